@@ -1,3 +1,4 @@
+#include <cuda_runtime.h>
 #include <thrust/sort.h>
 
 // This macro is used to enable the "__host__ __device__" attributes
@@ -21,4 +22,9 @@ void thrust_sort_CellSurf(EventQueueItem* begin, EventQueueItem* end)
   thrust::sort(thrust::device, begin, end, CellSurfCmp());
 }
 
+bool device_memory_info(size_t* free_bytes, size_t* total_bytes)
+{
+  return cudaMemGetInfo(free_bytes, total_bytes) == cudaSuccess;
+}
+
 }
@@ -2,48 +2,241 @@
 #define OPENMC_BANK_H
 
 #include <cstdint>
+#include <new> // for bad_alloc
 #include <vector>
 
+#include <omp.h>
+
 #include "openmc/shared_array.h"
 #include "openmc/particle.h"
 #include "openmc/position.h"
 
 namespace openmc {
 
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! OpenMP allocator used for the host side of the source and fission banks
+//
+//! \return An allocator returning pinned (page-locked) memory, falling back
+//!   to regular memory if none is available, when settings::pinned_banks is
+//!   set. Otherwise omp_null_allocator.
+omp_allocator_handle_t bank_allocator();
+
+//==============================================================================
+// Allocator for host bank storage. Pinned host memory lets the bank transfers
+// to and from the device run as direct DMA copies without going through an
+// intermediate staging buffer.
+//==============================================================================
+
+template<typename T>
+struct BankAllocator {
+  using value_type = T;
+
+  BankAllocator() = default;
+  template<typename U>
+  BankAllocator(const BankAllocator<U>&) {}
+
+  T* allocate(std::size_t n)
+  {
+    omp_allocator_handle_t allocator = bank_allocator();
+    if (allocator == omp_null_allocator) allocator = omp_default_mem_alloc;
+    void* p = omp_alloc(n * sizeof(T), allocator);
+    if (!p) throw std::bad_alloc();
+    return static_cast<T*>(p);
+  }
+
+  void deallocate(T* p, std::size_t) { omp_free(p, omp_null_allocator); }
+};
+
+template<typename T, typename U>
+bool operator==(const BankAllocator<T>&, const BankAllocator<U>&) { return true; }
+template<typename T, typename U>
+bool operator!=(const BankAllocator<T>&, const BankAllocator<U>&) { return false; }
+
+using BankVector = std::vector<Particle::Bank, BankAllocator<Particle::Bank>>;
+
+//==============================================================================
+//! Compact form of Particle::Bank used to exchange sites between processes
+//! when settings::packed_bank is set. The direction and weight are stored in
+//! single precision, and the parent and progeny IDs, which are only needed to
+//! sort the fission bank before it is exchanged, are dropped, as is the
+//! emission time, which fission sites always start at zero.
+//==============================================================================
+
+struct PackedBank {
+  Position r;
+  double E;
+  float u[3];
+  float wgt;
+  int32_t surf_id;
+  int8_t delayed_group;
+  int8_t particle;
+};
+
+inline PackedBank pack_bank(const Particle::Bank& site)
+{
+  PackedBank packed;
+  packed.r = site.r;
+  packed.E = site.E;
+  packed.u[0] = site.u.x;
+  packed.u[1] = site.u.y;
+  packed.u[2] = site.u.z;
+  packed.wgt = site.wgt;
+  packed.surf_id = site.surf_id;
+  packed.delayed_group = site.delayed_group;
+  packed.particle = static_cast<int8_t>(site.particle);
+  return packed;
+}
+
+//! Expand a packed site. The direction is renormalized after being widened,
+//! and the parent and progeny IDs and the emission time are zeroed.
+inline Particle::Bank unpack_bank(const PackedBank& packed)
+{
+  Particle::Bank site;
+  site.r = packed.r;
+  site.u = {packed.u[0], packed.u[1], packed.u[2]};
+  site.u /= site.u.norm();
+  site.E = packed.E;
+  site.wgt = packed.wgt;
+  site.delayed_group = packed.delayed_group;
+  site.surf_id = packed.surf_id;
+  site.particle = static_cast<Particle::Type>(packed.particle);
+  site.parent_id = 0;
+  site.progeny_id = 0;
+  site.time = 0.0;
+  return site;
+}
+
 //==============================================================================
 // Global variables
 //==============================================================================
 
 namespace simulation {
 
-extern std::vector<Particle::Bank> source_bank;
+extern BankVector source_bank;
 #pragma omp declare target
 extern Particle::Bank* device_source_bank;
 #pragma omp end declare target
 
+// Whether device_source_bank holds sites that have not been copied back to
+// source_bank, as is the case after the fission bank is resampled on device
+extern bool source_bank_stale;
+
 extern SharedArray<Particle::Bank> surf_source_bank;
 
 #pragma omp declare target
 extern SharedArray<Particle::Bank> fission_bank;
 #pragma omp end declare target
 
+// Sites banked once the fission bank is full are spilled here and moved into
+// the fission bank after transport, and those that fit in neither are counted
+#pragma omp declare target
+extern SharedArray<Particle::Bank> fission_spill;
+extern int64_t fission_sites_dropped;
+#pragma omp end declare target
+
+// Fission sites banked per source particle in the last generation, times the
+// keff they were banked with, from which the next generation's are predicted
+extern double fission_site_yield;
+
+// Shared pool holding the secondary particles that do not fit in a particle's
+// inline secondary bank. Entry i of secondary_pool_link is the pool index of
+// the next older spilled secondary of the same particle, or -1.
+#pragma omp declare target
+extern SharedArray<Particle::Bank> secondary_pool;
+#pragma omp end declare target
+extern std::vector<int> secondary_pool_link;
+
+#pragma omp declare target
+extern int* device_secondary_pool_link;
+#pragma omp end declare target
+
 extern std::vector<int64_t> progeny_per_particle;
 
 #pragma omp declare target
 extern int64_t* device_progeny_per_particle;
 #pragma omp end declare target
 
+// Scratch for sorting and resampling the fission bank on device (only
+// allocated when settings::device_fission_bank is set). Each holds as many
+// entries as the fission bank can.
+extern std::vector<Particle::Bank> fission_bank_scratch;
+extern std::vector<int64_t> fission_site_offsets;
+extern std::vector<int64_t> fission_scan_chunks;
+
+#pragma omp declare target
+extern Particle::Bank* device_fission_bank_scratch;
+extern int64_t* device_fission_site_offsets;
+extern int64_t* device_fission_scan_chunks;
+#pragma omp end declare target
+
 } // namespace simulation
 
 //==============================================================================
 // Non-member functions
 //==============================================================================
 
+//! Bank a fission site in the fission bank or, once it is full, in the spill
+//! buffer
+//
+//! \param site The fission site
+//! \return Whether the site was banked. Once both are full, the sites are
+//!   counted in simulation::fission_sites_dropped instead.
+#pragma omp declare target
+inline bool bank_fission_site(const Particle::Bank& site)
+{
+  if (simulation::fission_bank.thread_safe_append(site) != -1) return true;
+  if (simulation::fission_spill.thread_safe_append(site) != -1) return true;
+  #pragma omp atomic
+  simulation::fission_sites_dropped += 1;
+  return false;
+}
+#pragma omp end declare target
+
 void sort_fission_bank();
 
+//! Sort the device-resident fission bank in place with a parallel scan of
+//! device_progeny_per_particle and a parallel scatter. The result matches
+//! sort_fission_bank(), and neither the bank nor the progeny counts are
+//! copied to host.
+void sort_fission_bank_device();
+
+//! Copy the source bank back from device if it is newer there
+void update_source_bank_host();
+
 void free_memory_bank();
 
-void init_fission_bank(int64_t max);
+//! Allocate the fission bank and spill buffer with space for the sites
+//! expected in the first generation
+void init_fission_bank();
+
+//! Grow the fission bank and spill buffer, along with the scratch for sorting
+//! the fission bank on device, to hold the sites expected in the next
+//! generation. They are never shrunk, so that they are only mapped to device
+//! again while the population is still rising.
+void reserve_fission_bank();
+
+//! Copy the spilled sites and the count of dropped sites back from device.
+//! Called once per generation, after transport on device.
+void copy_fission_spill_to_host();
+
+//! Append sites to the host copy of the fission bank, growing it to hold them
+//
+//! \param sites The sites to append
+//! \param n The number of sites
+void append_fission_sites(const Particle::Bank* sites, int64_t n);
+
+//! Move the sites spilled in this generation into the fission bank and warn of
+//! any that were dropped. With settings::device_fission_bank, the merged bank
+//! is copied back to device.
+void merge_fission_spill();
+
+//! Allocate the shared secondary particle pool
+//
+//! \param max The number of spilled secondary particles the pool can hold
+void init_secondary_pool(int64_t max);
 
 } // namespace openmc
 
@@ -2,8 +2,8 @@
 #define OPENMC_BREMSSTRAHLUNG_H
 
 #include "openmc/particle.h"
+#include "openmc/vector.h"
 
-#include <gsl/gsl>
 #include "xtensor/xtensor.hpp"
 
 namespace openmc {
@@ -12,30 +12,18 @@ namespace openmc {
 // Bremsstrahlung classes
 //==============================================================================
 
+//! Bremsstrahlung tables of one material and particle type, as built on host.
+//! They are flattened into the data::ttb_* arrays for transport.
 class BremsstrahlungData {
 public:
-  // Methods
-  void copy_to_device();
-  void release_from_device();
-
   // Data
   xt::xtensor<double, 2> pdf_; //!< Bremsstrahlung energy PDF
   xt::xtensor<double, 2> cdf_; //!< Bremsstrahlung energy CDF
   xt::xtensor<double, 1> yield_; //!< Photon yield
-
-  double* device_pdf_ {nullptr};
-  double* device_cdf_ {nullptr};
-  double* device_yield_ {nullptr};
-  double pdf(gsl::index i, gsl::index j) const;
-  double cdf(gsl::index i, gsl::index j) const;
 };
 
 class Bremsstrahlung {
 public:
-  // Methods
-  void copy_to_device();
-  void release_from_device();
-
   // Data
   BremsstrahlungData electron;
   BremsstrahlungData positron;
@@ -55,12 +43,38 @@ extern double* device_ttb_e_grid;
 extern size_t ttb_e_grid_size;
 #pragma omp end declare target
 
+// The tables of every material, electron then positron, flattened by
+// flatten_bremsstrahlung(). Only the entries of photon energies up to the
+// incident energy are kept, so that row i of a table (incident energy i)
+// starts at entry i*(i+1)/2 and the tables are ttb_table_size entries apart.
+extern vector<double> ttb_pdf;      //!< Photon energy PDF
+extern vector<double> ttb_cdf;      //!< Photon energy CDF
+extern vector<double> ttb_exponent; //!< Exponent of the log-log PDF up to the next photon energy, plus one
+extern vector<double> ttb_log_yield; //!< Log of the photon number yield of each incident energy
+extern vector<double> ttb_energy;   //!< Energies of ttb_e_grid in [eV]
+#pragma omp declare target
+extern double* device_ttb_pdf;
+extern double* device_ttb_cdf;
+extern double* device_ttb_exponent;
+extern double* device_ttb_log_yield;
+extern double* device_ttb_energy;
+extern size_t ttb_table_size; //!< Entries of one table
+#pragma omp end declare target
+
 } // namespace data
 
 //==============================================================================
 // Non-member functions
 //==============================================================================
 
+//! Flatten the bremsstrahlung tables of every material into the data::ttb_*
+//! arrays, precomputing the interpolation exponents, and copy them to device.
+//! Nothing is done unless thick-target bremsstrahlung is in use.
+void copy_bremsstrahlung_to_device();
+
+//! Release the flattened bremsstrahlung tables on device and host
+void release_bremsstrahlung_from_device();
+
 #pragma omp declare target
 void thick_target_bremsstrahlung(Particle& p, double* E_lost);
 #pragma omp end declare target
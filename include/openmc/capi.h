@@ -20,6 +20,9 @@ extern "C" {
   int openmc_cell_set_fill(int32_t index, int type, int32_t n, const int32_t* indices);
   int openmc_cell_set_id(int32_t index, int32_t id);
   int openmc_cell_set_temperature(int32_t index, double T, const int32_t* instance, bool set_contained = false);
+  int openmc_cells_set_temperatures(int n, const int32_t* index,
+                                    const int32_t* instance, const double* T);
+  int openmc_collision_benchmark();
   int openmc_energy_filter_get_bins(int32_t index, const double** energies, size_t* n);
   int openmc_energy_filter_set_bins(int32_t index, size_t n, const double* energies);
   int openmc_energyfunc_filter_get_energy(int32_t index, size_t* n, const double** energy);
@@ -37,6 +40,9 @@ extern "C" {
   int openmc_filter_set_id(int32_t index, int32_t id);
   int openmc_finalize();
   int openmc_find_cell(const double* xyz, int32_t* index, int32_t* instance);
+  int openmc_find_cells(const double* xyz, int n, int32_t* index,
+                        int32_t* instance);
+  int openmc_find_overlaps();
   int openmc_cell_bounding_box(const int32_t index, double* llc, double* urc);
   int openmc_global_bounding_box(double* llc, double* urc);
   int openmc_fission_bank(void** ptr, int64_t* n);
@@ -66,6 +72,10 @@ extern "C" {
   int openmc_material_get_volume(int32_t index, double* volume);
   int openmc_material_set_density(int32_t index, double density, const char* units);
   int openmc_material_set_densities(int32_t index, int n, const char** name, const double* density);
+  int openmc_materials_set_densities(int n, const int32_t* index,
+                                     const double* density);
+  int openmc_materials_set_compositions(int n, const int32_t* index,
+    const int32_t* offset, const int* nuclide, const double* density);
   int openmc_material_set_id(int32_t index, int32_t id);
   int openmc_material_get_name(int32_t index, const char** name);
   int openmc_material_set_name(int32_t index, const char* name);
@@ -81,6 +91,9 @@ extern "C" {
   int openmc_new_filter(const char* type, int32_t* index);
   int openmc_next_batch(int* status);
   int openmc_nuclide_name(int index, const char** name);
+  int openmc_nuclides_collapse_rates(int n, const int* nuclides,
+    const int* MTs, const double* temperatures, const double* energy,
+    const double* flux, int n_groups, double* xs);
   int openmc_plot_geometry();
   int openmc_id_map(const void* slice, int32_t* data_out);
   int openmc_property_map(const void* slice, double* data_out);
@@ -93,10 +106,15 @@ extern "C" {
   int openmc_regular_mesh_get_params(int32_t index, double** ll, double** ur, double** width, int* n);
   int openmc_regular_mesh_set_dimension(int32_t index, int n, const int* dims);
   int openmc_regular_mesh_set_params(int32_t index, int n, const double* ll, const double* ur, const double* width);
+  int openmc_random_ray();
   int openmc_reset();
   int openmc_reset_timers();
   int openmc_run();
+  int openmc_search_keff(const char* parameter, int32_t index, double lower,
+    double upper, double target, double tol, int max_iterations,
+    double* guesses, double* keffs, int* n_iterations);
   void openmc_set_seed(int64_t new_seed);
+  int openmc_set_source_reuse(bool reuse, int32_t n_inactive);
   int openmc_set_n_batches(int32_t n_batches, bool set_max_batches,
                            bool add_statepoint_batch);
   int openmc_simulation_finalize();
@@ -113,6 +131,10 @@ extern "C" {
   int openmc_sphharm_filter_set_cosine(int32_t index, const char cosine[]);
   int openmc_statepoint_write(const char* filename, bool* write_source);
   int openmc_tally_allocate(int32_t index, const char* type);
+  int openmc_tally_collapse_rates(int32_t index, int n_nuclides,
+    const int* nuclides, int n_reactions, const int* MTs, double* rates);
+  int openmc_tally_device_results(int32_t index, double** ptr,
+    size_t shape_[3]);
   int openmc_tally_get_active(int32_t index, bool* active);
   int openmc_tally_get_estimator(int32_t index, int* estimator);
   int openmc_tally_get_id(int32_t index, int32_t* id);
@@ -132,6 +154,8 @@ extern "C" {
   int openmc_tally_set_scores(int32_t index, int n, const char** scores);
   int openmc_tally_set_type(int32_t index, const char* type);
   int openmc_tally_set_writable(int32_t index, bool writable);
+  int openmc_tally_sync_results(int32_t index);
+  int openmc_xs_benchmark();
   int openmc_zernike_filter_get_order(int32_t index, int* order);
   int openmc_zernike_filter_get_params(int32_t index, double* x, double* y, double* r);
   int openmc_zernike_filter_set_order(int32_t index, int order);
@@ -159,13 +183,16 @@ extern "C" {
   //! \param[in] spectral spectral radius of CMFD matrices and tolerances
   //! \param[in] map coremap for problem, storing accelerated regions
   //! \param[in] use_all_threads whether to use all threads when running CMFD solver
+  //! \param[in] solver linear solver to use, a value of CmfdSolver
+  //! \param[in] on_device whether to run the BiCGSTAB solver on the device
   extern "C" void openmc_initialize_linsolver(const int* indptr, int len_indptr,
                                               const int* indices, int n_elements,
                                               int dim, double spectral,
-                                              const int* map, bool use_all_threads);
+                                              const int* map, bool use_all_threads,
+                                              int solver, bool on_device);
 
-  //! Runs a Gauss Seidel linear solver to solve CMFD matrix equations
-  //! linear solver
+  //! Runs the linear solver chosen in openmc_initialize_linsolver to solve
+  //! CMFD matrix equations
   //! \param[in] A_data CSR format data array of coefficient matrix
   //! \param[in] b right hand side vector
   //! \param[out] x unknown vector
@@ -39,6 +39,14 @@ constexpr int32_t OP_COMPLEMENT   {std::numeric_limits<int32_t>::max() - 2};
 constexpr int32_t OP_INTERSECTION {std::numeric_limits<int32_t>::max() - 3};
 constexpr int32_t OP_UNION        {std::numeric_limits<int32_t>::max() - 4};
 
+// Terminal targets of the compiled region instructions
+constexpr int32_t REGION_ACCEPT {-1};
+constexpr int32_t REGION_REJECT {-2};
+
+// Cells whose region takes at least this many half-space tests reject points
+// outside of their bounding box before evaluating it
+constexpr int CELL_BOX_MIN_TESTS {4};
+
 //==============================================================================
 // Global variables
 //==============================================================================
@@ -65,6 +73,48 @@ namespace model {
   extern std::unordered_map<int32_t, int32_t> universe_map;
 } // namespace model
 
+//==============================================================================
+//! One instruction of a compiled cell region. The sense of the point with
+//! respect to the half-space given by token is evaluated, and evaluation
+//! continues at on_true or on_false, which are either the index of another
+//! instruction or REGION_ACCEPT/REGION_REJECT.
+//==============================================================================
+
+struct RegionInstruction {
+  int32_t token;    //!< Half-space as a signed surface index + 1
+  int32_t on_true;  //!< Next instruction if the point is in the half-space
+  int32_t on_false; //!< Next instruction otherwise
+};
+
+//==============================================================================
+//! Surface senses already evaluated at one position and direction, shared by
+//! all the cells tested for them during a cell search. Entries are direct
+//! mapped on the surface index, so a collision simply evicts the older sense.
+//==============================================================================
+
+class SurfaceSenseCache {
+public:
+  static constexpr int SIZE {16};
+
+  #pragma omp declare target
+  SurfaceSenseCache() { clear(); }
+
+  //! Forget every sense, e.g. when moving to other coordinates
+  void clear()
+  {
+    for (int i = 0; i < SIZE; ++i) surf_[i] = C_NONE;
+  }
+
+  //! Sense of a point with respect to a surface
+  //! \param i_surf Index of the surface in model::device_surfaces
+  bool sense(int32_t i_surf, Position r, Direction u);
+  #pragma omp end declare target
+
+private:
+  int32_t surf_[SIZE];
+  bool sense_[SIZE];
+};
+
 //==============================================================================
 //! A geometry primitive that fills all space and contains cells.
 //==============================================================================
@@ -97,6 +147,23 @@ public:
   // Constructors, destructors, factory functions
 
   explicit Cell(pugi::xml_node cell_node);
+
+  //! Construct a cell from one row of the cells of an HDF5 model input
+  //
+  //! \param id Unique ID
+  //! \param name User-defined name
+  //! \param universe ID of the universe the cell is in
+  //! \param fill ID of the universe or lattice filling the cell, or C_NONE
+  //! \param material IDs of the materials filling the cell, or MATERIAL_VOID
+  //! \param temperature Temperatures in [K], if any
+  //! \param region Region specification, as in geometry.xml
+  //! \param translation Translation vector, if any
+  //! \param rotation Rotation angles or matrix, if any
+  Cell(int32_t id, const std::string& name, int32_t universe, int32_t fill,
+    const std::vector<int32_t>& material,
+    const std::vector<double>& temperature, const std::string& region,
+    const std::vector<double>& translation,
+    const std::vector<double>& rotation);
   Cell() {};
   ~Cell() = default;
 
@@ -109,34 +176,57 @@ public:
   //! surface half-spaces. At initialization, the expression was converted
   //! to RPN notation.
   //!
-  //! The function is split into two cases, one for simple cells (those
-  //! involving only the intersection of half-spaces) and one for complex cells.
-  //! Simple cells can be evaluated with short circuit evaluation, i.e., as soon
-  //! as we know that one half-space is not satisfied, we can exit. This
-  //! provides a performance benefit for the common case. In
-  //! contains_complex, we evaluate the RPN expression using a stack, similar to
-  //! how a RPN calculator would work.
+  //! The expression is evaluated through region_code_, a flat list of
+  //! half-space tests that jump straight to the next test that can still
+  //! change the result, so that evaluation stops as soon as the result is
+  //! known for both simple and complex cells. Cheap surfaces are tested first.
+  //! Cells with many surfaces first reject points well outside of their
+  //! bounding box.
   //! \param r The 3D Cartesian coordinate to check.
   //! \param u A direction used to "break ties" the coordinates are very
   //!   close to a surface.
   //! \param on_surface The signed index of a surface that the coordinate is
   //!   known to be on.  This index takes precedence over surface sense
   //!   calculations.
+  //! \param senses Surface senses already known at r and u, which is updated
+  //!   with the senses evaluated here. May be nullptr.
   #pragma omp declare target
   bool
-  contains(Position r, Direction u, int32_t on_surface) const;
+  contains(Position r, Direction u, int32_t on_surface,
+    SurfaceSenseCache* senses = nullptr) const;
+  #pragma omp end declare target
+
+  //! \brief Is the cell the same everywhere it is used?
+  //!
+  //! This is the case when a single material and temperature fill all space
+  //! and instances aren't distinguished, so that particles can go through
+  //! lattice tiles filled with its universe as if they were one.
+  #pragma omp declare target
+  bool is_homogeneous() const
+  {
+    return type_ == Fill::MATERIAL && region_code_.empty() &&
+      material_.size() == 1 && sqrtkT_.size() == 1 &&
+      distribcell_index_ == C_NONE;
+  }
   #pragma omp end declare target
 
   //! Find the oncoming boundary of this cell.
+  //! \param planes Evaluations of the general planes of the cell, kept from
+  //!   one call to the next at the same position. May be nullptr.
   #pragma omp declare target
   std::pair<double, int32_t>
-  distance(Position r, Direction u, int32_t on_surface, Particle* p) const;
+  distance(Position r, Direction u, int32_t on_surface, Particle* p,
+    PlaneEvalCache* planes = nullptr) const;
   #pragma omp end declare target
 
   //! Write all information needed to reconstruct the cell to an HDF5 group.
   //! \param group_id An HDF5 group id.
   void to_hdf5(hid_t group_id) const;
 
+  //! Region specification in the infix notation of geometry.xml, by surface
+  //! ID, or an empty string if the cell has no region
+  std::string region_spec() const;
+
   //! Export physical properties to HDF5
   //! \param[in] group  HDF5 group to read from
   void export_properties_hdf5(hid_t group) const;
@@ -148,6 +238,10 @@ public:
   //! Get the BoundingBox for this cell.
   BoundingBox bounding_box() const;
 
+  //! Rebuild the compiled region, surface batches and bounding box from
+  //! region_, after it was read or changed
+  void update_region();
+
   void allocate_on_device();
   void copy_to_device();
 
@@ -216,9 +310,25 @@ public:
   vector<int32_t> region_;
   bool simple_; //!< Does the region contain only intersections?
 
+  //! Region compiled to short-circuiting half-space tests (see contains())
+  vector<RegionInstruction> region_code_;
+  int32_t region_entry_ {REGION_ACCEPT}; //!< First instruction of region_code_
+
+  //! Surfaces of the region grouped by type, for distance()
+  vector<SurfaceBatch> surface_batches_;
+  vector<int32_t> batch_tokens_; //!< Signed surface indices + 1 of the batches
+  vector<double> batch_coeffs_;  //!< Packed coefficients of the batches
+
+  //! Bounding box of the region, and whether contains() checks it
+  BoundingBox box_;
+  bool check_box_ {false};
+
   //! \brief Neighboring cells in the same universe.
   NeighborList neighbors_;
 
+  //! Are neutrons inside this cell delta-tracked? (see settings::delta_tracking)
+  bool delta_tracking_ {false};
+
   Position translation_ {0, 0, 0}; //!< Translation vector for filled universe
 
   //! \brief Rotational tranfsormation of the filled universe.
@@ -235,10 +345,25 @@ public:
   vector<int32_t> offset_;  //!< Distribcell offset table
 
 protected:
-  #pragma omp declare target
-  bool contains_simple(Position r, Direction u, int32_t on_surface) const;
-  bool contains_complex(Position r, Direction u, int32_t on_surface) const;
-  #pragma omp end declare target
+  //! Compile region_ to region_code_, ordering the operands of each union and
+  //! intersection by increasing cost of their surfaces
+  void compile_region();
+
+  //! Group the surfaces of region_ by type into surface_batches_. Planes of
+  //! each axis are sorted by position.
+  void build_surface_batches();
+
+  //! Set the temperatures of the cell from values in [K]
+  void set_temperatures(const std::vector<double>& T);
+
+  //! Set region_ from a region specification and compile it
+  void set_region(const std::string& region_spec);
+
+  void set_translation(const std::vector<double>& xyz);
+
+  //! Set the rotation matrix from three angles in [deg] or nine elements
+  void set_rotation(const std::vector<double>& rot);
+
   BoundingBox bounding_box_simple() const;
   static BoundingBox bounding_box_complex(vector<int32_t> postfix);
 
@@ -340,9 +465,10 @@ public:
 //==============================================================================
 //! Speeds up geometry searches by grouping cells in a search tree.
 //
-//! Currently this object only works with universes that are divided up by a
-//! bunch of z-planes.  It could be generalized to other planes, cylinders,
-//! and spheres.
+//! The universe is divided up by one family of nested surfaces: x-, y- or
+//! z-planes, cylinders sharing an axis, or concentric spheres. Of the families
+//! bounding its cells, the one leaving the fewest cells per partition on
+//! average is used.
 //==============================================================================
 
 class UniversePartitioner
@@ -358,7 +484,8 @@ public:
   void allocate_and_copy_to_device();
 
 //private:
-  //! A sorted vector of indices to surfaces that partition the universe
+  //! Indices to surfaces that partition the universe, sorted by position
+  //! along the planes' axis or by radius
   vector<int32_t> surfs_;
 
   //! Vectors listing the indices of the cells that lie within each partition
@@ -416,6 +543,29 @@ struct CellInstanceHash {
 
 void read_cells(pugi::xml_node node);
 
+//! Read the cells of an HDF5 model input (see read_geometry_hdf5())
+//
+//! \param file_id Open geometry.h5 file
+void read_cells_hdf5(hid_t file_id);
+
+//! Relative cost of evaluating the sense of a point for a half-space
+//! \param token Signed surface index + 1
+int half_space_cost(int32_t token);
+
+//! Record that the temperatures or fill of a cell are about to change on host.
+//! The geometry stays on device between simulations, so the cells changed
+//! are sent by update_cells_on_device(). Of the per-instance temperatures,
+//! only the block spanning the instances changed since is sent.
+//
+//! \param i Index in the cells array
+//! \param relocate Whether the temperature or material vectors may be
+//!   reallocated, in which case their device copies are released first
+//! \param instance Instance whose temperature changes, or -1 for all of them
+void mark_cell_changed(int32_t i, bool relocate, int32_t instance = -1);
+
+//! Send the cells changed since the geometry was moved to device
+void update_cells_on_device();
+
 #ifdef DAGMC
 int32_t next_cell(DAGCell* cur_cell, DAGSurface* surf_xed);
 #endif
@@ -26,12 +26,14 @@ constexpr int HDF5_VERSION[] {3, 0};
 // Version numbers for binary files
 constexpr std::array<int, 2> VERSION_STATEPOINT {17, 0};
 constexpr std::array<int, 2> VERSION_PARTICLE_RESTART {2, 0};
-constexpr std::array<int, 2> VERSION_TRACK {2, 0};
-constexpr std::array<int, 2> VERSION_SUMMARY {6, 0};
+constexpr std::array<int, 2> VERSION_TRACK {3, 0};
+constexpr std::array<int, 2> VERSION_SUMMARY {6, 1};
 constexpr std::array<int, 2> VERSION_VOLUME {1, 0};
 constexpr std::array<int, 2> VERSION_VOXEL {2, 0};
 constexpr std::array<int, 2> VERSION_MGXS_LIBRARY {1, 0};
 constexpr std::array<int, 2> VERSION_PROPERTIES {1, 0};
+constexpr std::array<int, 2> VERSION_MODEL_INPUT {1, 0};
+constexpr std::array<int, 2> VERSION_EVENT_TRACE {1, 0};
 
 // ============================================================================
 // ADJUSTABLE PARAMETERS
@@ -48,6 +50,37 @@ constexpr double CONFIDENCE_LEVEL {0.95};
 // Used for surface current tallies
 constexpr double TINY_BIT {1e-8};
 
+// Share of particles transported on host by hybrid transport before the
+// speeds of host and device have been measured
+constexpr double HYBRID_INITIAL_HOST_FRACTION {0.01};
+
+// Largest entropy or UFS mesh a fission matrix is tallied on, and the
+// convergence tolerance and iteration limit of its power iteration
+constexpr int FISSION_MATRIX_MAX_BINS {2048};
+constexpr double FISSION_MATRIX_TOL {1e-8};
+constexpr int FISSION_MATRIX_MAX_ITER {10000};
+
+// Smallest dataset, in bytes, that HDF5 output chunks and compresses when
+// compression is on. Smaller ones gain little and cost a chunk index each.
+constexpr size_t HDF5_FILTER_MIN_BYTES {1 << 16};
+
+// Shortest tabulated function whose abscissa is hashed on a logarithmic grid
+// when it is flattened, and the number of points per hash bin
+constexpr size_t TABULATED_HASH_MIN_PAIRS {64};
+constexpr size_t TABULATED_HASH_PAIRS_PER_BIN {4};
+
+// Fewest incident energies of a decoded angle-energy distribution whose grid
+// is hashed, with one logarithmic bin per incident energy
+constexpr size_t SECONDARY_HASH_MIN_ENERGIES {16};
+
+// Size in bytes of the blocks of tally results that an incremental checkpoint
+// rewrites when any of their values changed
+constexpr int CHECKPOINT_BLOCK_BYTES {1 << 16};
+
+// Number of sampled particle events that the event trace buffers on device
+// before they are written
+constexpr int EVENT_TRACE_RECORDS {1 << 20};
+
 // User for precision in geometry
 constexpr double FP_PRECISION {1e-14};
 constexpr double FP_REL_PRECISION {1e-5};
@@ -58,6 +91,13 @@ constexpr double FP_COINCIDENT {1e-12};
   */
 #define FP_COINCIDENT 1e-12
 
+// Factor by which the delta-tracking majorant XS exceeds the tabulated bound
+constexpr double MAJORANT_MARGIN {1.01};
+
+// Reduced speed beyond which the thermal motion of targets is not sampled by
+// target motion sampling, which bounds the speeds its majorant XS cover
+constexpr double TMS_SPEED_CUTOFF {4.0};
+
 // Maximum number of collisions/crossings
 constexpr int MAX_EVENTS {1000000};
 constexpr int MAX_SAMPLE {100000};
@@ -127,6 +167,21 @@ enum class TemperatureMethod {
  INTERPOLATION
 };
 
+// Energy grid used to bound the search for each nuclide's grid index
+enum class EnergyGridMethod {
+  logarithm, //!< Equal-lethargy hash bins (settings::n_log_bins)
+  unionized  //!< Union of all nuclide energy grids
+};
+
+// Implementation of the Faddeeva function used by windowed multipole lookups,
+// in order of increasing accuracy for the batched variants
+enum class FaddeevaMethod {
+  scalar,     //!< faddeeva(), one pole at a time (zpf8h or MIT per new_w)
+  humlicek8,  //!< Batched, branch-free Humlicek 8th order rational approximation
+  weideman16, //!< Batched Weideman rational approximation with 16 terms
+  weideman32  //!< Batched Weideman rational approximation with 32 terms
+};
+
 // Reaction types
 enum ReactionType {
   REACTION_NONE = 0,
@@ -256,10 +311,21 @@ enum ReactionType {
   HEATING_LOCAL = 901
 };
 
-#define DEPLETION_RX_SIZE 6
-#pragma omp declare target
-constexpr std::array<int, DEPLETION_RX_SIZE> DEPLETION_RX {N_GAMMA, N_P, N_A, N_2N, N_3N, N_4N};
-#pragma omp end declare target
+// Primary MT of each transmutation reaction of a depletion chain (see
+// openmc.deplete.chain.REACTIONS), with (n,gamma) first. The cross sections of
+// those scored by a tally, up to MAX_DEPLETION_RX of them, are looked up along
+// with the macroscopic XS (see simulation::depletion_rx).
+constexpr std::array<int, 84> DEPLETION_REACTIONS {
+  N_GAMMA, N_2ND, N_2N, N_3N, N_NA, N_N3A, N_2NA, N_3NA, N_NP, N_N2A, N_2N2A,
+  N_ND, N_NT, N_N3HE, N_ND2A, N_NT2A, N_4N, N_2NP, N_3NP, N_N2P, N_NPA, N_P,
+  N_D, N_T, N_3HE, N_A, N_2A, N_3A, N_2P, N_PA, N_T2A, N_D2A, N_PD, N_PT, N_DA,
+  N_5N, N_6N, N_2NT, N_TA, N_4NP, N_3ND, N_NDA, N_2NPA, N_7N, N_8N, N_5NP,
+  N_6NP, N_7NP, N_4NA, N_5NA, N_6NA, N_7NA, N_4ND, N_5ND, N_6ND, N_3NT, N_4NT,
+  N_5NT, N_6NT, N_2N3HE, N_3N3HE, N_4N3HE, N_3N2P, N_3N2A, N_3NPA, N_DT, N_NPD,
+  N_NPT, N_NDT, N_NP3HE, N_ND3HE, N_NT3HE, N_NTA, N_2N2P, N_P3HE, N_D3HE,
+  N_3HEA, N_4N2P, N_4N2A, N_4NPA, N_3P, N_N3P, N_3N2PA, N_5N2P
+};
+constexpr int MAX_DEPLETION_RX {16};
 
 enum class URRTableParam {
   CUM_PROB,
@@ -394,12 +460,32 @@ enum class RunMode {
   VOLUME
 };
 
+// Layouts of summary.h5
+enum class SummaryFormat {
+  full,    // One group per cell, surface, universe, lattice and material
+  compact, // Cells, universes and materials as arrays with one entry per object
+  hash     // The hash and contents of the model input files
+};
+
+// Policies for choosing the next event kernel in event-based mode
+enum class EventScheduler {
+  longest_queue, // Launch the kernel with the most queued particles
+  cost_model     // Launch the kernel with the highest predicted throughput
+};
+
 // ============================================================================
 // CMFD CONSTANTS
 
 // For non-accelerated regions on coarse mesh overlay
 constexpr int CMFD_NOACCEL {-1};
 
+// Linear solvers for the CMFD loss matrix, in the order of
+// openmc.CMFDRun.linear_solver
+enum class CmfdSolver {
+  gauss_seidel, // Red-black Gauss-Seidel with overrelaxation
+  bicgstab      // BiCGSTAB with a Jacobi preconditioner
+};
+
 } // namespace openmc
 
 #endif // OPENMC_CONSTANTS_H
@@ -23,6 +23,11 @@ namespace model {
 //==============================================================================
 
 void load_dagmc_geometry();
+
+//! Build the triangle hierarchy of every volume from its surface meshes, for
+//! ray queries on device
+void build_dagmc_bvhs();
+
 void free_memory_dagmc();
 void read_geometry_dagmc();
 bool read_uwuw_materials(pugi::xml_document& doc);
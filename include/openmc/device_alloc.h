@@ -4,12 +4,181 @@
 #include <omp.h>
 #include <assert.h>
 
+#include <cstddef> // for size_t
+#include <memory>  // for unique_ptr
+#include <string>
+#include <utility> // for pair
+#include <vector>
+
 namespace openmc {
 
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Capacity of each device arena slab. Arrays larger than this get a slab of
+// their own. Only the used portion of a slab is transferred to the device.
+constexpr size_t DEVICE_ARENA_SLAB_BYTES {size_t{256} << 20};
+
+// Alignment of every array allocated from a device arena
+constexpr size_t DEVICE_ARENA_ALIGNMENT {64};
+
+//==============================================================================
+//! Packs read-only arrays into a few large slabs that are each mapped to the
+//! device with a single transfer.
+//!
+//! Arrays are carved out of the slabs on host and filled in place. Once
+//! map_to_device() has been called, mapping an array that lies within a slab
+//! (e.g., to attach a struct member pointer on device) only finds the
+//! enclosing slab present, so it neither allocates nor copies.
+//==============================================================================
+
+class DeviceArena {
+public:
+  //! Allocate an uninitialized array within the arena
+  //
+  //! \param n Number of elements
+  //! \param subsystem Name the array's bytes are reported under
+  //! \return Host pointer to the array
+  template<typename T>
+  T* allocate(size_t n, const char* subsystem)
+  {
+    return static_cast<T*>(allocate_bytes(n * sizeof(T), subsystem));
+  }
+
+  //! Allocate uninitialized bytes within the arena
+  //
+  //! \param n_bytes Number of bytes
+  //! \param subsystem Name the bytes are reported under
+  //! \return Host pointer to the bytes, aligned to DEVICE_ARENA_ALIGNMENT
+  void* allocate_bytes(size_t n_bytes, const char* subsystem);
+
+  //! Account for data mapped to the device outside of the arena so that it
+  //! appears in report()
+  //
+  //! \param subsystem Name the bytes are reported under
+  //! \param n_bytes Number of bytes
+  void record(const char* subsystem, size_t n_bytes);
+
+  //! Map every slab to the device
+  void map_to_device();
+
+  //! Release every slab from the device and reset the counts of data mapped
+  //! outside of the arena
+  void release_from_device();
+
+  //! Reset the counts of data mapped outside of the arena, leaving the slabs
+  //! mapped
+  void reset_records();
+
+  //! Free all slabs on host and reset the byte counts
+  void clear();
+
+  //! Return the number of device bytes recorded across all subsystems
+  size_t total_bytes() const;
+
+private:
+  struct Slab {
+    std::unique_ptr<char[]> data; //!< Host storage
+    size_t capacity;              //!< Allocated bytes
+    size_t used;                  //!< Bytes handed out
+    bool mapped;                  //!< Whether the slab is mapped to device
+  };
+
+  //! allocate_bytes(), for a caller holding the arena lock
+  void* allocate_bytes_serial(size_t n_bytes, const char* subsystem);
+
+  //! Add n_bytes to a subsystem's count
+  void count(std::vector<std::pair<std::string, size_t>>& counts,
+    const char* subsystem, size_t n_bytes);
+
+  std::vector<Slab> slabs_;
+  std::vector<std::pair<std::string, size_t>> packed_; //!< Bytes in slabs
+  std::vector<std::pair<std::string, size_t>> direct_; //!< Bytes mapped directly
+};
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace data {
+
+//! Arena holding read-only nuclear data when settings::device_arena is set
+extern DeviceArena device_arena;
+
+} // namespace data
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Copy the global settings used on device to their device globals
+void move_settings_to_device();
+
+//! Choose the nuclides whose flattened pointwise XS stay in host memory so
+//! that the others fit in settings::device_xs_budget. Nuclides are kept on
+//! device in order of use, estimated from the number of cell instances of
+//! each material weighted by the nuclide's atom fraction in it.
+void choose_host_resident_xs();
+
+//! Let the device read a host array in place instead of a device copy of it.
+//! Mapping the array afterwards finds it present and copies nothing.
+//
+//! \param ptr Host array, in memory the device can access
+//! \param n_bytes Size of the array
+void map_in_place(void* ptr, size_t n_bytes);
+
+//! Undo map_in_place()
+void unmap_in_place(void* ptr);
+
+//! OpenMP allocator for host arrays read in place by the device
+//
+//! \return An allocator returning pinned (page-locked) memory, falling back
+//!   to regular memory if none is available
+omp_allocator_handle_t host_resident_allocator();
+
+//! Copy the surfaces, universes, cells and lattices to device
+void move_geometry_to_device();
+
 void move_read_only_data_to_device();
 
+//! Release the data moved by move_read_only_data_to_device(). With
+//! settings::keep_device_data, the nuclear data and materials stay on device
+//! for the next simulation, which then only adds the nuclides and elements
+//! loaded since and sends the materials changed since.
 void release_data_from_device();
 
+//! Release the nuclear data and materials kept on device by
+//! release_data_from_device(), if any, before they are freed on host
+void release_resident_data_from_device();
+
+//! Record that a material changed on host while the materials are kept on
+//! device between simulations. A change of only its atom densities is sent by
+//! the next simulation; any other change, e.g. of its nuclides, releases the
+//! materials so that the next simulation moves all of them again.
+//
+//! \param i Index in the materials array
+//! \param layout Whether more than the atom densities changed
+void mark_material_changed(int32_t i, bool layout);
+
+//! Determine the device memory that is still free
+//
+//! The free memory is queried from the device runtime when a vendor interop
+//! library is linked in. Otherwise it is estimated as settings::device_memory
+//! less everything recorded by data::device_arena.
+//! \return The number of free bytes, or 0 if it cannot be determined
+size_t free_device_memory();
+
+#ifdef CUDA_THRUST_SORT
+//! Query the free and total memory of the current device from the vendor
+//! runtime (defined alongside the Thrust sorting functions)
+//
+//! \param free_bytes Number of free bytes
+//! \param total_bytes Number of total bytes
+//! \return Whether the query succeeded
+bool device_memory_info(size_t* free_bytes, size_t* total_bytes);
+#endif
+
 } // namespace openmc
 
 #endif // OPENMC_DEVICE_ALLOC_H
@@ -0,0 +1,215 @@
+#ifndef OPENMC_DEVICE_SORT_H
+#define OPENMC_DEVICE_SORT_H
+
+//! \file device_sort.h
+//! \brief Portable on-device sorting of event queues via OpenMP offloading
+
+#include <cstdint>
+#include <cstring> // for memcpy
+
+#include "openmc/event.h"
+
+namespace openmc {
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Number of key bits sorted by each radix sort pass
+constexpr int RADIX_BITS {8};
+constexpr int RADIX_BUCKETS {1 << RADIX_BITS};
+
+// Number of consecutive queue items that a single device thread histograms
+// and scatters. Processing a tile serially is what keeps each pass stable
+// without requiring any intra-team synchronization.
+constexpr int RADIX_TILE {256};
+
+// Number of consecutive elements summed serially by a thread during a scan
+constexpr int SCAN_CHUNK {1024};
+
+// Number of bits of each coordinate interleaved into a Morton key
+constexpr int MORTON_BITS {21};
+
+//==============================================================================
+// Sort keys
+//==============================================================================
+
+#pragma omp declare target
+//! Map a signed integer to an unsigned integer with the same ordering
+inline uint32_t ordered_bits(int x)
+{
+  return static_cast<uint32_t>(x) ^ 0x80000000u;
+}
+
+//! Map a float to an unsigned integer with the same ordering
+inline uint32_t ordered_bits(float x)
+{
+  uint32_t u;
+  std::memcpy(&u, &x, sizeof(u));
+  return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+//! Pack the fields compared by MatECmp or CellSurfCmp into a single 64-bit
+//! key whose unsigned ordering matches that of the comparator. Keys of
+//! SortBy::position depend on the particle rather than the queue item and are
+//! built by position_key() instead.
+//
+//! \param item The queue item
+//! \param sort_by Which comparator to reproduce
+//! \return The packed key
+inline uint64_t sort_key(const EventQueueItem& item, SortBy sort_by)
+{
+  if (sort_by == SortBy::material_energy) {
+    return (static_cast<uint64_t>(ordered_bits(item.material)) << 32) |
+      ordered_bits(item.E);
+  } else {
+    return (static_cast<uint64_t>(ordered_bits(item.cell_id)) << 32) |
+      ordered_bits(item.surface_id);
+  }
+}
+
+//! Spread the low MORTON_BITS bits of an integer so that each is followed by
+//! two zero bits
+inline uint64_t spread_bits(uint64_t x)
+{
+  x &= (uint64_t {1} << MORTON_BITS) - 1;
+  x = (x | x << 32) & 0x001f00000000ffffull;
+  x = (x | x << 16) & 0x001f0000ff0000ffull;
+  x = (x | x << 8) & 0x100f00f00f00f00full;
+  x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+  x = (x | x << 2) & 0x1249249249249249ull;
+  return x;
+}
+
+//! Quantize a coordinate onto the 2^MORTON_BITS cells spanning its bounds
+//
+//! \param x The coordinate
+//! \param lower Lower bound of the coordinate
+//! \param inv_width Number of cells per unit length
+//! \return The index of the cell containing x
+inline uint64_t morton_cell(double x, double lower, double inv_width)
+{
+  constexpr double max_cell = (uint64_t {1} << MORTON_BITS) - 1;
+  double cell = (x - lower) * inv_width;
+  cell = cell < 0.0 ? 0.0 : (cell > max_cell ? max_cell : cell);
+  return static_cast<uint64_t>(cell);
+}
+
+//! Interleave the quantized coordinates of a position into a Morton key, so
+//! that positions close along the Z-order curve have close keys
+//
+//! \param x, y, z The position
+//! \param lower Lower corner of the bounds of all positions being sorted
+//! \param inv_width Number of cells per unit length in each direction
+//! \return The Morton key
+inline uint64_t position_key(double x, double y, double z,
+  const double* lower, const double* inv_width)
+{
+  return spread_bits(morton_cell(x, lower[0], inv_width[0])) |
+    spread_bits(morton_cell(y, lower[1], inv_width[1])) << 1 |
+    spread_bits(morton_cell(z, lower[2], inv_width[2])) << 2;
+}
+#pragma omp end declare target
+
+//==============================================================================
+// Structs
+//==============================================================================
+
+// A packed sort key paired with the position of its item in the unsorted
+// queue. Sorting these rather than full EventQueueItem objects moves 12 bytes
+// per item instead of 20, after which the queue is permuted with one gather.
+struct SortKeyIndex {
+  uint64_t key;
+  uint32_t idx;
+};
+
+struct SortKeyIndexCmp {
+  bool operator()(const SortKeyIndex& a, const SortKeyIndex& b)
+  {
+    return a.key < b.key;
+  }
+};
+
+struct SortKeyIndexCmpG {
+  bool operator()(const SortKeyIndex& a, const SortKeyIndex& b)
+  {
+    return a.key > b.key;
+  }
+};
+
+//==============================================================================
+// Functions
+//==============================================================================
+
+//! Sort a queue on device with a stable least significant digit radix sort
+//! written purely in terms of OpenMP offloading, so that device-side sorting
+//! is available on every backend without vendor sorting libraries. Passes
+//! over key digits that are identical for all items (e.g., the material digits
+//! of the fuel XS queue) are skipped. If settings::sort_key_index is set, only
+//! keys and indices are sorted and the queue is gathered once at the end.
+//
+//! \param queue The queue to sort. Its contents must be resident on device.
+//! \param sort_by Which ordering to sort the queue into
+void device_radix_sort(SharedArray<EventQueueItem>& queue, SortBy sort_by);
+
+//! Sort device-resident keys, recording the permutation that sorts them
+//
+//! \param keys Host pointer to n mapped keys, which are sorted on return
+//! \param perm Host pointer to n mapped indices. On return, position i of
+//!   the sorted order holds the key that was previously at position perm[i].
+//! \param n The number of keys
+void device_sort_keys(uint64_t* keys, uint32_t* perm, int n);
+
+//! Sort a queue on host by transferring only its keys and indices, then
+//! gather the device-resident queue into sorted order
+//
+//! \param queue The queue to sort. Its contents must be resident on device.
+//! \param sort_by Which ordering to sort the queue into
+void host_key_index_sort(SharedArray<EventQueueItem>& queue, SortBy sort_by);
+
+//! Reorder a device-resident queue into bucket order with a single counting
+//! sort scatter pass. Items are not ordered within a bucket.
+//
+//! \param queue The queue to reorder
+//! \param type Which XS lookup queue is being reordered, passed to xs_bucket()
+//! \param counts Host pointer to the mapped population of each of the queue's
+//!   buckets. On return, all counts are reset to zero.
+//! \param first_bucket Index in simulation::xs_bucket_counts of counts[0]
+//! \param n_buckets The number of buckets
+void device_bucket_scatter(SharedArray<EventQueueItem>& queue, EventType type,
+  int* counts, int first_bucket, int n_buckets);
+
+//! Stably reorder a device-resident queue so that items of each class (see
+//! partition_class()) are contiguous and in their prior relative order
+//
+//! \param queue The queue to reorder
+//! \param partition_by Which classes to partition the queue into, e.g., XS
+//!   lookup classes for an XS lookup queue
+//! \param n_classes The number of classes
+//! \param class_offsets Host array of n_classes + 1 elements. On return, the
+//!   items of class c occupy [class_offsets[c], class_offsets[c + 1]).
+void device_partition_by_class(SharedArray<EventQueueItem>& queue,
+  PartitionBy partition_by, int n_classes, int* class_offsets);
+
+//! Count the adjacent pairs of a device-resident queue that are out of order
+//
+//! \param queue The queue to check
+//! \param sort_by The ordering to check against
+//! \return The number of positions i for which item i-1 sorts after item i
+int count_unsorted(SharedArray<EventQueueItem>& queue, SortBy sort_by);
+
+//! Compute an in-place exclusive prefix sum of a device-resident array
+//
+//! \param data Host pointer to an array mapped on device
+//! \param n The number of elements in the array
+//! \param chunk_sums Host pointer to a mapped scratch array with at least
+//!   ceil(n / SCAN_CHUNK) elements
+void device_exclusive_scan(int* data, int n, int* chunk_sums);
+void device_exclusive_scan(int64_t* data, int64_t n, int64_t* chunk_sums);
+
+//! Release any device scratch memory held by the radix sort
+void free_device_sort_scratch();
+
+} // namespace openmc
+
+#endif // OPENMC_DEVICE_SORT_H
@@ -16,6 +16,17 @@
 
 namespace openmc {
 
+enum class DistType {
+  DISCRETE,
+  UNIFORM,
+  MAXWELL,
+  WATT,
+  NORMAL,
+  MUIR,
+  TABULAR,
+  EQUIPROBABLE
+};
+
 //==============================================================================
 //! Abstract class representing a univariate probability distribution
 //==============================================================================
@@ -24,6 +35,26 @@ class Distribution {
 public:
   virtual ~Distribution() = default;
   virtual double sample(uint64_t* seed) const = 0;
+
+  //! Write the type of the distribution followed by its parameters, to be
+  //! sampled by DistributionFlat
+  virtual void serialize_tagged(DataBuffer& buffer) const = 0;
+};
+
+//==============================================================================
+//! Univariate distribution written by Distribution::serialize_tagged()
+//==============================================================================
+
+class DistributionFlat {
+public:
+  #pragma omp declare target
+  explicit DistributionFlat(const uint8_t* data);
+
+  double sample(uint64_t* seed) const;
+  #pragma omp end declare target
+private:
+  DistType type_;
+  const uint8_t* data_;
 };
 
 //==============================================================================
@@ -40,6 +71,8 @@ public:
   //! \return Sampled value
   double sample(uint64_t* seed) const;
 
+  void serialize_tagged(DataBuffer& buffer) const;
+
   // Properties
   const std::vector<double>& x() const { return x_; }
   const std::vector<double>& p() const { return p_; }
@@ -65,6 +98,8 @@ public:
   //! \return Sampled value
   double sample(uint64_t* seed) const;
 
+  void serialize_tagged(DataBuffer& buffer) const;
+
   double a() const { return a_; }
   double b() const { return b_; }
 private:
@@ -86,6 +121,8 @@ public:
   //! \return Sampled value
   double sample(uint64_t* seed) const;
 
+  void serialize_tagged(DataBuffer& buffer) const;
+
   double theta() const { return theta_; }
 private:
   double theta_; //!< Factor in exponential [eV]
@@ -105,6 +142,8 @@ public:
   //! \return Sampled value
   double sample(uint64_t* seed) const;
 
+  void serialize_tagged(DataBuffer& buffer) const;
+
   double a() const { return a_; }
   double b() const { return b_; }
 private:
@@ -126,6 +165,8 @@ public:
   //! \return Sampled value
   double sample(uint64_t* seed) const;
 
+  void serialize_tagged(DataBuffer& buffer) const;
+
   double mean_value() const { return mean_value_; }
   double std_dev() const { return std_dev_; }
 private:
@@ -148,6 +189,8 @@ public:
   //! \return Sampled value
   double sample(uint64_t* seed) const;
 
+  void serialize_tagged(DataBuffer& buffer) const;
+
   double e0() const { return e0_; }
   double m_rat() const { return m_rat_; }
   double kt() const { return kt_; }
@@ -175,6 +218,8 @@ public:
   //! \return Sampled value
   double sample(uint64_t* seed) const;
 
+  void serialize_tagged(DataBuffer& buffer) const;
+
   void serialize(DataBuffer& buffer) const;
 
   // x property
@@ -227,6 +272,8 @@ public:
   //! \return Sampled value
   double sample(uint64_t* seed) const;
 
+  void serialize_tagged(DataBuffer& buffer) const;
+
   const std::vector<double>& x() const { return x_; }
 private:
   std::vector<double> x_; //! Possible outcomes
@@ -240,6 +287,11 @@ using UPtrDist = std::unique_ptr<Distribution>;
 //! \return Unique pointer to distribution
 UPtrDist distribution_from_xml(pugi::xml_node node);
 
+//! Number of bytes Distribution::serialize_tagged() writes
+//! \param[in] dist Distribution
+//! \return Number of bytes
+size_t tagged_nbytes(const Distribution& dist);
+
 } // namespace openmc
 
 #endif // OPENMC_DISTRIBUTION_H
@@ -13,16 +13,21 @@
 #include "openmc/constants.h"
 #include "openmc/endf.h"
 #include "openmc/serialize.h"
+#include "openmc/vector.h"
 
 namespace openmc {
 
+class XsCacheReader;
+class XsCacheWriter;
+
 enum class EnergyDistType {
   DISCRETE_PHOTON,
   LEVEL_INELASTIC,
   CONTINUOUS_TABULAR,
   EVAPORATION,
   MAXWELL,
-  WATT
+  WATT,
+  CONTINUOUS_TABULAR_TABLE //!< Handle of a ContinuousTabular decoded into data::ct_tables
 };
 
 class EnergyDistributionFlat {
@@ -137,6 +142,8 @@ public:
 
   void serialize(DataBuffer& buffer) const;
 private:
+  friend class ContinuousTabularTables;
+
   //! Outgoing energy for a single incoming energy
   struct CTTable {
     Interpolation interpolation; //!< Interpolation law
@@ -151,6 +158,7 @@ private:
   std::vector<Interpolation> interpolation_; //!< Interpolation laws
   std::vector<double> energy_; //!< Incident energy in [eV]
   std::vector<CTTable> distribution_; //!< Distributions for each incident energy
+  int handle_ {C_NONE}; //!< Index in data::ct_tables, if decoded into it
 };
 
 class CTTableFlat {
@@ -198,6 +206,63 @@ private:
   size_t n_energy_;
 };
 
+//===============================================================================
+//! Every ContinuousTabular distribution decoded at load time into arrays
+//! indexed by distribution, by incident energy table and by outgoing energy
+//! point, so that sampling one from its handle reads no serialized offsets (see
+//! settings::decoded_distributions)
+//===============================================================================
+
+class ContinuousTabularTables {
+public:
+  //! Decode a distribution
+  //! \param[in] dist The distribution
+  //! \return Handle of the distribution
+  int add(const ContinuousTabular& dist);
+
+  //! Sample the outgoing energy of a distribution exactly like
+  //! ContinuousTabularFlat::sample()
+  //! \param[in] handle Handle of the distribution
+  //! \param[in] E Incident particle energy in [eV]
+  //! \param[inout] seed Pseudorandom number seed pointer
+  //! \return Sampled energy in [eV]
+  #pragma omp declare target
+  double sample(int handle, double E, uint64_t* seed) const;
+  #pragma omp end declare target
+
+  void copy_to_device();
+  void release_device();
+  void clear();
+
+  //! Write the tables to, or replace them with those of, a compiled library
+  void write_cache(XsCacheWriter& cache) const;
+  void read_cache(XsCacheReader& cache);
+
+  bool empty() const { return histogram_.size() == 0; }
+
+  //! Number of bytes the tables occupy
+  size_t nbytes() const;
+
+private:
+  // Per distribution
+  vector<int> energy_start_; //!< First incident energy, with a final end entry
+  vector<uint8_t> histogram_; //!< Histogram interpolation between incident energies
+
+  // Per incident energy
+  vector<double> energy_;  //!< Incident energies in [eV]
+  vector<int> eout_start_; //!< First outgoing energy point of the table
+  vector<int> n_eout_;     //!< Number of outgoing energy points
+  vector<int> n_discrete_; //!< Number of discrete lines
+  vector<Interpolation> interpolation_; //!< Interpolation law of the table
+  vector<double> e_first_; //!< First continuous outgoing energy in [eV]
+  vector<double> e_last_;  //!< Last continuous outgoing energy in [eV]
+
+  // Per outgoing energy point
+  vector<double> e_out_; //!< Outgoing energies in [eV]
+  vector<double> p_;     //!< Probability density
+  vector<double> c_;     //!< Cumulative distribution
+};
+
 //===============================================================================
 //! Evaporation spectrum corresponding to ACE law 9 and ENDF File 5, LF=9.
 //===============================================================================
@@ -301,6 +366,18 @@ private:
   const uint8_t* data_;
 };
 
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace data {
+
+#pragma omp declare target
+extern ContinuousTabularTables ct_tables;
+#pragma omp end declare target
+
+} // namespace data
+
 } // namespace openmc
 
 #endif // OPENMC_DISTRIBUTION_ENERGY_H
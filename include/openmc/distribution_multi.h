@@ -10,6 +10,12 @@
 
 namespace openmc {
 
+enum class UnitSphereDistType {
+  POLAR_AZIMUTHAL,
+  ISOTROPIC,
+  MONODIRECTIONAL
+};
+
 //==============================================================================
 //! Probability density function for points on the unit sphere. Extensions of
 //! this type are used to sample angular distributions for starting sources
@@ -27,6 +33,9 @@ public:
   //! \return Direction sampled
   virtual Direction sample(uint64_t* seed) const = 0;
 
+  //! Write the distribution, to be sampled by UnitSphereDistributionFlat
+  virtual void serialize(DataBuffer& buffer) const = 0;
+
   Direction u_ref_ {0.0, 0.0, 1.0};  //!< reference direction
 };
 
@@ -44,6 +53,8 @@ public:
   //! \return Direction sampled
   Direction sample(uint64_t* seed) const;
 
+  void serialize(DataBuffer& buffer) const;
+
   // Observing pointers
   Distribution* mu() const { return mu_.get(); }
   Distribution* phi() const { return phi_.get(); }
@@ -65,6 +76,8 @@ public:
   //! \param seed Pseudorandom number seed pointer
   //! \return Sampled direction
   Direction sample(uint64_t* seed) const;
+
+  void serialize(DataBuffer& buffer) const;
 };
 
 //==============================================================================
@@ -80,6 +93,25 @@ public:
   //! \param seed Pseudorandom number seed pointer
   //! \return Sampled direction
   Direction sample(uint64_t* seed) const;
+
+  void serialize(DataBuffer& buffer) const;
+};
+
+//==============================================================================
+//! Distribution on the unit sphere written by
+//! UnitSphereDistribution::serialize()
+//==============================================================================
+
+class UnitSphereDistributionFlat {
+public:
+  #pragma omp declare target
+  explicit UnitSphereDistributionFlat(const uint8_t* data);
+
+  Direction sample(uint64_t* seed) const;
+  #pragma omp end declare target
+private:
+  UnitSphereDistType type_;
+  const uint8_t* data_;
 };
 
 using UPtrAngle = std::unique_ptr<UnitSphereDistribution>;
@@ -8,6 +8,14 @@
 
 namespace openmc {
 
+enum class SpatialDistType {
+  CARTESIAN,
+  CYLINDRICAL,
+  SPHERICAL,
+  BOX,
+  POINT
+};
+
 //==============================================================================
 //! Probability density function for points in Euclidean space
 //==============================================================================
@@ -18,6 +26,28 @@ public:
 
   //! Sample a position from the distribution
   virtual Position sample(uint64_t* seed) const = 0;
+
+  //! Write the distribution, to be sampled by SpatialDistributionFlat
+  virtual void serialize(DataBuffer& buffer) const = 0;
+};
+
+//==============================================================================
+//! Spatial distribution written by SpatialDistribution::serialize()
+//==============================================================================
+
+class SpatialDistributionFlat {
+public:
+  #pragma omp declare target
+  explicit SpatialDistributionFlat(const uint8_t* data);
+
+  Position sample(uint64_t* seed) const;
+
+  //! Whether only sites in fissionable materials are accepted
+  bool only_fissionable() const;
+  #pragma omp end declare target
+private:
+  SpatialDistType type_;
+  const uint8_t* data_;
 };
 
 //==============================================================================
@@ -33,6 +63,8 @@ public:
   //! \return Sampled position
   Position sample(uint64_t* seed) const;
 
+  void serialize(DataBuffer& buffer) const;
+
   // Observer pointers
   Distribution* x() const { return x_.get(); }
   Distribution* y() const { return y_.get(); }
@@ -55,6 +87,8 @@ public:
   //! \param seed Pseudorandom number seed pointer
   //! \return Sampled position
   Position sample(uint64_t* seed) const;
+
+  void serialize(DataBuffer& buffer) const;
   
   Distribution* r() const { return r_.get(); }
   Distribution* phi() const { return phi_.get(); }
@@ -81,6 +115,8 @@ public:
   //! \return Sampled position
   Position sample(uint64_t* seed) const;
 
+  void serialize(DataBuffer& buffer) const;
+
   Distribution* r() const { return r_.get(); }
   Distribution* theta() const { return theta_.get(); }
   Distribution* phi() const { return phi_.get(); }
@@ -105,6 +141,8 @@ public:
   //! \return Sampled position
   Position sample(uint64_t* seed) const;
 
+  void serialize(DataBuffer& buffer) const;
+
   // Properties
   bool only_fissionable() const { return only_fissionable_; }
   Position lower_left() const { return lower_left_; }
@@ -130,6 +168,8 @@ public:
   //! \return Sampled position
   Position sample(uint64_t* seed) const;
 
+  void serialize(DataBuffer& buffer) const;
+
   Position r() const { return r_; }
 private:
   Position r_; //!< Single position at which sites are generated
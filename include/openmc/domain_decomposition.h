@@ -0,0 +1,94 @@
+//! \file domain_decomposition.h
+//! \brief Spatial domains owned by each process, and the exchange of the
+//! particles that cross from one domain into another during event-based
+//! transport
+
+#ifndef OPENMC_DOMAIN_DECOMPOSITION_H
+#define OPENMC_DOMAIN_DECOMPOSITION_H
+
+#include <cstdint>
+
+#include "openmc/particle.h"
+#include "openmc/random_lcg.h"
+#include "openmc/settings.h"
+#include "openmc/shared_array.h"
+
+namespace openmc {
+
+//==============================================================================
+// Structs
+//==============================================================================
+
+//! State of a particle handed over to the process owning the domain it crossed
+//! into, from which its history is continued there
+struct DomainSite {
+  Particle::Bank site;       //!< Position, direction, energy, weight and type
+  uint64_t seeds[N_STREAMS]; //!< Random number seeds
+  int64_t id;                //!< Particle ID
+  int surface;               //!< Surface the particle is on
+  int n_collision;           //!< Number of collisions so far
+  int n_event;               //!< Number of events so far
+  int cell_born;             //!< Cell the particle was born in
+  int domain;                //!< Process owning the domain crossed into
+};
+
+//==============================================================================
+// Global variable declarations
+//==============================================================================
+
+namespace simulation {
+
+#pragma omp declare target
+extern int n_domain_bins; //!< Bins of the domain mesh, divided evenly over processes
+extern SharedArray<DomainSite> domain_outbox; //!< Particles leaving this domain
+extern SharedArray<DomainSite> domain_inbox;  //!< Particles about to be started
+#pragma omp end declare target
+
+} // namespace simulation
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Whether particles are handed over between the domains of the processes,
+//! i.e. settings::domain_mesh is set and there is more than one process
+inline bool domain_decomposed() { return settings::domain_mesh >= 0; }
+
+//! Check the settings that event-based domain decomposition relies on and
+//! allocate the buffers of particles exchanged between domains
+//
+//! \param[in] capacity Number of particles in the particle buffer
+void init_domain_decomposition(int capacity);
+
+//! Free the buffers of particles exchanged between domains
+void free_domain_decomposition();
+
+#pragma omp declare target
+//! Hand a particle over to the process owning the domain it is in, if that is
+//! another process. The particle is killed here once it is queued to be sent;
+//! when the send queue is full, it carries on being transported here.
+//
+//! \param[in] p The particle, which has just crossed a surface
+//! \return Whether the particle was handed over
+bool send_to_domain(Particle& p);
+
+//! Continue the history of a particle handed over from another domain
+//
+//! \param[out] p The particle buffer entry to continue it in
+//! \param[in] site The state of the particle
+void receive_from_domain(Particle& p, const DomainSite& site);
+#pragma omp end declare target
+
+//! Copy the next particles handed over from other domains to device, into
+//! simulation::domain_inbox. Once every particle received has been started,
+//! the particles sent by all processes are exchanged, as many times as it takes
+//! for one to be received or for no process to send any more. Must be called
+//! on every process once its own particles have all finished.
+//
+//! \return Number of particles copied, or zero once no particles remain in
+//!   flight on any process
+int receive_domain_particles();
+
+} // namespace openmc
+
+#endif // OPENMC_DOMAIN_DECOMPOSITION_H
@@ -26,6 +26,8 @@ extern double keff_generation; //!<  Single-generation k on each processor
 extern std::array<double, 2> k_sum; //!< Used to reduce sum and sum_sq
 extern std::vector<double> entropy; //!< Shannon entropy at each generation
 extern xt::xtensor<double, 1> source_frac; //!< Source fraction for UFS
+extern std::vector<double> fission_matrix; //!< Fission sites born in each mesh bin (row) by source sites started in each mesh bin (column)
+extern std::vector<double> fission_matrix_source; //!< Source weight started in each mesh bin
 
 } // namespace simulation
 
@@ -58,8 +60,39 @@ void calculate_average_keff();
 extern "C" int openmc_get_keff(double* k_combined);
 
 //! Sample/redistribute source sites from accumulated fission sites
+//!
+//! With settings::async_bank_exchange, the sites sent by other processes may
+//! still be arriving when this returns.
 void synchronize_bank();
 
+//! Whether the current generation ends without exchanging sites between
+//! processes, which with settings::local_generations is every generation of a
+//! batch but the last
+bool local_generation();
+
+//! Sample the source sites of this process from its own fission bank, keeping
+//! its share of n_particles. Used in place of synchronize_bank() for local
+//! generations.
+void synchronize_bank_local();
+
+//! Whether sites of the source bank have yet to be copied to device
+bool bank_exchange_pending();
+
+//! Copy to device the sites of the source bank that transport may start:
+//! all of them, or, while a bank exchange is in progress, those kept by this
+//! process and those that have arrived. Used with settings::async_bank_exchange
+//! in place of copying the whole source bank.
+void start_source_transfer();
+
+//! Copy to device the sites of the source bank that have arrived since the
+//! last call
+//
+//! \param[in] wait Whether to block until at least one more message completes
+void poll_bank_exchange(bool wait);
+
+//! Complete the sends of a bank exchange once transport has started every site
+void finish_bank_exchange();
+
 //! Calculates the Shannon entropy of the fission source distribution to assess
 //! source convergence
 void shannon_entropy();
@@ -69,6 +102,16 @@ void shannon_entropy();
 //! 'source_frac' variable is used later to bias the production of fission sites
 void ufs_count_sites();
 
+//! Adds the fission sites of this generation to the fission matrix, binned by
+//! the mesh bin of each site and of the source site of its history. Called
+//! before the fission bank is redistributed.
+void tally_fission_matrix();
+
+//! Reweights the source bank so that the weight in each mesh bin follows the
+//! fundamental mode of the fission matrix, in the same way as
+//! openmc_cmfd_reweight() follows the CMFD source
+void fission_matrix_reweight();
+
 //! Get UFS weight corresponding to particle's location
 double ufs_get_weight(const Particle& p);
 
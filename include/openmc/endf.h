@@ -127,9 +127,15 @@ private:
   gsl::span<const int> nbt() const;
   Interpolation interp(gsl::index i) const;
 
+  #pragma omp declare target
+  //! Index of the abscissa interval containing x, which lies within the table
+  gsl::index find(double x) const;
+  #pragma omp end declare target
+
   const uint8_t* data_;
   size_t n_regions_;
   size_t n_pairs_;
+  size_t n_hash_; //!< number of logarithmic hash bins, or zero if unhashed
 };
 
 //==============================================================================
@@ -19,21 +19,29 @@ enum class FunctionType {
 class Function1DFlat {
 public:
   // Constructors
-  explicit Function1DFlat(const uint8_t* data) : data_(data) { }
+  explicit Function1DFlat(const uint8_t* data)
+    : data_(data), type_(static_cast<FunctionType>(
+        *reinterpret_cast<const int*>(data))) { }
+  //! Wrap a function whose type has already been read from its data
+  Function1DFlat(const uint8_t* data, FunctionType type)
+    : data_(data), type_(type) { }
 
   #pragma omp declare target
   double operator()(double x) const;
   #pragma omp end declare target
 
-  FunctionType type() const;
+  FunctionType type() const { return type_; }
 private:
   // Data members
   const uint8_t* data_;
+  FunctionType type_;
 };
 
 class Function1DFlatContainer {
 public:
   explicit Function1DFlatContainer(const Function1D& func);
+  //! Copy a function serialized earlier
+  Function1DFlatContainer(const uint8_t* data, size_t n);
 
   #pragma omp declare target
   double operator()(double x) const;
@@ -43,11 +51,13 @@ public:
   void release_from_device();
 
   const uint8_t* data() const { return buffer_.data_; }
-  FunctionType type() const { return this->func().type(); }
-  Function1DFlat func() const { return Function1DFlat(buffer_.data_); }
+  size_t size() const { return buffer_.size(); }
+  FunctionType type() const { return type_; }
+  Function1DFlat func() const { return Function1DFlat(buffer_.data_, type_); }
 
 private:
   DataBuffer buffer_;
+  FunctionType type_; //!< type read once the function is flattened
 };
 
 } // namespace openmc
@@ -4,7 +4,11 @@
 //! \file event.h
 //! \brief Event-based data structures and methods
 
+#include <cstddef> // for size_t
+#include <cstdint>
+
 #include "openmc/shared_array.h"
+#include "openmc/vector.h"
 
 namespace openmc {
 
@@ -36,8 +40,39 @@ struct EventQueueItem{
     idx(buffer_idx), material(mat), E(static_cast<float>(energy)), cell_id(cell_id), surface_id(surface_id) {}
 };
 
-// Enumeration used for specifying which way you want to sort a queue
-enum class SortBy { material_energy, cell_surface };
+// Destination queue of a particle as decided by an event kernel. When queues
+// are built by aggregated appends, event kernels record these instead of
+// appending to the destination queues themselves, and a separate pass then
+// appends each team's particles with one atomic operation per queue.
+struct EventDispatch {
+  int idx;   //!< particle index in event-based particle buffer
+  int queue; //!< destination EventType as an integer, or -1 for none
+};
+
+// Enumeration used for specifying which way you want to sort a queue. Queues
+// sorted by position are ordered along a Morton (Z-order) curve through the
+// positions of their particles.
+enum class SortBy { material_energy, cell_surface, position };
+
+// Enumeration of the classes that queues can be partitioned into
+enum class PartitionBy { xs_lookup_class, collision_class };
+
+// Enumeration of the event kernels that the event-based transport loop can
+// select between
+enum class EventType {
+  calculate_xs_fuel,
+  calculate_xs_nonfuel,
+  advance,
+  surface_crossing,
+  collision,
+  revival
+};
+
+constexpr int N_EVENT_TYPES {6};
+
+// Queue items ahead of the current one whose nuclide data the host XS lookup
+// kernel prefetches (see settings::cpu_event_kernels)
+constexpr int XS_PREFETCH_DISTANCE {8};
 
 // Comparators for sorting queues. The "G" variants are required
 // for the parallel qsort host implementation in addition to the regular
@@ -95,6 +130,66 @@ struct CellSurfCmpG {
   }
 };
 
+//==============================================================================
+// Class declarations
+//==============================================================================
+
+// Online model of the cost of launching each event kernel. Every launch of a
+// kernel on n queued particles is assumed to take t(n) = a + b*n seconds,
+// where a is the fixed launch/synchronization latency and b is the marginal
+// cost per particle. Both coefficients are fit by weighted least squares to
+// the launches observed so far. Observations are exponentially decayed at the
+// end of each generation so that the model follows changes in the particle
+// population (e.g., as the energy spectrum or tally set changes over batches).
+class EventCostModel {
+public:
+  //! Record the elapsed time of a single kernel launch
+  //
+  //! \param type The event kernel that was launched
+  //! \param n_items The number of queue items processed by the launch
+  //! \param time The elapsed time of the launch in [s]
+  void record(EventType type, int64_t n_items, double time);
+
+  //! Whether enough launches have been observed to trust the model
+  bool is_calibrated(EventType type) const;
+
+  //! Predicted time in [s] to launch a kernel on n_items queue items
+  double predicted_time(EventType type, int64_t n_items) const;
+
+  //! Predicted throughput in [items/s] of a launch on n_items queue items
+  double throughput(EventType type, int64_t n_items) const;
+
+  //! Queue size below which a launch spends more time in fixed latency than
+  //! in processing particles, i.e., a/b. Returns zero if not calibrated.
+  double latency_bound_size(EventType type) const;
+
+  //! Down-weight all previous observations by a constant factor
+  void decay(double factor);
+
+  //! Discard all observations
+  void reset();
+
+private:
+  //! Weighted sums needed for the least squares fit of t(n) = a + b*n
+  struct Stats {
+    double w {0.0};   //!< sum of weights
+    double n {0.0};   //!< sum of w*n
+    double t {0.0};   //!< sum of w*t
+    double nn {0.0};  //!< sum of w*n*n
+    double nt {0.0};  //!< sum of w*n*t
+    int count {0};    //!< number of launches observed
+  };
+
+  //! Fit t(n) = a + b*n for a given event
+  //
+  //! \param type The event kernel
+  //! \param a The fixed launch latency in [s]
+  //! \param b The cost per queue item in [s]
+  void coefficients(EventType type, double& a, double& b) const;
+
+  Stats stats_[N_EVENT_TYPES];
+};
+
 //==============================================================================
 // Global variable declarations
 //==============================================================================
@@ -116,10 +211,58 @@ extern SharedArray<EventQueueItem> surface_crossing_queue;
 extern SharedArray<EventQueueItem> collision_queue;
 extern SharedArray<EventQueueItem> revival_queue;
 
+// Per-kernel particle destinations used for aggregated queue appends
+extern SharedArray<EventDispatch> dispatch_scratch;
+
+// Number of items in each (material, log-energy) bucket of the XS lookup
+// queues when settings::bucket_xs_queues is set. The fuel queue is bucketed by
+// energy alone and owns the first n_log_bins entries; the non-fuel queue owns
+// n_log_bins entries per material after that.
+extern SharedArray<int> xs_bucket_counts;
+
+// XS lookup class of each material. Class 0 is shared by all materials
+// without a dedicated XS lookup kernel launch, while each of the
+// settings::n_material_xs_queues materials with the most nuclides is given a
+// class of its own.
+extern int* device_material_xs_class;
+
+// Multipole (scatter, absorption, fission) XS of each particle in the current
+// XS lookup batch for each nuclide in data::wmp_nuclides, laid out as
+// settings::wmp_batch_items rows of data::n_wmp_nuclides triples
+extern double* wmp_batch_xs;
+
+// Structure-of-arrays copies of the particle fields read by event kernels that
+// do not otherwise need the particle itself (aggregated queue appends, XS
+// lookup class partitioning, batched multipole evaluation, and weight
+// reductions), indexed by particle buffer slot. They are maintained only when
+// settings::particle_soa is set, in which case a particle's fields are
+// published whenever it is routed to its next queue. The Particle objects
+// remain authoritative; the accessors below pick either source.
+extern double* soa_E;      //!< Energy in [eV]
+extern double* soa_wgt;    //!< Weight
+extern double* soa_sqrtkT; //!< sqrt(kT) of the current cell in [eV]
+extern int* soa_material;  //!< Current material
+extern int* soa_cell;      //!< Cell at the lowest coordinate level
+extern int* soa_surface;   //!< Index of the nearest boundary surface
+
 extern int current_source_offset;
+extern int n_sources_ready;     //!< Number of sites of the source bank that may be started
+extern int* device_source_order; //!< Source bank indices in the order they may be started, with --async-bank
 #pragma omp end declare target
 
+extern vector<int> source_order; //!< Host copy of device_source_order
+
+extern bool wmp_batching; //!< Whether XS lookups use batched multipole evaluation
+
 extern int sort_counter;
+extern int sort_skip_counter; //!< Number of sorts skipped because the queue was nearly sorted
+
+extern int particle_extent; //!< Number of leading particle buffer slots that queued particles may occupy
+extern int compact_counter; //!< Number of particle buffer compactions
+
+extern vector<int> material_xs_class; //!< XS lookup class of each material (host copy)
+
+extern EventCostModel event_cost_model; //!< Kernel cost model used by the scheduler
 
 } // namespace simulation
 
@@ -127,6 +270,25 @@ extern int sort_counter;
 // Functions
 //==============================================================================
 
+//! Return the queue holding particles waiting on an event
+//
+//! \param type The event kernel
+//! \return A reference to the global queue for that event
+#pragma omp declare target
+SharedArray<EventQueueItem>& event_queue(EventType type);
+#pragma omp end declare target
+
+//! Synchronize the sizes of all event queues (and the source offset) from
+//! device to host in a single round trip. Before transferring, the queues that
+//! were just processed can be emptied on device and their particles credited
+//! to the advance queue, so that no separate host-to-device update is required.
+//
+//! \param processed The queues to empty on device, or nullptr for none
+//! \param n_to_advance Number of items appended in-place to the advance queue
+//! \param n_processed Number of queues in processed
+void sync_queue_sizes(const EventType* processed = nullptr,
+  int n_to_advance = 0, int n_processed = 1);
+
 //! Allocate space for the event queues and particle buffer
 //
 //! \param n_particles The number of particles in the particle buffer
@@ -135,15 +297,117 @@ void init_event_queues(int n_particles);
 //! Free the event queues and particle buffer
 void free_event_queues(void);
 
+//! Compute the device memory needed for each particle in the event-based
+//! particle buffer: the particle itself, its micro XS cache slot, its entry in
+//! each event queue, and its structure-of-arrays fields
+//
+//! \param verbose Whether to print the breakdown of the footprint
+//! \return The number of device bytes per in-flight particle
+size_t event_bytes_per_particle(bool verbose);
+
+#pragma omp declare target
+//! Prepare a particle for its XS event and determine which queue it belongs
+//! in based on if it is in fuel or a non-fuel material (or whether it can skip
+//! the lookup entirely)
+//
+//! \param buffer_idx The particle's actual index in the particle buffer
+//! \return The event the particle must be queued for
+EventType dispatch_xs_destination(int buffer_idx);
+
 //! Enqueue a particle based on if it is in fuel or a non-fuel material
 //
 //! \param buffer_idx The particle's actual index in the particle buffer
 void dispatch_xs_event(int buffer_idx);
 
+//! Determine the bin of the logarithmic energy grid of a neutron energy
+//
+//! \param E The energy in [eV]
+//! \return Index of the bin, clamped to the grid
+int energy_bin(double E);
+
+//! Determine the insertion bucket of an XS lookup queue item
+//
+//! \param item The queue item
+//! \param type Which XS lookup queue the item belongs to
+//! \return Index of the item's bucket in simulation::xs_bucket_counts
+int xs_bucket(const EventQueueItem& item, EventType type);
+
+//! Determine the XS lookup class of an XS lookup queue item, i.e., which
+//! kernel launch will perform its lookup
+//
+//! \param item The queue item
+//! \return The XS lookup class of the particle's material
+int xs_lookup_class(const EventQueueItem& item);
+
+//! Determine the collision class of a collision queue item, i.e., which
+//! kernel launch will finish its collision (see settings::split_collisions)
+//
+//! \param item The queue item
+//! \return The Particle::CollisionClass sampled for the particle
+int collision_class(const EventQueueItem& item);
+
+//! Determine the class of a queue item that a queue is partitioned by
+//
+//! \param item The queue item
+//! \param partition_by Which classes the queue is partitioned into
+int partition_class(const EventQueueItem& item, PartitionBy partition_by);
+
+//! Route a particle to a queue, either by appending to the queue directly or
+//! by recording its destination for a subsequent enqueue_aggregated() pass
+//
+//! \param i Index of the particle within the kernel's iteration space
+//! \param buffer_idx The particle's actual index in the particle buffer
+//! \param queue Destination EventType as an integer, or -1 for none
+//! \param aggregate Whether to defer the append to enqueue_aggregated()
+void dispatch_particle(int i, int buffer_idx, int queue, bool aggregate);
+
+//! Copy a particle's fields into the structure-of-arrays copies
+//
+//! \param buffer_idx The particle's actual index in the particle buffer
+void publish_particle_soa(int buffer_idx);
+
+// Accessors for the fields of the particle in a buffer slot, read from the
+// structure-of-arrays copies when settings::particle_soa is set
+double particle_E(int buffer_idx);
+double particle_wgt(int buffer_idx);
+double particle_sqrtkT(int buffer_idx);
+int particle_material(int buffer_idx);
+int particle_cell(int buffer_idx);
+int particle_surface(int buffer_idx);
+#pragma omp end declare target
+
+//! Put an XS lookup queue into bucket order, using the bucket populations
+//! counted as particles were enqueued, and reset the counts for the next
+//! iteration
+//
+//! \param type Which XS lookup queue to order
+void bucket_xs_queue(EventType type);
+
+//! Append the n_items particle destinations recorded in dispatch_scratch to
+//! their queues. Each team counts its particles per queue and reserves a
+//! contiguous block with one atomic per queue, so that contention on the
+//! global queue sizes is reduced by the team size.
+//
+//! \param n_items The number of recorded destinations
+void enqueue_aggregated(int n_items);
+
+//! Reduce the deferred tally score queue if it is more than half full, so
+//! that it can hold the scores of the next event
+void reduce_tally_scores_if_needed();
+
 //! Execute the initialization event for all particles
 //
 //! \param n_particles The number of particles in the particle buffer
-void process_init_events(int n_particles);
+//! \param first_source The number of source sites already started in this
+//!   generation
+void process_init_events(int n_particles, int first_source = 0);
+
+//! Start the particles handed over from other domains, held in
+//! simulation::domain_inbox, in the first entries of the particle buffer.
+//! Every particle in the buffer must have finished.
+//
+//! \param n_particles The number of particles to start
+void process_arrival_events(int n_particles);
 
 //! Execute the calculate XS event for all particles in this event's buffer
 //
@@ -152,8 +416,15 @@ void process_init_events(int n_particles);
 void process_calculate_xs_events_fuel();
 void process_calculate_xs_events_nonfuel();
 
+//! Execute the fuel and non-fuel calculate XS events concurrently
+void process_calculate_xs_events_concurrent();
+
 //! Execute the advance particle event for all particles in this event's buffer
 void process_advance_particle_events();
+
+//! Whether the XS of simulation::depletion_rx are looked up along with the
+//! macroscopic XS, i.e. whether reaction rates for depletion are tallied with
+//! an active tracklength tally
 bool depletion_rx_check();
 
 //! Execute the surface crossing event for all particles in this event's buffer
@@ -162,6 +433,11 @@ void process_surface_crossing_events();
 //! Execute the collision event for all particles in this event's buffer
 void process_collision_events();
 
+//! Execute the surface crossing and collision events concurrently. The two
+//! are independent within an iteration, as both only append to the XS lookup
+//! and revival queues.
+void process_surface_crossing_and_collision_events();
+
 //! Execute the death event for all particles
 //
 //! \param n_particles The number of particles in the particle buffer
@@ -170,6 +446,57 @@ void process_death_events(int n_particles);
 //! Execute the revival event for all particles in this event's buffer
 void process_revival_events();
 
+//! Finish the histories of all in-flight particles with a single
+//! history-based kernel. This is used at the end of a generation once no more
+//! source particles remain, where the event-based loop would otherwise launch
+//! a long tail of latency-bound kernels on very few particles.
+void process_tail_events();
+
+//! Determine whether the event-based loop should hand the remaining in-flight
+//! particles over to process_tail_events()
+//
+//! \return True if the tail phase should begin
+bool should_finish_tail();
+
+//! Determine whether the queued particles are spread thinly enough over the
+//! particle buffer (see settings::compact_threshold) for it to be compacted
+//
+//! \return True if compact_particle_buffer() should be called
+bool should_compact_particles();
+
+//! Move the queued particles into a dense prefix of the particle buffer in
+//! queue order, so that the queues, which are left in their current (e.g.,
+//! sorted) order, index consecutive slots. The finished particles displaced
+//! from the prefix are moved to the vacated slots rather than overwritten, as
+//! their keff tally accumulators are only added up by process_death_events().
+void compact_particle_buffer();
+
+//! Return the number of particles currently queued for an event
+//
+//! \param type The event kernel
+//! \return The size of the corresponding queue
+int64_t event_queue_size(EventType type);
+
+//! Return the cumulative time spent in an event kernel, including any time
+//! spent sorting its queue and scoring tallies from it
+//
+//! \param type The event kernel
+//! \return Elapsed time in [s]
+double event_time_elapsed(EventType type);
+
+//! Select the next event kernel to launch according to the scheduling policy
+//! given by settings::event_scheduler
+//
+//! \param iteration The number of events launched so far in this generation
+//! \param type The event kernel to launch next
+//! \return False if all queues are empty (i.e., the generation is complete)
+bool select_next_event(int64_t iteration, EventType& type);
+
+//! Launch an event kernel, recording its cost in the event cost model
+//
+//! \param type The event kernel to launch
+void process_event(EventType type);
+
 #ifdef CUDA_THRUST_SORT
 //! Sort a queue on-device using CUDA Thrust
 //
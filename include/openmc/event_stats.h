@@ -0,0 +1,83 @@
+//! \file event_stats.h
+//! \brief Counts of the events, kernel launches and sorts of each batch of
+//! event-based transport
+
+#ifndef OPENMC_EVENT_STATS_H
+#define OPENMC_EVENT_STATS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "openmc/event.h"
+
+namespace openmc {
+
+//==============================================================================
+//! Event counts of one batch, summed over processes
+//==============================================================================
+
+struct BatchEventStats {
+  int batch {0};
+  int64_t events[N_EVENT_TYPES] {};   //!< Queue items processed of each type
+  int64_t launches[N_EVENT_TYPES] {}; //!< Launches of each event kernel
+  int64_t kernel_launches {0};  //!< Event, initialization, death and tail launches
+  int64_t sorts {0};            //!< Queue sorts performed
+  int64_t sorted_items {0};     //!< Items in the queues sorted
+  int64_t sorts_skipped {0};    //!< Sorts skipped as nearly sorted
+  int64_t occupancy_samples {0}; //!< Event launches the occupancy was sampled at
+  double occupancy_sum {0.0};   //!< Sum of the fraction of the particle buffer in flight
+  double transport_seconds {0.0}; //!< Transport time of the slowest process
+
+  int64_t total_events() const;
+  double mean_occupancy() const;
+};
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+extern BatchEventStats batch_event_stats; //!< Counts of the current batch on this process
+extern std::vector<BatchEventStats> event_stats_history; //!< Counts of past batches (master only)
+
+} // namespace simulation
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Whether event counts are reported, i.e. settings::event_stats,
+//! settings::path_event_stats or settings::path_status is set in an
+//! event-based run
+bool reporting_event_stats();
+
+//! Count a launch of an event kernel, before it runs
+//
+//! \param[in] type Event launched
+//! \param[in] n_items Length of its queue
+void record_event_launch(EventType type, int64_t n_items);
+
+//! Count a launch of initialization, death or the history-based tail
+void record_kernel_launch();
+
+//! Count a queue sort
+//
+//! \param[in] n_items Length of the queue
+//! \param[in] skipped Whether the sort was skipped as nearly sorted
+void record_sort(int64_t n_items, bool skipped);
+
+//! Clear the counts at the start of a batch
+void begin_batch_event_stats();
+
+//! Sum the counts of the batch over processes and, on the master process,
+//! keep and print them
+void end_batch_event_stats();
+
+//! Write the counts of every batch to settings::path_event_stats as JSON on
+//! the master process
+void write_event_stats();
+
+} // namespace openmc
+
+#endif // OPENMC_EVENT_STATS_H
@@ -0,0 +1,78 @@
+//! \file event_trace.h
+//! \brief Recording of the event kernel launches of event-based transport and
+//! of the events of a sample of particles, so that sorting and scheduling
+//! policies can be evaluated offline by replaying them
+
+#ifndef OPENMC_EVENT_TRACE_H
+#define OPENMC_EVENT_TRACE_H
+
+#include <cstdint>
+
+#include "openmc/event.h"
+#include "openmc/shared_array.h"
+
+namespace openmc {
+
+//==============================================================================
+//! One event of a sampled particle. Records are appended on device by the
+//! launch that processes the event.
+//==============================================================================
+
+struct EventTraceRecord {
+  int64_t launch;   //!< Row of the launch in the launches dataset
+  int64_t particle; //!< ID of the particle
+  int event;        //!< EventType of the launch
+  int material;     //!< Material the particle is in
+  int cell;         //!< Index of the cell at the lowest coordinate level
+  int energy_bin;   //!< Bin of the logarithmic energy grid, see energy_bin()
+};
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+#pragma omp declare target
+extern SharedArray<EventTraceRecord> event_trace; //!< Sampled events not yet written
+#pragma omp end declare target
+
+} // namespace simulation
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Whether event tracing is on, i.e. settings::event_trace_stride is set
+bool tracing_events();
+
+//! Allocate the trace buffer on host and device and create the trace file of
+//! this process. Does nothing unless events are traced.
+//
+//! \param[in] capacity Length of the event queues. The buffer holds at least
+//!   as many records, so that the whole queue of a launch fits once it is
+//!   flushed.
+void init_event_trace(int64_t capacity);
+
+//! Record a kernel launch about to process the queue of an event, with the
+//! length of every queue, and the events of the sampled particles in it
+//
+//! \param type The event kernel about to be launched
+//! \return Row of the launch in the launches dataset
+int64_t trace_event_launch(EventType type);
+
+//! Record the elapsed time of a launch
+//
+//! \param launch Row of the launch returned by trace_event_launch()
+//! \param seconds Elapsed time of the launch in [s]
+void trace_event_time(int64_t launch, double seconds);
+
+//! Write the launches and sampled events recorded so far to the trace file
+void flush_event_trace();
+
+//! Write what remains of the trace, close the trace file and free the buffer
+void finalize_event_trace();
+
+} // namespace openmc
+
+#endif // OPENMC_EVENT_TRACE_H
@@ -0,0 +1,29 @@
+//! \file event_tuning.h
+//! \brief Search for the fastest event-based runtime parameters during the
+//! inactive batches
+
+#ifndef OPENMC_EVENT_TUNING_H
+#define OPENMC_EVENT_TUNING_H
+
+namespace openmc {
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Prepare the parameter search if settings::auto_tune is set. The particle
+//! buffer must already be allocated, since the number of particles in flight
+//! is only tuned below its length.
+void init_event_tuning();
+
+//! Mark the start of a batch for timing its transport
+void begin_batch_event_tuning();
+
+//! Time the transport of the batch and, while the search lasts, move on to the
+//! settings the next batch tries. Once no inactive batches or settings are
+//! left, the fastest settings are kept and reported on the master process.
+void end_batch_event_tuning();
+
+} // namespace openmc
+
+#endif // OPENMC_EVENT_TUNING_H
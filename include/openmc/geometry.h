@@ -55,6 +55,19 @@ bool exhaustive_find_cell(Particle& p);
 bool neighbor_list_find_cell(Particle& p); // Only usable on surface crossings
 #pragma omp end declare target
 
+//==============================================================================
+//! Locate a particle below a coordinate level whose cell is known to still
+//! contain it, e.g. after it moved without crossing that cell's boundaries.
+//!
+//! \param p A particle to be located.
+//! \param level The coordinate level whose cell is kept.
+//! \return True if the particle's location could be found.
+//==============================================================================
+
+#pragma omp declare target
+bool find_cell_below(Particle& p, int level);
+#pragma omp end declare target
+
 //==============================================================================
 //! Move a particle into a new lattice tile.
 //==============================================================================
@@ -65,10 +78,14 @@ void cross_lattice(Particle& p, const BoundaryInfo& boundary);
 
 //==============================================================================
 //! Find the next boundary a particle will intersect.
+//!
+//! \param n_coord If given, only the boundaries of the first n_coord
+//!   coordinate levels are considered.
 //==============================================================================
 
 #pragma omp declare target
 BoundaryInfo distance_to_boundary(Particle& p);
+BoundaryInfo distance_to_boundary(Particle& p, int n_coord);
 #pragma omp end declare target
 
 } // namespace openmc
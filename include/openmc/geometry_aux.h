@@ -16,8 +16,16 @@ namespace model {
   extern std::unordered_map<int32_t, int32_t> universe_level_counts;
 } // namespace model
 
+//! Read the geometry from geometry.xml or, in its absence, geometry.h5
 void read_geometry_xml();
 
+//==============================================================================
+//! Read the geometry from geometry.h5, the HDF5 model input that the Python
+//! API writes for models too large to parse as XML in reasonable time
+//==============================================================================
+
+void read_geometry_hdf5();
+
 //==============================================================================
 //! Replace Universe, Lattice, and Material IDs with indices.
 //==============================================================================
@@ -44,6 +52,14 @@ void assign_temperatures();
 void get_temperatures(std::vector<std::vector<double>>& nuc_temps,
   std::vector<std::vector<double>>& thermal_temps);
 
+//==============================================================================
+//! Merge duplicate surfaces, drop redundant half-spaces of simple cells and
+//! order their tokens by cost, reporting what was saved. Applied by
+//! finalize_geometry() when settings::optimize_geometry is set.
+//==============================================================================
+
+void optimize_geometry();
+
 //==============================================================================
 //! \brief Perform final setup for geometry
 //==============================================================================
@@ -5,6 +5,7 @@
 #include <array>
 #include <complex>
 #include <cstddef>
+#include <cstdint>
 #include <cstring> // for strlen
 #include <string>
 #include <sstream>
@@ -42,6 +43,13 @@ void write_dataset_lowlevel(hid_t group_id, int ndim, const hsize_t* dims,
 
 bool using_mpio_device(hid_t obj_id);
 
+//! Whether the HDF5 library may be called from several threads at once
+bool hdf5_thread_safe();
+
+//! Number of bytes the datasets in a group and its subgroups occupy in the
+//! file
+hsize_t storage_size(hid_t group_id);
+
 //==============================================================================
 // Normal functions that are used to read/write files
 //==============================================================================
@@ -121,6 +129,49 @@ extern "C" {
                            const double* results);
 } // extern "C"
 
+//! Dataset creation property list for a new dataset. When
+//! settings::hdf5_compression is set, datasets of at least
+//! HDF5_FILTER_MIN_BYTES are chunked along their first dimension and shuffled
+//! and deflated. Filters need collective writes with the MPI-IO driver.
+//! \param[in] group_id Group the dataset is created in
+//! \param[in] type_id Type of the dataset in the file
+//! \param[in] ndim Number of dimensions, zero for a scalar
+//! \param[in] dims Dimensions of the dataset
+//! \param[in] indep Whether the dataset is written with independent I/O
+//! \return H5P_DEFAULT or a property list the caller must close
+hid_t dataset_create_plist(hid_t group_id, hid_t type_id, int ndim,
+  const hsize_t* dims, bool indep);
+
+//! Write the sum and sum_sq of a contiguous range of the filter bins of a
+//! tally to its results dataset. With the MPI-IO driver every process calls
+//! this collectively with its own range.
+//! \param[in] group_id Group of the tally
+//! \param[in] n_filter Number of filter bins of the tally
+//! \param[in] n_score Number of score bins of the tally
+//! \param[in] offset Index of the first filter bin of the range
+//! \param[in] n_rows Number of filter bins in the range, possibly zero
+//! \param[in] slab Sum and sum_sq of the range, of shape (n_rows, n_score, 2)
+void write_tally_results_slab(hid_t group_id, hsize_t n_filter, hsize_t n_score,
+  hsize_t offset, hsize_t n_rows, const double* slab);
+
+//! Create an empty chunked dataset of rows that grows along its first
+//! dimension as rows are appended with append_dataset_rows()
+//! \param[in] group_id Group the dataset is created in
+//! \param[in] name Name of the dataset
+//! \param[in] type_id Type of the dataset, in memory and in the file
+//! \param[in] n_cols Number of values in each row
+void create_extendable_dataset(hid_t group_id, const char* name,
+  hid_t type_id, hsize_t n_cols);
+
+//! Append rows to the end of a dataset made by create_extendable_dataset()
+//! \param[in] group_id Group of the dataset
+//! \param[in] name Name of the dataset
+//! \param[in] type_id Type of the dataset
+//! \param[in] n_rows Number of rows to append
+//! \param[in] buffer Values of the rows, row by row
+void append_dataset_rows(hid_t group_id, const char* name, hid_t type_id,
+  hsize_t n_rows, const void* buffer);
+
 //==============================================================================
 // Template struct used to map types to HDF5 datatype IDs, which are stored
 // using the type hid_t. By having a single static data member, the template can
@@ -255,6 +306,28 @@ read_dataset(hid_t obj_id, const char* name, std::string& str, bool indep=false)
   str = std::string {buffer.begin(), buffer.end()};
 }
 
+// overload for a 1D dataset of fixed-length strings
+inline void
+read_dataset(hid_t obj_id, const char* name, std::vector<std::string>& vec,
+  bool indep=false)
+{
+  hid_t dset = open_dataset(obj_id, name);
+  auto m = object_shape(dset)[0];
+  close_dataset(dset);
+
+  // Allocate a C char array to get strings
+  auto n = dataset_typesize(obj_id, name);
+  std::vector<char> buffer(m*n);
+  read_string(obj_id, name, n, buffer.data(), indep);
+
+  for (decltype(m) i = 0; i < m; ++i) {
+    // Strings as long as the type have no null character
+    std::size_t k = 0;
+    for (; k < n; ++k) if (buffer[i*n + k] == '\0') break;
+    vec.emplace_back(&buffer[i*n], k);
+  }
+}
+
 // array version
 template<typename T, std::size_t N> inline void
 read_dataset(hid_t dset, const char* name, std::array<T, N>& buffer,
@@ -416,6 +489,33 @@ inline void read_nd_vector(hid_t obj_id, const char* name,
   }
 }
 
+//! A dataset with a varying number of values per row, stored as the values of
+//! all rows in one dataset and the offset of each row, followed by the total,
+//! in a second dataset named with an "_offsets" suffix
+template<typename T>
+struct RaggedDataset {
+  RaggedDataset(hid_t group_id, const std::string& name)
+  {
+    read_dataset(group_id, name.c_str(), values);
+    read_dataset(group_id, (name + "_offsets").c_str(), offsets);
+    if (offsets.empty() ||
+        offsets.back() != static_cast<int64_t>(values.size())) {
+      fatal_error("Offsets of dataset " + name + " do not match its values.");
+    }
+  }
+
+  //! Number of rows
+  int size() const { return offsets.size() - 1; }
+
+  std::vector<T> row(int i) const
+  {
+    return {values.begin() + offsets[i], values.begin() + offsets[i + 1]};
+  }
+
+  std::vector<T> values;
+  std::vector<int64_t> offsets;
+};
+
 //==============================================================================
 // Templates/overloads for write_attribute
 //==============================================================================
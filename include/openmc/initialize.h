@@ -8,6 +8,12 @@
 namespace openmc {
 
 int parse_command_line(int argc, char* argv[]);
+
+//! Set the device that this process offloads to from settings::device_id or,
+//! with settings::bind_devices, from the rank of the process on its node
+//
+//! \return Error code
+int bind_device();
 #ifdef OPENMC_MPI
 void initialize_mpi(MPI_Comm intracomm);
 #endif
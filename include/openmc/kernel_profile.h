@@ -0,0 +1,111 @@
+//! \file kernel_profile.h
+//! \brief Device time, launch counts, items processed and bytes transferred of
+//! the event kernels of event-based transport
+
+#ifndef OPENMC_KERNEL_PROFILE_H
+#define OPENMC_KERNEL_PROFILE_H
+
+#include <cstdint>
+
+#include "hdf5.h"
+
+#include "openmc/event.h"
+#include "openmc/timer.h"
+
+namespace openmc {
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Regions of device work that profiles are kept for: one per event kernel, in
+// the order of EventType, followed by these
+constexpr int PROFILE_INIT {N_EVENT_TYPES};      //!< Particle initialization
+constexpr int PROFILE_DEATH {N_EVENT_TYPES + 1}; //!< Particle death
+constexpr int PROFILE_TAIL {N_EVENT_TYPES + 2};  //!< History-based tail
+constexpr int PROFILE_OTHER {N_EVENT_TYPES + 3}; //!< Outside of any region
+constexpr int N_PROFILE_REGIONS {N_EVENT_TYPES + 4};
+
+//==============================================================================
+//! Accumulated work of one region
+//==============================================================================
+
+struct KernelProfile {
+  int64_t launches {0};          //!< Number of times the region was run
+  int64_t items {0};             //!< Queue items processed
+  int64_t kernels {0};           //!< Target regions launched (OMPT only)
+  double device_seconds {0.0};   //!< Kernel execution time in [s]
+  int64_t bytes_to_device {0};   //!< Bytes copied to device (OMPT only)
+  int64_t bytes_from_device {0}; //!< Bytes copied from device (OMPT only)
+};
+
+//==============================================================================
+//! Attributes the device work launched during its lifetime to a region. When
+//! built without OMPT support, the host time of its lifetime is taken as the
+//! device time, which is only meaningful because the event functions wait on
+//! their kernels before returning.
+//==============================================================================
+
+class ProfileRegion {
+public:
+  //! \param region Index of the region
+  //! \param n_items Number of queue items the region processes
+  ProfileRegion(int region, int64_t n_items);
+  ~ProfileRegion();
+
+  ProfileRegion(const ProfileRegion&) = delete;
+  ProfileRegion& operator=(const ProfileRegion&) = delete;
+
+private:
+  int region_;   //!< Region entered, or -1 if profiling is off
+  int previous_; //!< Region to restore on exit
+  Timer timer_;
+};
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+extern KernelProfile kernel_profiles[N_PROFILE_REGIONS]; //!< Profiles of this process
+
+} // namespace simulation
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Name of a region, e.g. "advance"
+const char* profile_region_name(int region);
+
+//! Whether device times are measured by OMPT device tracing rather than host
+//! timers
+bool profile_uses_ompt();
+
+//! Count a launch of a region without entering it, for an event kernel run
+//! together with another one (whose region is charged the device work)
+void count_profile_launch(int region, int64_t n_items);
+
+//! Begin recording profiles if settings::kernel_profile is set
+void start_kernel_profile();
+
+//! Deliver the device times still buffered by the OpenMP runtime so that
+//! simulation::kernel_profiles is complete
+void flush_kernel_profile();
+
+//! Stop recording profiles
+void stop_kernel_profile();
+
+//! Discard all recorded profiles
+void reset_kernel_profiles();
+
+//! Print the profiles of this process
+void print_kernel_profile();
+
+//! Write the profiles of this process to a group of a statepoint file
+void write_kernel_profile(hid_t group);
+
+} // namespace openmc
+
+#endif // OPENMC_KERNEL_PROFILE_H
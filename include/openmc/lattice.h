@@ -119,6 +119,25 @@ public:
   RectLattice_distance(Position r, Direction u, const std::array<int, 3>& i_xyz) const;
   std::pair<double, std::array<int, 3>>
   HexLattice_distance(Position r, Direction u, const std::array<int, 3>& i_xyz) const;
+  //! Original hexagonal lattice distance, which finds the position relative to
+  //! each neighboring tile through get_local_position(). Kept as a reference
+  //! for hex_lattice_benchmark.
+  std::pair<double, std::array<int, 3>>
+  HexLattice_distance_neighbors(Position r, Direction u, const std::array<int, 3>& i_xyz) const;
+
+  //! \brief Find the next crossing into a tile of a rectangular lattice that
+  //!   is filled with another universe than the tile the particle is in
+  //!
+  //! The particle may have gone past the boundaries of its tile i_xyz, but only
+  //! into tiles filled with the same universe, which happens after this
+  //! distance has been used.
+  //! \param r A 3D Cartesian coordinate local to the tile i_xyz.
+  //! \param u A 3D Cartesian direction.
+  //! \param i_xyz The indices for the lattice tile the particle was located in.
+  //! \return The distance to the crossing and the change of the lattice
+  //!   indices from i_xyz after crossing that boundary.
+  std::pair<double, std::array<int, 3>>
+  RectLattice_run_distance(Position r, Direction u, const std::array<int, 3>& i_xyz) const;
   #pragma omp end declare target
 
   //! \brief Find the lattice tile indices for a given point.
@@ -128,6 +147,10 @@ public:
   std::array<int, 3> get_indices(Position r, Direction u) const;
   std::array<int, 3> RectLattice_get_indices(Position r, Direction u) const;
   std::array<int, 3> HexLattice_get_indices(Position r, Direction u) const;
+  //! Original hexagonal lattice indexing, which compares the distances to the
+  //! centers of four candidate tiles. Kept as a reference for
+  //! hex_lattice_benchmark.
+  std::array<int, 3> HexLattice_get_indices_candidates(Position r, Direction u) const;
   #pragma omp end declare target
 
   //! \brief Get coordinates local to a lattice tile.
@@ -1,6 +1,8 @@
 #ifndef OPENMC_MATERIAL_H
 #define OPENMC_MATERIAL_H
 
+#include <cmath>
+#include <cstdint>
 #include <memory> // for unique_ptr
 #include <string>
 #include <unordered_map>
@@ -41,10 +43,47 @@ extern vector2d<int> materials_nuclide;
 extern vector2d<int> materials_element;
 extern vector2d<double> materials_atom_density;
 extern vector2d<int> materials_p0;
-extern vector2d<int> materials_mat_nuclide_index;
+extern vector2d<int> materials_xs_features;
+extern vector2d<uint32_t> materials_nuclide_bitmap;
 extern vector2d<ThermalTable> materials_thermal_tables;
 #pragma omp end declare target
 
+//! Tabulated macroscopic (total, absorption) XS pairs of every material that
+//! has a table (see settings::material_xs_tables), on a log-uniform energy grid
+//! of settings::material_xs_table_points points per material
+extern vector<double> material_xs_table;
+//! For each table point, whether linear interpolation over the bin starting
+//! at that point reproduces a direct lookup to within the tolerance
+extern vector<uint8_t> material_xs_table_valid;
+#pragma omp declare target
+extern double* device_material_xs_table;
+extern uint8_t* device_material_xs_table_valid;
+extern int material_xs_table_size; //!< Total number of table points
+extern double material_xs_table_log_E_min; //!< Log of the grid's lowest energy
+extern double material_xs_table_inv_du; //!< Inverse of the grid's log spacing
+#pragma omp end declare target
+
+//! Upper bound on the total XS of the materials inside delta-tracking cells
+//! (see settings::delta_tracking) in each of settings::majorant_points
+//! log-uniform energy bins. Bins where no bound is known are zero.
+extern vector<double> majorant;
+#pragma omp declare target
+extern double* device_majorant;
+extern int majorant_size; //!< Number of majorant bins
+extern double majorant_log_E_min; //!< Log of the lowest majorant energy
+extern double majorant_inv_du; //!< Inverse of the majorant's log spacing
+#pragma omp end declare target
+
+//! Upper bound on the microscopic total XS, Doppler broadened by target motion
+//! sampling (see settings::temperature_tms), of each nuclide over each bin of
+//! the majorant, indexed by nuclide then bin. Bins where no bound is known
+//! are zero.
+extern vector<double> tms_majorant;
+#pragma omp declare target
+extern double* device_tms_majorant;
+extern int tms_majorant_bins; //!< Number of bins per nuclide, or 0 if off
+#pragma omp end declare target
+
 } // namespace model
 
 //==============================================================================
@@ -58,6 +97,30 @@ public:
   // Constructors, destructors, factory functions
   Material() {};
   explicit Material(pugi::xml_node material_node);
+
+  //! Construct a material from one row of an HDF5 model input
+  //
+  //! \param id Unique ID
+  //! \param name User-defined name
+  //! \param depletable Whether the material is depletable
+  //! \param units Units of the density, as in materials.xml
+  //! \param density Density in the given units
+  //! \param nuclides Names of the nuclides, or of the macroscopic data
+  //! \param fractions Atom (positive) or weight (negative) fraction of each
+  //!   nuclide
+  //! \param isotropic Nuclides scattering isotropically in the lab frame
+  //! \param sab_names Names of the thermal scattering tables
+  //! \param sab_fractions Fraction of nuclei each table applies to
+  //! \param temperature Default temperature in [K], or negative
+  //! \param volume Volume in [cm^3], or negative
+  Material(int32_t id, const std::string& name, bool depletable,
+    const std::string& units, double density,
+    const std::vector<std::string>& nuclides,
+    const std::vector<double>& fractions,
+    const std::vector<std::string>& isotropic,
+    const std::vector<std::string>& sab_names,
+    const std::vector<double>& sab_fractions, double temperature,
+    double volume);
   ~Material();
 
   //----------------------------------------------------------------------------
@@ -67,16 +130,55 @@ public:
   void calculate_xs(Particle& p, bool need_depletion_rx) const;
   #pragma omp end declare target
 
+  //! Prefetch on host the nuclide data that a neutron XS lookup at an energy
+  //! reads, in two stages: first the energy grid index entries of the
+  //! nuclides, then, once those are in cache, the energy grid points and XS
+  //! they point to. Only nuclides at a single temperature on the logarithmic
+  //! grid are prefetched, as the others search further for their data.
+  //! \param E Energy of the lookup in [eV]
+  //! \param grid Whether this is the second stage
+  void prefetch_xs(double E, bool grid) const;
+
+  //! Get the majorant of the material's total XS under target motion
+  //! sampling at an energy
+  //
+  //! \param E Energy in [eV]
+  //! \return Majorant XS in [1/cm], or zero if the material's XS at this
+  //!   energy are not Doppler broadened by target motion sampling
+  #pragma omp declare target
+  double tms_majorant_xs(double E) const;
+  #pragma omp end declare target
+
   //! Assign thermal scattering tables to specific nuclides within the material
   //! so the code knows when to apply bound thermal scattering data
   void init_thermal();
 
-  //! Set up mapping between global nuclides vector and indices in nuclide_
+  //! Set up the bitmap of the global nuclides the material contains
   void init_nuclide_index();
 
+  //! Classify each nuclide by the optional branches (XS_* in nuclide.h) its
+  //! microscopic lookups in this material can take. The nuclide data and
+  //! thermal tables must already be loaded.
+  void init_xs_features();
+
   //! Finalize the material, assigning tables, normalize density, etc.
   void finalize();
 
+  //! Determine whether the material's macroscopic XS are a deterministic
+  //! function of energy at a single temperature, so that they can be
+  //! tabulated before the simulation
+  //
+  //! \param[out] sqrtkT The temperature the material is seen at in
+  //!   sqrt(eV), if eligible
+  //! \return Whether the material is eligible for a macroscopic XS table
+  bool xs_table_eligible(double& sqrtkT) const;
+
+  //! Tabulate the material's macroscopic XS at a temperature, appending them
+  //! to model::material_xs_table
+  //
+  //! \param sqrtkT Temperature in sqrt(eV) to tabulate at
+  void init_xs_table(double sqrtkT);
+
   //! Write material data to HDF5
   void to_hdf5(hid_t group) const;
 
@@ -101,6 +203,13 @@ public:
   void set_densities(const std::vector<std::string>& name,
     const std::vector<double>& density);
 
+  //! Set atom densities for the material from loaded nuclides
+  //
+  //! \param[in] nuclide Index in the nuclides vector of each nuclide
+  //! \param[in] density Density of each nuclide in [atom/b-cm]
+  void set_densities(gsl::span<const int> nuclide,
+    gsl::span<const double> density);
+
   //----------------------------------------------------------------------------
   // Accessors
 
@@ -146,6 +255,15 @@ public:
   //! \return Whether material is fissionable
   bool fissionable() const { return fissionable_; }
 
+  //! Get whether material has a macroscopic XS table
+  //! \return Whether a table was built by build_material_xs_tables()
+  bool has_xs_table() const { return xs_table_offset_ != C_NONE; }
+
+  //! Mark every bin of the material's XS table invalid, on host and device,
+  //! so that lookups fall back to the nuclide loop after its composition
+  //! changes
+  void invalidate_xs_table();
+
   //! Get volume of material
   //! \return Volume in [cm^3]
   double volume() const;
@@ -154,17 +272,36 @@ public:
   //! \return Temperature in [K]
   double temperature() const;
 
-  void copy_to_device();
-  void release_from_device();
-
   // Serialized global array accessor functions
   #pragma omp declare target
   int& nuclide(int i) const {                 return model::materials_nuclide(          index_, i);}
   int& element(int i) const {                 return model::materials_element(          index_, i);}
   double& atom_density(int i) const {         return model::materials_atom_density(     index_, i);}
   int& p0(int i) const {                      return model::materials_p0(               index_, i);}
-  int& mat_nuclide_index(int i)const  {       return model::materials_mat_nuclide_index(index_, i);}
+  int& xs_features(int i) const {             return model::materials_xs_features(      index_, i);}
   ThermalTable& thermal_tables(int i) const { return model::materials_thermal_tables(   index_, i);}
+
+  //! Get whether the material contains a nuclide
+  //! \param i_nuclide Index in data::nuclides
+  bool contains_nuclide(int i_nuclide) const
+  {
+    return (model::materials_nuclide_bitmap(index_, i_nuclide / 32) >>
+      (i_nuclide % 32)) & 1u;
+  }
+
+  //! Get the index of a nuclide in nuclide_. The list is searched, so this is
+  //! meant for paths that are rare or only need the presence of the nuclide.
+  //! \param i_nuclide Index in data::nuclides
+  //! \return Index in nuclide_, or C_NONE if the material does not contain it
+  int mat_nuclide_index(int i_nuclide) const
+  {
+    if (!contains_nuclide(i_nuclide)) return C_NONE;
+    int n = nuclide_.size();
+    for (int i = 0; i < n; ++i) {
+      if (nuclide(i) == i_nuclide) return i;
+    }
+    return C_NONE;
+  }
   #pragma omp end declare target
 
   //----------------------------------------------------------------------------
@@ -180,16 +317,20 @@ public:
   bool fissionable_ {false}; //!< Does this material contain fissionable nuclides
   bool depletable_ {false}; //!< Is the material depletable?
   vector<int> p0_; //!< Indicate which nuclides are to be treated with iso-in-lab scattering
+  vector<int> xs_features_; //!< XS lookup branches each nuclide can take in this material
 
-  // To improve performance of tallying, we store an array (direct address
-  // table) that indicates for each nuclide in data::nuclides the index of the
-  // corresponding nuclide in the nuclide_ vector. If it is not present in the
-  // material, the entry is set to -1.
-  vector<int> mat_nuclide_index_;
+  // Bit i % 32 of word i / 32 is set if nuclide i of data::nuclides is in
+  // nuclide_. A bitmap keeps the lookup constant-time at 1/32 of the memory of
+  // a direct address table, which would mostly hold C_NONE.
+  vector<uint32_t> nuclide_bitmap_;
 
   // Thermal scattering tables
   vector<ThermalTable> thermal_tables_;
 
+  //! Energy in [eV] above which the material's XS are Doppler broadened by
+  //! target motion sampling, or infinity if none of its nuclides are
+  double tms_energy_min_ {INFTY};
+
   Bremsstrahlung ttb_;
 
 private:
@@ -205,9 +346,30 @@ private:
   //! Normalize density
   void normalize_density();
 
+  //! Set the density from a value in the units of materials.xml
+  //
+  //! \return Whether the density is the sum of the nuclide densities, which
+  //!   set_composition() then computes
+  bool set_density(const std::string& units, double val);
+
+  //! Register the nuclides of the material and their atom or weight fractions
+  void set_composition(const std::vector<std::string>& names,
+    const std::vector<double>& densities,
+    const std::vector<std::string>& iso_lab, bool sum_density);
+
+  //! Add a thermal scattering table applied to a fraction of the nuclei
+  void add_thermal_table(const std::string& name, double fraction);
+
   #pragma omp declare target
   void calculate_neutron_xs(Particle& p, bool need_depletion_rx) const;
   void calculate_photon_xs(Particle& p) const;
+
+  //! Set the particle's macroscopic XS by interpolating the material's XS
+  //! table, if it has one that is valid at the particle's energy
+  //
+  //! \param p The particle
+  //! \return Whether the table was used
+  bool lookup_xs_table(Particle& p) const;
   #pragma omp end declare target
 
   //----------------------------------------------------------------------------
@@ -218,6 +380,9 @@ private:
   //!
   //! A negative value indicates no default temperature was specified.
   double temperature_ {-1};
+
+  int xs_table_offset_ {C_NONE}; //!< First point of XS table, if any
+  double xs_table_sqrtkT_ {0.0}; //!< Temperature in sqrt(eV) of XS table
 };
 
 //==============================================================================
@@ -234,10 +399,54 @@ double density_effect(const std::vector<double>& f, const std::vector<double>&
   e_b_sq, double e_p_sq, double n_conduction, double rho, double E, double tol,
   int max_iter);
 
-//! Read material data from materials.xml
+//! Read material data from materials.xml or, in its absence, materials.h5
 void read_materials_xml();
 
+//! Read material data from materials.h5, the HDF5 model input that the Python
+//! API writes for models too large to parse as XML in reasonable time
+void read_materials_hdf5();
+
 void free_memory_material();
 
+//! Tabulate the macroscopic XS of every eligible material when
+//! settings::material_xs_tables is set
+void build_material_xs_tables();
+
+//! Bound the XS of each nuclide under target motion sampling when
+//! settings::temperature_tms is set. The bounds only depend on the nuclide
+//! data, so they are built once before build_majorant() uses them.
+void build_tms_majorant();
+
+//! Build the majorant XS of the delta-tracking cells when
+//! settings::delta_tracking is set
+void build_majorant();
+
+//! Get the bin of the majorant XS an energy is in
+//
+//! \param E Energy in [eV]
+//! \param n_bins Number of bins
+//! \return Index of the bin, or -1 if the energy is outside of the bins
+#pragma omp declare target
+inline int majorant_bin(double E, int n_bins)
+{
+  double u = (std::log(E) - model::majorant_log_E_min) * model::majorant_inv_du;
+  if (u < 0.0 || u >= n_bins) return -1;
+  return static_cast<int>(u);
+}
+#pragma omp end declare target
+
+//! Get the majorant XS at an energy
+//
+//! \param E Energy in [eV]
+//! \return Majorant XS in [1/cm], or zero if particles at this energy must
+//!   be surface-tracked
+#pragma omp declare target
+inline double majorant_xs(double E)
+{
+  int i = majorant_bin(E, model::majorant_size);
+  return i < 0 ? 0.0 : model::device_majorant[i];
+}
+#pragma omp end declare target
+
 } // namespace openmc
 #endif // OPENMC_MATERIAL_H
@@ -61,18 +61,22 @@ extern "C" void calc_pn_c(int n, double x, double pnx[]);
 //!   evaluated at x
 //==============================================================================
 
+#pragma omp declare target
 extern "C" double evaluate_legendre(int n, const double data[], double x);
+#pragma omp end declare target
 
 //==============================================================================
 //! Calculate the n-th order real spherical harmonics for a given angle (in
 //! terms of (u,v,w)) for all 0<=n and -m<=n<=n.
 //!
-//! \param n      The maximum order requested
+//! \param n      The maximum order requested, at most RN_MAX_ORDER
 //! \param uvw[3] The direction the harmonics are requested at
 //! \param rn     The requested harmonics of order 0 to n (inclusive)
 //!   evaluated at uvw.
 //==============================================================================
 
+constexpr int RN_MAX_ORDER {10};
+
 extern "C" void calc_rn_c(int n, const double uvw[3], double rn[]);
 
 #pragma omp declare target
@@ -90,14 +94,18 @@ void calc_rn(int n, Direction u, double rn[]);
 //! The normalization of the polynomials is such that the integral of Z_pq^2
 //! over the unit disk is exactly pi.
 //!
-//! \param n   The maximum order requested
+//! \param n   The maximum order requested, at most ZN_MAX_ORDER
 //! \param rho The radial parameter to specify location on the unit disk
 //! \param phi The angle parameter to specify location on the unit disk
 //! \param zn  The requested moments of order 0 to n (inclusive)
 //!   evaluated at rho and phi.
 //==============================================================================
 
+constexpr int ZN_MAX_ORDER {14};
+
+#pragma omp declare target
 extern "C" void calc_zn(int n, double rho, double phi, double zn[]);
+#pragma omp end declare target
 
 //==============================================================================
 //! Calculate only the even radial components of n-th order modified Zernike
@@ -196,7 +204,9 @@ extern "C" double watt_spectrum(double a, double b, uint64_t* seed);
 //! @result The sampled outgoing energy
 //==============================================================================
 
+#pragma omp declare target
 extern "C" double normal_variate(double mean, double std_dev, uint64_t* seed);
+#pragma omp end declare target
 
 //==============================================================================
 //! Samples an energy from the Muir (Gaussian) energy-dependent distribution.
@@ -212,8 +222,10 @@ extern "C" double normal_variate(double mean, double std_dev, uint64_t* seed);
 //! @result The sampled outgoing energy
 //==============================================================================
 
+#pragma omp declare target
 extern "C" double muir_spectrum(double e0, double m_rat, double kt,
   uint64_t* seed);
+#pragma omp end declare target
 
 //==============================================================================
 //! Constructs a natural cubic spline.
@@ -275,12 +287,31 @@ double spline_integrate(int n, const double x[], const double y[],
 std::complex<double> faddeeva(std::complex<double> z);
 #pragma omp end declare target
 
+//! Evaluate the Faddeeva function (in the same form as faddeeva()) for an
+//! array of arguments. Arguments and results are passed as separate real and
+//! imaginary arrays, and all methods other than FaddeevaMethod::scalar are
+//! branch-free rational approximations, so that the loop over the array
+//! vectorizes on CPU and does not diverge on device.
+//!
+//! \param n Number of arguments
+//! \param z_re Real parts of the arguments
+//! \param z_im Imaginary parts of the arguments
+//! \param w_re Real parts of the results
+//! \param w_im Imaginary parts of the results
+//! \param method Which implementation to use
+#pragma omp declare target
+void faddeeva_batch(int n, const double* z_re, const double* z_im,
+  double* w_re, double* w_im, FaddeevaMethod method);
+#pragma omp end declare target
+
 //! Evaluate derivative of the Faddeeva function
 //!
 //! \param z Complex argument
 //! \param order Order of the derivative
 //! \return Derivative of Faddeeva function evaluated at z
+#pragma omp declare target
 std::complex<double> w_derivative(std::complex<double> z, int order);
+#pragma omp end declare target
 
 } // namespace openmc
 #endif // OPENMC_MATH_FUNCTIONS_H
@@ -0,0 +1,43 @@
+//! \file memory_registry.h
+//! \brief Current and peak host and device bytes of each subsystem, recorded
+//! where containers are allocated, mapped, released and freed
+
+#ifndef OPENMC_MEMORY_REGISTRY_H
+#define OPENMC_MEMORY_REGISTRY_H
+
+#include <cstdint>
+
+namespace openmc {
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+enum class MemorySpace { host, device };
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Record bytes allocated or freed in a subsystem. May be called from within a
+//! parallel region.
+//
+//! \param category Name of the subsystem, e.g. "Nuclides"
+//! \param space Whether the bytes are in host or device memory
+//! \param n_bytes Bytes allocated, or minus the bytes freed
+void record_memory(const char* category, MemorySpace space, int64_t n_bytes);
+
+//! Bytes currently recorded across all subsystems
+//
+//! \param space Host or device memory
+int64_t memory_in_use(MemorySpace space);
+
+//! Display the current and peak bytes of each subsystem on the master process,
+//! with the largest peaks of any process
+//
+//! \param stage Point of the run the breakdown is taken at
+void print_memory_report(const char* stage);
+
+} // namespace openmc
+
+#endif // OPENMC_MEMORY_REGISTRY_H
@@ -4,6 +4,7 @@
 #ifndef OPENMC_MESH_H
 #define OPENMC_MESH_H
 
+#include <cmath> // for fabs
 #include <memory> // for unique_ptr
 #include <unordered_map>
 
@@ -63,6 +64,19 @@ public:
                             //std::vector<double>& lengths) const = 0;
   void bins_crossed(const Particle& p, FilterMatch& match) const;
 
+  //! Visit the bins crossed by a particle's last track, in order, along with
+  //! the fraction of the track length in each bin
+  //
+  //! The track is marched from one grid plane to the next (a 3D digital
+  //! differential analyzer): the distance to the next plane and between planes
+  //! is kept per direction and the bin index is stepped by its stride, so each
+  //! bin costs a comparison and a few additions.
+  //
+  //! \param[in] p Particle to check
+  //! \param[in] visit Called as visit(bin, fraction) for each bin crossed
+  template<typename F>
+  void for_each_bin_crossed(const Particle& p, F visit) const;
+
   //! Determine which surface bins were crossed by a particle
   //
   //! \param[in] p Particle to check
@@ -112,6 +126,15 @@ public:
   xt::xtensor<double, 1> count_sites(const Particle::Bank* bank,
                                      int64_t length, bool* outside) const;
 
+  //! Count number of bank sites in each mesh bin on device, transferring only
+  //! the counts. The mesh must be one of model::meshes.
+  //
+  //! \param[in] Pointer to bank sites mapped to device
+  //! \param[in] Number of bank sites
+  //! \param[out] Whether any bank sites are outside the mesh
+  xt::xtensor<double, 1> count_sites_device(const Particle::Bank* bank,
+                                            int64_t length, bool* outside) const;
+
   //! Get bin given mesh indices
   //
   //! \param[in] Array of mesh indices
@@ -176,6 +199,96 @@ public:
   vector<double> width_; //!< Width of each mesh element
 };
 
+template<typename F>
+void Mesh::for_each_bin_crossed(const Particle& p, F visit) const
+{
+  // ========================================================================
+  // Determine where the track intersects the mesh and if it intersects at all.
+
+  Position last_r {p.r_last_};
+  Position r {p.r()};
+  Direction u {p.u()};
+  double total_distance = (r - last_r).norm();
+
+  // While determining if this track intersects the mesh, offset the starting
+  // and ending coords by a bit.  This avoid finite-precision errors that can
+  // occur when the mesh surfaces coincide with lattice or geometric surfaces.
+  Position r0 = last_r + TINY_BIT*u;
+  Position r1 = r - TINY_BIT*u;
+
+  int n = n_dimension_;
+  int ijk0[3], ijk1[3];
+  bool start_in_mesh;
+  get_indices(r0, ijk0, &start_in_mesh);
+  bool end_in_mesh;
+  get_indices(r1, ijk1, &end_in_mesh);
+
+  if (start_in_mesh) {
+    r0 = last_r;
+  } else if (!intersects(r0, r1, ijk0)) {
+    return;
+  }
+
+  // For tracks shorter than 2*TINY_BIT, assume the track lies entirely in the
+  // starting bin, which the logic above guarantees is valid
+  int bin = get_bin_from_indices(ijk0);
+  int end_bin = -1;
+  if (total_distance < 2*TINY_BIT) {
+    end_bin = bin;
+  } else if (end_in_mesh) {
+    end_bin = get_bin_from_indices(ijk1);
+  }
+
+  // ========================================================================
+  // Set up the march. t_next is the distance from r0 to the next grid plane
+  // in each direction and t_delta the distance between successive planes.
+
+  double t_next[3] {INFTY, INFTY, INFTY};
+  double t_delta[3] {INFTY, INFTY, INFTY};
+  int step[3] {0, 0, 0};
+  int stride[3] {0, 0, 0};
+  int s = 1;
+  for (int k = 0; k < n; ++k) {
+    stride[k] = s;
+    s *= shape_[k];
+    if (std::fabs(u[k]) < FP_PRECISION) continue;
+    if (u[k] > 0.0) {
+      step[k] = 1;
+      t_next[k] = (lower_left_[k] + ijk0[k]*width_[k] - r0[k]) / u[k];
+      t_delta[k] = width_[k] / u[k];
+    } else {
+      step[k] = -1;
+      t_next[k] = (lower_left_[k] + (ijk0[k] - 1)*width_[k] - r0[k]) / u[k];
+      t_delta[k] = -width_[k] / u[k];
+    }
+  }
+
+  // ========================================================================
+  // Visit each bin until the track ends or leaves the mesh.
+
+  double t = 0.0;
+  while (bin != end_bin) {
+    int j = t_next[1] < t_next[0] ? 1 : 0;
+    if (t_next[2] < t_next[j]) j = 2;
+
+    // Finite-precision offsets can leave the end bin unreached along a
+    // direction of travel too close to parallel to be marched
+    if (t_next[j] == INFTY) break;
+
+    visit(bin, (t_next[j] - t) / total_distance);
+    t = t_next[j];
+    t_next[j] += t_delta[j];
+
+    ijk0[j] += step[j];
+    if (ijk0[j] < 1 || ijk0[j] > shape_[j]) return;
+    bin += step[j] * stride[j];
+  }
+
+  // The track ends in this bin, so use the particle end location rather than
+  // the next grid plane
+  visit(bin, ((r - r0).norm() - t) / total_distance);
+}
+
 
 /*
 class StructuredMesh : public Mesh {
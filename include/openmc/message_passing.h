@@ -16,7 +16,9 @@ namespace mpi {
 
 #ifdef OPENMC_MPI
   extern MPI_Datatype bank;
+  extern MPI_Datatype packed_bank;
   extern MPI_Comm intracomm;
+  extern MPI_Comm intranode; //!< Processes of intracomm on this node
 #endif
 
 } // namespace mpi
@@ -13,11 +13,14 @@
 #include "openmc/constants.h"
 #include "openmc/hdf5_interface.h"
 #include "openmc/particle.h"
+#include "openmc/vector.h"
 #include "openmc/xsdata.h"
 
 
 namespace openmc {
 
+class MgxsInterface;
+
 //==============================================================================
 // Cache contains the cached data for an MGXS object
 //==============================================================================
@@ -51,6 +54,8 @@ class Mgxs {
     std::vector<double> polar;
     std::vector<double> azimuthal;
 
+    friend class MgxsTables;
+
     //! \brief Initializes the Mgxs object metadata
     //!
     //! @param in_name Name of the object.
@@ -191,5 +196,174 @@ class Mgxs {
     const std::vector<XsData>& get_xsdata() const { return xs; }
 };
 
+//==============================================================================
+//! The MGXS of every material and nuclide in data::mg decoded into arrays
+//! indexed by handle, by temperature and angle set and by group, so that they
+//! can be evaluated and sampled on device. The handle of a material's
+//! macroscopic data is the material's index; those of the nuclides follow.
+//==============================================================================
+
+class MgxsTables {
+public:
+  //! Decode the macroscopic and nuclide data of an interface, replacing any
+  //! decoded before
+  void build(const MgxsInterface& mg);
+
+  //! Handle of a nuclide's data
+  int nuclide_handle(int i_nuclide) const { return nuclide_offset_ + i_nuclide; }
+
+  #pragma omp declare target
+  //! Find the temperature and angle set of data nearest a temperature and
+  //! direction, like Mgxs::set_temperature_index() and set_angle_index()
+  //! \param[in] handle Handle of the data
+  //! \param[in] sqrtkT Square root of the temperature in [eV]
+  //! \param[in] u Incoming particle direction
+  //! \return Index of the set
+  int set_index(int handle, double sqrtkT, Direction u) const;
+
+  //! Calculate the cross sections needed for tracking, like
+  //! Mgxs::calculate_xs()
+  //! \param[in] handle Handle of the data
+  //! \param[inout] p The particle
+  void calculate_xs(int handle, Particle& p) const;
+
+  //! Cross section of a set, like Mgxs::get_xs()
+  double get_xs(int set, MgxsType xstype, int gin, const int* gout,
+    const double* mu, const int* dg) const;
+
+  //! Sample the fission neutron energy and delay of a set, like
+  //! Mgxs::sample_fission_energy()
+  void sample_fission_energy(int set, int gin, int& dg, int& gout,
+    uint64_t* seed) const;
+
+  //! Sample the outgoing energy and angle of a scatter in a set, like
+  //! Mgxs::sample_scatter(), or from alias tables of the outgoing group and
+  //! tabulated cosine distributions if they were built (see
+  //! settings::mg_alias_sampling)
+  void sample_scatter(int set, int gin, int& gout, double& mu, double& wgt,
+    uint64_t* seed) const;
+
+  //! Average energy of a group in [eV]
+  double energy_bin_avg(int g) const { return energy_bin_avg_[g]; }
+
+  int num_delayed_groups() const { return n_dg_; }
+  #pragma omp end declare target
+
+  int num_groups() const { return n_g_; }
+
+  //! Whether the data of a handle is independent of the particle direction
+  bool is_isotropic(int handle) const { return is_isotropic_[handle]; }
+
+  void copy_to_device();
+  void release_device();
+  void clear();
+
+  bool empty() const { return set_start_.size() == 0; }
+
+  //! Number of bytes the tables occupy
+  size_t nbytes() const;
+
+private:
+  //! Decode the data of one Mgxs as the next handle
+  void add(const Mgxs& xs);
+
+  #pragma omp declare target
+  //! Normalized f(mu) of a scatter, like ScattData::calc_f()
+  double calc_f(int set, int gin, int gout, double mu) const;
+
+  //! Sample an entry of an alias table in constant time
+  //! \param[in] prob Probability of keeping each entry
+  //! \param[in] alias Entry taken in place of each entry otherwise
+  //! \param[in] n Number of entries
+  //! \param[inout] seed Pseudorandom number seed pointer
+  //! \return Index of the entry
+  static int sample_alias(const double* prob, const int* alias, int n,
+    uint64_t* seed);
+  #pragma omp end declare target
+
+  bool alias_ {false}; //!< Whether the alias tables were built
+  int n_g_ {0};  //!< Number of energy groups
+  int n_dg_ {0}; //!< Number of delayed groups
+  int nuclide_offset_ {0}; //!< Handle of the first nuclide
+  vector<double> energy_bin_avg_; //!< Average energy of each group in [eV]
+
+  // Per handle
+  vector<int> set_start_; //!< First set, with a final end entry
+  vector<int> kT_start_;  //!< First temperature, with a final end entry
+  vector<uint8_t> is_isotropic_;
+  vector<int> n_pol_;
+  vector<int> n_azi_;
+
+  // Per temperature
+  vector<double> kTs_; //!< Temperatures in [eV]
+
+  // Per set, i.e. temperature and angle. Fission data is held only by sets
+  // of fissionable data and indexed by fission_set_.
+  vector<int> fission_set_; //!< Index among the fissionable sets, or C_NONE
+  vector<AngleDistributionType> scatter_format_;
+  vector<int> mu_start_; //!< First point of the scattering cosine grid
+  vector<int> n_mu_;     //!< Number of points of the cosine grid
+  vector<double> dmu_;   //!< Spacing of the cosine grid
+
+  // Per set and group, or delayed group, in rows of n_g_ or n_dg_
+  vector<double> total_;
+  vector<double> absorption_;
+  vector<double> inverse_velocity_;
+  vector<double> decay_rate_;
+
+  // Per fissionable set and group, in rows of n_g_, n_dg_ * n_g_, n_g_ * n_g_
+  // or n_dg_ * n_g_ * n_g_
+  vector<double> fission_;
+  vector<double> nu_fission_;
+  vector<double> prompt_nu_fission_;
+  vector<double> kappa_fission_;
+  vector<double> delayed_nu_fission_;
+  vector<double> chi_prompt_;
+  vector<double> chi_delayed_;
+
+  // Per set and incoming group
+  vector<int> gmin_;         //!< Minimum outgoing group
+  vector<int> gmax_;         //!< Maximum outgoing group
+  vector<double> scattxs_;   //!< Nu-scatter cross section
+  vector<double> mult_norm_; //!< Sum of multiplicity weighted by energy
+  vector<int> gout_start_;   //!< First outgoing group entry
+
+  // Per outgoing group entry
+  vector<double> energy_;   //!< Probability of the outgoing group
+  vector<double> mult_;     //!< Multiplicity
+  vector<double> max_val_;  //!< Bound for Legendre rejection sampling
+  vector<int> dist_start_;  //!< First value of the angular distribution
+  vector<int> n_dist_;      //!< Number of values of the angular distribution
+  vector<int> fmu_start_;   //!< First value of f(mu)
+  vector<double> gout_prob_; //!< Alias table of the outgoing group: probability
+  vector<int> gout_alias_;   //!< Alias table of the outgoing group: alias
+
+  vector<double> mu_;   //!< Scattering cosine grids
+  vector<double> dist_; //!< Legendre coefficients or cumulative distributions
+  vector<double> fmu_;  //!< Tabulated f(mu)
+  vector<double> mu_prob_; //!< Alias tables of the cosine bins, as dist_
+  vector<int> mu_alias_;
+};
+
+//==============================================================================
+//! One set of MgxsTables, evaluated with the interface of Mgxs::get_xs()
+//==============================================================================
+
+struct MgxsTableSet {
+  const MgxsTables* tables;
+  int set;
+
+  double get_xs(MgxsType xstype, int gin, const int* gout, const double* mu,
+    const int* dg) const
+  {
+    return tables->get_xs(set, xstype, gin, gout, mu, dg);
+  }
+
+  double get_xs(MgxsType xstype, int gin) const
+  {
+    return tables->get_xs(set, xstype, gin, nullptr, nullptr, nullptr);
+  }
+};
+
 } // namespace openmc
 #endif // OPENMC_MGXS_H
@@ -64,6 +64,11 @@ public:
 
 namespace data {
   extern MgxsInterface mg;
+
+  //! data::mg decoded so that it can be used on device
+  #pragma omp declare target
+  extern MgxsTables mg_tables;
+  #pragma omp end declare target
 }
 
 // Puts available XS in MGXS file to globals so that when
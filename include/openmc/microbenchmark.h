@@ -0,0 +1,52 @@
+//! \file microbenchmark.h
+//! \brief Sites shared by the benchmarks that time one part of transport alone
+//! (--xs-benchmark, --collision-benchmark) on synthetic particle states
+
+#ifndef OPENMC_MICROBENCHMARK_H
+#define OPENMC_MICROBENCHMARK_H
+
+#include <cstdint>
+#include <vector>
+
+#include "openmc/particle.h"
+
+namespace openmc {
+
+//==============================================================================
+//! Places particles are put at: every distinct material and temperature that
+//! a cell instance of the model is filled with
+//==============================================================================
+
+struct BenchmarkSites {
+  std::vector<int> material;
+  std::vector<int> cell;
+  std::vector<double> sqrtkT;
+  double mean_nuclides {0.0}; //!< Nuclides per site, averaged over sites
+
+  int size() const { return material.size(); }
+};
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Find the material and temperature sites of the model
+BenchmarkSites find_benchmark_sites();
+
+#pragma omp declare target
+//! Initialize a neutron at rest at a site drawn uniformly from the sites,
+//! leaving the energy and direction to the caller
+//
+//! \param p Particle to initialize
+//! \param id Particle ID, which sets its random number streams
+//! \param material Material of each site
+//! \param cell Cell of each site
+//! \param sqrtkT Temperature of each site
+//! \param n_sites Number of sites
+void sample_benchmark_site(Particle& p, int64_t id, const int* material,
+  const int* cell, const double* sqrtkT, int n_sites);
+#pragma omp end declare target
+
+} // namespace openmc
+
+#endif // OPENMC_MICROBENCHMARK_H
@@ -7,18 +7,29 @@
 #include <mutex>
 #include <assert.h>
 
+#include "openmc/vector.h"
+
 #define NEIGHBOR_SIZE 50 // limited by fusion models
 
 namespace openmc{
 
 //==============================================================================
-//! A threadsafe, dynamic container for listing neighboring cells.
+//! Neighboring cells of a cell, in the same universe.
 //
-//! This container is a reduced interface for a linked list with an added OpenMP
-//! lock for write operations.  It allows for threadsafe dynamic growth; any
-//! number of threads can safely read data without locks or reference counting.
+//! The cells sharing a surface with the cell are found once the geometry is
+//! read and are never modified afterwards, so they can be read by any number
+//! of threads without contention, however many there are. Neighbors that share
+//! no surface with the cell (e.g. across coincident surfaces) are appended to
+//! list_ as transport finds them; reads of list_ need no locks either, and
+//! writes use atomic compare-and-swap operations.
 //==============================================================================
 
+//! Cell entered by crossing one of the surfaces of a cell
+struct SurfaceCrossing {
+  int32_t surface; //!< Half-space entered, as a signed surface index + 1
+  int32_t cell;    //!< Only cell of the universe bounded by that half-space
+};
+
 class NeighborList
 {
 public:
@@ -35,8 +46,23 @@ public:
   #pragma omp declare target
   void push_back(int32_t new_elem);
   #pragma omp end declare target
+
+  //! Cell a particle most likely enters by crossing a surface of this cell
+  //! \param on_surface Half-space entered, as a signed surface index + 1
+  //! \return The index of the cell, or -1 if there is no single candidate
+  #pragma omp declare target
+  int32_t across(int32_t on_surface) const
+  {
+    for (int i = 0; i < crossings_.size(); i++) {
+      if (crossings_[i].surface == on_surface) return crossings_[i].cell;
+    }
+    return -1;
+  }
+  #pragma omp end declare target
   
-  int32_t list_[NEIGHBOR_SIZE];
+  int32_t list_[NEIGHBOR_SIZE]; //!< Neighbors found during transport, or -1
+  vector<int32_t> adjacent_; //!< Cells sharing a surface, most shared first
+  vector<SurfaceCrossing> crossings_; //!< Unambiguous surface crossings
 };
 
 } // namespace openmc
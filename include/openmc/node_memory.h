@@ -0,0 +1,58 @@
+//! \file node_memory.h
+//! \brief Read-only memory shared by the processes on a node
+
+#ifndef OPENMC_NODE_MEMORY_H
+#define OPENMC_NODE_MEMORY_H
+
+#include <cstddef> // for size_t
+#include <memory>  // for unique_ptr
+
+#ifdef OPENMC_MPI
+#include <mpi.h>
+#endif
+
+namespace openmc {
+
+//==============================================================================
+//! One block of memory shared by all processes on a node, through an MPI-3
+//! shared memory window. One process per node fills the block and the others
+//! only read it, so that data all processes need is held once per node.
+//!
+//! Without MPI, the block is ordinary memory of the one process, which is
+//! also its writer.
+//==============================================================================
+
+class NodeSharedMemory {
+public:
+  //! Allocate the block, replacing any earlier one. Collective over
+  //! mpi::intracomm, and every process on a node must ask for the same size.
+  //
+  //! \param n_bytes Number of bytes
+  //! \return Pointer to the block, aligned to 64 bytes
+  char* allocate(size_t n_bytes);
+
+  //! Whether this process is the one on its node that fills the block
+  bool writer() const { return writer_; }
+
+  //! Wait until the writer on each node has filled the block. Collective over
+  //! mpi::intracomm.
+  void fence();
+
+  //! Free the block. Collective over mpi::intracomm.
+  void free();
+
+  size_t size() const { return size_; }
+
+private:
+  char* data_ {nullptr};
+  size_t size_ {0};
+  bool writer_ {true};
+  std::unique_ptr<char[]> local_; //!< Storage without MPI
+#ifdef OPENMC_MPI
+  MPI_Win win_ {MPI_WIN_NULL};
+#endif
+};
+
+} // namespace openmc
+
+#endif // OPENMC_NODE_MEMORY_H
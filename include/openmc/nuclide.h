@@ -23,9 +23,48 @@
 #include "openmc/vector.h"
 #include "openmc/wmp.h"
 #include "openmc/material.h"
+#include "openmc/node_memory.h"
 
 namespace openmc {
 
+class XsCacheReader;
+class XsCacheWriter;
+
+// Storage type of the flattened pointwise cross sections. Single precision
+// halves the device memory and bandwidth used by XS lookups. Energy grids are
+// always kept in double precision, as closely spaced resonance gridpoints are
+// not distinguishable in single precision.
+#ifdef SINGLE_PRECISION_XS
+using FlatXS = float;
+#else
+using FlatXS = double;
+#endif
+
+// Smallest number of inelastic scattering channels for which a nuclide keeps
+// running sums of their XS (see settings::inelastic_cdf)
+constexpr int INELASTIC_CDF_MIN_CHANNELS {8};
+
+// Number of 0K elastic scattering XS points summarized by each entry of
+// Nuclide::elastic_0K_block_max_
+constexpr int ELASTIC_0K_BLOCK {64};
+
+// Tabulated prompt fission spectra (see settings::fission_spectrum_table):
+// incident energy bins per decade, quantiles per bin and exact samples drawn
+// per quantile to estimate them
+constexpr int FISSION_SPECTRUM_BINS_PER_DECADE {4};
+constexpr int FISSION_SPECTRUM_QUANTILES {512};
+constexpr int FISSION_SPECTRUM_SAMPLES {32};
+
+// Optional branches of a microscopic XS lookup (see Nuclide::calculate_xs()).
+// Each (material, nuclide) pair is classified by the ones it can take (see
+// Material::xs_features_), and lookups compiled without a feature skip its
+// checks entirely.
+constexpr unsigned XS_TEMPERATURES {1 << 0}; //!< More than one temperature to pick from
+constexpr unsigned XS_MULTIPOLE {1 << 1};    //!< Windowed multipole data
+constexpr unsigned XS_SAB {1 << 2};          //!< S(a,b) table in the material
+constexpr unsigned XS_URR {1 << 3};          //!< URR probability tables in use
+constexpr unsigned XS_ALL {XS_TEMPERATURES | XS_MULTIPOLE | XS_SAB | XS_URR};
+
 //==============================================================================
 // Data for a nuclide
 //==============================================================================
@@ -39,10 +78,30 @@ public:
     std::vector<double> energy;
   };
 
+  //! A model temperature whose cross sections are pretabulated from the
+  //! library temperatures that bound it (see settings::pretabulate_temperatures)
+  struct PretabulatedTemperature {
+    int lo;    //!< Index of the lower bounding library temperature
+    int hi;    //!< Index of the upper bounding library temperature
+    double f;  //!< Interpolation factor between the two
+    double kT; //!< Temperature in [eV]
+    std::vector<double> energy; //!< Union of the bounding energy grids
+  };
+
   // Constructors/destructors
-  Nuclide(hid_t group, const std::vector<double>& temperature);
+  //! \param[in] group HDF5 group of the nuclide
+  //! \param[in] temperature Temperatures to read in [K]
+  //! \param[in] index Index of the nuclide in data::nuclides
+  Nuclide(hid_t group, const std::vector<double>& temperature, int index);
+  //! \param[in] cache Compiled library positioned at the nuclide
+  //! \param[in] index Index of the nuclide in data::nuclides
+  Nuclide(XsCacheReader& cache, int index);
   ~Nuclide();
 
+  //! Write the data read from HDF5 to a compiled library, from which the
+  //! nuclide can be constructed again without the HDF5 library
+  void write_cache(XsCacheWriter& cache) const;
+
   //! Initialize logarithmic grid for energy searches
   void init_grid();
 
@@ -55,12 +114,15 @@ public:
   // function returns an object directly rather than writing to a reference passed in.
   // The template type is used at the end of the function as part of the return call as
   // the correct type is generated via a constructor that knows what to do with all the possible
-  // parameters that might need to be passed back to the caller.
-  template <typename T>
-  T calculate_xs(int i_log_union, Particle& p, bool need_depletion_rx, double E, double sqrtkT)
+  // parameters that might need to be passed back to the caller. The XS of the depletion
+  // reactions of simulation::depletion_rx are the exception, as their number is only known
+  // at run time: they are written to reaction unless it is null. With the micro XS cache,
+  // reaction must be the nuclide's row of Particle::micro_rx(), which holds them on a hit.
+  // Features is a mask of the XS_* branches the lookup may take; the caller must only
+  // leave out those the (material, nuclide) pair can never need.
+  template <typename T, unsigned Features = XS_ALL>
+  T calculate_xs(int i_log_union, Particle& p, double* reaction, double E, double sqrtkT)
   {
-    double reaction[DEPLETION_RX_SIZE] = {};
-
     // ======================================================================
     // CHECK FOR SAB TABLE BEGIN
     // ======================================================================
@@ -68,17 +130,19 @@ public:
     int i_sab = C_NONE;
     double sab_frac = 0.0;
 
-    const auto& mat = model::materials[p.material_];
-    for (int s = 0; s < mat.thermal_tables_.size(); s++) {
-      const auto& sab {mat.thermal_tables(s)};
-      if (index_ == sab.index_nuclide) {
-        // Get index in sab_tables
-        i_sab = sab.index_table;
-        sab_frac = sab.fraction;
-
-        // If particle energy is greater than the highest energy for the
-        // S(a,b) table, then don't use the S(a,b) table
-        if (E > data::device_thermal_scatt[i_sab].energy_max_) i_sab = C_NONE;
+    if constexpr ((Features & XS_SAB) != 0) {
+      const auto& mat = model::materials[p.material_];
+      for (int s = 0; s < mat.thermal_tables_.size(); s++) {
+        const auto& sab {mat.thermal_tables(s)};
+        if (index_ == sab.index_nuclide) {
+          // Get index in sab_tables
+          i_sab = sab.index_table;
+          sab_frac = sab.fraction;
+
+          // If particle energy is greater than the highest energy for the
+          // S(a,b) table, then don't use the S(a,b) table
+          if (E > data::device_thermal_scatt[i_sab].energy_max_) i_sab = C_NONE;
+        }
       }
     }
 
@@ -90,6 +154,7 @@ public:
     {
       // Check if a microscopic XS lookup is even required. If all state variables are the same,
       // we don't need to perform a lookup at all.
+      const NuclideMicroXS& cache = p.neutron_xs_[index_];
       if (     E      == cache.last_E
           && sqrtkT == cache.last_sqrtkT
           && i_sab     == cache.index_sab
@@ -98,18 +163,24 @@ public:
       {
         // If the cache is still valid, then we can pass back any needed values directly
         // from the cache
-        if (micro) {
-          micro->total      = cache.total;
-          micro->absorption = cache.absorption;
-          micro->fission    = cache.fission;
-          micro->nu_fission = cache.nu_fission;
-        }
-        if (need_depletion_rx) {
-          for ( int r = 0; r < DEPLETION_RX_SIZE; r++) {
-            reaction[r] = cache.reaction[r];
-          }
-        }
-        return;
+        return T(
+            cache.total,
+            cache.absorption,
+            cache.fission,
+            cache.nu_fission,
+            cache.elastic,
+            cache.thermal,
+            cache.thermal_elastic,
+            cache.photon_prod,
+            cache.index_grid,
+            cache.index_temp,
+            cache.interp_factor,
+            cache.index_sab,
+            cache.index_temp_sab,
+            cache.sab_frac,
+            cache.use_ptable,
+            cache.last_E,
+            cache.last_sqrtkT);
       }
     }
     #endif
@@ -120,11 +191,18 @@ public:
     double fission;
     double nu_fission;
     double photon_prod = 0.0;
+    if (reaction) {
+      for (int r = 0; r < simulation::n_depletion_rx; ++r) reaction[r] = 0.0;
+    }
+    // (n,gamma) leads the depletion reactions when it is one of them
+    bool need_capture = reaction && simulation::depletion_rx[0] == N_GAMMA;
 
     bool use_mp = false;
     // Check to see if there is multipole data present at this energy
-    if (multipole()) {
-      use_mp = (E >= multipole()->E_min_ && E <= multipole()->E_max_);
+    if constexpr ((Features & XS_MULTIPOLE) != 0) {
+      if (multipole()) {
+        use_mp = (E >= multipole()->E_min_ && E <= multipole()->E_max_);
+      }
     }
 
     int i_temp = -1;
@@ -136,9 +214,17 @@ public:
       // MULTIPOLE LOOKUP BEGIN
       // ======================================================================
 
-      // Call multipole kernel
+      // Call multipole kernel, unless this lookup's evaluation was already
+      // made as part of an event-based batch
       double sig_s, sig_a, sig_f;
-      std::tie(sig_s, sig_a, sig_f) = multipole()->evaluate(E, sqrtkT);
+      if (p.wmp_xs_) {
+        const double* xs = &p.wmp_xs_[3 * data::device_wmp_slot[index_]];
+        sig_s = xs[0];
+        sig_a = xs[1];
+        sig_f = xs[2];
+      } else {
+        std::tie(sig_s, sig_a, sig_f) = multipole()->evaluate(E, sqrtkT);
+      }
 
       total = sig_s + sig_a;
       elastic = sig_s;
@@ -147,7 +233,7 @@ public:
       nu_fission = fissionable_ ?
         sig_f * this->nu(E, EmissionMode::total) : 0.0;
 
-      if (need_depletion_rx) {
+      if (need_capture) {
         // Only non-zero reaction is (n,gamma)
         reaction[0] = sig_a - sig_f;
       }
@@ -173,39 +259,45 @@ public:
       // POINTWISE LOOKUP BEGIN
       // ======================================================================
 
-      // Find the appropriate temperature index.
-      double kT = sqrtkT*sqrtkT;
-      switch (settings::temperature_method) {
-        case TemperatureMethod::NEAREST:
-          {
-            double max_diff = INFTY;
-            for (int t = 0; t < kTs_.size(); ++t) {
-              double diff = std::abs(kTs_[t] - kT);
-              if (diff < max_diff) {
-                i_temp = t;
-                max_diff = diff;
+      // Find the appropriate temperature index. Pretabulated nuclides hold
+      // each model temperature exactly, and there is nothing to pick if only
+      // one temperature is loaded.
+      if constexpr ((Features & XS_TEMPERATURES) == 0) {
+        i_temp = 0;
+      } else {
+        double kT = sqrtkT*sqrtkT;
+        switch (pretabulated_ ? TemperatureMethod::NEAREST : settings::temperature_method) {
+          case TemperatureMethod::NEAREST:
+            {
+              double max_diff = INFTY;
+              for (int t = 0; t < kTs_.size(); ++t) {
+                double diff = std::abs(kTs_[t] - kT);
+                if (diff < max_diff) {
+                  i_temp = t;
+                  max_diff = diff;
+                }
               }
             }
-          }
-          break;
+            break;
 
-        case TemperatureMethod::INTERPOLATION:
-          // Find temperatures that bound the actual temperature
-          for (i_temp = 0; i_temp < kTs_.size() - 1; ++i_temp) {
-            if (kTs_[i_temp] <= kT && kT < kTs_[i_temp + 1]) break;
-          }
+          case TemperatureMethod::INTERPOLATION:
+            // Find temperatures that bound the actual temperature
+            for (i_temp = 0; i_temp < kTs_.size() - 1; ++i_temp) {
+              if (kTs_[i_temp] <= kT && kT < kTs_[i_temp + 1]) break;
+            }
 
-          // Randomly sample between temperature i and i+1
-          f = (kT - kTs_[i_temp]) / (kTs_[i_temp + 1] - kTs_[i_temp]);
+            // Randomly sample between temperature i and i+1
+            f = (kT - kTs_[i_temp]) / (kTs_[i_temp + 1] - kTs_[i_temp]);
 
-          double sample = future_prn(static_cast<int64_t>(index_), p.seeds_[STREAM_SAB_T]);
+            double sample = future_prn(static_cast<int64_t>(index_), p.seeds_[STREAM_SAB_T]);
 
-          if (f > sample) ++i_temp;
-          break;
+            if (f > sample) ++i_temp;
+            break;
+        }
       }
 
       // Offset index grid
-      int index_offset = i_temp * (settings::n_log_bins + 1);
+      int index_offset = i_temp * index_gridpoints_per_temp_;
       int* grid_index = &flat_grid_index_[index_offset];
 
       // Offset energy grid
@@ -214,7 +306,7 @@ public:
 
       // Offset xs
       int xs_offset = flat_temp_offsets_[i_temp] * 5;
-      double* xs = &flat_xs_[xs_offset];
+      const FlatXS* xs = &flat_xs_[xs_offset];
 
       // Determine # of gridpoints for this temperature
       int num_gridpoints;
@@ -224,17 +316,17 @@ public:
         num_gridpoints = total_energy_gridpoints_ - energy_offset;
       }
 
-      // Determine the energy grid index using a logarithmic mapping to
-      // reduce the energy range over which a binary search needs to be
-      // performed
+      // Determine the energy grid index using a logarithmic (or unionized)
+      // mapping to reduce the energy range over which a binary search needs
+      // to be performed
 
       if (E < energy[0]) {
         i_grid = 0;
       } else if (E > energy[num_gridpoints-1]) {
         i_grid = num_gridpoints - 2;
       } else {
-        // Determine bounding indices based on which equal log-spaced
-        // interval the energy is in
+        // Determine bounding indices based on which equal log-spaced (or
+        // union grid) interval the energy is in
         int i_low  = grid_index[i_log_union];
         int i_high = grid_index[i_log_union + 1] + 1;
 
@@ -283,31 +375,19 @@ public:
       photon_prod = f_comp * photon_prod_low + f * photon_prod_next;
 
       // Depletion-related reactions
-      if (need_depletion_rx) {
-        for (int j = 0; j < DEPLETION_RX.size(); ++j) {
+      if (reaction) {
+        for (int j = 0; j < simulation::n_depletion_rx; ++j) {
           // If reaction is present and energy is greater than threshold, set the
           // reaction xs appropriately
-          int i_rx = reaction_index_[DEPLETION_RX[j]];
-          if (i_rx >= 0) {
-            const auto& rx = reactions_[i_rx].obj();
-
-            // Physics says that (n,gamma) is not a threshold reaction, so we don't
-            // need to specifically check its threshold index
-            if (j == 0) {
-              reaction[0] = rx.xs(i_temp, i_grid, f);
-              continue;
-            }
-
-            int threshold = rx.xs_threshold(i_temp);
-            if (i_grid >= threshold) {
-              reaction[j] = rx.xs(i_temp, i_grid, f);
-            } else if (j >= 3) {
-              // One can show that the the threshold for (n,(x+1)n) is always
-              // higher than the threshold for (n,xn). Thus, if we are below
-              // the threshold for, e.g., (n,2n), there is no reason to check
-              // the threshold for (n,3n) and (n,4n).
-              break;
-            }
+          int mt = simulation::depletion_rx[j];
+          int i_rx = reaction_index_[mt];
+          if (i_rx < 0) continue;
+          const auto& rx = reactions_[i_rx].obj();
+
+          // Physics says that (n,gamma) is not a threshold reaction, so we don't
+          // need to specifically check its threshold index
+          if (mt == N_GAMMA || i_grid >= rx.xs_threshold(i_temp)) {
+            reaction[j] = rx.xs(i_temp, i_grid, f);
           }
         }
       } // end depletion RX conditional
@@ -329,7 +409,7 @@ public:
     // If there is S(a,b) data for this nuclide, we need to set the sab_scatter
     // and sab_elastic cross sections and correct the total and elastic cross
     // sections.
-    if (i_sab >= 0)
+    if ((Features & XS_SAB) != 0 && i_sab >= 0)
     {
       // Set flag that S(a,b) treatment should be used for scattering
       index_sab = i_sab;
@@ -375,7 +455,8 @@ public:
 
     // If the particle is in the unresolved resonance range and there are
     // probability tables, we need to determine cross sections from the table
-    if (settings::urr_ptables_on && urr_present_ && !use_mp) {
+    if ((Features & XS_URR) != 0 && settings::urr_ptables_on && urr_present_ &&
+        !use_mp) {
       int n = urr_data_[i_temp].n_energy_;
       if ((E > urr_data_[i_temp].device_energy_[0]) &&
           (E < urr_data_[i_temp].device_energy_[n-1]))
@@ -385,79 +466,85 @@ public:
         // Create a shorthand for the URR data
         const auto& urr = urr_data_[i_temp];
 
-        // Determine the energy table
-        int i_energy = 0;
-        while (E >= urr.device_energy_[i_energy + 1]) {++i_energy;};
-
         // Sample the probability table using the cumulative distribution
 
         // Random nmbers for the xs calculation are sampled from a separate stream.
         // This guarantees the randomness and, at the same time, makes sure we
         // reuse random numbers for the same nuclide at different temperatures,
         // therefore preserving correlation of temperature in probability tables.
+        // The skip ahead to this nuclide's number is precomputed, so every URR
+        // lookup of a batched event costs one multiply-add per nuclide.
         //TODO: to maintain the same random number stream as the Fortran code this
         //replaces, the seed is set with index_ + 1 instead of index_
-        double r = future_prn(static_cast<int64_t>(index_ + 1), p.seeds_[STREAM_URR_PTABLE]);
-
-        int i_low = 0;
-        while (urr.prob(i_energy, URRTableParam::CUM_PROB, i_low) <= r) {++i_low;};
-
-        int i_up = 0;
-        while (urr.prob(i_energy + 1, URRTableParam::CUM_PROB, i_up) <= r) {++i_up;};
+        double r = skip_ahead_prn(urr_prn_mult_, urr_prn_add_, p.seeds_[STREAM_URR_PTABLE]);
 
         // Determine elastic, fission, and capture cross sections from the
         // probability table
         double p_elastic = 0.;
         double p_fission = 0.;
         double p_capture = 0.;
-        double p_f;
-        if (urr.interp_ == Interpolation::lin_lin) {
-          // Determine the interpolation factor on the table
-          p_f = (E - urr.device_energy_[i_energy]) /
-            (urr.device_energy_[i_energy + 1] - urr.device_energy_[i_energy]);
-
-          p_elastic = (1. - p_f) * urr.prob(i_energy, URRTableParam::ELASTIC, i_low) +
-            p_f * urr.prob(i_energy + 1, URRTableParam::ELASTIC, i_up);
-          p_fission = (1. - p_f) * urr.prob(i_energy, URRTableParam::FISSION, i_low) +
-            p_f * urr.prob(i_energy + 1, URRTableParam::FISSION, i_up);
-          p_capture = (1. - p_f) * urr.prob(i_energy, URRTableParam::N_GAMMA, i_low) +
-            p_f * urr.prob(i_energy + 1, URRTableParam::N_GAMMA, i_up);
-        } else if (urr.interp_ == Interpolation::log_log) {
-          // Determine interpolation factor on the table
-          p_f = std::log(E / urr.device_energy_[i_energy]) /
-            std::log(urr.device_energy_[i_energy + 1] / urr.device_energy_[i_energy]);
-
-          // Calculate the elastic cross section/factor
-          if ((urr.prob(i_energy, URRTableParam::ELASTIC, i_low) > 0.) &&
-              (urr.prob(i_energy + 1, URRTableParam::ELASTIC, i_up) > 0.)) {
-            p_elastic =
-              std::exp((1. - p_f) *
-                  std::log(urr.prob(i_energy, URRTableParam::ELASTIC, i_low)) +
-                  p_f * std::log(urr.prob(i_energy + 1, URRTableParam::ELASTIC, i_up)));
-          } else {
-            p_elastic = 0.;
-          }
+        if (settings::urr_fast_sampling) {
+          urr.sample_bands(E, r, p_elastic, p_fission, p_capture);
+        } else {
+          // Determine the energy table
+          int i_energy = 0;
+          while (E >= urr.device_energy_[i_energy + 1]) {++i_energy;};
+
+          int i_low = 0;
+          while (urr.prob(i_energy, URRTableParam::CUM_PROB, i_low) <= r) {++i_low;};
+
+          int i_up = 0;
+          while (urr.prob(i_energy + 1, URRTableParam::CUM_PROB, i_up) <= r) {++i_up;};
+
+          double p_f;
+          if (urr.interp_ == Interpolation::lin_lin) {
+            // Determine the interpolation factor on the table
+            p_f = (E - urr.device_energy_[i_energy]) /
+              (urr.device_energy_[i_energy + 1] - urr.device_energy_[i_energy]);
+
+            p_elastic = (1. - p_f) * urr.prob(i_energy, URRTableParam::ELASTIC, i_low) +
+              p_f * urr.prob(i_energy + 1, URRTableParam::ELASTIC, i_up);
+            p_fission = (1. - p_f) * urr.prob(i_energy, URRTableParam::FISSION, i_low) +
+              p_f * urr.prob(i_energy + 1, URRTableParam::FISSION, i_up);
+            p_capture = (1. - p_f) * urr.prob(i_energy, URRTableParam::N_GAMMA, i_low) +
+              p_f * urr.prob(i_energy + 1, URRTableParam::N_GAMMA, i_up);
+          } else if (urr.interp_ == Interpolation::log_log) {
+            // Determine interpolation factor on the table
+            p_f = std::log(E / urr.device_energy_[i_energy]) /
+              std::log(urr.device_energy_[i_energy + 1] / urr.device_energy_[i_energy]);
+
+            // Calculate the elastic cross section/factor
+            if ((urr.prob(i_energy, URRTableParam::ELASTIC, i_low) > 0.) &&
+                (urr.prob(i_energy + 1, URRTableParam::ELASTIC, i_up) > 0.)) {
+              p_elastic =
+                std::exp((1. - p_f) *
+                    std::log(urr.prob(i_energy, URRTableParam::ELASTIC, i_low)) +
+                    p_f * std::log(urr.prob(i_energy + 1, URRTableParam::ELASTIC, i_up)));
+            } else {
+              p_elastic = 0.;
+            }
 
-          // Calculate the fission cross section/factor
-          if ((urr.prob(i_energy, URRTableParam::FISSION, i_low) > 0.) &&
-              (urr.prob(i_energy + 1, URRTableParam::FISSION, i_up) > 0.)) {
-            p_fission =
-              std::exp((1. - p_f) *
-                  std::log(urr.prob(i_energy, URRTableParam::FISSION, i_low)) +
-                  p_f * std::log(urr.prob(i_energy + 1, URRTableParam::FISSION, i_up)));
-          } else {
-            p_fission = 0.;
-          }
+            // Calculate the fission cross section/factor
+            if ((urr.prob(i_energy, URRTableParam::FISSION, i_low) > 0.) &&
+                (urr.prob(i_energy + 1, URRTableParam::FISSION, i_up) > 0.)) {
+              p_fission =
+                std::exp((1. - p_f) *
+                    std::log(urr.prob(i_energy, URRTableParam::FISSION, i_low)) +
+                    p_f * std::log(urr.prob(i_energy + 1, URRTableParam::FISSION, i_up)));
+            } else {
+              p_fission = 0.;
+            }
 
-          // Calculate the capture cross section/factor
-          if ((urr.prob(i_energy, URRTableParam::N_GAMMA, i_low) > 0.) &&
-              (urr.prob(i_energy + 1, URRTableParam::N_GAMMA, i_up) > 0.)) {
-            p_capture =
-              std::exp((1. - p_f) *
-                  std::log(urr.prob(i_energy, URRTableParam::N_GAMMA, i_low)) +
-                  p_f * std::log(urr.prob(i_energy + 1, URRTableParam::N_GAMMA, i_up)));
-          } else {
-            p_capture = 0.;
+            // Calculate the capture cross section/factor
+            if ((urr.prob(i_energy, URRTableParam::N_GAMMA, i_low) > 0.) &&
+                (urr.prob(i_energy + 1, URRTableParam::N_GAMMA, i_up) > 0.)) {
+              p_capture =
+                std::exp((1. - p_f) *
+                    std::log(urr.prob(i_energy, URRTableParam::N_GAMMA, i_low)) +
+                    p_f * std::log(urr.prob(i_energy + 1, URRTableParam::N_GAMMA, i_up)));
+            } else {
+              p_capture = 0.;
+            }
           }
         }
 
@@ -489,7 +576,7 @@ public:
         fission = p_fission;
         total = p_elastic + p_inelastic + p_capture + p_fission;
 
-        if (need_depletion_rx) {
+        if (need_capture) {
           reaction[0] = p_capture;
         }
 
@@ -516,7 +603,6 @@ public:
         thermal,
         thermal_elastic,
         photon_prod,
-        reaction,
         i_grid,
         i_temp,
         f,
@@ -535,8 +621,43 @@ public:
   //! Determines the microscopic 0K elastic cross section at a trial relative
   //! energy used in resonance scattering
   double elastic_xs_0K(double E) const;
+
+  //! Determines the microscopic 0K elastic cross section at a trial relative
+  //! energy known to be below the last of the first n_search 0K grid points,
+  //! searching only those
+  double elastic_xs_0K(double E, int n_search) const;
+
+  //! Maximum 0K elastic cross section over the grid points [first, last)
+  double elastic_0K_max(int first, int last) const;
+
+  //! Sample an inelastic scattering channel by bisection of the running sums
+  //! of their XS
+  //
+  //! \param[in] micro Microscopic XS of the nuclide at the collision
+  //! \param[in] cutoff Sampled XS, measured from the first inelastic channel
+  //! \return Index in reactions_ of the first channel whose running sum
+  //!   reaches cutoff, or C_NONE if there are no running sums at this energy
+  int sample_inelastic_channel(const NuclideMicroXS& micro, double cutoff) const;
+
+  //! Sample the outgoing energy of a prompt fission neutron of the first
+  //! fission reaction from the tabulated quantiles of its spectrum
+  //
+  //! \param[in] E_in Incident neutron energy in [eV]
+  //! \param[inout] seed Pseudorandom seed pointer
+  //! \return Outgoing energy in [eV]
+  double sample_fission_spectrum(double E_in, uint64_t* seed) const;
   #pragma omp end declare target
 
+  //! Tabulate the quantiles of the prompt fission neutron spectrum of the
+  //! first fission reaction at the center of each incident energy bin, from
+  //! samples of the exact distribution
+  //
+  //! \param[in] validate Whether to compare the tables against independent
+  //!   samples of the exact distribution
+  //! \return Largest Kolmogorov-Smirnov distance between a table and its
+  //!   independent samples, or 0 if not validating
+  double init_fission_spectrum(bool validate);
+
   //! \brief Calculate reaction rate based on group-wise flux distribution
   //
   //! \param[in] MT ENDF MT value for desired reaction
@@ -547,7 +668,15 @@ public:
   double collapse_rate(int MT, double temperature, gsl::span<const double> energy,
     gsl::span<const double> flux) const;
 
-  void flatten_xs_data();
+  //! Flatten the pointwise cross sections and energy grids
+  //
+  //! \param[in] shared Node-shared storage of flat_xs_nbytes() bytes for the
+  //!   flattened arrays, filled only by the writer of data::shared_xs, or
+  //!   nullptr to allocate them for this process
+  void flatten_xs_data(char* shared = nullptr);
+
+  //! Number of bytes flatten_xs_data() places in node-shared storage
+  size_t flat_xs_nbytes() const;
 
   void flatten_wmp_data();
 
@@ -564,16 +693,22 @@ public:
 
   // Temperature dependent cross section data
   vector<double> kTs_; //!< temperatures in eV (k*T)
+  bool pretabulated_ {false}; //!< kTs_ are exactly the model temperatures?
+  double tms_kT_ {0.0}; //!< Highest kT in [eV] target motion sampling broadens kTs_[0] to
   std::vector<EnergyGrid> grid_; //!< Energy grid at each temperature
   std::vector<xt::xtensor<double, 2>> xs_; //!< Cross sections at each temperature
 
   // Flattened 1D temperature dependent cross section data
   int total_energy_gridpoints_;
   int total_index_gridpoints_;
+  int index_gridpoints_per_temp_; //!< Entries of flat_grid_index_ per temperature
   int* flat_temp_offsets_ {nullptr};
   int* flat_grid_index_;
   double* flat_grid_energy_;
-  double* flat_xs_;
+  FlatXS* flat_xs_;
+  bool flat_arena_ {false}; //!< Flattened arrays are owned by data::device_arena?
+  bool flat_shared_ {false}; //!< Flattened arrays are in data::shared_xs?
+  bool flat_host_ {false}; //!< Flattened arrays are read by the device from host memory?
 
   // Multipole data
   std::unique_ptr<WindowedMultipole> multipole_;
@@ -593,32 +728,75 @@ public:
   std::unique_ptr<Function1DFlatContainer> fragments_; //!< Fission fragment energy release
   std::unique_ptr<Function1DFlatContainer> betas_; //!< Delayed beta energy release
   Function1DFlatContainer* device_total_nu_ {nullptr};
+  Function1DFlatContainer* device_prompt_photons_ {nullptr};
+  Function1DFlatContainer* device_delayed_photons_ {nullptr};
 
   // Resonance scattering information
   bool resonant_ {false};
   vector<double> energy_0K_;
   vector<double> elastic_0K_;
   vector<double> xs_cdf_;
+  vector<double> elastic_0K_block_max_; //!< Max of elastic_0K_ over each full block of ELASTIC_0K_BLOCK points
 
   // Unresolved resonance range information
   bool urr_present_ {false};
   int urr_inelastic_ {C_NONE};
   vector<UrrData> urr_data_;
+  uint64_t urr_prn_mult_; //!< Skip-ahead factors to this nuclide's URR
+  uint64_t urr_prn_add_;  //!< random number (see skip_ahead_params())
 
   vector<ReactionFlatContainer> reactions_; //!< Reactions
   std::array<size_t, 902> reaction_index_; //!< Index of each reaction
   vector<int> index_inelastic_scatter_;
 
+  // Running sums of the inelastic scattering XS over index_inelastic_scatter_,
+  // at each grid point from the lowest threshold up. Each row holds one sum
+  // per channel. A row is marked inexact when a channel starting at the next
+  // grid point has a nonzero XS at its threshold, since interpolating the
+  // sums across that interval would count it before its threshold.
+  vector<double> inelastic_cdf_;
+  vector<uint8_t> inelastic_cdf_exact_; //!< Whether each row can be interpolated
+  vector<int> inelastic_cdf_start_;     //!< First grid point at each temperature
+  vector<int> inelastic_cdf_row_;       //!< First row at each temperature
+
+  // Quantiles of the prompt fission neutron energy of the first fission
+  // reaction, FISSION_SPECTRUM_QUANTILES per log-uniform incident energy bin
+  vector<double> fission_spectrum_;
+  int fission_spectrum_mt_ {C_NONE}; //!< MT of the tabulated fission reaction
+  int fission_spectrum_bins_ {0};    //!< Number of incident energy bins
+  double fission_spectrum_log_E_min_; //!< Log of the lowest incident energy
+  double fission_spectrum_inv_du_;    //!< Inverse log width of the bins
+
   ReactionFlatContainer** device_fission_rx_ {nullptr};
 private:
   void create_derived(const Function1DFlatContainer* prompt_photons, const Function1DFlatContainer* delayed_photons);
 
+  //! Tabulate the running sums of the inelastic scattering XS
+  void init_inelastic_cdf();
+
   //! Determine temperature index and interpolation factor
   //
   //! \param[in] T Temperature in [K]
   //! \return Temperature index and interpolation factor
   std::pair<gsl::index, double> find_temperature(double T) const;
 
+  //! Determine which model temperatures to pretabulate and the library
+  //! temperatures (which must already be read into kTs_ and grid_) that
+  //! bound each one
+  //
+  //! \param[in] temperature Temperatures in [K] present in the model
+  //! \return Temperatures to pretabulate, sorted by kT
+  std::vector<PretabulatedTemperature> plan_pretabulation(
+    const std::vector<double>& temperature) const;
+
+  //! Replace the cross sections of a reaction read at the library
+  //! temperatures with ones pretabulated at the model temperatures
+  //
+  //! \param[in] pretab Temperatures to pretabulate
+  //! \param[inout] rx Reaction read at the library temperatures
+  void pretabulate_reaction(const std::vector<PretabulatedTemperature>& pretab,
+    Reaction& rx) const;
+
   #pragma omp declare target
   static int XS_TOTAL;
   static int XS_ABSORPTION;
@@ -635,7 +813,31 @@ private:
 //! Checks for the right version of nuclear data within HDF5 files
 void check_data_version(hid_t file_id);
 
+//! Read the photon interaction data of the element of a nuclide, unless it
+//! is already loaded
+//
+//! \param[in] nuclide Name of the nuclide
+//! \return Error code
+int read_photon_element(const std::string& nuclide);
+
+#pragma omp declare target
 bool multipole_in_range(const Nuclide& nuc, double E);
+#pragma omp end declare target
+
+//! Build the unionized energy grid from the energy grids of every nuclide at
+//! every temperature, keeping every settings::union_grid_stride-th point
+void build_union_energy_grid();
+
+#pragma omp declare target
+//! Determine which interval of the grid selected by
+//! settings::energy_grid_method contains an energy. This is passed to
+//! Nuclide::calculate_xs() to bound each nuclide's energy grid search, so that
+//! for a unionized grid a single search serves every nuclide in a material.
+//
+//! \param E Neutron energy in [eV]
+//! \return Interval index on the logarithmic or unionized grid
+int energy_grid_search_index(double E);
+#pragma omp end declare target
 
 //==============================================================================
 // Global variables
@@ -662,6 +864,19 @@ extern Nuclide* nuclides;
 extern size_t nuclides_size;
 #pragma omp end declare target
 extern size_t nuclides_capacity;
+//! Bytes of nuclear data left unread (see settings::prune_nuclear_data)
+extern size_t pruned_bytes;
+
+//! Unionized energy grid in [eV] (only built for EnergyGridMethod::unionized)
+extern vector<double> union_grid;
+#pragma omp declare target
+extern double* device_union_grid;
+extern int union_grid_size;
+#pragma omp end declare target
+
+//! Flattened pointwise cross sections of all nuclides, held once per node
+//! (only used with settings::shared_xs)
+extern NodeSharedMemory shared_xs;
 
 } // namespace data
 
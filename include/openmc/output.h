@@ -49,6 +49,19 @@ void print_generation();
 //! Display time elapsed for various stages of a run
 void print_runtime();
 
+//! Display one line of elapsed time in the style of print_runtime()
+//
+//! \param label Description of the time
+//! \param secs Time in [s]
+//! \param indent_level Number of levels the line is nested under another
+void show_time(const char* label, double secs, int indent_level=0);
+
+//! Whether the transport kernels of the run executed on a device
+bool was_device_used();
+
+//! Display the scoring cost counters of each tally (see --tally-stats)
+void print_tally_stats();
+
 //! Display results for global tallies including k-effective estimators
 void print_results();
 
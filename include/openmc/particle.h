@@ -34,22 +34,17 @@
 #define NU_BANK_SIZE 16 // infinite_cell regression test
 */
 // Minimal for HM-SMall
-//#define NEUTRON_XS_SIZE 69 // HM-Small
-//#define NEUTRON_XS_SIZE 272 // HM-Large
-//#define NEUTRON_XS_SIZE 92 // SMR
-#ifdef NO_MICRO_XS_CACHE
-#define NEUTRON_XS_SIZE 1
-#else
-#define NEUTRON_XS_SIZE 296 // Depleted SMR uses 296
-#endif
-//#define NEUTRON_XS_SIZE 35 // Fresh Pincell
-#define PHOTON_XS_SIZE 9 // Pincell example uses 9
+// Coordinate levels stored per particle, set with -Dcoord_levels=N. Models
+// whose particles sit at most 3 or 4 levels deep can lower this to shrink
+// Particle by one LocalCoord (and one cell_last_ entry) per level removed.
+#ifndef COORD_SIZE
 #define COORD_SIZE 6 // Depleted SMR uses 6
-//#define COORD_SIZE 3 // Depleted SMR uses 6
-//#define SECONDARY_BANK_SIZE 200 // 100 not enough to pass regression tests, but 200 works. TODO: narrow this down.
-#define SECONDARY_BANK_SIZE 5 // 100 not enough to pass regression tests, but 200 works. TODO: narrow this down.
-#define FLUX_DERIVS_SIZE 1 // This is the min required to pass regression tests (diff_tally is limiter)
-#define NU_BANK_SIZE 16 // infinite_cell regression test
+#endif
+// Secondaries stored inline per particle, set with -Dsecondary_bank_inline=N.
+// Any more spill to simulation::secondary_pool, whose size is set at run time.
+#ifndef SECONDARY_BANK_SIZE
+#define SECONDARY_BANK_SIZE 5
+#endif
 
 namespace openmc {
 
@@ -72,6 +67,7 @@ constexpr double CACHE_INVALID {-1.0};
 
 // Forward declare the Surface class for use in function arguments.
 class Surface;
+struct LostParticle;
 
 class LocalCoord {
 public:
@@ -114,10 +110,6 @@ struct NuclideMicroXS {
   double thermal_elastic;  //!< Bound thermal elastic scattering
   double photon_prod;      //!< microscopic photon production xs
 
-  // Cross sections for depletion reactions (note that these are not stored in
-  // macroscopic cache)
-  double reaction[DEPLETION_RX_SIZE];
-
   // Indicies and factors needed to compute cross sections from the data tables
   int index_grid;        //!< Index on nuclide energy grid
   int index_temp;        //!< Temperature index for nuclide
@@ -144,7 +136,6 @@ struct NuclideMicroXS {
       double thermal,
       double thermal_elastic,
       double photon_prod,
-      double reaction_in[DEPLETION_RX_SIZE],
       int index_grid,
       int index_temp,
       double interp_factor,
@@ -172,16 +163,98 @@ struct NuclideMicroXS {
     use_ptable(use_ptable),
     last_E(last_E),
     last_sqrtkT(las_sqrtkT)
-  {
-    for (int r = 0; r < DEPLETION_RX_SIZE; r++) {
-      reaction[r] = reaction_in[r];
-    }
-  }
+  {}
 };
 
+struct ElementMicroXS;
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+// Pool from which each particle's microscopic neutron XS cache is carved. It
+// holds micro_xs_pool_slots slots of micro_xs_slot_size (i.e., the number of
+// nuclides) entries each, so its footprint tracks the problem being run
+// rather than the largest problem the code was compiled for.
+#pragma omp declare target
+extern NuclideMicroXS* micro_xs_pool;
+extern int micro_xs_slot_size;
+#pragma omp end declare target
+extern int micro_xs_pool_slots; //!< Slots reserved, recorded in every build
+
+// Pool from which each particle's flux derivatives are carved, with
+// flux_derivs_pool_slots slots of flux_derivs_slot_size (i.e., the number of
+// tally derivatives) entries each. It is empty when there are no derivatives.
+#pragma omp declare target
+extern double* flux_derivs_pool;
+extern int flux_derivs_slot_size;
+#pragma omp end declare target
+extern int flux_derivs_pool_slots;
+
+// Pool from which each particle's cumulative nuclide XS are carved, with
+// nuclide_cdf_pool_slots slots of nuclide_cdf_slot_size (i.e., the largest
+// number of nuclides in a material) entries each. It is only allocated when
+// settings::nuclide_cdf is set.
+#pragma omp declare target
+extern double* nuclide_cdf_pool;
+extern int nuclide_cdf_slot_size;
+#pragma omp end declare target
+extern int nuclide_cdf_pool_slots;
+
+// Pool from which each particle's microscopic photon XS cache is carved, with
+// photon_xs_pool_slots slots of photon_xs_slot_size (i.e., the number of
+// elements) entries each. It is only allocated for photon transport.
+#pragma omp declare target
+extern ElementMicroXS* photon_xs_pool;
+extern int photon_xs_slot_size;
+#pragma omp end declare target
+extern int photon_xs_pool_slots;
+
+// Reactions of DEPLETION_REACTIONS scored by any tally, in that order, whose
+// cross sections are looked up along with the macroscopic XS
+#pragma omp declare target
+extern int depletion_rx[MAX_DEPLETION_RX];
+extern int n_depletion_rx;
+#pragma omp end declare target
+
+// Pool from which each particle's depletion reaction XS are carved, with
+// depletion_rx_pool_slots slots of depletion_rx_slot_size entries each: the
+// macroscopic XS of each reaction of depletion_rx followed, with the micro XS
+// cache, by the microscopic XS of each nuclide. It is only allocated when
+// depletion_rx is not empty.
+#pragma omp declare target
+extern double* depletion_rx_pool;
+extern int depletion_rx_slot_size;
+#pragma omp end declare target
+extern int depletion_rx_pool_slots;
+
+} // namespace simulation
+
+//! Index of a reaction in simulation::depletion_rx
+//
+//! \param mt MT number of the reaction
+//! 
+eturn Its index, or C_NONE if its XS are not looked up for depletion
+#pragma omp declare target
+inline int depletion_rx_index(int mt)
+{
+  for (int j = 0; j < simulation::n_depletion_rx; ++j) {
+    if (simulation::depletion_rx[j] == mt) return j;
+  }
+  return C_NONE;
+}
+#pragma omp end declare target
+
 class NuclideMicroXSCache {
   public:
-  NuclideMicroXS neutron_xs_[NEUTRON_XS_SIZE]; //!< Microscopic neutron cross sections
+  #ifdef NO_MICRO_XS_CACHE
+  NuclideMicroXS neutron_xs_[1]; //!< Microscopic neutron cross sections
+  #else
+  NuclideMicroXS* neutron_xs_ {nullptr}; //!< Slot in simulation::micro_xs_pool
+  int size_ {0}; //!< Number of nuclides in the slot
+  #endif
   #pragma omp declare target
   NuclideMicroXS  operator [](int64_t i) const
   {
@@ -199,11 +272,26 @@ class NuclideMicroXSCache {
     return neutron_xs_[i];
     #endif
   }
+
+  //! Point the cache at a slot of simulation::micro_xs_pool. This must be
+  //! called from the same side (host or device) that will use the cache.
+  void assign(int slot)
+  {
+    #ifndef NO_MICRO_XS_CACHE
+    neutron_xs_ = simulation::micro_xs_pool +
+      static_cast<int64_t>(slot) * simulation::micro_xs_slot_size;
+    size_ = simulation::micro_xs_slot_size;
+    #endif
+  }
   #pragma omp end declare target
   void clear()
   {
     if (settings::run_CE) {
-      for (auto& micro : neutron_xs_) micro.last_E = 0.0;
+      #ifdef NO_MICRO_XS_CACHE
+      neutron_xs_[0].last_E = 0.0;
+      #else
+      for (int i = 0; i < size_; i++) neutron_xs_[i].last_E = 0.0;
+      #endif
     }
   }
 };
@@ -235,9 +323,6 @@ struct MacroXS {
   double fission;       //!< macroscopic fission xs
   double nu_fission;    //!< macroscopic production xs
   double photon_prod;   //!< macroscopic photon production xs
-  
-  // Cross sections for depletion reactions
-  double reaction[DEPLETION_RX_SIZE];
 
   // Photon cross sections
   double coherent;        //!< macroscopic coherent xs
@@ -255,7 +340,6 @@ struct MicroXS {
   double absorption;    //!< macroscopic absorption xs
   double fission;       //!< macroscopic fission xs
   double nu_fission;    //!< macroscopic production xs
-  double reaction[DEPLETION_RX_SIZE];
 
   MicroXS() = default;
 
@@ -268,7 +352,6 @@ struct MicroXS {
       double thermal,
       double thermal_elastic,
       double photon_prod,
-      double reaction_in[DEPLETION_RX_SIZE],
       int index_grid,
       int index_temp,
       double interp_factor,
@@ -283,11 +366,7 @@ struct MicroXS {
     absorption(absorption),
     fission(fission),
     nu_fission(nu_fission)
-  {
-    for (int r = 0; r < DEPLETION_RX_SIZE; r++) {
-      reaction[r] = reaction_in[r];
-    }
-  }
+  {}
 
 };
 
@@ -302,6 +381,73 @@ struct BoundaryInfo {
   std::array<int, 3> lattice_translation {}; //!< which way lattice indices will change
 };
 
+//==============================================================================
+//! Evaluations A*x + B*y + C*z - D of the general planes of one cell at the
+//! particle's position (see settings::plane_cache). Advancing a distance s
+//! along u changes an evaluation by s times the projection of u on the
+//! plane's normal, so the evaluations are carried along from one collision to
+//! the next instead of being recomputed while the particle stays in the cell.
+//==============================================================================
+
+class PlaneEvalCache {
+public:
+  static constexpr int SIZE {8}; //!< Most planes cached for one cell
+
+  #pragma omp declare target
+  //! Are the evaluations those of a cell at a position?
+  bool valid(int32_t cell_id, Position r) const
+  {
+    return cell_ == cell_id && r_ == r;
+  }
+
+  //! Start over with the planes of a cell at a position
+  void reset(int32_t cell_id, Position r)
+  {
+    cell_ = cell_id;
+    r_ = r;
+    n_ = 0;
+  }
+
+  //! Move the evaluations a distance along the direction the projections were
+  //! found for, or forget them if the particle moved along another one
+  //! \param distance Distance advanced along u
+  //! \param r Position after advancing
+  //! \param u Direction of the particle
+  void advance(double distance, Position r, Direction u)
+  {
+    if (n_ == 0) return;
+    if (u != u_) {
+      n_ = 0;
+      cell_ = C_NONE;
+      return;
+    }
+    for (int k = 0; k < n_; ++k) f_[k] += distance * projection_[k];
+    r_ = r;
+  }
+  #pragma omp end declare target
+
+  int32_t cell_ {C_NONE};    //!< ID of the cell, or C_NONE
+  int n_ {0};                //!< Number of planes evaluated
+  Position r_;               //!< Position of the evaluations
+  Direction u_;              //!< Direction of the projections
+  double f_[SIZE];           //!< Evaluation of each plane at r_
+  double projection_[SIZE];  //!< Projection of u_ on the normal of each plane
+};
+
+//============================================================================
+//! Particle state that only optional host-side features use. It is kept out
+//! of Particle itself so that it does not dilute the cache lines touched on
+//! every step, and is allocated only for particles that need it.
+//============================================================================
+
+struct ParticleColdState {
+  // DagMC state variables
+  #ifdef DAGMC
+  moab::DagMC::RayHistory history;
+  Direction last_dir;
+  #endif
+};
+
 //============================================================================
 //! State of a particle being transported through geometry
 //============================================================================
@@ -316,6 +462,29 @@ public:
     neutron, photon, electron, positron
   };
 
+  //! Where a delta-tracked particle is in its flight between tentative
+  //! collisions (see settings::delta_tracking), or whether a surface-tracked
+  //! one moved to a tentative collision of target motion sampling (see
+  //! settings::temperature_tms)
+  enum class DeltaState {
+    none,      //!< Not at a tentative collision
+    tentative, //!< Moved to a tentative collision, still to be located
+    located,   //!< Located at a tentative collision, still to be accepted
+    tms        //!< Moved to a tentative collision in its cell, still to be accepted
+  };
+
+  //! What remains of a collision once its reaction has been sampled (see
+  //! settings::split_collisions). Values are the keys collision queues are
+  //! partitioned by.
+  enum class CollisionClass {
+    none,       //!< Nothing: a tentative delta-tracking collision
+    complete,   //!< Only the post-collision tallies: absorbed or not a neutron
+    elastic,    //!< Elastic scattering off a free target
+    sab,        //!< S(a,b) thermal scattering
+    inelastic   //!< Inelastic scattering
+  };
+  static constexpr int N_COLLISION_CLASSES {5};
+
   //! Saved ("banked") state of a particle
   //! NOTE: This structure's MPI type is built in initialize_mpi() of
   //! initialize.cpp. Any changes made to the struct here must also be
@@ -333,6 +502,7 @@ public:
     Type particle;
     int64_t parent_id;
     int64_t progeny_id;
+    double time; //!< time the particle is emitted in [s]
   };
 
   //! Saved ("banked") state of a particle, for nu-fission tallying
@@ -372,6 +542,10 @@ public:
   //! Whether particle is alive
   bool alive() const { return wgt_ != 0.0; }
 
+  //! Speed of the particle in [cm/s], from its energy. In multigroup mode
+  //! this is the speed at the average energy of its group.
+  double speed() const;
+
   //! resets all coordinate levels for the particle
   void clear();
   #pragma omp end declare target
@@ -388,6 +562,24 @@ public:
   void create_secondary(double wgt, Direction u, double E, Type type);
   #pragma omp end declare target
 
+  //! Add a site to the secondary bank
+  //
+  //! Sites are stored in secondary_bank_ until it is full, after which they
+  //! spill to simulation::secondary_pool.
+  //! \param site The secondary particle site
+  //! \return Whether the site was banked (false if the pool is full)
+  #pragma omp declare target
+  bool push_secondary(const Bank& site);
+
+  //! Remove and return the most recently banked secondary site
+  Bank pop_secondary();
+
+  //! Return a banked secondary site
+  //
+  //! \param i Position of the site in the bank, in order of banking
+  const Bank& secondary(int64_t i) const;
+  #pragma omp end declare target
+
   //! initialize from a source site
   //
   //! initializes a particle from data stored in a source site. The source
@@ -405,6 +597,8 @@ public:
   bool event_calculate_xs_dispatch();
   void event_calculate_xs_execute(bool need_depletion_rx);
   void event_collide();
+  void event_collide_sample();
+  void event_collide_finish();
   void event_advance();
   void event_cross_surface();
   void event_revive_from_secondary();
@@ -435,6 +629,17 @@ public:
   void cross_reflective_bc(const Surface& surf, Direction new_u);
   #pragma omp end declare target
 
+  //! Restore the coordinate levels below the root universe after a
+  //! reflection, which leaves the particle where it was and sends it back
+  //! into the cells it came from. Directions are rotated down from the root
+  //! level as find_cell would, and only the lattice indices, which depend on
+  //! the direction on tile boundaries, are checked.
+  //
+  //! \return Whether the levels were restored, or a cell search is needed
+  #pragma omp declare target
+  bool reflect_lower_levels();
+  #pragma omp end declare target
+
 
   //! Cross a periodic boundary condition.
   //
@@ -450,8 +655,14 @@ public:
   //! mark a particle as lost and create a particle restart file
   //! \param message A warning message to display
   void mark_as_lost(const char* message);
+  //! mark a particle as lost without writing its restart file, which is
+  //! written on host from the record kept in simulation::lost_particles
   #pragma omp declare target
   void mark_as_lost_short();
+
+  //! store the state needed for a restart file of the particle
+  //! \param lost Record to fill
+  void record_lost(LostParticle& lost) const;
   #pragma omp end declare target
 
   void mark_as_lost(const std::string& message)
@@ -463,6 +674,14 @@ public:
   //! create a particle restart HDF5 file
   void write_restart() const;
 
+  //! Gets the state used by track output and DAGMC ray tracing, allocating
+  //! it if this is the first use
+  ParticleColdState& cold()
+  {
+    if (!cold_) cold_ = std::make_unique<ParticleColdState>();
+    return *cold_;
+  }
+
   //! Gets the pointer to the particle's current PRN seed
   #pragma omp declare target
   uint64_t* current_seed() {return seeds_ + stream_;}
@@ -471,59 +690,107 @@ public:
 
   //==========================================================================
   // Data members
+  //
+  // Members are grouped by how often they are touched. The first group is
+  // read or written on every step of a history (XS lookup, boundary search,
+  // advance and collision) and is kept together at the front of the object
+  // so that a step touches as few cache lines as possible. Large arrays that
+  // only some events use come last.
+
+  //--------------------------------------------------------------------------
+  // Per-step state
+
+  int64_t id_;  //!< Unique ID
+  Type type_ {Type::neutron};   //!< Particle type (n, p, e, etc.)
+
+  int n_coord_ {1};              //!< number of current coordinate levels
+  int cell_instance_;            //!< offset for distributed properties
+  int material_ {-1};       //!< index for current material
+  int surface_ {0};         //!< index for surface particle is on
+
+  double E_;       //!< post-collision energy in eV
+  double wgt_ {1.0};     //!< particle weight
+  double time_ {0.0};    //!< time since the start of the history in [s]
+  double sqrtkT_ {-1.0};      //!< sqrt(k_Boltzmann * temperature) in eV
+
+  double collision_distance_; // distance to particle's next closest collision
+  double advance_distance_; // distance the particle actually advanced this event
+
+  // Delta-tracking state
+  DeltaState delta_state_ {DeltaState::none};
+  int delta_level_;       //!< coordinate level of the delta-tracking cell
+  double delta_majorant_; //!< majorant XS the tentative collision was sampled with
+
+  // Target motion sampling state of an accepted collision
+  int tms_nuclide_ {C_NONE}; //!< nuclide collided with, or C_NONE
+  Direction tms_v_t_;        //!< target velocity sampled for it
+
+  // Boundary information
+  BoundaryInfo boundary_;
+  PlaneEvalCache plane_cache_; //!< General planes of the innermost cell
+
+  // Current PRNG state
+  int      stream_;           // current RNG stream
+  uint64_t seeds_[N_STREAMS]; // current seeds
 
   // Cross section caches
 
-  // TODO: neutron_xs_ can eventually be converted to an allocated array, with size fixed at runtime
   //std::vector<NuclideMicroXS> neutron_xs_; //!< Microscopic neutron cross sections
-  //NuclideMicroXS neutron_xs_[NEUTRON_XS_SIZE]; //!< Microscopic neutron cross sections
   NuclideMicroXSCache neutron_xs_; //!< Microscopic neutron cross sections
 
-  // TODO: photon_xs_ can eventually be converted to an allocated array, with size fixed at runtime
-  //std::vector<ElementMicroXS> photon_xs_; //!< Microscopic photon cross sections
-  ElementMicroXS photon_xs_[PHOTON_XS_SIZE]; //!< Microscopic photon cross sections
+  //! Row of simulation::wmp_batch_xs holding this particle's pre-evaluated
+  //! multipole (scatter, absorption, fission) XS for each nuclide in
+  //! data::wmp_nuclides, set only for the duration of a batched XS lookup
+  const double* wmp_xs_ {nullptr};
 
   MacroXS macro_xs_; //!< Macroscopic cross sections
 
-  int64_t id_;  //!< Unique ID
-  Type type_ {Type::neutron};   //!< Particle type (n, p, e, etc.)
+  // What event took place
+  TallyEvent event_;          //!< scatter, absorption
+  int event_nuclide_;  //!< index in nuclides array
+  int event_mt_;       //!< reaction MT
 
-  int n_coord_ {1};              //!< number of current coordinate levels
-  int cell_instance_;            //!< offset for distributed properties
+  // Reaction sampled by event_collide_sample() for event_collide_finish()
+  CollisionClass collision_class_ {CollisionClass::none};
+  int collision_rx_; //!< index of the scattering reaction in the nuclide
+  int n_event_ {0}; // number of events executed in this particle's history
+
+  bool fission_ {false}; //!< did particle cause implicit fission
+  bool trace_ {false};     //!< flag to show debug information
+  bool write_track_ {false}; //!< Track output
+  int n_tracks_ {0};         //!< Number of tracks begun for track output
+  int n_track_points_ {0};   //!< Number of points written in the current track
 
   // TODO: coord_ can eventually be converted to an allocated array, with size fixed at runtime
   //std::vector<LocalCoord> coord_; //!< coordinates for all levels
   LocalCoord coord_[COORD_SIZE]; //!< coordinates for all levels
 
+  //--------------------------------------------------------------------------
+  // Per-collision and per-crossing state
+
   // Particle coordinates before crossing a surface
   int n_coord_last_ {1};      //!< number of current coordinates
+  int n_coord_crossing_ {1};  //!< number of coordinates on reaching the surface
   // TODO: cell_last__ can eventually be converted to an allocated array, with size fixed at runtime
   //std::vector<int> cell_last_;  //!< coordinates for all levels
   int cell_last_[COORD_SIZE];  //!< coordinates for all levels
 
   // Energy data
-  double E_;       //!< post-collision energy in eV
   double E_last_;  //!< pre-collision energy in eV
   int g_ {0};      //!< post-collision energy group (MG only)
   int g_last_;     //!< pre-collision energy group (MG only)
 
   // Other physical data
-  double wgt_ {1.0};     //!< particle weight
   double mu_;      //!< angle of scatter
-
-  // Other physical data
   Position r_last_current_; //!< coordinates of the last collision or
                             //!< reflective/periodic surface crossing for
                             //!< current tallies
   Position r_last_;   //!< previous coordinates
   Direction u_last_;  //!< previous direction coordinates
   double wgt_last_ {1.0};   //!< pre-collision particle weight
-
-  // What event took place
-  bool fission_ {false}; //!< did particle cause implicit fission
-  TallyEvent event_;          //!< scatter, absorption
-  int event_nuclide_;  //!< index in nuclides array
-  int event_mt_;       //!< reaction MT
+  double time_last_ {0.0};  //!< time at the start of the last flight in [s]
+  double sqrtkT_last_ {0.0};  //!< last temperature
+  int material_last_ {-1};  //!< index for last material
   int delayed_group_ {0};  //!< delayed group
 
   // Post-collision physical data
@@ -533,72 +800,140 @@ public:
   int n_delayed_bank_[MAX_DELAYED_GROUPS];  //!< number of delayed fission
                                             //!< sites banked
 
-  // Indices for various arrays
-  int surface_ {0};         //!< index for surface particle is on
+  // Statistical data
+  int n_collision_ {0};  //!< number of collisions
   int cell_born_ {-1};      //!< index for cell particle was born in
-  int material_ {-1};       //!< index for current material
-  int material_last_ {-1};  //!< index for last material
 
-  // Boundary information
-  BoundaryInfo boundary_;
+  // Global tally accumulators
+  double keff_tally_absorption_ {0.0};
+  double keff_tally_collision_ {0.0};
+  double keff_tally_tracklength_ {0.0};
+  double keff_tally_leakage_ {0.0};
 
-  // Temperature of current cell
-  double sqrtkT_ {-1.0};      //!< sqrt(k_Boltzmann * temperature) in eV
-  double sqrtkT_last_ {0.0};  //!< last temperature
+  // TODO: filter_matches_ can eventually be converted to an allocated array, with size fixed at runtime
+  //std::vector<FilterMatch> filter_matches_; // tally filter matches
+  FilterMatch* filter_matches_; // tally filter matches
 
-  // Statistical data
-  int n_collision_ {0};  //!< number of collisions
+  uint64_t secondary_bank_length_ {0}; //!< Number of banked secondaries, inline and spilled
+  int secondary_spill_head_ {-1}; //!< Pool index of the newest spilled secondary
+  int64_t current_work_; // current work index
+  int64_t n_progeny_ {0}; // Number of progeny produced by this particle
 
-  // Track output
-  bool write_track_ {false};
+  //--------------------------------------------------------------------------
+  // Rarely used state
 
-  // Current PRNG state
-  uint64_t seeds_[N_STREAMS]; // current seeds
-  int      stream_;           // current RNG stream
+  //std::vector<ElementMicroXS> photon_xs_; //!< Microscopic photon cross sections
+  ElementMicroXS* photon_xs_ {nullptr}; //!< Slot in simulation::photon_xs_pool
 
-  // Secondary particle bank
-  // This one is necessarilly going to be large/wasteful, unless we add in shared
-  // secondary bank among threads or something along those lines
+  //! Point photon_xs_ at a slot of simulation::photon_xs_pool, or at nothing
+  //! if there is no pool, and invalidate the cached energies. Like
+  //! assign_flux_derivs(), this must be called from the side that will use it.
+  #pragma omp declare target
+  void assign_photon_xs(int slot)
+  {
+    if (!simulation::photon_xs_pool) {
+      photon_xs_ = nullptr;
+      return;
+    }
+    photon_xs_ = simulation::photon_xs_pool +
+      static_cast<int64_t>(slot) * simulation::photon_xs_slot_size;
+    for (int i = 0; i < simulation::photon_xs_slot_size; ++i) {
+      photon_xs_[i].last_E = 0.0;
+    }
+  }
+  #pragma omp end declare target
+
+  // Secondary particle bank. Only the first SECONDARY_BANK_SIZE secondaries
+  // are kept inline; any more are spilled to simulation::secondary_pool and
+  // chained through simulation::secondary_pool_link, so the inline size only
+  // needs to cover the common case. Use push_secondary()/pop_secondary().
   //std::vector<Particle::Bank> secondary_bank_;
   Particle::Bank secondary_bank_[SECONDARY_BANK_SIZE];
-  uint64_t secondary_bank_length_ {0};
-
-  int64_t current_work_; // current work index
 
-  // TODO: flux_derivs can eventually be converted to an allocated array, with size fixed at runtime
-  //std::vector<double> flux_derivs_;  // for derivatives for this particle
-  double flux_derivs_[FLUX_DERIVS_SIZE];  // for derivatives for this particle
+  //std::vector<NuBank> nu_bank_; // bank of most recently fissioned particles
+  NuBank* nu_bank_ {nullptr}; //!< Slot in simulation::nu_bank_pool
 
-  // TODO: filter_matches_ can eventually be converted to an allocated array, with size fixed at runtime
-  //std::vector<FilterMatch> filter_matches_; // tally filter matches
-  FilterMatch* filter_matches_; // tally filter matches
+  //! Point nu_bank_ at a slot of simulation::nu_bank_pool, or at nothing if
+  //! there is no pool. Like assign_flux_derivs(), this must be called from
+  //! the side that will use it.
+  #pragma omp declare target
+  void assign_nu_bank(int slot);
+  #pragma omp end declare target
 
-  std::vector<std::vector<Position>> tracks_; // tracks for outputting to file
+  //std::vector<double> flux_derivs_;  // for derivatives for this particle
+  double* flux_derivs_ {nullptr}; //!< Slot in simulation::flux_derivs_pool
 
-  //std::vector<NuBank> nu_bank_; // bank of most recently fissioned particles
-  NuBank nu_bank_[NU_BANK_SIZE]; // bank of most recently fissioned particles
+  #pragma omp declare target
+  //! Point flux_derivs_ at a slot of simulation::flux_derivs_pool. Like
+  //! NuclideMicroXSCache::assign(), this must be called from the same side
+  //! (host or device) that will use the derivatives.
+  void assign_flux_derivs(int slot)
+  {
+    flux_derivs_ = simulation::flux_derivs_pool +
+      static_cast<int64_t>(slot) * simulation::flux_derivs_slot_size;
+  }
 
-  // Global tally accumulators
-  double keff_tally_absorption_ {0.0};
-  double keff_tally_collision_ {0.0};
-  double keff_tally_tracklength_ {0.0};
-  double keff_tally_leakage_ {0.0};
+  //! Zero the accumulated flux derivatives
+  void clear_flux_derivs()
+  {
+    for (int i = 0; i < simulation::flux_derivs_slot_size; ++i) {
+      flux_derivs_[i] = 0.0;
+    }
+  }
+  #pragma omp end declare target
 
-  bool trace_ {false};     //!< flag to show debug information
+  // Running sum of the macroscopic total XS over the nuclides of the material,
+  // filled by Material::calculate_neutron_xs() so that sample_nuclide() can
+  // search it instead of walking the nuclides. It is valid for the material,
+  // energy and temperature it was computed at.
+  double* nuclide_cdf_ {nullptr}; //!< Slot in simulation::nuclide_cdf_pool
+  int32_t nuclide_cdf_material_ {C_NONE}; //!< Material of nuclide_cdf_
+  double nuclide_cdf_E_ {0.0};      //!< Energy of nuclide_cdf_ in [eV]
+  double nuclide_cdf_sqrtkT_ {0.0}; //!< Temperature of nuclide_cdf_ in [sqrt(eV)]
+
+  //! Point nuclide_cdf_ at a slot of simulation::nuclide_cdf_pool, or at
+  //! nothing if there is no pool. Like assign_flux_derivs(), this must be
+  //! called from the side that will use it.
+  #pragma omp declare target
+  void assign_nuclide_cdf(int slot)
+  {
+    nuclide_cdf_ = simulation::nuclide_cdf_pool ?
+      simulation::nuclide_cdf_pool +
+      static_cast<int64_t>(slot) * simulation::nuclide_cdf_slot_size : nullptr;
+    nuclide_cdf_material_ = C_NONE;
+  }
+  #pragma omp end declare target
 
-  double collision_distance_; // distance to particle's next closest collision
+  // Cross sections of the reactions of simulation::depletion_rx, filled by
+  // Material::calculate_neutron_xs() when depletion reaction rates are tallied
+  double* depletion_rx_ {nullptr}; //!< Slot in simulation::depletion_rx_pool
 
-  double advance_distance_; // distance the particle actually advanced this event
+  //! Point depletion_rx_ at a slot of simulation::depletion_rx_pool, or at
+  //! nothing if there is no pool. Like assign_flux_derivs(), this must be
+  //! called from the side that will use it.
+  #pragma omp declare target
+  void assign_depletion_rx(int slot)
+  {
+    depletion_rx_ = simulation::depletion_rx_pool ?
+      simulation::depletion_rx_pool +
+      static_cast<int64_t>(slot) * simulation::depletion_rx_slot_size : nullptr;
+  }
 
-  int n_event_ {0}; // number of events executed in this particle's history
+  //! Macroscopic XS of each depletion reaction in the current material
+  double* macro_rx() { return depletion_rx_; }
 
-  // DagMC state variables
-  #ifdef DAGMC
-  moab::DagMC::RayHistory history_;
-  Direction last_dir_;
+  #ifndef NO_MICRO_XS_CACHE
+  //! Cached microscopic XS of each depletion reaction of a nuclide
+  double* micro_rx(int i_nuclide)
+  {
+    return depletion_rx_ + (1 + static_cast<int64_t>(i_nuclide)) *
+      simulation::n_depletion_rx;
+  }
   #endif
+  #pragma omp end declare target
 
-  int64_t n_progeny_ {0}; // Number of progeny produced by this particle
+  //! Host-only state of optional features, allocated by cold() on first use
+  std::unique_ptr<ParticleColdState> cold_;
 
   bool operator<(const Particle& rhs) const
   {
@@ -613,6 +948,66 @@ public:
   }
 };
 
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+// Pool from which each particle's bank of the neutrons of its latest fission
+// is carved, with nu_bank_pool_slots slots of nu_bank_slot_size
+// (settings::nu_bank_size) entries each. It is only allocated when a tally
+// scores the individual fission neutrons (see tallies_need_nu_bank()).
+#pragma omp declare target
+extern Particle::NuBank* nu_bank_pool;
+extern int nu_bank_slot_size;
+#pragma omp end declare target
+extern int nu_bank_pool_slots;
+
+} // namespace simulation
+
+//============================================================================
+//! State of a lost particle kept for its restart file, so that particles
+//! lost on device can be reported without copying back the particle buffer
+//============================================================================
+
+struct LostParticle {
+  int64_t id;                 //!< Unique ID
+  int64_t current_work;       //!< Index of the history in the source bank
+  Particle::Type type;        //!< Particle type
+  Position r;                 //!< Position where the particle was lost
+  Direction u;                //!< Direction where the particle was lost
+  double E;                   //!< Energy in [eV]
+  double wgt;                 //!< Weight
+  uint64_t seeds[N_STREAMS];  //!< Random number seeds
+  int n_coord;                //!< Number of coordinate levels
+  int cell[COORD_SIZE];       //!< Index of the cell at each level
+  int material;               //!< Index of the material
+  int surface;                //!< Signed index of the surface
+  Particle::Bank source;      //!< Source site, for eigenvalue runs
+};
+
+namespace simulation {
+
+// Records of the particles lost since they were last checked, of which the
+// first lost_particle_capacity are kept. n_lost_records counts every loss,
+// so that it is the only value copied back while no particle is lost.
+#pragma omp declare target
+extern LostParticle* lost_particles;
+extern int lost_particle_capacity;
+extern int n_lost_records;
+#pragma omp end declare target
+
+} // namespace simulation
+
+#pragma omp declare target
+inline void Particle::assign_nu_bank(int slot)
+{
+  nu_bank_ = simulation::nu_bank_pool ? simulation::nu_bank_pool +
+    static_cast<int64_t>(slot) * simulation::nu_bank_slot_size : nullptr;
+}
+#pragma omp end declare target
+
 //============================================================================
 //! Functions
 //============================================================================
@@ -621,6 +1016,94 @@ std::string particle_type_to_str(Particle::Type type);
 
 Particle::Type str_to_particle_type(std::string str);
 
+//! Allocate simulation::micro_xs_pool on host and device with enough room for
+//! the microscopic XS caches of n_slots particles. Any existing pool is freed.
+//! Particles must call NuclideMicroXSCache::assign() to claim a slot.
+//
+//! \param n_slots The number of particles that may have a live cache at once
+void reserve_micro_xs_pool(int n_slots);
+
+//! Release simulation::micro_xs_pool on host and device
+void free_micro_xs_pool();
+
+//! Allocate simulation::flux_derivs_pool on host and device with room for the
+//! flux derivatives of n_slots particles, one per tally derivative. Any
+//! existing pool is freed. Particles must call Particle::assign_flux_derivs()
+//! to claim a slot.
+//
+//! \param n_slots The number of particles that may be in flight at once
+void reserve_flux_derivs_pool(int n_slots);
+
+//! Release simulation::flux_derivs_pool on host and device
+void free_flux_derivs_pool();
+
+//! Allocate simulation::nuclide_cdf_pool on host and device with room for the
+//! cumulative nuclide XS of n_slots particles, when settings::nuclide_cdf is
+//! set. Any existing pool is freed. Particles must call
+//! Particle::assign_nuclide_cdf() to claim a slot.
+//
+//! \param n_slots The number of particles that may be in flight at once
+void reserve_nuclide_cdf_pool(int n_slots);
+
+//! Release simulation::nuclide_cdf_pool on host and device
+void free_nuclide_cdf_pool();
+
+//! Allocate simulation::depletion_rx_pool on host and device with room for the
+//! depletion reaction XS of n_slots particles, when simulation::depletion_rx
+//! is not empty. Any existing pool is freed. Particles must call
+//! Particle::assign_depletion_rx() to claim a slot.
+//
+//! \param n_slots The number of particles that may be in flight at once
+void reserve_depletion_rx_pool(int n_slots);
+
+//! Release simulation::depletion_rx_pool on host and device
+void free_depletion_rx_pool();
+
+//! Allocate simulation::photon_xs_pool on host and device with room for the
+//! microscopic photon XS caches of n_slots particles, when photon transport is
+//! on. Any existing pool is freed. Particles must call
+//! Particle::assign_photon_xs() to claim a slot.
+//
+//! \param n_slots The number of particles that may be in flight at once
+void reserve_photon_xs_pool(int n_slots);
+
+//! Release simulation::photon_xs_pool on host and device
+void free_photon_xs_pool();
+
+//! Whether any tally scores the individual neutrons of a fission, i.e., an
+//! analog tally of fission neutron production with an outgoing energy filter
+//! or of delayed neutron precursor decay
+bool tallies_need_nu_bank();
+
+//! Allocate simulation::nu_bank_pool on host and device with room for the
+//! fission neutron banks of n_slots particles, when tallies_need_nu_bank().
+//! Any existing pool is freed. Particles must call Particle::assign_nu_bank()
+//! to claim a slot.
+//
+//! \param n_slots The number of particles that may be in flight at once
+void reserve_nu_bank_pool(int n_slots);
+
+//! Release simulation::nu_bank_pool on host and device
+void free_nu_bank_pool();
+
+//! Allocate simulation::lost_particles on host and device with room for
+//! settings::max_lost_particles records, beyond which the simulation stops
+//! unless rel_max_lost_particles allows more losses
+void reserve_lost_particles();
+
+//! Release simulation::lost_particles on host and device
+void free_lost_particles();
+
+//! Write the restart file of a lost particle
+//! \param lost State of the particle when it was lost
+void write_particle_restart(const LostParticle& lost);
+
+//! Report the particles recorded as lost since the last check, writing their
+//! restart files, and stop the simulation if too many have been lost
+//! \param on_device Whether the records were made on device, in which case
+//!   only the count is copied back unless a particle was lost
+void check_lost_particles(bool on_device);
+
 } // namespace openmc
 
 #endif // OPENMC_PARTICLE_H
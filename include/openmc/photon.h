@@ -18,6 +18,61 @@
 
 namespace openmc {
 
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Tabulated incoherent scattering (see settings::compton_table_quantiles):
+// alpha points per decade, and points of the fine grid the distribution is
+// integrated on per quantile
+constexpr int COMPTON_TABLE_POINTS_PER_DECADE {16};
+constexpr int COMPTON_TABLE_FINE_POINTS {16};
+
+//==============================================================================
+//! Quantiles of the incoherent scattering distribution on a log-uniform grid
+//! of alpha, so that the outgoing photon energy and angle are sampled with a
+//! single random number instead of by rejection. The quantiles are of
+//! u = ln(alpha/alpha') / ln(1 + 2 alpha), which lies in [0, 1] at any alpha.
+//==============================================================================
+
+class ComptonTable {
+public:
+  //! Tabulate the Klein-Nishina distribution, times the incoherent scattering
+  //! function if one is given, by integrating it on a fine grid of u
+  //
+  //! \param[in] alpha_min Lowest photon energy over electron rest mass
+  //! \param[in] alpha_max Highest photon energy over electron rest mass
+  //! \param[in] n_quantiles Number of equiprobable intervals per alpha point
+  //! \param[in] form_factor Incoherent scattering function S(x), or nullptr
+  //!   for scattering off free electrons
+  void init(double alpha_min, double alpha_max, int n_quantiles,
+    const Tabulated1D* form_factor);
+
+  //! Sample the outgoing energy and scattering cosine, interpolating the
+  //! quantiles linearly in u and in log(alpha)
+  //
+  //! \param[in] alpha Photon energy over electron rest mass
+  //! \param[out] alpha_out Outgoing photon energy over electron rest mass
+  //! \param[out] mu Scattering cosine
+  //! \param[inout] seed Pseudorandom seed pointer
+  #pragma omp declare target
+  void sample(double alpha, double* alpha_out, double* mu, uint64_t* seed) const;
+  #pragma omp end declare target
+
+  void copy_to_device() { quantiles_.copy_to_device(); }
+  void release_device() { quantiles_.release_device(); }
+
+  bool empty() const { return quantiles_.empty(); }
+  size_t nbytes() const { return quantiles_.size() * sizeof(double); }
+
+  //! n_quantiles_ + 1 quantile boundaries for each of n_alpha_ alpha points
+  vector<double> quantiles_;
+  int n_alpha_ {0};       //!< Number of alpha points
+  int n_quantiles_ {0};   //!< Number of equiprobable intervals per point
+  double log_alpha_min_;  //!< Log of the lowest alpha
+  double inv_du_;         //!< Inverse log spacing of the alpha points
+};
+
 //==============================================================================
 //! Photon interaction data for a single element
 //==============================================================================
@@ -121,6 +176,10 @@ public:
   // Bremsstrahlung scaled DCS
   xt::xtensor<double, 2> dcs_;
 
+  // Incoherent scattering distribution, when settings::compton_table_quantiles
+  // is set
+  ComptonTable compton_table_;
+
   // Constant data
   static constexpr int MAX_STACK_SIZE =
     7; //!< maximum possible size of atomic relaxation stack
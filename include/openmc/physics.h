@@ -20,9 +20,26 @@ namespace openmc {
 void collision(Particle& p);
 #pragma omp end declare target
 
-//! Samples an incident neutron reaction
+//! Sample the nuclide and reaction of a collision, performing all of it
+//! except any neutron scattering, which is left to finish_collision(). Sets
+//! Particle::collision_class_.
+#pragma omp declare target
+void sample_collision(Particle& p);
+#pragma omp end declare target
+
+//! Perform the scattering reaction sampled by sample_collision(), if any, and
+//! apply the energy cutoff
+#pragma omp declare target
+void finish_collision(Particle& p);
+#pragma omp end declare target
+
+//! Samples an incident neutron reaction, performing its absorption and
+//! fission but only sampling its scattering reaction
 void sample_neutron_reaction(Particle& p);
 
+//! Performs the scattering reaction sampled by sample_neutron_reaction()
+void finish_neutron_reaction(Particle& p);
+
 //! Samples an element based on the macroscopic cross sections for each nuclide
 //! within a material and then samples a reaction for that element and calls the
 //! appropriate routine to process the physics.
@@ -60,6 +77,11 @@ void sample_photon_product(int i_nuclide, Particle& p, int* i_rx, int* i_product
 
 void absorption(Particle& p, int i_nuclide);
 
+//! Samples which scattering reaction a neutron undergoes with a nuclide,
+//! setting Particle::collision_class_ and Particle::collision_rx_
+void sample_scatter(Particle& p, int i_nuclide);
+
+//! Performs the scattering reaction sampled by sample_scatter()
 void scatter(Particle& p, int i_nuclide);
 
 //! Treats the elastic scattering of a neutron with a target.
@@ -82,6 +104,29 @@ Direction sample_target_velocity(const Nuclide& nuc, double E, Direction u,
 Direction sample_cxs_target_velocity(double awr, double E, Direction u, double kT,
   uint64_t* seed);
 
+//! samples a target velocity from the Maxwellian distribution of thermal
+//! motion alone, without the weighting by relative speed of free gas
+//! scattering, up to a reduced speed of TMS_SPEED_CUTOFF
+Direction sample_maxwellian_target_velocity(double awr, Direction u, double kT,
+  uint64_t* seed);
+
+//! Accept or reject a tentative collision sampled with the target motion
+//! sampling majorant of the particle's material (see
+//! Material::tms_majorant_xs()). The nuclide is selected by the cutoff, and a
+//! target velocity is sampled at the difference between the particle's
+//! temperature and the nuclide's; the collision is real at the rate of the
+//! nuclide's XS at the relative energy. A real collision leaves the nuclide,
+//! its XS at the relative energy and the target velocity in the particle for
+//! the reaction to be sampled with. Every tentative collision scores the
+//! track-length estimate of k-eff.
+//
+//! \param p Particle at the tentative collision
+//! \param cutoff Uniform sample between zero and the material's majorant
+//! \return Whether the collision is real
+#pragma omp declare target
+bool sample_tms_collision(Particle& p, double cutoff);
+#pragma omp end declare target
+
 void sample_fission_neutron(int i_nuclide, const ReactionFlat& rx, double E_in,
   Particle::Bank* site, uint64_t* seed);
 
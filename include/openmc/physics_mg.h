@@ -14,8 +14,10 @@ namespace openmc {
 
 //! \brief samples particle behavior after a collision event.
 //! \param p Particle to operate on
+#pragma omp declare target
 void
 collision_mg(Particle& p);
+#pragma omp end declare target
 
 //! \brief samples a reaction type.
 //!
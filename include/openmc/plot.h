@@ -164,9 +164,13 @@ T PlotBase::get_map() const {
   xyz[in_i] = origin_[in_i] - width_[0] / 2. + in_pixel / 2.;
   xyz[out_i] = origin_[out_i] + width_[1] / 2. - out_pixel / 2.;
 
-  // arbitrary direction
+  // arbitrary direction for locating single points
   Direction dir = {0.7071, 0.7071, 0.0};
 
+  // rows are traced along the horizontal basis direction
+  Direction row_dir = {0.0, 0.0, 0.0};
+  row_dir[in_i] = 1.0;
+
   #pragma omp parallel
   {
     Particle p;
@@ -176,23 +180,83 @@ T PlotBase::get_map() const {
     int level = level_;
     int j{};
 
-    #pragma omp for
+    #pragma omp for schedule(dynamic)
     for (int y = 0; y < height; y++) {
       p.r()[out_i] =  xyz[out_i] - out_pixel * y;
-      for (int x = 0; x < width; x++) {
-        p.r()[in_i] = xyz[in_i] + in_pixel * x;
-        p.n_coord_ = 1;
-        // local variables
-        bool found_cell = exhaustive_find_cell(p);
+
+      // Overlaps are only found by testing every pixel center against every
+      // cell, so these plots locate each pixel separately
+      if (color_overlaps_) {
+        p.u() = dir;
+        for (int x = 0; x < width; x++) {
+          p.r()[in_i] = xyz[in_i] + in_pixel * x;
+          p.n_coord_ = 1;
+          // local variables
+          bool found_cell = exhaustive_find_cell(p);
+          j = p.n_coord_ - 1;
+          if (level >= 0) { j = level; }
+          if (found_cell) {
+            data.set_value(y, x, p, j);
+          }
+          if (check_cell_overlap(p, false)) {
+            data.set_overlap(y, x);
+          }
+        } // inner for
+        continue;
+      }
+
+      // Trace a ray along the row from the center of its first pixel. Every
+      // pixel center before the next boundary crossing lies in the cell found
+      // at the start of the segment.
+      p.u() = row_dir;
+      bool found_cell = false;
+      double s = 0.0; // distance traveled from the first pixel center
+      int x = 0;
+      while (x < width) {
+        if (!found_cell) {
+          // Outside of the geometry, locate the pixel center on its own
+          s = in_pixel * x;
+          p.r()[in_i] = xyz[in_i] + s;
+          p.n_coord_ = 1;
+          p.surface_ = 0;
+          found_cell = exhaustive_find_cell(p);
+          if (!found_cell) ++x;
+          continue;
+        }
+
+        BoundaryInfo boundary = distance_to_boundary(p);
+        double s_next = s + boundary.distance;
         j = p.n_coord_ - 1;
         if (level >= 0) { j = level; }
-        if (found_cell) {
+        while (x < width && in_pixel * x < s_next) {
           data.set_value(y, x, p, j);
+          ++x;
+        }
+        if (x == width) break;
+
+        // Move to the boundary and find the cell on the other side of it
+        for (int k = 0; k < p.n_coord_; ++k) {
+          p.coord_[k].r += boundary.distance * p.coord_[k].u;
         }
-        if (color_overlaps_ && check_cell_overlap(p, false)) {
-          data.set_overlap(y, x);
+        s = s_next;
+        p.surface_ = boundary.surface_index;
+        p.n_coord_ = boundary.coord_level;
+        if (boundary.lattice_translation[0] != 0 ||
+            boundary.lattice_translation[1] != 0 ||
+            boundary.lattice_translation[2] != 0) {
+          cross_lattice(p, boundary);
+          int32_t i_cell = p.coord_[p.n_coord_ - 1].cell;
+          found_cell = i_cell != C_NONE &&
+            model::cells[i_cell].type_ == Fill::MATERIAL;
+        } else {
+          found_cell = neighbor_list_find_cell(p);
+          if (!found_cell) {
+            p.surface_ = 0;
+            p.n_coord_ = 1;
+            found_cell = exhaustive_find_cell(p);
+          }
         }
-      } // inner for
+      } // row trace
     } // outer for
   } // omp parallel
 
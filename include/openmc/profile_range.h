@@ -0,0 +1,63 @@
+//! \file profile_range.h
+//! \brief Named ranges around the hot kernels and phases of a run, for
+//! external profilers (NVTX, ROCTX, LIKWID or PAPI). Built in only with the
+//! profile_ranges CMake option; otherwise they compile to nothing.
+
+#ifndef OPENMC_PROFILE_RANGE_H
+#define OPENMC_PROFILE_RANGE_H
+
+#if defined(PROFILE_RANGES_NVTX) || defined(PROFILE_RANGES_ROCTX) || \
+  defined(PROFILE_RANGES_LIKWID) || defined(PROFILE_RANGES_PAPI)
+#define PROFILE_RANGES
+#endif
+
+namespace openmc {
+
+//==============================================================================
+//! Marks its lifetime as a named range for the profiler built in. LIKWID and
+//! PAPI count hardware events of the calling thread only, so a range opened by
+//! the master thread around a parallel kernel measures that thread's share.
+//==============================================================================
+
+class ProfileRange {
+public:
+#ifdef PROFILE_RANGES
+  //! \param name Name of the range, which must outlive it
+  explicit ProfileRange(const char* name);
+
+  //! \param region Kernel profile region, named by profile_region_name()
+  explicit ProfileRange(int region);
+
+  ~ProfileRange();
+#else
+  explicit ProfileRange(const char*) {}
+  explicit ProfileRange(int) {}
+#endif
+
+  ProfileRange(const ProfileRange&) = delete;
+  ProfileRange& operator=(const ProfileRange&) = delete;
+
+#ifdef PROFILE_RANGES
+private:
+  const char* name_;
+#endif
+};
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+#ifdef PROFILE_RANGES
+//! Start the profiler's marker API, where it needs starting
+void init_profile_ranges();
+
+//! Stop the profiler's marker API and have it write its results
+void finalize_profile_ranges();
+#else
+inline void init_profile_ranges() {}
+inline void finalize_profile_ranges() {}
+#endif
+
+} // namespace openmc
+
+#endif // OPENMC_PROFILE_RANGE_H
@@ -55,7 +55,9 @@ double future_prn(int64_t n, uint64_t seed);
 //! @return The initialized seed value
 //==============================================================================
 
+#pragma omp declare target
 uint64_t init_seed(int64_t id, int offset);
+#pragma omp end declare target
 
 //==============================================================================
 //! Set the RNG seeds to unique values based on the ID of the particle. This
@@ -93,6 +95,33 @@ void advance_prn_seed(int64_t n, uint64_t* seed);
 uint64_t future_seed(uint64_t n, uint64_t seed);
 #pragma omp end declare target
 
+//==============================================================================
+//! Compute the parameters G and C such that advancing a seed 'n' times gives
+//! G*seed + C (mod 2^M).
+//!
+//! Precomputing these once for a fixed skip distance turns every subsequent
+//! skip ahead by that distance into a single multiply-add.
+//! @param n The number of RNG seeds to skip ahead by
+//! @param g Multiplicative skip-ahead factor
+//! @param c Additive skip-ahead factor
+//==============================================================================
+
+#pragma omp declare target
+void skip_ahead_params(uint64_t n, uint64_t* g, uint64_t* c);
+
+//==============================================================================
+//! Generate a random number ahead of the current seed by a skip distance whose
+//! parameters were precomputed with skip_ahead_params(). The result is the
+//! same as that of future_prn() for the same skip distance.
+//! @param g Multiplicative skip-ahead factor
+//! @param c Additive skip-ahead factor
+//! @param seed Pseudorandom number seed
+//! @return A random number between 0 and 1
+//==============================================================================
+
+double skip_ahead_prn(uint64_t g, uint64_t c, uint64_t seed);
+#pragma omp end declare target
+
 //==============================================================================
 //                               API FUNCTIONS
 //==============================================================================
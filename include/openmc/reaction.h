@@ -56,6 +56,7 @@ public:
   bool redundant_;     //!< redundant reaction?
   std::vector<TemperatureXS> xs_; //!< Cross section at each temperature
   std::vector<ReactionProduct> products_; //!< Reaction products
+  hsize_t pruned_bytes_ {0}; //!< Bytes of products left unread (see settings::prune_nuclear_data)
 };
 
 class ReactionFlat {
@@ -95,10 +96,15 @@ class ReactionFlatContainer {
 public:
   // Constructors
   explicit ReactionFlatContainer(const Reaction& rx);
+  //! Copy a reaction serialized earlier
+  ReactionFlatContainer(const uint8_t* data, size_t n);
 
   void copy_to_device();
   void release_from_device();
 
+  const uint8_t* data() const { return buffer_.data_; }
+  size_t size() const { return buffer_.size(); }
+
   #pragma omp declare target
   ReactionFlat obj() const;
   #pragma omp end declare target
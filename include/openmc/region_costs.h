@@ -0,0 +1,62 @@
+//! \file region_costs.h
+//! \brief Events and estimated time of event-based transport attributed to
+//! each cell and material, from a sample of the particles in the event queues
+
+#ifndef OPENMC_REGION_COSTS_H
+#define OPENMC_REGION_COSTS_H
+
+#include <cstdint>
+
+#include "openmc/event.h"
+
+namespace openmc {
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+#pragma omp declare target
+// Sampled events of each type in each cell and each material, indexed by
+// [type][cell] and [type][material]. The last material is void.
+extern int64_t* device_cell_event_counts;
+extern int64_t* device_material_event_counts;
+#pragma omp end declare target
+
+} // namespace simulation
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Whether events are attributed to cells and materials, i.e.
+//! settings::path_region_costs is set in event-based mode
+bool counting_region_costs();
+
+//! Allocate and zero the event counts on host and device. Does nothing unless
+//! region costs are counted.
+void init_region_costs();
+
+//! Count the events of the sampled particles in the queue of an event about to
+//! be processed
+//
+//! \param type The event kernel about to be launched
+void count_region_events(EventType type);
+
+//! Add the elapsed time of a launch to the time shared out among the regions
+//! its events were in
+//
+//! \param type The event kernel launched
+//! \param seconds Elapsed time of the launch in [s]
+void record_region_event_time(EventType type, double seconds);
+
+//! Reduce the counts onto the master process, write the report to
+//! settings::path_region_costs with a summary of the costliest regions, and
+//! free the counts. The time of each event type is shared out among regions in
+//! proportion to their sampled events of that type.
+void write_region_costs();
+
+} // namespace openmc
+
+#endif // OPENMC_REGION_COSTS_H
@@ -0,0 +1,28 @@
+//! \file run_status.h
+//! \brief JSON status file with the progress, rates, eigenvalue, triggers and
+//! memory of a run, rewritten after every batch for monitoring long jobs
+
+#ifndef OPENMC_RUN_STATUS_H
+#define OPENMC_RUN_STATUS_H
+
+namespace openmc {
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Whether a status file is written, i.e. settings::path_status is set
+bool writing_run_status();
+
+//! Start timing the batches reported in the status file
+void init_run_status();
+
+//! Replace the status file with the state of the run after the current batch.
+//! Must be called on every process, as memory use is reduced over them.
+//
+//! \param[in] finished Whether the simulation has ended
+void write_run_status(bool finished);
+
+} // namespace openmc
+
+#endif // OPENMC_RUN_STATUS_H
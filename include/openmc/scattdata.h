@@ -16,6 +16,7 @@ namespace openmc {
 // forward declarations so we can name our friend functions
 class ScattDataLegendre;
 class ScattDataTabular;
+class MgxsTables;
 
 //==============================================================================
 // SCATTDATA contains all the data needed to describe the scattering energy and
@@ -145,6 +146,7 @@ class ScattDataLegendre: public ScattData {
     // parameters
     friend void
     convert_legendre_to_tabular(ScattDataLegendre& leg, ScattDataTabular& tab);
+    friend class MgxsTables;
 
   public:
 
@@ -187,6 +189,8 @@ class ScattDataHistogram: public ScattData {
     double dmu;                // Quick storage of the mu spacing
     double_3dvec fmu;          // The angular distribution histogram
 
+    friend class MgxsTables;
+
   public:
 
     void
@@ -227,6 +231,7 @@ class ScattDataTabular: public ScattData {
     // parameters
     friend void
     convert_legendre_to_tabular(ScattDataLegendre& leg, ScattDataTabular& tab);
+    friend class MgxsTables;
 
   public:
 
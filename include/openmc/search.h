@@ -4,7 +4,10 @@
 #ifndef OPENMC_SEARCH_H
 #define OPENMC_SEARCH_H
 
-#include <algorithm> // for lower_bound, upper_bound
+#include <algorithm> // for lower_bound, upper_bound, min, max
+#include <cmath>     // for log
+#include <cstddef>   // for size_t, ptrdiff_t
+#include <vector>
 
 namespace openmc {
 
@@ -26,6 +29,52 @@ upper_bound_index(It first, It last, const T& value)
   return std::upper_bound(first, last, value) - first - 1;
 }
 
+//! Bin of a value on a logarithmic hash of a grid (see log_hash_start)
+
+inline size_t log_hash_bin(double value, double log_x0, double inv_spacing,
+  size_t n_hash)
+{
+  auto b = static_cast<size_t>((std::log(value) - log_x0) * inv_spacing);
+  return std::min(b, n_hash - 1);
+}
+
+//! Hash an ascending, positive grid on n_hash logarithmic bins between its
+//! first and last points. Entry b is the first point whose own bin is at
+//! least b, and a final entry holds the number of points, so that as points
+//! are binned the same way as the values looked up, the interval containing a
+//! value lies between the starts of its bin and of the next.
+
+inline std::vector<int> log_hash_start(const double* x, size_t n,
+  size_t n_hash, double& log_x0, double& inv_spacing)
+{
+  log_x0 = std::log(x[0]);
+  inv_spacing = n_hash / std::log(x[n - 1] / x[0]);
+  std::vector<int> start(n_hash + 1, static_cast<int>(n));
+  size_t b = 0;
+  for (int i = 0; i < n; ++i) {
+    size_t b_i = log_hash_bin(x[i], log_x0, inv_spacing, n_hash);
+    while (b <= b_i) start[b++] = i;
+  }
+  return start;
+}
+
+//! lower_bound_index() of a value within a grid hashed by log_hash_start(),
+//! searching only the points of its bin and of the neighbouring ones. The
+//! neighbours cover a logarithm on device that rounds differently from the
+//! one on host that built the hash.
+
+inline std::ptrdiff_t hashed_lower_bound_index(const double* x, size_t n,
+  const int* start, size_t n_hash, double log_x0, double inv_spacing,
+  double value)
+{
+  size_t b = log_hash_bin(value, log_x0, inv_spacing, n_hash);
+  const double* first = x + start[b > 0 ? b - 1 : 0];
+  const double* last = x + std::min<size_t>(start[std::min(b + 2, n_hash)] + 1,
+    n);
+  std::ptrdiff_t i = std::lower_bound(first, last, value) - x - 1;
+  return std::max<std::ptrdiff_t>(i, 0);
+}
+
 } // namespace openmc
 
 #endif // OPENMC_SEARCH_H
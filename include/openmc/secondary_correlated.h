@@ -11,6 +11,7 @@
 #include "xtensor/xtensor.hpp"
 
 #include "openmc/angle_energy.h"
+#include "openmc/constants.h"
 #include "openmc/endf.h"
 #include "openmc/distribution.h"
 #include "openmc/secondary_flat.h"
@@ -46,6 +47,10 @@ public:
 
   void serialize(DataBuffer& buffer) const override;
 
+  //! Decode the distribution into data::ae_tables, after which it is
+  //! serialized as its handle
+  void decode();
+
   // energy property
   std::vector<double>& energy() { return energy_; }
   const std::vector<double>& energy() const { return energy_; }
@@ -54,12 +59,15 @@ public:
   std::vector<CorrTable>& distribution() { return distribution_; }
   const std::vector<CorrTable>& distribution() const { return distribution_; }
 private:
+  friend class AngleEnergyTables;
+
   int n_region_; //!< Number of interpolation regions
   std::vector<int> breakpoints_; //!< Breakpoints between regions
   std::vector<Interpolation> interpolation_; //!< Interpolation laws
   std::vector<double> energy_; //!< Energies [eV] at which distributions
                                //!< are tabulated
   std::vector<CorrTable> distribution_; //!< Distribution at each energy
+  int handle_ {C_NONE}; //!< Index in data::ae_tables, if decoded into it
 };
 
 class CorrTableFlat {
@@ -18,7 +18,8 @@ enum class AngleEnergyType {
   INCOHERENT_ELASTIC,
   INCOHERENT_ELASTIC_DISCRETE,
   INCOHERENT_INELASTIC,
-  INCOHERENT_INELASTIC_DISCRETE
+  INCOHERENT_INELASTIC_DISCRETE,
+  DECODED_TABLE //!< Handle of a distribution decoded into data::ae_tables
 };
 
 class AngleEnergyFlat {
@@ -35,7 +35,13 @@ public:
   void sample(double E_in, double& E_out, double& mu, uint64_t* seed) const override;
 
   void serialize(DataBuffer& buffer) const override;
+
+  //! Decode the distribution into data::ae_tables, after which it is
+  //! serialized as its handle
+  void decode();
 private:
+  friend class AngleEnergyTables;
+
   //! Outgoing energy/angle at a single incoming energy
   struct KMTable {
     int n_discrete; //!< Number of discrete lines
@@ -53,6 +59,7 @@ private:
   std::vector<double> energy_; //!< Energies [eV] at which distributions
                                //!< are tabulated
   std::vector<KMTable> distribution_; //!< Distribution at each energy
+  int handle_ {C_NONE}; //!< Index in data::ae_tables, if decoded into it
 };
 
 class KMTableFlat {
@@ -0,0 +1,119 @@
+//! \file secondary_tables.h
+//! \brief Kalbach-Mann and correlated angle-energy distributions decoded at
+//! load time into shared tables
+
+#ifndef OPENMC_SECONDARY_TABLES_H
+#define OPENMC_SECONDARY_TABLES_H
+
+#include <cstdint>
+#include <vector>
+
+#include "xtensor/xtensor.hpp"
+
+#include "openmc/endf.h"
+#include "openmc/vector.h"
+#include "openmc/xs_cache.h"
+
+namespace openmc {
+
+class CorrelatedAngleEnergy;
+class KalbachMann;
+
+//===============================================================================
+//! Every KalbachMann and CorrelatedAngleEnergy distribution decoded at load
+//! time into arrays indexed by distribution, by incident energy table and by
+//! outgoing energy point (see settings::decoded_distributions). The outgoing
+//! distributions of all tables are contiguous, incident energy grids are
+//! hashed on a logarithmic grid, and outgoing energy bins are found by binary
+//! search of the CDF. Samples are the same as those of KalbachMannFlat and
+//! CorrelatedAngleEnergyFlat.
+//===============================================================================
+
+class AngleEnergyTables {
+public:
+  //! Decode a distribution
+  //! \param[in] dist The distribution
+  //! \return Handle of the distribution
+  int add(const KalbachMann& dist);
+  int add(const CorrelatedAngleEnergy& dist);
+
+  //! Sample an outgoing energy and angle of a distribution
+  //! \param[in] handle Handle of the distribution
+  //! \param[in] E_in Incoming energy in [eV]
+  //! \param[out] E_out Outgoing energy in [eV]
+  //! \param[out] mu Outgoing cosine with respect to current direction
+  //! \param[inout] seed Pseudorandom seed pointer
+  #pragma omp declare target
+  void sample(int handle, double E_in, double& E_out, double& mu,
+    uint64_t* seed) const;
+  #pragma omp end declare target
+
+  void copy_to_device();
+  void release_device();
+  void clear();
+
+  //! Write the tables to, or replace them with those of, a compiled library
+  void write_cache(XsCacheWriter& cache) const;
+  void read_cache(XsCacheReader& cache);
+
+  bool empty() const { return kalbach_.size() == 0; }
+
+  //! Number of bytes the tables occupy
+  size_t nbytes() const;
+
+private:
+  //! Add the incident energies of a distribution and their hash
+  void add_energies(const std::vector<double>& energy);
+
+  //! Add the outgoing energy points of a table
+  void add_table(int n_discrete, Interpolation interpolation,
+    const xt::xtensor<double, 1>& e_out, const xt::xtensor<double, 1>& p,
+    const xt::xtensor<double, 1>& c, int extra);
+
+  // Per distribution
+  vector<int> energy_start_; //!< First incident energy, with a final end entry
+  vector<uint8_t> kalbach_;  //!< Kalbach-Mann rather than correlated?
+  vector<int> hash_start_;   //!< First hash bin, with a final end entry
+  vector<double> log_E0_;    //!< Logarithm of the first incident energy
+  vector<double> inv_spacing_; //!< Inverse logarithmic width of the hash bins
+
+  // Per hash bin
+  vector<int> hash_; //!< First incident energy of each bin, relative to the distribution
+
+  // Per incident energy
+  vector<double> energy_;  //!< Incident energies in [eV]
+  vector<int> eout_start_; //!< First outgoing energy point of the table
+  vector<int> n_eout_;     //!< Number of outgoing energy points
+  vector<int> n_discrete_; //!< Number of discrete lines
+  vector<Interpolation> interpolation_; //!< Interpolation law of the table
+  vector<double> e_first_; //!< First continuous outgoing energy in [eV]
+  vector<double> e_last_;  //!< Last outgoing energy in [eV]
+  vector<int> extra_start_; //!< First Kalbach-Mann parameter or angle distribution
+
+  // Per outgoing energy point
+  vector<double> e_out_; //!< Outgoing energies in [eV]
+  vector<double> p_;     //!< Probability density
+  vector<double> c_;     //!< Cumulative distribution
+
+  // Per outgoing energy point, of one law only
+  vector<double> r_; //!< Kalbach-Mann pre-compound fraction
+  vector<double> a_; //!< Kalbach-Mann angular parameter
+  vector<int64_t> angle_offset_; //!< Correlated angle distribution in angle_data_
+  vector<uint8_t> angle_data_;   //!< Serialized angle distributions
+};
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace data {
+
+#pragma omp declare target
+extern AngleEnergyTables ae_tables;
+#pragma omp end declare target
+
+} // namespace data
+
+} // namespace openmc
+
+#endif // OPENMC_SECONDARY_TABLES_H
@@ -26,7 +26,11 @@ public:
   //DataBuffer& operator=(const DataBuffer& buffer);
   ~DataBuffer();
 
-  void reserve(size_t n);
+  //! Allocate n bytes, discarding any contents
+  //
+  //! \param n Number of bytes
+  //! \param category Subsystem the memory is recorded under
+  void reserve(size_t n, const char* category = "Serialized data");
   size_t size() const { return offset_; }
 
   template<typename T> std::enable_if_t<std::is_scalar<std::decay_t<T>>::value>
@@ -43,6 +47,7 @@ public:
   size_t capacity_{0};
   size_t offset_{0};
   Mode mode_{Mode::write};
+  const char* category_{"Serialized data"}; //!< Subsystem memory is recorded under
 };
 
 template<typename T> inline
@@ -54,6 +54,7 @@ extern bool source_latest;            //!< write latest source at each batch?
 extern bool source_separate;          //!< write source to separate file?
 extern bool source_write;             //!< write source in HDF5 files?
 extern bool surf_source_write;        //!< write surface source file?
+extern bool surf_source_per_rank;     //!< write surface source sites to a file per process?
 extern bool surf_source_read;         //!< read surface source file?
 #pragma omp declare target
 extern bool survival_biasing;         //!< use survival biasing?
@@ -64,8 +65,10 @@ extern bool trigger_predict;          //!< predict batches for triggers?
 extern bool ufs_on;                   //!< uniform fission site method on?
 #pragma omp declare target
 extern bool urr_ptables_on;           //!< use unresolved resonance prob. tables?
+extern bool urr_fast_sampling;        //!< sample URR prob. tables from precomputed band records?
+extern bool weight_windows_on;        //!< apply weight windows?
+extern bool write_all_tracks;         //!< write tracks for every particle?
 #pragma omp end declare target
-extern bool write_all_tracks;         //!< write track files for every particle?
 extern bool write_initial_source;     //!< write out initial source file?
 
 // Paths to various files
@@ -74,27 +77,138 @@ extern std::string path_input;            //!< directory where main .xml files r
 extern std::string path_output;           //!< directory where output files are written
 extern std::string path_particle_restart; //!< path to a particle restart file
 extern std::string path_sourcepoint;      //!< path to a source file
+extern std::string path_event_stats;      //!< path to a JSON report of per-batch event counts
+extern std::string path_region_costs;     //!< path to a JSON report of event costs by cell and material
+extern std::string path_startup_profile;  //!< path to a JSON report of startup phases
+extern std::string path_status;           //!< path to a JSON status file updated every batch
 extern "C" std::string path_statepoint;   //!< path to a statepoint file
+extern std::string path_xs_cache;         //!< directory of compiled cross section libraries
 
 extern "C" int32_t n_inactive;               //!< number of inactive batches
 #pragma omp declare target
 extern "C" int32_t max_lost_particles;     //!< maximum number of lost particles
 extern double rel_max_lost_particles;   //!< maximum number of lost particles, relative to the total number of particles
+extern int lost_check_interval;         //!< Event-based events between checks for particles lost on device (0 = end of transport only)
 extern "C" int32_t gen_per_batch;            //!< number of generations per batch
 extern "C" int64_t n_particles;              //!< number of particles per generation
 #pragma omp end declare target
 
 extern int64_t max_particles_in_flight; //!< Max num. event-based particles in flight
+extern bool auto_particles_in_flight; //!< Size max_particles_in_flight to fit in free device memory
+extern double device_memory; //!< Device memory in [GB] used when it cannot be queried (0 = query)
+extern double device_memory_headroom; //!< Fraction of free device memory left unused by auto-sizing
 extern double fuel_lookup_bias; //!< Bias against selection of the fuel lookup event (higher means fuel lookup queue must be longer before running)
+extern EventScheduler event_scheduler; //!< Policy for selecting the next event kernel in event-based mode
+extern int max_revival_period; //!< Max number of event iterations between revival events in event-based mode
+extern bool aggregate_queue_appends; //!< Append to event queues with one atomic per team rather than per particle
+extern bool fuse_advance_tally; //!< Score tracklength tallies in the advance kernel in event-based mode
+extern bool cpu_event_kernels; //!< Run the main event-based kernels as host thread loops when there is no device to offload to
+extern int64_t event_tail_threshold; //!< Live particle count below which event-based mode finishes histories in a single kernel (0 = off, -1 = automatic)
+extern bool auto_tune; //!< Search the inactive batches for the fastest in-flight count, fuel XS bias and sort settings
 
 extern bool sort_fissionable_xs_lookups; //!< Sort fissionable material XS lookups in event-based mode
 extern bool sort_non_fissionable_xs_lookups; //!< Sort non-fissionable material XS lookups in event-based mode
 extern bool sort_surface_crossing; //!< Sort surface crossings in event-based mode
+extern bool sort_surface_position; //!< Sort surface crossings by particle position rather than by cell and surface
+extern bool sort_advance_position; //!< Sort the advance queue by particle position in event-based mode
 extern bool sort_on_device; //!< Sort queues on device rather than on host
+#pragma omp declare target
+extern bool bucket_xs_queues; //!< Build XS lookup queues in (material, log-energy) bucket order rather than sorting them
+#pragma omp end declare target
+extern bool async_event_kernels; //!< Overlap independent event kernels in event-based mode
+extern bool split_collisions; //!< Finish event-based collisions in a separate kernel for each class of sampled reaction
+extern int n_material_xs_queues; //!< Number of materials (those with the most nuclides) given their own XS lookup kernel launch in event-based mode
+extern bool sort_key_index; //!< Sort event queues as packed (key, index) pairs followed by a gather
+extern double sort_skip_fraction; //!< Skip sorting a queue if at most this fraction of it is out of order (0 = never skip)
+extern double compact_threshold; //!< Compact the particle buffer once at most this fraction of its occupied slots hold queued particles (0 = never)
+extern bool material_xs_tables; //!< Interpolate tabulated macroscopic XS for eligible non-fissionable materials
+#pragma omp declare target
+extern int material_xs_table_points; //!< Number of log-uniform energy points in each material XS table
+#pragma omp end declare target
+extern double material_xs_table_tolerance; //!< Max relative error of an interpolated material XS before a direct lookup is used
+extern bool wmp_batch_lookups; //!< Evaluate multipole XS for whole event-based XS lookup queues in nuclide-major batches
+extern int wmp_batch_items; //!< Number of queue items per batched multipole evaluation
+extern bool device_arena; //!< Pack read-only nuclear data into a few large device slabs
+extern bool pinned_banks; //!< Allocate the host source and fission banks in pinned memory
+extern bool device_fission_bank; //!< Sort and resample the fission bank on device between generations
+extern bool packed_bank; //!< Exchange and write source sites in the compact PackedBank format
+extern int tally_replicas; //!< Number of replicated result buffers per tally in event-based mode (0 = atomics only)
+extern int64_t max_replicated_tally_bins; //!< Tallies with more filter-score bins than this always use atomics
+extern int deferred_tally_scores; //!< Tally score queue entries per in-flight particle in event-based mode (0 = score immediately)
+extern double sparse_tally_fraction; //!< Fraction of result blocks that a sparse tally can hold on device (0 = dense storage)
+extern int64_t min_sparse_tally_bins; //!< Only tallies with at least this many filter-score bins are stored sparsely
+extern bool device_tally_accumulate; //!< Keep tally results on device and accumulate them there between batches
+extern bool async_tally_reduction; //!< Overlap the reduction of tallies across ranks with the next batch
+extern int64_t tally_reduce_chunk; //!< Number of tally values reduced across ranks per message
+extern int tally_reduce_group;     //!< Number of ranks reduced onto each aggregator before master (1 = none)
+extern int64_t min_distributed_tally_bins; //!< Tallies with at least this many filter-score bins are accumulated in slices spread over ranks (0 = never)
+extern bool tally_stats; //!< Count the scoring cost of each tally and report it
+extern bool async_statepoint; //!< Write statepoint tally results in the background during the next batch
+extern int hdf5_compression; //!< Deflate level of large datasets in statepoint, source and summary files (0 = none)
+extern int64_t hdf5_chunk_size; //!< Target size in bytes of the chunks of compressed datasets
+extern int checkpoint_interval; //!< Batches between incremental checkpoints (0 = none)
+extern int64_t checkpoint_particles; //!< Source particles of each process between mid-batch checkpoints (0 = none)
+extern int checkpoint_stop; //!< Mid-batch checkpoints after which the run stops as if preempted (0 = never)
+extern int track_buffer_size; //!< Track points buffered per generation on each process
+extern int event_trace_stride; //!< Trace the events of every this many particles in event-based mode (0 = none)
+extern int region_cost_stride; //!< Attribute the events of every this many particles to cells and materials
+extern SummaryFormat summary_format; //!< Layout of summary.h5
+extern bool kernel_profile; //!< Record device time, launches, items and bytes of each event kernel
+extern bool event_stats; //!< Print the event, launch and sort counts of each batch
+extern int64_t xs_benchmark_lookups; //!< Number of random XS lookups to time in place of transport (0 = off)
+extern int64_t collision_benchmark_samples; //!< Number of synthetic neutron collisions to time in place of transport (0 = off)
+extern bool collapse_tallies; //!< Sum tallies with a coarser EnergyFilter from an otherwise identical finer tally
+#pragma omp declare target
+extern bool particle_soa; //!< Keep structure-of-arrays copies of particle fields read by event kernels
+#pragma omp end declare target
+#pragma omp declare target
+extern bool delta_tracking; //!< Delta-track neutrons inside the cells of delta_tracking_cells
+extern bool temperature_tms; //!< Doppler broaden a single nuclide temperature by target motion sampling
+#pragma omp end declare target
+#pragma omp declare target
+extern bool plane_cache; //!< Carry the evaluations of general planes of the current cell between collisions
+extern bool fast_reflection; //!< Keep the lower coordinate levels of reflected particles instead of searching for their cells
+#pragma omp end declare target
+extern bool nuclide_cdf; //!< Keep a running sum of nuclide XS to sample collision nuclides by bisection
+extern bool fission_spectrum_table; //!< Sample prompt fission neutron energies from tabulated quantiles binned on incident energy
+extern bool validate_fission_spectrum; //!< Compare tabulated prompt fission spectra against samples of the exact distributions
+extern int compton_table_quantiles; //!< Quantiles per alpha point of tabulated incoherent scattering distributions, or 0 to sample by rejection
+extern bool decoded_distributions; //!< Decode continuous tabular, Kalbach-Mann and correlated secondary distributions into shared flat tables at load time
+extern bool inelastic_cdf; //!< Tabulate running sums of inelastic XS to sample scattering channels by bisection
+extern std::vector<int32_t> delta_tracking_cells; //!< IDs of cells whose contents are delta-tracked
+extern int majorant_points; //!< Number of log-uniform energy bins of the delta-tracking majorant XS
+extern bool optimize_geometry; //!< Merge duplicate surfaces and drop redundant half-spaces at initialization
+extern bool device_volume_calc; //!< Sample stochastic volume calculations on device
+extern bool device_find_cells; //!< Locate the points of openmc_find_cells() on device
+#pragma omp declare target
+extern bool device_source; //!< Sample fixed-source sites on device as particles start
+#pragma omp end declare target
+#pragma omp declare target
+extern bool async_bank_exchange; //!< Start transporting local source sites while sites from other processes arrive
+#pragma omp end declare target
+extern bool fission_matrix_on; //!< Reweight the source of inactive batches by the fundamental mode of a fission matrix tallied on the entropy or UFS mesh
+extern bool random_ray;        //!< Solve for the multigroup fluxes of flat source regions by random ray tracing instead of transporting particles
+extern double random_ray_distance_active;   //!< Distance in [cm] each random ray tallies over
+extern double random_ray_distance_inactive; //!< Dead zone in [cm] each random ray travels before tallying
+extern bool local_generations; //!< Exchange fission sites between processes only at the end of each batch
+extern bool hybrid_transport; //!< Transport a share of each generation's particles history-based on host threads alongside event-based transport on device
+extern int interleaved_histories; //!< Histories each host thread interleaves in history-based mode (1 = one at a time)
+extern bool persistent_history; //!< Keep device history threads resident, each taking the next history from a counter
+extern bool mg_alias_sampling; //!< Sample multigroup outgoing groups and tabulated scattering cosines from alias tables
+extern double max_work_ratio; //!< Largest share of particles a process may be given, relative to an even share, when shares follow measured speed (0 = even shares)
+extern int64_t source_block_sites; //!< Sites of a source file held in memory at once (0 = the whole file)
+extern bool find_overlaps; //!< Run the sampled overlap check instead of plotting
+extern int64_t overlap_samples; //!< Number of points sampled by the overlap check
+extern int overlap_limit; //!< Overlaps recorded per cell before the overlap check stops testing it
+extern bool device_overlaps; //!< Sample the overlap check on device
+#pragma omp declare target
+extern int32_t domain_mesh; //!< Index in model::meshes of the mesh whose bins are divided into the domains of the processes, or C_NONE
+#pragma omp end declare target
 
 #pragma omp declare target
 extern ElectronTreatment electron_treatment;       //!< how to treat secondary electrons
 extern std::array<double, 4> energy_cutoff;  //!< Energy cutoff in [eV] for each particle type
+extern std::array<double, 4> time_cutoff;    //!< Time cutoff in [s] for each particle type
 #pragma omp end declare target
 extern int legendre_to_tabular_points; //!< number of points to convert Legendres
 extern int max_order;                //!< Maximum Legendre order for multigroup data
@@ -116,9 +230,23 @@ extern std::unordered_set<int> sourcepoint_batch; //!< Batches when source shoul
 extern std::unordered_set<int> statepoint_batch; //!< Batches when state should be written
 extern std::unordered_set<int> source_write_surf_id; //!< Surface ids where sources will be written
 extern int64_t max_surface_particles;    //!< maximum number of particles to be banked on surfaces per process
+extern int64_t secondary_pool_size;      //!< Capacity of the shared pool that overflowing secondary banks spill to (-1 = particles per process)
+extern double fission_bank_margin;       //!< Room in the fission bank beyond the sites expected in a generation, as a fraction of them
+extern int nu_bank_size;                 //!< Most neutrons of a fission each particle keeps for analog fission tallies
+extern double max_split_growth;          //!< Most particles weight windows may split off per generation, per particle of the process
 #pragma omp declare target
 extern TemperatureMethod temperature_method;           //!< method for choosing temperatures
+extern EnergyGridMethod energy_grid_method; //!< grid used to find nuclide energy grid indices
+extern FaddeevaMethod faddeeva_method; //!< Faddeeva implementation for multipole lookups
 #pragma omp end declare target
+extern int union_grid_stride;            //!< keep every n-th point of the unionized energy grid
+extern bool pretabulate_temperatures;    //!< tabulate nuclide XS at only the temperatures present in the model?
+extern bool shared_xs;                   //!< hold flattened nuclide XS once per node?
+extern bool prune_nuclear_data;          //!< leave nuclear data the run cannot use unread?
+extern double device_xs_budget;          //!< device memory in [GB] for pointwise nuclide XS, or 0 for no limit
+extern int device_id;                    //!< device to offload to, or -1 for the OpenMP default
+extern bool bind_devices;                //!< give processes on a node the devices in turn?
+extern bool keep_device_data;            //!< keep nuclear data and materials on device between simulations?
 extern double temperature_tolerance;     //!< Tolerance in [K] on choosing temperatures
 extern double temperature_default;       //!< Default T in [K]
 extern std::array<double, 2> temperature_range;  //!< Min/max T in [K] over which to load xs
@@ -4,9 +4,11 @@
 //! \file shared_array.h
 //! \brief Shared array data structure
 
+#include <algorithm> // for copy
 #include <memory>
 
 #include "openmc/device_alloc.h"
+#include "openmc/memory_registry.h"
 
 namespace openmc {
 
@@ -56,6 +58,7 @@ public:
   SharedArray(int capacity) : capacity_(capacity)
   {
     data_ = new T[capacity];
+    record_memory(category_, MemorySpace::host, bytes());
   }
 
   //==========================================================================
@@ -70,10 +73,63 @@ public:
   //! reserve() does not change the size of the container.
   //
   //! \param capacity The number of elements to allocate in the container
-  void reserve(int capacity)
+  //! \param category Subsystem the memory is recorded under
+  //! \param allocator OpenMP allocator to obtain the (uninitialized) space
+  //!   from, e.g., one returning pinned memory. If omp_null_allocator, the
+  //!   elements are allocated with new[].
+  void reserve(int capacity, const char* category,
+    omp_allocator_handle_t allocator = omp_null_allocator)
   {
-    data_ = new T[capacity];
+    if (allocator == omp_null_allocator) {
+      data_ = new T[capacity];
+    } else {
+      data_ = static_cast<T*>(omp_alloc(capacity * sizeof(T), allocator));
+    }
+    omp_allocated_ = (allocator != omp_null_allocator);
+    allocator_ = allocator;
     capacity_ = capacity;
+    category_ = category;
+    record_memory(category_, MemorySpace::host, bytes());
+  }
+
+  //! Allocate space for the specified number of elements, recorded as memory
+  //! of no particular subsystem
+  void reserve(int capacity, omp_allocator_handle_t allocator = omp_null_allocator)
+  {
+    reserve(capacity, "Other arrays", allocator);
+  }
+
+  //! Increase the space allocated for the container to hold at least the
+  //! specified number of elements, keeping the elements in use on host. The
+  //! space comes from the same allocator as before. If the container is
+  //! mapped to device, it is mapped again with the new capacity, but the
+  //! elements are not copied there.
+  //
+  //! \param capacity The number of elements to allocate in the container
+  void grow(int capacity)
+  {
+    if (capacity <= capacity_) return;
+    bool mapped = (device_data_ != nullptr);
+    if (mapped) {
+      #pragma omp target exit data map(release: data_[:capacity_])
+      record_memory(category_, MemorySpace::device, -bytes());
+      device_data_ = nullptr;
+    }
+
+    T* old_data = data_;
+    bool old_omp_allocated = omp_allocated_;
+    record_memory(category_, MemorySpace::host, -bytes());
+    reserve(capacity, category_, allocator_);
+    if (old_data != nullptr) {
+      std::copy(old_data, old_data + size_, data_);
+      if (old_omp_allocated) {
+        omp_free(old_data, omp_null_allocator);
+      } else {
+        delete[] old_data;
+      }
+    }
+
+    if (mapped) allocate_on_device();
   }
 
   //! Increase the size of the container by one and append value to the 
@@ -110,13 +166,46 @@ public:
     return idx;
   }
 
+  //! Increase the size of the container by n and return the index of the
+  //! first of n contiguous elements reserved for the caller. This allows a
+  //! group of threads (e.g., a team) to append a block of elements with a
+  //! single atomic operation on the size. In the event that the block would
+  //! extend past the end of the array, set the size to be equal to the
+  //! capacity and return -1.
+  //
+  //! \param n The number of elements to reserve
+  //! \return The index of the first reserved element, or -1 on overflow
+  int thread_safe_reserve(int n)
+  {
+    // Atomically capture the start of the block we want to write to
+    int idx;
+    #pragma omp atomic capture //seq_cst
+    { idx = size_; size_ += n; }
+
+    // Check that we haven't written off the end of the array
+    if (idx + n > capacity_) {
+      #pragma omp atomic write //seq_cst
+      size_ = capacity_;
+      return -1;
+    }
+
+    return idx;
+  }
+
   //! Free any space that was allocated for the container. Set the
   //! container's size and capacity to 0.
   void clear()
   {
     if( data_ != nullptr )
     {
-      delete[] data_;
+      record_memory(category_, MemorySpace::host, -bytes());
+      if (device_data_) record_memory(category_, MemorySpace::device, -bytes());
+      device_data_ = nullptr;
+      if (omp_allocated_) {
+        omp_free(data_, omp_null_allocator);
+      } else {
+        delete[] data_;
+      }
       data_ = nullptr;
     }
     size_ = 0;
@@ -147,10 +236,20 @@ public:
     sync_size_host_to_device();
   }
 
+  //! Set the size of the host copy of the container without synchronizing it
+  //! with the device. This is useful when the device size is maintained
+  //! separately (e.g., when several sizes are transferred at once).
+  //
+  //! \param size The new size of the host copy of the container
+  void set_host_size(int size) {size_ = size;}
+
   //! Return the number of elements that the container has currently allocated
   //! space for.
   int capacity() {return capacity_;}
 
+  //! Return the number of bytes allocated for elements
+  int64_t bytes() const {return static_cast<int64_t>(capacity_) * sizeof(T);}
+
   //! Return pointer to the underlying array serving as element storage.
   T* data() {return data_;}
   const T* data() const {return data_;}
@@ -172,21 +271,32 @@ public:
     {
       device_data_ = data_;
     }
+    record_memory(category_, MemorySpace::device, bytes());
     
     // If OpenMP 5.1 is fully supported, we can more simply just do:
     //device_data_ = static_cast<T*>(omp_get_mapped_ptr(data_, omp_get_default_device()));
   }
 
+  //! Copy the size and the elements in use to the device
   void copy_host_to_device()
   {
     #pragma omp target update to(size_)
-    #pragma omp target update to(data_[:capacity_])
+    #pragma omp target update to(data_[:size_])
   }
-  
-  void copy_device_to_host()
+
+  //! Copy the size and the elements in use from the device
+  //
+  //! \param async If true, only the size is copied before returning and the
+  //!   elements are copied by a deferred target task, which must be waited on
+  //!   (e.g., with a taskwait) before they are read
+  void copy_device_to_host(bool async = false)
   {
-    #pragma omp target update from(data_[:capacity_])
     #pragma omp target update from(size_)
+    if (async) {
+      #pragma omp target update from(data_[:size_]) nowait
+    } else {
+      #pragma omp target update from(data_[:size_])
+    }
   }
   
   //==========================================================================
@@ -198,6 +308,9 @@ public:
   T* device_data_ {nullptr}; //!< Device pointer for interop with device libraries
   int size_ {0}; //!< The current number of elements 
   int capacity_ {0}; //!< The total space allocated for elements
+  bool omp_allocated_ {false}; //!< Whether data_ came from omp_alloc()
+  omp_allocator_handle_t allocator_ {omp_null_allocator}; //!< Allocator data_ came from
+  const char* category_ {"Other arrays"}; //!< Subsystem memory is recorded under
 }; 
 
 } // namespace openmc
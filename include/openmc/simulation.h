@@ -41,12 +41,17 @@ extern "C" bool need_depletion_rx; //!< need to calculate depletion rx?
 extern "C" bool depletion_scores_present; //!< are there any user-defined depletion scores
 #pragma omp end declare target
 extern "C" int restart_batch;   //!< batch at which a restart job resumed
+extern bool reuse_source;        //!< start from the source bank left by the last simulation?
+extern int32_t reuse_n_inactive; //!< inactive batches when starting from a reused source, or -1 to keep settings::n_inactive
 extern "C" bool satisfy_triggers; //!< have tally triggers been satisfied?
 #pragma omp declare target
 extern "C" int total_gen;        //!< total number of generations simulated
 extern double total_weight;  //!< Total source weight in a batch
 extern int64_t work_per_rank;         //!< number of particles per MPI rank
+extern int64_t next_history;          //!< next work index taken by a persistent device history thread
 #pragma omp end declare target
+extern int64_t max_work_per_rank;     //!< largest number of particles the banks of this rank can hold
+extern int64_t host_work;             //!< number of the last particles of this rank transported on host by hybrid transport
 
 extern const Mesh* entropy_mesh;
 extern const Mesh* ufs_mesh;
@@ -76,6 +81,10 @@ void allocate_banks();
 //! Determine number of particles to transport per process
 void calculate_work();
 
+//! Divide the particles among processes in proportion to the rate at which
+//! each transported them since the last call, up to max_work_per_rank each
+void balance_work();
+
 //! Initialize nuclear data before a simulation
 void initialize_data();
 
@@ -5,13 +5,17 @@
 #define OPENMC_SOURCE_H
 
 #include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "pugixml.hpp"
 
+#include "openmc/bank.h"
 #include "openmc/distribution_multi.h"
 #include "openmc/distribution_spatial.h"
 #include "openmc/particle.h"
+#include "openmc/serialize.h"
 
 namespace openmc {
 
@@ -25,6 +29,13 @@ namespace model {
 
 extern std::vector<std::unique_ptr<Source>> external_sources;
 
+//! External sources serialized for sampling on device: the number of sources
+//! and their total strength, the offset of each source, then the sources
+extern DataBuffer external_sources_flat;
+#pragma omp declare target
+extern uint8_t* device_external_sources;
+#pragma omp end declare target
+
 } // namespace model
 
 //==============================================================================
@@ -40,6 +51,10 @@ public:
 
   // Methods that can be overridden
   virtual double strength() const { return 1.0; }
+
+  //! Called on the host, outside of any parallel region, before the sites of
+  //! each generation are sampled
+  virtual void prepare_generation() { }
 };
 
 //==============================================================================
@@ -57,6 +72,12 @@ public:
   //! \return Sampled site
   Particle::Bank sample(uint64_t* seed) const override;
 
+  //! Write the source, to be sampled by IndependentSourceFlat
+  //
+  //! Sources with a monoenergetic spectrum outside of the range of the cross
+  //! sections are rejected here rather than on every sample
+  void serialize(DataBuffer& buffer) const;
+
   // Properties
   Particle::Type particle_type() const { return particle_; }
   double strength() const override { return strength_; }
@@ -74,20 +95,69 @@ private:
   UPtrDist energy_; //!< Energy distribution
 };
 
+//==============================================================================
+//! Independent source written by IndependentSource::serialize()
+//==============================================================================
+
+class IndependentSourceFlat {
+public:
+  #pragma omp declare target
+  explicit IndependentSourceFlat(const uint8_t* data) : data_{data} { }
+
+  //! Sample from the external source distribution, in the same way and with
+  //! the same pseudorandom numbers as IndependentSource::sample()
+  //
+  //! \param[inout] p Particle used to locate sampled positions in the geometry
+  //! \param[inout] seed Pseudorandom seed pointer
+  //! \return Sampled site, with zero weight if no position in the geometry was
+  //!   found within EXTSRC_REJECT_THRESHOLD attempts
+  Particle::Bank sample(Particle& p, uint64_t* seed) const;
+
+  double strength() const;
+  #pragma omp end declare target
+private:
+  const uint8_t* data_;
+};
+
 //==============================================================================
 //! Source composed of particles read from a file
 //==============================================================================
 
 class FileSource : public Source {
 public:
-  // Constructors
+  // Constructors, destructors
   explicit FileSource(std::string path);
+  ~FileSource();
 
   // Methods
   Particle::Bank sample(uint64_t* seed) const override;
 
+  //! Move to the next block of sites when the file is read in blocks
+  void prepare_generation() override;
+
 private:
-  std::vector<Particle::Bank> sites_; //!< Source sites from a file
+  //! Index of the block used at a position in the sequence of blocks. Each
+  //! pass through the file visits the blocks in a different shuffled order.
+  //! \param[in] position Position in the sequence
+  //! \return Index of the block
+  int64_t block_index(int64_t position) const;
+
+  //! Read one block of sites from the file
+  //! \param[in] block Index of the block
+  //! \param[out] sites Sites of the block
+  void read_block(int64_t block, BankVector& sites) const;
+
+  //! Read the block after the current one in the background
+  void start_prefetch();
+
+  std::string path_; //!< Path to the source file
+  BankVector sites_; //!< Source sites from a file, or the current block of them
+  int64_t n_file_sites_; //!< Number of sites in the file
+  int64_t n_blocks_ {1}; //!< Number of blocks the file is read in
+  int64_t position_ {0}; //!< Position of the current block in the sequence
+  bool first_generation_ {true}; //!< Whether no generation has been prepared
+  BankVector next_sites_; //!< Sites of the next block, read in the background
+  std::thread prefetch_; //!< Thread reading next_sites_
 };
 
 //==============================================================================
@@ -128,6 +198,24 @@ extern "C" void initialize_fixed_source();
 //! \return Sampled source site
 Particle::Bank sample_external_source(uint64_t* seed);
 
+//! Sample a site from the external sources serialized in
+//! model::device_external_sources, in the same way as sample_external_source()
+//! \param[inout] p Particle used to locate sampled positions in the geometry
+//! \param[inout] seed Pseudorandom seed pointer
+//! \return Sampled source site
+#pragma omp declare target
+Particle::Bank sample_external_source_device(Particle& p, uint64_t* seed);
+#pragma omp end declare target
+
+//! Whether the external sources can be sampled on device: they must all be
+//! independent sources of a continuous-energy run
+bool can_sample_sources_on_device();
+
+//! Serialize the external sources and copy them to device
+void copy_external_sources_to_device();
+
+void release_external_sources_from_device();
+
 void free_memory_source();
 
 } // namespace openmc
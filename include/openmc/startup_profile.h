@@ -0,0 +1,88 @@
+//! \file startup_profile.h
+//! \brief Wall time and host and device memory of each phase of startup,
+//! from reading the input to moving the read-only data to device
+
+#ifndef OPENMC_STARTUP_PROFILE_H
+#define OPENMC_STARTUP_PROFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "openmc/timer.h"
+
+namespace openmc {
+
+//==============================================================================
+//! One phase of startup. Phases nest: a phase begun while another is open is
+//! part of it.
+//==============================================================================
+
+struct StartupPhase {
+  std::string name;
+  int depth;              //!< Number of phases enclosing this one
+  double seconds {0.0};   //!< Wall time
+  int64_t host_bytes {0}; //!< Change in resident host memory
+  int64_t device_bytes {0}; //!< Change in device memory in data::device_arena
+  Timer timer;
+  int64_t host_start;
+  int64_t device_start;
+};
+
+//==============================================================================
+//! Time taken by one item of a phase, such as one nuclide read
+//==============================================================================
+
+struct StartupItem {
+  std::string kind;
+  std::string name;
+  double seconds;
+};
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+extern std::vector<StartupPhase> startup_phases; //!< Phases in order of start
+extern std::vector<StartupItem> startup_items;
+
+} // namespace simulation
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Whether startup is being profiled, i.e. settings::path_startup_profile is
+//! set
+bool profiling_startup();
+
+//! Begin a phase within the innermost open phase. Does nothing unless startup
+//! is being profiled.
+//
+//! \param[in] name Name of the phase
+void begin_phase(const std::string& name);
+
+//! End the innermost open phase
+void end_phase();
+
+//! Record the time taken by one item. May be called from within a parallel
+//! region.
+//
+//! \param[in] kind Kind of item, e.g. "nuclide"
+//! \param[in] name Name of the item
+//! \param[in] seconds Wall time
+void record_startup_item(const char* kind, const std::string& name,
+  double seconds);
+
+//! Resident host memory of the process, or zero where it cannot be read
+int64_t host_resident_bytes();
+
+//! Write the phases and items to settings::path_startup_profile on the master
+//! process and clear them
+void write_startup_profile();
+
+} // namespace openmc
+
+#endif // OPENMC_STARTUP_PROFILE_H
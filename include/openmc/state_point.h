@@ -2,21 +2,76 @@
 #define OPENMC_STATE_POINT_H
 
 #include <cstdint>
+#include <string>
 #include <vector>
 
 #include "hdf5.h"
 
+#include "openmc/bank.h"
 #include "openmc/capi.h"
 #include "openmc/particle.h"
 
 namespace openmc {
 
 void load_state_point();
+
+//! Wait for the tally results of the last statepoint to be written, when they
+//! are written in the background (settings::async_statepoint). Must be called
+//! before the HDF5 library is used while a statepoint may be in progress.
+void finish_statepoint_write();
+
 std::vector<int64_t> calculate_surf_source_size();
 void write_source_point(const char* filename, bool surf_source_bank = false);
 void write_source_bank(hid_t group_id, bool surf_source_bank);
-void read_source_bank(hid_t group_id, std::vector<Particle::Bank>& sites, bool distribute);
+
+//! Write the surface source sites of each process to a file of its own, named
+//! after filename with the rank before the extension, and on the master a
+//! virtual dataset in filename that joins them
+//! \param[in] filename Path to the joined file
+void write_surf_source_per_rank(const std::string& filename);
+void read_source_bank(hid_t group_id, BankVector& sites, bool distribute);
+
+//! Number of sites in the source bank of a file
+//! \param[in] group_id Group holding the source_bank dataset
+//! \return Number of sites
+int64_t source_bank_size(hid_t group_id);
+
+//! Read a contiguous range of the sites of the source bank of a file, with
+//! independent I/O so that it may be called by one process or thread alone
+//! \param[in] group_id Group holding the source_bank dataset
+//! \param[out] sites Sites read
+//! \param[in] offset Index of the first site
+//! \param[in] n Number of sites
+void read_source_bank_range(hid_t group_id, BankVector& sites, int64_t offset,
+  int64_t n);
 void write_tally_results_nr(hid_t file_id);
+
+//! Update the incremental checkpoint, checkpoint.h5 in the output directory.
+//! The first call writes it as a statepoint. Later calls write the batch
+//! state, the source bank and the blocks of tally results that changed since
+//! to checkpoint.h5.delta, which load_state_point() applies on restart, until
+//! most blocks have changed and a new statepoint is cheaper.
+void write_checkpoint();
+
+//! Whether the batch in progress can be checkpointed and resumed: in
+//! event-based mode with one generation per batch, with no histories
+//! transported on host threads or handed over between domains and with every
+//! source site in place before transport starts
+bool batch_checkpoint_supported();
+
+//! Checkpoint the batch in progress on this process, once the particle buffer
+//! has drained after the first n_sources sites were started. The keff
+//! accumulators, fission sites, progeny counts and tally scores so far are
+//! copied and written to <checkpoint>.batch.<rank> in the background, next to
+//! the checkpoint of the last batch. Nothing is written before there is one.
+//! \param[in] n_sources Number of source sites started
+//! \return Whether the batch was checkpointed
+bool write_batch_checkpoint(int64_t n_sources);
+
+//! Restore the state of the batch in progress read by load_state_point(),
+//! when the current batch is the one it was taken in
+//! \return Number of source sites already transported
+int64_t resume_batch_checkpoint();
 void restart_set_keff();
 
 #ifdef DAGMC
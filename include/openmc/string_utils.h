@@ -22,5 +22,8 @@ bool ends_with(const std::string& value, const std::string& ending);
 
 bool starts_with(const std::string& value, const std::string& beginning);
 
+//! Quote and escape a string for a JSON string literal
+std::string json_string(const std::string& s);
+
 } // namespace openmc
 #endif // OPENMC_STRING_UTILS_H
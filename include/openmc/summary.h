@@ -11,6 +11,17 @@ void write_nuclides(hid_t file);
 void write_geometry(hid_t file);
 void write_materials(hid_t file);
 
+//! Write the cells and universes as datasets with one entry per object, with
+//! the surfaces and lattices as in write_geometry()
+void write_geometry_compact(hid_t file);
+
+//! Write the materials as datasets with one entry per material
+void write_materials_compact(hid_t file);
+
+//! Write the model input files and a hash of them in place of the geometry
+//! and materials
+void write_model_input(hid_t file);
+
 }
 
 #endif // OPENMC_SUMMARY_H
@@ -14,6 +14,7 @@
 #include "openmc/constants.h"
 #include "openmc/particle.h"
 #include "openmc/position.h"
+#include "openmc/vector.h"
 #include "dagmc.h"
 
 namespace openmc {
@@ -116,10 +117,24 @@ public:
   double A_, B_, C_, D_, E_, F_, G_, H_, J_, K_;
 
   explicit Surface(pugi::xml_node surf_node, SurfaceType type);
+
+  //! Construct a surface from one row of the surfaces of an HDF5 model input
+  //
+  //! \param id Unique ID
+  //! \param type Surface type
+  //! \param name User-defined name
+  //! \param boundary Boundary condition, as in geometry.xml
+  //! \param coeffs Coefficients in the order of geometry.xml
+  //! \param n_coeffs Number of coefficients
+  Surface(int id, SurfaceType type, const std::string& name,
+    const std::string& boundary, const double* coeffs, int n_coeffs);
   Surface();
 
   ~Surface() {}
 
+  //! Set the boundary condition from its name in geometry.xml
+  void set_boundary(const std::string& surf_bc);
+
   //! Determine which side of a surface a point lies on.
   //! \param r The 3D Cartesian coordinate of a point.
   //! \param u A direction used to "break ties" and pick a sense when the
@@ -243,6 +258,42 @@ protected:
  void SurfaceQuadric_to_hdf5_inner(hid_t group_id) const;  
 };
 
+//==============================================================================
+//! Surfaces of a single type bounding a cell, with their coefficients packed
+//! contiguously so that the distances to all of them are found by one loop
+//! that does not dispatch on the surface type.
+//==============================================================================
+
+struct SurfaceBatch {
+  Surface::SurfaceType type;
+  int32_t n;      //!< Number of surfaces
+  int32_t token;  //!< Offset of the first signed surface index + 1
+  int32_t coeff;  //!< Offset of the first packed coefficient
+};
+
+//! Append the packed coefficients of a surface. Only planes, axis-aligned
+//! cylinders and spheres have any; distances to surfaces of other types are
+//! found through Surface::distance().
+void pack_coefficients(const Surface& surf, vector<double>& coeffs);
+
+//! Find the nearest surface of a batch if it is nearer than min_dist, in which
+//! case min_dist and i_surf are updated like in Cell::distance()
+//! \param batch The surfaces to check
+//! \param tokens Signed surface indices + 1, indexed by batch.token
+//! \param coeffs Packed coefficients, indexed by batch.coeff
+//! \param r Position of the particle
+//! \param u Direction of the particle
+//! \param on_surface Signed index of the surface the particle is on, if any
+//! \param min_dist Distance to the nearest surface so far
+//! \param i_surf Negated token of the nearest surface so far
+//! \param planes Evaluations of the general planes of the batch at r, or
+//!   nullptr. They are used if already found and stored otherwise.
+#pragma omp declare target
+void batch_distance(const SurfaceBatch& batch, const int32_t* tokens,
+  const double* coeffs, Position r, Direction u, int32_t on_surface,
+  double& min_dist, int32_t& i_surf, PlaneEvalCache* planes = nullptr);
+#pragma omp end declare target
+
 //==============================================================================
 //! A `Surface` representing a DAGMC-based surface in DAGMC.
 //==============================================================================
@@ -536,6 +587,11 @@ public:
 
 void read_surfaces(pugi::xml_node node);
 
+//! Read the surfaces of an HDF5 model input (see read_geometry_hdf5())
+//
+//! \param file_id Open geometry.h5 file
+void read_surfaces_hdf5(hid_t file_id);
+
 void free_memory_surfaces();
 
 } // namespace openmc
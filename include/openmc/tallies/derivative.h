@@ -39,6 +39,7 @@ struct TallyDerivative {
 //! Read tally derivatives from a tallies.xml file
 void read_tally_derivatives(pugi::xml_node node);
 
+#pragma omp declare target
 //! Scale the given score by its logarithmic derivative
 
 void
@@ -60,6 +61,7 @@ void score_collision_derivative(Particle& p);
 //! \param p The particle being tracked
 //! \param distance The distance in [cm] traveled by the particle
 void score_track_derivative(Particle& p, double distance);
+#pragma omp end declare target
 
 } // namespace openmc
 
@@ -72,6 +74,10 @@ namespace openmc {
 namespace model {
 extern std::unordered_map<int, int> tally_deriv_map;
 extern std::vector<TallyDerivative> tally_derivs;
+#pragma omp declare target
+extern TallyDerivative* device_tally_derivs; //!< tally_derivs on device
+extern int n_tally_derivs; //!< Size of tally_derivs
+#pragma omp end declare target
 } // namespace model
 
 } // namespace openmc
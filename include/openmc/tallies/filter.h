@@ -58,6 +58,7 @@ public:
     SphericalHarmonicsFilter,
     SpatialLegendreFilter,
     SurfaceFilter,
+    TimeFilter,
     UniverseFilter,
     ZernikeFilter,
     ZernikeRadialFilter
@@ -108,6 +109,7 @@ public:
   void SphericalHarmonicsFilter_from_xml(pugi::xml_node node);
   void SpatialLegendreFilter_from_xml(pugi::xml_node node);
   void SurfaceFilter_from_xml(pugi::xml_node node);
+  void TimeFilter_from_xml(pugi::xml_node node);
   void UniverseFilter_from_xml(pugi::xml_node node);
   void ZernikeFilter_from_xml(pugi::xml_node node);
   //void ZernikeRadialFilter_from_xml(pugi::xml_node node);
@@ -148,8 +150,17 @@ public:
   void SphericalHarmonicsFilter_get_all_bins(const Particle& p, TallyEstimator estimator, FilterMatch& match) const;
   void SpatialLegendreFilter_get_all_bins(const Particle& p, TallyEstimator estimator, FilterMatch& match) const;
   void SurfaceFilter_get_all_bins(const Particle& p, TallyEstimator estimator, FilterMatch& match) const;
+  void TimeFilter_get_all_bins(const Particle& p, TallyEstimator estimator, FilterMatch& match) const;
   void UniverseFilter_get_all_bins(const Particle& p, TallyEstimator estimator, FilterMatch& match) const;
   void ZernikeRadialFilter_get_all_bins(const Particle& p, TallyEstimator estimator, FilterMatch& match) const;
+
+  //! Find the bin of an energy, exactly as lower_bound_index() over bins_
+  //! would, through the log-spaced index built by EnergyFilter_set_bins().
+  //! Used by EnergyFilter and EnergyoutFilter.
+  //
+  //! \param E Energy, which must lie within [bins_.front(), bins_.back()]
+  //! \return Index of the bin containing E
+  int energy_bin(double E) const;
   #pragma omp end declare target
   void ZernikeFilter_get_all_bins(const Particle& p, TallyEstimator estimator, FilterMatch& match) const;
 
@@ -177,6 +188,7 @@ public:
   void SphericalHarmonicsFilter_to_statepoint(hid_t filter_group) const;
   void SpatialLegendreFilter_to_statepoint(hid_t filter_group) const;
   void SurfaceFilter_to_statepoint(hid_t filter_group) const;
+  void TimeFilter_to_statepoint(hid_t filter_group) const;
   void UniverseFilter_to_statepoint(hid_t filter_group) const;
   void ZernikeFilter_to_statepoint(hid_t filter_group) const;
   //void ZernikeRadialFilter_to_statepoint(hid_t filter_group) const;
@@ -207,6 +219,7 @@ public:
   std::string SphericalHarmonicsFilter_text_label(int bin) const;
   std::string SpatialLegendreFilter_text_label(int bin) const;
   std::string SurfaceFilter_text_label(int bin) const;
+  std::string TimeFilter_text_label(int bin) const;
   std::string UniverseFilter_text_label(int bin) const;
   std::string ZernikeFilter_text_label(int bin) const;
   std::string ZernikeRadialFilter_text_label(int bin) const;
@@ -245,6 +258,8 @@ public:
   vector<int32_t>& materials() { return materials_; }
   const vector<int32_t>& materials() const { return materials_; }
   int32_t mesh() const {return mesh_;}
+  //! Bin of each cell (CellFilter) or material (MaterialFilter) index
+  const static_map<int32_t, int>& map() const { return map_; }
   void set_mesh(int32_t mesh){
     mesh_ = mesh;
     if (type_ == FilterType::MeshFilter)
@@ -287,6 +302,7 @@ public:
   void EnergyFilter_set_bins(gsl::span<const double> bins);
   void MuFilter_set_bins(gsl::span<const double> bins);
   void PolarFilter_set_bins(gsl::span<const double> bins);
+  void TimeFilter_set_bins(gsl::span<const double> bins);
 
   void set_order(int order);
 
@@ -307,6 +323,13 @@ private:
   int32_t id_ {C_NONE};
   gsl::index index_;
   vector<double> bins_;
+  // EnergyFilter: bin containing the lower edge of each log-spaced hash cell
+  // between bins_[energy_first_] and bins_.back(), or empty for few bins
+  vector<int> energy_index_;
+  int energy_first_ {0};         // First bin edge that is positive
+  double energy_log_min_ {0.0};  // Log of bins_[energy_first_]
+  double energy_inv_du_ {0.0};   // Inverse lethargy width of a hash cell or bin
+  bool equal_lethargy_ {false};  // Bins above energy_first_ have equal widths
   vector<int32_t> cells_;
   static_map<int32_t, int> map_;
   vector<CellInstance> cell_instances_;
@@ -0,0 +1,155 @@
+#ifndef OPENMC_TALLIES_FILTER_PIPELINE_H
+#define OPENMC_TALLIES_FILTER_PIPELINE_H
+
+#include "openmc/constants.h"
+#include "openmc/mesh.h"
+#include "openmc/particle.h"
+#include "openmc/tallies/filter.h"
+
+namespace openmc {
+
+//==============================================================================
+//! Filter combinations that tallies can be scored through without going
+//! through Filter::get_all_bins() and FilterMatch. The filters may be given
+//! in any order in the tally.
+//==============================================================================
+
+enum class FilterPipeline {
+  generic,         //!< Any other combination, scored through FilterBinIter
+  mesh,            //!< MeshFilter
+  energy_mesh,     //!< EnergyFilter and MeshFilter
+  cell_energy,     //!< CellFilter and EnergyFilter
+  material_energy  //!< MaterialFilter and EnergyFilter
+};
+
+//==============================================================================
+//! Bins of the filters shared by several tallies, found once per tally event
+//! and reused by every tally that uses them. Filters are shared when they
+//! match at most one bin, with unit weight, and are used by more than one
+//! tally; filters of the same type with the same bins are treated as one.
+//! The slot of each filter of a tally is in Tally::shared_slots_.
+//==============================================================================
+
+constexpr int MAX_SHARED_FILTERS {16};
+
+struct SharedFilterBins {
+  static constexpr int UNKNOWN {-2}; //!< Not evaluated yet for this event
+  static constexpr int NONE {-1};    //!< Evaluated, with no matching bin
+
+  SharedFilterBins()
+  {
+    for (int i = 0; i < MAX_SHARED_FILTERS; ++i) bins_[i] = UNKNOWN;
+  }
+
+  int bins_[MAX_SHARED_FILTERS];
+};
+
+//==============================================================================
+// Bin visitors for the filters of the specialized pipelines. Each calls
+// visit(bin, weight) for every bin the filter matches, exactly like the
+// corresponding *Filter_get_all_bins() would have pushed them.
+//==============================================================================
+
+struct EnergyBins {
+  template<class F>
+  static void for_each(const Filter& filt, const Particle& p,
+    TallyEstimator estimator, F&& visit)
+  {
+    const auto& bins = filt.bins();
+    double E = p.E_last_;
+    if (E >= bins.front() && E <= bins.back()) {
+      visit(filt.energy_bin(E), 1.0);
+    }
+  }
+};
+
+struct MeshBins {
+  template<class F>
+  static void for_each(const Filter& filt, const Particle& p,
+    TallyEstimator estimator, F&& visit)
+  {
+    const auto& mesh = model::meshes[filt.mesh()];
+    if (estimator != TallyEstimator::TRACKLENGTH) {
+      int bin = mesh.get_bin(p.r());
+      if (bin >= 0) visit(bin, 1.0);
+    } else {
+      mesh.for_each_bin_crossed(p, visit);
+    }
+  }
+};
+
+struct CellBins {
+  template<class F>
+  static void for_each(const Filter& filt, const Particle& p,
+    TallyEstimator estimator, F&& visit)
+  {
+    const auto& map = filt.map();
+    for (int i = 0; i < p.n_coord_; i++) {
+      auto search = map.find(p.coord_[i].cell);
+      if (search != map.end()) visit(search->second, 1.0);
+    }
+  }
+};
+
+struct MaterialBins {
+  template<class F>
+  static void for_each(const Filter& filt, const Particle& p,
+    TallyEstimator estimator, F&& visit)
+  {
+    const auto& map = filt.map();
+    auto search = map.find(p.material_);
+    if (search != map.end()) visit(search->second, 1.0);
+  }
+};
+
+//==============================================================================
+//! Visit the bins matched by a filter, through its shared bin if it has one
+//
+//! \param slot Slot of the filter in shared, or C_NONE if it isn't shared
+//==============================================================================
+
+template<class Bins, class F>
+void for_each_shared(const Filter& filt, int slot, SharedFilterBins& shared,
+  const Particle& p, TallyEstimator estimator, F&& visit)
+{
+  if (slot == C_NONE) {
+    Bins::for_each(filt, p, estimator, visit);
+    return;
+  }
+  int& bin = shared.bins_[slot];
+  if (bin == SharedFilterBins::UNKNOWN) {
+    bin = SharedFilterBins::NONE;
+    Bins::for_each(filt, p, estimator, [&](int b, double weight) { bin = b; });
+  }
+  if (bin >= 0) visit(bin, 1.0);
+}
+
+//==============================================================================
+//! Visit every combination of the bins matched by two filters
+//
+//! \param filt_a First filter of the pipeline, visited by A
+//! \param stride_a Index stride of filt_a in the tally
+//! \param slot_a Shared bin slot of filt_a, or C_NONE
+//! \param filt_b Second filter of the pipeline, visited by B
+//! \param stride_b Index stride of filt_b in the tally
+//! \param slot_b Shared bin slot of filt_b, or C_NONE
+//! \param shared Bins of the shared filters for the current event
+//! \param visit Called with the filter combination index and weight
+//==============================================================================
+
+template<class A, class B, class F>
+void for_each_filter_pair(const Filter& filt_a, int stride_a, int slot_a,
+  const Filter& filt_b, int stride_b, int slot_b, SharedFilterBins& shared,
+  const Particle& p, TallyEstimator estimator, F&& visit)
+{
+  for_each_shared<A>(filt_a, slot_a, shared, p, estimator,
+    [&](int bin_a, double weight_a) {
+      for_each_shared<B>(filt_b, slot_b, shared, p, estimator,
+        [&](int bin_b, double weight_b) {
+          visit(bin_a * stride_a + bin_b * stride_b, weight_a * weight_b);
+        });
+    });
+}
+
+} // namespace openmc
+#endif // OPENMC_TALLIES_FILTER_PIPELINE_H
@@ -2,11 +2,14 @@
 #define OPENMC_TALLIES_TALLY_H
 
 #include "openmc/constants.h"
+#include "openmc/shared_array.h"
 #include "openmc/tallies/filter.h"
+#include "openmc/tallies/filter_pipeline.h"
 #include "openmc/tallies/trigger.h"
 #include "openmc/vector.h"
 
 #include <gsl/gsl>
+#include <omp.h>
 #include "pugixml.hpp"
 #include "xtensor/xfixed.hpp"
 #include "xtensor/xtensor.hpp"
@@ -19,6 +22,58 @@
 
 namespace openmc {
 
+//==============================================================================
+//! A score whose addition to a tally bin has been deferred to
+//! reduce_tally_scores()
+//==============================================================================
+
+struct TallyScore {
+  int32_t tally; //!< Index in model::tallies
+  int32_t bin;   //!< Filter combination index * n_scores_ + score index
+  double value;
+};
+
+//! Number of consecutive filter-score bins in a block of a sparse tally
+constexpr int SPARSE_TALLY_BLOCK {256};
+
+//==============================================================================
+//! A nuclide bin of a tally whose nuclide is present in a given material
+//==============================================================================
+
+struct TallyNuclide {
+  int bin;     //!< Index in Tally::nuclides_
+  int nuclide; //!< Index in data::nuclides, or -1 for the total material
+  double atom_density; //!< Nuclide density in the material in [atom/b-cm]
+};
+
+//==============================================================================
+//! Scoring cost counters of a tally, kept when settings::tally_stats is set
+//==============================================================================
+
+struct TallyStats {
+  int64_t events;         //!< Events the tally was scored for
+  int64_t combinations;   //!< Filter bin combinations visited
+  int64_t results;        //!< Results added (atomic updates or queued scores)
+  int64_t sampled_events; //!< Events whose scoring was timed
+  double sampled_time;    //!< Time spent scoring the sampled events [s]
+
+  //! Time spent scoring all events, extrapolated from the sampled ones [s]
+  double estimated_time() const
+  {
+    return sampled_events > 0 ?
+      sampled_time * static_cast<double>(events) / sampled_events : 0.0;
+  }
+};
+
+//! Scoring of one in this many particles is timed for TallyStats
+constexpr int TALLY_STATS_SAMPLE_INTERVAL {64};
+
+namespace simulation {
+#pragma omp declare target
+extern SharedArray<TallyScore> tally_score_queue;
+#pragma omp end declare target
+}
+
 //==============================================================================
 //! A user-specified flux-weighted (or current) measurement.
 //==============================================================================
@@ -76,6 +131,12 @@ public:
 
   void accumulate();
 
+  //! Accumulate batch values that were reduced across ranks rather than the
+  //! VALUE results, which may already hold the next batch's scores
+  //
+  //! \param values Reduced value of each filter-score bin (used on master)
+  void accumulate_reduced(const double* values);
+
   //! A string representing the i-th score on this tally
   std::string score_name(int score_idx) const;
 
@@ -84,6 +145,48 @@ public:
   void update_host_to_device();
   void release_from_device();
 
+  //! Set up deferred scoring, allocate replicated result buffers if
+  //! settings call for them, pick the filter pipeline and build the
+  //! per-material nuclide bin tables.
+  //! Must be called before the tally itself is mapped to device.
+  void init_device_scoring();
+
+  //! Build the table of nuclide bins present in each material
+  void init_material_nuclides();
+
+  //! Refresh the atom densities of a material in the table of nuclide bins,
+  //! on host and device, after its densities changed during a simulation
+  //
+  //! \param i_material Index of the material
+  void update_material_nuclides(int i_material);
+
+  //! Pick the specialized filter pipeline matching the tally's filters, if any
+  void init_filter_pipeline();
+
+  //! Sum the replicated result buffers into the results on device and zero
+  //! them. Called by update_device_to_host().
+  void reduce_replicas();
+
+  //! Add the blocks of a sparse tally scored on device to the host results
+  //! and empty the device store. Called by update_device_to_host().
+  void gather_sparse_results();
+
+  //! Number of bytes of result storage this tally holds on device
+  size_t device_results_bytes() const;
+
+  //! Copy results accumulated on device back to host if they have changed
+  //! since they were last copied
+  void sync_results_to_host();
+
+  //! Copy the host results to device for a tally accumulated there, e.g.
+  //! after they were reset or read from a statepoint
+  void sync_results_to_device();
+
+  //! Add the scores made on host by hybrid transport to the VALUE results,
+  //! on device for a tally accumulated there, and zero them. Called once the
+  //! device results have been brought back with update_device_to_host().
+  void add_host_scores();
+
   //----------------------------------------------------------------------------
   // Major public data members.
 
@@ -115,10 +218,187 @@ public:
   size_t results_size_ {0};
   size_t n_scores_;
 
+  //! Replicated copies of the VALUE results that device teams score into
+  //! instead of results_, so that fewer threads contend for each atomic. Each
+  //! replica holds n_filter_bins_ * n_scores_ values. Only allocated in
+  //! event-based mode for tallies no larger than
+  //! settings::max_replicated_tally_bins.
+  double* replicas_ {nullptr};
+  int n_replicas_ {0};
+
+  //! VALUE results scored by particles transported on host by hybrid
+  //! transport, which would otherwise be overwritten by the device results.
+  //! Holds n_filter_bins_ * n_scores_ values and is never mapped to device.
+  double* host_scores_ {nullptr};
+
+  //! Whether scores are queued in simulation::tally_score_queue (when it has
+  //! room) rather than added to the results right away
+  bool defer_scores_ {false};
+
+  //! Sparse device storage of the VALUE results of a large tally, used in
+  //! event-based mode for tallies with at least
+  //! settings::min_sparse_tally_bins bins. The filter-score bins are grouped
+  //! in blocks of SPARSE_TALLY_BLOCK, and a block is given a slot in
+  //! sparse_pool_ the first time one of its bins is scored, so that only
+  //! blocks that are scored take device memory. results_ is then kept on
+  //! host only.
+  int n_sparse_blocks_ {0}; //!< Number of blocks, or 0 for dense storage
+  int sparse_capacity_ {0}; //!< Number of slots in the pool
+  int* sparse_slots_ {nullptr}; //!< Pool slot of each block, or -1
+  int* sparse_owners_ {nullptr}; //!< Block held by each slot, or -1
+  int* sparse_used_ {nullptr}; //!< Number of slots claimed so far
+  double* sparse_pool_ {nullptr}; //!< Values of the blocks, plus an overflow block
+  std::vector<int> sparse_touched_; //!< Blocks gathered since the last accumulate()
+
+  //! Whether results_ stays on device between batches, with accumulate()
+  //! run there too. The host copy is then only brought up to date by
+  //! sync_results_to_host() when it is read (statepoints, triggers, the C
+  //! API and the final results).
+  bool accumulate_on_device_ {false};
+  bool host_results_stale_ {false}; //!< Device holds newer results than host
+
+  //! Scoring cost counters, or nullptr unless settings::tally_stats is set
+  TallyStats* stats_ {nullptr};
+
+  //! Bring the host copy of stats_ up to date
+  void sync_stats_to_host();
+
+  //! Whether the batch values have been sent off to be reduced across ranks
+  //! and are accumulated by complete_tally_reductions() instead of accumulate()
+  bool reduction_pending_ {false};
+
+  //! Whether the batch values are reduced straight onto the ranks owning
+  //! contiguous slices of the bins, each of which accumulates only its own
+  //! slice. Master holds all of the results only once they are gathered by
+  //! complete_tally_reductions().
+  bool distributed_ {false};
+  bool gather_pending_ {false}; //!< Slices accumulated since the last gather
+
+  //! Specialized filter pipeline the tally is scored through, chosen by
+  //! init_filter_pipeline(), and the positions in filters_ of its first and
+  //! second filter. Tracklength tallies with a MeshFilter are then scored as
+  //! the mesh is traversed rather than through FilterMatch, which would have
+  //! to hold every bin crossed by the track.
+  FilterPipeline pipeline_ {FilterPipeline::generic};
+  int pipeline_filters_[2] {0, 0};
+
+  //! Slot in SharedFilterBins of each filter, or C_NONE for filters that
+  //! aren't shared with other tallies. Assigned by init_shared_filters().
+  vector<int32_t> shared_slots_;
+
+  //! Tally identical to this one but for a finer EnergyFilter, whose batch
+  //! values this tally's can be summed from, or C_NONE. Assigned by
+  //! init_collapsed_tallies().
+  int32_t collapse_parent_ {C_NONE};
+
+  //! Filter combination of this tally that each filter combination of
+  //! collapse_parent_ falls in, or C_NONE
+  vector<int32_t> collapse_bins_;
+
+  //! Whether this batch's values are collapsed from collapse_parent_ rather
+  //! than scored, which is the case whenever the parent is active too
+  bool collapsed_ {false};
+
+  //! Set the batch values of this tally to the sums of the values of the
+  //! bins of collapse_parent_ that fall in each of its bins
+  void collapse_from_parent();
+
+  //! Nuclide bins present in each material, so that scoring loops skip the
+  //! nuclides a material doesn't contain. The bins for material m are
+  //! material_nuclides_[material_nuclide_offsets_[m + 1]] up to
+  //! material_nuclides_[material_nuclide_offsets_[m + 2]]; the first row holds
+  //! every bin (with zero density) for the void material.
+  int* material_nuclide_offsets_ {nullptr};
+  TallyNuclide* material_nuclides_ {nullptr};
+  int n_material_nuclide_offsets_ {0};
+  int n_material_nuclides_ {0};
+
   #pragma omp declare target
+  //! Get the nuclide bins present in a material
+  //
+  //! \param i_material Index of the material, or MATERIAL_VOID
+  //! \param[out] n Number of bins
+  //! \return Pointer to the first bin
+  const TallyNuclide* material_nuclides(int i_material, int& n) const
+  {
+    const int* offsets = material_nuclide_offsets_ + (i_material + 1);
+    n = offsets[1] - offsets[0];
+    return material_nuclides_ + offsets[0];
+  }
+
+  //! Get the device storage of the VALUE result of a filter-score bin of a
+  //! sparse tally, giving its block a pool slot if it has none. Past the end
+  //! of the pool, an overflow block is returned, which
+  //! gather_sparse_results() reports.
+  //
+  //! \param bin Filter combination index * n_scores_ + score index
+  double* sparse_value(gsl::index bin)
+  {
+    int block = bin / SPARSE_TALLY_BLOCK;
+    int slot;
+    #pragma omp atomic read
+    slot = sparse_slots_[block];
+    if (slot < 0) {
+      // Once the pool has been exceeded, stop counting claims
+      int claimed;
+      #pragma omp atomic read
+      claimed = *sparse_used_;
+      if (claimed <= sparse_capacity_) {
+        #pragma omp atomic capture
+        claimed = (*sparse_used_)++;
+      }
+      if (claimed >= sparse_capacity_) {
+        return sparse_pool_ + sparse_capacity_ * SPARSE_TALLY_BLOCK;
+      }
+      // Another thread may have given the block a slot in the meantime, in
+      // which case the claimed slot is left unused
+      slot = __sync_val_compare_and_swap(&sparse_slots_[block], -1, claimed);
+      if (slot < 0) {
+        slot = claimed;
+        sparse_owners_[slot] = block;
+      }
+    }
+    return sparse_pool_ + slot * SPARSE_TALLY_BLOCK + bin % SPARSE_TALLY_BLOCK;
+  }
+
   const double* results(gsl::index i, gsl::index j, TallyResult k) const;
   double* results(gsl::index i, gsl::index j, TallyResult k);
   std::array<size_t, 3> results_shape() const;
+
+  //! Atomically add a score to the VALUE result of a bin, to its sparse
+  //! storage or to the calling team's replica of it
+  void add_result(gsl::index i, gsl::index j, double score)
+  {
+    if (stats_) {
+      #pragma omp atomic
+      stats_->results++;
+    }
+    if (host_scores_ && omp_is_initial_device()) {
+      #pragma omp atomic
+      host_scores_[i * n_scores_ + j] += score;
+      return;
+    }
+    if (defer_scores_) {
+      TallyScore deferred {static_cast<int32_t>(index_),
+        static_cast<int32_t>(i * n_scores_ + j), score};
+      if (simulation::tally_score_queue.thread_safe_append(deferred) >= 0) {
+        return;
+      }
+    }
+    if (n_sparse_blocks_ > 0) {
+      double* value = sparse_value(i * n_scores_ + j);
+      #pragma omp atomic
+      *value += score;
+    } else if (n_replicas_ > 0) {
+      int r = omp_get_team_num() % n_replicas_;
+      double* value = replicas_ + (r * n_filter_bins_ + i) * n_scores_ + j;
+      #pragma omp atomic
+      *value += score;
+    } else {
+      #pragma omp atomic
+      *results(i, j, TallyResult::VALUE) += score;
+    }
+  }
   #pragma omp end declare target
 
   //! True if this tally should be written to statepoint files
@@ -151,6 +431,49 @@ private:
   gsl::index index_;
 };
 
+//==============================================================================
+//! Records the scoring cost of a tally for one event in its TallyStats, if it
+//! keeps them, when it goes out of scope. Every TALLY_STATS_SAMPLE_INTERVAL-th
+//! particle is also timed.
+//==============================================================================
+
+#pragma omp declare target
+class TallyStatsProbe {
+public:
+  TallyStatsProbe(const Tally& tally, int64_t particle_id)
+    : stats_ {tally.stats_}
+  {
+    if (stats_ && particle_id % TALLY_STATS_SAMPLE_INTERVAL == 0) {
+      start_ = omp_get_wtime();
+    }
+  }
+
+  ~TallyStatsProbe()
+  {
+    if (!stats_) return;
+    #pragma omp atomic
+    stats_->events++;
+    #pragma omp atomic
+    stats_->combinations += n_combinations_;
+    if (start_ >= 0.0) {
+      double elapsed = omp_get_wtime() - start_;
+      #pragma omp atomic
+      stats_->sampled_events++;
+      #pragma omp atomic
+      stats_->sampled_time += elapsed;
+    }
+  }
+
+  //! Count a filter bin combination visited
+  void visit() { ++n_combinations_; }
+
+private:
+  TallyStats* stats_;
+  int64_t n_combinations_ {0};
+  double start_ {-1.0};
+};
+#pragma omp end declare target
+
 //==============================================================================
 // Global variable declarations
 //==============================================================================
@@ -169,10 +492,16 @@ namespace model {
   extern size_t tallies_size;
   extern int* device_active_tallies;
   extern size_t active_tallies_size;
+  extern int* device_active_analog_tallies;
+  extern size_t active_analog_tallies_size;
   extern int* device_active_collision_tallies;
   extern size_t active_collision_tallies_size;
   extern int* device_active_tracklength_tallies;
   extern size_t active_tracklength_tallies_size;
+  extern int* device_active_meshsurf_tallies;
+  extern size_t active_meshsurf_tallies_size;
+  extern int* device_active_surface_tallies;
+  extern size_t active_surface_tallies_size;
   #pragma omp end declare target
 }
 
@@ -198,10 +527,44 @@ extern double global_tally_leakage;
 //! Read tally specification from tallies.xml
 void read_tallies_xml();
 
+//! Allocate the deferred tally score queue on host and device
+//
+//! \param capacity The number of scores the queue can hold
+void init_tally_score_queue(int capacity);
+
+//! Free the deferred tally score queue
+void free_tally_score_queue();
+
+//! Add the scores in the deferred tally score queue to their tallies and empty
+//! it. The scores are sorted by tally and bin on device, after which each run
+//! of scores for the same bin is summed and added with one non-atomic update.
+void reduce_tally_scores();
+
 //! \brief Accumulate the sum of the contributions from each history within the
 //! batch to a new random variable
 void accumulate_tallies();
 
+//! Bring the host results of tallies accumulated on device up to date
+void sync_tally_results_to_host();
+
+//! Bring the host copies of the scoring cost counters of all tallies up to date
+void sync_tally_stats_to_host();
+
+//! Find the filters used by more than one tally whose bins can be evaluated
+//! once per event and shared, and assign them slots in SharedFilterBins.
+//! Must be called before the tallies are mapped to device.
+void init_shared_filters();
+
+//! With settings::collapse_tallies, find the tallies that differ from another
+//! tally only by an EnergyFilter whose edges are a subset of the other's, so
+//! that they are collapsed from it rather than scored. Must be called after
+//! Tally::init_device_scoring() and before the tallies are mapped to device.
+void init_collapsed_tallies();
+
+//! Find the reactions of DEPLETION_REACTIONS scored by any tally, which make
+//! up simulation::depletion_rx
+void init_depletion_rx();
+
 //! Determine which tallies should be active
 void setup_active_tallies();
 
@@ -213,6 +576,14 @@ using adaptor_type = xt::xtensor_adaptor<xt::xbuffer_adaptor<double*&, xt::no_ow
 #ifdef OPENMC_MPI
 //! Collect all tally results onto master process
 void reduce_tally_results();
+
+//! Wait for the tally reductions started by reduce_tally_results() and
+//! accumulate their results. With aggregators or distributed tallies, must be
+//! called on every rank.
+//
+//! \param gather Whether to also gather the slices of distributed tallies
+//!   onto master
+void complete_tally_reductions(bool gather = true);
 #endif
 
 void free_memory_tally();
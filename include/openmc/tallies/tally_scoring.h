@@ -74,6 +74,79 @@ private:
 // Non-member functions
 //==============================================================================
 
+//! Visit every combination of a tally's filter bins that matches the current
+//! event, through the tally's specialized filter pipeline if it has one and
+//! through FilterBinIter otherwise.
+//
+//! \param tally The tally being scored
+//! \param p The particle being tracked
+//! \param shared Bins of the shared filters for the current event
+//! \param visit Called as visit(filter_index, filter_weight)
+template<class F>
+void for_each_filter_bin(const Tally& tally, Particle& p,
+  SharedFilterBins& shared, F&& visit)
+{
+  // Filter, index stride and shared slot of the i-th filter of the pipeline
+  const int* pos = tally.pipeline_filters_;
+  auto filt = [&](int i) -> const Filter& {
+    return model::tally_filters[tally.filters(pos[i])];
+  };
+  auto stride = [&](int i) { return tally.strides(pos[i]); };
+  auto slot = [&](int i) { return tally.shared_slots_[pos[i]]; };
+
+  switch (tally.pipeline_) {
+  case FilterPipeline::mesh:
+    MeshBins::for_each(filt(0), p, tally.estimator_,
+      [&](int bin, double weight) { visit(bin * stride(0), weight); });
+    return;
+  case FilterPipeline::energy_mesh:
+    for_each_filter_pair<EnergyBins, MeshBins>(filt(0), stride(0), slot(0),
+      filt(1), stride(1), slot(1), shared, p, tally.estimator_, visit);
+    return;
+  case FilterPipeline::cell_energy:
+    for_each_filter_pair<CellBins, EnergyBins>(filt(0), stride(0), slot(0),
+      filt(1), stride(1), slot(1), shared, p, tally.estimator_, visit);
+    return;
+  case FilterPipeline::material_energy:
+    for_each_filter_pair<MaterialBins, EnergyBins>(filt(0), stride(0),
+      slot(0), filt(1), stride(1), slot(1), shared, p, tally.estimator_,
+      visit);
+    return;
+  case FilterPipeline::generic:
+    break;
+  }
+
+  // Allocate particle FilterMatch array on the stack
+  FilterMatch filter_matches[FILTER_MATCHES_SIZE];
+  p.filter_matches_ = filter_matches;
+
+  // Reuse the bins of shared filters that another tally already evaluated
+  for (int i = 0; i < tally.n_filters(); ++i) {
+    int s = tally.shared_slots_[i];
+    if (s == C_NONE || shared.bins_[s] == SharedFilterBins::UNKNOWN) continue;
+    auto& match {filter_matches[i]};
+    match.bins_weights_length_ = 0;
+    if (shared.bins_[s] >= 0) match.push_back(shared.bins_[s], 1.0);
+    match.bins_present_ = true;
+  }
+
+  auto filter_iter = FilterBinIter(tally, p);
+  auto end = FilterBinIter(tally, true, p.filter_matches_);
+
+  // Record the bins of shared filters evaluated for this tally
+  for (int i = 0; i < tally.n_filters(); ++i) {
+    int s = tally.shared_slots_[i];
+    const auto& match {filter_matches[i]};
+    if (s == C_NONE || !match.bins_present_) continue;
+    shared.bins_[s] = match.bins_weights_length_ > 0 ? match.bins_[0] :
+      SharedFilterBins::NONE;
+  }
+
+  for (; filter_iter != end; ++filter_iter) {
+    visit(filter_iter.index_, filter_iter.weight_);
+  }
+}
+
 //! Score tallies using a 1 / Sigma_t estimate of the flux.
 //
 //! This is triggered after every collision.  It is invalid for tallies that
@@ -83,6 +156,7 @@ private:
 //! since collisions do not occur in voids.
 //
 //! \param p The particle being tracked
+#pragma omp declare target
 void score_collision_tally(Particle& p);
 
 //! Score tallies based on a simple count of events (for continuous energy).
@@ -98,6 +172,7 @@ void score_analog_tally_ce(Particle& p);
 //
 //! \param p The particle being tracked
 void score_analog_tally_mg(Particle& p);
+#pragma omp end declare target
 
 #pragma omp declare target
 //! Score tallies using a tracklength estimate of the flux.
@@ -111,11 +186,14 @@ void score_analog_tally_mg(Particle& p);
 void score_tracklength_tally(Particle& p, double distance, bool need_depletion_rx);
 #pragma omp end declare target
 
+#pragma omp declare target
 //! Score surface or mesh-surface tallies for particle currents.
 //
 //! \param p The particle being tracked
-//! \param tallies A vector of tallies to score to
-void score_surface_tally(Particle& p, const std::vector<int>& tallies);
+//! \param tallies Indices of the tallies to score to
+//! \param n_tallies The number of tallies to score to
+void score_surface_tally(Particle& p, const int* tallies, int n_tallies);
+#pragma omp end declare target
 
 } // namespace openmc
 
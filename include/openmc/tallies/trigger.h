@@ -40,6 +40,10 @@ namespace settings {
   extern KTrigger keff_trigger;
 }
 
+namespace simulation {
+  extern double trigger_ratio; //!< Largest uncertainty over threshold at the last check, or 0
+}
+
 //==============================================================================
 // Non-memeber functions
 //==============================================================================
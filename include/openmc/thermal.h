@@ -34,6 +34,28 @@ extern ThermalScattering* device_thermal_scatt;
 #pragma omp end declare target
 }
 
+//==============================================================================
+// Constants
+//==============================================================================
+
+//! Thermal elastic scattering treatment of a table at one temperature. It is
+//! resolved from the data types when the table is loaded so that lookups and
+//! sampling go straight to a kernel specialized for it.
+enum class ThermalElastic {
+  none,                //!< No elastic data
+  coherent,            //!< Coherent elastic (Bragg edges)
+  incoherent,          //!< Incoherent elastic
+  incoherent_discrete, //!< Incoherent elastic with discrete cosines
+  generic              //!< Any other combination of XS and distribution
+};
+
+//! Thermal inelastic scattering treatment, resolved like ThermalElastic
+enum class ThermalInelastic {
+  continuous, //!< Incoherent inelastic with continuous outgoing energies
+  discrete,   //!< Incoherent inelastic with discrete outgoing energies
+  generic     //!< Any other combination of XS and distribution
+};
+
 //==============================================================================
 //! Secondary angle-energy data for thermal neutron scattering at a single
 //! temperature
@@ -63,6 +85,9 @@ public:
   void sample(const NuclideMicroXS& micro_xs, double E_in,
               double* E_out, double* mu, uint64_t* seed);
   #pragma omp end declare target
+
+  ThermalElastic elastic_mode() const { return elastic_mode_; }
+  ThermalInelastic inelastic_mode() const { return inelastic_mode_; }
 private:
   struct Reaction {
     // Default constructor
@@ -79,6 +104,10 @@ private:
   Reaction elastic_;
   Reaction inelastic_;
 
+  // Kernels selected for the data above
+  ThermalElastic elastic_mode_ {ThermalElastic::none};
+  ThermalInelastic inelastic_mode_ {ThermalInelastic::generic};
+
   // ThermalScattering needs access to private data members
   friend class ThermalScattering;
 };
@@ -16,15 +16,22 @@ namespace simulation {
 extern Timer time_active;
 extern Timer time_bank;
 extern Timer time_bank_sample;
+extern Timer time_bank_sort;
 extern Timer time_bank_sendrecv;
 extern Timer time_finalize;
 extern Timer time_inactive;
 extern Timer time_initialize;
 extern Timer time_read_xs;
+extern Timer time_read_materials;
+extern Timer time_read_geometry;
+extern Timer time_finalize_geometry;
+extern Timer time_read_tallies;
+extern Timer time_distribcell;
 extern Timer time_statepoint;
 extern Timer time_accumulate_tallies;
 extern Timer time_total;
 extern Timer time_transport;
+extern Timer time_transport_local; //!< Transport excluding waits for other processes
 extern Timer time_event_init;
 extern Timer time_event_calculate_xs;
 extern Timer time_event_calculate_xs_fuel;
@@ -36,6 +43,8 @@ extern Timer time_event_collision;
 extern Timer time_event_death;
 extern Timer time_event_revival;
 extern Timer time_event_sort;
+extern Timer time_event_tail;
+extern Timer time_event_compact;
 
 } // namespace simulation
 
@@ -1,17 +1,72 @@
+//! \file track_output.h
+//! \brief Buffered output of particle tracks to a single file
+
 #ifndef OPENMC_TRACK_OUTPUT_H
 #define OPENMC_TRACK_OUTPUT_H
 
+#include <cstdint>
+
 #include "openmc/particle.h"
+#include "openmc/position.h"
+#include "openmc/shared_array.h"
 
 namespace openmc {
 
+//==============================================================================
+//! One point of a particle track. Points are appended in whatever order the
+//! particles in flight reach them and ordered by particle, track and point
+//! when they are written.
+//==============================================================================
+
+struct TrackPoint {
+  Position r;       //!< Position of the point
+  int64_t particle; //!< ID of the particle
+  int track;        //!< Index of the track among those of the particle
+  int point;        //!< Index of the point along the track
+};
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+#pragma omp declare target
+extern SharedArray<TrackPoint> track_points; //!< Points of the current generation
+extern int* device_track_identifiers; //!< Batch, generation and ID of each particle tracked
+extern int n_track_identifiers;
+#pragma omp end declare target
+
+} // namespace simulation
+
 //==============================================================================
 // Non-member functions
 //==============================================================================
 
+#pragma omp declare target
+//! Whether the tracks of a particle of the current generation are written
+//
+//! \param[in] id ID of the particle
+bool track_particle(int64_t id);
+
+//! Begin a new track of a particle, such as a secondary particle it banked
 void add_particle_track(Particle& p);
+
+//! Append the current position of a particle to its current track. Points
+//! beyond the capacity of simulation::track_points are dropped.
 void write_particle_track(Particle& p);
-void finalize_particle_track(Particle& p);
+#pragma omp end declare target
+
+//! Allocate the track buffer on host and device and create the track file, if
+//! any tracks are written
+void init_track_output();
+
+//! Write the points buffered during a generation to the track file on the
+//! master process and empty the buffer
+void flush_track_output();
+
+//! Close the track file and free the track buffer
+void finalize_track_output();
 
 } // namespace openmc
 
@@ -0,0 +1,152 @@
+//! \file triangle_bvh.h
+//! \brief Flattened bounding volume hierarchy over the triangles of a
+//! surface mesh, for ray queries on host and device
+
+#ifndef OPENMC_TRIANGLE_BVH_H
+#define OPENMC_TRIANGLE_BVH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "openmc/constants.h"
+#include "openmc/position.h"
+#include "openmc/surface.h"
+#include "openmc/vector.h"
+
+namespace openmc {
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Largest number of triangles in a leaf of a TriangleBVH
+constexpr int BVH_LEAF_TRIANGLES {4};
+
+// Number of bins the surface area heuristic evaluates splits at
+constexpr int BVH_SAH_BINS {12};
+
+// Depth of the traversal stack, which bounds the depth of the tree
+constexpr int BVH_MAX_DEPTH {64};
+
+//==============================================================================
+//! A triangle of a surface mesh, wound so that its normal points out of the
+//! volume whose hierarchy it is in
+//==============================================================================
+
+struct BVHTriangle {
+  Position v0, v1, v2; //!< Vertices
+  int32_t surface;     //!< Index of the surface the triangle belongs to
+};
+
+//==============================================================================
+//! Nearest triangle hit by a ray
+//==============================================================================
+
+struct BVHHit {
+  double distance {INFTY};     //!< Distance to the hit
+  int32_t surface {C_NONE};    //!< Surface of the triangle hit
+  int32_t triangle {C_NONE};   //!< Index of the triangle hit
+  bool exiting {false};        //!< Whether the ray leaves the volume there
+};
+
+//==============================================================================
+//! Node of a TriangleBVH. Nodes are stored depth first, so the left child of
+//! an interior node follows it directly.
+//==============================================================================
+
+struct BVHNode {
+  double lower[3]; //!< Lower corner of the bounding box
+  double upper[3]; //!< Upper corner of the bounding box
+  int32_t offset;  //!< First triangle of a leaf, or right child of a node
+  int32_t count;   //!< Number of triangles of a leaf, 0 for interior nodes
+};
+
+//==============================================================================
+//! Bounding volume hierarchy over the triangles bounding one volume
+//==============================================================================
+
+class TriangleBVH {
+public:
+  //! Build the hierarchy with a binned surface area heuristic
+  //
+  //! \param triangles Triangles bounding the volume, oriented outward
+  void build(std::vector<BVHTriangle> triangles);
+
+  //! Nearest triangle along a ray through which the ray leaves the volume
+  //
+  //! Triangles the ray enters the volume through are ignored, so a ray
+  //! starting on the surface it just crossed into the volume, or was just
+  //! reflected from, doesn't hit it again.
+  //! \param r Starting point of the ray
+  //! \param u Direction of the ray
+  //! \return The hit, with an infinite distance if there is none
+  #pragma omp declare target
+  BVHHit ray_fire(Position r, Direction u) const;
+  #pragma omp end declare target
+
+  //! Whether a point is inside the volume, from the orientation of the
+  //! nearest triangle along a direction
+  //
+  //! \param r Point
+  //! \param u Direction of the ray cast from r
+  #pragma omp declare target
+  bool contains(Position r, Direction u) const;
+  #pragma omp end declare target
+
+  //! Bounding box of all triangles
+  BoundingBox bounding_box() const;
+
+  //! Copy the nodes and triangles to device
+  void copy_to_device();
+
+  bool empty() const { return nodes_.size() == 0; }
+
+  vector<BVHNode> nodes_;         //!< Nodes, root first
+  vector<BVHTriangle> triangles_; //!< Triangles, in leaf order
+
+private:
+  //! Nearest triangle hit along a ray
+  //
+  //! \param exiting_only Only consider triangles the ray leaves through
+  #pragma omp declare target
+  BVHHit nearest_hit(Position r, Direction u, bool exiting_only) const;
+  #pragma omp end declare target
+};
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Watertight ray/triangle intersection (Woop, Benthin and Wald, 2013)
+//
+//! Rays through an edge or vertex shared by two triangles hit at least one
+//! of them.
+//! \param r Starting point of the ray
+//! \param u Direction of the ray
+//! \param tri Triangle
+//! \param t_max Hits at this distance or further are ignored
+//! \return Distance to the hit, or INFTY if there is none in [0, t_max)
+#pragma omp declare target
+double intersect_triangle(Position r, Direction u, const BVHTriangle& tri,
+  double t_max);
+#pragma omp end declare target
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace model {
+
+//! Hierarchy over the triangles bounding each cell of a triangle mesh (DAGMC)
+//! model, indexed like model::cells. Empty for CSG models.
+extern std::vector<TriangleBVH> cell_bvhs;
+
+#pragma omp declare target
+extern TriangleBVH* device_cell_bvhs;
+#pragma omp end declare target
+
+} // namespace model
+
+} // namespace openmc
+
+#endif // OPENMC_TRIANGLE_BVH_H
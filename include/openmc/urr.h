@@ -4,6 +4,7 @@
 #define OPENMC_URR_H
 
 #include <iostream>
+#include <vector>
 #include "xtensor/xtensor.hpp"
 
 #include "openmc/constants.h"
@@ -11,6 +12,20 @@
 
 namespace openmc {
 
+class XsCacheReader;
+class XsCacheWriter;
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Number of values in each precomputed band record: cumulative probability
+// followed by the elastic, fission, and capture factors
+constexpr int URR_BAND_FIELDS {4};
+
+// Stand-in for the logarithm of a non-positive factor in log-log band records
+constexpr double URR_LOG_ZERO {-1.0e300};
+
 //==============================================================================
 //! UrrData contains probability tables for the unresolved resonance range.
 //==============================================================================
@@ -29,14 +44,46 @@ public:
   int n_bands_;
   int n_total_prob_;
 
+  // Precomputed sampling data, built when settings::urr_fast_sampling is set.
+  // Every (energy, band) pair has one contiguous record of URR_BAND_FIELDS
+  // values so that a sampled band is read with a single coalesced load. For
+  // log-log tables the factors are stored as logarithms.
+  std::vector<double> bands_;
+  double* device_bands_ {nullptr};
+  std::vector<double> inv_spacing_; //!< 1/dE (lin-lin) or 1/dlog(E) (log-log) of each interval
+  double* device_inv_spacing_ {nullptr};
+  int n_total_bands_ {0};
+
   //! \brief Load the URR data from the provided HDF5 group
   explicit UrrData(hid_t group_id);
 
+  //! \brief Load the URR data from a compiled library
+  explicit UrrData(XsCacheReader& cache);
+
+  //! \brief Write the URR data to a compiled library
+  void write_cache(XsCacheWriter& cache) const;
+
   void flatten_urr_data();
 
   #pragma omp declare target
   double prob(int i_energy, URRTableParam i_tableparam, int band) const;
+
+  //! \brief Sample the elastic, fission, and capture factors at an energy
+  //! from the precomputed band records
+  //
+  //! \param[in] E Incident energy in [eV], inside the table energy range
+  //! \param[in] r Random number used to sample the band at both bounding
+  //!   table energies
+  //! \param[out] p_elastic Elastic factor (or cross section)
+  //! \param[out] p_fission Fission factor (or cross section)
+  //! \param[out] p_capture Capture factor (or cross section)
+  void sample_bands(double E, double r, double& p_elastic, double& p_fission,
+    double& p_capture) const;
   #pragma omp end declare target
+
+private:
+  //! \brief Build the interleaved band records and interval spacings
+  void precompute_bands();
 };
 
 } // namespace openmc
@@ -195,6 +195,15 @@ public:
 #pragma GCC diagnostic pop
   }
 
+  // Copies n elements starting at first to device
+  void update_to_device(size_type first, size_type n) {
+    T* block = data_ + first;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wopenmp-mapping"
+#pragma omp target update to(block[:n])
+#pragma GCC diagnostic pop
+  }
+
   void update_from_device() {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wopenmp-mapping"
@@ -460,6 +469,15 @@ class vector2d : public vector<T> {
     }
   }
 
+  // Copies the first n elements of row i, as filled by copy_row(), to device
+  void update_row_to_device(size_type i, size_type n) {
+    T* row = data_ + i * stride_;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wopenmp-mapping"
+#pragma omp target update to(row[:n])
+#pragma GCC diagnostic pop
+  }
+
   protected:
   using vector<T>::data_;
   using vector<T>::capacity_;
@@ -8,6 +8,7 @@
 #include "xtensor/xtensor.hpp"
 
 #include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <gsl/gsl>
@@ -54,8 +55,15 @@ public:
     CELL
   };
 
+  // Volume estimators
+  enum class Estimator {
+    POINT, //!< Fraction of sampled points within each domain
+    RAY    //!< Fraction of the length of sampled chords within each domain
+  };
+
   // Data members
   TallyDomain domain_type_; //!< Type of domain (cell, material, etc.)
+  Estimator estimator_ {Estimator::POINT}; //!< Volume estimator
   size_t n_samples_; //!< Number of samples to use
   double threshold_ {-1.0}; //!< Error threshold for domain volumes
   TriggerMetric trigger_type_ {TriggerMetric::not_active}; //!< Trigger metric for the volume calculation
@@ -71,7 +79,43 @@ private:
   //! \param[in,out] indices Vector of material indices
   //! \param[in,out] hits Number of hits corresponding to each material
   void check_hit(int i_material, std::vector<int>& indices,
-    std::vector<int>& hits) const;
+    std::vector<int64_t>& hits) const;
+
+  //! \brief Sample one iteration's locations on device and add the hits of
+  //! each material in each domain to the master lists
+  //
+  //! \param[in] iterations Number of iterations already run
+  //! \param[in] i_start Index of the first sample of this process
+  //! \param[in] i_end Index past the last sample of this process
+  //! \param[in,out] master_indices Material indices hit in each domain
+  //! \param[in,out] master_hits Number of hits of each material in each domain
+  void sample_on_device(int iterations, size_t i_start, size_t i_end,
+    std::vector<std::vector<int>>& master_indices,
+    std::vector<std::vector<int64_t>>& master_hits) const;
+
+  //! \brief Trace one iteration's chords and add the fraction of each chord's
+  //! length taken by each material in each domain to the sums
+  //
+  //! Each chord is the line through the bounding box along an isotropic
+  //! direction from a uniformly sampled point. The mean fraction of its
+  //! length within a region is the fraction of the box volume the region
+  //! takes, with a lower variance than the hits of the point itself.
+  //
+  //! \param[in] iterations Number of iterations already run
+  //! \param[in] i_start Index of the first sample of this process
+  //! \param[in] i_end Index past the last sample of this process
+  //! \param[in,out] sums Sum of the fractions, by domain and material slot
+  //!   (material index + 1, so that void is slot 0)
+  //! \param[in,out] sums_sq Sum of the squared fractions, by domain and
+  //!   material slot
+  //! \param[in,out] domain_sums_sq Sum of the squared fractions of each domain
+  void sample_rays(int iterations, size_t i_start, size_t i_end,
+    std::vector<double>& sums, std::vector<double>& sums_sq,
+    std::vector<double>& domain_sums_sq) const;
+
+  //! \brief Map each cell, universe or material (by domain type) to the index
+  //! of the domain it is, or C_NONE
+  std::vector<int> domain_indices() const;
 
 };
 
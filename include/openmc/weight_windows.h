@@ -0,0 +1,153 @@
+//! \file weight_windows.h
+//! \brief Mesh-based weight windows, applied by splitting and Russian roulette
+
+#ifndef OPENMC_WEIGHT_WINDOWS_H
+#define OPENMC_WEIGHT_WINDOWS_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "pugixml.hpp"
+
+#include "openmc/constants.h"
+#include "openmc/particle.h"
+#include "openmc/vector.h"
+
+namespace openmc {
+
+class Tally;
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Number of particle types, for the weight windows of each type
+constexpr int N_WW_PARTICLE_TYPES {4};
+
+//==============================================================================
+//! Bounds on the weight of one type of particle in each bin of a mesh and of
+//! an energy grid. Particles above the upper bound of their bin are split and
+//! particles below its lower bound play Russian roulette. Bins with a
+//! negative lower bound have no window.
+//==============================================================================
+
+class WeightWindows {
+public:
+  WeightWindows() = default;
+  explicit WeightWindows(pugi::xml_node node);
+
+  //! Resolve the mesh, whose index is only final once tallies.xml is read
+  void init();
+
+  //! Index of the bounds at the position and energy of a particle
+  //
+  //! \param[in] p Particle
+  //! \return Index in lower_ww_ and upper_ww_, or C_NONE if the particle is
+  //!   outside of the mesh or of the energy grid
+  #pragma omp declare target
+  int bin(const Particle& p) const;
+  #pragma omp end declare target
+
+  //! Set the bounds from the flux of a mesh tally with the MAGIC method: the
+  //! lower bound of each bin is half the flux there over the largest flux of
+  //! its energy group, so that the bins richest in particles keep source
+  //! particles of unit weight
+  //
+  //! \param[in] tally Tally scoring flux on the mesh (and energy grid) of the
+  //!   windows, accumulated over at least one realization
+  //! \param[in] threshold Largest relative error of the flux for a bin to get
+  //!   a window
+  //! \param[in] ratio Ratio of the upper to the lower bound
+  void update_magic(const Tally& tally, double threshold, double ratio);
+
+  //! Check that a tally can generate these windows
+  //
+  //! \return Whether the tally has a mesh filter on the mesh of the windows,
+  //!   an energy filter with the same group boundaries if the windows have
+  //!   energy groups, no other filters and a flux score
+  bool matches(const Tally& tally) const;
+
+  void copy_to_device();
+  void release_device();
+
+  //! Copy the bounds to device after they were updated on host
+  void update_bounds_to_device();
+
+  int32_t id_ {C_NONE};     //!< User-specified ID
+  Particle::Type particle_ {Particle::Type::neutron}; //!< Type of particle
+  int32_t mesh_id_ {C_NONE}; //!< ID of the mesh
+  int32_t mesh_ {C_NONE};   //!< Index of the mesh in model::meshes
+  int n_mesh_bins_ {0};     //!< Number of mesh bins
+  int n_energy_ {1};        //!< Number of energy groups
+  vector<double> energy_bounds_; //!< Group boundaries in [eV], if any
+  vector<double> lower_ww_; //!< Lower bound of each bin, mesh bin fastest
+  vector<double> upper_ww_; //!< Upper bound of each bin, mesh bin fastest
+  double survival_ratio_ {3.0}; //!< Survival weight over the lower bound
+  int max_split_ {10};      //!< Largest number of particles a split makes
+  double weight_cutoff_ {1.0e-38}; //!< Weight below which particles are killed
+};
+
+//==============================================================================
+//! Periodic update of a set of weight windows from a flux tally
+//==============================================================================
+
+struct WeightWindowsGenerator {
+  int32_t weight_windows_; //!< Index in variance_reduction::weight_windows
+  int32_t tally_id_;       //!< ID of the flux tally
+  int32_t tally_ {C_NONE}; //!< Index of the flux tally in model::tallies
+  double threshold_ {1.0}; //!< Largest relative error of a windowed bin
+  double ratio_ {5.0};     //!< Upper over lower bound
+  int interval_ {1};       //!< Active batches between updates
+};
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Read the <weight_windows> and <weight_window_generator> elements of
+//! settings.xml
+void read_weight_windows(pugi::xml_node root);
+
+//! Resolve the meshes and tallies that weight windows refer to
+void init_weight_windows();
+
+//! Split or roulette a particle according to the weight window of its
+//! position and energy, if there is one
+#pragma omp declare target
+void apply_weight_windows(Particle& p);
+#pragma omp end declare target
+
+//! Update the generated weight windows after an active batch, on host and
+//! device, when it is due
+void update_weight_windows();
+
+//! Restore the number of daughters that splitting may add in the next
+//! generation, on host and device
+void reset_split_budget();
+
+void free_memory_weight_windows();
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace variance_reduction {
+
+extern std::vector<WeightWindows> weight_windows;
+extern std::unordered_map<int32_t, int32_t> ww_map;
+extern std::vector<WeightWindowsGenerator> ww_generators;
+
+#pragma omp declare target
+extern WeightWindows* device_weight_windows;
+//! Index of the weight windows of each particle type, or C_NONE
+extern int32_t particle_weight_windows[N_WW_PARTICLE_TYPES];
+extern int64_t n_split_daughters; //!< Daughters split off this generation
+extern int64_t split_budget;      //!< Most daughters split off per generation
+#pragma omp end declare target
+
+} // namespace variance_reduction
+
+} // namespace openmc
+
+#endif // OPENMC_WEIGHT_WINDOWS_H
@@ -29,6 +29,10 @@ constexpr int FIT_S {0}; // Scattering
 constexpr int FIT_A {1}; // Absorption
 constexpr int FIT_F {2}; // Fission
 
+// Number of poles whose Faddeeva evaluations are batched together when a
+// batched settings::faddeeva_method is selected
+constexpr int WMP_POLE_CHUNK {8};
+
 // Multipole HDF5 file version
 constexpr std::array<int, 2> WMP_VERSION {1, 1};
 
@@ -68,7 +72,9 @@ public:
   //! \param sqrtkT Square root of temperature times Boltzmann constant
   //! \return Tuple of derivatives of elastic scattering, absorption, and
   //!         fission cross sections in [b/K]
+  #pragma omp declare target
   std::tuple<double, double, double> evaluate_deriv(double E, double sqrtkT) const;
+  #pragma omp end declare target
 
   void flatten_wmp_data();
 
@@ -105,6 +111,25 @@ public:
   #pragma omp end declare target
 };
 
+//========================================================================
+// Global variables
+//========================================================================
+
+namespace data {
+
+//! Indices in data::nuclides of the nuclides with multipole data
+extern vector<int> wmp_nuclides;
+//! For each nuclide, its position in wmp_nuclides (or C_NONE). This is the
+//! column of the nuclide's results in event-based batched multipole lookups.
+extern vector<int> wmp_slot;
+#pragma omp declare target
+extern int* device_wmp_nuclides;
+extern int* device_wmp_slot;
+extern int n_wmp_nuclides;
+#pragma omp end declare target
+
+} // namespace data
+
 //========================================================================
 // Non-member functions
 //========================================================================
@@ -120,6 +145,13 @@ void check_wmp_version(hid_t file);
 //! \param[in] i_nuclide  Index in global nuclides array
 void read_multipole_data(int i_nuclide);
 
+//! Build data::wmp_nuclides and data::wmp_slot from the nuclides that have
+//! multipole data and map them to device
+void init_wmp_slots();
+
+//! Release data::wmp_nuclides and data::wmp_slot on host and device
+void free_wmp_slots();
+
 
 //==============================================================================
 //! Doppler broadens the windowed multipole curvefit.
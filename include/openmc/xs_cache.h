@@ -0,0 +1,172 @@
+//! \file xs_cache.h
+//! \brief Compiled cross section libraries: the nuclides of a model as they
+//! are once read from HDF5, written to one binary file that later runs map
+//! into memory instead of reading the HDF5 libraries again
+
+#ifndef OPENMC_XS_CACHE_H
+#define OPENMC_XS_CACHE_H
+
+#include <cstdint>
+#include <cstring> // for memcpy
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "openmc/vector.h"
+
+namespace openmc {
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Version of the cache file layout. Files of another version are ignored.
+constexpr int XS_CACHE_VERSION {4};
+
+//==============================================================================
+//! Sequential writer of a cache file. The file is written under a temporary
+//! name and renamed into place by close(), so that readers never see a
+//! partial file.
+//==============================================================================
+
+class XsCacheWriter {
+public:
+  explicit XsCacheWriter(const std::string& filename);
+
+  template<typename T>
+  void write(T value) { write_bytes(&value, sizeof(T)); }
+
+  template<typename T>
+  void write(const std::vector<T>& v) { write_array(v.data(), v.size()); }
+
+  template<typename T>
+  void write(const vector<T>& v) { write_array(v.data(), v.size()); }
+
+  void write(const std::string& s) { write_array(s.data(), s.size()); }
+
+  //! Write a number of elements followed by the elements
+  template<typename T>
+  void write_array(const T* data, size_t n)
+  {
+    write<uint64_t>(n);
+    write_bytes(data, n * sizeof(T));
+  }
+
+  void write_bytes(const void* data, size_t n);
+
+  //! Finish the file and move it into place
+  //
+  //! \return Whether the file was written in full
+  bool close();
+
+private:
+  std::string filename_; //!< Final name of the file
+  std::string temp_;     //!< Name the file is written under
+  std::ofstream stream_;
+};
+
+//==============================================================================
+//! Sequential reader of a cache file mapped into memory
+//==============================================================================
+
+class XsCacheReader {
+public:
+  //! Map a cache file
+  //
+  //! \param[in] filename Path to the file
+  //! \return Whether the file exists and could be mapped
+  bool open(const std::string& filename);
+
+  ~XsCacheReader();
+
+  template<typename T>
+  T read()
+  {
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  //! Read a number of elements and return a pointer to the elements, which
+  //! stay valid while the file is mapped
+  template<typename T>
+  const T* read_array(size_t& n)
+  {
+    n = read<uint64_t>();
+    return reinterpret_cast<const T*>(take(n * sizeof(T)));
+  }
+
+  template<typename T>
+  void read(std::vector<T>& v)
+  {
+    size_t n;
+    const T* data = read_array<T>(n);
+    v.assign(data, data + n);
+  }
+
+  template<typename T>
+  void read(vector<T>& v)
+  {
+    size_t n;
+    const T* data = read_array<T>(n);
+    v.resize(n);
+    if (n > 0) std::memcpy(v.data(), data, n * sizeof(T));
+  }
+
+  std::string read_string()
+  {
+    size_t n;
+    const char* data = read_array<char>(n);
+    return {data, n};
+  }
+
+private:
+  //! Advance past n bytes, aborting if the file ends before them
+  const char* take(size_t n);
+
+  std::string filename_;
+  const char* data_ {nullptr}; //!< Start of the mapping
+  size_t size_ {0};            //!< Size of the file
+  size_t offset_ {0};          //!< Position of the next read
+};
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+//! Path of the cache file for reading a set of nuclides with the current
+//! settings
+//
+//! The name is a hash of a key made of everything the nuclides read depend
+//! on: the settings used while reading them and, for each nuclide in the
+//! order of its index, its name, temperatures and the path, size and
+//! modification time of its library. The same key is stored in the file and
+//! compared on reading.
+//! \param[in] nuclides Indices of the nuclides, in order
+//! \param[in] names Name of each nuclide by index
+//! \param[in] temps Temperatures of each nuclide by index in [K]
+//! \param[out] key Key of the nuclides
+//! \return Path of the cache file in settings::path_xs_cache
+std::string xs_cache_filename(const std::vector<int>& nuclides,
+  const std::vector<std::string>& names,
+  const std::vector<std::vector<double>>& temps, std::string& key);
+
+//! Construct data::nuclides and data::ct_tables from a cache file
+//
+//! \param[in] filename Path to the cache file
+//! \param[in] key Key the file must have been written with
+//! \param[in] n_nuclides Number of nuclides expected
+//! \return Whether the file existed and matched the key. The nuclides are not
+//!   touched otherwise.
+bool read_xs_cache(const std::string& filename, const std::string& key,
+  int n_nuclides);
+
+//! Write data::nuclides and data::ct_tables to a cache file
+//
+//! \param[in] filename Path to the cache file
+//! \param[in] key Key of the nuclides
+void write_xs_cache(const std::string& filename, const std::string& key);
+
+} // namespace openmc
+
+#endif // OPENMC_XS_CACHE_H
@@ -0,0 +1,48 @@
+import numpy as np
+
+
+# Version of the HDF5 model input (materials.h5 and geometry.h5)
+MODEL_INPUT_VERSION = (1, 0)
+
+
+def write_strings(group, name, strings):
+    """Write a 1D dataset of fixed-length strings.
+
+    Parameters
+    ----------
+    group : h5py.Group
+        Group to write the dataset in
+    name : str
+        Name of the dataset
+    strings : iterable of str
+        Strings to write
+
+    """
+    data = [s.encode() for s in strings]
+    group.create_dataset(name, data=np.array(data, dtype='S'))
+
+
+def write_ragged(group, name, rows, dtype):
+    """Write rows of varying length as the values of all rows and the offset
+    of each row, followed by the total, in a second dataset named with an
+    '_offsets' suffix.
+
+    Parameters
+    ----------
+    group : h5py.Group
+        Group to write the datasets in
+    name : str
+        Name of the dataset of values
+    rows : iterable of iterable
+        Values of each row
+    dtype : numpy.dtype
+        Type of the values
+
+    """
+    rows = list(rows)
+    offsets = np.zeros(len(rows) + 1, dtype=np.int64)
+    offsets[1:] = np.cumsum([len(row) for row in rows])
+    values = np.fromiter((x for row in rows for x in row), dtype=dtype,
+                         count=offsets[-1])
+    group.create_dataset(name, data=values)
+    group.create_dataset(name + '_offsets', data=offsets)
@@ -43,6 +43,10 @@ _TINY_BIT = 1.e-8
 # For non-accelerated regions on coarse mesh overlay
 _CMFD_NOACCEL = -1
 
+# Linear solvers for the CMFD matrix equations, in the order of the C++
+# CmfdSolver enum
+_LINEAR_SOLVERS = ['gauss-seidel', 'bicgstab']
+
 # Constant to represent a zero flux "albedo"
 _ZERO_FLUX = 999.0
 
@@ -364,6 +368,18 @@ class CMFDRun:
         Time for solving CMFD matrix equations, in seconds
     use_all_threads : bool
         Whether to use all threads allocated to OpenMC for CMFD solver
+    linear_solver : {'gauss-seidel', 'bicgstab'}
+        Linear solver for the CMFD matrix equations. Options are:
+
+        * "gauss-seidel" - Red-black Gauss-Seidel iterations with
+          overrelaxation by ``spectral``. Inner iterations stop when the RMS
+          relative change of the flux falls below the inner tolerance.
+        * "bicgstab" - BiCGSTAB with a Jacobi preconditioner for any number of
+          groups. Inner iterations stop when the norm of the residual relative
+          to that of the source falls below the inner tolerance.
+
+    linear_solver_on_device : bool
+        Whether to run the "bicgstab" linear solver on the device
     intracomm : mpi4py.MPI.Intracomm or None
         MPI intercommunicator for running MPI commands
 
@@ -398,6 +414,8 @@ class CMFDRun:
         self._window_size = 10
         self._intracomm = None
         self._use_all_threads = False
+        self._linear_solver = 'gauss-seidel'
+        self._linear_solver_on_device = False
 
         # External variables used during runtime but users cannot control
         self._set_reference_params = False
@@ -564,6 +582,14 @@ class CMFDRun:
     def use_all_threads(self):
         return self._use_all_threads
 
+    @property
+    def linear_solver(self):
+        return self._linear_solver
+
+    @property
+    def linear_solver_on_device(self):
+        return self._linear_solver_on_device
+
     @property
     def cmfd_src(self):
         return self._cmfd_src
@@ -762,6 +788,17 @@ class CMFDRun:
         check_type('CMFD use all threads', use_all_threads, bool)
         self._use_all_threads = use_all_threads
 
+    @linear_solver.setter
+    def linear_solver(self, linear_solver):
+        check_value('CMFD linear solver', linear_solver,
+                    _LINEAR_SOLVERS)
+        self._linear_solver = linear_solver
+
+    @linear_solver_on_device.setter
+    def linear_solver_on_device(self, on_device):
+        check_type('CMFD linear solver on device', on_device, bool)
+        self._linear_solver_on_device = on_device
+
     def run(self, **kwargs):
         """Run OpenMC with coarse mesh finite difference acceleration
 
@@ -988,7 +1025,9 @@ class CMFDRun:
 
         args = temp_loss.indptr, len(temp_loss.indptr), \
             temp_loss.indices, len(temp_loss.indices), n, \
-            self._spectral, coremap, self._use_all_threads
+            self._spectral, coremap, self._use_all_threads, \
+            _LINEAR_SOLVERS.index(self._linear_solver), \
+            self._linear_solver_on_device
         return openmc.lib._dll.openmc_initialize_linsolver(*args)
 
     def _write_cmfd_output(self):
@@ -262,6 +262,15 @@ class ReactionRateHelper(ABC):
         check_type("nuclides", nuclides, list, str)
         self._nuclides = nuclides
 
+    def unpack(self):
+        """Unpack tally data prior to computing reaction rates.
+
+        Called after a :meth:`openmc.deplete.Operator.__call__` routine,
+        before :meth:`get_material_rates` is called for each material.
+
+        Not necessary for all subclasses to implement.
+        """
+
     @abstractmethod
     def get_material_rates(self, mat_id, nuc_index, react_index):
         """Return 2D array of [nuclide, reaction] reaction rates
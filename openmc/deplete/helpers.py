@@ -80,6 +80,10 @@ class DirectReactionRateHelper(ReactionRateHelper):
         self._rate_tally.scores = scores
         self._rate_tally.filters = [MaterialFilter(materials)]
 
+    def unpack(self):
+        """Read the mean reaction rates of all materials at once"""
+        self._rate_means = self._rate_tally.mean
+
     def get_material_rates(self, mat_id, nuc_index, react_index):
         """Return an array of reaction rates for a material
 
@@ -100,7 +104,7 @@ class DirectReactionRateHelper(ReactionRateHelper):
             reaction rates in this material
         """
         self._results_cache.fill(0.0)
-        full_tally_res = self._rate_tally.mean[mat_id]
+        full_tally_res = self._rate_means[mat_id]
         for i_tally, (i_nuc, i_react) in enumerate(
                 product(nuc_index, react_index)):
             self._results_cache[i_nuc, i_react] = full_tally_res[i_tally]
@@ -191,6 +195,18 @@ class FluxCollapseHelper(ReactionRateHelper):
             if self._nuclides_direct is not None:
                 self._rate_tally.nuclides = self._nuclides_direct
 
+    def unpack(self):
+        """Collapse the flux spectrum of every material with the C API
+
+        The reaction rates of all materials, nuclides and reactions that are
+        not tallied directly are computed at once, in parallel, from the mean
+        flux of the last transport solve.
+        """
+        self._collapsed_rates = self._flux_tally.collapse_rates(
+            self.nuclides, self._mts)
+        if self._reactions_direct:
+            self._rate_means = self._rate_tally.mean
+
     def get_material_rates(self, mat_index, nuc_index, react_index):
         """Return an array of reaction rates for a material
 
@@ -213,27 +229,17 @@ class FluxCollapseHelper(ReactionRateHelper):
         """
         self._results_cache.fill(0.0)
 
-        # Get flux for specified material
-        shape = (len(self._materials), len(self._energies) - 1)
-        mean_value = self._flux_tally.mean.reshape(shape)
-        flux = mean_value[mat_index]
+        # Reaction rates collapsed from the flux of the material
+        collapsed = self._collapsed_rates[mat_index]
 
         # Get direct reaction rates
         if self._reactions_direct:
             nuclides_direct = self._rate_tally.nuclides
             shape = (len(nuclides_direct), len(self._reactions_direct))
-            rx_rates = self._rate_tally.mean[mat_index].reshape(shape)
-
-        mat = self._materials[mat_index]
-
-        # Build nucname: density mapping to enable O(1) lookup in loop below
-        densities = dict(zip(mat.nuclides, mat.densities))
+            rx_rates = self._rate_means[mat_index].reshape(shape)
 
-        for name, i_nuc in zip(self.nuclides, nuc_index):
-            # Determine density of nuclide
-            density = densities[name]
-
-            for mt, score, i_rx in zip(self._mts, self._scores, react_index):
+        for j, (name, i_nuc) in enumerate(zip(self.nuclides, nuc_index)):
+            for k, (score, i_rx) in enumerate(zip(self._scores, react_index)):
                 if score in self._reactions_direct and name in nuclides_direct:
                     # Determine index in rx_rates
                     i_rx_direct = self._reactions_direct.index(score)
@@ -242,13 +248,7 @@ class FluxCollapseHelper(ReactionRateHelper):
                     # Get reaction rate from tally
                     self._results_cache[i_nuc, i_rx] = rx_rates[i_nuc_direct, i_rx_direct]
                 else:
-                    # Use flux to collapse reaction rate (per N)
-                    nuc = openmc.lib.nuclides[name]
-                    rate_per_nuc = nuc.collapse_rate(
-                        mt, mat.temperature, self._energies, flux)
-
-                    # Multiply by density to get absolute reaction rate
-                    self._results_cache[i_nuc, i_rx] = rate_per_nuc * density
+                    self._results_cache[i_nuc, i_rx] = collapsed[j, k]
 
         return self._results_cache
 
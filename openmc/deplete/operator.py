@@ -561,6 +561,10 @@ class Operator(TransportOperator):
         for rank in range(comm.size):
             number_i = comm.bcast(self.number, root=rank)
 
+            # The compositions of all materials of a process are set at once
+            materials = []
+            mat_nuclides = []
+            mat_densities = []
             for mat in number_i.materials:
                 nuclides = []
                 densities = []
@@ -587,12 +591,16 @@ class Operator(TransportOperator):
                                       " is negative (density = ", val, " at/barn-cm)")
                             number_i[mat, nuc] = 0.0
 
-                # Update densities on C API side
-                mat_internal = openmc.lib.materials[int(mat)]
-                mat_internal.set_densities(nuclides, densities)
+                materials.append(openmc.lib.materials[int(mat)])
+                mat_nuclides.append(nuclides)
+                mat_densities.append(densities)
 
-                #TODO Update densities on the Python side, otherwise the
-                # summary.h5 file contains densities at the first time step
+            # Update densities on C API side
+            openmc.lib.set_material_compositions(
+                materials, mat_nuclides, mat_densities)
+
+            #TODO Update densities on the Python side, otherwise the
+            # summary.h5 file contains densities at the first time step
 
     def _generate_materials_xml(self):
         """Creates materials.xml from self.number.
@@ -689,6 +697,7 @@ class Operator(TransportOperator):
         # Keep track of energy produced from all reactions in eV per source
         # particle
         self._normalization_helper.reset()
+        self._rate_helper.unpack()
         self._yield_helper.unpack()
 
         # Store fission yield dictionaries
@@ -22,7 +22,8 @@ _FILTER_TYPES = (
     'universe', 'material', 'cell', 'cellborn', 'surface', 'mesh', 'energy',
     'energyout', 'mu', 'polar', 'azimuthal', 'distribcell', 'delayedgroup',
     'energyfunction', 'cellfrom', 'legendre', 'spatiallegendre',
-    'sphericalharmonics', 'zernike', 'zernikeradial', 'particle', 'cellinstance'
+    'sphericalharmonics', 'zernike', 'zernikeradial', 'particle', 'cellinstance',
+    'time'
 )
 
 _CURRENT_NAMES = (
@@ -1631,6 +1632,42 @@ class AzimuthalFilter(RealFilter):
                 cv.check_less_than('filter value', x, np.pi, equality=True)
 
 
+class TimeFilter(RealFilter):
+    """Bins tally events based on the particle's time.
+
+    Track-length estimates are divided among the bins the track spans, in
+    proportion to the time the particle spends in each of them.
+
+    Parameters
+    ----------
+    values : Iterable of Real
+        A grid of times in [s] which events will be binned into. Each
+        successive pair of values is the range of times for a bin.
+    filter_id : int
+        Unique identifier for the filter
+
+    Attributes
+    ----------
+    values : numpy.ndarray
+        An array of values for which each successive pair constitutes a range of
+        times in [s] for a single bin
+    id : int
+        Unique identifier for the filter
+    bins : numpy.ndarray
+        An array of shape (N, 2) where each row is a pair of times in [s] for a
+        single filter bin
+    num_bins : Integral
+        The number of filter bins
+
+    """
+    units = 's'
+
+    def check_bins(self, bins):
+        super().check_bins(bins)
+        for x in np.ravel(bins):
+            cv.check_greater_than('filter value', x, 0., equality=True)
+
+
 class DelayedGroupFilter(Filter):
     """Bins fission events based on the produced neutron precursor groups.
 
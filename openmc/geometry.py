@@ -4,8 +4,12 @@ from copy import deepcopy
 from pathlib import Path
 from xml.etree import ElementTree as ET
 
+import h5py
+import numpy as np
+
 import openmc
 import openmc._xml as xml
+from ._hdf5 import MODEL_INPUT_VERSION, write_ragged, write_strings
 from .checkvalue import check_type
 
 
@@ -114,6 +118,89 @@ class Geometry:
         tree = ET.ElementTree(root_element)
         tree.write(str(p), xml_declaration=True, encoding='utf-8')
 
+    def export_to_hdf5(self, path='geometry.h5', remove_surfs=False):
+        """Export geometry to an HDF5 file.
+
+        Surfaces and cells are written as columns that OpenMC reads in place
+        of geometry.xml when that file is absent, which is much faster for
+        models with very many cells. Lattices are written as the XML elements
+        that geometry.xml would hold.
+
+        .. versionadded:: 0.13
+
+        Parameters
+        ----------
+        path : str
+            Path to file to write. Defaults to 'geometry.h5'.
+        remove_surfs : bool
+            Whether or not to remove redundant surfaces from the geometry when
+            exporting
+
+        """
+        if remove_surfs:
+            self.remove_redundant_surfaces()
+
+        # The XML representation is transcribed to columns so that the file
+        # holds exactly what geometry.xml would
+        root_element = ET.Element("geometry")
+        self.root_universe.create_xml_subelement(root_element, memo=set())
+        surfaces = sorted(root_element.findall('surface'),
+                          key=lambda x: int(x.get('id')))
+        cells = sorted(root_element.findall('cell'),
+                       key=lambda x: int(x.get('id')))
+        lattices = ET.Element("geometry")
+        lattices[:] = sorted(
+            (e for e in root_element if e.tag in ('lattice', 'hex_lattice')),
+            key=lambda x: (x.tag, int(x.get('id'))))
+
+        def floats(element, name):
+            return [float(x) for x in element.get(name, '').split()]
+
+        p = Path(path)
+        if p.is_dir():
+            p /= 'geometry.h5'
+
+        with h5py.File(str(p), 'w') as f:
+            f.attrs['filetype'] = np.string_('geometry')
+            f.attrs['version'] = MODEL_INPUT_VERSION
+
+            group = f.create_group('surfaces')
+            group.create_dataset('id', data=np.array(
+                [int(e.get('id')) for e in surfaces], dtype=np.int32))
+            write_strings(group, 'type', (e.get('type') for e in surfaces))
+            write_strings(group, 'name', (e.get('name', '') for e in surfaces))
+            write_strings(group, 'boundary',
+                          (e.get('boundary', '') for e in surfaces))
+            group.create_dataset('periodic_surface_id', data=np.array(
+                [int(e.get('periodic_surface_id', -1)) for e in surfaces],
+                dtype=np.int32))
+            write_ragged(group, 'coeffs',
+                         (floats(e, 'coeffs') for e in surfaces), float)
+
+            group = f.create_group('cells')
+            group.create_dataset('id', data=np.array(
+                [int(e.get('id')) for e in cells], dtype=np.int32))
+            write_strings(group, 'name', (e.get('name', '') for e in cells))
+            group.create_dataset('universe', data=np.array(
+                [int(e.get('universe', 0)) for e in cells], dtype=np.int32))
+            group.create_dataset('fill', data=np.array(
+                [int(e.get('fill', -1)) for e in cells], dtype=np.int32))
+            write_ragged(group, 'region', (e.get('region', '').encode()
+                                           for e in cells), np.int8)
+            write_ragged(group, 'material', (
+                [-1 if m == 'void' else int(m)
+                 for m in e.get('material', '').split()] for e in cells),
+                np.int32)
+            write_ragged(group, 'temperature',
+                         (floats(e, 'temperature') for e in cells), float)
+            write_ragged(group, 'translation',
+                         (floats(e, 'translation') for e in cells), float)
+            write_ragged(group, 'rotation',
+                         (floats(e, 'rotation') for e in cells), float)
+
+            f.create_dataset('lattices', data=np.string_(
+                ET.tostring(lattices, encoding='unicode')))
+
     @classmethod
     def from_xml(cls, path='geometry.xml', materials=None):
         """Generate geometry from XML file
@@ -8,11 +8,11 @@ import numpy as np
 
 from ..exceptions import AllocationError, InvalidIDError
 from . import _dll
-from .core import _FortranObjectWithID
+from .core import _FortranObjectWithID, _array_1d_int, _array_1d_dble
 from .error import _error_handler
 from .material import Material
 
-__all__ = ['Cell', 'cells']
+__all__ = ['Cell', 'cells', 'set_cell_temperatures']
 
 # Cell functions
 _dll.openmc_extend_cells.argtypes = [c_int32, POINTER(c_int32), POINTER(c_int32)]
@@ -49,6 +49,10 @@ _dll.openmc_cell_set_temperature.argtypes = [
     c_int32, c_double, POINTER(c_int32), c_bool]
 _dll.openmc_cell_set_temperature.restype = c_int
 _dll.openmc_cell_set_temperature.errcheck = _error_handler
+_dll.openmc_cells_set_temperatures.argtypes = [
+    c_int, _array_1d_int, POINTER(c_int32), _array_1d_dble]
+_dll.openmc_cells_set_temperatures.restype = c_int
+_dll.openmc_cells_set_temperatures.errcheck = _error_handler
 _dll.openmc_get_cell_index.argtypes = [c_int32, POINTER(c_int32)]
 _dll.openmc_get_cell_index.restype = c_int
 _dll.openmc_get_cell_index.errcheck = _error_handler
@@ -229,6 +233,37 @@ class Cell(_FortranObjectWithID):
         return llc, urc
 
 
+def set_cell_temperatures(cells, temperatures, instances=None):
+    """Set the temperatures of many cells in one call
+
+    Only the temperatures that changed are sent to device, if the geometry
+    has been moved there.
+
+    Parameters
+    ----------
+    cells : iterable of openmc.lib.Cell
+        Cells filled by a material
+    temperatures : iterable of float
+        Temperature of each cell in K
+    instances : iterable of int or None
+        Instance of each cell to set the temperature of, or -1 for all of its
+        instances. If None, all instances of each cell are set.
+
+    """
+    index = np.array([c._index for c in cells], dtype=np.int32)
+    T = np.ascontiguousarray(temperatures, dtype=np.double)
+    if T.shape != index.shape:
+        raise ValueError('One temperature must be given per cell.')
+    if instances is None:
+        instance = None
+    else:
+        instance = np.ascontiguousarray(instances, dtype=np.int32)
+        if instance.shape != index.shape:
+            raise ValueError('One instance must be given per cell.')
+        instance = instance.ctypes.data_as(POINTER(c_int32))
+    _dll.openmc_cells_set_temperatures(len(index), index, instance, T)
+
+
 class _CellMapping(Mapping):
     def __getitem__(self, key):
         index = c_int32()
@@ -21,7 +21,8 @@ class _Bank(Structure):
                 ('surf_id', c_int),
                 ('particle', c_int),
                 ('parent_id', c_int64),
-                ('progeny_id', c_int64)]
+                ('progeny_id', c_int64),
+                ('time', c_double)]
 
 
 # Define input type for numpy arrays that will be passed into C++ functions
@@ -41,6 +42,10 @@ _dll.openmc_find_cell.argtypes = [POINTER(c_double*3), POINTER(c_int32),
                                   POINTER(c_int32)]
 _dll.openmc_find_cell.restype = c_int
 _dll.openmc_find_cell.errcheck = _error_handler
+_dll.openmc_find_cells.argtypes = [_array_1d_dble, c_int, _array_1d_int,
+                                   _array_1d_int]
+_dll.openmc_find_cells.restype = c_int
+_dll.openmc_find_cells.errcheck = _error_handler
 _dll.openmc_hard_reset.restype = c_int
 _dll.openmc_hard_reset.errcheck = _error_handler
 _dll.openmc_init.argtypes = [c_int, POINTER(POINTER(c_char)), c_void_p]
@@ -54,7 +59,7 @@ _dll.openmc_initialize_mesh_egrid.argtypes = [
 ]
 _dll.openmc_initialize_mesh_egrid.restype = None
 _init_linsolver_argtypes = [_array_1d_int, c_int, _array_1d_int, c_int, c_int,
-                            c_double, _array_1d_int, c_bool]
+                            c_double, _array_1d_int, c_bool, c_int, c_bool]
 _dll.openmc_initialize_linsolver.argtypes = _init_linsolver_argtypes
 _dll.openmc_initialize_linsolver.restype = None
 _dll.openmc_is_statepoint_batch.restype = c_bool
@@ -80,6 +85,11 @@ _run_linsolver_argtypes = [_array_1d_dble, _array_1d_dble, _array_1d_dble,
                            c_double]
 _dll.openmc_run_linsolver.argtypes = _run_linsolver_argtypes
 _dll.openmc_run_linsolver.restype = c_int
+_dll.openmc_search_keff.argtypes = [
+    c_char_p, c_int32, c_double, c_double, c_double, c_double, c_int,
+    POINTER(c_double), POINTER(c_double), POINTER(c_int)]
+_dll.openmc_search_keff.restype = c_int
+_dll.openmc_search_keff.errcheck = _error_handler
 _dll.openmc_source_bank.argtypes = [POINTER(POINTER(_Bank)), POINTER(c_int64)]
 _dll.openmc_source_bank.restype = c_int
 _dll.openmc_source_bank.errcheck = _error_handler
@@ -179,6 +189,32 @@ def find_cell(xyz):
     return openmc.lib.Cell(index=index.value), instance.value
 
 
+def find_cells(xyz):
+    """Find the cells at many points in one call
+
+    Parameters
+    ----------
+    xyz : numpy.ndarray
+        Cartesian coordinates of the points with shape (N, 3)
+
+    Returns
+    -------
+    numpy.ndarray
+        Index of the cell containing each point, or -1 for points outside of
+        the geometry
+    numpy.ndarray
+        Instance of the cell at each point, or -1 for points outside of the
+        geometry
+
+    """
+    xyz = np.ascontiguousarray(xyz, dtype=np.double).reshape(-1, 3)
+    n = xyz.shape[0]
+    index = np.empty(n, dtype=np.int32)
+    instance = np.empty(n, dtype=np.int32)
+    _dll.openmc_find_cells(xyz.ravel(), n, index, instance)
+    return index, instance
+
+
 def find_material(xyz):
     """Find the material at a given point
 
@@ -371,6 +407,54 @@ def run():
     _dll.openmc_run()
 
 
+def search_for_keff(obj, bracket, target=1.0, tol=1e-3, max_iterations=10):
+    """Search for the density of a material or the temperature of a cell at
+    which keff reaches a target.
+
+    Every iterate is run in memory. Those after the first start from the
+    source the previous one converged to and, when Shannon entropy is on, end
+    their inactive batches once the entropy is back to that of the previous
+    active batches.
+
+    Parameters
+    ----------
+    obj : openmc.lib.Material or openmc.lib.Cell
+        Material whose density [g/cm3] or cell whose temperature [K] is varied
+    bracket : Iterable of float
+        Lower and upper values of the parameter, at which keff must lie on
+        either side of the target
+    target : float
+        Value of keff to search for
+    tol : float
+        Tolerance on keff at which the search stops
+    max_iterations : int
+        Maximum number of simulations to run
+
+    Returns
+    -------
+    guesses : list of float
+        Values of the parameter at each iterate
+    keffs : list of tuple
+        Mean keff and its standard deviation at each iterate
+
+    """
+    if isinstance(obj, openmc.lib.Material):
+        parameter = b'density'
+    elif isinstance(obj, openmc.lib.Cell):
+        parameter = b'temperature'
+    else:
+        raise TypeError('Only a material density or a cell temperature can be '
+                        'searched over.')
+    lower, upper = bracket
+    guesses = (c_double*max_iterations)()
+    keffs = (c_double*(2*max_iterations))()
+    n = c_int()
+    _dll.openmc_search_keff(parameter, obj._index, lower, upper, target, tol,
+                            max_iterations, guesses, keffs, n)
+    return (list(guesses[:n.value]),
+            [(keffs[2*i], keffs[2*i + 1]) for i in range(n.value)])
+
+
 def simulation_init():
     """Initialize simulation"""
     _dll.openmc_simulation_init()
@@ -7,11 +7,13 @@ from numpy.ctypeslib import as_array
 
 from openmc.exceptions import AllocationError, InvalidIDError, OpenMCError
 from . import _dll, Nuclide
-from .core import _FortranObjectWithID
+from .nuclide import load_nuclide, nuclides as _nuclides
+from .core import _FortranObjectWithID, _array_1d_int, _array_1d_dble
 from .error import _error_handler
 
 
-__all__ = ['Material', 'materials']
+__all__ = ['Material', 'materials', 'set_material_densities',
+           'set_material_compositions']
 
 # Material functions
 _dll.openmc_extend_materials.argtypes = [c_int32, POINTER(c_int32), POINTER(c_int32)]
@@ -48,6 +50,14 @@ _dll.openmc_material_set_densities.argtypes = [
     c_int32, c_int, POINTER(c_char_p), POINTER(c_double)]
 _dll.openmc_material_set_densities.restype = c_int
 _dll.openmc_material_set_densities.errcheck = _error_handler
+_dll.openmc_materials_set_densities.argtypes = [
+    c_int, _array_1d_int, _array_1d_dble]
+_dll.openmc_materials_set_densities.restype = c_int
+_dll.openmc_materials_set_densities.errcheck = _error_handler
+_dll.openmc_materials_set_compositions.argtypes = [
+    c_int, _array_1d_int, _array_1d_int, _array_1d_int, _array_1d_dble]
+_dll.openmc_materials_set_compositions.restype = c_int
+_dll.openmc_materials_set_compositions.errcheck = _error_handler
 _dll.openmc_material_set_id.argtypes = [c_int32, c_int32]
 _dll.openmc_material_set_id.restype = c_int
 _dll.openmc_material_set_id.errcheck = _error_handler
@@ -273,6 +283,77 @@ class Material(_FortranObjectWithID):
         _dll.openmc_material_set_densities(self._index, len(nuclides), nucs, dp)
 
 
+def set_material_densities(materials, densities):
+    """Set the nuclide densities of many materials in one call
+
+    The nuclides of each material are kept. Only the densities that changed
+    are sent to device, if the materials have been moved there.
+
+    Parameters
+    ----------
+    materials : iterable of openmc.lib.Material
+        Materials to update
+    densities : iterable of iterable of float
+        Densities in atom/b-cm of the nuclides of each material, in the order
+        of :attr:`Material.nuclides`
+
+    """
+    index = np.array([m._index for m in materials], dtype=np.int32)
+    d = [np.asarray(x, dtype=np.double).ravel() for x in densities]
+    if len(d) != len(index):
+        raise ValueError('Densities must be given for each material.')
+    for m, x in zip(materials, d):
+        if x.size != len(m.nuclides):
+            raise ValueError('One density must be given per nuclide of '
+                             'material {}.'.format(m.id))
+    d = np.concatenate(d) if d else np.empty(0)
+    _dll.openmc_materials_set_densities(len(index), index, d)
+
+
+def set_material_compositions(materials, nuclides, densities):
+    """Set the nuclides and densities of many materials in one call
+
+    Nuclides that are not loaded yet are loaded first. The nuclides of a
+    material can only change between simulations; during one, only the
+    densities of its current nuclides can be given.
+
+    Parameters
+    ----------
+    materials : iterable of openmc.lib.Material
+        Materials to update
+    nuclides : iterable of iterable of str
+        Names of the nuclides of each material
+    densities : iterable of iterable of float
+        Densities in atom/b-cm of the nuclides of each material, which must
+        all be positive
+
+    """
+    index = np.array([m._index for m in materials], dtype=np.int32)
+    nuclides = [list(x) for x in nuclides]
+    d = [np.asarray(x, dtype=np.double).ravel() for x in densities]
+    if len(nuclides) != len(index) or len(d) != len(index):
+        raise ValueError('Nuclides and densities must be given for each '
+                         'material.')
+
+    # Look up each distinct nuclide once
+    nuclide_index = {}
+    for names, x in zip(nuclides, d):
+        if len(names) != x.size:
+            raise ValueError('One density must be given per nuclide.')
+        for name in names:
+            if name not in nuclide_index:
+                if name not in _nuclides:
+                    load_nuclide(name)
+                nuclide_index[name] = _nuclides[name]._index
+
+    offset = np.zeros(len(index) + 1, dtype=np.int32)
+    offset[1:] = np.cumsum([len(names) for names in nuclides])
+    nuc = np.array([nuclide_index[name] for names in nuclides
+                    for name in names], dtype=np.int32)
+    d = np.concatenate(d) if d else np.empty(0)
+    _dll.openmc_materials_set_compositions(len(index), index, offset, nuc, d)
+
+
 class _MaterialMapping(Mapping):
     def __getitem__(self, key):
         index = c_int32()
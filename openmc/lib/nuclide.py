@@ -11,9 +11,10 @@ from .core import _FortranObject
 from .error import _error_handler
 
 
-__all__ = ['Nuclide', 'nuclides', 'load_nuclide']
+__all__ = ['Nuclide', 'nuclides', 'load_nuclide', 'collapse_rates']
 
 _array_1d_dble = ndpointer(dtype=np.double, ndim=1, flags='CONTIGUOUS')
+_array_1d_int = ndpointer(dtype=np.intc, ndim=1, flags='CONTIGUOUS')
 
 # Nuclide functions
 _dll.openmc_get_nuclide_index.argtypes = [c_char_p, POINTER(c_int)]
@@ -29,6 +30,11 @@ _dll.openmc_nuclide_collapse_rate.argtypes = [c_int, c_int, c_double,
     _array_1d_dble, _array_1d_dble, c_int, POINTER(c_double)]
 _dll.openmc_nuclide_collapse_rate.restype = c_int
 _dll.openmc_nuclide_collapse_rate.errcheck = _error_handler
+_dll.openmc_nuclides_collapse_rates.argtypes = [c_int, _array_1d_int,
+    _array_1d_int, _array_1d_dble, _array_1d_dble, _array_1d_dble, c_int,
+    _array_1d_dble]
+_dll.openmc_nuclides_collapse_rates.restype = c_int
+_dll.openmc_nuclides_collapse_rates.errcheck = _error_handler
 _dll.nuclides_size.restype = c_size_t
 
 
@@ -44,6 +50,43 @@ def load_nuclide(name):
     _dll.openmc_load_nuclide(name.encode(), None, 0)
 
 
+def collapse_rates(nuclides, MTs, temperatures, energy, flux):
+    """Calculate the reaction rates of many reactions with one group-wise flux
+    distribution, in parallel
+
+    Parameters
+    ----------
+    nuclides : iterable of openmc.lib.Nuclide
+        Nuclide of each reaction
+    MTs : int or iterable of int
+        ENDF MT value of each reaction
+    temperatures : float or iterable of float
+        Temperature in [K] at which to evaluate the cross section of each
+        reaction
+    energy : iterable of float
+        Energy group boundaries in [eV]
+    flux : iterable of float
+        Flux in each energy group (not normalized per eV)
+
+    Returns
+    -------
+    numpy.ndarray
+        Reaction rate of each reaction
+
+    """
+    indices = np.array([nuc._index for nuc in nuclides], dtype=np.intc)
+    n = len(indices)
+    MTs = np.ascontiguousarray(np.broadcast_to(MTs, n), dtype=np.intc)
+    temperatures = np.ascontiguousarray(
+        np.broadcast_to(temperatures, n), dtype=float)
+    energy = np.asarray(energy, dtype=float)
+    flux = np.asarray(flux, dtype=float)
+    xs = np.zeros(n)
+    _dll.openmc_nuclides_collapse_rates(n, indices, MTs, temperatures, energy,
+                                        flux, len(flux), xs)
+    return xs
+
+
 class Nuclide(_FortranObject):
     """Nuclide stored internally.
 
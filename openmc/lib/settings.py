@@ -18,6 +18,9 @@ _dll.openmc_get_n_batches.errcheck = _error_handler
 _dll.openmc_set_n_batches.argtypes = [c_int32, c_bool, c_bool]
 _dll.openmc_set_n_batches.restype = c_int
 _dll.openmc_set_n_batches.errcheck = _error_handler
+_dll.openmc_set_source_reuse.argtypes = [c_bool, c_int32]
+_dll.openmc_set_source_reuse.restype = c_int
+_dll.openmc_set_source_reuse.errcheck = _error_handler
 
 
 class _Settings:
@@ -103,5 +106,25 @@ class _Settings:
 
         return n_batches.value
 
+    def set_source_reuse(self, reuse=True, n_inactive=None):
+        """Start following simulations from the source left in memory by the
+        last one
+
+        Parameters
+        ----------
+        reuse : bool
+            Whether to start from the source left by the last simulation
+            instead of sampling the external source. The source is only reused
+            when each process holds as many particles as before.
+        n_inactive : int or None
+            Number of inactive batches of a simulation started from a reused
+            source. If None, the number of inactive batches is kept. The number
+            of active batches is unchanged.
+
+        """
+        if n_inactive is None:
+            n_inactive = -1
+        _dll.openmc_set_source_reuse(reuse, n_inactive)
+
 
 settings = _Settings()
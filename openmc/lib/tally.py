@@ -1,5 +1,6 @@
 from collections.abc import Mapping
-from ctypes import c_int, c_int32, c_size_t, c_double, c_char_p, c_bool, POINTER
+from ctypes import (c_int, c_int32, c_size_t, c_double, c_char_p, c_bool,
+                    c_void_p, POINTER, cast)
 from weakref import WeakValueDictionary
 
 import numpy as np
@@ -9,12 +10,14 @@ import scipy.stats
 from openmc.exceptions import AllocationError, InvalidIDError
 from openmc.data.reaction import REACTION_NAME
 from . import _dll, Nuclide
+from .nuclide import nuclides as _nuclides
 from .core import _FortranObjectWithID
 from .error import _error_handler
 from .filter import _get_filter
 
 
-__all__ = ['Tally', 'tallies', 'global_tallies', 'num_realizations']
+__all__ = ['Tally', 'DeviceResults', 'tallies', 'global_tallies',
+           'num_realizations']
 
 # Tally functions
 _dll.openmc_extend_tallies.argtypes = [c_int32, POINTER(c_int32), POINTER(c_int32)]
@@ -26,6 +29,14 @@ _dll.openmc_get_tally_index.errcheck = _error_handler
 _dll.openmc_global_tallies.argtypes = [POINTER(POINTER(c_double))]
 _dll.openmc_global_tallies.restype = c_int
 _dll.openmc_global_tallies.errcheck = _error_handler
+_dll.openmc_tally_collapse_rates.argtypes = [
+    c_int32, c_int, POINTER(c_int), c_int, POINTER(c_int), POINTER(c_double)]
+_dll.openmc_tally_collapse_rates.restype = c_int
+_dll.openmc_tally_collapse_rates.errcheck = _error_handler
+_dll.openmc_tally_device_results.argtypes = [
+    c_int32, POINTER(POINTER(c_double)), POINTER(c_size_t*3)]
+_dll.openmc_tally_device_results.restype = c_int
+_dll.openmc_tally_device_results.errcheck = _error_handler
 _dll.openmc_tally_get_active.argtypes = [c_int32, POINTER(c_bool)]
 _dll.openmc_tally_get_active.restype = c_int
 _dll.openmc_tally_get_active.errcheck = _error_handler
@@ -87,6 +98,9 @@ _dll.openmc_tally_set_type.errcheck = _error_handler
 _dll.openmc_tally_set_writable.argtypes = [c_int32, c_bool]
 _dll.openmc_tally_set_writable.restype = c_int
 _dll.openmc_tally_set_writable.errcheck = _error_handler
+_dll.openmc_tally_sync_results.argtypes = [c_int32]
+_dll.openmc_tally_sync_results.restype = c_int
+_dll.openmc_tally_sync_results.errcheck = _error_handler
 _dll.tallies_size.restype = c_size_t
 
 
@@ -176,7 +190,11 @@ class Tally(_FortranObjectWithID):
     num_realizations : int
         Number of realizations
     results : numpy.ndarray
-        Array of tally results
+        Array of tally results, a view of the host results brought up to date
+        from device when read
+    device_results : DeviceResults
+        Results of a tally accumulated on device, exported without a copy to
+        host through the CUDA array interface
     std_dev : numpy.ndarray
         An array containing the sample standard deviation for each bin
     type : str
@@ -303,6 +321,13 @@ class Tally(_FortranObjectWithID):
         _dll.openmc_tally_results(self._index, data, shape)
         return as_array(data, tuple(shape))
 
+    @property
+    def device_results(self):
+        data = POINTER(c_double)()
+        shape = (c_size_t*3)()
+        _dll.openmc_tally_device_results(self._index, data, shape)
+        return DeviceResults(data, tuple(shape), self)
+
     @property
     def scores(self):
         scores_as_int = POINTER(c_int)()
@@ -364,6 +389,15 @@ class Tally(_FortranObjectWithID):
         """Reset results and num_realizations of tally"""
         _dll.openmc_tally_reset(self._index)
 
+    def sync(self):
+        """Bring the host results up to date with those on device
+
+        Reading :attr:`results` does this too. Only the results accumulated
+        on device since they were last read are copied.
+
+        """
+        _dll.openmc_tally_sync_results(self._index)
+
     def ci_width(self, alpha=0.05):
         """Confidence interval half-width based on a Student t distribution
 
@@ -384,6 +418,73 @@ class Tally(_FortranObjectWithID):
             half_width *= scipy.stats.t.ppf(1 - alpha/2, n - 1)
         return half_width
 
+    def collapse_rates(self, nuclides, MTs):
+        """Collapse the group flux of each material with pointwise data
+
+        The tally must score the total flux with a
+        :class:`openmc.lib.MaterialFilter` followed by an
+        :class:`openmc.lib.EnergyFilter`. The mean flux in each material is
+        collapsed with the cross section of each reaction of each nuclide at
+        the temperature of the material, in parallel over materials and
+        nuclides.
+
+        Parameters
+        ----------
+        nuclides : iterable of str
+            Names of loaded nuclides
+        MTs : iterable of int
+            ENDF MT values of the reactions
+
+        Returns
+        -------
+        numpy.ndarray
+            Reaction rates of shape ``(n_materials, n_nuclides, n_reactions)``
+            in the order of the materials of the filter, each multiplied by
+            the atom density in [atom/b-cm] of the nuclide in the material and
+            zero where the material does not contain the nuclide
+
+        """
+        nucs = [_nuclides[name]._index for name in nuclides]
+        MTs = list(MTs)
+        filters = self.filters
+        n_materials = len(filters[0].bins) if filters else 0
+        rates = np.zeros((n_materials, len(nucs), len(MTs)))
+        _dll.openmc_tally_collapse_rates(
+            self._index, len(nucs), (c_int*len(nucs))(*nucs), len(MTs),
+            (c_int*len(MTs))(*MTs),
+            rates.ctypes.data_as(POINTER(c_double)))
+        return rates
+
+
+class DeviceResults:
+    """Results of a tally held on device
+
+    The results are exported without a copy through the CUDA array interface,
+    e.g. with ``cupy.asarray(tally.device_results)``, and have the shape of
+    :attr:`Tally.results`. They can be read between batches and stay valid
+    until the simulation is finalized.
+
+    Parameters
+    ----------
+    ptr : ctypes.POINTER(ctypes.c_double)
+        Device address of the results
+    shape : tuple of int
+        Shape of the results
+    tally : Tally
+        Tally holding the results
+
+    """
+    def __init__(self, ptr, shape, tally):
+        self._ptr = ptr
+        self.shape = shape
+        self.tally = tally
+
+    @property
+    def __cuda_array_interface__(self):
+        address = cast(self._ptr, c_void_p).value or 0
+        return {'shape': self.shape, 'typestr': '<f8',
+                'data': (address, True), 'strides': None, 'version': 3}
+
 
 class _TallyMapping(Mapping):
     def __getitem__(self, key):
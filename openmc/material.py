@@ -7,11 +7,13 @@ import re
 import warnings
 from xml.etree import ElementTree as ET
 
+import h5py
 import numpy as np
 
 import openmc
 import openmc.data
 import openmc.checkvalue as cv
+from ._hdf5 import MODEL_INPUT_VERSION, write_ragged, write_strings
 from ._xml import clean_indentation, reorder_attributes
 from .mixin import IDManagerMixin
 
@@ -1260,6 +1262,93 @@ class Materials(cv.CheckedList):
             # Write the closing tag for the root element.
             fh.write('</materials>\n')
 
+    def export_to_hdf5(self, path='materials.h5'):
+        """Export material collection to an HDF5 file.
+
+        The materials are written as columns that OpenMC reads in place of
+        materials.xml when that file is absent, which is much faster for
+        models with very many materials.
+
+        .. versionadded:: 0.13
+
+        Parameters
+        ----------
+        path : str
+            Path to file to write. Defaults to 'materials.h5'.
+
+        """
+        p = Path(path)
+        if p.is_dir():
+            p /= 'materials.h5'
+
+        materials = sorted(self, key=lambda x: x.id)
+        for material in materials:
+            if material._density is None and material._density_units != 'sum':
+                raise ValueError('Density has not been set for material {}!'
+                                 .format(material.id))
+
+        # Nuclides and thermal scattering tables are referred to by index
+        nuclide_index = {}
+        sab_index = {}
+
+        def index(table, name):
+            return table.setdefault(name, len(table))
+
+        nuclides = []
+        fractions = []
+        isotropic = []
+        sab = []
+        sab_fractions = []
+        for material in materials:
+            if material._macroscopic is None:
+                nuclides.append([index(nuclide_index, nuc.name)
+                                 for nuc in material._nuclides])
+                fractions.extend(nuc.percent if nuc.percent_type == 'ao'
+                                 else -nuc.percent
+                                 for nuc in material._nuclides)
+            else:
+                nuclides.append([index(nuclide_index, material._macroscopic)])
+                fractions.append(1.0)
+            isotropic.append([index(nuclide_index, name)
+                              for name in material._isotropic])
+            sab.append([index(sab_index, name) for name, _ in material._sab])
+            sab_fractions.extend(fraction for _, fraction in material._sab)
+
+        with h5py.File(str(p), 'w') as f:
+            f.attrs['filetype'] = np.string_('materials')
+            f.attrs['version'] = MODEL_INPUT_VERSION
+            if self._cross_sections is not None:
+                f.attrs['cross_sections'] = np.string_(
+                    str(self._cross_sections))
+
+            write_strings(f, 'nuclides', nuclide_index)
+            write_strings(f, 'sab_names', sab_index)
+
+            f.create_dataset('id', data=np.array(
+                [m.id for m in materials], dtype=np.int32))
+            write_strings(f, 'name', (m.name for m in materials))
+            f.create_dataset('depletable', data=np.array(
+                [m.depletable for m in materials], dtype=np.int8))
+            write_strings(
+                f, 'density_units', (m.density_units for m in materials))
+            f.create_dataset('density', data=np.array(
+                [m.density if m.density is not None else 0.0
+                 for m in materials], dtype=float))
+            f.create_dataset('temperature', data=np.array(
+                [m.temperature if m.temperature is not None else -1.0
+                 for m in materials], dtype=float))
+            f.create_dataset('volume', data=np.array(
+                [m.volume if m.volume else -1.0 for m in materials],
+                dtype=float))
+
+            write_ragged(f, 'nuclide', nuclides, np.int32)
+            f.create_dataset('nuclide_fraction',
+                             data=np.array(fractions, dtype=float))
+            write_ragged(f, 'isotropic', isotropic, np.int32)
+            write_ragged(f, 'sab', sab, np.int32)
+            f.create_dataset('sab_fraction',
+                             data=np.array(sab_fractions, dtype=float))
+
     @classmethod
     def from_xml(cls, path='materials.xml'):
         """Generate materials collection from XML file
@@ -165,7 +165,7 @@ class Model:
                                        'si_celi', 'si_leqi', 'celi', 'leqi'))
         getattr(dep.integrator, method)(op, timesteps, **kwargs)
 
-    def export_to_xml(self, directory='.'):
+    def export_to_xml(self, directory='.', binary=False):
         """Export model to XML files.
 
         Parameters
@@ -173,6 +173,13 @@ class Model:
         directory : str
             Directory to write XML files to. If it doesn't exist already, it
             will be created.
+        binary : bool
+            Whether to write the materials and geometry to materials.h5 and
+            geometry.h5 instead of XML files, which OpenMC reads much faster
+            for very large models. Any materials.xml and geometry.xml in the
+            directory are removed, since OpenMC would read them instead.
+
+            .. versionadded:: 0.13
 
         """
         # Create directory if required
@@ -182,16 +189,26 @@ class Model:
 
         self.settings.export_to_xml(d)
         if not self.settings.dagmc:
-            self.geometry.export_to_xml(d)
+            if binary:
+                self.geometry.export_to_hdf5(d)
+                if (d / 'geometry.xml').exists():
+                    (d / 'geometry.xml').unlink()
+            else:
+                self.geometry.export_to_xml(d)
 
         # If a materials collection was specified, export it. Otherwise, look
         # for all materials in the geometry and use that to automatically build
         # a collection.
         if self.materials:
-            self.materials.export_to_xml(d)
+            materials = self.materials
         else:
             materials = openmc.Materials(self.geometry.get_all_materials()
                                          .values())
+        if binary:
+            materials.export_to_hdf5(d)
+            if (d / 'materials.xml').exists():
+                (d / 'materials.xml').unlink()
+        else:
             materials.export_to_xml(d)
 
         if self.tallies:
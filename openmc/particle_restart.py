@@ -38,6 +38,11 @@ class Particle:
         Position of the particle
     uvw : list of float
         Directional cosines of the particle
+    lost : dict or None
+        State of the particle where it was lost, with keys 'weight', 'energy',
+        'xyz', 'uvw', 'cells' (IDs from the top coordinate level down),
+        'material' and 'surface' (IDs) and 'seeds' (random number seeds), or
+        None for files that do not record it
 
     """
 
@@ -58,3 +63,9 @@ class Particle:
             self.uvw = f['uvw'][()]
             self.weight = f['weight'][()]
             self.xyz = f['xyz'][()]
+
+            if 'lost' in f:
+                group = f['lost']
+                self.lost = {key: group[key][()] for key in group}
+            else:
+                self.lost = None
@@ -7,6 +7,7 @@ from math import ceil
 
 import openmc.checkvalue as cv
 from . import VolumeCalculation, Source, RegularMesh
+from .weight_windows import WeightWindows, WeightWindowGenerator
 from ._xml import clean_indentation, get_text, reorder_attributes
 
 
@@ -36,14 +37,17 @@ class Settings:
     create_fission_neutrons : bool
         Indicate whether fission neutrons should be created or not.
     cutoff : dict
-        Dictionary defining weight cutoff and energy cutoff. The dictionary may
-        have six keys, 'weight', 'weight_avg', 'energy_neutron', 'energy_photon',
-        'energy_electron', and 'energy_positron'. Value for 'weight'
+        Dictionary defining weight cutoff, energy cutoff and time cutoff. The
+        dictionary may have ten keys, 'weight', 'weight_avg', 'energy_neutron',
+        'energy_photon', 'energy_electron', 'energy_positron', 'time_neutron',
+        'time_photon', 'time_electron', and 'time_positron'. Value for 'weight'
         should be a float indicating weight cutoff below which particle undergo
         Russian roulette. Value for 'weight_avg' should be a float indicating
         weight assigned to particles that are not killed after Russian
         roulette. Value of energy should be a float indicating energy in eV
-        below which particle type will be killed.
+        below which particle type will be killed. Value of time should be a
+        float indicating time in seconds after which particle type will be
+        killed.
     dagmc : bool
         Indicate that a CAD-based DAGMC geometry will be used.
     delayed_photon_scaling : bool
@@ -52,6 +56,15 @@ class Settings:
         release of delayed photons.
 
         .. versionadded:: 0.12
+    delta_tracking_cells : Iterable of int
+        IDs of cells inside which neutrons are delta-tracked: collisions are
+        sampled with a majorant cross section, without crossing the surfaces
+        of the cells filling them. Only collision and analog tally estimators
+        are used when this is set.
+    domain_mesh : openmc.RegularMesh
+        Mesh whose bins are divided into the spatial domains of the MPI
+        processes. Particles crossing into the domain of another process are
+        handed over to it in event-based fixed source runs.
     electron_treatment : {'led', 'ttb'}
         Whether to deposit all energy from electrons locally ('led') or create
         secondary bremsstrahlung photons ('ttb').
@@ -91,9 +104,10 @@ class Settings:
         are necessary when a particular instance of a cell needs to be tallied.
 
         .. versionadded:: 0.12
-    max_particles_in_flight : int
+    max_particles_in_flight : int or str
         Number of neutrons to run concurrently when using event-based
-        parallelism.
+        parallelism. If 'auto', the largest number that fits in free device
+        memory is used.
 
         .. versionadded:: 0.12
     max_order : None or int
@@ -114,6 +128,12 @@ class Settings:
         Whether to use photon transport.
     ptables : bool
         Determine whether probability tables are used.
+    random_ray : dict
+        Settings for solving a multigroup eigenvalue problem with the random
+        ray method in place of Monte Carlo transport. Accepted keys are
+        'distance_active' (float), the distance in [cm] over which each ray
+        scores, and 'distance_inactive' (float), the distance of the dead zone
+        each ray is first traced over to converge its angular flux.
     resonance_scattering : dict
         Settings for resonance elastic scattering. Accepted keys are 'enable'
         (bool), 'method' (str), 'energy_min' (float), 'energy_max' (float), and
@@ -166,7 +186,7 @@ class Settings:
     temperature : dict
         Defines a default temperature and method for treating intermediate
         temperatures at which nuclear data doesn't exist. Accepted keys are
-        'default', 'method', 'range', 'tolerance', and 'multipole'. The value
+        'default', 'method', 'range', 'tolerance', 'multipole', and 'tms'. The value
         for 'default' should be a float representing the default temperature in
         Kelvin. The value for 'method' should be 'nearest' or 'interpolation'.
         If the method is 'nearest', 'tolerance' indicates a range of temperature
@@ -175,7 +195,9 @@ class Settings:
         that cross sections be loaded at all temperatures within the
         range. 'multipole' is a boolean indicating whether or not the windowed
         multipole method should be used to evaluate resolved resonance cross
-        sections.
+        sections. 'tms' is a boolean indicating whether cross sections should
+        only be loaded at the lowest temperature and Doppler broadened to the
+        others by target motion sampling.
     trace : tuple or list
         Show detailed information about a single particle, indicated by three
         integers: the batch number, generation number, and particle number
@@ -199,6 +221,12 @@ class Settings:
         described in :ref:`verbosity`.
     volume_calculations : VolumeCalculation or iterable of VolumeCalculation
         Stochastic volume calculation specifications
+    weight_windows : openmc.WeightWindows or iterable of openmc.WeightWindows
+        Weight windows applied by splitting and Russian roulette, at most one
+        set per particle type
+    weight_window_generators : openmc.WeightWindowGenerator or iterable of openmc.WeightWindowGenerator
+        Updates of weight windows during the active batches from the flux of a
+        tally
 
     """
 
@@ -229,6 +257,9 @@ class Settings:
         # Shannon entropy mesh
         self._entropy_mesh = None
 
+        # Mesh divided into the domains of the processes
+        self._domain_mesh = None
+
         # Trigger subelement
         self._trigger_active = None
         self._trigger_max_batches = None
@@ -261,11 +292,16 @@ class Settings:
         self._ufs_mesh = None
 
         self._resonance_scattering = {}
+        self._random_ray = {}
         self._volume_calculations = cv.CheckedList(
             VolumeCalculation, 'volume calculations')
+        self._weight_windows = cv.CheckedList(WeightWindows, 'weight windows')
+        self._weight_window_generators = cv.CheckedList(
+            WeightWindowGenerator, 'weight window generators')
 
         self._create_fission_neutrons = None
         self._delayed_photon_scaling = None
+        self._delta_tracking_cells = None
         self._material_cell_offsets = None
         self._log_grid_bins = None
 
@@ -346,6 +382,10 @@ class Settings:
     def entropy_mesh(self):
         return self._entropy_mesh
 
+    @property
+    def domain_mesh(self):
+        return self._domain_mesh
+
     @property
     def trigger_active(self):
         return self._trigger_active
@@ -414,10 +454,22 @@ class Settings:
     def resonance_scattering(self):
         return self._resonance_scattering
 
+    @property
+    def random_ray(self):
+        return self._random_ray
+
     @property
     def volume_calculations(self):
         return self._volume_calculations
 
+    @property
+    def weight_windows(self):
+        return self._weight_windows
+
+    @property
+    def weight_window_generators(self):
+        return self._weight_window_generators
+
     @property
     def create_fission_neutrons(self):
         return self._create_fission_neutrons
@@ -426,6 +478,10 @@ class Settings:
     def delayed_photon_scaling(self):
         return self._delayed_photon_scaling
 
+    @property
+    def delta_tracking_cells(self):
+        return self._delta_tracking_cells
+
     @property
     def material_cell_offsets(self):
         return self._material_cell_offsets
@@ -672,6 +728,10 @@ class Settings:
                          'energy_positron']:
                 cv.check_type('energy cutoff', cutoff[key], Real)
                 cv.check_greater_than('energy cutoff', cutoff[key], 0.0)
+            elif key in ['time_neutron', 'time_photon', 'time_electron',
+                         'time_positron']:
+                cv.check_type('time cutoff', cutoff[key], Real)
+                cv.check_greater_than('time cutoff', cutoff[key], 0.0)
             else:
                 msg = 'Unable to set cutoff to "{0}" which is unsupported by '\
                       'OpenMC'.format(key)
@@ -683,6 +743,11 @@ class Settings:
         cv.check_type('entropy mesh', entropy, RegularMesh)
         self._entropy_mesh = entropy
 
+    @domain_mesh.setter
+    def domain_mesh(self, domain_mesh):
+        cv.check_type('domain mesh', domain_mesh, RegularMesh)
+        self._domain_mesh = domain_mesh
+
     @trigger_active.setter
     def trigger_active(self, trigger_active):
         cv.check_type('trigger active', trigger_active, bool)
@@ -725,7 +790,7 @@ class Settings:
         for key, value in temperature.items():
             cv.check_value('temperature key', key,
                            ['default', 'method', 'tolerance', 'multipole',
-                            'range'])
+                            'range', 'tms'])
             if key == 'default':
                 cv.check_type('default temperature', value, Real)
             elif key == 'method':
@@ -735,6 +800,8 @@ class Settings:
                 cv.check_type('temperature tolerance', value, Real)
             elif key == 'multipole':
                 cv.check_type('temperature multipole', value, bool)
+            elif key == 'tms':
+                cv.check_type('temperature tms', value, bool)
             elif key == 'range':
                 cv.check_length('temperature range', value, 2)
                 for T in value:
@@ -796,6 +863,20 @@ class Settings:
                               Iterable, str)
         self._resonance_scattering = res
 
+    @random_ray.setter
+    def random_ray(self, random_ray):
+        cv.check_type('random ray settings', random_ray, Mapping)
+        for key, value in random_ray.items():
+            cv.check_value('random ray dictionary key', key,
+                           ('distance_active', 'distance_inactive'))
+            name = 'random ray {}'.format(key.replace('_', ' '))
+            cv.check_type(name, value, Real)
+            if key == 'distance_active':
+                cv.check_greater_than(name, value, 0)
+            else:
+                cv.check_greater_than(name, value, 0, equality=True)
+        self._random_ray = random_ray
+
     @volume_calculations.setter
     def volume_calculations(self, vol_calcs):
         if not isinstance(vol_calcs, MutableSequence):
@@ -803,6 +884,20 @@ class Settings:
         self._volume_calculations = cv.CheckedList(
             VolumeCalculation, 'stochastic volume calculations', vol_calcs)
 
+    @weight_windows.setter
+    def weight_windows(self, weight_windows):
+        if not isinstance(weight_windows, MutableSequence):
+            weight_windows = [weight_windows]
+        self._weight_windows = cv.CheckedList(
+            WeightWindows, 'weight windows', weight_windows)
+
+    @weight_window_generators.setter
+    def weight_window_generators(self, generators):
+        if not isinstance(generators, MutableSequence):
+            generators = [generators]
+        self._weight_window_generators = cv.CheckedList(
+            WeightWindowGenerator, 'weight window generators', generators)
+
     @create_fission_neutrons.setter
     def create_fission_neutrons(self, create_fission_neutrons):
         cv.check_type('Whether create fission neutrons',
@@ -814,6 +909,13 @@ class Settings:
         cv.check_type('delayed photon scaling', value, bool)
         self._delayed_photon_scaling = value
 
+    @delta_tracking_cells.setter
+    def delta_tracking_cells(self, cells):
+        cv.check_type('delta tracking cells', cells, Iterable, Integral)
+        for cell in cells:
+            cv.check_greater_than('delta tracking cell', cell, 0)
+        self._delta_tracking_cells = cells
+
     @event_based.setter
     def event_based(self, value):
         cv.check_type('event based', value, bool)
@@ -821,8 +923,9 @@ class Settings:
 
     @max_particles_in_flight.setter
     def max_particles_in_flight(self, value):
-        cv.check_type('max particles in flight', value, Integral)
-        cv.check_greater_than('max particles in flight', value, 0)
+        if value != 'auto':
+            cv.check_type('max particles in flight', value, Integral)
+            cv.check_greater_than('max particles in flight', value, 0)
         self._max_particles_in_flight = value
 
     @material_cell_offsets.setter
@@ -1015,6 +1118,16 @@ class Settings:
             subelement = ET.SubElement(root, "entropy_mesh")
             subelement.text = str(self.entropy_mesh.id)
 
+    def _create_domain_mesh_subelement(self, root):
+        if self.domain_mesh is not None:
+            # See if a <mesh> element already exists -- if not, add it
+            path = "./mesh[@id='{}']".format(self.domain_mesh.id)
+            if root.find(path) is None:
+                root.append(self.domain_mesh.to_xml_element())
+
+            subelement = ET.SubElement(root, "domain_mesh")
+            subelement.text = str(self.domain_mesh.id)
+
     def _create_trigger_subelement(self, root):
         if self._trigger_active is not None:
             trigger_element = ET.SubElement(root, "trigger")
@@ -1105,6 +1218,11 @@ class Settings:
             elem = ET.SubElement(root, "delayed_photon_scaling")
             elem.text = str(self._delayed_photon_scaling).lower()
 
+    def _create_delta_tracking_cells_subelement(self, root):
+        if self._delta_tracking_cells is not None:
+            elem = ET.SubElement(root, "delta_tracking_cells")
+            elem.text = ' '.join(map(str, self._delta_tracking_cells))
+
     def _create_event_based_subelement(self, root):
         if self._event_based is not None:
             elem = ET.SubElement(root, "event_based")
@@ -1284,7 +1402,9 @@ class Settings:
         if elem is not None:
             self.cutoff = {}
             for key in ('energy_neutron', 'energy_photon', 'energy_electron',
-                        'energy_positron', 'weight', 'weight_avg'):
+                        'energy_positron', 'weight', 'weight_avg',
+                        'time_neutron', 'time_photon', 'time_electron',
+                        'time_positron'):
                 value = get_text(elem, key)
                 if value is not None:
                     self.cutoff[key] = float(value)
@@ -1297,6 +1417,14 @@ class Settings:
             if elem is not None:
                 self.entropy_mesh = RegularMesh.from_xml_element(elem)
 
+    def _domain_mesh_from_xml_element(self, root):
+        text = get_text(root, 'domain_mesh')
+        if text is not None:
+            path = "./mesh[@id='{}']".format(int(text))
+            elem = root.find(path)
+            if elem is not None:
+                self.domain_mesh = RegularMesh.from_xml_element(elem)
+
     def _trigger_from_xml_element(self, root):
         elem = root.find('trigger')
         if elem is not None:
@@ -1343,6 +1471,9 @@ class Settings:
         text = get_text(root, 'temperature_multipole')
         if text is not None:
             self.temperature['multipole'] = text in ('true', '1')
+        text = get_text(root, 'temperature_tms')
+        if text is not None:
+            self.temperature['tms'] = text in ('true', '1')
 
     def _trace_from_xml_element(self, root):
         text = get_text(root, 'trace')
@@ -1362,6 +1493,26 @@ class Settings:
             if elem is not None:
                 self.ufs_mesh = RegularMesh.from_xml_element(elem)
 
+    def _create_random_ray_subelement(self, root):
+        if self.random_ray:
+            elem = ET.SubElement(root, 'random_ray')
+            for key in ('distance_active', 'distance_inactive'):
+                if key in self.random_ray:
+                    subelem = ET.SubElement(elem, key)
+                    subelem.text = str(self.random_ray[key])
+
+    def _create_weight_windows_subelements(self, root):
+        for ww in self.weight_windows:
+            # See if a <mesh> element already exists -- if not, add it
+            path = "./mesh[@id='{}']".format(ww.mesh.id)
+            if root.find(path) is None:
+                root.append(ww.mesh.to_xml_element())
+
+            root.append(ww.to_xml_element())
+
+        for generator in self.weight_window_generators:
+            root.append(generator.to_xml_element())
+
     def _resonance_scattering_from_xml_element(self, root):
         elem = root.find('resonance_scattering')
         if elem is not None:
@@ -1377,6 +1528,25 @@ class Settings:
                         value = value.split()
                     self.resonance_scattering[key] = value
 
+    def _random_ray_from_xml_element(self, root):
+        elem = root.find('random_ray')
+        if elem is not None:
+            for key in ('distance_active', 'distance_inactive'):
+                value = get_text(elem, key)
+                if value is not None:
+                    self.random_ray[key] = float(value)
+
+    def _weight_windows_from_xml_element(self, root):
+        weight_windows = {}
+        for elem in root.findall('weight_windows'):
+            ww = WeightWindows.from_xml_element(elem, root)
+            self.weight_windows.append(ww)
+            weight_windows[ww.id] = ww
+
+        for elem in root.findall('weight_window_generator'):
+            self.weight_window_generators.append(
+                WeightWindowGenerator.from_xml_element(elem, weight_windows))
+
     def _create_fission_neutrons_from_xml_element(self, root):
         text = get_text(root, 'create_fission_neutrons')
         if text is not None:
@@ -1387,6 +1557,11 @@ class Settings:
         if text is not None:
             self.delayed_photon_scaling = text in ('true', '1')
 
+    def _delta_tracking_cells_from_xml_element(self, root):
+        text = get_text(root, 'delta_tracking_cells')
+        if text is not None:
+            self.delta_tracking_cells = [int(x) for x in text.split()]
+
     def _event_based_from_xml_element(self, root):
         text = get_text(root, 'event_based')
         if text is not None:
@@ -1395,7 +1570,7 @@ class Settings:
     def _max_particles_in_flight_from_xml_element(self, root):
         text = get_text(root, 'max_particles_in_flight')
         if text is not None:
-            self.max_particles_in_flight = int(text)
+            self.max_particles_in_flight = text if text == 'auto' else int(text)
 
     def _material_cell_offsets_from_xml_element(self, root):
         text = get_text(root, 'material_cell_offsets')
@@ -1449,6 +1624,7 @@ class Settings:
         self._create_survival_biasing_subelement(root_element)
         self._create_cutoff_subelement(root_element)
         self._create_entropy_mesh_subelement(root_element)
+        self._create_domain_mesh_subelement(root_element)
         self._create_trigger_subelement(root_element)
         self._create_no_reduce_subelement(root_element)
         self._create_verbosity_subelement(root_element)
@@ -1458,9 +1634,12 @@ class Settings:
         self._create_track_subelement(root_element)
         self._create_ufs_mesh_subelement(root_element)
         self._create_resonance_scattering_subelement(root_element)
+        self._create_random_ray_subelement(root_element)
+        self._create_weight_windows_subelements(root_element)
         self._create_volume_calcs_subelement(root_element)
         self._create_create_fission_neutrons_subelement(root_element)
         self._create_delayed_photon_scaling_subelement(root_element)
+        self._create_delta_tracking_cells_subelement(root_element)
         self._create_event_based_subelement(root_element)
         self._create_max_particles_in_flight_subelement(root_element)
         self._create_material_cell_offsets_subelement(root_element)
@@ -1524,6 +1703,7 @@ class Settings:
         settings._survival_biasing_from_xml_element(root)
         settings._cutoff_from_xml_element(root)
         settings._entropy_mesh_from_xml_element(root)
+        settings._domain_mesh_from_xml_element(root)
         settings._trigger_from_xml_element(root)
         settings._no_reduce_from_xml_element(root)
         settings._verbosity_from_xml_element(root)
@@ -1533,8 +1713,11 @@ class Settings:
         settings._track_from_xml_element(root)
         settings._ufs_mesh_from_xml_element(root)
         settings._resonance_scattering_from_xml_element(root)
+        settings._random_ray_from_xml_element(root)
+        settings._weight_windows_from_xml_element(root)
         settings._create_fission_neutrons_from_xml_element(root)
         settings._delayed_photon_scaling_from_xml_element(root)
+        settings._delta_tracking_cells_from_xml_element(root)
         settings._event_based_from_xml_element(root)
         settings._max_particles_in_flight_from_xml_element(root)
         settings._material_cell_offsets_from_xml_element(root)
@@ -71,6 +71,11 @@ class StatePoint:
         Cross-product of absorption and tracklength estimates of k-effective
     k_generation : numpy.ndarray
         Estimate of k-effective for each batch/generation
+    kernel_profile : dict or None
+        Dictionary whose keys are the regions of event-based device work
+        (e.g. 'advance') and whose values are dictionaries of their launches,
+        items, kernels, device_seconds, bytes_to_device and bytes_from_device,
+        if the run was made with ``--kernel-profile``
     meshes : dict
         Dictionary whose keys are mesh IDs and whose values are MeshBase objects
     n_batches : int
@@ -289,6 +294,18 @@ class StatePoint:
         else:
             return None
 
+    @property
+    def kernel_profile(self):
+        if 'kernels' not in self._f['runtime']:
+            return None
+        group = self._f['runtime/kernels']
+        regions = [r.decode() for r in group['regions'][()]]
+        fields = ('launches', 'items', 'kernels', 'device_seconds',
+                  'bytes_to_device', 'bytes_from_device')
+        values = {f: group[f][()] for f in fields}
+        return {r: {f: values[f][i] for f in fields}
+                for i, r in enumerate(regions)}
+
     @property
     def meshes(self):
         if not self._meshes_read:
@@ -337,7 +354,8 @@ class StatePoint:
     @property
     def runtime(self):
         return {name: dataset[()]
-                for name, dataset in self._f['runtime'].items()}
+                for name, dataset in self._f['runtime'].items()
+                if isinstance(dataset, h5py.Dataset)}
 
     @property
     def seed(self):
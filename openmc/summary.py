@@ -1,4 +1,6 @@
 from collections.abc import Iterable
+import os
+from tempfile import TemporaryDirectory
 import warnings
 
 import h5py
@@ -18,10 +20,15 @@ class Summary:
     ----------
     date_and_time : str
         Date and time when simulation began
+    format : {'full', 'compact', 'hash'}
+        Layout of the summary file. Geometry and materials of the 'hash'
+        layout are rebuilt from the model input files it holds.
     geometry : openmc.Geometry
         The geometry reconstructed from the summary file
     materials : openmc.Materials
         The materials reconstructed from the summary file
+    model_hash : str or None
+        Hash of the model input files for the 'hash' layout
     nuclides : dict
         Dictionary whose keys are nuclide names and values are atomic weight
         ratios.
@@ -54,7 +61,10 @@ class Summary:
 
         self._read_nuclides()
         self._read_macroscopics()
-        self._read_geometry()
+        if self.format == 'hash':
+            self._read_model_input()
+        else:
+            self._read_geometry()
 
     @property
     def date_and_time(self):
@@ -80,6 +90,17 @@ class Summary:
     def version(self):
         return tuple(self._f.attrs['openmc_version'])
 
+    @property
+    def format(self):
+        if 'format' in self._f.attrs:
+            return self._f.attrs['format'].decode()
+        return 'full'
+
+    @property
+    def model_hash(self):
+        if 'model_hash' in self._f.attrs:
+            return self._f.attrs['model_hash'].decode()
+
     def _read_nuclides(self):
         if 'nuclides/names' in self._f:
             names = self._f['nuclides/names'][()]
@@ -99,17 +120,91 @@ class Summary:
             # also used to create the model), so silence ID warnings
             warnings.simplefilter("ignore", openmc.IDWarning)
 
+            compact = self.format == 'compact'
+
             # Read in and initialize the Materials
-            self._read_materials()
+            if compact:
+                self._read_materials_compact()
+            else:
+                self._read_materials()
 
             # Read native geometry only
             if "dagmc" not in self._f['geometry'].attrs.keys():
                 self._read_surfaces()
-                cell_fills = self._read_cells()
-                self._read_universes()
+                if compact:
+                    cell_fills = self._read_cells_compact()
+                    self._read_universes_compact()
+                else:
+                    cell_fills = self._read_cells()
+                    self._read_universes()
                 self._read_lattices()
                 self._finalize_geometry(cell_fills)
 
+    def _read_model_input(self):
+        with TemporaryDirectory() as tmpdir:
+            for name, dataset in self._f['model'].items():
+                with open(os.path.join(tmpdir, name), 'wb') as fh:
+                    fh.write(dataset[()].tobytes())
+
+            # Only XML input can be rebuilt in Python
+            path_materials = os.path.join(tmpdir, 'materials.xml')
+            path_geometry = os.path.join(tmpdir, 'geometry.xml')
+            if not (os.path.exists(path_materials) and
+                    os.path.exists(path_geometry)):
+                warnings.warn('The geometry and materials of the summary file '
+                              'cannot be rebuilt without geometry.xml and '
+                              'materials.xml.')
+                return
+
+            with warnings.catch_warnings():
+                warnings.simplefilter("ignore", openmc.IDWarning)
+                self._materials = openmc.Materials.from_xml(path_materials)
+                self._geometry = openmc.Geometry.from_xml(
+                    path_geometry, self._materials)
+        for material in self._materials:
+            self._fast_materials[material.id] = material
+        for cell in self._geometry.get_all_cells().values():
+            self._fast_cells[cell.id] = cell
+
+    @staticmethod
+    def _read_ragged(group, name):
+        values = group[name][()]
+        offsets = group[name + '_offsets'][()]
+        return [values[offsets[i]:offsets[i + 1]]
+                for i in range(len(offsets) - 1)]
+
+    def _read_materials_compact(self):
+        group = self._f['materials']
+        nuclide_names = [n.decode() for n in group['nuclide_names'][()]] \
+            if 'nuclide_names' in group else []
+        sab_names = [n.decode() for n in group['sab_names'][()]] \
+            if 'sab_names' in group else []
+        nuclides = self._read_ragged(group, 'nuclide')
+        densities = self._read_ragged(group, 'nuclide_density')
+        sabs = self._read_ragged(group, 'sab')
+
+        for i, mat_id in enumerate(group['id'][()]):
+            material = openmc.Material(int(mat_id), group['name'][i].decode())
+            material.depletable = bool(group['depletable'][i])
+            if group['volume'][i] > 0.0:
+                material.volume = group['volume'][i]
+            if group['temperature'][i] > 0.0:
+                material.temperature = group['temperature'][i]
+            for i_sab in sabs[i]:
+                material.add_s_alpha_beta(sab_names[i_sab])
+            material.set_density(density=group['atom_density'][i],
+                                 units='atom/b-cm')
+            for i_nuc, density in zip(nuclides[i], densities[i]):
+                name = nuclide_names[i_nuc]
+                if name in self._macroscopics:
+                    material.add_macroscopic(name)
+                else:
+                    material.add_nuclide(name, percent=density,
+                                         percent_type='ao')
+
+            self.materials.append(material)
+            self._fast_materials[material.id] = material
+
     def _read_materials(self):
         for group in self._f['materials'].values():
             material = openmc.Material.from_hdf5(group)
@@ -174,6 +269,54 @@ class Summary:
 
         return cell_fills
 
+    def _read_cells_compact(self):
+        group = self._f['geometry/cells']
+        names = group['name'][()]
+        fill_types = group['fill_type'][()]
+        fills = group['fill'][()]
+        regions = self._read_ragged(group, 'region')
+        materials = self._read_ragged(group, 'material')
+        temperatures = self._read_ragged(group, 'temperature')
+        translations = self._read_ragged(group, 'translation')
+        rotations = self._read_ragged(group, 'rotation')
+
+        cell_fills = {}
+        for i, cell_id in enumerate(group['id'][()]):
+            cell = openmc.Cell(cell_id=int(cell_id), name=names[i].decode())
+            fill_type = fill_types[i].decode()
+
+            if fill_type == 'material':
+                mats = materials[i]
+                fill_id = int(mats[0]) if mats.size == 1 else mats
+                cell.temperature = temperatures[i]
+            else:
+                fill_id = int(fills[i])
+                if fill_type == 'universe':
+                    if translations[i].size > 0:
+                        cell.translation = translations[i]
+                    if rotations[i].size > 0:
+                        rotation = rotations[i]
+                        if rotation.size == 9:
+                            rotation.shape = (3, 3)
+                        cell.rotation = rotation
+            cell_fills[cell.id] = (fill_type, fill_id)
+
+            region = regions[i].tobytes().decode()
+            if region:
+                cell.region = Region.from_expression(region, self._fast_surfaces)
+
+            self._fast_cells[cell.id] = cell
+
+        return cell_fills
+
+    def _read_universes_compact(self):
+        group = self._f['geometry/universes']
+        cells = self._read_ragged(group, 'cells')
+        for universe_id, cell_ids in zip(group['id'][()], cells):
+            universe = openmc.Universe(universe_id=int(universe_id))
+            universe.add_cells([self._fast_cells[c] for c in cell_ids])
+            self._fast_universes[universe.id] = universe
+
     def _read_universes(self):
         for group in self._f['geometry/universes'].values():
             universe = openmc.Universe.from_hdf5(group, self._fast_cells)
@@ -32,6 +32,11 @@ class VolumeCalculation:
         Upper-right coordinates of bounding box used to sample points. If this
         argument is not supplied, an attempt is made to automatically determine
         a bounding box.
+    estimator : {'point', 'ray'}
+        Volume estimator. The point estimator counts the samples within each
+        domain. The ray estimator scores the fraction of the chord through the
+        bounding box from each sample, along an isotropic direction, that lies
+        within each domain.
 
     Attributes
     ----------
@@ -45,6 +50,8 @@ class VolumeCalculation:
         Lower-left coordinates of bounding box used to sample points
     upper_right : Iterable of float
         Upper-right coordinates of bounding box used to sample points
+    estimator : {'point', 'ray'}
+        Volume estimator
     atoms : dict
         Dictionary mapping unique IDs of domains to a mapping of nuclides to
         total number of atoms for each nuclide present in the domain. For
@@ -68,7 +75,8 @@ class VolumeCalculation:
         .. versionadded:: 0.12
 
     """
-    def __init__(self, domains, samples, lower_left=None, upper_right=None):
+    def __init__(self, domains, samples, lower_left=None, upper_right=None,
+                 estimator='point'):
         self._atoms = {}
         self._volumes = {}
         self._threshold = None
@@ -86,6 +94,7 @@ class VolumeCalculation:
         self.ids = [d.id for d in domains]
 
         self.samples = samples
+        self.estimator = estimator
 
         if lower_left is not None:
             if upper_right is None:
@@ -137,6 +146,10 @@ class VolumeCalculation:
     def upper_right(self):
         return self._upper_right
 
+    @property
+    def estimator(self):
+        return self._estimator
+
     @property
     def threshold(self):
         return self._threshold
@@ -196,6 +209,11 @@ class VolumeCalculation:
         cv.check_length(name, upper_right, 3)
         self._upper_right = upper_right
 
+    @estimator.setter
+    def estimator(self, estimator):
+        cv.check_value('volume estimator', estimator, ('point', 'ray'))
+        self._estimator = estimator
+
     @threshold.setter
     def threshold(self, threshold):
         name = 'volume std. dev. threshold'
@@ -263,6 +281,7 @@ class VolumeCalculation:
             samples = f.attrs['samples']
             lower_left = f.attrs['lower_left']
             upper_right = f.attrs['upper_right']
+            estimator = f.attrs.get('estimator', b'point').decode()
 
             threshold = f.attrs.get('threshold')
             trigger_type = f.attrs.get('trigger_type')
@@ -297,7 +316,7 @@ class VolumeCalculation:
                 domains = [openmc.Universe(uid) for uid in ids]
 
         # Instantiate the class and assign results
-        vol = cls(domains, samples, lower_left, upper_right)
+        vol = cls(domains, samples, lower_left, upper_right, estimator)
 
         if trigger_type is not None:
             vol.set_trigger(threshold, trigger_type.decode())
@@ -347,6 +366,9 @@ class VolumeCalculation:
         ll_elem.text = ' '.join(str(x) for x in self.lower_left)
         ur_elem = ET.SubElement(element, "upper_right")
         ur_elem.text = ' '.join(str(x) for x in self.upper_right)
+        if self.estimator != 'point':
+            est_elem = ET.SubElement(element, "estimator")
+            est_elem.text = self.estimator
         if self.threshold:
             trigger_elem = ET.SubElement(element, "threshold")
             trigger_elem.set("type", self.trigger_type)
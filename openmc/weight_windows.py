@@ -0,0 +1,421 @@
+from numbers import Real, Integral
+from xml.etree import ElementTree as ET
+
+import numpy as np
+
+import openmc.checkvalue as cv
+from openmc.mesh import RegularMesh
+from openmc.mixin import IDManagerMixin
+from ._xml import get_text
+
+
+_PARTICLES = ('neutron', 'photon', 'electron', 'positron')
+
+
+class WeightWindows(IDManagerMixin):
+    """Bounds on the weight of one type of particle in each bin of a mesh and
+    of an energy grid.
+
+    After each collision and surface crossing, a particle above the upper
+    bound of its bin is split into particles of equal weight and a particle
+    below the lower bound plays Russian roulette.
+
+    Parameters
+    ----------
+    mesh : openmc.RegularMesh
+        Mesh of the windows
+    lower_ww_bounds : Iterable of float, optional
+        Lower bound of each bin, with mesh bins varying fastest. A negative
+        bound means the bin has no window. May be left out when a
+        :class:`openmc.WeightWindowGenerator` sets the bounds.
+    upper_ww_bounds : Iterable of float, optional
+        Upper bound of each bin, ordered like the lower bounds
+    upper_bound_ratio : float, optional
+        Ratio of the upper to the lower bounds, used when no upper bounds are
+        given
+    energy_bounds : Iterable of float, optional
+        Increasing boundaries of the energy groups of the windows in [eV]
+    particle_type : {'neutron', 'photon', 'electron', 'positron'}
+        Type of particle the windows apply to
+    survival_ratio : float, optional
+        Weight a particle surviving Russian roulette is given, as a multiple
+        of the lower bound
+    max_split : int, optional
+        Largest number of particles a particle is split into
+    weight_cutoff : float, optional
+        Weight below which particles entering a window are killed
+    id : int, optional
+        Unique identifier for the weight windows. If not specified, an
+        identifier will automatically be assigned.
+
+    Attributes
+    ----------
+    id : int
+        Unique identifier for the weight windows
+    mesh : openmc.RegularMesh
+        Mesh of the windows
+    lower_ww_bounds : numpy.ndarray or None
+        Lower bound of each bin
+    upper_ww_bounds : numpy.ndarray or None
+        Upper bound of each bin
+    upper_bound_ratio : float or None
+        Ratio of the upper to the lower bounds
+    energy_bounds : numpy.ndarray or None
+        Boundaries of the energy groups in [eV]
+    particle_type : str
+        Type of particle the windows apply to
+    survival_ratio : float or None
+        Survival weight over the lower bound
+    max_split : int or None
+        Largest number of particles a particle is split into
+    weight_cutoff : float or None
+        Weight below which particles are killed
+
+    """
+
+    next_id = 1
+    used_ids = set()
+
+    def __init__(self, mesh, lower_ww_bounds=None, upper_ww_bounds=None,
+                 upper_bound_ratio=None, energy_bounds=None,
+                 particle_type='neutron', survival_ratio=None,
+                 max_split=None, weight_cutoff=None, id=None):
+        self.id = id
+        self.mesh = mesh
+        self.lower_ww_bounds = lower_ww_bounds
+        self.upper_ww_bounds = upper_ww_bounds
+        self.upper_bound_ratio = upper_bound_ratio
+        self.energy_bounds = energy_bounds
+        self.particle_type = particle_type
+        self.survival_ratio = survival_ratio
+        self.max_split = max_split
+        self.weight_cutoff = weight_cutoff
+
+    def __repr__(self):
+        string = 'WeightWindows\n'
+        string += '{: <16}=\t{}\n'.format('\tID', self.id)
+        string += '{: <16}=\t{}\n'.format('\tMesh', self.mesh.id)
+        string += '{: <16}=\t{}\n'.format('\tParticle', self.particle_type)
+        string += '{: <16}=\t{}\n'.format('\tEnergy bounds', self.energy_bounds)
+        return string
+
+    @property
+    def mesh(self):
+        return self._mesh
+
+    @mesh.setter
+    def mesh(self, mesh):
+        cv.check_type('weight windows mesh', mesh, RegularMesh)
+        self._mesh = mesh
+
+    @property
+    def lower_ww_bounds(self):
+        return self._lower_ww_bounds
+
+    @lower_ww_bounds.setter
+    def lower_ww_bounds(self, bounds):
+        if bounds is not None:
+            cv.check_iterable_type('lower weight window bounds', bounds, Real)
+            bounds = np.asarray(bounds, dtype=float).flatten()
+        self._lower_ww_bounds = bounds
+
+    @property
+    def upper_ww_bounds(self):
+        return self._upper_ww_bounds
+
+    @upper_ww_bounds.setter
+    def upper_ww_bounds(self, bounds):
+        if bounds is not None:
+            cv.check_iterable_type('upper weight window bounds', bounds, Real)
+            bounds = np.asarray(bounds, dtype=float).flatten()
+        self._upper_ww_bounds = bounds
+
+    @property
+    def upper_bound_ratio(self):
+        return self._upper_bound_ratio
+
+    @upper_bound_ratio.setter
+    def upper_bound_ratio(self, ratio):
+        if ratio is not None:
+            cv.check_type('upper bound ratio', ratio, Real)
+            cv.check_greater_than('upper bound ratio', ratio, 1.0)
+        self._upper_bound_ratio = ratio
+
+    @property
+    def energy_bounds(self):
+        return self._energy_bounds
+
+    @energy_bounds.setter
+    def energy_bounds(self, bounds):
+        if bounds is not None:
+            cv.check_iterable_type('weight window energy bounds', bounds, Real)
+            cv.check_length('weight window energy bounds', bounds, 2)
+            bounds = np.asarray(bounds, dtype=float)
+            if np.any(np.diff(bounds) <= 0.0):
+                raise ValueError('Weight window energy bounds must be '
+                                 'increasing')
+        self._energy_bounds = bounds
+
+    @property
+    def particle_type(self):
+        return self._particle_type
+
+    @particle_type.setter
+    def particle_type(self, particle_type):
+        cv.check_value('weight windows particle', particle_type, _PARTICLES)
+        self._particle_type = particle_type
+
+    @property
+    def survival_ratio(self):
+        return self._survival_ratio
+
+    @survival_ratio.setter
+    def survival_ratio(self, ratio):
+        if ratio is not None:
+            cv.check_type('survival ratio', ratio, Real)
+            cv.check_greater_than('survival ratio', ratio, 1.0, equality=True)
+        self._survival_ratio = ratio
+
+    @property
+    def max_split(self):
+        return self._max_split
+
+    @max_split.setter
+    def max_split(self, max_split):
+        if max_split is not None:
+            cv.check_type('max split', max_split, Integral)
+            cv.check_greater_than('max split', max_split, 1, equality=True)
+        self._max_split = max_split
+
+    @property
+    def weight_cutoff(self):
+        return self._weight_cutoff
+
+    @weight_cutoff.setter
+    def weight_cutoff(self, cutoff):
+        if cutoff is not None:
+            cv.check_type('weight cutoff', cutoff, Real)
+            cv.check_greater_than('weight cutoff', cutoff, 0.0, equality=True)
+        self._weight_cutoff = cutoff
+
+    def to_xml_element(self):
+        """Return XML representation of the weight windows
+
+        Returns
+        -------
+        element : xml.etree.ElementTree.Element
+            XML element containing the weight windows
+
+        """
+        element = ET.Element('weight_windows')
+        element.set('id', str(self.id))
+
+        subelement = ET.SubElement(element, 'particle')
+        subelement.text = self.particle_type
+        subelement = ET.SubElement(element, 'mesh')
+        subelement.text = str(self.mesh.id)
+
+        for key in ('energy_bounds', 'lower_ww_bounds', 'upper_ww_bounds'):
+            value = getattr(self, key)
+            if value is not None:
+                subelement = ET.SubElement(element, key)
+                subelement.text = ' '.join(map(str, value))
+
+        for key in ('upper_bound_ratio', 'survival_ratio', 'max_split',
+                    'weight_cutoff'):
+            value = getattr(self, key)
+            if value is not None:
+                subelement = ET.SubElement(element, key)
+                subelement.text = str(value)
+
+        return element
+
+    @classmethod
+    def from_xml_element(cls, elem, root):
+        """Generate weight windows from an XML element
+
+        Parameters
+        ----------
+        elem : xml.etree.ElementTree.Element
+            XML element
+        root : xml.etree.ElementTree.Element
+            Root element of the settings file, which holds the mesh
+
+        Returns
+        -------
+        openmc.WeightWindows
+            Weight windows generated from the XML element
+
+        """
+        mesh_id = int(get_text(elem, 'mesh'))
+        mesh_elem = root.find("./mesh[@id='{}']".format(mesh_id))
+        if mesh_elem is None:
+            raise ValueError('Mesh {} of weight windows is not in the '
+                             'settings'.format(mesh_id))
+        mesh = RegularMesh.from_xml_element(mesh_elem)
+
+        kwargs = {'id': int(get_text(elem, 'id'))}
+        particle = get_text(elem, 'particle')
+        if particle is not None:
+            kwargs['particle_type'] = particle
+        for key in ('energy_bounds', 'lower_ww_bounds', 'upper_ww_bounds'):
+            text = get_text(elem, key)
+            if text is not None:
+                kwargs[key] = [float(x) for x in text.split()]
+        for key in ('upper_bound_ratio', 'survival_ratio', 'weight_cutoff'):
+            text = get_text(elem, key)
+            if text is not None:
+                kwargs[key] = float(text)
+        text = get_text(elem, 'max_split')
+        if text is not None:
+            kwargs['max_split'] = int(text)
+
+        return cls(mesh, **kwargs)
+
+
+class WeightWindowGenerator:
+    """Periodic update of a set of weight windows from the flux of a tally
+    with the MAGIC method.
+
+    The lower bound of each bin is half its flux over the largest flux of its
+    energy group. The tally must score flux and have only a mesh filter on the
+    mesh of the windows and, if the windows have energy groups, an energy
+    filter with the same boundaries.
+
+    Parameters
+    ----------
+    weight_windows : openmc.WeightWindows
+        Weight windows to generate
+    tally : openmc.Tally or int
+        Flux tally, or its unique ID
+    threshold : float, optional
+        Largest relative error of the flux in a bin for it to get a window
+    ratio : float, optional
+        Ratio of the upper to the lower bound of the generated windows
+    interval : int, optional
+        Number of active batches between updates of the windows
+
+    Attributes
+    ----------
+    weight_windows : openmc.WeightWindows
+        Weight windows to generate
+    tally_id : int
+        Unique ID of the flux tally
+    threshold : float or None
+        Largest relative error of a windowed bin
+    ratio : float or None
+        Upper over lower bound
+    interval : int or None
+        Active batches between updates
+
+    """
+
+    def __init__(self, weight_windows, tally, threshold=None, ratio=None,
+                 interval=None):
+        self.weight_windows = weight_windows
+        self.tally_id = tally if isinstance(tally, Integral) else tally.id
+        self.threshold = threshold
+        self.ratio = ratio
+        self.interval = interval
+
+    @property
+    def weight_windows(self):
+        return self._weight_windows
+
+    @weight_windows.setter
+    def weight_windows(self, weight_windows):
+        cv.check_type('generated weight windows', weight_windows,
+                      WeightWindows)
+        self._weight_windows = weight_windows
+
+    @property
+    def tally_id(self):
+        return self._tally_id
+
+    @tally_id.setter
+    def tally_id(self, tally_id):
+        cv.check_type('weight window generator tally', tally_id, Integral)
+        self._tally_id = tally_id
+
+    @property
+    def threshold(self):
+        return self._threshold
+
+    @threshold.setter
+    def threshold(self, threshold):
+        if threshold is not None:
+            cv.check_type('weight window threshold', threshold, Real)
+            cv.check_greater_than('weight window threshold', threshold, 0.0)
+        self._threshold = threshold
+
+    @property
+    def ratio(self):
+        return self._ratio
+
+    @ratio.setter
+    def ratio(self, ratio):
+        if ratio is not None:
+            cv.check_type('weight window ratio', ratio, Real)
+            cv.check_greater_than('weight window ratio', ratio, 1.0)
+        self._ratio = ratio
+
+    @property
+    def interval(self):
+        return self._interval
+
+    @interval.setter
+    def interval(self, interval):
+        if interval is not None:
+            cv.check_type('weight window interval', interval, Integral)
+            cv.check_greater_than('weight window interval', interval, 1,
+                                  equality=True)
+        self._interval = interval
+
+    def to_xml_element(self):
+        """Return XML representation of the weight window generator
+
+        Returns
+        -------
+        element : xml.etree.ElementTree.Element
+            XML element containing the generator
+
+        """
+        element = ET.Element('weight_window_generator')
+        subelement = ET.SubElement(element, 'weight_windows')
+        subelement.text = str(self.weight_windows.id)
+        subelement = ET.SubElement(element, 'tally')
+        subelement.text = str(self.tally_id)
+        for key in ('threshold', 'ratio', 'interval'):
+            value = getattr(self, key)
+            if value is not None:
+                subelement = ET.SubElement(element, key)
+                subelement.text = str(value)
+        return element
+
+    @classmethod
+    def from_xml_element(cls, elem, weight_windows):
+        """Generate a weight window generator from an XML element
+
+        Parameters
+        ----------
+        elem : xml.etree.ElementTree.Element
+            XML element
+        weight_windows : dict
+            Dictionary mapping IDs to :class:`openmc.WeightWindows`
+
+        Returns
+        -------
+        openmc.WeightWindowGenerator
+            Generator read from the XML element
+
+        """
+        ww = weight_windows[int(get_text(elem, 'weight_windows'))]
+        kwargs = {}
+        for key in ('threshold', 'ratio'):
+            text = get_text(elem, key)
+            if text is not None:
+                kwargs[key] = float(text)
+        text = get_text(elem, 'interval')
+        if text is not None:
+            kwargs['interval'] = int(text)
+        return cls(ww, int(get_text(elem, 'tally')), **kwargs)
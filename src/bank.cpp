@@ -1,9 +1,16 @@
 #include "openmc/bank.h"
 #include "openmc/capi.h"
+#include "openmc/device_sort.h"
 #include "openmc/error.h"
 #include "openmc/simulation.h"
 #include "openmc/message_passing.h"
+#include "openmc/settings.h"
+#include "openmc/timer.h"
 
+#include <fmt/core.h>
+
+#include <algorithm> // for copy
+#include <cmath>
 #include <cstdint>
 
 
@@ -15,16 +22,28 @@ namespace openmc {
 
 namespace simulation {
 
-std::vector<Particle::Bank> source_bank;
+BankVector source_bank;
 Particle::Bank* device_source_bank {nullptr};
+bool source_bank_stale {false};
 
 SharedArray<Particle::Bank> surf_source_bank;
 
 // The fission bank is allocated as a SharedArray, rather than a vector, as it will
-// be shared by all threads in the simulation. It will be allocated to a fixed
-// maximum capacity in the init_fission_bank() function. Then, Elements will be
-// added to it by using SharedArray's special thread_safe_append() function.
+// be shared by all threads in the simulation. It is allocated in the
+// init_fission_bank() function and grown between generations to hold the sites
+// expected in the next one. Then, Elements will be added to it by using
+// bank_fission_site(), which spills them to fission_spill once it is full.
 SharedArray<Particle::Bank> fission_bank;
+SharedArray<Particle::Bank> fission_spill;
+int64_t fission_sites_dropped {0};
+double fission_site_yield {1.0};
+
+// Secondary particles are spilled here by Particle::push_secondary() once a
+// particle's inline secondary bank is full. Spilled sites are not reclaimed
+// when they are popped; the pool is emptied at the start of each generation.
+SharedArray<Particle::Bank> secondary_pool;
+std::vector<int> secondary_pool_link;
+int* device_secondary_pool_link {nullptr};
 
 // Each entry in this vector corresponds to the number of progeny produced
 // this generation for the particle located at that index. This vector is
@@ -32,24 +51,188 @@ SharedArray<Particle::Bank> fission_bank;
 std::vector<int64_t> progeny_per_particle;
 int64_t* device_progeny_per_particle {nullptr};
 
+std::vector<Particle::Bank> fission_bank_scratch;
+std::vector<int64_t> fission_site_offsets;
+std::vector<int64_t> fission_scan_chunks;
+Particle::Bank* device_fission_bank_scratch {nullptr};
+int64_t* device_fission_site_offsets {nullptr};
+int64_t* device_fission_scan_chunks {nullptr};
+
 } // namespace simulation
 
 //==============================================================================
 // Non-member functions
 //==============================================================================
 
+namespace {
+
+// Size of the spill buffer as a fraction of the capacity of the fission bank
+constexpr double FISSION_SPILL_FRACTION {0.25};
+
+//! Capacity of the fission bank for a generation of a process
+//
+//! \param n_source Number of source particles of the process
+int64_t fission_bank_capacity(int64_t n_source)
+{
+  // The keff that the sites are banked with divides the expected yield. Some
+  // room is left on top of the margin for four standard deviations of the
+  // number of sites, which dominate when a process has few particles.
+  double n_expected = n_source * simulation::fission_site_yield /
+    simulation::keff;
+  return static_cast<int64_t>(std::ceil(n_expected *
+    (1.0 + settings::fission_bank_margin) + 4.0 * std::sqrt(n_expected)));
+}
+
+//! Grow the device scratch for sorting and resampling the fission bank,
+//! mapping it again if it is already mapped
+void resize_fission_bank_scratch(int64_t n)
+{
+  bool mapped = (simulation::device_fission_bank_scratch != nullptr);
+  if (mapped) {
+    #pragma omp target exit data map(release: simulation::device_fission_bank_scratch[:simulation::fission_bank_scratch.size()], \
+      simulation::device_fission_site_offsets[:simulation::fission_site_offsets.size()], \
+      simulation::device_fission_scan_chunks[:simulation::fission_scan_chunks.size()])
+  }
+  int64_t n_old = simulation::fission_bank_scratch.size();
+  int64_t n_chunks_old = simulation::fission_scan_chunks.size();
+
+  simulation::fission_bank_scratch.resize(n);
+  simulation::fission_site_offsets.resize(n);
+  simulation::fission_scan_chunks.resize((n + SCAN_CHUNK - 1) / SCAN_CHUNK);
+
+  if (mapped) {
+    simulation::device_fission_bank_scratch = simulation::fission_bank_scratch.data();
+    simulation::device_fission_site_offsets = simulation::fission_site_offsets.data();
+    simulation::device_fission_scan_chunks = simulation::fission_scan_chunks.data();
+    #pragma omp target enter data map(alloc: simulation::device_fission_bank_scratch[:simulation::fission_bank_scratch.size()], \
+      simulation::device_fission_site_offsets[:simulation::fission_site_offsets.size()], \
+      simulation::device_fission_scan_chunks[:simulation::fission_scan_chunks.size()])
+    data::device_arena.record("Fission bank scratch",
+      (n - n_old) * (sizeof(Particle::Bank) + sizeof(int64_t)) +
+      (simulation::fission_scan_chunks.size() - n_chunks_old) * sizeof(int64_t));
+  }
+}
+
+//! Grow the fission bank, the spill buffer and the sorting scratch
+//
+//! \param capacity The number of sites the fission bank is to hold
+void grow_fission_bank(int64_t capacity)
+{
+  simulation::fission_bank.grow(capacity);
+  simulation::fission_spill.grow(
+    static_cast<int64_t>(std::ceil(FISSION_SPILL_FRACTION * capacity)));
+  if (settings::device_fission_bank) resize_fission_bank_scratch(capacity);
+}
+
+} // namespace
+
+omp_allocator_handle_t bank_allocator()
+{
+  if (!settings::pinned_banks) return omp_null_allocator;
+
+  static omp_allocator_handle_t pinned = [] {
+    omp_alloctrait_t traits[] {
+      {omp_atk_pinned, omp_atv_true},
+      {omp_atk_fallback, omp_atv_default_mem_fb}
+    };
+    return omp_init_allocator(omp_default_mem_space, 2, traits);
+  }();
+  return pinned;
+}
+
 void free_memory_bank()
 {
   simulation::source_bank.clear();
   simulation::surf_source_bank.clear();
   simulation::fission_bank.clear();
+  simulation::fission_spill.clear();
+  simulation::secondary_pool.clear();
+  simulation::secondary_pool_link.clear();
   simulation::progeny_per_particle.clear();
+  simulation::fission_bank_scratch.clear();
+  simulation::fission_site_offsets.clear();
+  simulation::fission_scan_chunks.clear();
 }
 
-void init_fission_bank(int64_t max)
+void init_fission_bank()
 {
-  simulation::fission_bank.reserve(max);
+  // Until a generation has run, sites are expected to be banked at the rate
+  // of the keff they are banked with
+  simulation::fission_site_yield = simulation::keff;
+  int64_t capacity = fission_bank_capacity(simulation::max_work_per_rank);
+  simulation::fission_bank.reserve(capacity, "Particle banks",
+    bank_allocator());
+  simulation::fission_spill.reserve(
+    static_cast<int64_t>(std::ceil(FISSION_SPILL_FRACTION * capacity)),
+    "Particle banks", bank_allocator());
+  simulation::progeny_per_particle.reserve(simulation::max_work_per_rank,
+    "Particle banks");
   simulation::progeny_per_particle.resize(simulation::work_per_rank);
+
+  if (settings::device_fission_bank) resize_fission_bank_scratch(capacity);
+}
+
+void reserve_fission_bank()
+{
+  int64_t capacity = fission_bank_capacity(simulation::work_per_rank);
+  if (capacity <= simulation::fission_bank.capacity()) return;
+  write_message(6, " Growing the fission bank from {} to {} sites",
+    simulation::fission_bank.capacity(), capacity);
+  grow_fission_bank(capacity);
+}
+
+void copy_fission_spill_to_host()
+{
+  simulation::fission_spill.copy_device_to_host();
+  #pragma omp target update from(simulation::fission_sites_dropped)
+}
+
+void append_fission_sites(const Particle::Bank* sites, int64_t n)
+{
+  int64_t size = simulation::fission_bank.size();
+  if (size + n > simulation::fission_bank.capacity()) {
+    grow_fission_bank(size + n);
+  }
+  std::copy(sites, sites + n, simulation::fission_bank.data() + size);
+  simulation::fission_bank.set_host_size(size + n);
+}
+
+void merge_fission_spill()
+{
+  int64_t n_spilled = simulation::fission_spill.size();
+  if (n_spilled > 0) {
+    // A fission bank resident on device takes a round trip through host to
+    // grow, which is only paid in the generations that outgrow it
+    if (settings::device_fission_bank) {
+      simulation::fission_bank.copy_device_to_host();
+    }
+    append_fission_sites(simulation::fission_spill.data(), n_spilled);
+    if (settings::device_fission_bank) {
+      simulation::fission_bank.copy_host_to_device();
+    }
+    write_message(6, " Merged {} fission sites spilled past the fission bank",
+      n_spilled);
+  }
+
+  if (simulation::fission_sites_dropped > 0) {
+    warning(fmt::format("{} fission sites fit in neither the fission bank nor "
+      "its spill buffer and were not banked. Increase --fission-bank-margin to "
+      "bank them.", simulation::fission_sites_dropped));
+  }
+
+  // The next generation's capacity is predicted from the sites of this one,
+  // including those that were dropped
+  if (simulation::work_per_rank > 0) {
+    simulation::fission_site_yield = simulation::keff *
+      (simulation::fission_bank.size() + simulation::fission_sites_dropped) /
+      simulation::work_per_rank;
+  }
+}
+
+void init_secondary_pool(int64_t max)
+{
+  simulation::secondary_pool.reserve(max, "Particle banks");
+  simulation::secondary_pool_link.resize(max);
 }
 
 // Performs an O(n) sort on the fission bank, by leveraging
@@ -65,22 +248,47 @@ void sort_fission_bank()
     return;
   }
 
+  simulation::time_bank.start();
+  simulation::time_bank_sort.start();
+
   // Perform exclusive scan summation to determine starting indices in fission
-  // bank for each parent particle id
-  int64_t tmp = simulation::progeny_per_particle[0];
-  simulation::progeny_per_particle[0] = 0;
-  for (int64_t i = 1; i < simulation::progeny_per_particle.size(); i++) {
-    int64_t value = simulation::progeny_per_particle[i-1] + tmp;
-    tmp = simulation::progeny_per_particle[i];
-    simulation::progeny_per_particle[i] = value;
-  }
+  // bank for each parent particle id. Each thread sums a contiguous block of
+  // parents, the block sums are scanned, and then each thread scans its own
+  // block starting from its offset.
+  int64_t n_parents = simulation::progeny_per_particle.size();
+  int64_t* progeny = simulation::progeny_per_particle.data();
+  std::vector<int64_t> block_offsets(omp_get_max_threads() + 1, 0);
+
+  #pragma omp parallel
+  {
+    int n_threads = omp_get_num_threads();
+    int t = omp_get_thread_num();
+    int64_t first = n_parents * t / n_threads;
+    int64_t last = n_parents * (t + 1) / n_threads;
 
-  // TODO: C++17 introduces the exclusive_scan() function which could be
-  // used to replace everything above this point in this function.
+    int64_t sum = 0;
+    for (int64_t i = first; i < last; i++) {
+      sum += progeny[i];
+    }
+    block_offsets[t + 1] = sum;
+
+    #pragma omp barrier
+    #pragma omp single
+    for (int i = 1; i <= n_threads; i++) {
+      block_offsets[i] += block_offsets[i - 1];
+    }
+
+    int64_t running = block_offsets[t];
+    for (int64_t i = first; i < last; i++) {
+      int64_t value = progeny[i];
+      progeny[i] = running;
+      running += value;
+    }
+  }
 
   // We need a scratch vector to make permutation of the fission bank into
-  // sorted order easy. Under normal usage conditions, the fission bank is
-  // over provisioned, so we can use that as scratch space.
+  // sorted order easy. The unused portion of the fission bank serves as
+  // scratch space when a generation banks at most half of its capacity.
   Particle::Bank* sorted_bank;
   std::vector<Particle::Bank> sorted_bank_holder;
 
@@ -92,17 +300,68 @@ void sort_fission_bank()
     sorted_bank = &simulation::fission_bank[simulation::fission_bank.size()];
   }
 
-  // Use parent and progeny indices to sort fission bank
-  for (int64_t i = 0; i < simulation::fission_bank.size(); i++) {
+  // Use parent and progeny indices to sort fission bank. Every site has a
+  // unique destination, so the scatter can be done in parallel.
+  int64_t n_bank = simulation::fission_bank.size();
+  int64_t first_id = simulation::work_index[mpi::rank];
+  #pragma omp parallel for
+  for (int64_t i = 0; i < n_bank; i++) {
     const auto& site = simulation::fission_bank[i];
-    int64_t offset = site.parent_id - 1 - simulation::work_index[mpi::rank];
-    int64_t idx = simulation::progeny_per_particle[offset] + site.progeny_id;
+    int64_t offset = site.parent_id - 1 - first_id;
+    int64_t idx = progeny[offset] + site.progeny_id;
     sorted_bank[idx] = site;
   }
 
   // Copy sorted bank into the fission bank
-  std::copy(sorted_bank, sorted_bank + simulation::fission_bank.size(),
-      simulation::fission_bank.data());
+  Particle::Bank* bank = simulation::fission_bank.data();
+  #pragma omp parallel for
+  for (int64_t i = 0; i < n_bank; i++) {
+    bank[i] = sorted_bank[i];
+  }
+
+  simulation::time_bank_sort.stop();
+  simulation::time_bank.stop();
+}
+
+void sort_fission_bank_device()
+{
+  int64_t n_parents = simulation::progeny_per_particle.size();
+  if (n_parents == 0) {
+    return;
+  }
+  simulation::time_bank.start();
+  simulation::time_bank_sort.start();
+
+  int64_t n_bank = simulation::fission_bank.size();
+  int64_t first_id = simulation::work_index[mpi::rank];
+
+  // Starting index in the sorted bank of each parent particle's sites
+  device_exclusive_scan(simulation::device_progeny_per_particle, n_parents,
+    simulation::device_fission_scan_chunks);
+
+  // Scatter sites into sorted order, then copy them back into the fission bank
+  #pragma omp target teams distribute parallel for
+  for (int64_t i = 0; i < n_bank; i++) {
+    const auto& site = simulation::fission_bank[i];
+    int64_t offset = site.parent_id - 1 - first_id;
+    int64_t idx = simulation::device_progeny_per_particle[offset] + site.progeny_id;
+    simulation::device_fission_bank_scratch[idx] = site;
+  }
+
+  #pragma omp target teams distribute parallel for
+  for (int64_t i = 0; i < n_bank; i++) {
+    simulation::fission_bank[i] = simulation::device_fission_bank_scratch[i];
+  }
+
+  simulation::time_bank_sort.stop();
+  simulation::time_bank.stop();
+}
+
+void update_source_bank_host()
+{
+  if (!simulation::source_bank_stale) return;
+  #pragma omp target update from(simulation::device_source_bank[:simulation::source_bank.size()])
+  simulation::source_bank_stale = false;
 }
 
 //==============================================================================
@@ -120,6 +379,7 @@ extern "C" int openmc_source_bank(void** ptr, int64_t* n)
     set_errmsg("Source bank has not been allocated.");
     return OPENMC_E_ALLOCATE;
   } else {
+    update_source_bank_host();
     *ptr = simulation::source_bank.data();
     *n = simulation::source_bank.size();
     return 0;
@@ -1,6 +1,9 @@
 #include "openmc/bremsstrahlung.h"
 
+#include <cmath>
+
 #include "openmc/constants.h"
+#include "openmc/device_alloc.h"
 #include "openmc/material.h"
 #include "openmc/random_lcg.h"
 #include "openmc/search.h"
@@ -22,55 +25,98 @@ xt::xtensor<double, 1> ttb_k_grid;
 double* device_ttb_e_grid {nullptr};
 size_t ttb_e_grid_size {0};
 
+vector<double> ttb_pdf;
+vector<double> ttb_cdf;
+vector<double> ttb_exponent;
+vector<double> ttb_log_yield;
+vector<double> ttb_energy;
+double* device_ttb_pdf {nullptr};
+double* device_ttb_cdf {nullptr};
+double* device_ttb_exponent {nullptr};
+double* device_ttb_log_yield {nullptr};
+double* device_ttb_energy {nullptr};
+size_t ttb_table_size {0};
+
 } // namespace data
 
 //==============================================================================
-// Bremsstrahlung implementation
+// Non-member functions
 //==============================================================================
 
-void BremsstrahlungData::copy_to_device()
-{
-  device_pdf_ = pdf_.data();
-  device_cdf_ = cdf_.data();
-  device_yield_ = yield_.data();
-  #pragma omp target enter data map(to: device_pdf_[:pdf_.size()])
-  #pragma omp target enter data map(to: device_cdf_[:cdf_.size()])
-  #pragma omp target enter data map(to: device_yield_[:yield_.size()])
-}
-
-void BremsstrahlungData::release_from_device()
+void copy_bremsstrahlung_to_device()
 {
-  #pragma omp target exit data map(release: device_pdf_[:pdf_.size()])
-  #pragma omp target exit data map(release: device_cdf_[:cdf_.size()])
-  #pragma omp target exit data map(release: device_yield_[:yield_.size()])
-}
-
-double BremsstrahlungData::pdf(gsl::index i, gsl::index j) const
-{
-  return *(device_pdf_ + i * data::ttb_e_grid_size + j);
-}
+  if (!settings::photon_transport ||
+      settings::electron_treatment != ElectronTreatment::TTB) return;
+
+  // The energy grid holds log energies by now
+  size_t n_e = data::ttb_e_grid.size();
+  size_t n_tables = 2 * model::materials_size;
+  data::ttb_table_size = n_e * (n_e + 1) / 2;
+  size_t n = n_tables * data::ttb_table_size;
+  data::ttb_pdf.resize(n, 0.0);
+  data::ttb_cdf.resize(n, 0.0);
+  data::ttb_exponent.resize(n, 0.0);
+  data::ttb_log_yield.resize(n_tables * n_e, 0.0);
+  data::ttb_energy.resize(n_e);
+  for (size_t i = 0; i < n_e; ++i) {
+    data::ttb_energy[i] = std::exp(data::ttb_e_grid(i));
+  }
 
-double BremsstrahlungData::cdf(gsl::index i, gsl::index j) const
-{
-  return *(device_cdf_ + i * data::ttb_e_grid_size + j);
-}
+  for (size_t t = 0; t < n_tables; ++t) {
+    const auto& mat {model::materials[t / 2]};
+    const auto& ttb {t % 2 == 0 ? mat.ttb_.electron : mat.ttb_.positron};
+    if (ttb.yield_.size() != n_e) continue;
+
+    for (size_t i = 0; i < n_e; ++i) {
+      size_t row = t * data::ttb_table_size + i * (i + 1) / 2;
+      for (size_t k = 0; k <= i; ++k) {
+        data::ttb_pdf[row + k] = ttb.pdf_(i, k);
+        data::ttb_cdf[row + k] = ttb.cdf_(i, k);
+
+        // The PDF is interpolated on a log-log scale, as p(w) ~ w^(a-1)
+        // between photon energies, with the CDF growing as w^a
+        if (k < i) {
+          data::ttb_exponent[row + k] = std::log(ttb.pdf_(i, k+1) /
+            ttb.pdf_(i, k)) / (data::ttb_e_grid(k+1) - data::ttb_e_grid(k)) +
+            1.0;
+        }
+      }
+      data::ttb_log_yield[t * n_e + i] = ttb.yield_(i);
+    }
+  }
 
-void Bremsstrahlung::copy_to_device()
-{
-  electron.copy_to_device();
-  positron.copy_to_device();
+  data::device_ttb_pdf = data::ttb_pdf.data();
+  data::device_ttb_cdf = data::ttb_cdf.data();
+  data::device_ttb_exponent = data::ttb_exponent.data();
+  data::device_ttb_log_yield = data::ttb_log_yield.data();
+  data::device_ttb_energy = data::ttb_energy.data();
+  #pragma omp target update to(data::ttb_table_size)
+  #pragma omp target enter data map(to: data::device_ttb_pdf[:n])
+  #pragma omp target enter data map(to: data::device_ttb_cdf[:n])
+  #pragma omp target enter data map(to: data::device_ttb_exponent[:n])
+  #pragma omp target enter data map(to: data::device_ttb_log_yield[:n_tables*n_e])
+  #pragma omp target enter data map(to: data::device_ttb_energy[:n_e])
+  data::device_arena.record("Bremsstrahlung tables",
+    (3 * n + n_tables * n_e + n_e) * sizeof(double));
 }
 
-void Bremsstrahlung::release_from_device()
+void release_bremsstrahlung_from_device()
 {
-  electron.release_from_device();
-  positron.release_from_device();
+  if (data::ttb_pdf.empty()) return;
+
+  size_t n = data::ttb_pdf.size();
+  #pragma omp target exit data map(release: data::device_ttb_pdf[:n])
+  #pragma omp target exit data map(release: data::device_ttb_cdf[:n])
+  #pragma omp target exit data map(release: data::device_ttb_exponent[:n])
+  #pragma omp target exit data map(release: data::device_ttb_log_yield[:data::ttb_log_yield.size()])
+  #pragma omp target exit data map(release: data::device_ttb_energy[:data::ttb_energy.size()])
+  data::ttb_pdf.clear();
+  data::ttb_cdf.clear();
+  data::ttb_exponent.clear();
+  data::ttb_log_yield.clear();
+  data::ttb_energy.clear();
 }
 
-//==============================================================================
-// Non-member functions
-//==============================================================================
-
 void thick_target_bremsstrahlung(Particle& p, double* E_lost)
 {
   if (p.material_ == MATERIAL_VOID) return;
@@ -78,16 +124,13 @@ void thick_target_bremsstrahlung(Particle& p, double* E_lost)
   int photon = static_cast<int>(Particle::Type::photon);
   if (p.E_ < settings::energy_cutoff[photon]) return;
 
-  // Get bremsstrahlung data for this material and particle type
-  BremsstrahlungData* mat;
-  if (p.type_ == Particle::Type::positron) {
-    mat = &model::materials[p.material_].ttb_.positron;
-  } else {
-    mat = &model::materials[p.material_].ttb_.electron;
-  }
+  // Get the bremsstrahlung table of this material and particle type
+  auto n_e = data::ttb_e_grid_size;
+  size_t t = 2 * p.material_ + (p.type_ == Particle::Type::positron ? 1 : 0);
+  size_t table = t * data::ttb_table_size;
+  const double* log_yield = data::device_ttb_log_yield + t * n_e;
 
   double e = std::log(p.E_);
-  auto n_e = data::ttb_e_grid_size;
 
   // Find the lower bounding index of the incident electron energy
   size_t j = lower_bound_index(data::device_ttb_e_grid,
@@ -97,8 +140,8 @@ void thick_target_bremsstrahlung(Particle& p, double* E_lost)
   // Get the interpolation bounds
   double e_l = data::device_ttb_e_grid[j];
   double e_r = data::device_ttb_e_grid[j+1];
-  double y_l = mat->device_yield_[j];
-  double y_r = mat->device_yield_[j+1];
+  double y_l = log_yield[j];
+  double y_r = log_yield[j+1];
 
   // Calculate the interpolation weight w_j+1 of the bremsstrahlung energy PDF
   // interpolated in log energy, which can be interpreted as the probability
@@ -118,39 +161,38 @@ void thick_target_bremsstrahlung(Particle& p, double* E_lost)
   // Sample index of the tabulated PDF in the energy grid, j or j+1
   double c_max;
   int i_e;
+  size_t row;
   if (prn(p.current_seed()) <= f || j == 0) {
     i_e = j + 1;
+    row = table + i_e * (i_e + 1) / 2;
 
     // Interpolate the maximum value of the CDF at the incoming particle
     // energy on a log-log scale
-    double p_l = mat->pdf(i_e, i_e - 1);
-    double p_r = mat->pdf(i_e, i_e);
-    double c_l = mat->cdf(i_e, i_e - 1);
-    double a = std::log(p_r/p_l)/(e_r - e_l) + 1.0;
-    c_max = c_l + std::exp(e_l)*p_l/a*(std::exp(a*(e - e_l)) - 1.0);
+    size_t k = row + i_e - 1;
+    double a = data::device_ttb_exponent[k];
+    c_max = data::device_ttb_cdf[k] + data::device_ttb_energy[i_e - 1] *
+      data::device_ttb_pdf[k]/a*(std::exp(a*(e - e_l)) - 1.0);
   } else {
     i_e = j;
+    row = table + i_e * (i_e + 1) / 2;
 
     // Maximum value of the CDF
-    c_max = mat->cdf(i_e, i_e);
+    c_max = data::device_ttb_cdf[row + i_e];
   }
 
   // Sample the energies of the emitted photons
+  const double* cdf = data::device_ttb_cdf + row;
   for (int i = 0; i < n; ++i) {
     // Generate a random number r and determine the index i for which
     // cdf(i) <= r*cdf,max <= cdf(i+1)
     double c = prn(p.current_seed())*c_max;
-    auto start = mat->device_cdf_ + i_e * data::ttb_e_grid_size;
-    int i_w = lower_bound_index(start, start + i_e, c);
+    int i_w = lower_bound_index(cdf, cdf + i_e, c);
 
     // Sample the photon energy
-    double w_l = data::device_ttb_e_grid[i_w];
-    double w_r = data::device_ttb_e_grid[i_w + 1];
-    double p_l = mat->pdf(i_e, i_w);
-    double p_r = mat->pdf(i_e, i_w + 1);
-    double c_l = mat->cdf(i_e, i_w);
-    double a = std::log(p_r/p_l)/(w_r - w_l) + 1.0;
-    double w = std::exp(w_l)*std::pow(a*(c - c_l)/(std::exp(w_l)*p_l) + 1.0, 1.0/a);
+    double w_l = data::device_ttb_energy[i_w];
+    double p_l = data::device_ttb_pdf[row + i_w];
+    double a = data::device_ttb_exponent[row + i_w];
+    double w = w_l*std::pow(a*(c - cdf[i_w])/(w_l*p_l) + 1.0, 1.0/a);
 
     if (w > settings::energy_cutoff[photon]) {
       // Create secondary photon
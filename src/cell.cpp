@@ -24,6 +24,7 @@
 #include "openmc/nuclide.h"
 #include "openmc/settings.h"
 #include "openmc/surface.h"
+#include "openmc/triangle_bvh.h"
 #include "openmc/xml_interface.h"
 
 namespace openmc {
@@ -42,6 +43,21 @@ namespace model {
   std::unordered_map<int32_t, int32_t> universe_map;
 } // namespace model
 
+namespace {
+
+// Cells changed on host since they were sent to device, and those among them
+// whose vectors were released to be reallocated
+std::vector<int32_t> changed_cells;
+std::vector<int32_t> relocated_cells;
+
+// Block of instances whose temperatures changed in each changed cell, as the
+// first instance and one past the last. Only the block is sent to device, as
+// coupled thermal-hydraulics updates of a few assemblies would otherwise send
+// the temperatures of every instance of the core.
+std::unordered_map<int32_t, std::pair<int32_t, int32_t>> changed_instances;
+
+} // namespace
+
 //==============================================================================
 //! Convert region specification string to integer tokens.
 //!
@@ -289,6 +305,132 @@ vector<int32_t> generate_postfix(int32_t cell_id, vector<int32_t> infix)
   return rpn;
 }
 
+//==============================================================================
+
+int half_space_cost(int32_t token)
+{
+  // Note the off-by-one indexing
+  switch (model::surfaces[std::abs(token) - 1].type_) {
+  case Surface::SurfaceType::SurfaceXPlane:
+  case Surface::SurfaceType::SurfaceYPlane:
+  case Surface::SurfaceType::SurfaceZPlane:
+    return 1;
+  case Surface::SurfaceType::SurfacePlane:
+    return 2;
+  case Surface::SurfaceType::SurfaceXCylinder:
+  case Surface::SurfaceType::SurfaceYCylinder:
+  case Surface::SurfaceType::SurfaceZCylinder:
+  case Surface::SurfaceType::SurfaceSphere:
+    return 3;
+  case Surface::SurfaceType::SurfaceXCone:
+  case Surface::SurfaceType::SurfaceYCone:
+  case Surface::SurfaceType::SurfaceZCone:
+    return 4;
+  default:
+    return 6;
+  }
+}
+
+//==============================================================================
+
+void mark_cell_changed(int32_t i, bool relocate, int32_t instance)
+{
+  if (!model::device_cells) return;
+
+  // A change of every instance covers all of them
+  auto it = changed_instances.find(i);
+  if (instance < 0 || relocate) {
+    changed_instances[i] = {0, INT32_MAX};
+  } else if (it == changed_instances.end()) {
+    changed_instances[i] = {instance, instance + 1};
+  } else {
+    it->second.first = std::min(it->second.first, instance);
+    it->second.second = std::max(it->second.second, instance + 1);
+  }
+
+  // Releasing a vector no longer on device has no effect
+  changed_cells.push_back(i);
+  if (relocate) {
+    model::cells[i].material_.release_device();
+    model::cells[i].sqrtkT_.release_device();
+    relocated_cells.push_back(i);
+  }
+}
+
+void update_cells_on_device()
+{
+  if (!model::device_cells) return;
+
+  // The device copies of relocated vectors are replaced by ones of their new
+  // size, and the vectors' pointers and sizes in the device cell are attached
+  // to them
+  Cell* cells = model::device_cells;
+  for (auto* v : {&changed_cells, &relocated_cells}) {
+    std::sort(v->begin(), v->end());
+    v->erase(std::unique(v->begin(), v->end()), v->end());
+  }
+  for (int32_t i : relocated_cells) {
+    auto& c = model::cells[i];
+    #pragma omp target update to(cells[i].material_, cells[i].sqrtkT_)
+    c.material_.copy_to_device();
+    c.sqrtkT_.copy_to_device();
+  }
+
+  for (int32_t i : changed_cells) {
+    auto& c = model::cells[i];
+    if (!std::binary_search(relocated_cells.begin(), relocated_cells.end(),
+        i)) {
+      c.material_.update_to_device();
+      const auto& block = changed_instances.at(i);
+      int32_t first = std::min<int32_t>(block.first, c.sqrtkT_.size());
+      int32_t last = std::min<int32_t>(block.second, c.sqrtkT_.size());
+      if (first < last) c.sqrtkT_.update_to_device(first, last - first);
+    }
+    #pragma omp target update to(cells[i].type_)
+  }
+  changed_cells.clear();
+  relocated_cells.clear();
+  changed_instances.clear();
+}
+
+namespace {
+
+//==============================================================================
+//! Union or intersection of half-spaces, built from the RPN of a region to
+//! compile it. Nested operations of the same kind are flattened into one.
+//==============================================================================
+
+struct RegionNode {
+  int32_t token;            //!< Half-space, OP_UNION or OP_INTERSECTION
+  vector<int> children;     //!< Operands of a union or intersection
+  int cost;                 //!< Relative cost of evaluating every operand
+};
+
+//! Append the instructions of a node, given where evaluation continues once its
+//! value is known, and return the index of its first instruction. Operands are
+//! emitted last to first so that the targets of each one are already known.
+int32_t emit_region(const vector<RegionNode>& nodes, int i_node,
+  int32_t on_true, int32_t on_false, vector<RegionInstruction>& code)
+{
+  const auto& node = nodes[i_node];
+  if (node.token < OP_UNION) {
+    code.push_back({node.token, on_true, on_false});
+    return code.size() - 1;
+  }
+
+  int32_t next = (node.token == OP_INTERSECTION) ? on_true : on_false;
+  for (int k = node.children.size() - 1; k >= 0; --k) {
+    if (node.token == OP_INTERSECTION) {
+      next = emit_region(nodes, node.children[k], next, on_false, code);
+    } else {
+      next = emit_region(nodes, node.children[k], on_true, next, code);
+    }
+  }
+  return next;
+}
+
+} // namespace
+
 //==============================================================================
 // Universe implementation
 //==============================================================================
@@ -388,15 +530,20 @@ Cell::set_temperature(double T, int32_t instance, bool set_contained)
   if (type_ == Fill::MATERIAL) {
     if (instance >= 0) {
       // If temperature vector is not big enough, resize it first
-      if (sqrtkT_.size() != n_instances_) sqrtkT_.resize(n_instances_, sqrtkT_[0]);
+      int32_t i_cell = this - model::cells.data();
+      bool resize = sqrtkT_.size() != n_instances_;
+      mark_cell_changed(i_cell, resize, instance);
+      if (resize) sqrtkT_.resize(n_instances_, sqrtkT_[0]);
 
       // Set temperature for the corresponding instance
       sqrtkT_.at(instance) = std::sqrt(K_BOLTZMANN * T);
     } else {
-      // Set temperature for all instances
-      for (auto& T_ : sqrtkT_) {
-        T_ = std::sqrt(K_BOLTZMANN * T);
-      }
+      // Set temperature for all instances, which then share a single entry
+      // again instead of one each
+      bool collapse = sqrtkT_.size() > 1;
+      mark_cell_changed(this - model::cells.data(), collapse);
+      if (collapse) sqrtkT_.resize(1);
+      sqrtkT_[0] = std::sqrt(K_BOLTZMANN * T);
     }
   } else {
     if (!set_contained) {
@@ -466,6 +613,12 @@ void Cell::copy_to_device()
   material_.copy_to_device();
   sqrtkT_.copy_to_device();
   region_.copy_to_device();
+  region_code_.copy_to_device();
+  neighbors_.adjacent_.copy_to_device();
+  neighbors_.crossings_.copy_to_device();
+  surface_batches_.copy_to_device();
+  batch_tokens_.copy_to_device();
+  batch_coeffs_.copy_to_device();
   offset_.copy_to_device();
 }
 
@@ -536,28 +689,7 @@ Cell::Cell(pugi::xml_node cell_node)
 
   // Read the temperature element which may be distributed like materials.
   if (check_for_node(cell_node, "temperature")) {
-    sqrtkT_ = get_node_array_ov<double>(cell_node, "temperature");
-    sqrtkT_.shrink_to_fit();
-
-    // Make sure this is a material-filled cell.
-    if (material_.size() == 0) {
-      fatal_error(fmt::format(
-        "Cell {} was specified with a temperature but no material. Temperature"
-        "specification is only valid for cells filled with a material.", id_));
-    }
-
-    // Make sure all temperatures are non-negative.
-    for (auto T : sqrtkT_) {
-      if (T < 0) {
-        fatal_error(fmt::format(
-          "Cell {} was specified with a negative temperature", id_));
-      }
-    }
-
-    // Convert to sqrt(k*T).
-    for (auto& T : sqrtkT_) {
-      T = std::sqrt(K_BOLTZMANN * T);
-    }
+    set_temperatures(get_node_array<double>(cell_node, "temperature"));
   }
 
   // Read the region specification.
@@ -565,7 +697,73 @@ Cell::Cell(pugi::xml_node cell_node)
   if (check_for_node(cell_node, "region")) {
     region_spec = get_node_value(cell_node, "region");
   }
+  set_region(region_spec);
+
+  // Read the translation vector.
+  if (check_for_node(cell_node, "translation")) {
+    set_translation(get_node_array<double>(cell_node, "translation"));
+  }
+
+  // Read the rotation transform.
+  if (check_for_node(cell_node, "rotation")) {
+    set_rotation(get_node_array<double>(cell_node, "rotation"));
+  }
+}
+
+Cell::Cell(int32_t id, const std::string& name, int32_t universe,
+  int32_t fill, const std::vector<int32_t>& material,
+  const std::vector<double>& temperature, const std::string& region,
+  const std::vector<double>& translation, const std::vector<double>& rotation)
+  : id_(id), name_(name), universe_(universe), fill_(fill)
+{
+  if (fill_ == C_NONE && material.empty()) {
+    fatal_error(fmt::format(
+      "Neither material nor fill was specified for cell {}", id_));
+  }
+  if (fill_ != C_NONE && !material.empty()) {
+    fatal_error(fmt::format("Cell {} has both a material and a fill specified; "
+      "only one can be specified per cell", id_));
+  }
+  if (fill_ != C_NONE && fill_ == universe_) {
+    fatal_error(fmt::format("Cell {} is filled with the same universe that"
+      "it is contained in.", id_));
+  }
+  material_.assign(material.begin(), material.end());
+
+  if (!temperature.empty()) set_temperatures(temperature);
+  set_region(region);
+  if (!translation.empty()) set_translation(translation);
+  if (!rotation.empty()) set_rotation(rotation);
+}
+
+void Cell::set_temperatures(const std::vector<double>& T)
+{
+  // Make sure this is a material-filled cell.
+  if (material_.size() == 0) {
+    fatal_error(fmt::format(
+      "Cell {} was specified with a temperature but no material. Temperature"
+      "specification is only valid for cells filled with a material.", id_));
+  }
 
+  // Make sure all temperatures are non-negative.
+  for (auto T_i : T) {
+    if (T_i < 0) {
+      fatal_error(fmt::format(
+        "Cell {} was specified with a negative temperature", id_));
+    }
+  }
+
+  // Convert to sqrt(k*T).
+  sqrtkT_.clear();
+  sqrtkT_.reserve(T.size());
+  for (auto T_i : T) {
+    sqrtkT_.push_back(std::sqrt(K_BOLTZMANN * T_i));
+  }
+  sqrtkT_.shrink_to_fit();
+}
+
+void Cell::set_region(const std::string& region_spec)
+{
   // Get a tokenized representation of the region specification and apply De
   // Morgans law
   region_ = tokenize(region_spec);
@@ -574,10 +772,8 @@ Cell::Cell(pugi::xml_node cell_node)
   // Convert user IDs to surface indices.
   for (auto& r : region_) {
     if (r < OP_UNION) {
-      //const auto& it {model::surface_map.find(abs(r))};
       const auto& it {model::surface_map.find(std::abs(r))};
       if (it == model::surface_map.end()) {
-        //throw std::runtime_error{"Invalid surface ID " + std::to_string(abs(r))
         throw std::runtime_error{"Invalid surface ID " + std::to_string(std::abs(r))
           + " specified in region for cell " + std::to_string(id_) + "."};
       }
@@ -608,102 +804,252 @@ Cell::Cell(pugi::xml_node cell_node)
     region_.shrink_to_fit();
   }
 
-  // Read the translation vector.
-  if (check_for_node(cell_node, "translation")) {
-    if (fill_ == C_NONE) {
-      fatal_error(fmt::format("Cannot apply a translation to cell {}"
-        " because it is not filled with another universe", id_));
-    }
+  update_region();
+}
 
-    auto xyz {get_node_array<double>(cell_node, "translation")};
-    if (xyz.size() != 3) {
-      fatal_error(fmt::format(
-        "Non-3D translation vector applied to cell {}", id_));
-    }
-    translation_ = xyz;
+void Cell::set_translation(const std::vector<double>& xyz)
+{
+  if (fill_ == C_NONE) {
+    fatal_error(fmt::format("Cannot apply a translation to cell {}"
+      " because it is not filled with another universe", id_));
+  }
+  if (xyz.size() != 3) {
+    fatal_error(fmt::format(
+      "Non-3D translation vector applied to cell {}", id_));
   }
+  translation_ = xyz;
+}
 
-  // Read the rotation transform.
-  if (check_for_node(cell_node, "rotation")) {
-    if (fill_ == C_NONE) {
-      fatal_error(fmt::format("Cannot apply a rotation to cell {}"
-        " because it is not filled with another universe", id_));
+void Cell::set_rotation(const std::vector<double>& rot)
+{
+  if (fill_ == C_NONE) {
+    fatal_error(fmt::format("Cannot apply a rotation to cell {}"
+      " because it is not filled with another universe", id_));
+  }
+  if (rot.size() != 3 && rot.size() != 9) {
+    fatal_error(fmt::format(
+      "Non-3D rotation vector applied to cell {}", id_));
+  }
+
+  // Compute and store the rotation matrix.
+  if (rot.size() == 3) {
+    double phi = -rot[0] * PI / 180.0;
+    double theta = -rot[1] * PI / 180.0;
+    double psi = -rot[2] * PI / 180.0;
+    rotation_[0] = std::cos(theta) * std::cos(psi);
+    rotation_[1] = -std::cos(phi) * std::sin(psi)
+                        + std::sin(phi) * std::sin(theta) * std::cos(psi);
+    rotation_[2] = std::sin(phi) * std::sin(psi)
+                        + std::cos(phi) * std::sin(theta) * std::cos(psi);
+    rotation_[3] = std::cos(theta) * std::sin(psi);
+    rotation_[4] = std::cos(phi) * std::cos(psi)
+                        + std::sin(phi) * std::sin(theta) * std::sin(psi);
+    rotation_[5] = -std::sin(phi) * std::cos(psi)
+                        + std::cos(phi) * std::sin(theta) * std::sin(psi);
+    rotation_[6] = -std::sin(theta);
+    rotation_[7] = std::sin(phi) * std::cos(theta);
+    rotation_[8] = std::cos(phi) * std::cos(theta);
+
+    // When user specifies angles, write them at end of vector
+    rotation_[9] = rot[0];
+    rotation_[10] = rot[1];
+    rotation_[11] = rot[2];
+    rotation_length_ = 12;
+  } else {
+    std::copy(rot.begin(), rot.end(), rotation_);
+    rotation_length_ = 9;
+  }
+}
+
+//==============================================================================
+
+bool
+Cell::contains(Position r, Direction u, int32_t on_surface,
+  SurfaceSenseCache* senses) const
+{
+  // The margin keeps points that surface senses, with their tolerance and
+  // tie-breaking direction, could still place in the cell
+  if (check_box_ &&
+      (r.x < box_.xmin - TINY_BIT || r.x > box_.xmax + TINY_BIT ||
+       r.y < box_.ymin - TINY_BIT || r.y > box_.ymax + TINY_BIT ||
+       r.z < box_.zmin - TINY_BIT || r.z > box_.zmax + TINY_BIT)) {
+    return false;
+  }
+
+  int32_t i = region_entry_;
+  while (i >= 0) {
+    const auto& inst = region_code_[i];
+
+    // If the particle's surface attribute is set and matches the token, that
+    // overrides the determination based on sense().
+    bool in_half_space;
+    if (inst.token == on_surface) {
+      in_half_space = true;
+    } else if (-inst.token == on_surface) {
+      in_half_space = false;
+    } else {
+      // Note the off-by-one indexing
+      int32_t i_surf = std::abs(inst.token) - 1;
+      bool sense = senses ? senses->sense(i_surf, r, u) :
+        model::device_surfaces[i_surf].sense(r, u);
+      in_half_space = (sense == (inst.token > 0));
     }
+    i = in_half_space ? inst.on_true : inst.on_false;
+  }
+  return i == REGION_ACCEPT;
+}
 
-    auto rot {get_node_array<double>(cell_node, "rotation")};
-    if (rot.size() != 3 && rot.size() != 9) {
-      fatal_error(fmt::format(
-        "Non-3D rotation vector applied to cell {}", id_));
+//==============================================================================
+
+void Cell::update_region()
+{
+  compile_region();
+  build_surface_batches();
+
+  // Cache the bounding box of cells with enough surfaces that testing it
+  // first saves evaluating the region for points far from the cell
+  box_ = bounding_box();
+  check_box_ = region_code_.size() >= CELL_BOX_MIN_TESTS &&
+    (std::isfinite(box_.xmin) || std::isfinite(box_.xmax) ||
+     std::isfinite(box_.ymin) || std::isfinite(box_.ymax) ||
+     std::isfinite(box_.zmin) || std::isfinite(box_.zmax));
+}
+
+//==============================================================================
+
+void Cell::build_surface_batches()
+{
+  surface_batches_.clear();
+  batch_tokens_.clear();
+  batch_coeffs_.clear();
+
+  // Find each surface once, keeping the sign of its first token, and order
+  // them by type
+  std::set<int32_t> surfs;
+  vector<int32_t> tokens;
+  for (int32_t token : region_) {
+    if (token < OP_UNION && surfs.insert(std::abs(token)).second) {
+      tokens.push_back(token);
     }
+  }
+  // Note the off-by-one indexing
+  auto type = [](int32_t token) {
+    return model::surfaces[std::abs(token) - 1].type_;
+  };
 
-    // Compute and store the rotation matrix.
-    //rotation_.reserve(rot.size() == 9 ? 9 : 12);
-    if (rot.size() == 3) {
-      double phi = -rot[0] * PI / 180.0;
-      double theta = -rot[1] * PI / 180.0;
-      double psi = -rot[2] * PI / 180.0;
-      rotation_[0] = std::cos(theta) * std::cos(psi);
-      rotation_[1] = -std::cos(phi) * std::sin(psi)
-                          + std::sin(phi) * std::sin(theta) * std::cos(psi);
-      rotation_[2] = std::sin(phi) * std::sin(psi)
-                          + std::cos(phi) * std::sin(theta) * std::cos(psi);
-      rotation_[3] = std::cos(theta) * std::sin(psi);
-      rotation_[4] = std::cos(phi) * std::cos(psi)
-                          + std::sin(phi) * std::sin(theta) * std::sin(psi);
-      rotation_[5] = -std::sin(phi) * std::cos(psi)
-                          + std::cos(phi) * std::sin(theta) * std::sin(psi);
-      rotation_[6] = -std::sin(theta);
-      rotation_[7] = std::sin(phi) * std::cos(theta);
-      rotation_[8] = std::cos(phi) * std::cos(theta);
-
-      // When user specifies angles, write them at end of vector
-      rotation_[9] = rot[0];
-      rotation_[10] = rot[1];
-      rotation_[11] = rot[2];
-      rotation_length_ = 12;
-    } else {
-      std::copy(rot.begin(), rot.end(), rotation_);
-      rotation_length_ = 9;
+  // Planes normal to each axis are also sorted by position, so that only the
+  // distance to the first one ahead of the particle is needed
+  auto position = [](int32_t token) {
+    const auto& surf {model::surfaces[std::abs(token) - 1]};
+    switch (surf.type_) {
+      case Surface::SurfaceType::SurfaceXPlane: return surf.x0_;
+      case Surface::SurfaceType::SurfaceYPlane: return surf.y0_;
+      case Surface::SurfaceType::SurfaceZPlane: return surf.z0_;
+      default: return 0.0;
     }
+  };
+  std::stable_sort(tokens.begin(), tokens.end(),
+    [&type, &position](int32_t a, int32_t b) {
+      return type(a) < type(b) ||
+        (type(a) == type(b) && position(a) < position(b));
+    });
+
+  for (int32_t token : tokens) {
+    const auto& surf {model::surfaces[std::abs(token) - 1]};
+    if (surface_batches_.empty() || surface_batches_.back().type != surf.type_) {
+      surface_batches_.push_back({surf.type_, 0,
+        static_cast<int32_t>(batch_tokens_.size()),
+        static_cast<int32_t>(batch_coeffs_.size())});
+    }
+    ++surface_batches_.back().n;
+    batch_tokens_.push_back(token);
+    pack_coefficients(surf, batch_coeffs_);
   }
 }
 
 //==============================================================================
 
-bool
-Cell::contains(Position r, Direction u, int32_t on_surface) const
+void Cell::compile_region()
 {
+  region_code_.clear();
+  region_entry_ = REGION_ACCEPT;
+  if (region_.empty()) return;
+
+  // Build the expression tree from the RPN, flattening nested operations of
+  // the same kind. Simple cells are a single intersection of every token.
+  vector<RegionNode> nodes;
+  vector<int> stack;
+  auto rpn = simple_ ? region_ : generate_postfix(id_, region_);
   if (simple_) {
-    return contains_simple(r, u, on_surface);
-  } else {
-    return contains_complex(r, u, on_surface);
+    nodes.push_back({OP_INTERSECTION, {}, 0});
   }
+  for (int32_t token : rpn) {
+    if (token < OP_UNION) {
+      nodes.push_back({token, {}, half_space_cost(token)});
+      if (simple_) {
+        nodes[0].children.push_back(nodes.size() - 1);
+      } else {
+        stack.push_back(nodes.size() - 1);
+      }
+      continue;
+    }
+
+    RegionNode node {token, {}, 0};
+    for (int i = 0; i < 2; ++i) {
+      int i_operand = stack[stack.size() - 2 + i];
+      if (nodes[i_operand].token == token) {
+        for (int c : nodes[i_operand].children) node.children.push_back(c);
+      } else {
+        node.children.push_back(i_operand);
+      }
+    }
+    stack.resize(stack.size() - 2);
+    nodes.push_back(node);
+    stack.push_back(nodes.size() - 1);
+  }
+  int i_root = simple_ ? 0 : stack.back();
+
+  // Evaluate cheaper operands first. Nodes only refer to nodes built before
+  // them, so one pass in order sums the cost of the operands of every node.
+  for (auto& node : nodes) {
+    if (node.token < OP_UNION) continue;
+    node.cost = 0;
+    for (int c : node.children) node.cost += nodes[c].cost;
+    std::stable_sort(node.children.begin(), node.children.end(),
+      [&nodes](int a, int b) { return nodes[a].cost < nodes[b].cost; });
+  }
+
+  // Emit the instructions and reverse them so that they are laid out in the
+  // order they are evaluated
+  vector<RegionInstruction> code;
+  int32_t entry = emit_region(nodes, i_root, REGION_ACCEPT, REGION_REJECT,
+    code);
+  int32_t n = code.size();
+  for (int32_t i = n - 1; i >= 0; --i) {
+    auto inst = code[i];
+    if (inst.on_true >= 0) inst.on_true = n - 1 - inst.on_true;
+    if (inst.on_false >= 0) inst.on_false = n - 1 - inst.on_false;
+    region_code_.push_back(inst);
+  }
+  region_entry_ = n - 1 - entry;
 }
 
 //==============================================================================
 
 std::pair<double, int32_t>
-Cell::distance(Position r, Direction u, int32_t on_surface, Particle* p) const
+Cell::distance(Position r, Direction u, int32_t on_surface, Particle* p,
+  PlaneEvalCache* planes) const
 {
   double min_dist {INFTY};
   int32_t i_surf {std::numeric_limits<int32_t>::max()};
 
-  for (int32_t token : region_) {
-    // Ignore this token if it corresponds to an operator rather than a region.
-    if (token >= OP_UNION) continue;
-
-    // Calculate the distance to this surface.
-    // Note the off-by-one indexing
-    bool coincident {std::fabs(token) == std::fabs(on_surface)};
-    double d {model::device_surfaces[(int) std::fabs(token)-1].distance(r, u, coincident)};
-
-    // Check if this distance is the new minimum.
-    if (d < min_dist) {
-      if (min_dist - d >= FP_PRECISION*min_dist) {
-        min_dist = d;
-        i_surf = -token;
-      }
-    }
+  if (planes && !planes->valid(id_, r)) planes->reset(id_, r);
+
+  // Surfaces of the same type are checked together to avoid dispatching on the
+  // type of each of them
+  for (const auto& batch : surface_batches_) {
+    batch_distance(batch, batch_tokens_.data(), batch_coeffs_.data(), r, u,
+      on_surface, min_dist, i_surf, planes);
   }
 
   return {min_dist, i_surf};
@@ -725,25 +1071,7 @@ Cell::to_hdf5(hid_t cell_group) const
 
   // Write the region specification.
   if (!region_.empty()) {
-    std::stringstream region_spec {};
-    for (int32_t token : region_) {
-      if (token == OP_LEFT_PAREN) {
-        region_spec << " (";
-      } else if (token == OP_RIGHT_PAREN) {
-        region_spec << " )";
-      } else if (token == OP_COMPLEMENT) {
-        region_spec << " ~";
-      } else if (token == OP_INTERSECTION) {
-      } else if (token == OP_UNION) {
-        region_spec << " |";
-      } else {
-        // Note the off-by-one indexing
-        //auto surf_id = model::surfaces[abs(token)-1].id_;
-        auto surf_id = model::surfaces[std::abs(token)-1].id_;
-        region_spec << " " << ((token > 0) ? surf_id : -surf_id);
-      }
-    }
-    write_string(group, "region", region_spec.str(), false);
+    write_string(group, "region", region_spec(), false);
   }
 
   // Write fill information.
@@ -795,6 +1123,29 @@ Cell::to_hdf5(hid_t cell_group) const
   close_group(group);
 }
 
+std::string
+Cell::region_spec() const
+{
+  std::stringstream region_spec {};
+  for (int32_t token : region_) {
+    if (token == OP_LEFT_PAREN) {
+      region_spec << " (";
+    } else if (token == OP_RIGHT_PAREN) {
+      region_spec << " )";
+    } else if (token == OP_COMPLEMENT) {
+      region_spec << " ~";
+    } else if (token == OP_INTERSECTION) {
+    } else if (token == OP_UNION) {
+      region_spec << " |";
+    } else {
+      // Note the off-by-one indexing
+      auto surf_id = model::surfaces[std::abs(token)-1].id_;
+      region_spec << " " << ((token > 0) ? surf_id : -surf_id);
+    }
+  }
+  return region_spec.str();
+}
+
 BoundingBox Cell::bounding_box_simple() const {
   BoundingBox bbox;
   for (int32_t token : region_) {
@@ -918,85 +1269,17 @@ BoundingBox Cell::bounding_box() const
 
 //==============================================================================
 
-bool
-Cell::contains_simple(Position r, Direction u, int32_t on_surface) const
+#pragma omp declare target
+bool SurfaceSenseCache::sense(int32_t i_surf, Position r, Direction u)
 {
-  for (int32_t token : region_) {
-    // Assume that no tokens are operators. Evaluate the sense of particle with
-    // respect to the surface and see if the token matches the sense. If the
-    // particle's surface attribute is set and matches the token, that
-    // overrides the determination based on sense().
-    if (token == on_surface) {
-    } else if (-token == on_surface) {
-      return false;
-    } else {
-      // Note the off-by-one indexing
-      bool sense = model::device_surfaces[std::abs(token)-1].sense(r, u);
-      if (sense != (token > 0)) {return false;}
-    }
-  }
-  return true;
-}
-
-//==============================================================================
-
-bool
-Cell::contains_complex(Position r, Direction u, int32_t on_surface) const
-{
-  bool in_cell = true;
-  int total_depth = 0;
-
-  // For each token
-  for (auto it = region_.begin(); it != region_.end(); it++) {
-    int32_t token = *it;
-
-    // If the token is a surface evaluate the sense
-    // If the token is a union or intersection check to
-    // short circuit
-    if (token < OP_UNION) {
-      if (token == on_surface) {
-        in_cell = true;
-      } else if (-token == on_surface) {
-        in_cell = false;
-      } else {
-        // Note the off-by-one indexing
-        bool sense = model::device_surfaces[std::abs(token) - 1].sense(r, u);
-        in_cell = (sense == (token > 0));
-      }
-    } else if ((token == OP_UNION && in_cell == true) ||
-               (token == OP_INTERSECTION && in_cell == false)) {
-      // If the total depth is zero return
-      if (total_depth == 0) {
-        return in_cell;
-      }
-
-      total_depth--;
-
-      // While the iterator is within the bounds of the vector
-      int depth = 1;
-      do {
-        // Get next token
-        it++;
-        int32_t next_token = *it;
-
-        // If the token is an a parenthesis
-        if (next_token > OP_COMPLEMENT) {
-          // Adjust depth accordingly
-          if (next_token == OP_RIGHT_PAREN) {
-            depth--;
-          } else {
-            depth++;
-          }
-        }
-      } while (depth > 0);
-    } else if (token == OP_LEFT_PAREN) {
-      total_depth++;
-    } else if (token == OP_RIGHT_PAREN) {
-      total_depth--;
-    }
+  int slot = i_surf % SIZE;
+  if (surf_[slot] != i_surf) {
+    surf_[slot] = i_surf;
+    sense_[slot] = model::device_surfaces[i_surf].sense(r, u);
   }
-  return in_cell;
+  return sense_[slot];
 }
+#pragma omp end declare target
 
 //==============================================================================
 // DAGMC Cell implementation
@@ -1007,12 +1290,20 @@ DAGCell::DAGCell() : Cell{} { simple_ = true; };
 std::pair<double, int32_t>
 DAGCell::distance(Position r, Direction u, int32_t on_surface, Particle* p) const
 {
+  const auto& bvh {model::device_cell_bvhs[dag_index_ - 1]};
+  if (!bvh.empty()) {
+    BVHHit hit = bvh.ray_fire(r, u);
+    if (hit.triangle == C_NONE) return {INFINITY, -1};
+    return {hit.distance, hit.surface};
+  }
+
   Expects(p);
   // if we've changed direction or we're not on a surface,
   // reset the history and update last direction
-  if (u != p->last_dir_ || on_surface == 0) {
-    p->history_.reset();
-    p->last_dir_ = u;
+  auto& cold = p->cold();
+  if (u != cold.last_dir || on_surface == 0) {
+    cold.history.reset();
+    cold.last_dir = u;
   }
 
   moab::ErrorCode rval;
@@ -1021,7 +1312,7 @@ DAGCell::distance(Position r, Direction u, int32_t on_surface, Particle* p) cons
   double dist;
   double pnt[3] = {r.x, r.y, r.z};
   double dir[3] = {u.x, u.y, u.z};
-  rval = dagmc_ptr_->ray_fire(vol, pnt, dir, hit_surf, dist, &p->history_);
+  rval = dagmc_ptr_->ray_fire(vol, pnt, dir, hit_surf, dist, &cold.history);
   MB_CHK_ERR_CONT(rval);
   int surf_idx;
   if (hit_surf != 0) {
@@ -1037,6 +1328,9 @@ DAGCell::distance(Position r, Direction u, int32_t on_surface, Particle* p) cons
 
 bool DAGCell::contains(Position r, Direction u, int32_t on_surface) const
 {
+  const auto& bvh {model::device_cell_bvhs[dag_index_ - 1]};
+  if (!bvh.empty()) return bvh.contains(r, u);
+
   moab::ErrorCode rval;
   moab::EntityHandle vol = dagmc_ptr_->entity_by_index(3, dag_index_);
 
@@ -1052,6 +1346,9 @@ void DAGCell::to_hdf5(hid_t group_id) const { return; }
 
 BoundingBox DAGCell::bounding_box() const
 {
+  const auto& bvh {model::device_cell_bvhs[dag_index_ - 1]};
+  if (!bvh.empty()) return bvh.bounding_box();
+
   moab::ErrorCode rval;
   moab::EntityHandle vol = dagmc_ptr_->entity_by_index(3, dag_index_);
   double min[3], max[3];
@@ -1066,114 +1363,159 @@ BoundingBox DAGCell::bounding_box() const
 // UniversePartitioner implementation
 //==============================================================================
 
-UniversePartitioner::UniversePartitioner(const Universe& univ)
+namespace {
+
+//! Whether two surfaces belong to the same family of nested surfaces that a
+//! universe can be partitioned by: planes normal to the same axis, cylinders
+//! along the same axis line, or concentric spheres
+bool same_partition_family(const Surface& a, const Surface& b)
+{
+  if (a.type_ != b.type_) return false;
+  switch (a.type_) {
+  case Surface::SurfaceType::SurfaceXPlane:
+  case Surface::SurfaceType::SurfaceYPlane:
+  case Surface::SurfaceType::SurfaceZPlane:
+    return true;
+  case Surface::SurfaceType::SurfaceXCylinder:
+    return a.y0_ == b.y0_ && a.z0_ == b.z0_;
+  case Surface::SurfaceType::SurfaceYCylinder:
+    return a.x0_ == b.x0_ && a.z0_ == b.z0_;
+  case Surface::SurfaceType::SurfaceZCylinder:
+    return a.x0_ == b.x0_ && a.y0_ == b.y0_;
+  case Surface::SurfaceType::SurfaceSphere:
+    return a.x0_ == b.x0_ && a.y0_ == b.y0_ && a.z0_ == b.z0_;
+  default:
+    return false;
+  }
+}
+
+//! Position of a surface within its family. The positive side of a surface
+//! holds every point beyond it, i.e. on the positive side of the surfaces of
+//! the family at lower levels too.
+double partition_level(const Surface& s)
 {
-  // Define an ordered set of surface indices that point to z-planes.  Use a
-  // functor to to order the set by the z0_ values of the corresponding planes.
+  switch (s.type_) {
+  case Surface::SurfaceType::SurfaceXPlane: return s.x0_;
+  case Surface::SurfaceType::SurfaceYPlane: return s.y0_;
+  case Surface::SurfaceType::SurfaceZPlane: return s.z0_;
+  default: return s.radius_;
+  }
+}
+
+//! Partitions of the cells of a universe along one family of surfaces
+struct FamilyPartitions {
+  vector<int32_t> surfs; //!< Surfaces of the family, by increasing level
+  std::vector<std::vector<int32_t>> partitions;
+};
+
+FamilyPartitions partition_by_family(const Universe& univ, int32_t i_first)
+{
+  const auto& first = model::surfaces[i_first];
+
+  // Collect the surfaces of the family, one per level, in increasing order.
+  // A set is used here for the O(log(n)) insertions that will ensure entries
+  // are not repeated.
   struct compare_surfs {
     bool operator()(const int32_t& i_surf, const int32_t& j_surf) const
     {
-      /*
-      const auto* surf = model::surfaces[i_surf].get();
-      const auto* zplane = dynamic_cast<const SurfaceZPlane*>(surf);
-      double zi = zplane->z0_;
-      surf = model::surfaces[j_surf].get();
-      zplane = dynamic_cast<const SurfaceZPlane*>(surf);
-      double zj = zplane->z0_;
-      return zi < zj;
-      */
-      return model::surfaces[i_surf].z0_ < model::surfaces[j_surf].z0_;
+      return partition_level(model::surfaces[i_surf]) <
+        partition_level(model::surfaces[j_surf]);
     }
   };
   std::set<int32_t, compare_surfs> surf_set;
-
-  // Find all of the z-planes in this universe.  A set is used here for the
-  // O(log(n)) insertions that will ensure entries are not repeated.
   for (auto i_cell : univ.cells_) {
-    //for (auto token : model::cells[i_cell]->rpn_) {
     for (auto token : model::cells[i_cell].region_) {
       if (token < OP_UNION) {
         auto i_surf = std::abs(token) - 1;
-        const auto* surf = &model::surfaces[i_surf];
-        //if (const auto* zplane = dynamic_cast<const SurfaceZPlane*>(surf))
-        if( surf->type_ == Surface::SurfaceType::SurfaceZPlane )
+        if (same_partition_family(model::surfaces[i_surf], first)) {
           surf_set.insert(i_surf);
+        }
       }
     }
   }
 
-  // Populate the surfs_ vector from the ordered set.
-  surfs_.insert(surfs_.begin(), surf_set.begin(), surf_set.end());
+  FamilyPartitions fp;
+  fp.surfs.insert(fp.surfs.begin(), surf_set.begin(), surf_set.end());
+  int n_surfs = fp.surfs.size();
+  std::vector<double> levels;
+  for (auto i_surf : fp.surfs) {
+    levels.push_back(partition_level(model::surfaces[i_surf]));
+  }
 
-  // Populate the partition lists.
-  partitions_.resize(surfs_.size() + 1);
+  // Populate the partition lists. There are n+1 partitions with n surfaces.
+  fp.partitions.resize(n_surfs + 1);
   for (auto i_cell : univ.cells_) {
+    const auto& cell = model::cells[i_cell];
+
     // It is difficult to determine the bounds of a complex cell, so add complex
     // cells to all partitions.
-    //if (!model::cells[i_cell]->simple_) {
-    if (!model::cells[i_cell].simple_) {
-      for (auto& p : partitions_) p.push_back(i_cell);
+    if (!cell.simple_) {
+      for (auto& p : fp.partitions) p.push_back(i_cell);
       continue;
     }
 
-    // Find the tokens for bounding z-planes.
-    int32_t lower_token = 0, upper_token = 0;
-    double min_z, max_z;
-    //for (auto token : model::cells[i_cell]->rpn_) {
-    for (auto token : model::cells[i_cell].region_) {
-      if (token < OP_UNION) {
-        const auto* surf = &model::surfaces[std::abs(token) - 1];
-        //if (const auto* zplane = dynamic_cast<const SurfaceZPlane*>(surf)) {
-        if( surf->type_ == Surface::SurfaceType::SurfaceZPlane )
-        {
-          const auto* zplane = surf;
-          if (lower_token == 0 || zplane->z0_ < min_z) {
-            lower_token = token;
-            min_z = zplane->z0_;
-          }
-          if (upper_token == 0 || zplane->z0_ > max_z) {
-            upper_token = token;
-            max_z = zplane->z0_;
-          }
-        }
+    // The cell lies beyond the highest surface of the family whose positive
+    // side it is on, and before the lowest one whose negative side it is on.
+    // Surfaces at the same level as one in the set are the same surface.
+    int first_partition = 0;
+    int last_partition = n_surfs;
+    for (auto token : cell.region_) {
+      const auto& surf = model::surfaces[std::abs(token) - 1];
+      if (!same_partition_family(surf, first)) continue;
+      int i = std::lower_bound(levels.begin(), levels.end(),
+        partition_level(surf)) - levels.begin();
+      if (token > 0) {
+        first_partition = std::max(first_partition, i + 1);
+      } else {
+        last_partition = std::min(last_partition, i);
       }
     }
 
-    // If there are no bounding z-planes, add this cell to all partitions.
-    if (lower_token == 0) {
-      for (auto& p : partitions_) p.push_back(i_cell);
-      continue;
+    // Add the cell to all relevant partitions.
+    for (int i = first_partition; i <= last_partition; ++i) {
+      fp.partitions[i].push_back(i_cell);
     }
+  }
+  return fp;
+}
 
-    // Find the first partition this cell lies in.  If the lower_token indicates
-    // a negative halfspace, then the cell is unbounded in the lower direction
-    // and it lies in the first partition onward.  Otherwise, it is bounded by
-    // the positive halfspace given by the lower_token.
-    int first_partition = 0;
-    if (lower_token > 0) {
-      for (int i = 0; i < surfs_.size(); ++i) {
-        if (lower_token == surfs_[i] + 1) {
-          first_partition = i + 1;
-          break;
-        }
-      }
-    }
+} // namespace
 
-    // Find the last partition this cell lies in.  The logic is analogous to the
-    // logic for first_partition.
-    int last_partition = surfs_.size();
-    if (upper_token < 0) {
-      for (int i = first_partition; i < surfs_.size(); ++i) {
-        if (upper_token == -(surfs_[i] + 1)) {
-          last_partition = i;
+UniversePartitioner::UniversePartitioner(const Universe& univ)
+{
+  // Find one surface of each family that bounds cells of this universe
+  std::vector<int32_t> families;
+  for (auto i_cell : univ.cells_) {
+    for (auto token : model::cells[i_cell].region_) {
+      if (token >= OP_UNION) continue;
+      auto i_surf = std::abs(token) - 1;
+      const auto& surf = model::surfaces[i_surf];
+
+      // Skip surfaces that don't form families, such as general planes
+      if (!same_partition_family(surf, surf)) continue;
+      bool known = false;
+      for (auto j_surf : families) {
+        if (same_partition_family(model::surfaces[j_surf], surf)) {
+          known = true;
           break;
         }
       }
+      if (!known) families.push_back(i_surf);
     }
+  }
 
-    // Add the cell to all relevant partitions.
-    for (int i = first_partition; i <= last_partition; ++i) {
-      partitions_[i].push_back(i_cell);
+  // Partition by the family that leaves the fewest cells to search in a
+  // partition, on average
+  double best = INFTY;
+  for (auto i_surf : families) {
+    auto fp = partition_by_family(univ, i_surf);
+    size_t n_listed = 0;
+    for (const auto& p : fp.partitions) n_listed += p.size();
+    double average = static_cast<double>(n_listed) / fp.partitions.size();
+    if (average < best) {
+      best = average;
+      surfs_ = std::move(fp.surfs);
+      partitions_ = std::move(fp.partitions);
     }
   }
 }
@@ -1256,23 +1598,12 @@ void UniversePartitioner::allocate_and_copy_to_device()
 // Non-method functions
 //==============================================================================
 
-void read_cells(pugi::xml_node node)
-{
-  // Count the number of cells.
-  int n_cells = 0;
-  for (pugi::xml_node cell_node: node.children("cell")) {n_cells++;}
-  if (n_cells == 0) {
-    fatal_error("No cells found in geometry.xml!");
-  }
-
-  // Loop over XML cell elements and populate the array.
-  model::cells.reserve(n_cells);
-  for (pugi::xml_node cell_node : node.children("cell")) {
-    //model::cells.push_back(std::make_unique<CSGCell>(cell_node));
-    //model::cells.push_back(cell_node);
-    model::cells.emplace_back(cell_node);
-  }
+namespace {
 
+//! Map the IDs of the cells, gather them into universes and allocate the
+//! overlap counts. Shared by the XML and HDF5 readers.
+void finish_cells()
+{
   // Fill the cell map.
   for (int i = 0; i < model::cells.size(); i++) {
     //int32_t id = model::cells[i]->id_;
@@ -1309,6 +1640,89 @@ void read_cells(pugi::xml_node node)
   }
 }
 
+} // namespace
+
+void read_cells(pugi::xml_node node)
+{
+  // Collect the cell elements so that they can be read in parallel
+  std::vector<pugi::xml_node> cell_nodes;
+  for (pugi::xml_node cell_node: node.children("cell")) {
+    cell_nodes.push_back(cell_node);
+  }
+  int n_cells = cell_nodes.size();
+  if (n_cells == 0) {
+    fatal_error("No cells found in geometry.xml!");
+  }
+
+  // Construct the cells from their XML elements. Cells only look up surfaces
+  // while being constructed, so this is safe on several threads. An error in
+  // any cell is rethrown once all threads are done.
+  model::cells.resize(n_cells);
+  std::string error;
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (int i = 0; i < n_cells; ++i) {
+    try {
+      model::cells[i] = Cell(cell_nodes[i]);
+    } catch (const std::exception& e) {
+      #pragma omp critical(read_cells)
+      if (error.empty()) error = e.what();
+    }
+  }
+  if (!error.empty()) throw std::runtime_error{error};
+
+  finish_cells();
+}
+
+void read_cells_hdf5(hid_t file_id)
+{
+  hid_t group = open_group(file_id, "cells");
+  std::vector<int32_t> ids;
+  std::vector<std::string> names;
+  std::vector<int32_t> universes;
+  std::vector<int32_t> fills;
+  read_dataset(group, "id", ids);
+  read_dataset(group, "name", names);
+  read_dataset(group, "universe", universes);
+  read_dataset(group, "fill", fills);
+  RaggedDataset<char> regions {group, "region"};
+  RaggedDataset<int32_t> materials {group, "material"};
+  RaggedDataset<double> temperatures {group, "temperature"};
+  RaggedDataset<double> translations {group, "translation"};
+  RaggedDataset<double> rotations {group, "rotation"};
+  close_group(group);
+
+  int n_cells = ids.size();
+  if (n_cells == 0) {
+    fatal_error("No cells found in geometry.h5!");
+  }
+  if (names.size() != n_cells || universes.size() != n_cells ||
+      fills.size() != n_cells || regions.size() != n_cells ||
+      materials.size() != n_cells || temperatures.size() != n_cells ||
+      translations.size() != n_cells || rotations.size() != n_cells) {
+    fatal_error("The cell datasets of geometry.h5 differ in length.");
+  }
+
+  // Construct the cells from their rows, as read_cells() does from elements
+  model::cells.resize(n_cells);
+  std::string error;
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (int i = 0; i < n_cells; ++i) {
+    try {
+      auto region = regions.row(i);
+      model::cells[i] = Cell(ids[i], names[i], universes[i], fills[i],
+        materials.row(i), temperatures.row(i),
+        std::string {region.begin(), region.end()}, translations.row(i),
+        rotations.row(i));
+    } catch (const std::exception& e) {
+      #pragma omp critical(read_cells)
+      if (error.empty()) error = e.what();
+    }
+  }
+  if (!error.empty()) throw std::runtime_error{error};
+
+  finish_cells();
+}
+
 //==============================================================================
 // C-API functions
 //==============================================================================
@@ -1340,6 +1754,7 @@ openmc_cell_set_fill(int32_t index, int type, int32_t n,
   Fill filltype = static_cast<Fill>(type);
   if (index >= 0 && index < model::cells.size()) {
     Cell& c {model::cells[index]};
+    mark_cell_changed(index, filltype == Fill::MATERIAL);
     if (filltype == Fill::MATERIAL) {
       c.type_ = Fill::MATERIAL;
       c.material_.clear();
@@ -1386,6 +1801,44 @@ openmc_cell_set_temperature(int32_t index, double T, const int32_t* instance, bo
   return 0;
 }
 
+extern "C" int
+openmc_cells_set_temperatures(int n, const int32_t* index,
+  const int32_t* instance, const double* T)
+{
+  // Check every update first so that an invalid one leaves no cell changed
+  for (int i = 0; i < n; ++i) {
+    if (index[i] < 0 || index[i] >= model::cells.size()) {
+      set_errmsg("Index in cells array is out of bounds.");
+      return OPENMC_E_OUT_OF_BOUNDS;
+    }
+    const auto& c = model::cells[index[i]];
+    if (c.type_ != Fill::MATERIAL) {
+      set_errmsg(fmt::format("Attempted to set the temperature of cell {} "
+        "which is not filled by a material.", c.id_));
+      return OPENMC_E_INVALID_TYPE;
+    }
+    if (instance && instance[i] >= c.n_instances_) {
+      set_errmsg(fmt::format("Instance {} of cell {} is out of bounds.",
+        instance[i], c.id_));
+      return OPENMC_E_OUT_OF_BOUNDS;
+    }
+  }
+
+  try {
+    for (int i = 0; i < n; ++i) {
+      int32_t instance_index = instance ? instance[i] : -1;
+      model::cells[index[i]].set_temperature(T[i], instance_index);
+    }
+  } catch (const std::exception& e) {
+    set_errmsg(e.what());
+    return OPENMC_E_UNASSIGNED;
+  }
+
+  // Send the temperatures of each changed cell to device once
+  update_cells_on_device();
+  return 0;
+}
+
 extern "C" int
 openmc_cell_get_temperature(int32_t index, const int32_t* instance, double* T)
 {
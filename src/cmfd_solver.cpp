@@ -1,5 +1,6 @@
 #include "openmc/cmfd_solver.h"
 
+#include <algorithm> // for copy
 #include <vector>
 #include <cmath>
 
@@ -31,13 +32,23 @@ std::vector<int> indptr;
 
 std::vector<int> indices;
 
+std::vector<int> diagonal;
+
+std::vector<double> x_old;
+
+vector<double> krylov_work;
+
+CmfdSolver solver;
+
+bool on_device;
+
 int dim;
 
 double spectral;
 
 int nx, ny, nz, ng;
 
-xt::xtensor<int, 2> indexmap;
+std::vector<int> color_rows[2];
 
 int use_all_threads;
 
@@ -90,6 +101,7 @@ xt::xtensor<double, 1> count_bank_sites(xt::xtensor<int, 1>& bins, bool* outside
   xt::xarray<double> cnt {cnt_shape, 0.0};
   bool outside_ = false;
 
+  update_source_bank_host();
   auto bank_size = simulation::source_bank.size();
   for (int i = 0; i < bank_size; i++) {
     const auto& site = simulation::source_bank[i];
@@ -147,6 +159,7 @@ extern "C"
 void openmc_cmfd_reweight(const bool feedback, const double* cmfd_src)
 {
   // Get size of source bank and cmfd_src
+  update_source_bank_host();
   auto bank_size = simulation::source_bank.size();
   std::size_t src_size = cmfd::nx * cmfd::ny * cmfd::nz * cmfd::ng;
 
@@ -235,19 +248,6 @@ void openmc_initialize_mesh_egrid(const int meshtally_id, const int* cmfd_indice
   }
 }
 
-//==============================================================================
-// MATRIX_TO_INDICES converts a matrix index to spatial and group
-// indices
-//==============================================================================
-
-void matrix_to_indices(int irow, int& g, int& i, int& j, int& k)
-{
-  g = irow % cmfd::ng;
-  i = cmfd::indexmap(irow/cmfd::ng, 0);
-  j = cmfd::indexmap(irow/cmfd::ng, 1);
-  k = cmfd::indexmap(irow/cmfd::ng, 2);
-}
-
 //==============================================================================
 // GET_DIAGONAL_INDEX returns the index in CSR index array corresponding to
 // the diagonal element of a specified row
@@ -265,7 +265,8 @@ int get_diagonal_index(int row)
 }
 
 //==============================================================================
-// SET_INDEXMAP sets the elements of indexmap based on input coremap
+// SET_INDEXMAP sorts the first matrix row of each accelerated region into
+// red and black by the parity of its spatial indices, based on input coremap
 //==============================================================================
 
 void set_indexmap(const int* coremap)
@@ -276,9 +277,7 @@ void set_indexmap(const int* coremap)
         int idx = (z*cmfd::ny*cmfd::nx) + (y*cmfd::nx) + x;
         if (coremap[idx] != CMFD_NOACCEL) {
           int counter = coremap[idx];
-          cmfd::indexmap(counter, 0) = x;
-          cmfd::indexmap(counter, 1) = y;
-          cmfd::indexmap(counter, 2) = z;
+          cmfd::color_rows[(x+y+z) % 2].push_back(counter*cmfd::ng);
         }
       }
     }
@@ -300,22 +299,21 @@ int cmfd_linsolver_1g(const double* A_data, const double* b, double* x,
     double err = 0.0;
 
     // Copy over x vector
-    std::vector<double> tmpx {x, x+cmfd::dim};
+    std::copy(x, x + cmfd::dim, cmfd::x_old.begin());
+    const auto& tmpx = cmfd::x_old;
 
     // Perform red/black Gauss-Seidel iterations
     for (int irb = 0; irb < 2; irb++) {
 
-      // Loop around matrix rows
+      // Loop around matrix rows of the current color
+      const auto& rows = cmfd::color_rows[irb];
+      int n_rows = rows.size();
       #pragma omp parallel for reduction (+:err) if(cmfd::use_all_threads)
-      for (int irow = 0; irow < cmfd::dim; irow++) {
-        int g, i, j, k;
-        matrix_to_indices(irow, g, i, j, k);
-
-        // Filter out black cells
-        if ((i+j+k) % 2 != irb) continue;
+      for (int n = 0; n < n_rows; n++) {
+        int irow = rows[n];
 
         // Get index of diagonal for current row
-        int didx = get_diagonal_index(irow);
+        int didx = cmfd::diagonal[irow];
 
         // Perform temporary sums, first do left of diag, then right of diag
         double tmp1 = 0.0;
@@ -367,23 +365,22 @@ int cmfd_linsolver_2g(const double* A_data, const double* b, double* x,
     double err = 0.0;
 
     // Copy over x vector
-    std::vector<double> tmpx {x, x+cmfd::dim};
+    std::copy(x, x + cmfd::dim, cmfd::x_old.begin());
+    const auto& tmpx = cmfd::x_old;
 
     // Perform red/black Gauss-Seidel iterations
     for (int irb = 0; irb < 2; irb++) {
 
-      // Loop around matrix rows
+      // Loop around the first matrix row of each region of the current color
+      const auto& rows = cmfd::color_rows[irb];
+      int n_rows = rows.size();
       #pragma omp parallel for reduction (+:err) if(cmfd::use_all_threads)
-      for (int irow = 0; irow < cmfd::dim; irow+=2) {
-        int g, i, j, k;
-        matrix_to_indices(irow, g, i, j, k);
-
-        // Filter out black cells
-        if ((i+j+k) % 2 != irb) continue;
+      for (int n = 0; n < n_rows; n++) {
+        int irow = rows[n];
 
         // Get index of diagonals for current row and next row
-        int d1idx = get_diagonal_index(irow);
-        int d2idx = get_diagonal_index(irow+1);
+        int d1idx = cmfd::diagonal[irow];
+        int d2idx = cmfd::diagonal[irow+1];
 
         // Get block diagonal
         double m11 = A_data[d1idx];     // group 1 diagonal
@@ -459,12 +456,13 @@ int cmfd_linsolver_ng(const double* A_data, const double* b, double* x,
     double err = 0.0;
 
     // Copy over x vector
-    std::vector<double> tmpx {x, x+cmfd::dim};
+    std::copy(x, x + cmfd::dim, cmfd::x_old.begin());
+    const auto& tmpx = cmfd::x_old;
 
     // Loop around matrix rows
     for (int irow = 0; irow < cmfd::dim; irow++) {
       // Get index of diagonal for current row
-      int didx = get_diagonal_index(irow);
+      int didx = cmfd::diagonal[irow];
 
       // Perform temporary sums, first do left of diag, then right of diag
       double tmp1 = 0.0;
@@ -500,6 +498,143 @@ int cmfd_linsolver_ng(const double* A_data, const double* b, double* x,
   return -1;
 }
 
+//==============================================================================
+// Kernels of the BiCGSTAB solver. Each runs on the device when the solver was
+// initialized for it and otherwise on the host threads.
+//==============================================================================
+
+namespace {
+
+// Number of work vectors of length cmfd::dim used by BiCGSTAB
+constexpr int N_KRYLOV_VECTORS {9};
+
+//! Compute y = A*x for the loss matrix with CSR values A_data
+void csr_multiply(const double* A_data, const double* x, double* y)
+{
+  const int* indptr = cmfd::indptr.data();
+  const int* indices = cmfd::indices.data();
+  int n = cmfd::dim;
+  bool threaded = cmfd::on_device || cmfd::use_all_threads;
+  #pragma omp target teams distribute parallel for if(target: cmfd::on_device) if(parallel: threaded)
+  for (int i = 0; i < n; i++) {
+    double sum = 0.0;
+    for (int j = indptr[i]; j < indptr[i+1]; j++)
+      sum += A_data[j] * x[indices[j]];
+    y[i] = sum;
+  }
+}
+
+//! Inner product of two vectors of length cmfd::dim
+double dot(const double* a, const double* b)
+{
+  int n = cmfd::dim;
+  bool threaded = cmfd::on_device || cmfd::use_all_threads;
+  double sum = 0.0;
+  #pragma omp target teams distribute parallel for reduction(+:sum) map(tofrom: sum) if(target: cmfd::on_device) if(parallel: threaded)
+  for (int i = 0; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+} // namespace
+
+//==============================================================================
+// CMFD_LINSOLVER_BICGSTAB solves a CMFD linear system with any number of
+// groups by the stabilized biconjugate gradient method, right-preconditioned
+// by the inverse of the diagonal. It converges when the 2-norm of the residual
+// is below tol times that of b.
+//==============================================================================
+
+int cmfd_linsolver_bicgstab(const double* A_data, const double* b, double* x,
+                            double tol)
+{
+  int n = cmfd::dim;
+  int nnz = cmfd::indices.size();
+  const int* diagonal = cmfd::diagonal.data();
+  bool threaded = cmfd::on_device || cmfd::use_all_threads;
+
+  // Work vectors, allocated once by openmc_initialize_linsolver
+  double* inv_diag = cmfd::krylov_work.data();
+  double* r = inv_diag + n;     // residual
+  double* r0 = r + n;           // shadow residual
+  double* p = r0 + n;           // search direction
+  double* v = p + n;            // A times preconditioned p
+  double* s = v + n;            // intermediate residual
+  double* t = s + n;            // A times preconditioned s
+  double* p_hat = t + n;        // preconditioned p
+  double* s_hat = p_hat + n;    // preconditioned s
+
+  int n_iter = -1;
+  #pragma omp target data map(to: A_data[:nnz], b[:n]) map(tofrom: x[:n]) if(cmfd::on_device)
+  {
+    // Jacobi preconditioner and initial residual
+    csr_multiply(A_data, x, r);
+    #pragma omp target teams distribute parallel for if(target: cmfd::on_device) if(parallel: threaded)
+    for (int i = 0; i < n; i++) {
+      inv_diag[i] = 1.0 / A_data[diagonal[i]];
+      r[i] = b[i] - r[i];
+      r0[i] = r[i];
+      p[i] = 0.0;
+      v[i] = 0.0;
+    }
+
+    double norm_b = std::sqrt(dot(b, b));
+    if (norm_b == 0.0) norm_b = 1.0;
+    double rho = 1.0;
+    double alpha = 1.0;
+    double omega = 1.0;
+
+    // The initial guess may already solve the system, as the converged flux
+    // of the last batch does. Its residual then vanishes and the loop below
+    // would stop at once on rho = 0.
+    if (std::sqrt(dot(r, r)) < tol * norm_b) n_iter = 0;
+
+    for (int it = 1; n_iter < 0 && it <= 10000; it++) {
+      double rho_new = dot(r0, r);
+      if (rho_new == 0.0) break;
+      double beta = (rho_new / rho) * (alpha / omega);
+      rho = rho_new;
+
+      #pragma omp target teams distribute parallel for if(target: cmfd::on_device) if(parallel: threaded)
+      for (int i = 0; i < n; i++) {
+        p[i] = r[i] + beta * (p[i] - omega * v[i]);
+        p_hat[i] = inv_diag[i] * p[i];
+      }
+      csr_multiply(A_data, p_hat, v);
+      alpha = rho / dot(r0, v);
+
+      #pragma omp target teams distribute parallel for if(target: cmfd::on_device) if(parallel: threaded)
+      for (int i = 0; i < n; i++) {
+        s[i] = r[i] - alpha * v[i];
+        s_hat[i] = inv_diag[i] * s[i];
+      }
+      csr_multiply(A_data, s_hat, t);
+      double tt = dot(t, t);
+      omega = (tt > 0.0) ? dot(t, s) / tt : 0.0;
+
+      #pragma omp target teams distribute parallel for if(target: cmfd::on_device) if(parallel: threaded)
+      for (int i = 0; i < n; i++) {
+        x[i] += alpha * p_hat[i] + omega * s_hat[i];
+        r[i] = s[i] - omega * t[i];
+      }
+
+      // Check convergence
+      if (std::sqrt(dot(r, r)) < tol * norm_b) {
+        n_iter = it;
+        break;
+      }
+
+      // A vanishing step cannot make further progress
+      if (omega == 0.0) break;
+    }
+  }
+
+  if (n_iter < 0)
+    fatal_error("CMFD BiCGSTAB solver did not converge.");
+
+  return n_iter;
+}
+
 //==============================================================================
 // OPENMC_INITIALIZE_LINSOLVER sets the fixed variables that are used for the
 // linear solver
@@ -509,40 +644,61 @@ extern "C"
 void openmc_initialize_linsolver(const int* indptr, int len_indptr,
                                  const int* indices, int n_elements, int dim,
                                  double spectral, const int* map,
-                                 bool use_all_threads)
+                                 bool use_all_threads, int solver,
+                                 bool on_device)
 {
-  // Store elements of indptr
-  for (int i = 0; i < len_indptr; i++)
-    cmfd::indptr.push_back(indptr[i]);
-
-  // Store elements of indices
-  for (int i = 0; i < n_elements; i++)
-    cmfd::indices.push_back(indices[i]);
+  // Store elements of indptr and indices
+  cmfd::indptr.assign(indptr, indptr + len_indptr);
+  cmfd::indices.assign(indices, indices + n_elements);
 
   // Set dimenion of CMFD problem and specral radius
   cmfd::dim = dim;
   cmfd::spectral = spectral;
 
-  // Set indexmap if 1 or 2 group problem
+  // Sort rows into red and black if 1 or 2 group problem
   if (cmfd::ng == 1 || cmfd::ng == 2) {
-    // Resize indexmap and set its elements
-    cmfd::indexmap.resize({static_cast<size_t>(dim), 3});
     set_indexmap(map);
   }
 
   // Use all threads allocated to OpenMC simulation to run CMFD solver
   cmfd::use_all_threads = use_all_threads;
+
+  // Find the diagonal of each row once rather than on every sweep
+  cmfd::diagonal.resize(dim);
+  for (int i = 0; i < dim; i++)
+    cmfd::diagonal[i] = get_diagonal_index(i);
+
+  cmfd::solver = static_cast<CmfdSolver>(solver);
+  if (cmfd::solver == CmfdSolver::bicgstab) {
+    cmfd::krylov_work.resize(N_KRYLOV_VECTORS * dim);
+
+    // The structure of the matrix stays on the device for every solve; only
+    // its values and the vectors are copied each time
+    cmfd::on_device = on_device;
+    if (cmfd::on_device) {
+      int* indptr_d = cmfd::indptr.data();
+      int* indices_d = cmfd::indices.data();
+      int* diagonal_d = cmfd::diagonal.data();
+      #pragma omp target enter data map(to: indptr_d[:len_indptr], indices_d[:n_elements], diagonal_d[:dim])
+      cmfd::krylov_work.allocate_on_device();
+    }
+  } else {
+    cmfd::x_old.resize(dim);
+  }
 }
 
 //==============================================================================
-// OPENMC_RUN_LINSOLVER runs a Gauss Seidel linear solver to solve CMFD matrix
-// equations
+// OPENMC_RUN_LINSOLVER runs the linear solver chosen in
+// openmc_initialize_linsolver to solve CMFD matrix equations
 //==============================================================================
 
 extern "C"
 int openmc_run_linsolver(const double* A_data, const double* b, double* x,
                          double tol)
 {
+  if (cmfd::solver == CmfdSolver::bicgstab)
+    return cmfd_linsolver_bicgstab(A_data, b, x, tol);
+
   switch (cmfd::ng) {
   case 1:
     return cmfd_linsolver_1g(A_data, b, x, tol);
@@ -555,13 +711,28 @@ int openmc_run_linsolver(const double* A_data, const double* b, double* x,
 
 void free_memory_cmfd()
 {
+  // Release the solver's device copies
+  if (cmfd::on_device) {
+    int* indptr_d = cmfd::indptr.data();
+    int* indices_d = cmfd::indices.data();
+    int* diagonal_d = cmfd::diagonal.data();
+    int len_indptr = cmfd::indptr.size();
+    int n_elements = cmfd::indices.size();
+    int n = cmfd::diagonal.size();
+    #pragma omp target exit data map(release: indptr_d[:len_indptr], indices_d[:n_elements], diagonal_d[:n])
+    cmfd::krylov_work.release_device();
+    cmfd::on_device = false;
+  }
+
   // Clear std::vectors
   cmfd::indptr.clear();
   cmfd::indices.clear();
+  cmfd::diagonal.clear();
+  cmfd::x_old.clear();
+  cmfd::krylov_work.clear();
   cmfd::egrid.clear();
-
-  // Resize xtensors to be empty
-  cmfd::indexmap.resize({0});
+  cmfd::color_rows[0].clear();
+  cmfd::color_rows[1].clear();
 
   // Set pointers to null
   cmfd::mesh = nullptr;
@@ -0,0 +1,335 @@
+//! \file collision_benchmark.cpp
+//! \brief Neutron collision physics alone, on synthetic particle states, with
+//! the sampling kernels and options of a real run
+
+#include <algorithm> // for min, max
+#include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <fmt/core.h>
+
+#include "openmc/bank.h"
+#include "openmc/capi.h"
+#include "openmc/constants.h"
+#include "openmc/error.h"
+#include "openmc/event.h"
+#include "openmc/math_functions.h"
+#include "openmc/message_passing.h"
+#include "openmc/microbenchmark.h"
+#include "openmc/nuclide.h"
+#include "openmc/output.h"
+#include "openmc/particle.h"
+#include "openmc/physics.h"
+#include "openmc/random_lcg.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+#include "openmc/timer.h"
+
+namespace openmc {
+
+namespace {
+
+using CollisionClass = Particle::CollisionClass;
+
+// Parts of a collision timed separately: the sampling of the nuclide and
+// reaction, which includes absorption and the banking of fission sites, and
+// the secondary distributions of each class of scattering
+constexpr int N_COLLISION_PARTS {4};
+constexpr const char* PART_NAMES[N_COLLISION_PARTS] {"Reaction sampling",
+  "Elastic scattering", "S(a,b) scattering", "Inelastic scattering"};
+
+// Spectrum energies are drawn from: a third each of a U-235 Watt fission
+// spectrum, a 1/E slowing-down spectrum and a Maxwellian at the temperature of
+// the material, like the flux of a thermal reactor
+constexpr double WATT_A {0.988e6};   // [eV]
+constexpr double WATT_B {2.249e-6};  // [1/eV]
+constexpr double SLOWING_DOWN_MIN {1.0};   // [eV]
+constexpr double SLOWING_DOWN_MAX {1.0e5}; // [eV]
+
+struct CollisionTotals {
+  double seconds[N_COLLISION_PARTS] {};
+  int64_t samples[N_COLLISION_PARTS] {};
+  int64_t absorptions {0};
+  int64_t fissions {0};   //!< Collisions that banked fission sites
+};
+
+#pragma omp declare target
+//! Put a neutron in a random site, with an energy from a reactor-like spectrum,
+//! an isotropic direction and the cross sections of its material
+void sample_collision_state(Particle& p, int64_t id, const int* material,
+  const int* cell, const double* sqrtkT, int n_sites, double E_min,
+  double E_max, bool need_depletion_rx)
+{
+  sample_benchmark_site(p, id, material, cell, sqrtkT, n_sites);
+  uint64_t* seed = p.current_seed();
+  double xi = prn(seed);
+  double E;
+  if (xi < 1.0 / 3.0) {
+    E = watt_spectrum(WATT_A, WATT_B, seed);
+  } else if (xi < 2.0 / 3.0) {
+    E = SLOWING_DOWN_MIN * std::exp(prn(seed) *
+      std::log(SLOWING_DOWN_MAX / SLOWING_DOWN_MIN));
+  } else {
+    E = maxwell_spectrum(p.sqrtkT_ * p.sqrtkT_, seed);
+  }
+  p.E_ = std::min(std::max(E, E_min), E_max);
+  p.E_last_ = p.E_;
+
+  double mu = 2.0 * prn(seed) - 1.0;
+  double phi = 2.0 * PI * prn(seed);
+  double s = std::sqrt(1.0 - mu * mu);
+  p.u() = {mu, s * std::cos(phi), s * std::sin(phi)};
+  p.mu_ = 0.0;
+
+  // Nothing is left of any earlier collision of the particle
+  p.fission_ = false;
+  p.n_collision_ = 0;
+  p.n_bank_ = 0;
+  p.n_bank_second_ = 0;
+  p.wgt_bank_ = 0.0;
+  for (int& v : p.n_delayed_bank_) v = 0;
+  p.n_progeny_ = 0;
+  p.secondary_bank_length_ = 0;
+  p.material_last_ = C_NONE;
+  p.stream_ = STREAM_TRACKING;
+
+  p.event_calculate_xs_execute(need_depletion_rx);
+}
+
+//! Which part of a collision a particle with a sampled reaction goes on to,
+//! or -1 if its collision is complete
+int collision_part(const Particle& p)
+{
+  switch (p.collision_class_) {
+  case CollisionClass::elastic:
+    return 1;
+  case CollisionClass::sab:
+    return 2;
+  case CollisionClass::inelastic:
+    return 3;
+  default:
+    return -1;
+  }
+}
+#pragma omp end declare target
+
+//! Sample n collisions on device, one particle buffer at a time, timing each
+//! part of the collisions in its own kernel
+void event_collisions(int64_t n, const BenchmarkSites& sites, double E_min,
+  double E_max, CollisionTotals& totals)
+{
+  const int* material = sites.material.data();
+  const int* cell = sites.cell.data();
+  const double* sqrtkT = sites.sqrtkT.data();
+  int n_sites = sites.size();
+  bool need_depletion_rx = depletion_rx_check();
+  int64_t offset = static_cast<int64_t>(mpi::rank) * n;
+
+  // Fission sites are discarded after every buffer, which must hold them all
+  int64_t n_buffer = std::min<int64_t>(simulation::particles.size(),
+    simulation::fission_bank.capacity() / 3);
+
+  std::vector<Timer> timers(N_COLLISION_PARTS);
+  for (int64_t first = 0; first < n; first += n_buffer) {
+    int n_items = std::min(n_buffer, n - first);
+    #pragma omp target teams distribute parallel for \
+      map(to: material[:n_sites], cell[:n_sites], sqrtkT[:n_sites])
+    for (int i = 0; i < n_items; ++i) {
+      sample_collision_state(simulation::device_particles[i],
+        offset + first + i + 1, material, cell, sqrtkT, n_sites, E_min, E_max,
+        need_depletion_rx);
+    }
+
+    timers[0].start();
+    #pragma omp target teams distribute parallel for
+    for (int i = 0; i < n_items; ++i) {
+      sample_collision(simulation::device_particles[i]);
+    }
+    timers[0].stop();
+    totals.samples[0] += n_items;
+
+    int64_t counts[N_COLLISION_PARTS] {};
+    int64_t absorptions = 0;
+    int64_t fissions = 0;
+    #pragma omp target teams distribute parallel for \
+      reduction(+: counts[:N_COLLISION_PARTS], absorptions, fissions)
+    for (int i = 0; i < n_items; ++i) {
+      const Particle& p = simulation::device_particles[i];
+      int part = collision_part(p);
+      if (part > 0) ++counts[part];
+      if (!p.alive()) ++absorptions;
+      if (p.fission_) ++fissions;
+    }
+    totals.absorptions += absorptions;
+    totals.fissions += fissions;
+
+    // Each class of scattering is finished by its own launch, which skips the
+    // particles of other classes
+    for (int part = 1; part < N_COLLISION_PARTS; ++part) {
+      if (counts[part] == 0) continue;
+      timers[part].start();
+      #pragma omp target teams distribute parallel for
+      for (int i = 0; i < n_items; ++i) {
+        Particle& p = simulation::device_particles[i];
+        if (collision_part(p) == part) finish_collision(p);
+      }
+      timers[part].stop();
+      totals.samples[part] += counts[part];
+    }
+
+    simulation::fission_bank.resize(0);
+    simulation::fission_spill.resize(0);
+  }
+  for (int i = 0; i < N_COLLISION_PARTS; ++i) {
+    totals.seconds[i] = timers[i].elapsed();
+  }
+}
+
+//! Sample n collisions on host threads, each with its own particle, timing
+//! each part of every collision
+void host_collisions(int64_t n, const BenchmarkSites& sites, double E_min,
+  double E_max, CollisionTotals& totals)
+{
+  const int* material = sites.material.data();
+  const int* cell = sites.cell.data();
+  const double* sqrtkT = sites.sqrtkT.data();
+  int n_sites = sites.size();
+  bool need_depletion_rx = depletion_rx_check();
+  int64_t offset = static_cast<int64_t>(mpi::rank) * n;
+  int64_t n_block = simulation::fission_bank.capacity() / 3;
+
+  int n_threads = 1;
+  for (int64_t first = 0; first < n; first += n_block) {
+    int64_t n_items = std::min(n_block, n - first);
+    #pragma omp parallel
+    {
+      Particle p;
+      p.neutron_xs_.assign(omp_get_thread_num());
+      p.assign_flux_derivs(omp_get_thread_num());
+      p.assign_nuclide_cdf(omp_get_thread_num());
+      p.assign_depletion_rx(omp_get_thread_num());
+      p.assign_photon_xs(omp_get_thread_num());
+      p.assign_nu_bank(omp_get_thread_num());
+      std::vector<Timer> timers(N_COLLISION_PARTS);
+      CollisionTotals mine;
+
+      #pragma omp for schedule(static)
+      for (int64_t i = 0; i < n_items; ++i) {
+        sample_collision_state(p, offset + first + i + 1, material, cell,
+          sqrtkT, n_sites, E_min, E_max, need_depletion_rx);
+        timers[0].start();
+        sample_collision(p);
+        timers[0].stop();
+        ++mine.samples[0];
+        if (!p.alive()) ++mine.absorptions;
+        if (p.fission_) ++mine.fissions;
+
+        int part = collision_part(p);
+        if (part > 0) {
+          timers[part].start();
+          finish_collision(p);
+          timers[part].stop();
+          ++mine.samples[part];
+        }
+      }
+
+      #pragma omp critical(collision_totals)
+      {
+        n_threads = omp_get_num_threads();
+        for (int i = 0; i < N_COLLISION_PARTS; ++i) {
+          totals.seconds[i] += timers[i].elapsed();
+          totals.samples[i] += mine.samples[i];
+        }
+        totals.absorptions += mine.absorptions;
+        totals.fissions += mine.fissions;
+      }
+    }
+    simulation::fission_bank.resize(0);
+    simulation::fission_spill.resize(0);
+  }
+
+  // Threads time their own samples, so the wall time of each part is its
+  // thread time shared out over the threads
+  for (double& s : totals.seconds) s /= n_threads;
+}
+
+} // namespace
+
+} // namespace openmc
+
+//==============================================================================
+// C API
+//==============================================================================
+
+int openmc_collision_benchmark()
+{
+  using namespace openmc;
+
+  if (!settings::run_CE) {
+    set_errmsg("The collision benchmark requires continuous-energy data.");
+    return OPENMC_E_INVALID_ARGUMENT;
+  }
+
+  int err = openmc_simulation_init();
+  if (err) return err;
+
+  BenchmarkSites sites = find_benchmark_sites();
+  if (sites.size() == 0) {
+    set_errmsg("The model has no material cells to sample collisions in.");
+    return OPENMC_E_GEOMETRY;
+  }
+
+  int neutron = static_cast<int>(Particle::Type::neutron);
+  double E_min = data::energy_min[neutron];
+  double E_max = data::energy_max[neutron];
+  int64_t n = settings::collision_benchmark_samples;
+
+  CollisionTotals totals;
+  if (settings::event_based) {
+    event_collisions(n, sites, E_min, E_max, totals);
+  } else {
+    host_collisions(n, sites, E_min, E_max, totals);
+  }
+
+  // Every process samples the same number of collisions, so the rate of the
+  // run is set by the slowest
+#ifdef OPENMC_MPI
+  MPI_Allreduce(MPI_IN_PLACE, totals.seconds, N_COLLISION_PARTS, MPI_DOUBLE,
+    MPI_MAX, mpi::intracomm);
+  MPI_Allreduce(MPI_IN_PLACE, totals.samples, N_COLLISION_PARTS, MPI_INT64_T,
+    MPI_SUM, mpi::intracomm);
+  MPI_Allreduce(MPI_IN_PLACE, &totals.absorptions, 1, MPI_INT64_T, MPI_SUM,
+    mpi::intracomm);
+  MPI_Allreduce(MPI_IN_PLACE, &totals.fissions, 1, MPI_INT64_T, MPI_SUM,
+    mpi::intracomm);
+#endif
+
+  if (mpi::master) {
+    header("COLLISION BENCHMARK", 1);
+    const char* where = settings::event_based ?
+      (was_device_used() ? "event-based on device" : "event-based on host") :
+      "history-based on host";
+    fmt::print(" Collisions                        = {}\n", totals.samples[0]);
+    fmt::print(" Material and temperature sites    = {}\n", sites.size());
+    fmt::print(" Collision kernels                 = {}\n", where);
+    fmt::print(" Absorptions                       = {}\n", totals.absorptions);
+    fmt::print(" Collisions banking fission sites  = {}\n", totals.fissions);
+    for (int i = 0; i < N_COLLISION_PARTS; ++i) {
+      if (totals.samples[i] == 0) continue;
+      show_time(PART_NAMES[i], totals.seconds[i]);
+      double rate = totals.seconds[i] > 0.0 ?
+        totals.samples[i] / totals.seconds[i] : 0.0;
+      fmt::print("   {:<31} = {:.6} samples/second ({} samples)\n",
+        "Sampling rate", rate, totals.samples[i]);
+    }
+    double seconds = 0.0;
+    for (double s : totals.seconds) seconds += s;
+    fmt::print(" Collision rate                    = {:.6} collisions/second\n",
+      seconds > 0.0 ? totals.samples[0] / seconds : 0.0);
+  }
+
+  return openmc_simulation_finalize();
+}
@@ -17,15 +17,19 @@
 #include "openmc/photon.h"
 #include "openmc/settings.h"
 #include "openmc/simulation.h"
+#include "openmc/startup_profile.h"
 #include "openmc/string_utils.h"
 #include "openmc/timer.h"
 #include "openmc/thermal.h"
 #include "openmc/xml_interface.h"
+#include "openmc/xs_cache.h"
 #include "openmc/wmp.h"
 
 #include "pugixml.hpp"
 
 #include <cstdlib> // for getenv
+#include <memory>  // for unique_ptr
+#include <stdexcept>
 #include <unordered_set>
 
 namespace openmc {
@@ -109,12 +113,26 @@ void read_cross_sections_xml()
     doc.load_file(s.c_str());
   } else {
 #endif
-  // Check if materials.xml exists
-  if (!file_exists(filename)) {
-    fatal_error("Material XML file '" + filename + "' does not exist.");
+  std::string h5_filename = settings::path_input + "materials.h5";
+  if (!file_exists(filename) && file_exists(h5_filename)) {
+    // The HDF5 model input keeps the path as an attribute. Only that is
+    // needed here, so it stands in for the parsed materials.xml.
+    auto root = doc.append_child("materials");
+    hid_t file_id = file_open(h5_filename, 'r');
+    if (attribute_exists(file_id, "cross_sections")) {
+      std::string path;
+      read_attribute(file_id, "cross_sections", path);
+      root.append_child("cross_sections").text().set(path.c_str());
+    }
+    file_close(file_id);
+  } else {
+    // Check if materials.xml exists
+    if (!file_exists(filename)) {
+      fatal_error("Material XML file '" + filename + "' does not exist.");
+    }
+    // Parse materials.xml file
+    doc.load_file(filename.c_str());
   }
-  // Parse materials.xml file
-  doc.load_file(filename.c_str());
 #ifdef DAGMC
   }
 #endif
@@ -182,6 +200,80 @@ void read_cross_sections_xml()
   }
 }
 
+namespace {
+
+//! Whether nuclides can be read on several threads with the same result as
+//! one after the other
+//
+//! \param[in] nuclides Indices of the nuclides to read, in order
+//! \param[in] names Name of each nuclide by index
+bool read_in_parallel(const std::vector<int>& nuclides,
+  const std::vector<std::string>& names)
+{
+  if (nuclides.size() < 2 || !hdf5_thread_safe()) return false;
+
+  for (int i_nuc : nuclides) {
+    // Missing libraries are reported by openmc_load_nuclide()
+    LibraryKey key {Library::Type::neutron, names[i_nuc]};
+    auto it = data::library_map.find(key);
+    if (it == data::library_map.end()) return false;
+
+    // A nuclide with data at one temperature switches interpolation to the
+    // nearest temperature for the nuclides read after it
+    if (settings::temperature_method == TemperatureMethod::INTERPOLATION) {
+      hid_t file_id = file_open(data::libraries[it->second].path_, 'r');
+      hid_t group = open_group(file_id, (names[i_nuc] + "/kTs").c_str());
+      bool single = dataset_names(group).size() == 1;
+      close_group(group);
+      file_close(file_id);
+      if (single) return false;
+    }
+  }
+  return true;
+}
+
+//! Read nuclides on several threads, each through its own file handle
+//
+//! \param[in] nuclides Indices of the nuclides to read, in order
+//! \param[in] names Name of each nuclide by index
+//! \param[in] temps Temperatures to read for each nuclide by index
+void read_nuclides_parallel(const std::vector<int>& nuclides,
+  const std::vector<std::string>& names,
+  const std::vector<std::vector<double>>& temps)
+{
+  int n = nuclides.size();
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < n; ++i) {
+    const auto& name = names[nuclides[i]];
+    LibraryKey key {Library::Type::neutron, name};
+    const auto& filename = data::libraries[data::library_map.at(key)].path_;
+    write_message(6, "Reading {} from {}", name, filename);
+
+    Timer timer;
+    timer.start();
+    hid_t file_id = file_open(filename, 'r');
+    check_data_version(file_id);
+    hid_t group = open_group(file_id, name.c_str());
+    new(data::nuclides + i) Nuclide(group, temps[nuclides[i]], i);
+    close_group(group);
+    file_close(file_id);
+
+    if (settings::temperature_multipole) read_multipole_data(i);
+    record_startup_item("nuclide", name, timer.elapsed());
+  }
+  data::nuclides_size = n;
+
+  // Elements are read in the order of the nuclides that need them
+  if (settings::photon_transport) {
+    for (int i_nuc : nuclides) {
+      int err = read_photon_element(names[i_nuc]);
+      if (err < 0) throw std::runtime_error{openmc_err_msg};
+    }
+  }
+}
+
+} // namespace
+
 void
 read_ce_cross_sections(const std::vector<std::vector<double>>& nuc_temps,
   const std::vector<std::vector<double>>& thermal_temps)
@@ -211,7 +303,10 @@ read_ce_cross_sections(const std::vector<std::vector<double>>& nuc_temps,
     thermal_names[kv.second] = kv.first;
   }
 
-  // Read cross sections
+  // Find the nuclides and S(a,b) tables to read, in the order they first
+  // appear in materials, which is the order of their indices
+  std::vector<int> nuclides_to_read;
+  std::vector<int> tables_to_read;
   for (int i = 0; i < model::materials_size; i++) {
     const auto& mat = model::materials[i];
     for (int i_nuc : mat.nuclide_) {
@@ -222,48 +317,104 @@ read_ce_cross_sections(const std::vector<std::vector<double>>& nuc_temps,
 
       // If we've already read this nuclide, skip it
       if (already_read.find(name) != already_read.end()) continue;
-
-      const auto& temps = nuc_temps[i_nuc];
-      int err = openmc_load_nuclide(name.c_str(), temps.data(), temps.size());
-      if (err < 0) throw std::runtime_error{openmc_err_msg};
-
+      nuclides_to_read.push_back(i_nuc);
       already_read.insert(name);
     }
-  }
-
-  // Perform final tasks -- reading S(a,b) tables, normalizing densities
-  for (int i = 0; i < model::materials_size; i++) {
-    auto& mat = model::materials[i];
     for (const auto& table : mat.thermal_tables_) {
-      // Get name of S(a,b) table
       int i_table = table.index_table;
       std::string& name = thermal_names[i_table];
+      if (already_read.find(name) != already_read.end()) continue;
+      tables_to_read.push_back(i_table);
+      already_read.insert(name);
+    }
+  }
 
-      if (already_read.find(name) == already_read.end()) {
-        LibraryKey key {Library::Type::thermal, name};
-        int idx = data::library_map[key];
-        std::string& filename = data::libraries[idx].path_;
-
-        write_message(6, "Reading {} from {}", name, filename);
-
-        // Open file and make sure version matches
-        hid_t file_id = file_open(filename, 'r');
-        check_data_version(file_id);
-
-        // Read thermal scattering data from HDF5
-        hid_t group = open_group(file_id, name.c_str());
-        data::thermal_scatt.push_back({group, thermal_temps[i_table]});
-        close_group(group);
-        file_close(file_id);
+  // A compiled library written by an earlier run with the same nuclides,
+  // libraries and settings replaces the HDF5 neutron libraries
+  std::string cache_key;
+  std::string cache_file;
+  if (!settings::path_xs_cache.empty()) {
+    cache_file = xs_cache_filename(nuclides_to_read, nuclide_names, nuc_temps,
+      cache_key);
+  }
 
-        // Add name to dictionary
-        already_read.insert(name);
+  // Read cross sections
+  begin_phase("Reading nuclides");
+  if (!cache_file.empty() &&
+      read_xs_cache(cache_file, cache_key, nuclides_to_read.size())) {
+    for (int i = 0; i < data::nuclides_size; ++i) {
+      if (settings::temperature_multipole) read_multipole_data(i);
+    }
+    if (settings::photon_transport) {
+      for (int i_nuc : nuclides_to_read) {
+        int err = read_photon_element(nuclide_names[i_nuc]);
+        if (err < 0) throw std::runtime_error{openmc_err_msg};
       }
-    } // thermal_tables_
+    }
+  } else {
+    if (read_in_parallel(nuclides_to_read, nuclide_names)) {
+      read_nuclides_parallel(nuclides_to_read, nuclide_names, nuc_temps);
+    } else {
+      for (int i_nuc : nuclides_to_read) {
+        const auto& name = nuclide_names[i_nuc];
+        const auto& temps = nuc_temps[i_nuc];
+        Timer timer;
+        timer.start();
+        int err = openmc_load_nuclide(name.c_str(), temps.data(), temps.size());
+        if (err < 0) throw std::runtime_error{openmc_err_msg};
+        record_startup_item("nuclide", name, timer.elapsed());
+      }
+    }
+    if (mpi::master && !cache_file.empty()) {
+      write_xs_cache(cache_file, cache_key);
+    }
+  }
+  end_phase();
+  if (data::pruned_bytes > 0) {
+    write_message(5, "Left {:.3f} MB of nuclear data unread that the run "
+      "cannot use", data::pruned_bytes * 1.0e-6);
+  }
+
+  // Read S(a,b) tables, on several threads when HDF5 allows it
+  begin_phase("Reading thermal scattering");
+  int n_tables = tables_to_read.size();
+  std::vector<std::unique_ptr<ThermalScattering>> tables(n_tables);
+  #pragma omp parallel for schedule(dynamic) if(hdf5_thread_safe())
+  for (int i = 0; i < n_tables; ++i) {
+    int i_table = tables_to_read[i];
+    const auto& name = thermal_names[i_table];
+    LibraryKey key {Library::Type::thermal, name};
+    int idx = data::library_map.at(key);
+    const auto& filename = data::libraries[idx].path_;
+
+    write_message(6, "Reading {} from {}", name, filename);
+
+    Timer timer;
+    timer.start();
+    // Open file and make sure version matches
+    hid_t file_id = file_open(filename, 'r');
+    check_data_version(file_id);
+
+    // Read thermal scattering data from HDF5
+    hid_t group = open_group(file_id, name.c_str());
+    tables[i] = std::make_unique<ThermalScattering>(group,
+      thermal_temps[i_table]);
+    close_group(group);
+    file_close(file_id);
+    record_startup_item("thermal", name, timer.elapsed());
+  }
+  for (auto& table : tables) {
+    data::thermal_scatt.push_back(std::move(*table));
+  }
+  end_phase();
 
-    // Finish setting up materials (normalizing densities, etc.)
-    mat.finalize();
-  } // materials
+  // Finish setting up materials (normalizing densities, etc.)
+  begin_phase("Finalizing materials");
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < model::materials_size; i++) {
+    model::materials[i].finalize();
+  }
+  end_phase();
 
   if (settings::photon_transport && settings::electron_treatment == ElectronTreatment::TTB) {
     // Take logarithm of energies since they are log-log interpolated
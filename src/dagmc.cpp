@@ -11,6 +11,7 @@
 #include "openmc/string_utils.h"
 #include "openmc/settings.h"
 #include "openmc/surface.h"
+#include "openmc/triangle_bvh.h"
 
 #ifdef DAGMC
 #include "uwuw.hpp"
@@ -335,9 +336,69 @@ void load_dagmc_geometry()
     model::surface_map[s->id_] = i;
   }
 
+  build_dagmc_bvhs();
+
   return;
 }
 
+void build_dagmc_bvhs()
+{
+  moab::Interface* mbi = model::DAG->moab_instance();
+  int n_cells = model::DAG->num_entities(3);
+  model::cell_bvhs.clear();
+  model::cell_bvhs.resize(n_cells);
+
+  for (int i = 0; i < n_cells; i++) {
+    moab::EntityHandle vol = model::DAG->entity_by_index(3, i+1);
+
+    // The implicit complement has no surfaces of its own to fire rays at, so
+    // it keeps using the OBB tree
+    if (model::DAG->is_implicit_complement(vol)) continue;
+
+    moab::Range surfs;
+    moab::ErrorCode rval = mbi->get_child_meshsets(vol, surfs);
+    MB_CHK_ERR_CONT(rval);
+
+    std::vector<BVHTriangle> triangles;
+    for (auto surf : surfs) {
+      // Triangles of a surface are wound along the normal pointing out of its
+      // forward volume
+      int sense;
+      rval = model::DAG->surface_sense(vol, surf, sense);
+      MB_CHK_ERR_CONT(rval);
+      int32_t surf_idx = model::DAG->index_by_handle(surf);
+
+      moab::Range tris;
+      rval = mbi->get_entities_by_type(surf, moab::MBTRI, tris);
+      MB_CHK_ERR_CONT(rval);
+
+      for (auto tri : tris) {
+        const moab::EntityHandle* conn;
+        int n_conn;
+        rval = mbi->get_connectivity(tri, conn, n_conn);
+        MB_CHK_ERR_CONT(rval);
+        double coords[9];
+        rval = mbi->get_coords(conn, 3, coords);
+        MB_CHK_ERR_CONT(rval);
+
+        BVHTriangle t;
+        t.v0 = {coords[0], coords[1], coords[2]};
+        t.v1 = {coords[3], coords[4], coords[5]};
+        t.v2 = {coords[6], coords[7], coords[8]};
+        if (sense == -1) std::swap(t.v1, t.v2);
+        t.surface = surf_idx;
+        triangles.push_back(t);
+      }
+    }
+
+    model::cell_bvhs[i].build(std::move(triangles));
+  }
+
+  // Cells read the hierarchies through the pointer mapped to device, which
+  // is the host array until they are moved there
+  model::device_cell_bvhs = model::cell_bvhs.data();
+}
+
 void read_geometry_dagmc()
 {
   write_message("Reading DAGMC geometry...", 5);
@@ -348,6 +409,8 @@ void read_geometry_dagmc()
 
 void free_memory_dagmc()
 {
+  model::cell_bvhs.clear();
+  model::device_cell_bvhs = nullptr;
   delete model::DAG;
 }
 
@@ -3,44 +3,394 @@
 #include "openmc/bank.h"
 #include "openmc/bremsstrahlung.h"
 #include "openmc/cell.h"
+#include "openmc/constants.h"
+#include "openmc/distribution_energy.h"
+#include "openmc/error.h"
+#include "openmc/event.h"
 #include "openmc/geometry.h"
 #include "openmc/lattice.h"
 #include "openmc/material.h"
+#include "openmc/memory_registry.h"
+#include "openmc/mesh.h"
 #include "openmc/message_passing.h"
+#include "openmc/mgxs_interface.h"
 #include "openmc/nuclide.h"
 #include "openmc/particle.h"
 #include "openmc/photon.h"
+#include "openmc/secondary_tables.h"
 #include "openmc/simulation.h"
+#include "openmc/source.h"
+#include "openmc/startup_profile.h"
 #include "openmc/thermal.h"
+#include "openmc/triangle_bvh.h"
+#include "openmc/weight_windows.h"
 
 #include "openmc/tallies/derivative.h"
 #include "openmc/tallies/tally.h"
 #include "openmc/tallies/tally_scoring.h"
 
 
+#include <algorithm> // for max, sort, unique
+#include <cstdint>   // for uintptr_t
+#include <iostream>
+
+#include <fmt/core.h>
+
 namespace openmc {
 
-void enforce_assumptions()
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace data {
+
+DeviceArena device_arena;
+
+} // namespace data
+
+//==============================================================================
+// DeviceArena implementation
+//==============================================================================
+
+void* DeviceArena::allocate_bytes(size_t n_bytes, const char* subsystem)
+{
+  // Nuclides are flattened on several threads
+  void* ptr;
+  #pragma omp critical(device_arena)
+  ptr = allocate_bytes_serial(n_bytes, subsystem);
+  return ptr;
+}
+
+void* DeviceArena::allocate_bytes_serial(size_t n_bytes, const char* subsystem)
+{
+  // Find the first slab with room for the aligned array
+  auto aligned_offset = [](const Slab& slab) {
+    auto base = reinterpret_cast<uintptr_t>(slab.data.get());
+    uintptr_t end = base + slab.used;
+    uintptr_t aligned = (end + DEVICE_ARENA_ALIGNMENT - 1) &
+      ~static_cast<uintptr_t>(DEVICE_ARENA_ALIGNMENT - 1);
+    return static_cast<size_t>(aligned - base);
+  };
+  Slab* slab = nullptr;
+  size_t offset = 0;
+  for (auto& s : slabs_) {
+    offset = aligned_offset(s);
+    if (!s.mapped && offset + n_bytes <= s.capacity) {
+      slab = &s;
+      break;
+    }
+  }
+
+  // Start a new slab if none had room
+  if (!slab) {
+    size_t capacity = std::max(DEVICE_ARENA_SLAB_BYTES,
+      n_bytes + DEVICE_ARENA_ALIGNMENT);
+    slabs_.push_back({std::unique_ptr<char[]>(new char[capacity]), capacity,
+      0, false});
+    slab = &slabs_.back();
+    offset = aligned_offset(*slab);
+  }
+
+  slab->used = offset + n_bytes;
+  count(packed_, subsystem, n_bytes);
+  record_memory(subsystem, MemorySpace::host, n_bytes);
+  return slab->data.get() + offset;
+}
+
+void DeviceArena::record(const char* subsystem, size_t n_bytes)
+{
+  count(direct_, subsystem, n_bytes);
+}
+
+void DeviceArena::count(std::vector<std::pair<std::string, size_t>>& counts,
+  const char* subsystem, size_t n_bytes)
 {
-  // TODO: These first two assumptions don't do anything, as no tallies are active at beginning of simulation
+  record_memory(subsystem, MemorySpace::device, n_bytes);
+  for (auto& c : counts) {
+    if (c.first == subsystem) {
+      c.second += n_bytes;
+      return;
+    }
+  }
+  counts.emplace_back(subsystem, n_bytes);
+}
 
-  // Notably, I have commented this capability out of particle::cross_vacuum_bc and particle::cross_reflective_bc
-  assert(model::active_meshsurf_tallies.empty() && "Mesh surface tallies not yet supported.");
+void DeviceArena::map_to_device()
+{
+  for (auto& slab : slabs_) {
+    if (slab.mapped) continue;
+    char* data = slab.data.get();
+    size_t n = slab.used;
+    #pragma omp target enter data map(to: data[:n])
+    slab.mapped = true;
+  }
+}
 
-  // Commented out of particle::cross_reflective_bc
-  assert(model::active_surface_tallies.empty() && "Surface tallies not yet supported.");
+void DeviceArena::release_from_device()
+{
+  for (auto& slab : slabs_) {
+    if (!slab.mapped) continue;
+    char* data = slab.data.get();
+    size_t n = slab.used;
+    #pragma omp target exit data map(release: data[:n])
+    slab.mapped = false;
+  }
+
+  reset_records();
+}
+
+void DeviceArena::reset_records()
+{
+  // Directly mapped data is recorded again when it is next mapped
+  for (const auto& c : direct_) {
+    record_memory(c.first.c_str(), MemorySpace::device, -static_cast<int64_t>(c.second));
+  }
+  direct_.clear();
+}
+
+void DeviceArena::clear()
+{
+  for (const auto& c : packed_) {
+    record_memory(c.first.c_str(), MemorySpace::host, -static_cast<int64_t>(c.second));
+    record_memory(c.first.c_str(), MemorySpace::device, -static_cast<int64_t>(c.second));
+  }
+  for (const auto& c : direct_) {
+    record_memory(c.first.c_str(), MemorySpace::device, -static_cast<int64_t>(c.second));
+  }
+  slabs_.clear();
+  packed_.clear();
+  direct_.clear();
+}
+
+size_t DeviceArena::total_bytes() const
+{
+  size_t total = 0;
+  for (const auto& c : direct_) total += c.second;
+  for (const auto& c : packed_) total += c.second;
+  return total;
+}
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+void enforce_assumptions()
+{
+  // Windowed multipole temperature derivatives, evaluated on device, are not
+  // implemented for 0 Kelvin cross sections
+  for (const auto& deriv : model::tally_derivs) {
+    if (deriv.variable != DerivativeVariable::TEMPERATURE) continue;
+    int i_material = model::material_map.at(deriv.diff_material);
+    for (const auto& cell : model::cells) {
+      bool filled = false;
+      for (int i = 0; i < cell.material_.size(); ++i) {
+        if (cell.material_[i] == i_material) filled = true;
+      }
+      if (!filled) continue;
+      for (int i = 0; i < cell.sqrtkT_.size(); ++i) {
+        if (cell.sqrtkT_[i] == 0.0) {
+          fatal_error(fmt::format("Windowed multipole temperature derivatives "
+            "are not implemented for 0 Kelvin cross sections (derivative {}, "
+            "cell {}).", deriv.id, cell.id_));
+        }
+      }
+    }
+  }
 
   // Assertions made when initializing particles
-  assert(model::tally_derivs.size() <= FLUX_DERIVS_SIZE);
   for (auto i = 0; i < model::tallies_size; i++) {
     assert(model::tallies[i].n_filters() <= FILTER_MATCHES_SIZE);
-    assert(model::tallies[i].estimator_ == TallyEstimator::TRACKLENGTH && "Analog and collision tallies not yet supported on device.");
   }
   assert(model::n_coord_levels <= COORD_SIZE);
-  #ifndef NO_MICRO_XS_CACHE
-  assert(data::nuclides_size <= NEUTRON_XS_SIZE);
-  #endif
-  assert(data::elements_size <= PHOTON_XS_SIZE);
+
+  // Fixed-source sites are sampled on device only from sources it can sample
+  if (settings::device_source) {
+    if (settings::run_mode != RunMode::FIXED_SOURCE) {
+      settings::device_source = false;
+    } else if (!can_sample_sources_on_device()) {
+      if (mpi::master) {
+        warning("External sources will be sampled on host: only independent "
+          "sources of continuous-energy runs can be sampled on device.");
+      }
+      settings::device_source = false;
+    }
+  }
+
+  // A fission matrix is tallied on the entropy mesh or, without one, the UFS
+  // mesh, and is held whole on each process
+  if (settings::fission_matrix_on) {
+    const Mesh* mesh = simulation::entropy_mesh ? simulation::entropy_mesh :
+      simulation::ufs_mesh;
+    if (settings::run_mode != RunMode::EIGENVALUE || !mesh) {
+      if (mpi::master) {
+        warning("No fission matrix will be tallied: --fission-matrix applies "
+          "to eigenvalue runs with an entropy or UFS mesh.");
+      }
+      settings::fission_matrix_on = false;
+    } else if (mesh->n_bins() > FISSION_MATRIX_MAX_BINS) {
+      if (mpi::master) {
+        warning(fmt::format("No fission matrix will be tallied: its mesh has "
+          "{} bins, more than the {} a fission matrix may have.",
+          mesh->n_bins(), FISSION_MATRIX_MAX_BINS));
+      }
+      settings::fission_matrix_on = false;
+    }
+  }
+
+  // Generations within a batch only stay on their process when there is more
+  // than one of each. Uniform fission site weighting counts sites across
+  // processes every generation.
+  if (settings::local_generations) {
+    if (mpi::n_procs == 1 || settings::run_mode != RunMode::EIGENVALUE ||
+        settings::gen_per_batch == 1) {
+      settings::local_generations = false;
+    } else if (settings::ufs_on) {
+      if (mpi::master) {
+        warning("Sites will be exchanged every generation: --local-generations "
+          "does not apply to runs with uniform fission site weighting.");
+      }
+      settings::local_generations = false;
+    }
+  }
+
+  // Host threads transport particles history-based next to the event-based
+  // transport on device. Sites that are sampled on device, or banked in
+  // device-resident banks other than the ones merged afterwards, leave no
+  // share for the host.
+  if (settings::hybrid_transport) {
+    if (!settings::event_based || omp_get_max_threads() < 2) {
+      settings::hybrid_transport = false;
+    } else if (settings::device_fission_bank || settings::device_source ||
+        settings::async_bank_exchange || settings::surf_source_write ||
+        settings::write_all_tracks || !settings::track_identifiers.empty()) {
+      if (mpi::master) {
+        warning("All particles will be transported on device: --hybrid does "
+          "not apply with --device-fission-bank, --device-source, "
+          "--async-bank, surface source writing or track output.");
+      }
+      settings::hybrid_transport = false;
+    }
+  }
+
+  // Sites can only be started out of order in event-based eigenvalue runs
+  // whose source bank is not read before transport
+  if (settings::async_bank_exchange) {
+    if (mpi::n_procs == 1 || settings::run_mode != RunMode::EIGENVALUE) {
+      settings::async_bank_exchange = false;
+    } else if (!settings::event_based || settings::ufs_on ||
+        settings::fission_matrix_on) {
+      if (mpi::master) {
+        warning("The bank exchange will complete before transport: "
+          "--async-bank applies to event-based runs without uniform fission "
+          "site weighting or a fission matrix.");
+      }
+      settings::async_bank_exchange = false;
+    }
+  }
+}
+
+void choose_host_resident_xs()
+{
+  if (settings::device_xs_budget <= 0.0) {
+    // Point out the budget when the pointwise XS alone exceed free memory
+    size_t free_bytes = free_device_memory();
+    size_t total = 0;
+    for (int i = 0; i < data::nuclides_size; ++i) {
+      total += data::nuclides[i].flat_xs_nbytes();
+    }
+    if (mpi::master && free_bytes > 0 && total > free_bytes) {
+      warning(fmt::format("Pointwise XS take {:.1f} MB, more than the {:.1f} MB "
+        "of free device memory. Consider --device-xs-budget.", total * 1.0e-6,
+        free_bytes * 1.0e-6));
+    }
+    return;
+  }
+  if (settings::shared_xs) {
+    warning("Node-shared pointwise XS are all mapped to device; the device XS "
+      "budget is ignored.");
+    return;
+  }
+
+  // Number of cell instances filled by each material
+  std::vector<int> n_instances(model::materials_size, 0);
+  for (const auto& cell : model::cells) {
+    for (int i = 0; i < cell.material_.size(); ++i) {
+      if (cell.material_[i] != MATERIAL_VOID) ++n_instances[cell.material_[i]];
+    }
+  }
+
+  // Estimated use of each nuclide
+  std::vector<double> use(data::nuclides_size, 0.0);
+  for (int i = 0; i < model::materials_size; ++i) {
+    const auto& mat = model::materials[i];
+    auto density = mat.densities();
+    double total = 0.0;
+    for (double d : density) total += d;
+    if (total <= 0.0) continue;
+    for (int j = 0; j < density.size(); ++j) {
+      use[mat.nuclides()[j]] += n_instances[i] * density[j] / total;
+    }
+  }
+
+  // Keep the most used nuclides on device while they fit, and smaller ones
+  // first among equally used
+  std::vector<size_t> nbytes(data::nuclides_size);
+  std::vector<int> order(data::nuclides_size);
+  for (int i = 0; i < data::nuclides_size; ++i) {
+    nbytes[i] = data::nuclides[i].flat_xs_nbytes();
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](int a, int b) {
+    return use[a] != use[b] ? use[a] > use[b] : nbytes[a] < nbytes[b];
+  });
+
+  double budget = settings::device_xs_budget * 1.0e9;
+  size_t resident = 0;
+  size_t host = 0;
+  int n_host = 0;
+  for (int i : order) {
+    auto& nuc = data::nuclides[i];
+    nuc.flat_host_ = (resident + nbytes[i] > budget);
+    if (nuc.flat_host_) {
+      host += nbytes[i];
+      ++n_host;
+    } else {
+      resident += nbytes[i];
+    }
+  }
+
+  if (mpi::master && n_host > 0) {
+    std::cout << " Keeping pointwise XS of " << n_host << " of " <<
+      data::nuclides_size << " nuclides (" << host * 1.0e-6 << " MB) in host "
+      "memory read by the device" << std::endl;
+  }
+}
+
+void map_in_place(void* ptr, size_t n_bytes)
+{
+#ifdef _OPENMP
+  if (n_bytes == 0) return;
+  omp_target_associate_ptr(ptr, ptr, n_bytes, 0, omp_get_default_device());
+#endif
+}
+
+void unmap_in_place(void* ptr)
+{
+#ifdef _OPENMP
+  omp_target_disassociate_ptr(ptr, omp_get_default_device());
+#endif
+}
+
+omp_allocator_handle_t host_resident_allocator()
+{
+  static omp_allocator_handle_t pinned = [] {
+    omp_alloctrait_t traits[] {
+      {omp_atk_pinned, omp_atv_true},
+      {omp_atk_fallback, omp_atv_default_mem_fb}
+    };
+    return omp_init_allocator(omp_default_mem_space, 2, traits);
+  }();
+  return pinned;
 }
 
 void move_settings_to_device()
@@ -57,6 +407,7 @@ void move_settings_to_device()
   #pragma omp target update to(settings::urr_ptables_on)
   #pragma omp target update to(settings::create_fission_neutrons)
   #pragma omp target update to(settings::survival_biasing)
+  #pragma omp target update to(settings::write_all_tracks)
   #pragma omp target update to(settings::res_scat_method)
   #pragma omp target update to(settings::res_scat_energy_min)
   #pragma omp target update to(settings::res_scat_energy_max)
@@ -65,11 +416,25 @@ void move_settings_to_device()
   #pragma omp target update to(settings::electron_treatment)
   settings::energy_cutoff[0]; // Lazy extern template expansion workaround
   #pragma omp target update to(settings::energy_cutoff)
+  settings::time_cutoff[0]; // Lazy extern template expansion workaround
+  #pragma omp target update to(settings::time_cutoff)
   #pragma omp target update to(settings::n_log_bins)
+  #pragma omp target update to(settings::energy_grid_method)
+  #pragma omp target update to(settings::faddeeva_method)
   #pragma omp target update to(settings::assume_separate)
   #pragma omp target update to(settings::check_overlaps)
   #pragma omp target update to(settings::max_particles_in_flight)
   #pragma omp target update to(settings::minimum_sort_items)
+  #pragma omp target update to(settings::bucket_xs_queues)
+  #pragma omp target update to(settings::material_xs_table_points)
+  #pragma omp target update to(settings::urr_fast_sampling)
+  #pragma omp target update to(settings::particle_soa)
+  #pragma omp target update to(settings::delta_tracking)
+  #pragma omp target update to(settings::plane_cache)
+  #pragma omp target update to(settings::fast_reflection)
+  #pragma omp target update to(settings::weight_windows_on)
+  #pragma omp target update to(settings::device_source)
+  #pragma omp target update to(settings::async_bank_exchange)
 
   // message_passing.h
   #pragma omp target update to(mpi::rank)
@@ -88,22 +453,11 @@ void move_settings_to_device()
   #pragma omp target update to(model::root_universe)
 }
 
-void move_read_only_data_to_device()
+void move_geometry_to_device()
 {
-  // Enforce any device-specific assumptions or limitations on user inputs
-  enforce_assumptions();
-
-  // Copy all global settings into device globals
-  move_settings_to_device();
-
-  #ifdef _OPENMP
-  int host_id = omp_get_initial_device();
-  int device_id = omp_get_default_device();
-  #else
-  int host_id = 0;
-  int device_id = 0;
-  #endif
-  size_t sz;
+  // The geometry stays on device after the first simulation, which finds it
+  // present and copies nothing again, so the cells changed since are sent
+  update_cells_on_device();
 
   // Surfaces ////////////////////////////////////////////////////////
 
@@ -112,6 +466,7 @@ void move_read_only_data_to_device()
   }
   model::device_surfaces = model::surfaces.data();
   #pragma omp target enter data map(to: model::device_surfaces[:model::surfaces.size()])
+  data::device_arena.record("Surfaces", model::surfaces.size() * sizeof(model::surfaces[0]));
 
   // Universes ///////////////////////////////////////////////////////
 
@@ -120,6 +475,7 @@ void move_read_only_data_to_device()
   }
   model::device_universes = model::universes.data();
   #pragma omp target enter data map(to: model::device_universes[:model::universes.size()])
+  data::device_arena.record("Universes", model::universes.size() * sizeof(model::universes[0]));
   for( auto& universe : model::universes ) {
     universe.allocate_and_copy_to_device();
   }
@@ -131,6 +487,7 @@ void move_read_only_data_to_device()
   }
   model::device_cells = model::cells.data();
   #pragma omp target enter data map(to: model::device_cells[0:model::cells.size()])
+  data::device_arena.record("Cells", model::cells.size() * sizeof(model::cells[0]));
   for( auto& cell : model::cells ) {
     cell.copy_to_device();
   }
@@ -142,19 +499,69 @@ void move_read_only_data_to_device()
   }
   model::device_lattices = model::lattices.data();
   #pragma omp target enter data map(to: model::device_lattices[:model::lattices.size()])
+  data::device_arena.record("Lattices", model::lattices.size() * sizeof(model::lattices[0]));
   for( auto& lattice : model::lattices ) {
     lattice.allocate_and_copy_to_device();
   }
 
-  // Nuclear data /////////////////////////////////////////////////////
-  data::energy_min[0]; // Lazy extern template expansion workaround
-  data::energy_max[0]; // Lazy extern template expansion workaround
-  #pragma omp target update to(data::energy_min)
-  #pragma omp target update to(data::energy_max)
-  #pragma omp target update to(data::nuclides_size)
+  // DAGMC triangle hierarchies //////////////////////////////////////
 
-  // Flatten nuclides before copying
-  for (int i = 0; i < data::nuclides_size; ++i) {
+  if (!model::cell_bvhs.empty()) {
+    if (mpi::master) {
+      std::cout << " Moving " << model::cell_bvhs.size() << " DAGMC volume hierarchies to device..." << std::endl;
+    }
+    model::device_cell_bvhs = model::cell_bvhs.data();
+    #pragma omp target enter data map(to: model::device_cell_bvhs[:model::cell_bvhs.size()])
+    size_t n_bytes = model::cell_bvhs.size() * sizeof(model::cell_bvhs[0]);
+    for (auto& bvh : model::cell_bvhs) {
+      bvh.copy_to_device();
+      n_bytes += bvh.nodes_.size() * sizeof(BVHNode) +
+        bvh.triangles_.size() * sizeof(BVHTriangle);
+    }
+    data::device_arena.record("DAGMC hierarchies", n_bytes);
+  }
+}
+
+namespace {
+
+//! Extent of the nuclear data on device. With settings::keep_device_data it
+//! stays there between simulations, and the next one only adds what was
+//! loaded since.
+struct DeviceNuclearData {
+  bool resident {false};   //!< Left on device by release_data_from_device()
+  Nuclide* nuclides {nullptr}; //!< Host array of nuclides mapped to device
+  size_t nuclides_capacity {0}; //!< Number of nuclides it has room for
+  int n_nuclides {0};      //!< Nuclides copied to device
+  int n_elements {0};      //!< Photon elements copied to device
+  size_t n_thermal {0};    //!< Thermal scattering tables copied to device
+  size_t ct_tables_bytes {0}; //!< Size of the decoded tabular distributions
+  size_t ae_tables_bytes {0}; //!< Size of the decoded angle-energy distributions
+};
+
+DeviceNuclearData device_nuclear_data;
+
+//! Materials kept on device between simulations with settings::keep_device_data,
+//! and those whose atom densities changed on host since
+struct DeviceMaterials {
+  bool resident {false};  //!< Left on device by release_data_from_device()
+  int n_materials {0};    //!< Materials on device
+  int n_nuclides {0};     //!< Width of the material nuclide index rows
+  std::vector<int32_t> changed; //!< Materials to send again
+};
+
+DeviceMaterials device_materials;
+
+//! Flatten the nuclides from index begin on before they are copied to device
+//
+//! \param begin Index of the first nuclide
+//! \param shared Block shared by the processes on a node that holds the
+//!   pointwise XS, or nullptr
+//! \param shared_offset Offset of each nuclide's XS in the shared block
+void flatten_nuclides(int begin, char* shared,
+  const std::vector<size_t>& shared_offset)
+{
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = begin; i < data::nuclides_size; ++i) {
     auto& nuc = data::nuclides[i];
 
     // URR data flattening
@@ -163,22 +570,89 @@ void move_read_only_data_to_device()
     }
 
     // Pointwise XS data flattening
-    nuc.flatten_xs_data();
+    nuc.flatten_xs_data(shared ? shared + shared_offset[i] : nullptr);
 
     // Windowed multipole
     nuc.flatten_wmp_data();
   }
+}
+
+void move_nuclear_data_to_device()
+{
+  #pragma omp target update to(data::nuclides_size)
+
+  // The unionized energy grid must exist before nuclides build their indices
+  // into it while being flattened
+  if (settings::energy_grid_method == EnergyGridMethod::unionized) {
+    build_union_energy_grid();
+    if (mpi::master) {
+      std::cout << " Unionized energy grid has " << data::union_grid.size() <<
+        " points (" << data::union_grid.size() * sizeof(double) * 1.0e-6 << " MB)" << std::endl;
+    }
+    data::device_union_grid = data::union_grid.data();
+    #pragma omp target update to(data::union_grid_size)
+    #pragma omp target enter data map(to: data::device_union_grid[:data::union_grid_size])
+  }
+
+  // Leave the least used pointwise XS in host memory if all do not fit
+  choose_host_resident_xs();
+
+  // Place the flattened pointwise XS of all nuclides in one block that the
+  // processes on a node share
+  std::vector<size_t> shared_offset;
+  char* shared = nullptr;
+  if (settings::shared_xs) {
+    shared_offset.resize(data::nuclides_size + 1, 0);
+    for (int i = 0; i < data::nuclides_size; ++i) {
+      shared_offset[i + 1] = shared_offset[i] +
+        data::nuclides[i].flat_xs_nbytes();
+    }
+    shared = data::shared_xs.allocate(shared_offset.back());
+  }
+
+  // Flatten nuclides before copying
+  begin_phase("Flattening nuclides");
+  flatten_nuclides(0, shared, shared_offset);
+  end_phase();
+
+  if (settings::shared_xs) {
+    data::shared_xs.fence();
+    if (mpi::master) {
+      std::cout << " Sharing " << data::shared_xs.size() * 1.0e-6 <<
+        " MB of pointwise XS among the processes on each node" << std::endl;
+    }
+  }
+
+  // Transfer the flattened arrays packed into the arena. The per-nuclide maps
+  // below then only attach device pointers to them.
+  if (settings::device_arena) {
+    data::device_arena.map_to_device();
+  }
 
   if (mpi::master) {
     std::cout << " Moving " << data::nuclides_size << " nuclides to device..." << std::endl;
   }
 
-  #pragma omp target enter data map(to: data::nuclides[:data::nuclides_size])
+  // The whole array is mapped so that nuclides loaded later can be added to
+  // it in place
+  #pragma omp target enter data map(to: data::nuclides[:data::nuclides_capacity])
+  device_nuclear_data.nuclides = data::nuclides;
+  device_nuclear_data.nuclides_capacity = data::nuclides_capacity;
   for (int i = 0; i < data::nuclides_size; ++i) {
     auto& nuc = data::nuclides[i];
     nuc.copy_to_device();
   }
 
+  // Continuous tabular energy distributions decoded out of the nuclides' data
+  if (!data::ct_tables.empty()) {
+    #pragma omp target update to(data::ct_tables)
+    data::ct_tables.copy_to_device();
+  }
+  if (!data::ae_tables.empty()) {
+    #pragma omp target update to(data::ae_tables)
+    data::ae_tables.copy_to_device();
+  }
+
   data::device_thermal_scatt = data::thermal_scatt.data();
   #pragma omp target enter data map(to: data::device_thermal_scatt[:data::thermal_scatt.size()])
   for (auto& ts : data::thermal_scatt) {
@@ -195,17 +669,194 @@ void move_read_only_data_to_device()
   #pragma omp target enter data map(to: data::compton_profile_pz[:data::compton_profile_pz_size])
 
   #pragma omp target update to(data::elements_size)
-  #pragma omp target enter data map(to: data::elements[:data::elements_size])
+  #pragma omp target enter data map(to: data::elements[:data::elements_capacity])
   for (int i = 0; i < data::elements_size; ++i) {
     auto& elm = data::elements[i];
     elm.copy_to_device();
   }
   data::device_ttb_e_grid = data::ttb_e_grid.data();
+  data::ttb_e_grid_size = data::ttb_e_grid.size();
   #pragma omp target update to(data::ttb_e_grid_size)
   #pragma omp target enter data map(to: data::device_ttb_e_grid[:data::ttb_e_grid.size()])
 
-  // Materials /////////////////////////////////////////////////////////
+  device_nuclear_data.n_nuclides = data::nuclides_size;
+  device_nuclear_data.n_elements = data::elements_size;
+  device_nuclear_data.n_thermal = data::thermal_scatt.size();
+  device_nuclear_data.ct_tables_bytes = data::ct_tables.nbytes();
+  device_nuclear_data.ae_tables_bytes = data::ae_tables.nbytes();
+}
 
+//! Whether the nuclear data left on device can be completed by adding the
+//! nuclides and elements loaded since it was copied
+bool can_add_nuclear_data()
+{
+  const auto& d {device_nuclear_data};
+  // A new nuclide changes the unionized grid, and new decoded distributions or
+  // thermal tables grow arrays already mapped
+  bool added = data::nuclides_size > d.n_nuclides;
+  if (added && settings::energy_grid_method == EnergyGridMethod::unionized) {
+    return false;
+  }
+  // The array is mapped in place, so it must not have grown since
+  if (data::nuclides != d.nuclides) return false;
+  return data::nuclides_size >= d.n_nuclides &&
+    data::elements_size >= d.n_elements &&
+    data::thermal_scatt.size() == d.n_thermal &&
+    data::ct_tables.nbytes() == d.ct_tables_bytes &&
+    data::ae_tables.nbytes() == d.ae_tables_bytes;
+}
+
+//! Copy the nuclides and elements loaded since the nuclear data was copied
+//! into the arrays already mapped to device
+void add_nuclear_data_to_device()
+{
+  auto& d {device_nuclear_data};
+  if (data::nuclides_size > d.n_nuclides) {
+    if (mpi::master) {
+      std::cout << " Adding " << data::nuclides_size - d.n_nuclides <<
+        " nuclides to device..." << std::endl;
+    }
+    // Nuclides added later hold their own pointwise XS rather than a part of
+    // the node-shared block
+    begin_phase("Flattening nuclides");
+    flatten_nuclides(d.n_nuclides, nullptr, {});
+    end_phase();
+    if (settings::device_arena) {
+      data::device_arena.map_to_device();
+    }
+    #pragma omp target update to(data::nuclides_size)
+    for (int i = d.n_nuclides; i < data::nuclides_size; ++i) {
+      Nuclide* nuc = data::nuclides + i;
+      #pragma omp target update to(nuc[:1])
+      nuc->copy_to_device();
+    }
+    d.n_nuclides = data::nuclides_size;
+  }
+
+  if (data::elements_size > d.n_elements) {
+    #pragma omp target update to(data::elements_size)
+    for (int i = d.n_elements; i < data::elements_size; ++i) {
+      PhotonInteraction* elm = data::elements + i;
+      #pragma omp target update to(elm[:1])
+      elm->copy_to_device();
+    }
+    d.n_elements = data::elements_size;
+  }
+}
+
+void release_nuclear_data_from_device()
+{
+  const auto& d {device_nuclear_data};
+  for (int i = 0; i < d.n_nuclides; ++i) {
+    data::nuclides[i].release_from_device();
+  }
+  // The array may have grown since it was mapped, in which case the mapping
+  // is still that of the array it was moved from
+  Nuclide* nuclides = d.nuclides;
+  #pragma omp target exit data map(release: nuclides[:d.nuclides_capacity])
+  if (settings::energy_grid_method == EnergyGridMethod::unionized) {
+    #pragma omp target exit data map(release: data::device_union_grid[:data::union_grid_size])
+  }
+  if (d.ct_tables_bytes > 0) {
+    data::ct_tables.release_device();
+  }
+  if (d.ae_tables_bytes > 0) {
+    data::ae_tables.release_device();
+  }
+
+  for (auto& ts : data::thermal_scatt) {
+    ts.release_from_device();
+  }
+  #pragma omp target exit data map(release: data::device_thermal_scatt[:d.n_thermal])
+
+  #pragma omp target exit data map(release: data::compton_profile_pz[:data::compton_profile_pz_size])
+  for (int i = 0; i < d.n_elements; ++i) {
+    data::elements[i].release_from_device();
+  }
+  #pragma omp target exit data map(release: data::elements[:data::elements_capacity])
+  #pragma omp target exit data map(release: data::device_ttb_e_grid[:data::ttb_e_grid.size()])
+
+  data::device_arena.release_from_device();
+  device_nuclear_data = {};
+}
+
+//! Account for the nuclear data mapped outside of the arena
+void record_nuclear_data()
+{
+  if (settings::energy_grid_method == EnergyGridMethod::unionized) {
+    data::device_arena.record("Unionized energy grid", data::union_grid_size * sizeof(double));
+  }
+  data::device_arena.record("Nuclides", data::nuclides_capacity * sizeof(Nuclide));
+  if (!data::ct_tables.empty()) {
+    data::device_arena.record("Tabular energy distributions",
+      data::ct_tables.nbytes());
+  }
+  if (!data::ae_tables.empty()) {
+    data::device_arena.record("Angle-energy distributions",
+      data::ae_tables.nbytes());
+  }
+  data::device_arena.record("Thermal scattering", data::thermal_scatt.size() * sizeof(data::thermal_scatt[0]));
+  data::device_arena.record("Photon elements", data::elements_capacity * sizeof(data::elements[0]));
+}
+
+//! Release the materials and the data derived from their compositions, which
+//! are copied again at the start of every simulation
+void release_materials_from_device()
+{
+  if (model::material_xs_table_size > 0) {
+    #pragma omp target exit data map(release: model::device_material_xs_table[:2*model::material_xs_table_size])
+    #pragma omp target exit data map(release: model::device_material_xs_table_valid[:model::material_xs_table_size])
+  }
+  if (model::majorant_size > 0) {
+    #pragma omp target exit data map(release: model::device_majorant[:model::majorant_size])
+  }
+  if (model::tms_majorant_bins > 0) {
+    #pragma omp target exit data map(release: model::device_tms_majorant[:model::tms_majorant.size()])
+  }
+
+  release_bremsstrahlung_from_device();
+  #pragma omp target exit data map(release: model::materials[:model::materials_size])
+
+  model::materials_nuclide.release_device();
+  model::materials_element.release_device();
+  model::materials_atom_density.release_device();
+  model::materials_p0.release_device();
+  model::materials_xs_features.release_device();
+  model::materials_nuclide_bitmap.release_device();
+  model::materials_thermal_tables.release_device();
+
+  // Compositions changed between simulations (e.g. by depletion) are
+  // serialized again, and density updates are no longer sent to device
+  model::materials_nuclide.clear();
+  model::materials_element.clear();
+  model::materials_atom_density.clear();
+  model::materials_p0.clear();
+  model::materials_xs_features.clear();
+  model::materials_nuclide_bitmap.clear();
+  model::materials_thermal_tables.clear();
+  device_materials.resident = false;
+  device_materials.changed.clear();
+}
+
+//! Device memory of the materials and their serialized compositions,
+//! excluding any ttb_ data
+size_t materials_device_bytes()
+{
+  size_t n_bytes = model::materials_size * sizeof(Material);
+  n_bytes += model::materials_nuclide.nbytes();
+  n_bytes += model::materials_element.nbytes();
+  n_bytes += model::materials_atom_density.nbytes();
+  n_bytes += model::materials_p0.nbytes();
+  n_bytes += model::materials_xs_features.nbytes();
+  n_bytes += model::materials_nuclide_bitmap.nbytes();
+  n_bytes += model::materials_thermal_tables.nbytes();
+  return n_bytes;
+}
+
+//! Serialize the materials and copy them, their XS tables and the majorant
+//! to device
+void move_materials_to_device()
+{
   // Analyze fissionable materials
   if (mpi::master) {
     int min = 99999;
@@ -240,7 +891,8 @@ void move_read_only_data_to_device()
     model::materials_element.stretch(mat.element_);
     model::materials_atom_density.stretch(mat.atom_density_);
     model::materials_p0.stretch(mat.p0_);
-    model::materials_mat_nuclide_index.stretch(mat.mat_nuclide_index_);
+    model::materials_xs_features.stretch(mat.xs_features_);
+    model::materials_nuclide_bitmap.stretch(mat.nuclide_bitmap_);
     model::materials_thermal_tables.stretch(mat.thermal_tables_);
   }
 
@@ -249,7 +901,8 @@ void move_read_only_data_to_device()
   model::materials_element.resize2d(model::materials_size);
   model::materials_atom_density.resize2d(model::materials_size);
   model::materials_p0.resize2d(model::materials_size);
-  model::materials_mat_nuclide_index.resize2d(model::materials_size);
+  model::materials_xs_features.resize2d(model::materials_size);
+  model::materials_nuclide_bitmap.resize2d(model::materials_size);
   model::materials_thermal_tables.resize2d(model::materials_size);
 
   // Populate serialized material vectors
@@ -259,21 +912,64 @@ void move_read_only_data_to_device()
     model::materials_element.copy_row(i, mat.element_);
     model::materials_atom_density.copy_row(i, mat.atom_density_);
     model::materials_p0.copy_row(i, mat.p0_);
-    model::materials_mat_nuclide_index.copy_row(i, mat.mat_nuclide_index_);
+    model::materials_xs_features.copy_row(i, mat.xs_features_);
+    model::materials_nuclide_bitmap.copy_row(i, mat.nuclide_bitmap_);
     model::materials_thermal_tables.copy_row(i, mat.thermal_tables_);
   }
 
   // Calculate and report memory usage (excluding any ttb_ data)
-  int n_bytes = model::materials_size * sizeof(Material);
-  n_bytes += model::materials_nuclide.nbytes();
-  n_bytes += model::materials_element.nbytes();
-  n_bytes += model::materials_atom_density.nbytes();
-  n_bytes += model::materials_p0.nbytes();
-  n_bytes += model::materials_mat_nuclide_index.nbytes();
-  n_bytes += model::materials_thermal_tables.nbytes();
+  size_t n_bytes = materials_device_bytes();
   if (mpi::master) {
     std::cout << " Moving " << model::materials_size << " materials to device of total size: " << n_bytes * 1.0e-6 << " MB" << std::endl;
   }
+  data::device_arena.record("Materials", n_bytes);
+
+  // Tabulate macroscopic XS of eligible materials. This must precede mapping
+  // the materials, as it sets their table offsets.
+  begin_phase("Building material XS tables");
+  build_material_xs_tables();
+  if (model::material_xs_table_size > 0) {
+    if (mpi::master) {
+      std::cout << " Moving material XS tables to device of total size: " <<
+        model::material_xs_table_size * (2*sizeof(double) + sizeof(uint8_t)) * 1.0e-6 <<
+        " MB" << std::endl;
+    }
+    model::device_material_xs_table = model::material_xs_table.data();
+    model::device_material_xs_table_valid = model::material_xs_table_valid.data();
+    #pragma omp target update to(model::material_xs_table_size)
+    #pragma omp target update to(model::material_xs_table_log_E_min)
+    #pragma omp target update to(model::material_xs_table_inv_du)
+    #pragma omp target enter data map(to: model::device_material_xs_table[:2*model::material_xs_table_size])
+    #pragma omp target enter data map(to: model::device_material_xs_table_valid[:model::material_xs_table_size])
+    data::device_arena.record("Material XS tables",
+      model::material_xs_table_size * (2*sizeof(double) + sizeof(uint8_t)));
+  }
+  end_phase();
+
+  // Bound the total XS of the nuclides under target motion sampling, and of
+  // the delta-tracking cells
+  begin_phase("Building majorant");
+  build_tms_majorant();
+  if (model::tms_majorant_bins > 0) {
+    model::device_tms_majorant = model::tms_majorant.data();
+    #pragma omp target update to(model::tms_majorant_bins)
+    #pragma omp target update to(model::majorant_log_E_min)
+    #pragma omp target update to(model::majorant_inv_du)
+    #pragma omp target enter data map(to: model::device_tms_majorant[:model::tms_majorant.size()])
+    data::device_arena.record("TMS majorant XS",
+      model::tms_majorant.size() * sizeof(double));
+  }
+  build_majorant();
+  if (model::majorant_size > 0) {
+    model::device_majorant = model::majorant.data();
+    #pragma omp target update to(model::majorant_size)
+    #pragma omp target update to(model::majorant_log_E_min)
+    #pragma omp target update to(model::majorant_inv_du)
+    #pragma omp target enter data map(to: model::device_majorant[:model::majorant_size])
+    data::device_arena.record("Majorant XS",
+      model::majorant_size * sizeof(double));
+  }
+  end_phase();
 
   // Update top level global scalars to device
   #pragma omp target update to(model::materials_size)
@@ -281,30 +977,172 @@ void move_read_only_data_to_device()
   #pragma omp target update to(model::materials_element)
   #pragma omp target update to(model::materials_atom_density)
   #pragma omp target update to(model::materials_p0)
-  #pragma omp target update to(model::materials_mat_nuclide_index)
+  #pragma omp target update to(model::materials_xs_features)
+  #pragma omp target update to(model::materials_nuclide_bitmap)
   #pragma omp target update to(model::materials_thermal_tables)
 
   // Map top level material array to device
   #pragma omp target enter data map(to: model::materials[:model::materials_size])
 
-  // Map ttb_ field arrays, if needed
-  for (int i = 0; i < model::materials_size; i++) {
-    model::materials[i].copy_to_device();
-  }
+  // Flatten and map the bremsstrahlung tables, if needed
+  copy_bremsstrahlung_to_device();
 
   // Map serialized material vectors to device
   model::materials_nuclide.copy_to_device();
   model::materials_element.copy_to_device();
   model::materials_atom_density.copy_to_device();
   model::materials_p0.copy_to_device();
-  model::materials_mat_nuclide_index.copy_to_device();
+  model::materials_xs_features.copy_to_device();
+  model::materials_nuclide_bitmap.copy_to_device();
   model::materials_thermal_tables.copy_to_device();
+}
+
+//! Send the atom densities of the materials changed since the last
+//! simulation, which left the materials on device
+void update_resident_materials()
+{
+  auto& changed {device_materials.changed};
+  std::sort(changed.begin(), changed.end());
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+  if (mpi::master) {
+    std::cout << " Updating " << changed.size() << " of " <<
+      model::materials_size << " materials kept on device..." << std::endl;
+  }
+
+  for (int32_t i : changed) {
+    auto& mat = model::materials[i];
+    model::materials_atom_density.copy_row(i, mat.atom_density_);
+    model::materials_atom_density.update_row_to_device(i, mat.nuclide_.size());
+    #pragma omp target update to(model::materials[i].density_, model::materials[i].density_gpcc_)
+    mat.invalidate_xs_table();
+  }
+
+  // The majorant bounds the delta-tracked materials at their old densities
+  if (!changed.empty() && model::majorant_size > 0) {
+    build_majorant();
+    model::device_majorant = model::majorant.data();
+    #pragma omp target update to(model::device_majorant[:model::majorant_size])
+  }
+
+  data::device_arena.record("Materials", materials_device_bytes());
+  if (model::material_xs_table_size > 0) {
+    data::device_arena.record("Material XS tables",
+      model::material_xs_table_size * (2*sizeof(double) + sizeof(uint8_t)));
+  }
+  if (model::majorant_size > 0) {
+    data::device_arena.record("Majorant XS",
+      model::majorant_size * sizeof(double));
+  }
+  if (model::tms_majorant_bins > 0) {
+    data::device_arena.record("TMS majorant XS",
+      model::tms_majorant.size() * sizeof(double));
+  }
+}
+
+} // namespace
+
+void move_read_only_data_to_device()
+{
+  // Enforce any device-specific assumptions or limitations on user inputs
+  enforce_assumptions();
+
+  // Copy all global settings into device globals
+  move_settings_to_device();
+
+  #ifdef _OPENMP
+  int host_id = omp_get_initial_device();
+  int device_id = omp_get_default_device();
+  #else
+  int host_id = 0;
+  int device_id = 0;
+  #endif
+  size_t sz;
+
+  // Geometry /////////////////////////////////////////////////////////
+  begin_phase("Moving geometry");
+  move_geometry_to_device();
+  end_phase();
+
+  // Nuclear data /////////////////////////////////////////////////////
+  begin_phase("Moving nuclear data");
+  data::energy_min[0]; // Lazy extern template expansion workaround
+  data::energy_max[0]; // Lazy extern template expansion workaround
+  #pragma omp target update to(data::energy_min)
+  #pragma omp target update to(data::energy_max)
+
+  // Nuclear data kept on device from the last simulation only needs what was
+  // loaded since
+  if (device_nuclear_data.resident && can_add_nuclear_data()) {
+    add_nuclear_data_to_device();
+  } else {
+    if (device_nuclear_data.resident) {
+      release_nuclear_data_from_device();
+    }
+    move_nuclear_data_to_device();
+  }
+  device_nuclear_data.resident = false;
+  record_nuclear_data();
+
+  // Multigroup cross sections, decoded again for every simulation as the
+  // macroscopic data follows the materials
+  if (!settings::run_CE) {
+    if (mpi::master) {
+      std::cout << " Moving multigroup cross sections to device..." << std::endl;
+    }
+    data::mg_tables.build(data::mg);
+    #pragma omp target update to(data::mg_tables)
+    data::mg_tables.copy_to_device();
+    data::device_arena.record("Multigroup cross sections",
+      data::mg_tables.nbytes());
+  }
+  end_phase();
+
+  // Materials /////////////////////////////////////////////////////////
+
+  begin_phase("Moving materials");
+
+  // Materials kept on device from the last simulation with the same layout
+  // only need the atom densities changed since
+  if (device_materials.resident &&
+      device_materials.n_materials == model::materials_size &&
+      device_materials.n_nuclides == data::nuclides_size) {
+    update_resident_materials();
+  } else {
+    if (device_materials.resident) {
+      release_materials_from_device();
+    }
+    move_materials_to_device();
+  }
+  device_materials.resident = false;
+  device_materials.changed.clear();
+  end_phase();
 
   // Source Bank ///////////////////////////////////////////////////////
 
+  begin_phase("Moving particle banks");
+
   simulation::device_source_bank = simulation::source_bank.data();
-  #pragma omp target enter data map(alloc: simulation::device_source_bank[:simulation::source_bank.size()])
+  #pragma omp target enter data map(alloc: simulation::device_source_bank[:simulation::source_bank.capacity()])
+  if (settings::async_bank_exchange) {
+    simulation::source_order.resize(simulation::source_bank.capacity());
+    simulation::device_source_order = simulation::source_order.data();
+    #pragma omp target enter data map(alloc: simulation::device_source_order[:simulation::source_order.size()])
+  }
+  if (settings::device_source) {
+    copy_external_sources_to_device();
+    data::device_arena.record("External sources",
+      model::external_sources_flat.size());
+  }
   simulation::fission_bank.allocate_on_device();
+  simulation::fission_spill.allocate_on_device();
+  simulation::secondary_pool.allocate_on_device();
+  simulation::device_secondary_pool_link = simulation::secondary_pool_link.data();
+  #pragma omp target enter data map(alloc: simulation::device_secondary_pool_link[:simulation::secondary_pool_link.size()])
+  // The fission bank, its spill buffer and the secondary pool record their
+  // own device memory
+  data::device_arena.record("Particle banks",
+    simulation::source_bank.capacity() * sizeof(Particle::Bank) +
+    simulation::secondary_pool_link.size() * sizeof(int));
 
   // MPI Work Indices ///////////////////////////////////////////////////
 
@@ -314,10 +1152,28 @@ void move_read_only_data_to_device()
   // Progeny per Particle ///////////////////////////////////////////////////
 
   simulation::device_progeny_per_particle = simulation::progeny_per_particle.data();
-  #pragma omp target enter data map(alloc: simulation::device_progeny_per_particle[:simulation::progeny_per_particle.size()])
+  #pragma omp target enter data map(alloc: simulation::device_progeny_per_particle[:simulation::progeny_per_particle.capacity()])
+
+  // Fission bank sorting and resampling scratch ////////////////////////////
+
+  if (settings::device_fission_bank) {
+    simulation::device_fission_bank_scratch = simulation::fission_bank_scratch.data();
+    simulation::device_fission_site_offsets = simulation::fission_site_offsets.data();
+    simulation::device_fission_scan_chunks = simulation::fission_scan_chunks.data();
+    #pragma omp target enter data map(alloc: simulation::device_fission_bank_scratch[:simulation::fission_bank_scratch.size()], \
+      simulation::device_fission_site_offsets[:simulation::fission_site_offsets.size()], \
+      simulation::device_fission_scan_chunks[:simulation::fission_scan_chunks.size()])
+    data::device_arena.record("Fission bank scratch",
+      simulation::fission_bank_scratch.size() * sizeof(Particle::Bank) +
+      (simulation::fission_site_offsets.size() + simulation::fission_scan_chunks.size()) *
+      sizeof(int64_t));
+  }
+
+  end_phase();
 
   // Filters ////////////////////////////////////////////////////////////////
 
+  begin_phase("Moving tally filters");
   if (mpi::master) {
     std::cout << " Moving " << model::n_tally_filters << " tally filters to device..." << std::endl;
   }
@@ -326,9 +1182,11 @@ void move_read_only_data_to_device()
   for (int i = 0; i < model::n_tally_filters; i++) {
     model::tally_filters[i].copy_to_device();
   }
+  end_phase();
 
   // Meshes ////////////////////////////////////////////////////////////////
 
+  begin_phase("Moving meshes");
   if (mpi::master) {
     std::cout << " Moving " << model::meshes_size << " meshes to device..." << std::endl;
   }
@@ -337,21 +1195,72 @@ void move_read_only_data_to_device()
   for (int i = 0; i < model::meshes_size; i++) {
     model::meshes[i].copy_to_device();
   }
+  end_phase();
+
+  // Weight windows ////////////////////////////////////////////////////////
+
+  begin_phase("Moving weight windows");
+  if (!variance_reduction::weight_windows.empty()) {
+    auto& windows {variance_reduction::weight_windows};
+    variance_reduction::device_weight_windows = windows.data();
+    #pragma omp target enter data map(to: variance_reduction::device_weight_windows[:windows.size()])
+    size_t n_bytes = windows.size() * sizeof(windows[0]);
+    for (auto& ww : windows) {
+      ww.copy_to_device();
+      n_bytes += (ww.energy_bounds_.size() + ww.lower_ww_.size() +
+        ww.upper_ww_.size()) * sizeof(double);
+    }
+    #pragma omp target update to(variance_reduction::particle_weight_windows)
+    data::device_arena.record("Weight windows", n_bytes);
+  }
+  end_phase();
+
+  // Tally derivatives /////////////////////////////////////////
+
+  begin_phase("Moving tallies");
+  model::device_tally_derivs = model::tally_derivs.data();
+  model::n_tally_derivs = model::tally_derivs.size();
+  #pragma omp target update to(model::n_tally_derivs)
+  #pragma omp target enter data map(to: model::device_tally_derivs[:model::n_tally_derivs])
 
   // Tallies ///////////////////////////////////////////////////
 
   if (mpi::master) {
     std::cout << " Moving " << model::tallies_size << " tallies to device..." << std::endl;
   }
+  for (int i = 0; i < model::tallies_size; ++i) {
+    model::tallies[i].init_device_scoring();
+  }
+  init_collapsed_tallies();
+  init_shared_filters();
   #pragma omp target update to(model::tallies_size)
   #pragma omp target enter data map(to: model::tallies[:model::tallies_size])
   for (int i = 0; i < model::tallies_size; ++i) {
     auto& tally = model::tallies[i];
     if (mpi::master) {
-      std::cout << "   Moving tally " << tally.id_ << " containing " << tally.n_filter_bins() << " bins with " << tally.n_scores_ << " scores each. Total size: " << (double) tally.results_size_ * sizeof(double) / 1.0e6 << " MB" << std::endl;
+      std::cout << "   Moving tally " << tally.id_ << " containing " << tally.n_filter_bins() << " bins with " << tally.n_scores_ << " scores each. Total size: " << (double) tally.results_size_ * sizeof(double) / 1.0e6 << " MB";
+      if (tally.n_replicas_ > 0) {
+        std::cout << " (" << tally.n_replicas_ << " replicas)";
+      }
+      if (tally.n_sparse_blocks_ > 0) {
+        std::cout << " (sparse, room for " << tally.sparse_capacity_ << " of "
+          << tally.n_sparse_blocks_ << " blocks)";
+      }
+      if (tally.accumulate_on_device_) {
+        std::cout << " (accumulated on device)";
+      }
+      if (tally.collapse_parent_ != C_NONE) {
+        std::cout << " (collapsed from tally "
+          << model::tallies[tally.collapse_parent_].id_ << ")";
+      }
+      std::cout << std::endl;
     }
     tally.copy_to_device();
+    data::device_arena.record("Tally results", tally.device_results_bytes());
   }
+  end_phase();
+
+  print_memory_report("the end of initialization");
 
   #ifdef OPENMC_MPI
   MPI_Barrier( mpi::intracomm );
@@ -364,18 +1273,77 @@ void release_data_from_device()
   if (mpi::master) {
     std::cout << " Releasing data from device..." << std::endl;
   }
-  for (int i = 0; i < data::nuclides_size; ++i) {
-    data::nuclides[i].release_from_device();
+  if (settings::keep_device_data) {
+    device_materials.resident = true;
+    device_materials.n_materials = model::materials_size;
+    device_materials.n_nuclides = data::nuclides_size;
+    device_materials.changed.clear();
+  } else {
+    release_materials_from_device();
   }
+  release_external_sources_from_device();
 
-  for (int i = 0; i < data::elements_size; ++i) {
-    data::elements[i].release_from_device();
+  if (!data::mg_tables.empty()) {
+    data::mg_tables.release_device();
+    data::mg_tables.clear();
   }
 
   for (int i = 0; i < model::tallies_size; ++i) {
     model::tallies[i].release_from_device();
   }
+  #pragma omp target exit data map(release: model::device_tally_derivs[:model::n_tally_derivs])
+
+  if (!variance_reduction::weight_windows.empty()) {
+    auto& windows {variance_reduction::weight_windows};
+    for (auto& ww : windows) {
+      ww.release_device();
+    }
+    #pragma omp target exit data map(release: variance_reduction::device_weight_windows[:windows.size()])
+  }
+
+  if (settings::keep_device_data) {
+    device_nuclear_data.resident = true;
+    data::device_arena.reset_records();
+  } else {
+    release_nuclear_data_from_device();
+  }
+}
+
+void release_resident_data_from_device()
+{
+  if (device_materials.resident) {
+    release_materials_from_device();
+  }
+  if (device_nuclear_data.resident) {
+    release_nuclear_data_from_device();
+  }
+}
+
+void mark_material_changed(int32_t i, bool layout)
+{
+  if (!device_materials.resident) return;
+
+  // The serialized rows and XS tables are sized for the old compositions
+  if (layout) {
+    release_materials_from_device();
+  } else {
+    device_materials.changed.push_back(i);
+  }
 }
 
 
+size_t free_device_memory()
+{
+#ifdef CUDA_THRUST_SORT
+  size_t free_bytes, total_bytes;
+  if (device_memory_info(&free_bytes, &total_bytes)) return free_bytes;
+#endif
+  if (settings::device_memory > 0.0) {
+    double assumed = settings::device_memory * 1.0e9;
+    double used = data::device_arena.total_bytes();
+    return assumed > used ? static_cast<size_t>(assumed - used) : 0;
+  }
+  return 0;
+}
+
 } // namespace openmc
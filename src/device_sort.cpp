@@ -0,0 +1,515 @@
+#include "openmc/device_sort.h"
+
+#include <algorithm> // for min, max
+#include <vector>
+
+#include "openmc/constants.h"
+#include "openmc/particle.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+#include "openmc/sort.h"
+
+namespace openmc {
+
+//==============================================================================
+// Device scratch memory
+//==============================================================================
+
+namespace {
+
+// Buffers used by device_radix_sort() and device_bucket_scatter(). These are
+// allocated on host and mapped
+// to device once, growing only if a larger queue is ever sorted.
+struct RadixSortScratch {
+  int capacity {0};
+  int hist_size {0};
+  int chunk_size {0};
+  uint64_t* keys {nullptr};
+  uint64_t* keys_alt {nullptr};
+  uint32_t* perm {nullptr};
+  uint32_t* perm_alt {nullptr};
+  EventQueueItem* items_alt {nullptr};
+  int* hist {nullptr};
+  int* chunk_sums {nullptr};
+  int* bucket_chunk_sums {nullptr};
+  int bucket_chunk_size {0};
+
+  void reserve(int n)
+  {
+    if (n <= capacity) return;
+    clear();
+
+    capacity = n;
+    hist_size = RADIX_BUCKETS * ((n + RADIX_TILE - 1) / RADIX_TILE);
+    chunk_size = (hist_size + SCAN_CHUNK - 1) / SCAN_CHUNK;
+    keys = new uint64_t[capacity];
+    keys_alt = new uint64_t[capacity];
+    perm = new uint32_t[capacity];
+    perm_alt = new uint32_t[capacity];
+    items_alt = new EventQueueItem[capacity];
+    hist = new int[hist_size];
+    chunk_sums = new int[chunk_size];
+
+    #pragma omp target enter data map(alloc: keys[:capacity], \
+      keys_alt[:capacity], perm[:capacity], perm_alt[:capacity], \
+      items_alt[:capacity], hist[:hist_size], chunk_sums[:chunk_size])
+  }
+
+  void reserve_buckets(int n_buckets)
+  {
+    int size = (n_buckets + SCAN_CHUNK - 1) / SCAN_CHUNK;
+    if (size <= bucket_chunk_size) return;
+    clear_buckets();
+
+    bucket_chunk_size = size;
+    bucket_chunk_sums = new int[size];
+    #pragma omp target enter data map(alloc: bucket_chunk_sums[:size])
+  }
+
+  void clear_buckets()
+  {
+    if (bucket_chunk_size == 0) return;
+    #pragma omp target exit data map(delete: \
+      bucket_chunk_sums[:bucket_chunk_size])
+    delete[] bucket_chunk_sums;
+    bucket_chunk_sums = nullptr;
+    bucket_chunk_size = 0;
+  }
+
+  void clear()
+  {
+    if (capacity == 0) return;
+
+    #pragma omp target exit data map(delete: keys[:capacity], \
+      keys_alt[:capacity], perm[:capacity], perm_alt[:capacity], \
+      items_alt[:capacity], hist[:hist_size], chunk_sums[:chunk_size])
+
+    delete[] keys;
+    delete[] keys_alt;
+    delete[] perm;
+    delete[] perm_alt;
+    delete[] items_alt;
+    delete[] hist;
+    delete[] chunk_sums;
+    keys = keys_alt = nullptr;
+    perm = perm_alt = nullptr;
+    items_alt = nullptr;
+    hist = chunk_sums = nullptr;
+    capacity = hist_size = chunk_size = 0;
+  }
+};
+
+RadixSortScratch radix_scratch;
+
+} // namespace
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+namespace {
+
+template<typename T>
+void exclusive_scan_chunks(T* data, T n, T* chunk_sums)
+{
+  T n_chunks = (n + SCAN_CHUNK - 1) / SCAN_CHUNK;
+
+  // Sum each chunk
+  #pragma omp target teams distribute parallel for
+  for (T c = 0; c < n_chunks; ++c) {
+    T last = std::min<T>((c + 1) * SCAN_CHUNK, n);
+    T sum = 0;
+    for (T i = c * SCAN_CHUNK; i < last; ++i) {
+      sum += data[i];
+    }
+    chunk_sums[c] = sum;
+  }
+
+  // Scan the chunk sums. There are SCAN_CHUNK times fewer of these than
+  // elements, so a single device thread is sufficient.
+  #pragma omp target
+  {
+    T running = 0;
+    for (T c = 0; c < n_chunks; ++c) {
+      T sum = chunk_sums[c];
+      chunk_sums[c] = running;
+      running += sum;
+    }
+  }
+
+  // Scan within each chunk, starting from the chunk's offset
+  #pragma omp target teams distribute parallel for
+  for (T c = 0; c < n_chunks; ++c) {
+    T last = std::min<T>((c + 1) * SCAN_CHUNK, n);
+    T running = chunk_sums[c];
+    for (T i = c * SCAN_CHUNK; i < last; ++i) {
+      T value = data[i];
+      data[i] = running;
+      running += value;
+    }
+  }
+}
+
+} // namespace
+
+void device_exclusive_scan(int* data, int n, int* chunk_sums)
+{
+  exclusive_scan_chunks(data, n, chunk_sums);
+}
+
+void device_exclusive_scan(int64_t* data, int64_t n, int64_t* chunk_sums)
+{
+  exclusive_scan_chunks(data, n, chunk_sums);
+}
+
+namespace {
+
+//! Bounds of the positions of the particles of a device-resident queue,
+//! over which SortBy::position keys are quantized
+struct PositionBounds {
+  double lower[3];
+  double inv_width[3];
+};
+
+PositionBounds position_bounds(const EventQueueItem* items, int n)
+{
+  double x_min = INFTY, y_min = INFTY, z_min = INFTY;
+  double x_max = -INFTY, y_max = -INFTY, z_max = -INFTY;
+  #pragma omp target teams distribute parallel for \
+    reduction(min: x_min, y_min, z_min) reduction(max: x_max, y_max, z_max)
+  for (int i = 0; i < n; ++i) {
+    const Position& r = simulation::device_particles[items[i].idx].r();
+    x_min = std::min(x_min, r.x);
+    y_min = std::min(y_min, r.y);
+    z_min = std::min(z_min, r.z);
+    x_max = std::max(x_max, r.x);
+    y_max = std::max(y_max, r.y);
+    z_max = std::max(z_max, r.z);
+  }
+
+  // Directions in which every particle has the same coordinate contribute
+  // nothing to the keys
+  PositionBounds b {{x_min, y_min, z_min}, {}};
+  double width[3] {x_max - x_min, y_max - y_min, z_max - z_min};
+  for (int k = 0; k < 3; ++k) {
+    b.inv_width[k] = width[k] > 0.0 ?
+      (uint64_t {1} << MORTON_BITS) / width[k] : 0.0;
+  }
+  return b;
+}
+
+#pragma omp declare target
+//! Key of a queue item, which for SortBy::position is the Morton key of its
+//! particle's position
+inline uint64_t queue_sort_key(const EventQueueItem& item, SortBy sort_by,
+  const double* lower, const double* inv_width)
+{
+  if (sort_by != SortBy::position) return sort_key(item, sort_by);
+  const Position& r = simulation::device_particles[item.idx].r();
+  return position_key(r.x, r.y, r.z, lower, inv_width);
+}
+#pragma omp end declare target
+
+//! Build the packed keys (and identity permutation) for a device-resident
+//! queue, returning a mask of the key bits that differ between items
+uint64_t build_sort_keys(const EventQueueItem* items, int n, SortBy sort_by,
+  uint64_t* keys, uint32_t* perm)
+{
+  PositionBounds b {};
+  if (sort_by == SortBy::position) b = position_bounds(items, n);
+  const double* lower = b.lower;
+  const double* inv_width = b.inv_width;
+
+  uint64_t varying = 0;
+  #pragma omp target teams distribute parallel for reduction(|:varying) \
+    map(to: lower[:3], inv_width[:3])
+  for (int i = 0; i < n; ++i) {
+    keys[i] = queue_sort_key(items[i], sort_by, lower, inv_width);
+    perm[i] = i;
+    varying |= keys[i] ^ queue_sort_key(items[0], sort_by, lower, inv_width);
+  }
+  return varying;
+}
+
+//! Perform the radix sort passes over keys and a payload array, returning
+//! whether the sorted result ended up in the alternate buffers
+template<typename T>
+bool radix_sort_passes(uint64_t* keys, uint64_t* keys_alt, T* payload,
+  T* payload_alt, int n, uint64_t varying)
+{
+  auto& s = radix_scratch;
+  int* hist = s.hist;
+  int* chunk_sums = s.chunk_sums;
+  int n_tiles = (n + RADIX_TILE - 1) / RADIX_TILE;
+
+  bool in_alt = false;
+  for (int shift = 0; shift < 64; shift += RADIX_BITS) {
+    // Digits that are the same for every item do not need a pass
+    if (((varying >> shift) & (RADIX_BUCKETS - 1)) == 0) continue;
+
+    const uint64_t* src_keys = in_alt ? keys_alt : keys;
+    uint64_t* dst_keys = in_alt ? keys : keys_alt;
+    const T* src = in_alt ? payload_alt : payload;
+    T* dst = in_alt ? payload : payload_alt;
+
+    // Histogram each tile. Counts are stored digit-major so that an exclusive
+    // scan over the whole array yields each tile's output offset per digit.
+    #pragma omp target teams distribute parallel for
+    for (int t = 0; t < n_tiles; ++t) {
+      for (int b = 0; b < RADIX_BUCKETS; ++b) {
+        hist[b * n_tiles + t] = 0;
+      }
+      int last = std::min((t + 1) * RADIX_TILE, n);
+      for (int i = t * RADIX_TILE; i < last; ++i) {
+        int digit = (src_keys[i] >> shift) & (RADIX_BUCKETS - 1);
+        hist[digit * n_tiles + t]++;
+      }
+    }
+
+    device_exclusive_scan(hist, RADIX_BUCKETS * n_tiles, chunk_sums);
+
+    // Scatter each tile in order, which keeps the pass stable
+    #pragma omp target teams distribute parallel for
+    for (int t = 0; t < n_tiles; ++t) {
+      int last = std::min((t + 1) * RADIX_TILE, n);
+      for (int i = t * RADIX_TILE; i < last; ++i) {
+        uint64_t key = src_keys[i];
+        int digit = (key >> shift) & (RADIX_BUCKETS - 1);
+        int j = hist[digit * n_tiles + t]++;
+        dst_keys[j] = key;
+        dst[j] = src[i];
+      }
+    }
+
+    in_alt = !in_alt;
+  }
+  return in_alt;
+}
+
+//! Permute a device-resident queue so that position i holds the item that was
+//! previously at position perm[i]
+void gather_queue(EventQueueItem* items, const uint32_t* perm, int n)
+{
+  EventQueueItem* items_alt = radix_scratch.items_alt;
+
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n; ++i) {
+    items_alt[i] = items[perm[i]];
+  }
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n; ++i) {
+    items[i] = items_alt[i];
+  }
+}
+
+} // namespace
+
+void device_radix_sort(SharedArray<EventQueueItem>& queue, SortBy sort_by)
+{
+  int n = queue.size();
+  if (n <= 1) return;
+
+  auto& s = radix_scratch;
+  s.reserve(queue.capacity());
+
+  // Local copies of the (host) pointers, which are translated to their
+  // corresponding device addresses when referenced in target regions
+  EventQueueItem* items = queue.data();
+  EventQueueItem* items_alt = s.items_alt;
+
+  uint64_t varying = build_sort_keys(items, n, sort_by, s.keys, s.perm);
+
+  if (settings::sort_key_index) {
+    // Sort keys with their original positions, then gather the queue once
+    bool in_alt = radix_sort_passes(s.keys, s.keys_alt, s.perm, s.perm_alt,
+      n, varying);
+    gather_queue(items, in_alt ? s.perm_alt : s.perm, n);
+  } else {
+    // Move the full queue items in every pass
+    bool in_alt = radix_sort_passes(s.keys, s.keys_alt, items, items_alt,
+      n, varying);
+
+    // Make sure the sorted result ends up in the queue itself
+    if (in_alt) {
+      #pragma omp target teams distribute parallel for
+      for (int i = 0; i < n; ++i) {
+        items[i] = items_alt[i];
+      }
+    }
+  }
+}
+
+void device_sort_keys(uint64_t* keys, uint32_t* perm, int n)
+{
+  if (n <= 1) {
+    if (n == 1) {
+      #pragma omp target
+      {
+        perm[0] = 0;
+      }
+    }
+    return;
+  }
+
+  auto& s = radix_scratch;
+  s.reserve(n);
+  uint64_t* s_keys = s.keys;
+  uint32_t* s_perm = s.perm;
+
+  uint64_t varying = 0;
+  #pragma omp target teams distribute parallel for reduction(|:varying)
+  for (int i = 0; i < n; ++i) {
+    s_keys[i] = keys[i];
+    s_perm[i] = i;
+    varying |= keys[i] ^ keys[0];
+  }
+
+  bool in_alt = radix_sort_passes(s.keys, s.keys_alt, s.perm, s.perm_alt,
+    n, varying);
+  const uint64_t* sorted_keys = in_alt ? s.keys_alt : s.keys;
+  const uint32_t* sorted_perm = in_alt ? s.perm_alt : s.perm;
+
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n; ++i) {
+    keys[i] = sorted_keys[i];
+    perm[i] = sorted_perm[i];
+  }
+}
+
+void host_key_index_sort(SharedArray<EventQueueItem>& queue, SortBy sort_by)
+{
+  int n = queue.size();
+  if (n <= 1) return;
+
+  auto& s = radix_scratch;
+  s.reserve(queue.capacity());
+  uint64_t* keys = s.keys;
+  uint32_t* perm = s.perm;
+
+  build_sort_keys(queue.data(), n, sort_by, keys, perm);
+
+  // Sort (key, index) pairs on host. The indices start out as the identity
+  // permutation, so only the keys need to be transferred.
+  #pragma omp target update from(keys[:n])
+  std::vector<SortKeyIndex> pairs(n);
+  for (int i = 0; i < n; ++i) {
+    pairs[i] = {keys[i], static_cast<uint32_t>(i)};
+  }
+  quickSort_parallel(pairs.data(), n, SortKeyIndexCmp(), SortKeyIndexCmpG());
+  for (int i = 0; i < n; ++i) {
+    perm[i] = pairs[i].idx;
+  }
+  #pragma omp target update to(perm[:n])
+
+  gather_queue(queue.data(), perm, n);
+}
+
+void device_bucket_scatter(SharedArray<EventQueueItem>& queue, EventType type,
+  int* counts, int first_bucket, int n_buckets)
+{
+  int n = queue.size();
+  auto& s = radix_scratch;
+  s.reserve(queue.capacity());
+  s.reserve_buckets(n_buckets);
+
+  EventQueueItem* items = queue.data();
+  EventQueueItem* items_alt = s.items_alt;
+
+  // Turn the bucket populations into the starting position of each bucket
+  device_exclusive_scan(counts, n_buckets, s.bucket_chunk_sums);
+
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n; ++i) {
+    int b = xs_bucket(items[i], type) - first_bucket;
+    int j;
+    #pragma omp atomic capture
+    j = counts[b]++;
+    items_alt[j] = items[i];
+  }
+
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n; ++i) {
+    items[i] = items_alt[i];
+  }
+
+  // Reset the counts for the particles enqueued during the next iteration
+  #pragma omp target teams distribute parallel for
+  for (int b = 0; b < n_buckets; ++b) {
+    counts[b] = 0;
+  }
+}
+
+void device_partition_by_class(SharedArray<EventQueueItem>& queue,
+  PartitionBy partition_by, int n_classes, int* class_offsets)
+{
+  int n = queue.size();
+  for (int c = 0; c <= n_classes; ++c) {
+    class_offsets[c] = n;
+  }
+  if (n == 0) return;
+
+  auto& s = radix_scratch;
+  s.reserve(queue.capacity());
+  EventQueueItem* items = queue.data();
+  uint64_t* keys = s.keys;
+  uint32_t* perm = s.perm;
+
+  uint64_t varying = 0;
+  #pragma omp target teams distribute parallel for reduction(|:varying)
+  for (int i = 0; i < n; ++i) {
+    keys[i] = partition_class(items[i], partition_by);
+    perm[i] = i;
+    varying |= keys[i] ^ partition_class(items[0], partition_by);
+  }
+
+  // The radix sort is stable, so items keep their (e.g., energy) order within
+  // each class
+  bool in_alt = false;
+  if (varying != 0) {
+    in_alt = radix_sort_passes(keys, s.keys_alt, perm, s.perm_alt, n, varying);
+    gather_queue(items, in_alt ? s.perm_alt : perm, n);
+  }
+
+  // Find where each class starts. Classes without items keep a start of n
+  // and are fixed up afterwards.
+  const uint64_t* sorted = in_alt ? s.keys_alt : keys;
+  #pragma omp target teams distribute parallel for \
+    map(tofrom: class_offsets[:n_classes + 1])
+  for (int i = 0; i < n; ++i) {
+    if (i == 0 || sorted[i - 1] != sorted[i]) {
+      class_offsets[sorted[i]] = i;
+    }
+  }
+  for (int c = n_classes - 1; c >= 0; --c) {
+    class_offsets[c] = std::min(class_offsets[c], class_offsets[c + 1]);
+  }
+}
+
+int count_unsorted(SharedArray<EventQueueItem>& queue, SortBy sort_by)
+{
+  int n = queue.size();
+  const EventQueueItem* items = queue.data();
+
+  PositionBounds b {};
+  if (sort_by == SortBy::position && n > 0) b = position_bounds(items, n);
+  const double* lower = b.lower;
+  const double* inv_width = b.inv_width;
+
+  int not_sorted = 0;
+  #pragma omp target teams distribute parallel for reduction(+:not_sorted) \
+    map(to: lower[:3], inv_width[:3])
+  for (int i = 1; i < n; ++i) {
+    if (queue_sort_key(items[i - 1], sort_by, lower, inv_width) >
+        queue_sort_key(items[i], sort_by, lower, inv_width))
+      not_sorted += 1;
+  }
+  return not_sorted;
+}
+
+void free_device_sort_scratch()
+{
+  radix_scratch.clear();
+  radix_scratch.clear_buckets();
+}
+
+} // namespace openmc
@@ -14,6 +14,63 @@
 
 namespace openmc {
 
+//==============================================================================
+// DistributionFlat implementation
+//==============================================================================
+
+DistributionFlat::DistributionFlat(const uint8_t* data) : data_{data}
+{
+  type_ = static_cast<DistType>(*reinterpret_cast<const int*>(data_));
+}
+
+double DistributionFlat::sample(uint64_t* seed) const
+{
+  auto params = reinterpret_cast<const double*>(data_ + 8);
+  switch (type_) {
+  case DistType::DISCRETE:
+    {
+      int n = *reinterpret_cast<const int*>(data_ + 4);
+      const double* x = params;
+      const double* p = params + n;
+      if (n > 1) {
+        double xi = prn(seed);
+        double c = 0.0;
+        for (int i = 0; i < n - 1; ++i) {
+          c += p[i];
+          if (xi < c) return x[i];
+        }
+      }
+      return x[n - 1];
+    }
+  case DistType::UNIFORM:
+    return params[0] + prn(seed)*(params[1] - params[0]);
+  case DistType::MAXWELL:
+    return maxwell_spectrum(params[0], seed);
+  case DistType::WATT:
+    return watt_spectrum(params[0], params[1], seed);
+  case DistType::NORMAL:
+    return normal_variate(params[0], params[1], seed);
+  case DistType::MUIR:
+    return muir_spectrum(params[0], params[1], params[2], seed);
+  case DistType::TABULAR:
+    {
+      TabularFlat dist(data_ + 8);
+      return dist.sample(seed);
+    }
+  case DistType::EQUIPROBABLE:
+    {
+      int n = *reinterpret_cast<const int*>(data_ + 4);
+      double r = prn(seed);
+      int i = std::floor((n - 1)*r);
+      double xl = params[i];
+      double xr = params[i+1];
+      return xl + ((n - 1)*r - i) * (xr - xl);
+    }
+  default:
+    UNREACHABLE();
+  }
+}
+
 //==============================================================================
 // Discrete implementation
 //==============================================================================
@@ -51,6 +108,14 @@ double Discrete::sample(uint64_t* seed) const
   }
 }
 
+void Discrete::serialize_tagged(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(DistType::DISCRETE)); // 4
+  buffer.add(static_cast<int>(x_.size()));          // 4
+  buffer.add(x_);                                   // 8*n
+  buffer.add(p_);                                   // 8*n
+}
+
 void Discrete::normalize()
 {
   // Renormalize density function so that it sums to unity
@@ -81,6 +146,14 @@ double Uniform::sample(uint64_t* seed) const
   return a_ + prn(seed)*(b_ - a_);
 }
 
+void Uniform::serialize_tagged(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(DistType::UNIFORM)); // 4
+  buffer.align(8);                                 // 4
+  buffer.add(a_);                                  // 8
+  buffer.add(b_);                                  // 8
+}
+
 //==============================================================================
 // Maxwell implementation
 //==============================================================================
@@ -95,6 +168,13 @@ double Maxwell::sample(uint64_t* seed) const
   return maxwell_spectrum(theta_, seed);
 }
 
+void Maxwell::serialize_tagged(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(DistType::MAXWELL)); // 4
+  buffer.align(8);                                 // 4
+  buffer.add(theta_);                              // 8
+}
+
 //==============================================================================
 // Watt implementation
 //==============================================================================
@@ -115,6 +195,14 @@ double Watt::sample(uint64_t* seed) const
   return watt_spectrum(a_, b_, seed);
 }
 
+void Watt::serialize_tagged(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(DistType::WATT)); // 4
+  buffer.align(8);                              // 4
+  buffer.add(a_);                               // 8
+  buffer.add(b_);                               // 8
+}
+
 //==============================================================================
 // Normal implementation
 //==============================================================================
@@ -135,6 +223,14 @@ double Normal::sample(uint64_t* seed) const
   return normal_variate(mean_value_, std_dev_, seed);
 }
 
+void Normal::serialize_tagged(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(DistType::NORMAL)); // 4
+  buffer.align(8);                                // 4
+  buffer.add(mean_value_);                        // 8
+  buffer.add(std_dev_);                           // 8
+}
+
 //==============================================================================
 // Muir implementation
 //==============================================================================
@@ -156,6 +252,15 @@ double Muir::sample(uint64_t* seed) const
   return muir_spectrum(e0_, m_rat_, kt_, seed);
 }
 
+void Muir::serialize_tagged(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(DistType::MUIR)); // 4
+  buffer.align(8);                              // 4
+  buffer.add(e0_);                              // 8
+  buffer.add(m_rat_);                           // 8
+  buffer.add(kt_);                              // 8
+}
+
 //==============================================================================
 // Tabular implementation
 //==============================================================================
@@ -263,6 +368,13 @@ double Tabular::sample(uint64_t* seed) const
   }
 }
 
+void Tabular::serialize_tagged(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(DistType::TABULAR)); // 4
+  buffer.align(8);                                 // 4
+  serialize(buffer);
+}
+
 void Tabular::serialize(DataBuffer& buffer) const
 {
   buffer.add(static_cast<int>(interp_));  // 4
@@ -356,10 +468,17 @@ double Equiprobable::sample(uint64_t* seed) const
   int i = std::floor((n - 1)*r);
 
   double xl = x_[i];
-  double xr = x_[i+i];
+  double xr = x_[i+1];
   return xl + ((n - 1)*r - i) * (xr - xl);
 }
 
+void Equiprobable::serialize_tagged(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(DistType::EQUIPROBABLE)); // 4
+  buffer.add(static_cast<int>(x_.size()));              // 4
+  buffer.add(x_);                                       // 8*n
+}
+
 //==============================================================================
 // Helper function
 //==============================================================================
@@ -394,4 +513,12 @@ UPtrDist distribution_from_xml(pugi::xml_node node)
   return dist;
 }
 
+size_t tagged_nbytes(const Distribution& dist)
+{
+  DataBuffer buffer;
+  buffer.mode_ = DataBuffer::Mode::count;
+  dist.serialize_tagged(buffer);
+  return buffer.size();
+}
+
 } // namespace openmc
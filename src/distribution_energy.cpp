@@ -13,9 +13,25 @@
 #include "openmc/math_functions.h"
 #include "openmc/random_lcg.h"
 #include "openmc/search.h"
+#include "openmc/settings.h"
+#include "openmc/xs_cache.h"
 
 namespace openmc {
 
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace data {
+
+ContinuousTabularTables ct_tables;
+
+} // namespace data
+
+//==============================================================================
+// EnergyDistributionFlat implementation
+//==============================================================================
+
 EnergyDistributionFlat::EnergyDistributionFlat(const uint8_t* data)
   : data_{data}
 {
@@ -40,6 +56,9 @@ double EnergyDistributionFlat::sample(double E, uint64_t* seed) const
       ContinuousTabularFlat dist(data_);
       return dist.sample(E, seed);
     }
+  case EnergyDistType::CONTINUOUS_TABULAR_TABLE:
+    return data::ct_tables.sample(*reinterpret_cast<const int*>(data_ + 4), E,
+      seed);
   case EnergyDistType::EVAPORATION:
     {
       EvaporationFlat dist(data_);
@@ -221,6 +240,8 @@ ContinuousTabular::ContinuousTabular(hid_t group)
 
     distribution_.push_back(std::move(d));
   } // incoming energies
+
+  if (settings::decoded_distributions) handle_ = data::ct_tables.add(*this);
 }
 
 double ContinuousTabular::sample(double E, uint64_t* seed) const
@@ -341,6 +362,13 @@ double ContinuousTabular::sample(double E, uint64_t* seed) const
 
 void ContinuousTabular::serialize(DataBuffer& buffer) const
 {
+  // Decoded distributions are only referred to by their handle
+  if (handle_ != C_NONE) {
+    buffer.add(static_cast<int>(EnergyDistType::CONTINUOUS_TABULAR_TABLE)); // 4
+    buffer.add(handle_);                                                    // 4
+    return;
+  }
+
   buffer.add(static_cast<int>(EnergyDistType::CONTINUOUS_TABULAR)); // 4
   buffer.add(n_region_);                                            // 4
   buffer.add(breakpoints_);                                         // 4*n_region_
@@ -563,6 +591,238 @@ CTTableFlat ContinuousTabularFlat::distribution(gsl::index i) const
   return CTTableFlat(data_ + offset);
 }
 
+//==============================================================================
+// ContinuousTabularTables implementation
+//==============================================================================
+
+int ContinuousTabularTables::add(const ContinuousTabular& dist)
+{
+  // Distributions are added by nuclides read on several threads
+  int handle;
+  #pragma omp critical(ct_tables)
+  {
+    handle = histogram_.size();
+    if (handle == 0) energy_start_.push_back(0);
+    histogram_.push_back(dist.n_region_ == 1 &&
+      dist.interpolation_[0] == Interpolation::histogram);
+
+    for (int i = 0; i < dist.energy_.size(); ++i) {
+      const auto& d {dist.distribution_[i]};
+      int n = d.e_out.size();
+      energy_.push_back(dist.energy_[i]);
+      eout_start_.push_back(e_out_.size());
+      n_eout_.push_back(n);
+      n_discrete_.push_back(d.n_discrete);
+      interpolation_.push_back(d.interpolation);
+      e_first_.push_back(n > d.n_discrete ? d.e_out[d.n_discrete] : 0.0);
+      e_last_.push_back(n > d.n_discrete ? d.e_out[n - 1] : 0.0);
+      for (int k = 0; k < n; ++k) {
+        e_out_.push_back(d.e_out[k]);
+        p_.push_back(d.p[k]);
+        c_.push_back(d.c[k]);
+      }
+    }
+    energy_start_.push_back(energy_.size());
+  }
+  return handle;
+}
+
+double ContinuousTabularTables::sample(int handle, double E,
+  uint64_t* seed) const
+{
+  bool histogram_interp = histogram_[handle];
+
+  // Find energy bin and calculate interpolation factor -- if the energy is
+  // outside the range of the tabulated energies, choose the first or last bins
+  int first = energy_start_[handle];
+  int n_energy_in = energy_start_[handle + 1] - first;
+  const double* energy = &energy_[first];
+  int i;
+  double r;
+  if (E < energy[0]) {
+    i = 0;
+    r = 0.0;
+  } else if (E > energy[n_energy_in - 1]) {
+    i = n_energy_in - 2;
+    r = 1.0;
+  } else {
+    i = lower_bound_index(energy, energy + n_energy_in, E);
+    r = (E - energy[i]) / (energy[i+1] - energy[i]);
+  }
+
+  // Sample between the ith and [i+1]th bin
+  int l;
+  if (histogram_interp) {
+    l = i;
+  } else {
+    l = r > prn(seed) ? i + 1 : i;
+  }
+
+  // Interpolation for energy E1 and EK
+  int t_i = first + i;
+  double E_i_1 = e_first_[t_i];
+  double E_i_K = e_last_[t_i];
+  double E_i1_1 = e_first_[t_i + 1];
+  double E_i1_K = e_last_[t_i + 1];
+  double E_1 = E_i_1 + r * (E_i1_1 - E_i_1);
+  double E_K = E_i_K + r * (E_i1_K - E_i_K);
+
+  // Determine outgoing energy bin
+  int t_l = first + l;
+  const double* e_out = &e_out_[eout_start_[t_l]];
+  const double* pdf = &p_[eout_start_[t_l]];
+  const double* cdf = &c_[eout_start_[t_l]];
+  int n_energy_out = n_eout_[t_l];
+  int n_discrete = n_discrete_[t_l];
+  double r1 = prn(seed);
+  double c_k = cdf[0];
+  int k = 0;
+  int end = n_energy_out - 2;
+
+  // Discrete portion
+  for (int j = 0; j < n_discrete; ++j) {
+    k = j;
+    c_k = cdf[k];
+    if (r1 < c_k) {
+      end = j;
+      break;
+    }
+  }
+
+  // Continuous portion
+  double c_k1;
+  for (int j = n_discrete; j < end; ++j) {
+    k = j;
+    c_k1 = cdf[k+1];
+    if (r1 < c_k1) break;
+    k = j + 1;
+    c_k = c_k1;
+  }
+
+  double E_l_k = e_out[k];
+  double p_l_k = pdf[k];
+  double E_out = E_l_k;
+  if (interpolation_[t_l] == Interpolation::histogram) {
+    // Histogram interpolation
+    if (p_l_k > 0.0 && k >= n_discrete) {
+      E_out = E_l_k + (r1 - c_k)/p_l_k;
+    }
+
+  } else if (interpolation_[t_l] == Interpolation::lin_lin) {
+    // Linear-linear interpolation
+    double E_l_k1 = e_out[k+1];
+    double p_l_k1 = pdf[k+1];
+
+    if (E_l_k != E_l_k1) {
+      double frac = (p_l_k1 - p_l_k)/(E_l_k1 - E_l_k);
+      if (frac == 0.0) {
+        E_out = E_l_k + (r1 - c_k)/p_l_k;
+      } else {
+        E_out = E_l_k + (std::sqrt(std::max(0.0, p_l_k*p_l_k +
+                        2.0*frac*(r1 - c_k))) - p_l_k)/frac;
+      }
+    }
+  }
+
+  // Now interpolate between incident energy bins i and i + 1
+  if (!histogram_interp && n_energy_out > 1 && k >= n_discrete) {
+    if (l == i) {
+      return E_1 + (E_out - E_i_1)*(E_K - E_1)/(E_i_K - E_i_1);
+    } else {
+      return E_1 + (E_out - E_i1_1)*(E_K - E_1)/(E_i1_K - E_i1_1);
+    }
+  } else {
+    return E_out;
+  }
+}
+
+void ContinuousTabularTables::copy_to_device()
+{
+  energy_start_.copy_to_device();
+  histogram_.copy_to_device();
+  energy_.copy_to_device();
+  eout_start_.copy_to_device();
+  n_eout_.copy_to_device();
+  n_discrete_.copy_to_device();
+  interpolation_.copy_to_device();
+  e_first_.copy_to_device();
+  e_last_.copy_to_device();
+  e_out_.copy_to_device();
+  p_.copy_to_device();
+  c_.copy_to_device();
+}
+
+void ContinuousTabularTables::release_device()
+{
+  energy_start_.release_device();
+  histogram_.release_device();
+  energy_.release_device();
+  eout_start_.release_device();
+  n_eout_.release_device();
+  n_discrete_.release_device();
+  interpolation_.release_device();
+  e_first_.release_device();
+  e_last_.release_device();
+  e_out_.release_device();
+  p_.release_device();
+  c_.release_device();
+}
+
+void ContinuousTabularTables::clear()
+{
+  energy_start_.clear();
+  histogram_.clear();
+  energy_.clear();
+  eout_start_.clear();
+  n_eout_.clear();
+  n_discrete_.clear();
+  interpolation_.clear();
+  e_first_.clear();
+  e_last_.clear();
+  e_out_.clear();
+  p_.clear();
+  c_.clear();
+}
+
+void ContinuousTabularTables::write_cache(XsCacheWriter& cache) const
+{
+  cache.write(energy_start_);
+  cache.write(histogram_);
+  cache.write(energy_);
+  cache.write(eout_start_);
+  cache.write(n_eout_);
+  cache.write(n_discrete_);
+  cache.write(interpolation_);
+  cache.write(e_first_);
+  cache.write(e_last_);
+  cache.write(e_out_);
+  cache.write(p_);
+  cache.write(c_);
+}
+
+void ContinuousTabularTables::read_cache(XsCacheReader& cache)
+{
+  cache.read(energy_start_);
+  cache.read(histogram_);
+  cache.read(energy_);
+  cache.read(eout_start_);
+  cache.read(n_eout_);
+  cache.read(n_discrete_);
+  cache.read(interpolation_);
+  cache.read(e_first_);
+  cache.read(e_last_);
+  cache.read(e_out_);
+  cache.read(p_);
+  cache.read(c_);
+}
+
+size_t ContinuousTabularTables::nbytes() const
+{
+  return energy_start_.size() * sizeof(int) + histogram_.size() +
+    energy_.size() * (3*sizeof(double) + 3*sizeof(int) + sizeof(Interpolation)) +
+    e_out_.size() * 3*sizeof(double);
+}
+
 //==============================================================================
 // MaxwellEnergy implementation
 //==============================================================================
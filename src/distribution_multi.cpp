@@ -11,6 +11,49 @@
 
 namespace openmc {
 
+//==============================================================================
+// UnitSphereDistributionFlat implementation
+//==============================================================================
+
+UnitSphereDistributionFlat::UnitSphereDistributionFlat(const uint8_t* data)
+  : data_{data}
+{
+  type_ = static_cast<UnitSphereDistType>(*reinterpret_cast<const int*>(data_));
+}
+
+Direction UnitSphereDistributionFlat::sample(uint64_t* seed) const
+{
+  Direction u_ref {reinterpret_cast<const double*>(data_ + 8)};
+  switch (type_) {
+  case UnitSphereDistType::POLAR_AZIMUTHAL:
+    {
+      // Sample cosine of polar angle
+      DistributionFlat mu_dist(data_ + 32);
+      double mu = mu_dist.sample(seed);
+      if (mu == 1.0) return u_ref;
+
+      // Sample azimuthal angle
+      int offset_phi = *reinterpret_cast<const int*>(data_ + 4);
+      DistributionFlat phi_dist(data_ + offset_phi);
+      double phi = phi_dist.sample(seed);
+      if (u_ref.x == 0 && u_ref.y == 0) phi += 0.5*PI;
+
+      return rotate_angle(u_ref, mu, &phi, seed);
+    }
+  case UnitSphereDistType::ISOTROPIC:
+    {
+      double phi = 2.0*PI*prn(seed);
+      double mu = 2.0*prn(seed) - 1.0;
+      return {mu, std::sqrt(1.0 - mu*mu) * std::cos(phi),
+          std::sqrt(1.0 - mu*mu) * std::sin(phi)};
+    }
+  case UnitSphereDistType::MONODIRECTIONAL:
+    return u_ref;
+  default:
+    UNREACHABLE();
+  }
+}
+
 //==============================================================================
 // UnitSphereDistribution implementation
 //==============================================================================
@@ -70,6 +113,18 @@ Direction PolarAzimuthal::sample(uint64_t* seed) const
   return rotate_angle(u_ref_, mu, &phi, seed);
 }
 
+void PolarAzimuthal::serialize(DataBuffer& buffer) const
+{
+  int offset_phi = 32 + tagged_nbytes(*mu_);
+  buffer.add(static_cast<int>(UnitSphereDistType::POLAR_AZIMUTHAL)); // 4
+  buffer.add(offset_phi);                                            // 4
+  buffer.add(u_ref_.x);                                              // 8
+  buffer.add(u_ref_.y);                                              // 8
+  buffer.add(u_ref_.z);                                              // 8
+  mu_->serialize_tagged(buffer);
+  phi_->serialize_tagged(buffer);
+}
+
 //==============================================================================
 // Isotropic implementation
 //==============================================================================
@@ -82,6 +137,15 @@ Direction Isotropic::sample(uint64_t* seed) const
       std::sqrt(1.0 - mu*mu) * std::sin(phi)};
 }
 
+void Isotropic::serialize(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(UnitSphereDistType::ISOTROPIC)); // 4
+  buffer.align(8);                                             // 4
+  buffer.add(u_ref_.x);                                        // 8
+  buffer.add(u_ref_.y);                                        // 8
+  buffer.add(u_ref_.z);                                        // 8
+}
+
 //==============================================================================
 // Monodirectional implementation
 //==============================================================================
@@ -91,4 +155,13 @@ Direction Monodirectional::sample(uint64_t* seed) const
   return u_ref_;
 }
 
+void Monodirectional::serialize(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(UnitSphereDistType::MONODIRECTIONAL)); // 4
+  buffer.align(8);                                                   // 4
+  buffer.add(u_ref_.x);                                              // 8
+  buffer.add(u_ref_.y);                                              // 8
+  buffer.add(u_ref_.z);                                              // 8
+}
+
 } // namespace openmc
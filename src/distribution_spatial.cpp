@@ -1,11 +1,71 @@
 #include "openmc/distribution_spatial.h"
 
+#include <cmath> // for sin, cos
+
 #include "openmc/error.h"
 #include "openmc/random_lcg.h"
 #include "openmc/xml_interface.h"
 
 namespace openmc {
 
+//==============================================================================
+// SpatialDistributionFlat implementation
+//==============================================================================
+
+SpatialDistributionFlat::SpatialDistributionFlat(const uint8_t* data)
+  : data_{data}
+{
+  type_ = static_cast<SpatialDistType>(*reinterpret_cast<const int*>(data_));
+}
+
+Position SpatialDistributionFlat::sample(uint64_t* seed) const
+{
+  auto offsets = reinterpret_cast<const int*>(data_);
+  switch (type_) {
+  case SpatialDistType::CARTESIAN:
+    {
+      double x = DistributionFlat(data_ + 16).sample(seed);
+      double y = DistributionFlat(data_ + offsets[2]).sample(seed);
+      double z = DistributionFlat(data_ + offsets[3]).sample(seed);
+      return {x, y, z};
+    }
+  case SpatialDistType::CYLINDRICAL:
+    {
+      Position origin {reinterpret_cast<const double*>(data_ + 8)};
+      double r = DistributionFlat(data_ + 40).sample(seed);
+      double phi = DistributionFlat(data_ + offsets[8]).sample(seed);
+      double z = DistributionFlat(data_ + offsets[9]).sample(seed);
+      return {r*cos(phi) + origin.x, r*sin(phi) + origin.y, z + origin.z};
+    }
+  case SpatialDistType::SPHERICAL:
+    {
+      Position origin {reinterpret_cast<const double*>(data_ + 8)};
+      double r = DistributionFlat(data_ + 40).sample(seed);
+      double theta = DistributionFlat(data_ + offsets[8]).sample(seed);
+      double phi = DistributionFlat(data_ + offsets[9]).sample(seed);
+      return {r*sin(theta)*cos(phi) + origin.x,
+        r*sin(theta)*sin(phi) + origin.y, r*cos(theta) + origin.z};
+    }
+  case SpatialDistType::BOX:
+    {
+      Position lower_left {reinterpret_cast<const double*>(data_ + 8)};
+      Position upper_right {reinterpret_cast<const double*>(data_ + 32)};
+      Position xi {prn(seed), prn(seed), prn(seed)};
+      return lower_left + xi*(upper_right - lower_left);
+    }
+  case SpatialDistType::POINT:
+    return {reinterpret_cast<const double*>(data_ + 8)};
+  default:
+    UNREACHABLE();
+  }
+}
+
+bool SpatialDistributionFlat::only_fissionable() const
+{
+  return type_ == SpatialDistType::BOX &&
+    *reinterpret_cast<const int*>(data_ + 4);
+}
+
 //==============================================================================
 // CartesianIndependent implementation
 //==============================================================================
@@ -51,6 +111,19 @@ Position CartesianIndependent::sample(uint64_t* seed) const
   return {x_->sample(seed), y_->sample(seed), z_->sample(seed)};
 }
 
+void CartesianIndependent::serialize(DataBuffer& buffer) const
+{
+  int offset_y = 16 + tagged_nbytes(*x_);
+  int offset_z = offset_y + tagged_nbytes(*y_);
+  buffer.add(static_cast<int>(SpatialDistType::CARTESIAN)); // 4
+  buffer.align(8);                                          // 4
+  buffer.add(offset_y);                                     // 4
+  buffer.add(offset_z);                                     // 4
+  x_->serialize_tagged(buffer);
+  y_->serialize_tagged(buffer);
+  z_->serialize_tagged(buffer);
+}
+
 //==============================================================================
 // CylindricalIndependent implementation
 //==============================================================================
@@ -115,6 +188,22 @@ Position CylindricalIndependent::sample(uint64_t* seed) const
   return {x, y, z};
 }
 
+void CylindricalIndependent::serialize(DataBuffer& buffer) const
+{
+  int offset_phi = 40 + tagged_nbytes(*r_);
+  int offset_z = offset_phi + tagged_nbytes(*phi_);
+  buffer.add(static_cast<int>(SpatialDistType::CYLINDRICAL)); // 4
+  buffer.align(8);                                            // 4
+  buffer.add(origin_.x);                                      // 8
+  buffer.add(origin_.y);                                      // 8
+  buffer.add(origin_.z);                                      // 8
+  buffer.add(offset_phi);                                     // 4
+  buffer.add(offset_z);                                       // 4
+  r_->serialize_tagged(buffer);
+  phi_->serialize_tagged(buffer);
+  z_->serialize_tagged(buffer);
+}
+
 //==============================================================================
 // SphericalIndependent implementation
 //==============================================================================
@@ -180,6 +269,22 @@ Position SphericalIndependent::sample(uint64_t* seed) const
   return {x, y, z};
 }
 
+void SphericalIndependent::serialize(DataBuffer& buffer) const
+{
+  int offset_theta = 40 + tagged_nbytes(*r_);
+  int offset_phi = offset_theta + tagged_nbytes(*theta_);
+  buffer.add(static_cast<int>(SpatialDistType::SPHERICAL)); // 4
+  buffer.align(8);                                          // 4
+  buffer.add(origin_.x);                                    // 8
+  buffer.add(origin_.y);                                    // 8
+  buffer.add(origin_.z);                                    // 8
+  buffer.add(offset_theta);                                 // 4
+  buffer.add(offset_phi);                                   // 4
+  r_->serialize_tagged(buffer);
+  theta_->serialize_tagged(buffer);
+  phi_->serialize_tagged(buffer);
+}
+
 //==============================================================================
 // SpatialBox implementation
 //==============================================================================
@@ -203,6 +308,18 @@ Position SpatialBox::sample(uint64_t* seed) const
   return lower_left_ + xi*(upper_right_ - lower_left_);
 }
 
+void SpatialBox::serialize(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(SpatialDistType::BOX)); // 4
+  buffer.add(static_cast<int>(only_fissionable_));    // 4
+  buffer.add(lower_left_.x);                          // 8
+  buffer.add(lower_left_.y);                          // 8
+  buffer.add(lower_left_.z);                          // 8
+  buffer.add(upper_right_.x);                         // 8
+  buffer.add(upper_right_.y);                         // 8
+  buffer.add(upper_right_.z);                         // 8
+}
+
 //==============================================================================
 // SpatialPoint implementation
 //==============================================================================
@@ -224,4 +341,13 @@ Position SpatialPoint::sample(uint64_t* seed) const
   return r_;
 }
 
+void SpatialPoint::serialize(DataBuffer& buffer) const
+{
+  buffer.add(static_cast<int>(SpatialDistType::POINT)); // 4
+  buffer.align(8);                                      // 4
+  buffer.add(r_.x);                                     // 8
+  buffer.add(r_.y);                                     // 8
+  buffer.add(r_.z);                                     // 8
+}
+
 } // namespace openmc
@@ -0,0 +1,231 @@
+#include "openmc/domain_decomposition.h"
+
+#include <algorithm> // for min, sort
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "openmc/error.h"
+#include "openmc/mesh.h"
+#include "openmc/message_passing.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+#include "openmc/tallies/derivative.h"
+
+namespace openmc {
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+int n_domain_bins {0};
+SharedArray<DomainSite> domain_outbox;
+SharedArray<DomainSite> domain_inbox;
+
+} // namespace simulation
+
+namespace {
+
+// Particles received in the last exchange, and how many have been started
+std::vector<DomainSite> received;
+size_t n_started {0};
+
+#ifdef OPENMC_MPI
+//! Send the particles queued on device to the processes owning their domains
+//! and receive those sent here
+//
+//! \return Number of particles sent by all processes
+int64_t exchange_domain_particles()
+{
+  auto& outbox = simulation::domain_outbox;
+  outbox.copy_device_to_host();
+
+  // Group the particles by the process they are sent to. Ordering them by ID
+  // within a group makes the order they are started in reproducible.
+  std::vector<DomainSite> sent(outbox.data(), outbox.data() + outbox.size());
+  std::sort(sent.begin(), sent.end(),
+    [](const DomainSite& a, const DomainSite& b) {
+      return a.domain != b.domain ? a.domain < b.domain : a.id < b.id;
+    });
+  outbox.resize(0);
+
+  int n = mpi::n_procs;
+  std::vector<int> send_counts(n, 0);
+  for (const auto& s : sent) send_counts[s.domain]++;
+  std::vector<int> recv_counts(n);
+  MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT,
+    mpi::intracomm);
+
+  std::vector<int> send_displs(n, 0);
+  std::vector<int> recv_displs(n, 0);
+  for (int p = 1; p < n; ++p) {
+    send_displs[p] = send_displs[p - 1] + send_counts[p - 1];
+    recv_displs[p] = recv_displs[p - 1] + recv_counts[p - 1];
+  }
+  received.resize(recv_displs[n - 1] + recv_counts[n - 1]);
+  n_started = 0;
+
+  MPI_Datatype site_type;
+  MPI_Type_contiguous(sizeof(DomainSite), MPI_BYTE, &site_type);
+  MPI_Type_commit(&site_type);
+  MPI_Alltoallv(sent.data(), send_counts.data(), send_displs.data(),
+    site_type, received.data(), recv_counts.data(), recv_displs.data(),
+    site_type, mpi::intracomm);
+  MPI_Type_free(&site_type);
+
+  int64_t n_sent = sent.size();
+  MPI_Allreduce(MPI_IN_PLACE, &n_sent, 1, MPI_INT64_T, MPI_SUM,
+    mpi::intracomm);
+  return n_sent;
+}
+#endif
+
+} // namespace
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+void init_domain_decomposition(int capacity)
+{
+  free_domain_decomposition();
+  if (!domain_decomposed()) return;
+
+  // A single process owns every domain
+  if (mpi::n_procs == 1) {
+    settings::domain_mesh = C_NONE;
+    #pragma omp target update to(settings::domain_mesh)
+    return;
+  }
+
+  // Particles are handed over between the event kernels. Fission sites are
+  // ordered by the progeny of the particles started on each process, and
+  // unreduced tally realizations assume each process ran whole histories.
+  if (!settings::event_based) {
+    fatal_error("Domain decomposition requires event-based transport.");
+  }
+  if (settings::run_mode != RunMode::FIXED_SOURCE) {
+    fatal_error("Domain decomposition is only supported in fixed source mode.");
+  }
+  if (!settings::reduce_tallies) {
+    fatal_error("Domain decomposition requires tallies to be reduced.");
+  }
+  if (settings::hybrid_transport) {
+    fatal_error("Domain decomposition cannot be combined with hybrid "
+      "transport.");
+  }
+  if (model::n_tally_derivs > 0) {
+    fatal_error("Differential tallies are not supported with domain "
+      "decomposition.");
+  }
+
+  simulation::n_domain_bins = model::meshes[settings::domain_mesh].n_bins();
+  if (simulation::n_domain_bins < mpi::n_procs) {
+    fatal_error(fmt::format("The domain mesh has {} bins, fewer than the {} "
+      "processes that domains are owned by.", simulation::n_domain_bins,
+      mpi::n_procs));
+  }
+  #pragma omp target update to(settings::domain_mesh)
+  #pragma omp target update to(simulation::n_domain_bins)
+
+  // At most the whole particle buffer leaves or enters the domain at once
+  simulation::domain_outbox.reserve(capacity, "Domain exchange");
+  simulation::domain_outbox.allocate_on_device();
+  simulation::domain_inbox.reserve(capacity, "Domain exchange");
+  simulation::domain_inbox.allocate_on_device();
+  received.clear();
+  n_started = 0;
+}
+
+void free_domain_decomposition()
+{
+  auto& outbox = simulation::domain_outbox;
+  auto& inbox = simulation::domain_inbox;
+  if (outbox.data()) {
+    #pragma omp target exit data map(delete: outbox.data_[:outbox.capacity_])
+    outbox.clear();
+  }
+  if (inbox.data()) {
+    #pragma omp target exit data map(delete: inbox.data_[:inbox.capacity_])
+    inbox.clear();
+  }
+  received.clear();
+  received.shrink_to_fit();
+}
+
+#pragma omp declare target
+bool send_to_domain(Particle& p)
+{
+  // Particles outside of the mesh stay with the process they are on
+  int bin = model::meshes[settings::domain_mesh].get_bin(p.r());
+  if (bin < 0) return false;
+  int domain = static_cast<int64_t>(bin) * mpi::n_procs /
+    simulation::n_domain_bins;
+  if (domain == mpi::rank) return false;
+
+  DomainSite s;
+  s.site.r = p.r();
+  s.site.u = p.u();
+  s.site.E = settings::run_CE ? p.E_ : p.g_;
+  s.site.wgt = p.wgt_;
+  s.site.delayed_group = p.delayed_group_;
+  s.site.surf_id = 0;
+  s.site.particle = p.type_;
+  s.site.parent_id = p.id_;
+  s.site.progeny_id = p.n_progeny_;
+  s.site.time = p.time_;
+  for (int i = 0; i < N_STREAMS; ++i) s.seeds[i] = p.seeds_[i];
+  s.id = p.id_;
+  s.surface = p.surface_;
+  s.n_collision = p.n_collision_;
+  s.n_event = p.n_event_;
+  s.cell_born = p.cell_born_;
+  s.domain = domain;
+  if (simulation::domain_outbox.thread_safe_append(s) < 0) return false;
+
+  // Its secondaries, which were born in this domain, are still revived here
+  p.wgt_ = 0.0;
+  return true;
+}
+
+void receive_from_domain(Particle& p, const DomainSite& site)
+{
+  p.from_source(site.site);
+  p.surface_ = site.surface;
+  p.n_collision_ = site.n_collision;
+  p.cell_born_ = site.cell_born;
+  p.current_work_ = 0;
+  p.id_ = site.id;
+  p.n_progeny_ = 0;
+  p.n_event_ = site.n_event;
+  for (int i = 0; i < N_STREAMS; ++i) p.seeds_[i] = site.seeds[i];
+  p.trace_ = false;
+  p.write_track_ = false;
+  p.n_tracks_ = 0;
+  initialize_history_partial(p);
+}
+#pragma omp end declare target
+
+int receive_domain_particles()
+{
+#ifdef OPENMC_MPI
+  while (n_started == received.size()) {
+    if (exchange_domain_particles() == 0) return 0;
+  }
+
+  auto& inbox = simulation::domain_inbox;
+  int n = std::min<size_t>(inbox.capacity(), received.size() - n_started);
+  std::copy(received.begin() + n_started, received.begin() + n_started + n,
+    inbox.data());
+  inbox.set_host_size(n);
+  inbox.copy_host_to_device();
+  n_started += n;
+  return n;
+#else
+  return 0;
+#endif
+}
+
+} // namespace openmc
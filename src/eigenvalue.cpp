@@ -8,11 +8,14 @@
 #include "openmc/bank.h"
 #include "openmc/capi.h"
 #include "openmc/constants.h"
+#include "openmc/device_sort.h"
 #include "openmc/error.h"
+#include "openmc/event.h"
 #include "openmc/hdf5_interface.h"
 #include "openmc/math_functions.h"
 #include "openmc/mesh.h"
 #include "openmc/message_passing.h"
+#include "openmc/profile_range.h"
 #include "openmc/random_lcg.h"
 #include "openmc/search.h"
 #include "openmc/settings.h"
@@ -24,6 +27,7 @@
 #include <array>
 #include <cmath> // for sqrt, abs, pow
 #include <iterator> // for back_inserter
+#include <numeric> // for accumulate
 #include <string>
 #include <limits> //for infinity
 
@@ -39,6 +43,8 @@ double keff_generation;
 std::array<double, 2> k_sum;
 std::vector<double> entropy;
 xt::xtensor<double, 1> source_frac;
+std::vector<double> fission_matrix;
+std::vector<double> fission_matrix_source;
 
 } // namespace simulation
 
@@ -46,30 +52,154 @@ xt::xtensor<double, 1> source_frac;
 // Non-member functions
 //==============================================================================
 
+namespace {
+
+// Single-generation k on this process of the generations of the current batch
+// whose values have yet to be combined across processes
+std::vector<double> keff_local;
+
+} // namespace
+
+bool local_generation()
+{
+  return settings::local_generations &&
+    simulation::current_gen < settings::gen_per_batch;
+}
+
 void calculate_generation_keff()
 {
   const auto& gt = simulation::global_tallies;
 
   // Get keff for this generation by subtracting off the starting value
   simulation::keff_generation = gt(GlobalTally::K_TRACKLENGTH, TallyResult::VALUE) - simulation::keff_generation;
+  if (simulation::current_gen == 1) keff_local.clear();
+  keff_local.push_back(simulation::keff_generation);
+
+  // Until the end of the batch, the next generation banks fission sites with
+  // the estimate of this process alone
+  if (local_generation()) {
+    simulation::keff = simulation::keff_generation / simulation::work_per_rank;
+    return;
+  }
 
-  double keff_reduced;
+  int n = keff_local.size();
+  std::vector<double> keff_reduced(n);
 #ifdef OPENMC_MPI
   // Combine values across all processors
-  MPI_Allreduce(&simulation::keff_generation, &keff_reduced, 1, MPI_DOUBLE,
+  MPI_Allreduce(keff_local.data(), keff_reduced.data(), n, MPI_DOUBLE,
     MPI_SUM, mpi::intracomm);
 #else
-  keff_reduced = simulation::keff_generation;
+  keff_reduced = keff_local;
 #endif
+  keff_local.clear();
 
   // Normalize single batch estimate of k
   // TODO: This should be normalized by total_weight, not by n_particles
-  keff_reduced /= settings::n_particles;
-  simulation::k_generation.push_back(keff_reduced);
+  for (double k : keff_reduced) {
+    simulation::k_generation.push_back(k / settings::n_particles);
+  }
+}
+
+namespace {
+
+//! Sample sites from the device-resident fission bank, drawing the same random
+//! numbers for each site as the host loop in synchronize_bank()
+//
+//! \param n_copies The number of copies of every site to add unconditionally
+//! \param p_sample The probability of adding one further copy of a site
+//! \param seed The seed preceding the draw for this rank's first site
+//! \param sites Device pointer to write the sampled sites to
+//! \param max_sites The number of sites that fit in sites. Sampled sites past
+//!   this are discarded.
+//! \return The number of sites sampled, including any that were discarded
+int64_t sample_fission_bank_device(int64_t n_copies, double p_sample,
+  uint64_t seed, Particle::Bank* sites, int64_t max_sites)
+{
+  int64_t n_bank = simulation::fission_bank.size();
+  int64_t* offsets = simulation::device_fission_site_offsets;
+
+  // Count the sites sampled from each fission site and scan the counts to
+  // find where they go
+  #pragma omp target teams distribute parallel for
+  for (int64_t i = 0; i < n_bank; i++) {
+    offsets[i] = n_copies + (future_prn(i + 1, seed) < p_sample ? 1 : 0);
+  }
+  int64_t n_last = n_copies + (future_prn(n_bank, seed) < p_sample ? 1 : 0);
+  device_exclusive_scan(offsets, n_bank, simulation::device_fission_scan_chunks);
+
+  int64_t n_sampled;
+  #pragma omp target map(from: n_sampled)
+  {
+    n_sampled = offsets[n_bank - 1] + n_last;
+  }
+
+  #pragma omp target teams distribute parallel for
+  for (int64_t i = 0; i < n_bank; i++) {
+    int64_t last = (i + 1 < n_bank) ? offsets[i + 1] : n_sampled;
+    for (int64_t j = offsets[i]; j < std::min(last, max_sites); j++) {
+      sites[j] = simulation::fission_bank[i];
+    }
+  }
+  return n_sampled;
+}
+
+//! Repeat sites from the very end of the device-resident fission bank
+//
+//! \param sites Device pointer to the sampled sites
+//! \param index The number of sites already sampled
+//! \param n The number of sites to repeat
+void repeat_fission_sites_device(Particle::Bank* sites, int64_t index, int64_t n)
+{
+  int64_t first = simulation::fission_bank.size() - n;
+  #pragma omp target teams distribute parallel for
+  for (int64_t i = 0; i < n; i++) {
+    sites[index + i] = simulation::fission_bank[first + i];
+  }
+}
+
+#ifdef OPENMC_MPI
+//! A bank exchange left in progress by synchronize_bank() with --async-bank,
+//! so that transport can start the sites of the source bank as they arrive
+struct BankExchange {
+  bool active {false};
+  std::vector<MPI_Request> requests;
+  std::vector<std::array<int64_t, 2>> ranges; //!< Source bank range received by each request (empty for sends)
+  std::array<int64_t, 2> local_range {0, 0}; //!< Source bank range copied from this process
+  std::vector<Particle::Bank> temp_sites; //!< Send buffer
+  std::vector<PackedBank> packed_sites;   //!< Send buffer with --packed-bank
+  std::vector<PackedBank> packed_recv;    //!< Receive buffer with --packed-bank
+};
+
+BankExchange exchange;
+#endif
+
+//! Copy a range of the source bank to device and append it to the order in
+//! which sites are started
+//
+//! \param range First and one past the last index of the range
+void make_sites_ready(std::array<int64_t, 2> range)
+{
+  int first = simulation::n_sources_ready;
+  int n = range[1] - range[0];
+  if (n == 0) return;
+
+  if (!simulation::source_bank_stale) {
+    #pragma omp target update to(simulation::device_source_bank[range[0]:n])
+  }
+  for (int i = 0; i < n; i++) {
+    simulation::source_order[first + i] = range[0] + i;
+  }
+  #pragma omp target update to(simulation::device_source_order[first:n])
+
+  simulation::n_sources_ready += n;
+  #pragma omp target update to(simulation::n_sources_ready)
 }
 
+} // namespace
+
 void synchronize_bank()
 {
+  ProfileRange range {"synchronize_bank"};
   simulation::time_bank.start();
 
   // In order to properly understand the fission bank algorithm, you need to
@@ -135,29 +265,56 @@ void synchronize_bank()
   // SAMPLE N_PARTICLES FROM FISSION BANK AND PLACE IN TEMP_SITES
 
   // Allocate temporary source bank -- we don't really know how many fission
-  // sites were created, so overallocate by a factor of 3
+  // sites will be sampled, so overallocate by a factor of 3, or by one site
+  // per banked site once the fission bank has grown past that
   int64_t index_temp = 0;
-  std::vector<Particle::Bank> temp_sites(3*simulation::work_per_rank);
+  std::vector<Particle::Bank> temp_sites_holder;
+  Particle::Bank* temp_sites;
+
+  // When the fission bank is resident on device, sites are sampled there. On
+  // a single process they go straight into the source bank; otherwise they
+  // are gathered in device scratch and brought back to be sent to neighbors.
+  Particle::Bank* device_sites;
+  int64_t max_device_sites;
+  if (settings::device_fission_bank) {
+    temp_sites = simulation::fission_bank_scratch.data();
+#ifdef OPENMC_MPI
+    device_sites = simulation::device_fission_bank_scratch;
+    max_device_sites = simulation::fission_bank_scratch.size();
+#else
+    device_sites = simulation::device_source_bank;
+    max_device_sites = simulation::source_bank.size();
+#endif
+    int64_t n_copies = (total < settings::n_particles) ?
+      settings::n_particles / total : 0;
+    index_temp = sample_fission_bank_device(n_copies, p_sample, seed,
+      device_sites, max_device_sites);
 
-  for (int64_t i = 0; i < simulation::fission_bank.size(); i++ ) {
-    const auto& site = simulation::fission_bank[i];
+  } else {
+    temp_sites_holder.resize(std::max(3*simulation::max_work_per_rank,
+      simulation::fission_bank.size() + simulation::max_work_per_rank));
+    temp_sites = temp_sites_holder.data();
+
+    for (int64_t i = 0; i < simulation::fission_bank.size(); i++ ) {
+      const auto& site = simulation::fission_bank[i];
+
+      // If there are less than n_particles particles banked, automatically add
+      // int(n_particles/total) sites to temp_sites. For example, if you need
+      // 1000 and 300 were banked, this would add 3 source sites per banked site
+      // and the remaining 100 would be randomly sampled.
+      if (total < settings::n_particles) {
+        for (int64_t j = 1; j <= settings::n_particles / total; ++j) {
+          temp_sites[index_temp] = site;
+          ++index_temp;
+        }
+      }
 
-    // If there are less than n_particles particles banked, automatically add
-    // int(n_particles/total) sites to temp_sites. For example, if you need
-    // 1000 and 300 were banked, this would add 3 source sites per banked site
-    // and the remaining 100 would be randomly sampled.
-    if (total < settings::n_particles) {
-      for (int64_t j = 1; j <= settings::n_particles / total; ++j) {
+      // Randomly sample sites needed
+      if (prn(&seed) < p_sample) {
         temp_sites[index_temp] = site;
         ++index_temp;
       }
     }
-
-    // Randomly sample sites needed
-    if (prn(&seed) < p_sample) {
-      temp_sites[index_temp] = site;
-      ++index_temp;
-    }
   }
 
   // At this point, the sampling of source sites is done and now we need to
@@ -195,10 +352,15 @@ void synchronize_bank()
       // If we have too few sites, repeat sites from the very end of the
       // fission bank
       sites_needed = settings::n_particles - finish;
-      for (int i = 0; i < sites_needed; ++i) {
-        int i_bank = simulation::fission_bank.size() - sites_needed + i;
-        temp_sites[index_temp] = simulation::fission_bank[i_bank];
-        ++index_temp;
+      if (settings::device_fission_bank) {
+        repeat_fission_sites_device(device_sites, index_temp, sites_needed);
+        index_temp += sites_needed;
+      } else {
+        for (int i = 0; i < sites_needed; ++i) {
+          int i_bank = simulation::fission_bank.size() - sites_needed + i;
+          temp_sites[index_temp] = simulation::fission_bank[i_bank];
+          ++index_temp;
+        }
       }
     }
 
@@ -210,11 +372,29 @@ void synchronize_bank()
   simulation::time_bank_sendrecv.start();
 
 #ifdef OPENMC_MPI
+  if (settings::device_fission_bank) {
+    #pragma omp target update from(device_sites[:index_temp])
+  }
+
+  // With the packed bank format, sites are packed before being sent and
+  // received sites are unpacked once all communication has completed
+  std::vector<PackedBank> packed_sites;
+  std::vector<PackedBank> packed_recv;
+  if (settings::packed_bank) {
+    packed_sites.resize(index_temp);
+    #pragma omp parallel for
+    for (int64_t i = 0; i < index_temp; i++) {
+      packed_sites[i] = pack_bank(temp_sites[i]);
+    }
+    packed_recv.resize(simulation::work_per_rank);
+  }
+
   // ==========================================================================
   // SEND BANK SITES TO NEIGHBORS
 
   int64_t index_local = 0;
   std::vector<MPI_Request> requests;
+  std::vector<std::array<int64_t, 2>> request_ranges;
 
   if (start < settings::n_particles) {
     // Determine the index of the processor which has the first part of the
@@ -230,8 +410,15 @@ void synchronize_bank()
       // process
       if (neighbor != mpi::rank) {
         requests.emplace_back();
-        MPI_Isend(&temp_sites[index_local], static_cast<int>(n), mpi::bank,
-          neighbor, mpi::rank, mpi::intracomm, &requests.back());
+        request_ranges.push_back({0, 0});
+        if (settings::packed_bank) {
+          MPI_Isend(&packed_sites[index_local], static_cast<int>(n),
+            mpi::packed_bank, neighbor, mpi::rank, mpi::intracomm,
+            &requests.back());
+        } else {
+          MPI_Isend(&temp_sites[index_local], static_cast<int>(n), mpi::bank,
+            neighbor, mpi::rank, mpi::intracomm, &requests.back());
+        }
       }
 
       // Increment all indices
@@ -251,6 +438,7 @@ void synchronize_bank()
 
   start = simulation::work_index[mpi::rank];
   index_local = 0;
+  exchange.local_range = {0, 0};
 
   // Determine what process has the source sites that will need to be stored at
   // the beginning of this processor's source bank.
@@ -276,8 +464,15 @@ void synchronize_bank()
       // asynchronous receive for the source sites
 
       requests.emplace_back();
-      MPI_Irecv(&simulation::source_bank[index_local], static_cast<int>(n), mpi::bank,
-            neighbor, neighbor, mpi::intracomm, &requests.back());
+      request_ranges.push_back({index_local, index_local + n});
+      if (settings::packed_bank) {
+        MPI_Irecv(&packed_recv[index_local], static_cast<int>(n),
+          mpi::packed_bank, neighbor, neighbor, mpi::intracomm,
+          &requests.back());
+      } else {
+        MPI_Irecv(&simulation::source_bank[index_local], static_cast<int>(n), mpi::bank,
+              neighbor, neighbor, mpi::intracomm, &requests.back());
+      }
 
     } else {
       // If the source sites are on this procesor, we can simply copy them
@@ -286,6 +481,7 @@ void synchronize_bank()
       index_temp = start - bank_position[mpi::rank];
       std::copy(&temp_sites[index_temp], &temp_sites[index_temp + n],
         &simulation::source_bank[index_local]);
+      exchange.local_range = {index_local, index_local + n};
     }
 
     // Increment all indices
@@ -294,29 +490,182 @@ void synchronize_bank()
     ++neighbor;
   }
 
-  // Since we initiated a series of asynchronous ISENDs and IRECVs, now we have
-  // to ensure that the data has actually been communicated before moving on to
-  // the next generation
+  if (settings::async_bank_exchange) {
+    // The local sites are started right away and the others as they arrive
+    // during transport, so the buffers are kept until the messages complete
+    exchange.active = true;
+    exchange.requests = std::move(requests);
+    exchange.ranges = std::move(request_ranges);
+    std::swap(exchange.temp_sites, temp_sites_holder);
+    std::swap(exchange.packed_sites, packed_sites);
+    std::swap(exchange.packed_recv, packed_recv);
+
+  } else {
+    // Since we initiated a series of asynchronous ISENDs and IRECVs, now we
+    // have to ensure that the data has actually been communicated before
+    // moving on to the next generation
+
+    int n_request = requests.size();
+    MPI_Waitall(n_request, requests.data(), MPI_STATUSES_IGNORE);
+
+    if (settings::packed_bank) {
+      for (const auto& range : request_ranges) {
+        #pragma omp parallel for
+        for (int64_t i = range[0]; i < range[1]; i++) {
+          simulation::source_bank[i] = unpack_bank(packed_recv[i]);
+        }
+      }
+    }
+  }
 
-  int n_request = requests.size();
-  MPI_Waitall(n_request, requests.data(), MPI_STATUSES_IGNORE);
+  // Sites sampled on device by local generations have been replaced
+  simulation::source_bank_stale = false;
 
 #else
-  std::copy(temp_sites.data(), temp_sites.data() + settings::n_particles,
-    simulation::source_bank.begin());
+  if (settings::device_fission_bank) {
+    simulation::source_bank_stale = true;
+  } else {
+    std::copy(temp_sites, temp_sites + settings::n_particles,
+      simulation::source_bank.begin());
+  }
 #endif
 
   simulation::time_bank_sendrecv.stop();
   simulation::time_bank.stop();
 }
 
-void calculate_average_keff()
+void synchronize_bank_local()
+{
+  ProfileRange range {"synchronize_bank_local"};
+  simulation::time_bank.start();
+
+  int64_t total = simulation::fission_bank.size();
+  if (total == 0) {
+    fatal_error("No fission sites banked on MPI rank " + std::to_string(mpi::rank));
+  }
+
+  // Each process draws from its own part of the sequence. The fission bank of
+  // a process is sized to the sites expected from its share, which stay far
+  // below three times the share, so the parts do not overlap.
+  int64_t id = simulation::total_gen + overall_generation();
+  uint64_t seed = init_seed(id, STREAM_TRACKING);
+  advance_prn_seed(3*simulation::work_index[mpi::rank], &seed);
+
+  // Sample this process' share of sites from its own fission bank, in the
+  // same way as synchronize_bank() samples n_particles from the global one
+  int64_t n = simulation::work_per_rank;
+  int64_t n_copies = (total < n) ? n / total : 0;
+  int64_t sites_needed = (total < n) ? n % total : n;
+  double p_sample = static_cast<double>(sites_needed) / total;
+
+  simulation::time_bank_sample.start();
+
+  int64_t index = 0;
+  if (settings::device_fission_bank) {
+    index = std::min(sample_fission_bank_device(n_copies, p_sample, seed,
+      simulation::device_source_bank, n), n);
+    if (index < n) {
+      repeat_fission_sites_device(simulation::device_source_bank, index,
+        n - index);
+    }
+    simulation::source_bank_stale = true;
+
+  } else {
+    for (int64_t i = 0; i < total && index < n; i++) {
+      const auto& site = simulation::fission_bank[i];
+      for (int64_t j = 0; j < n_copies && index < n; ++j) {
+        simulation::source_bank[index++] = site;
+      }
+      if (prn(&seed) < p_sample && index < n) {
+        simulation::source_bank[index++] = site;
+      }
+    }
+
+    // If there are too few sites, repeat sites from the very end of the
+    // fission bank
+    int64_t n_repeat = n - index;
+    for (int64_t i = 0; i < n_repeat; ++i) {
+      simulation::source_bank[index++] =
+        simulation::fission_bank[total - n_repeat + i];
+    }
+  }
+
+  simulation::time_bank_sample.stop();
+  simulation::time_bank.stop();
+}
+
+bool bank_exchange_pending()
+{
+  return simulation::n_sources_ready < simulation::work_per_rank;
+}
+
+void start_source_transfer()
+{
+  simulation::n_sources_ready = 0;
+#ifdef OPENMC_MPI
+  if (exchange.active) {
+    make_sites_ready(exchange.local_range);
+    poll_bank_exchange(false);
+    return;
+  }
+#endif
+  make_sites_ready({0, simulation::work_per_rank});
+}
+
+void poll_bank_exchange(bool wait)
+{
+#ifdef OPENMC_MPI
+  if (!exchange.active) return;
+
+  int n_request = exchange.requests.size();
+  std::vector<int> indices(n_request);
+  int n_done;
+  if (wait) {
+    MPI_Waitsome(n_request, exchange.requests.data(), &n_done, indices.data(),
+      MPI_STATUSES_IGNORE);
+  } else {
+    MPI_Testsome(n_request, exchange.requests.data(), &n_done, indices.data(),
+      MPI_STATUSES_IGNORE);
+  }
+  if (n_done == MPI_UNDEFINED) return;
+
+  for (int k = 0; k < n_done; ++k) {
+    const auto& range = exchange.ranges[indices[k]];
+    if (settings::packed_bank) {
+      #pragma omp parallel for
+      for (int64_t i = range[0]; i < range[1]; i++) {
+        simulation::source_bank[i] = unpack_bank(exchange.packed_recv[i]);
+      }
+    }
+    make_sites_ready(range);
+  }
+#endif
+}
+
+void finish_bank_exchange()
+{
+#ifdef OPENMC_MPI
+  if (!exchange.active) return;
+
+  // Once every site has been started, only sends can be outstanding
+  MPI_Waitall(exchange.requests.size(), exchange.requests.data(),
+    MPI_STATUSES_IGNORE);
+  exchange.active = false;
+#endif
+}
+
+namespace {
+
+//! Add the keff of one generation of the current batch to the mean of keff
+//
+//! \param gen Generation within the current batch
+void add_generation_keff(int gen)
 {
   // Determine overall generation and number of active generations
-  int i = overall_generation() - 1;
+  int i = overall_generation() - 1 - (simulation::current_gen - gen);
   int n;
   if (simulation::current_batch > settings::n_inactive) {
-    n = settings::gen_per_batch*simulation::n_realizations + simulation::current_gen;
+    n = settings::gen_per_batch*simulation::n_realizations + gen;
   } else {
     n = 0;
   }
@@ -350,6 +699,18 @@ void calculate_average_keff()
   }
 }
 
+} // namespace
+
+void calculate_average_keff()
+{
+  // With local generations, the generations of a batch are all added at its
+  // end
+  int first_gen = settings::local_generations ? 1 : simulation::current_gen;
+  for (int gen = first_gen; gen <= simulation::current_gen; ++gen) {
+    add_generation_keff(gen);
+  }
+}
+
 int openmc_get_keff(double* k_combined)
 {
   k_combined[0] = 0.0;
@@ -505,11 +866,18 @@ int openmc_get_keff(double* k_combined)
 
 void shannon_entropy()
 {
-  // Get source weight in each mesh bin
+  // Get source weight in each mesh bin, on device when the fission bank is
+  // kept there
   bool sites_outside;
-  xt::xtensor<double, 1> p = simulation::entropy_mesh->count_sites(
-    simulation::fission_bank.data(), simulation::fission_bank.size(),
-    &sites_outside);
+  xt::xtensor<double, 1> p;
+  if (settings::device_fission_bank) {
+    p = simulation::entropy_mesh->count_sites_device(
+      simulation::fission_bank.data(), simulation::fission_bank.size(),
+      &sites_outside);
+  } else {
+    p = simulation::entropy_mesh->count_sites(simulation::fission_bank.data(),
+      simulation::fission_bank.size(), &sites_outside);
+  }
 
   // display warning message if there were sites outside entropy box
   if (sites_outside) {
@@ -545,10 +913,19 @@ void ufs_count_sites()
     simulation::source_frac = xt::xtensor<double, 1>({n}, vol_frac);
 
   } else {
-    // count number of source sites in each ufs mesh cell
+    // count number of source sites in each ufs mesh cell, on device when
+    // the source bank was last written there
+    bool device_sites = simulation::source_bank_stale;
     bool sites_outside;
-    simulation::source_frac = simulation::ufs_mesh->count_sites(
-      simulation::source_bank.data(), simulation::source_bank.size(), &sites_outside);
+    if (device_sites) {
+      simulation::source_frac = simulation::ufs_mesh->count_sites_device(
+        simulation::source_bank.data(), simulation::source_bank.size(),
+        &sites_outside);
+    } else {
+      simulation::source_frac = simulation::ufs_mesh->count_sites(
+        simulation::source_bank.data(), simulation::source_bank.size(),
+        &sites_outside);
+    }
 
     // Check for sites outside of the mesh
     if (mpi::master && sites_outside) {
@@ -567,8 +944,230 @@ void ufs_count_sites()
 
     // Since the total starting weight is not equal to n_particles, we need to
     // renormalize the weight of the source sites
-    for (int i = 0; i < simulation::work_per_rank; ++i) {
-      simulation::source_bank[i].wgt *= settings::n_particles / total;
+    double factor = settings::n_particles / total;
+    if (device_sites) {
+      int64_t n = simulation::work_per_rank;
+      #pragma omp target teams distribute parallel for
+      for (int64_t i = 0; i < n; ++i) {
+        simulation::device_source_bank[i].wgt *= factor;
+      }
+    } else {
+      for (int i = 0; i < simulation::work_per_rank; ++i) {
+        simulation::source_bank[i].wgt *= factor;
+      }
+    }
+  }
+}
+
+namespace {
+
+//! Mesh the fission matrix is tallied on
+const Mesh* fission_matrix_mesh()
+{
+  return simulation::entropy_mesh ? simulation::entropy_mesh :
+    simulation::ufs_mesh;
+}
+
+} // namespace
+
+void tally_fission_matrix()
+{
+  const Mesh* mesh = fission_matrix_mesh();
+  int n = mesh->n_bins();
+  int64_t n_matrix = static_cast<int64_t>(n) * n;
+  if (simulation::fission_matrix.empty()) {
+    simulation::fission_matrix.assign(n_matrix, 0.0);
+    simulation::fission_matrix_source.assign(n, 0.0);
+  }
+
+  // The matrix of this generation is followed by the source weight in each
+  // bin so that both are reduced at once
+  std::vector<double> gen(n_matrix + n, 0.0);
+  double* F = gen.data();
+  int64_t m = gen.size();
+
+  // Sites refer to the source site of their history by its particle ID
+  int64_t first_id = simulation::work_index[mpi::rank] + 1;
+  int64_t n_source = simulation::work_per_rank;
+  int64_t n_sites = simulation::fission_bank.size();
+
+  if (settings::device_fission_bank) {
+    // The copy of the mesh in model::meshes is the one that is on device
+    const Particle::Bank* bank = simulation::fission_bank.data();
+    int i_mesh = mesh - model::meshes;
+
+    #pragma omp target data map(tofrom: F[:m])
+    {
+      #pragma omp target teams distribute parallel for
+      for (int64_t i = 0; i < n_source; ++i) {
+        const auto& site = simulation::device_source_bank[i];
+        int bin = model::meshes[i_mesh].get_bin(site.r);
+        if (bin < 0) continue;
+        #pragma omp atomic
+        F[n_matrix + bin] += site.wgt;
+      }
+
+      #pragma omp target teams distribute parallel for
+      for (int64_t i = 0; i < n_sites; ++i) {
+        const auto& site = bank[i];
+        const auto& source = simulation::device_source_bank[site.parent_id - first_id];
+        int to = model::meshes[i_mesh].get_bin(site.r);
+        int from = model::meshes[i_mesh].get_bin(source.r);
+        if (to < 0 || from < 0) continue;
+        #pragma omp atomic
+        F[static_cast<int64_t>(to)*n + from] += site.wgt;
+      }
+    }
+  } else {
+    for (int64_t i = 0; i < n_source; ++i) {
+      const auto& site = simulation::source_bank[i];
+      int bin = mesh->get_bin(site.r);
+      if (bin >= 0) F[n_matrix + bin] += site.wgt;
+    }
+
+    for (int64_t i = 0; i < n_sites; ++i) {
+      const auto& site = simulation::fission_bank[i];
+      const auto& source = simulation::source_bank[site.parent_id - first_id];
+      int to = mesh->get_bin(site.r);
+      int from = mesh->get_bin(source.r);
+      if (to < 0 || from < 0) continue;
+      F[static_cast<int64_t>(to)*n + from] += site.wgt;
+    }
+  }
+
+#ifdef OPENMC_MPI
+  // Only the master process solves for the fundamental mode
+  if (mpi::master) {
+    MPI_Reduce(MPI_IN_PLACE, F, m, MPI_DOUBLE, MPI_SUM, 0, mpi::intracomm);
+  } else {
+    MPI_Reduce(F, nullptr, m, MPI_DOUBLE, MPI_SUM, 0, mpi::intracomm);
+  }
+#endif
+
+  if (mpi::master) {
+    for (int64_t i = 0; i < n_matrix; ++i) {
+      simulation::fission_matrix[i] += F[i];
+    }
+    for (int i = 0; i < n; ++i) {
+      simulation::fission_matrix_source[i] += F[n_matrix + i];
+    }
+  }
+}
+
+void fission_matrix_reweight()
+{
+  const Mesh* mesh = fission_matrix_mesh();
+  int n = mesh->n_bins();
+
+  // Count the weight of the new source in each bin, on device when the source
+  // bank was last written there
+  bool device_sites = simulation::source_bank_stale;
+  bool sites_outside;
+  xt::xtensor<double, 1> counts;
+  if (device_sites) {
+    counts = mesh->count_sites_device(simulation::source_bank.data(),
+      simulation::source_bank.size(), &sites_outside);
+  } else {
+    counts = mesh->count_sites(simulation::source_bank.data(),
+      simulation::source_bank.size(), &sites_outside);
+  }
+
+  std::vector<double> weightfactors(n, 1.0);
+  if (mpi::master) {
+    // Keep only the nonzero elements of the matrix, each normalized by the
+    // weight started in its column, so that the power iteration is cheap
+    // however sparse the matrix is
+    const auto& F = simulation::fission_matrix;
+    const auto& S = simulation::fission_matrix_source;
+    std::vector<int> rows;
+    std::vector<int> cols;
+    std::vector<double> values;
+    for (int to = 0; to < n; ++to) {
+      for (int from = 0; from < n; ++from) {
+        double f = F[static_cast<int64_t>(to)*n + from];
+        if (f > 0.0 && S[from] > 0.0) {
+          rows.push_back(to);
+          cols.push_back(from);
+          values.push_back(f / S[from]);
+        }
+      }
+    }
+
+    // Find the fundamental mode by power iteration, starting from the
+    // current source
+    std::vector<double> phi(counts.begin(), counts.end());
+    std::vector<double> next(n);
+    bool converged = false;
+    double total = std::accumulate(phi.begin(), phi.end(), 0.0);
+    for (int iter = 0; iter < FISSION_MATRIX_MAX_ITER && total > 0.0; ++iter) {
+      for (auto& x : phi) x /= total;
+      std::fill(next.begin(), next.end(), 0.0);
+      for (int k = 0; k < values.size(); ++k) {
+        next[rows[k]] += values[k] * phi[cols[k]];
+      }
+      total = std::accumulate(next.begin(), next.end(), 0.0);
+      if (total == 0.0) break;
+
+      double diff = 0.0;
+      for (int i = 0; i < n; ++i) {
+        diff += std::abs(next[i] / total - phi[i]);
+      }
+      std::swap(phi, next);
+      if (diff < FISSION_MATRIX_TOL) {
+        converged = true;
+        break;
+      }
+    }
+
+    if (total == 0.0) {
+      warning("The fission matrix has no fission sites in the source mesh "
+        "bins; the source was not reweighted.");
+    } else {
+      if (!converged) {
+        warning("The fundamental mode of the fission matrix did not converge.");
+      }
+
+      // Weight factors carry the source in each occupied bin to its share of
+      // the mode, with the total source weight unchanged
+      double phi_total = 0.0;
+      double count_total = 0.0;
+      for (int i = 0; i < n; ++i) {
+        if (counts(i) > 0.0) {
+          phi_total += phi[i];
+          count_total += counts(i);
+        }
+      }
+      if (phi_total > 0.0) {
+        double norm = count_total / phi_total;
+        for (int i = 0; i < n; ++i) {
+          if (counts(i) > 0.0 && phi[i] > 0.0) {
+            weightfactors[i] = phi[i] * norm / counts(i);
+          }
+        }
+      }
+    }
+  }
+
+#ifdef OPENMC_MPI
+  MPI_Bcast(weightfactors.data(), n, MPI_DOUBLE, 0, mpi::intracomm);
+#endif
+
+  // Sites outside the mesh keep their weight
+  int64_t n_source = simulation::source_bank.size();
+  if (device_sites) {
+    const double* factors = weightfactors.data();
+    int i_mesh = mesh - model::meshes;
+    #pragma omp target teams distribute parallel for map(to: factors[:n])
+    for (int64_t i = 0; i < n_source; ++i) {
+      auto& site = simulation::device_source_bank[i];
+      int bin = model::meshes[i_mesh].get_bin(site.r);
+      if (bin >= 0) site.wgt *= factors[bin];
+    }
+  } else {
+    for (int64_t i = 0; i < n_source; ++i) {
+      auto& site = simulation::source_bank[i];
+      int bin = mesh->get_bin(site.r);
+      if (bin >= 0) site.wgt *= weightfactors[bin];
     }
   }
 }
@@ -253,12 +253,42 @@ void Tabulated1D::serialize(DataBuffer& buffer) const
   buffer.add(n_pairs_);                                  // 8
   buffer.add(x_);                                        // 8*n_pairs_
   buffer.add(y_);                                        // 8*n_pairs_
+
+  // Long tables on a positive abscissa are hashed on a logarithmic grid
+  size_t n_hash = 0;
+  if (n_pairs_ >= TABULATED_HASH_MIN_PAIRS && x_.front() > 0.0 &&
+      x_.back() > x_.front()) {
+    n_hash = n_pairs_ / TABULATED_HASH_PAIRS_PER_BIN;
+  }
+  buffer.add(n_hash);                                    // 8
+  if (n_hash == 0) return;
+
+  double log_x0, inv_spacing;
+  auto start = log_hash_start(x_.data(), n_pairs_, n_hash, log_x0, inv_spacing);
+  buffer.add(log_x0);                                    // 8
+  buffer.add(inv_spacing);                               // 8
+  buffer.add(start);                                     // 4*(n_hash + 1)
 }
 
 Tabulated1DFlat::Tabulated1DFlat(const uint8_t* data) : data_(data)
 {
   n_regions_ = *reinterpret_cast<const int*>(data_ + 4);
   n_pairs_ = *reinterpret_cast<const size_t*>(data_ + 4 + 4 + (4 + 4)*n_regions_);
+  n_hash_ = *reinterpret_cast<const size_t*>(data_ + 16 + (4 + 4)*n_regions_ +
+    16*n_pairs_);
+}
+
+gsl::index Tabulated1DFlat::find(double x) const
+{
+  auto x_ = this->x();
+  if (n_hash_ == 0) return lower_bound_index(x_.begin(), x_.end(), x);
+
+  auto hash = data_ + 24 + (4 + 4)*n_regions_ + 16*n_pairs_;
+  double log_x0 = *reinterpret_cast<const double*>(hash);
+  double inv_spacing = *reinterpret_cast<const double*>(hash + 8);
+  auto start = reinterpret_cast<const int*>(hash + 16);
+  return hashed_lower_bound_index(x_.data(), n_pairs_, start, n_hash_, log_x0,
+    inv_spacing, x);
 }
 
 double Tabulated1DFlat::operator()(double x) const
@@ -276,7 +306,7 @@ double Tabulated1DFlat::operator()(double x) const
   } else if (x > x_[n_pairs_ - 1]) {
     return y_[n_pairs_ - 1];
   } else {
-    i = lower_bound_index(x_.begin(), x_.end(), x);
+    i = this->find(x);
   }
 
   // determine interpolation scheme
@@ -1,5 +1,7 @@
 #include "openmc/endf_flat.h"
 
+#include <cstring> // for memcpy
+
 #include "openmc/endf.h"
 #include "openmc/error.h"
 
@@ -7,7 +9,7 @@ namespace openmc {
 
 double Function1DFlat::operator()(double x) const
 {
-  switch (this->type()) {
+  switch (type_) {
   case FunctionType::TABULATED:
     {
       Tabulated1DFlat dist(data_);
@@ -33,12 +35,6 @@ double Function1DFlat::operator()(double x) const
   }
 }
 
-FunctionType Function1DFlat::type() const
-{
-  int value = *reinterpret_cast<const int*>(data_);
-  return static_cast<FunctionType>(value);
-}
-
 
 Function1DFlatContainer::Function1DFlatContainer(const Function1D& func)
 {
@@ -46,9 +42,18 @@ Function1DFlatContainer::Function1DFlatContainer(const Function1D& func)
   size_t n = buffer_nbytes(func);
 
   // Write into buffer
-  buffer_.reserve(n);
+  buffer_.reserve(n, "Flattened distributions");
   func.serialize(buffer_);
   Ensures(n == buffer_.size());
+  type_ = Function1DFlat(buffer_.data_).type();
+}
+
+Function1DFlatContainer::Function1DFlatContainer(const uint8_t* data, size_t n)
+{
+  buffer_.reserve(n, "Flattened distributions");
+  std::memcpy(buffer_.data_, data, n);
+  buffer_.offset_ = n;
+  type_ = Function1DFlat(buffer_.data_).type();
 }
 
 double Function1DFlatContainer::operator()(double x) const
@@ -1,13 +1,32 @@
 #include "openmc/bank.h"
 #include "openmc/cell.h"
+#include "openmc/device_sort.h"
+#include "openmc/domain_decomposition.h"
 #include "openmc/event.h"
+#include "openmc/event_stats.h"
+#include "openmc/event_trace.h"
+#include "openmc/kernel_profile.h"
 #include "openmc/lattice.h"
 #include "openmc/material.h"
+#include "openmc/memory_registry.h"
+#include "openmc/nuclide.h"
+#include "openmc/profile_range.h"
+#include "openmc/region_costs.h"
 #include "openmc/simulation.h"
 #include "openmc/sort.h"
 #include "openmc/surface.h"
 #include "openmc/timer.h"
 #include "openmc/tallies/tally.h"
+#include "openmc/wmp.h"
+
+#include <algorithm> // for max
+#include <cmath>     // for abs
+#include <iostream>
+#include <numeric>   // for iota
+#include <vector>
+
+#include <omp.h>
+
 #ifndef DEVICE_PRINTF
 #define printf(fmt, ...) (0)
 #endif
@@ -27,23 +46,207 @@ SharedArray<EventQueueItem> surface_crossing_queue;
 SharedArray<EventQueueItem> collision_queue;
 SharedArray<EventQueueItem> revival_queue;
 
+SharedArray<EventDispatch> dispatch_scratch;
+SharedArray<int> xs_bucket_counts;
+int* device_material_xs_class;
+double* wmp_batch_xs {nullptr};
+
+double* soa_E {nullptr};
+double* soa_wgt {nullptr};
+double* soa_sqrtkT {nullptr};
+int* soa_material {nullptr};
+int* soa_cell {nullptr};
+int* soa_surface {nullptr};
+
 int current_source_offset;
+int n_sources_ready;
+int* device_source_order {nullptr};
+vector<int> source_order;
+bool wmp_batching {false};
 
 int sort_counter{0};
+int sort_skip_counter{0};
+
+int particle_extent {0};
+int compact_counter {0};
+
+vector<int> material_xs_class;
+
+EventCostModel event_cost_model;
 
 } // namespace simulation
 
+namespace {
+
+// Device scratch memory used by compact_particle_buffer(), allocated on first
+// use and growing only if a larger population is ever compacted
+struct CompactScratch {
+  int n_slots {0};
+  int n_parked {0};
+  int n_chunks {0};
+  vector<Particle> parked;
+  int* new_slot {nullptr};
+  int* rank {nullptr};
+  int* vacated {nullptr};
+  int* chunk_sums {nullptr};
+
+  void reserve(int slots, int n_live)
+  {
+    if (slots <= n_slots && n_live <= n_parked) return;
+    clear();
+
+    n_slots = slots;
+    n_parked = n_live;
+    n_chunks = (n_slots + SCAN_CHUNK - 1) / SCAN_CHUNK;
+    parked.resize(n_parked);
+    new_slot = new int[n_slots];
+    rank = new int[n_slots];
+    vacated = new int[n_parked];
+    chunk_sums = new int[n_chunks];
+
+    Particle* p = parked.data();
+    #pragma omp target enter data map(alloc: p[:n_parked], \
+      new_slot[:n_slots], rank[:n_slots], vacated[:n_parked], \
+      chunk_sums[:n_chunks])
+    record_memory("Particle compaction", MemorySpace::device,
+      n_parked * static_cast<int64_t>(sizeof(Particle) + sizeof(int)) +
+      (2 * n_slots + n_chunks) * static_cast<int64_t>(sizeof(int)));
+  }
+
+  void clear()
+  {
+    if (n_slots == 0) return;
+
+    Particle* p = parked.data();
+    #pragma omp target exit data map(delete: p[:n_parked], \
+      new_slot[:n_slots], rank[:n_slots], vacated[:n_parked], \
+      chunk_sums[:n_chunks])
+    record_memory("Particle compaction", MemorySpace::device,
+      -(n_parked * static_cast<int64_t>(sizeof(Particle) + sizeof(int)) +
+      (2 * n_slots + n_chunks) * static_cast<int64_t>(sizeof(int))));
+
+    parked.clear();
+    parked.shrink_to_fit();
+    delete[] new_slot;
+    delete[] rank;
+    delete[] vacated;
+    delete[] chunk_sums;
+    new_slot = rank = vacated = chunk_sums = nullptr;
+    n_slots = n_parked = n_chunks = 0;
+  }
+};
+
+CompactScratch compact_scratch;
+
+} // namespace
+
+//==============================================================================
+// EventCostModel implementation
+//==============================================================================
+
+void EventCostModel::record(EventType type, int64_t n_items, double time)
+{
+  if (n_items <= 0) return;
+  auto& s = stats_[static_cast<int>(type)];
+  double n = static_cast<double>(n_items);
+  s.w += 1.0;
+  s.n += n;
+  s.t += time;
+  s.nn += n * n;
+  s.nt += n * time;
+  s.count++;
+}
+
+bool EventCostModel::is_calibrated(EventType type) const
+{
+  // At least two launches are needed to separate latency from per-item cost
+  return stats_[static_cast<int>(type)].count >= 2;
+}
+
+void EventCostModel::coefficients(EventType type, double& a, double& b) const
+{
+  const auto& s = stats_[static_cast<int>(type)];
+  a = 0.0;
+  b = 0.0;
+  if (s.w <= 0.0 || s.n <= 0.0) return;
+
+  double det = s.w * s.nn - s.n * s.n;
+  if (std::abs(det) > 1.0e-12 * s.w * s.nn) {
+    b = (s.w * s.nt - s.n * s.t) / det;
+    a = (s.t - b * s.n) / s.w;
+  }
+
+  // If all launches had (nearly) the same size, or the fit is unphysical due to
+  // timing noise, attribute all of the time to the per-item cost
+  if (det <= 1.0e-12 * s.w * s.nn || a < 0.0 || b < 0.0) {
+    a = 0.0;
+    b = s.t / s.n;
+  }
+}
+
+double EventCostModel::predicted_time(EventType type, int64_t n_items) const
+{
+  double a, b;
+  coefficients(type, a, b);
+  return a + b * n_items;
+}
+
+double EventCostModel::throughput(EventType type, int64_t n_items) const
+{
+  double t = predicted_time(type, n_items);
+  return t > 0.0 ? n_items / t : INFINITY;
+}
+
+double EventCostModel::latency_bound_size(EventType type) const
+{
+  if (!is_calibrated(type)) return 0.0;
+  double a, b;
+  coefficients(type, a, b);
+  return b > 0.0 ? a / b : 0.0;
+}
+
+void EventCostModel::decay(double factor)
+{
+  for (auto& s : stats_) {
+    s.w *= factor;
+    s.n *= factor;
+    s.t *= factor;
+    s.nn *= factor;
+    s.nt *= factor;
+  }
+}
+
+void EventCostModel::reset()
+{
+  for (auto& s : stats_) {
+    s = Stats();
+  }
+}
+
 //==============================================================================
 // Non-member functions
 //==============================================================================
 
 void sort_queue(SharedArray<EventQueueItem>& queue, SortBy sort_by)
 {
+  ProfileRange range {"sort_queue"};
   simulation::time_event_sort.start();
 
   if (queue.size() > settings::minimum_sort_items)
   {
+    // Queues that are close enough to sorted order (e.g., because the same
+    // particles were sorted in the previous iteration) are left as they are
+    if (settings::sort_skip_fraction > 0.0 &&
+        count_unsorted(queue, sort_by) <=
+        settings::sort_skip_fraction * queue.size()) {
+      simulation::sort_skip_counter++;
+      record_sort(queue.size(), true);
+      simulation::time_event_sort.stop();
+      return;
+    }
+
     simulation::sort_counter++;
+    record_sort(queue.size(), false);
 
     switch(sort_by) {
       case SortBy::material_energy:
@@ -52,7 +255,12 @@ void sort_queue(SharedArray<EventQueueItem>& queue, SortBy sort_by)
           thrust_sort_MatE(queue.device_data(), queue.device_data() + queue.size());
           #elif SYCL_SORT
           SYCL_sort_MatE(queue.device_data(), queue.device_data() + queue.size());
+          #else
+          device_radix_sort(queue, sort_by);
           #endif
+        } else if (settings::sort_key_index) {
+          // Sort only keys and indices on host, then gather on device
+          host_key_index_sort(queue, sort_by);
         } else {
           // Transfer queue information to the host
           #pragma omp target update from(queue.data_[:queue.size()])
@@ -70,7 +278,12 @@ void sort_queue(SharedArray<EventQueueItem>& queue, SortBy sort_by)
           thrust_sort_CellSurf(queue.device_data(), queue.device_data() + queue.size());
           #elif SYCL_SORT
           SYCL_sort_CellSurf(queue.device_data(), queue.device_data() + queue.size());
+          #else
+          device_radix_sort(queue, sort_by);
           #endif
+        } else if (settings::sort_key_index) {
+          // Sort only keys and indices on host, then gather on device
+          host_key_index_sort(queue, sort_by);
         } else {
           // Transfer queue information to the host
           #pragma omp target update from(queue.data_[:queue.size()])
@@ -82,40 +295,103 @@ void sort_queue(SharedArray<EventQueueItem>& queue, SortBy sort_by)
           #pragma omp target update to(queue.data_[:queue.size()])
         }
         break;
+      case SortBy::position:
+        // Position keys are built from the particles themselves, which only
+        // reside on device, so there is no comparator for the full items
+        if (settings::sort_on_device) {
+          device_radix_sort(queue, sort_by);
+        } else {
+          host_key_index_sort(queue, sort_by);
+        }
+        break;
     }
   }
 
   simulation::time_event_sort.stop();
 }
 
-bool is_sorted(SharedArray<EventQueueItem>& queue)
+bool is_sorted(SharedArray<EventQueueItem>& queue, SortBy sort_by)
+{
+  return count_unsorted(queue, sort_by) == 0;
+}
+
+SharedArray<EventQueueItem>& event_queue(EventType type)
 {
-  int not_sorted = 0;
-  if( simulation::calculate_fuel_xs_queue.size() > settings::minimum_sort_items )
+  switch (type) {
+  case EventType::calculate_xs_fuel:
+    return simulation::calculate_fuel_xs_queue;
+  case EventType::calculate_xs_nonfuel:
+    return simulation::calculate_nonfuel_xs_queue;
+  case EventType::advance:
+    return simulation::advance_particle_queue;
+  case EventType::surface_crossing:
+    return simulation::surface_crossing_queue;
+  case EventType::collision:
+    return simulation::collision_queue;
+  case EventType::revival:
+  default:
+    return simulation::revival_queue;
+  }
+}
+
+void sync_queue_sizes(const EventType* processed, int n_to_advance,
+  int n_processed)
+{
+  // Packed sizes of every queue, followed by the current source offset
+  int sizes[N_EVENT_TYPES + 1];
+  int n_reset = processed != nullptr ? n_processed : 0;
+  int reset[N_EVENT_TYPES];
+  for (int i = 0; i < n_reset; ++i) {
+    reset[i] = static_cast<int>(processed[i]);
+  }
+
+  #pragma omp target map(to: reset[:N_EVENT_TYPES]) \
+    map(from: sizes[:N_EVENT_TYPES + 1])
   {
-    #pragma omp target teams distribute parallel for reduction(+:not_sorted)
-    for( int i = 1; i < queue.size(); i++ )
-    {
-      if( queue[i-1].E > queue[i].E )
-        not_sorted += 1;
+    for (int i = 0; i < n_reset; ++i) {
+      event_queue(static_cast<EventType>(reset[i])).size_ = 0;
     }
+    simulation::advance_particle_queue.size_ += n_to_advance;
+    for (int i = 0; i < N_EVENT_TYPES; ++i) {
+      sizes[i] = event_queue(static_cast<EventType>(i)).size_;
+    }
+    sizes[N_EVENT_TYPES] = simulation::current_source_offset;
   }
-  if( !not_sorted )
-    return true;
-  else
-    return false;
+
+  for (int i = 0; i < N_EVENT_TYPES; ++i) {
+    event_queue(static_cast<EventType>(i)).set_host_size(sizes[i]);
+  }
+  simulation::current_source_offset = sizes[N_EVENT_TYPES];
 }
 
-void init_event_queues(int n_particles)
+//! Zero the population of every XS lookup queue bucket
+void reset_xs_bucket_counts()
 {
-  simulation::calculate_fuel_xs_queue.reserve(n_particles);
-  simulation::calculate_nonfuel_xs_queue.reserve(n_particles);
-  simulation::advance_particle_queue.reserve(n_particles);
-  simulation::surface_crossing_queue.reserve(n_particles);
-  simulation::collision_queue.reserve(n_particles);
-  simulation::revival_queue.reserve(n_particles);
+  int n_buckets = simulation::xs_bucket_counts.size();
+  #pragma omp target teams distribute parallel for
+  for (int b = 0; b < n_buckets; ++b) {
+    simulation::xs_bucket_counts[b] = 0;
+  }
+}
 
+void init_event_queues(int n_particles)
+{
+  // Host event kernels merge the queue appends of their threads, which needs
+  // the destinations of the particles to be recorded first
+  if (settings::cpu_event_kernels) settings::aggregate_queue_appends = true;
+
+  simulation::calculate_fuel_xs_queue.reserve(n_particles, "Event queues");
+  simulation::calculate_nonfuel_xs_queue.reserve(n_particles, "Event queues");
+  simulation::advance_particle_queue.reserve(n_particles, "Event queues");
+  simulation::surface_crossing_queue.reserve(n_particles, "Event queues");
+  simulation::collision_queue.reserve(n_particles, "Event queues");
+  simulation::revival_queue.reserve(n_particles, "Event queues");
+  simulation::dispatch_scratch.reserve(n_particles, "Event queues");
+
+  int64_t n_old = simulation::particles.size();
   simulation::particles.resize(n_particles);
+  record_memory("Particle buffer", MemorySpace::host,
+    (n_particles - n_old) * static_cast<int64_t>(sizeof(Particle)));
 
   // Allocate any queues that are needed on device
   simulation::calculate_fuel_xs_queue.allocate_on_device();
@@ -124,6 +400,62 @@ void init_event_queues(int n_particles)
   simulation::surface_crossing_queue.allocate_on_device();
   simulation::collision_queue.allocate_on_device();
   simulation::revival_queue.allocate_on_device();
+  simulation::dispatch_scratch.allocate_on_device();
+
+  if (settings::deferred_tally_scores > 0) {
+    init_tally_score_queue(settings::deferred_tally_scores * n_particles);
+  }
+
+  if (settings::bucket_xs_queues) {
+    int n_buckets = settings::n_log_bins * (1 + model::materials_size);
+    simulation::xs_bucket_counts.reserve(n_buckets, "Event queues");
+    simulation::xs_bucket_counts.resize(n_buckets);
+    simulation::xs_bucket_counts.allocate_on_device();
+    reset_xs_bucket_counts();
+  }
+
+  // Give the materials with the most nuclides their own XS lookup class
+  simulation::material_xs_class.assign(model::materials_size, 0);
+  vector<int> by_size(model::materials_size);
+  std::iota(by_size.begin(), by_size.end(), 0);
+  std::stable_sort(by_size.begin(), by_size.end(), [](int a, int b) {
+    return model::materials[a].nuclide_.size() >
+      model::materials[b].nuclide_.size();
+  });
+  int n_classes = std::min(settings::n_material_xs_queues, model::materials_size);
+  for (int c = 0; c < n_classes; ++c) {
+    simulation::material_xs_class[by_size[c]] = c + 1;
+  }
+  simulation::device_material_xs_class = simulation::material_xs_class.data();
+  #pragma omp target enter data map(to: simulation::device_material_xs_class[:model::materials_size])
+
+  // Allocate the results of batched multipole evaluations
+  if (settings::wmp_batch_lookups && settings::temperature_multipole) {
+    init_wmp_slots();
+    if (data::n_wmp_nuclides > 0) {
+      simulation::wmp_batching = true;
+      int64_t n = 3 * static_cast<int64_t>(settings::wmp_batch_items) *
+        data::n_wmp_nuclides;
+      simulation::wmp_batch_xs = new double[n];
+      #pragma omp target enter data map(alloc: simulation::wmp_batch_xs[:n])
+    }
+  }
+
+  // Allocate the structure-of-arrays particle fields
+  if (settings::particle_soa) {
+    simulation::soa_E = new double[n_particles];
+    simulation::soa_wgt = new double[n_particles];
+    simulation::soa_sqrtkT = new double[n_particles];
+    simulation::soa_material = new int[n_particles];
+    simulation::soa_cell = new int[n_particles];
+    simulation::soa_surface = new int[n_particles];
+    #pragma omp target enter data map(alloc: simulation::soa_E[:n_particles])
+    #pragma omp target enter data map(alloc: simulation::soa_wgt[:n_particles])
+    #pragma omp target enter data map(alloc: simulation::soa_sqrtkT[:n_particles])
+    #pragma omp target enter data map(alloc: simulation::soa_material[:n_particles])
+    #pragma omp target enter data map(alloc: simulation::soa_cell[:n_particles])
+    #pragma omp target enter data map(alloc: simulation::soa_surface[:n_particles])
+  }
 
   #pragma omp target update to(simulation::work_per_rank)
 }
@@ -136,99 +468,637 @@ void free_event_queues(void)
   simulation::surface_crossing_queue.clear();
   simulation::collision_queue.clear();
   simulation::revival_queue.clear();
+  simulation::dispatch_scratch.clear();
+  simulation::xs_bucket_counts.clear();
+  free_tally_score_queue();
+  free_device_sort_scratch();
+  compact_scratch.clear();
+
+  #pragma omp target exit data map(delete: simulation::device_material_xs_class[:model::materials_size])
+  simulation::material_xs_class.clear();
+
+  if (simulation::wmp_batching) {
+    int64_t n = 3 * static_cast<int64_t>(settings::wmp_batch_items) *
+      data::n_wmp_nuclides;
+    #pragma omp target exit data map(delete: simulation::wmp_batch_xs[:n])
+    delete[] simulation::wmp_batch_xs;
+    simulation::wmp_batch_xs = nullptr;
+    simulation::wmp_batching = false;
+  }
+  if (settings::wmp_batch_lookups && settings::temperature_multipole) {
+    free_wmp_slots();
+  }
+
+  if (simulation::soa_E) {
+    int n = simulation::particles.size();
+    #pragma omp target exit data map(delete: simulation::soa_E[:n])
+    #pragma omp target exit data map(delete: simulation::soa_wgt[:n])
+    #pragma omp target exit data map(delete: simulation::soa_sqrtkT[:n])
+    #pragma omp target exit data map(delete: simulation::soa_material[:n])
+    #pragma omp target exit data map(delete: simulation::soa_cell[:n])
+    #pragma omp target exit data map(delete: simulation::soa_surface[:n])
+    delete[] simulation::soa_E;
+    delete[] simulation::soa_wgt;
+    delete[] simulation::soa_sqrtkT;
+    delete[] simulation::soa_material;
+    delete[] simulation::soa_cell;
+    delete[] simulation::soa_surface;
+    simulation::soa_E = nullptr;
+    simulation::soa_wgt = nullptr;
+    simulation::soa_sqrtkT = nullptr;
+    simulation::soa_material = nullptr;
+    simulation::soa_cell = nullptr;
+    simulation::soa_surface = nullptr;
+  }
 
   simulation::particles.clear();
 }
 
-void dispatch_xs_event(int buffer_idx)
+size_t event_bytes_per_particle(bool verbose)
+{
+  size_t particle = sizeof(Particle);
+#ifdef NO_MICRO_XS_CACHE
+  size_t micro_xs = 0;
+  size_t depletion_rx = simulation::n_depletion_rx * sizeof(double);
+#else
+  size_t micro_xs = data::nuclides_size * sizeof(NuclideMicroXS);
+  size_t depletion_rx = simulation::n_depletion_rx * (1 + data::nuclides_size) *
+    sizeof(double);
+#endif
+  size_t queues = 6 * sizeof(EventQueueItem) + sizeof(EventDispatch);
+  size_t soa = settings::particle_soa ? 3 * sizeof(double) + 3 * sizeof(int) : 0;
+  size_t scores = settings::deferred_tally_scores *
+    (sizeof(TallyScore) + sizeof(uint64_t) + sizeof(uint32_t));
+  size_t compact = settings::compact_threshold > 0.0 ? 2 * sizeof(int) +
+    settings::compact_threshold * (sizeof(Particle) + sizeof(int)) : 0;
+
+  if (verbose) {
+    std::cout << " Event-based memory per in-flight particle: "
+      << particle + micro_xs + depletion_rx + queues + soa + scores + compact
+      << " bytes (particle " << particle << ", micro XS cache " << micro_xs
+      << ", depletion reaction XS " << depletion_rx << ", queue entries "
+      << queues << ", SoA fields " << soa << ", deferred tally scores "
+      << scores << ", compaction " << compact << ")" << std::endl;
+  }
+  return particle + micro_xs + depletion_rx + queues + soa + scores + compact;
+}
+
+#pragma omp declare target
+void publish_particle_soa(int buffer_idx)
+{
+  const Particle& p = simulation::device_particles[buffer_idx];
+  simulation::soa_E[buffer_idx] = p.E_;
+  simulation::soa_wgt[buffer_idx] = p.wgt_;
+  simulation::soa_sqrtkT[buffer_idx] = p.sqrtkT_;
+  simulation::soa_material[buffer_idx] = p.material_;
+  simulation::soa_cell[buffer_idx] = p.coord_[p.n_coord_ - 1].cell;
+  simulation::soa_surface[buffer_idx] = p.boundary_.surface_index;
+}
+
+double particle_E(int buffer_idx)
+{
+  return settings::particle_soa ? simulation::soa_E[buffer_idx] :
+    simulation::device_particles[buffer_idx].E_;
+}
+
+double particle_wgt(int buffer_idx)
+{
+  return settings::particle_soa ? simulation::soa_wgt[buffer_idx] :
+    simulation::device_particles[buffer_idx].wgt_;
+}
+
+double particle_sqrtkT(int buffer_idx)
+{
+  return settings::particle_soa ? simulation::soa_sqrtkT[buffer_idx] :
+    simulation::device_particles[buffer_idx].sqrtkT_;
+}
+
+int particle_material(int buffer_idx)
+{
+  return settings::particle_soa ? simulation::soa_material[buffer_idx] :
+    simulation::device_particles[buffer_idx].material_;
+}
+
+int particle_cell(int buffer_idx)
+{
+  if (settings::particle_soa) return simulation::soa_cell[buffer_idx];
+  const Particle& p = simulation::device_particles[buffer_idx];
+  return p.coord_[p.n_coord_ - 1].cell;
+}
+
+int particle_surface(int buffer_idx)
+{
+  return settings::particle_soa ? simulation::soa_surface[buffer_idx] :
+    simulation::device_particles[buffer_idx].boundary_.surface_index;
+}
+
+//! Build the queue item for a particle destined for a given queue
+EventQueueItem make_queue_item(int buffer_idx, EventType type)
+{
+  int cell_id = particle_cell(buffer_idx);
+  int surface_id = particle_surface(buffer_idx);
+  double E = particle_E(buffer_idx);
+
+  // Only the non-fuel lookup queue is sorted by material
+  if (type == EventType::calculate_xs_nonfuel) {
+    return {E, particle_material(buffer_idx), buffer_idx, cell_id, surface_id};
+  } else {
+    return {E, buffer_idx, cell_id, surface_id};
+  }
+}
+#pragma omp end declare target
+
+int energy_bin(double E)
+{
+  int neutron = static_cast<int>(Particle::Type::neutron);
+  int i_grid = std::log(E/data::energy_min[neutron])/simulation::log_spacing;
+  return std::min(std::max(i_grid, 0), settings::n_log_bins - 1);
+}
+
+int xs_bucket(const EventQueueItem& item, EventType type)
+{
+  int n_bins = settings::n_log_bins;
+  int i_grid = energy_bin(item.E);
+
+  if (type == EventType::calculate_xs_fuel) {
+    return i_grid;
+  } else {
+    return n_bins * (1 + item.material) + i_grid;
+  }
+}
+
+int xs_lookup_class(const EventQueueItem& item)
+{
+  return simulation::device_material_xs_class[particle_material(item.idx)];
+}
+
+int collision_class(const EventQueueItem& item)
+{
+  return static_cast<int>(simulation::device_particles[item.idx].collision_class_);
+}
+
+int partition_class(const EventQueueItem& item, PartitionBy partition_by)
+{
+  return partition_by == PartitionBy::collision_class ?
+    collision_class(item) : xs_lookup_class(item);
+}
+
+#pragma omp declare target
+//! Append an item to a queue, counting it in its bucket if the queue is a
+//! bucketed XS lookup queue
+void append_queue_item(EventType type, const EventQueueItem& item, int index)
+{
+  auto& queue = event_queue(type);
+  if (index < 0) {
+    index = queue.thread_safe_append(item);
+  } else {
+    queue[index] = item;
+  }
+  if (index >= 0 && settings::bucket_xs_queues &&
+      (type == EventType::calculate_xs_fuel ||
+       type == EventType::calculate_xs_nonfuel)) {
+    #pragma omp atomic
+    simulation::xs_bucket_counts[xs_bucket(item, type)]++;
+  }
+}
+#pragma omp end declare target
+
+EventType dispatch_xs_destination(int buffer_idx)
 {
   Particle& p = simulation::device_particles[buffer_idx];
 
   // Determine if the particle requires an XS lookup or not
   bool needs_lookup = p.event_calculate_xs_dispatch();
 
-  int cell_id = p.coord_[p.n_coord_ - 1].cell;
-  int surface_id = p.boundary_.surface_index;
-
   if (needs_lookup) {
     // If a lookup is needed, dispatch to fuel vs. non-fuel lookup queue
     if (!model::materials[p.material_].fissionable_) {
-      simulation::calculate_nonfuel_xs_queue.thread_safe_append({p.E_, p.material_, buffer_idx, cell_id, surface_id});
+      return EventType::calculate_xs_nonfuel;
     } else {
-      simulation::calculate_fuel_xs_queue.thread_safe_append({p.E_, buffer_idx, cell_id, surface_id});
+      return EventType::calculate_xs_fuel;
     }
   } else {
     // Otherwise, particle can move directly to the advance particle queue
-    simulation::advance_particle_queue.thread_safe_append({p.E_, buffer_idx, cell_id, surface_id});
+    return EventType::advance;
+  }
+}
+
+void dispatch_xs_event(int buffer_idx)
+{
+  EventType type = dispatch_xs_destination(buffer_idx);
+  if (settings::particle_soa) publish_particle_soa(buffer_idx);
+  append_queue_item(type, make_queue_item(buffer_idx, type), -1);
+}
+
+void dispatch_particle(int i, int buffer_idx, int queue, bool aggregate)
+{
+  if (settings::particle_soa && queue >= 0) publish_particle_soa(buffer_idx);
+  if (aggregate) {
+    simulation::dispatch_scratch[i] = {buffer_idx, queue};
+  } else if (queue >= 0) {
+    auto type = static_cast<EventType>(queue);
+    append_queue_item(type, make_queue_item(buffer_idx, type), -1);
   }
 }
 
-void process_init_events(int n_particles)
+//! Append the particles whose destinations are in dispatch_scratch to their
+//! queues from host threads. Each thread counts the destinations of a
+//! contiguous chunk of the items, a prefix sum over the counts gives each
+//! chunk consecutive blocks of the queues, and each thread then fills its
+//! blocks in order, so that no atomics are needed.
+void enqueue_aggregated_host(int n_items)
+{
+  if (n_items == 0) return;
+  int n_chunks = std::min(omp_get_max_threads(), n_items);
+  std::vector<int> offsets(n_chunks * N_EVENT_TYPES, 0);
+  auto chunk_first = [=](int c) {
+    return static_cast<int>(static_cast<int64_t>(n_items) * c / n_chunks);
+  };
+
+  #pragma omp parallel for schedule(static, 1)
+  for (int c = 0; c < n_chunks; ++c) {
+    int* count = &offsets[c * N_EVENT_TYPES];
+    for (int i = chunk_first(c); i < chunk_first(c + 1); ++i) {
+      int q = simulation::dispatch_scratch[i].queue;
+      if (q >= 0) count[q]++;
+    }
+  }
+
+  // Turn the counts into the position of each chunk's block, which is -1 if
+  // the queue is full
+  for (int q = 0; q < N_EVENT_TYPES; ++q) {
+    int total = 0;
+    for (int c = 0; c < n_chunks; ++c) {
+      int n = offsets[c * N_EVENT_TYPES + q];
+      offsets[c * N_EVENT_TYPES + q] = total;
+      total += n;
+    }
+    if (total == 0) continue;
+    int base = event_queue(static_cast<EventType>(q)).thread_safe_reserve(total);
+    for (int c = 0; c < n_chunks; ++c) {
+      int& offset = offsets[c * N_EVENT_TYPES + q];
+      offset = base < 0 ? -1 : base + offset;
+    }
+  }
+
+  #pragma omp parallel for schedule(static, 1)
+  for (int c = 0; c < n_chunks; ++c) {
+    int* offset = &offsets[c * N_EVENT_TYPES];
+    for (int i = chunk_first(c); i < chunk_first(c + 1); ++i) {
+      EventDispatch d = simulation::dispatch_scratch[i];
+      if (d.queue < 0 || offset[d.queue] < 0) continue;
+      auto type = static_cast<EventType>(d.queue);
+      append_queue_item(type, make_queue_item(d.idx, type), offset[d.queue]++);
+    }
+  }
+}
+
+void enqueue_aggregated(int n_items)
+{
+  if (settings::cpu_event_kernels) {
+    enqueue_aggregated_host(n_items);
+    return;
+  }
+
+  // Number of queue items handled by each team
+  constexpr int block_size {256};
+  int n_blocks = (n_items + block_size - 1) / block_size;
+
+  #pragma omp target teams distribute
+  for (int block = 0; block < n_blocks; ++block) {
+    int first = block * block_size;
+    int last = std::min(first + block_size, n_items);
+
+    // Count this team's particles bound for each queue
+    int count[N_EVENT_TYPES] = {0};
+    #pragma omp parallel for reduction(+:count[:N_EVENT_TYPES])
+    for (int i = first; i < last; ++i) {
+      int q = simulation::dispatch_scratch[i].queue;
+      if (q >= 0) count[q]++;
+    }
+
+    // Reserve a contiguous block in each destination queue
+    int base[N_EVENT_TYPES];
+    int offset[N_EVENT_TYPES];
+    for (int q = 0; q < N_EVENT_TYPES; ++q) {
+      base[q] = count[q] > 0 ?
+        event_queue(static_cast<EventType>(q)).thread_safe_reserve(count[q]) : 0;
+      offset[q] = 0;
+    }
+
+    // Fill the reserved blocks. The remaining atomics are only on team-local
+    // counters rather than on the global queue sizes.
+    #pragma omp parallel for
+    for (int i = first; i < last; ++i) {
+      EventDispatch d = simulation::dispatch_scratch[i];
+      if (d.queue < 0 || base[d.queue] < 0) continue;
+      int j;
+      #pragma omp atomic capture
+      j = offset[d.queue]++;
+      auto type = static_cast<EventType>(d.queue);
+      append_queue_item(type, make_queue_item(d.idx, type), base[d.queue] + j);
+    }
+  }
+}
+
+#pragma omp declare target
+//! Start the history of a particle in the buffer and queue it
+void init_event(int i, int first_source, bool aggregate)
+{
+  int index_source = settings::async_bank_exchange ?
+    simulation::device_source_order[first_source + i] : first_source + i;
+  initialize_history(simulation::device_particles[i], index_source + 1);
+  int queue = static_cast<int>(dispatch_xs_destination(i));
+  dispatch_particle(i, i, queue, aggregate);
+}
+#pragma omp end declare target
+
+void process_init_events(int n_particles, int first_source)
 {
   simulation::time_event_init.start();
+  ProfileRegion profile {PROFILE_INIT, n_particles};
+  ProfileRange range {PROFILE_INIT};
+  record_kernel_launch();
 
-  simulation::current_source_offset = n_particles;
+  simulation::current_source_offset = first_source + n_particles;
   #pragma omp target update to(simulation::current_source_offset)
 
   double total_weight = 0.0;
+  bool aggregate = settings::aggregate_queue_appends;
 
-  #pragma omp target teams distribute parallel for
-  for (int i = 0; i < n_particles; i++) {
-    initialize_history(simulation::device_particles[i], i + 1);
-    dispatch_xs_event(i);
+  if (settings::cpu_event_kernels) {
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n_particles; i++) {
+      init_event(i, first_source, aggregate);
+    }
+  } else {
+    #pragma omp target teams distribute parallel for
+    for (int i = 0; i < n_particles; i++) {
+      init_event(i, first_source, aggregate);
+    }
   }
+  if (aggregate) enqueue_aggregated(n_particles);
 
   // The loop below can in theory be combined with the one above,
   // but is present here as a compiler bug workaround
-  #pragma omp target teams distribute parallel for reduction(+:total_weight)
-  for (int i = 0; i < n_particles; i++) {
-    total_weight += simulation::device_particles[i].wgt_;
+  if (settings::cpu_event_kernels) {
+    #pragma omp parallel for simd reduction(+:total_weight)
+    for (int i = 0; i < n_particles; i++) {
+      total_weight += particle_wgt(i);
+    }
+  } else {
+    #pragma omp target teams distribute parallel for reduction(+:total_weight)
+    for (int i = 0; i < n_particles; i++) {
+      total_weight += particle_wgt(i);
+    }
   }
   simulation::time_event_init.stop();
 
+  // Every other slot has finished, so only the new particles can be queued
+  simulation::particle_extent = n_particles;
+
   // Write total weight to global variable
-  simulation::total_weight = total_weight;
+  if (first_source == 0) simulation::total_weight = 0.0;
+  simulation::total_weight += total_weight;
+
+  sync_queue_sizes();
+}
 
-  simulation::calculate_fuel_xs_queue.sync_size_device_to_host();
-  simulation::calculate_nonfuel_xs_queue.sync_size_device_to_host();
-  simulation::advance_particle_queue.sync_size_device_to_host();
+void process_arrival_events(int n_particles)
+{
+  simulation::time_event_init.start();
+  ProfileRegion profile {PROFILE_INIT, n_particles};
+  ProfileRange range {PROFILE_INIT};
+  record_kernel_launch();
+
+  // The keff tally accumulators of the buffer entries are kept, as they are
+  // only added up by process_death_events()
+  bool aggregate = settings::aggregate_queue_appends;
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n_particles; i++) {
+    receive_from_domain(simulation::device_particles[i],
+      simulation::domain_inbox[i]);
+    int queue = static_cast<int>(dispatch_xs_destination(i));
+    dispatch_particle(i, i, queue, aggregate);
+  }
+  if (aggregate) enqueue_aggregated(n_particles);
+  simulation::particle_extent = n_particles;
+  simulation::time_event_init.stop();
 
+  sync_queue_sizes();
+}
+
+void reduce_tally_scores_if_needed()
+{
+  if (settings::deferred_tally_scores == 0) return;
+  simulation::tally_score_queue.sync_size_device_to_host();
+  if (simulation::tally_score_queue.size() >
+      simulation::tally_score_queue.capacity() / 2) {
+    reduce_tally_scores();
+  }
 }
 
 bool depletion_rx_check()
 {
   return !model::active_tracklength_tallies.empty() &&
-    (simulation::need_depletion_rx || simulation::depletion_scores_present);
+    simulation::n_depletion_rx > 0;
 }
 
-void process_calculate_xs_events_nonfuel()
+void bucket_xs_queue(EventType type)
+{
+  ProfileRange range {"bucket_xs_queue"};
+  simulation::time_event_sort.start();
+
+  int n_bins = settings::n_log_bins;
+  int first = type == EventType::calculate_xs_fuel ? 0 : n_bins;
+  int n_buckets = type == EventType::calculate_xs_fuel ? n_bins :
+    simulation::xs_bucket_counts.size() - n_bins;
+  device_bucket_scatter(event_queue(type), type,
+    simulation::xs_bucket_counts.data() + first, first, n_buckets);
+
+  simulation::time_event_sort.stop();
+}
+
+//! Prefetch the nuclide data read by the XS lookup of a particle (see
+//! Material::prefetch_xs())
+//
+//! \param buffer_idx Index of the particle in the buffer
+//! \param grid Whether this is the second stage of the prefetch
+void prefetch_xs_lookup(int buffer_idx, bool grid)
+{
+  const Particle& p = simulation::device_particles[buffer_idx];
+  int i_material = particle_material(buffer_idx);
+  if (p.type_ != Particle::Type::neutron || i_material == MATERIAL_VOID) return;
+  model::materials[i_material].prefetch_xs(particle_E(buffer_idx), grid);
+}
+
+//! Look up the XS of a contiguous range of an XS lookup queue on host
+//! threads, prefetching the nuclide data of the particles XS_PREFETCH_DISTANCE
+//! items ahead in two stages, so that the lookups of a sorted queue stream
+//! through the nuclide grids rather than waiting on each of them
+void calculate_xs_host(SharedArray<EventQueueItem>& queue, int first,
+  int last, int offset, bool need_depletion_rx)
+{
+  #pragma omp parallel for schedule(static)
+  for (int i = first; i < last; i++) {
+    if (i + 2*XS_PREFETCH_DISTANCE < last)
+      prefetch_xs_lookup(queue[i + 2*XS_PREFETCH_DISTANCE].idx, false);
+    if (i + XS_PREFETCH_DISTANCE < last)
+      prefetch_xs_lookup(queue[i + XS_PREFETCH_DISTANCE].idx, true);
+    int buffer_idx = queue[i].idx;
+    Particle& p = simulation::device_particles[buffer_idx];
+    p.event_calculate_xs_execute(need_depletion_rx);
+    p.wmp_xs_ = nullptr;
+    simulation::advance_particle_queue[offset + i] = queue[i];
+  }
+}
+
+//! Launch the XS lookup kernel for a contiguous range of an XS lookup queue.
+//! The kernel is launched asynchronously and must be waited on with a
+//! taskwait.
+void launch_calculate_xs_kernel(SharedArray<EventQueueItem>& queue, int first,
+  int last, int offset, bool need_depletion_rx)
+{
+  if (settings::cpu_event_kernels) {
+    calculate_xs_host(queue, first, last, offset, need_depletion_rx);
+    return;
+  }
+
+  #pragma omp target teams distribute parallel for nowait
+  for (int i = first; i < last; i++) {
+    int buffer_idx = queue[i].idx;
+    Particle& p = simulation::device_particles[buffer_idx];
+    p.event_calculate_xs_execute(need_depletion_rx);
+    p.wmp_xs_ = nullptr;
+    simulation::advance_particle_queue[offset + i] = queue[i];
+  }
+}
+
+//! Evaluate the multipole XS of every particle in a range of an XS lookup
+//! queue for every multipole nuclide in its material, storing them in
+//! simulation::wmp_batch_xs for the following XS lookup kernel to use
+void evaluate_wmp_batch(SharedArray<EventQueueItem>& queue, int first,
+  int last)
 {
-  // Sort non fuel lookup queue by material and energy
-  if (settings::sort_non_fissionable_xs_lookups) {
-    sort_queue(simulation::calculate_nonfuel_xs_queue, SortBy::material_energy);
+  int n_items = last - first;
+  int n_wmp = data::n_wmp_nuclides;
+
+  // Iterations are nuclide-major, so consecutive threads evaluate the same
+  // nuclide for consecutive particles. As the queue is ordered by energy,
+  // these mostly fall in the same window and share its poles and curve fit.
+  #pragma omp target teams distribute parallel for collapse(2)
+  for (int w = 0; w < n_wmp; w++) {
+    for (int i = 0; i < n_items; i++) {
+      int buffer_idx = queue[first + i].idx;
+      double* xs = &simulation::wmp_batch_xs[3 * (static_cast<int64_t>(i) * n_wmp + w)];
+      if (w == 0) {
+        simulation::device_particles[buffer_idx].wmp_xs_ =
+          &simulation::wmp_batch_xs[3 * static_cast<int64_t>(i) * n_wmp];
+      }
+
+      int i_nuclide = data::device_wmp_nuclides[w];
+      if (!model::materials[particle_material(buffer_idx)].contains_nuclide(i_nuclide))
+        continue;
+      const auto* mp = data::nuclides[i_nuclide].multipole();
+      double E = particle_E(buffer_idx);
+      if (E < mp->E_min_ || E > mp->E_max_) continue;
+      std::tie(xs[0], xs[1], xs[2]) = mp->evaluate(E, particle_sqrtkT(buffer_idx));
+    }
   }
+}
+
+//! Launch the XS lookups of a contiguous range of an XS lookup queue, which
+//! move the particles to the advance queue. The kernel is launched
+//! asynchronously and must be waited on with a taskwait.
+void launch_calculate_xs_range(SharedArray<EventQueueItem>& queue, int first,
+  int last, int offset, bool need_depletion_rx)
+{
+  if (!simulation::wmp_batching) {
+    launch_calculate_xs_kernel(queue, first, last, offset, need_depletion_rx);
+    return;
+  }
+
+  // With batched multipole evaluation, the range is looked up in chunks that
+  // fit in simulation::wmp_batch_xs, each of which must finish before the
+  // next chunk's evaluations overwrite it
+  for (int c = first; c < last; c += settings::wmp_batch_items) {
+    int c_last = std::min(c + settings::wmp_batch_items, last);
+    evaluate_wmp_batch(queue, c, c_last);
+    launch_calculate_xs_kernel(queue, c, c_last, offset, need_depletion_rx);
+    #pragma omp taskwait
+  }
+}
+
+//! Launch the XS lookups of every particle in an XS lookup queue
+//
+//! \param queue The XS lookup queue
+//! \param offset Position in the advance queue of the queue's first particle
+//! \param need_depletion_rx Whether depletion reaction XS are needed
+void launch_calculate_xs_queue(SharedArray<EventQueueItem>& queue, int offset,
+  bool need_depletion_rx)
+{
+  int n_particles = queue.size();
+
+  if (settings::n_material_xs_queues == 0) {
+    launch_calculate_xs_range(queue, 0, n_particles, offset, need_depletion_rx);
+    return;
+  }
+
+  // Launch a separate kernel for each material with its own XS lookup class
+  // (and one for the remaining materials), so that every thread in a launch
+  // loops over the same nuclides and launches for materials with very
+  // different nuclide counts do not share occupancy
+  int n_classes = 1 + settings::n_material_xs_queues;
+  vector<int> class_offsets(n_classes + 1);
+  device_partition_by_class(queue, PartitionBy::xs_lookup_class, n_classes,
+    class_offsets.data());
+  for (int c = 0; c < n_classes; ++c) {
+    if (class_offsets[c] == class_offsets[c + 1]) continue;
+    launch_calculate_xs_range(queue, class_offsets[c], class_offsets[c + 1],
+      offset, need_depletion_rx);
+    // Class launches only overlap each other if requested
+    if (!settings::async_event_kernels) {
+      #pragma omp taskwait
+    }
+  }
+}
+
+//! Order an XS lookup queue prior to its lookups, either coarsely by the
+//! buckets that particles were counted into as they were enqueued, or exactly
+//! by sorting
+void order_xs_queue(EventType type)
+{
+  bool sort = type == EventType::calculate_xs_fuel ?
+    settings::sort_fissionable_xs_lookups :
+    settings::sort_non_fissionable_xs_lookups;
+  if (settings::bucket_xs_queues) {
+    bucket_xs_queue(type);
+  } else if (sort) {
+    sort_queue(event_queue(type), SortBy::material_energy);
+  }
+}
+
+void process_calculate_xs_events_nonfuel()
+{
+  // Order non fuel lookup queue by material and energy
+  order_xs_queue(EventType::calculate_xs_nonfuel);
 
   simulation::time_event_calculate_xs.start();
   simulation::time_event_calculate_xs_nonfuel.start();
 
   bool need_depletion_rx = depletion_rx_check();
 
-  int offset = simulation::advance_particle_queue.size();;
-
+  int offset = simulation::advance_particle_queue.size();
   int n_particles = simulation::calculate_nonfuel_xs_queue.size();
-  #pragma omp target teams distribute parallel for
-  for (int i = 0; i < n_particles; i++) {
-    int buffer_idx = simulation::calculate_nonfuel_xs_queue[i].idx;
-    Particle& p = simulation::device_particles[buffer_idx];
-    p.event_calculate_xs_execute(need_depletion_rx);
-    simulation::advance_particle_queue[offset + i] = simulation::calculate_nonfuel_xs_queue[i];
-  }
+  launch_calculate_xs_queue(simulation::calculate_nonfuel_xs_queue, offset,
+    need_depletion_rx);
+  #pragma omp taskwait
 
   // After executing a calculate_xs event, particles will
   // always require an advance event. Therefore, we don't need to use
   // the protected enqueuing function.
-  simulation::advance_particle_queue.resize(offset + simulation::calculate_nonfuel_xs_queue.size());
-  simulation::calculate_nonfuel_xs_queue.resize(0);
+  EventType processed = EventType::calculate_xs_nonfuel;
+  sync_queue_sizes(&processed, n_particles);
 
   simulation::time_event_calculate_xs.stop();
   simulation::time_event_calculate_xs_nonfuel.stop();
@@ -236,68 +1106,115 @@ void process_calculate_xs_events_nonfuel()
 
 void process_calculate_xs_events_fuel()
 {
-  // Sort fuel lookup queue by energy
-  if (settings::sort_fissionable_xs_lookups) {
-    sort_queue(simulation::calculate_fuel_xs_queue, SortBy::material_energy);
-  }
+  // Order fuel lookup queue by energy
+  order_xs_queue(EventType::calculate_xs_fuel);
 
   // The below line can be used to check if the queue has actually been sorted.
   // May be useful for debugging future on-device sorting strategies.
-  //assert(is_sorted(simulation::calculate_fuel_xs_queue));
+  //assert(is_sorted(simulation::calculate_fuel_xs_queue, SortBy::material_energy));
 
   simulation::time_event_calculate_xs.start();
   simulation::time_event_calculate_xs_fuel.start();
 
   bool need_depletion_rx = depletion_rx_check();
 
-  int offset = simulation::advance_particle_queue.size();;
-
+  int offset = simulation::advance_particle_queue.size();
   int n_particles = simulation::calculate_fuel_xs_queue.size();
-  #pragma omp target teams distribute parallel for
-  for (int i = 0; i < n_particles; i++) {
-    int buffer_idx = simulation::calculate_fuel_xs_queue[i].idx;
-    Particle& p = simulation::device_particles[buffer_idx];
-    p.event_calculate_xs_execute(need_depletion_rx);
-    simulation::advance_particle_queue[offset + i] = simulation::calculate_fuel_xs_queue[i];
-  }
+  launch_calculate_xs_queue(simulation::calculate_fuel_xs_queue, offset,
+    need_depletion_rx);
+  #pragma omp taskwait
 
   // After executing a calculate_xs event, particles will
   // always require an advance event. Therefore, we don't need to use
   // the protected enqueuing function.
-  simulation::advance_particle_queue.resize(offset + simulation::calculate_fuel_xs_queue.size());
-  simulation::calculate_fuel_xs_queue.resize(0);
+  EventType processed = EventType::calculate_xs_fuel;
+  sync_queue_sizes(&processed, n_particles);
 
   simulation::time_event_calculate_xs.stop();
   simulation::time_event_calculate_xs_fuel.stop();
 }
 
+void process_calculate_xs_events_concurrent()
+{
+  order_xs_queue(EventType::calculate_xs_fuel);
+  order_xs_queue(EventType::calculate_xs_nonfuel);
+
+  simulation::time_event_calculate_xs.start();
+  simulation::time_event_calculate_xs_fuel.start();
+  simulation::time_event_calculate_xs_nonfuel.start();
+
+  bool need_depletion_rx = depletion_rx_check();
+
+  // The two queues move their particles to disjoint ranges of the advance queue
+  int offset = simulation::advance_particle_queue.size();
+  int n_fuel = simulation::calculate_fuel_xs_queue.size();
+  int n_nonfuel = simulation::calculate_nonfuel_xs_queue.size();
+  launch_calculate_xs_queue(simulation::calculate_fuel_xs_queue, offset,
+    need_depletion_rx);
+  launch_calculate_xs_queue(simulation::calculate_nonfuel_xs_queue,
+    offset + n_fuel, need_depletion_rx);
+  #pragma omp taskwait
+
+  EventType processed[] {EventType::calculate_xs_fuel,
+    EventType::calculate_xs_nonfuel};
+  sync_queue_sizes(processed, n_fuel + n_nonfuel, 2);
+
+  simulation::time_event_calculate_xs.stop();
+  simulation::time_event_calculate_xs_fuel.stop();
+  simulation::time_event_calculate_xs_nonfuel.stop();
+}
+
+#pragma omp declare target
+//! Advance a particle of the advance queue and queue it for what it reaches
+void advance_event(int i, bool fused, bool need_depletion_rx, bool aggregate)
+{
+  int buffer_idx = simulation::advance_particle_queue[i].idx;
+  Particle& p = simulation::device_particles[buffer_idx];
+  p.event_advance();
+  if (fused) p.event_tracklength_tally(need_depletion_rx);
+  EventType type = p.collision_distance_ > p.boundary_.distance ?
+    EventType::surface_crossing : EventType::collision;
+  dispatch_particle(i, buffer_idx, static_cast<int>(type), aggregate);
+}
+#pragma omp end declare target
+
 void process_advance_particle_events()
 {
+  bool tally = !model::active_tracklength_tallies.empty();
+  bool need_depletion_rx = depletion_rx_check();
+
+  // When fused, tracklength tallies are scored while the particle is still
+  // resident from the advance rather than in a second pass over the queue.
+  // The fused kernel is larger (more register pressure), so this is optional.
+  bool fused = tally && settings::fuse_advance_tally;
+  bool aggregate = settings::aggregate_queue_appends;
+
+  // Order particles along a space-filling curve so that neighbouring threads
+  // track through the same cells, surfaces and lattice tiles
+  if (settings::sort_advance_position) {
+    sort_queue(simulation::advance_particle_queue, SortBy::position);
+  }
+
   simulation::time_event_advance_particle.start();
 
   int n_particles = simulation::advance_particle_queue.size();
-  #pragma omp target teams distribute parallel for
-  for (int i = 0; i < n_particles; i++) {
-    int buffer_idx = simulation::advance_particle_queue[i].idx;
-    Particle& p = simulation::device_particles[buffer_idx];
-    p.event_advance();
-    int cell_id = p.coord_[p.n_coord_ - 1].cell;
-    int surface_id = p.boundary_.surface_index;
-    if (p.collision_distance_ > p.boundary_.distance) {
-      simulation::surface_crossing_queue.thread_safe_append({p.E_, buffer_idx, cell_id, surface_id});
-    } else {
-      simulation::collision_queue.thread_safe_append({p.E_, buffer_idx, cell_id, surface_id});
+  if (settings::cpu_event_kernels) {
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n_particles; i++) {
+      advance_event(i, fused, need_depletion_rx, aggregate);
+    }
+  } else {
+    #pragma omp target teams distribute parallel for
+    for (int i = 0; i < n_particles; i++) {
+      advance_event(i, fused, need_depletion_rx, aggregate);
     }
   }
-  simulation::surface_crossing_queue.sync_size_device_to_host();
-  simulation::collision_queue.sync_size_device_to_host();
-  
+  if (aggregate) enqueue_aggregated(n_particles);
   simulation::time_event_advance_particle.stop();
   simulation::time_event_tally.start();
   
   // Perform tracklength tallying on device if active tallies are present
-  if (!model::active_tracklength_tallies.empty()) {
-    bool need_depletion_rx = depletion_rx_check();
+  if (tally && !fused) {
     #pragma omp target teams distribute parallel for
     for (int i = 0; i < n_particles; i++) {
       int buffer_idx = simulation::advance_particle_queue[i].idx;
@@ -306,40 +1223,166 @@ void process_advance_particle_events()
     }
   }
 
-  simulation::advance_particle_queue.resize(0);
+  if (tally) reduce_tally_scores_if_needed();
+
+  EventType processed = EventType::advance;
+  sync_queue_sizes(&processed);
   simulation::time_event_tally.stop();
 }
 
-void process_surface_crossing_events()
+#pragma omp declare target
+//! Move a particle of the surface crossing queue across its surface and
+//! queue it for its next event
+void surface_crossing_event(int i, int scratch_offset, bool decomposed,
+  bool aggregate)
 {
-  // Sort fuel lookup queue by energy
-  if (settings::sort_surface_crossing) {
-    sort_queue(simulation::surface_crossing_queue, SortBy::cell_surface);
-  }
+  int buffer_idx = simulation::surface_crossing_queue[i].idx;
+  Particle& p = simulation::device_particles[buffer_idx];
+  p.event_cross_surface();
+  // A particle that crossed into the domain of another process is revived
+  // from its secondaries or a new source particle here
+  if (decomposed && p.alive()) send_to_domain(p);
+  EventType type = p.alive() ?
+    dispatch_xs_destination(buffer_idx) : EventType::revival;
+  dispatch_particle(scratch_offset + i, buffer_idx, static_cast<int>(type),
+    aggregate);
+}
 
-  simulation::time_event_surface_crossing.start();
+//! Collide a particle of the collision queue and queue it for its next event
+void collision_event(int i, int scratch_offset, bool aggregate)
+{
+  int buffer_idx = simulation::collision_queue[i].idx;
+  Particle& p = simulation::device_particles[buffer_idx];
+  p.event_collide();
+  EventType type = p.alive() ?
+    dispatch_xs_destination(buffer_idx) : EventType::revival;
+  dispatch_particle(scratch_offset + i, buffer_idx, static_cast<int>(type),
+    aggregate);
+}
+#pragma omp end declare target
 
+//! Launch the surface crossing kernel asynchronously
+//
+//! \param scratch_offset Position in dispatch_scratch at which to record the
+//!   destinations of the queue's particles when appends are aggregated
+void launch_surface_crossing_events(int scratch_offset)
+{
+  bool aggregate = settings::aggregate_queue_appends;
+  bool decomposed = domain_decomposed();
   int n_particles = simulation::surface_crossing_queue.size();
+  if (settings::cpu_event_kernels) {
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n_particles; i++) {
+      surface_crossing_event(i, scratch_offset, decomposed, aggregate);
+    }
+  } else {
+    #pragma omp target teams distribute parallel for nowait
+    for (int i = 0; i < n_particles; i++) {
+      surface_crossing_event(i, scratch_offset, decomposed, aggregate);
+    }
+  }
+}
+
+//! Launch the kernel finishing the collisions of a contiguous range of the
+//! collision queue, whose reactions have been sampled, asynchronously
+void launch_collision_finish_kernel(int first, int last, int scratch_offset)
+{
+  bool aggregate = settings::aggregate_queue_appends;
+  #pragma omp target teams distribute parallel for nowait
+  for (int i = first; i < last; i++) {
+    int buffer_idx = simulation::collision_queue[i].idx;
+    Particle& p = simulation::device_particles[buffer_idx];
+    p.event_collide_finish();
+    EventType type = p.alive() ?
+      dispatch_xs_destination(buffer_idx) : EventType::revival;
+    dispatch_particle(scratch_offset + i, buffer_idx, static_cast<int>(type),
+      aggregate);
+  }
+}
+
+//! Sample the reactions of the collision queue and launch a separate kernel
+//! finishing the collisions of each class of reaction (see
+//! settings::split_collisions), so that every thread in a launch goes
+//! through the same scattering physics. Only the finishing kernels are
+//! launched asynchronously.
+void launch_split_collision_events(int scratch_offset)
+{
+  int n_particles = simulation::collision_queue.size();
   #pragma omp target teams distribute parallel for
   for (int i = 0; i < n_particles; i++) {
-    int buffer_idx = simulation::surface_crossing_queue[i].idx;
-    Particle& p = simulation::device_particles[buffer_idx];
-    p.event_cross_surface();
-    if (p.alive())
-      dispatch_xs_event(buffer_idx);
-    else
-    {
-      int cell_id = p.coord_[p.n_coord_ - 1].cell;
-      int surface_id = p.boundary_.surface_index;
-      simulation::revival_queue.thread_safe_append({p.E_, buffer_idx, cell_id, surface_id});
+    int buffer_idx = simulation::collision_queue[i].idx;
+    simulation::device_particles[buffer_idx].event_collide_sample();
+  }
+
+  int n_classes = Particle::N_COLLISION_CLASSES;
+  vector<int> class_offsets(n_classes + 1);
+  device_partition_by_class(simulation::collision_queue,
+    PartitionBy::collision_class, n_classes, class_offsets.data());
+  for (int c = 0; c < n_classes; ++c) {
+    if (class_offsets[c] == class_offsets[c + 1]) continue;
+    launch_collision_finish_kernel(class_offsets[c], class_offsets[c + 1],
+      scratch_offset);
+    // Class launches only overlap each other if requested
+    if (!settings::async_event_kernels) {
+      #pragma omp taskwait
+    }
+  }
+}
+
+//! Launch the collision kernel asynchronously
+//
+//! \param scratch_offset Position in dispatch_scratch at which to record the
+//!   destinations of the queue's particles when appends are aggregated
+void launch_collision_events(int scratch_offset)
+{
+  if (settings::split_collisions) {
+    launch_split_collision_events(scratch_offset);
+    return;
+  }
+
+  bool aggregate = settings::aggregate_queue_appends;
+  int n_particles = simulation::collision_queue.size();
+  if (settings::cpu_event_kernels) {
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n_particles; i++) {
+      collision_event(i, scratch_offset, aggregate);
+    }
+  } else {
+    #pragma omp target teams distribute parallel for nowait
+    for (int i = 0; i < n_particles; i++) {
+      collision_event(i, scratch_offset, aggregate);
     }
   }
+}
 
-  simulation::calculate_fuel_xs_queue.sync_size_device_to_host();
-  simulation::calculate_nonfuel_xs_queue.sync_size_device_to_host();
-  simulation::advance_particle_queue.sync_size_device_to_host();
-  simulation::revival_queue.sync_size_device_to_host();
-  simulation::surface_crossing_queue.resize(0);
+//! Ordering of the surface crossing queue, which is by cell and surface
+//! unless particles are to be ordered by position
+SortBy surface_crossing_sort()
+{
+  return settings::sort_surface_position ? SortBy::position :
+    SortBy::cell_surface;
+}
+
+void process_surface_crossing_events()
+{
+  // Sort surface crossing queue by cell and surface, or by position
+  if (settings::sort_surface_crossing) {
+    sort_queue(simulation::surface_crossing_queue, surface_crossing_sort());
+  }
+
+  simulation::time_event_surface_crossing.start();
+
+  launch_surface_crossing_events(0);
+  #pragma omp taskwait
+  if (settings::aggregate_queue_appends)
+    enqueue_aggregated(simulation::surface_crossing_queue.size());
+  if (!model::active_surface_tallies.empty() ||
+      !model::active_meshsurf_tallies.empty()) {
+    reduce_tally_scores_if_needed();
+  }
+
+  EventType processed = EventType::surface_crossing;
+  sync_queue_sizes(&processed);
 
   simulation::time_event_surface_crossing.stop();
 }
@@ -348,35 +1391,56 @@ void process_collision_events()
 {
   simulation::time_event_collision.start();
 
-  int n_particles = simulation::collision_queue.size();
-  #pragma omp target teams distribute parallel for
-  for (int i = 0; i < n_particles; i++) {
-    int buffer_idx = simulation::collision_queue[i].idx;
-    Particle& p = simulation::device_particles[buffer_idx];
-    p.event_collide();
-    if (p.alive())
-      dispatch_xs_event(buffer_idx);
-    else
-    {
-      int cell_id = p.coord_[p.n_coord_ - 1].cell;
-      int surface_id = p.boundary_.surface_index;
-      simulation::revival_queue.thread_safe_append({p.E_, buffer_idx, cell_id, surface_id});
-    }
+  launch_collision_events(0);
+  #pragma omp taskwait
+  if (settings::aggregate_queue_appends)
+    enqueue_aggregated(simulation::collision_queue.size());
+  if (!model::active_collision_tallies.empty() ||
+      !model::active_analog_tallies.empty()) {
+    reduce_tally_scores_if_needed();
   }
 
-  simulation::calculate_fuel_xs_queue.sync_size_device_to_host();
-  simulation::calculate_nonfuel_xs_queue.sync_size_device_to_host();
-  simulation::advance_particle_queue.sync_size_device_to_host();
-  simulation::revival_queue.sync_size_device_to_host();
-  simulation::collision_queue.resize(0);
+  EventType processed = EventType::collision;
+  sync_queue_sizes(&processed);
 
   simulation::time_event_collision.stop();
 }
 
+void process_surface_crossing_and_collision_events()
+{
+  if (settings::sort_surface_crossing) {
+    sort_queue(simulation::surface_crossing_queue, surface_crossing_sort());
+  }
+
+  simulation::time_event_surface_crossing.start();
+  simulation::time_event_collision.start();
+
+  // Collisions record their destinations after those of the surface crossings
+  // so that a single aggregated append handles both queues
+  int n_surface = simulation::surface_crossing_queue.size();
+  int n_collision = simulation::collision_queue.size();
+  launch_surface_crossing_events(0);
+  launch_collision_events(n_surface);
+  #pragma omp taskwait
+  if (settings::aggregate_queue_appends)
+    enqueue_aggregated(n_surface + n_collision);
+  if (model::active_tallies.size() > model::active_tracklength_tallies.size()) {
+    reduce_tally_scores_if_needed();
+  }
+
+  EventType processed[] {EventType::surface_crossing, EventType::collision};
+  sync_queue_sizes(processed, 0, 2);
+
+  simulation::time_event_surface_crossing.stop();
+  simulation::time_event_collision.stop();
+}
 
 void process_death_events(int n_particles)
 {
   simulation::time_event_death.start();
+  ProfileRegion profile {PROFILE_DEATH, n_particles};
+  ProfileRange range {PROFILE_DEATH};
+  record_kernel_launch();
 
   // Local keff tally accumulators
   // (workaround for compilers that don't like reductions w/global variables)
@@ -397,8 +1461,13 @@ void process_death_events(int n_particles)
   global_tally_tracklength += tracklength;
   global_tally_leakage     += leakage;
 
-  // Move particle progeny count array back to host
-  #pragma omp target update from(simulation::device_progeny_per_particle[:simulation::progeny_per_particle.size()])
+  // Move particle progeny count array back to host, unless the fission bank
+  // is sorted on device. The counts of particles transported on host are
+  // already there.
+  if (!settings::device_fission_bank) {
+    int64_t n_device = simulation::work_per_rank - simulation::host_work;
+    #pragma omp target update from(simulation::device_progeny_per_particle[:n_device])
+  }
 
   simulation::time_event_death.stop();
 
@@ -410,6 +1479,7 @@ void process_revival_events()
 
   // Accumulator for particle weights from any sourced particles
   double extra_weight = 0;
+  bool aggregate = settings::aggregate_queue_appends;
 
   int n_particles = simulation::revival_queue.size();
   #pragma omp target teams distribute parallel for reduction(+:extra_weight)
@@ -431,24 +1501,34 @@ void process_revival_events()
       #pragma omp atomic capture //seq_cst
       source_offset_idx = simulation::current_source_offset++;
 
-      // Check that we are not going to run more particles than the user specified
-      if (source_offset_idx < simulation::work_per_rank) {
+      // Check that we are not going to run more particles than the user
+      // specified, or start a site that has yet to arrive
+      if (source_offset_idx < simulation::n_sources_ready) {
         // If a valid particle is sourced, initialize it and accumulate its weight
-        initialize_history(p, source_offset_idx + 1);
+        int index_source = settings::async_bank_exchange ?
+          simulation::device_source_order[source_offset_idx] : source_offset_idx;
+        initialize_history(p, index_source + 1);
         extra_weight += p.wgt_;
       }
     }
     // If particle has either been revived or a new particle has been sourced,
     // then dispatch particle to appropriate queue. Otherwise, if particle is
     // dead, then it will not be queued anywhere.
-    if (p.alive())
-      dispatch_xs_event(buffer_idx);
+    int queue = p.alive() ? static_cast<int>(dispatch_xs_destination(buffer_idx)) : -1;
+    dispatch_particle(i, buffer_idx, queue, aggregate);
   }
+  if (aggregate) enqueue_aggregated(n_particles);
+
+  EventType processed = EventType::revival;
+  sync_queue_sizes(&processed);
 
-  simulation::revival_queue.resize(0);
-  simulation::calculate_fuel_xs_queue.sync_size_device_to_host();
-  simulation::calculate_nonfuel_xs_queue.sync_size_device_to_host();
-  simulation::advance_particle_queue.sync_size_device_to_host();
+  // Offsets taken by particles that found no site ready are given back so that
+  // the sites are started once they arrive, or after a mid-batch checkpoint
+  if ((settings::async_bank_exchange || settings::checkpoint_particles > 0) &&
+      simulation::current_source_offset > simulation::n_sources_ready) {
+    simulation::current_source_offset = simulation::n_sources_ready;
+    #pragma omp target update to(simulation::current_source_offset)
+  }
 
   // Add any newly sourced particle weights to global variable
   simulation::total_weight += extra_weight;
@@ -456,4 +1536,470 @@ void process_revival_events()
   simulation::time_event_revival.stop();
 }
 
+//! Complete the pending event of an in-flight particle and then transport it
+//! (and any of its secondaries) history-based until it dies
+//
+//! \param p The particle
+//! \param type The event the particle is currently queued for
+//! \param tally Whether tracklength tallies are active
+//! \param need_depletion_rx Whether depletion reaction rates are needed
+#pragma omp declare target
+void finish_history(Particle& p, EventType type, bool tally,
+  bool need_depletion_rx)
+{
+  // Complete whatever event the particle was waiting on. Each case falls
+  // through to the events that would have followed it in the event loop.
+  switch (type) {
+  case EventType::calculate_xs_fuel:
+  case EventType::calculate_xs_nonfuel:
+    p.event_calculate_xs_execute(need_depletion_rx);
+    // fall through
+  case EventType::advance:
+    p.event_advance();
+    if (tally) p.event_tracklength_tally(need_depletion_rx);
+    if (p.collision_distance_ > p.boundary_.distance) {
+      p.event_cross_surface();
+    } else {
+      p.event_collide();
+    }
+    break;
+  case EventType::surface_crossing:
+    p.event_cross_surface();
+    break;
+  case EventType::collision:
+    p.event_collide();
+    break;
+  case EventType::revival:
+    break;
+  }
+  p.event_revive_from_secondary();
+
+  // Continue with the same loop as transport_history_based_single_particle()
+  while (p.alive()) {
+    p.event_calculate_xs(need_depletion_rx);
+    p.event_advance();
+    if (tally) p.event_tracklength_tally(need_depletion_rx);
+    if (p.collision_distance_ > p.boundary_.distance) {
+      p.event_cross_surface();
+    } else {
+      p.event_collide();
+    }
+    p.event_revive_from_secondary();
+  }
+
+  // Keff tallies are accumulated for all buffer slots by process_death_events()
+  p.event_death();
+}
+#pragma omp end declare target
+
+void process_tail_queue(SharedArray<EventQueueItem>& queue, EventType type,
+  bool tally, bool need_depletion_rx)
+{
+  int n_particles = queue.size();
+  if (n_particles == 0) return;
+
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n_particles; i++) {
+    int buffer_idx = queue[i].idx;
+    Particle& p = simulation::device_particles[buffer_idx];
+    finish_history(p, type, tally, need_depletion_rx);
+  }
+  queue.resize(0);
+}
+
+void process_tail_events()
+{
+  simulation::time_event_tail.start();
+  int64_t n_tail = 0;
+  for (int i = 0; i < N_EVENT_TYPES; ++i) {
+    n_tail += event_queue_size(static_cast<EventType>(i));
+  }
+  ProfileRegion profile {PROFILE_TAIL, n_tail};
+  ProfileRange range {PROFILE_TAIL};
+  record_kernel_launch();
+
+  bool tally = !model::active_tracklength_tallies.empty();
+  bool need_depletion_rx = depletion_rx_check();
+
+  process_tail_queue(simulation::calculate_fuel_xs_queue,
+    EventType::calculate_xs_fuel, tally, need_depletion_rx);
+  process_tail_queue(simulation::calculate_nonfuel_xs_queue,
+    EventType::calculate_xs_nonfuel, tally, need_depletion_rx);
+  process_tail_queue(simulation::advance_particle_queue,
+    EventType::advance, tally, need_depletion_rx);
+  process_tail_queue(simulation::surface_crossing_queue,
+    EventType::surface_crossing, tally, need_depletion_rx);
+  process_tail_queue(simulation::collision_queue,
+    EventType::collision, tally, need_depletion_rx);
+  process_tail_queue(simulation::revival_queue,
+    EventType::revival, tally, need_depletion_rx);
+  if (settings::bucket_xs_queues) reset_xs_bucket_counts();
+
+  simulation::time_event_tail.stop();
+}
+
+bool should_finish_tail()
+{
+  // Histories finished in the tail kernel would not be handed over to the
+  // domains they cross into
+  if (settings::event_tail_threshold == 0 || domain_decomposed()) return false;
+
+  // Only switch once every source particle has been started, as the revival
+  // event is the only place new histories are sourced
+  if (simulation::current_source_offset <
+      simulation::work_per_rank - simulation::host_work)
+    return false;
+
+  int64_t n_live = 0;
+  for (int i = 0; i < N_EVENT_TYPES; ++i) {
+    n_live += event_queue_size(static_cast<EventType>(i));
+  }
+  if (n_live == 0) return false;
+
+  double threshold = settings::event_tail_threshold;
+  if (settings::event_tail_threshold == -1) {
+    // Switch once every queue would launch a latency-bound kernel, i.e., once
+    // there are fewer live particles than it takes for any event kernel to
+    // spend as much time on particles as on its fixed launch overhead
+    threshold = 0.0;
+    for (int i = 0; i < N_EVENT_TYPES; ++i) {
+      threshold = std::max(threshold, simulation::event_cost_model.
+        latency_bound_size(static_cast<EventType>(i)));
+    }
+  }
+  return n_live < threshold;
+}
+
+bool should_compact_particles()
+{
+  if (settings::compact_threshold == 0.0) return false;
+
+  int64_t n_live = 0;
+  for (int i = 0; i < N_EVENT_TYPES; ++i) {
+    n_live += event_queue_size(static_cast<EventType>(i));
+  }
+  return n_live > 0 && n_live < simulation::particle_extent &&
+    n_live <= settings::compact_threshold * simulation::particle_extent;
+}
+
+void compact_particle_buffer()
+{
+  simulation::time_event_compact.start();
+  ProfileRange range {"compact_particle_buffer"};
+
+  int n_slots = simulation::particle_extent;
+  int n_live = 0;
+  for (int i = 0; i < N_EVENT_TYPES; ++i) {
+    n_live += event_queue_size(static_cast<EventType>(i));
+  }
+
+  auto& s = compact_scratch;
+  s.reserve(n_slots, n_live);
+  Particle* parked = s.parked.data();
+  int* new_slot = s.new_slot;
+  int* rank = s.rank;
+  int* vacated = s.vacated;
+
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n_slots; ++i) {
+    new_slot[i] = -1;
+  }
+
+  // Park the queued particles in the order of the queues, one after another,
+  // and point the queue items at the slots the particles are moved to
+  int offset = 0;
+  for (int t = 0; t < N_EVENT_TYPES; ++t) {
+    auto& queue = event_queue(static_cast<EventType>(t));
+    EventQueueItem* items = queue.data();
+    int n = queue.size();
+    #pragma omp target teams distribute parallel for
+    for (int i = 0; i < n; ++i) {
+      int j = offset + i;
+      new_slot[items[i].idx] = j;
+      parked[j] = simulation::device_particles[items[i].idx];
+      items[i].idx = j;
+    }
+    offset += n;
+  }
+
+  // Rank the finished particles within the prefix and the queued particles
+  // beyond it. There are as many of one as of the other, and the finished
+  // particle of each rank is moved into the slot of the queued one.
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n_slots; ++i) {
+    rank[i] = (i < n_live) == (new_slot[i] < 0);
+  }
+  device_exclusive_scan(rank, n_live, s.chunk_sums);
+  device_exclusive_scan(rank + n_live, n_slots - n_live, s.chunk_sums);
+
+  #pragma omp target teams distribute parallel for
+  for (int i = n_live; i < n_slots; ++i) {
+    if (new_slot[i] >= 0) vacated[rank[i]] = i;
+  }
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n_live; ++i) {
+    if (new_slot[i] < 0) {
+      simulation::device_particles[vacated[rank[i]]] =
+        simulation::device_particles[i];
+    }
+  }
+
+  // Unpark the queued particles into the prefix
+  bool soa = settings::particle_soa;
+  #pragma omp target teams distribute parallel for
+  for (int j = 0; j < n_live; ++j) {
+    simulation::device_particles[j] = parked[j];
+    if (soa) publish_particle_soa(j);
+  }
+
+  simulation::particle_extent = n_live;
+  simulation::compact_counter++;
+  simulation::time_event_compact.stop();
+}
+
+int64_t event_queue_size(EventType type)
+{
+  switch (type) {
+  case EventType::calculate_xs_fuel:
+    return simulation::calculate_fuel_xs_queue.size();
+  case EventType::calculate_xs_nonfuel:
+    return simulation::calculate_nonfuel_xs_queue.size();
+  case EventType::advance:
+    return simulation::advance_particle_queue.size();
+  case EventType::surface_crossing:
+    return simulation::surface_crossing_queue.size();
+  case EventType::collision:
+    return simulation::collision_queue.size();
+  case EventType::revival:
+    return simulation::revival_queue.size();
+  }
+  return 0;
+}
+
+double event_time_elapsed(EventType type)
+{
+  // Queue sorting is accumulated in a single timer, so it is charged to
+  // whichever event is being measured (only the sorted events use it)
+  double sort = simulation::time_event_sort.elapsed();
+  switch (type) {
+  case EventType::calculate_xs_fuel:
+    return simulation::time_event_calculate_xs_fuel.elapsed() + sort;
+  case EventType::calculate_xs_nonfuel:
+    return simulation::time_event_calculate_xs_nonfuel.elapsed() + sort;
+  case EventType::advance:
+    return simulation::time_event_advance_particle.elapsed() +
+      simulation::time_event_tally.elapsed();
+  case EventType::surface_crossing:
+    return simulation::time_event_surface_crossing.elapsed() + sort;
+  case EventType::collision:
+    return simulation::time_event_collision.elapsed();
+  case EventType::revival:
+    return simulation::time_event_revival.elapsed();
+  }
+  return 0.0;
+}
+
+bool select_next_event(int64_t iteration, EventType& type)
+{
+  int64_t n_revival = simulation::revival_queue.size();
+
+  // Determine which event kernel has the longest queue
+  int64_t max = std::max({
+    simulation::calculate_fuel_xs_queue.size(),
+    simulation::calculate_nonfuel_xs_queue.size(),
+    simulation::advance_particle_queue.size(),
+    simulation::surface_crossing_queue.size(),
+    simulation::revival_queue.size(),
+    simulation::collision_queue.size()});
+
+  if (max == 0) return false;
+
+  // The max revival period forces particles to be revived (if there are any
+  // in the revival queue) every nth iteration rather than waiting for this
+  // queue to be selected by the scheduling policy. While the kernel itself is
+  // not very efficient if executing with only a few particles, it is
+  // important to revive particles promptly so as to reduce the length of the
+  // tail of particle deaths at the end of each power iteration. Basically, to
+  // reduce the overall number of events run, we want to make sure we start
+  // all particles at the lowest event # possible. The pathological case is if
+  // we have a single particle waiting to be revived, and that event would not
+  // normally be selected until all (or nearly all) other particles have died
+  // off. In this case, we would essentially need to launch tens or hundreds
+  // of events just to process that last particle in serial. Introduction of a
+  // maximum period for the revival event ensures that such a particle is
+  // revived while there are still many particles in-flight.
+  //
+  // In practice, this optimization has a few percent improvement in
+  // performance. Improvements are largest when # particles per iteration <=
+  // max # particles in flight.
+  if (n_revival > 0 && iteration % settings::max_revival_period == 0) {
+    type = EventType::revival;
+    return true;
+  }
+
+  if (settings::event_scheduler == EventScheduler::cost_model) {
+    const auto& model = simulation::event_cost_model;
+
+    // Any event that has not yet been observed enough to calibrate its cost
+    // is selected as soon as it has particles queued so that the model
+    // quickly learns about every kernel
+    double best = -1.0;
+    for (int i = 0; i < N_EVENT_TYPES; ++i) {
+      auto t = static_cast<EventType>(i);
+      int64_t n = event_queue_size(t);
+      if (n == 0) continue;
+      double score = model.is_calibrated(t) ? model.throughput(t, n) : INFINITY;
+      if (score > best) {
+        best = score;
+        type = t;
+      }
+    }
+    return true;
+  }
+
+  // Determine which event kernel has the longest queue (not including the
+  // fuel XS lookup queue)
+  int64_t max_other_than_fuel_xs = std::max({
+    simulation::calculate_nonfuel_xs_queue.size(),
+    simulation::advance_particle_queue.size(),
+    simulation::surface_crossing_queue.size(),
+    simulation::revival_queue.size(),
+    simulation::collision_queue.size()});
+
+  // The fuel lookup bias increases the number of particles required before
+  // selecting this event to execute. E.g., if we had 100 particles in flight,
+  // and fuel xs queue had 45 particles and the next fullest queue had 30
+  // particles, we would usually select the fuel lookup event to execute. With
+  // a bias factor of 2, in this example, since the next fullest queue has 30
+  // particles, we would not select the fuel lookup event unless it had
+  // 30 * 2 = 60 particles present.
+  //
+  // In practice, this has a several percent improvement in performance, as
+  // the fuel lookup event runs more efficiently with more particles in
+  // comparison to other events (due to the energy sort for the fuel lookup
+  // event which is not used for other events).
+  if (static_cast<double>(max) < settings::fuel_lookup_bias *
+      static_cast<double>(max_other_than_fuel_xs))
+    max = max_other_than_fuel_xs;
+
+  // Execute event with the longest queue
+  if (max == simulation::revival_queue.size()) {
+    type = EventType::revival;
+  } else if (max == simulation::calculate_fuel_xs_queue.size()) {
+    type = EventType::calculate_xs_fuel;
+  } else if (max == simulation::calculate_nonfuel_xs_queue.size()) {
+    type = EventType::calculate_xs_nonfuel;
+  } else if (max == simulation::advance_particle_queue.size()) {
+    type = EventType::advance;
+  } else if (max == simulation::surface_crossing_queue.size()) {
+    type = EventType::surface_crossing;
+  } else {
+    type = EventType::collision;
+  }
+  return true;
+}
+
+void process_event(EventType type)
+{
+  // Independent events are run together with their counterpart when kernels
+  // may overlap and both queues have particles waiting
+  EventType partner = type;
+  if (settings::async_event_kernels) {
+    switch (type) {
+    case EventType::calculate_xs_fuel:
+      partner = EventType::calculate_xs_nonfuel;
+      break;
+    case EventType::calculate_xs_nonfuel:
+      partner = EventType::calculate_xs_fuel;
+      break;
+    case EventType::surface_crossing:
+      partner = EventType::collision;
+      break;
+    case EventType::collision:
+      partner = EventType::surface_crossing;
+      break;
+    default:
+      break;
+    }
+    if (event_queue_size(partner) == 0) partner = type;
+  }
+
+  bool trace = tracing_events();
+
+  if (partner != type) {
+    int64_t n_items = event_queue_size(type);
+    int64_t n_partner = event_queue_size(partner);
+    record_event_launch(type, n_items);
+    record_event_launch(partner, n_partner);
+    int64_t launch = trace ? trace_event_launch(type) : 0;
+    int64_t launch_partner = trace ? trace_event_launch(partner) : 0;
+    count_region_events(type);
+    count_region_events(partner);
+    double t_start = event_time_elapsed(type);
+    double t_start_partner = event_time_elapsed(partner);
+
+    // The device work of both kernels is charged to the selected event
+    count_profile_launch(static_cast<int>(partner), n_partner);
+    {
+      ProfileRegion profile {static_cast<int>(type), n_items};
+      ProfileRange range {static_cast<int>(type)};
+      if (type == EventType::calculate_xs_fuel ||
+          type == EventType::calculate_xs_nonfuel) {
+        process_calculate_xs_events_concurrent();
+      } else {
+        process_surface_crossing_and_collision_events();
+      }
+    }
+
+    // The overlapped time is attributed in full to both events
+    double elapsed = event_time_elapsed(type) - t_start;
+    double elapsed_partner = event_time_elapsed(partner) - t_start_partner;
+    simulation::event_cost_model.record(type, n_items, elapsed);
+    simulation::event_cost_model.record(partner, n_partner, elapsed_partner);
+    record_region_event_time(type, elapsed);
+    record_region_event_time(partner, elapsed_partner);
+    if (trace) {
+      trace_event_time(launch, elapsed);
+      trace_event_time(launch_partner, elapsed_partner);
+    }
+    return;
+  }
+
+  int64_t n_items = event_queue_size(type);
+  record_event_launch(type, n_items);
+  int64_t launch = trace ? trace_event_launch(type) : 0;
+  count_region_events(type);
+  double t_start = event_time_elapsed(type);
+
+  {
+    ProfileRegion profile {static_cast<int>(type), n_items};
+    ProfileRange range {static_cast<int>(type)};
+    switch (type) {
+    case EventType::calculate_xs_fuel:
+      process_calculate_xs_events_fuel();
+      break;
+    case EventType::calculate_xs_nonfuel:
+      process_calculate_xs_events_nonfuel();
+      break;
+    case EventType::advance:
+      process_advance_particle_events();
+      break;
+    case EventType::surface_crossing:
+      process_surface_crossing_events();
+      break;
+    case EventType::collision:
+      process_collision_events();
+      break;
+    case EventType::revival:
+      process_revival_events();
+      break;
+    }
+  }
+
+  double elapsed = event_time_elapsed(type) - t_start;
+  simulation::event_cost_model.record(type, n_items, elapsed);
+  record_region_event_time(type, elapsed);
+  if (trace) trace_event_time(launch, elapsed);
+}
+
 } // namespace openmc
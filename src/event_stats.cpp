@@ -0,0 +1,200 @@
+#include "openmc/event_stats.h"
+
+#include <algorithm> // for copy
+#include <fstream>
+#include <string>
+
+#include <fmt/core.h>
+
+#include "openmc/error.h"
+#include "openmc/message_passing.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+#include "openmc/timer.h"
+
+namespace openmc {
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+BatchEventStats batch_event_stats;
+std::vector<BatchEventStats> event_stats_history;
+
+} // namespace simulation
+
+namespace {
+
+// Transport time already elapsed when the batch began
+double transport_start {0.0};
+
+// Names of the event types in JSON output and the per-batch summary
+const char* event_names[N_EVENT_TYPES] {"calculate_xs_fuel",
+  "calculate_xs_nonfuel", "advance", "surface_crossing", "collision",
+  "revival"};
+const char* event_labels[N_EVENT_TYPES] {"xs fuel", "xs non-fuel", "advance",
+  "crossing", "collision", "revival"};
+
+} // namespace
+
+//==============================================================================
+// BatchEventStats implementation
+//==============================================================================
+
+int64_t BatchEventStats::total_events() const
+{
+  int64_t n = 0;
+  for (int i = 0; i < N_EVENT_TYPES; ++i) n += events[i];
+  return n;
+}
+
+double BatchEventStats::mean_occupancy() const
+{
+  return occupancy_samples > 0 ? occupancy_sum / occupancy_samples : 0.0;
+}
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+bool reporting_event_stats()
+{
+  return settings::event_based && (settings::event_stats ||
+    !settings::path_event_stats.empty() || !settings::path_status.empty());
+}
+
+void record_event_launch(EventType type, int64_t n_items)
+{
+  auto& stats = simulation::batch_event_stats;
+  int i = static_cast<int>(type);
+  stats.events[i] += n_items;
+  ++stats.launches[i];
+  ++stats.kernel_launches;
+
+  if (simulation::particles.empty()) return;
+  int64_t n_live = 0;
+  for (int j = 0; j < N_EVENT_TYPES; ++j) {
+    n_live += event_queue_size(static_cast<EventType>(j));
+  }
+  stats.occupancy_sum += static_cast<double>(n_live) /
+    simulation::particles.size();
+  ++stats.occupancy_samples;
+}
+
+void record_kernel_launch()
+{
+  ++simulation::batch_event_stats.kernel_launches;
+}
+
+void record_sort(int64_t n_items, bool skipped)
+{
+  auto& stats = simulation::batch_event_stats;
+  if (skipped) {
+    ++stats.sorts_skipped;
+  } else {
+    ++stats.sorts;
+    stats.sorted_items += n_items;
+  }
+}
+
+void begin_batch_event_stats()
+{
+  simulation::batch_event_stats = {};
+  transport_start = simulation::time_transport_local.elapsed();
+}
+
+void end_batch_event_stats()
+{
+  if (!reporting_event_stats()) return;
+
+  auto stats = simulation::batch_event_stats;
+  stats.batch = simulation::current_batch;
+  stats.transport_seconds = simulation::time_transport_local.elapsed() -
+    transport_start;
+
+#ifdef OPENMC_MPI
+  // Counts are summed over processes and the time is that of the slowest
+  std::vector<int64_t> counts(stats.events, stats.events + N_EVENT_TYPES);
+  counts.insert(counts.end(), stats.launches, stats.launches + N_EVENT_TYPES);
+  counts.insert(counts.end(), {stats.kernel_launches, stats.sorts,
+    stats.sorted_items, stats.sorts_skipped, stats.occupancy_samples});
+  int n = counts.size();
+  MPI_Reduce(mpi::master ? MPI_IN_PLACE : counts.data(), counts.data(), n,
+    MPI_INT64_T, MPI_SUM, 0, mpi::intracomm);
+  MPI_Reduce(mpi::master ? MPI_IN_PLACE : &stats.occupancy_sum,
+    &stats.occupancy_sum, 1, MPI_DOUBLE, MPI_SUM, 0, mpi::intracomm);
+  MPI_Reduce(mpi::master ? MPI_IN_PLACE : &stats.transport_seconds,
+    &stats.transport_seconds, 1, MPI_DOUBLE, MPI_MAX, 0, mpi::intracomm);
+  std::copy(counts.begin(), counts.begin() + N_EVENT_TYPES, stats.events);
+  std::copy(counts.begin() + N_EVENT_TYPES, counts.begin() + 2*N_EVENT_TYPES,
+    stats.launches);
+  int k = 2*N_EVENT_TYPES;
+  stats.kernel_launches = counts[k];
+  stats.sorts = counts[k + 1];
+  stats.sorted_items = counts[k + 2];
+  stats.sorts_skipped = counts[k + 3];
+  stats.occupancy_samples = counts[k + 4];
+#endif
+
+  if (!mpi::master) return;
+  simulation::event_stats_history.push_back(stats);
+  if (!settings::event_stats) return;
+
+  int64_t total = stats.total_events();
+  double rate = stats.transport_seconds > 0.0 ?
+    total / stats.transport_seconds : 0.0;
+  fmt::print(" Batch {} events: {:.4e} total, {:.4e} events/s, {} launches, "
+    "{:.1f}% occupancy\n", stats.batch, static_cast<double>(total), rate,
+    stats.kernel_launches, 100.0 * stats.mean_occupancy());
+  std::string line {"  "};
+  for (int i = 0; i < N_EVENT_TYPES; ++i) {
+    line += fmt::format(" {} {:.3e} ({})", event_labels[i],
+      static_cast<double>(stats.events[i]), stats.launches[i]);
+  }
+  fmt::print("{}\n", line);
+  double avg_sort = stats.sorts > 0 ?
+    static_cast<double>(stats.sorted_items) / stats.sorts : 0.0;
+  fmt::print("   sorts {} (avg {:.3e} items, {} skipped)\n", stats.sorts,
+    avg_sort, stats.sorts_skipped);
+}
+
+void write_event_stats()
+{
+  if (!reporting_event_stats() || settings::path_event_stats.empty()) return;
+  if (!mpi::master) return;
+
+  std::ofstream out {settings::path_event_stats};
+  if (!out) {
+    warning(fmt::format("Could not write event statistics {}.",
+      settings::path_event_stats));
+    return;
+  }
+
+  out << "{\n  \"batches\": [";
+  const auto& history {simulation::event_stats_history};
+  for (int i = 0; i < history.size(); ++i) {
+    const auto& s {history[i]};
+    out << (i == 0 ? "\n" : ",\n") << fmt::format("    {{\"batch\": {}, "
+      "\"transport_seconds\": {:.6e}, \"kernel_launches\": {}, "
+      "\"mean_occupancy\": {:.6e}, \"sorts\": {}, \"sorted_items\": {}, "
+      "\"sorts_skipped\": {}, \"events\": {{", s.batch, s.transport_seconds,
+      s.kernel_launches, s.mean_occupancy(), s.sorts, s.sorted_items,
+      s.sorts_skipped);
+    for (int j = 0; j < N_EVENT_TYPES; ++j) {
+      out << fmt::format("{}\"{}\": {}", j == 0 ? "" : ", ", event_names[j],
+        s.events[j]);
+    }
+    out << "}, \"launches\": {";
+    for (int j = 0; j < N_EVENT_TYPES; ++j) {
+      out << fmt::format("{}\"{}\": {}", j == 0 ? "" : ", ", event_names[j],
+        s.launches[j]);
+    }
+    out << "}}";
+  }
+  out << "\n  ]\n}\n";
+  write_message(5, "Wrote event statistics {}", settings::path_event_stats);
+}
+
+} // namespace openmc
@@ -0,0 +1,184 @@
+#include "openmc/event_trace.h"
+
+#include <algorithm> // for max
+#include <array>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+#include "hdf5.h"
+
+#include "openmc/constants.h"
+#include "openmc/error.h"
+#include "openmc/hdf5_interface.h"
+#include "openmc/message_passing.h"
+#include "openmc/nuclide.h"
+#include "openmc/particle.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+#include "openmc/state_point.h"
+
+namespace openmc {
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+SharedArray<EventTraceRecord> event_trace;
+
+} // namespace simulation
+
+namespace {
+
+// Batch, generation, event and the length of every queue before the launch
+constexpr int LAUNCH_COLUMNS {3 + N_EVENT_TYPES};
+
+hid_t trace_file {-1};
+int64_t n_launches_written {0};
+std::vector<int64_t> launches; // Rows of LAUNCH_COLUMNS not yet written
+std::vector<double> launch_seconds;
+
+// Upper bound on the size of simulation::event_trace on device, which is only
+// read back when the records are written
+int64_t n_records_bound {0};
+
+//! Write the sampled events buffered on device
+void flush_records()
+{
+  auto& trace = simulation::event_trace;
+  trace.copy_device_to_host();
+  std::vector<int64_t> rows;
+  rows.reserve(6 * trace.size());
+  for (int i = 0; i < trace.size(); ++i) {
+    const auto& r = trace[i];
+    rows.insert(rows.end(), {r.launch, r.particle, r.event, r.material, r.cell,
+      r.energy_bin});
+  }
+  if (!rows.empty()) {
+    append_dataset_rows(trace_file, "events", H5T_NATIVE_INT64,
+      rows.size() / 6, rows.data());
+  }
+  trace.resize(0);
+  n_records_bound = 0;
+}
+
+} // namespace
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+bool tracing_events()
+{
+  return settings::event_based && settings::event_trace_stride > 0;
+}
+
+void init_event_trace(int64_t capacity)
+{
+  if (!tracing_events()) return;
+
+  simulation::event_trace.reserve(std::max<int64_t>(EVENT_TRACE_RECORDS,
+    capacity), "Event trace");
+  simulation::event_trace.allocate_on_device();
+  n_launches_written = 0;
+  n_records_bound = 0;
+
+  // Each process schedules its own particles, so each writes its own trace
+  std::string filename = settings::path_output + "event_trace.h5";
+  if (mpi::n_procs > 1) {
+    filename = fmt::format("{}event_trace_{}.h5", settings::path_output,
+      mpi::rank);
+  }
+  finish_statepoint_write();
+  trace_file = file_open(filename, 'w');
+  write_attribute(trace_file, "filetype", "event trace");
+  write_attribute(trace_file, "version", VERSION_EVENT_TRACE);
+  write_attribute(trace_file, "stride", settings::event_trace_stride);
+
+  // Settings that a replay of the scheduling needs
+  write_attribute(trace_file, "max_particles_in_flight",
+    settings::max_particles_in_flight);
+  write_attribute(trace_file, "minimum_sort_items",
+    settings::minimum_sort_items);
+  write_attribute(trace_file, "fuel_lookup_bias", settings::fuel_lookup_bias);
+  write_attribute(trace_file, "max_revival_period",
+    settings::max_revival_period);
+  int neutron = static_cast<int>(Particle::Type::neutron);
+  write_attribute(trace_file, "energy_min", data::energy_min[neutron]);
+  write_attribute(trace_file, "log_spacing", simulation::log_spacing);
+  write_attribute(trace_file, "n_log_bins", settings::n_log_bins);
+
+  create_extendable_dataset(trace_file, "launches", H5T_NATIVE_INT64,
+    LAUNCH_COLUMNS);
+  create_extendable_dataset(trace_file, "launch_seconds", H5T_NATIVE_DOUBLE, 1);
+  create_extendable_dataset(trace_file, "events", H5T_NATIVE_INT64, 6);
+}
+
+int64_t trace_event_launch(EventType type)
+{
+  int64_t row = n_launches_written + launch_seconds.size();
+  launches.insert(launches.end(), {simulation::current_batch,
+    simulation::current_gen, static_cast<int64_t>(type)});
+  for (int i = 0; i < N_EVENT_TYPES; ++i) {
+    launches.push_back(event_queue_size(static_cast<EventType>(i)));
+  }
+  launch_seconds.push_back(0.0);
+
+  // Every item of the queue could be sampled, so make room for all of them
+  int n = event_queue_size(type);
+  if (n_records_bound + n > simulation::event_trace.capacity()) {
+    finish_statepoint_write();
+    flush_records();
+  }
+  n_records_bound += n;
+
+  int stride = settings::event_trace_stride;
+  int event = static_cast<int>(type);
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n; i++) {
+    const EventQueueItem& item = event_queue(static_cast<EventType>(event))[i];
+    const Particle& p = simulation::device_particles[item.idx];
+    if (p.id_ % stride != 0) continue;
+    simulation::event_trace.thread_safe_append({row, p.id_, event,
+      particle_material(item.idx), item.cell_id, energy_bin(item.E)});
+  }
+  return row;
+}
+
+void trace_event_time(int64_t launch, double seconds)
+{
+  launch_seconds[launch - n_launches_written] = seconds;
+}
+
+void flush_event_trace()
+{
+  if (!tracing_events()) return;
+
+  finish_statepoint_write();
+  flush_records();
+  int64_t n = launch_seconds.size();
+  if (n > 0) {
+    append_dataset_rows(trace_file, "launches", H5T_NATIVE_INT64, n,
+      launches.data());
+    append_dataset_rows(trace_file, "launch_seconds", H5T_NATIVE_DOUBLE, n,
+      launch_seconds.data());
+  }
+  n_launches_written += n;
+  launches.clear();
+  launch_seconds.clear();
+}
+
+void finalize_event_trace()
+{
+  if (!tracing_events() || trace_file < 0) return;
+
+  flush_event_trace();
+  file_close(trace_file);
+  trace_file = -1;
+  #pragma omp target exit data map(release: simulation::event_trace.data_[:simulation::event_trace.capacity()])
+  simulation::event_trace.clear();
+}
+
+} // namespace openmc
@@ -0,0 +1,340 @@
+#include "openmc/event_tuning.h"
+
+#include <algorithm> // for max, min
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "openmc/error.h"
+#include "openmc/message_passing.h"
+#include "openmc/particle.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+#include "openmc/timer.h"
+
+namespace openmc {
+
+namespace {
+
+//==============================================================================
+// Tuned parameters
+//==============================================================================
+
+// Parameters in the order they are searched. Those with the largest effect
+// come first, so that the later ones are tuned around them.
+enum class Knob {
+  particles_in_flight,
+  fuel_lookup_bias,
+  sort_fissionable_xs,
+  sort_non_fissionable_xs,
+  sort_surface_crossing,
+  sort_surface_position,
+  sort_advance_position,
+  sort_on_device,
+  sort_key_index,
+  minimum_sort_items
+};
+
+constexpr int N_KNOBS {10};
+
+const char* knob_labels[N_KNOBS] {"Particles in flight", "Fuel XS queue bias",
+  "Sort fissionable XS", "Sort non-fissionable XS", "Sort surface crossing",
+  "Sort crossing by position", "Sort advance by position", "Sort on device",
+  "Sort key-index pairs", "Minimum sort items"};
+
+// A trial must be at least this much faster than the fastest settings so far
+// to replace them, so that batch-to-batch noise is not mistaken for a gain
+constexpr double TUNING_MIN_GAIN {0.02};
+
+//==============================================================================
+// Search state
+//==============================================================================
+
+struct EventTuning {
+  bool active {false};          //!< Whether the search is still going on
+  int64_t buffer_length {0};    //!< Length of the particle buffer
+  int n_timed {0};              //!< Batches timed so far
+  int n_trials {0};             //!< Batches that tried other settings
+  double transport_start {0.0}; //!< Transport time elapsed when the batch began
+  double best_seconds {0.0};    //!< Transport time of the fastest settings
+  int knob {-1};                //!< Parameter being searched
+  std::vector<double> candidates; //!< Values of the parameter to try
+  int candidate {-1};           //!< Value being tried
+  double start_value {0.0};     //!< Value of the parameter when its search began
+  double best_value {0.0};      //!< Fastest value of the parameter so far
+};
+
+EventTuning tuning;
+
+bool any_sorting()
+{
+  return settings::sort_fissionable_xs_lookups ||
+    settings::sort_non_fissionable_xs_lookups ||
+    settings::sort_surface_crossing || settings::sort_advance_position;
+}
+
+double knob_value(Knob knob)
+{
+  switch (knob) {
+  case Knob::particles_in_flight:
+    return std::min(settings::max_particles_in_flight, tuning.buffer_length);
+  case Knob::fuel_lookup_bias:
+    return settings::fuel_lookup_bias;
+  case Knob::sort_fissionable_xs:
+    return settings::sort_fissionable_xs_lookups;
+  case Knob::sort_non_fissionable_xs:
+    return settings::sort_non_fissionable_xs_lookups;
+  case Knob::sort_surface_crossing:
+    return settings::sort_surface_crossing;
+  case Knob::sort_surface_position:
+    return settings::sort_surface_position;
+  case Knob::sort_advance_position:
+    return settings::sort_advance_position;
+  case Knob::sort_on_device:
+    return settings::sort_on_device;
+  case Knob::sort_key_index:
+    return settings::sort_key_index;
+  case Knob::minimum_sort_items:
+    return settings::minimum_sort_items;
+  }
+  return 0.0;
+}
+
+void set_knob(Knob knob, double value)
+{
+  switch (knob) {
+  case Knob::particles_in_flight:
+    settings::max_particles_in_flight = static_cast<int64_t>(value);
+    #pragma omp target update to(settings::max_particles_in_flight)
+    break;
+  case Knob::fuel_lookup_bias:
+    settings::fuel_lookup_bias = value;
+    break;
+  case Knob::sort_fissionable_xs:
+    settings::sort_fissionable_xs_lookups = value != 0.0;
+    break;
+  case Knob::sort_non_fissionable_xs:
+    settings::sort_non_fissionable_xs_lookups = value != 0.0;
+    break;
+  case Knob::sort_surface_crossing:
+    settings::sort_surface_crossing = value != 0.0;
+    break;
+  case Knob::sort_surface_position:
+    settings::sort_surface_position = value != 0.0;
+    break;
+  case Knob::sort_advance_position:
+    settings::sort_advance_position = value != 0.0;
+    break;
+  case Knob::sort_on_device:
+    settings::sort_on_device = value != 0.0;
+    break;
+  case Knob::sort_key_index:
+    settings::sort_key_index = value != 0.0;
+    break;
+  case Knob::minimum_sort_items:
+    settings::minimum_sort_items = static_cast<int>(value);
+    #pragma omp target update to(settings::minimum_sort_items)
+    break;
+  }
+}
+
+//! Whether the parameter has any effect given the values of the others
+bool knob_matters(Knob knob)
+{
+  switch (knob) {
+  case Knob::fuel_lookup_bias:
+    return settings::event_scheduler == EventScheduler::longest_queue;
+  case Knob::sort_surface_position:
+    return settings::sort_surface_crossing;
+  case Knob::sort_on_device:
+  case Knob::minimum_sort_items:
+    return any_sorting();
+  case Knob::sort_key_index:
+    return any_sorting() && !settings::sort_on_device;
+  default:
+    return true;
+  }
+}
+
+std::vector<double> knob_candidates(Knob knob)
+{
+  switch (knob) {
+  case Knob::particles_in_flight: {
+    int64_t n = tuning.buffer_length;
+    return {static_cast<double>(n),
+      static_cast<double>(std::max<int64_t>(n/2, 1)),
+      static_cast<double>(std::max<int64_t>(n/4, 1))};
+  }
+  case Knob::fuel_lookup_bias:
+    return {1.0, 2.0, 4.0};
+  case Knob::minimum_sort_items: {
+    double m = std::max(settings::minimum_sort_items, 1000);
+    return {0.1*m, m, 10.0*m};
+  }
+  default:
+    return {0.0, 1.0};
+  }
+}
+
+//! Command-line option that sets the parameter to its value, starting from
+//! the defaults, or an empty string if the default is the value
+std::string knob_option(Knob knob)
+{
+  switch (knob) {
+  case Knob::particles_in_flight:
+    return fmt::format("-i {}", settings::max_particles_in_flight);
+  case Knob::fuel_lookup_bias:
+    return fmt::format("-x {}", settings::fuel_lookup_bias);
+  case Knob::sort_fissionable_xs:
+    return settings::sort_fissionable_xs_lookups ? "" :
+      "--no-sort-fissionable-xs";
+  case Knob::sort_non_fissionable_xs:
+    return settings::sort_non_fissionable_xs_lookups ? "" :
+      "--no-sort-non-fissionable-xs";
+  case Knob::sort_surface_crossing:
+    return settings::sort_surface_crossing ? "" : "--no-sort-surface-crossing";
+  case Knob::sort_surface_position:
+    return settings::sort_surface_position ? "--sort-surface-position" : "";
+  case Knob::sort_advance_position:
+    return settings::sort_advance_position ? "--sort-advance-position" : "";
+  case Knob::sort_on_device:
+    return settings::sort_on_device ? "" : "--no-sort-device";
+  case Knob::sort_key_index:
+    return settings::sort_key_index ? "" : "--sort-full-items";
+  case Knob::minimum_sort_items:
+    return fmt::format("-m {}", settings::minimum_sort_items);
+  }
+  return "";
+}
+
+//! Move on to the next untried value of a parameter, keeping the fastest
+//! value of each parameter whose values are exhausted
+//
+//! \return Whether a value is left to try
+bool next_trial()
+{
+  while (true) {
+    if (tuning.knob >= 0) {
+      Knob knob = static_cast<Knob>(tuning.knob);
+      while (++tuning.candidate < static_cast<int>(tuning.candidates.size())) {
+        double value = tuning.candidates[tuning.candidate];
+        if (value != tuning.start_value && value != tuning.best_value) {
+          set_knob(knob, value);
+          return true;
+        }
+      }
+      set_knob(knob, tuning.best_value);
+    }
+
+    if (++tuning.knob == N_KNOBS) return false;
+    Knob knob = static_cast<Knob>(tuning.knob);
+    tuning.candidates.clear();
+    if (knob_matters(knob)) tuning.candidates = knob_candidates(knob);
+    tuning.candidate = -1;
+    tuning.start_value = knob_value(knob);
+    tuning.best_value = tuning.start_value;
+  }
+}
+
+//! Keep the fastest settings found and report them
+void finish_event_tuning()
+{
+  // A search cut short by the end of the inactive batches may be trying a
+  // value that was not the fastest
+  if (tuning.knob >= 0 && tuning.knob < N_KNOBS) {
+    set_knob(static_cast<Knob>(tuning.knob), tuning.best_value);
+  }
+  tuning.active = false;
+  if (!mpi::master) return;
+
+  if (tuning.n_trials == 0) {
+    warning("No inactive batches were left to tune the event-based "
+      "parameters.");
+    return;
+  }
+
+  fmt::print(" Event-based parameters tuned over {} trial batches ({:.4e} s "
+    "transport per batch):\n", tuning.n_trials, tuning.best_seconds);
+  std::string options;
+  for (int i = 0; i < N_KNOBS; ++i) {
+    Knob knob = static_cast<Knob>(i);
+    double value = knob_value(knob);
+    if (i == static_cast<int>(Knob::fuel_lookup_bias) ||
+        i == static_cast<int>(Knob::particles_in_flight) ||
+        i == static_cast<int>(Knob::minimum_sort_items)) {
+      fmt::print("   {:<26} = {}\n", knob_labels[i], value);
+    } else {
+      fmt::print("   {:<26} = {}\n", knob_labels[i],
+        value != 0.0 ? "Yes" : "No");
+    }
+    std::string option = knob_option(knob);
+    if (!option.empty()) options += (options.empty() ? "" : " ") + option;
+  }
+  fmt::print(" Reuse them with the options: {}\n", options);
+}
+
+} // namespace
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+void init_event_tuning()
+{
+  tuning = {};
+  if (!settings::auto_tune) return;
+
+  // The settings are tried on inactive batches only, one after a baseline
+  // batch that follows the first, which also pays one-time costs
+  if (!settings::event_based || settings::run_mode != RunMode::EIGENVALUE ||
+      settings::n_inactive < 3) {
+    warning("Tuning of event-based parameters needs an event-based eigenvalue "
+      "run with at least 3 inactive batches and is disabled.");
+    return;
+  }
+  tuning.active = true;
+  tuning.buffer_length = simulation::particles.size();
+}
+
+void begin_batch_event_tuning()
+{
+  if (!tuning.active) return;
+  tuning.transport_start = simulation::time_transport_local.elapsed();
+}
+
+void end_batch_event_tuning()
+{
+  if (!tuning.active) return;
+
+  double seconds = simulation::time_transport_local.elapsed() -
+    tuning.transport_start;
+#ifdef OPENMC_MPI
+  // All processes keep the same settings, judged by the slowest of them
+  MPI_Allreduce(MPI_IN_PLACE, &seconds, 1, MPI_DOUBLE, MPI_MAX,
+    mpi::intracomm);
+#endif
+
+  ++tuning.n_timed;
+  if (tuning.n_timed == 2) {
+    tuning.best_seconds = seconds;
+  } else if (tuning.n_timed > 2) {
+    ++tuning.n_trials;
+    double value = tuning.candidates[tuning.candidate];
+    write_message(6, " Tuning batch {}: {} = {} took {:.4e} s (fastest "
+      "{:.4e} s)", simulation::current_batch, knob_labels[tuning.knob], value,
+      seconds, tuning.best_seconds);
+    if (seconds < (1.0 - TUNING_MIN_GAIN) * tuning.best_seconds) {
+      tuning.best_seconds = seconds;
+      tuning.best_value = value;
+    }
+  }
+
+  // Other settings are only tried while the next batch is inactive
+  bool next_inactive = simulation::current_batch < settings::n_inactive;
+  if (tuning.n_timed == 1 && next_inactive) return;
+  if (!next_inactive || !next_trial()) finish_event_tuning();
+}
+
+} // namespace openmc
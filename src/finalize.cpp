@@ -6,6 +6,8 @@
 #include "openmc/constants.h"
 #include "openmc/cross_sections.h"
 #include "openmc/dagmc.h"
+#include "openmc/device_alloc.h"
+#include "openmc/domain_decomposition.h"
 #include "openmc/eigenvalue.h"
 #include "openmc/event.h"
 #include "openmc/geometry.h"
@@ -15,15 +17,18 @@
 #include "openmc/message_passing.h"
 #include "openmc/nuclide.h"
 #include "openmc/photon.h"
+#include "openmc/profile_range.h"
 #include "openmc/random_lcg.h"
 #include "openmc/settings.h"
 #include "openmc/simulation.h"
 #include "openmc/source.h"
+#include "openmc/state_point.h"
 #include "openmc/surface.h"
 #include "openmc/thermal.h"
 #include "openmc/timer.h"
 #include "openmc/tallies/tally.h"
 #include "openmc/volume_calc.h"
+#include "openmc/weight_windows.h"
 
 #include "xtensor/xview.hpp"
 
@@ -31,6 +36,7 @@ namespace openmc {
 
 void free_memory()
 {
+  release_resident_data_from_device();
   free_memory_geometry();
   free_memory_surfaces();
   free_memory_material();
@@ -44,12 +50,14 @@ void free_memory()
   free_memory_source();
   free_memory_mesh();
   free_memory_tally();
+  free_memory_weight_windows();
   free_memory_bank();
   if (mpi::master) {
     free_memory_cmfd();
   }
   if (settings::event_based) {
     free_event_queues();
+    free_domain_decomposition();
   }
 #ifdef DAGMC
   free_memory_dagmc();
@@ -62,6 +70,10 @@ using namespace openmc;
 
 int openmc_finalize()
 {
+  // Wait for a statepoint still being written in the background, which reads
+  // the tally results cleared below
+  finish_statepoint_write();
+
   // Clear results
   openmc_reset();
 
@@ -76,6 +88,7 @@ int openmc_finalize()
   settings::electron_treatment = ElectronTreatment::LED;
   settings::dagmc = false;
   settings::delayed_photon_scaling = true;
+  settings::domain_mesh = C_NONE;
   settings::energy_cutoff = {0.0, 1000.0, 0.0, 0.0};
   settings::entropy_on = false;
   settings::event_based = false;
@@ -107,6 +120,7 @@ int openmc_finalize()
   settings::temperature_multipole = false;
   settings::temperature_range = {0.0, 0.0};
   settings::temperature_tolerance = 10.0;
+  settings::time_cutoff = {INFTY, INFTY, INFTY, INFTY};
   settings::trigger_on = false;
   settings::trigger_predict = false;
   settings::trigger_batch_interval = 1;
@@ -121,6 +135,9 @@ int openmc_finalize()
   simulation::keff = 1.0;
   simulation::n_lost_particles = 0;
   simulation::need_depletion_rx = false;
+  simulation::n_depletion_rx = 0;
+  simulation::reuse_source = false;
+  simulation::reuse_n_inactive = -1;
   simulation::satisfy_triggers = false;
   simulation::total_gen = 0;
 
@@ -137,10 +154,13 @@ int openmc_finalize()
 
   // Deallocate arrays
   free_memory();
+  finalize_profile_ranges();
 
   // Free all MPI types
 #ifdef OPENMC_MPI
   if (mpi::bank != MPI_DATATYPE_NULL) MPI_Type_free(&mpi::bank);
+  if (mpi::packed_bank != MPI_DATATYPE_NULL) MPI_Type_free(&mpi::packed_bank);
+  if (mpi::intranode != MPI_COMM_NULL) MPI_Comm_free(&mpi::intranode);
 #endif
 
   return 0;
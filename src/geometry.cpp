@@ -7,6 +7,7 @@
 
 #include "openmc/cell.h"
 #include "openmc/constants.h"
+#include "openmc/device_alloc.h"
 #include "openmc/error.h"
 #include "openmc/lattice.h"
 #include "openmc/settings.h"
@@ -69,19 +70,45 @@ bool check_cell_overlap(Particle& p, bool error)
 
 //==============================================================================
 
+//! Find the cell containing the particle, from its current coordinate level
+//! down to a material cell
+//! \param neighbor_list Cells to try first at the current level, or nullptr
+//! \param senses Surface senses already evaluated at the current level, or
+//!   nullptr. Senses evaluated here at that level are added to it.
+//! \param known_cell Cell already known to contain the particle at the current
+//!   level, or C_NONE to search for it
+
 bool
-find_cell_inner(Particle& p, const NeighborList* neighbor_list)
+find_cell_inner(Particle& p, const NeighborList* neighbor_list,
+  SurfaceSenseCache* senses, int32_t known_cell = C_NONE)
 {
+  // Senses of the surfaces shared by the cells tested at one coordinate level
+  SurfaceSenseCache level_senses;
+  if (!senses) senses = &level_senses;
+
   // Find which cell of this universe the particle is in.  Use the neighbor list
   // to shorten the search if one was provided.
-  bool found = false;
-  int32_t i_cell = C_NONE;
+  bool found = known_cell != C_NONE;
+  int32_t i_cell = known_cell;
   if (neighbor_list) {
     // TODO: ALSO MOVE ALL THE CELL DATA
     //#pragma omp target update to(p, neighbor_list[:1])
     //#pragma omp target map(tofrom: found, i_cell)
     {
-    for (int64_t i = 0; i < NEIGHBOR_SIZE ; i++) {
+    // After a surface crossing, the particle is usually in the only cell of
+    // the universe on the other side of the surface
+    i_cell = neighbor_list->across(p.surface_);
+    if (i_cell != -1) {
+      Position r {p.r_local()};
+      Direction u {p.u_local()};
+      auto surf = p.surface_;
+      if (model::device_cells[i_cell].contains(r, u, surf, senses)) {
+        p.coord_[p.n_coord_-1].cell = i_cell;
+        found = true;
+      }
+    }
+
+    for (int64_t i = 0; !found && i < NEIGHBOR_SIZE ; i++) {
 
       // Perform a read of the neighbor list element. Note that this
       // operation may be executed by this thread concurrently with another
@@ -141,12 +168,26 @@ find_cell_inner(Particle& p, const NeighborList* neighbor_list)
       Direction u {p.u_local()};
       auto surf = p.surface_;
       //if (model::cells[i_cell].contains(r, u, surf)) {
-      if (model::device_cells[i_cell].contains(r, u, surf)) {
+      if (model::device_cells[i_cell].contains(r, u, surf, senses)) {
         p.coord_[p.n_coord_-1].cell = i_cell;
         found = true;
         break;
       }
     }
+
+    // Then try the cells sharing a surface with this one. These are already in
+    // the same universe.
+    const auto& adjacent = neighbor_list->adjacent_;
+    for (int i = 0; !found && i < adjacent.size(); i++) {
+      i_cell = adjacent[i];
+      Position r {p.r_local()};
+      Direction u {p.u_local()};
+      auto surf = p.surface_;
+      if (model::device_cells[i_cell].contains(r, u, surf, senses)) {
+        p.coord_[p.n_coord_-1].cell = i_cell;
+        found = true;
+      }
+    }
     } // END TARGET REGION
     // TODO: ALSO MOVE ALL THE CELL DATA
     //#pragma omp target update from(p, neighbor_list[:1])
@@ -195,7 +236,8 @@ find_cell_inner(Particle& p, const NeighborList* neighbor_list)
         bool does_contain;
         //#pragma omp target map(from:does_contain)
         {
-          does_contain = model::device_cells[i_cell].contains(r, u, surf);
+          does_contain = model::device_cells[i_cell].contains(r, u, surf,
+            senses);
         }
         if (does_contain) {
           p.coord_[p.n_coord_-1].cell = i_cell;
@@ -357,6 +399,10 @@ find_cell_inner(Particle& p, const NeighborList* neighbor_list)
       //#pragma omp target update from(p)
     }
     i_cell = C_NONE; // trip non-neighbor cell search at next iteration
+
+    // The next level has its own coordinates
+    senses = &level_senses;
+    senses->clear();
   }
 
   return found;
@@ -371,9 +417,13 @@ bool neighbor_list_find_cell(Particle& p)
   auto i_cell = p.coord_[coord_lvl].cell;
   Cell& c {model::device_cells[i_cell]};
 
+  // Surfaces tested for the neighbors are usually shared with the other cells
+  // of the universe, so keep their senses for the exhaustive search
+  SurfaceSenseCache senses;
+
   // Search for the particle in that cell's neighbor list.  Return if we
   // found the particle.
-  bool found = find_cell_inner(p, &c.neighbors_);
+  bool found = find_cell_inner(p, &c.neighbors_, &senses);
   
   if (found)
     return found;
@@ -381,7 +431,7 @@ bool neighbor_list_find_cell(Particle& p)
   // The particle could not be found in the neighbor list.  Try searching all
   // cells in this universe, and update the neighbor list if we find a new
   // neighboring cell.
-  found = find_cell_inner(p, nullptr);
+  found = find_cell_inner(p, nullptr, &senses);
 
   if (found) {
     c.neighbors_.push_back(p.coord_[coord_lvl].cell);
@@ -405,12 +455,24 @@ bool exhaustive_find_cell(Particle& p)
   //#pragma omp target update to(p)
   //#pragma omp target map(from: found)
   {
-    found = find_cell_inner(p, nullptr);
+    found = find_cell_inner(p, nullptr, nullptr);
   }
   //#pragma omp target update from(p)
   return found;
 }
 
+bool find_cell_below(Particle& p, int level)
+{
+  // The cell at this level is still the one the particle is in, but the levels
+  // below it may have been left behind
+  p.n_coord_ = level + 1;
+  for (int i = p.n_coord_; i < COORD_SIZE; i++) {
+    p.coord_[i].reset();
+  }
+  p.surface_ = 0;
+  return find_cell_inner(p, nullptr, nullptr, p.coord_[level].cell);
+}
+
 //==============================================================================
 
 void
@@ -482,6 +544,11 @@ cross_lattice(Particle& p, const BoundaryInfo& boundary)
 //==============================================================================
 
 BoundaryInfo distance_to_boundary(Particle& p)
+{
+  return distance_to_boundary(p, p.n_coord_);
+}
+
+BoundaryInfo distance_to_boundary(Particle& p, int n_coord)
 {
   //if( p->id_ == 1 )
     //printf("in distance_to_boundary -- mode::device_cells ptr = %p\n", model::device_cells);
@@ -492,7 +559,7 @@ BoundaryInfo distance_to_boundary(Particle& p)
   std::array<int, 3> level_lat_trans {};
 
   // Loop over each coordinate level.
-  for (int i = 0; i < p.n_coord_; i++) {
+  for (int i = 0; i < n_coord; i++) {
     const auto& coord {p.coord_[i]};
     Position r {coord.r};
     Direction u {coord.u};
@@ -511,7 +578,11 @@ BoundaryInfo distance_to_boundary(Particle& p)
 
 
     // Find the oncoming surface in this cell and the distance to it.
-    auto surface_distance = c.distance(r, u, p.surface_, &p);
+    // Collisions happen in the innermost cell, whose general planes can be
+    // carried along from one to the next
+    PlaneEvalCache* planes = settings::plane_cache && i == n_coord - 1 ?
+      &p.plane_cache_ : nullptr;
+    auto surface_distance = c.distance(r, u, p.surface_, &p, planes);
     d_surf = surface_distance.first;
     level_surf_cross = surface_distance.second;
 
@@ -526,7 +597,13 @@ BoundaryInfo distance_to_boundary(Particle& p)
       std::pair<double, std::array<int, 3>> lattice_distance;
       switch (lat.type_) {
         case LatticeType::rect:
-          lattice_distance = lat.distance(r, u, i_xyz);
+          // Go straight through the tiles ahead that are filled with the same
+          // homogeneous universe
+          if (c.is_homogeneous()) {
+            lattice_distance = lat.RectLattice_run_distance(r, u, i_xyz);
+          } else {
+            lattice_distance = lat.distance(r, u, i_xyz);
+          }
           break;
         case LatticeType::hex:
           //auto& cell_above {model::cells[p->coord_[i-1].cell]};
@@ -615,6 +692,49 @@ openmc_find_cell(const double* xyz, int32_t* index, int32_t* instance)
   return 0;
 }
 
+extern "C" int
+openmc_find_cells(const double* xyz, int n, int32_t* index, int32_t* instance)
+{
+  if (n < 0) {
+    set_errmsg("Number of points to locate must be nonnegative.");
+    return OPENMC_E_INVALID_ARGUMENT;
+  }
+  if (n == 0) return 0;
+
+  // Cells are located through the device geometry pointers, which are only
+  // set once the geometry has been moved
+  if (!model::device_cells) {
+    move_settings_to_device();
+    move_geometry_to_device();
+  }
+
+  // Points outside of the geometry are marked rather than failing the whole
+  // call, so that callers can handle them together
+  if (settings::device_find_cells) {
+    #pragma omp target teams distribute parallel for \
+      map(to: xyz[:3*n]) map(from: index[:n], instance[:n])
+    for (int i = 0; i < n; ++i) {
+      Particle p;
+      p.r() = Position{xyz + 3*i};
+      p.u() = {0.0, 0.0, 1.0};
+      bool found = exhaustive_find_cell(p);
+      index[i] = found ? p.coord_[p.n_coord_-1].cell : C_NONE;
+      instance[i] = found ? p.cell_instance_ : C_NONE;
+    }
+  } else {
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i = 0; i < n; ++i) {
+      Particle p;
+      p.r() = Position{xyz + 3*i};
+      p.u() = {0.0, 0.0, 1.0};
+      bool found = exhaustive_find_cell(p);
+      index[i] = found ? p.coord_[p.n_coord_-1].cell : C_NONE;
+      instance[i] = found ? p.cell_instance_ : C_NONE;
+    }
+  }
+  return 0;
+}
+
 extern "C" int openmc_global_bounding_box(double* llc, double* urc) {
   auto bbox = model::universes.at(model::root_universe).bounding_box();
 
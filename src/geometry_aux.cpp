@@ -1,8 +1,13 @@
 #include "openmc/geometry_aux.h"
 
 #include <algorithm>  // for std::max
+#include <array>
+#include <map>
+#include <set>
 #include <sstream>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility> // for pair
 
 #include <fmt/core.h>
 #include <pugixml.hpp>
@@ -14,9 +19,11 @@
 #include "openmc/error.h"
 #include "openmc/file_utils.h"
 #include "openmc/geometry.h"
+#include "openmc/hdf5_interface.h"
 #include "openmc/lattice.h"
 #include "openmc/material.h"
 #include "openmc/settings.h"
+#include "openmc/startup_profile.h"
 #include "openmc/surface.h"
 #include "openmc/tallies/filter.h"
 
@@ -47,29 +54,91 @@ void read_geometry_xml()
   }
 #endif
 
+  // Fall back on the HDF5 model input when there is no geometry.xml
+  std::string filename = settings::path_input + "geometry.xml";
+  if (!file_exists(filename) &&
+      file_exists(settings::path_input + "geometry.h5")) {
+    read_geometry_hdf5();
+    return;
+  }
+
   // Display output message
   write_message("Reading geometry XML file...", 5);
 
   // Check if geometry.xml exists
-  std::string filename = settings::path_input + "geometry.xml";
   if (!file_exists(filename)) {
     fatal_error("Geometry XML file '" + filename + "' does not exist!");
   }
 
   // Parse settings.xml file
+  begin_phase("Parsing geometry.xml");
   pugi::xml_document doc;
   auto result = doc.load_file(filename.c_str());
   if (!result) {
     fatal_error("Error processing geometry.xml file.");
   }
+  end_phase();
 
   // Get root element
   pugi::xml_node root = doc.document_element();
 
   // Read surfaces, cells, lattice
+  begin_phase("Building surfaces");
   read_surfaces(root);
+  end_phase();
+  begin_phase("Building cells");
   read_cells(root);
+  end_phase();
+  begin_phase("Building lattices");
   read_lattices(root);
+  end_phase();
+
+  // Allocate universes, universe cell arrays, and assign base universe
+  model::root_universe = find_root_universe();
+}
+
+void read_geometry_hdf5()
+{
+  write_message("Reading geometry HDF5 file...", 5);
+
+  std::string filename = settings::path_input + "geometry.h5";
+  hid_t file_id = file_open(filename, 'r');
+
+  // Check the filetype and version
+  std::string type;
+  read_attribute(file_id, "filetype", type);
+  if (type != "geometry") {
+    fatal_error(fmt::format("{} is not a geometry file.", filename));
+  }
+  std::array<int, 2> version;
+  read_attribute(file_id, "version", version);
+  if (version != VERSION_MODEL_INPUT) {
+    fatal_error(fmt::format("{} has version {}.{}, but OpenMC reads version "
+      "{}.{}.", filename, version[0], version[1], VERSION_MODEL_INPUT[0],
+      VERSION_MODEL_INPUT[1]));
+  }
+
+  // Read surfaces and cells from their columns
+  begin_phase("Building surfaces");
+  read_surfaces_hdf5(file_id);
+  end_phase();
+  begin_phase("Building cells");
+  read_cells_hdf5(file_id);
+  end_phase();
+
+  // Lattices are few and small next to cells, so they are stored as the XML
+  // elements that geometry.xml would hold
+  std::string lattices;
+  read_dataset(file_id, "lattices", lattices);
+  file_close(file_id);
+
+  begin_phase("Building lattices");
+  pugi::xml_document doc;
+  if (!doc.load_string(lattices.c_str())) {
+    fatal_error("Error processing the lattices of geometry.h5.");
+  }
+  read_lattices(doc.document_element());
+  end_phase();
 
   // Allocate universes, universe cell arrays, and assign base universe
   model::root_universe = find_root_universe();
@@ -81,7 +150,9 @@ void
 adjust_indices()
 {
   // Adjust material/fill idices.
-  for (auto& c : model::cells) {
+  #pragma omp parallel for schedule(static)
+  for (int i = 0; i < model::cells.size(); ++i) {
+    auto& c = model::cells[i];
     if (c.fill_ != C_NONE) {
       int32_t id = c.fill_;
       auto search_univ = model::universe_map.find(id);
@@ -114,7 +185,9 @@ adjust_indices()
   }
 
   // Change cell.universe values from IDs to indices.
-  for (auto& c : model::cells) {
+  #pragma omp parallel for schedule(static)
+  for (int i = 0; i < model::cells.size(); ++i) {
+    auto& c = model::cells[i];
     auto search = model::universe_map.find(c.universe_);
     if (search != model::universe_map.end()) {
       c.universe_ = search->second;
@@ -125,54 +198,148 @@ adjust_indices()
   }
 
   // Change all lattice universe values from IDs to indices.
-  for (auto& l : model::lattices) {
-    l.adjust_indices();
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < model::lattices.size(); ++i) {
+    model::lattices[i].adjust_indices();
   }
 }
 
 //==============================================================================
-//! Partition some universes with many z-planes for faster find_cell searches.
+//! Partition some universes with many nested planes, cylinders or spheres for
+//! faster find_cell searches.
 
 void
 partition_universes()
 {
   // Iterate over universes with more than 10 cells.  (Fewer than 10 is likely
   // not worth partitioning.)
-  //for (const auto& univ : model::universes) {
-  for (auto& univ : model::universes) {
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < model::universes.size(); ++i) {
+    auto& univ = model::universes[i];
     if (univ.cells_.size() > 10) {
-      // Collect the set of surfaces in this universe.
-      std::unordered_set<int32_t> surf_inds;
-      for (auto i_cell : univ.cells_) {
-        for (auto token : model::cells[i_cell].region_) {
-          if (token < OP_UNION)
-            surf_inds.insert(std::abs(token) - 1);
+      // Keep the partitioner if it divides the universe with more than 5
+      // surfaces.  (Fewer than 5 is likely not worth it.)
+      auto* partitioner = new UniversePartitioner(univ);
+      if (partitioner->surfs_.size() > 5) {
+        univ.partitioner_ = partitioner;
+      } else {
+        delete partitioner;
+      }
+    }
+  }
+}
+
+//==============================================================================
+//! Find the cells of the same universe sharing a surface with each cell. These
+//! are the cells a particle can enter by crossing one of the cell's surfaces,
+//! except across coincident surfaces or through a corner.
+
+void
+find_adjacent_cells()
+{
+  // Universes share no cells, so each is handled by one thread
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < model::universes.size(); ++i) {
+    const auto& univ = model::universes[i];
+    // Find the surfaces bounding each cell and the cells bounded by each
+    // surface
+    std::unordered_map<int32_t, std::set<int32_t>> cell_surfaces;
+    std::unordered_map<int32_t, vector<int32_t>> surface_cells;
+    for (int32_t i_cell : univ.cells_) {
+      auto& surfs = cell_surfaces[i_cell];
+      for (int32_t token : model::cells[i_cell].region_) {
+        if (token < OP_UNION) surfs.insert(std::abs(token) - 1);
+      }
+      for (int32_t i_surf : surfs) surface_cells[i_surf].push_back(i_cell);
+    }
+
+    int n_cells = univ.cells_.size();
+    for (int32_t i_cell : univ.cells_) {
+      // Count the surfaces shared with each other cell. In large universes,
+      // surfaces bounding most of the cells (e.g. an axial plane through the
+      // whole model) are skipped since their cells are better found by the
+      // exhaustive search.
+      std::unordered_map<int32_t, int> n_shared;
+      for (int32_t i_surf : cell_surfaces[i_cell]) {
+        const auto& cells = surface_cells[i_surf];
+        if (n_cells > NEIGHBOR_SIZE && 2 * static_cast<int>(cells.size()) > n_cells) continue;
+        for (int32_t j_cell : cells) {
+          if (j_cell != i_cell) ++n_shared[j_cell];
         }
       }
 
-      // Partition the universe if there are more than 5 z-planes.  (Fewer than
-      // 5 is likely not worth it.)
-      int n_zplanes = 0;
-      for (auto i_surf : surf_inds) {
-        //if (dynamic_cast<const SurfaceZPlane*>(model::surfaces[i_surf].get())) {
-        if (model::surfaces[i_surf].type_ == Surface::SurfaceType::SurfaceZPlane) {
-          ++n_zplanes;
-          if (n_zplanes > 5) {
-            univ.partitioner_ = new UniversePartitioner(univ);
-            break;
-          }
+      std::vector<std::pair<int, int32_t>> adjacent;
+      for (const auto& kv : n_shared) adjacent.push_back({-kv.second, kv.first});
+      std::sort(adjacent.begin(), adjacent.end());
+
+      auto& list = model::cells[i_cell].neighbors_.adjacent_;
+      list.clear();
+      for (const auto& a : adjacent) list.push_back(a.second);
+    }
+  }
+}
+
+//==============================================================================
+//! For each surface of each cell, find the cell a particle enters by crossing
+//! it when a single cell of the universe is bounded by the other side.
+
+void
+find_surface_crossings()
+{
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < model::universes.size(); ++i) {
+    const auto& univ = model::universes[i];
+    // Find the cells bounded by each half-space
+    std::unordered_map<int32_t, vector<int32_t>> half_space_cells;
+    for (int32_t i_cell : univ.cells_) {
+      std::set<int32_t> tokens;
+      for (int32_t token : model::cells[i_cell].region_) {
+        if (token < OP_UNION) tokens.insert(token);
+      }
+      for (int32_t token : tokens) half_space_cells[token].push_back(i_cell);
+    }
+
+    for (int32_t i_cell : univ.cells_) {
+      auto& crossings = model::cells[i_cell].neighbors_.crossings_;
+      crossings.clear();
+      std::set<int32_t> entered;
+      for (int32_t token : model::cells[i_cell].region_) {
+        if (token >= OP_UNION || !entered.insert(-token).second) continue;
+        auto search = half_space_cells.find(-token);
+        if (search == half_space_cells.end()) continue;
+        const auto& cells = search->second;
+        if (cells.size() == 1 && cells[0] != i_cell) {
+          crossings.push_back({-token, cells[0]});
         }
       }
     }
   }
 }
 
+//==============================================================================
+//! Flag the cells listed in settings::delta_tracking_cells
+
+void
+mark_delta_tracking_cells()
+{
+  for (int32_t id : settings::delta_tracking_cells) {
+    auto search = model::cell_map.find(id);
+    if (search == model::cell_map.end()) {
+      fatal_error(fmt::format(
+        "Could not find delta-tracking cell {} in the geometry.", id));
+    }
+    model::cells[search->second].delta_tracking_ = true;
+  }
+}
+
 //==============================================================================
 
 void
 assign_temperatures()
 {
-  for (auto& c : model::cells) {
+  #pragma omp parallel for schedule(static)
+  for (int i = 0; i < model::cells.size(); ++i) {
+    auto& c = model::cells[i];
     // Ignore non-material cells and cells with defined temperature.
     if (c.material_.size() == 0) continue;
     if (c.sqrtkT_.size() > 0) continue;
@@ -241,20 +408,192 @@ get_temperatures(std::vector<std::vector<double>>& nuc_temps,
   }
 }
 
+namespace {
+
+//==============================================================================
+//! Drop the half-spaces of an intersection that another one of the same kind
+//! implies: repeated tokens, the looser of two half-spaces of parallel
+//! axis-aligned planes, and the larger (smaller) of two insides (outsides) of
+//! coaxial cylinders or concentric spheres.
+//
+//! \param region Tokens of a simple cell, which are all intersected
+//! \return Number of tokens removed
+
+int
+simplify_intersection(vector<int32_t>& region)
+{
+  // Half-spaces of the same family differ only by their position (planes) or
+  // radius (cylinders and spheres). Other surfaces are their own family.
+  auto family = [](int32_t token) {
+    const auto& surf {model::surfaces[std::abs(token) - 1]};
+    vector<double> coeffs;
+    pack_coefficients(surf, coeffs);
+    std::vector<double> key {static_cast<double>(surf.type_),
+      token > 0 ? 1.0 : -1.0};
+    switch (surf.type_) {
+    case Surface::SurfaceType::SurfaceXPlane:
+    case Surface::SurfaceType::SurfaceYPlane:
+    case Surface::SurfaceType::SurfaceZPlane:
+      return std::make_pair(key, coeffs[0]);
+    case Surface::SurfaceType::SurfaceXCylinder:
+    case Surface::SurfaceType::SurfaceYCylinder:
+    case Surface::SurfaceType::SurfaceZCylinder:
+    case Surface::SurfaceType::SurfaceSphere:
+      key.insert(key.end(), coeffs.begin(), coeffs.end() - 1);
+      return std::make_pair(key, coeffs[coeffs.size() - 1]);
+    default:
+      key.push_back(token);
+      return std::make_pair(key, 0.0);
+    }
+  };
+
+  // The tightest position or radius of each family: the largest one on the
+  // positive side of planes or outside of cylinders and spheres, the
+  // smallest one otherwise. Distinct surfaces at the tightest position are
+  // all kept, since they may have different boundary conditions.
+  std::map<std::vector<double>, double> tightest;
+  for (int32_t token : region) {
+    auto f = family(token);
+    auto it = tightest.find(f.first);
+    if (it == tightest.end()) {
+      tightest.emplace(f.first, f.second);
+    } else if (token > 0 ? f.second > it->second : f.second < it->second) {
+      it->second = f.second;
+    }
+  }
+
+  vector<int32_t> simplified;
+  std::set<int32_t> seen;
+  for (int32_t token : region) {
+    auto f = family(token);
+    if (f.second == tightest[f.first] && seen.insert(token).second) {
+      simplified.push_back(token);
+    }
+  }
+  int n_removed = region.size() - simplified.size();
+  region = simplified;
+  return n_removed;
+}
+
+} // namespace
+
+//==============================================================================
+//! Merge coincident duplicate surfaces, drop redundant half-spaces of simple
+//! cells and order their tokens by increasing cost (see
+//! settings::optimize_geometry).
+
+void
+optimize_geometry()
+{
+  // Surfaces of the same type, coefficients and boundary condition are the
+  // same surface. Cells and the surface map are pointed at the first one, so
+  // that surface filters and surface source banks given either ID still see
+  // its crossings. Periodic surfaces and types without packed coefficients
+  // are left alone.
+  int n_surfaces = model::surfaces.size();
+  std::vector<int32_t> kept(n_surfaces);
+  std::map<std::vector<double>, int32_t> unique;
+  int n_merged = 0;
+  for (int32_t i = 0; i < n_surfaces; ++i) {
+    kept[i] = i;
+    const auto& surf {model::surfaces[i]};
+    auto bc = surf.bc_.type_;
+    if (bc == BoundaryCondition::BCType::TranslationalPeriodic ||
+        bc == BoundaryCondition::BCType::RotationalPeriodic) continue;
+    vector<double> coeffs;
+    pack_coefficients(surf, coeffs);
+    if (coeffs.empty()) continue;
+
+    std::vector<double> key {static_cast<double>(surf.type_),
+      static_cast<double>(bc), surf.surf_source_ ? 1.0 : 0.0};
+    key.insert(key.end(), coeffs.begin(), coeffs.end());
+    auto it = unique.find(key);
+    if (it == unique.end()) {
+      unique.emplace(key, i);
+    } else {
+      kept[i] = it->second;
+      model::surface_map[surf.id_] = it->second;
+      ++n_merged;
+    }
+  }
+
+  int n_removed = 0;
+  int n_cells_changed = 0;
+  for (auto& c : model::cells) {
+    bool changed = false;
+    for (auto& token : c.region_) {
+      if (token >= OP_UNION) continue;
+      int32_t i_surf = kept[std::abs(token) - 1];
+      int32_t merged = token > 0 ? i_surf + 1 : -(i_surf + 1);
+      if (merged != token) changed = true;
+      token = merged;
+    }
+
+    if (c.simple_) {
+      int n = simplify_intersection(c.region_);
+      if (n > 0) changed = true;
+      n_removed += n;
+
+      // Cheaper half-spaces first, which is also the order contains() tests
+      // them in
+      std::stable_sort(c.region_.begin(), c.region_.end(),
+        [](int32_t a, int32_t b) {
+          return half_space_cost(a) < half_space_cost(b);
+        });
+    }
+
+    if (changed) {
+      c.update_region();
+      ++n_cells_changed;
+    }
+  }
+
+  write_message(fmt::format("Geometry optimization merged {} duplicate "
+    "surfaces and removed {} redundant half-spaces, changing {} cells.",
+    n_merged, n_removed, n_cells_changed), 6);
+}
+
 //==============================================================================
 
 void finalize_geometry()
 {
   // Perform some final operations to set up the geometry
+  begin_phase("Adjusting indices");
   adjust_indices();
+  end_phase();
+  if (settings::optimize_geometry && !settings::dagmc) {
+    begin_phase("Optimizing geometry");
+    optimize_geometry();
+    end_phase();
+  }
+  begin_phase("Counting cell instances");
   count_cell_instances(model::root_universe);
+  end_phase();
+  begin_phase("Partitioning universes");
   partition_universes();
+  end_phase();
+  begin_phase("Finding adjacent cells");
+  find_adjacent_cells();
+  end_phase();
+  begin_phase("Finding surface crossings");
+  find_surface_crossings();
+  end_phase();
+  begin_phase("Marking delta-tracking cells");
+  mark_delta_tracking_cells();
+  end_phase();
 
   // Assign temperatures to cells that don't have temperatures already assigned
+  begin_phase("Assigning temperatures");
   assign_temperatures();
+  end_phase();
 
   // Determine number of nested coordinate levels in the geometry
   model::n_coord_levels = maximum_levels(model::root_universe);
+  if (model::n_coord_levels > COORD_SIZE) {
+    fatal_error(fmt::format("The geometry has {} coordinate levels, but "
+      "particles can only store {}. Rebuild with -Dcoord_levels={} or higher.",
+      model::n_coord_levels, COORD_SIZE, model::n_coord_levels));
+  }
 }
 
 //==============================================================================
@@ -1,5 +1,6 @@
 #include "openmc/hdf5_interface.h"
 
+#include <algorithm> // for min, max
 #include <array>
 #include <cstring>
 #include <stdexcept>
@@ -16,6 +17,9 @@
 #include "openmc/message_passing.h"
 #endif
 
+#include "openmc/constants.h"
+#include "openmc/settings.h"
+
 
 namespace openmc {
 
@@ -667,8 +671,10 @@ write_dataset_lowlevel(hid_t group_id, int ndim, const hsize_t* dims,
     dspace = H5Screate(H5S_SCALAR);
   }
 
+  hid_t dcpl = dataset_create_plist(group_id, mem_type_id, ndim, dims, indep);
   hid_t dset = H5Dcreate(group_id, name, mem_type_id, dspace,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+                         H5P_DEFAULT, dcpl, H5P_DEFAULT);
+  if (dcpl != H5P_DEFAULT) H5Pclose(dcpl);
 
   if (using_mpio_device(group_id)) {
 #ifdef PHDF5
@@ -770,6 +776,129 @@ write_tally_results(hid_t group_id, hsize_t n_filter, hsize_t n_score,
 }
 
 
+hid_t dataset_create_plist(hid_t group_id, hid_t type_id, int ndim,
+  const hsize_t* dims, bool indep)
+{
+  if (settings::hdf5_compression == 0 || ndim == 0) return H5P_DEFAULT;
+
+  // Filtered datasets cannot be written independently in parallel
+  if (indep && using_mpio_device(group_id)) return H5P_DEFAULT;
+
+  // Bytes in one index of the first dimension
+  hsize_t row_bytes = H5Tget_size(type_id);
+  for (int i = 1; i < ndim; ++i) row_bytes *= dims[i];
+  if (row_bytes == 0 || dims[0] * row_bytes < HDF5_FILTER_MIN_BYTES) {
+    return H5P_DEFAULT;
+  }
+
+  // Chunks of whole rows, as close to the target size as possible
+  std::vector<hsize_t> chunk {dims, dims + ndim};
+  hsize_t n_rows = settings::hdf5_chunk_size / row_bytes;
+  chunk[0] = std::min(std::max<hsize_t>(n_rows, 1), dims[0]);
+
+  hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(dcpl, ndim, chunk.data());
+  H5Pset_shuffle(dcpl);
+  H5Pset_deflate(dcpl, settings::hdf5_compression);
+  return dcpl;
+}
+
+
+void write_tally_results_slab(hid_t group_id, hsize_t n_filter, hsize_t n_score,
+  hsize_t offset, hsize_t n_rows, const double* slab)
+{
+  constexpr int ndim = 3;
+  hsize_t dims[ndim] {n_filter, n_score, 2};
+  hid_t dspace = H5Screate_simple(ndim, dims, nullptr);
+
+  hid_t dcpl = dataset_create_plist(group_id, H5T_NATIVE_DOUBLE, ndim, dims,
+    false);
+  hid_t dset = H5Dcreate(group_id, "results", H5T_NATIVE_DOUBLE, dspace,
+                         H5P_DEFAULT, dcpl, H5P_DEFAULT);
+  if (dcpl != H5P_DEFAULT) H5Pclose(dcpl);
+
+  // Select the range in the file. A process without filter bins still takes
+  // part in the collective write with an empty selection.
+  hsize_t mem_dims[ndim] {n_rows > 0 ? n_rows : 1, n_score, 2};
+  hid_t memspace = H5Screate_simple(ndim, mem_dims, nullptr);
+  if (n_rows > 0) {
+    hsize_t start[ndim] {offset, 0, 0};
+    hsize_t count[ndim] {n_rows, n_score, 2};
+    H5Sselect_hyperslab(dspace, H5S_SELECT_SET, start, nullptr, count, nullptr);
+  } else {
+    H5Sselect_none(dspace);
+    H5Sselect_none(memspace);
+  }
+
+  hid_t plist = H5P_DEFAULT;
+#ifdef PHDF5
+  if (using_mpio_device(group_id)) {
+    plist = H5Pcreate(H5P_DATASET_XFER);
+    H5Pset_dxpl_mpio(plist, H5FD_MPIO_COLLECTIVE);
+  }
+#endif
+  H5Dwrite(dset, H5T_NATIVE_DOUBLE, memspace, dspace, plist, slab);
+
+  // Free resources
+  if (plist != H5P_DEFAULT) H5Pclose(plist);
+  H5Sclose(memspace);
+  H5Dclose(dset);
+  H5Sclose(dspace);
+}
+
+
+void create_extendable_dataset(hid_t group_id, const char* name,
+  hid_t type_id, hsize_t n_cols)
+{
+  hsize_t dims[] {0, n_cols};
+  hsize_t maxdims[] {H5S_UNLIMITED, n_cols};
+  hid_t dspace = H5Screate_simple(2, dims, maxdims);
+
+  // Chunks of whole rows of about settings::hdf5_chunk_size bytes, compressed
+  // like other large datasets
+  hsize_t chunk[] {std::max<hsize_t>(1,
+    settings::hdf5_chunk_size / (n_cols * H5Tget_size(type_id))), n_cols};
+  hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(dcpl, 2, chunk);
+  if (settings::hdf5_compression > 0) {
+    H5Pset_shuffle(dcpl);
+    H5Pset_deflate(dcpl, settings::hdf5_compression);
+  }
+
+  hid_t dset = H5Dcreate(group_id, name, type_id, dspace, H5P_DEFAULT, dcpl,
+    H5P_DEFAULT);
+  H5Dclose(dset);
+  H5Pclose(dcpl);
+  H5Sclose(dspace);
+}
+
+
+void append_dataset_rows(hid_t group_id, const char* name, hid_t type_id,
+  hsize_t n_rows, const void* buffer)
+{
+  hid_t dset = H5Dopen(group_id, name, H5P_DEFAULT);
+  hid_t dspace = H5Dget_space(dset);
+  hsize_t dims[2];
+  H5Sget_simple_extent_dims(dspace, dims, nullptr);
+  H5Sclose(dspace);
+
+  hsize_t start[] {dims[0], 0};
+  hsize_t count[] {n_rows, dims[1]};
+  dims[0] += n_rows;
+  H5Dset_extent(dset, dims);
+
+  dspace = H5Dget_space(dset);
+  H5Sselect_hyperslab(dspace, H5S_SELECT_SET, start, nullptr, count, nullptr);
+  hid_t memspace = H5Screate_simple(2, count, nullptr);
+  H5Dwrite(dset, type_id, memspace, dspace, H5P_DEFAULT, buffer);
+
+  // Free resources
+  H5Sclose(memspace);
+  H5Sclose(dspace);
+  H5Dclose(dset);
+}
+
+
 bool
 using_mpio_device(hid_t obj_id)
 {
@@ -789,6 +918,31 @@ using_mpio_device(hid_t obj_id)
   return driver == H5FD_MPIO;
 }
 
+bool
+hdf5_thread_safe()
+{
+  hbool_t thread_safe = false;
+  H5is_library_threadsafe(&thread_safe);
+  return thread_safe;
+}
+
+hsize_t
+storage_size(hid_t group_id)
+{
+  hsize_t n = 0;
+  for (const auto& name : dataset_names(group_id)) {
+    hid_t dset = open_dataset(group_id, name.c_str());
+    n += H5Dget_storage_size(dset);
+    close_dataset(dset);
+  }
+  for (const auto& name : group_names(group_id)) {
+    hid_t group = open_group(group_id, name.c_str());
+    n += storage_size(group);
+    close_group(group);
+  }
+  return n;
+}
+
 // Specializations of the H5TypeMap template struct
 template<>
 const hid_t H5TypeMap<bool>::type_id = H5T_NATIVE_INT8;
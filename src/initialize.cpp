@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdlib> // for getenv
 #include <cstring>
+#include <limits> // for numeric_limits
 #include <string>
 #include <vector>
 
@@ -11,6 +12,7 @@
 #endif
 #include <fmt/core.h>
 
+#include "openmc/bank.h"
 #include "openmc/capi.h"
 #include "openmc/constants.h"
 #include "openmc/cross_sections.h"
@@ -23,9 +25,11 @@
 #include "openmc/nuclide.h"
 #include "openmc/output.h"
 #include "openmc/plot.h"
+#include "openmc/profile_range.h"
 #include "openmc/random_lcg.h"
 #include "openmc/settings.h"
 #include "openmc/simulation.h"
+#include "openmc/startup_profile.h"
 #include "openmc/string_utils.h"
 #include "openmc/summary.h"
 #include "openmc/tallies/tally.h"
@@ -54,6 +58,21 @@ int openmc_init(int argc, char* argv[], const void* intracomm)
   int err = parse_command_line(argc, argv);
   if (err) return err;
 
+  // Choose the device to offload to before the first target region
+  err = bind_device();
+  if (err) return err;
+
+  // Start the marker API of the profiler annotations are built for, if any
+  init_profile_ranges();
+
+#ifdef OPENMC_MPI
+  // Empty target region + MPI barrier ensures that variable JIT compile
+  // times do not cause timing differences between MPI ranks
+  #pragma omp target
+  {}
+  MPI_Barrier( mpi::intracomm );
+#endif
+
   // Start total and initialization timer
   simulation::time_total.start();
   simulation::time_initialize.start();
@@ -95,20 +114,18 @@ void initialize_mpi(MPI_Comm intracomm)
   MPI_Initialized(&flag);
   if (!flag) MPI_Init(nullptr, nullptr);
 
-  // Empty target region + MPI barrier ensures that variable JIT compile
-  // times do not cause timing differences between MPI ranks
-  #pragma omp target
-  {}
-  MPI_Barrier( mpi::intracomm );
-
   // Determine number of processes and rank for each
   MPI_Comm_size(intracomm, &mpi::n_procs);
   MPI_Comm_rank(intracomm, &mpi::rank);
   mpi::master = (mpi::rank == 0);
 
+  // Group the processes that can share memory
+  MPI_Comm_split_type(intracomm, MPI_COMM_TYPE_SHARED, mpi::rank,
+    MPI_INFO_NULL, &mpi::intranode);
+
   // Create bank datatype
   Particle::Bank b;
-  MPI_Aint disp[9];
+  MPI_Aint disp[10];
   MPI_Get_address(&b.r, &disp[0]);
   MPI_Get_address(&b.u, &disp[1]);
   MPI_Get_address(&b.E, &disp[2]);
@@ -118,17 +135,70 @@ void initialize_mpi(MPI_Comm intracomm)
   MPI_Get_address(&b.particle, &disp[6]);
   MPI_Get_address(&b.parent_id, &disp[7]);
   MPI_Get_address(&b.progeny_id, &disp[8]);
-  for (int i = 8; i >= 0; --i) {
+  MPI_Get_address(&b.time, &disp[9]);
+  for (int i = 9; i >= 0; --i) {
     disp[i] -= disp[0];
   }
 
-  int blocks[] {3, 3, 1, 1, 1, 1, 1, 1, 1};
-  MPI_Datatype types[] {MPI_DOUBLE, MPI_DOUBLE, MPI_DOUBLE, MPI_DOUBLE, MPI_INT, MPI_INT, MPI_INT, MPI_LONG, MPI_LONG};
-  MPI_Type_create_struct(9, blocks, disp, types, &mpi::bank);
+  int blocks[] {3, 3, 1, 1, 1, 1, 1, 1, 1, 1};
+  MPI_Datatype types[] {MPI_DOUBLE, MPI_DOUBLE, MPI_DOUBLE, MPI_DOUBLE, MPI_INT, MPI_INT, MPI_INT, MPI_LONG, MPI_LONG, MPI_DOUBLE};
+  MPI_Type_create_struct(10, blocks, disp, types, &mpi::bank);
   MPI_Type_commit(&mpi::bank);
+
+  // Create packed bank datatype
+  PackedBank pb;
+  MPI_Aint pdisp[7];
+  MPI_Get_address(&pb.r, &pdisp[0]);
+  MPI_Get_address(&pb.E, &pdisp[1]);
+  MPI_Get_address(&pb.u, &pdisp[2]);
+  MPI_Get_address(&pb.wgt, &pdisp[3]);
+  MPI_Get_address(&pb.surf_id, &pdisp[4]);
+  MPI_Get_address(&pb.delayed_group, &pdisp[5]);
+  MPI_Get_address(&pb.particle, &pdisp[6]);
+  for (int i = 6; i >= 0; --i) {
+    pdisp[i] -= pdisp[0];
+  }
+
+  int pblocks[] {3, 1, 3, 1, 1, 1, 1};
+  MPI_Datatype ptypes[] {MPI_DOUBLE, MPI_DOUBLE, MPI_FLOAT, MPI_FLOAT, MPI_INT32_T, MPI_INT8_T, MPI_INT8_T};
+  MPI_Datatype packed_struct;
+  MPI_Type_create_struct(7, pblocks, pdisp, ptypes, &packed_struct);
+  MPI_Type_create_resized(packed_struct, 0, sizeof(PackedBank), &mpi::packed_bank);
+  MPI_Type_free(&packed_struct);
+  MPI_Type_commit(&mpi::packed_bank);
 }
 #endif // OPENMC_MPI
 
+int bind_device()
+{
+#ifdef _OPENMP
+  int n_devices = omp_get_num_devices();
+  int device = settings::device_id;
+  if (settings::bind_devices && device < 0 && n_devices > 0) {
+    // Processes on a node take the devices in turn
+    int node_rank = 0;
+#ifdef OPENMC_MPI
+    MPI_Comm_rank(mpi::intranode, &node_rank);
+#endif
+    device = node_rank % n_devices;
+  }
+
+  if (device >= 0) {
+    if (device >= n_devices) {
+      std::string msg {fmt::format("Device {} was requested, but only {} "
+        "devices are available.", device, n_devices)};
+      strcpy(openmc_err_msg, msg.c_str());
+      return OPENMC_E_INVALID_ARGUMENT;
+    }
+    omp_set_default_device(device);
+  }
+
+  // Event-based kernels are only run as host thread loops when their target
+  // regions would fall back to the host anyway
+  if (n_devices > 0) settings::cpu_event_kernels = false;
+#endif
+  return 0;
+}
 
 int
 parse_command_line(int argc, char* argv[])
@@ -160,13 +230,606 @@ parse_command_line(int argc, char* argv[])
       } else if (arg == "--no-sort-device") {
         settings::sort_on_device = false;
 
+      } else if (arg == "--bucket-xs") {
+        settings::bucket_xs_queues = true;
+
+      } else if (arg == "--energy-grid") {
+        i += 1;
+        std::string grid {argv[i]};
+        if (grid == "log") {
+          settings::energy_grid_method = EnergyGridMethod::logarithm;
+        } else if (grid == "union") {
+          settings::energy_grid_method = EnergyGridMethod::unionized;
+        } else {
+          auto msg = fmt::format("Unrecognized energy grid method: {}.", grid);
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--faddeeva") {
+        i += 1;
+        std::string method {argv[i]};
+        if (method == "scalar") {
+          settings::faddeeva_method = FaddeevaMethod::scalar;
+        } else if (method == "humlicek8") {
+          settings::faddeeva_method = FaddeevaMethod::humlicek8;
+        } else if (method == "weideman16") {
+          settings::faddeeva_method = FaddeevaMethod::weideman16;
+        } else if (method == "weideman32") {
+          settings::faddeeva_method = FaddeevaMethod::weideman32;
+        } else {
+          auto msg = fmt::format("Unrecognized Faddeeva method: {}.", method);
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--union-grid-stride") {
+        i += 1;
+        settings::union_grid_stride = std::stoi(argv[i]);
+        if (settings::union_grid_stride < 1) {
+          std::string msg {"Union grid stride must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--pretabulate-temperatures") {
+        settings::pretabulate_temperatures = true;
+
+      } else if (arg == "--tms") {
+        settings::temperature_tms = true;
+
+      } else if (arg == "--device-xs-budget") {
+        i += 1;
+        settings::device_xs_budget = std::stod(argv[i]);
+        if (settings::device_xs_budget < 0.0) {
+          std::string msg {"Device XS budget must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--device") {
+        i += 1;
+        settings::device_id = std::stoi(argv[i]);
+        if (settings::device_id < 0) {
+          std::string msg {"Device number must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--bind-devices") {
+        settings::bind_devices = true;
+
+      } else if (arg == "--keep-device-data") {
+        settings::keep_device_data = true;
+
+      } else if (arg == "--prune-data") {
+        settings::prune_nuclear_data = true;
+
+      } else if (arg == "--shared-xs") {
+        settings::shared_xs = true;
+
+      } else if (arg == "--xs-cache") {
+        i += 1;
+        settings::path_xs_cache = argv[i];
+
+      } else if (arg == "--startup-profile") {
+        i += 1;
+        settings::path_startup_profile = argv[i];
+
+      } else if (arg == "--async-events") {
+        settings::async_event_kernels = true;
+
+      } else if (arg == "--split-collisions") {
+        settings::split_collisions = true;
+
+      } else if (arg == "--material-xs-queues") {
+        i += 1;
+        settings::n_material_xs_queues = std::stoi(argv[i]);
+        if (settings::n_material_xs_queues < 0) {
+          std::string msg {"Number of material XS queues must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--material-xs-tables") {
+        settings::material_xs_tables = true;
+
+      } else if (arg == "--material-xs-table-points") {
+        i += 1;
+        settings::material_xs_table_points = std::stoi(argv[i]);
+        if (settings::material_xs_table_points < 2) {
+          std::string msg {"Material XS tables need at least 2 points."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--material-xs-table-tol") {
+        i += 1;
+        settings::material_xs_table_tolerance = std::stod(argv[i]);
+        if (settings::material_xs_table_tolerance <= 0.0) {
+          std::string msg {"Material XS table tolerance must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--majorant-points") {
+        i += 1;
+        settings::majorant_points = std::stoi(argv[i]);
+        if (settings::majorant_points < 1) {
+          std::string msg {"The majorant XS needs at least 1 energy bin."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--device-volume") {
+        settings::device_volume_calc = true;
+
+      } else if (arg == "--device-find-cells") {
+        settings::device_find_cells = true;
+
+      } else if (arg == "--device-source") {
+        settings::device_source = true;
+
+      } else if (arg == "--async-bank") {
+        settings::async_bank_exchange = true;
+
+      } else if (arg == "--fission-matrix") {
+        settings::fission_matrix_on = true;
+
+      } else if (arg == "--local-generations") {
+        settings::local_generations = true;
+
+      } else if (arg == "--hybrid") {
+        settings::hybrid_transport = true;
+
+      } else if (arg == "--persistent-history") {
+        settings::persistent_history = true;
+
+      } else if (arg == "--interleave") {
+        i += 1;
+        settings::interleaved_histories = std::stoi(argv[i]);
+        if (settings::interleaved_histories < 1) {
+          std::string msg {"Number of interleaved histories must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--mg-alias") {
+        settings::mg_alias_sampling = true;
+
+      } else if (arg == "--balance-work") {
+        i += 1;
+        settings::max_work_ratio = std::stod(argv[i]);
+        if (settings::max_work_ratio < 1.0) {
+          std::string msg {"A process must be able to take at least an even "
+            "share of particles."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--source-block-sites") {
+        i += 1;
+        settings::source_block_sites = std::stoll(argv[i]);
+        if (settings::source_block_sites < 0) {
+          std::string msg {"Number of source file sites per block must be "
+            "non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--find-overlaps") {
+        settings::run_mode = RunMode::PLOTTING;
+        settings::find_overlaps = true;
+
+      } else if (arg == "--overlap-samples") {
+        i += 1;
+        settings::overlap_samples = std::stoll(argv[i]);
+        if (settings::overlap_samples < 1) {
+          std::string msg {"The overlap check needs at least 1 sample."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--overlap-limit") {
+        i += 1;
+        settings::overlap_limit = std::stoi(argv[i]);
+        if (settings::overlap_limit < 1) {
+          std::string msg {"The overlap check must record at least 1 overlap "
+            "per cell."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--device-overlaps") {
+        settings::device_overlaps = true;
+
+      } else if (arg == "--urr-fast-sampling") {
+        settings::urr_fast_sampling = true;
+
+      } else if (arg == "--secondary-pool-size") {
+        i += 1;
+        settings::secondary_pool_size = std::stoll(argv[i]);
+        if (settings::secondary_pool_size < 0) {
+          std::string msg {"Secondary particle pool size must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--fission-bank-margin") {
+        i += 1;
+        settings::fission_bank_margin = std::stod(argv[i]);
+        if (settings::fission_bank_margin < 0.0) {
+          std::string msg {"Fission bank margin must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--lost-check-interval") {
+        i += 1;
+        settings::lost_check_interval = std::stoi(argv[i]);
+        if (settings::lost_check_interval < 0) {
+          std::string msg {"Lost particle check interval must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--nu-bank-size") {
+        i += 1;
+        settings::nu_bank_size = std::stoi(argv[i]);
+        if (settings::nu_bank_size < 1) {
+          std::string msg {"Fission neutron bank size must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--max-split-growth") {
+        i += 1;
+        settings::max_split_growth = std::stod(argv[i]);
+        if (settings::max_split_growth < 0.0) {
+          std::string msg {"The split growth limit must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--device-arena") {
+        settings::device_arena = true;
+
+      } else if (arg == "--pinned-banks") {
+        settings::pinned_banks = true;
+
+      } else if (arg == "--device-fission-bank") {
+        settings::device_fission_bank = true;
+
+      } else if (arg == "--packed-bank") {
+        settings::packed_bank = true;
+
+      } else if (arg == "--surf-source-per-rank") {
+        settings::surf_source_per_rank = true;
+
+      } else if (arg == "--tally-replicas") {
+        i += 1;
+        settings::tally_replicas = std::stoi(argv[i]);
+        if (settings::tally_replicas < 0) {
+          std::string msg {"Number of tally replicas must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--defer-tally") {
+        i += 1;
+        settings::deferred_tally_scores = std::stoi(argv[i]);
+        if (settings::deferred_tally_scores < 0) {
+          std::string msg {"Number of deferred tally scores per particle must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--tally-replica-bins") {
+        i += 1;
+        settings::max_replicated_tally_bins = std::stoll(argv[i]);
+        if (settings::max_replicated_tally_bins < 0) {
+          std::string msg {"Maximum replicated tally bins must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--sparse-tallies") {
+        i += 1;
+        settings::sparse_tally_fraction = std::stod(argv[i]);
+        if (settings::sparse_tally_fraction < 0.0 ||
+            settings::sparse_tally_fraction > 1.0) {
+          std::string msg {"Sparse tally block fraction must be between 0 and 1."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--sparse-tally-bins") {
+        i += 1;
+        settings::min_sparse_tally_bins = std::stoll(argv[i]);
+        if (settings::min_sparse_tally_bins < 0) {
+          std::string msg {"Minimum sparse tally bins must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--device-tally-accumulate") {
+        settings::device_tally_accumulate = true;
+
+      } else if (arg == "--async-tally-reduce") {
+        settings::async_tally_reduction = true;
+
+      } else if (arg == "--tally-reduce-chunk") {
+        i += 1;
+        settings::tally_reduce_chunk = std::stoll(argv[i]);
+        if (settings::tally_reduce_chunk <= 0 ||
+            settings::tally_reduce_chunk > std::numeric_limits<int>::max()) {
+          std::string msg {"Tally reduction chunk size must be a positive int."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--tally-reduce-group") {
+        i += 1;
+        settings::tally_reduce_group = std::stoi(argv[i]);
+        if (settings::tally_reduce_group < 1) {
+          std::string msg {"Number of ranks per tally aggregator must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--distribute-tallies") {
+        i += 1;
+        settings::min_distributed_tally_bins = std::stoll(argv[i]);
+        if (settings::min_distributed_tally_bins < 0) {
+          std::string msg {"Number of bins of distributed tallies must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--tally-stats") {
+        settings::tally_stats = true;
+
+      } else if (arg == "--collapse-tallies") {
+        settings::collapse_tallies = true;
+
+      } else if (arg == "--async-statepoint") {
+        settings::async_statepoint = true;
+
+      } else if (arg == "--hdf5-compression") {
+        i += 1;
+        settings::hdf5_compression = std::stoi(argv[i]);
+        if (settings::hdf5_compression < 0 || settings::hdf5_compression > 9) {
+          std::string msg {"HDF5 compression level must be from 0 to 9."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--hdf5-chunk-size") {
+        i += 1;
+        settings::hdf5_chunk_size = std::stoll(argv[i]);
+        if (settings::hdf5_chunk_size <= 0) {
+          std::string msg {"HDF5 chunk size must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--checkpoint") {
+        i += 1;
+        settings::checkpoint_interval = std::stoi(argv[i]);
+        if (settings::checkpoint_interval < 1) {
+          std::string msg {"Number of batches between checkpoints must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--checkpoint-particles") {
+        i += 1;
+        settings::checkpoint_particles = std::stoll(argv[i]);
+        if (settings::checkpoint_particles < 1) {
+          std::string msg {"Number of particles between checkpoints must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--checkpoint-stop") {
+        i += 1;
+        settings::checkpoint_stop = std::stoi(argv[i]);
+        if (settings::checkpoint_stop < 1) {
+          std::string msg {"Number of checkpoints to stop after must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--track-buffer") {
+        i += 1;
+        settings::track_buffer_size = std::stoi(argv[i]);
+        if (settings::track_buffer_size < 1) {
+          std::string msg {"Track buffer size must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--event-trace") {
+        i += 1;
+        settings::event_trace_stride = std::stoi(argv[i]);
+        if (settings::event_trace_stride < 1) {
+          std::string msg {"Event trace stride must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--summary-format") {
+        i += 1;
+        std::string format {argv[i]};
+        if (format == "full") {
+          settings::summary_format = SummaryFormat::full;
+        } else if (format == "compact") {
+          settings::summary_format = SummaryFormat::compact;
+        } else if (format == "hash") {
+          settings::summary_format = SummaryFormat::hash;
+        } else {
+          auto msg = fmt::format("Unrecognized summary format: {}.", format);
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--kernel-profile") {
+        settings::kernel_profile = true;
+
+      } else if (arg == "--event-stats") {
+        settings::event_stats = true;
+
+      } else if (arg == "--event-stats-json") {
+        i += 1;
+        settings::path_event_stats = argv[i];
+
+      } else if (arg == "--region-costs") {
+        i += 1;
+        settings::path_region_costs = argv[i];
+
+      } else if (arg == "--region-cost-stride") {
+        i += 1;
+        settings::region_cost_stride = std::stoi(argv[i]);
+        if (settings::region_cost_stride < 1) {
+          std::string msg {"Region cost stride must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--status-file") {
+        i += 1;
+        settings::path_status = argv[i];
+
+      } else if (arg == "--xs-benchmark") {
+        i += 1;
+        settings::xs_benchmark_lookups = std::stoll(argv[i]);
+        if (settings::xs_benchmark_lookups <= 0) {
+          std::string msg {"Number of XS benchmark lookups must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--collision-benchmark") {
+        i += 1;
+        settings::collision_benchmark_samples = std::stoll(argv[i]);
+        if (settings::collision_benchmark_samples <= 0) {
+          std::string msg {"Number of collision benchmark samples must be "
+            "positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--particle-soa") {
+        settings::particle_soa = true;
+
+      } else if (arg == "--plane-cache") {
+        settings::plane_cache = true;
+
+      } else if (arg == "--fast-reflection") {
+        settings::fast_reflection = true;
+
+      } else if (arg == "--nuclide-cdf") {
+        settings::nuclide_cdf = true;
+
+      } else if (arg == "--inelastic-cdf") {
+        settings::inelastic_cdf = true;
+
+      } else if (arg == "--decoded-distributions") {
+        settings::decoded_distributions = true;
+
+      } else if (arg == "--fission-spectrum-table") {
+        settings::fission_spectrum_table = true;
+
+      } else if (arg == "--validate-fission-spectrum") {
+        settings::fission_spectrum_table = true;
+        settings::validate_fission_spectrum = true;
+
+      } else if (arg == "--compton-table") {
+        i += 1;
+        settings::compton_table_quantiles = std::stoi(argv[i]);
+        if (settings::compton_table_quantiles < 2) {
+          std::string msg {"Tabulated incoherent scattering needs at least 2 "
+            "quantiles."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--optimize-geometry") {
+        settings::optimize_geometry = true;
+
+      } else if (arg == "--wmp-batch") {
+        settings::wmp_batch_lookups = true;
+
+      } else if (arg == "--wmp-batch-items") {
+        i += 1;
+        settings::wmp_batch_items = std::stoi(argv[i]);
+        if (settings::wmp_batch_items < 1) {
+          std::string msg {"Number of batched multipole items must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--sort-advance-position") {
+        settings::sort_advance_position = true;
+
+      } else if (arg == "--sort-surface-position") {
+        settings::sort_surface_position = true;
+
+      } else if (arg == "--sort-full-items") {
+        settings::sort_key_index = false;
+
+      } else if (arg == "--sort-skip-fraction") {
+        i += 1;
+        settings::sort_skip_fraction = std::stod(argv[i]);
+        if (settings::sort_skip_fraction < 0.0 ||
+            settings::sort_skip_fraction > 1.0) {
+          std::string msg {"Sort skip fraction must be between 0 and 1."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--compact-threshold") {
+        i += 1;
+        settings::compact_threshold = std::stod(argv[i]);
+        if (settings::compact_threshold < 0.0 ||
+            settings::compact_threshold >= 1.0) {
+          std::string msg {"Compaction threshold must be at least 0 and "
+            "less than 1."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
       } else if (arg == "-m" || arg == "--minimum") {
         i += 1;
         settings::minimum_sort_items = std::stoll(argv[i]);
       
       } else if (arg == "-i" || arg == "--inflight") {
         i += 1;
-        settings::max_particles_in_flight = std::stoll(argv[i]);
+        if (std::string(argv[i]) == "auto") {
+          settings::auto_particles_in_flight = true;
+          settings::max_particles_in_flight = 1000000;
+        } else {
+          settings::max_particles_in_flight = std::stoll(argv[i]);
+        }
+
+      } else if (arg == "--device-memory") {
+        i += 1;
+        settings::device_memory = std::stod(argv[i]);
+        if (settings::device_memory < 0.0) {
+          std::string msg {"Device memory must be non-negative."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--device-memory-headroom") {
+        i += 1;
+        settings::device_memory_headroom = std::stod(argv[i]);
+        if (settings::device_memory_headroom < 0.0 ||
+            settings::device_memory_headroom >= 1.0) {
+          std::string msg {"Device memory headroom must be in [0, 1)."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
       
       } else if (arg == "-b" || arg == "--n-log-bins") {
         i += 1;
@@ -176,6 +839,54 @@ parse_command_line(int argc, char* argv[])
         i += 1;
         settings::fuel_lookup_bias = std::stod(argv[i]);
 
+      } else if (arg == "--auto-tune") {
+        settings::auto_tune = true;
+
+      } else if (arg == "--event-scheduler") {
+        i += 1;
+        std::string scheduler {argv[i]};
+        if (scheduler == "longest") {
+          settings::event_scheduler = EventScheduler::longest_queue;
+        } else if (scheduler == "cost") {
+          settings::event_scheduler = EventScheduler::cost_model;
+        } else {
+          auto msg = fmt::format("Unrecognized event scheduler: {}.", scheduler);
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
+      } else if (arg == "--aggregate-append") {
+        settings::aggregate_queue_appends = true;
+
+      } else if (arg == "--fuse-tally") {
+        settings::fuse_advance_tally = true;
+
+      } else if (arg == "--no-cpu-events") {
+        settings::cpu_event_kernels = false;
+
+      } else if (arg == "--tail-threshold") {
+        i += 1;
+        std::string threshold {argv[i]};
+        if (threshold == "auto") {
+          settings::event_tail_threshold = -1;
+        } else {
+          settings::event_tail_threshold = std::stoll(threshold);
+          if (settings::event_tail_threshold < 0) {
+            std::string msg {"Tail threshold must be non-negative or 'auto'."};
+            strcpy(openmc_err_msg, msg.c_str());
+            return OPENMC_E_INVALID_ARGUMENT;
+          }
+        }
+
+      } else if (arg == "--revival-period") {
+        i += 1;
+        settings::max_revival_period = std::stoi(argv[i]);
+        if (settings::max_revival_period < 1) {
+          std::string msg {"Revival period must be positive."};
+          strcpy(openmc_err_msg, msg.c_str());
+          return OPENMC_E_INVALID_ARGUMENT;
+        }
+
       } else if (arg == "-r" || arg == "--restart") {
         i += 1;
 
@@ -286,23 +997,52 @@ parse_command_line(int argc, char* argv[])
 
 void read_input_xml()
 {
+  begin_phase("Reading settings");
   read_settings_xml();
+  end_phase();
+  begin_phase("Reading cross section listing");
   read_cross_sections_xml();
+  end_phase();
+  simulation::time_read_materials.start();
+  begin_phase("Reading materials");
   read_materials_xml();
+  end_phase();
+  simulation::time_read_materials.stop();
+  simulation::time_read_geometry.start();
+  begin_phase("Reading geometry");
   read_geometry_xml();
+  end_phase();
+  simulation::time_read_geometry.stop();
 
   // Final geometry setup and assign temperatures
+  simulation::time_finalize_geometry.start();
+  begin_phase("Finalizing geometry");
   finalize_geometry();
+  end_phase();
+  simulation::time_finalize_geometry.stop();
 
   // Finalize cross sections having assigned temperatures
+  begin_phase("Reading cross sections");
   finalize_cross_sections();
+  end_phase();
 
+  simulation::time_read_tallies.start();
+  begin_phase("Reading tallies");
   read_tallies_xml();
+  end_phase();
+  simulation::time_read_tallies.stop();
 
   // Initialize distribcell_filters
+  simulation::time_distribcell.start();
+  begin_phase("Preparing distribcells");
   prepare_distribcell();
+  end_phase();
+  simulation::time_distribcell.stop();
+
+  if (settings::run_mode == RunMode::PLOTTING && settings::find_overlaps) {
+    // The overlap check samples the geometry alone and needs no plots
 
-  if (settings::run_mode == RunMode::PLOTTING) {
+  } else if (settings::run_mode == RunMode::PLOTTING) {
     // Read plots.xml if it exists
     read_plots_xml();
     if (mpi::master && settings::verbosity >= 5) print_plot();
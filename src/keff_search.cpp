@@ -0,0 +1,207 @@
+//! \file keff_search.cpp
+//! \brief Search for the value of a material density or cell temperature at
+//! which keff reaches a target, running every iterate in memory
+
+#include <algorithm> // for max
+#include <cmath>     // for abs, sqrt
+#include <cstring>   // for strcmp
+#include <string>
+
+#include <fmt/core.h>
+
+#include "openmc/capi.h"
+#include "openmc/cell.h"
+#include "openmc/error.h"
+#include "openmc/material.h"
+#include "openmc/message_passing.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+
+namespace openmc {
+
+namespace {
+
+//! Shannon entropy of the source over the active generations of an iterate
+struct EntropyBand {
+  double mean {0.0};
+  double std_dev {0.0};
+  bool valid {false};
+};
+
+//! Run one simulation of a search and return its combined keff. Iterates
+//! after the first start from the source the previous one converged to, and
+//! end their inactive batches as soon as the Shannon entropy of the source is
+//! back within two standard deviations of that of the previous active
+//! generations. The number of active batches is unchanged.
+//
+//! \param[inout] band Entropy of the previous iterate, replaced by this one's
+//! \param[out] k Combined keff and its standard deviation
+//! \return Error code
+int run_iterate(EntropyBand& band, double* k)
+{
+  int n_inactive = settings::n_inactive;
+  int n_batches = settings::n_batches;
+  int n_max_batches = settings::n_max_batches;
+  bool adapt = band.valid;
+
+  int err = openmc_simulation_init();
+  int status = 0;
+  while (status == 0 && err == 0) {
+    err = openmc_next_batch(&status);
+    if (err || !adapt || simulation::current_batch >= settings::n_inactive) {
+      continue;
+    }
+
+    int converged = 0;
+    if (mpi::master) {
+      double H = simulation::entropy.back();
+      converged = std::abs(H - band.mean) <= 2.0 * band.std_dev;
+    }
+#ifdef OPENMC_MPI
+    MPI_Bcast(&converged, 1, MPI_INT, 0, mpi::intracomm);
+#endif
+    if (converged) {
+      int n_skipped = settings::n_inactive - simulation::current_batch;
+      settings::n_inactive -= n_skipped;
+      settings::n_batches -= n_skipped;
+      settings::n_max_batches -= n_skipped;
+      adapt = false;
+    }
+  }
+
+  // Entropy of the active generations, which the next iterate is compared to
+  int first = settings::n_inactive * settings::gen_per_batch;
+  band.valid = settings::entropy_on &&
+    simulation::current_batch * settings::gen_per_batch - first >= 2;
+  if (band.valid && mpi::master) {
+    const auto& H = simulation::entropy;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    for (int i = first; i < H.size(); ++i) {
+      sum += H[i];
+      sum_sq += H[i] * H[i];
+    }
+    int n = H.size() - first;
+    band.mean = sum / n;
+    band.std_dev = std::sqrt(std::max(0.0, (sum_sq - n * band.mean *
+      band.mean) / (n - 1)));
+  }
+  if (settings::verbosity >= 6 && mpi::master &&
+      settings::n_inactive < n_inactive) {
+    write_message(fmt::format("Source converged after {} inactive batches",
+      settings::n_inactive), 6);
+  }
+
+  int err_finalize = openmc_simulation_finalize();
+  if (!err) err = err_finalize;
+  if (!err) err = openmc_get_keff(k);
+
+  settings::n_inactive = n_inactive;
+  settings::n_batches = n_batches;
+  settings::n_max_batches = n_max_batches;
+  return err;
+}
+
+} // namespace
+
+} // namespace openmc
+
+//==============================================================================
+// C API functions
+//==============================================================================
+
+using namespace openmc;
+
+//! \brief Search for the density of a material or the temperature of a cell
+//! at which keff reaches a target, by regula falsi with the Illinois
+//! modification over a bracketing interval. The simulations run in memory,
+//! each from the source the last one converged to.
+extern "C" int
+openmc_search_keff(const char* parameter, int32_t index, double lower,
+  double upper, double target, double tol, int max_iterations,
+  double* guesses, double* keffs, int* n_iterations)
+{
+  *n_iterations = 0;
+  bool density = std::strcmp(parameter, "density") == 0;
+  if (!density && std::strcmp(parameter, "temperature") != 0) {
+    set_errmsg(fmt::format("Cannot search over parameter '{}'; it must be "
+      "'density' or 'temperature'.", parameter));
+    return OPENMC_E_INVALID_ARGUMENT;
+  }
+  int32_t n = density ? model::materials_size : model::cells.size();
+  if (index < 0 || index >= n) {
+    set_errmsg(density ? "Index in materials array is out of bounds." :
+      "Index in cells array is out of bounds.");
+    return OPENMC_E_OUT_OF_BOUNDS;
+  }
+  if (settings::run_mode != RunMode::EIGENVALUE) {
+    set_errmsg("A keff search requires an eigenvalue calculation.");
+    return OPENMC_E_INVALID_ARGUMENT;
+  }
+  if (simulation::initialized) {
+    set_errmsg("A keff search cannot be started during a simulation.");
+    return OPENMC_E_ALLOCATE;
+  }
+  if (!(lower < upper) || max_iterations < 2 || tol <= 0.0) {
+    set_errmsg("A keff search needs a bracket with lower < upper, a positive "
+      "tolerance and at least two iterations.");
+    return OPENMC_E_INVALID_ARGUMENT;
+  }
+
+  // Set the parameter, run an iterate and record it
+  bool reuse_source = simulation::reuse_source;
+  EntropyBand band;
+  auto evaluate = [&](double x, double& f) {
+    int err = density ? openmc_material_set_density(index, x, "g/cm3") :
+      openmc_cell_set_temperature(index, x, nullptr, true);
+    if (err) return err;
+    double* k = keffs + 2 * (*n_iterations);
+    err = run_iterate(band, k);
+    if (err) return err;
+    guesses[*n_iterations] = x;
+    ++(*n_iterations);
+    simulation::reuse_source = true;
+    f = k[0] - target;
+    if (mpi::master) {
+      write_message(fmt::format("Search iteration {}: {} = {:.6e}, keff = "
+        "{:.5f} +/- {:.5f}", *n_iterations, parameter, x, k[0], k[1]), 5);
+    }
+    return 0;
+  };
+
+  double a = lower;
+  double b = upper;
+  double fa, fb;
+  int err = evaluate(a, fa);
+  if (!err) err = evaluate(b, fb);
+  if (!err && fa * fb > 0.0) {
+    set_errmsg(fmt::format("keff is {:.5f} and {:.5f} at the ends of the "
+      "bracket, which do not enclose the target {:.5f}.", fa + target,
+      fb + target, target));
+    err = OPENMC_E_INVALID_ARGUMENT;
+  }
+
+  // The end of the bracket that was kept twice in a row has its value halved,
+  // so that the bracket shrinks from both sides
+  int side = 0;
+  while (!err && std::abs(fa) > tol && std::abs(fb) > tol &&
+         *n_iterations < max_iterations) {
+    double c = (a * fb - b * fa) / (fb - fa);
+    double fc;
+    err = evaluate(c, fc);
+    if (err || std::abs(fc) <= tol) break;
+    if (fc * fb > 0.0) {
+      b = c;
+      fb = fc;
+      if (side == -1) fa /= 2.0;
+      side = -1;
+    } else {
+      a = c;
+      fa = fc;
+      if (side == 1) fb /= 2.0;
+      side = 1;
+    }
+  }
+  simulation::reuse_source = reuse_source;
+  return err;
+}
@@ -0,0 +1,363 @@
+#include "openmc/kernel_profile.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#ifdef OMPT_KERNEL_PROFILE
+#include <omp-tools.h>
+#endif
+
+#include "openmc/hdf5_interface.h"
+#include "openmc/settings.h"
+
+namespace openmc {
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+KernelProfile kernel_profiles[N_PROFILE_REGIONS];
+
+} // namespace simulation
+
+namespace {
+
+bool recording {false};
+
+// Region that device work launched now is attributed to. Kernels are launched
+// from the host thread running the event loop while OMPT callbacks may arrive
+// on runtime threads, hence the atomic.
+std::atomic<int> current_region {PROFILE_OTHER};
+
+#ifdef OMPT_KERNEL_PROFILE
+
+// The region of a kernel is carried to its trace record in the low bits of the
+// host operation ID assigned when it is submitted
+constexpr int REGION_BITS {8};
+
+std::mutex profile_mutex; // Guards simulation::kernel_profiles in callbacks
+std::atomic<uint64_t> n_host_ops {0};
+
+ompt_set_callback_t ompt_set_callback_fn {nullptr};
+
+// A device whose kernels are traced, with the entry points looked up for it
+struct TracedDevice {
+  ompt_device_t* device;
+  ompt_set_trace_ompt_t set_trace_ompt;
+  ompt_start_trace_t start_trace;
+  ompt_flush_trace_t flush_trace;
+  ompt_stop_trace_t stop_trace;
+  ompt_advance_buffer_cursor_t advance_buffer_cursor;
+  ompt_get_record_ompt_t get_record_ompt;
+  ompt_translate_time_t translate_time;
+  bool started {false};
+};
+
+std::vector<TracedDevice> devices;
+bool traced {false}; // Whether tracing started on any device
+
+constexpr size_t TRACE_BUFFER_BYTES {1 << 20};
+
+void on_buffer_request(int device_num, ompt_buffer_t** buffer, size_t* bytes)
+{
+  *bytes = TRACE_BUFFER_BYTES;
+  *buffer = new char[TRACE_BUFFER_BYTES];
+}
+
+void on_buffer_complete(int device_num, ompt_buffer_t* buffer, size_t bytes,
+  ompt_buffer_cursor_t begin, int buffer_owned)
+{
+  if (device_num >= 0 && device_num < devices.size() && bytes > 0) {
+    const auto& d = devices[device_num];
+    ompt_buffer_cursor_t cursor = begin;
+    std::lock_guard<std::mutex> lock {profile_mutex};
+    while (true) {
+      ompt_record_ompt_t* record = d.get_record_ompt(buffer, cursor);
+      if (!record) break;
+      if (record->type == ompt_callback_target_submit_emi ||
+          record->type == ompt_callback_target_submit) {
+        const auto& kernel = record->record.target_kernel;
+        int region = kernel.host_op_id & ((1 << REGION_BITS) - 1);
+        if (region < N_PROFILE_REGIONS) {
+          simulation::kernel_profiles[region].device_seconds +=
+            d.translate_time(d.device, kernel.end_time) -
+            d.translate_time(d.device, record->time);
+        }
+      }
+      if (d.advance_buffer_cursor(d.device, buffer, bytes, cursor, &cursor) ==
+          0) break;
+    }
+  }
+  if (buffer_owned) delete[] static_cast<char*>(buffer);
+}
+
+void on_device_initialize(int device_num, const char* type,
+  ompt_device_t* device, ompt_function_lookup_t lookup,
+  const char* documentation)
+{
+  if (!lookup) return;
+  TracedDevice d;
+  d.device = device;
+  d.set_trace_ompt = reinterpret_cast<ompt_set_trace_ompt_t>(
+    lookup("ompt_set_trace_ompt"));
+  d.start_trace = reinterpret_cast<ompt_start_trace_t>(
+    lookup("ompt_start_trace"));
+  d.flush_trace = reinterpret_cast<ompt_flush_trace_t>(
+    lookup("ompt_flush_trace"));
+  d.stop_trace = reinterpret_cast<ompt_stop_trace_t>(lookup("ompt_stop_trace"));
+  d.advance_buffer_cursor = reinterpret_cast<ompt_advance_buffer_cursor_t>(
+    lookup("ompt_advance_buffer_cursor"));
+  d.get_record_ompt = reinterpret_cast<ompt_get_record_ompt_t>(
+    lookup("ompt_get_record_ompt"));
+  d.translate_time = reinterpret_cast<ompt_translate_time_t>(
+    lookup("ompt_translate_time"));
+  if (!d.set_trace_ompt || !d.start_trace || !d.flush_trace ||
+      !d.stop_trace || !d.advance_buffer_cursor || !d.get_record_ompt ||
+      !d.translate_time) return;
+
+  if (devices.size() <= device_num) devices.resize(device_num + 1, {nullptr});
+  devices[device_num] = d;
+}
+
+void on_target_submit(ompt_scope_endpoint_t endpoint, ompt_data_t* target_data,
+  ompt_id_t* host_op_id, unsigned int requested_num_teams)
+{
+  if (!recording || endpoint != ompt_scope_begin) return;
+  int region = current_region.load();
+  *host_op_id = (++n_host_ops << REGION_BITS) | region;
+  std::lock_guard<std::mutex> lock {profile_mutex};
+  ++simulation::kernel_profiles[region].kernels;
+}
+
+void on_target_data_op(ompt_scope_endpoint_t endpoint,
+  ompt_data_t* target_task_data, ompt_data_t* target_data,
+  ompt_id_t* host_op_id, ompt_target_data_op_t optype, void* src_addr,
+  int src_device_num, void* dest_addr, int dest_device_num, size_t bytes,
+  const void* codeptr_ra)
+{
+  if (!recording || endpoint != ompt_scope_begin) return;
+  int region = current_region.load();
+  std::lock_guard<std::mutex> lock {profile_mutex};
+  auto& profile = simulation::kernel_profiles[region];
+  switch (optype) {
+  case ompt_target_data_transfer_to_device:
+  case ompt_target_data_transfer_to_device_async:
+    profile.bytes_to_device += bytes;
+    break;
+  case ompt_target_data_transfer_from_device:
+  case ompt_target_data_transfer_from_device_async:
+    profile.bytes_from_device += bytes;
+    break;
+  default:
+    break;
+  }
+}
+
+int initialize_tool(ompt_function_lookup_t lookup, int initial_device_num,
+  ompt_data_t* tool_data)
+{
+  ompt_set_callback_fn = reinterpret_cast<ompt_set_callback_t>(
+    lookup("ompt_set_callback"));
+  if (!ompt_set_callback_fn) return 0;
+  ompt_set_callback_fn(ompt_callback_device_initialize,
+    reinterpret_cast<ompt_callback_t>(&on_device_initialize));
+  ompt_set_callback_fn(ompt_callback_target_submit_emi,
+    reinterpret_cast<ompt_callback_t>(&on_target_submit));
+  ompt_set_callback_fn(ompt_callback_target_data_op_emi,
+    reinterpret_cast<ompt_callback_t>(&on_target_data_op));
+  return 1;
+}
+
+void finalize_tool(ompt_data_t* tool_data) {}
+
+#endif // OMPT_KERNEL_PROFILE
+
+} // namespace
+
+#ifdef OMPT_KERNEL_PROFILE
+
+// Entry point the OpenMP runtime looks up to find a tool
+extern "C" ompt_start_tool_result_t* ompt_start_tool(
+  unsigned int omp_version, const char* runtime_version)
+{
+  static ompt_start_tool_result_t result {&initialize_tool, &finalize_tool,
+    {0}};
+  return &result;
+}
+
+#endif
+
+//==============================================================================
+// ProfileRegion implementation
+//==============================================================================
+
+ProfileRegion::ProfileRegion(int region, int64_t n_items)
+  : region_ {recording ? region : -1}
+{
+  if (region_ < 0) return;
+  auto& profile = simulation::kernel_profiles[region_];
+  ++profile.launches;
+  profile.items += n_items;
+  previous_ = current_region.exchange(region_);
+  timer_.start();
+}
+
+ProfileRegion::~ProfileRegion()
+{
+  if (region_ < 0) return;
+  timer_.stop();
+  current_region.store(previous_);
+  if (!profile_uses_ompt()) {
+    simulation::kernel_profiles[region_].device_seconds += timer_.elapsed();
+  }
+}
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+const char* profile_region_name(int region)
+{
+  switch (region) {
+  case static_cast<int>(EventType::calculate_xs_fuel):
+    return "calculate_xs_fuel";
+  case static_cast<int>(EventType::calculate_xs_nonfuel):
+    return "calculate_xs_nonfuel";
+  case static_cast<int>(EventType::advance):
+    return "advance";
+  case static_cast<int>(EventType::surface_crossing):
+    return "surface_crossing";
+  case static_cast<int>(EventType::collision):
+    return "collision";
+  case static_cast<int>(EventType::revival):
+    return "revival";
+  case PROFILE_INIT:
+    return "initialize";
+  case PROFILE_DEATH:
+    return "death";
+  case PROFILE_TAIL:
+    return "tail";
+  default:
+    return "other";
+  }
+}
+
+bool profile_uses_ompt()
+{
+  #ifdef OMPT_KERNEL_PROFILE
+  return traced;
+  #else
+  return false;
+  #endif
+}
+
+void count_profile_launch(int region, int64_t n_items)
+{
+  if (!recording) return;
+  auto& profile = simulation::kernel_profiles[region];
+  ++profile.launches;
+  profile.items += n_items;
+}
+
+void start_kernel_profile()
+{
+  if (!settings::kernel_profile || !settings::event_based || recording) return;
+
+  #ifdef OMPT_KERNEL_PROFILE
+  for (auto& d : devices) {
+    if (!d.device || d.started) continue;
+    d.set_trace_ompt(d.device, 1, ompt_callback_target_submit_emi);
+    d.set_trace_ompt(d.device, 1, ompt_callback_target_submit);
+    d.started = d.start_trace(d.device, &on_buffer_request,
+      &on_buffer_complete);
+    traced = traced || d.started;
+  }
+  #endif
+  current_region.store(PROFILE_OTHER);
+  recording = true;
+}
+
+void flush_kernel_profile()
+{
+  #ifdef OMPT_KERNEL_PROFILE
+  for (auto& d : devices) {
+    if (d.started) d.flush_trace(d.device);
+  }
+  #endif
+}
+
+void stop_kernel_profile()
+{
+  if (!recording) return;
+
+  #ifdef OMPT_KERNEL_PROFILE
+  for (auto& d : devices) {
+    if (!d.started) continue;
+    d.flush_trace(d.device);
+    d.stop_trace(d.device);
+    d.started = false;
+  }
+  #endif
+  recording = false;
+}
+
+void reset_kernel_profiles()
+{
+  for (auto& profile : simulation::kernel_profiles) {
+    profile = {};
+  }
+}
+
+void print_kernel_profile()
+{
+  fmt::print(" Event kernel profile ({})\n", profile_uses_ompt() ?
+    "device time from OMPT tracing" : "device time from host timers");
+  fmt::print("   {:<22}{:>10}{:>14}{:>10}{:>13}{:>13}{:>12}{:>12}\n", "Region",
+    "Launches", "Items", "Kernels", "Device [s]", "Items/s", "MB to dev",
+    "MB from dev");
+  for (int i = 0; i < N_PROFILE_REGIONS; ++i) {
+    const auto& p = simulation::kernel_profiles[i];
+    if (p.launches == 0 && p.kernels == 0) continue;
+    double rate = p.device_seconds > 0.0 ? p.items / p.device_seconds : 0.0;
+    fmt::print("   {:<22}{:>10}{:>14}{:>10}{:>13.4e}{:>13.4e}{:>12.3f}{:>12.3f}\n",
+      profile_region_name(i), p.launches, p.items, p.kernels, p.device_seconds,
+      rate, p.bytes_to_device / 1.0e6, p.bytes_from_device / 1.0e6);
+  }
+}
+
+void write_kernel_profile(hid_t group)
+{
+  std::vector<std::string> names;
+  std::vector<int64_t> launches, items, kernels, to_device, from_device;
+  std::vector<double> seconds;
+  for (int i = 0; i < N_PROFILE_REGIONS; ++i) {
+    const auto& p = simulation::kernel_profiles[i];
+    names.push_back(profile_region_name(i));
+    launches.push_back(p.launches);
+    items.push_back(p.items);
+    kernels.push_back(p.kernels);
+    seconds.push_back(p.device_seconds);
+    to_device.push_back(p.bytes_to_device);
+    from_device.push_back(p.bytes_from_device);
+  }
+
+  hid_t kernels_group = create_group(group, "kernels");
+  write_attribute(kernels_group, "source",
+    profile_uses_ompt() ? "ompt" : "host timer");
+  write_dataset(kernels_group, "regions", names);
+  write_dataset(kernels_group, "launches", launches);
+  write_dataset(kernels_group, "items", items);
+  write_dataset(kernels_group, "kernels", kernels);
+  write_dataset(kernels_group, "device_seconds", seconds);
+  write_dataset(kernels_group, "bytes_to_device", to_device);
+  write_dataset(kernels_group, "bytes_from_device", from_device);
+  close_group(kernels_group);
+}
+
+} // namespace openmc
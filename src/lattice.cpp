@@ -499,6 +499,71 @@ const
 
 //==============================================================================
 
+std::pair<double, std::array<int, 3>>
+Lattice::RectLattice_run_distance(Position r, Direction u, const std::array<int, 3>& i_xyz)
+const
+{
+  // Convenience aliases
+  int nx {n_cells_[0]};
+  int ny {n_cells_[1]};
+  int n_axes = is_3d_ ? 3 : 2;
+
+  if (!RectLattice_are_valid_indices(i_xyz.data())) {
+    return RectLattice_distance(r, u, i_xyz);
+  }
+  int32_t univ = universes_[nx*ny*i_xyz[2] + nx*i_xyz[1] + i_xyz[0]];
+
+  // Find the tile the particle has actually moved into
+  std::array<int, 3> trans {0, 0, 0};
+  for (int i = 0; i < n_axes; ++i) {
+    trans[i] = std::floor((r[i] + 0.5 * pitch_[i]) / pitch_[i]);
+    r[i] -= trans[i] * pitch_[i];
+  }
+  int start[3] {i_xyz[0] + trans[0], i_xyz[1] + trans[1], i_xyz[2] + trans[2]};
+  if (!RectLattice_are_valid_indices(start) ||
+      universes_[nx*ny*start[2] + nx*start[1] + start[0]] != univ) {
+    return RectLattice_distance(r, u, {start[0], start[1], start[2]});
+  }
+
+  // Distance to the first crossing along each axis and between crossings
+  double t_max[3] {INFTY, INFTY, INFTY};
+  double t_delta[3] {INFTY, INFTY, INFTY};
+  for (int i = 0; i < n_axes; ++i) {
+    if (u[i] == 0) continue;
+    double edge {copysign(0.5 * pitch_[i], u[i])};
+    if (std::abs(r[i] - edge) <= FP_PRECISION) {
+      // The particle is on its oncoming edge, which RectLattice_distance()
+      // handles by ignoring that axis
+      auto result = RectLattice_distance(r, u, {start[0], start[1], start[2]});
+      for (int j = 0; j < 3; ++j) result.second[j] += trans[j];
+      return result;
+    }
+    t_max[i] = (edge - r[i]) / u[i];
+    t_delta[i] = pitch_[i] / std::abs(u[i]);
+  }
+
+  // Step through the tiles along the ray until the universe changes or the
+  // ray leaves the lattice. Ties go to x, then y, then z, like
+  // RectLattice_distance().
+  for (;;) {
+    int i = 0;
+    if (t_max[1] < t_max[i]) i = 1;
+    if (t_max[2] < t_max[i]) i = 2;
+    double d = t_max[i];
+    if (d == INFTY) return {d, trans};
+
+    trans[i] += (u[i] > 0) ? 1 : -1;
+    int next[3] {i_xyz[0] + trans[0], i_xyz[1] + trans[1], i_xyz[2] + trans[2]};
+    if (!RectLattice_are_valid_indices(next) ||
+        universes_[nx*ny*next[2] + nx*next[1] + next[0]] != univ) {
+      return {d, trans};
+    }
+    t_max[i] += t_delta[i];
+  }
+}
+
+//==============================================================================
+
 std::array<int, 3>
 Lattice::RectLattice_get_indices(Position r, Direction u) const
 {
@@ -917,7 +982,7 @@ Lattice::HexLattice_are_valid_indices(const int i_xyz[3]) const
 //==============================================================================
 
 std::pair<double, std::array<int, 3>>
-Lattice::HexLattice_distance(Position r, Direction u, const std::array<int, 3>& i_xyz)
+Lattice::HexLattice_distance_neighbors(Position r, Direction u, const std::array<int, 3>& i_xyz)
 const
 {
   // Short description of the direction vectors used here.  The beta, gamma, and
@@ -1059,7 +1124,7 @@ const
 //==============================================================================
 
 std::array<int, 3>
-Lattice::HexLattice_get_indices(Position r, Direction u) const
+Lattice::HexLattice_get_indices_candidates(Position r, Direction u) const
 {
   // Offset the xyz by the lattice center.
   Position r_o {r.x - center_.x, r.y - center_.y, r.z};
@@ -1154,6 +1219,170 @@ Lattice::HexLattice_get_indices(Position r, Direction u) const
   return {i1, i2, iz};
 }
 
+//==============================================================================
+// Fast hexagonal lattice kernels.
+//
+// Whatever the orientation, the center of tile (i1, i2) is at
+//   center + (i1 - n_rings + 1) * pitch * beta + (i2 - n_rings + 1) * pitch * delta
+// where beta, gamma and delta are the unit normals to the flat sides described
+// in HexLattice_distance_neighbors(), and crossing the side facing beta, gamma
+// or delta changes the indices by (1, 0), (1, -1) or (0, 1).
+//==============================================================================
+
+namespace {
+
+struct HexSides {
+  double nx[3]; //!< x component of the beta, gamma and delta normals
+  double ny[3]; //!< y component of the beta, gamma and delta normals
+};
+
+constexpr int HEX_SIDE_DI1[3] {1, 1, 0};
+constexpr int HEX_SIDE_DI2[3] {0, -1, 1};
+
+#pragma omp declare target
+inline HexSides hex_sides(bool y_orientation)
+{
+  const double s = std::sqrt(3.0) / 2.0;
+  if (y_orientation) {
+    return {{s, s, 0.0}, {0.5, -0.5, 1.0}};
+  } else {
+    return {{1.0, 0.5, 0.5}, {0.0, -s, s}};
+  }
+}
+#pragma omp end declare target
+
+} // namespace
+
+std::pair<double, std::array<int, 3>>
+Lattice::HexLattice_distance(Position r, Direction u, const std::array<int, 3>& i_xyz)
+const
+{
+  const HexSides sides {hex_sides(orientation_ == Orientation::y)};
+  const double p = pitch_[0];
+  const double x0 = center_.x + (i_xyz[0] - n_rings_ + 1) * p * sides.nx[0]
+                              + (i_xyz[1] - n_rings_ + 1) * p * sides.nx[2];
+  const double y0 = center_.y + (i_xyz[0] - n_rings_ + 1) * p * sides.ny[0]
+                              + (i_xyz[1] - n_rings_ + 1) * p * sides.ny[2];
+
+  // As in HexLattice_distance_neighbors(), the position is taken relative to
+  // the tile across each side so that neighboring tiles agree on where the
+  // side is.
+  double d {INFTY};
+  std::array<int, 3> lattice_trans {0, 0, 0};
+  for (int k = 0; k < 3; ++k) {
+    const double dir = sides.nx[k] * u.x + sides.ny[k] * u.y;
+    if (dir == 0) continue;
+    const int sign = (dir > 0) ? 1 : -1;
+    const double x_t = r.x - x0 - sign * (HEX_SIDE_DI1[k] * sides.nx[0]
+      + HEX_SIDE_DI2[k] * sides.nx[2]) * p;
+    const double y_t = r.y - y0 - sign * (HEX_SIDE_DI1[k] * sides.ny[0]
+      + HEX_SIDE_DI2[k] * sides.ny[2]) * p;
+    const double proj = sides.nx[k] * x_t + sides.ny[k] * y_t;
+    const double edge = -sign * 0.5 * p;
+    if (std::abs(proj - edge) > FP_PRECISION) {
+      const double this_d = (edge - proj) / dir;
+      if (this_d < d) {
+        d = this_d;
+        lattice_trans = {sign * HEX_SIDE_DI1[k], sign * HEX_SIDE_DI2[k], 0};
+      }
+    }
+  }
+
+  // Top and bottom sides
+  if (is_3d_) {
+    double z = r.z;
+    double z0 {copysign(0.5 * pitch_[1], u.z)};
+    if ((std::abs(z - z0) > FP_PRECISION) && u.z != 0) {
+      double this_d = (z0 - z) / u.z;
+      if (this_d < d) {
+        d = this_d;
+        lattice_trans = {0, 0, u.z > 0 ? 1 : -1};
+      }
+    }
+  }
+
+  return {d, lattice_trans};
+}
+
+//==============================================================================
+
+std::array<int, 3>
+Lattice::HexLattice_get_indices(Position r, Direction u) const
+{
+  // Offset the xyz by the lattice center.
+  Position r_o {r.x - center_.x, r.y - center_.y, r.z};
+  if (is_3d_) {r_o.z -= center_.z;}
+
+  // Index the z direction, accounting for coincidence
+  int iz = 0;
+  if (is_3d_) {
+    double iz_ {r_o.z / pitch_[1] + 0.5 * n_axial_};
+    long iz_close {std::lround(iz_)};
+    if (coincident(iz_, iz_close)) {
+      iz = (u.z > 0) ? iz_close : iz_close - 1;
+    } else {
+      iz = std::floor(iz_);
+    }
+  }
+
+  // Fractional coordinates of the position in the (beta, delta) basis
+  const double p = pitch_[0];
+  double a, b;
+  if (orientation_ == Orientation::y) {
+    a = 2.0 * r_o.x / (std::sqrt(3.0) * p);
+    b = r_o.y / p - 0.5 * a;
+  } else {
+    b = 2.0 * r_o.y / (std::sqrt(3.0) * p);
+    a = r_o.x / p - 0.5 * b;
+  }
+
+  // Round to the nearest tile center with cube coordinates (a, b, -a - b):
+  // the component that moved most when rounded is the one recomputed from the
+  // others.
+  double ra = std::round(a);
+  double rb = std::round(b);
+  double rc = std::round(-a - b);
+  double da = std::abs(ra - a);
+  double db = std::abs(rb - b);
+  double dc = std::abs(rc + a + b);
+  if (da > db && da > dc) {
+    ra = -rb - rc;
+  } else if (db > dc) {
+    rb = -ra - rc;
+  }
+  int i1 = static_cast<int>(ra);
+  int i2 = static_cast<int>(rb);
+
+  // COINCIDENCE CHECK
+  // If the position is on a side (or two, at a vertex) of the tile, pick the
+  // tile the particle is moving into, i.e. the one across the side whose
+  // normal is the most aligned with the direction, if any is aligned with it.
+  const HexSides sides {hex_sides(orientation_ == Orientation::y)};
+  const double x_t = r_o.x - (i1 * sides.nx[0] + i2 * sides.nx[2]) * p;
+  const double y_t = r_o.y - (i1 * sides.ny[0] + i2 * sides.ny[2]) * p;
+  int i1_chg {};
+  int i2_chg {};
+  double dp_max {0.0};
+  for (int k = 0; k < 3; ++k) {
+    const double proj = sides.nx[k] * x_t + sides.ny[k] * y_t;
+    if (!coincident(1.0, 2.0 * std::abs(proj) / p)) continue;
+    const int sign = (proj > 0) ? 1 : -1;
+    const double dp = sign * (sides.nx[k] * u.x + sides.ny[k] * u.y);
+    if (dp > dp_max) {
+      dp_max = dp;
+      i1_chg = sign * HEX_SIDE_DI1[k];
+      i2_chg = sign * HEX_SIDE_DI2[k];
+    }
+  }
+
+  // Add offset to indices (the center cell is (i1, i2) = (0, 0) but
+  // the array is offset so that the indices never go below 0).
+  i1 += i1_chg + n_rings_ - 1;
+  i2 += i2_chg + n_rings_ - 1;
+
+  return {i1, i2, iz};
+}
+
 //==============================================================================
 
 Position
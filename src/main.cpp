@@ -35,10 +35,22 @@ int main(int argc, char* argv[]) {
   switch (settings::run_mode) {
     case RunMode::FIXED_SOURCE:
     case RunMode::EIGENVALUE:
-      err = openmc_run();
+      if (settings::random_ray) {
+        err = openmc_random_ray();
+      } else if (settings::xs_benchmark_lookups > 0) {
+        err = openmc_xs_benchmark();
+      } else if (settings::collision_benchmark_samples > 0) {
+        err = openmc_collision_benchmark();
+      } else {
+        err = openmc_run();
+      }
       break;
     case RunMode::PLOTTING:
-      err = openmc_plot_geometry();
+      if (settings::find_overlaps) {
+        if (mpi::master) err = openmc_find_overlaps();
+      } else {
+        err = openmc_plot_geometry();
+      }
       break;
     case RunMode::PARTICLE:
       if (mpi::master) run_particle_restart();
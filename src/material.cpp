@@ -1,7 +1,9 @@
 #include "openmc/material.h"
 
-#include <algorithm> // for min, max, sort, fill
+#include <algorithm> // for min, max, sort, fill, equal
+#include <array>
 #include <cmath>
+#include <deque>
 #include <iterator>
 #include <string>
 #include <sstream>
@@ -12,9 +14,11 @@
 #include "xtensor/xview.hpp"
 
 #include "openmc/capi.h"
+#include "openmc/cell.h"
 #include "openmc/cross_sections.h"
 #include "openmc/container_util.h"
 #include "openmc/dagmc.h"
+#include "openmc/device_alloc.h"
 #include "openmc/error.h"
 #include "openmc/file_utils.h"
 #include "openmc/hdf5_interface.h"
@@ -26,6 +30,8 @@
 #include "openmc/search.h"
 #include "openmc/settings.h"
 #include "openmc/simulation.h"
+#include "openmc/startup_profile.h"
+#include "openmc/tallies/tally.h"
 #include "openmc/string_utils.h"
 #include "openmc/thermal.h"
 #include "openmc/xml_interface.h"
@@ -45,21 +51,52 @@ vector2d<int> materials_nuclide;
 vector2d<int> materials_element;
 vector2d<double> materials_atom_density;
 vector2d<int> materials_p0;
-vector2d<int> materials_mat_nuclide_index;
+vector2d<int> materials_xs_features;
+vector2d<uint32_t> materials_nuclide_bitmap;
 vector2d<ThermalTable> materials_thermal_tables;
 
+vector<double> material_xs_table;
+vector<uint8_t> material_xs_table_valid;
+double* device_material_xs_table {nullptr};
+uint8_t* device_material_xs_table_valid {nullptr};
+int material_xs_table_size {0};
+double material_xs_table_log_E_min {0.0};
+double material_xs_table_inv_du {0.0};
+
+vector<double> majorant;
+double* device_majorant {nullptr};
+int majorant_size {0};
+double majorant_log_E_min {0.0};
+double majorant_inv_du {0.0};
+
+vector<double> tms_majorant;
+double* device_tms_majorant {nullptr};
+int tms_majorant_bins {0};
+
 } // namespace model
 
 //==============================================================================
 // Material implementation
 //==============================================================================
 
-Material::Material(pugi::xml_node node)
+namespace {
+
+// Tracks the index of the next material constructed in the model::materials
+// array
+uint64_t unique_index = 0;
+
+//! Prefetch the cache line holding an address, if the compiler can
+inline void prefetch(const void* ptr)
 {
-  // Declare a static variable to track this material's index in
-  // the model::materials array
-  static uint64_t unique_index = 0;
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(ptr);
+#endif
+}
+
+} // namespace
 
+Material::Material(pugi::xml_node node)
+{
   index_ = unique_index++; // Avoids warning about narrowing
 
   if (check_for_node(node, "id")) {
@@ -76,39 +113,17 @@ Material::Material(pugi::xml_node node)
     depletable_ = get_node_value_bool(node, "depletable");
   }
 
-  bool sum_density {false};
   pugi::xml_node density_node = node.child("density");
   std::string units;
+  bool sum_density {false};
   if (density_node) {
     units = get_node_value(density_node, "units");
-    if (units == "sum") {
-      sum_density = true;
-    } else if (units == "macro") {
-      if (check_for_node(density_node, "value")) {
-        density_ = std::stod(get_node_value(density_node, "value"));
-      } else {
-        density_ = 1.0;
-      }
-    } else {
-      double val = std::stod(get_node_value(density_node, "value"));
-      if (val <= 0.0) {
-        fatal_error("Need to specify a positive density on material "
-          + std::to_string(id_) + ".");
-      }
-
-      if (units == "g/cc" || units == "g/cm3") {
-        density_ = -val;
-      } else if (units == "kg/m3") {
-        density_ = -1.0e-3 * val;
-      } else if (units == "atom/b-cm") {
-        density_ = val;
-      } else if (units == "atom/cc" || units == "atom/cm3") {
-        density_ = 1.0e-24 * val;
-      } else {
-        fatal_error("Unknown units '" + units + "' specified on material "
-          + std::to_string(id_) + ".");
-      }
+    double val = 1.0;
+    if (units != "sum" && (units != "macro" ||
+        check_for_node(density_node, "value"))) {
+      val = std::stod(get_node_value(density_node, "value"));
     }
+    sum_density = set_density(units, val);
   } else {
     fatal_error("Must specify <density> element in material "
       + std::to_string(id_) + ".");
@@ -210,9 +225,110 @@ Material::Material(pugi::xml_node node)
     iso_lab = get_node_array<std::string>(node, "isotropic");
   }
 
-  // ========================================================================
-  // COPY NUCLIDES TO ARRAYS IN MATERIAL
+  set_composition(names, densities, iso_lab, sum_density);
 
+  if (check_for_node(node, "temperature")) {
+    temperature_ = std::stod(get_node_value(node, "temperature"));
+  }
+
+  if (check_for_node(node, "volume")) {
+    volume_ = std::stod(get_node_value(node, "volume"));
+  }
+
+  // =======================================================================
+  // READ AND PARSE <sab> TAG FOR THERMAL SCATTERING DATA
+  if (settings::run_CE) {
+    // Loop over <sab> elements
+
+    std::vector<std::string> sab_names;
+    for (auto node_sab : node.children("sab")) {
+      // Determine name of thermal scattering table
+      if (!check_for_node(node_sab, "name")) {
+        fatal_error("Need to specify <name> for thermal scattering table.");
+      }
+      std::string name = get_node_value(node_sab, "name");
+      sab_names.push_back(name);
+
+      // Read the fraction of nuclei affected by this thermal scattering table
+      double fraction = 1.0;
+      if (check_for_node(node_sab, "fraction")) {
+        fraction = std::stod(get_node_value(node_sab, "fraction"));
+      }
+      add_thermal_table(name, fraction);
+    }
+  }
+}
+
+Material::Material(int32_t id, const std::string& name, bool depletable,
+  const std::string& units, double density,
+  const std::vector<std::string>& nuclides,
+  const std::vector<double>& fractions,
+  const std::vector<std::string>& isotropic,
+  const std::vector<std::string>& sab_names,
+  const std::vector<double>& sab_fractions, double temperature, double volume)
+  : name_(name), volume_(volume), depletable_(depletable),
+    temperature_(temperature)
+{
+  index_ = unique_index++; // Avoids warning about narrowing
+  this->set_id(id);
+
+  bool sum_density = set_density(units, density);
+
+  if (nuclides.empty()) {
+    fatal_error("No macroscopic data or nuclides specified on material "
+      + std::to_string(id_));
+  }
+
+  // Macroscopic data is written as the only nuclide of its material, with
+  // the density of the material
+  std::vector<double> densities = fractions;
+  if (units == "macro") {
+    if (settings::run_CE) {
+      fatal_error("Macroscopic can not be used in continuous-energy mode.");
+    }
+    std::fill(densities.begin(), densities.end(), density_);
+  }
+  set_composition(nuclides, densities, isotropic, sum_density);
+
+  if (settings::run_CE) {
+    for (int i = 0; i < sab_names.size(); ++i) {
+      add_thermal_table(sab_names[i], sab_fractions[i]);
+    }
+  }
+}
+
+bool Material::set_density(const std::string& units, double val)
+{
+  if (units == "sum") return true;
+  if (units == "macro") {
+    density_ = val;
+    return false;
+  }
+
+  if (val <= 0.0) {
+    fatal_error("Need to specify a positive density on material "
+      + std::to_string(id_) + ".");
+  }
+
+  if (units == "g/cc" || units == "g/cm3") {
+    density_ = -val;
+  } else if (units == "kg/m3") {
+    density_ = -1.0e-3 * val;
+  } else if (units == "atom/b-cm") {
+    density_ = val;
+  } else if (units == "atom/cc" || units == "atom/cm3") {
+    density_ = 1.0e-24 * val;
+  } else {
+    fatal_error("Unknown units '" + units + "' specified on material "
+      + std::to_string(id_) + ".");
+  }
+  return false;
+}
+
+void Material::set_composition(const std::vector<std::string>& names,
+  const std::vector<double>& densities,
+  const std::vector<std::string>& iso_lab, bool sum_density)
+{
   // allocate arrays in Material object
   auto n = names.size();
   nuclide_.reserve(n);
@@ -291,60 +407,32 @@ Material::Material(pugi::xml_node node)
 
   // Determine density if it is a sum value
   if (sum_density) density_ = xt::sum(atom_density_)();
+}
 
-
-  if (check_for_node(node, "temperature")) {
-    temperature_ = std::stod(get_node_value(node, "temperature"));
-  }
-
-  if (check_for_node(node, "volume")) {
-    volume_ = std::stod(get_node_value(node, "volume"));
+void Material::add_thermal_table(const std::string& name, double fraction)
+{
+  // Check that the thermal scattering table is listed in the
+  // cross_sections.xml file
+  LibraryKey key {Library::Type::thermal, name};
+  if (data::library_map.find(key) == data::library_map.end()) {
+    fatal_error("Could not find thermal scattering data " + name +
+      " in cross_sections.xml file.");
+  }
+
+  // Determine index of thermal scattering data in global
+  // data::thermal_scatt array
+  int index_table;
+  if (data::thermal_scatt_map.find(name) == data::thermal_scatt_map.end()) {
+    index_table = data::thermal_scatt_map.size();
+    data::thermal_scatt_map[name] = index_table;
+  } else {
+    index_table = data::thermal_scatt_map[name];
   }
 
-  // =======================================================================
-  // READ AND PARSE <sab> TAG FOR THERMAL SCATTERING DATA
-  if (settings::run_CE) {
-    // Loop over <sab> elements
-
-    std::vector<std::string> sab_names;
-    for (auto node_sab : node.children("sab")) {
-      // Determine name of thermal scattering table
-      if (!check_for_node(node_sab, "name")) {
-        fatal_error("Need to specify <name> for thermal scattering table.");
-      }
-      std::string name = get_node_value(node_sab, "name");
-      sab_names.push_back(name);
-
-      // Read the fraction of nuclei affected by this thermal scattering table
-      double fraction = 1.0;
-      if (check_for_node(node_sab, "fraction")) {
-        fraction = std::stod(get_node_value(node_sab, "fraction"));
-      }
-
-      // Check that the thermal scattering table is listed in the
-      // cross_sections.xml file
-      LibraryKey key {Library::Type::thermal, name};
-      if (data::library_map.find(key) == data::library_map.end()) {
-        fatal_error("Could not find thermal scattering data " + name +
-          " in cross_sections.xml file.");
-      }
-
-      // Determine index of thermal scattering data in global
-      // data::thermal_scatt array
-      int index_table;
-      if (data::thermal_scatt_map.find(name) == data::thermal_scatt_map.end()) {
-        index_table = data::thermal_scatt_map.size();
-        data::thermal_scatt_map[name] = index_table;
-      } else {
-        index_table = data::thermal_scatt_map[name];
-      }
-
-      // Add entry to thermal tables vector. For now, we put the nuclide index
-      // as zero since we don't know which nuclides the table is being applied
-      // to yet (this is assigned in init_thermal)
-      thermal_tables_.push_back({index_table, 0, fraction});
-    }
-  }
+  // Add entry to thermal tables vector. For now, we put the nuclide index
+  // as zero since we don't know which nuclides the table is being applied
+  // to yet (this is assigned in init_thermal)
+  thermal_tables_.push_back({index_table, 0, fraction});
 }
 
 Material::~Material()
@@ -749,12 +837,56 @@ void Material::init_nuclide_index()
 {
   int n = settings::run_CE ?
     data::nuclides_size : data::mg.nuclides_.size();
-  mat_nuclide_index_.resize(n);
-  std::fill(mat_nuclide_index_.begin(), mat_nuclide_index_.end(), C_NONE);
+  nuclide_bitmap_.resize((n + 31) / 32);
+  std::fill(nuclide_bitmap_.begin(), nuclide_bitmap_.end(), 0u);
+  for (int i_nuclide : nuclide_) {
+    nuclide_bitmap_[i_nuclide / 32] |= 1u << (i_nuclide % 32);
+  }
+}
+
+void Material::init_xs_features()
+{
+  xs_features_.assign(nuclide_.size(), XS_ALL);
+  if (!settings::run_CE) return;
+
   for (int i = 0; i < nuclide_.size(); ++i) {
-    mat_nuclide_index_[nuclide_[i]] = i;
+    const auto& nuc {data::nuclides[nuclide_[i]]};
+    int features = 0;
+    if (nuc.kTs_.size() > 1) features |= XS_TEMPERATURES;
+    if (nuc.multipole()) features |= XS_MULTIPOLE;
+    if (settings::urr_ptables_on && nuc.urr_present_) features |= XS_URR;
+    for (const auto& sab : thermal_tables_) {
+      if (sab.index_nuclide == nuc.index_) features |= XS_SAB;
+    }
+    xs_features_[i] = features;
+  }
+}
+
+namespace {
+
+//! Look up the microscopic XS of a nuclide with the variant of
+//! Nuclide::calculate_xs() compiled for the fewest features that covers the
+//! nuclide's. Fresh structural and coolant materials at one temperature
+//! mostly take the variants without temperature, multipole or URR branches.
+#pragma omp declare target
+template <typename T>
+T calculate_nuclide_xs(Nuclide& nuc, int features, int i_grid, Particle& p,
+  double* reaction, double E, double sqrtkT)
+{
+  switch (features) {
+  case 0:
+    return nuc.calculate_xs<T, 0>(i_grid, p, reaction, E, sqrtkT);
+  case XS_URR:
+    return nuc.calculate_xs<T, XS_URR>(i_grid, p, reaction, E, sqrtkT);
+  case XS_SAB:
+    return nuc.calculate_xs<T, XS_SAB>(i_grid, p, reaction, E, sqrtkT);
+  default:
+    return nuc.calculate_xs<T, XS_ALL>(i_grid, p, reaction, E, sqrtkT);
   }
 }
+#pragma omp end declare target
+
+} // namespace
 
 void Material::calculate_xs(Particle& p, bool need_depletion_rx) const
 {
@@ -770,53 +902,156 @@ void Material::calculate_neutron_xs(Particle& p, bool need_depletion_rx) const
   double E = p.E_;
   double sqrtkT = p.sqrtkT_;
 
-  // Find energy index on energy grid
-  int neutron = static_cast<int>(Particle::Type::neutron);
-  int i_grid = std::log(E/data::energy_min[neutron])/simulation::log_spacing;
-
-  // Local macro XS accumulator
-  MacroXS macro = {};
+  // Materials with a macroscopic XS table replace the loop over nuclides with
+  // a single interpolation, provided the table was built at this temperature.
+  // Depletion reaction rates are not tabulated.
+  if (xs_table_offset_ != C_NONE && !need_depletion_rx &&
+      sqrtkT == xs_table_sqrtkT_) {
+    if (this->lookup_xs_table(p)) return;
+  }
 
-  // Add contribution from each nuclide in material
-  for (int i = 0; i < nuclide_.size(); ++i) {
+  // Find energy index on energy grid
+  int i_grid = energy_grid_search_index(E);
+
+  // Local macro XS accumulators. These are kept as scalars and a plain array
+  // (rather than a MacroXS) so that they can be reduced across SIMD lanes.
+  double total = 0.0;
+  double absorption = 0.0;
+  double fission = 0.0;
+  double nu_fission = 0.0;
+  int n_rx = need_depletion_rx ? simulation::n_depletion_rx : 0;
+  double reaction[MAX_DEPLETION_RX];
+  for (int r = 0; r < n_rx; r++) reaction[r] = 0.0;
+
+  // Add contribution from each nuclide in material. Iterations are independent
+  // (each one reads only its own nuclide's data and writes only its own micro
+  // XS cache entry), so with SIMD_NUCLIDE_LOOP the loop is vectorized across
+  // nuclides, with the lookups of several nuclides evaluated in lockstep.
+  int n_nuclides = nuclide_.size();
+  double* cdf = p.nuclide_cdf_;
+  #ifdef SIMD_NUCLIDE_LOOP
+  #pragma omp simd reduction(+:total, absorption, fission, nu_fission) \
+    reduction(+:reaction[:MAX_DEPLETION_RX])
+  #endif
+  for (int i = 0; i < n_nuclides; ++i) {
 
     // Determine microscopic cross sections for this nuclide
     int i_nuclide = nuclide(i);
 
     #ifndef NO_MICRO_XS_CACHE
-    NuclideMicroXS nuclide_micro = data::nuclides[i_nuclide].calculate_xs<NuclideMicroXS>(i_grid, p, need_depletion_rx, E, sqrtkT);
+    double* micro_rx = n_rx > 0 ? p.micro_rx(i_nuclide) : nullptr;
+    NuclideMicroXS nuclide_micro = calculate_nuclide_xs<NuclideMicroXS>(
+      data::nuclides[i_nuclide], xs_features(i), i_grid, p, micro_rx, E, sqrtkT);
+    p.neutron_xs_[i_nuclide] = nuclide_micro;
     #else
-    MicroXS nuclide_micro = data::nuclides[i_nuclide].calculate_xs<MicroXS>(i_grid, p, need_depletion_rx, E, sqrtkT);
+    double micro_rx_local[MAX_DEPLETION_RX];
+    double* micro_rx = n_rx > 0 ? micro_rx_local : nullptr;
+    MicroXS nuclide_micro = calculate_nuclide_xs<MicroXS>(
+      data::nuclides[i_nuclide], xs_features(i), i_grid, p, micro_rx, E, sqrtkT);
     #endif
 
     // Get atom density of nuclide in material
     double atom_density = this->atom_density(i);
     
-    // Accumulate this nuclide's contribution to the local macro XS variable
-    macro.total      += atom_density * nuclide_micro.total;
-    macro.absorption += atom_density * nuclide_micro.absorption;
-    macro.fission    += atom_density * nuclide_micro.fission;
-    macro.nu_fission += atom_density * nuclide_micro.nu_fission;
-
-    if (need_depletion_rx) {
-      for (int r = 0; r < DEPLETION_RX_SIZE; r++) {
-        macro.reaction[r] += atom_density * nuclide_micro.reaction[r];
-      }
+    // Accumulate this nuclide's contribution to the local macro XS variables
+    total      += atom_density * nuclide_micro.total;
+    absorption += atom_density * nuclide_micro.absorption;
+    fission    += atom_density * nuclide_micro.fission;
+    nu_fission += atom_density * nuclide_micro.nu_fission;
+    if (cdf) cdf[i] = atom_density * nuclide_micro.total;
+
+    for (int r = 0; r < n_rx; r++) {
+      reaction[r] += atom_density * micro_rx[r];
     }
   }
 
+  // Turn the nuclide XS into the running sum searched by sample_nuclide().
+  // This is a separate pass so that the loop above stays free of a
+  // loop-carried dependence.
+  if (cdf) {
+    double sum = 0.0;
+    for (int i = 0; i < n_nuclides; ++i) {
+      sum += cdf[i];
+      cdf[i] = sum;
+    }
+    p.nuclide_cdf_material_ = index_;
+    p.nuclide_cdf_E_ = E;
+    p.nuclide_cdf_sqrtkT_ = sqrtkT;
+  }
+
   // Store accumulated macro XS to particle
-  p.macro_xs_.total      = macro.total;
-  p.macro_xs_.absorption = macro.absorption;
-  p.macro_xs_.fission    = macro.fission;
-  p.macro_xs_.nu_fission = macro.nu_fission;
-  if (need_depletion_rx) {
-    for (int r = 0; r < DEPLETION_RX_SIZE; r++) {
-      p.macro_xs_.reaction[r] = macro.reaction[r];
+  p.macro_xs_.total      = total;
+  p.macro_xs_.absorption = absorption;
+  p.macro_xs_.fission    = fission;
+  p.macro_xs_.nu_fission = nu_fission;
+  double* macro_rx = p.macro_rx();
+  for (int r = 0; r < n_rx; r++) {
+    macro_rx[r] = reaction[r];
+  }
+}
+
+void Material::prefetch_xs(double E, bool grid) const
+{
+  if (has_xs_table() ||
+      settings::energy_grid_method != EnergyGridMethod::logarithm) return;
+  int i_log_union = energy_grid_search_index(E);
+  if (i_log_union < 0 || i_log_union >= settings::n_log_bins) return;
+
+  int n_nuclides = nuclide_.size();
+  for (int i = 0; i < n_nuclides; ++i) {
+    const auto& nuc = data::nuclides[nuclide(i)];
+    if (nuc.kTs_.size() != 1) continue;
+    const int* grid_index = &nuc.flat_grid_index_[i_log_union];
+    if (!grid) {
+      prefetch(grid_index);
+    } else {
+      int i_grid = *grid_index;
+      prefetch(&nuc.flat_grid_energy_[i_grid]);
+      prefetch(&nuc.flat_xs_[5 * static_cast<int64_t>(i_grid)]);
     }
   }
 }
 
+double Material::tms_majorant_xs(double E) const
+{
+  if (E <= tms_energy_min_) return 0.0;
+  int bin = majorant_bin(E, model::tms_majorant_bins);
+  if (bin < 0) return 0.0;
+
+  // The material is only sampled where all of its nuclides are bounded
+  double majorant = 0.0;
+  int n_nuclides = nuclide_.size();
+  for (int i = 0; i < n_nuclides; ++i) {
+    double xs = model::device_tms_majorant[nuclide(i) *
+      model::tms_majorant_bins + bin];
+    if (xs == 0.0) return 0.0;
+    majorant += atom_density(i) * xs;
+  }
+  return majorant;
+}
+
+bool Material::lookup_xs_table(Particle& p) const
+{
+  // Locate the energy on the table's log-uniform grid
+  double u = (std::log(p.E_) - model::material_xs_table_log_E_min) *
+    model::material_xs_table_inv_du;
+  if (u < 0.0 || u >= settings::material_xs_table_points - 1) return false;
+  int i = static_cast<int>(u);
+  double f = u - i;
+
+  // Bins that could not be interpolated to within tolerance (e.g., resolved
+  // resonances or the unresolved range) fall back to a direct lookup
+  int i_point = xs_table_offset_ + i;
+  if (!model::device_material_xs_table_valid[i_point]) return false;
+
+  const double* xs = &model::device_material_xs_table[2*i_point];
+  p.macro_xs_.total      = xs[0] + f * (xs[2] - xs[0]);
+  p.macro_xs_.absorption = xs[1] + f * (xs[3] - xs[1]);
+  p.macro_xs_.fission    = 0.0;
+  p.macro_xs_.nu_fission = 0.0;
+  return true;
+}
+
 void Material::calculate_photon_xs(Particle& p) const
 {
   p.macro_xs_.total = 0.0;
@@ -891,6 +1126,7 @@ void Material::set_density(double density, gsl::cstring_span units)
   if (nuclide_.empty()) {
     throw std::runtime_error{"No nuclides exist in material yet."};
   }
+  mark_material_changed(index_, false);
 
   if (units == "atom/b-cm") {
     // Set total density based on value provided
@@ -932,6 +1168,30 @@ void Material::set_densities(const std::vector<std::string>& name,
   Expects(n > 0);
   Expects(n == density.size());
 
+  vector<int> nuclide(n);
+  for (gsl::index i = 0; i < n; ++i) {
+    const auto& nuc {name[i]};
+    if (data::nuclide_map.find(nuc) == data::nuclide_map.end()) {
+      int err = openmc_load_nuclide(nuc.c_str(), nullptr, 0);
+      if (err < 0) throw std::runtime_error{openmc_err_msg};
+    }
+    nuclide[i] = data::nuclide_map.at(nuc);
+  }
+  this->set_densities(nuclide, density);
+}
+
+void Material::set_densities(gsl::span<const int> nuclide,
+  gsl::span<const double> density)
+{
+  auto n = nuclide.size();
+  Expects(n > 0);
+  Expects(n == density.size());
+
+  if (!std::equal(nuclide.begin(), nuclide.end(), nuclide_.begin(),
+      nuclide_.end())) {
+    mark_material_changed(index_, true);
+  }
+
   if (n != nuclide_.size()) {
     nuclide_.resize(n);
     atom_density_ = xt::zeros<double>({n});
@@ -940,19 +1200,13 @@ void Material::set_densities(const std::vector<std::string>& name,
 
   double sum_density = 0.0;
   for (gsl::index i = 0; i < n; ++i) {
-    const auto& nuc {name[i]};
-    if (data::nuclide_map.find(nuc) == data::nuclide_map.end()) {
-      int err = openmc_load_nuclide(nuc.c_str(), nullptr, 0);
-      if (err < 0) throw std::runtime_error{openmc_err_msg};
-    }
-
-    nuclide_[i] = data::nuclide_map.at(nuc);
+    nuclide_[i] = nuclide[i];
     Expects(density[i] > 0.0);
     atom_density_(i) = density[i];
     sum_density += density[i];
 
     if (settings::photon_transport) {
-      auto element_name = to_element(nuc);
+      auto element_name = to_element(data::nuclides[nuclide[i]].name_);
       element_[i] = data::element_map.at(element_name);
     }
   }
@@ -1070,11 +1324,13 @@ void Material::add_nuclide(const std::string& name, double density)
       density_gpcc_ += (density - atom_density_(i))
         * awr * MASS_NEUTRON / N_AVOGADRO;
       atom_density_(i) = density;
+      mark_material_changed(index_, false);
       return;
     }
   }
 
   // If nuclide wasn't found, extend nuclide/density arrays
+  mark_material_changed(index_, true);
   int err = openmc_load_nuclide(name.c_str(), nullptr, 0);
   if (err < 0) throw std::runtime_error{openmc_err_msg};
 
@@ -1101,20 +1357,376 @@ void Material::add_nuclide(const std::string& name, double density)
     * MASS_NEUTRON / N_AVOGADRO;
 }
 
-void Material::copy_to_device()
+bool Material::xs_table_eligible(double& sqrtkT) const
 {
-  ttb_.copy_to_device();
+  // Fission sites are sampled from per-nuclide data, so fissionable materials
+  // (which also tend to have the most nuclides) are never tabulated
+  if (fissionable_) return false;
+
+  // Sampling between bracketing temperatures uses random numbers, so the XS
+  // is only a function of energy if there is a single temperature to pick
+  // (pretabulated nuclides always pick their exact model temperature)
+  if (settings::temperature_method == TemperatureMethod::INTERPOLATION) {
+    for (int i_nuc : nuclide_) {
+      const auto& nuc = data::nuclides[i_nuc];
+      if (!nuc.pretabulated_ && nuc.kTs_.size() > 1) return false;
+    }
+    for (const auto& table : thermal_tables_) {
+      if (data::thermal_scatt[table.index_table].kTs_.size() > 1) return false;
+    }
+  }
+
+  // The table is built at one temperature, so every cell instance filled with
+  // this material must be at the same temperature
+  bool found = false;
+  for (const auto& c : model::cells) {
+    if (std::find(c.material_.begin(), c.material_.end(), index_) ==
+        c.material_.end()) continue;
+    for (double s : c.sqrtkT_) {
+      if (!found) {
+        sqrtkT = s;
+        found = true;
+      } else if (s != sqrtkT) {
+        return false;
+      }
+    }
+  }
+  return found;
 }
 
-void Material::release_from_device()
+void Material::init_xs_table(double sqrtkT)
 {
-  ttb_.release_from_device();
+  int n_points = settings::material_xs_table_points;
+  int offset = model::material_xs_table_valid.size();
+  double du = 1.0 / model::material_xs_table_inv_du;
+
+  // XS in the unresolved resonance range are sampled from probability tables,
+  // so bins overlapping it are never valid
+  double E_urr_min = INFTY;
+  double E_urr_max = -INFTY;
+  if (settings::urr_ptables_on) {
+    for (int i_nuc : nuclide_) {
+      const auto& nuc = data::nuclides[i_nuc];
+      if (!nuc.urr_present_) continue;
+      for (const auto& urr : nuc.urr_data_) {
+        E_urr_min = std::min(E_urr_min, urr.energy_(0));
+        E_urr_max = std::max(E_urr_max, urr.energy_(urr.n_energy_ - 1));
+      }
+    }
+  }
+
+  // Direct lookups are made with a host particle at the table's temperature.
+  // Since xs_table_offset_ is not yet set, these do not consult the table.
+  Particle p;
+  p.type_ = Particle::Type::neutron;
+  p.material_ = index_;
+  p.sqrtkT_ = sqrtkT;
+  auto direct_xs = [&](double log_E, double& total, double& absorption) {
+    p.E_ = std::exp(log_E);
+    this->calculate_neutron_xs(p, false);
+    total = p.macro_xs_.total;
+    absorption = p.macro_xs_.absorption;
+  };
+
+  double log_E_min = model::material_xs_table_log_E_min;
+  for (int i = 0; i < n_points; i++) {
+    double total, absorption;
+    direct_xs(log_E_min + i*du, total, absorption);
+    model::material_xs_table.push_back(total);
+    model::material_xs_table.push_back(absorption);
+  }
+
+  // Check each bin at its (logarithmic) midpoint against a direct lookup
+  int n_valid = 0;
+  double tol = settings::material_xs_table_tolerance;
+  for (int i = 0; i < n_points; i++) {
+    bool valid = false;
+    if (i < n_points - 1) {
+      double E_low = std::exp(log_E_min + i*du);
+      double E_high = std::exp(log_E_min + (i + 1)*du);
+      if (E_high <= E_urr_min || E_low >= E_urr_max) {
+        const double* xs = &model::material_xs_table[2*(offset + i)];
+        double total, absorption;
+        direct_xs(log_E_min + (i + 0.5)*du, total, absorption);
+        valid = std::abs(0.5*(xs[0] + xs[2]) - total) <= tol * total &&
+          std::abs(0.5*(xs[1] + xs[3]) - absorption) <= tol * absorption;
+      }
+    }
+    model::material_xs_table_valid.push_back(valid);
+    if (valid) ++n_valid;
+  }
+
+  xs_table_offset_ = offset;
+  xs_table_sqrtkT_ = sqrtkT;
+
+  if (mpi::master) {
+    std::cout << " Tabulated macro XS of material " << id_ << " (" <<
+      nuclide_.size() << " nuclides), " << 100.0 * n_valid / (n_points - 1) <<
+      "% of bins within tolerance" << std::endl;
+  }
+}
+
+void Material::invalidate_xs_table()
+{
+  if (xs_table_offset_ == C_NONE) return;
+  int n_points = settings::material_xs_table_points;
+  uint8_t* valid = &model::material_xs_table_valid[xs_table_offset_];
+  for (int i = 0; i < n_points; i++) valid[i] = false;
+  #pragma omp target update to(valid[:n_points])
 }
 
 //==============================================================================
 // Non-method functions
 //==============================================================================
 
+void build_material_xs_tables()
+{
+  model::material_xs_table.clear();
+  model::material_xs_table_valid.clear();
+  model::material_xs_table_size = 0;
+  if (!settings::material_xs_tables || !settings::run_CE) return;
+
+#ifndef NO_MICRO_XS_CACHE
+  // A tabulated lookup would leave the particle's micro XS cache stale for
+  // nuclide tallies, so tables are only used without the cache
+  warning("Material XS tables are not supported with the micro XS cache.");
+  return;
+#endif
+
+  int neutron = static_cast<int>(Particle::Type::neutron);
+  double log_E_min = std::log(data::energy_min[neutron]);
+  double log_E_max = std::log(data::energy_max[neutron]);
+  model::material_xs_table_log_E_min = log_E_min;
+  model::material_xs_table_inv_du = (settings::material_xs_table_points - 1) /
+    (log_E_max - log_E_min);
+
+  for (int i = 0; i < model::materials_size; i++) {
+    auto& mat = model::materials[i];
+    double sqrtkT;
+    if (mat.xs_table_eligible(sqrtkT)) mat.init_xs_table(sqrtkT);
+  }
+  model::material_xs_table_size = model::material_xs_table_valid.size();
+}
+
+void build_tms_majorant()
+{
+  model::tms_majorant.clear();
+  model::tms_majorant_bins = 0;
+  if (!settings::temperature_tms || !settings::run_CE) return;
+
+  int neutron = static_cast<int>(Particle::Type::neutron);
+  double log_E_min = std::log(data::energy_min[neutron]);
+  double log_E_max = std::log(data::energy_max[neutron]);
+  int n_bins = settings::majorant_points;
+  double inv_du = n_bins / (log_E_max - log_E_min);
+  auto bin = [&](double E) {
+    int i = std::floor((std::log(E) - log_E_min) * inv_du);
+    return std::max(0, std::min(i, n_bins - 1));
+  };
+
+  model::tms_majorant.assign(static_cast<size_t>(data::nuclides_size) * n_bins,
+    0.0);
+  for (int i_nuc = 0; i_nuc < data::nuclides_size; ++i_nuc) {
+    const auto& nuc = data::nuclides[i_nuc];
+    double* b = &model::tms_majorant[static_cast<size_t>(i_nuc) * n_bins];
+
+    // Targets are sampled with reduced speeds up to TMS_SPEED_CUTOFF, which
+    // moves the square root of the relative energy by at most c
+    double kT = std::max(nuc.tms_kT_ - nuc.kTs_[0], 0.0);
+    double c = TMS_SPEED_CUTOFF * std::sqrt(kT / nuc.awr_);
+
+    // Neutrons of energy E collide with targets at relative energy E' at a
+    // rate of sigma(E') sqrt(E'/E). Over each interval of the energy grid,
+    // sigma never exceeds the larger endpoint value and E' the upper endpoint.
+    const auto& energy = nuc.grid_[0].energy;
+    int n_intervals = energy.size() - 1;
+    std::vector<double> rate(n_intervals);
+    for (int j = 0; j < n_intervals; ++j) {
+      rate[j] = std::max(nuc.xs_[0](j, Nuclide::XS_TOTAL),
+        nuc.xs_[0](j + 1, Nuclide::XS_TOTAL)) * std::sqrt(energy[j + 1]);
+    }
+
+    // The intervals reachable from a bin only move up with the bin, so a
+    // deque of decreasing rates keeps the largest one in reach
+    std::deque<int> window;
+    int j_next = 0;
+    for (int k = 0; k < n_bins; ++k) {
+      double s_low = std::exp(0.5 * (log_E_min + k / inv_du));
+      double s_high = std::exp(0.5 * (log_E_min + (k + 1) / inv_du));
+      double E_low = std::pow(std::max(s_low - c, 0.0), 2);
+      double E_high = std::pow(s_high + c, 2);
+      while (j_next < n_intervals && energy[j_next] < E_high) {
+        while (!window.empty() && rate[window.back()] <= rate[j_next]) {
+          window.pop_back();
+        }
+        window.push_back(j_next++);
+      }
+      while (!window.empty() && energy[window.front() + 1] < E_low) {
+        window.pop_front();
+      }
+      if (!window.empty()) b[k] = MAJORANT_MARGIN * rate[window.front()] / s_low;
+    }
+
+    // Probability tables and multipole data are not broadened this way
+    auto clear = [&](double E_low, double E_high) {
+      for (int k = bin(E_low); k <= bin(E_high); ++k) b[k] = 0.0;
+    };
+    if (settings::urr_ptables_on && nuc.urr_present_) {
+      for (const auto& urr : nuc.urr_data_) {
+        clear(urr.energy_(0), urr.energy_(urr.n_energy_ - 1));
+      }
+    }
+    if (nuc.multipole_) clear(nuc.multipole_->E_min_, nuc.multipole_->E_max_);
+  }
+
+  // Materials are sampled above their thermal scattering data, if any of their
+  // nuclides are seen at a temperature above the one they were read at
+  int n_sampled = 0;
+  for (int i_mat = 0; i_mat < model::materials_size; ++i_mat) {
+    auto& mat = model::materials[i_mat];
+    mat.tms_energy_min_ = INFTY;
+    for (int i_nuc : mat.nuclide_) {
+      const auto& nuc = data::nuclides[i_nuc];
+      if (nuc.tms_kT_ > nuc.kTs_[0]) mat.tms_energy_min_ = 0.0;
+    }
+    if (mat.tms_energy_min_ == INFTY) continue;
+    ++n_sampled;
+    for (const auto& table : mat.thermal_tables_) {
+      mat.tms_energy_min_ = std::max(mat.tms_energy_min_,
+        data::thermal_scatt[table.index_table].energy_max_);
+    }
+  }
+
+  model::tms_majorant_bins = n_bins;
+  model::majorant_log_E_min = log_E_min;
+  model::majorant_inv_du = inv_du;
+
+  if (mpi::master) {
+    std::cout << " Built target motion sampling majorant XS, " << n_sampled <<
+      " of " << model::materials_size << " materials Doppler broadened" <<
+      std::endl;
+  }
+}
+
+void build_majorant()
+{
+  model::majorant.clear();
+  model::majorant_size = 0;
+  if (!settings::delta_tracking || !settings::run_CE) return;
+
+  // Find the materials that neutrons can be delta-tracked through
+  std::vector<bool> delta_material(model::materials_size, false);
+  auto add_materials = [&](const Cell& c) {
+    for (int32_t i_mat : c.material_) {
+      if (i_mat != MATERIAL_VOID) delta_material[i_mat] = true;
+    }
+  };
+  for (const auto& c : model::cells) {
+    if (!c.delta_tracking_) continue;
+    add_materials(c);
+    for (const auto& entry : c.get_contained_cells()) {
+      add_materials(model::cells[entry.first]);
+    }
+  }
+
+  int neutron = static_cast<int>(Particle::Type::neutron);
+  double log_E_min = std::log(data::energy_min[neutron]);
+  double log_E_max = std::log(data::energy_max[neutron]);
+  int n_bins = settings::majorant_points;
+  double inv_du = n_bins / (log_E_max - log_E_min);
+  auto bin = [&](double E) {
+    int i = std::floor((std::log(E) - log_E_min) * inv_du);
+    return std::max(0, std::min(i, n_bins - 1));
+  };
+
+  // Bound each nuclide's total XS over every bin, at every temperature. XS are
+  // linearly interpolated, so over each interval of the energy grid they never
+  // exceed the larger of the two endpoint values. Under target motion
+  // sampling, tentative collisions must be at least as frequent as the ones
+  // it samples.
+  std::vector<std::vector<double>> nuclide_bound(data::nuclides_size);
+  auto bound = [&](int i_nuc) -> const std::vector<double>& {
+    auto& b = nuclide_bound[i_nuc];
+    if (!b.empty()) return b;
+    if (model::tms_majorant_bins == n_bins) {
+      auto first = model::tms_majorant.cbegin() +
+        static_cast<size_t>(i_nuc) * n_bins;
+      b.assign(first, first + n_bins);
+      return b;
+    }
+    b.resize(n_bins, 0.0);
+    const auto& nuc = data::nuclides[i_nuc];
+    for (int t = 0; t < nuc.kTs_.size(); ++t) {
+      const auto& energy = nuc.grid_[t].energy;
+      for (int j = 0; j + 1 < energy.size(); ++j) {
+        double xs = std::max(nuc.xs_[t](j, Nuclide::XS_TOTAL),
+          nuc.xs_[t](j + 1, Nuclide::XS_TOTAL));
+        for (int i = bin(energy[j]); i <= bin(energy[j + 1]); ++i) {
+          b[i] = std::max(b[i], xs);
+        }
+      }
+    }
+    return b;
+  };
+
+  // Energy bins in which a material's XS are not given by the pointwise tables
+  // (thermal scattering, URR probability tables, multipole) have no bound
+  std::vector<bool> unbounded(n_bins, false);
+  auto mark_unbounded = [&](double E_low, double E_high) {
+    for (int i = bin(E_low); i <= bin(E_high); ++i) unbounded[i] = true;
+  };
+
+  model::majorant.assign(n_bins, 0.0);
+  for (int i_mat = 0; i_mat < model::materials_size; ++i_mat) {
+    if (!delta_material[i_mat]) continue;
+    const auto& mat = model::materials[i_mat];
+    for (const auto& table : mat.thermal_tables_) {
+      mark_unbounded(data::energy_min[neutron],
+        data::thermal_scatt[table.index_table].energy_max_);
+    }
+
+    std::vector<double> total(n_bins, 0.0);
+    for (int i = 0; i < mat.nuclide_.size(); ++i) {
+      int i_nuc = mat.nuclide_[i];
+      const auto& nuc = data::nuclides[i_nuc];
+      if (settings::urr_ptables_on && nuc.urr_present_) {
+        for (const auto& urr : nuc.urr_data_) {
+          mark_unbounded(urr.energy_(0), urr.energy_(urr.n_energy_ - 1));
+        }
+      }
+      if (nuc.multipole_) {
+        mark_unbounded(nuc.multipole_->E_min_, nuc.multipole_->E_max_);
+      }
+      const auto& b = bound(i_nuc);
+      for (int j = 0; j < n_bins; ++j) total[j] += mat.atom_density_(i) * b[j];
+    }
+    for (int j = 0; j < n_bins; ++j) {
+      model::majorant[j] = std::max(model::majorant[j], total[j]);
+    }
+  }
+
+  // Leave some room for the rounding of single precision XS and of material
+  // XS tables
+  int n_bounded = 0;
+  for (int j = 0; j < n_bins; ++j) {
+    if (unbounded[j]) {
+      model::majorant[j] = 0.0;
+    } else {
+      model::majorant[j] *= MAJORANT_MARGIN;
+      if (model::majorant[j] > 0.0) ++n_bounded;
+    }
+  }
+
+  model::majorant_size = n_bins;
+  model::majorant_log_E_min = log_E_min;
+  model::majorant_inv_du = inv_du;
+
+  if (mpi::master) {
+    std::cout << " Built delta-tracking majorant XS, " << 100.0 * n_bounded /
+      n_bins << "% of energy bins delta-tracked" << std::endl;
+  }
+}
+
 double sternheimer_adjustment(const std::vector<double>& f, const
   std::vector<double>& e_b_sq, double e_p_sq, double n_conduction, double
   log_I, double tol, int max_iter)
@@ -1248,14 +1860,23 @@ void read_materials_xml()
 
 
   if (!using_dagmc_mats) {
-    // Check if materials.xml exists
+    // Fall back on the HDF5 model input when there is no materials.xml
     std::string filename = settings::path_input + "materials.xml";
+    if (!file_exists(filename) &&
+        file_exists(settings::path_input + "materials.h5")) {
+      read_materials_hdf5();
+      return;
+    }
+
+    // Check if materials.xml exists
     if (!file_exists(filename)) {
       fatal_error("Material XML file '" + filename + "' does not exist!");
     }
 
     // Parse materials.xml file and get root element
+    begin_phase("Parsing materials.xml");
     doc.load_file(filename.c_str());
+    end_phase();
   }
 
   // Loop over XML material elements and populate the array.
@@ -1267,10 +1888,102 @@ void read_materials_xml()
   // Resize the material vector
   model::materials = static_cast<Material*>(malloc(model::materials_size * sizeof(Material)));
 
+  begin_phase("Building materials");
   int i = 0;
   for (pugi::xml_node material_node : root.children("material")) {
     new (model::materials + i++) Material(material_node);
   }
+  end_phase();
+}
+
+void read_materials_hdf5()
+{
+  write_message("Reading materials HDF5 file...", 5);
+
+  std::string filename = settings::path_input + "materials.h5";
+  hid_t file_id = file_open(filename, 'r');
+
+  // Check the filetype and version
+  std::string type;
+  read_attribute(file_id, "filetype", type);
+  if (type != "materials") {
+    fatal_error(fmt::format("{} is not a materials file.", filename));
+  }
+  std::array<int, 2> version;
+  read_attribute(file_id, "version", version);
+  if (version != VERSION_MODEL_INPUT) {
+    fatal_error(fmt::format("{} has version {}.{}, but OpenMC reads version "
+      "{}.{}.", filename, version[0], version[1], VERSION_MODEL_INPUT[0],
+      VERSION_MODEL_INPUT[1]));
+  }
+
+  // Names that the materials refer to by index
+  std::vector<std::string> nuclide_names;
+  std::vector<std::string> sab_names;
+  read_dataset(file_id, "nuclides", nuclide_names);
+  read_dataset(file_id, "sab_names", sab_names);
+
+  // Columns of the materials
+  std::vector<int32_t> ids;
+  std::vector<std::string> names;
+  std::vector<int> depletable;
+  std::vector<std::string> units;
+  std::vector<double> density;
+  std::vector<double> temperature;
+  std::vector<double> volume;
+  read_dataset(file_id, "id", ids);
+  read_dataset(file_id, "name", names);
+  read_dataset(file_id, "depletable", depletable);
+  read_dataset(file_id, "density_units", units);
+  read_dataset(file_id, "density", density);
+  read_dataset(file_id, "temperature", temperature);
+  read_dataset(file_id, "volume", volume);
+
+  // Per nuclide and thermal scattering table of each material, with the
+  // fractions sharing the offsets of the indices
+  std::vector<double> fractions;
+  std::vector<double> sab_fractions;
+  read_dataset(file_id, "nuclide_fraction", fractions);
+  read_dataset(file_id, "sab_fraction", sab_fractions);
+  RaggedDataset<int32_t> nuclides {file_id, "nuclide"};
+  RaggedDataset<int32_t> isotropic {file_id, "isotropic"};
+  RaggedDataset<int32_t> sab {file_id, "sab"};
+  file_close(file_id);
+
+  int n = ids.size();
+  if (names.size() != n || depletable.size() != n || units.size() != n ||
+      density.size() != n || temperature.size() != n || volume.size() != n ||
+      nuclides.size() != n || fractions.size() != nuclides.values.size() ||
+      isotropic.size() != n || sab.size() != n ||
+      sab_fractions.size() != sab.values.size()) {
+    fatal_error("The material datasets of materials.h5 differ in length.");
+  }
+
+  // Look up the names of the indices of a row
+  auto row_names = [](const RaggedDataset<int32_t>& column, int i,
+    const std::vector<std::string>& table) {
+    std::vector<std::string> row;
+    for (int32_t j : column.row(i)) {
+      if (j < 0 || j >= table.size()) {
+        fatal_error("Index out of range in materials.h5.");
+      }
+      row.push_back(table[j]);
+    }
+    return row;
+  };
+
+  model::materials_size = n;
+  model::materials = static_cast<Material*>(malloc(n * sizeof(Material)));
+  for (int i = 0; i < n; ++i) {
+    auto begin = fractions.begin();
+    auto sab_begin = sab_fractions.begin();
+    new (model::materials + i) Material(ids[i], names[i], depletable[i],
+      units[i], density[i], row_names(nuclides, i, nuclide_names),
+      {begin + nuclides.offsets[i], begin + nuclides.offsets[i + 1]},
+      row_names(isotropic, i, nuclide_names), row_names(sab, i, sab_names),
+      {sab_begin + sab.offsets[i], sab_begin + sab.offsets[i + 1]},
+      temperature[i], volume[i]);
+  }
 }
 
 void free_memory_material()
@@ -1281,6 +1994,9 @@ void free_memory_material()
   free(model::materials);
   model::materials_size = 0;
   model::material_map.clear();
+  model::material_xs_table.clear();
+  model::material_xs_table_valid.clear();
+  model::material_xs_table_size = 0;
 }
 
 //==============================================================================
@@ -1437,6 +2153,162 @@ openmc_material_set_densities(int32_t index, int n, const char** name, const dou
   return 0;
 }
 
+extern "C" int
+openmc_materials_set_densities(int n, const int32_t* index,
+  const double* density)
+{
+  // Check every update first so that an invalid one leaves no material changed
+  int n_densities = 0;
+  for (int i = 0; i < n; ++i) {
+    if (index[i] < 0 || index[i] >= model::materials_size) {
+      set_errmsg("Index in materials array is out of bounds.");
+      return OPENMC_E_OUT_OF_BOUNDS;
+    }
+    const auto& mat = model::materials[index[i]];
+    if (mat.nuclide_.empty()) {
+      set_errmsg(fmt::format("No nuclides exist in material {} yet.", mat.id_));
+      return OPENMC_E_UNASSIGNED;
+    }
+    double total = 0.0;
+    for (int j = 0; j < mat.nuclide_.size(); ++j) {
+      double d = density[n_densities + j];
+      if (d < 0.0) {
+        set_errmsg(fmt::format("Negative nuclide density given for material "
+          "{}.", mat.id_));
+        return OPENMC_E_INVALID_ARGUMENT;
+      }
+      total += d;
+    }
+    if (total <= 0.0) {
+      set_errmsg(fmt::format("Total density given for material {} is not "
+        "positive.", mat.id_));
+      return OPENMC_E_INVALID_ARGUMENT;
+    }
+    n_densities += mat.nuclide_.size();
+  }
+
+  // The serialized atom densities are only allocated once the materials have
+  // been moved to device, after which only the changed rows are sent again.
+  // Materials kept on device between simulations are sent by the next one.
+  bool on_device = simulation::initialized &&
+    model::materials_atom_density.size() > 0;
+
+  n_densities = 0;
+  for (int i = 0; i < n; ++i) {
+    auto& mat = model::materials[index[i]];
+    int n_nuc = mat.nuclide_.size();
+    double total = 0.0;
+    for (int j = 0; j < n_nuc; ++j) {
+      mat.atom_density_(j) = density[n_densities + j];
+      total += mat.atom_density_(j);
+    }
+    n_densities += n_nuc;
+    mat.set_density(total, "atom/b-cm");
+
+    if (on_device) {
+      model::materials_atom_density.copy_row(index[i], mat.atom_density_);
+      model::materials_atom_density.update_row_to_device(index[i], n_nuc);
+      #pragma omp target update to(model::materials[index[i]].density_, model::materials[index[i]].density_gpcc_)
+      mat.invalidate_xs_table();
+      for (int i_tally = 0; i_tally < model::tallies_size; ++i_tally) {
+        model::tallies[i_tally].update_material_nuclides(index[i]);
+      }
+    }
+  }
+
+  // The majorant bounds the delta-tracked materials at their old densities
+  if (on_device && n > 0 && model::majorant_size > 0) {
+    build_majorant();
+    model::device_majorant = model::majorant.data();
+    #pragma omp target update to(model::device_majorant[:model::majorant_size])
+  }
+  return 0;
+}
+
+extern "C" int
+openmc_materials_set_compositions(int n, const int32_t* index,
+  const int32_t* offset, const int* nuclide, const double* density)
+{
+  // The serialized compositions only allow the densities to change during a
+  // simulation. Materials kept on device between simulations are sent by the
+  // next one, or moved again if their nuclides changed.
+  bool on_device = simulation::initialized &&
+    model::materials_atom_density.size() > 0;
+
+  // Check every update first so that an invalid one leaves no material changed
+  for (int i = 0; i < n; ++i) {
+    if (index[i] < 0 || index[i] >= model::materials_size) {
+      set_errmsg("Index in materials array is out of bounds.");
+      return OPENMC_E_OUT_OF_BOUNDS;
+    }
+    const auto& mat = model::materials[index[i]];
+    if (offset[i + 1] <= offset[i]) {
+      set_errmsg(fmt::format("No nuclides given for material {}.", mat.id_));
+      return OPENMC_E_INVALID_ARGUMENT;
+    }
+    for (int j = offset[i]; j < offset[i + 1]; ++j) {
+      if (nuclide[j] < 0 || nuclide[j] >= data::nuclides_size) {
+        set_errmsg("Index in nuclides vector is out of bounds.");
+        return OPENMC_E_OUT_OF_BOUNDS;
+      }
+      if (density[j] <= 0.0) {
+        set_errmsg(fmt::format("Non-positive nuclide density given for "
+          "material {}.", mat.id_));
+        return OPENMC_E_INVALID_ARGUMENT;
+      }
+    }
+    if (on_device && !std::equal(nuclide + offset[i], nuclide + offset[i + 1],
+        mat.nuclide_.begin(), mat.nuclide_.end())) {
+      set_errmsg(fmt::format("The nuclides of material {} cannot change "
+        "during a simulation.", mat.id_));
+      return OPENMC_E_INVALID_ARGUMENT;
+    }
+  }
+
+  for (int i = 0; i < n; ++i) {
+    auto& mat = model::materials[index[i]];
+    int n_nuc = offset[i + 1] - offset[i];
+    const int* nuc = nuclide + offset[i];
+    const double* d = density + offset[i];
+
+    // Only the densities of an unchanged composition need to be replaced
+    if (std::equal(nuc, nuc + n_nuc, mat.nuclide_.begin(), mat.nuclide_.end())) {
+      double total = 0.0;
+      for (int j = 0; j < n_nuc; ++j) {
+        mat.atom_density_(j) = d[j];
+        total += d[j];
+      }
+      mat.set_density(total, "atom/b-cm");
+    } else {
+      try {
+        mat.set_densities({nuc, static_cast<size_t>(n_nuc)},
+          {d, static_cast<size_t>(n_nuc)});
+      } catch (const std::exception& e) {
+        set_errmsg(e.what());
+        return OPENMC_E_UNASSIGNED;
+      }
+    }
+
+    if (on_device) {
+      model::materials_atom_density.copy_row(index[i], mat.atom_density_);
+      model::materials_atom_density.update_row_to_device(index[i], n_nuc);
+      #pragma omp target update to(model::materials[index[i]].density_, model::materials[index[i]].density_gpcc_)
+      mat.invalidate_xs_table();
+      for (int i_tally = 0; i_tally < model::tallies_size; ++i_tally) {
+        model::tallies[i_tally].update_material_nuclides(index[i]);
+      }
+    }
+  }
+
+  // The majorant bounds the delta-tracked materials at their old densities
+  if (on_device && n > 0 && model::majorant_size > 0) {
+    build_majorant();
+    model::device_majorant = model::majorant.data();
+    #pragma omp target update to(model::device_majorant[:model::majorant_size])
+  }
+  return 0;
+}
+
 extern "C" int
 openmc_material_set_id(int32_t index, int32_t id)
 {
@@ -1502,6 +2374,9 @@ openmc_extend_materials(int32_t n, int32_t* index_start, int32_t* index_end)
   if (index_start) *index_start = model::materials_size;
   if (index_end) *index_end = model::materials_size + n - 1;
 
+  // Materials kept on device are released before the array moves
+  mark_material_changed(C_NONE, true);
+
   // Allocate temporary buffer
   Material* tmp = static_cast<Material*>(malloc(n * sizeof(Material)));
 
@@ -1,5 +1,7 @@
 #include "openmc/math_functions.h"
 
+#include <algorithm> // for min
+
 #ifndef NEW_FADDEEVA
 #include "../vendor/faddeeva/Faddeeva.cc"
 #endif
@@ -112,13 +114,18 @@ void calc_pn_c(int n, double x, double pnx[])
 
 double evaluate_legendre(int n, const double data[], double x)
 {
-  double* pnx = new double[n + 1];
-  double val = 0.0;
-  calc_pn_c(n, x, pnx);
-  for (int l = 0; l <= n; l++) {
-    val += (l + 0.5) * data[l] * pnx[l];
+  // The polynomials are built by the recursion of calc_pn_c() as they are
+  // summed, so that no storage is allocated (this is called on device)
+  double p_prev = 1.;
+  double p_l = x;
+  double val = 0.5 * data[0];
+  if (n >= 1) val += 1.5 * data[1] * x;
+  for (int l = 1; l < n; l++) {
+    double p_next = ((2 * l + 1) * x * p_l - l * p_prev) / (l + 1);
+    p_prev = p_l;
+    p_l = p_next;
+    val += (l + 1.5) * data[l + 1] * p_l;
   }
-  delete[] pnx;
   return val;
 }
 
@@ -146,6 +153,34 @@ void calc_rn(int n, Direction u, double rn[])
   // Store the shorthand of 1-w * w
   double w2m1 = 1. - w * w;
 
+  // Tabulate the powers and multiple-angle terms the harmonics are built from,
+  // so that only one sin/cos pair and one sqrt are evaluated for all orders:
+  //   sin(mx) = 2 cos(x) sin((m-1)x) - sin((m-2)x)
+  //   cos(mx) = 2 cos(x) cos((m-1)x) - cos((m-2)x)
+  double sin_mphi[RN_MAX_ORDER + 1];  // sin(m * phi)
+  double cos_mphi[RN_MAX_ORDER + 1];  // cos(m * phi)
+  double sqrt_w2m1[2*RN_MAX_ORDER + 1];  // (1 - w * w)^(k/2)
+  double w_pow[RN_MAX_ORDER + 1];  // w^k
+  int n_tab = std::min(n, RN_MAX_ORDER);
+  sin_mphi[0] = 0.;
+  cos_mphi[0] = 1.;
+  sqrt_w2m1[0] = 1.;
+  w_pow[0] = 1.;
+  if (n_tab >= 1) {
+    sin_mphi[1] = std::sin(phi);
+    cos_mphi[1] = std::cos(phi);
+    sqrt_w2m1[1] = std::sqrt(w2m1);
+    w_pow[1] = w;
+  }
+  for (int m = 2; m <= n_tab; m++) {
+    sin_mphi[m] = 2. * cos_mphi[1] * sin_mphi[m - 1] - sin_mphi[m - 2];
+    cos_mphi[m] = 2. * cos_mphi[1] * cos_mphi[m - 1] - cos_mphi[m - 2];
+    w_pow[m] = w_pow[m - 1] * w;
+  }
+  for (int k = 2; k <= 2*n_tab; k++) {
+    sqrt_w2m1[k] = sqrt_w2m1[k - 1] * sqrt_w2m1[1];
+  }
+
   // Now evaluate the spherical harmonics function
   rn[0] = 1.;
   int i = 0;
@@ -157,371 +192,371 @@ void calc_rn(int n, Direction u, double rn[])
     switch (l) {
       case 1:
         // l = 1, m = -1
-        rn[i] = -(std::sqrt(w2m1) * std::sin(phi));
+        rn[i] = -(sqrt_w2m1[1] * sin_mphi[1]);
         // l = 1, m = 0
         rn[i + 1] = w;
         // l = 1, m = 1
-        rn[i + 2] = -(std::sqrt(w2m1) * std::cos(phi));
+        rn[i + 2] = -(sqrt_w2m1[1] * cos_mphi[1]);
         break;
       case 2:
         // l = 2, m = -2
-        rn[i] = 0.288675134594813 * (-3. * w * w + 3.) * std::sin(2. * phi);
+        rn[i] = 0.288675134594813 * (-3. * w * w + 3.) * sin_mphi[2];
         // l = 2, m = -1
-        rn[i + 1] = -(1.73205080756888 * w*std::sqrt(w2m1) * std::sin(phi));
+        rn[i + 1] = -(1.73205080756888 * w*sqrt_w2m1[1] * sin_mphi[1]);
         // l = 2, m = 0
         rn[i + 2] = 1.5 * w * w - 0.5;
         // l = 2, m = 1
-        rn[i + 3] = -(1.73205080756888 * w*std::sqrt(w2m1) * std::cos(phi));
+        rn[i + 3] = -(1.73205080756888 * w*sqrt_w2m1[1] * cos_mphi[1]);
         // l = 2, m = 2
-        rn[i + 4] = 0.288675134594813 * (-3. * w * w + 3.) * std::cos(2. * phi);
+        rn[i + 4] = 0.288675134594813 * (-3. * w * w + 3.) * cos_mphi[2];
         break;
       case 3:
         // l = 3, m = -3
-        rn[i] = -(0.790569415042095 * std::pow(w2m1, 1.5) * std::sin(3. * phi));
+        rn[i] = -(0.790569415042095 * sqrt_w2m1[3] * sin_mphi[3]);
         // l = 3, m = -2
-        rn[i + 1] = 1.93649167310371 * w*(w2m1) * std::sin(2.*phi);
+        rn[i + 1] = 1.93649167310371 * w*(w2m1) * sin_mphi[2];
         // l = 3, m = -1
-        rn[i + 2] = -(0.408248290463863*std::sqrt(w2m1)*((7.5)*w * w - 3./2.) *
-             std::sin(phi));
+        rn[i + 2] = -(0.408248290463863*sqrt_w2m1[1]*((7.5)*w * w - 3./2.) *
+             sin_mphi[1]);
         // l = 3, m = 0
-        rn[i + 3] = 2.5 * std::pow(w, 3) - 1.5 * w;
+        rn[i + 3] = 2.5 * w_pow[3] - 1.5 * w;
         // l = 3, m = 1
-        rn[i + 4] = -(0.408248290463863*std::sqrt(w2m1)*((7.5)*w * w - 3./2.) *
-             std::cos(phi));
+        rn[i + 4] = -(0.408248290463863*sqrt_w2m1[1]*((7.5)*w * w - 3./2.) *
+             cos_mphi[1]);
         // l = 3, m = 2
-        rn[i + 5] = 1.93649167310371 * w*(w2m1) * std::cos(2.*phi);
+        rn[i + 5] = 1.93649167310371 * w*(w2m1) * cos_mphi[2];
         // l = 3, m = 3
-        rn[i + 6] = -(0.790569415042095 * std::pow(w2m1, 1.5) * std::cos(3.* phi));
+        rn[i + 6] = -(0.790569415042095 * sqrt_w2m1[3] * cos_mphi[3]);
         break;
       case 4:
         // l = 4, m = -4
-        rn[i] = 0.739509972887452 * (w2m1 * w2m1) * std::sin(4.0*phi);
+        rn[i] = 0.739509972887452 * (w2m1 * w2m1) * sin_mphi[4];
         // l = 4, m = -3
-        rn[i + 1] = -(2.09165006633519 * w * std::pow(w2m1, 1.5) * std::sin(3.* phi));
+        rn[i + 1] = -(2.09165006633519 * w * sqrt_w2m1[3] * sin_mphi[3]);
         // l = 4, m = -2
-        rn[i + 2] = 0.074535599249993 * (w2m1)*(52.5 * w * w - 7.5) * std::sin(2. *phi);
+        rn[i + 2] = 0.074535599249993 * (w2m1)*(52.5 * w * w - 7.5) * sin_mphi[2];
         // l = 4, m = -1
-        rn[i + 3] = -(0.316227766016838*std::sqrt(w2m1)*(17.5 * std::pow(w, 3) - 7.5 * w) *
-             std::sin(phi));
+        rn[i + 3] = -(0.316227766016838*sqrt_w2m1[1]*(17.5 * w_pow[3] - 7.5 * w) *
+             sin_mphi[1]);
         // l = 4, m = 0
-        rn[i + 4] = 4.375 * std::pow(w, 4) - 3.75 * w * w + 0.375;
+        rn[i + 4] = 4.375 * w_pow[4] - 3.75 * w * w + 0.375;
         // l = 4, m = 1
-        rn[i + 5] = -(0.316227766016838*std::sqrt(w2m1)*(17.5 * std::pow(w, 3) - 7.5*w) *
-             std::cos(phi));
+        rn[i + 5] = -(0.316227766016838*sqrt_w2m1[1]*(17.5 * w_pow[3] - 7.5*w) *
+             cos_mphi[1]);
         // l = 4, m = 2
-        rn[i + 6] = 0.074535599249993 * (w2m1)*(52.5*w * w - 7.5) * std::cos(2.*phi);
+        rn[i + 6] = 0.074535599249993 * (w2m1)*(52.5*w * w - 7.5) * cos_mphi[2];
         // l = 4, m = 3
-        rn[i + 7] = -(2.09165006633519 * w * std::pow(w2m1, 1.5) * std::cos(3.* phi));
+        rn[i + 7] = -(2.09165006633519 * w * sqrt_w2m1[3] * cos_mphi[3]);
         // l = 4, m = 4
-        rn[i + 8] = 0.739509972887452 * w2m1 * w2m1 * std::cos(4.0*phi);
+        rn[i + 8] = 0.739509972887452 * w2m1 * w2m1 * cos_mphi[4];
         break;
       case 5:
         // l = 5, m = -5
-        rn[i] = -(0.701560760020114 * std::pow(w2m1, 2.5) * std::sin(5.0 * phi));
+        rn[i] = -(0.701560760020114 * sqrt_w2m1[5] * sin_mphi[5]);
         // l = 5, m = -4
-        rn[i + 1] = 2.21852991866236 * w * w2m1 * w2m1 * std::sin(4.0 * phi);
+        rn[i + 1] = 2.21852991866236 * w * w2m1 * w2m1 * sin_mphi[4];
         // l = 5, m = -3
-        rn[i + 2] = -(0.00996023841111995 * std::pow(w2m1, 1.5) *
-             ((945.0 /2.)* w * w - 52.5) * std::sin(3.*phi));
+        rn[i + 2] = -(0.00996023841111995 * sqrt_w2m1[3] *
+             ((945.0 /2.)* w * w - 52.5) * sin_mphi[3]);
         // l = 5, m = -2
         rn[i + 3] = 0.0487950036474267 * (w2m1)
-             * ((315.0/2.)* std::pow(w, 3) - 52.5 * w) * std::sin(2.*phi);
+             * ((315.0/2.)* w_pow[3] - 52.5 * w) * sin_mphi[2];
         // l = 5, m = -1
-        rn[i + 4] = -(0.258198889747161*std::sqrt(w2m1) *
-             (39.375 * std::pow(w, 4) - 105.0/4.0 * w * w + 15.0/8.0) * std::sin(phi));
+        rn[i + 4] = -(0.258198889747161*sqrt_w2m1[1] *
+             (39.375 * w_pow[4] - 105.0/4.0 * w * w + 15.0/8.0) * sin_mphi[1]);
         // l = 5, m = 0
-        rn[i + 5] = 7.875 * std::pow(w, 5) - 8.75 * std::pow(w, 3) + 1.875 * w;
+        rn[i + 5] = 7.875 * w_pow[5] - 8.75 * w_pow[3] + 1.875 * w;
         // l = 5, m = 1
-        rn[i + 6] = -(0.258198889747161 * std::sqrt(w2m1)*
-             (39.375 * std::pow(w, 4) - 105.0/4.0 * w * w + 15.0/8.0) * std::cos(phi));
+        rn[i + 6] = -(0.258198889747161 * sqrt_w2m1[1]*
+             (39.375 * w_pow[4] - 105.0/4.0 * w * w + 15.0/8.0) * cos_mphi[1]);
         // l = 5, m = 2
         rn[i + 7] = 0.0487950036474267 * (w2m1) *
-             ((315.0 / 2.) * std::pow(w, 3) - 52.5*w) * std::cos(2.*phi);
+             ((315.0 / 2.) * w_pow[3] - 52.5*w) * cos_mphi[2];
         // l = 5, m = 3
-        rn[i + 8] = -(0.00996023841111995 * std::pow(w2m1, 1.5) *
-             ((945.0 / 2.) * w * w - 52.5) * std::cos(3.*phi));
+        rn[i + 8] = -(0.00996023841111995 * sqrt_w2m1[3] *
+             ((945.0 / 2.) * w * w - 52.5) * cos_mphi[3]);
         // l = 5, m = 4
-        rn[i + 9] = 2.21852991866236 * w * w2m1 * w2m1 * std::cos(4.0*phi);
+        rn[i + 9] = 2.21852991866236 * w * w2m1 * w2m1 * cos_mphi[4];
         // l = 5, m = 5
-        rn[i + 10] = -(0.701560760020114 * std::pow(w2m1, 2.5) * std::cos(5.0* phi));
+        rn[i + 10] = -(0.701560760020114 * sqrt_w2m1[5] * cos_mphi[5]);
         break;
       case 6:
         // l = 6, m = -6
-        rn[i] = 0.671693289381396 * std::pow(w2m1, 3) * std::sin(6.0*phi);
+        rn[i] = 0.671693289381396 * sqrt_w2m1[6] * sin_mphi[6];
         // l = 6, m = -5
-        rn[i + 1] = -(2.32681380862329 * w*std::pow(w2m1, 2.5) * std::sin(5.0*phi));
+        rn[i + 1] = -(2.32681380862329 * w*sqrt_w2m1[5] * sin_mphi[5]);
         // l = 6, m = -4
         rn[i + 2] = 0.00104990131391452 * w2m1 * w2m1 *
-             ((10395.0/2.) * w * w - 945.0/2.) * std::sin(4.0 * phi);
+             ((10395.0/2.) * w * w - 945.0/2.) * sin_mphi[4];
         // l = 6, m = -3
-        rn[i + 3] = -(0.00575054632785295 * std::pow(w2m1, 1.5) *
-             ((3465.0/2.) * std::pow(w, 3) - 945.0/2.*w) * std::sin(3.*phi));
+        rn[i + 3] = -(0.00575054632785295 * sqrt_w2m1[3] *
+             ((3465.0/2.) * w_pow[3] - 945.0/2.*w) * sin_mphi[3]);
         // l = 6, m = -2
         rn[i + 4] = 0.0345032779671177 * (w2m1) *
-             ((3465.0/8.0)* std::pow(w, 4) - 945.0/4.0 * w * w + 105.0/8.0) *
-             std::sin(2. * phi);
+             ((3465.0/8.0)* w_pow[4] - 945.0/4.0 * w * w + 105.0/8.0) *
+             sin_mphi[2];
         // l = 6, m = -1
-        rn[i + 5] = -(0.218217890235992*std::sqrt(w2m1) *
-             ((693.0/8.0)* std::pow(w, 5)- 315.0/4.0 * std::pow(w, 3) + (105.0/8.0)*w) *
-             std::sin(phi));
+        rn[i + 5] = -(0.218217890235992*sqrt_w2m1[1] *
+             ((693.0/8.0)* w_pow[5]- 315.0/4.0 * w_pow[3] + (105.0/8.0)*w) *
+             sin_mphi[1]);
         // l = 6, m = 0
-        rn[i + 6] = 14.4375 * std::pow(w, 6) - 19.6875 * std::pow(w, 4) + 6.5625 * w * w -
+        rn[i + 6] = 14.4375 * w_pow[6] - 19.6875 * w_pow[4] + 6.5625 * w * w -
              0.3125;
         // l = 6, m = 1
-        rn[i + 7] = -(0.218217890235992*std::sqrt(w2m1) *
-             ((693.0/8.0)* std::pow(w, 5)- 315.0/4.0 * std::pow(w, 3) + (105.0/8.0)*w) *
-             std::cos(phi));
+        rn[i + 7] = -(0.218217890235992*sqrt_w2m1[1] *
+             ((693.0/8.0)* w_pow[5]- 315.0/4.0 * w_pow[3] + (105.0/8.0)*w) *
+             cos_mphi[1]);
         // l = 6, m = 2
         rn[i + 8] = 0.0345032779671177 * w2m1 *
-             ((3465.0/8.0)* std::pow(w, 4) -945.0/4.0 * w * w + 105.0/8.0) *
-             std::cos(2.*phi);
+             ((3465.0/8.0)* w_pow[4] -945.0/4.0 * w * w + 105.0/8.0) *
+             cos_mphi[2];
         // l = 6, m = 3
-        rn[i + 9] = -(0.00575054632785295 * std::pow(w2m1, 1.5) *
-             ((3465.0/2.) * std::pow(w, 3) - 945.0/2.*w) * std::cos(3.*phi));
+        rn[i + 9] = -(0.00575054632785295 * sqrt_w2m1[3] *
+             ((3465.0/2.) * w_pow[3] - 945.0/2.*w) * cos_mphi[3]);
         // l = 6, m = 4
         rn[i + 10] = 0.00104990131391452 * w2m1 * w2m1 *
-             ((10395.0/2.)*w * w - 945.0/2.) * std::cos(4.0*phi);
+             ((10395.0/2.)*w * w - 945.0/2.) * cos_mphi[4];
         // l = 6, m = 5
-        rn[i + 11] = -(2.32681380862329 * w * std::pow(w2m1, 2.5) * std::cos(5.0*phi));
+        rn[i + 11] = -(2.32681380862329 * w * sqrt_w2m1[5] * cos_mphi[5]);
         // l = 6, m = 6
-        rn[i + 12] = 0.671693289381396 * std::pow(w2m1, 3) * std::cos(6.0*phi);
+        rn[i + 12] = 0.671693289381396 * sqrt_w2m1[6] * cos_mphi[6];
         break;
       case 7:
         // l = 7, m = -7
-        rn[i] = -(0.647259849287749 * std::pow(w2m1, 3.5) * std::sin(7.0*phi));
+        rn[i] = -(0.647259849287749 * sqrt_w2m1[7] * sin_mphi[7]);
         // l = 7, m = -6
-        rn[i + 1] = 2.42182459624969 * w*std::pow(w2m1, 3) * std::sin(6.0*phi);
+        rn[i + 1] = 2.42182459624969 * w*sqrt_w2m1[6] * sin_mphi[6];
         // l = 7, m = -5
-        rn[i + 2] = -(9.13821798555235e-5*std::pow(w2m1, 2.5) *
-             ((135135.0/2.)*w * w - 10395.0/2.) * std::sin(5.0*phi));
+        rn[i + 2] = -(9.13821798555235e-5*sqrt_w2m1[5] *
+             ((135135.0/2.)*w * w - 10395.0/2.) * sin_mphi[5]);
         // l = 7, m = -4
         rn[i + 3] = 0.000548293079133141 * w2m1 * w2m1 *
-             ((45045.0/2.)*std::pow(w, 3) - 10395.0/2.*w) * std::sin(4.0*phi);
+             ((45045.0/2.)*w_pow[3] - 10395.0/2.*w) * sin_mphi[4];
         // l = 7, m = -3
-        rn[i + 4] = -(0.00363696483726654 * std::pow(w2m1, 1.5) *
-             ((45045.0/8.0)* std::pow(w, 4) - 10395.0/4.0 * w * w + 945.0/8.0) *
-             std::sin(3.*phi));
+        rn[i + 4] = -(0.00363696483726654 * sqrt_w2m1[3] *
+             ((45045.0/8.0)* w_pow[4] - 10395.0/4.0 * w * w + 945.0/8.0) *
+             sin_mphi[3]);
         // l = 7, m = -2
         rn[i + 5] = 0.025717224993682 * (w2m1) *
-             ((9009.0/8.0)* std::pow(w, 5) -3465.0/4.0 * std::pow(w, 3) + (945.0/8.0)*w) *
-             std::sin(2.*phi);
+             ((9009.0/8.0)* w_pow[5] -3465.0/4.0 * w_pow[3] + (945.0/8.0)*w) *
+             sin_mphi[2];
         // l = 7, m = -1
-        rn[i + 6] = -(0.188982236504614*std::sqrt(w2m1) *
-             ((3003.0/16.0)* std::pow(w, 6) - 3465.0/16.0 * std::pow(w, 4) +
-             (945.0/16.0)*w * w - 35.0/16.0) * std::sin(phi));
+        rn[i + 6] = -(0.188982236504614*sqrt_w2m1[1] *
+             ((3003.0/16.0)* w_pow[6] - 3465.0/16.0 * w_pow[4] +
+             (945.0/16.0)*w * w - 35.0/16.0) * sin_mphi[1]);
         // l = 7, m = 0
-        rn[i + 7] = 26.8125 * std::pow(w, 7) - 43.3125 * std::pow(w, 5) + 19.6875 * std::pow(w, 3) -
+        rn[i + 7] = 26.8125 * w_pow[7] - 43.3125 * w_pow[5] + 19.6875 * w_pow[3] -
              2.1875 * w;
         // l = 7, m = 1
-        rn[i + 8] = -(0.188982236504614*std::sqrt(w2m1) * ((3003.0/16.0) * std::pow(w, 6) -
-             3465.0/16.0 * std::pow(w, 4) + (945.0/16.0)*w * w - 35.0/16.0) * std::cos(phi));
+        rn[i + 8] = -(0.188982236504614*sqrt_w2m1[1] * ((3003.0/16.0) * w_pow[6] -
+             3465.0/16.0 * w_pow[4] + (945.0/16.0)*w * w - 35.0/16.0) * cos_mphi[1]);
         // l = 7, m = 2
-        rn[i + 9] = 0.025717224993682 * (w2m1) * ((9009.0/8.0)* std::pow(w, 5) -
-             3465.0/4.0 * std::pow(w, 3) + (945.0/8.0)*w) * std::cos(2.*phi);
+        rn[i + 9] = 0.025717224993682 * (w2m1) * ((9009.0/8.0)* w_pow[5] -
+             3465.0/4.0 * w_pow[3] + (945.0/8.0)*w) * cos_mphi[2];
         // l = 7, m = 3
-        rn[i + 10] = -(0.00363696483726654 * std::pow(w2m1, 1.5) *
-             ((45045.0/8.0)* std::pow(w, 4) - 10395.0/4.0 * w * w + 945.0/8.0) *
-             std::cos(3.*phi));
+        rn[i + 10] = -(0.00363696483726654 * sqrt_w2m1[3] *
+             ((45045.0/8.0)* w_pow[4] - 10395.0/4.0 * w * w + 945.0/8.0) *
+             cos_mphi[3]);
         // l = 7, m = 4
         rn[i + 11] = 0.000548293079133141 * w2m1 * w2m1 *
-             ((45045.0/2.)*std::pow(w, 3) - 10395.0/2.*w) * std::cos(4.0*phi);
+             ((45045.0/2.)*w_pow[3] - 10395.0/2.*w) * cos_mphi[4];
         // l = 7, m = 5
-        rn[i + 12] = -(9.13821798555235e-5*std::pow(w2m1, 2.5) *
-             ((135135.0/2.)*w * w - 10395.0/2.) * std::cos(5.0*phi));
+        rn[i + 12] = -(9.13821798555235e-5*sqrt_w2m1[5] *
+             ((135135.0/2.)*w * w - 10395.0/2.) * cos_mphi[5]);
         // l = 7, m = 6
-        rn[i + 13] = 2.42182459624969 * w*std::pow(w2m1, 3) * std::cos(6.0*phi);
+        rn[i + 13] = 2.42182459624969 * w*sqrt_w2m1[6] * cos_mphi[6];
         // l = 7, m = 7
-        rn[i + 14] = -(0.647259849287749 * std::pow(w2m1, 3.5) * std::cos(7.0*phi));
+        rn[i + 14] = -(0.647259849287749 * sqrt_w2m1[7] * cos_mphi[7]);
         break;
       case 8:
         // l = 8, m = -8
-        rn[i] = 0.626706654240044 * std::pow(w2m1, 4) * std::sin(8.0*phi);
+        rn[i] = 0.626706654240044 * sqrt_w2m1[8] * sin_mphi[8];
         // l = 8, m = -7
-        rn[i + 1] = -(2.50682661696018 * w*std::pow(w2m1, 3.5) * std::sin(7.0*phi));
+        rn[i + 1] = -(2.50682661696018 * w*sqrt_w2m1[7] * sin_mphi[7]);
         // l = 8, m = -6
-        rn[i + 2] = 6.77369783729086e-6*std::pow(w2m1, 3)*
-             ((2027025.0/2.)*w * w - 135135.0/2.) * std::sin(6.0*phi);
+        rn[i + 2] = 6.77369783729086e-6*sqrt_w2m1[6]*
+             ((2027025.0/2.)*w * w - 135135.0/2.) * sin_mphi[6];
         // l = 8, m = -5
-        rn[i + 3] = -(4.38985792528482e-5*std::pow(w2m1, 2.5) *
-                  ((675675.0/2.)*std::pow(w, 3) - 135135.0/2.*w) * std::sin(5.0*phi));
+        rn[i + 3] = -(4.38985792528482e-5*sqrt_w2m1[5] *
+                  ((675675.0/2.)*w_pow[3] - 135135.0/2.*w) * sin_mphi[5]);
         // l = 8, m = -4
         rn[i + 4] = 0.000316557156832328 * w2m1 * w2m1 *
-             ((675675.0/8.0)* std::pow(w, 4) - 135135.0/4.0 * w * w + 10395.0/8.0) *
-             std::sin(4.0*phi);
+             ((675675.0/8.0)* w_pow[4] - 135135.0/4.0 * w * w + 10395.0/8.0) *
+             sin_mphi[4];
         // l = 8, m = -3
-        rn[i + 5] = -(0.00245204119306875 * std::pow(w2m1, 1.5) * ((135135.0/8.0) *
-             std::pow(w, 5) - 45045.0/4.0 * std::pow(w, 3) + (10395.0/8.0)*w) * std::sin(3.*phi));
+        rn[i + 5] = -(0.00245204119306875 * sqrt_w2m1[3] * ((135135.0/8.0) *
+             w_pow[5] - 45045.0/4.0 * w_pow[3] + (10395.0/8.0)*w) * sin_mphi[3]);
         // l = 8, m = -2
         rn[i + 6] = 0.0199204768222399 * (w2m1) *
-             ((45045.0/16.0)* std::pow(w, 6)- 45045.0/16.0 * std::pow(w, 4) +
-             (10395.0/16.0)*w * w - 315.0/16.0) * std::sin(2.*phi);
+             ((45045.0/16.0)* w_pow[6]- 45045.0/16.0 * w_pow[4] +
+             (10395.0/16.0)*w * w - 315.0/16.0) * sin_mphi[2];
         // l = 8, m = -1
-        rn[i + 7] = -(0.166666666666667*std::sqrt(w2m1) *
-             ((6435.0/16.0)* std::pow(w, 7) - 9009.0/16.0 * std::pow(w, 5) +
-             (3465.0/16.0)*std::pow(w, 3) - 315.0/16.0 * w) * std::sin(phi));
+        rn[i + 7] = -(0.166666666666667*sqrt_w2m1[1] *
+             ((6435.0/16.0)* w_pow[7] - 9009.0/16.0 * w_pow[5] +
+             (3465.0/16.0)*w_pow[3] - 315.0/16.0 * w) * sin_mphi[1]);
         // l = 8, m = 0
-        rn[i + 8] = 50.2734375 * std::pow(w, 8) - 93.84375 * std::pow(w, 6) + 54.140625 *
-             std::pow(w, 4) - 9.84375 * w * w + 0.2734375;
+        rn[i + 8] = 50.2734375 * w_pow[8] - 93.84375 * w_pow[6] + 54.140625 *
+             w_pow[4] - 9.84375 * w * w + 0.2734375;
         // l = 8, m = 1
-        rn[i + 9] = -(0.166666666666667*std::sqrt(w2m1) *
-                   ((6435.0/16.0)* std::pow(w, 7) - 9009.0/16.0 * std::pow(w, 5) +
-                   (3465.0/16.0)*std::pow(w, 3) - 315.0/16.0 * w) * std::cos(phi));
+        rn[i + 9] = -(0.166666666666667*sqrt_w2m1[1] *
+                   ((6435.0/16.0)* w_pow[7] - 9009.0/16.0 * w_pow[5] +
+                   (3465.0/16.0)*w_pow[3] - 315.0/16.0 * w) * cos_mphi[1]);
         // l = 8, m = 2
-        rn[i + 10] = 0.0199204768222399 * (w2m1)*((45045.0/16.0)* std::pow(w, 6)-
-             45045.0/16.0 * std::pow(w, 4) + (10395.0/16.0)*w * w -
-             315.0/16.0) * std::cos(2.*phi);
+        rn[i + 10] = 0.0199204768222399 * (w2m1)*((45045.0/16.0)* w_pow[6]-
+             45045.0/16.0 * w_pow[4] + (10395.0/16.0)*w * w -
+             315.0/16.0) * cos_mphi[2];
         // l = 8, m = 3
-        rn[i + 11] = -(0.00245204119306875 * std::pow(w2m1, 1.5)*
-                   ((135135.0/8.0) * std::pow(w, 5) - 45045.0/4.0 * std::pow(w, 3) +
-                   (10395.0/8.0)*w) * std::cos(3.*phi));
+        rn[i + 11] = -(0.00245204119306875 * sqrt_w2m1[3]*
+                   ((135135.0/8.0) * w_pow[5] - 45045.0/4.0 * w_pow[3] +
+                   (10395.0/8.0)*w) * cos_mphi[3]);
         // l = 8, m = 4
-        rn[i + 12] = 0.000316557156832328 * w2m1 * w2m1*((675675.0/8.0)* std::pow(w, 4) -
-             135135.0/4.0 * w * w + 10395.0/8.0) * std::cos(4.0*phi);
+        rn[i + 12] = 0.000316557156832328 * w2m1 * w2m1*((675675.0/8.0)* w_pow[4] -
+             135135.0/4.0 * w * w + 10395.0/8.0) * cos_mphi[4];
         // l = 8, m = 5
-        rn[i + 13] = -(4.38985792528482e-5*std::pow(w2m1, 2.5)*((675675.0/2.)*std::pow(w, 3) -
-                   135135.0/2.*w) * std::cos(5.0*phi));
+        rn[i + 13] = -(4.38985792528482e-5*sqrt_w2m1[5]*((675675.0/2.)*w_pow[3] -
+                   135135.0/2.*w) * cos_mphi[5]);
         // l = 8, m = 6
-        rn[i + 14] = 6.77369783729086e-6*std::pow(w2m1, 3)*((2027025.0/2.)*w * w -
-             135135.0/2.) * std::cos(6.0*phi);
+        rn[i + 14] = 6.77369783729086e-6*sqrt_w2m1[6]*((2027025.0/2.)*w * w -
+             135135.0/2.) * cos_mphi[6];
         // l = 8, m = 7
-        rn[i + 15] = -(2.50682661696018 * w*std::pow(w2m1, 3.5) * std::cos(7.0*phi));
+        rn[i + 15] = -(2.50682661696018 * w*sqrt_w2m1[7] * cos_mphi[7]);
         // l = 8, m = 8
-        rn[i + 16] = 0.626706654240044 * std::pow(w2m1, 4) * std::cos(8.0*phi);
+        rn[i + 16] = 0.626706654240044 * sqrt_w2m1[8] * cos_mphi[8];
         break;
       case 9:
         // l = 9, m = -9
-        rn[i] = -(0.609049392175524 * std::pow(w2m1, 4.5) * std::sin(9.0 * phi));
+        rn[i] = -(0.609049392175524 * sqrt_w2m1[9] * sin_mphi[9]);
         // l = 9, m = -8
-        rn[i + 1] = 2.58397773170915 * w*std::pow(w2m1, 4) * std::sin(8.0 * phi);
+        rn[i + 1] = 2.58397773170915 * w*sqrt_w2m1[8] * sin_mphi[8];
         // l = 9, m = -7
-        rn[i + 2] = -(4.37240315267812e-7*std::pow(w2m1, 3.5) *
-             ((34459425.0/2.)*w * w - 2027025.0/2.) * std::sin(7.0 * phi));
+        rn[i + 2] = -(4.37240315267812e-7*sqrt_w2m1[7] *
+             ((34459425.0/2.)*w * w - 2027025.0/2.) * sin_mphi[7]);
         // l = 9, m = -6
-        rn[i + 3] = 3.02928976464514e-6*std::pow(w2m1, 3)*
-             ((11486475.0/2.)*std::pow(w, 3) - 2027025.0/2.*w) * std::sin(6.0 * phi);
+        rn[i + 3] = 3.02928976464514e-6*sqrt_w2m1[6]*
+             ((11486475.0/2.)*w_pow[3] - 2027025.0/2.*w) * sin_mphi[6];
         // l = 9, m = -5
-        rn[i + 4] = -(2.34647776186144e-5*std::pow(w2m1, 2.5) *
-             ((11486475.0/8.0)* std::pow(w, 4) - 2027025.0 / 4.0 * w * w +
-              135135.0/8.0) * std::sin(5.0 * phi));
+        rn[i + 4] = -(2.34647776186144e-5*sqrt_w2m1[5] *
+             ((11486475.0/8.0)* w_pow[4] - 2027025.0 / 4.0 * w * w +
+              135135.0/8.0) * sin_mphi[5]);
         // l = 9, m = -4
-        rn[i + 5] = 0.000196320414650061 * w2m1 * w2m1*((2297295.0/8.0)* std::pow(w, 5) -
-             675675.0/4.0 * std::pow(w, 3) + (135135.0/8.0)*w) * std::sin(4.0*phi);
+        rn[i + 5] = 0.000196320414650061 * w2m1 * w2m1*((2297295.0/8.0)* w_pow[5] -
+             675675.0/4.0 * w_pow[3] + (135135.0/8.0)*w) * sin_mphi[4];
         // l = 9, m = -3
-        rn[i + 6] = -(0.00173385495536766 * std::pow(w2m1, 1.5) *
-                  ((765765.0/16.0)* std::pow(w, 6) - 675675.0/16.0 * std::pow(w, 4) +
-                  (135135.0/16.0)*w * w - 3465.0/16.0) * std::sin(3. * phi));
+        rn[i + 6] = -(0.00173385495536766 * sqrt_w2m1[3] *
+                  ((765765.0/16.0)* w_pow[6] - 675675.0/16.0 * w_pow[4] +
+                  (135135.0/16.0)*w * w - 3465.0/16.0) * sin_mphi[3]);
         // l = 9, m = -2
-        rn[i + 7] = 0.0158910431540932 * (w2m1)*((109395.0/16.0)* std::pow(w, 7)-
-             135135.0/16.0 * std::pow(w, 5) + (45045.0/16.0)*std::pow(w, 3) -
-             3465.0/16.0 * w) * std::sin(2. * phi);
+        rn[i + 7] = 0.0158910431540932 * (w2m1)*((109395.0/16.0)* w_pow[7]-
+             135135.0/16.0 * w_pow[5] + (45045.0/16.0)*w_pow[3] -
+             3465.0/16.0 * w) * sin_mphi[2];
         // l = 9, m = -1
-        rn[i + 8] = -(0.149071198499986*std::sqrt(w2m1)*((109395.0/128.0)* std::pow(w, 8) -
-                  45045.0/32.0 * std::pow(w, 6) + (45045.0/64.0)* std::pow(w, 4) -
-                  3465.0/32.0 * w * w + 315.0/128.0) * std::sin(phi));
+        rn[i + 8] = -(0.149071198499986*sqrt_w2m1[1]*((109395.0/128.0)* w_pow[8] -
+                  45045.0/32.0 * w_pow[6] + (45045.0/64.0)* w_pow[4] -
+                  3465.0/32.0 * w * w + 315.0/128.0) * sin_mphi[1]);
         // l = 9, m = 0
-        rn[i + 9] = 94.9609375 * std::pow(w, 9) - 201.09375 * std::pow(w, 7) +
-             140.765625 * std::pow(w, 5)- 36.09375 * std::pow(w, 3) + 2.4609375 * w;
+        rn[i + 9] = 94.9609375 * w_pow[9] - 201.09375 * w_pow[7] +
+             140.765625 * w_pow[5]- 36.09375 * w_pow[3] + 2.4609375 * w;
         // l = 9, m = 1
-        rn[i + 10] = -(0.149071198499986*std::sqrt(w2m1)*((109395.0/128.0)* std::pow(w, 8) -
-                   45045.0/32.0 * std::pow(w, 6) + (45045.0/64.0)* std::pow(w, 4) -
-                   3465.0/32.0 * w * w + 315.0/128.0) * std::cos(phi));
+        rn[i + 10] = -(0.149071198499986*sqrt_w2m1[1]*((109395.0/128.0)* w_pow[8] -
+                   45045.0/32.0 * w_pow[6] + (45045.0/64.0)* w_pow[4] -
+                   3465.0/32.0 * w * w + 315.0/128.0) * cos_mphi[1]);
         // l = 9, m = 2
-        rn[i + 11] = 0.0158910431540932 * (w2m1)*((109395.0/16.0)* std::pow(w, 7) -
-             135135.0/16.0 * std::pow(w, 5) + (45045.0/16.0)*std::pow(w, 3) -
-             3465.0/ 16.0 * w) * std::cos(2. * phi);
+        rn[i + 11] = 0.0158910431540932 * (w2m1)*((109395.0/16.0)* w_pow[7] -
+             135135.0/16.0 * w_pow[5] + (45045.0/16.0)*w_pow[3] -
+             3465.0/ 16.0 * w) * cos_mphi[2];
         // l = 9, m = 3
-        rn[i + 12] = -(0.00173385495536766 * std::pow(w2m1, 1.5)*((765765.0/16.0) *
-                   std::pow(w, 6) - 675675.0/16.0 * std::pow(w, 4) +
-                   (135135.0/16.0)* w * w - 3465.0/16.0)* std::cos(3. * phi));
+        rn[i + 12] = -(0.00173385495536766 * sqrt_w2m1[3]*((765765.0/16.0) *
+                   w_pow[6] - 675675.0/16.0 * w_pow[4] +
+                   (135135.0/16.0)* w * w - 3465.0/16.0)* cos_mphi[3]);
         // l = 9, m = 4
-        rn[i + 13] = 0.000196320414650061 * w2m1 * w2m1*((2297295.0/8.0) * std::pow(w, 5) -
-             675675.0/4.0 * std::pow(w, 3) + (135135.0/8.0)*w) * std::cos(4.0 * phi);
+        rn[i + 13] = 0.000196320414650061 * w2m1 * w2m1*((2297295.0/8.0) * w_pow[5] -
+             675675.0/4.0 * w_pow[3] + (135135.0/8.0)*w) * cos_mphi[4];
         // l = 9, m = 5
-        rn[i + 14] = -(2.34647776186144e-5*std::pow(w2m1, 2.5)*((11486475.0/8.0) *
-                   std::pow(w, 4) - 2027025.0/4.0 * w * w + 135135.0/8.0) *
-                   std::cos(5.0 * phi));
+        rn[i + 14] = -(2.34647776186144e-5*sqrt_w2m1[5]*((11486475.0/8.0) *
+                   w_pow[4] - 2027025.0/4.0 * w * w + 135135.0/8.0) *
+                   cos_mphi[5]);
         // l = 9, m = 6
-        rn[i + 15] = 3.02928976464514e-6*std::pow(w2m1, 3)*((11486475.0/2.)*std::pow(w, 3) -
-             2027025.0/2. * w) * std::cos(6.0 * phi);
+        rn[i + 15] = 3.02928976464514e-6*sqrt_w2m1[6]*((11486475.0/2.)*w_pow[3] -
+             2027025.0/2. * w) * cos_mphi[6];
         // l = 9, m = 7
-        rn[i + 16] = -(4.37240315267812e-7*std::pow(w2m1, 3.5)*
-                   ((34459425.0/2.) * w * w - 2027025.0/2.) * std::cos(7.0 * phi));
+        rn[i + 16] = -(4.37240315267812e-7*sqrt_w2m1[7]*
+                   ((34459425.0/2.) * w * w - 2027025.0/2.) * cos_mphi[7]);
         // l = 9, m = 8
-        rn[i + 17] = 2.58397773170915 * w*std::pow(w2m1, 4) * std::cos(8.0 * phi);
+        rn[i + 17] = 2.58397773170915 * w*sqrt_w2m1[8] * cos_mphi[8];
         // l = 9, m = 9
-        rn[i + 18] = -(0.609049392175524 * std::pow(w2m1, 4.5) * std::cos(9.0 * phi));
+        rn[i + 18] = -(0.609049392175524 * sqrt_w2m1[9] * cos_mphi[9]);
         break;
       case 10:
         // l = 10, m = -10
-        rn[i] = 0.593627917136573 * std::pow(w2m1, 5) * std::sin(10.0 * phi);
+        rn[i] = 0.593627917136573 * sqrt_w2m1[10] * sin_mphi[10];
         // l = 10, m = -9
-        rn[i + 1] = -(2.65478475211798 * w * std::pow(w2m1, 4.5) * std::sin(9.0 * phi));
+        rn[i + 1] = -(2.65478475211798 * w * sqrt_w2m1[9] * sin_mphi[9]);
         // l = 10, m = -8
-        rn[i + 2] = 2.49953651452314e-8 * std::pow(w2m1, 4) *
-             ((654729075.0/2.) * w * w - 34459425.0/2.) * std::sin(8.0 * phi);
+        rn[i + 2] = 2.49953651452314e-8 * sqrt_w2m1[8] *
+             ((654729075.0/2.) * w * w - 34459425.0/2.) * sin_mphi[8];
         // l = 10, m = -7
-        rn[i + 3] = -(1.83677671621093e-7*std::pow(w2m1, 3.5)*
-                  ((218243025.0/2.)*std::pow(w, 3) - 34459425.0/2.*w) *
-                  std::sin(7.0 * phi));
+        rn[i + 3] = -(1.83677671621093e-7*sqrt_w2m1[7]*
+                  ((218243025.0/2.)*w_pow[3] - 34459425.0/2.*w) *
+                  sin_mphi[7]);
         // l = 10, m = -6
-        rn[i + 4] = 1.51464488232257e-6*std::pow(w2m1, 3)*((218243025.0/8.0)* std::pow(w, 4) -
-             34459425.0/4.0 * w * w + 2027025.0/8.0) * std::sin(6.0 * phi);
+        rn[i + 4] = 1.51464488232257e-6*sqrt_w2m1[6]*((218243025.0/8.0)* w_pow[4] -
+             34459425.0/4.0 * w * w + 2027025.0/8.0) * sin_mphi[6];
         // l = 10, m = -5
-        rn[i + 5] = -(1.35473956745817e-5*std::pow(w2m1, 2.5)*
-                  ((43648605.0/8.0)* std::pow(w, 5) - 11486475.0/4.0 * std::pow(w, 3) +
-                  (2027025.0/8.0)*w) * std::sin(5.0 * phi));
+        rn[i + 5] = -(1.35473956745817e-5*sqrt_w2m1[5]*
+                  ((43648605.0/8.0)* w_pow[5] - 11486475.0/4.0 * w_pow[3] +
+                  (2027025.0/8.0)*w) * sin_mphi[5]);
         // l = 10, m = -4
-        rn[i + 6] = 0.000128521880085575 * w2m1 * w2m1*((14549535.0/16.0)* std::pow(w, 6) -
-             11486475.0/16.0 * std::pow(w, 4) + (2027025.0/16.0)*w * w -
-             45045.0/16.0) * std::sin(4.0 * phi);
+        rn[i + 6] = 0.000128521880085575 * w2m1 * w2m1*((14549535.0/16.0)* w_pow[6] -
+             11486475.0/16.0 * w_pow[4] + (2027025.0/16.0)*w * w -
+             45045.0/16.0) * sin_mphi[4];
         // l = 10, m = -3
-        rn[i + 7] = -(0.00127230170115096 * std::pow(w2m1, 1.5)*
-                  ((2078505.0/16.0)* std::pow(w, 7) - 2297295.0/16.0 * std::pow(w, 5) +
-                  (675675.0/16.0)*std::pow(w, 3) - 45045.0/16.0 * w) * std::sin(3. * phi));
+        rn[i + 7] = -(0.00127230170115096 * sqrt_w2m1[3]*
+                  ((2078505.0/16.0)* w_pow[7] - 2297295.0/16.0 * w_pow[5] +
+                  (675675.0/16.0)*w_pow[3] - 45045.0/16.0 * w) * sin_mphi[3]);
         // l = 10, m = -2
-        rn[i + 8] = 0.012974982402692 * (w2m1)*((2078505.0/128.0)* std::pow(w, 8) -
-             765765.0/32.0 * std::pow(w, 6) + (675675.0/64.0)* std::pow(w, 4) -
-             45045.0/32.0 * w * w + 3465.0/128.0) * std::sin(2. * phi);
+        rn[i + 8] = 0.012974982402692 * (w2m1)*((2078505.0/128.0)* w_pow[8] -
+             765765.0/32.0 * w_pow[6] + (675675.0/64.0)* w_pow[4] -
+             45045.0/32.0 * w * w + 3465.0/128.0) * sin_mphi[2];
         // l = 10, m = -1
-        rn[i + 9] = -(0.134839972492648*std::sqrt(w2m1)*((230945.0/128.0)* std::pow(w, 9) -
-                   109395.0/32.0 * std::pow(w, 7) + (135135.0/64.0)* std::pow(w, 5) -
-                   15015.0/32.0 * std::pow(w, 3) + (3465.0/128.0)*w) * std::sin(phi));
+        rn[i + 9] = -(0.134839972492648*sqrt_w2m1[1]*((230945.0/128.0)* w_pow[9] -
+                   109395.0/32.0 * w_pow[7] + (135135.0/64.0)* w_pow[5] -
+                   15015.0/32.0 * w_pow[3] + (3465.0/128.0)*w) * sin_mphi[1]);
         // l = 10, m = 0
-        rn[i + 10] = 180.42578125 * std::pow(w, 10) - 427.32421875 * std::pow(w, 8) +351.9140625
-             * std::pow(w, 6) - 117.3046875 * std::pow(w, 4) + 13.53515625 * w * w -0.24609375;
+        rn[i + 10] = 180.42578125 * w_pow[10] - 427.32421875 * w_pow[8] +351.9140625
+             * w_pow[6] - 117.3046875 * w_pow[4] + 13.53515625 * w * w -0.24609375;
         // l = 10, m = 1
-        rn[i + 11] = -(0.134839972492648*std::sqrt(w2m1)*((230945.0/128.0)* std::pow(w, 9) -
-                   109395.0/32.0 * std::pow(w, 7) + (135135.0/64.0)* std::pow(w, 5) -15015.0/
-                   32.0 * std::pow(w, 3) + (3465.0/128.0)*w) * std::cos(phi));
+        rn[i + 11] = -(0.134839972492648*sqrt_w2m1[1]*((230945.0/128.0)* w_pow[9] -
+                   109395.0/32.0 * w_pow[7] + (135135.0/64.0)* w_pow[5] -15015.0/
+                   32.0 * w_pow[3] + (3465.0/128.0)*w) * cos_mphi[1]);
         // l = 10, m = 2
-        rn[i + 12] = 0.012974982402692 * (w2m1)*((2078505.0/128.0)* std::pow(w, 8) -
-             765765.0/32.0 * std::pow(w, 6) + (675675.0/64.0)* std::pow(w, 4) -
-             45045.0/32.0 * w * w + 3465.0/128.0) * std::cos(2. * phi);
+        rn[i + 12] = 0.012974982402692 * (w2m1)*((2078505.0/128.0)* w_pow[8] -
+             765765.0/32.0 * w_pow[6] + (675675.0/64.0)* w_pow[4] -
+             45045.0/32.0 * w * w + 3465.0/128.0) * cos_mphi[2];
         // l = 10, m = 3
-        rn[i + 13] = -(0.00127230170115096 * std::pow(w2m1, 1.5)*
-                   ((2078505.0/16.0)* std::pow(w, 7) - 2297295.0/16.0 * std::pow(w, 5) +
-                   (675675.0/16.0)*std::pow(w, 3) - 45045.0/16.0 * w) * std::cos(3. * phi));
+        rn[i + 13] = -(0.00127230170115096 * sqrt_w2m1[3]*
+                   ((2078505.0/16.0)* w_pow[7] - 2297295.0/16.0 * w_pow[5] +
+                   (675675.0/16.0)*w_pow[3] - 45045.0/16.0 * w) * cos_mphi[3]);
         // l = 10, m = 4
-        rn[i + 14] = 0.000128521880085575 * w2m1 * w2m1*((14549535.0/16.0)* std::pow(w, 6) -
-             11486475.0/16.0 * std::pow(w, 4) + (2027025.0/16.0) * w * w -
-             45045.0/16.0) * std::cos(4.0 * phi);
+        rn[i + 14] = 0.000128521880085575 * w2m1 * w2m1*((14549535.0/16.0)* w_pow[6] -
+             11486475.0/16.0 * w_pow[4] + (2027025.0/16.0) * w * w -
+             45045.0/16.0) * cos_mphi[4];
         // l = 10, m = 5
-        rn[i + 15] = -(1.35473956745817e-5*std::pow(w2m1, 2.5)*
-                   ((43648605.0/8.0)* std::pow(w, 5) - 11486475.0/4.0 * std::pow(w, 3) +
-                   (2027025.0/8.0)*w) * std::cos(5.0 * phi));
+        rn[i + 15] = -(1.35473956745817e-5*sqrt_w2m1[5]*
+                   ((43648605.0/8.0)* w_pow[5] - 11486475.0/4.0 * w_pow[3] +
+                   (2027025.0/8.0)*w) * cos_mphi[5]);
         // l = 10, m = 6
-        rn[i + 16] = 1.51464488232257e-6*std::pow(w2m1, 3)*((218243025.0/8.0)* std::pow(w, 4) -
-             34459425.0/4.0 * w * w + 2027025.0/8.0) * std::cos(6.0 * phi);
+        rn[i + 16] = 1.51464488232257e-6*sqrt_w2m1[6]*((218243025.0/8.0)* w_pow[4] -
+             34459425.0/4.0 * w * w + 2027025.0/8.0) * cos_mphi[6];
         // l = 10, m = 7
-        rn[i + 17] = -(1.83677671621093e-7*std::pow(w2m1, 3.5) *
-             ((218243025.0/2.)*std::pow(w, 3) - 34459425.0/2.*w) * std::cos(7.0 * phi));
+        rn[i + 17] = -(1.83677671621093e-7*sqrt_w2m1[7] *
+             ((218243025.0/2.)*w_pow[3] - 34459425.0/2.*w) * cos_mphi[7]);
         // l = 10, m = 8
-        rn[i + 18] = 2.49953651452314e-8*std::pow(w2m1, 4)*
-             ((654729075.0/2.)*w * w - 34459425.0/2.) * std::cos(8.0 * phi);
+        rn[i + 18] = 2.49953651452314e-8*sqrt_w2m1[8]*
+             ((654729075.0/2.)*w * w - 34459425.0/2.) * cos_mphi[8];
         // l = 10, m = 9
-        rn[i + 19] = -(2.65478475211798 * w*std::pow(w2m1, 4.5) * std::cos(9.0 * phi));
+        rn[i + 19] = -(2.65478475211798 * w*sqrt_w2m1[9] * cos_mphi[9]);
         // l = 10, m = 10
-        rn[i + 20] = 0.593627917136573 * std::pow(w2m1, 5) * std::cos(10.0 * phi);
+        rn[i + 20] = 0.593627917136573 * sqrt_w2m1[10] * cos_mphi[10];
     }
   }
 }
@@ -539,12 +574,14 @@ void calc_zn(int n, double rho, double phi, double zn[]) {
   double sin_phi = std::sin(phi);
   double cos_phi = std::cos(phi);
 
-  std::vector<double> sin_phi_vec(n + 1); // Sin[n * phi]
-  std::vector<double> cos_phi_vec(n + 1); // Cos[n * phi]
+  double sin_phi_vec[ZN_MAX_ORDER + 1]; // Sin[n * phi]
+  double cos_phi_vec[ZN_MAX_ORDER + 1]; // Cos[n * phi]
   sin_phi_vec[0] = 1.0;
   cos_phi_vec[0] = 1.0;
-  sin_phi_vec[1] = 2.0 * cos_phi;
-  cos_phi_vec[1] = cos_phi;
+  if (n >= 1) {
+    sin_phi_vec[1] = 2.0 * cos_phi;
+    cos_phi_vec[1] = cos_phi;
+  }
 
   for (int i = 2; i <= n; i++) {
     sin_phi_vec[i] = 2. * cos_phi * sin_phi_vec[i - 1] - sin_phi_vec[i - 2];
@@ -557,8 +594,9 @@ void calc_zn(int n, double rho, double phi, double zn[]) {
 
   // ===========================================================================
   // Calculate R_pq(rho)
-  // Matrix forms of the coefficients which are easier to work with
-  std::vector<std::vector<double>> zn_mat(n + 1, std::vector<double>(n + 1));
+  // Matrix forms of the coefficients which are easier to work with, kept on
+  // the stack so that this can be evaluated on device
+  double zn_mat[ZN_MAX_ORDER + 1][ZN_MAX_ORDER + 1];
 
   // Fill the main diagonal first (Eq 3.9 in Chong)
   for (int p = 0; p <= n; p++) {
@@ -856,21 +894,161 @@ std::complex<double> faddeeva(std::complex<double> z)
   return z.imag() > 0.0 ? w_impl(z) : -std::conj(w_impl(std::conj(z)));
 }
 
+//==============================================================================
+// Batched Faddeeva approximations. These evaluate w_fun(z) for Im(z) >= 0 in
+// real arithmetic; faddeeva_batch() applies the reflection used by faddeeva().
+//==============================================================================
+
+#pragma omp declare target
+
+// Coefficients (highest order first) of the polynomial in Z = (L + iz)/(L - iz)
+// of Weideman's rational approximation, J. A. C. Weideman, "Computation of the
+// complex error function," SIAM J. Numer. Anal. 31.5 (1994): 1497-1518.
+constexpr double WEIDEMAN16_L {3.363585661014858};
+constexpr double WEIDEMAN16_A[16] = {
+  9.93932254115848303e-07, 3.98128757692420288e-06, -5.58423340962788117e-06,
+  -2.73464046252475113e-05, 2.17098679328037170e-05, 2.10710563965613162e-04,
+  8.70315842848717880e-05, -1.52765974012261663e-03, -3.88101518902310427e-03,
+  3.68256731709190599e-03, 5.18224024316099596e-02, 1.91241726746694235e-01,
+  4.69290900903603037e-01, 8.86447830205054021e-01, 1.36224082227195864e+00,
+  1.74839588608196195e+00};
+
+constexpr double WEIDEMAN32_L {4.756828460010884};
+constexpr double WEIDEMAN32_A[32] = {
+  -1.30255212179359728e-12, 3.73948788601197180e-12, 8.03388258696635660e-12,
+  -2.15421985805264171e-11, -5.54383136619485128e-11, 1.16582701825684865e-10,
+  4.15378280382849852e-10, -5.23100597560333114e-10, -3.20801434028350485e-09,
+  8.12494058144430653e-10, 2.37975647937593848e-08, 2.29304413096320658e-08,
+  -1.48130787760991645e-07, -4.18407636509909864e-07, 4.25583312466115693e-07,
+  4.40153173071611281e-06, 6.82103194306338256e-06, -2.14096192034385346e-05,
+  -1.30754492546292234e-04, -2.45329802703447841e-04, 3.92591360699801051e-04,
+  4.51954110534813491e-03, 1.90061557848446028e-02, 5.73044035298355819e-02,
+  1.40607162268936381e-01, 2.95444510715085928e-01, 5.46013972063932540e-01,
+  9.01925489364799216e-01, 1.34554416923454379e+00, 1.82566962963248103e+00,
+  2.26353729990026631e+00, 2.57225340812456871e+00};
+
+// Full precision 1/sqrt(pi), as SQRT_PI would limit the 32 term approximation
+constexpr double INV_SQRT_PI {0.564189583547756287};
+
+template<int N>
+inline void weideman_w(double x, double y, const double* a, double L,
+  double& w_re, double& w_im)
+{
+  // With iz = -y + ix, q = 1/(L - iz) and Z = (L + iz) q
+  double d_re = L + y;
+  double inv_d2 = 1.0 / (d_re*d_re + x*x);
+  double q_re = d_re * inv_d2;
+  double q_im = x * inv_d2;
+  double Z_re = (L*L - x*x - y*y) * inv_d2;
+  double Z_im = 2.0 * L * x * inv_d2;
+
+  // Horner evaluation of p(Z)
+  double p_re = a[0];
+  double p_im = 0.0;
+  for (int k = 1; k < N; ++k) {
+    double t = p_re*Z_re - p_im*Z_im + a[k];
+    p_im = p_re*Z_im + p_im*Z_re;
+    p_re = t;
+  }
+
+  // w = 2 p q^2 + q / sqrt(pi)
+  double q2_re = q_re*q_re - q_im*q_im;
+  double q2_im = 2.0 * q_re * q_im;
+  w_re = 2.0*(p_re*q2_re - p_im*q2_im) + q_re * INV_SQRT_PI;
+  w_im = 2.0*(p_re*q2_im + p_im*q2_re) + q_im * INV_SQRT_PI;
+}
+
+inline void humlicek8_w(double x, double y, double& w_re, double& w_im)
+{
+  // Real arithmetic form of zpf8h(). Numerator coefficients alternate between
+  // purely real and purely imaginary, lowest order first.
+  constexpr double a[8] = {+11.7559071436993, -32.310199761603,
+    -21.9357456686406, 31.490536152863, 6.75847413957232, -8.07354660639634,
+    -0.507771291744591, 0.564189504758109};
+  constexpr double b[5] = {6.5625, -52.5, 52.5, -14.0, 1.0};
+
+  y += 0.9;
+  double zz_re = x*x - y*y;
+  double zz_im = 2.0*x*y;
+
+  // Numerator, Horner's rule from the highest order (imaginary) coefficient
+  double n_re = 0.0;
+  double n_im = a[7];
+  for (int k = 6; k >= 0; --k) {
+    double t = n_re*x - n_im*y;
+    n_im = n_re*y + n_im*x;
+    n_re = t;
+    if (k % 2 == 0) {
+      n_re += a[k];
+    } else {
+      n_im += a[k];
+    }
+  }
+
+  // Denominator in z^2
+  double d_re = b[4];
+  double d_im = 0.0;
+  for (int k = 3; k >= 0; --k) {
+    double t = d_re*zz_re - d_im*zz_im + b[k];
+    d_im = d_re*zz_im + d_im*zz_re;
+    d_re = t;
+  }
+
+  double inv_d2 = 1.0 / (d_re*d_re + d_im*d_im);
+  w_re = (n_re*d_re + n_im*d_im) * inv_d2;
+  w_im = (n_im*d_re - n_re*d_im) * inv_d2;
+}
+
+void faddeeva_batch(int n, const double* z_re, const double* z_im,
+  double* w_re, double* w_im, FaddeevaMethod method)
+{
+  if (method == FaddeevaMethod::scalar) {
+    for (int i = 0; i < n; ++i) {
+      auto w = faddeeva(std::complex<double>(z_re[i], z_im[i]));
+      w_re[i] = w.real();
+      w_im[i] = w.imag();
+    }
+    return;
+  }
+
+  // Each approximation is evaluated at (x, |y|). For Im(z) <= 0, faddeeva()
+  // returns -conj(w_fun(conj(z))), which only flips the sign of the real part.
+  #pragma omp simd
+  for (int i = 0; i < n; ++i) {
+    double x = z_re[i];
+    double y = std::abs(z_im[i]);
+    double wr, wi;
+    if (method == FaddeevaMethod::humlicek8) {
+      humlicek8_w(x, y, wr, wi);
+    } else if (method == FaddeevaMethod::weideman16) {
+      weideman_w<16>(x, y, WEIDEMAN16_A, WEIDEMAN16_L, wr, wi);
+    } else {
+      weideman_w<32>(x, y, WEIDEMAN32_A, WEIDEMAN32_L, wr, wi);
+    }
+    w_re[i] = z_im[i] > 0.0 ? wr : -wr;
+    w_im[i] = wi;
+  }
+}
+
+#pragma omp end declare target
+
+#pragma omp declare target
 std::complex<double> w_derivative(std::complex<double> z, int order)
 {
   using namespace std::complex_literals;
-  switch (order) {
-  case 0:
-    return faddeeva(z);
-  case 1:
-    return -2.0*z*faddeeva(z) + 2.0i / SQRT_PI;
-    //std::complex<double> add(0.0, 2.0 / SQRT_PI);
-    //return -2.0*z*faddeeva(z) + add;
-    //return std::complex<double>-2.0*z*faddeeva(z) + 2.0i / SQRT_PI;
-  default:
-    return -2.0*z*w_derivative(z, order-1)
-      - 2.0*(order-1)*w_derivative(z, order-2);
+
+  // Use the recurrence w^(n)(z) = -2z w^(n-1)(z) - 2(n-1) w^(n-2)(z) upwards
+  // from w and w', rather than recursively, to keep the device stack small
+  std::complex<double> w = faddeeva(z);
+  if (order == 0) return w;
+  std::complex<double> dw = -2.0*z*w + 2.0i / SQRT_PI;
+  for (int n = 2; n <= order; ++n) {
+    std::complex<double> next = -2.0*z*dw - 2.0*(n-1)*w;
+    w = dw;
+    dw = next;
   }
+  return dw;
 }
+#pragma omp end declare target
 
 } // namespace openmc
@@ -0,0 +1,93 @@
+#include "openmc/memory_registry.h"
+
+#include <algorithm> // for max
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "openmc/message_passing.h"
+
+namespace openmc {
+
+namespace {
+
+//! Bytes of one subsystem in host and device memory
+struct MemoryCategory {
+  std::string name;
+  int64_t bytes[2] {0, 0};
+  int64_t peak[2] {0, 0};
+};
+
+// Subsystems in order of first allocation, followed by the totals
+std::vector<MemoryCategory> categories;
+MemoryCategory totals {"Total"};
+
+void add_bytes(MemoryCategory& c, int space, int64_t n_bytes)
+{
+  c.bytes[space] += n_bytes;
+  c.peak[space] = std::max(c.peak[space], c.bytes[space]);
+}
+
+} // namespace
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+void record_memory(const char* category, MemorySpace space, int64_t n_bytes)
+{
+  if (n_bytes == 0) return;
+
+  int s = static_cast<int>(space);
+  #pragma omp critical(memory_registry)
+  {
+    MemoryCategory* c = nullptr;
+    for (auto& existing : categories) {
+      if (existing.name == category) {
+        c = &existing;
+        break;
+      }
+    }
+    if (!c) {
+      categories.push_back({category});
+      c = &categories.back();
+    }
+    add_bytes(*c, s, n_bytes);
+    add_bytes(totals, s, n_bytes);
+  }
+}
+
+int64_t memory_in_use(MemorySpace space)
+{
+  return totals.bytes[static_cast<int>(space)];
+}
+
+void print_memory_report(const char* stage)
+{
+  // Processes hold different shares of particles and banks
+  int64_t largest[2] {totals.peak[0], totals.peak[1]};
+#ifdef OPENMC_MPI
+  MPI_Reduce(mpi::master ? MPI_IN_PLACE : largest, largest, 2, MPI_INT64_T,
+    MPI_MAX, 0, mpi::intracomm);
+#endif
+  if (!mpi::master) return;
+
+  fmt::print(" Memory by subsystem at {} [MB]:\n", stage);
+  fmt::print("   {:<30} {:>10} {:>10} {:>10} {:>10}\n", "", "Host", "Peak",
+    "Device", "Peak");
+  auto print = [](const MemoryCategory& c) {
+    fmt::print("   {:<30} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f}\n", c.name,
+      c.bytes[0] * 1.0e-6, c.peak[0] * 1.0e-6, c.bytes[1] * 1.0e-6,
+      c.peak[1] * 1.0e-6);
+  };
+  for (const auto& c : categories) print(c);
+  print(totals);
+  if (mpi::n_procs > 1) {
+    fmt::print("   {:<30} {:>10} {:>10.3f} {:>10} {:>10.3f}\n",
+      "Largest peak of any process", "", largest[0] * 1.0e-6, "",
+      largest[1] * 1.0e-6);
+  }
+}
+
+} // namespace openmc
@@ -262,34 +262,17 @@ int Mesh::n_surface_bins() const
   return 4 * n_dimension_ * n_bins();
 }
 
-xt::xtensor<double, 1>
-Mesh::count_sites(const Particle::Bank* bank,
-                            int64_t length,
-                            bool* outside) const
-{
-  // Determine shape of array for counts
-  std::size_t m = this->n_bins();
-  std::vector<std::size_t> shape = {m};
-
-  // Create array of zeros
-  xt::xarray<double> cnt {shape, 0.0};
-  bool outside_ = false;
-
-  for (int64_t i = 0; i < length; i++) {
-    const auto& site = bank[i];
-
-    // determine scoring bin for entropy mesh
-    int mesh_bin = get_bin(site.r);
+namespace {
 
-    // if outside mesh, skip particle
-    if (mesh_bin < 0) {
-      outside_ = true;
-      continue;
-    }
-
-    // Add to appropriate bin
-    cnt(mesh_bin) += site.wgt;
-  }
+//! Sum the weight of sites in each mesh bin over all processes onto the master
+//
+//! \param[in] cnt Weight of the sites of this process in each bin
+//! \param[in] outside_ Whether any site of this process is outside the mesh
+//! \param[out] outside Whether any site is outside the mesh
+xt::xtensor<double, 1> reduce_site_counts(const std::vector<double>& cnt,
+  bool outside_, bool* outside)
+{
+  std::vector<std::size_t> shape = {cnt.size()};
 
   // Create copy of count data. Since ownership will be acquired by xtensor,
   // std::allocator must be used to avoid Valgrind mismatched free() / delete
@@ -318,6 +301,64 @@ Mesh::count_sites(const Particle::Bank* bank,
   return counts;
 }
 
+} // namespace
+
+xt::xtensor<double, 1>
+Mesh::count_sites(const Particle::Bank* bank,
+                            int64_t length,
+                            bool* outside) const
+{
+  // Create array of zeros
+  std::vector<double> cnt(this->n_bins(), 0.0);
+  bool outside_ = false;
+
+  for (int64_t i = 0; i < length; i++) {
+    const auto& site = bank[i];
+
+    // determine scoring bin for entropy mesh
+    int mesh_bin = get_bin(site.r);
+
+    // if outside mesh, skip particle
+    if (mesh_bin < 0) {
+      outside_ = true;
+      continue;
+    }
+
+    // Add to appropriate bin
+    cnt[mesh_bin] += site.wgt;
+  }
+
+  return reduce_site_counts(cnt, outside_, outside);
+}
+
+xt::xtensor<double, 1>
+Mesh::count_sites_device(const Particle::Bank* bank, int64_t length,
+  bool* outside) const
+{
+  int m = this->n_bins();
+  std::vector<double> cnt(m, 0.0);
+  double* counts = cnt.data();
+
+  // The copy of this mesh in model::meshes is the one that is on device
+  int i_mesh = this - model::meshes;
+  int n_outside = 0;
+
+  #pragma omp target teams distribute parallel for map(tofrom: counts[:m]) \
+    reduction(+:n_outside)
+  for (int64_t i = 0; i < length; i++) {
+    const auto& site = bank[i];
+    int mesh_bin = model::meshes[i_mesh].get_bin(site.r);
+    if (mesh_bin < 0) {
+      ++n_outside;
+      continue;
+    }
+    #pragma omp atomic
+    counts[mesh_bin] += site.wgt;
+  }
+
+  return reduce_site_counts(cnt, n_outside > 0, outside);
+}
+
 bool Mesh::intersects(Position& r0, Position r1, int* ijk) const
 {
   switch(n_dimension_) {
@@ -561,119 +602,11 @@ bool Mesh::intersects_3d(Position& r0, Position r1, int* ijk) const
   return min_dist < INFTY;
 }
 
-//void RegularMesh::bins_crossed(const Particle* p, std::vector<int>& bins,
-//                               std::vector<double>& lengths) const
-//void RegularMesh::bins_crossed(const Particle& p, FilterMatch& match) const
 void Mesh::bins_crossed(const Particle& p, FilterMatch& match) const
 {
-  // ========================================================================
-  // Determine where the track intersects the mesh and if it intersects at all.
-
-  // Copy the starting and ending coordinates of the particle.
-  Position last_r {p.r_last_};
-  Position r {p.r()};
-  Direction u {p.u()};
-
-  // Compute the length of the entire track.
-  double total_distance = (r - last_r).norm();
-
-  // While determining if this track intersects the mesh, offset the starting
-  // and ending coords by a bit.  This avoid finite-precision errors that can
-  // occur when the mesh surfaces coincide with lattice or geometric surfaces.
-  Position r0 = last_r + TINY_BIT*u;
-  Position r1 = r - TINY_BIT*u;
-
-  // Determine the mesh indices for the starting and ending coords. Here, we
-  // use arrays for ijk0 and ijk1 instead of std::vector because we obtain a
-  // small performance improvement by forcing this data to live on the stack,
-  // rather than on the heap. We know the maximum length is 3, and by
-  // ensuring that all loops are only indexed up to n_dimension, we will not
-  // access any non-initialized values. The same concept is used throughout.
-  int n = n_dimension_;
-  int ijk0[3], ijk1[3];
-  bool start_in_mesh;
-  get_indices(r0, ijk0, &start_in_mesh);
-  bool end_in_mesh;
-  get_indices(r1, ijk1, &end_in_mesh);
-
-  // Reset coordinates and check for a mesh intersection if necessary.
-  if (start_in_mesh) {
-    // The initial coords lie in the mesh, use those coords for tallying.
-    r0 = last_r;
-  } else {
-    // The initial coords do not lie in the mesh.  Check to see if the particle
-    // eventually intersects the mesh and compute the relevant coords and
-    // indices.
-    if (!intersects(r0, r1, ijk0)) return;
-  }
-  r1 = r;
-
-  // The TINY_BIT offsets above mean that the preceding logic cannot always find
-  // the correct ijk0 and ijk1 indices. For tracks shorter than 2*TINY_BIT, just
-  // assume the track lies in only one mesh bin. These tracks are very short so
-  // any error caused by this assumption will be small. It is important that
-  // ijk0 values are used rather than ijk1 because the previous logic guarantees
-  // ijk0 is a valid mesh bin.
-  if (total_distance < 2*TINY_BIT) {
-    for (int i = 0; i < n; ++i) ijk1[i] = ijk0[i];
-  }
-
-  // ========================================================================
-  // Find which mesh cells are traversed and the length of each traversal.
-
-  while (true) {
-    if (std::equal(ijk0, ijk0 + n, ijk1)) {
-      // The track ends in this cell.  Use the particle end location rather
-      // than the mesh surface and stop iterating.
-      double distance = (r1 - r0).norm();
-      //bins.push_back(get_bin_from_indices(ijk0.data()));
-      //lengths.push_back(distance / total_distance);
-      match.push_back(get_bin_from_indices(ijk0), distance / total_distance);
-      break;
-    }
-
-    // The track exits this cell.  Determine the distance to each mesh surface.
-    double d[3];
-    for (int k = 0; k < n; ++k) {
-      if (std::fabs(u[k]) < FP_PRECISION) {
-        d[k] = INFTY;
-      } else if (u[k] > 0) {
-        double xyz_cross = positive_grid_boundary(ijk0, k);
-        d[k] = (xyz_cross - r0[k]) / u[k];
-      } else {
-        double xyz_cross = negative_grid_boundary(ijk0, k);
-        d[k] = (xyz_cross - r0[k]) / u[k];
-      }
-    }
-
-    // Pick the closest mesh surface and append this traversal to the output.
-    auto j = std::min_element(d, d + n) - d;
-    double distance = d[j];
-    //bins.push_back(get_bin_from_indices(ijk0.data()));
-    //lengths.push_back(distance / total_distance);
-    match.push_back(get_bin_from_indices(ijk0), distance / total_distance);
-
-    // Translate to the oncoming mesh surface.
-    r0 += distance * u;
-
-    // Increment the indices into the next mesh cell.
-    if (u[j] > 0.0) {
-      ++ijk0[j];
-    } else {
-      --ijk0[j];
-    }
-
-    // If the next indices are invalid, then the track has left the mesh and
-    // we are done.
-    bool in_mesh = true;
-    for (int i = 0; i < n; ++i) {
-      if (ijk0[i] < 1 || ijk0[i] > shape_[i]) {
-        in_mesh = false;
-        break;
-      }
-    }
-    if (!in_mesh) break;
-  }
+  for_each_bin_crossed(p, [&match](int bin, double fraction) {
+    match.push_back(bin, fraction);
+  });
 }
 
 //==============================================================================
@@ -2008,14 +1941,33 @@ UnstructuredMesh::write(std::string base_filename) const {
 
 void read_meshes(pugi::xml_node root)
 {
-  // Count the number of materials
-  model::meshes_size = std::distance(root.children("mesh").begin(), root.children("mesh").end());
+  // Count the new meshes. The meshes of settings.xml are kept when tallies.xml
+  // is read, and a mesh given in both (as the Python API writes them) is only
+  // read once.
+  auto is_new = [](pugi::xml_node node) {
+    int32_t id = std::stoi(get_node_value(node, "id"));
+    return model::mesh_map.find(id) == model::mesh_map.end();
+  };
+  int32_t n_old = model::meshes_size;
+  int32_t n_new = 0;
+  for (auto node : root.children("mesh")) {
+    if (is_new(node)) ++n_new;
+  }
 
   // Resize the mesh array
-  model::meshes = static_cast<Mesh*>(malloc(model::meshes_size * sizeof(Mesh)));
+  Mesh* old_meshes = model::meshes;
+  model::meshes = static_cast<Mesh*>(malloc((n_old + n_new) * sizeof(Mesh)));
+  for (int i = 0; i < n_old; ++i) {
+    new (model::meshes + i) Mesh(old_meshes[i]);
+    old_meshes[i].~Mesh();
+  }
+  free(old_meshes);
+  model::meshes_size = n_old + n_new;
 
-  int i = 0;
+  int i = n_old;
   for (auto node : root.children("mesh")) {
+    if (!is_new(node)) continue;
+
     std::string mesh_type;
     if (check_for_node(node, "type")) {
       mesh_type = get_node_value(node, "type", true, true);
@@ -2029,11 +1981,14 @@ void read_meshes(pugi::xml_node root)
     } else if (mesh_type == "rectilinear") {
       fatal_error("Rectilinear Meshes Not Yet Supported On Device!");
       //model::meshes.push_back(std::make_unique<RectilinearMesh>(node));
-#ifdef DAGMC
     } else if (mesh_type == "unstructured") {
-      model::meshes.push_back(std::make_unique<UnstructuredMesh>(node));
+      // UnstructuredMesh (MOAB) is not yet flattened for device: it would
+      // need Mesh to dispatch on a mesh kind, as Filter does on FilterType,
+      // and its tets, point location tree and neighbors as flat arrays.
+#ifdef DAGMC
+      fatal_error("Unstructured Meshes Not Yet Supported On Device!");
+      //model::meshes.push_back(std::make_unique<UnstructuredMesh>(node));
 #else
-    } else if (mesh_type == "unstructured") {
       fatal_error("Unstructured mesh support is disabled.");
 #endif
     } else {
@@ -2073,6 +2028,7 @@ void free_memory_mesh()
     model::meshes[i].~Mesh();
   }
   free(model::meshes);
+  model::meshes = nullptr;
   model::meshes_size = 0;
   model::mesh_map.clear();
 }
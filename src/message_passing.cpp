@@ -9,7 +9,9 @@ bool master {true};
 
 #ifdef OPENMC_MPI
 MPI_Comm intracomm {MPI_COMM_NULL};
+MPI_Comm intranode {MPI_COMM_NULL};
 MPI_Datatype bank {MPI_DATATYPE_NULL};
+MPI_Datatype packed_bank {MPI_DATATYPE_NULL};
 #endif
 
 extern "C" bool openmc_master() { return mpi::master; }
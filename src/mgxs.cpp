@@ -1,8 +1,10 @@
 #include "openmc/mgxs.h"
 
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <algorithm>
+#include <numeric>
 #include <sstream>
 
 #ifdef _OPENMP
@@ -19,6 +21,7 @@
 #include "openmc/math_functions.h"
 #include "openmc/mgxs_interface.h"
 #include "openmc/random_lcg.h"
+#include "openmc/search.h"
 #include "openmc/settings.h"
 #include "openmc/string_utils.h"
 
@@ -700,4 +703,687 @@ Mgxs::set_angle_index(Direction u)
   }
 }
 
+//==============================================================================
+// MgxsTables implementation
+//==============================================================================
+
+namespace {
+
+//! Append the Walker alias table of a set of weights, built by Vose's method,
+//! to the probabilities of keeping each entry and the aliases taken otherwise
+void append_alias_table(const std::vector<double>& weights,
+  vector<double>& prob, vector<int>& alias)
+{
+  int n = weights.size();
+  double sum = 0.;
+  for (double w : weights) sum += std::max(w, 0.);
+
+  std::vector<double> p(n);
+  std::vector<int> a(n);
+  std::vector<int> small;
+  std::vector<int> large;
+  for (int i = 0; i < n; ++i) {
+    p[i] = sum > 0. ? std::max(weights[i], 0.) * n / sum : 1.;
+    a[i] = i;
+    if (p[i] < 1.) {
+      small.push_back(i);
+    } else {
+      large.push_back(i);
+    }
+  }
+
+  // Fill each entry below one with the excess of an entry above one
+  while (!small.empty() && !large.empty()) {
+    int i_small = small.back();
+    small.pop_back();
+    int i_large = large.back();
+    a[i_small] = i_large;
+    p[i_large] -= 1. - p[i_small];
+    if (p[i_large] < 1.) {
+      large.pop_back();
+      small.push_back(i_large);
+    }
+  }
+
+  // The entries left differ from one only by round-off
+  for (int i : small) p[i] = 1.;
+  for (int i : large) p[i] = 1.;
+
+  for (int i = 0; i < n; ++i) {
+    prob.push_back(p[i]);
+    alias.push_back(a[i]);
+  }
+}
+
+} // namespace
+
+void
+MgxsTables::build(const MgxsInterface& mg)
+{
+  clear();
+  alias_ = settings::mg_alias_sampling;
+  n_g_ = mg.num_energy_groups_;
+  n_dg_ = mg.num_delayed_groups_;
+  energy_bin_avg_.assign(mg.energy_bin_avg_.begin(), mg.energy_bin_avg_.end());
+
+  set_start_.push_back(0);
+  kT_start_.push_back(0);
+  for (const auto& xs : mg.macro_xs_) add(xs);
+  nuclide_offset_ = mg.macro_xs_.size();
+  for (const auto& xs : mg.nuclides_) add(xs);
+}
+
+void
+MgxsTables::add(const Mgxs& xs)
+{
+  is_isotropic_.push_back(xs.is_isotropic);
+  n_pol_.push_back(xs.n_pol);
+  n_azi_.push_back(xs.n_azi);
+  for (double kT : xs.kTs) kTs_.push_back(kT);
+  kT_start_.push_back(kTs_.size());
+
+  // Sets of a temperature are consecutive, in the order of the angle index
+  int n_fission_set = nu_fission_.size() / std::max(n_g_, 1);
+  for (const auto& xs_t : xs.xs) {
+    int n_ang = xs_t.total.shape()[0];
+    for (int a = 0; a < n_ang; ++a) {
+      for (int g = 0; g < n_g_; ++g) {
+        total_.push_back(xs_t.total(a, g));
+        absorption_.push_back(xs_t.absorption(a, g));
+        inverse_velocity_.push_back(xs_t.inverse_velocity(a, g));
+      }
+      for (int d = 0; d < n_dg_; ++d) {
+        decay_rate_.push_back(xs_t.decay_rate(a, d));
+      }
+
+      if (xs.fissionable) {
+        fission_set_.push_back(n_fission_set++);
+        for (int g = 0; g < n_g_; ++g) {
+          fission_.push_back(xs_t.fission(a, g));
+          nu_fission_.push_back(xs_t.nu_fission(a, g));
+          prompt_nu_fission_.push_back(xs_t.prompt_nu_fission(a, g));
+          kappa_fission_.push_back(xs_t.kappa_fission(a, g));
+        }
+        for (int d = 0; d < n_dg_; ++d) {
+          for (int g = 0; g < n_g_; ++g) {
+            delayed_nu_fission_.push_back(xs_t.delayed_nu_fission(a, d, g));
+          }
+        }
+        for (int gin = 0; gin < n_g_; ++gin) {
+          for (int gout = 0; gout < n_g_; ++gout) {
+            chi_prompt_.push_back(xs_t.chi_prompt(a, gin, gout));
+          }
+        }
+        for (int d = 0; d < n_dg_; ++d) {
+          for (int gin = 0; gin < n_g_; ++gin) {
+            for (int gout = 0; gout < n_g_; ++gout) {
+              chi_delayed_.push_back(xs_t.chi_delayed(a, d, gin, gout));
+            }
+          }
+        }
+      } else {
+        fission_set_.push_back(C_NONE);
+      }
+
+      // The scattering representation is that of the ScattData, which for
+      // Legendre data may have been converted to tabular when read
+      const ScattData* scatt = xs_t.scatter[a].get();
+      const xt::xtensor<double, 1>* mu = nullptr;
+      const double_3dvec* fmu = nullptr;
+      double dmu = 0.;
+      const double_2dvec* max_val = nullptr;
+      if (auto leg = dynamic_cast<const ScattDataLegendre*>(scatt)) {
+        scatter_format_.push_back(AngleDistributionType::LEGENDRE);
+        max_val = &leg->max_val;
+      } else if (auto hist = dynamic_cast<const ScattDataHistogram*>(scatt)) {
+        scatter_format_.push_back(AngleDistributionType::HISTOGRAM);
+        mu = &hist->mu;
+        dmu = hist->dmu;
+        fmu = &hist->fmu;
+      } else {
+        auto tab = dynamic_cast<const ScattDataTabular*>(scatt);
+        scatter_format_.push_back(AngleDistributionType::TABULAR);
+        mu = &tab->mu;
+        dmu = tab->dmu;
+        fmu = &tab->fmu;
+      }
+      mu_start_.push_back(mu_.size());
+      n_mu_.push_back(mu ? mu->size() : 0);
+      dmu_.push_back(dmu);
+      if (mu) {
+        for (double m : *mu) mu_.push_back(m);
+      }
+
+      for (int gin = 0; gin < n_g_; ++gin) {
+        gmin_.push_back(scatt->gmin[gin]);
+        gmax_.push_back(scatt->gmax[gin]);
+        scattxs_.push_back(scatt->scattxs[gin]);
+        gout_start_.push_back(energy_.size());
+        const auto& energy = scatt->energy[gin];
+        const auto& mult = scatt->mult[gin];
+        mult_norm_.push_back(std::inner_product(mult.begin(), mult.end(),
+          energy.begin(), 0.0));
+        if (alias_) append_alias_table(energy, gout_prob_, gout_alias_);
+        for (int i_gout = 0; i_gout < energy.size(); ++i_gout) {
+          energy_.push_back(energy[i_gout]);
+          mult_.push_back(mult[i_gout]);
+          max_val_.push_back(max_val ? (*max_val)[gin][i_gout] : 0.);
+          const auto& dist = scatt->dist[gin][i_gout];
+          dist_start_.push_back(dist_.size());
+          n_dist_.push_back(dist.size());
+          for (double v : dist) dist_.push_back(v);
+          fmu_start_.push_back(fmu_.size());
+          if (fmu) {
+            for (double v : (*fmu)[gin][i_gout]) fmu_.push_back(v);
+          }
+
+          // The alias table of the cosine bins, whose masses are differences
+          // of the cumulative distribution, is padded to the length of dist
+          // (Legendre kernels are still sampled by rejection)
+          if (alias_) {
+            std::vector<double> mass(dist.size(), 0.);
+            if (scatter_format_.back() == AngleDistributionType::HISTOGRAM) {
+              for (int k = 0; k < dist.size(); ++k) {
+                mass[k] = dist[k] - (k > 0 ? dist[k - 1] : 0.);
+              }
+            } else if (scatter_format_.back() == AngleDistributionType::TABULAR) {
+              for (int k = 0; k + 1 < dist.size(); ++k) {
+                mass[k] = dist[k + 1] - dist[k];
+              }
+              if (dist.size() > 1) mass.pop_back();
+            }
+            append_alias_table(mass, mu_prob_, mu_alias_);
+            for (int k = mass.size(); k < dist.size(); ++k) {
+              mu_prob_.push_back(1.);
+              mu_alias_.push_back(k);
+            }
+          }
+        }
+      }
+    }
+  }
+  set_start_.push_back(fission_set_.size());
+}
+
+int
+MgxsTables::set_index(int handle, double sqrtkT, Direction u) const
+{
+  // Nearest temperature
+  int first = kT_start_[handle];
+  int n_kT = kT_start_[handle + 1] - first;
+  double kT = sqrtkT * sqrtkT;
+  int t = 0;
+  double min_diff = std::abs(kTs_[first] - kT);
+  for (int i = 1; i < n_kT; ++i) {
+    double diff = std::abs(kTs_[first + i] - kT);
+    if (diff < min_diff) {
+      t = i;
+      min_diff = diff;
+    }
+  }
+
+  // Angle bin, assuming equal-bin angles
+  int a = 0;
+  int n_pol = n_pol_[handle];
+  int n_azi = n_azi_[handle];
+  if (!is_isotropic_[handle]) {
+    double my_pol = std::acos(u.z);
+    double my_azi = std::atan2(u.y, u.x);
+    int p = std::floor(my_pol / (PI / n_pol));
+    a = n_azi * p + static_cast<int>(std::floor((my_azi + PI) /
+      (2. * PI / n_azi)));
+  }
+
+  return set_start_[handle] + t * n_pol * n_azi + a;
+}
+
+void
+MgxsTables::calculate_xs(int handle, Particle& p) const
+{
+  int s = set_index(handle, p.sqrtkT_, p.u_local());
+  int i = s * n_g_ + p.g_;
+  p.macro_xs_.total = total_[i];
+  p.macro_xs_.absorption = absorption_[i];
+  int f = fission_set_[s];
+  p.macro_xs_.nu_fission = f != C_NONE ? nu_fission_[f * n_g_ + p.g_] : 0.;
+}
+
+double
+MgxsTables::calc_f(int set, int gin, int gout, double mu) const
+{
+  int sg = set * n_g_ + gin;
+  if ((gout < gmin_[sg]) || (gout > gmax_[sg])) return 0.;
+  int j = gout_start_[sg] + gout - gmin_[sg];
+
+  if (scatter_format_[set] == AngleDistributionType::LEGENDRE) {
+    return evaluate_legendre(n_dist_[j] - 1, &dist_[dist_start_[j]], mu);
+  }
+
+  // Find mu bin
+  const double* mu_grid = &mu_[mu_start_[set]];
+  const double* fmu = &fmu_[fmu_start_[j]];
+  int imu;
+  if (mu == 1.) {
+    // use size -2 to have the index one before the end
+    imu = n_mu_[set] - 2;
+  } else {
+    imu = std::floor((mu + 1.) / dmu_[set] + 1.) - 1;
+  }
+  if (scatter_format_[set] == AngleDistributionType::HISTOGRAM) {
+    return fmu[imu];
+  }
+  double r = (mu - mu_grid[imu]) / (mu_grid[imu + 1] - mu_grid[imu]);
+  return (1. - r) * fmu[imu] + r * fmu[imu + 1];
+}
+
+double
+MgxsTables::get_xs(int set, MgxsType xstype, int gin, const int* gout,
+  const double* mu, const int* dg) const
+{
+  int i = set * n_g_ + gin;
+  int f = fission_set_[set];
+  switch (xstype) {
+  case MgxsType::TOTAL:
+    return total_[i];
+  case MgxsType::ABSORPTION:
+    return absorption_[i];
+  case MgxsType::INVERSE_VELOCITY:
+    return inverse_velocity_[i];
+  case MgxsType::DECAY_RATE:
+    return decay_rate_[set * n_dg_ + (dg ? *dg : 0)];
+  case MgxsType::NU_SCATTER:
+  case MgxsType::SCATTER:
+  case MgxsType::NU_SCATTER_FMU:
+  case MgxsType::SCATTER_FMU:
+    {
+      // Set the outgoing group offset index as needed, short circuiting
+      // outgoing groups from a zero portion of the scattering matrix
+      int j = 0;
+      if (gout) {
+        if ((*gout < gmin_[i]) || (*gout > gmax_[i])) return 0.;
+        j = gout_start_[i] + *gout - gmin_[i];
+      }
+      double val = scattxs_[i];
+      if (xstype == MgxsType::NU_SCATTER) {
+        if (gout) val *= energy_[j];
+      } else if (xstype == MgxsType::SCATTER) {
+        val = gout ? val * energy_[j] / mult_[j] : val / mult_norm_[i];
+      } else {
+        // Asking for f(mu) without a group and mu is not an expected path
+        if (!gout || !mu) return 0.;
+        val *= energy_[j] * calc_f(set, gin, *gout, *mu);
+        if (xstype == MgxsType::SCATTER_FMU) val /= mult_[j];
+      }
+      return val;
+    }
+  default:
+    break;
+  }
+
+  // The remaining cross sections are zero for data that is not fissionable
+  if (f == C_NONE) return 0.;
+  int i_f = f * n_g_ + gin;
+  switch (xstype) {
+  case MgxsType::FISSION:
+    return fission_[i_f];
+  case MgxsType::NU_FISSION:
+    return nu_fission_[i_f];
+  case MgxsType::PROMPT_NU_FISSION:
+    return prompt_nu_fission_[i_f];
+  case MgxsType::KAPPA_FISSION:
+    return kappa_fission_[i_f];
+  case MgxsType::DELAYED_NU_FISSION:
+    {
+      const double* dnf = &delayed_nu_fission_[f * n_dg_ * n_g_ + gin];
+      if (dg) return dnf[*dg * n_g_];
+      double val = 0.;
+      for (int d = 0; d < n_dg_; d++) val += dnf[d * n_g_];
+      return val;
+    }
+  case MgxsType::CHI_PROMPT:
+    {
+      const double* chi = &chi_prompt_[(f * n_g_ + gin) * n_g_];
+      if (gout) return chi[*gout];
+      // provide an outgoing group-wise sum
+      double val = 0.;
+      for (int g = 0; g < n_g_; g++) val += chi[g];
+      return val;
+    }
+  case MgxsType::CHI_DELAYED:
+    {
+      // Without a delayed group, that of an outgoing group is the first's and
+      // the sum over outgoing groups is that over all delayed groups
+      double val = 0.;
+      for (int d = 0; d < n_dg_; d++) {
+        if (dg ? d != *dg : (gout && d != 0)) continue;
+        const double* chi = &chi_delayed_[((f * n_dg_ + d) * n_g_ + gin) * n_g_];
+        if (gout) {
+          val += chi[*gout];
+        } else {
+          for (int g = 0; g < n_g_; g++) val += chi[g];
+        }
+      }
+      return val;
+    }
+  default:
+    return 0.;
+  }
+}
+
+void
+MgxsTables::sample_fission_energy(int set, int gin, int& dg, int& gout,
+  uint64_t* seed) const
+{
+  int f = fission_set_[set];
+  double nu_fission = nu_fission_[f * n_g_ + gin];
+
+  // Find the probability of having a prompt neutron
+  double prob_prompt = prompt_nu_fission_[f * n_g_ + gin];
+
+  // sample random numbers
+  double xi_pd = prn(seed) * nu_fission;
+  double xi_gout = prn(seed);
+
+  // Select whether the neutron is prompt or delayed
+  const double* chi;
+  if (xi_pd <= prob_prompt) {
+    // the neutron is prompt, indicated by a delayed group of -1
+    dg = -1;
+    chi = &chi_prompt_[(f * n_g_ + gin) * n_g_];
+  } else {
+    // get the delayed group
+    const double* dnf = &delayed_nu_fission_[f * n_dg_ * n_g_ + gin];
+    for (dg = 0; dg < n_dg_; ++dg) {
+      prob_prompt += dnf[dg * n_g_];
+      if (xi_pd < prob_prompt) break;
+    }
+
+    // adjust dg in case of round-off error
+    dg = std::min(dg, n_dg_ - 1);
+    chi = &chi_delayed_[((f * n_dg_ + dg) * n_g_ + gin) * n_g_];
+  }
+
+  // sample the outgoing energy group
+  double prob_gout = 0.;
+  for (gout = 0; gout < n_g_; ++gout) {
+    prob_gout += chi[gout];
+    if (xi_gout < prob_gout) break;
+  }
+}
+
+void
+MgxsTables::sample_scatter(int set, int gin, int& gout, double& mu,
+  double& wgt, uint64_t* seed) const
+{
+  // Sample the outgoing group
+  int sg = set * n_g_ + gin;
+  int j = gout_start_[sg];
+  if (alias_) {
+    int i_gout = sample_alias(&gout_prob_[j], &gout_alias_[j],
+      gmax_[sg] - gmin_[sg] + 1, seed);
+    gout = gmin_[sg] + i_gout;
+    j += i_gout;
+  } else {
+    double xi = prn(seed);
+    double prob = 0.;
+    for (gout = gmin_[sg]; gout < gmax_[sg]; ++gout) {
+      prob += energy_[j];
+      if (xi < prob) break;
+      ++j;
+    }
+  }
+
+  const double* dist = &dist_[dist_start_[j]];
+  switch (scatter_format_[set]) {
+  case AngleDistributionType::LEGENDRE:
+    {
+      // Sample mu with the scattering kernel using rejection sampling from a
+      // rectangular bounding box
+      int samples;
+      for (samples = 0; samples < MAX_SAMPLE; ++samples) {
+        mu = 2. * prn(seed) - 1.;
+        double f = calc_f(set, gin, gout, mu);
+        if (f > 0.) {
+          double u = prn(seed) * max_val_[j];
+          if (u <= f) break;
+        }
+      }
+      if (samples == MAX_SAMPLE) {
+        printf("Maximum number of Legendre expansion samples reached!\n");
+      }
+    }
+    break;
+  case AngleDistributionType::HISTOGRAM:
+    {
+      // Determine the outgoing cosine bin and select mu within it
+      int imu;
+      if (alias_) {
+        imu = sample_alias(&mu_prob_[dist_start_[j]],
+          &mu_alias_[dist_start_[j]], n_dist_[j], seed);
+      } else {
+        double xi = prn(seed);
+        if (xi < dist[0]) {
+          imu = 0;
+        } else {
+          imu = upper_bound_index(dist, dist + n_dist_[j], xi) + 1;
+        }
+      }
+      mu = prn(seed) * dmu_[set] + mu_[mu_start_[set] + imu];
+    }
+    break;
+  default:
+    {
+      // Determine the outgoing cosine bin. With an alias table, the bin is
+      // chosen first and the cumulative probability within it after.
+      int NP = n_mu_[set];
+      double xi;
+      double c_k;
+      int k;
+      if (alias_) {
+        k = sample_alias(&mu_prob_[dist_start_[j]],
+          &mu_alias_[dist_start_[j]], NP - 1, seed);
+        c_k = dist[k];
+        xi = c_k + prn(seed) * (dist[k + 1] - c_k);
+      } else {
+        xi = prn(seed);
+        c_k = dist[0];
+        for (k = 0; k < NP - 1; k++) {
+          double c_k1 = dist[k + 1];
+          if (xi < c_k1) break;
+          c_k = c_k1;
+        }
+        k = std::min(k, NP - 2);
+      }
+
+      // Invert the linear pdf between the grid points
+      const double* fmu = &fmu_[fmu_start_[j]];
+      const double* mu_grid = &mu_[mu_start_[set]];
+      double p0 = fmu[k];
+      double mu0 = mu_grid[k];
+      double p1 = fmu[k + 1];
+      double mu1 = mu_grid[k + 1];
+      if (p0 == p1) {
+        mu = mu0 + (xi - c_k) / p0;
+      } else {
+        double frac = (p1 - p0) / (mu1 - mu0);
+        mu = mu0 + (std::sqrt(std::max(0., p0 * p0 + 2. * frac * (xi - c_k)))
+                    - p0) / frac;
+      }
+    }
+  }
+
+  if (scatter_format_[set] != AngleDistributionType::LEGENDRE) {
+    mu = std::max(-1., std::min(mu, 1.));
+  }
+
+  // Update the weight to reflect neutron multiplicity
+  wgt *= mult_[j];
+}
+
+int
+MgxsTables::sample_alias(const double* prob, const int* alias, int n,
+  uint64_t* seed)
+{
+  double x = prn(seed) * n;
+  int k = std::min(static_cast<int>(x), n - 1);
+  return x - k < prob[k] ? k : alias[k];
+}
+
+void
+MgxsTables::copy_to_device()
+{
+  energy_bin_avg_.copy_to_device();
+  set_start_.copy_to_device();
+  kT_start_.copy_to_device();
+  is_isotropic_.copy_to_device();
+  n_pol_.copy_to_device();
+  n_azi_.copy_to_device();
+  kTs_.copy_to_device();
+  fission_set_.copy_to_device();
+  scatter_format_.copy_to_device();
+  mu_start_.copy_to_device();
+  n_mu_.copy_to_device();
+  dmu_.copy_to_device();
+  total_.copy_to_device();
+  absorption_.copy_to_device();
+  inverse_velocity_.copy_to_device();
+  decay_rate_.copy_to_device();
+  fission_.copy_to_device();
+  nu_fission_.copy_to_device();
+  prompt_nu_fission_.copy_to_device();
+  kappa_fission_.copy_to_device();
+  delayed_nu_fission_.copy_to_device();
+  chi_prompt_.copy_to_device();
+  chi_delayed_.copy_to_device();
+  gmin_.copy_to_device();
+  gmax_.copy_to_device();
+  scattxs_.copy_to_device();
+  mult_norm_.copy_to_device();
+  gout_start_.copy_to_device();
+  energy_.copy_to_device();
+  mult_.copy_to_device();
+  max_val_.copy_to_device();
+  dist_start_.copy_to_device();
+  n_dist_.copy_to_device();
+  fmu_start_.copy_to_device();
+  gout_prob_.copy_to_device();
+  gout_alias_.copy_to_device();
+  mu_.copy_to_device();
+  dist_.copy_to_device();
+  fmu_.copy_to_device();
+  mu_prob_.copy_to_device();
+  mu_alias_.copy_to_device();
+}
+
+void
+MgxsTables::release_device()
+{
+  energy_bin_avg_.release_device();
+  set_start_.release_device();
+  kT_start_.release_device();
+  is_isotropic_.release_device();
+  n_pol_.release_device();
+  n_azi_.release_device();
+  kTs_.release_device();
+  fission_set_.release_device();
+  scatter_format_.release_device();
+  mu_start_.release_device();
+  n_mu_.release_device();
+  dmu_.release_device();
+  total_.release_device();
+  absorption_.release_device();
+  inverse_velocity_.release_device();
+  decay_rate_.release_device();
+  fission_.release_device();
+  nu_fission_.release_device();
+  prompt_nu_fission_.release_device();
+  kappa_fission_.release_device();
+  delayed_nu_fission_.release_device();
+  chi_prompt_.release_device();
+  chi_delayed_.release_device();
+  gmin_.release_device();
+  gmax_.release_device();
+  scattxs_.release_device();
+  mult_norm_.release_device();
+  gout_start_.release_device();
+  energy_.release_device();
+  mult_.release_device();
+  max_val_.release_device();
+  dist_start_.release_device();
+  n_dist_.release_device();
+  fmu_start_.release_device();
+  gout_prob_.release_device();
+  gout_alias_.release_device();
+  mu_.release_device();
+  dist_.release_device();
+  fmu_.release_device();
+  mu_prob_.release_device();
+  mu_alias_.release_device();
+}
+
+void
+MgxsTables::clear()
+{
+  energy_bin_avg_.clear();
+  set_start_.clear();
+  kT_start_.clear();
+  is_isotropic_.clear();
+  n_pol_.clear();
+  n_azi_.clear();
+  kTs_.clear();
+  fission_set_.clear();
+  scatter_format_.clear();
+  mu_start_.clear();
+  n_mu_.clear();
+  dmu_.clear();
+  total_.clear();
+  absorption_.clear();
+  inverse_velocity_.clear();
+  decay_rate_.clear();
+  fission_.clear();
+  nu_fission_.clear();
+  prompt_nu_fission_.clear();
+  kappa_fission_.clear();
+  delayed_nu_fission_.clear();
+  chi_prompt_.clear();
+  chi_delayed_.clear();
+  gmin_.clear();
+  gmax_.clear();
+  scattxs_.clear();
+  mult_norm_.clear();
+  gout_start_.clear();
+  energy_.clear();
+  mult_.clear();
+  max_val_.clear();
+  dist_start_.clear();
+  n_dist_.clear();
+  fmu_start_.clear();
+  gout_prob_.clear();
+  gout_alias_.clear();
+  mu_.clear();
+  dist_.clear();
+  fmu_.clear();
+  mu_prob_.clear();
+  mu_alias_.clear();
+}
+
+size_t
+MgxsTables::nbytes() const
+{
+  size_t n_int = set_start_.size() + kT_start_.size() + n_pol_.size() +
+    n_azi_.size() + fission_set_.size() + mu_start_.size() + n_mu_.size() +
+    gmin_.size() + gmax_.size() + gout_start_.size() + dist_start_.size() +
+    n_dist_.size() + fmu_start_.size() + gout_alias_.size() + mu_alias_.size();
+  size_t n_double = energy_bin_avg_.size() + kTs_.size() + dmu_.size() +
+    total_.size() + absorption_.size() + inverse_velocity_.size() +
+    decay_rate_.size() + fission_.size() + nu_fission_.size() +
+    prompt_nu_fission_.size() + kappa_fission_.size() +
+    delayed_nu_fission_.size() + chi_prompt_.size() + chi_delayed_.size() +
+    scattxs_.size() + mult_norm_.size() + energy_.size() + mult_.size() +
+    max_val_.size() + mu_.size() + dist_.size() + fmu_.size() +
+    gout_prob_.size() + mu_prob_.size();
+  return n_int * sizeof(int) + n_double * sizeof(double) +
+    is_isotropic_.size() + scatter_format_.size() * sizeof(AngleDistributionType);
+}
+
 } // namespace openmc
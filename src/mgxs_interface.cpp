@@ -26,6 +26,7 @@ namespace openmc {
 
 namespace data {
   MgxsInterface mg;
+  MgxsTables mg_tables;
 }
 
 MgxsInterface::MgxsInterface(const std::string& path_cross_sections,
@@ -0,0 +1,56 @@
+#include "openmc/microbenchmark.h"
+
+#include <algorithm> // for min, max
+#include <set>
+#include <utility> // for pair
+
+#include "openmc/cell.h"
+#include "openmc/material.h"
+#include "openmc/random_lcg.h"
+
+namespace openmc {
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+BenchmarkSites find_benchmark_sites()
+{
+  std::set<std::pair<int, double>> seen;
+  BenchmarkSites sites;
+  for (int i = 0; i < model::cells.size(); ++i) {
+    const auto& c = model::cells[i];
+    if (c.type_ != Fill::MATERIAL) continue;
+    int n = std::max(c.material_.size(), c.sqrtkT_.size());
+    for (int j = 0; j < n; ++j) {
+      int mat = c.material_[c.material_.size() == 1 ? 0 : j];
+      double sqrtkT = c.sqrtkT_[c.sqrtkT_.size() == 1 ? 0 : j];
+      if (mat == MATERIAL_VOID || !seen.insert({mat, sqrtkT}).second) continue;
+      sites.material.push_back(mat);
+      sites.cell.push_back(i);
+      sites.sqrtkT.push_back(sqrtkT);
+      sites.mean_nuclides += model::materials[mat].nuclide_.size();
+    }
+  }
+  if (sites.size() > 0) sites.mean_nuclides /= sites.size();
+  return sites;
+}
+
+void sample_benchmark_site(Particle& p, int64_t id, const int* material,
+  const int* cell, const double* sqrtkT, int n_sites)
+{
+  init_particle_seeds(id, p.seeds_);
+  p.stream_ = STREAM_SOURCE;
+  int site = std::min(static_cast<int>(prn(p.current_seed()) * n_sites),
+    n_sites - 1);
+  p.id_ = id;
+  p.type_ = Particle::Type::neutron;
+  p.wgt_ = 1.0;
+  p.material_ = material[site];
+  p.sqrtkT_ = sqrtkT[site];
+  p.n_coord_ = 1;
+  p.coord_[0].cell = cell[site];
+  p.coord_[0].r = {0.0, 0.0, 0.0};
+}
+
+} // namespace openmc
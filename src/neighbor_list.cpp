@@ -44,7 +44,9 @@ namespace openmc{
       // so, we continue reading through the list.
     }
 
-    // If we reach this point, the neighbor list was found to be already full. new_elem was not successfully appended
+    // If we reach this point, the neighbor list was found to be already full.
+    // new_elem was not appended, so it will keep being found through the
+    // exhaustive search like any neighbor outside adjacent_.
     printf("A neighbor list has reached capacity. Increase size of NEIGHBOR_SIZE variable!\n");
   }
 
@@ -0,0 +1,80 @@
+#include "openmc/node_memory.h"
+
+#include <cstdint> // for uintptr_t
+
+#include "openmc/error.h"
+#include "openmc/message_passing.h"
+
+namespace openmc {
+
+//==============================================================================
+// NodeSharedMemory implementation
+//==============================================================================
+
+char* NodeSharedMemory::allocate(size_t n_bytes)
+{
+  this->free();
+
+  // Room to align the block, which MPI only guarantees for the base type
+  constexpr size_t alignment {64};
+  size_t n_alloc = n_bytes + alignment;
+
+  char* base;
+#ifdef OPENMC_MPI
+  int node_rank;
+  MPI_Comm_rank(mpi::intranode, &node_rank);
+  writer_ = (node_rank == 0);
+
+  // Only the writer contributes memory to the window; the others find the
+  // writer's memory with a query
+  MPI_Aint size = writer_ ? n_alloc : 0;
+  void* ptr;
+  int err = MPI_Win_allocate_shared(size, 1, MPI_INFO_NULL, mpi::intranode,
+    &ptr, &win_);
+  if (err != MPI_SUCCESS) {
+    fatal_error("Could not allocate node-shared memory.");
+  }
+  int disp_unit;
+  MPI_Win_shared_query(win_, 0, &size, &disp_unit, &ptr);
+  base = static_cast<char*>(ptr);
+
+  // Keep the window open for reading by all processes on the node
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, win_);
+#else
+  writer_ = true;
+  local_.reset(new char[n_alloc]);
+  base = local_.get();
+#endif
+
+  auto address = reinterpret_cast<uintptr_t>(base);
+  uintptr_t aligned = (address + alignment - 1) &
+    ~static_cast<uintptr_t>(alignment - 1);
+  data_ = base + (aligned - address);
+  size_ = n_bytes;
+  return data_;
+}
+
+void NodeSharedMemory::fence()
+{
+#ifdef OPENMC_MPI
+  if (win_ == MPI_WIN_NULL) return;
+  MPI_Win_sync(win_);
+  MPI_Barrier(mpi::intranode);
+  MPI_Win_sync(win_);
+#endif
+}
+
+void NodeSharedMemory::free()
+{
+#ifdef OPENMC_MPI
+  if (win_ != MPI_WIN_NULL) {
+    MPI_Win_unlock_all(win_);
+    MPI_Win_free(&win_);
+  }
+#endif
+  local_.reset();
+  data_ = nullptr;
+  size_ = 0;
+}
+
+} // namespace openmc
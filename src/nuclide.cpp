@@ -3,11 +3,15 @@
 #include "openmc/capi.h"
 #include "openmc/container_util.h"
 #include "openmc/cross_sections.h"
+#include "openmc/device_alloc.h"
+#include "openmc/distribution_energy.h"
 #include "openmc/endf.h"
 #include "openmc/error.h"
 #include "openmc/hdf5_interface.h"
 #include "openmc/material.h"
 #include "openmc/message_passing.h"
+#include "openmc/secondary_tables.h"
+#include "openmc/serialize.h"
 #include "openmc/photon.h"
 #include "openmc/random_lcg.h"
 #include "openmc/search.h"
@@ -15,13 +19,17 @@
 #include "openmc/simulation.h"
 #include "openmc/string_utils.h"
 #include "openmc/thermal.h"
+#include "openmc/xs_cache.h"
 
 #include <fmt/core.h>
 
 #include "xtensor/xbuilder.hpp"
 #include "xtensor/xview.hpp"
 
-#include <algorithm> // for sort, min_element
+#include <algorithm> // for sort, min, max_element, min_element, set_union
+#include <cmath>    // for ceil, log, sqrt
+#include <cstring>  // for memcpy
+#include <iterator> // for back_inserter
 #include <string> // for to_string, stoi
 #ifndef DEVICE_PRINTF
 #define printf(fmt, ...) (0)
@@ -42,6 +50,11 @@ std::unordered_map<std::string, int> nuclide_map;
 Nuclide* nuclides;
 size_t nuclides_size;
 size_t nuclides_capacity;
+size_t pruned_bytes {0};
+vector<double> union_grid;
+double* device_union_grid {nullptr};
+int union_grid_size {0};
+NodeSharedMemory shared_xs;
 } // namespace data
 
 //==============================================================================
@@ -54,13 +67,17 @@ int Nuclide::XS_FISSION {2};
 int Nuclide::XS_NU_FISSION {3};
 int Nuclide::XS_PHOTON_PROD {4};
 
-Nuclide::Nuclide(hid_t group, const std::vector<double>& temperature)
+Nuclide::Nuclide(hid_t group, const std::vector<double>& temperature,
+  int index)
 {
   // Set index of nuclide in global vector
-  index_ = data::nuclides_size;
+  index_ = index;
+  skip_ahead_params(index_ + 1, &urr_prn_mult_, &urr_prn_add_);
 
-  // Get name of nuclide from group, removing leading '/'
+  // Get name of nuclide from group, removing leading '/'. Nuclides may be
+  // read on several threads, so updates of global data are serialized.
   name_ = object_name(group).substr(1);
+  #pragma omp critical(nuclide_globals)
   data::nuclide_map[name_] = index_;
 
   read_attribute(group, "Z", Z_);
@@ -85,91 +102,112 @@ Nuclide::Nuclide(hid_t group, const std::vector<double>& temperature)
       warning("Cross sections for " + name_ + " are only available at one "
         "temperature. Reverting to nearest temperature method.");
     }
+    #pragma omp critical(nuclide_globals)
     settings::temperature_method = TemperatureMethod::NEAREST;
   }
 
-  // Determine actual temperatures to read -- start by checking whether a
-  // temperature range was given (indicated by T_max > 0), in which case all
-  // temperatures in the range are loaded irrespective of what temperatures
-  // actually appear in the model
+  // Target motion sampling broadens a single library temperature, the highest
+  // one not above the lowest model temperature, to all the others. They reach
+  // up to the end of the temperature range if one was given, so that cell
+  // temperatures can still be raised after the data are read. Where it falls
+  // back to regular tracking (probability tables, thermal scattering data),
+  // the highest library temperature not above each model temperature is used,
+  // so these are read as well.
   std::vector<int> temps_to_read;
   int n = temperature.size();
-  double T_min = n > 0 ? settings::temperature_range[0] : 0.0;
-  double T_max = n > 0 ? settings::temperature_range[1] : INFTY;
-  if (T_max > 0.0) {
-    // Determine first available temperature below or equal to T_min
-    auto T_min_it = std::upper_bound(temps_available.begin(), temps_available.end(), T_min);
-    if (T_min_it != temps_available.begin()) --T_min_it;
-
-    // Determine first available temperature above or equal to T_max
-    auto T_max_it = std::lower_bound(temps_available.begin(), temps_available.end(), T_max);
-    if (T_max_it != temps_available.end()) ++T_max_it;
-
-    // Add corresponding temperatures to vector
-    for (auto it = T_min_it; it != T_max_it; ++it) {
-      temps_to_read.push_back(std::round(*it));
-    }
-  }
-
-  switch (settings::temperature_method) {
-  case TemperatureMethod::NEAREST:
-    // Find nearest temperatures
+  if (settings::temperature_tms && n > 0) {
     for (double T_desired : temperature) {
+      auto T_it = std::upper_bound(temps_available.begin(),
+        temps_available.end(), T_desired + settings::temperature_tolerance);
+      if (T_it != temps_available.begin()) --T_it;
+      if (!contains(temps_to_read, std::round(*T_it))) {
+        temps_to_read.push_back(std::round(*T_it));
+      }
+    }
+    double T_max = *std::max_element(temperature.begin(), temperature.end());
+    tms_kT_ = std::max(T_max, settings::temperature_range[1]) * K_BOLTZMANN;
+  } else {
+    // Determine actual temperatures to read -- start by checking whether a
+    // temperature range was given (indicated by T_max > 0), in which case all
+    // temperatures in the range are loaded irrespective of what temperatures
+    // actually appear in the model
+    double T_min = n > 0 ? settings::temperature_range[0] : 0.0;
+    double T_max = n > 0 ? settings::temperature_range[1] : INFTY;
+    if (T_max > 0.0) {
+      // Determine first available temperature below or equal to T_min
+      auto T_min_it = std::upper_bound(temps_available.begin(), temps_available.end(), T_min);
+      if (T_min_it != temps_available.begin()) --T_min_it;
+
+      // Determine first available temperature above or equal to T_max
+      auto T_max_it = std::lower_bound(temps_available.begin(), temps_available.end(), T_max);
+      if (T_max_it != temps_available.end()) ++T_max_it;
+
+      // Add corresponding temperatures to vector
+      for (auto it = T_min_it; it != T_max_it; ++it) {
+        temps_to_read.push_back(std::round(*it));
+      }
+    }
 
-      // Determine closest temperature
-      double min_delta_T = INFTY;
-      double T_actual = 0.0;
-      for (auto T : temps_available) {
-        double delta_T = std::abs(T - T_desired);
-        if (delta_T < min_delta_T) {
-          T_actual = T;
-          min_delta_T = delta_T;
+    switch (settings::temperature_method) {
+    case TemperatureMethod::NEAREST:
+      // Find nearest temperatures
+      for (double T_desired : temperature) {
+
+        // Determine closest temperature
+        double min_delta_T = INFTY;
+        double T_actual = 0.0;
+        for (auto T : temps_available) {
+          double delta_T = std::abs(T - T_desired);
+          if (delta_T < min_delta_T) {
+            T_actual = T;
+            min_delta_T = delta_T;
+          }
         }
-      }
 
-      if (std::abs(T_actual - T_desired) < settings::temperature_tolerance) {
-        if (!contains(temps_to_read, std::round(T_actual))) {
-          temps_to_read.push_back(std::round(T_actual));
+        if (std::abs(T_actual - T_desired) < settings::temperature_tolerance) {
+          if (!contains(temps_to_read, std::round(T_actual))) {
+            temps_to_read.push_back(std::round(T_actual));
 
-          // Write warning for resonance scattering data if 0K is not available
-          if (std::abs(T_actual - T_desired) > 0 && T_desired == 0 && mpi::master) {
-            warning(name_ + " does not contain 0K data needed for resonance "
-              "scattering options selected. Using data at " + std::to_string(T_actual)
-              + " K instead.");
+            // Write warning for resonance scattering data if 0K is not available
+            if (std::abs(T_actual - T_desired) > 0 && T_desired == 0 && mpi::master) {
+              warning(name_ + " does not contain 0K data needed for resonance "
+                "scattering options selected. Using data at " + std::to_string(T_actual)
+                + " K instead.");
+            }
           }
+        } else {
+          fatal_error("Nuclear data library does not contain cross sections for " +
+            name_ + " at or near " + std::to_string(T_desired) + " K.");
         }
-      } else {
-        fatal_error("Nuclear data library does not contain cross sections for " +
-          name_ + " at or near " + std::to_string(T_desired) + " K.");
       }
-    }
-    break;
-
-  case TemperatureMethod::INTERPOLATION:
-    // If temperature interpolation or multipole is selected, get a list of
-    // bounding temperatures for each actual temperature present in the model
-    for (double T_desired : temperature) {
-      bool found_pair = false;
-      for (int j = 0; j < temps_available.size() - 1; ++j) {
-        if (temps_available[j] <= T_desired && T_desired < temps_available[j + 1]) {
-          int T_j = std::round(temps_available[j]);
-          int T_j1 = std::round(temps_available[j+1]);
-          if (!contains(temps_to_read, T_j)) {
-            temps_to_read.push_back(T_j);
-          }
-          if (!contains(temps_to_read, T_j1)) {
-            temps_to_read.push_back(T_j1);
+      break;
+
+    case TemperatureMethod::INTERPOLATION:
+      // If temperature interpolation or multipole is selected, get a list of
+      // bounding temperatures for each actual temperature present in the model
+      for (double T_desired : temperature) {
+        bool found_pair = false;
+        for (int j = 0; j < temps_available.size() - 1; ++j) {
+          if (temps_available[j] <= T_desired && T_desired < temps_available[j + 1]) {
+            int T_j = std::round(temps_available[j]);
+            int T_j1 = std::round(temps_available[j+1]);
+            if (!contains(temps_to_read, T_j)) {
+              temps_to_read.push_back(T_j);
+            }
+            if (!contains(temps_to_read, T_j1)) {
+              temps_to_read.push_back(T_j1);
+            }
+            found_pair = true;
           }
-          found_pair = true;
         }
-      }
 
-      if (!found_pair) {
-        fatal_error("Nuclear data library does not contain cross sections for " +
-          name_ +" at temperatures that bound " + std::to_string(T_desired) + " K.");
+        if (!found_pair) {
+          fatal_error("Nuclear data library does not contain cross sections for " +
+            name_ +" at temperatures that bound " + std::to_string(T_desired) + " K.");
+        }
       }
+      break;
     }
-    break;
   }
 
   // Sort temperatures to read
@@ -177,9 +215,13 @@ Nuclide::Nuclide(hid_t group, const std::vector<double>& temperature)
 
   double T_min_read = *std::min_element(temps_to_read.cbegin(), temps_to_read.cend());
   double T_max_read = *std::max_element(temps_to_read.cbegin(), temps_to_read.cend());
+  if (tms_kT_ > 0.0) T_max_read = tms_kT_ / K_BOLTZMANN;
 
-  data::temperature_min = std::max(data::temperature_min, T_min_read);
-  data::temperature_max = std::min(data::temperature_max, T_max_read);
+  #pragma omp critical(nuclide_globals)
+  {
+    data::temperature_min = std::max(data::temperature_min, T_min_read);
+    data::temperature_max = std::min(data::temperature_max, T_max_read);
+  }
 
   hid_t energy_group = open_group(group, "energy");
   for (const auto& T : temps_to_read) {
@@ -196,9 +238,29 @@ Nuclide::Nuclide(hid_t group, const std::vector<double>& temperature)
   }
   close_group(kT_group);
 
+  // Only the temperatures present in the model are kept if pretabulation was
+  // requested. The library temperatures read above are still needed while the
+  // reactions are being pretabulated.
+  std::vector<PretabulatedTemperature> pretab;
+  if (settings::pretabulate_temperatures && !settings::temperature_tms && n > 0) {
+    pretab = this->plan_pretabulation(temperature);
+  }
+
+  // 0K elastic scattering data is only used by resonance scattering
+  bool read_0K = !settings::prune_nuclear_data || (settings::res_scat_on &&
+    (settings::res_scat_nuclides.empty() ||
+    contains(settings::res_scat_nuclides, name_)));
+  hsize_t pruned = 0;
+
   // Check for 0K energy grid
   if (object_exists(energy_group, "0K")) {
-    read_dataset(energy_group, "0K", energy_0K_);
+    if (read_0K) {
+      read_dataset(energy_group, "0K", energy_0K_);
+    } else {
+      hid_t dset = open_dataset(energy_group, "0K");
+      pruned += H5Dget_storage_size(dset);
+      close_dataset(dset);
+    }
   }
   close_group(energy_group);
 
@@ -208,17 +270,23 @@ Nuclide::Nuclide(hid_t group, const std::vector<double>& temperature)
     if (starts_with(name, "reaction_")) {
       hid_t rx_group = open_group(rxs_group, name.c_str());
       Reaction rx(rx_group, temps_to_read);
+      if (!pretab.empty()) this->pretabulate_reaction(pretab, rx);
       reactions_.emplace_back(rx);
 
       // Check for 0K elastic scattering
       if (rx.mt_ == ELASTIC) {
         if (object_exists(rx_group, "0K")) {
           hid_t temp_group = open_group(rx_group, "0K");
-          read_dataset(temp_group, "xs", elastic_0K_);
+          if (read_0K) {
+            read_dataset(temp_group, "xs", elastic_0K_);
+          } else {
+            pruned += storage_size(temp_group);
+          }
           close_group(temp_group);
         }
       }
       close_group(rx_group);
+      pruned += rx.pruned_bytes_;
 
       // Determine reaction indices for inelastic scattering reactions
       if (is_inelastic_scatter(rx.mt_) && !rx.redundant_) {
@@ -231,11 +299,21 @@ Nuclide::Nuclide(hid_t group, const std::vector<double>& temperature)
   // Read unresolved resonance probability tables if present
   if (object_exists(group, "urr")) {
     urr_present_ = true;
-    urr_data_.reserve(temps_to_read.size());
 
-    for (int i = 0; i < temps_to_read.size(); i++) {
+    // Probability tables cannot be combined, so a pretabulated temperature
+    // uses the tables of the nearer of its bounding temperatures
+    std::vector<int> urr_temps = temps_to_read;
+    if (!pretab.empty()) {
+      urr_temps.clear();
+      for (const auto& T : pretab) {
+        urr_temps.push_back(temps_to_read[T.f < 0.5 ? T.lo : T.hi]);
+      }
+    }
+    urr_data_.reserve(urr_temps.size());
+
+    for (int i = 0; i < urr_temps.size(); i++) {
       // Get temperature as a string
-      std::string temp_str {std::to_string(temps_to_read[i]) + "K"};
+      std::string temp_str {std::to_string(urr_temps[i]) + "K"};
 
       // Read probability tables for i-th temperature
       hid_t urr_group = open_group(group, ("urr/" + temp_str).c_str());
@@ -279,6 +357,19 @@ Nuclide::Nuclide(hid_t group, const std::vector<double>& temperature)
     }
   }
 
+  // Replace the library temperatures with the pretabulated ones
+  if (!pretab.empty()) {
+    std::vector<EnergyGrid> grid;
+    kTs_.clear();
+    for (auto& T : pretab) {
+      kTs_.push_back(T.kT);
+      grid.emplace_back();
+      grid.back().energy = std::move(T.energy);
+    }
+    grid_ = std::move(grid);
+    pretabulated_ = true;
+  }
+
   // Check for total nu data
   if (object_exists(group, "total_nu")) {
     // Read total nu data
@@ -305,14 +396,181 @@ Nuclide::Nuclide(hid_t group, const std::vector<double>& temperature)
     close_group(fer_group);
   }
 
+  #pragma omp atomic
+  data::pruned_bytes += pruned;
+
+  this->create_derived(prompt_photons_.get(), delayed_photons_.get());
+  if (settings::inelastic_cdf) this->init_inelastic_cdf();
+}
+
+namespace {
+
+// Functions of energy that a nuclide may lack are preceded by a flag
+void write_cached_function(XsCacheWriter& cache,
+  const std::unique_ptr<Function1DFlatContainer>& func)
+{
+  cache.write<bool>(func != nullptr);
+  if (func) cache.write_array(func->data(), func->size());
+}
+
+std::unique_ptr<Function1DFlatContainer> read_cached_function(XsCacheReader& cache)
+{
+  if (!cache.read<bool>()) return nullptr;
+  size_t n;
+  const uint8_t* data = cache.read_array<uint8_t>(n);
+  return std::make_unique<Function1DFlatContainer>(data, n);
+}
+
+} // namespace
+
+Nuclide::Nuclide(XsCacheReader& cache, int index)
+{
+  index_ = index;
+  skip_ahead_params(index_ + 1, &urr_prn_mult_, &urr_prn_add_);
+
+  name_ = cache.read_string();
+  data::nuclide_map[name_] = index_;
+  Z_ = cache.read<int>();
+  A_ = cache.read<int>();
+  metastable_ = cache.read<int>();
+  awr_ = cache.read<double>();
+
+  cache.read(kTs_);
+  pretabulated_ = cache.read<bool>();
+  tms_kT_ = cache.read<double>();
+  grid_.resize(kTs_.size());
+  for (auto& grid : grid_) cache.read(grid.energy);
+  cache.read(energy_0K_);
+  cache.read(elastic_0K_);
+
+  auto n_reactions = cache.read<uint64_t>();
+  reactions_.reserve(n_reactions);
+  for (int i = 0; i < n_reactions; ++i) {
+    size_t n;
+    const uint8_t* data = cache.read_array<uint8_t>(n);
+    reactions_.emplace_back(data, n);
+  }
+  cache.read(index_inelastic_scatter_);
+
+  urr_present_ = cache.read<bool>();
+  urr_inelastic_ = cache.read<int>();
+  auto n_urr = cache.read<uint64_t>();
+  urr_data_.reserve(n_urr);
+  for (int i = 0; i < n_urr; ++i) {
+    urr_data_.emplace_back(cache);
+  }
+
+  total_nu_ = read_cached_function(cache);
+  fission_q_prompt_ = read_cached_function(cache);
+  fission_q_recov_ = read_cached_function(cache);
+  fragments_ = read_cached_function(cache);
+  betas_ = read_cached_function(cache);
+  prompt_photons_ = read_cached_function(cache);
+  delayed_photons_ = read_cached_function(cache);
+
   this->create_derived(prompt_photons_.get(), delayed_photons_.get());
+  if (settings::inelastic_cdf) this->init_inelastic_cdf();
+}
+
+void Nuclide::write_cache(XsCacheWriter& cache) const
+{
+  cache.write(name_);
+  cache.write(Z_);
+  cache.write(A_);
+  cache.write(metastable_);
+  cache.write(awr_);
+
+  cache.write(kTs_);
+  cache.write(pretabulated_);
+  cache.write(tms_kT_);
+  for (const auto& grid : grid_) cache.write(grid.energy);
+  cache.write(energy_0K_);
+  cache.write(elastic_0K_);
+
+  cache.write<uint64_t>(reactions_.size());
+  for (const auto& rx : reactions_) {
+    cache.write_array(rx.data(), rx.size());
+  }
+  cache.write(index_inelastic_scatter_);
+
+  cache.write(urr_present_);
+  cache.write(urr_inelastic_);
+  cache.write<uint64_t>(urr_data_.size());
+  for (const auto& urr : urr_data_) urr.write_cache(cache);
+
+  write_cached_function(cache, total_nu_);
+  write_cached_function(cache, fission_q_prompt_);
+  write_cached_function(cache, fission_q_recov_);
+  write_cached_function(cache, fragments_);
+  write_cached_function(cache, betas_);
+  write_cached_function(cache, prompt_photons_);
+  write_cached_function(cache, delayed_photons_);
 }
 
-void Nuclide::flatten_xs_data()
+void Nuclide::init_inelastic_cdf()
+{
+  int n_channels = index_inelastic_scatter_.size();
+  if (n_channels < INELASTIC_CDF_MIN_CHANNELS) return;
+
+  // Rows start at the lowest threshold of any channel at each temperature
+  int n_temps = kTs_.size();
+  inelastic_cdf_start_.resize(n_temps);
+  inelastic_cdf_row_.resize(n_temps);
+  int n_rows = 0;
+  for (int t = 0; t < n_temps; ++t) {
+    int n_grid = grid_[t].energy.size();
+    int start = n_grid;
+    for (int i_rx : index_inelastic_scatter_) {
+      start = std::min(start, reactions_[i_rx].obj().xs_threshold(t));
+    }
+    inelastic_cdf_start_[t] = start;
+    inelastic_cdf_row_[t] = n_rows;
+    n_rows += n_grid - start;
+  }
+
+  inelastic_cdf_.resize(static_cast<size_t>(n_rows) * n_channels);
+  inelastic_cdf_exact_.resize(n_rows, true);
+  for (int t = 0; t < n_temps; ++t) {
+    int n_grid = grid_[t].energy.size();
+    int start = inelastic_cdf_start_[t];
+    double* cdf = &inelastic_cdf_[inelastic_cdf_row_[t] * n_channels];
+    for (int k = 0; k < n_channels; ++k) {
+      auto rx = reactions_[index_inelastic_scatter_[k]].obj();
+      int threshold = rx.xs_threshold(t);
+      auto value = rx.xs_value(t);
+      for (int i = start; i < n_grid; ++i) {
+        double xs = i < threshold ? 0.0 : value[i - threshold];
+        double previous = k > 0 ? cdf[(i - start) * n_channels + k - 1] : 0.0;
+        cdf[(i - start) * n_channels + k] = previous + xs;
+      }
+      if (threshold > start && !value.empty() && value[0] != 0.0) {
+        inelastic_cdf_exact_[inelastic_cdf_row_[t] + threshold - 1 - start] =
+          false;
+      }
+    }
+  }
+}
+
+size_t Nuclide::flat_xs_nbytes() const
+{
+  size_t n_energy = 0;
+  for (const auto& grid : grid_) n_energy += grid.energy.size();
+  size_t n_index = kTs_.size() *
+    (settings::energy_grid_method == EnergyGridMethod::unionized ?
+    data::union_grid.size() : settings::n_log_bins + 1);
+  return aligned(n_energy * 5 * sizeof(FlatXS), 64) +
+    aligned(n_energy * sizeof(double), 64) + aligned(n_index * sizeof(int), 64);
+}
+
+void Nuclide::flatten_xs_data(char* shared)
 {
   // Allocate array to store 1D jagged offsets for each temperature
   int n_temps = kTs_.size();
-  flat_temp_offsets_ = new int[n_temps];
+  flat_shared_ = (shared != nullptr);
+  flat_arena_ = settings::device_arena && !flat_shared_ && !flat_host_;
+  flat_temp_offsets_ = flat_arena_ ?
+    data::device_arena.allocate<int>(n_temps, "Nuclide pointwise XS") :
+    new int[n_temps];
 
   // Compute offsets for each temperature and total # of gridpoints
   total_energy_gridpoints_ = 0;
@@ -321,11 +579,37 @@ void Nuclide::flatten_xs_data()
     total_energy_gridpoints_ += grid_[t].energy.size();
   }
 
-  total_index_gridpoints_ = n_temps * (settings::n_log_bins + 1);
-
-  // Allocate space for grid information and populate
-  flat_grid_energy_ = new double[total_energy_gridpoints_];
-  flat_grid_index_ = new int[total_index_gridpoints_];
+  bool unionized = settings::energy_grid_method == EnergyGridMethod::unionized;
+  index_gridpoints_per_temp_ = unionized ? data::union_grid.size() :
+    settings::n_log_bins + 1;
+  total_index_gridpoints_ = n_temps * index_gridpoints_per_temp_;
+
+  // Allocate space for grid information and populate. Node-shared arrays are
+  // laid out as flat_xs_nbytes() counts them, and only one process per node
+  // fills them.
+  if (flat_shared_) {
+    flat_xs_ = reinterpret_cast<FlatXS*>(shared);
+    shared += aligned(total_energy_gridpoints_ * 5 * sizeof(FlatXS), 64);
+    flat_grid_energy_ = reinterpret_cast<double*>(shared);
+    shared += aligned(total_energy_gridpoints_ * sizeof(double), 64);
+    flat_grid_index_ = reinterpret_cast<int*>(shared);
+    if (!data::shared_xs.writer()) return;
+  } else if (flat_arena_) {
+    flat_grid_energy_ = data::device_arena.allocate<double>(
+      total_energy_gridpoints_, "Nuclide pointwise XS");
+    flat_grid_index_ = data::device_arena.allocate<int>(
+      total_index_gridpoints_, "Nuclide pointwise XS");
+  } else if (flat_host_) {
+    // Host-resident arrays are read by the device in place
+    auto allocator = host_resident_allocator();
+    flat_grid_energy_ = static_cast<double*>(omp_alloc(
+      total_energy_gridpoints_ * sizeof(double), allocator));
+    flat_grid_index_ = static_cast<int*>(omp_alloc(
+      total_index_gridpoints_ * sizeof(int), allocator));
+  } else {
+    flat_grid_energy_ = new double[total_energy_gridpoints_];
+    flat_grid_index_ = new int[total_index_gridpoints_];
+  }
   for (int t = 0; t < n_temps; t++) {
     int energy_offset = flat_temp_offsets_[t];
 
@@ -333,15 +617,36 @@ void Nuclide::flatten_xs_data()
       flat_grid_energy_[energy_offset + e] = grid_[t].energy[e];
     }
 
-    int grid_offset = t * (settings::n_log_bins + 1);
-
-    for (int i = 0; i < grid_[t].grid_index.size(); i++) {
-      flat_grid_index_[grid_offset + i] = grid_[t].grid_index[i];
+    int grid_offset = t * index_gridpoints_per_temp_;
+
+    if (unionized) {
+      // Determine corresponding indices in nuclide grid to energies on the
+      // unionized grid, as init_grid() does for the logarithmic grid
+      const auto& energy = grid_[t].energy;
+      int j = 0;
+      for (int k = 0; k < data::union_grid.size(); ++k) {
+        while (energy[j + 1] <= data::union_grid[k]) {
+          if (j + 2 == energy.size()) break;
+          ++j;
+        }
+        flat_grid_index_[grid_offset + k] = j;
+      }
+    } else {
+      for (int i = 0; i < grid_[t].grid_index.size(); i++) {
+        flat_grid_index_[grid_offset + i] = grid_[t].grid_index[i];
+      }
     }
   }
 
   // Allocate space for XS data and fill
-  flat_xs_ = new double[total_energy_gridpoints_ * 5];
+  if (flat_host_) {
+    flat_xs_ = static_cast<FlatXS*>(omp_alloc(total_energy_gridpoints_ * 5 *
+      sizeof(FlatXS), host_resident_allocator()));
+  } else if (!flat_shared_) {
+    flat_xs_ = flat_arena_ ? data::device_arena.allocate<FlatXS>(
+      total_energy_gridpoints_ * 5, "Nuclide pointwise XS") :
+      new FlatXS[total_energy_gridpoints_ * 5];
+  }
   int idx = 0;
   for (int t = 0; t < n_temps; t++) {
     for (int e = 0; e < grid_[t].energy.size(); e++) {
@@ -364,12 +669,22 @@ Nuclide::~Nuclide()
 {
   data::nuclide_map.erase(name_);
 
-  // These arrays are only allocated if 1D flattening function was called
-  if (flat_temp_offsets_ != nullptr) {
+  // These arrays are only allocated if 1D flattening function was called, and
+  // are owned by data::device_arena if they were packed into it or by
+  // data::shared_xs if they are shared by the node. Host-resident arrays come
+  // from an OpenMP allocator.
+  if (flat_temp_offsets_ != nullptr && !flat_arena_) {
     delete[] flat_temp_offsets_;
-    delete[] flat_grid_index_;
-    delete[] flat_grid_energy_;
-    delete[] flat_xs_;
+    if (flat_host_) {
+      auto allocator = host_resident_allocator();
+      omp_free(flat_grid_index_, allocator);
+      omp_free(flat_grid_energy_, allocator);
+      omp_free(flat_xs_, allocator);
+    } else if (!flat_shared_) {
+      delete[] flat_grid_index_;
+      delete[] flat_grid_energy_;
+      delete[] flat_xs_;
+    }
   }
 }
 
@@ -462,6 +777,8 @@ void Nuclide::create_derived(const Function1DFlatContainer* prompt_photons, cons
   // Calculate nu-fission cross section
   device_fission_rx_ = fission_rx_.data();
   device_total_nu_ = total_nu_.get();
+  device_prompt_photons_ = prompt_photons_.get();
+  device_delayed_photons_ = delayed_photons_.get();
   for (int t = 0; t < kTs_.size(); ++t) {
     if (fissionable_) {
       int n = grid_[t].energy.size();
@@ -513,6 +830,15 @@ void Nuclide::create_derived(const Function1DFlatContainer* prompt_photons, cons
               / 2.0 * (E[i+1] - E[i]);
         xs_cdf_[i+1] = xs_cdf_sum;
       }
+
+      // Build the maxima of the 0K elastic XS over blocks of grid points that
+      // bound it for DBRC
+      int n_blocks = E.size() / ELASTIC_0K_BLOCK;
+      elastic_0K_block_max_.resize(n_blocks);
+      for (int b = 0; b < n_blocks; ++b) {
+        elastic_0K_block_max_[b] = *std::max_element(
+          xs.begin() + b*ELASTIC_0K_BLOCK, xs.begin() + (b + 1)*ELASTIC_0K_BLOCK);
+      }
     }
   }
 }
@@ -604,6 +930,11 @@ double Nuclide::calculate_elastic_xs(int i_temp, int i_grid, double interp_facto
 
 
 double Nuclide::elastic_xs_0K(double E) const
+{
+  return elastic_xs_0K(E, energy_0K_.size());
+}
+
+double Nuclide::elastic_xs_0K(double E, int n_search) const
 {
   // Determine index on nuclide energy grid
   int i_grid;
@@ -613,7 +944,8 @@ double Nuclide::elastic_xs_0K(double E) const
   } else if (E > energy_0K_[n-1]) {
     i_grid = n - 2;
   } else {
-    i_grid = lower_bound_index(energy_0K_.begin(), energy_0K_.end(), E);
+    i_grid = lower_bound_index(energy_0K_.begin(),
+      energy_0K_.begin() + n_search, E);
   }
 
   // check for rare case where two energy points are the same
@@ -627,6 +959,137 @@ double Nuclide::elastic_xs_0K(double E) const
   return (1.0 - f)*elastic_0K_[i_grid] + f*elastic_0K_[i_grid + 1];
 }
 
+double Nuclide::sample_fission_spectrum(double E_in, uint64_t* seed) const
+{
+  int bin = (std::log(E_in) - fission_spectrum_log_E_min_) *
+    fission_spectrum_inv_du_;
+  bin = std::max(0, std::min(bin, fission_spectrum_bins_ - 1));
+  const double* q = &fission_spectrum_[bin * FISSION_SPECTRUM_QUANTILES];
+
+  // Outgoing energies are uniformly distributed between adjacent quantiles
+  double x = prn(seed) * (FISSION_SPECTRUM_QUANTILES - 1);
+  int k = std::min(static_cast<int>(x), FISSION_SPECTRUM_QUANTILES - 2);
+  return q[k] + (x - k) * (q[k + 1] - q[k]);
+}
+
+double Nuclide::init_fission_spectrum(bool validate)
+{
+  if (!fissionable_ || fission_rx_.empty()) return 0.0;
+
+  constexpr int neutron = static_cast<int>(Particle::Type::neutron);
+  double log_E_min = std::log(data::energy_min[neutron]);
+  double log_E_max = std::log(data::energy_max[neutron]);
+  int n_bins = std::max(1, static_cast<int>(std::ceil(
+    (log_E_max - log_E_min) / std::log(10.0) * FISSION_SPECTRUM_BINS_PER_DECADE)));
+  fission_spectrum_mt_ = fission_rx_[0]->obj().mt();
+  fission_spectrum_bins_ = n_bins;
+  fission_spectrum_log_E_min_ = log_E_min;
+  fission_spectrum_inv_du_ = n_bins / (log_E_max - log_E_min);
+  fission_spectrum_.resize(n_bins * FISSION_SPECTRUM_QUANTILES);
+
+  // Samples of the exact spectrum, resampled above the maximum neutron energy
+  // like sample_fission_neutron() does
+  auto rx = fission_rx_[0]->obj();
+  int n_samples = FISSION_SPECTRUM_QUANTILES * FISSION_SPECTRUM_SAMPLES;
+  std::vector<double> samples(n_samples);
+  auto sample_exact = [&](double E_in, uint64_t* seed) {
+    for (auto& E_out : samples) {
+      double mu;
+      for (int n = 0; n < MAX_SAMPLE; ++n) {
+        rx.products(0).sample(E_in, E_out, mu, seed);
+        if (E_out < data::energy_max[neutron]) break;
+      }
+    }
+    std::sort(samples.begin(), samples.end());
+  };
+
+  uint64_t seed = init_seed(index_, STREAM_SOURCE);
+  double max_distance = 0.0;
+  for (int b = 0; b < n_bins; ++b) {
+    double E_in = std::exp(log_E_min + (b + 0.5) / fission_spectrum_inv_du_);
+    sample_exact(E_in, &seed);
+    double* q = &fission_spectrum_[b * FISSION_SPECTRUM_QUANTILES];
+    for (int j = 0; j < FISSION_SPECTRUM_QUANTILES; ++j) {
+      q[j] = samples[static_cast<int64_t>(n_samples - 1) * j /
+        (FISSION_SPECTRUM_QUANTILES - 1)];
+    }
+    if (!validate) continue;
+
+    // Kolmogorov-Smirnov distance between the CDF of the table and that of
+    // independent exact samples
+    sample_exact(E_in, &seed);
+    for (int i = 0; i < n_samples; ++i) {
+      double x = samples[i];
+      int k = std::upper_bound(q, q + FISSION_SPECTRUM_QUANTILES, x) - q - 1;
+      double cdf;
+      if (k < 0) {
+        cdf = 0.0;
+      } else if (k >= FISSION_SPECTRUM_QUANTILES - 1) {
+        cdf = 1.0;
+      } else {
+        double f = q[k + 1] > q[k] ? (x - q[k]) / (q[k + 1] - q[k]) : 0.0;
+        cdf = (k + f) / (FISSION_SPECTRUM_QUANTILES - 1);
+      }
+      max_distance = std::max({max_distance,
+        std::abs(cdf - static_cast<double>(i) / n_samples),
+        std::abs(cdf - static_cast<double>(i + 1) / n_samples)});
+    }
+  }
+  return max_distance;
+}
+
+double Nuclide::elastic_0K_max(int first, int last) const
+{
+  // Full blocks within the range are covered by their maxima, leaving at
+  // most two partial blocks of points to check at its ends
+  int b_first = (first + ELASTIC_0K_BLOCK - 1) / ELASTIC_0K_BLOCK;
+  int b_last = last / ELASTIC_0K_BLOCK;
+  if (b_first >= b_last) {
+    return *std::max_element(&elastic_0K_[first], &elastic_0K_[last]);
+  }
+
+  double xs_max = elastic_0K_block_max_[b_first];
+  for (int i = first; i < b_first*ELASTIC_0K_BLOCK; ++i) {
+    xs_max = std::max(xs_max, elastic_0K_[i]);
+  }
+  for (int b = b_first; b < b_last; ++b) {
+    xs_max = std::max(xs_max, elastic_0K_block_max_[b]);
+  }
+  for (int i = b_last*ELASTIC_0K_BLOCK; i < last; ++i) {
+    xs_max = std::max(xs_max, elastic_0K_[i]);
+  }
+  return xs_max;
+}
+
+int Nuclide::sample_inelastic_channel(const NuclideMicroXS& micro,
+  double cutoff) const
+{
+  // Multipole lookups leave no grid index, and below the lowest threshold
+  // there are no rows
+  if (inelastic_cdf_.size() == 0 || micro.index_temp < 0) return C_NONE;
+  int start = inelastic_cdf_start_[micro.index_temp];
+  if (micro.index_grid < start) return C_NONE;
+  int row = inelastic_cdf_row_[micro.index_temp] + micro.index_grid - start;
+  if (!inelastic_cdf_exact_[row]) return C_NONE;
+
+  // Bisect the sums interpolated between the rows bounding the energy
+  int n = index_inelastic_scatter_.size();
+  const double* lower = &inelastic_cdf_[row * n];
+  const double* upper = lower + n;
+  double f = micro.interp_factor;
+  int low = 0;
+  int high = n - 1;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if ((1.0 - f)*lower[mid] + f*upper[mid] >= cutoff) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return index_inelastic_scatter_[low];
+}
+
 std::pair<gsl::index, double> Nuclide::find_temperature(double T) const
 {
   Expects(T >= 0.0);
@@ -636,7 +1099,7 @@ std::pair<gsl::index, double> Nuclide::find_temperature(double T) const
   double f = 0.0;
   double kT = K_BOLTZMANN * T;
   gsl::index n = kTs_.size();
-  switch (settings::temperature_method) {
+  switch (pretabulated_ ? TemperatureMethod::NEAREST : settings::temperature_method) {
   case TemperatureMethod::NEAREST:
     {
       double max_diff = INFTY;
@@ -663,6 +1126,142 @@ std::pair<gsl::index, double> Nuclide::find_temperature(double T) const
   return {i_temp, f};
 }
 
+std::vector<Nuclide::PretabulatedTemperature> Nuclide::plan_pretabulation(
+  const std::vector<double>& temperature) const
+{
+  std::vector<PretabulatedTemperature> pretab;
+  int n = kTs_.size();
+  for (double T : temperature) {
+    PretabulatedTemperature entry {0, 0, 0.0, K_BOLTZMANN * T, {}};
+    if (settings::temperature_method == TemperatureMethod::NEAREST || n == 1) {
+      // Keep only the library temperature nearest to T
+      for (int t = 1; t < n; ++t) {
+        if (std::abs(kTs_[t] - entry.kT) < std::abs(kTs_[entry.lo] - entry.kT)) {
+          entry.lo = t;
+        }
+      }
+      entry.hi = entry.lo;
+    } else {
+      // Find the library temperatures that bound T
+      int t = 0;
+      while (t < n - 2 && kTs_[t + 1] <= entry.kT) ++t;
+      double f = (entry.kT - kTs_[t]) / (kTs_[t + 1] - kTs_[t]);
+      if (f <= 0.0) {
+        entry.lo = entry.hi = t;
+      } else if (f >= 1.0) {
+        entry.lo = entry.hi = t + 1;
+      } else {
+        entry.lo = t;
+        entry.hi = t + 1;
+        entry.f = f;
+      }
+    }
+
+    // Temperatures that need no interpolation keep their library value
+    if (entry.lo == entry.hi) entry.kT = kTs_[entry.lo];
+
+    bool duplicate = false;
+    for (const auto& other : pretab) {
+      if (other.lo == entry.lo && other.hi == entry.hi && other.kT == entry.kT) {
+        duplicate = true;
+      }
+    }
+    if (!duplicate) pretab.push_back(entry);
+  }
+
+  std::sort(pretab.begin(), pretab.end(),
+    [](const PretabulatedTemperature& a, const PretabulatedTemperature& b) {
+      return a.kT < b.kT;
+    });
+
+  // Both bounding cross sections are linear between the points of the union
+  // of their grids, so their combination is exact on the union grid. Repeated
+  // energies (discontinuities) in either grid are preserved.
+  for (auto& entry : pretab) {
+    const auto& E_lo = grid_[entry.lo].energy;
+    const auto& E_hi = grid_[entry.hi].energy;
+    if (entry.lo == entry.hi) {
+      entry.energy = E_lo;
+    } else {
+      std::set_union(E_lo.begin(), E_lo.end(), E_hi.begin(), E_hi.end(),
+        std::back_inserter(entry.energy));
+    }
+  }
+
+  return pretab;
+}
+
+//! Evaluate a reaction cross section given on one energy grid at every point
+//! of a grid that contains all of its points, exactly as ReactionFlat::xs()
+//! would when looking up those energies
+//
+//! \param[in] grid Energy grid of the cross section
+//! \param[in] xs Cross section on the grid
+//! \param[in] shared Grid to evaluate the cross section on
+//! \param[out] first Index of the first shared point at or above the threshold
+//! \return Cross section at each point of the shared grid
+static std::vector<double> interpolate_to_grid(const std::vector<double>& grid,
+  const Reaction::TemperatureXS& xs, const std::vector<double>& shared,
+  int& first)
+{
+  std::vector<double> values(shared.size(), 0.0);
+  first = shared.size();
+  int n = grid.size();
+  int j = -1;
+  for (int k = 0; k < shared.size(); ++k) {
+    // Advance to the last grid point below E, and onto E itself at most once
+    // so that each of a repeated pair of energies keeps its own value
+    double E = shared[k];
+    while (j + 1 < n && grid[j + 1] < E) ++j;
+    if (j + 1 < n && grid[j + 1] == E) ++j;
+
+    int i = j;
+    double f = 0.0;
+    if (j < 0) {
+      i = 0;
+    } else if (j == n - 1) {
+      i = n - 2;
+      f = 1.0;
+    } else if (E > grid[j]) {
+      f = (E - grid[j]) / (grid[j + 1] - grid[j]);
+    }
+
+    if (i >= xs.threshold) {
+      if (first == shared.size()) first = k;
+      int i_xs = i - xs.threshold;
+      values[k] = (1.0 - f) * xs.value[i_xs] + f * xs.value[i_xs + 1];
+    }
+  }
+  return values;
+}
+
+void Nuclide::pretabulate_reaction(
+  const std::vector<PretabulatedTemperature>& pretab, Reaction& rx) const
+{
+  std::vector<Reaction::TemperatureXS> xs;
+  for (const auto& T : pretab) {
+    if (T.lo == T.hi) {
+      xs.push_back(rx.xs_[T.lo]);
+      continue;
+    }
+
+    int first_lo;
+    int first_hi;
+    auto xs_lo = interpolate_to_grid(grid_[T.lo].energy, rx.xs_[T.lo], T.energy, first_lo);
+    auto xs_hi = interpolate_to_grid(grid_[T.hi].energy, rx.xs_[T.hi], T.energy, first_hi);
+
+    // Weighting the bounding cross sections by their sampling probabilities
+    // gives the mean of stochastic interpolation between the two
+    Reaction::TemperatureXS combined;
+    combined.threshold = std::min(first_lo, first_hi);
+    for (int k = combined.threshold; k < T.energy.size(); ++k) {
+      combined.value.push_back((1.0 - T.f) * xs_lo[k] + T.f * xs_hi[k]);
+    }
+    xs.push_back(std::move(combined));
+  }
+  rx.xs_ = std::move(xs);
+}
+
 double Nuclide::collapse_rate(int MT, double temperature, gsl::span<const double> energy,
   gsl::span<const double> flux) const
 {
@@ -698,6 +1297,11 @@ void Nuclide::copy_to_device()
 {
   // Reactions
   index_inelastic_scatter_.copy_to_device();
+  inelastic_cdf_.copy_to_device();
+  inelastic_cdf_exact_.copy_to_device();
+  inelastic_cdf_start_.copy_to_device();
+  inelastic_cdf_row_.copy_to_device();
+  fission_spectrum_.copy_to_device();
   reactions_.copy_to_device();
   device_fission_rx_ = fission_rx_.data();
   device_total_nu_ = total_nu_.get();
@@ -706,6 +1310,17 @@ void Nuclide::copy_to_device()
     #pragma omp target enter data map(to: device_total_nu_[:1])
     total_nu_->copy_to_device();
   }
+
+  // The photon energy release scales the yield of fission photons to account
+  // for delayed ones
+  device_prompt_photons_ = prompt_photons_.get();
+  device_delayed_photons_ = delayed_photons_.get();
+  if (prompt_photons_ && delayed_photons_) {
+    #pragma omp target enter data map(to: device_prompt_photons_[:1])
+    #pragma omp target enter data map(to: device_delayed_photons_[:1])
+    prompt_photons_->copy_to_device();
+    delayed_photons_->copy_to_device();
+  }
   for (auto& rx : reactions_) {
     rx.copy_to_device();
   }
@@ -715,7 +1330,13 @@ void Nuclide::copy_to_device()
   energy_0K_.copy_to_device();
   elastic_0K_.copy_to_device();
   xs_cdf_.copy_to_device();
+  elastic_0K_block_max_.copy_to_device();
   #pragma omp target enter data map(to: flat_temp_offsets_[:kTs_.size()])
+  if (flat_host_) {
+    map_in_place(flat_grid_energy_, total_energy_gridpoints_ * sizeof(double));
+    map_in_place(flat_grid_index_, total_index_gridpoints_ * sizeof(int));
+    map_in_place(flat_xs_, total_energy_gridpoints_ * 5 * sizeof(FlatXS));
+  }
   #pragma omp target enter data map(to: flat_grid_energy_[:total_energy_gridpoints_])
   #pragma omp target enter data map(to: flat_grid_index_[:total_index_gridpoints_])
   #pragma omp target enter data map(to: flat_xs_[:total_energy_gridpoints_*5])
@@ -724,7 +1345,12 @@ void Nuclide::copy_to_device()
   urr_data_.copy_to_device();
   for (auto& u : urr_data_) {
     #pragma omp target enter data map(to: u.device_energy_[:u.n_energy_])
-    #pragma omp target enter data map(to: u.device_prob_[:u.n_total_prob_])
+    if (u.n_total_bands_ > 0) {
+      #pragma omp target enter data map(to: u.device_bands_[:u.n_total_bands_*URR_BAND_FIELDS])
+      #pragma omp target enter data map(to: u.device_inv_spacing_[:u.n_energy_-1])
+    } else {
+      #pragma omp target enter data map(to: u.device_prob_[:u.n_total_prob_])
+    }
   }
 
   // Because fission_rx_ is an array of host pointers, if we copy it over as an
@@ -757,22 +1383,44 @@ void Nuclide::release_from_device()
   }
   reactions_.release_device();
   index_inelastic_scatter_.release_device();
+  inelastic_cdf_.release_device();
+  inelastic_cdf_exact_.release_device();
+  inelastic_cdf_start_.release_device();
+  inelastic_cdf_row_.release_device();
+  fission_spectrum_.release_device();
   #pragma omp target exit data map(release: device_fission_rx_[:fission_rx_.size()])
+  if (prompt_photons_ && delayed_photons_) {
+    prompt_photons_->release_from_device();
+    delayed_photons_->release_from_device();
+    #pragma omp target exit data map(release: device_prompt_photons_[:1])
+    #pragma omp target exit data map(release: device_delayed_photons_[:1])
+  }
 
   // Regular pointwise XS data
   kTs_.release_device();
   xs_cdf_.release_device();
+  elastic_0K_block_max_.release_device();
   elastic_0K_.release_device();
   energy_0K_.release_device();
   #pragma omp target exit data map(release: flat_temp_offsets_[:kTs_.size()])
   #pragma omp target exit data map(release: flat_grid_energy_[:total_energy_gridpoints_])
   #pragma omp target exit data map(release: flat_grid_index_[:total_index_gridpoints_])
   #pragma omp target exit data map(release: flat_xs_[:total_energy_gridpoints_*5])
+  if (flat_host_) {
+    unmap_in_place(flat_grid_energy_);
+    unmap_in_place(flat_grid_index_);
+    unmap_in_place(flat_xs_);
+  }
 
   // URR data
   for (auto& u : urr_data_) {
     #pragma omp target exit data map(release: u.device_energy_[:u.n_energy_])
-    #pragma omp target exit data map(release: u.device_prob_[:u.n_total_prob_])
+    if (u.n_total_bands_ > 0) {
+      #pragma omp target exit data map(release: u.device_bands_[:u.n_total_bands_*URR_BAND_FIELDS])
+      #pragma omp target exit data map(release: u.device_inv_spacing_[:u.n_energy_-1])
+    } else {
+      #pragma omp target exit data map(release: u.device_prob_[:u.n_total_prob_])
+    }
   }
   urr_data_.release_device();
 
@@ -815,6 +1463,28 @@ nuclides_size()
 // C API
 //==============================================================================
 
+namespace {
+
+//! Move the nuclides to an array of twice the capacity. Nuclides have no move
+//! constructor, so they are relocated bytewise, and only their names, which
+//! may point into themselves, are constructed again.
+void grow_nuclides()
+{
+  size_t capacity = std::max<size_t>(2 * data::nuclides_capacity, 1);
+  auto nuclides = static_cast<Nuclide*>(malloc(capacity * sizeof(Nuclide)));
+  for (int i = 0; i < data::nuclides_size; ++i) {
+    auto& nuc = data::nuclides[i];
+    std::memcpy(static_cast<void*>(nuclides + i), &nuc, sizeof(Nuclide));
+    new(&nuclides[i].name_) std::string(std::move(nuc.name_));
+    nuc.name_.~basic_string();
+  }
+  free(data::nuclides);
+  data::nuclides = nuclides;
+  data::nuclides_capacity = capacity;
+}
+
+} // namespace
+
 extern "C" int openmc_load_nuclide(const char* name, const double* temps, int n)
 {
   if (data::nuclide_map.find(name) == data::nuclide_map.end() ||
@@ -839,7 +1509,12 @@ extern "C" int openmc_load_nuclide(const char* name, const double* temps, int n)
     hid_t group = open_group(file_id, name);
     std::vector<double> temperature{temps, temps + n};
 
-    new(data::nuclides + data::nuclides_size) Nuclide(group, temperature);
+    // Nuclides are constructed in place, so the array grows when it is full.
+    // Its mapping on device, if it was left there, is replaced when the data
+    // is moved to device again.
+    if (data::nuclides_size == data::nuclides_capacity) grow_nuclides();
+    new(data::nuclides + data::nuclides_size) Nuclide(group, temperature,
+      data::nuclides_size);
     ++data::nuclides_size;
 
     close_group(group);
@@ -850,36 +1525,40 @@ extern "C" int openmc_load_nuclide(const char* name, const double* temps, int n)
     if (settings::temperature_multipole) read_multipole_data(i_nuclide);
 
     // Read elemental data, if necessary
-    if (settings::photon_transport) {
-      auto element = to_element(name);
-      if (data::element_map.find(element) == data::element_map.end() ||
-          data::element_map.at(element) >= data::elements_size) {
-        // Read photon interaction data from HDF5 photon library
-        LibraryKey key {Library::Type::photon, element};
-        const auto& it = data::library_map.find(key);
-        if (it == data::library_map.end()) {
-          set_errmsg("Element '" + std::string{element} + "' is not present in library.");
-          return OPENMC_E_DATA;
-        }
+    if (settings::photon_transport) return read_photon_element(name);
+  }
+  return 0;
+}
 
-        int idx = it->second;
-        const auto& filename = data::libraries[idx].path_;
-        write_message(6, "Reading {} from {} ", element, filename);
+int read_photon_element(const std::string& nuclide)
+{
+  auto element = to_element(nuclide);
+  if (data::element_map.find(element) != data::element_map.end() &&
+      data::element_map.at(element) < data::elements_size) return 0;
+
+  // Read photon interaction data from HDF5 photon library
+  LibraryKey key {Library::Type::photon, element};
+  const auto& it = data::library_map.find(key);
+  if (it == data::library_map.end()) {
+    set_errmsg("Element '" + std::string{element} + "' is not present in library.");
+    return OPENMC_E_DATA;
+  }
 
-        // Open file and make sure version is sufficient
-        hid_t file_id = file_open(filename, 'r');
-        check_data_version(file_id);
+  int idx = it->second;
+  const auto& filename = data::libraries[idx].path_;
+  write_message(6, "Reading {} from {} ", element, filename);
 
-        // Read element data from HDF5
-        hid_t group = open_group(file_id, element.c_str());
-        new(data::elements + data::elements_size) PhotonInteraction(group);
-        ++data::elements_size;
+  // Open file and make sure version is sufficient
+  hid_t file_id = file_open(filename, 'r');
+  check_data_version(file_id);
 
-        close_group(group);
-        file_close(file_id);
-      }
-    }
-  }
+  // Read element data from HDF5
+  hid_t group = open_group(file_id, element.c_str());
+  new(data::elements + data::elements_size) PhotonInteraction(group);
+  ++data::elements_size;
+
+  close_group(group);
+  file_close(file_id);
   return 0;
 }
 
@@ -927,12 +1606,63 @@ openmc_nuclide_collapse_rate(int index, int MT, double temperature,
   return 0;
 }
 
+//! \brief Collapses one group flux with the cross sections of many reactions,
+//! each of a nuclide at a temperature of its own. The reactions are collapsed
+//! in parallel and xs[i] is the reaction rate of nuclides[i], MTs[i] and
+//! temperatures[i].
+extern "C" int
+openmc_nuclides_collapse_rates(int n, const int* nuclides, const int* MTs,
+  const double* temperatures, const double* energy, const double* flux,
+  int n_groups, double* xs)
+{
+  for (int i = 0; i < n; ++i) {
+    if (nuclides[i] < 0 || nuclides[i] >= data::nuclides_size) {
+      set_errmsg("Index in nuclides vector is out of bounds.");
+      return OPENMC_E_OUT_OF_BOUNDS;
+    }
+    if (MTs[i] <= 0) {
+      set_errmsg(fmt::format("Invalid reaction MT {}.", MTs[i]));
+      return OPENMC_E_INVALID_ARGUMENT;
+    }
+  }
+
+  // Errors cannot leave the parallel region, so only the first is kept
+  gsl::span<const double> E {energy, static_cast<size_t>(n_groups + 1)};
+  gsl::span<const double> phi {flux, static_cast<size_t>(n_groups)};
+  int err = 0;
+  std::string msg;
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < n; ++i) {
+    try {
+      xs[i] = data::nuclides[nuclides[i]].collapse_rate(MTs[i],
+        temperatures[i], E, phi);
+    } catch (const std::out_of_range& e) {
+      xs[i] = 0.0;
+      #pragma omp critical(nuclides_collapse_rates)
+      if (err == 0) {
+        err = OPENMC_E_OUT_OF_BOUNDS;
+        msg = e.what();
+      }
+    }
+  }
+  if (err != 0) {
+    set_errmsg(msg);
+    return err;
+  }
+  return 0;
+}
+
 void nuclides_clear()
 {
   for (int i = 0; i < data::nuclides_size; ++i) {
     data::nuclides[i].~Nuclide();
   }
   free(data::nuclides);
+  data::ct_tables.clear();
+  data::ae_tables.clear();
+  data::device_arena.clear();
+  data::shared_xs.free();
+  data::pruned_bytes = 0;
   data::nuclides_capacity = 0;
   data::nuclides_size = 0;
   data::nuclide_map.clear();
@@ -940,7 +1670,63 @@ void nuclides_clear()
 
 bool multipole_in_range(const Nuclide& nuc, double E)
 {
-  return E >= nuc.multipole_->E_min_ && E <= nuc.multipole_->E_max_;
+  const auto* mp = nuc.multipole();
+  return mp && E >= mp->E_min_ && E <= mp->E_max_;
+}
+
+void build_union_energy_grid()
+{
+  int neutron = static_cast<int>(Particle::Type::neutron);
+  double E_min = data::energy_min[neutron];
+  double E_max = data::energy_max[neutron];
+
+  // Merge every nuclide grid at every temperature within the transport range
+  vector<double> merged {E_min, E_max};
+  for (int i = 0; i < data::nuclides_size; ++i) {
+    for (const auto& grid : data::nuclides[i].grid_) {
+      for (double E : grid.energy) {
+        if (E > E_min && E < E_max) merged.push_back(E);
+      }
+    }
+  }
+  std::sort(merged.begin(), merged.end());
+  merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+
+  // Thin the grid if requested, always keeping both end points. Each nuclide's
+  // search is then bounded by the gridpoints between two union grid points.
+  int stride = settings::union_grid_stride;
+  data::union_grid.clear();
+  for (int i = 0; i < merged.size(); i += stride) {
+    data::union_grid.push_back(merged[i]);
+  }
+  if (data::union_grid.back() != merged.back()) {
+    data::union_grid.push_back(merged.back());
+  }
+  data::union_grid_size = data::union_grid.size();
+}
+
+int energy_grid_search_index(double E)
+{
+  if (settings::energy_grid_method == EnergyGridMethod::unionized) {
+    // Binary search for the union grid interval containing E
+    const double* grid = data::device_union_grid;
+    int i_low = 0;
+    int i_high = data::union_grid_size - 1;
+    if (E <= grid[i_low]) return i_low;
+    if (E >= grid[i_high]) return i_high - 1;
+    while (i_high - i_low > 1) {
+      int i_mid = (i_low + i_high) / 2;
+      if (grid[i_mid] <= E) {
+        i_low = i_mid;
+      } else {
+        i_high = i_mid;
+      }
+    }
+    return i_low;
+  } else {
+    int neutron = static_cast<int>(Particle::Type::neutron);
+    return std::log(E/data::energy_min[neutron])/simulation::log_spacing;
+  }
 }
 
 } // namespace openmc
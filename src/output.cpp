@@ -18,20 +18,26 @@
 #endif
 #include "xtensor/xview.hpp"
 
+#include "openmc/bank.h"
 #include "openmc/capi.h"
 #include "openmc/cell.h"
 #include "openmc/constants.h"
+#include "openmc/distribution_energy.h"
 #include "openmc/eigenvalue.h"
 #include "openmc/error.h"
 #include "openmc/event.h"
 #include "openmc/geometry.h"
+#include "openmc/kernel_profile.h"
 #include "openmc/lattice.h"
+#include "openmc/material.h"
 #include "openmc/math_functions.h"
 #include "openmc/message_passing.h"
 #include "openmc/mgxs_interface.h"
 #include "openmc/nuclide.h"
+#include "openmc/photon.h"
 #include "openmc/plot.h"
 #include "openmc/reaction.h"
+#include "openmc/secondary_tables.h"
 #include "openmc/settings.h"
 #include "openmc/simulation.h"
 #include "openmc/surface.h"
@@ -312,16 +318,163 @@ void print_usage()
       "  -r, --restart          Restart a previous run from a state point\n"
       "                         or a particle restart file\n"
       "  -s, --threads          Number of OpenMP threads\n"
-      "  -t, --track            Write tracks for all particles\n"
+      "  -t, --track            Write tracks for all particles to tracks.h5\n"
       "  -e, --event            Run using event-based parallelism\n"
       "  -m, --minimum          Minimum energy sorting threshold\n"
-      "  -i, --inflight         Maximum number of in-flight particles\n"
+      "  -i, --inflight         Maximum number of in-flight particles, or 'auto' to fit free device memory\n"
+      "  --device-memory        Device memory in GB assumed by '-i auto' when it cannot be queried\n"
+      "  --device-memory-headroom  Fraction of free device memory that '-i auto' leaves unused\n"
       "  --no-sort-fissionable-xs      Do not sort event-based fissionable material xs lookups\n"
       "  --no-sort-non-fissionable-xs  Do not sort event-based non-fissionable material xs lookups\n"
       "  --no-sort-surface-crossing    Do not sort event-based surface crossing\n"
       "  --no-sort-device              Do not sort event-based queues on device (use host instead)\n"
+      "  --bucket-xs                   Bucket event-based xs lookup queues by material and energy instead of sorting\n"
+      "  --async-events         Overlap independent event-based kernels\n"
+      "  --split-collisions     Finish event-based collisions in one kernel per sampled reaction type\n"
+      "  --material-xs-queues   Number of largest materials given their own event-based xs lookup kernel\n"
+      "  --sort-full-items             Sort full event-based queue items rather than (key, index) pairs\n"
+      "  --sort-advance-position       Sort the event-based advance queue along a Morton curve through particle positions\n"
+      "  --sort-surface-position       Sort event-based surface crossing by particle position rather than cell and surface\n"
+      "  --wmp-batch            Evaluate event-based multipole xs in nuclide-major batches\n"
+      "  --wmp-batch-items      Number of queue items per batched multipole evaluation\n"
+      "  --secondary-pool-size  Number of overflowing secondary particles that can be banked per process\n"
+      "  --fission-bank-margin  Room in the fission bank beyond the sites expected in a generation, as a\n"
+      "                         fraction of them (default 0.25). A further quarter of it is kept to spill to.\n"
+      "  --lost-check-interval  Event-based events between checks for particles lost on device, which\n"
+      "                         copy back only their count unless one was lost (default 1000, 0 = end of transport only)\n"
+      "  --nu-bank-size         Most neutrons of one fission each particle keeps for analog energyout\n"
+      "                         and decay rate tallies (default 16)\n"
+      "  --max-split-growth     Most particles weight windows may split off per generation, per source particle\n"
+      "  --device-xs-budget     Device memory in GB for pointwise nuclide xs; the least used nuclides\n"
+      "                         beyond it are read by the device from pinned host memory\n"
+      "  --device               Number of the device to offload to\n"
+      "  --bind-devices         Offload processes on a node to its devices in turn, by local rank\n"
+      "  --keep-device-data     Keep nuclear data and materials on device between simulations (e.g.\n"
+      "                         depletion steps), sending only the nuclides and densities changed since\n"
+      "  --device-arena         Pack read-only nuclear data into a few large device slabs\n"
+      "  --pinned-banks         Allocate host source and fission banks in pinned memory\n"
+      "  --device-fission-bank  Sort and resample the fission bank on device between generations\n"
+      "  --packed-bank          Exchange and write source sites with single precision directions and weights\n"
+      "  --surf-source-per-rank Write the surface source sites of each process to its own file, joined\n"
+      "                         in surface_source.h5 by a virtual dataset\n"
+      "  --tally-replicas       Number of replicated result buffers per event-based tally that device teams\n"
+      "                         score into, reducing atomic contention (0 disables)\n"
+      "  --tally-replica-bins   Largest number of tally filter-score bins that is replicated\n"
+      "  --defer-tally          Queue this many event-based tally scores per particle and reduce them\n"
+      "                         by bin in a separate kernel (0, the default, scores immediately)\n"
+      "  --sparse-tallies       Store large event-based tallies on device in blocks allocated when first\n"
+      "                         scored, with room for this fraction of all blocks (0 disables)\n"
+      "  --sparse-tally-bins    Smallest number of tally filter-score bins that is stored sparsely\n"
+      "  --device-tally-accumulate  Keep event-based tally results on device and accumulate batches\n"
+      "                         there, copying them to host only when they are read\n"
+      "  --async-tally-reduce   Overlap the reduction of tallies across MPI ranks with the next batch\n"
+      "  --tally-reduce-chunk   Number of tally values reduced across MPI ranks per message\n"
+      "  --tally-reduce-group   Reduce tallies onto one aggregator per this many ranks, then onto master\n"
+      "  --distribute-tallies   Reduce tallies with at least this many filter-score bins onto slices\n"
+      "                         owned by each MPI rank, gathering them onto master only when read\n"
+      "  --tally-stats          Count the events, filter bin combinations and results scored by each\n"
+      "                         tally, timing a sample of events, and report them\n"
+      "  --collapse-tallies     Sum tallies differing from another only by a coarser energy filter\n"
+      "                         from the finer tally each batch instead of scoring them\n"
+      "  --async-statepoint     Write statepoint tally results from a copy in the background while the\n"
+      "                         next batch is transported\n"
+      "  --hdf5-compression     Shuffle and deflate large datasets of statepoint, source and summary\n"
+      "                         files at this level (1-9)\n"
+      "  --hdf5-chunk-size      Target size in bytes of the chunks of compressed HDF5 datasets\n"
+      "  --checkpoint           Every this many batches, update checkpoint.h5 with the tally blocks\n"
+      "                         and batch state that changed since it was last written in full\n"
+      "  --checkpoint-particles Also checkpoint the batch in progress every this many source particles\n"
+      "                         of each process, from which a restart resumes the batch (event-based)\n"
+      "  --checkpoint-stop      Stop the run as if it were preempted once this many checkpoints of a\n"
+      "                         batch in progress were written, for testing restarts\n"
+      "  --track-buffer         Number of track points buffered per generation on each process\n"
+      "  --event-trace          Record event kernel launches and the events of every n-th particle\n"
+      "                         to event_trace.h5 for offline replay of scheduling policies\n"
+      "  --summary-format       Layout of summary.h5: 'full' (default), 'compact' arrays, or 'hash'\n"
+      "                         of the model input files with their contents\n"
+      "  --kernel-profile       Report device time, launches, items and bytes of each event kernel\n"
+      "  --event-stats          Print the events, kernel launches, sorts and queue occupancy of each batch\n"
+      "  --event-stats-json     Write the per-batch event counts of --event-stats to a JSON file\n"
+      "  --region-costs         Write the events and estimated time of each cell and material\n"
+      "                         in event-based mode to a JSON file\n"
+      "  --region-cost-stride   Attribute the events of every n-th particle for --region-costs\n"
+      "                         (default 16)\n"
+      "  --status-file          Rewrite a JSON file with the progress, rates, keff and memory\n"
+      "                         of the run after every batch\n"
+      "  --xs-benchmark         Time the given number of XS lookups at random materials\n"
+      "                         and energies instead of running transport\n"
+      "  --collision-benchmark  Time the given number of neutron collisions on synthetic\n"
+      "                         particle states instead of running transport\n"
+      "  --particle-soa         Read event-based queue fields from structure-of-arrays particle copies\n"
+      "  --plane-cache          Carry general plane evaluations of the current cell between collisions\n"
+      "  --fast-reflection      Keep the lower universe coordinates of reflected particles instead of searching for their cells\n"
+      "  --nuclide-cdf          Sample collision nuclides by bisection of a running sum of nuclide XS\n"
+      "  --inelastic-cdf        Sample inelastic scattering channels by bisection of tabulated XS sums\n"
+      "  --decoded-distributions  Decode tabular secondary energy and angle-energy distributions into shared tables at load time\n"
+      "  --fission-spectrum-table     Sample prompt fission neutron energies from tabulated quantiles\n"
+      "  --validate-fission-spectrum  Tabulate prompt fission spectra and compare them against the exact distributions\n"
+      "  --compton-table        Sample incoherent photon scattering from this many tabulated quantiles per energy\n"
+      "  --optimize-geometry    Merge duplicate surfaces and drop redundant half-spaces of cells\n"
+      "  --sort-skip-fraction   Skip sorting a queue when at most this fraction of it is out of order\n"
+      "  --compact-threshold    Compact the event-based particle buffer in queue order once at most this\n"
+      "                         fraction of its occupied slots hold queued particles\n"
       "  -x, --xs-event-bias    Bias against fuel XS lookup event selection (higher means even needs more particles)\n"
+      "  --event-scheduler      Event kernel selection policy: 'longest' (default) or 'cost'\n"
+      "  --auto-tune            Search the inactive batches for the fastest in-flight count, fuel XS\n"
+      "                         bias and sort settings, then keep and report them\n"
+      "  --revival-period       Maximum number of event iterations between revival events\n"
+      "  --aggregate-append     Append to event-based queues with one atomic per team\n"
+      "  --fuse-tally           Score tracklength tallies within the event-based advance kernel\n"
+      "  --no-cpu-events        Run event-based kernels as target regions even without a device, rather\n"
+      "                         than as host thread loops with prefetched XS lookups\n"
+      "  --tail-threshold       Live particle count ('auto' to derive from kernel costs) below which\n"
+      "                         event-based mode finishes all histories in a single kernel\n"
       "  -b, --n-log-bins       Number of logarithmic hash bins to use for XS lookup acceleration\n"
+      "  --energy-grid          Grid bounding nuclide energy searches: 'log' (default) or 'union'\n"
+      "  --union-grid-stride    Keep every n-th unionized energy grid point (trades speed for memory)\n"
+      "  --pretabulate-temperatures  Tabulate nuclide xs at only the model's temperatures, interpolating\n"
+      "                              between bounding library temperatures ahead of time\n"
+      "  --tms                  Load each nuclide at its lowest model temperature only and Doppler\n"
+      "                         broaden it to the others by target motion sampling at collisions\n"
+      "  --prune-data           Do not read nuclear data the run cannot use (photon products without\n"
+      "                         photon transport, 0 K elastic data without resonance scattering)\n"
+      "  --shared-xs            Hold flattened nuclide xs once per node, shared by its MPI processes\n"
+      "  --xs-cache             Directory of compiled cross section libraries, written on first use and\n"
+      "                         read instead of the HDF5 libraries while they are unchanged\n"
+      "  --startup-profile      Write the time and host and device memory of each startup phase as JSON\n"
+      "  --faddeeva             Multipole Faddeeva implementation: 'scalar' (default), or batched\n"
+      "                         'humlicek8' (fastest), 'weideman16' or 'weideman32' (most accurate)\n"
+      "  --material-xs-tables   Interpolate tabulated macroscopic xs for non-fissionable materials\n"
+      "  --material-xs-table-points  Number of energy points in each material xs table\n"
+      "  --material-xs-table-tol     Relative error above which a table bin falls back to a direct lookup\n"
+      "  --majorant-points      Number of energy bins of the delta-tracking majorant xs\n"
+      "  --device-volume        Sample stochastic volume calculations on device\n"
+      "  --device-find-cells    Locate the points of batched cell searches from the C API on device\n"
+      "  --device-source        Sample fixed-source sites on device as particles start instead of\n"
+      "                         sampling the whole generation on host beforehand\n"
+      "  --async-bank           Start transporting the source sites kept by each process while the\n"
+      "                         sites sent by other processes arrive (event-based eigenvalue runs)\n"
+      "  --fission-matrix       Reweight the source of each inactive batch by the fundamental mode of\n"
+      "                         a fission matrix tallied on the entropy or UFS mesh\n"
+      "  --local-generations    Resample the fission bank of each process on that process for all but\n"
+      "                         the last generation of each batch\n"
+      "  --hybrid               Transport a share of particles on host threads while the rest are\n"
+      "                         transported on device, with the share following their speeds\n"
+      "  --persistent-history   Keep device history threads resident, each taking the next history\n"
+      "                         from a device counter until none are left (device history builds)\n"
+      "  --interleave           Histories each host thread interleaves in history-based mode, switching\n"
+      "                         between them while their XS data is prefetched (default 1)\n"
+      "  --mg-alias             Sample multigroup scattering groups and tabulated cosines from alias\n"
+      "                         tables in constant time\n"
+      "  --balance-work         Give each process a share of particles in proportion to its speed in\n"
+      "                         the previous batch, up to this multiple of an even share\n"
+      "  --source-block-sites   Hold only this many sites of a source file in memory, reading blocks of\n"
+      "                         the file in shuffled order as generations are sampled\n"
+      "  --find-overlaps        Sample points in the geometry and report the cells that overlap\n"
+      "  --overlap-samples      Number of points sampled by --find-overlaps\n"
+      "  --overlap-limit        Overlaps recorded per cell before --find-overlaps stops testing it\n"
+      "  --device-overlaps      Sample --find-overlaps on device\n"
+      "  --urr-fast-sampling    Sample URR probability tables from precomputed, interleaved band records\n"
       "  -v, --version          Show version information\n"
       "  -h, --help             Show this message\n");
   }
@@ -385,7 +538,7 @@ void print_generation()
 
 //==============================================================================
 
-void show_time(const char* label, double secs, int indent_level=0)
+void show_time(const char* label, double secs, int indent_level)
 {
   int width = 33 - indent_level*2;
   fmt::print("{0:{1}} {2:<{3}} = {4:>10.4e} seconds\n",
@@ -437,6 +590,9 @@ void print_runtime()
   fmt::print(" Simulation Algorithm              = ");
   if (settings::event_based )
     fmt::print("Event-Based\n");
+  else if (settings::interleaved_histories > 1)
+    fmt::print("History-Based ({:d} Interleaved per Thread)\n",
+      settings::interleaved_histories);
   else
     fmt::print("History-Based\n");
 
@@ -445,28 +601,241 @@ void print_runtime()
     fmt::print("GPU Device\n");
   else
     fmt::print("CPU Host\n");
+
+#ifdef _OPENMP
+  if (was_device_used()) {
+    fmt::print(" Offload Device                    = {} of {}{}\n",
+      omp_get_default_device(), omp_get_num_devices(),
+      settings::bind_devices && settings::device_id < 0 ?
+      " (bound by local rank)" : "");
+  }
+#endif
+
+  fmt::print(" Secondary Particle Spill Pool     = {:d} Sites\n",
+    simulation::secondary_pool.capacity());
+
+  if (settings::run_mode == RunMode::EIGENVALUE) {
+    fmt::print(" Fission Bank                      = {:d} Sites + {:d} "
+      "Spill\n", simulation::fission_bank.capacity(),
+      simulation::fission_spill.capacity());
+  }
+
+  if (settings::weight_windows_on) {
+    fmt::print(" Weight Window Split Limit         = {:d} Particles per "
+      "Generation\n", static_cast<int64_t>(settings::max_split_growth *
+      simulation::work_per_rank));
+  }
+
+  fmt::print(" Particle Coordinate Levels        = {:d} Used, {:d} Stored\n",
+    model::n_coord_levels, COORD_SIZE);
   
   if (settings::event_based) {
     fmt::print(" Event-Based Queue Sort Location   = ");
-    if (settings::sort_on_device) 
-      fmt::print("GPU Device\n");
-    else 
+    if (settings::sort_on_device) {
+      #if defined(CUDA_THRUST_SORT)
+      fmt::print("GPU Device (Thrust)\n");
+      #elif defined(SYCL_SORT)
+      fmt::print("GPU Device (OneDPL)\n");
+      #else
+      fmt::print("GPU Device (Radix Sort)\n");
+      #endif
+    } else {
       fmt::print("CPU Host\n");
+    }
+
+    fmt::print(" Event-Based XS Queue Ordering     = {}\n",
+      settings::bucket_xs_queues ? "Bucketed Insertion" : "Sorted");
+
+    fmt::print(" Event-Based Kernel Execution      = {}\n",
+      settings::async_event_kernels ? "Concurrent" : "Sequential");
+
+    fmt::print(" Event-Based Material XS Queues    = {:d}\n", settings::n_material_xs_queues);
+
+    fmt::print(" Event-Based Collision Kernels     = {}\n",
+      settings::split_collisions ? "Split by Reaction" : "Single");
 
-    fmt::print(" Event-Based Fuel XS Queue Bias    = {:.2f}\n", settings::fuel_lookup_bias);
+    if (settings::temperature_multipole) {
+      fmt::print(" Event-Based Multipole Evaluation  = ");
+      if (simulation::wmp_batching)
+        fmt::print("Batched ({:d} Items)\n", settings::wmp_batch_items);
+      else
+        fmt::print("Per Particle\n");
+    }
+
+    fmt::print(" Event-Based Queue Sort Payload    = {}\n",
+      settings::sort_key_index ? "Key-Index Pairs" : "Full Items");
+    if (settings::sort_skip_fraction > 0.0)
+      fmt::print(" Event-Based Sort Skip Fraction    = {:.4f}\n", settings::sort_skip_fraction);
+    if (settings::compact_threshold > 0.0)
+      fmt::print(" Event-Based Compaction Threshold  = {:.4f}\n", settings::compact_threshold);
+    if (settings::sort_advance_position || settings::sort_surface_position) {
+      std::string queues = settings::sort_advance_position ? "Advance" : "";
+      if (settings::sort_surface_position)
+        queues += queues.empty() ? "Surface Crossing" : ", Surface Crossing";
+      fmt::print(" Event-Based Position Sorting      = {}\n", queues);
+    }
+
+    fmt::print(" Event-Based Scheduler             = ");
+    if (settings::event_scheduler == EventScheduler::cost_model)
+      fmt::print("Cost Model\n");
+    else
+      fmt::print("Longest Queue\n");
+
+    if (settings::event_scheduler == EventScheduler::longest_queue)
+      fmt::print(" Event-Based Fuel XS Queue Bias    = {:.2f}\n", settings::fuel_lookup_bias);
+    fmt::print(" Event-Based Max Revival Period    = {:d}\n", settings::max_revival_period);
+
+    fmt::print(" Event-Based Advance/Tally Kernels = {}\n",
+      settings::fuse_advance_tally ? "Fused" : "Separate");
+
+    fmt::print(" Event-Based Kernels               = {}\n",
+      settings::cpu_event_kernels ? "Host Threads" : "Target Regions");
+
+    fmt::print(" Event-Based Queue Appends         = ");
+    if (settings::cpu_event_kernels)
+      fmt::print("Thread-Merged\n");
+    else if (settings::aggregate_queue_appends)
+      fmt::print("Team-Aggregated\n");
+    else
+      fmt::print("Per-Particle Atomic\n");
+
+    fmt::print(" Event-Based Particle Fields       = {}\n",
+      settings::particle_soa ? "Structure-of-Arrays Copies" : "Particle Objects");
+
+    fmt::print(" Event-Based History Tail          = ");
+    if (settings::event_tail_threshold == -1)
+      fmt::print("Automatic\n");
+    else if (settings::event_tail_threshold > 0)
+      fmt::print("Below {:d} Particles\n", settings::event_tail_threshold);
+    else
+      fmt::print("Off\n");
+
+    if (settings::auto_tune)
+      fmt::print(" Event-Based Parameter Tuning      = Inactive Batches\n");
+  }
+  fmt::print(" Energy Grid Method                = ");
+  if (settings::energy_grid_method == EnergyGridMethod::unionized) {
+    fmt::print("Unionized ({:d} Points)\n", data::union_grid.size());
+  } else {
+    fmt::print("Logarithmic\n");
+    fmt::print(" Number of Log Hash Bins           = {:d}\n", settings::n_log_bins);
   }
-  fmt::print(" Number of Log Hash Bins           = {:d}\n", settings::n_log_bins);
 
-  fmt::print(" Faddeeva Implementation           = ");
-  #ifdef NEW_FADDEEVA
-  fmt::print("Ben Forget Rational Approximation\n");
+  fmt::print(" Nuclide XS Temperatures           = {}\n",
+    settings::temperature_tms ? "Broadened (Target Motion Sampling)" :
+    settings::pretabulate_temperatures ? "Model Only (Pretabulated)" : "Library");
+
+  fmt::print(" Material Macro XS Tables          = ");
+  if (settings::material_xs_tables) {
+    int n_tables = 0;
+    for (int i = 0; i < model::materials_size; i++) {
+      if (model::materials[i].has_xs_table()) n_tables++;
+    }
+    fmt::print("{:d} of {:d} Materials ({:d} Points, Tol. {:.1e})\n", n_tables,
+      model::materials_size, settings::material_xs_table_points,
+      settings::material_xs_table_tolerance);
+  } else {
+    fmt::print("Off\n");
+  }
+
+  if (settings::delta_tracking) {
+    fmt::print(" Delta-Tracking Cells              = {:d} ({:d} Majorant Bins)\n",
+      settings::delta_tracking_cells.size(), settings::majorant_points);
+  }
+
+  if (settings::plane_cache) {
+    fmt::print(" General Plane Evaluations         = Cached Between Collisions\n");
+  }
+
+  if (settings::fast_reflection) {
+    fmt::print(" Reflective/White Boundaries       = Lower Coordinates Kept\n");
+  }
+
+  if (settings::nuclide_cdf) {
+    fmt::print(" Collision Nuclide Sampling        = Bisection of Cumulative XS\n");
+  }
+
+  if (settings::inelastic_cdf) {
+    int n_tabulated = 0;
+    for (int i = 0; i < data::nuclides_size; ++i) {
+      if (data::nuclides[i].inelastic_cdf_.size() > 0) ++n_tabulated;
+    }
+    fmt::print(" Inelastic Channel Sampling        = Bisection ({:d} Nuclides)\n",
+      n_tabulated);
+  }
+
+  if (settings::fission_spectrum_table) {
+    int n_tabulated = 0;
+    for (int i = 0; i < data::nuclides_size; ++i) {
+      if (data::nuclides[i].fission_spectrum_.size() > 0) ++n_tabulated;
+    }
+    fmt::print(" Prompt Fission Spectrum Sampling  = Tabulated Quantiles ({:d} Nuclides)\n",
+      n_tabulated);
+  }
+
+  if (settings::compton_table_quantiles > 0) {
+    size_t n_bytes = 0;
+    for (int i = 0; i < data::elements_size; ++i) {
+      n_bytes += data::elements[i].compton_table_.nbytes();
+    }
+    fmt::print(" Incoherent Scattering Sampling    = Tabulated ({:d} Quantiles, {:.1f} MB)\n",
+      settings::compton_table_quantiles, n_bytes * 1.0e-6);
+  }
+
+  if (settings::decoded_distributions) {
+    fmt::print(" Tabular Energy Distributions      = Decoded ({:.1f} MB)\n",
+      data::ct_tables.nbytes() * 1.0e-6);
+    fmt::print(" Angle-Energy Distributions        = Decoded ({:.1f} MB)\n",
+      data::ae_tables.nbytes() * 1.0e-6);
+  }
+
+  if (settings::urr_ptables_on) {
+    fmt::print(" URR Probability Table Sampling    = {}\n",
+      settings::urr_fast_sampling ? "Precomputed Band Records" : "Direct");
+  }
+
+  fmt::print(" Pointwise XS Storage Precision    = ");
+  #ifdef SINGLE_PRECISION_XS
+  fmt::print("Single (Double Energy Grid)\n");
   #else
-  fmt::print("MIT\n");
+  fmt::print("Double\n");
   #endif
 
+  fmt::print(" Nuclide Loop Vectorization        = ");
+  #ifdef SIMD_NUCLIDE_LOOP
+  fmt::print("SIMD\n");
+  #else
+  fmt::print("Scalar\n");
+  #endif
+
+  fmt::print(" Faddeeva Implementation           = ");
+  switch (settings::faddeeva_method) {
+  case FaddeevaMethod::scalar:
+    #ifdef NEW_FADDEEVA
+    fmt::print("Ben Forget Rational Approximation\n");
+    #else
+    fmt::print("MIT\n");
+    #endif
+    break;
+  case FaddeevaMethod::humlicek8:
+    fmt::print("Batched Humlicek 8th Order\n");
+    break;
+  case FaddeevaMethod::weideman16:
+    fmt::print("Batched Weideman (16 Terms)\n");
+    break;
+  case FaddeevaMethod::weideman32:
+    fmt::print("Batched Weideman (32 Terms)\n");
+    break;
+  }
+
   // display time elapsed for various sections
   show_time("Total time for initialization", time_initialize.elapsed());
+  show_time("Reading materials", time_read_materials.elapsed(), 1);
+  show_time("Reading geometry", time_read_geometry.elapsed(), 1);
+  show_time("Finalizing geometry", time_finalize_geometry.elapsed(), 1);
   show_time("Reading cross sections", time_read_xs.elapsed(), 1);
+  show_time("Reading tallies", time_read_tallies.elapsed(), 1);
+  show_time("Preparing distribcells", time_distribcell.elapsed(), 1);
   show_time("Total time in simulation", time_inactive.elapsed() +
     time_active.elapsed());
   show_time("Time in transport only", time_transport.elapsed(), 1);
@@ -477,12 +846,20 @@ void print_runtime()
     show_time("XS lookups (Non-Fuel)", time_event_calculate_xs_nonfuel.elapsed(), 2);
     show_time("XS queue sorting", time_event_sort.elapsed(), 2);
     show_time("Avg. time per sort", time_event_sort.elapsed() / sort_counter, 2);
+    if (settings::sort_skip_fraction > 0.0)
+      fmt::print("   Sorts skipped (nearly sorted)   = {:d}\n", sort_skip_counter);
     show_time("Advancing", time_event_advance_particle.elapsed(), 2);
     show_time("Tallying", time_event_tally.elapsed(), 2);
     show_time("Surface crossings", time_event_surface_crossing.elapsed(), 2);
     show_time("Collisions", time_event_collision.elapsed(), 2);
     show_time("Particle death", time_event_death.elapsed(), 2);
     show_time("Revival", time_event_revival.elapsed(), 2);
+    show_time("History-based tail", time_event_tail.elapsed(), 2);
+    if (settings::compact_threshold > 0.0) {
+      show_time("Particle compaction", time_event_compact.elapsed(), 2);
+      fmt::print("   Particle buffer compactions     = {:d}\n", compact_counter);
+    }
+    if (settings::kernel_profile) print_kernel_profile();
   }
   if (settings::run_mode == RunMode::EIGENVALUE) {
     show_time("Time in inactive batches", time_inactive.elapsed(), 1);
@@ -490,6 +867,7 @@ void print_runtime()
   show_time("Time in active batches", time_active.elapsed(), 1);
   if (settings::run_mode == RunMode::EIGENVALUE) {
     show_time("Time synchronizing fission bank", time_bank.elapsed(), 1);
+    show_time("Sorting fission sites", time_bank_sort.elapsed(), 2);
     show_time("Sampling source sites", time_bank_sample.elapsed(), 2);
     show_time("SEND/RECV source sites", time_bank_sendrecv.elapsed(), 2);
   }
@@ -533,6 +911,37 @@ void print_runtime()
 
 //==============================================================================
 
+void print_tally_stats()
+{
+  header("Tally Scoring Statistics", 1);
+  fmt::print(" Scoring of one in {} particles is timed; times are extrapolated "
+    "to all events\n\n", TALLY_STATS_SAMPLE_INTERVAL);
+  fmt::print(" {:>8} {:>14} {:>14} {:>14} {:>14} {:>12}\n", "Tally", "Events",
+    "Combinations", "Results", "Est. Time [s]", "[us]/Event");
+
+  // Most expensive tallies first
+  std::vector<int> order;
+  for (int i = 0; i < model::tallies_size; ++i) {
+    if (model::tallies[i].stats_) order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [](int a, int b) {
+    return model::tallies[a].stats_->estimated_time() >
+      model::tallies[b].stats_->estimated_time();
+  });
+
+  for (int i : order) {
+    const auto& t = model::tallies[i];
+    const auto& stats = *t.stats_;
+    double per_event = stats.sampled_events > 0 ?
+      1.0e6 * stats.sampled_time / stats.sampled_events : 0.0;
+    fmt::print(" {:>8} {:>14} {:>14} {:>14} {:>14.4e} {:>12.4f}\n", t.id_,
+      stats.events, stats.combinations, stats.results,
+      stats.estimated_time(), per_event);
+  }
+}
+
+//==============================================================================
+
 std::pair<double, double>
 mean_stdev(const double* x, int n)
 {
@@ -0,0 +1,220 @@
+//! \file overlap_check.cpp
+//! \brief Sampled search for overlapping cells, independent of transport
+
+#include "openmc/capi.h"
+#include "openmc/cell.h"
+#include "openmc/constants.h"
+#include "openmc/device_alloc.h"
+#include "openmc/error.h"
+#include "openmc/geometry.h"
+#include "openmc/output.h"
+#include "openmc/particle.h"
+#include "openmc/random_lcg.h"
+#include "openmc/settings.h"
+#include "openmc/surface.h"
+#include "openmc/timer.h"
+
+#include <fmt/core.h>
+
+#include <algorithm> // for min, sort
+#include <cmath>     // for isfinite
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace openmc {
+
+namespace {
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Largest number of overlapping points kept for the report
+constexpr int64_t MAX_OVERLAP_SITES {1 << 16};
+
+//==============================================================================
+//! A point found inside two cells of the same universe
+//==============================================================================
+
+struct OverlapSite {
+  int32_t cell_found; //!< Cell found by the cell search
+  int32_t cell_other; //!< Other cell that also contains the point
+  int32_t universe;   //!< Universe of both cells
+  Position r;         //!< Global coordinates of the point
+};
+
+#pragma omp declare target
+//! Sample one point and look for every other cell that contains it on each
+//! coordinate level
+//
+//! Cells are skipped once overlap_limit overlaps with them have been found,
+//! or when the point is outside of their bounding box.
+//! \return Whether the point is within the geometry
+bool check_sample(int64_t i, BoundingBox box, const BoundingBox* cell_boxes,
+  int64_t* n_overlaps, int limit, OverlapSite* sites, int64_t* n_sites)
+{
+  uint64_t seed = init_seed(i, STREAM_VOLUME);
+
+  Particle p;
+  p.n_coord_ = 1;
+  p.r() = {box.xmin + prn(&seed) * (box.xmax - box.xmin),
+    box.ymin + prn(&seed) * (box.ymax - box.ymin),
+    box.zmin + prn(&seed) * (box.zmax - box.zmin)};
+  p.u() = {0.5, 0.5, 0.5};
+  if (!exhaustive_find_cell(p)) return false;
+
+  for (int j = 0; j < p.n_coord_; ++j) {
+    const auto& coord {p.coord_[j]};
+    const auto& univ {model::device_universes[coord.universe]};
+    const int32_t* cells = univ.cells_.data();
+    int n_cells = univ.cells_.size();
+    for (int k = 0; k < n_cells; ++k) {
+      int32_t i_cell = cells[k];
+      if (i_cell == coord.cell) continue;
+
+      int64_t n_found;
+      #pragma omp atomic read
+      n_found = n_overlaps[i_cell];
+      if (n_found >= limit) continue;
+
+      const auto& b {cell_boxes[i_cell]};
+      const Position& r {coord.r};
+      if (r.x < b.xmin - FP_COINCIDENT || r.x > b.xmax + FP_COINCIDENT ||
+          r.y < b.ymin - FP_COINCIDENT || r.y > b.ymax + FP_COINCIDENT ||
+          r.z < b.zmin - FP_COINCIDENT || r.z > b.zmax + FP_COINCIDENT) {
+        continue;
+      }
+      if (!model::device_cells[i_cell].contains(r, coord.u, p.surface_)) {
+        continue;
+      }
+
+      #pragma omp atomic capture
+      n_found = n_overlaps[i_cell]++;
+      if (n_found >= limit) continue;
+
+      int64_t i_site;
+      #pragma omp atomic capture
+      i_site = (*n_sites)++;
+      if (i_site < MAX_OVERLAP_SITES) {
+        sites[i_site] = {coord.cell, i_cell, coord.universe, p.r()};
+      }
+    }
+  }
+  return true;
+}
+#pragma omp end declare target
+
+} // namespace
+
+} // namespace openmc
+
+//==============================================================================
+// OPENMC_FIND_OVERLAPS samples points uniformly in the bounding box of the
+// root universe and reports every pair of cells found to contain the same
+// point
+//==============================================================================
+
+int openmc_find_overlaps()
+{
+  using namespace openmc;
+
+  header("CELL OVERLAP CHECK", 3);
+  Timer time_overlaps;
+  time_overlaps.start();
+
+  // Cells are located through the device geometry pointers, which are only
+  // set once the geometry has been moved
+  if (!model::device_cells) {
+    move_settings_to_device();
+    move_geometry_to_device();
+  }
+
+  BoundingBox box = model::universes[model::root_universe].bounding_box();
+  if (!std::isfinite(box.xmin) || !std::isfinite(box.xmax) ||
+      !std::isfinite(box.ymin) || !std::isfinite(box.ymax) ||
+      !std::isfinite(box.zmin) || !std::isfinite(box.zmax)) {
+    set_errmsg("The root universe is unbounded, so there is no box to sample "
+      "points for the overlap check in.");
+    return OPENMC_E_GEOMETRY;
+  }
+
+  // Bounding box of each cell in the coordinates of its universe
+  int n_cells = model::cells.size();
+  std::vector<BoundingBox> cell_boxes(n_cells);
+  for (int i = 0; i < n_cells; ++i) {
+    cell_boxes[i] = model::cells[i].bounding_box();
+  }
+
+  std::vector<int64_t> n_overlaps(n_cells, 0);
+  std::vector<OverlapSite> sites(MAX_OVERLAP_SITES);
+  int64_t n_sites = 0;
+  int64_t n_missed = 0;
+
+  BoundingBox* boxes = cell_boxes.data();
+  int64_t* overlaps = n_overlaps.data();
+  OverlapSite* site_data = sites.data();
+  int64_t n_samples = settings::overlap_samples;
+  int limit = settings::overlap_limit;
+
+  write_message(fmt::format("Sampling {} points on {}...", n_samples,
+    settings::device_overlaps ? "device" : "host"), 6);
+  if (settings::device_overlaps) {
+    #pragma omp target teams distribute parallel for \
+      map(to: boxes[:n_cells]) map(tofrom: overlaps[:n_cells], n_sites) \
+      map(from: site_data[:MAX_OVERLAP_SITES]) reduction(+:n_missed)
+    for (int64_t i = 0; i < n_samples; ++i) {
+      if (!check_sample(i, box, boxes, overlaps, limit, site_data, &n_sites)) {
+        ++n_missed;
+      }
+    }
+  } else {
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+:n_missed)
+    for (int64_t i = 0; i < n_samples; ++i) {
+      if (!check_sample(i, box, boxes, overlaps, limit, site_data, &n_sites)) {
+        ++n_missed;
+      }
+    }
+  }
+  n_sites = std::min(n_sites, MAX_OVERLAP_SITES);
+
+  // Group the overlapping points by cell pair, keeping the first point of each
+  std::map<std::tuple<int32_t, int32_t, int32_t>,
+    std::pair<int64_t, Position>> pairs;
+  for (int64_t i = 0; i < n_sites; ++i) {
+    const auto& site {sites[i]};
+    int32_t id_a = model::cells[site.cell_found].id_;
+    int32_t id_b = model::cells[site.cell_other].id_;
+    auto key = std::make_tuple(model::universes[site.universe].id_,
+      std::min(id_a, id_b), std::max(id_a, id_b));
+    auto it = pairs.find(key);
+    if (it == pairs.end()) {
+      pairs.emplace(key, std::make_pair(int64_t {1}, site.r));
+    } else {
+      ++it->second.first;
+    }
+  }
+
+  if (pairs.empty()) {
+    write_message("No overlapping cells were found.", 4);
+  } else {
+    fmt::print(" Universe     Cell     Cell   Points   First point\n");
+    for (const auto& pair : pairs) {
+      const Position& r {pair.second.second};
+      fmt::print(" {:8} {:8} {:8} {:8}   ({}, {}, {})\n",
+        std::get<0>(pair.first), std::get<1>(pair.first),
+        std::get<2>(pair.first), pair.second.first, r.x, r.y, r.z);
+    }
+    fmt::print("\n");
+    warning(fmt::format("Found {} pairs of overlapping cells. At most {} "
+      "overlapping points are recorded per cell.", pairs.size(), limit));
+  }
+  if (n_missed > 0) {
+    write_message(fmt::format("{} of {} points were outside of the geometry.",
+      n_missed, n_samples), 6);
+  }
+
+  time_overlaps.stop();
+  write_message(fmt::format("Elapsed time: {} s", time_overlaps.elapsed()), 6);
+  return 0;
+}
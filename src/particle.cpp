@@ -1,7 +1,8 @@
 #include "openmc/particle.h"
 
-#include <algorithm> // copy, min
+#include <algorithm> // copy, max, min
 #include <cmath>     // log, abs
+#include <iostream>
 
 #include <fmt/core.h>
 
@@ -12,7 +13,9 @@
 #include "openmc/error.h"
 #include "openmc/geometry.h"
 #include "openmc/hdf5_interface.h"
+#include "openmc/lattice.h"
 #include "openmc/material.h"
+#include "openmc/memory_registry.h"
 #include "openmc/message_passing.h"
 #include "openmc/mgxs_interface.h"
 #include "openmc/nuclide.h"
@@ -22,18 +25,52 @@
 #include "openmc/random_lcg.h"
 #include "openmc/settings.h"
 #include "openmc/source.h"
+#include "openmc/state_point.h"
 #include "openmc/surface.h"
 #include "openmc/simulation.h"
 #include "openmc/tallies/derivative.h"
 #include "openmc/tallies/tally.h"
 #include "openmc/tallies/tally_scoring.h"
 #include "openmc/track_output.h"
+#include "openmc/weight_windows.h"
 #ifndef DEVICE_PRINTF
 #define printf(fmt, ...) (0)
 #endif
 
 namespace openmc {
 
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+NuclideMicroXS* micro_xs_pool {nullptr};
+int micro_xs_slot_size {0};
+int micro_xs_pool_slots {0};
+double* flux_derivs_pool {nullptr};
+int flux_derivs_slot_size {0};
+int flux_derivs_pool_slots {0};
+double* nuclide_cdf_pool {nullptr};
+int nuclide_cdf_slot_size {0};
+int nuclide_cdf_pool_slots {0};
+ElementMicroXS* photon_xs_pool {nullptr};
+int photon_xs_slot_size {0};
+int photon_xs_pool_slots {0};
+int depletion_rx[MAX_DEPLETION_RX];
+int n_depletion_rx {0};
+double* depletion_rx_pool {nullptr};
+int depletion_rx_slot_size {0};
+int depletion_rx_pool_slots {0};
+Particle::NuBank* nu_bank_pool {nullptr};
+int nu_bank_slot_size {0};
+int nu_bank_pool_slots {0};
+LostParticle* lost_particles {nullptr};
+int lost_particle_capacity {0};
+int n_lost_records {0};
+
+} // namespace simulation
+
 //==============================================================================
 // LocalCoord implementation
 //==============================================================================
@@ -76,7 +113,6 @@ Particle::Particle()
 
   // Create microscopic cross section caches
   //neutron_xs_.resize(data::nuclides_size);
-  //photon_xs_.resize(data::elements.size());
 }
 
 void
@@ -87,21 +123,85 @@ Particle::clear()
   n_coord_ = 1;
 }
 
+double
+Particle::speed() const
+{
+  // Photons move at the speed of light, while the speed of massive particles
+  // follows from their kinetic energy relativistically
+  double mass;
+  switch (type_) {
+  case Type::neutron:
+    mass = MASS_NEUTRON_EV;
+    break;
+  case Type::photon:
+    return 100.0 * C_LIGHT;
+  default:
+    mass = MASS_ELECTRON_EV;
+  }
+  return 100.0 * C_LIGHT * std::sqrt(E_ * (E_ + 2.0 * mass)) / (E_ + mass);
+}
+
 void
 Particle::create_secondary(double wgt, Direction u, double E, Type type)
 {
   //secondary_bank_.emplace_back();
 
   //auto& bank {secondary_bank_.back()};
-  //assert(secondary_bank_length_ < SECONDARY_BANK_SIZE);
-  auto& bank = secondary_bank_[secondary_bank_length_++];
+  Bank bank;
   bank.particle = type;
   bank.wgt = wgt;
   bank.r = this->r();
   bank.u = u;
   bank.E = settings::run_CE ? E : g_;
+  bank.time = time_;
+
+  if (push_secondary(bank)) n_bank_second_ += 1;
+}
+
+bool
+Particle::push_secondary(const Bank& site)
+{
+  if (secondary_bank_length_ < SECONDARY_BANK_SIZE) {
+    secondary_bank_[secondary_bank_length_++] = site;
+    return true;
+  }
+
+  int idx = simulation::secondary_pool.thread_safe_append(site);
+  if (idx == -1) {
+    printf("The shared secondary particle pool is full. Additional secondary "
+      "particles created in this generation will not be banked.\n");
+    return false;
+  }
+  simulation::device_secondary_pool_link[idx] = secondary_spill_head_;
+  secondary_spill_head_ = idx;
+  ++secondary_bank_length_;
+  return true;
+}
+
+Particle::Bank
+Particle::pop_secondary()
+{
+  --secondary_bank_length_;
+  if (secondary_bank_length_ < SECONDARY_BANK_SIZE) {
+    return secondary_bank_[secondary_bank_length_];
+  }
 
-  n_bank_second_ += 1;
+  int idx = secondary_spill_head_;
+  secondary_spill_head_ = simulation::device_secondary_pool_link[idx];
+  return simulation::secondary_pool[idx];
+}
+
+const Particle::Bank&
+Particle::secondary(int64_t i) const
+{
+  if (i < SECONDARY_BANK_SIZE) return secondary_bank_[i];
+
+  // Spilled sites are chained from newest to oldest
+  int idx = secondary_spill_head_;
+  for (int64_t j = secondary_bank_length_ - 1; j > i; --j) {
+    idx = simulation::device_secondary_pool_link[idx];
+  }
+  return simulation::secondary_pool[idx];
 }
 
 void
@@ -114,8 +214,10 @@ Particle::from_source(const Bank& src)
   material_ = C_NONE;
   n_collision_ = 0;
   fission_ = false;
+  delta_state_ = DeltaState::none;
+  tms_nuclide_ = C_NONE;
   //std::fill(flux_derivs_.begin(), flux_derivs_.end(), 0.0);
-  std::fill(flux_derivs_, flux_derivs_ + FLUX_DERIVS_SIZE, 0.0);
+  clear_flux_derivs();
 
   // Copy attributes from source bank site
   type_ = src.particle;
@@ -126,16 +228,15 @@ Particle::from_source(const Bank& src)
   r_last_current_ = src.r;
   r_last_ = src.r;
   u_last_ = src.u;
+  time_ = src.time;
+  time_last_ = src.time;
   if (settings::run_CE) {
     E_ = src.E;
     g_ = 0;
   } else {
-    printf("Error - MG mode not supported yet on device.\n");
-    /*
     g_ = static_cast<int>(src.E);
     g_last_ = static_cast<int>(src.E);
-    E_ = data::mg.energy_bin_avg_[g_];
-    */
+    E_ = data::mg_tables.energy_bin_avg(g_);
   }
   E_last_ = E_;
 }
@@ -156,6 +257,9 @@ Particle::event_calculate_xs_dispatch()
   u_last_ = this->u();
   r_last_ = this->r();
 
+  // Record the start of each flight in the particle track
+  if (write_track_) write_particle_track(*this);
+
   // Reset event variables
   event_ = TallyEvent::KILL;
   event_nuclide_ = NUCLIDE_NONE;
@@ -192,16 +296,13 @@ Particle::event_calculate_xs_dispatch()
         return true;
       }
     } else {
-      printf("multigroup mode not yet supported on device.\n");
-      /*
       // Get the MG data; unlike the CE case above, we have to re-calculate
       // cross sections for every collision since the cross sections may
       // be angle-dependent
-      data::mg.macro_xs_[material_].calculate_xs(*this);
+      data::mg_tables.calculate_xs(material_, *this);
 
       // Update the particle's group while we know we are multi-group
       g_last_ = g_;
-      */
     }
   } else {
     macro_xs_.total      = 0.0;
@@ -236,22 +337,95 @@ Particle::event_calculate_xs(bool need_depletion_rx)
 void
 Particle::event_advance()
 {
-  //   if(id_ == 1 )
-  //    printf("In event_advance() -- model::device_cells ptr = %p\n", model::device_cells);
-  // Find the distance to the nearest boundary
-  boundary_ = distance_to_boundary(*this);
+  time_last_ = time_;
+
+  // Accept or reject a tentative collision of a delta-tracked flight, now that
+  // the cross sections where it happens are known. A real collision happens
+  // right here, while a virtual one continues the flight.
+  if (delta_state_ == DeltaState::located) {
+    delta_state_ = DeltaState::none;
+
+    // Where target motion sampling Doppler broadens the material, it accepts
+    // the collisions that fall below its own majorant instead
+    double cutoff = prn(this->current_seed()) * delta_majorant_;
+    double tms_majorant = material_ == MATERIAL_VOID ? 0.0 :
+      model::materials[material_].tms_majorant_xs(E_);
+
+    // Tentative collisions occur at the rate of the majorant along the flight,
+    // so each one scores 1/majorant of track length to the estimate of k-eff.
+    // Target motion sampling scores the broadened XS itself.
+    if (settings::run_mode == RunMode::EIGENVALUE && tms_majorant == 0.0) {
+      keff_tally_tracklength_ += wgt_ * macro_xs_.nu_fission / delta_majorant_;
+    }
+    bool real = tms_majorant > 0.0 ?
+      cutoff < tms_majorant && sample_tms_collision(*this, cutoff) :
+      cutoff < macro_xs_.total;
+    if (real) {
+      boundary_ = BoundaryInfo {};
+      collision_distance_ = 0.0;
+      advance_distance_ = 0.0;
+      return;
+    }
+  }
 
-  //if( id_ == 1 )
-  //  printf("distance to boundary = %.3le\n", boundary_.distance);
-
-  // Sample a distance to collision
-  if (type_ == Particle::Type::electron ||
-      type_ == Particle::Type::positron) {
-    collision_distance_ = 0.0;
-  } else if (macro_xs_.total == 0.0) {
-    collision_distance_ = INFINITY;
+  // Find the outermost delta-tracking cell the particle is in, if neutrons of
+  // its energy can be delta-tracked
+  int delta_level = C_NONE;
+  bool tms = false;
+  double majorant = 0.0;
+  if (settings::delta_tracking && type_ == Particle::Type::neutron) {
+    for (int j = 0; j < n_coord_; ++j) {
+      if (model::device_cells[coord_[j].cell].delta_tracking_) {
+        majorant = majorant_xs(E_);
+        if (majorant > 0.0) delta_level = j;
+        break;
+      }
+    }
+  }
+
+  if (delta_level != C_NONE) {
+    // Only the boundaries of the delta-tracking cell and of the levels above
+    // it end the flight. The collision sampled with the majorant is
+    // tentative: the particle is located there by event_collide() and the
+    // collision is accepted or rejected by the next event_advance().
+    boundary_ = distance_to_boundary(*this, delta_level + 1);
+    collision_distance_ = -std::log(prn(this->current_seed())) / majorant;
+    if (collision_distance_ <= boundary_.distance) {
+      delta_state_ = DeltaState::tentative;
+      delta_level_ = delta_level;
+      delta_majorant_ = majorant;
+    }
   } else {
-    collision_distance_ = -std::log(prn(this->current_seed())) / macro_xs_.total;
+    //   if(id_ == 1 )
+    //    printf("In event_advance() -- model::device_cells ptr = %p\n", model::device_cells);
+    // Find the distance to the nearest boundary
+    boundary_ = distance_to_boundary(*this);
+
+    //if( id_ == 1 )
+    //  printf("distance to boundary = %.3le\n", boundary_.distance);
+
+    // Sample a distance to collision. Where target motion sampling Doppler
+    // broadens the material, the collision is sampled with its majorant and
+    // is only tentative.
+    double tms_majorant = 0.0;
+    if (type_ == Particle::Type::neutron && material_ != MATERIAL_VOID) {
+      tms_majorant = model::materials[material_].tms_majorant_xs(E_);
+    }
+    if (type_ == Particle::Type::electron ||
+        type_ == Particle::Type::positron) {
+      collision_distance_ = 0.0;
+    } else if (tms_majorant > 0.0) {
+      tms = true;
+      collision_distance_ = -std::log(prn(this->current_seed())) / tms_majorant;
+      if (collision_distance_ <= boundary_.distance) {
+        delta_state_ = DeltaState::tms;
+        delta_majorant_ = tms_majorant;
+      }
+    } else if (macro_xs_.total == 0.0) {
+      collision_distance_ = INFINITY;
+    } else {
+      collision_distance_ = -std::log(prn(this->current_seed())) / macro_xs_.total;
+    }
   }
 
   //if( id_ == 1 )
@@ -260,10 +434,27 @@ Particle::event_advance()
   // Select smaller of the two distances
   advance_distance_ = std::min(boundary_.distance, collision_distance_);
 
+  // Advance the clock. A particle that would pass its time cutoff is stopped
+  // where it reaches it instead, and killed there by event_collide().
+  double speed = this->speed();
+  double time_cutoff = settings::time_cutoff[static_cast<int>(type_)];
+  if (time_ + advance_distance_ / speed > time_cutoff) {
+    advance_distance_ = std::max(0.0, (time_cutoff - time_) * speed);
+    collision_distance_ = advance_distance_;
+    delta_state_ = DeltaState::none;
+    time_ = std::max(time_, time_cutoff);
+  } else {
+    time_ += advance_distance_ / speed;
+  }
+
   // Advance particle
   for (int j = 0; j < n_coord_; ++j) {
     coord_[j].r += advance_distance_ * coord_[j].u;
   }
+  if (settings::plane_cache) {
+    const auto& coord {coord_[n_coord_ - 1]};
+    plane_cache_.advance(advance_distance_, coord.r, coord.u);
+  }
   /*
   if( id_ == 1 )
   {
@@ -272,9 +463,11 @@ Particle::event_advance()
   }
   */
 
-  // Score track-length estimate of k-eff
+  // Score track-length estimate of k-eff. Delta-tracked flights may cross
+  // several materials, and the unbroadened XS do not hold where target motion
+  // sampling is used, so they score at their tentative collisions instead.
   if (settings::run_mode == RunMode::EIGENVALUE &&
-      type_ == Particle::Type::neutron) {
+      type_ == Particle::Type::neutron && delta_level == C_NONE && !tms) {
     keff_tally_tracklength_ += wgt_ * advance_distance_ * macro_xs_.nu_fission;
   }
 }
@@ -285,7 +478,7 @@ void Particle::event_tracklength_tally(bool need_depletion_rx)
   score_tracklength_tally(*this, advance_distance_, need_depletion_rx);
 
   // Score flux derivative accumulators for differential tallies.
-  // score_track_derivative(*this, advance_distance_);
+  if (model::n_tally_derivs > 0) score_track_derivative(*this, advance_distance_);
 }
 
 void
@@ -293,6 +486,7 @@ Particle::event_cross_surface()
 {
   // Set surface that particle is on and adjust coordinate levels
   surface_ = boundary_.surface_index;
+  n_coord_crossing_ = n_coord_;
   n_coord_ = boundary_.coord_level;
 
   // Saving previous cell data
@@ -313,58 +507,102 @@ Particle::event_cross_surface()
     event_ = TallyEvent::SURFACE;
   }
   // Score cell to cell partial currents
-  // TODO: Add this capability back in
-  // NOTE: The lack of this capability is enforced in device_alloc.cpp
-  /*
-  if (!model::active_surface_tallies.empty()) {
-    score_surface_tally(*this, model::active_surface_tallies);
+  if (model::active_surface_tallies_size > 0) {
+    score_surface_tally(*this, model::device_active_surface_tallies,
+      model::active_surface_tallies_size);
   }
-  */
+
+  // Split or roulette on entering the next window
+  if (settings::weight_windows_on && alive()) apply_weight_windows(*this);
 }
 
 void
 Particle::event_collide()
 {
-  // Score collision estimate of keff
+  event_collide_sample();
+  event_collide_finish();
+}
+
+void
+Particle::event_collide_sample()
+{
+  collision_class_ = CollisionClass::none;
+
+  // A particle stopped at its time cutoff dies there instead of colliding
+  if (time_ >= settings::time_cutoff[static_cast<int>(type_)]) {
+    wgt_ = 0.0;
+    return;
+  }
+
+  // A tentative collision of a delta-tracked flight only locates the particle
+  // below the delta-tracking cell, whose geometry it went through unseen
+  if (delta_state_ == DeltaState::tentative) {
+    if (!find_cell_below(*this, delta_level_)) {
+      mark_as_lost_short();
+      return;
+    }
+    delta_state_ = DeltaState::located;
+    return;
+  }
+
+  // A tentative collision of target motion sampling is accepted or rejected
+  // right away, as it stayed in the cell its XS are known for
+  if (delta_state_ == DeltaState::tms) {
+    delta_state_ = DeltaState::none;
+    if (!sample_tms_collision(*this, prn(this->current_seed()) *
+        delta_majorant_)) return;
+  }
+
+  // Score collision estimate of keff. After target motion sampling the
+  // nuclide's XS at the relative energy stand for those of the material.
   if (settings::run_mode == RunMode::EIGENVALUE &&
       type_ == Particle::Type::neutron) {
-    keff_tally_collision_ += wgt_ * macro_xs_.nu_fission
-      / macro_xs_.total;
+    if (tms_nuclide_ != C_NONE) {
+      const auto& micro {neutron_xs_[tms_nuclide_]};
+      keff_tally_collision_ += wgt_ * micro.nu_fission / micro.total;
+    } else {
+      keff_tally_collision_ += wgt_ * macro_xs_.nu_fission
+        / macro_xs_.total;
+    }
   }
 
   // Score surface current tallies -- this has to be done before the collision
   // since the direction of the particle will change and we need to use the
   // pre-collision direction to figure out what mesh surfaces were crossed
-
-  /*
-  if (!model::active_meshsurf_tallies.empty())
-    score_surface_tally(*this, model::active_meshsurf_tallies);
-  */
+  if (model::active_meshsurf_tallies_size > 0) {
+    score_surface_tally(*this, model::device_active_meshsurf_tallies,
+      model::active_meshsurf_tallies_size);
+  }
 
   // Clear surface component
   surface_ = 0;
 
   if (settings::run_CE) {
-    collision(*this);
+    sample_collision(*this);
   } else {
-    /*
     collision_mg(*this);
-    */
+    collision_class_ = CollisionClass::complete;
   }
+}
+
+void
+Particle::event_collide_finish()
+{
+  if (collision_class_ == CollisionClass::none) return;
+
+  if (settings::run_CE) finish_collision(*this);
 
   // Score collision estimator tallies -- this is done after a collision
   // has occurred rather than before because we need information on the
   // outgoing energy for any tallies with an outgoing energy filter
-  /*
-  if (!model::active_collision_tallies.empty()) score_collision_tally(*this);
-  if (!model::active_analog_tallies.empty()) {
+  if (model::active_collision_tallies_size > 0) score_collision_tally(*this);
+  if (model::active_analog_tallies_size > 0) {
     if (settings::run_CE) {
       score_analog_tally_ce(*this);
     } else {
       score_analog_tally_mg(*this);
     }
   }
-  */
 
   // Reset banked weight during collision
   n_bank_ = 0;
@@ -397,9 +635,10 @@ Particle::event_collide()
   }
 
   // Score flux derivative accumulators for differential tallies.
-  /*
-  if (!model::active_tallies.empty()) score_collision_derivative(*this);
-  */
+  if (model::n_tally_derivs > 0) score_collision_derivative(*this);
+
+  // Split or roulette with the post-collision weight and energy
+  if (settings::weight_windows_on && alive()) apply_weight_windows(*this);
 }
 
 void
@@ -423,7 +662,7 @@ Particle::event_revive_from_secondary()
     if (secondary_bank_length_ == 0) return;
 
     //this->from_source(secondary_bank_.back());
-    this->from_source(secondary_bank_[--secondary_bank_length_]);
+    this->from_source(pop_secondary());
     //secondary_bank_.pop_back();
     n_event_ = 0;
 
@@ -438,9 +677,7 @@ Particle::event_revive_from_secondary()
     neutron_xs_.clear();
 
     // Enter new particle in particle track file
-    /*
     if (write_track_) add_particle_track(*this);
-    */
   }
 }
 
@@ -484,16 +721,11 @@ void
 Particle::event_death()
 {
   #ifdef DAGMC
-  if (settings::dagmc) history_.reset();
+  if (settings::dagmc) cold().history.reset();
   #endif
 
   // Finish particle track output.
-  /*
-  if (write_track_) {
-    write_particle_track(*this);
-    finalize_particle_track(*this);
-  }
-  */
+  if (write_track_) write_particle_track(*this);
 
   // Record the number of progeny created by this particle.
   // This data will be used to efficiently sort the fission bank.
@@ -609,16 +841,14 @@ Particle::cross_vacuum_bc(const Surface& surf)
   // Score any surface current tallies -- note that the particle is moved
   // forward slightly so that if the mesh boundary is on the surface, it is
   // still processed
-
-  /*
-  if (!model::active_meshsurf_tallies.empty()) {
+  if (model::active_meshsurf_tallies_size > 0) {
     // TODO: Find a better solution to score surface currents than
     // physically moving the particle forward slightly
 
     this->r() += TINY_BIT * this->u();
-    score_surface_tally(*this, model::active_meshsurf_tallies);
+    score_surface_tally(*this, model::device_active_meshsurf_tallies,
+      model::active_meshsurf_tallies_size);
   }
-  */
 
   // Score to global leakage tally
   keff_tally_leakage_ += wgt_;
@@ -654,19 +884,18 @@ Particle::cross_reflective_bc(const Surface& surf, Direction new_u)
   // once after. For mesh surface filters, we need to artificially move
   // the particle slightly back in case the surface crossing is coincident
   // with a mesh boundary
-
-  /*
-  if (!model::active_surface_tallies.empty()) {
-    score_surface_tally(*this, model::active_surface_tallies);
+  if (model::active_surface_tallies_size > 0) {
+    score_surface_tally(*this, model::device_active_surface_tallies,
+      model::active_surface_tallies_size);
   }
 
-  if (!model::active_meshsurf_tallies.empty()) {
+  if (model::active_meshsurf_tallies_size > 0) {
     Position r {this->r()};
     this->r() -= TINY_BIT * this->u();
-    score_surface_tally(*this, model::active_meshsurf_tallies);
+    score_surface_tally(*this, model::device_active_meshsurf_tallies,
+      model::active_meshsurf_tallies_size);
     this->r() = r;
   }
-  */
 
   // Set the new particle direction
   this->u() = new_u;
@@ -679,7 +908,10 @@ Particle::cross_reflective_bc(const Surface& surf, Direction new_u)
   // boundary, it is necessary to redetermine the particle's coordinates in
   // the lower universes.
   // (unless we're using a dagmc model, which has exactly one universe)
-  if (!settings::dagmc) {
+  if (settings::fast_reflection && !settings::dagmc && reflect_lower_levels()) {
+    material_last_ = material_;
+    sqrtkT_last_ = sqrtkT_;
+  } else if (!settings::dagmc) {
     n_coord_ = 1;
 
     if (!neighbor_list_find_cell(*this)) {
@@ -704,6 +936,31 @@ Particle::cross_reflective_bc(const Surface& surf, Direction new_u)
   */
 }
 
+bool
+Particle::reflect_lower_levels()
+{
+  for (int j = 1; j < n_coord_crossing_; ++j) {
+    const auto& above {coord_[j - 1]};
+    auto& coord {coord_[j]};
+    const auto& c {model::device_cells[above.cell]};
+    coord.u = coord.rotated ? above.u.rotate(c.rotation_) : above.u;
+
+    // A particle on a tile boundary is in the tile it is heading into
+    if (coord.lattice != C_NONE) {
+      const auto& lat {model::device_lattices[coord.lattice]};
+      Position r = above.r - c.translation_;
+      if (coord.rotated) r = r.rotate(c.rotation_);
+      auto i_xyz = lat.get_indices(r, coord.u);
+      if (i_xyz[0] != coord.lattice_x || i_xyz[1] != coord.lattice_y ||
+          i_xyz[2] != coord.lattice_z) {
+        return false;
+      }
+    }
+  }
+  n_coord_ = n_coord_crossing_;
+  return true;
+}
+
 void
 Particle::cross_periodic_bc(const Surface& surf, Position new_r,
                             Direction new_u, int new_surface)
@@ -719,10 +976,11 @@ Particle::cross_periodic_bc(const Surface& surf, Position new_r,
   // Score surface currents since reflection causes the direction of the
   // particle to change -- artificially move the particle slightly back in
   // case the surface crossing is coincident with a mesh boundary
-  if (!model::active_meshsurf_tallies.empty()) {
+  if (model::active_meshsurf_tallies_size > 0) {
     Position r {this->r()};
     this->r() -= TINY_BIT * this->u();
-    score_surface_tally(*this, model::active_meshsurf_tallies);
+    score_surface_tally(*this, model::device_active_meshsurf_tallies,
+      model::active_meshsurf_tallies_size);
     this->r() = r;
   }
 
@@ -779,25 +1037,64 @@ Particle::mark_as_lost(const char* message)
 void
 Particle::mark_as_lost_short()
 {
-  // Increment number of lost particles
+  // Keep the state of the particle for its restart file while there is room
+  int i;
+  #pragma omp atomic capture
+  i = simulation::n_lost_records++;
+  if (i < simulation::lost_particle_capacity) {
+    record_lost(simulation::lost_particles[i]);
+  }
+
+  // The number of lost particles is brought up to date on host from the
+  // number of records when they are checked
   wgt_ = 0.0;
-  #pragma omp atomic
-  simulation::n_lost_particles += 1;
+}
+
+void
+Particle::record_lost(LostParticle& lost) const
+{
+  lost.id = id_;
+  lost.current_work = current_work_;
+  lost.type = type_;
+  lost.r = r();
+  lost.u = u();
+  lost.E = E_;
+  lost.wgt = wgt_;
+  for (int i = 0; i < N_STREAMS; ++i) {
+    lost.seeds[i] = seeds_[i];
+  }
+  lost.n_coord = n_coord_;
+  for (int j = 0; j < n_coord_; ++j) {
+    lost.cell[j] = coord_[j].cell;
+  }
+  lost.material = material_;
+  lost.surface = surface_;
+  if (settings::run_mode == RunMode::EIGENVALUE) {
+    lost.source = simulation::device_source_bank[current_work_ - 1];
+  }
 }
 
 void
 Particle::write_restart() const
+{
+  LostParticle lost;
+  record_lost(lost);
+  write_particle_restart(lost);
+}
+
+void write_particle_restart(const LostParticle& lost)
 {
   // Dont write another restart file if in particle restart mode
   if (settings::run_mode == RunMode::PARTICLE) return;
 
   // Set up file name
   auto filename = fmt::format("{}particle_{}_{}.h5", settings::path_output,
-    simulation::current_batch, id_);
+    simulation::current_batch, lost.id);
 
   #pragma omp critical (WriteParticleRestart)
   {
-    // Create file
+    // Create file once no statepoint is being written
+    finish_statepoint_write();
     hid_t file_id = file_open(filename, 'w');
 
     // Write filetype and version info
@@ -826,16 +1123,16 @@ Particle::write_restart() const
       default:
         break;
     }
-    write_dataset(file_id, "id", id_);
-    write_dataset(file_id, "type", static_cast<int>(type_));
+    write_dataset(file_id, "id", lost.id);
+    write_dataset(file_id, "type", static_cast<int>(lost.type));
 
-    int64_t i = current_work_;
+    int64_t i = lost.current_work;
     if (settings::run_mode == RunMode::EIGENVALUE) {
       //take source data from primary bank for eigenvalue simulation
-      write_dataset(file_id, "weight", simulation::source_bank[i-1].wgt);
-      write_dataset(file_id, "energy", simulation::source_bank[i-1].E);
-      write_dataset(file_id, "xyz", simulation::source_bank[i-1].r);
-      write_dataset(file_id, "uvw", simulation::source_bank[i-1].u);
+      write_dataset(file_id, "weight", lost.source.wgt);
+      write_dataset(file_id, "energy", lost.source.E);
+      write_dataset(file_id, "xyz", lost.source.r);
+      write_dataset(file_id, "uvw", lost.source.u);
     } else if (settings::run_mode == RunMode::FIXED_SOURCE) {
       // re-sample using rng random number seed used to generate source particle
       int64_t id = (simulation::total_gen + overall_generation() - 1)*settings::n_particles +
@@ -849,6 +1146,31 @@ Particle::write_restart() const
       write_dataset(file_id, "uvw", site.u);
     }
 
+    // Write the state of the particle where it was lost
+    hid_t lost_group = create_group(file_id, "lost");
+    write_dataset(lost_group, "weight", lost.wgt);
+    write_dataset(lost_group, "energy", lost.E);
+    write_dataset(lost_group, "xyz", lost.r);
+    write_dataset(lost_group, "uvw", lost.u);
+    std::vector<int> cells;
+    for (int j = 0; j < lost.n_coord; ++j) {
+      cells.push_back(lost.cell[j] == C_NONE ? C_NONE :
+        model::cells[lost.cell[j]].id_);
+    }
+    write_dataset(lost_group, "cells", cells);
+    write_dataset(lost_group, "material", lost.material == MATERIAL_VOID ?
+      MATERIAL_VOID : model::materials[lost.material].id_);
+    int surface_id = 0;
+    if (lost.surface != 0) {
+      surface_id = model::surfaces[std::abs(lost.surface) - 1].id_;
+      if (lost.surface < 0) surface_id = -surface_id;
+    }
+    write_dataset(lost_group, "surface", surface_id);
+    std::array<uint64_t, N_STREAMS> seeds;
+    std::copy(lost.seeds, lost.seeds + N_STREAMS, seeds.begin());
+    write_dataset(lost_group, "seeds", seeds);
+    close_group(lost_group);
+
     // Close file
     file_close(file_id);
   } // #pragma omp critical
@@ -884,4 +1206,319 @@ Particle::Type str_to_particle_type(std::string str)
   }
 }
 
+void reserve_micro_xs_pool(int n_slots)
+{
+  // The number of slots is recorded in every build, as transport loops keep
+  // that many particles in flight at once
+#ifdef NO_MICRO_XS_CACHE
+  simulation::micro_xs_pool_slots = n_slots;
+#else
+  free_micro_xs_pool();
+
+  simulation::micro_xs_slot_size = data::nuclides_size;
+  simulation::micro_xs_pool_slots = n_slots;
+  int64_t n = static_cast<int64_t>(n_slots) * simulation::micro_xs_slot_size;
+  simulation::micro_xs_pool = new NuclideMicroXS[n];
+  #pragma omp target update to(simulation::micro_xs_slot_size)
+  #pragma omp target enter data map(alloc: simulation::micro_xs_pool[:n])
+  int64_t n_bytes = n * sizeof(NuclideMicroXS);
+  record_memory("Micro XS cache", MemorySpace::host, n_bytes);
+  record_memory("Micro XS cache", MemorySpace::device, n_bytes);
+
+  if (mpi::master) {
+    std::cout << " Allocating micro XS cache pool of size: "
+      << n * sizeof(NuclideMicroXS) / 1.0e6 << " MB ("
+      << n_slots << " slots of " << simulation::micro_xs_slot_size
+      << " nuclides)" << std::endl;
+  }
+#endif
+}
+
+void free_micro_xs_pool()
+{
+#ifndef NO_MICRO_XS_CACHE
+  if (!simulation::micro_xs_pool) return;
+  int64_t n = static_cast<int64_t>(simulation::micro_xs_pool_slots) *
+    simulation::micro_xs_slot_size;
+  #pragma omp target exit data map(delete: simulation::micro_xs_pool[:n])
+  delete[] simulation::micro_xs_pool;
+  int64_t n_bytes = n * sizeof(NuclideMicroXS);
+  record_memory("Micro XS cache", MemorySpace::host, -n_bytes);
+  record_memory("Micro XS cache", MemorySpace::device, -n_bytes);
+  simulation::micro_xs_pool = nullptr;
+#endif
+  simulation::micro_xs_pool_slots = 0;
+}
+
+void reserve_flux_derivs_pool(int n_slots)
+{
+  free_flux_derivs_pool();
+
+  simulation::flux_derivs_slot_size = model::tally_derivs.size();
+  #pragma omp target update to(simulation::flux_derivs_slot_size)
+  if (simulation::flux_derivs_slot_size == 0) return;
+
+  simulation::flux_derivs_pool_slots = n_slots;
+  int64_t n = static_cast<int64_t>(n_slots) * simulation::flux_derivs_slot_size;
+  simulation::flux_derivs_pool = new double[n];
+  #pragma omp target enter data map(alloc: simulation::flux_derivs_pool[:n])
+
+  if (mpi::master) {
+    std::cout << " Allocating flux derivative pool of size: "
+      << n * sizeof(double) / 1.0e6 << " MB (" << n_slots << " slots of "
+      << simulation::flux_derivs_slot_size << " derivatives)" << std::endl;
+  }
+}
+
+void free_flux_derivs_pool()
+{
+  if (!simulation::flux_derivs_pool) return;
+  int64_t n = static_cast<int64_t>(simulation::flux_derivs_pool_slots) *
+    simulation::flux_derivs_slot_size;
+  #pragma omp target exit data map(delete: simulation::flux_derivs_pool[:n])
+  delete[] simulation::flux_derivs_pool;
+  simulation::flux_derivs_pool = nullptr;
+  simulation::flux_derivs_pool_slots = 0;
+}
+
+void reserve_nuclide_cdf_pool(int n_slots)
+{
+  free_nuclide_cdf_pool();
+
+  simulation::nuclide_cdf_slot_size = 0;
+  if (settings::nuclide_cdf && settings::run_CE) {
+    for (int i = 0; i < model::materials_size; ++i) {
+      simulation::nuclide_cdf_slot_size = std::max(
+        simulation::nuclide_cdf_slot_size,
+        static_cast<int>(model::materials[i].nuclide_.size()));
+    }
+  }
+  #pragma omp target update to(simulation::nuclide_cdf_slot_size)
+  if (simulation::nuclide_cdf_slot_size == 0) return;
+
+  simulation::nuclide_cdf_pool_slots = n_slots;
+  int64_t n = static_cast<int64_t>(n_slots) * simulation::nuclide_cdf_slot_size;
+  simulation::nuclide_cdf_pool = new double[n];
+  #pragma omp target enter data map(alloc: simulation::nuclide_cdf_pool[:n])
+
+  if (mpi::master) {
+    std::cout << " Allocating nuclide CDF pool of size: "
+      << n * sizeof(double) / 1.0e6 << " MB (" << n_slots << " slots of "
+      << simulation::nuclide_cdf_slot_size << " nuclides)" << std::endl;
+  }
+}
+
+void free_nuclide_cdf_pool()
+{
+  if (!simulation::nuclide_cdf_pool) return;
+  int64_t n = static_cast<int64_t>(simulation::nuclide_cdf_pool_slots) *
+    simulation::nuclide_cdf_slot_size;
+  #pragma omp target exit data map(delete: simulation::nuclide_cdf_pool[:n])
+  delete[] simulation::nuclide_cdf_pool;
+  simulation::nuclide_cdf_pool = nullptr;
+  simulation::nuclide_cdf_pool_slots = 0;
+}
+
+void reserve_depletion_rx_pool(int n_slots)
+{
+  free_depletion_rx_pool();
+
+  // One row of macroscopic XS and, with the micro XS cache, one per nuclide
+  int n_rows = 1;
+#ifndef NO_MICRO_XS_CACHE
+  n_rows += data::nuclides_size;
+#endif
+  simulation::depletion_rx_slot_size = simulation::n_depletion_rx * n_rows;
+  #pragma omp target update to(simulation::depletion_rx_slot_size)
+  if (simulation::depletion_rx_slot_size == 0) return;
+
+  simulation::depletion_rx_pool_slots = n_slots;
+  int64_t n = static_cast<int64_t>(n_slots) * simulation::depletion_rx_slot_size;
+  simulation::depletion_rx_pool = new double[n];
+  #pragma omp target enter data map(alloc: simulation::depletion_rx_pool[:n])
+  int64_t n_bytes = n * sizeof(double);
+  record_memory("Depletion reaction XS", MemorySpace::host, n_bytes);
+  record_memory("Depletion reaction XS", MemorySpace::device, n_bytes);
+
+  if (mpi::master) {
+    std::cout << " Allocating depletion reaction XS pool of size: "
+      << n_bytes / 1.0e6 << " MB (" << n_slots << " slots of "
+      << simulation::n_depletion_rx << " reactions)" << std::endl;
+  }
+}
+
+void free_depletion_rx_pool()
+{
+  if (!simulation::depletion_rx_pool) return;
+  int64_t n = static_cast<int64_t>(simulation::depletion_rx_pool_slots) *
+    simulation::depletion_rx_slot_size;
+  #pragma omp target exit data map(delete: simulation::depletion_rx_pool[:n])
+  delete[] simulation::depletion_rx_pool;
+  int64_t n_bytes = n * sizeof(double);
+  record_memory("Depletion reaction XS", MemorySpace::host, -n_bytes);
+  record_memory("Depletion reaction XS", MemorySpace::device, -n_bytes);
+  simulation::depletion_rx_pool = nullptr;
+  simulation::depletion_rx_pool_slots = 0;
+}
+
+void reserve_photon_xs_pool(int n_slots)
+{
+  free_photon_xs_pool();
+
+  simulation::photon_xs_slot_size = settings::photon_transport ?
+    data::elements_size : 0;
+  #pragma omp target update to(simulation::photon_xs_slot_size)
+  if (simulation::photon_xs_slot_size == 0) return;
+
+  simulation::photon_xs_pool_slots = n_slots;
+  int64_t n = static_cast<int64_t>(n_slots) * simulation::photon_xs_slot_size;
+  simulation::photon_xs_pool = new ElementMicroXS[n];
+  #pragma omp target enter data map(alloc: simulation::photon_xs_pool[:n])
+
+  if (mpi::master) {
+    std::cout << " Allocating photon XS cache pool of size: "
+      << n * sizeof(ElementMicroXS) / 1.0e6 << " MB (" << n_slots
+      << " slots of " << simulation::photon_xs_slot_size << " elements)"
+      << std::endl;
+  }
+}
+
+void free_photon_xs_pool()
+{
+  if (!simulation::photon_xs_pool) return;
+  int64_t n = static_cast<int64_t>(simulation::photon_xs_pool_slots) *
+    simulation::photon_xs_slot_size;
+  #pragma omp target exit data map(delete: simulation::photon_xs_pool[:n])
+  delete[] simulation::photon_xs_pool;
+  simulation::photon_xs_pool = nullptr;
+  simulation::photon_xs_pool_slots = 0;
+}
+
+bool tallies_need_nu_bank()
+{
+  for (size_t i = 0; i < model::tallies_size; ++i) {
+    const auto& tally {model::tallies[i]};
+    if (tally.estimator_ != TallyEstimator::ANALOG) continue;
+    for (int score : tally.scores_) {
+      if (score == SCORE_DECAY_RATE) return true;
+      if (tally.energyout_filter_ != C_NONE && (score == SCORE_NU_FISSION ||
+          score == SCORE_PROMPT_NU_FISSION || score == SCORE_DELAYED_NU_FISSION))
+        return true;
+    }
+  }
+  return false;
+}
+
+void reserve_nu_bank_pool(int n_slots)
+{
+  free_nu_bank_pool();
+
+  simulation::nu_bank_slot_size = tallies_need_nu_bank() ?
+    settings::nu_bank_size : 0;
+  #pragma omp target update to(simulation::nu_bank_slot_size)
+  if (simulation::nu_bank_slot_size == 0) return;
+
+  simulation::nu_bank_pool_slots = n_slots;
+  int64_t n = static_cast<int64_t>(n_slots) * simulation::nu_bank_slot_size;
+  simulation::nu_bank_pool = new Particle::NuBank[n];
+  #pragma omp target enter data map(alloc: simulation::nu_bank_pool[:n])
+  int64_t n_bytes = n * sizeof(Particle::NuBank);
+  record_memory("Fission neutron banks", MemorySpace::host, n_bytes);
+  record_memory("Fission neutron banks", MemorySpace::device, n_bytes);
+
+  if (mpi::master) {
+    std::cout << " Allocating fission neutron bank pool of size: "
+      << n_bytes / 1.0e6 << " MB (" << n_slots << " slots of "
+      << simulation::nu_bank_slot_size << " neutrons)" << std::endl;
+  }
+}
+
+void free_nu_bank_pool()
+{
+  if (!simulation::nu_bank_pool) return;
+  int64_t n = static_cast<int64_t>(simulation::nu_bank_pool_slots) *
+    simulation::nu_bank_slot_size;
+  #pragma omp target exit data map(delete: simulation::nu_bank_pool[:n])
+  delete[] simulation::nu_bank_pool;
+  int64_t n_bytes = n * sizeof(Particle::NuBank);
+  record_memory("Fission neutron banks", MemorySpace::host, -n_bytes);
+  record_memory("Fission neutron banks", MemorySpace::device, -n_bytes);
+  simulation::nu_bank_pool = nullptr;
+  simulation::nu_bank_pool_slots = 0;
+}
+
+void reserve_lost_particles()
+{
+  free_lost_particles();
+
+  int n = std::max<int>(settings::max_lost_particles, 1);
+  simulation::lost_particles = new LostParticle[n];
+  simulation::lost_particle_capacity = n;
+  simulation::n_lost_records = 0;
+  #pragma omp target enter data map(alloc: simulation::lost_particles[:n])
+  #pragma omp target update to(simulation::lost_particle_capacity, \
+    simulation::n_lost_records)
+  int64_t n_bytes = n * sizeof(LostParticle);
+  record_memory("Lost particle records", MemorySpace::host, n_bytes);
+  record_memory("Lost particle records", MemorySpace::device, n_bytes);
+}
+
+void free_lost_particles()
+{
+  if (!simulation::lost_particles) return;
+  int n = simulation::lost_particle_capacity;
+  #pragma omp target exit data map(delete: simulation::lost_particles[:n])
+  delete[] simulation::lost_particles;
+  int64_t n_bytes = n * sizeof(LostParticle);
+  record_memory("Lost particle records", MemorySpace::host, -n_bytes);
+  record_memory("Lost particle records", MemorySpace::device, -n_bytes);
+  simulation::lost_particles = nullptr;
+  simulation::lost_particle_capacity = 0;
+  simulation::n_lost_records = 0;
+  #pragma omp target update to(simulation::lost_particle_capacity, \
+    simulation::n_lost_records)
+}
+
+void check_lost_particles(bool on_device)
+{
+  // While no particle is lost, only the count crosses over
+  if (on_device) {
+    #pragma omp target update from(simulation::n_lost_records)
+  }
+  int n_lost = simulation::n_lost_records;
+  if (n_lost == 0) return;
+
+  int n = std::min(n_lost, simulation::lost_particle_capacity);
+  if (on_device) {
+    #pragma omp target update from(simulation::lost_particles[:n])
+  }
+  for (int i = 0; i < n; ++i) {
+    const auto& lost = simulation::lost_particles[i];
+    int i_cell = lost.cell[lost.n_coord - 1];
+    warning(fmt::format("Particle {} was lost at ({}, {}, {}) in cell {}.",
+      lost.id, lost.r.x, lost.r.y, lost.r.z,
+      i_cell == C_NONE ? C_NONE : model::cells[i_cell].id_));
+    write_particle_restart(lost);
+  }
+  if (n_lost > n) {
+    warning(fmt::format("{} more particles were lost without restart files.",
+      n_lost - n));
+  }
+
+  simulation::n_lost_records = 0;
+  if (on_device) {
+    #pragma omp target update to(simulation::n_lost_records)
+  }
+  simulation::n_lost_particles += n_lost;
+
+  // Abort the simulation if the maximum number of lost particles has been
+  // reached
+  auto n_total = simulation::current_batch * settings::gen_per_batch *
+    simulation::work_per_rank;
+  if (simulation::n_lost_particles >= settings::max_lost_particles &&
+      simulation::n_lost_particles >= settings::rel_max_lost_particles*n_total) {
+    fatal_error("Maximum number of lost particles has been reached.");
+  }
+}
+
 } // namespace openmc
@@ -1,5 +1,6 @@
 #include "openmc/particle_restart.h"
 
+#include "openmc/bank.h"
 #include "openmc/constants.h"
 #include "openmc/device_alloc.h"
 #include "openmc/hdf5_interface.h"
@@ -75,6 +76,10 @@ void run_particle_restart()
   // Set verbosity high
   settings::verbosity = 10;
 
+  // A single history needs only a small secondary spill pool
+  init_secondary_pool(settings::secondary_pool_size == -1 ? 10000 :
+    settings::secondary_pool_size);
+
   // Move read on data to device, if running on device
   move_read_only_data_to_device();
 
@@ -110,6 +115,18 @@ void run_particle_restart()
   init_particle_seeds(particle_seed, p.seeds_);
 
   // Force calculation of cross-sections by setting last energy to zero
+  reserve_micro_xs_pool(1);
+  reserve_flux_derivs_pool(1);
+  reserve_nuclide_cdf_pool(1);
+  reserve_depletion_rx_pool(1);
+  reserve_photon_xs_pool(1);
+  reserve_nu_bank_pool(1);
+  p.neutron_xs_.assign(0);
+  p.assign_flux_derivs(0);
+  p.assign_nuclide_cdf(0);
+  p.assign_depletion_rx(0);
+  p.assign_photon_xs(0);
+  p.assign_nu_bank(0);
   p.neutron_xs_.clear();
 
   // Prepare to write out particle track.
@@ -119,8 +136,7 @@ void run_particle_restart()
   if (!model::active_tallies.empty()) {
     //p.flux_derivs_.resize(model::tally_derivs.size(), 0.0);
     //std::fill(p.flux_derivs_.begin(), p.flux_derivs_.end(), 0.0);
-    assert(FLUX_DERIVS_SIZE >= model::tally_derivs.size());
-    std::fill(p.flux_derivs_, p.flux_derivs_ + FLUX_DERIVS_SIZE, 0.0);
+    p.clear_flux_derivs();
   }
 
   // Allocate space for tally filter matches
@@ -134,6 +150,13 @@ void run_particle_restart()
 
   // Write output if particle made it
   print_particle(p);
+
+  free_micro_xs_pool();
+  free_flux_derivs_pool();
+  free_nuclide_cdf_pool();
+  free_depletion_rx_pool();
+  free_photon_xs_pool();
+  free_nu_bank_pool();
 }
 
 } // namespace openmc
@@ -2,6 +2,7 @@
 
 #include "openmc/bremsstrahlung.h"
 #include "openmc/constants.h"
+#include "openmc/error.h"
 #include "openmc/hdf5_interface.h"
 #include "openmc/message_passing.h"
 #include "openmc/nuclide.h"
@@ -37,6 +38,88 @@ size_t elements_capacity;
 
 } // namespace data
 
+//==============================================================================
+// ComptonTable implementation
+//==============================================================================
+
+void ComptonTable::init(double alpha_min, double alpha_max, int n_quantiles,
+  const Tabulated1D* form_factor)
+{
+  double log_min = std::log(alpha_min);
+  double log_max = std::log(alpha_max);
+  n_alpha_ = std::max(2, static_cast<int>(std::ceil((log_max - log_min) /
+    std::log(10.0) * COMPTON_TABLE_POINTS_PER_DECADE)) + 1);
+  n_quantiles_ = n_quantiles;
+  log_alpha_min_ = log_min;
+  inv_du_ = (n_alpha_ - 1) / (log_max - log_min);
+
+  int n_fine = n_quantiles_ * COMPTON_TABLE_FINE_POINTS;
+  std::vector<double> cdf(n_fine + 1);
+  quantiles_.clear();
+  quantiles_.resize(n_alpha_ * (n_quantiles_ + 1));
+  for (int i = 0; i < n_alpha_; ++i) {
+    double alpha = std::exp(log_alpha_min_ + i / inv_du_);
+    double log_beta = std::log1p(2.0*alpha);
+
+    // Density of u up to a constant: the Klein-Nishina cross section in
+    // x = alpha/alpha', times dx/du = x ln(1 + 2 alpha), times S(x)
+    auto pdf = [&](double u) {
+      double x = std::exp(u*log_beta);
+      double mu = 1.0 - (x - 1.0)/alpha;
+      double p = (1.0/x + x - 1.0 + mu*mu) / x;
+      if (form_factor) {
+        p *= (*form_factor)(MASS_ELECTRON_EV/PLANCK_C*alpha*
+          std::sqrt(std::max(0.0, 0.5*(1.0 - mu))));
+      }
+      return p;
+    };
+
+    // Integrate the density with the trapezoidal rule
+    cdf[0] = 0.0;
+    double p_last = pdf(0.0);
+    for (int k = 1; k <= n_fine; ++k) {
+      double p = pdf(static_cast<double>(k) / n_fine);
+      cdf[k] = cdf[k - 1] + 0.5*(p + p_last) / n_fine;
+      p_last = p;
+    }
+
+    // Invert the integral at equiprobable points
+    double* q = &quantiles_[i * (n_quantiles_ + 1)];
+    q[0] = 0.0;
+    q[n_quantiles_] = 1.0;
+    int k = 0;
+    for (int j = 1; j < n_quantiles_; ++j) {
+      double c = cdf[n_fine] * j / n_quantiles_;
+      while (k < n_fine - 1 && cdf[k + 1] < c) ++k;
+      double dc = cdf[k + 1] - cdf[k];
+      q[j] = (k + (dc > 0.0 ? (c - cdf[k]) / dc : 0.0)) / n_fine;
+    }
+  }
+}
+
+void ComptonTable::sample(double alpha, double* alpha_out, double* mu,
+  uint64_t* seed) const
+{
+  // Alpha point below alpha, clamped to the table
+  double v = (std::log(alpha) - log_alpha_min_) * inv_du_;
+  int i = std::max(0, std::min(static_cast<int>(v), n_alpha_ - 2));
+  double f = std::max(0.0, std::min(v - i, 1.0));
+
+  // Interpolate the same quantile at both alpha points
+  double xi = prn(seed) * n_quantiles_;
+  int j = std::min(static_cast<int>(xi), n_quantiles_ - 1);
+  double g = xi - j;
+  const double* q0 = quantiles_.data() + i * (n_quantiles_ + 1);
+  const double* q1 = q0 + n_quantiles_ + 1;
+  double u0 = q0[j] + g*(q0[j + 1] - q0[j]);
+  double u1 = q1[j] + g*(q1[j + 1] - q1[j]);
+  double u = u0 + f*(u1 - u0);
+
+  double x = std::exp(u*std::log1p(2.0*alpha));
+  *alpha_out = alpha / x;
+  *mu = 1.0 - (x - 1.0)/alpha;
+}
+
 //==============================================================================
 // PhotonInteraction implementation
 //==============================================================================
@@ -216,12 +299,13 @@ PhotonInteraction::PhotonInteraction(hid_t group)
   }
   close_group(rgroup);
 
-  // Check the maximum size of the atomic relaxation stack
+  // The relaxation stack is a fixed size array so that atomic_relaxation()
+  // can run on device, and a cascade deeper than it would write past its end
   auto max_size = this->calc_max_stack_size();
-  if (max_size > MAX_STACK_SIZE && mpi::master) {
-    warning("The subshell vacancy stack in atomic relaxation can grow up to " +
-            std::to_string(max_size) + ", but the stack size limit is set to " +
-            std::to_string(MAX_STACK_SIZE) + ".");
+  if (max_size > MAX_STACK_SIZE) {
+    fatal_error("The subshell vacancy stack in atomic relaxation for " + name_ +
+      " can grow up to " + std::to_string(max_size) + ", but the stack size "
+      "limit is set to " + std::to_string(MAX_STACK_SIZE) + ".");
   }
 
   // Determine number of electron shells
@@ -347,6 +431,13 @@ PhotonInteraction::PhotonInteraction(hid_t group)
   pair_production_total_ = xt::where(pair_production_total_ > 0.0,
     xt::log(pair_production_total_), -500.0);
   heating_ = xt::where(heating_ > 0.0, xt::log(heating_), -500.0);
+
+  // Tabulate incoherent scattering over the energy grid of the element
+  if (settings::compton_table_quantiles > 0) {
+    compton_table_.init(std::exp(energy_(0)) / MASS_ELECTRON_EV,
+      std::exp(energy_(energy_.size() - 1)) / MASS_ELECTRON_EV,
+      settings::compton_table_quantiles, &incoherent_form_factor_);
+  }
 }
 
 PhotonInteraction::~PhotonInteraction()
@@ -405,40 +496,43 @@ int PhotonInteraction::calc_helper(
 void PhotonInteraction::compton_scatter(double alpha, bool doppler,
   double* alpha_out, double* mu, int* i_shell, uint64_t* seed) const
 {
-  double form_factor_xmax = 0.0;
-  while (true) {
-    // Sample Klein-Nishina distribution for trial energy and angle
-    std::tie(*alpha_out, *mu) = klein_nishina(alpha, seed);
-
-    // Note that the parameter used here does not correspond exactly to the
-    // momentum transfer q in ENDF-102 Eq. (27.2). Rather, this is the
-    // parameter as defined by Hubbell, where the actual data comes from
-    double x = MASS_ELECTRON_EV/PLANCK_C*alpha*std::sqrt(0.5*(1.0 - *mu));
-
-    // Calculate S(x, Z) and S(x_max, Z)
-    double form_factor_x = this->incoherent_form_factor()(x);
-    if (form_factor_xmax == 0.0) {
-      form_factor_xmax = this->incoherent_form_factor()(MASS_ELECTRON_EV/PLANCK_C*alpha);
+  if (!compton_table_.empty()) {
+    compton_table_.sample(alpha, alpha_out, mu, seed);
+  } else {
+    double form_factor_xmax = 0.0;
+    while (true) {
+      // Sample Klein-Nishina distribution for trial energy and angle
+      std::tie(*alpha_out, *mu) = klein_nishina(alpha, seed);
+
+      // Note that the parameter used here does not correspond exactly to the
+      // momentum transfer q in ENDF-102 Eq. (27.2). Rather, this is the
+      // parameter as defined by Hubbell, where the actual data comes from
+      double x = MASS_ELECTRON_EV/PLANCK_C*alpha*std::sqrt(0.5*(1.0 - *mu));
+
+      // Calculate S(x, Z) and S(x_max, Z)
+      double form_factor_x = this->incoherent_form_factor()(x);
+      if (form_factor_xmax == 0.0) {
+        form_factor_xmax = this->incoherent_form_factor()(MASS_ELECTRON_EV/PLANCK_C*alpha);
+      }
+
+      // Perform rejection on form factor
+      if (prn(seed) < form_factor_x / form_factor_xmax) break;
     }
+  }
 
-    // Perform rejection on form factor
-    if (prn(seed) < form_factor_x / form_factor_xmax) {
-      if (doppler) {
-        double E_out;
-        this->compton_doppler(alpha, *mu, &E_out, i_shell, seed);
-        *alpha_out = E_out/MASS_ELECTRON_EV;
-
-         // It's possible for the Compton profile data to have more shells than
-         // there are in the ENDF data. Make sure the shell index doesn't end up
-         // out of bounds.
-         if (*i_shell >= shells_.size()) {
-           *i_shell = -1;
-         }
-      } else {
-        *i_shell = -1;
-      }
-      break;
+  if (doppler) {
+    double E_out;
+    this->compton_doppler(alpha, *mu, &E_out, i_shell, seed);
+    *alpha_out = E_out/MASS_ELECTRON_EV;
+
+    // It's possible for the Compton profile data to have more shells than
+    // there are in the ENDF data. Make sure the shell index doesn't end up
+    // out of bounds.
+    if (*i_shell >= shells_.size()) {
+      *i_shell = -1;
     }
+  } else {
+    *i_shell = -1;
   }
 }
 
@@ -848,7 +942,8 @@ void PhotonInteraction::copy_to_device()
 
   // Form factors
   size_t offset = 8 + buffer_nbytes(incoherent_form_factor_);
-  buffer_.reserve(offset + buffer_nbytes(coherent_int_form_factor_));
+  buffer_.reserve(offset + buffer_nbytes(coherent_int_form_factor_),
+    "Photon elements");
   buffer_.add(offset); // offset for coherent
   incoherent_form_factor_.serialize(buffer_);
   coherent_int_form_factor_.serialize(buffer_);
@@ -888,6 +983,8 @@ void PhotonInteraction::copy_to_device()
   #pragma omp target enter data map(to: device_profile_cdf_[:profile_cdf_.size()])
   #pragma omp target enter data map(to: device_binding_energy_[:binding_energy_.size()])
   #pragma omp target enter data map(to: device_electron_pdf_[:electron_pdf_.size()])
+
+  compton_table_.copy_to_device();
 }
 
 void PhotonInteraction::release_from_device()
@@ -911,6 +1008,8 @@ void PhotonInteraction::release_from_device()
   #pragma omp target exit data map(release: device_profile_cdf_[:profile_cdf_.size()])
   #pragma omp target exit data map(release: device_binding_energy_[:binding_energy_.size()])
   #pragma omp target exit data map(release: device_electron_pdf_[:electron_pdf_.size()])
+
+  compton_table_.release_device();
 }
 
 Tabulated1DFlat PhotonInteraction::incoherent_form_factor() const
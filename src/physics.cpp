@@ -37,10 +37,19 @@ namespace openmc {
 //==============================================================================
 
 void collision(Particle& p)
+{
+  sample_collision(p);
+  finish_collision(p);
+}
+
+void sample_collision(Particle& p)
 {
   // Add to collision counter for particle
   ++(p.n_collision_);
 
+  // Only neutron scattering is left to finish_collision()
+  p.collision_class_ = Particle::CollisionClass::complete;
+
   // Sample reaction for the material the particle is in
   switch (p.type_) {
   case Particle::Type::neutron:
@@ -56,6 +65,11 @@ void collision(Particle& p)
     sample_positron_reaction(p);
     break;
   }
+}
+
+void finish_collision(Particle& p)
+{
+  if (p.type_ == Particle::Type::neutron) finish_neutron_reaction(p);
 
   // Kill particle if energy falls below cutoff
   int type = static_cast<int>(p.type_);
@@ -87,8 +101,10 @@ void collision(Particle& p)
 
 void sample_neutron_reaction(Particle& p)
 {
-  // Sample a nuclide within the material
-  int i_nuclide = sample_nuclide(p);
+  // Sample a nuclide within the material, unless target motion sampling
+  // already selected it
+  int i_nuclide = p.tms_nuclide_;
+  if (i_nuclide == C_NONE) i_nuclide = sample_nuclide(p);
 
   // Save which nuclide particle had collision with
   p.event_nuclide_ = i_nuclide;
@@ -125,14 +141,12 @@ void sample_neutron_reaction(Particle& p)
     }
   }
 
-  /*
   // Create secondary photons
   if (settings::photon_transport) {
     p.stream_ = STREAM_PHOTON;
     sample_secondary_photons(p, i_nuclide);
     p.stream_ = STREAM_TRACKING;
   }
-  */
 
   // If survival biasing is being used, the following subroutine adjusts the
   // weight of the particle. Otherwise, it checks to see if absorption occurs
@@ -142,9 +156,20 @@ void sample_neutron_reaction(Particle& p)
   }
   if (!p.alive()) return;
 
-  // Sample a scattering reaction and determine the secondary energy of the
-  // exiting neutron
-  scatter(p, i_nuclide);
+  // Sample a scattering reaction
+  sample_scatter(p, i_nuclide);
+}
+
+void finish_neutron_reaction(Particle& p)
+{
+  if (p.collision_class_ == Particle::CollisionClass::complete) {
+    p.tms_nuclide_ = C_NONE;
+    return;
+  }
+
+  // Determine the secondary energy and direction of the exiting neutron
+  scatter(p, p.event_nuclide_);
+  p.tms_nuclide_ = C_NONE;
 
   // Advance URR seed stream 'N' times after energy changes
   if (p.E_ != p.E_last_) {
@@ -185,7 +210,6 @@ create_fission_sites(Particle& p, int i_nuclide, const ReactionFlat& rx)
   double nu_d[MAX_DELAYED_GROUPS] = {0.};
 
   // Clear out particle's nu fission bank
-  //p->nu_bank_.clear();
 
   p.fission_ = true;
   int skipped = 0;
@@ -207,23 +231,32 @@ create_fission_sites(Particle& p, int i_nuclide, const ReactionFlat& rx)
     // Sample delayed group and angle/energy for fission reaction
     sample_fission_neutron(i_nuclide, rx, p.E_, &site, p.current_seed());
 
+    // Sites of the next generation start their clocks anew, while in fixed
+    // source mode fission neutrons carry on the time of the fission, and
+    // delayed ones are only emitted once their precursor decays
+    site.time = use_fission_bank ? 0.0 : p.time_;
+    if (!use_fission_bank && site.delayed_group > 0) {
+      double decay_rate = rx.products(site.delayed_group).decay_rate();
+      site.time -= std::log(prn(p.current_seed())) / decay_rate;
+    }
+
     // Store fission site in bank
     if (use_fission_bank) {
-      int64_t idx = simulation::fission_bank.thread_safe_append(site);
-      if (idx == -1) {
-        /*
-        warning("The shared fission bank is full. Additional fission sites created "
-            "in this generation will not be banked.");
-        */
-        printf("The shared fission bank is full. Additional fission sites created "
-          "in this generation will not be banked.\n");
+      // Once a site is dropped no more fit this generation, so the progeny of
+      // the particle stay numbered contiguously for sorting the fission bank
+      if (!bank_fission_site(site)) {
+        --p.n_progeny_;
         skipped++;
         break;
       }
-    } else {
+    } else if (site.time <= settings::time_cutoff[
+        static_cast<int>(Particle::Type::neutron)]) {
+      // Neutrons emitted after the time cutoff are not transported
       //p->secondary_bank_.push_back(site);
-      //assert(p.secondary_bank_length_ < SECONDARY_BANK_SIZE);
-      p.secondary_bank_[p.secondary_bank_length_++] = site;
+      if (!p.push_secondary(site)) {
+        skipped++;
+        break;
+      }
     }
 
     // Set the delayed group on the particle as well
@@ -234,11 +267,9 @@ create_fission_sites(Particle& p, int i_nuclide, const ReactionFlat& rx)
       nu_d[p.delayed_group_-1]++;
     }
 
-    // Write fission particles to nuBank
-    if (use_fission_bank) {
-      //p->nu_bank_.emplace_back();
-      //Particle::NuBank* nu_bank_entry = &p->nu_bank_.back();
-      //assert(i < NU_BANK_SIZE);
+    // Write fission particles to nuBank. Neutrons beyond the capacity of the
+    // bank (settings::nu_bank_size) are banked but not tallied individually.
+    if (use_fission_bank && i < simulation::nu_bank_slot_size) {
       Particle::NuBank* nu_bank_entry = &p.nu_bank_[i];
       nu_bank_entry->wgt              = site.wgt;
       nu_bank_entry->E                = site.E;
@@ -464,6 +495,39 @@ void sample_positron_reaction(Particle& p)
   p.event_ = TallyEvent::ABSORB;
 }
 
+namespace {
+
+//! Position of the sampled nuclide in the running sum of nuclide XS left by
+//! Material::calculate_neutron_xs(), found by bisection
+//
+//! \return Index of the nuclide in the material, or -1 if the particle has no
+//!   running sum for its current material, energy and temperature
+int search_nuclide_cdf(const Particle& p, int n, double cutoff)
+{
+  if (!p.nuclide_cdf_ || p.nuclide_cdf_material_ != p.material_ ||
+      p.nuclide_cdf_E_ != p.E_ || p.nuclide_cdf_sqrtkT_ != p.sqrtkT_) {
+    return -1;
+  }
+
+  // Find the first nuclide whose running sum reaches the cutoff, as the
+  // linear walk does. The macroscopic total may differ from the last sum by
+  // rounding when it was reduced across SIMD lanes.
+  const double* cdf = p.nuclide_cdf_;
+  int low = 0;
+  int high = n - 1;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (cdf[mid] >= cutoff) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return low;
+}
+
+} // namespace
+
 // If no micro XS cache is being used then we must perform all microscopic cross
 // section lookups until nuclide is sapled. This involves extra logic to track
 // the presence of S(A,B) tables, so separate implementations (with and without the
@@ -482,15 +546,23 @@ int sample_nuclide(Particle& p)
   double sqrtkT = p.sqrtkT_;
 
   // Find energy index on energy grid
-  int neutron = static_cast<int>(Particle::Type::neutron);
-  int i_grid = std::log(E/data::energy_min[neutron])/simulation::log_spacing;
+  int i_grid = energy_grid_search_index(E);
+
+  // With a running sum of the nuclide XS, only the sampled nuclide's micro XS
+  // are looked up again
+  int i_cdf = search_nuclide_cdf(p, n, cutoff);
+  if (i_cdf >= 0) {
+    int i_nuclide = mat.nuclide(i_cdf);
+    p.neutron_xs_[0] = data::nuclides[i_nuclide].calculate_xs<NuclideMicroXS>(i_grid, p, nullptr, E, sqrtkT);
+    return i_nuclide;
+  }
 
   double prob = 0.0;
   for (int i = 0; i < n; ++i) {
     int i_nuclide = mat.nuclide(i);
 
     // Lookup micro XS (no depletion XS data is needed for collisions)
-    NuclideMicroXS xs = data::nuclides[i_nuclide].calculate_xs<NuclideMicroXS>(i_grid, p, false, E, sqrtkT);
+    NuclideMicroXS xs = data::nuclides[i_nuclide].calculate_xs<NuclideMicroXS>(i_grid, p, nullptr, E, sqrtkT);
     
     // Get atom density
     double atom_density = mat.atom_density(i);
@@ -522,6 +594,9 @@ int sample_nuclide(Particle& p)
   const auto& mat = model::materials[p.material_];
   int n = mat.nuclide_.size();
 
+  int i_cdf = search_nuclide_cdf(p, n, cutoff);
+  if (i_cdf >= 0) return mat.nuclide(i_cdf);
+
   double prob = 0.0;
   for (int i = 0; i < n; ++i) {
     // Get atom density
@@ -641,9 +716,9 @@ void sample_photon_product(int i_nuclide, Particle& p, int* i_rx, int* i_product
         double f = 1.0;
         if (settings::delayed_photon_scaling) {
           if (is_fission(rx.mt())) {
-            if (nuc.prompt_photons_ && nuc.delayed_photons_) {
-              double energy_prompt = (*nuc.prompt_photons_)(p.E_);
-              double energy_delayed = (*nuc.delayed_photons_)(p.E_);
+            if (nuc.device_prompt_photons_ && nuc.device_delayed_photons_) {
+              double energy_prompt = (*nuc.device_prompt_photons_)(p.E_);
+              double energy_delayed = (*nuc.device_delayed_photons_)(p.E_);
               f = (energy_prompt + energy_delayed)/(energy_prompt);
             }
           }
@@ -692,20 +767,15 @@ void absorption(Particle& p, int i_nuclide)
   }
 }
 
-void scatter(Particle& p, int i_nuclide)
+void sample_scatter(Particle& p, int i_nuclide)
 {
-  // copy incoming direction
-  Direction u_old {p.u()};
-
   // Get pointer to nuclide and grid index/interpolation factor
   const auto& nuc {data::nuclides[i_nuclide]};
   auto& micro {p.neutron_xs_[i_nuclide]};
-  int i_temp =  micro.index_temp;
 
   // For tallying purposes, this routine might be called directly. In that
   // case, we need to sample a reaction via the cutoff variable
   double cutoff = prn(p.current_seed()) * (micro.total - micro.absorption);
-  bool sampled = false;
 
   // Calculate elastic cross section if it wasn't precalculated
   if (micro.elastic == CACHE_INVALID) {
@@ -714,37 +784,28 @@ void scatter(Particle& p, int i_nuclide)
 
   double prob = micro.elastic - micro.thermal;
   if (prob > cutoff) {
-    // =======================================================================
     // NON-S(A,B) ELASTIC SCATTERING
-
-    // Determine temperature
-    double kT = nuc.multipole() ? p.sqrtkT_*p.sqrtkT_ : nuc.kTs_[i_temp];
-
-    // Perform collision physics for elastic scattering
-    elastic_scatter(i_nuclide, nuc.reactions_[0].obj(), kT, p);
-
-    p.event_mt_ = ELASTIC;
-    sampled = true;
+    p.collision_class_ = Particle::CollisionClass::elastic;
+    p.collision_rx_ = 0;
+    return;
   }
 
   prob = micro.elastic;
-  if (prob > cutoff && !sampled) {
-    // =======================================================================
+  if (prob > cutoff) {
     // S(A,B) SCATTERING
-
-    sab_scatter(i_nuclide, micro.index_sab, p);
-
-    p.event_mt_ = ELASTIC;
-    sampled = true;
+    p.collision_class_ = Particle::CollisionClass::sab;
+    p.collision_rx_ = C_NONE;
+    return;
   }
 
-  if (!sampled) {
-    // =======================================================================
-    // INELASTIC SCATTERING
+  // INELASTIC SCATTERING
 
+  // Nuclides with many channels search running sums of their XS, where
+  // they have them. Otherwise the channels are walked.
+  int i = nuc.sample_inelastic_channel(micro, cutoff - prob);
+  if (i == C_NONE) {
     int j = 0;
-    int i = 0;
-
+    i = 0;
     while (prob < cutoff) {
       i = nuc.index_inelastic_scatter_[j];
       ++j;
@@ -761,12 +822,40 @@ void scatter(Particle& p, int i_nuclide)
       auto rx = nuc.reactions_[i].obj();
       prob += rx.xs(micro);
     }
+  }
+  p.collision_class_ = Particle::CollisionClass::inelastic;
+  p.collision_rx_ = i;
+}
+
+void scatter(Particle& p, int i_nuclide)
+{
+  // copy incoming direction
+  Direction u_old {p.u()};
+
+  const auto& nuc {data::nuclides[i_nuclide]};
 
+  switch (p.collision_class_) {
+  case Particle::CollisionClass::elastic: {
+    // Determine temperature
+    int i_temp = p.neutron_xs_[i_nuclide].index_temp;
+    double kT = nuc.multipole() ? p.sqrtkT_*p.sqrtkT_ : nuc.kTs_[i_temp];
+
+    // Perform collision physics for elastic scattering
+    elastic_scatter(i_nuclide, nuc.reactions_[0].obj(), kT, p);
+    p.event_mt_ = ELASTIC;
+    break;
+  }
+  case Particle::CollisionClass::sab:
+    sab_scatter(i_nuclide, p.neutron_xs_[i_nuclide].index_sab, p);
+    p.event_mt_ = ELASTIC;
+    break;
+  default: {
     // Perform collision physics for inelastic scattering
-    auto rx = nuc.reactions_[i].obj();
+    auto rx = nuc.reactions_[p.collision_rx_].obj();
     inelastic_scatter(nuc, rx, p);
     p.event_mt_ = rx.mt();
   }
+  }
 
   // Set event component
   p.event_ = TallyEvent::SCATTER;
@@ -801,9 +890,12 @@ void elastic_scatter(int i_nuclide, const ReactionFlat& rx, double kT,
   // Neutron velocity in LAB
   Direction v_n = vel*p.u();
 
-  // Sample velocity of target nucleus
+  // Sample velocity of target nucleus. Target motion sampling has already
+  // sampled the one the neutron collided with.
   Direction v_t {};
-  if (!p.neutron_xs_[i_nuclide].use_ptable) {
+  if (p.tms_nuclide_ == i_nuclide) {
+    v_t = p.tms_v_t_;
+  } else if (!p.neutron_xs_[i_nuclide].use_ptable) {
     v_t = sample_target_velocity(nuc, p.E_, p.u(), v_n,
       p.neutron_xs_[i_nuclide].elastic, kT, p.current_seed());
   }
@@ -954,8 +1046,7 @@ Direction sample_target_velocity(const Nuclide& nuc, double E, Direction u,
       xs_up += m * (E_up - nuc.energy_0K_[i_E_up]);
 
       // get max 0K xs value over range of practical relative energies
-      double xs_max = *std::max_element(&nuc.elastic_0K_[i_E_low + 1],
-        &nuc.elastic_0K_[i_E_up + 1]);
+      double xs_max = nuc.elastic_0K_max(i_E_low + 1, i_E_up + 1);
       xs_max = std::max({xs_low, xs_max, xs_up});
 
       while (true) {
@@ -969,8 +1060,9 @@ Direction sample_target_velocity(const Nuclide& nuc, double E, Direction u,
           if (E_rel < E_up) break;
         }
 
-        // perform Doppler broadening rejection correction (dbrc)
-        double xs_0K = nuc.elastic_xs_0K(E_rel);
+        // perform Doppler broadening rejection correction (dbrc). Relative
+        // energies are below E_up, so only the grid up to it is searched.
+        double xs_0K = nuc.elastic_xs_0K(E_rel, i_E_up + 2);
         double R = xs_0K / xs_max;
         if (prn(seed) < R) return v_target;
       }
@@ -1076,6 +1168,83 @@ sample_cxs_target_velocity(double awr, double E, Direction u, double kT, uint64_
   return vt * rotate_angle(u, mu, nullptr, seed);
 }
 
+Direction
+sample_maxwellian_target_velocity(double awr, Direction u, double kT,
+  uint64_t* seed)
+{
+  // The reduced speed has the density y^2 * e^(-y^2), sampled with scheme C61
+  // from the Monte Carlo sampler. Speeds beyond the cutoff are sampled again.
+  double beta_vt_sq;
+  do {
+    double r1 = prn(seed);
+    double r2 = prn(seed);
+    double c = std::cos(PI/2.0 * prn(seed));
+    beta_vt_sq = -std::log(r1) - std::log(r2)*c*c;
+  } while (beta_vt_sq > TMS_SPEED_CUTOFF*TMS_SPEED_CUTOFF);
+
+  // The direction of the target is isotropic
+  double vt = std::sqrt(beta_vt_sq*kT/awr);
+  double mu = 2.0*prn(seed) - 1.0;
+  return vt * rotate_angle(u, mu, nullptr, seed);
+}
+
+bool sample_tms_collision(Particle& p, double cutoff)
+{
+  const auto& mat = model::materials[p.material_];
+  int bin = majorant_bin(p.E_, model::tms_majorant_bins);
+
+  // Select the nuclide of the tentative collision by its share of the majorant
+  int n = mat.nuclide_.size();
+  int i_nuclide = C_NONE;
+  double majorant = 0.0;
+  double prob = 0.0;
+  for (int i = 0; i < n; ++i) {
+    i_nuclide = mat.nuclide(i);
+    majorant = model::device_tms_majorant[i_nuclide *
+      model::tms_majorant_bins + bin];
+    prob += mat.atom_density(i) * majorant;
+    if (cutoff < prob) break;
+  }
+  auto& nuc {data::nuclides[i_nuclide]};
+
+  // Sample a target moving at the temperature difference the nuclide's XS
+  // are broadened by
+  double E_rel = p.E_;
+  double kT = p.sqrtkT_*p.sqrtkT_ - nuc.kTs_[0];
+  Direction v_t {};
+  if (kT > 0.0) {
+    v_t = sample_maxwellian_target_velocity(nuc.awr_, p.u(), kT,
+      p.current_seed());
+    Direction v_rel = std::sqrt(p.E_)*p.u() - v_t;
+    int neutron = static_cast<int>(Particle::Type::neutron);
+    E_rel = std::min(std::max(v_rel.dot(v_rel), data::energy_min[neutron]),
+      data::energy_max[neutron]);
+  }
+
+  // The collision happens at the rate of the XS of the relative energy times
+  // the relative speed
+  auto xs = nuc.calculate_xs<NuclideMicroXS, 0>(energy_grid_search_index(E_rel),
+    p, nullptr, E_rel, 0.0);
+  double speed_ratio = std::sqrt(E_rel / p.E_);
+
+  // Nuclides are selected at the rate of their share of the majorant, so each
+  // tentative collision scores the broadened nu-fission XS over it to the
+  // track-length estimate of k-eff
+  if (settings::run_mode == RunMode::EIGENVALUE) {
+    p.keff_tally_tracklength_ += p.wgt_ * xs.nu_fission * speed_ratio /
+      majorant;
+  }
+
+  if (prn(p.current_seed()) * majorant >= xs.total * speed_ratio) return false;
+
+  // The reaction of a real collision is sampled from the XS at the relative
+  // energy, and an elastic scatter is off the target sampled here
+  p.neutron_xs_[i_nuclide] = xs;
+  p.tms_nuclide_ = i_nuclide;
+  p.tms_v_t_ = v_t;
+  return true;
+}
+
 void sample_fission_neutron(int i_nuclide, const ReactionFlat& rx, double E_in, Particle::Bank* site, uint64_t* seed)
 {
   // Sample cosine of angle -- fission neutrons are always emitted
@@ -1149,10 +1318,17 @@ void sample_fission_neutron(int i_nuclide, const ReactionFlat& rx, double E_in,
     // set the delayed group for the particle born from fission to 0
     site->delayed_group = 0;
 
-    // sample from prompt neutron energy distribution
+    // sample from prompt neutron energy distribution, or from its tabulated
+    // quantiles if it has them
+    bool tabulated = !nuc.fission_spectrum_.empty() &&
+      rx.mt() == nuc.fission_spectrum_mt_;
     int n_sample = 0;
     while (true) {
-      rx.products(0).sample(E_in, site->E, mu, seed);
+      if (tabulated) {
+        site->E = nuc.sample_fission_spectrum(E_in, seed);
+      } else {
+        rx.products(0).sample(E_in, site->E, mu, seed);
+      }
 
       // resample if energy is greater than maximum neutron energy
       constexpr int neutron = static_cast<int>(Particle::Type::neutron);
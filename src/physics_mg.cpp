@@ -1,5 +1,6 @@
 #include "openmc/physics_mg.h"
 
+#include <cmath> // for log
 #include <stdexcept>
 
 #include <fmt/core.h>
@@ -19,6 +20,10 @@
 #include "openmc/simulation.h"
 #include "openmc/tallies/tally.h"
 
+#ifndef DEVICE_PRINTF
+#define printf(fmt, ...) (0)
+#endif
+
 namespace openmc {
 
 void
@@ -32,7 +37,7 @@ collision_mg(Particle& p)
 
   // Display information about collision
   if ((settings::verbosity >= 10) || p.trace_) {
-    write_message(fmt::format("    Energy Group = {}", p.g_), 1);
+    printf("    Energy Group = %d\n", p.g_);
   }
 }
 
@@ -74,14 +79,16 @@ sample_reaction(Particle& p)
 void
 scatter(Particle& p)
 {
-  data::mg.macro_xs_[p.material_].sample_scatter(p.g_last_, p.g_, p.mu_,
-                                                  p.wgt_, p.current_seed());
+  // The set is that of the incoming direction, which calculate_xs() used
+  const auto& tables {data::mg_tables};
+  int set = tables.set_index(p.material_, p.sqrtkT_, p.u_local());
+  tables.sample_scatter(set, p.g_last_, p.g_, p.mu_, p.wgt_, p.current_seed());
 
   // Rotate the angle
   p.u() = rotate_angle(p.u(), p.mu_, nullptr, p.current_seed());
 
   // Update energy value for downstream compatability (in tallying)
-  p.E_ = data::mg.energy_bin_avg_[p.g_];
+  p.E_ = tables.energy_bin_avg(p.g_);
 
   // Set event component
   p.event_ = TallyEvent::SCATTER;
@@ -92,7 +99,7 @@ create_fission_sites(Particle& p)
 {
   // If uniform fission source weighting is turned on, we increase or decrease
   // the expected number of fission sites produced
-  double weight = settings::ufs_on ? ufs_get_weight(p) : 1.0;
+  double weight = 1.0; //settings::ufs_on ? ufs_get_weight(p) : 1.0;
 
   // Determine the expected number of neutrons produced
   double nu_t = p.wgt_ / simulation::keff * weight *
@@ -113,7 +120,6 @@ create_fission_sites(Particle& p)
   double nu_d[MAX_DELAYED_GROUPS] = {0.};
 
   // Clear out particle's nu fission bank
-  //p->nu_bank_.clear();
 
   p.fission_ = true;
   int skipped = 0;
@@ -122,6 +128,9 @@ create_fission_sites(Particle& p)
   // or the secondary particle bank.
   bool use_fission_bank = (settings::run_mode == RunMode::EIGENVALUE);
 
+  // The set is that of the incoming direction, which calculate_xs() used
+  int set = data::mg_tables.set_index(p.material_, p.sqrtkT_, p.u_local());
+
   for (int i = 0; i < nu; ++i) {
     // Initialize fission site object with particle data
     Particle::Bank site;
@@ -130,6 +139,7 @@ create_fission_sites(Particle& p)
     site.wgt = 1. / weight;
     site.parent_id = p.id_;
     site.progeny_id = p.n_progeny_++;
+    site.surf_id = 0;
 
     // Sample the cosine of the angle, assuming fission neutrons are emitted
     // isotropically
@@ -144,7 +154,7 @@ create_fission_sites(Particle& p)
     // Sample secondary energy distribution for the fission reaction
     int dg;
     int gout;
-    data::mg.macro_xs_[p.material_].sample_fission_energy(p.g_, dg, gout,
+    data::mg_tables.sample_fission_energy(set, p.g_, dg, gout,
       p.current_seed());
 
     // Store the energy and delayed groups on the fission bank
@@ -154,19 +164,33 @@ create_fission_sites(Particle& p)
     // of the code, 0 is prompt.
     site.delayed_group = dg + 1;
 
+    // Sites of the next generation start their clocks anew, while in fixed
+    // source mode fission neutrons carry on the time of the fission, and
+    // delayed ones are only emitted once their precursor decays
+    site.time = use_fission_bank ? 0.0 : p.time_;
+    if (!use_fission_bank && dg >= 0) {
+      double decay_rate = data::mg_tables.get_xs(set, MgxsType::DECAY_RATE,
+        p.g_, nullptr, nullptr, &dg);
+      site.time -= std::log(prn(p.current_seed())) / decay_rate;
+    }
+
     // Store fission site in bank
     if (use_fission_bank) {
-      int64_t idx = simulation::fission_bank.thread_safe_append(site);
-      if (idx == -1) {
-        warning("The shared fission bank is full. Additional fission sites created "
-            "in this generation will not be banked.");
+      // Once a site is dropped no more fit this generation, so the progeny of
+      // the particle stay numbered contiguously for sorting the fission bank
+      if (!bank_fission_site(site)) {
+        --p.n_progeny_;
         skipped++;
         break;
       }
-    } else {
+    } else if (site.time <= settings::time_cutoff[
+        static_cast<int>(Particle::Type::neutron)]) {
+      // Neutrons emitted after the time cutoff are not transported
       //p->secondary_bank_.push_back(site);
-      assert(p.secondary_bank_length_ < SECONDARY_BANK_SIZE);
-      p.secondary_bank_[p.secondary_bank_length_++] = site;
+      if (!p.push_secondary(site)) {
+        skipped++;
+        break;
+      }
     }
 
     // Set the delayed group on the particle as well
@@ -177,11 +201,9 @@ create_fission_sites(Particle& p)
       nu_d[dg]++;
     }
 
-    // Write fission particles to nuBank
-    if (use_fission_bank) {
-      //p->nu_bank_.emplace_back();
-      //Particle::NuBank* nu_bank_entry = &p->nu_bank_.back();
-      assert(i < NU_BANK_SIZE);
+    // Write fission particles to nuBank. Neutrons beyond the capacity of the
+    // bank (settings::nu_bank_size) are banked but not tallied individually.
+    if (use_fission_bank && i < simulation::nu_bank_slot_size) {
       Particle::NuBank* nu_bank_entry = &p.nu_bank_[i];
       nu_bank_entry->wgt              = site.wgt;
       nu_bank_entry->E                = site.E;
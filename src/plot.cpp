@@ -9,6 +9,7 @@
 #include "xtensor/xview.hpp"
 
 #include "openmc/constants.h"
+#include "openmc/device_alloc.h"
 #include "openmc/file_utils.h"
 #include "openmc/geometry.h"
 #include "openmc/error.h"
@@ -102,6 +103,13 @@ uint64_t plotter_seed = 1;
 extern "C"
 int openmc_plot_geometry()
 {
+  // The geometry searches and distances used to build the plots go through
+  // the device geometry pointers, which are only set once it has been moved
+  if (!model::device_cells) {
+    move_settings_to_device();
+    move_geometry_to_device();
+  }
+
   for (auto& pl : model::plots) {
     write_message(5, "Processing plot {}: {}...", pl.id_, pl.path_plot_);
 
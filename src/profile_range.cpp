@@ -0,0 +1,75 @@
+#include "openmc/profile_range.h"
+
+#ifdef PROFILE_RANGES
+
+#if defined(PROFILE_RANGES_NVTX)
+#include <nvToolsExt.h>
+#elif defined(PROFILE_RANGES_ROCTX)
+#include <roctracer/roctx.h>
+#elif defined(PROFILE_RANGES_LIKWID)
+#include <likwid-marker.h>
+#elif defined(PROFILE_RANGES_PAPI)
+#include <papi.h>
+#endif
+
+#include "openmc/kernel_profile.h"
+
+namespace openmc {
+
+//==============================================================================
+// ProfileRange implementation
+//==============================================================================
+
+ProfileRange::ProfileRange(const char* name) : name_ {name}
+{
+#if defined(PROFILE_RANGES_NVTX)
+  nvtxRangePushA(name_);
+#elif defined(PROFILE_RANGES_ROCTX)
+  roctxRangePushA(name_);
+#elif defined(PROFILE_RANGES_LIKWID)
+  LIKWID_MARKER_START(name_);
+#elif defined(PROFILE_RANGES_PAPI)
+  PAPI_hl_region_begin(name_);
+#endif
+}
+
+ProfileRange::ProfileRange(int region)
+  : ProfileRange {profile_region_name(region)}
+{}
+
+ProfileRange::~ProfileRange()
+{
+#if defined(PROFILE_RANGES_NVTX)
+  nvtxRangePop();
+#elif defined(PROFILE_RANGES_ROCTX)
+  roctxRangePop();
+#elif defined(PROFILE_RANGES_LIKWID)
+  LIKWID_MARKER_STOP(name_);
+#elif defined(PROFILE_RANGES_PAPI)
+  PAPI_hl_region_end(name_);
+#endif
+}
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+void init_profile_ranges()
+{
+#if defined(PROFILE_RANGES_LIKWID)
+  LIKWID_MARKER_INIT;
+#endif
+}
+
+void finalize_profile_ranges()
+{
+#if defined(PROFILE_RANGES_LIKWID)
+  LIKWID_MARKER_CLOSE;
+#elif defined(PROFILE_RANGES_PAPI)
+  PAPI_hl_stop();
+#endif
+}
+
+} // namespace openmc
+
+#endif // PROFILE_RANGES
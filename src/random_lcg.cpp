@@ -20,6 +20,44 @@ constexpr uint64_t prn_stride {152917LL};                // stride between
                                                          //   particles
 constexpr double   prn_norm   {1.0 / prn_mod};           // 2^-63
 
+namespace {
+
+// Parameters G and C of the skip ahead by b*256^k for each byte value b and
+// each byte position k, so that the skip ahead by any n is the composition of
+// one entry per byte of n
+struct SkipTable {
+  uint64_t g[8][256];
+  uint64_t c[8][256];
+};
+
+constexpr SkipTable make_skip_table()
+{
+  SkipTable t {};
+
+  // Parameters of the skip ahead by 256^k
+  uint64_t g_unit = prn_mult;
+  uint64_t c_unit = prn_add;
+  for (int k = 0; k < 8; ++k) {
+    t.g[k][0] = 1;
+    t.c[k][0] = 0;
+    for (int b = 1; b < 256; ++b) {
+      // Skip ahead by (b - 1)*256^k and then by 256^k
+      t.g[k][b] = g_unit * t.g[k][b - 1];
+      t.c[k][b] = g_unit * t.c[k][b - 1] + c_unit;
+    }
+    uint64_t g_next = g_unit * t.g[k][255];
+    c_unit = g_unit * t.c[k][255] + c_unit;
+    g_unit = g_next;
+  }
+  return t;
+}
+
+#pragma omp declare target
+constexpr SkipTable skip_table {make_skip_table()};
+#pragma omp end declare target
+
+} // namespace
+
 //==============================================================================
 // PRN
 //==============================================================================
@@ -59,8 +97,12 @@ uint64_t init_seed(int64_t id, int offset)
 
 void init_particle_seeds(int64_t id, uint64_t* seeds)
 {
+  // Every stream skips ahead by the same distance from its own master seed
+  uint64_t g;
+  uint64_t c;
+  skip_ahead_params(static_cast<uint64_t>(id) * prn_stride, &g, &c);
   for (int i = 0; i < N_STREAMS; i++) {
-    seeds[i] = future_seed(static_cast<uint64_t>(id) * prn_stride, master_seed + i);
+    seeds[i] = (g * static_cast<uint64_t>(master_seed + i) + c) & prn_mask;
   }
 }
 
@@ -78,37 +120,50 @@ void advance_prn_seed(int64_t n, uint64_t* seed)
 //==============================================================================
 
 uint64_t future_seed(uint64_t n, uint64_t seed)
+{
+  uint64_t g_new;
+  uint64_t c_new;
+  skip_ahead_params(n, &g_new, &c_new);
+
+  // With G and C, we can now find the new seed.
+  return (g_new * seed + c_new) & prn_mask;
+}
+
+//==============================================================================
+// SKIP_AHEAD_PARAMS
+//==============================================================================
+
+void skip_ahead_params(uint64_t n, uint64_t* g_new, uint64_t* c_new)
 {
   // Make sure nskip is less than 2^M.
   n &= prn_mask;
 
   // The algorithm here to determine the parameters used to skip ahead is
   // described in F. Brown, "Random Number Generation with Arbitrary Stride,"
-  // Trans. Am. Nucl. Soc. (Nov. 1994). This algorithm is able to skip ahead in
-  // O(log2(N)) operations instead of O(N). Basically, it computes parameters G
-  // and C which can then be used to find x_N = G*x_0 + C mod 2^M.
-
-  // Initialize constants
-  uint64_t g     {prn_mult};
-  uint64_t c     {prn_add};
-  uint64_t g_new {1};
-  uint64_t c_new {0};
-
-  while (n > 0) {
-    // Check if the least significant bit is 1.
-    if (n & 1) {
-      g_new *= g;
-      c_new = c_new * g + c;
-    }
-    c *= (g + 1);
-    g *= g;
-
-    // Move bits right, dropping least significant bit.
-    n >>= 1;
+  // Trans. Am. Nucl. Soc. (Nov. 1994). Basically, it computes parameters G and
+  // C which can then be used to find x_N = G*x_0 + C mod 2^M. Rather than one
+  // step per bit of N, the parameters for each byte of N are looked up in a
+  // table computed at compile time and composed, in at most eight steps.
+  *g_new = 1;
+  *c_new = 0;
+
+  for (int k = 0; n > 0; ++k) {
+    int b = n & 0xff;
+    *c_new = skip_table.g[k][b] * *c_new + skip_table.c[k][b];
+    *g_new *= skip_table.g[k][b];
+
+    // Move to the next byte
+    n >>= 8;
   }
+}
 
-  // With G and C, we can now find the new seed.
-  return (g_new * seed + c_new) & prn_mask;
+//==============================================================================
+// SKIP_AHEAD_PRN
+//==============================================================================
+
+double skip_ahead_prn(uint64_t g, uint64_t c, uint64_t seed)
+{
+  return ((g * seed + c) & prn_mask) * prn_norm;
 }
 
 //==============================================================================
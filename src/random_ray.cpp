@@ -0,0 +1,648 @@
+//! \file random_ray.cpp
+//! \brief Random ray solver for the multigroup scalar fluxes of flat source
+//! regions, tracing rays through the CSG geometry with the kernels of particle
+//! transport
+
+#include <algorithm> // for fill, min
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <fmt/core.h>
+
+#include "openmc/capi.h"
+#include "openmc/cell.h"
+#include "openmc/constants.h"
+#include "openmc/error.h"
+#include "openmc/geometry.h"
+#include "openmc/hdf5_interface.h"
+#include "openmc/material.h"
+#include "openmc/message_passing.h"
+#include "openmc/mgxs_interface.h"
+#include "openmc/output.h"
+#include "openmc/particle.h"
+#include "openmc/random_lcg.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+#include "openmc/source.h"
+#include "openmc/surface.h"
+#include "openmc/tallies/tally.h"
+#include "openmc/timer.h"
+
+namespace openmc {
+
+namespace {
+
+//==============================================================================
+//! The flat source regions of the model, which are the instances of its
+//! material cells, with the multigroup data of the cross section sets they are
+//! filled with and the fluxes and sources the solver iterates on
+//==============================================================================
+
+struct FlatSourceRegions {
+  int n_groups {0};
+  int64_t n_regions {0};
+  int n_sets {0};
+
+  // Per cell
+  std::vector<int64_t> cell_region; //!< First region of a cell, or C_NONE
+
+  // Per region
+  std::vector<int32_t> cell;     //!< Cell of the region
+  std::vector<int32_t> instance; //!< Instance of the cell
+  std::vector<int> set;          //!< Cross section set, or C_NONE for void
+  std::vector<double> length;    //!< Track length of this iteration
+  std::vector<double> volume;    //!< Track length summed over iterations
+
+  // Per set and group, or set and pair of incoming and outgoing groups
+  std::vector<double> sigma_t;
+  std::vector<double> nu_sigma_f;
+  std::vector<double> scatter; //!< Isotropic nu-scatter matrix
+  std::vector<double> fission; //!< Fission spectrum times nu-fission
+
+  // Per region and group
+  std::vector<double> flux;      //!< Scalar flux
+  std::vector<double> source;    //!< Isotropic source per steradian
+  std::vector<double> delta_psi; //!< Attenuation of the angular flux summed over rays
+  std::vector<double> flux_sum;  //!< Scalar flux summed over active batches
+};
+
+//==============================================================================
+//! Pointers to the arrays of FlatSourceRegions that rays are traced with. On
+//! device, they are built inside target regions from the mapped arrays.
+//==============================================================================
+
+struct RayData {
+  int n_groups;
+  double distance_inactive;
+  double distance_active;
+  const int64_t* cell_region;
+  const int* set;
+  const double* sigma_t;
+  const double* source;
+  double* delta_psi;
+  double* length;
+};
+
+//! Find the flat source regions of the model and the data of their sets
+FlatSourceRegions find_flat_source_regions()
+{
+  FlatSourceRegions fsr;
+  const auto& tables = data::mg_tables;
+  int n_g = tables.num_groups();
+  fsr.n_groups = n_g;
+
+  // Number the regions cell by cell, and the distinct sets they are filled
+  // with in order of appearance
+  fsr.cell_region.assign(model::cells.size(), C_NONE);
+  std::map<int, int> set_index;
+  std::vector<int> sets;
+  for (int i = 0; i < model::cells.size(); ++i) {
+    const Cell& c {model::cells[i]};
+    if (c.type_ != Fill::MATERIAL) continue;
+    fsr.cell_region[i] = fsr.n_regions;
+    for (int j = 0; j < c.n_instances_; ++j) {
+      int mat = c.material_.size() > 1 ? c.material_[j] : c.material_[0];
+      double sqrtkT = c.sqrtkT_.size() > 1 ? c.sqrtkT_[j] : c.sqrtkT_[0];
+      int s = C_NONE;
+      if (mat != MATERIAL_VOID) {
+        if (!tables.is_isotropic(mat)) {
+          fatal_error(fmt::format("Material {} has angle-dependent multigroup "
+            "cross sections, which the random ray solver does not support.",
+            model::materials[mat].id_));
+        }
+        int set = tables.set_index(mat, sqrtkT, {0.0, 0.0, 1.0});
+        auto it = set_index.find(set);
+        if (it == set_index.end()) {
+          s = sets.size();
+          set_index[set] = s;
+          sets.push_back(set);
+        } else {
+          s = it->second;
+        }
+      }
+      fsr.cell.push_back(i);
+      fsr.instance.push_back(j);
+      fsr.set.push_back(s);
+      ++fsr.n_regions;
+    }
+  }
+
+  // Scattering is taken to be isotropic, and the fission spectrum is that of
+  // the prompt and delayed neutrons together
+  fsr.n_sets = sets.size();
+  int n_dg = tables.num_delayed_groups();
+  fsr.sigma_t.resize(fsr.n_sets * n_g);
+  fsr.nu_sigma_f.resize(fsr.n_sets * n_g);
+  fsr.scatter.resize(fsr.n_sets * n_g * n_g);
+  fsr.fission.resize(fsr.n_sets * n_g * n_g);
+  for (int s = 0; s < fsr.n_sets; ++s) {
+    int set = sets[s];
+    for (int g_in = 0; g_in < n_g; ++g_in) {
+      double sigma_t = tables.get_xs(set, MgxsType::TOTAL, g_in, nullptr,
+        nullptr, nullptr);
+      if (sigma_t <= 0.0) {
+        fatal_error(fmt::format("The random ray solver needs positive total "
+          "cross sections, but that of group {} is zero.", g_in + 1));
+      }
+      fsr.sigma_t[s * n_g + g_in] = sigma_t;
+      fsr.nu_sigma_f[s * n_g + g_in] = tables.get_xs(set, MgxsType::NU_FISSION,
+        g_in, nullptr, nullptr, nullptr);
+
+      double prompt = tables.get_xs(set, MgxsType::PROMPT_NU_FISSION, g_in,
+        nullptr, nullptr, nullptr);
+      for (int g = 0; g < n_g; ++g) {
+        int64_t k = (static_cast<int64_t>(s) * n_g + g_in) * n_g + g;
+        fsr.scatter[k] = tables.get_xs(set, MgxsType::NU_SCATTER, g_in, &g,
+          nullptr, nullptr);
+        double chi_nu_f = prompt * tables.get_xs(set, MgxsType::CHI_PROMPT,
+          g_in, &g, nullptr, nullptr);
+        for (int d = 0; d < n_dg; ++d) {
+          chi_nu_f += tables.get_xs(set, MgxsType::DELAYED_NU_FISSION, g_in,
+            nullptr, nullptr, &d) * tables.get_xs(set, MgxsType::CHI_DELAYED,
+            g_in, &g, nullptr, &d);
+        }
+        fsr.fission[k] = chi_nu_f;
+      }
+    }
+  }
+
+  int64_t n = fsr.n_regions * n_g;
+  fsr.length.assign(fsr.n_regions, 0.0);
+  fsr.volume.assign(fsr.n_regions, 0.0);
+  fsr.flux.assign(n, 1.0);
+  fsr.source.assign(n, 0.0);
+  fsr.delta_psi.assign(n, 0.0);
+  fsr.flux_sum.assign(n, 0.0);
+  return fsr;
+}
+
+#pragma omp declare target
+//! Flat source region a ray is in
+int64_t ray_region(const Particle& p, const RayData& d)
+{
+  return d.cell_region[p.coord_[p.n_coord_ - 1].cell] + p.cell_instance_;
+}
+
+//! Attenuate the angular flux of a ray along a segment in a flat source
+//! region, summing the attenuation and segment length into the region if the
+//! segment lies past the dead zone
+//
+//! \param i Flat source region
+//! \param length Length of the segment in [cm]
+//! \param active Whether the segment lies past the dead zone
+//! \param psi Angular flux of each group, followed by scratch for as many
+//!   values
+//! \param d Arrays of the regions
+void attenuate_ray(int64_t i, double length, bool active, double* psi,
+  const RayData& d)
+{
+  if (active) {
+    #pragma omp atomic
+    d.length[i] += length;
+  }
+  int s = d.set[i];
+  if (s == C_NONE) return;
+
+  int n_g = d.n_groups;
+  const double* sigma_t = d.sigma_t + s * n_g;
+  const double* source = d.source + i * n_g;
+  double* delta = psi + n_g;
+  #pragma omp simd
+  for (int g = 0; g < n_g; ++g) {
+    delta[g] = (psi[g] - source[g] / sigma_t[g]) *
+      -std::expm1(-sigma_t[g] * length);
+    psi[g] -= delta[g];
+  }
+  if (active) {
+    double* delta_psi = d.delta_psi + i * n_g;
+    for (int g = 0; g < n_g; ++g) {
+      #pragma omp atomic
+      delta_psi[g] += delta[g];
+    }
+  }
+}
+
+//! Trace a ray from a site over its dead zone and active distance. At vacuum
+//! boundaries its angular flux is zeroed and it is reflected back in.
+//
+//! \param p Particle the ray is traced with
+//! \param site Position and direction of the start of the ray
+//! \param psi Angular flux of each group, followed by scratch for as many
+//!   values
+//! \param d Arrays of the regions
+//! \return Whether the ray was traced over its whole distance, rather than
+//!   lost in the geometry
+bool trace_ray(Particle& p, const Particle::Bank& site, double* psi,
+  const RayData& d)
+{
+  p.from_source(site);
+  if (!exhaustive_find_cell(p)) return false;
+
+  // The angular flux starts out as that of the region's flat source alone
+  int n_g = d.n_groups;
+  int64_t i = ray_region(p, d);
+  int s = d.set[i];
+  for (int g = 0; g < n_g; ++g) {
+    psi[g] = s == C_NONE ? 0.0 : d.source[i * n_g + g] / d.sigma_t[s * n_g + g];
+  }
+
+  double distance = 0.0;
+  double total = d.distance_inactive + d.distance_active;
+  while (distance < total) {
+    p.boundary_ = distance_to_boundary(p);
+    double length = std::min(p.boundary_.distance, total - distance);
+    bool active = distance >= d.distance_inactive;
+
+    // The segment through the end of the dead zone is split there
+    if (!active && distance + length > d.distance_inactive) {
+      length = d.distance_inactive - distance;
+    }
+    bool crossing = length == p.boundary_.distance;
+    attenuate_ray(i, length, active, psi, d);
+
+    for (int j = 0; j < p.n_coord_; ++j) {
+      p.coord_[j].r += length * p.coord_[j].u;
+    }
+    if (settings::plane_cache) {
+      const auto& coord {p.coord_[p.n_coord_ - 1]};
+      p.plane_cache_.advance(length, coord.r, coord.u);
+    }
+    distance += length;
+    if (!crossing) continue;
+
+    p.event_cross_surface();
+    if (!p.alive()) {
+      for (int g = 0; g < n_g; ++g) psi[g] = 0.0;
+      const auto& surf {model::device_surfaces[std::abs(p.surface_) - 1]};
+      Direction u = surf.reflect(p.r(), p.u(), &p);
+      u /= u.norm();
+      p.wgt_ = 1.0;
+      p.cross_reflective_bc(surf, u);
+    }
+    if (p.coord_[p.n_coord_ - 1].cell == C_NONE) return false;
+    i = ray_region(p, d);
+  }
+  return true;
+}
+#pragma omp end declare target
+
+//! Sample the start of each ray of this process from the external source
+//
+//! \param sites Start of each ray
+//! \param first_id ID of the first ray, which sets its random number stream
+void sample_rays(std::vector<Particle::Bank>& sites, int64_t first_id)
+{
+  #pragma omp parallel for
+  for (int64_t i = 0; i < sites.size(); ++i) {
+    uint64_t seed = init_seed(first_id + i, STREAM_SOURCE);
+    sites[i] = sample_external_source(&seed);
+  }
+}
+
+//! Trace the rays history-based on host threads
+//
+//! \return Number of rays lost
+int64_t host_rays(FlatSourceRegions& fsr,
+  const std::vector<Particle::Bank>& sites)
+{
+  RayData d {fsr.n_groups, settings::random_ray_distance_inactive,
+    settings::random_ray_distance_active, fsr.cell_region.data(),
+    fsr.set.data(), fsr.sigma_t.data(), fsr.source.data(),
+    fsr.delta_psi.data(), fsr.length.data()};
+  int64_t n_rays = sites.size();
+  int64_t n_lost = 0;
+  #pragma omp parallel reduction(+: n_lost)
+  {
+    Particle p;
+    std::vector<double> psi(2 * fsr.n_groups);
+    #pragma omp for schedule(dynamic, 64)
+    for (int64_t i = 0; i < n_rays; ++i) {
+      if (!trace_ray(p, sites[i], psi.data(), d)) ++n_lost;
+    }
+  }
+  return n_lost;
+}
+
+//! Trace the rays on device with the particles of the event-based buffer, as
+//! many at a time as the buffer holds. The arrays of the regions must already
+//! be mapped.
+//
+//! \return Number of rays lost
+int64_t event_rays(FlatSourceRegions& fsr, std::vector<Particle::Bank>& sites,
+  double* psi)
+{
+  int n_g = fsr.n_groups;
+  double distance_inactive = settings::random_ray_distance_inactive;
+  double distance_active = settings::random_ray_distance_active;
+  const int64_t* cell_region = fsr.cell_region.data();
+  const int* set = fsr.set.data();
+  const double* sigma_t = fsr.sigma_t.data();
+  double* source = fsr.source.data();
+  double* delta_psi = fsr.delta_psi.data();
+  double* length = fsr.length.data();
+  Particle::Bank* ray_sites = sites.data();
+  int64_t n = fsr.n_regions * n_g;
+  int64_t n_regions = fsr.n_regions;
+  int64_t n_rays = sites.size();
+
+  #pragma omp target update to(source[:n], ray_sites[:n_rays])
+  #pragma omp target teams distribute parallel for
+  for (int64_t i = 0; i < n; ++i) {
+    delta_psi[i] = 0.0;
+    if (i < n_regions) length[i] = 0.0;
+  }
+
+  int64_t n_buffer = simulation::particles.size();
+  int64_t n_lost = 0;
+  for (int64_t first = 0; first < n_rays; first += n_buffer) {
+    int64_t n_items = std::min(n_buffer, n_rays - first);
+    #pragma omp target teams distribute parallel for reduction(+: n_lost)
+    for (int64_t i = 0; i < n_items; ++i) {
+      RayData d {n_g, distance_inactive, distance_active, cell_region, set,
+        sigma_t, source, delta_psi, length};
+      if (!trace_ray(simulation::device_particles[i], ray_sites[first + i],
+          psi + 2 * n_g * i, d)) {
+        ++n_lost;
+      }
+    }
+  }
+
+  #pragma omp target update from(delta_psi[:n], length[:n_regions])
+  return n_lost;
+}
+
+//! Update the isotropic source of each region from its scalar flux
+void update_source(FlatSourceRegions& fsr, double k)
+{
+  int n_g = fsr.n_groups;
+  #pragma omp parallel for
+  for (int64_t i = 0; i < fsr.n_regions; ++i) {
+    double* source = &fsr.source[i * n_g];
+    std::fill(source, source + n_g, 0.0);
+    int s = fsr.set[i];
+    if (s == C_NONE) continue;
+
+    const double* flux = &fsr.flux[i * n_g];
+    const double* scatter = &fsr.scatter[static_cast<int64_t>(s) * n_g * n_g];
+    const double* fission = &fsr.fission[static_cast<int64_t>(s) * n_g * n_g];
+    for (int g_in = 0; g_in < n_g; ++g_in) {
+      double flux_in = flux[g_in];
+      double fission_in = flux_in / k;
+      #pragma omp simd
+      for (int g = 0; g < n_g; ++g) {
+        source[g] += scatter[g_in * n_g + g] * flux_in +
+          fission[g_in * n_g + g] * fission_in;
+      }
+    }
+    for (int g = 0; g < n_g; ++g) source[g] /= 4.0 * PI;
+  }
+}
+
+//! Update the scalar flux of each region from the attenuation of the rays
+//! through it, with its volume estimated by the track length averaged over
+//! the iterations so far
+//
+//! \param n_iterations Number of iterations including this one
+//! \return Ratio of the fission rates of the new and old fluxes
+double update_flux(FlatSourceRegions& fsr, int n_iterations)
+{
+  int n_g = fsr.n_groups;
+  double fission_old = 0.0;
+  double fission_new = 0.0;
+  #pragma omp parallel for reduction(+: fission_old, fission_new)
+  for (int64_t i = 0; i < fsr.n_regions; ++i) {
+    fsr.volume[i] += fsr.length[i];
+    double volume = fsr.volume[i] / n_iterations;
+    int s = fsr.set[i];
+    double* flux = &fsr.flux[i * n_g];
+    if (s == C_NONE || volume == 0.0) {
+      std::fill(flux, flux + n_g, 0.0);
+      continue;
+    }
+
+    const double* sigma_t = &fsr.sigma_t[s * n_g];
+    const double* nu_sigma_f = &fsr.nu_sigma_f[s * n_g];
+    const double* source = &fsr.source[i * n_g];
+    const double* delta_psi = &fsr.delta_psi[i * n_g];
+    for (int g = 0; g < n_g; ++g) {
+      fission_old += volume * nu_sigma_f[g] * flux[g];
+      flux[g] = 4.0 * PI * (source[g] + delta_psi[g] / volume) / sigma_t[g];
+      fission_new += volume * nu_sigma_f[g] * flux[g];
+    }
+  }
+  return fission_old > 0.0 ? fission_new / fission_old : 1.0;
+}
+
+//! Write the fluxes averaged over the active batches, with the estimated
+//! volume of each region as a fraction of the total
+void write_random_ray(const FlatSourceRegions& fsr, int n_active)
+{
+  std::string filename = settings::path_output + "random_ray.h5";
+  write_message("Writing random ray results to " + filename + "...", 5);
+
+  std::vector<int32_t> cell_ids(fsr.n_regions);
+  std::vector<double> volume(fsr.n_regions);
+  double total_volume = 0.0;
+  for (double v : fsr.volume) total_volume += v;
+  for (int64_t i = 0; i < fsr.n_regions; ++i) {
+    cell_ids[i] = model::cells[fsr.cell[i]].id_;
+    volume[i] = total_volume > 0.0 ? fsr.volume[i] / total_volume : 0.0;
+  }
+  std::vector<double> flux(fsr.flux_sum);
+  for (double& f : flux) f /= std::max(n_active, 1);
+
+  hid_t file = file_open(filename, 'w');
+  write_attribute(file, "filetype", "random_ray");
+  write_attribute(file, "openmc_version", VERSION);
+  write_attribute(file, "date_and_time", time_stamp());
+  write_dataset(file, "k_generation", simulation::k_generation);
+  write_dataset(file, "k_combined", std::array<double, 2> {simulation::keff,
+    simulation::keff_std});
+  write_dataset(file, "cells", cell_ids);
+  write_dataset(file, "instances", fsr.instance);
+  write_dataset(file, "volumes", volume);
+  hsize_t dims[] {static_cast<hsize_t>(fsr.n_regions),
+    static_cast<hsize_t>(fsr.n_groups)};
+  write_dataset_lowlevel(file, 2, dims, "flux", H5TypeMap<double>::type_id,
+    H5S_ALL, false, flux.data());
+  file_close(file);
+}
+
+} // namespace
+
+} // namespace openmc
+
+//==============================================================================
+// C API
+//==============================================================================
+
+int openmc_random_ray()
+{
+  using namespace openmc;
+
+  if (settings::run_CE) {
+    set_errmsg("The random ray solver requires multigroup data.");
+    return OPENMC_E_INVALID_ARGUMENT;
+  }
+  if (settings::run_mode != RunMode::EIGENVALUE) {
+    set_errmsg("The random ray solver only solves eigenvalue problems.");
+    return OPENMC_E_INVALID_ARGUMENT;
+  }
+  if (settings::weight_windows_on) {
+    set_errmsg("Weight windows cannot be used with the random ray solver.");
+    return OPENMC_E_INVALID_ARGUMENT;
+  }
+  // Flat source regions are the instances of the material cells, which are
+  // numbered by the material cell offsets
+  if (!settings::material_cell_offsets) {
+    set_errmsg("The random ray solver needs material cell offsets.");
+    return OPENMC_E_INVALID_ARGUMENT;
+  }
+
+  int err = openmc_simulation_init();
+  if (err) return err;
+  if (model::tallies_size > 0 && mpi::master) {
+    warning("Tallies are not scored by the random ray solver.");
+  }
+
+  FlatSourceRegions fsr = find_flat_source_regions();
+  if (fsr.n_sets == 0) {
+    openmc_simulation_finalize();
+    set_errmsg("The model has no materials for the random ray solver.");
+    return OPENMC_E_GEOMETRY;
+  }
+  int n_g = fsr.n_groups;
+  int64_t n = fsr.n_regions * n_g;
+
+  // Rays are traced on device when the event-based particle buffer is there
+  // to trace them with
+  std::vector<Particle::Bank> sites(simulation::work_per_rank);
+  Particle::Bank* ray_sites = sites.data();
+  int64_t n_rays = sites.size();
+  std::vector<double> psi;
+  double* device_psi = nullptr;
+  int64_t n_cells = fsr.cell_region.size();
+  const int64_t* cell_region = fsr.cell_region.data();
+  const int* set = fsr.set.data();
+  const double* sigma_t = fsr.sigma_t.data();
+  double* source = fsr.source.data();
+  double* delta_psi = fsr.delta_psi.data();
+  double* length = fsr.length.data();
+  int64_t n_regions = fsr.n_regions;
+  int64_t n_sigma_t = fsr.sigma_t.size();
+  int64_t n_psi = 0;
+  if (settings::event_based) {
+    psi.resize(2 * n_g * simulation::particles.size());
+    device_psi = psi.data();
+    n_psi = psi.size();
+    #pragma omp target enter data map(to: cell_region[:n_cells], set[:n_regions], \
+      sigma_t[:n_sigma_t]) map(alloc: source[:n], delta_psi[:n], \
+      length[:n_regions], ray_sites[:n_rays], device_psi[:n_psi])
+  }
+
+  if (mpi::master) {
+    header("RANDOM RAY SOLVER", 3);
+    fmt::print(" Flat source regions               = {}\n", fsr.n_regions);
+    fmt::print(" Energy groups                     = {}\n", n_g);
+    fmt::print(" Rays per batch                    = {}\n", settings::n_particles);
+    fmt::print(" Ray distance                      = {} cm, after {} cm "
+      "dead zone\n", settings::random_ray_distance_active,
+      settings::random_ray_distance_inactive);
+    const char* where = settings::event_based ?
+      (was_device_used() ? "on device" : "event-based on host") :
+      "history-based on host";
+    fmt::print(" Ray tracing                       = {}\n\n", where);
+    fmt::print(
+      "  Batch          k            Average k\n"
+      "  =========   ========   ====================\n");
+  }
+
+  Timer timer;
+  timer.start();
+  double k = 1.0;
+  double k_sum = 0.0;
+  double k_sum_sq = 0.0;
+  int n_active = 0;
+  int64_t n_lost = 0;
+  simulation::k_generation.clear();
+  for (int batch = 1; batch <= settings::n_batches; ++batch) {
+    update_source(fsr, k);
+
+    int64_t first_id = (batch - 1) * settings::n_particles +
+      simulation::work_index[mpi::rank] + 1;
+    sample_rays(sites, first_id);
+    if (settings::event_based) {
+      n_lost += event_rays(fsr, sites, device_psi);
+    } else {
+      std::fill(fsr.delta_psi.begin(), fsr.delta_psi.end(), 0.0);
+      std::fill(fsr.length.begin(), fsr.length.end(), 0.0);
+      n_lost += host_rays(fsr, sites);
+    }
+
+#ifdef OPENMC_MPI
+    MPI_Allreduce(MPI_IN_PLACE, fsr.delta_psi.data(), n, MPI_DOUBLE, MPI_SUM,
+      mpi::intracomm);
+    MPI_Allreduce(MPI_IN_PLACE, fsr.length.data(), fsr.n_regions, MPI_DOUBLE,
+      MPI_SUM, mpi::intracomm);
+#endif
+
+    k *= update_flux(fsr, batch);
+    simulation::k_generation.push_back(k);
+
+    if (batch > settings::n_inactive) {
+      ++n_active;
+      k_sum += k;
+      k_sum_sq += k * k;
+      for (int64_t i = 0; i < n; ++i) fsr.flux_sum[i] += fsr.flux[i];
+      simulation::keff = k_sum / n_active;
+      simulation::keff_std = n_active > 1 ? std::sqrt(std::max(0.0,
+        (k_sum_sq / n_active - simulation::keff * simulation::keff) /
+        (n_active - 1))) : 0.0;
+    }
+
+    if (mpi::master && settings::verbosity >= 7) {
+      fmt::print("  {:>9}   {:8.5f}", batch, k);
+      if (n_active > 1) {
+        fmt::print("   {:8.5f} +/-{:8.5f}", simulation::keff,
+          simulation::keff_std);
+      }
+      std::cout << std::endl;
+    }
+  }
+  timer.stop();
+
+  if (settings::event_based) {
+    #pragma omp target exit data map(delete: cell_region[:n_cells], \
+      set[:n_regions], sigma_t[:n_sigma_t], source[:n], delta_psi[:n], \
+      length[:n_regions], ray_sites[:n_rays], device_psi[:n_psi])
+  }
+
+#ifdef OPENMC_MPI
+  MPI_Allreduce(MPI_IN_PLACE, &n_lost, 1, MPI_INT64_T, MPI_SUM,
+    mpi::intracomm);
+#endif
+  if (mpi::master) {
+    if (n_lost > 0) {
+      warning(fmt::format("{} rays could not be located in the geometry and "
+        "were cut short.", n_lost));
+    }
+    header("Results", 4);
+    fmt::print(" k-effective (Random Ray)          = {:.5f} +/- {:.5f}\n",
+      simulation::keff, simulation::keff_std);
+    show_time("Total time in ray iterations", timer.elapsed());
+    fmt::print(" Calculation Rate                  = {:.6} rays/second\n",
+      timer.elapsed() > 0.0 ?
+      settings::n_batches * settings::n_particles / timer.elapsed() : 0.0);
+    write_random_ray(fsr, n_active);
+  }
+
+  return openmc_simulation_finalize();
+}
@@ -1,5 +1,6 @@
 #include "openmc/reaction.h"
 
+#include <cstring> // for memcpy
 #include <string>
 #include <unordered_map>
 #include <utility> // for move
@@ -12,6 +13,7 @@
 #include "openmc/random_lcg.h"
 #include "openmc/search.h"
 #include "openmc/secondary_uncorrelated.h"
+#include "openmc/settings.h"
 
 namespace openmc {
 
@@ -55,11 +57,22 @@ Reaction::Reaction(hid_t group, const std::vector<int>& temperatures)
     xs_.push_back(std::move(xs));
   }
 
-  // Read products
+  // Read products. Photon products are of no use without photon transport,
+  // and follow the neutron products, so leaving them out when pruning does
+  // not move the neutron products.
+  bool skip_photons = settings::prune_nuclear_data &&
+    !settings::photon_transport;
   for (const auto& name : group_names(group)) {
     if (name.rfind("product_", 0) == 0) {
       hid_t pgroup = open_group(group, name.c_str());
-      products_.emplace_back(pgroup);
+      std::string particle;
+      if (skip_photons) read_attribute(pgroup, "particle", particle);
+      if (skip_photons && str_to_particle_type(particle) ==
+          Particle::Type::photon) {
+        pruned_bytes_ += storage_size(pgroup);
+      } else {
+        products_.emplace_back(pgroup);
+      }
       close_group(pgroup);
     }
   }
@@ -343,6 +356,13 @@ ReactionFlatContainer::ReactionFlatContainer(const Reaction& rx)
   Ensures(n == buffer_.size());
 }
 
+ReactionFlatContainer::ReactionFlatContainer(const uint8_t* data, size_t n)
+{
+  buffer_.reserve(n);
+  std::memcpy(buffer_.data_, data, n);
+  buffer_.offset_ = n;
+}
+
 ReactionFlat ReactionFlatContainer::obj() const
 {
   return ReactionFlat(buffer_.data_);
@@ -14,6 +14,7 @@
 #include "openmc/secondary_kalbach.h"
 #include "openmc/secondary_nbody.h"
 #include "openmc/secondary_uncorrelated.h"
+#include "openmc/settings.h"
 
 namespace openmc {
 
@@ -68,14 +69,20 @@ ReactionProduct::ReactionProduct(hid_t group)
 
     // Determine distribution type and read data
     read_attribute(dgroup, "type", temp);
+    // Correlated distributions are also read as temporaries by thermal
+    // scattering data, so they are decoded here rather than on construction
     if (temp == "uncorrelated") {
       distribution_.push_back(std::make_unique<UncorrelatedAngleEnergy>(dgroup));
     } else if (temp == "correlated") {
-      distribution_.push_back(std::make_unique<CorrelatedAngleEnergy>(dgroup));
+      auto dist = std::make_unique<CorrelatedAngleEnergy>(dgroup);
+      if (settings::decoded_distributions) dist->decode();
+      distribution_.push_back(std::move(dist));
     } else if (temp == "nbody") {
       distribution_.push_back(std::make_unique<NBodyPhaseSpace>(dgroup));
     } else if (temp == "kalbach-mann") {
-      distribution_.push_back(std::make_unique<KalbachMann>(dgroup));
+      auto dist = std::make_unique<KalbachMann>(dgroup);
+      if (settings::decoded_distributions) dist->decode();
+      distribution_.push_back(std::move(dist));
     }
 
     close_group(dgroup);
@@ -0,0 +1,252 @@
+#include "openmc/region_costs.h"
+
+#include <algorithm> // for fill, min, sort
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "openmc/cell.h"
+#include "openmc/constants.h"
+#include "openmc/error.h"
+#include "openmc/kernel_profile.h"
+#include "openmc/material.h"
+#include "openmc/message_passing.h"
+#include "openmc/output.h"
+#include "openmc/particle.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+#include "openmc/string_utils.h"
+
+namespace openmc {
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+int64_t* device_cell_event_counts {nullptr};
+int64_t* device_material_event_counts {nullptr};
+
+} // namespace simulation
+
+namespace {
+
+// Host copies of the counts, which the device pointers point into
+std::vector<int64_t> cell_counts;
+std::vector<int64_t> material_counts;
+
+double event_seconds[N_EVENT_TYPES]; // Elapsed time of each event type
+
+// Number of regions the counts of each event type are kept for
+int n_cell_regions {0};
+int n_material_regions {0};
+
+//! Costs of one cell or material
+struct RegionCost {
+  int index;                     //!< Index of the cell or material, or -1
+  int64_t events[N_EVENT_TYPES]; //!< Estimated events, i.e. scaled by stride
+  double seconds;
+};
+
+//! Share out the time of each event type among regions in proportion to their
+//! sampled events of that type
+//
+//! \param counts Sampled events, indexed by [type][region]
+//! \param n_regions Number of regions
+//! \param type_events Sampled events of each type in all regions
+std::vector<RegionCost> region_costs(const std::vector<int64_t>& counts,
+  int n_regions, const int64_t* type_events)
+{
+  std::vector<RegionCost> costs;
+  for (int r = 0; r < n_regions; ++r) {
+    RegionCost c {r, {}, 0.0};
+    int64_t total = 0;
+    for (int t = 0; t < N_EVENT_TYPES; ++t) {
+      int64_t n = counts[t * n_regions + r];
+      c.events[t] = n * settings::region_cost_stride;
+      if (type_events[t] > 0) {
+        c.seconds += event_seconds[t] * n / type_events[t];
+      }
+      total += n;
+    }
+    if (total > 0) costs.push_back(c);
+  }
+  std::sort(costs.begin(), costs.end(),
+    [](const RegionCost& a, const RegionCost& b) {
+      return a.seconds > b.seconds;
+    });
+  return costs;
+}
+
+//! Write the costs of cells or materials as a JSON array
+void write_costs(std::ofstream& out, const std::vector<RegionCost>& costs,
+  bool cells, double total_seconds)
+{
+  for (int i = 0; i < costs.size(); ++i) {
+    const auto& c {costs[i]};
+    int32_t id = -1;
+    std::string name {"void"};
+    if (cells) {
+      id = model::cells[c.index].id_;
+      name = model::cells[c.index].name();
+    } else if (c.index < model::materials.size()) {
+      id = model::materials[c.index].id_;
+      name = model::materials[c.index].name();
+    }
+    out << (i == 0 ? "\n" : ",\n") << fmt::format("    {{\"id\": {}, "
+      "\"name\": {}, \"seconds\": {:.6e}, \"fraction\": {:.6e}, \"events\": {{",
+      id, json_string(name), c.seconds,
+      total_seconds > 0.0 ? c.seconds / total_seconds : 0.0);
+    for (int t = 0; t < N_EVENT_TYPES; ++t) {
+      out << fmt::format("{}\"{}\": {}", t == 0 ? "" : ", ",
+        profile_region_name(t), c.events[t]);
+    }
+    out << "}}";
+  }
+}
+
+//! Display the costliest regions
+void print_costs(const char* kind, const std::vector<RegionCost>& costs,
+  bool cells, double total_seconds)
+{
+  fmt::print(" {:<10} {:>12} {:>9} {:>14}\n", kind, "Time [s]", "Share",
+    "Events");
+  for (int i = 0; i < std::min<int>(costs.size(), 10); ++i) {
+    const auto& c {costs[i]};
+    std::string label {"void"};
+    if (cells) {
+      label = std::to_string(model::cells[c.index].id_);
+    } else if (c.index < model::materials.size()) {
+      label = std::to_string(model::materials[c.index].id_);
+    }
+    int64_t events = 0;
+    for (int t = 0; t < N_EVENT_TYPES; ++t) events += c.events[t];
+    fmt::print(" {:<10} {:>12.4e} {:>8.1f}% {:>14}\n", label, c.seconds,
+      total_seconds > 0.0 ? 100.0 * c.seconds / total_seconds : 0.0, events);
+  }
+}
+
+} // namespace
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+bool counting_region_costs()
+{
+  return settings::event_based && !settings::path_region_costs.empty();
+}
+
+void init_region_costs()
+{
+  if (!counting_region_costs()) return;
+
+  n_cell_regions = model::cells.size();
+  n_material_regions = model::materials.size() + 1;
+  cell_counts.assign(N_EVENT_TYPES * n_cell_regions, 0);
+  material_counts.assign(N_EVENT_TYPES * n_material_regions, 0);
+  std::fill(event_seconds, event_seconds + N_EVENT_TYPES, 0.0);
+
+  simulation::device_cell_event_counts = cell_counts.data();
+  simulation::device_material_event_counts = material_counts.data();
+  #pragma omp target enter data map(to: simulation::device_cell_event_counts[:cell_counts.size()])
+  #pragma omp target enter data map(to: simulation::device_material_event_counts[:material_counts.size()])
+}
+
+void count_region_events(EventType type)
+{
+  if (!counting_region_costs()) return;
+
+  int n = event_queue_size(type);
+  int stride = settings::region_cost_stride;
+  int event = static_cast<int>(type);
+  int n_cells = n_cell_regions;
+  int n_materials = n_material_regions;
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n; i++) {
+    const EventQueueItem& item = event_queue(static_cast<EventType>(event))[i];
+    if (simulation::device_particles[item.idx].id_ % stride != 0) continue;
+    if (item.cell_id >= 0) {
+      #pragma omp atomic
+      simulation::device_cell_event_counts[event * n_cells + item.cell_id]++;
+    }
+    int material = particle_material(item.idx);
+    if (material == MATERIAL_VOID) material = n_materials - 1;
+    #pragma omp atomic
+    simulation::device_material_event_counts[event * n_materials + material]++;
+  }
+}
+
+void record_region_event_time(EventType type, double seconds)
+{
+  if (!counting_region_costs()) return;
+  event_seconds[static_cast<int>(type)] += seconds;
+}
+
+void write_region_costs()
+{
+  if (!counting_region_costs() || cell_counts.empty()) return;
+
+  #pragma omp target exit data map(from: simulation::device_cell_event_counts[:cell_counts.size()])
+  #pragma omp target exit data map(from: simulation::device_material_event_counts[:material_counts.size()])
+  simulation::device_cell_event_counts = nullptr;
+  simulation::device_material_event_counts = nullptr;
+
+  // The time of every process is shared out, so that shares are of the time
+  // of the whole run
+#ifdef OPENMC_MPI
+  void* cells_send = mpi::master ? MPI_IN_PLACE : cell_counts.data();
+  void* materials_send = mpi::master ? MPI_IN_PLACE : material_counts.data();
+  void* seconds_send = mpi::master ? MPI_IN_PLACE : event_seconds;
+  MPI_Reduce(cells_send, cell_counts.data(), cell_counts.size(), MPI_INT64_T,
+    MPI_SUM, 0, mpi::intracomm);
+  MPI_Reduce(materials_send, material_counts.data(), material_counts.size(),
+    MPI_INT64_T, MPI_SUM, 0, mpi::intracomm);
+  MPI_Reduce(seconds_send, event_seconds, N_EVENT_TYPES, MPI_DOUBLE, MPI_SUM,
+    0, mpi::intracomm);
+#endif
+
+  if (mpi::master) {
+    // Every sampled event is in exactly one material, but may be in no cell
+    int64_t type_events[N_EVENT_TYPES] {};
+    double total_seconds = 0.0;
+    for (int t = 0; t < N_EVENT_TYPES; ++t) {
+      for (int r = 0; r < n_material_regions; ++r) {
+        type_events[t] += material_counts[t * n_material_regions + r];
+      }
+      total_seconds += event_seconds[t];
+    }
+    auto cells = region_costs(cell_counts, n_cell_regions, type_events);
+    auto materials = region_costs(material_counts, n_material_regions,
+      type_events);
+
+    std::ofstream out {settings::path_region_costs};
+    if (!out) {
+      warning(fmt::format("Could not write region costs {}.",
+        settings::path_region_costs));
+    } else {
+      out << fmt::format("{{\n  \"stride\": {},\n  \"seconds\": {:.6e},\n"
+        "  \"cells\": [", settings::region_cost_stride, total_seconds);
+      write_costs(out, cells, true, total_seconds);
+      out << "\n  ],\n  \"materials\": [";
+      write_costs(out, materials, false, total_seconds);
+      out << "\n  ]\n}\n";
+      write_message(5, "Wrote region costs {}", settings::path_region_costs);
+    }
+
+    if (settings::verbosity >= 5) {
+      header("Event Costs by Region", 5);
+      print_costs("Cell", cells, true, total_seconds);
+      fmt::print("\n");
+      print_costs("Material", materials, false, total_seconds);
+    }
+  }
+
+  cell_counts.clear();
+  material_counts.clear();
+}
+
+} // namespace openmc
@@ -0,0 +1,161 @@
+#include "openmc/run_status.h"
+
+#include <algorithm> // for max, min
+#include <cstdint>
+#include <cstdio>    // for rename
+#include <ctime>
+#include <fstream>
+#include <string>
+
+#include <fmt/core.h>
+
+#include "openmc/eigenvalue.h"
+#include "openmc/error.h"
+#include "openmc/event_stats.h"
+#include "openmc/memory_registry.h"
+#include "openmc/message_passing.h"
+#include "openmc/output.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+#include "openmc/startup_profile.h"
+#include "openmc/tallies/tally.h"
+#include "openmc/tallies/trigger.h"
+#include "openmc/timer.h"
+
+namespace openmc {
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace {
+
+Timer run_timer;   // Since the simulation was initialized
+Timer batch_timer; // Since the status was last written
+double batch_seconds {0.0}; // Wall time of the last batch
+int first_batch;   // Batches before the first one this run transports
+
+//! Batches the run is expected to end after. With triggers, this is the
+//! prediction of check_triggers once the triggers are first checked.
+int expected_batches()
+{
+  int n = settings::n_batches;
+  if (settings::trigger_on && simulation::trigger_ratio > 1.0 &&
+      simulation::current_batch >= settings::n_batches) {
+    double r = simulation::trigger_ratio;
+    int n_active = simulation::current_batch - settings::n_inactive;
+    n = static_cast<int>(n_active * r * r) + settings::n_inactive + 1;
+    n = std::min(n, settings::n_max_batches);
+  }
+  return std::max(n, simulation::current_batch);
+}
+
+} // namespace
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+bool writing_run_status()
+{
+  return !settings::path_status.empty();
+}
+
+void init_run_status()
+{
+  if (!writing_run_status()) return;
+
+  first_batch = settings::restart_run ? simulation::restart_batch : 0;
+  batch_seconds = 0.0;
+  run_timer.reset();
+  run_timer.start();
+  batch_timer.reset();
+  batch_timer.start();
+}
+
+void write_run_status(bool finished)
+{
+  if (!writing_run_status()) return;
+
+  // The final status keeps the time of the last batch, not of finalization
+  if (!finished) {
+    batch_seconds = batch_timer.elapsed();
+    batch_timer.reset();
+    batch_timer.start();
+  }
+
+  // The largest memory use of any process
+  int64_t memory[] {host_resident_bytes(), memory_in_use(MemorySpace::host),
+    memory_in_use(MemorySpace::device)};
+#ifdef OPENMC_MPI
+  MPI_Reduce(mpi::master ? MPI_IN_PLACE : memory, memory, 3, MPI_INT64_T,
+    MPI_MAX, 0, mpi::intracomm);
+#endif
+  if (!mpi::master) return;
+
+  int batch = simulation::current_batch;
+  double elapsed = run_timer.elapsed();
+  int n_run = batch - first_batch;
+  double particles = static_cast<double>(settings::n_particles) *
+    settings::gen_per_batch;
+  int n_expected = expected_batches();
+  double eta = n_run > 0 && !finished ?
+    elapsed / n_run * (n_expected - batch) : 0.0;
+
+  std::string status = fmt::format("{{\n  \"state\": \"{}\",\n"
+    "  \"updated\": \"{}\",\n  \"updated_epoch\": {},\n"
+    "  \"batch\": {},\n  \"n_inactive\": {},\n  \"n_batches\": {},\n"
+    "  \"n_max_batches\": {},\n  \"expected_batches\": {},\n"
+    "  \"elapsed_seconds\": {:.3f},\n  \"eta_seconds\": {:.3f},\n"
+    "  \"batch_seconds\": {:.6e},\n  \"particles_per_second\": {:.6e},\n"
+    "  \"mean_particles_per_second\": {:.6e}",
+    finished ? "finished" : "running", time_stamp(),
+    static_cast<int64_t>(std::time(nullptr)), batch, settings::n_inactive,
+    settings::n_batches, settings::n_max_batches, n_expected, elapsed, eta,
+    batch_seconds, batch_seconds > 0.0 ? particles / batch_seconds : 0.0,
+    elapsed > 0.0 ? particles * n_run / elapsed : 0.0);
+
+  // Event counts are those of the last batch transported
+  const auto& history {simulation::event_stats_history};
+  if (!history.empty() && history.back().transport_seconds > 0.0) {
+    status += fmt::format(",\n  \"events_per_second\": {:.6e}",
+      history.back().total_events() / history.back().transport_seconds);
+  }
+
+  if (settings::run_mode == RunMode::EIGENVALUE &&
+      !simulation::k_generation.empty()) {
+    status += fmt::format(",\n  \"keff_generation\": {:.6f}",
+      simulation::k_generation.back());
+    if (simulation::n_realizations > 1) {
+      status += fmt::format(",\n  \"keff\": {:.6f},\n  \"keff_std_dev\": {:.6f}",
+        simulation::keff, simulation::keff_std);
+    }
+  }
+
+  if (settings::trigger_on) {
+    status += fmt::format(",\n  \"triggers_satisfied\": {},\n"
+      "  \"trigger_ratio\": {:.6e}", simulation::satisfy_triggers,
+      simulation::trigger_ratio);
+  }
+
+  status += fmt::format(",\n  \"host_resident_bytes\": {},\n"
+    "  \"host_recorded_bytes\": {},\n  \"device_bytes\": {}\n}}\n", memory[0],
+    memory[1], memory[2]);
+
+  // Readers never see a partly written file
+  std::string tmp = settings::path_status + ".tmp";
+  {
+    std::ofstream out {tmp};
+    out << status;
+    if (!out) {
+      warning(fmt::format("Could not write status file {}.", tmp));
+      return;
+    }
+  }
+  if (std::rename(tmp.c_str(), settings::path_status.c_str()) != 0) {
+    warning(fmt::format("Could not replace status file {}.",
+      settings::path_status));
+  }
+}
+
+} // namespace openmc
@@ -14,6 +14,7 @@
 #include "openmc/endf.h"
 #include "openmc/random_lcg.h"
 #include "openmc/search.h"
+#include "openmc/secondary_tables.h"
 
 namespace openmc {
 
@@ -268,8 +269,20 @@ void CorrelatedAngleEnergy::sample(double E_in, double& E_out, double& mu,
   }
 }
 
+void CorrelatedAngleEnergy::decode()
+{
+  handle_ = data::ae_tables.add(*this);
+}
+
 void CorrelatedAngleEnergy::serialize(DataBuffer& buffer) const
 {
+  // Decoded distributions are only referred to by their handle
+  if (handle_ != C_NONE) {
+    buffer.add(static_cast<int>(AngleEnergyType::DECODED_TABLE)); // 4
+    buffer.add(handle_);                                          // 4
+    return;
+  }
+
   buffer.add(static_cast<int>(AngleEnergyType::CORRELATED)); // 4
 
   // Determine size of buffer needed
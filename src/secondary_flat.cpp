@@ -3,6 +3,7 @@
 #include "openmc/secondary_correlated.h"
 #include "openmc/secondary_kalbach.h"
 #include "openmc/secondary_nbody.h"
+#include "openmc/secondary_tables.h"
 #include "openmc/secondary_thermal.h"
 #include "openmc/secondary_uncorrelated.h"
 
@@ -30,6 +31,10 @@ AngleEnergyFlat::sample(double E_in, double& E_out, double& mu, uint64_t* seed)
       dist.sample(E_in, E_out, mu, seed);
     }
     break;
+  case AngleEnergyType::DECODED_TABLE:
+    data::ae_tables.sample(*reinterpret_cast<const int*>(data_ + 4), E_in,
+      E_out, mu, seed);
+    break;
   case AngleEnergyType::NBODY:
     {
       NBodyPhaseSpaceFlat dist(data_);
@@ -81,7 +86,7 @@ AngleEnergyFlatContainer::AngleEnergyFlatContainer(const AngleEnergy& dist)
   size_t n = buffer_nbytes(dist);
 
   // Write into buffer
-  buffer_.reserve(n);
+  buffer_.reserve(n, "Flattened distributions");
   dist.serialize(buffer_);
   Ensures(n == buffer_.size());
 }
@@ -13,6 +13,7 @@
 #include "openmc/hdf5_interface.h"
 #include "openmc/random_lcg.h"
 #include "openmc/search.h"
+#include "openmc/secondary_tables.h"
 #include "openmc/serialize.h"
 
 namespace openmc {
@@ -240,8 +241,20 @@ void KalbachMann::sample(double E_in, double& E_out, double& mu, uint64_t* seed)
   }
 }
 
+void KalbachMann::decode()
+{
+  handle_ = data::ae_tables.add(*this);
+}
+
 void KalbachMann::serialize(DataBuffer& buffer) const
 {
+  // Decoded distributions are only referred to by their handle
+  if (handle_ != C_NONE) {
+    buffer.add(static_cast<int>(AngleEnergyType::DECODED_TABLE)); // 4
+    buffer.add(handle_);                                          // 4
+    return;
+  }
+
   buffer.add(static_cast<int>(AngleEnergyType::KALBACH_MANN)); // 4
 
   // Determine size of buffer needed
@@ -0,0 +1,426 @@
+#include "openmc/secondary_tables.h"
+
+#include <algorithm> // for max, upper_bound
+#include <cmath>     // for exp, log, sinh, sqrt
+#include <cstring>   // for memcpy
+
+#include "openmc/distribution.h"
+#include "openmc/random_lcg.h"
+#include "openmc/search.h"
+#include "openmc/secondary_correlated.h"
+#include "openmc/secondary_kalbach.h"
+#include "openmc/serialize.h"
+
+namespace openmc {
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace data {
+
+AngleEnergyTables ae_tables;
+
+} // namespace data
+
+//==============================================================================
+// AngleEnergyTables implementation
+//==============================================================================
+
+int AngleEnergyTables::add(const KalbachMann& dist)
+{
+  // Distributions are added by nuclides read on several threads
+  int handle;
+  #pragma omp critical(ae_tables)
+  {
+    handle = kalbach_.size();
+    kalbach_.push_back(true);
+    add_energies(dist.energy_);
+    for (const auto& d : dist.distribution_) {
+      add_table(d.n_discrete, d.interpolation, d.e_out, d.p, d.c, r_.size());
+      for (int k = 0; k < d.e_out.size(); ++k) {
+        r_.push_back(d.r[k]);
+        a_.push_back(d.a[k]);
+      }
+    }
+    energy_start_.push_back(energy_.size());
+  }
+  return handle;
+}
+
+int AngleEnergyTables::add(const CorrelatedAngleEnergy& dist)
+{
+  int handle;
+  #pragma omp critical(ae_tables)
+  {
+    handle = kalbach_.size();
+    kalbach_.push_back(false);
+    add_energies(dist.energy_);
+    for (const auto& d : dist.distribution_) {
+      add_table(d.n_discrete, d.interpolation, d.e_out, d.p, d.c,
+        angle_offset_.size());
+
+      // Angle distributions stay serialized, each aligned for its doubles
+      for (const auto& adist : d.angle) {
+        DataBuffer buffer;
+        buffer.reserve(buffer_nbytes(*adist), "Flattened distributions");
+        adist->serialize(buffer);
+        size_t offset = angle_data_.size();
+        angle_offset_.push_back(offset);
+        angle_data_.resize(offset + aligned(buffer.size(), 8), 0);
+        std::memcpy(angle_data_.data() + offset, buffer.data_, buffer.size());
+      }
+    }
+    energy_start_.push_back(energy_.size());
+  }
+  return handle;
+}
+
+void AngleEnergyTables::add_energies(const std::vector<double>& energy)
+{
+  if (energy_start_.size() == 0) {
+    energy_start_.push_back(0);
+    hash_start_.push_back(0);
+  }
+  for (double E : energy) energy_.push_back(E);
+
+  // Only grids long enough to outweigh the logarithm are hashed
+  size_t n = energy.size();
+  double log_E0 = 0.0;
+  double inv_spacing = 0.0;
+  if (n >= SECONDARY_HASH_MIN_ENERGIES && energy.front() > 0.0 &&
+      energy.back() > energy.front()) {
+    for (int b : log_hash_start(energy.data(), n, n, log_E0, inv_spacing)) {
+      hash_.push_back(b);
+    }
+  }
+  log_E0_.push_back(log_E0);
+  inv_spacing_.push_back(inv_spacing);
+  hash_start_.push_back(hash_.size());
+}
+
+void AngleEnergyTables::add_table(int n_discrete, Interpolation interpolation,
+  const xt::xtensor<double, 1>& e_out, const xt::xtensor<double, 1>& p,
+  const xt::xtensor<double, 1>& c, int extra)
+{
+  int n = e_out.size();
+  eout_start_.push_back(e_out_.size());
+  n_eout_.push_back(n);
+  n_discrete_.push_back(n_discrete);
+  interpolation_.push_back(interpolation);
+  e_first_.push_back(n > n_discrete ? e_out[n_discrete] : 0.0);
+  e_last_.push_back(n > 0 ? e_out[n - 1] : 0.0);
+  extra_start_.push_back(extra);
+  for (int k = 0; k < n; ++k) {
+    e_out_.push_back(e_out[k]);
+    p_.push_back(p[k]);
+    c_.push_back(c[k]);
+  }
+}
+
+void AngleEnergyTables::sample(int handle, double E_in, double& E_out,
+  double& mu, uint64_t* seed) const
+{
+  // Before the secondary distribution refactor, an isotropic polar cosine was
+  // always sampled but then overwritten with the polar cosine sampled from the
+  // correlated distribution. It is kept to preserve the random number stream.
+  mu = 2.0*prn(seed) - 1.0;
+
+  // Find energy bin and calculate interpolation factor -- if the energy is
+  // outside the range of the tabulated energies, choose the first or last bins
+  int first = energy_start_[handle];
+  int n_energy_in = energy_start_[handle + 1] - first;
+  const double* energy = &energy_[first];
+  int i;
+  double r;
+  if (E_in < energy[0]) {
+    i = 0;
+    r = 0.0;
+  } else if (E_in > energy[n_energy_in - 1]) {
+    i = n_energy_in - 2;
+    r = 1.0;
+  } else {
+    int n_hash = hash_start_[handle + 1] - hash_start_[handle] - 1;
+    if (n_hash > 0) {
+      i = hashed_lower_bound_index(energy, n_energy_in,
+        &hash_[hash_start_[handle]], n_hash, log_E0_[handle],
+        inv_spacing_[handle], E_in);
+    } else {
+      i = lower_bound_index(energy, energy + n_energy_in, E_in);
+    }
+    r = (E_in - energy[i]) / (energy[i+1] - energy[i]);
+  }
+
+  // Sample between the ith and [i+1]th bin
+  int l = r > prn(seed) ? i + 1 : i;
+
+  // Interpolation for energy E1 and EK
+  int t_i = first + i;
+  double E_i_1 = e_first_[t_i];
+  double E_i_K = e_last_[t_i];
+  double E_i1_1 = e_first_[t_i + 1];
+  double E_i1_K = e_last_[t_i + 1];
+  double E_1 = E_i_1 + r*(E_i1_1 - E_i_1);
+  double E_K = E_i_K + r*(E_i1_K - E_i_K);
+
+  // Determine outgoing energy bin
+  int t_l = first + l;
+  const double* e_out = &e_out_[eout_start_[t_l]];
+  const double* pdf = &p_[eout_start_[t_l]];
+  const double* cdf = &c_[eout_start_[t_l]];
+  int n_energy_out = n_eout_[t_l];
+  int n_discrete = n_discrete_[t_l];
+  double r1 = prn(seed);
+  double c_k = cdf[0];
+  int k = 0;
+  int end = n_energy_out - 2;
+
+  // Discrete portion
+  for (int j = 0; j < n_discrete; ++j) {
+    k = j;
+    c_k = cdf[k];
+    if (r1 < c_k) {
+      end = j;
+      break;
+    }
+  }
+
+  // Continuous portion, as the linear scan of the flat distributions would
+  // find it: the first point past the discrete lines whose CDF exceeds r1
+  double c_k1 = c_k;
+  if (n_discrete < end) {
+    int m = std::upper_bound(cdf + n_discrete + 1, cdf + end + 1, r1) - cdf;
+    if (m <= end) {
+      k = m - 1;
+      if (k > n_discrete) c_k = cdf[k];
+      c_k1 = cdf[m];
+    } else {
+      k = end;
+      c_k = cdf[end];
+      c_k1 = c_k;
+    }
+  }
+
+  double E_l_k = e_out[k];
+  double p_l_k = pdf[k];
+  int extra = extra_start_[t_l];
+  Interpolation interp = interpolation_[t_l];
+  E_out = E_l_k;
+  if (kalbach_[handle]) {
+    const double* km_r = &r_[extra];
+    const double* km_a = &a_[extra];
+    double R, A;
+    if (interp == Interpolation::histogram) {
+      // Histogram interpolation
+      if (p_l_k > 0.0 && k >= n_discrete) {
+        E_out = E_l_k + (r1 - c_k)/p_l_k;
+      }
+      R = km_r[k];
+      A = km_a[k];
+
+    } else {
+      // Linear-linear interpolation
+      double E_l_k1 = e_out[k+1];
+      double p_l_k1 = pdf[k+1];
+
+      double frac = (p_l_k1 - p_l_k)/(E_l_k1 - E_l_k);
+      if (frac == 0.0) {
+        E_out = E_l_k + (r1 - c_k)/p_l_k;
+      } else {
+        E_out = E_l_k + (std::sqrt(std::max(0.0, p_l_k*p_l_k +
+                          2.0*frac*(r1 - c_k))) - p_l_k)/frac;
+      }
+      R = km_r[k] + (E_out - E_l_k)/(E_l_k1 - E_l_k) * (km_r[k+1] - km_r[k]);
+      A = km_a[k] + (E_out - E_l_k)/(E_l_k1 - E_l_k) * (km_a[k+1] - km_a[k]);
+    }
+
+    // Now interpolate between incident energy bins i and i + 1
+    if (k >= n_discrete) {
+      if (l == i) {
+        E_out = E_1 + (E_out - E_i_1)*(E_K - E_1)/(E_i_K - E_i_1);
+      } else {
+        E_out = E_1 + (E_out - E_i1_1)*(E_K - E_1)/(E_i1_K - E_i1_1);
+      }
+    }
+
+    // Sampled correlated angle from Kalbach-Mann parameters
+    if (prn(seed) > R) {
+      double T = (2.0*prn(seed) - 1.0) * std::sinh(A);
+      mu = std::log(T + std::sqrt(T*T + 1.0))/A;
+    } else {
+      double r2 = prn(seed);
+      mu = std::log(r2*std::exp(A) + (1.0 - r2)*std::exp(-A))/A;
+    }
+
+  } else {
+    if (interp == Interpolation::histogram) {
+      // Histogram interpolation
+      if (p_l_k > 0.0 && k >= n_discrete) {
+        E_out = E_l_k + (r1 - c_k)/p_l_k;
+      }
+
+    } else if (interp == Interpolation::lin_lin) {
+      // Linear-linear interpolation
+      double E_l_k1 = e_out[k+1];
+      double p_l_k1 = pdf[k+1];
+
+      double frac = (p_l_k1 - p_l_k)/(E_l_k1 - E_l_k);
+      if (frac == 0.0) {
+        E_out = E_l_k + (r1 - c_k)/p_l_k;
+      } else {
+        E_out = E_l_k + (std::sqrt(std::max(0.0, p_l_k*p_l_k +
+                          2.0*frac*(r1 - c_k))) - p_l_k)/frac;
+      }
+    }
+
+    // Now interpolate between incident energy bins i and i + 1
+    if (k >= n_discrete) {
+      if (l == i) {
+        E_out = E_1 + (E_out - E_i_1)*(E_K - E_1)/(E_i_K - E_i_1);
+      } else {
+        E_out = E_1 + (E_out - E_i1_1)*(E_K - E_1)/(E_i1_K - E_i1_1);
+      }
+    }
+
+    // Find correlated angular distribution for closest outgoing energy bin
+    int k_mu = r1 - c_k < c_k1 - r1 ? k : k + 1;
+    TabularFlat angle(&angle_data_[angle_offset_[extra + k_mu]]);
+    mu = angle.sample(seed);
+  }
+}
+
+void AngleEnergyTables::copy_to_device()
+{
+  energy_start_.copy_to_device();
+  kalbach_.copy_to_device();
+  hash_start_.copy_to_device();
+  log_E0_.copy_to_device();
+  inv_spacing_.copy_to_device();
+  hash_.copy_to_device();
+  energy_.copy_to_device();
+  eout_start_.copy_to_device();
+  n_eout_.copy_to_device();
+  n_discrete_.copy_to_device();
+  interpolation_.copy_to_device();
+  e_first_.copy_to_device();
+  e_last_.copy_to_device();
+  extra_start_.copy_to_device();
+  e_out_.copy_to_device();
+  p_.copy_to_device();
+  c_.copy_to_device();
+  r_.copy_to_device();
+  a_.copy_to_device();
+  angle_offset_.copy_to_device();
+  angle_data_.copy_to_device();
+}
+
+void AngleEnergyTables::release_device()
+{
+  energy_start_.release_device();
+  kalbach_.release_device();
+  hash_start_.release_device();
+  log_E0_.release_device();
+  inv_spacing_.release_device();
+  hash_.release_device();
+  energy_.release_device();
+  eout_start_.release_device();
+  n_eout_.release_device();
+  n_discrete_.release_device();
+  interpolation_.release_device();
+  e_first_.release_device();
+  e_last_.release_device();
+  extra_start_.release_device();
+  e_out_.release_device();
+  p_.release_device();
+  c_.release_device();
+  r_.release_device();
+  a_.release_device();
+  angle_offset_.release_device();
+  angle_data_.release_device();
+}
+
+void AngleEnergyTables::clear()
+{
+  energy_start_.clear();
+  kalbach_.clear();
+  hash_start_.clear();
+  log_E0_.clear();
+  inv_spacing_.clear();
+  hash_.clear();
+  energy_.clear();
+  eout_start_.clear();
+  n_eout_.clear();
+  n_discrete_.clear();
+  interpolation_.clear();
+  e_first_.clear();
+  e_last_.clear();
+  extra_start_.clear();
+  e_out_.clear();
+  p_.clear();
+  c_.clear();
+  r_.clear();
+  a_.clear();
+  angle_offset_.clear();
+  angle_data_.clear();
+}
+
+void AngleEnergyTables::write_cache(XsCacheWriter& cache) const
+{
+  cache.write(energy_start_);
+  cache.write(kalbach_);
+  cache.write(hash_start_);
+  cache.write(log_E0_);
+  cache.write(inv_spacing_);
+  cache.write(hash_);
+  cache.write(energy_);
+  cache.write(eout_start_);
+  cache.write(n_eout_);
+  cache.write(n_discrete_);
+  cache.write(interpolation_);
+  cache.write(e_first_);
+  cache.write(e_last_);
+  cache.write(extra_start_);
+  cache.write(e_out_);
+  cache.write(p_);
+  cache.write(c_);
+  cache.write(r_);
+  cache.write(a_);
+  cache.write(angle_offset_);
+  cache.write(angle_data_);
+}
+
+void AngleEnergyTables::read_cache(XsCacheReader& cache)
+{
+  cache.read(energy_start_);
+  cache.read(kalbach_);
+  cache.read(hash_start_);
+  cache.read(log_E0_);
+  cache.read(inv_spacing_);
+  cache.read(hash_);
+  cache.read(energy_);
+  cache.read(eout_start_);
+  cache.read(n_eout_);
+  cache.read(n_discrete_);
+  cache.read(interpolation_);
+  cache.read(e_first_);
+  cache.read(e_last_);
+  cache.read(extra_start_);
+  cache.read(e_out_);
+  cache.read(p_);
+  cache.read(c_);
+  cache.read(r_);
+  cache.read(a_);
+  cache.read(angle_offset_);
+  cache.read(angle_data_);
+}
+
+size_t AngleEnergyTables::nbytes() const
+{
+  return kalbach_.size() * (1 + 2*sizeof(int) + 2*sizeof(double)) +
+    hash_.size() * sizeof(int) +
+    energy_.size() * (3*sizeof(double) + 4*sizeof(int) + sizeof(Interpolation)) +
+    e_out_.size() * 3*sizeof(double) + r_.size() * 2*sizeof(double) +
+    angle_offset_.size() * sizeof(int64_t) + angle_data_.size();
+}
+
+} // namespace openmc
@@ -3,6 +3,8 @@
 #include <algorithm> // for copy
 #include <cstring> // for memcpy
 
+#include "openmc/memory_registry.h"
+
 namespace openmc {
 
 DataBuffer::DataBuffer(size_t n)
@@ -13,7 +15,7 @@ DataBuffer::DataBuffer(size_t n)
 
 DataBuffer::DataBuffer(const DataBuffer& buffer)
 {
-  this->reserve(buffer.capacity_);
+  this->reserve(buffer.capacity_, buffer.category_);
   std::copy(buffer.data_, buffer.data_ + buffer.capacity_, data_);
   offset_ = buffer.offset_;
   mode_ = buffer.mode_;
@@ -21,15 +23,23 @@ DataBuffer::DataBuffer(const DataBuffer& buffer)
 
 DataBuffer::~DataBuffer()
 {
-  if (data_) delete[] data_;
+  if (data_) {
+    record_memory(category_, MemorySpace::host, -static_cast<int64_t>(capacity_));
+    delete[] data_;
+  }
 }
 
-void DataBuffer::reserve(size_t n)
+void DataBuffer::reserve(size_t n, const char* category)
 {
-  if (data_) delete[] data_;
+  if (data_) {
+    record_memory(category_, MemorySpace::host, -static_cast<int64_t>(capacity_));
+    delete[] data_;
+  }
   data_ = new uint8_t[n];
   capacity_ = n;
   offset_ = 0;
+  category_ = category;
+  record_memory(category_, MemorySpace::host, n);
 }
 
 void DataBuffer::align(int n)
@@ -42,11 +52,13 @@ void DataBuffer::align(int n)
 void DataBuffer::copy_to_device() const
 {
   #pragma omp target enter data map(to: data_[:offset_])
+  record_memory(category_, MemorySpace::device, offset_);
 }
 
 void DataBuffer::release_device() const
 {
   #pragma omp target exit data map(release: data_[:offset_])
+  record_memory(category_, MemorySpace::device, -static_cast<int64_t>(offset_));
 }
 
 } // end namespace openmc
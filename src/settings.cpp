@@ -27,6 +27,7 @@
 #include "openmc/string_utils.h"
 #include "openmc/tallies/trigger.h"
 #include "openmc/volume_calc.h"
+#include "openmc/weight_windows.h"
 #include "openmc/xml_interface.h"
 
 namespace openmc {
@@ -61,6 +62,7 @@ bool source_latest           {false};
 bool source_separate         {false};
 bool source_write            {true};
 bool surf_source_write       {false};
+bool surf_source_per_rank    {false};
 bool surf_source_read        {false};
 bool survival_biasing        {false};
 bool temperature_multipole   {false};
@@ -68,6 +70,8 @@ bool trigger_on              {false};
 bool trigger_predict         {false};
 bool ufs_on                  {false};
 bool urr_ptables_on          {true};
+bool urr_fast_sampling       {false};
+bool weight_windows_on       {false};
 bool write_all_tracks        {false};
 bool write_initial_source    {false};
 
@@ -76,28 +80,119 @@ std::string path_input;
 std::string path_output;
 std::string path_particle_restart;
 std::string path_sourcepoint;
+std::string path_event_stats;
+std::string path_region_costs;
+std::string path_startup_profile;
+std::string path_status;
 std::string path_statepoint;
+std::string path_xs_cache;
 
 int32_t n_inactive {0};
 int32_t max_lost_particles {10};
 double rel_max_lost_particles {1.0e-6};
+int lost_check_interval {1000};
 int32_t gen_per_batch {1};
 int64_t n_particles {-1};
 
 int64_t max_particles_in_flight {-1};
+bool auto_particles_in_flight {false};
+double device_memory {0.0};
+double device_memory_headroom {0.1};
 double fuel_lookup_bias {2.0};
+EventScheduler event_scheduler {EventScheduler::longest_queue};
+int max_revival_period {100};
+int64_t event_tail_threshold {0};
+bool auto_tune {false};
+bool fuse_advance_tally {false};
+bool cpu_event_kernels {true};
+bool aggregate_queue_appends {false};
 
 bool sort_fissionable_xs_lookups {true};
 bool sort_non_fissionable_xs_lookups {true};
 bool sort_surface_crossing {true};
-#if defined(CUDA_THRUST_SORT) || defined(SYCL_SORT)
+bool sort_surface_position {false};
+bool sort_advance_position {false};
 bool sort_on_device {true};
-#else
-bool sort_on_device {false};
-#endif
+bool bucket_xs_queues {false};
+bool async_event_kernels {false};
+bool split_collisions {false};
+int n_material_xs_queues {0};
+bool sort_key_index {true};
+double sort_skip_fraction {0.0};
+double compact_threshold {0.0};
+bool material_xs_tables {false};
+int material_xs_table_points {100000};
+double material_xs_table_tolerance {1.0e-3};
+bool wmp_batch_lookups {false};
+int wmp_batch_items {16384};
+bool particle_soa {false};
+bool device_arena {false};
+bool pinned_banks {false};
+bool device_fission_bank {false};
+bool packed_bank {false};
+int tally_replicas {0};
+int64_t max_replicated_tally_bins {65536};
+int deferred_tally_scores {0};
+double sparse_tally_fraction {0.0};
+int64_t min_sparse_tally_bins {1 << 20};
+bool device_tally_accumulate {false};
+bool async_tally_reduction {false};
+int64_t tally_reduce_chunk {1 << 22};
+int tally_reduce_group {1};
+int64_t min_distributed_tally_bins {0};
+bool tally_stats {false};
+bool collapse_tallies {false};
+bool async_statepoint {false};
+int hdf5_compression {0};
+int64_t hdf5_chunk_size {1 << 20};
+int checkpoint_interval {0};
+int64_t checkpoint_particles {0};
+int checkpoint_stop {0};
+int track_buffer_size {1 << 20};
+int event_trace_stride {0};
+int region_cost_stride {16};
+SummaryFormat summary_format {SummaryFormat::full};
+bool kernel_profile {false};
+bool event_stats {false};
+int64_t xs_benchmark_lookups {0};
+int64_t collision_benchmark_samples {0};
+bool delta_tracking {false};
+bool temperature_tms {false};
+std::vector<int32_t> delta_tracking_cells;
+int majorant_points {10000};
+bool plane_cache {false};
+bool fast_reflection {false};
+bool nuclide_cdf {false};
+bool inelastic_cdf {false};
+bool decoded_distributions {false};
+bool fission_spectrum_table {false};
+bool validate_fission_spectrum {false};
+int compton_table_quantiles {0};
+bool optimize_geometry {false};
+bool device_volume_calc {false};
+bool device_find_cells {false};
+bool device_source {false};
+bool async_bank_exchange {false};
+bool fission_matrix_on {false};
+bool random_ray {false};
+double random_ray_distance_active {0.0};
+double random_ray_distance_inactive {0.0};
+bool local_generations {false};
+bool hybrid_transport {false};
+int interleaved_histories {1};
+bool persistent_history {false};
+bool mg_alias_sampling {false};
+double max_work_ratio {0.0};
+int64_t source_block_sites {0};
+bool find_overlaps {false};
+int64_t overlap_samples {10000000};
+int overlap_limit {10};
+bool device_overlaps {false};
+int32_t domain_mesh {C_NONE};
 
 ElectronTreatment electron_treatment {ElectronTreatment::TTB};
 std::array<double, 4> energy_cutoff {0.0, 1000.0, 0.0, 0.0};
+std::array<double, 4> time_cutoff {INFTY, INFTY, INFTY, INFTY};
 int legendre_to_tabular_points {C_NONE};
 int max_order {0};
 int n_log_bins {-1};
@@ -112,7 +207,21 @@ std::unordered_set<int> sourcepoint_batch;
 std::unordered_set<int> statepoint_batch;
 std::unordered_set<int> source_write_surf_id;
 int64_t max_surface_particles;
+int64_t secondary_pool_size {-1};
+double fission_bank_margin {0.25};
+int nu_bank_size {16};
+double max_split_growth {1.0};
 TemperatureMethod temperature_method {TemperatureMethod::NEAREST};
+EnergyGridMethod energy_grid_method {EnergyGridMethod::logarithm};
+FaddeevaMethod faddeeva_method {FaddeevaMethod::scalar};
+int union_grid_stride {1};
+bool pretabulate_temperatures {false};
+bool shared_xs {false};
+bool prune_nuclear_data {false};
+double device_xs_budget {0.0};
+int device_id {-1};
+bool bind_devices {false};
+bool keep_device_data {false};
 double temperature_tolerance {10.0};
 double temperature_default {293.6};
 std::array<double, 2> temperature_range {0.0, 0.0};
@@ -152,8 +261,14 @@ void get_run_parameters(pugi::xml_node node_base)
   // set by the user anywhere, set it to a reasonable default value.
   if (max_particles_in_flight == -1) {
     if (check_for_node(node_base, "max_particles_in_flight")) {
-      max_particles_in_flight = std::stoll(get_node_value(node_base,
-        "max_particles_in_flight"));
+      auto value = get_node_value(node_base, "max_particles_in_flight");
+      if (value == "auto") {
+        // Replaced once the free device memory is known
+        auto_particles_in_flight = true;
+        max_particles_in_flight = 1000000;
+      } else {
+        max_particles_in_flight = std::stoll(value);
+      }
     } else {
       max_particles_in_flight = 1000000;
     }
@@ -530,6 +645,18 @@ void read_settings_xml()
     if (check_for_node(node_cutoff, "energy_positron")) {
       energy_cutoff[3] = std::stod(get_node_value(node_cutoff, "energy_positron"));
     }
+    if (check_for_node(node_cutoff, "time_neutron")) {
+      time_cutoff[0] = std::stod(get_node_value(node_cutoff, "time_neutron"));
+    }
+    if (check_for_node(node_cutoff, "time_photon")) {
+      time_cutoff[1] = std::stod(get_node_value(node_cutoff, "time_photon"));
+    }
+    if (check_for_node(node_cutoff, "time_electron")) {
+      time_cutoff[2] = std::stod(get_node_value(node_cutoff, "time_electron"));
+    }
+    if (check_for_node(node_cutoff, "time_positron")) {
+      time_cutoff[3] = std::stod(get_node_value(node_cutoff, "time_positron"));
+    }
   }
 
   // Particle trace
@@ -565,6 +692,9 @@ void read_settings_xml()
   // Read meshes
   read_meshes(root);
 
+  // Weight windows on those meshes
+  read_weight_windows(root);
+
   // Shannon Entropy mesh
   if (check_for_node(root, "entropy_mesh")) {
     int temp = std::stoi(get_node_value(root, "entropy_mesh"));
@@ -608,6 +738,16 @@ void read_settings_xml()
       "it by specifying its ID in a <ufs_mesh> element.");
   }
 
+  // Mesh whose bins are divided into the domains owned by each process
+  if (check_for_node(root, "domain_mesh")) {
+    auto temp = std::stoi(get_node_value(root, "domain_mesh"));
+    if (model::mesh_map.find(temp) == model::mesh_map.end()) {
+      fatal_error(fmt::format("Mesh {} specified for domain decomposition "
+        "does not exist.", temp));
+    }
+    domain_mesh = model::mesh_map.at(temp);
+  }
+
   // Check if the user has specified to write state points
   if (check_for_node(root, "state_point")) {
 
@@ -805,6 +945,9 @@ void read_settings_xml()
   if (check_for_node(root, "temperature_multipole")) {
     temperature_multipole = get_node_value_bool(root, "temperature_multipole");
   }
+  if (check_for_node(root, "temperature_tms")) {
+    temperature_tms = get_node_value_bool(root, "temperature_tms");
+  }
   if (check_for_node(root, "temperature_range")) {
     auto range = get_node_array<double>(root, "temperature_range");
     temperature_range[0] = range.at(0);
@@ -853,6 +996,40 @@ void read_settings_xml()
   if (check_for_node(root, "material_cell_offsets")) {
     material_cell_offsets = get_node_value_bool(root, "material_cell_offsets");
   }
+
+  // Cells whose contents are delta-tracked
+  if (check_for_node(root, "delta_tracking_cells")) {
+    delta_tracking_cells = get_node_array<int32_t>(root, "delta_tracking_cells");
+    delta_tracking = !delta_tracking_cells.empty();
+  }
+
+  // Random ray solver. Its flat source regions are the instances of the
+  // material cells, which need the cell offsets to be told apart.
+  if (check_for_node(root, "random_ray")) {
+    xml_node node_ray = root.child("random_ray");
+    random_ray = true;
+    if (!check_for_node(node_ray, "distance_active")) {
+      fatal_error("<distance_active> must be specified with <random_ray>.");
+    }
+    random_ray_distance_active = std::stod(get_node_value(node_ray,
+      "distance_active"));
+    if (random_ray_distance_active <= 0.0) {
+      fatal_error("Random ray active distance must be positive.");
+    }
+    if (check_for_node(node_ray, "distance_inactive")) {
+      random_ray_distance_inactive = std::stod(get_node_value(node_ray,
+        "distance_inactive"));
+      if (random_ray_distance_inactive < 0.0) {
+        fatal_error("Random ray inactive distance must be non-negative.");
+      }
+    }
+    // Flat source regions are numbered by the material cell offsets
+    if (check_for_node(root, "material_cell_offsets") &&
+        !material_cell_offsets) {
+      fatal_error("The random ray solver needs material cell offsets.");
+    }
+    material_cell_offsets = true;
+  }
 }
 
 void free_memory_settings() {
@@ -860,6 +1037,7 @@ void free_memory_settings() {
   settings::sourcepoint_batch.clear();
   settings::source_write_surf_id.clear();
   settings::res_scat_nuclides.clear();
+  settings::delta_tracking_cells.clear();
 }
 
 //==============================================================================
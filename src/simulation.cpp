@@ -5,20 +5,29 @@
 #include "openmc/cell.h"
 #include "openmc/container_util.h"
 #include "openmc/device_alloc.h"
+#include "openmc/domain_decomposition.h"
 #include "openmc/eigenvalue.h"
 #include "openmc/error.h"
 #include "openmc/event.h"
+#include "openmc/event_stats.h"
+#include "openmc/event_trace.h"
+#include "openmc/event_tuning.h"
 #include "openmc/geometry_aux.h"
+#include "openmc/kernel_profile.h"
 #include "openmc/lattice.h"
 #include "openmc/material.h"
+#include "openmc/memory_registry.h"
 #include "openmc/message_passing.h"
 #include "openmc/nuclide.h"
 #include "openmc/output.h"
 #include "openmc/particle.h"
 #include "openmc/photon.h"
 #include "openmc/random_lcg.h"
+#include "openmc/region_costs.h"
+#include "openmc/run_status.h"
 #include "openmc/settings.h"
 #include "openmc/source.h"
+#include "openmc/startup_profile.h"
 #include "openmc/state_point.h"
 #include "openmc/timer.h"
 #include "openmc/tallies/derivative.h"
@@ -26,6 +35,7 @@
 #include "openmc/tallies/tally.h"
 #include "openmc/tallies/trigger.h"
 #include "openmc/track_output.h"
+#include "openmc/weight_windows.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -41,11 +51,20 @@
 #include <algorithm>
 #include <cmath>
 #include <string>
+#include <thread>
 
 #ifndef DEVICE_PRINTF
 #define printf(fmt, ...) (0)
 #endif
 
+namespace {
+
+// Inactive batches that the current simulation skips by starting from the
+// source left by the last one
+int n_inactive_skipped {0};
+
+} // namespace
+
 //==============================================================================
 // C API functions
 //==============================================================================
@@ -77,6 +96,10 @@ int openmc_simulation_init()
   // Skip if simulation has already been initialized
   if (simulation::initialized) return 0;
 
+  // Sites left by the last simulation can only be reused if this process
+  // holds as many particles again
+  int64_t n_sites = simulation::source_bank.size();
+
   // Initialize nuclear data (energy limits, log grid)
   if (settings::run_CE) {
     initialize_data();
@@ -85,34 +108,44 @@ int openmc_simulation_init()
   // Determine how much work each process should do
   calculate_work();
 
-  // Allocate source, fission and surface source banks.
-  allocate_banks();
-
-  // If doing an event-based simulation, intialize the particle buffer
-  // and event queues
-  if (settings::event_based) {
-    int64_t event_buffer_length = std::min(simulation::work_per_rank,
-      settings::max_particles_in_flight);
-    init_event_queues(event_buffer_length);
-
-    // Allocate particle buffer on device
-    if (mpi::master) {
-      std::cout << " Moving particle buffer to device of size: " << simulation::particles.size() * sizeof(Particle) /1.0e6 << " MB. Particle size = " << sizeof(Particle) / 1.0e3 << " KB" << std::endl;
+  // Start from the sites left by the last simulation if every process holds
+  // as many particles again, running fewer inactive batches if requested
+  bool reuse = settings::run_mode == RunMode::EIGENVALUE &&
+    simulation::reuse_source && !settings::restart_run;
+  if (reuse) {
+    reuse = n_sites == simulation::work_per_rank;
+#ifdef OPENMC_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &reuse, 1, MPI_CXX_BOOL, MPI_LAND,
+      mpi::intracomm);
+#endif
+    if (!reuse) {
+      if (mpi::master) warning("The source left by the last simulation does "
+        "not match the number of particles; sampling a new source.");
+    } else if (simulation::reuse_n_inactive >= 0 &&
+        simulation::reuse_n_inactive < settings::n_inactive) {
+      n_inactive_skipped = settings::n_inactive - simulation::reuse_n_inactive;
+      settings::n_inactive -= n_inactive_skipped;
+      settings::n_batches -= n_inactive_skipped;
+      settings::n_max_batches -= n_inactive_skipped;
     }
-    simulation::device_particles = simulation::particles.data();
-    #pragma omp target enter data map(to: simulation::device_particles[:event_buffer_length])
   }
 
+  // Allocate source, fission and surface source banks.
+  allocate_banks();
 
   // Allocate tally results arrays if they're not allocated yet
   for (int i = 0; i < model::tallies_size; ++i) {
     model::tallies[i].init_results();
   }
 
-  // Set up material nuclide index mapping
+  // Determine the depletion reactions whose XS are looked up with the macro XS
+  init_depletion_rx();
+
+  // Set up material nuclide bitmaps
   for (int i = 0; i < model::materials_size; i++) {
     auto& mat = model::materials[i];
     mat.init_nuclide_index();
+    mat.init_xs_features();
   }
 
   // Reset global variables -- this is done before loading state point (as that
@@ -120,10 +153,114 @@ int openmc_simulation_init()
   simulation::current_batch = 0;
   simulation::k_generation.clear();
   simulation::entropy.clear();
+  simulation::fission_matrix.clear();
+  simulation::fission_matrix_source.clear();
   openmc_reset();
 
+  // Resolve the meshes and tallies that weight windows refer to
+  init_weight_windows();
+
   // Allocate & Copy simulation data from host -> device
+  begin_phase("Moving data to device");
   move_read_only_data_to_device();
+  end_phase();
+  write_startup_profile();
+
+  // Allocate the track buffer once the settings it reads are on device
+  init_track_output();
+  init_run_status();
+
+  // Report the device memory needed per in-flight particle and, if requested,
+  // size the particle buffer to fit in the memory left by the read-only data
+  if (settings::event_based) {
+    size_t per_particle = event_bytes_per_particle(mpi::master);
+    if (settings::auto_particles_in_flight) {
+      size_t free_bytes = free_device_memory();
+      if (free_bytes == 0) {
+        warning("Free device memory could not be determined; using " +
+          std::to_string(settings::max_particles_in_flight) + " particles in "
+          "flight. Set the device memory with --device-memory.");
+      } else {
+        double usable = free_bytes * (1.0 - settings::device_memory_headroom);
+        settings::max_particles_in_flight = std::max<int64_t>(1,
+          static_cast<int64_t>(usable / per_particle));
+        #pragma omp target update to(settings::max_particles_in_flight)
+        if (mpi::master) {
+          std::cout << " Free device memory: " << free_bytes * 1.0e-6 << " MB. "
+            "Fitting up to " << settings::max_particles_in_flight << " particles "
+            "in flight with " << settings::device_memory_headroom * 100.0 <<
+            "% headroom" << std::endl;
+        }
+      }
+    }
+  }
+
+  // If doing an event-based simulation, intialize the particle buffer
+  // and event queues
+  if (settings::event_based) {
+    // Particles handed over from other domains may outnumber those of this
+    // process
+    int64_t event_buffer_length = domain_decomposed() && mpi::n_procs > 1 ?
+      settings::max_particles_in_flight : std::min(simulation::max_work_per_rank,
+      settings::max_particles_in_flight);
+    init_event_queues(event_buffer_length);
+    init_domain_decomposition(event_buffer_length);
+    init_event_trace(event_buffer_length);
+    start_kernel_profile();
+    simulation::event_stats_history.clear();
+    simulation::event_cost_model.reset();
+    init_region_costs();
+
+    // Allocate particle buffer on device
+    if (mpi::master) {
+      std::cout << " Moving particle buffer to device of size: " << simulation::particles.size() * sizeof(Particle) /1.0e6 << " MB. Particle size = " << sizeof(Particle) / 1.0e3 << " KB" << std::endl;
+    }
+    simulation::device_particles = simulation::particles.data();
+    #pragma omp target enter data map(to: simulation::device_particles[:event_buffer_length])
+    record_memory("Particle buffer", MemorySpace::device,
+      event_buffer_length * sizeof(Particle));
+
+    // Give each particle in the buffer its own slot of the micro XS cache pool
+    reserve_micro_xs_pool(event_buffer_length);
+    reserve_flux_derivs_pool(event_buffer_length);
+    reserve_nuclide_cdf_pool(event_buffer_length);
+    reserve_depletion_rx_pool(event_buffer_length);
+    reserve_photon_xs_pool(event_buffer_length);
+    reserve_nu_bank_pool(event_buffer_length);
+    #pragma omp target teams distribute parallel for
+    for (int64_t i = 0; i < event_buffer_length; i++) {
+      simulation::device_particles[i].neutron_xs_.assign(i);
+      simulation::device_particles[i].assign_flux_derivs(i);
+      simulation::device_particles[i].assign_nuclide_cdf(i);
+      simulation::device_particles[i].assign_depletion_rx(i);
+      simulation::device_particles[i].assign_photon_xs(i);
+      simulation::device_particles[i].assign_nu_bank(i);
+    }
+  } else {
+    #ifdef DEVICE_HISTORY
+    int n_slots = std::min(simulation::max_work_per_rank,
+      settings::max_particles_in_flight);
+    #else
+    // Each thread keeps its interleaved histories in separate slots
+    int n_slots = omp_get_max_threads() * settings::interleaved_histories;
+    #endif
+    reserve_micro_xs_pool(n_slots);
+    reserve_flux_derivs_pool(n_slots);
+    reserve_nuclide_cdf_pool(n_slots);
+    reserve_depletion_rx_pool(n_slots);
+    reserve_photon_xs_pool(n_slots);
+    reserve_nu_bank_pool(n_slots);
+  }
+  reserve_lost_particles();
+  init_event_tuning();
+
+  if (settings::checkpoint_particles > 0 && !batch_checkpoint_supported() &&
+      mpi::master) {
+    warning("Batches in progress are only checkpointed in event-based mode "
+      "with one generation per batch and without hybrid transport, "
+      "asynchronous bank exchange, domain decomposition, surface source "
+      "writing or CMFD.");
+  }
 
   // If this is a restart run, load the state point data and binary source
   // file
@@ -132,7 +269,7 @@ int openmc_simulation_init()
     write_message("Resuming simulation...", 6);
   } else {
     // Only initialize primary source bank for eigenvalue simulations
-    if (settings::run_mode == RunMode::EIGENVALUE) {
+    if (settings::run_mode == RunMode::EIGENVALUE && !reuse) {
       initialize_source();
     }
   }
@@ -163,13 +300,34 @@ int openmc_simulation_finalize()
   // Skip if simulation was never run
   if (!simulation::initialized) return 0;
 
-  // Release data from device
+  // Wait for the last statepoint to be complete
+  finish_statepoint_write();
+  finalize_track_output();
+  finalize_event_trace();
+  stop_kernel_profile();
+  write_event_stats();
+  write_region_costs();
+  write_run_status(true);
+
+  print_memory_report("finalization");
+
+  // Release data from device, keeping the results accumulated there and the
+  // source sites that a following simulation may start from
+  sync_tally_results_to_host();
+  update_source_bank_host();
   release_data_from_device();
-
-  // Clear material nuclide mapping
+  free_micro_xs_pool();
+  free_flux_derivs_pool();
+  free_nuclide_cdf_pool();
+  free_depletion_rx_pool();
+  free_photon_xs_pool();
+  free_nu_bank_pool();
+  free_lost_particles();
+
+  // Clear material nuclide bitmaps
   for (int i = 0; i < model::materials_size; i++) {
     auto& mat = model::materials[i];
-    mat.mat_nuclide_index_.clear();
+    mat.nuclide_bitmap_.clear();
   }
 
   // Increment total number of generations
@@ -193,6 +351,7 @@ int openmc_simulation_finalize()
   simulation::time_total.stop();
   if (mpi::master) {
     if (settings::verbosity >= 6) print_runtime();
+    if (settings::tally_stats) print_tally_stats();
     if (settings::verbosity >= 4) print_results();
   }
   if (settings::check_overlaps) print_overlap_check();
@@ -200,6 +359,12 @@ int openmc_simulation_finalize()
   //free(simulation::device_particles);
   //printf("freeing device particles was a success!\n");
 
+  // Restore the inactive batches skipped by starting from a reused source
+  settings::n_inactive += n_inactive_skipped;
+  settings::n_batches += n_inactive_skipped;
+  settings::n_max_batches += n_inactive_skipped;
+  n_inactive_skipped = 0;
+
   // Reset flags
   simulation::initialized = false;
   return 0;
@@ -225,7 +390,8 @@ int openmc_next_batch(int* status)
 
     initialize_generation();
   
-    if (settings::run_mode == RunMode::FIXED_SOURCE) {
+    // Fixed-source sites sampled on device are sampled as particles start
+    if (settings::run_mode == RunMode::FIXED_SOURCE && !settings::device_source) {
       initialize_fixed_source();
     }
 
@@ -236,11 +402,13 @@ int openmc_next_batch(int* status)
     if (settings::event_based) {
       transport_event_based();
     } else {
+      simulation::time_transport_local.start();
       #ifdef DEVICE_HISTORY
       transport_history_based_device();
       #else
       transport_history_based();
       #endif
+      simulation::time_transport_local.stop();
     }
 
     // Accumulate time for transport
@@ -267,10 +435,30 @@ int openmc_next_batch(int* status)
   }
 
   finalize_batch();
+  write_run_status(false);
 
   return 0;
 }
 
+int openmc_set_source_reuse(bool reuse, int32_t n_inactive)
+{
+  using namespace openmc;
+
+  if (simulation::initialized) {
+    set_errmsg("Source reuse cannot be changed during a simulation.");
+    return OPENMC_E_ALLOCATE;
+  }
+  if (n_inactive >= 0 && n_inactive > settings::n_inactive) {
+    set_errmsg("Inactive batches with a reused source cannot exceed the "
+      "number of inactive batches.");
+    return OPENMC_E_INVALID_ARGUMENT;
+  }
+
+  simulation::reuse_source = reuse;
+  simulation::reuse_n_inactive = n_inactive < 0 ? -1 : n_inactive;
+  return 0;
+}
+
 bool openmc_is_statepoint_batch() {
   using namespace openmc;
   using openmc::simulation::current_gen;
@@ -302,10 +490,15 @@ int n_lost_particles {0};
 bool need_depletion_rx {false};
 bool depletion_scores_present {false};
 int restart_batch;
+bool reuse_source {false};
+int32_t reuse_n_inactive {-1};
 bool satisfy_triggers {false};
 int total_gen {0};
 double total_weight;
 int64_t work_per_rank;
+int64_t next_history {1};
+int64_t max_work_per_rank;
+int64_t host_work {0};
 
 const Mesh* entropy_mesh {nullptr};
 const Mesh* ufs_mesh {nullptr};
@@ -326,17 +519,37 @@ Particle*  device_particles {nullptr};
 
 void allocate_banks()
 {
-  // Allocate source bank
+  // Allocate source bank. Its storage is kept in place as shares of work
+  // change, so that it stays mapped to device.
+  int64_t n_old = simulation::source_bank.capacity();
+  simulation::source_bank.reserve(simulation::max_work_per_rank);
+  record_memory("Particle banks", MemorySpace::host,
+    (simulation::source_bank.capacity() - n_old) * sizeof(Particle::Bank));
   simulation::source_bank.resize(simulation::work_per_rank);
+  simulation::source_bank_stale = false;
+
+  // The fission bank only stays resident on device when particles are
+  // transported there
+#ifndef DEVICE_HISTORY
+  if (settings::device_fission_bank && !settings::event_based) {
+    warning("Device fission bank sorting requires event-based mode.");
+    settings::device_fission_bank = false;
+  }
+#endif
 
   if (settings::run_mode == RunMode::EIGENVALUE) {
     // Allocate fission bank
-    init_fission_bank(3*simulation::work_per_rank);
+    init_fission_bank();
   }
 
+  // Allocate pool for secondary particles that overflow the inline banks
+  init_secondary_pool(settings::secondary_pool_size == -1 ?
+    simulation::max_work_per_rank : settings::secondary_pool_size);
+
   if (settings::surf_source_write) {
     // Allocate surface source bank
-    simulation::surf_source_bank.reserve(settings::max_surface_particles);
+    simulation::surf_source_bank.reserve(settings::max_surface_particles,
+      "Particle banks");
   }
 
 }
@@ -354,6 +567,8 @@ void initialize_batch()
   // Reset total starting particle weight used for normalizing tallies
   simulation::total_weight = 0.0;
   #pragma omp target update to(simulation::total_weight)
+  begin_batch_event_stats();
+  begin_batch_event_tuning();
 
   // Determine if this batch is the first inactive or active batch.
   bool first_inactive = false;
@@ -383,6 +598,9 @@ void initialize_batch()
 
 void finalize_batch()
 {
+  end_batch_event_stats();
+  end_batch_event_tuning();
+
   // Reduce tallies onto master process and accumulate
   simulation::time_accumulate_tallies.start();
   accumulate_tallies();
@@ -394,7 +612,13 @@ void finalize_batch()
     simulation::n_realizations = 0;
   }
 
-  // Check_triggers
+  // Regenerate weight windows from their flux tallies
+  update_weight_windows();
+
+  // Check_triggers, on results whose reduction may still be in flight
+#ifdef OPENMC_MPI
+  if (settings::trigger_on) complete_tally_reductions();
+#endif
   if (mpi::master) check_triggers();
 #ifdef OPENMC_MPI
   MPI_Bcast(&simulation::satisfy_triggers, 1, MPI_C_BOOL, 0, mpi::intracomm);
@@ -418,6 +642,14 @@ void finalize_batch()
     }
   }
 
+  // Update the checkpoint for restarts, after every batch when the batches
+  // in progress are checkpointed as well
+  if ((settings::checkpoint_interval > 0 && !settings::cmfd_run &&
+      simulation::current_batch % settings::checkpoint_interval == 0) ||
+      (settings::checkpoint_particles > 0 && batch_checkpoint_supported())) {
+    write_checkpoint();
+  }
+
   if (settings::run_mode == RunMode::EIGENVALUE) {
     // Write out a separate source point if it's been specified for this batch
     if (contains(settings::sourcepoint_batch, simulation::current_batch)
@@ -441,9 +673,20 @@ void finalize_batch()
 
 void initialize_generation()
 {
+  // Clear out secondary particles spilled during the previous generation
+  simulation::secondary_pool.resize(0);
+
+  // Let weight windows split again
+  if (settings::weight_windows_on) reset_split_budget();
+
   if (settings::run_mode == RunMode::EIGENVALUE) {
-    // Clear out the fission bank
+    // Clear out the fission bank and grow it to hold the sites expected in
+    // this generation
     simulation::fission_bank.resize(0);
+    simulation::fission_spill.resize(0);
+    simulation::fission_sites_dropped = 0;
+    #pragma omp target update to(simulation::fission_sites_dropped)
+    reserve_fission_bank();
 
     // Count source sites if using uniform fission source weighting
     if (settings::ufs_on) ufs_count_sites();
@@ -466,6 +709,12 @@ void finalize_generation()
   }
   gt(GlobalTally::LEAKAGE, TallyResult::VALUE) += global_tally_leakage;
 
+  // Write the track points of this generation
+  flush_track_output();
+
+  // Sites spilled past the fission bank join it before it is used
+  if (settings::run_mode == RunMode::EIGENVALUE) merge_fission_spill();
+
   // reset tallies
   if (settings::run_mode == RunMode::EIGENVALUE) {
     global_tally_collision = 0.0;
@@ -478,24 +727,55 @@ void finalize_generation()
   global_tally_leakage = 0.0;
   #pragma omp target update to(global_tally_leakage)
 
+  // The fission matrix of inactive batches is tallied while the fission bank
+  // and source bank are still those of this generation
+  bool fission_matrix = settings::fission_matrix_on &&
+    simulation::current_batch <= settings::n_inactive;
+  if (fission_matrix) tally_fission_matrix();
+
   if (settings::run_mode == RunMode::EIGENVALUE) {
     // If using shared memory, stable sort the fission bank (by parent IDs)
     // so as to allow for reproducibility regardless of which order particles
     // are run in.
-    sort_fission_bank();
+    if (settings::device_fission_bank) {
+      sort_fission_bank_device();
+    } else {
+      sort_fission_bank();
+    }
+  }
+
+  // Shares of the next batch follow the speed of each process in this one.
+  // The fission bank is sorted with the shares it was produced with and then
+  // distributed with the new ones.
+  if (settings::max_work_ratio > 0.0 &&
+      simulation::current_gen == settings::gen_per_batch) {
+    balance_work();
+  }
 
-    // Distribute fission bank across processors evenly
-    synchronize_bank();
+  if (settings::run_mode == RunMode::EIGENVALUE) {
+    // Distribute fission bank across processors, or only resample it on each
+    // processor until the end of the batch
+    if (local_generation()) {
+      synchronize_bank_local();
+    } else {
+      synchronize_bank();
+    }
+
+    // Move the source of the next batch toward the fundamental mode
+    if (fission_matrix && simulation::current_gen == settings::gen_per_batch) {
+      fission_matrix_reweight();
+    }
 
     // Calculate shannon entropy
     if (settings::entropy_on) shannon_entropy();
 
     // Collect results and statistics
     calculate_generation_keff();
-    calculate_average_keff();
+    if (!local_generation()) calculate_average_keff();
 
-    // Write generation output
-    if (mpi::master && settings::verbosity >= 7) {
+    // Write generation output. The k of local generations is only known once
+    // their batch ends.
+    if (mpi::master && settings::verbosity >= 7 && !local_generation()) {
       print_generation();
     }
 
@@ -504,20 +784,18 @@ void finalize_generation()
 
 double initialize_history(Particle& p, int index_source)
 {
-  // Initialize eigenvalue or fixed source particles from primary source bank
-  p.from_source(simulation::device_source_bank[index_source - 1]);
-  
-    /*
-  else if (settings::run_mode == RunMode::FIXED_SOURCE) {
-    // initialize random number seed
+  if (settings::device_source) {
+    // Sample fixed source particles from the external sources, with the seed
+    // initialize_fixed_source() would have sampled their site with
     int64_t id = (simulation::total_gen + overall_generation() - 1)*settings::n_particles +
       simulation::device_work_index[mpi::rank] + index_source;
     uint64_t seed = init_seed(id, STREAM_SOURCE);
-    // sample from external source distribution or custom library then set
-    auto site = sample_external_source(&seed);
+    auto site = sample_external_source_device(p, &seed);
     p.from_source(site);
+  } else {
+    // Initialize eigenvalue or fixed source particles from primary source bank
+    p.from_source(simulation::device_source_bank[index_source - 1]);
   }
-    */
   p.current_work_ = index_source;
 
   // set identifier for particle
@@ -543,27 +821,20 @@ double initialize_history(Particle& p, int index_source)
   */
 
   // Set particle track.
-  p.write_track_ = false;
-  /*
-  if (settings::write_all_tracks) {
-    p.write_track_ = true;
-  } else if (settings::track_identifiers.size() > 0) {
-    for (const auto& t : settings::track_identifiers) {
-      if (simulation::current_batch == t[0] &&
-          simulation::current_gen == t[1] &&
-          p.id_ == t[2]) {
-        p.write_track_ = true;
-        break;
-      }
-    }
-  }
+  p.write_track_ = track_particle(p.id_);
+  p.n_tracks_ = 0;
 
+  /*
   // Display message if high verbosity or trace is on
   if (settings::verbosity >= 9 || p.trace_) {
     write_message("Simulating Particle {}", p.id_);
   }
   */
 
+  // A site that could not be placed in the geometry starts a lost particle,
+  // recorded once its identifier and seeds are known
+  if (settings::device_source && p.wgt_ == 0.0) p.mark_as_lost_short();
+
   initialize_history_partial(p);
 
   return p.wgt_;
@@ -575,16 +846,17 @@ void initialize_history_partial(Particle& p)
   p.neutron_xs_.clear();
 
   // Prepare to write out particle track.
-  //if (p.write_track_) add_particle_track(p);
+  if (p.write_track_) add_particle_track(p);
 
   // Every particle starts with no accumulated flux derivative.
   // Note: This is not harmful even if there are no active tallies, and
   // doing so without condition avoids having to access model::active_tallies
   // which is not yet on device.
-  std::fill(p.flux_derivs_, p.flux_derivs_ + FLUX_DERIVS_SIZE, 0.0);
+  p.clear_flux_derivs();
 
   // Set secondary bank to 0 length
   p.secondary_bank_length_ = 0;
+  p.secondary_spill_head_ = -1;
 }
 
 int overall_generation()
@@ -615,6 +887,86 @@ void calculate_work()
     i_bank += work_i;
     simulation::work_index[i + 1] = i_bank;
   }
+
+  // When shares follow the speed of each process, the banks are sized for
+  // the largest share a process may be given
+  simulation::max_work_per_rank = simulation::work_per_rank;
+  if (settings::max_work_ratio > 0.0 && mpi::n_procs > 1) {
+    int64_t max_work = std::ceil(settings::max_work_ratio *
+      settings::n_particles / mpi::n_procs);
+    simulation::max_work_per_rank = std::max(simulation::work_per_rank,
+      std::min(max_work, settings::n_particles));
+  }
+}
+
+void balance_work()
+{
+  // Particles per second this process transported since the last call
+  double seconds = simulation::time_transport_local.elapsed();
+  simulation::time_transport_local.reset();
+  if (mpi::n_procs == 1) return;
+  double rate = seconds > 0.0 ?
+    settings::gen_per_batch*simulation::work_per_rank / seconds : 0.0;
+
+  int n = mpi::n_procs;
+  std::vector<double> rates(n, rate);
+#ifdef OPENMC_MPI
+  MPI_Allgather(&rate, 1, MPI_DOUBLE, rates.data(), 1, MPI_DOUBLE,
+    mpi::intracomm);
+#endif
+  if (*std::min_element(rates.begin(), rates.end()) <= 0.0) return;
+
+  // Divide the particles in proportion to rate. Shares over the largest
+  // allowed are held at it and the rest divided again among the others. One
+  // particle is left spare so that rounding cannot exceed the bank size.
+  double max_share = simulation::max_work_per_rank - 1;
+  std::vector<double> share(n);
+  std::vector<bool> held(n, false);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    double left = settings::n_particles;
+    double rate_left = 0.0;
+    for (int i = 0; i < n; ++i) {
+      if (held[i]) {
+        left -= max_share;
+      } else {
+        rate_left += rates[i];
+      }
+    }
+    for (int i = 0; i < n; ++i) {
+      if (held[i]) continue;
+      share[i] = left * rates[i] / rate_left;
+      if (share[i] > max_share) {
+        share[i] = max_share;
+        held[i] = true;
+        changed = true;
+      }
+    }
+  }
+
+  // Round the running sum of the shares so that they add to n_particles. Every
+  // process computes the same shares from the same rates.
+  std::vector<int64_t> work_index(n + 1);
+  double sum = 0.0;
+  for (int i = 0; i < n; ++i) {
+    sum += share[i];
+    work_index[i + 1] = i + 1 < n ? std::llround(sum) : settings::n_particles;
+    int64_t work_i = work_index[i + 1] - work_index[i];
+    if (work_i < 1 || work_i > simulation::max_work_per_rank) return;
+  }
+
+  std::copy(work_index.begin(), work_index.end(),
+    simulation::work_index.begin());
+  simulation::work_per_rank = work_index[mpi::rank + 1] - work_index[mpi::rank];
+  #pragma omp target update to(simulation::work_per_rank)
+  #pragma omp target update to(simulation::device_work_index[:n + 1])
+
+  // Storage was reserved for the largest share, so the banks stay in place
+  simulation::source_bank.resize(simulation::work_per_rank);
+  if (settings::run_mode == RunMode::EIGENVALUE) {
+    simulation::progeny_per_particle.resize(simulation::work_per_rank);
+  }
 }
 
 void initialize_data()
@@ -684,6 +1036,33 @@ void initialize_data()
   for (int i = 0; i < data::nuclides_size; ++i) {
     data::nuclides[i].init_grid();
   }
+
+  // Tabulate prompt fission spectra, which needs the neutron energy bounds
+  if (settings::fission_spectrum_table) {
+    std::vector<double> distance(data::nuclides_size);
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < data::nuclides_size; ++i) {
+      distance[i] = data::nuclides[i].init_fission_spectrum(
+        settings::validate_fission_spectrum);
+    }
+
+    // The tables are expected to differ from the exact spectra by no more
+    // than the 95% critical Kolmogorov-Smirnov distance of the samples
+    if (settings::validate_fission_spectrum && mpi::master) {
+      int n_samples = FISSION_SPECTRUM_QUANTILES * FISSION_SPECTRUM_SAMPLES;
+      double critical = 1.358 * std::sqrt(2.0 / n_samples);
+      for (int i = 0; i < data::nuclides_size; ++i) {
+        const auto& nuc = data::nuclides[i];
+        if (nuc.fission_spectrum_.size() == 0) continue;
+        write_message(5, "Fission spectrum table of {}: largest KS distance "
+          "{:.5f} (critical {:.5f})", nuc.name_, distance[i], critical);
+        if (distance[i] > critical) {
+          warning(fmt::format("Tabulated prompt fission spectrum of {} differs "
+            "from the exact distribution.", nuc.name_));
+        }
+      }
+    }
+  }
   int neutron = static_cast<int>(Particle::Type::neutron);
   simulation::log_spacing = std::log(data::energy_max[neutron] /
     data::energy_min[neutron]) / settings::n_log_bins;
@@ -728,32 +1107,28 @@ void free_memory_simulation()
   simulation::entropy.clear();
 }
 
-void check_for_lost_particles(void)
+//! Move a particle from one collision or surface crossing to the next
+//
+//! \return Whether the particle (or a secondary it was revived from) is alive
+bool transport_history_step(Particle& p, bool need_depletion_rx)
 {
-  #pragma omp target update from(simulation::n_lost_particles)
-  if (simulation::n_lost_particles >= settings::max_lost_particles &&
-      simulation::n_lost_particles >= settings::rel_max_lost_particles * simulation::work_per_rank * simulation::current_batch * settings::gen_per_batch) {
-    fatal_error("Too many particles have been lost.");
+  p.event_calculate_xs(need_depletion_rx);
+  p.event_advance();
+  if (!model::active_tracklength_tallies.empty()) {
+    p.event_tracklength_tally(need_depletion_rx);
   }
+  if (p.collision_distance_ > p.boundary_.distance) {
+    p.event_cross_surface();
+  } else {
+    p.event_collide();
+  }
+  p.event_revive_from_secondary();
+  return p.alive();
 }
 
 void transport_history_based_single_particle(Particle& p, double& absorption, double& collision, double& tracklength, double& leakage, bool need_depletion_rx)
 {
-  while (true) {
-    p.event_calculate_xs(need_depletion_rx);
-    p.event_advance();
-    if (!model::active_tracklength_tallies.empty()) {
-      p.event_tracklength_tally(need_depletion_rx);
-    }
-    if (p.collision_distance_ > p.boundary_.distance) {
-      p.event_cross_surface();
-    } else {
-      p.event_collide();
-    }
-    p.event_revive_from_secondary();
-    if (!p.alive())
-      break;
-  }
+  while (transport_history_step(p, need_depletion_rx)) {}
   p.accumulate_keff_tallies_local(absorption, collision, tracklength, leakage);
   p.event_death();
 }
@@ -761,9 +1136,12 @@ void transport_history_based_single_particle(Particle& p, double& absorption, do
 #ifdef DEVICE_HISTORY
 void transport_history_based_device()
 {
-  // Transfer source/fission bank to device
-  #pragma omp target update to(simulation::device_source_bank[:simulation::source_bank.size()])
-  simulation::fission_bank.copy_host_to_device();
+  // Transfer source bank to device. The fission bank is empty at this point,
+  // so only its size is sent.
+  if (!simulation::source_bank_stale && !settings::device_source) {
+    #pragma omp target update to(simulation::device_source_bank[:simulation::source_bank.size()])
+  }
+  simulation::fission_bank.sync_size_host_to_device();
   #pragma omp target update to(simulation::keff)
 
   int64_t work_amount = simulation::work_per_rank;
@@ -776,11 +1154,57 @@ void transport_history_based_device()
   
   bool need_depletion_rx = depletion_rx_check();
 
-  #pragma omp target teams distribute parallel for reduction(+:total_weight,absorption, collision, tracklength, leakage)
-  for (int64_t i_work = 1; i_work <= work_amount; i_work++) {
-    Particle p;
-    total_weight += initialize_history(p, i_work);
-    transport_history_based_single_particle(p, absorption, collision, tracklength, leakage, need_depletion_rx);
+  if (settings::persistent_history) {
+    // Each thread keeps one slot of the micro XS cache pool and takes the next
+    // history from a device counter until none are left, so that threads
+    // finishing short histories go on to others rather than idling until the
+    // longest of their chunk is done. Histories are still seeded by their
+    // index, so results do not depend on which thread ran them.
+    simulation::next_history = 1;
+    #pragma omp target update to(simulation::next_history)
+    int64_t n_threads = std::min<int64_t>(simulation::micro_xs_pool_slots,
+      work_amount);
+    if (n_threads == 0 && work_amount > 0) {
+      fatal_error("No particle slots were reserved for persistent history-based "
+        "transport.");
+    }
+    #pragma omp target teams distribute parallel for reduction(+:total_weight,absorption, collision, tracklength, leakage)
+    for (int64_t slot = 0; slot < n_threads; slot++) {
+      Particle p;
+      p.neutron_xs_.assign(slot);
+      p.assign_flux_derivs(slot);
+      p.assign_nuclide_cdf(slot);
+      p.assign_depletion_rx(slot);
+      p.assign_photon_xs(slot);
+      p.assign_nu_bank(slot);
+      while (true) {
+        int64_t i_work;
+        #pragma omp atomic capture
+        i_work = simulation::next_history++;
+        if (i_work > work_amount) break;
+        total_weight += initialize_history(p, i_work);
+        transport_history_based_single_particle(p, absorption, collision, tracklength, leakage, need_depletion_rx);
+      }
+    }
+  } else {
+    // Particles are run in chunks no larger than the micro XS cache pool so
+    // that each one in flight has its own cache slot
+    int64_t chunk = std::max(simulation::micro_xs_pool_slots, 1);
+    for (int64_t first = 1; first <= work_amount; first += chunk) {
+      int64_t last = std::min(first + chunk - 1, work_amount);
+      #pragma omp target teams distribute parallel for reduction(+:total_weight,absorption, collision, tracklength, leakage)
+      for (int64_t i_work = first; i_work <= last; i_work++) {
+        Particle p;
+        p.neutron_xs_.assign(i_work - first);
+        p.assign_flux_derivs(i_work - first);
+        p.assign_nuclide_cdf(i_work - first);
+        p.assign_depletion_rx(i_work - first);
+        p.assign_photon_xs(i_work - first);
+        p.assign_nu_bank(i_work - first);
+        total_weight += initialize_history(p, i_work);
+        transport_history_based_single_particle(p, absorption, collision, tracklength, leakage, need_depletion_rx);
+      }
+    }
   }
 
   simulation::total_weight = total_weight;
@@ -791,16 +1215,135 @@ void transport_history_based_device()
   global_tally_tracklength = tracklength;
   global_tally_leakage     = leakage;
 
-  // Copy back fission bank to host
-  simulation::fission_bank.copy_device_to_host();
-
-  // Move particle progeny count array back to host
-  #pragma omp target update from(simulation::device_progeny_per_particle[:simulation::progeny_per_particle.size()])
+  // Copy back fission bank and particle progeny counts to host, unless they
+  // are sorted on device
+  if (settings::device_fission_bank) {
+    simulation::fission_bank.sync_size_device_to_host();
+  } else {
+    simulation::fission_bank.copy_device_to_host();
+    #pragma omp target update from(simulation::device_progeny_per_particle[:simulation::progeny_per_particle.size()])
+  }
+  copy_fission_spill_to_host();
+  check_lost_particles(true);
 }
 #endif
 
+namespace {
+
+//! Steps a particle of an interleaved group takes in turn, each of which is
+//! followed by a switch to the next particle of the group
+enum class InterleavedStep {
+  prefetch_grid, //!< Prefetch the grid points and XS of the next lookup
+  transport      //!< Look up XS, move to the next collision or crossing and
+                 //!< prefetch the grid index entries of the lookup after it
+};
+
+//! Prefetch on host the nuclide data of a particle's next XS lookup
+void prefetch_next_xs(const Particle& p, bool grid)
+{
+  if (p.type_ != Particle::Type::neutron || p.material_ == MATERIAL_VOID)
+    return;
+  model::materials[p.material_].prefetch_xs(p.E_, grid);
+}
+
+//! Transport the histories of this rank on host threads, each of which
+//! interleaves settings::interleaved_histories of them. A thread goes round
+//! its group one step at a time, so that the nuclide data a particle's next
+//! lookup reads is prefetched while other particles of the group are moved,
+//! much as the queues of event-based transport hide the latency of its
+//! lookups, but without their bookkeeping. Every other particle starts one
+//! step ahead, so that half of the group is moved in each round and the
+//! prefetches of each stage have that long to arrive.
+void transport_history_based_interleaved()
+{
+  double total_weight = 0.0;
+  double absorption = 0.0;
+  double collision = 0.0;
+  double tracklength = 0.0;
+  double leakage = 0.0;
+  bool need_depletion_rx = depletion_rx_check();
+  int n_group = settings::interleaved_histories;
+  int64_t next_work = 1;
+
+  #pragma omp parallel reduction(+:total_weight,absorption, collision, tracklength, leakage)
+  {
+    std::vector<Particle> group(n_group);
+    std::vector<InterleavedStep> step(n_group);
+    std::vector<bool> active(n_group);
+    int first_slot = omp_get_thread_num() * n_group;
+    for (int j = 0; j < n_group; ++j) {
+      Particle& p = group[j];
+      p.neutron_xs_.assign(first_slot + j);
+      p.assign_flux_derivs(first_slot + j);
+      p.assign_nuclide_cdf(first_slot + j);
+      p.assign_depletion_rx(first_slot + j);
+      p.assign_photon_xs(first_slot + j);
+      p.assign_nu_bank(first_slot + j);
+    }
+
+    // Start the next history of the rank in a slot of the group
+    auto start = [&](int j) {
+      int64_t i_work;
+      #pragma omp atomic capture
+      i_work = next_work++;
+      active[j] = i_work <= simulation::work_per_rank;
+      if (!active[j]) return;
+      total_weight += initialize_history(group[j], i_work);
+      prefetch_next_xs(group[j], false);
+      step[j] = InterleavedStep::prefetch_grid;
+    };
+
+    int n_active = 0;
+    for (int j = 0; j < n_group; ++j) {
+      start(j);
+      if (active[j]) ++n_active;
+      if (j % 2 == 1) step[j] = InterleavedStep::transport;
+    }
+
+    while (n_active > 0) {
+      for (int j = 0; j < n_group; ++j) {
+        if (!active[j]) continue;
+        Particle& p = group[j];
+        switch (step[j]) {
+        case InterleavedStep::prefetch_grid:
+          prefetch_next_xs(p, true);
+          step[j] = InterleavedStep::transport;
+          break;
+        case InterleavedStep::transport:
+          if (transport_history_step(p, need_depletion_rx)) {
+            prefetch_next_xs(p, false);
+            step[j] = InterleavedStep::prefetch_grid;
+            break;
+          }
+          p.accumulate_keff_tallies_local(absorption, collision, tracklength,
+            leakage);
+          p.event_death();
+          start(j);
+          if (!active[j]) --n_active;
+          break;
+        }
+      }
+    }
+  }
+
+  // Write local reduction results to global values
+  global_tally_absorption  = absorption;
+  global_tally_collision   = collision;
+  global_tally_tracklength = tracklength;
+  global_tally_leakage     = leakage;
+  simulation::total_weight = total_weight;
+  check_lost_particles(false);
+}
+
+} // namespace
+
 void transport_history_based()
 {
+  if (settings::interleaved_histories > 1) {
+    transport_history_based_interleaved();
+    return;
+  }
+
   double total_weight = 0.0;
   double absorption = 0.0;
   double collision = 0.0;
@@ -810,6 +1353,12 @@ void transport_history_based()
   #pragma omp parallel for reduction(+:total_weight,absorption, collision, tracklength, leakage)
   for (int64_t i_work = 1; i_work <= simulation::work_per_rank; ++i_work) {
     Particle p;
+    p.neutron_xs_.assign(omp_get_thread_num());
+    p.assign_flux_derivs(omp_get_thread_num());
+    p.assign_nuclide_cdf(omp_get_thread_num());
+    p.assign_depletion_rx(omp_get_thread_num());
+    p.assign_photon_xs(omp_get_thread_num());
+    p.assign_nu_bank(omp_get_thread_num());
     total_weight += initialize_history(p, i_work);
     transport_history_based_single_particle(p, absorption, collision, tracklength, leakage, need_depletion_rx);
   }
@@ -819,130 +1368,291 @@ void transport_history_based()
   global_tally_tracklength = tracklength;
   global_tally_leakage     = leakage;
   simulation::total_weight = total_weight;
+  check_lost_particles(false);
+}
+
+namespace {
+
+// Share of the particles of this rank transported on host by hybrid transport
+double host_fraction {HYBRID_INITIAL_HOST_FRACTION};
+
+//! Sums over the particles transported on host by hybrid transport
+struct HostTransport {
+  double total_weight {0.0};
+  double absorption {0.0};
+  double collision {0.0};
+  double tracklength {0.0};
+  double leakage {0.0};
+  double seconds {0.0}; //!< Wall time taken
+};
+
+//! Transport the last simulation::host_work particles of this rank
+//! history-based on host threads
+//
+//! \param n_threads Number of host threads, each with its own slot of the
+//!   micro XS cache pool
+//! \param result Sums over the particles transported
+void transport_host_share(int n_threads, HostTransport& result)
+{
+  Timer timer;
+  timer.start();
+
+  double total_weight = 0.0;
+  double absorption = 0.0;
+  double collision = 0.0;
+  double tracklength = 0.0;
+  double leakage = 0.0;
+  bool need_depletion_rx = depletion_rx_check();
+  int64_t first = simulation::work_per_rank - simulation::host_work + 1;
+  #pragma omp parallel for num_threads(n_threads) reduction(+:total_weight,absorption, collision, tracklength, leakage)
+  for (int64_t i_work = first; i_work <= simulation::work_per_rank; ++i_work) {
+    Particle p;
+    p.neutron_xs_.assign(omp_get_thread_num());
+    p.assign_flux_derivs(omp_get_thread_num());
+    p.assign_nuclide_cdf(omp_get_thread_num());
+    p.assign_depletion_rx(omp_get_thread_num());
+    p.assign_photon_xs(omp_get_thread_num());
+    p.assign_nu_bank(omp_get_thread_num());
+    total_weight += initialize_history(p, i_work);
+    transport_history_based_single_particle(p, absorption, collision, tracklength, leakage, need_depletion_rx);
+  }
+
+  result.total_weight = total_weight;
+  result.absorption = absorption;
+  result.collision = collision;
+  result.tracklength = tracklength;
+  result.leakage = leakage;
+  timer.stop();
+  result.seconds = timer.elapsed();
 }
 
+//! Number of the particles of this rank to transport on host
+//
+//! \param n_threads Number of host threads
+int64_t host_share(int n_threads)
+{
+  // Each host thread is given at least one particle so that the speed of the
+  // host keeps being measured, and the device at least one
+  int64_t n = std::llround(host_fraction * simulation::work_per_rank);
+  n = std::max<int64_t>(n, n_threads);
+  return std::min(n, simulation::work_per_rank - 1);
+}
+
+//! Update the host share from the speeds of host and device in this
+//! generation, so that both finish the next one at the same time
+//
+//! \param n_device Number of particles transported on device
+//! \param device_seconds Wall time taken by the device
+//! \param host Sums over the particles transported on host
+void update_host_share(int64_t n_device, double device_seconds,
+  const HostTransport& host)
+{
+  if (simulation::host_work == 0 || n_device == 0 || host.seconds <= 0.0 ||
+      device_seconds <= 0.0) return;
+
+  double host_rate = simulation::host_work / host.seconds;
+  double device_rate = n_device / device_seconds;
+
+  // The previous share is averaged in so that one unusual generation does not
+  // swing the next
+  host_fraction = 0.5*(host_fraction + host_rate / (host_rate + device_rate));
+}
+
+} // namespace
+
 void transport_event_based()
 {
   #ifdef OPENMC_MPI
   MPI_Barrier( mpi::intracomm );
   #endif
-  // The fuel lookup bias is the increases the number of particles required before
-  // selecting this event to execute.
-  // E.g., if we had 100 particles in flight, and fuel xs queue had 45 particles
-  // and the next fullest queue had 30 particles, we would usually select the fuel
-  // lookup event to execute. With a bias factor of 2, in this example, since the next
-  // fullest queue has 30 particles, we would not select the fuel lookup event
-  // unless it had 30 * 2 = 60 particles present.
-  //
-  // In practice, this has a several percent improvement in performance, as the fuel lookup
-  // event runs more efficiently with more particles in comparison to other events (due to
-  // the energy sort for the fuel lookup event which is not used for other events).
-  //const int64_t fuel_lookup_bias = 2;
-
-  // The max revival period forces particles to be revived (if there are any in the revival queue)
-  // every nth iteration rather than waiting for this queue to be the largest. While the kernel itself
-  // is not very efficient if executing with only a few particles, it is important to revive particles
-  // promptly so as to reduce the length of the tail of particle deaths at the end of each power iteration.
-  // Basically, to reduce the overall number of events run, we want to make sure we start all particles
-  // at the lowest event # possible. The pathological case is if we have a single particle waiting to be
-  // revived, and that event would not normally be selected until all (or nearly all) other particles have
-  // died off. In this case, we would essentially need to launch tens or hundreds of events just to process
-  // that last particle in serial. Introduction of a maximum period for the revival event ensures that such
-  // a particle is revived while there are still many particles in-flight.
-  //
-  // In practice, this optimization has a few percent improvement in performance. Improvements are largest
-  // when # particles per iteration <= max # particles in flight.
-  const int64_t max_revival_period = 100;
-  // Transfer source/fission bank to device
-  #pragma omp target update to(simulation::device_source_bank[:simulation::source_bank.size()])
-  simulation::fission_bank.copy_host_to_device();
+  simulation::time_transport_local.start();
+
+  // With hybrid transport, the last particles of this rank are transported on
+  // host threads, with one thread left to drive the device
+  int n_host_threads = 0;
+  simulation::host_work = 0;
+  if (settings::hybrid_transport) {
+    n_host_threads = std::min(omp_get_max_threads() - 1,
+      simulation::micro_xs_pool_slots);
+    if (n_host_threads > 0) {
+      simulation::host_work = host_share(n_host_threads);
+    } else if (simulation::current_batch == 1 && mpi::master) {
+      warning("Hybrid transport needs more than one OpenMP thread; all "
+        "particles are transported on device.");
+    }
+  }
+  int64_t n_device = simulation::work_per_rank - simulation::host_work;
+
+  // A batch checkpointed part way through resumes after its last checkpoint.
+  // Checkpoints are taken once the particle buffer drains, which it does when
+  // the sites ready to start are limited to those before the next one.
+  bool checkpoint_batch = settings::checkpoint_particles > 0 &&
+    batch_checkpoint_supported();
+  int64_t first_source = batch_checkpoint_supported() ?
+    resume_batch_checkpoint() : 0;
+
+  // Transfer source bank to device while the tallies are being transferred.
+  // The fission bank is empty at this point, so only its size is sent. With
+  // an asynchronous bank exchange, sites are transferred as they arrive.
+  if (settings::async_bank_exchange) {
+    start_source_transfer();
+  } else {
+    if (!simulation::source_bank_stale && !settings::device_source) {
+      #pragma omp target update to(simulation::device_source_bank[:simulation::source_bank.size()]) nowait
+    }
+    simulation::n_sources_ready = checkpoint_batch ? std::min(n_device,
+      first_source + settings::checkpoint_particles) : n_device;
+    #pragma omp target update to(simulation::n_sources_ready)
+  }
+  simulation::fission_bank.sync_size_host_to_device();
   #pragma omp target update to(simulation::keff)
   
   // Transfer tally data to device for on-device tallying
-  if (!model::active_tracklength_tallies.empty()) {
+  if (!model::active_tallies.empty()) {
     for (int i = 0; i < model::tallies_size; ++i) {
       auto& tally = model::tallies[i];
       tally.update_host_to_device();
     }
   }
+  #pragma omp taskwait
+
+  // Host threads start on their share once the source bank and tallies are in
+  // place on device
+  HostTransport host;
+  std::thread host_thread;
+  if (simulation::host_work > 0) {
+    host_thread = std::thread {transport_host_share, n_host_threads,
+      std::ref(host)};
+  }
+  Timer device_timer;
+  device_timer.start();
 
   // Figure out # of particles to initialize. If # of particles required per batch for this rank
   // is greater than what is allowed in-flight at once, then the particles will be refilled
   // on-the-fly via the revival event.
-  int64_t n_particles = std::min(simulation::work_per_rank, settings::max_particles_in_flight);
+  int64_t n_particles = std::min(n_device, settings::max_particles_in_flight);
+  int64_t n_started = n_particles;
 
   // Initialize in-flight particles
-  process_init_events(n_particles);
-
-  int event = 0;
+  process_init_events(std::min<int64_t>(n_particles,
+    simulation::n_sources_ready - first_source), first_source);
 
   // Event-based transport loop
+  int64_t event = 0;
+  EventType type;
   while (true) {
-    // Determine which event kernel has the longest queue
-    int64_t max = std::max({
-      simulation::calculate_fuel_xs_queue.size(),
-      simulation::calculate_nonfuel_xs_queue.size(),
-      simulation::advance_particle_queue.size(),
-      simulation::surface_crossing_queue.size(),
-      simulation::revival_queue.size(),
-      simulation::collision_queue.size()});
-
-    // Determine which event kernel has the longest queue (not including the fuel XS lookup queue)
-    int64_t max_other_than_fuel_xs = std::max({
-      simulation::calculate_nonfuel_xs_queue.size(),
-      simulation::advance_particle_queue.size(),
-      simulation::surface_crossing_queue.size(),
-      simulation::revival_queue.size(),
-      simulation::collision_queue.size()});
-
-    // Require the fuel XS lookup event to be more full to run as compared to other events
-    // This is motivated by this event having more benefit to running with more particles
-    // due to the particle energy sort.
-    if ( static_cast<double>(max) < settings::fuel_lookup_bias * static_cast<double>(max_other_than_fuel_xs) )
-      max = max_other_than_fuel_xs;
-
-    // Execute event with the longest queue (or revival queue if the revival period is reached)
-    if (max == 0) {
-      break;
-    } else if (max == simulation::revival_queue.size() || ( simulation::revival_queue.size() > 0 && event % max_revival_period == 0 )) {
-      process_revival_events();
-    } else if (max == simulation::calculate_fuel_xs_queue.size()) {
-      process_calculate_xs_events_fuel();
-    } else if (max == simulation::calculate_nonfuel_xs_queue.size()) {
-      process_calculate_xs_events_nonfuel();
-    } else if (max == simulation::advance_particle_queue.size()) {
-      process_advance_particle_events();
-    } else if (max == simulation::surface_crossing_queue.size()) {
-      process_surface_crossing_events();
-    } else if (max == simulation::collision_queue.size()) {
-      process_collision_events();
-    }
-
-    event++;
-
-    /*
-    // Check if the maximum number of lost particles has been reached
-    #pragma omp target update from(simulation::n_lost_particles)
-    if (simulation::n_lost_particles >= settings::max_lost_particles &&
-        simulation::n_lost_particles >= settings::rel_max_lost_particles * simulation::work_per_rank * simulation::current_batch * settings::gen_per_batch) {
-      fatal_error("Too many particles have been lost.");
-    }
-    */
+    while (select_next_event(event, type)) {
+      // Once only a few particles remain, finish them history-based rather
+      // than launching many nearly empty event kernels
+      if (should_finish_tail()) {
+        process_tail_events();
+        break;
+      }
+      process_event(type);
+      event++;
+      if (should_compact_particles()) compact_particle_buffer();
+      if (simulation::host_work == 0 && settings::lost_check_interval > 0 &&
+          event % settings::lost_check_interval == 0) {
+        check_lost_particles(true);
+      }
+      if (bank_exchange_pending()) poll_bank_exchange(false);
+    }
+
+    // While sites are still arriving from other processes, the in-flight
+    // particles can all finish before every site has been started. The buffer
+    // is then refilled with the sites that have arrived.
+    int offset = simulation::current_source_offset;
+    if (offset >= n_device) {
+      // Once its own particles have finished, this process continues the
+      // histories handed over from other domains until none remain anywhere
+      int n_arrived = domain_decomposed() ? receive_domain_particles() : 0;
+      if (n_arrived == 0) break;
+      process_arrival_events(n_arrived);
+      n_started = std::max<int64_t>(n_started, n_arrived);
+      continue;
+    }
+    if (checkpoint_batch && offset == simulation::n_sources_ready) {
+      // Gather the keff accumulators and lost particles of the histories
+      // finished so far, as they would be at the end of the batch
+      process_death_events(n_started);
+      check_lost_particles(true);
+      bool written = write_batch_checkpoint(offset);
+
+      // Emulate a run preempted part way through the batch
+      static int n_checkpoints = 0;
+      if (written && settings::checkpoint_stop > 0 &&
+          ++n_checkpoints == settings::checkpoint_stop) {
+        finish_statepoint_write();
+        fatal_error(fmt::format("Stopped after {} checkpoints of the batch in "
+          "progress.", n_checkpoints));
+      }
+      simulation::n_sources_ready = std::min(n_device,
+        offset + settings::checkpoint_particles);
+      #pragma omp target update to(simulation::n_sources_ready)
+    }
+    while (offset >= simulation::n_sources_ready) poll_bank_exchange(true);
+    process_init_events(std::min<int64_t>(n_particles,
+      simulation::n_sources_ready - offset), offset);
+  }
+  finish_bank_exchange();
+
+  // Age the kernel cost observations so that the scheduler adapts to changes
+  // in the particle population from generation to generation
+  simulation::event_cost_model.decay(0.5);
+  device_timer.stop();
+
+  // The sites banked on host, including those spilled and dropped, are set
+  // aside while the device sites are copied over them, and are then appended
+  std::vector<Particle::Bank> host_sites;
+  int64_t host_dropped = 0;
+  if (host_thread.joinable()) {
+    host_thread.join();
+    host_sites.assign(simulation::fission_bank.data(),
+      simulation::fission_bank.data() + simulation::fission_bank.size());
+    host_sites.insert(host_sites.end(), simulation::fission_spill.data(),
+      simulation::fission_spill.data() + simulation::fission_spill.size());
+    host_dropped = simulation::fission_sites_dropped;
+    update_host_share(n_device, device_timer.elapsed(), host);
   }
 
+  // No more sites are banked past this point, so start copying the fission
+  // bank back to host while the remaining kernels and transfers run. If it is
+  // sorted on device, only its size is needed.
+  if (settings::device_fission_bank) {
+    simulation::fission_bank.sync_size_device_to_host();
+  } else {
+    simulation::fission_bank.copy_device_to_host(true);
+  }
+  copy_fission_spill_to_host();
+  simulation::fission_sites_dropped += host_dropped;
+
   // Execute death event for all particles
-  process_death_events(n_particles);
+  process_death_events(n_started);
+  flush_event_trace();
+
+  // Particles lost on host threads are counted in the host copy of the
+  // records, which is read before it is overwritten by those from device
+  if (simulation::host_work > 0) check_lost_particles(false);
+  check_lost_particles(true);
+  global_tally_absorption  += host.absorption;
+  global_tally_collision   += host.collision;
+  global_tally_tracklength += host.tracklength;
+  global_tally_leakage     += host.leakage;
+  simulation::total_weight += host.total_weight;
 
-  // Copy back fission bank to host
-  simulation::fission_bank.copy_device_to_host();
-  
   // Transfer tally data back to host for host-side accumulation
-  if (!model::active_tracklength_tallies.empty()) {
+  if (!model::active_tallies.empty()) {
+    reduce_tally_scores();
     for (int i = 0; i < model::tallies_size; ++i) {
       auto& tally = model::tallies[i];
       tally.update_device_to_host();
+      tally.add_host_scores();
     }
   }
+  #pragma omp taskwait
+
+  append_fission_sites(host_sites.data(), host_sites.size());
+  simulation::time_transport_local.stop();
 
   #ifdef OPENMC_MPI
   MPI_Barrier( mpi::intracomm );
@@ -4,8 +4,9 @@
 #define HAS_DYNAMIC_LINKING
 #endif
 
-#include <algorithm> // for move
+#include <algorithm> // for move, swap
 #include <memory> // for unique_ptr
+#include <numeric> // for iota
 
 #ifdef HAS_DYNAMIC_LINKING
 #include <dlfcn.h> // for dlopen, dlsym, dlclose, dlerror
@@ -18,6 +19,7 @@
 #include "openmc/cell.h"
 #include "openmc/error.h"
 #include "openmc/file_utils.h"
+#include "openmc/geometry.h"
 #include "openmc/hdf5_interface.h"
 #include "openmc/material.h"
 #include "openmc/message_passing.h"
@@ -40,6 +42,8 @@ namespace openmc {
 namespace model {
 
 std::vector<std::unique_ptr<Source>> external_sources;
+DataBuffer external_sources_flat;
+uint8_t* device_external_sources {nullptr};
 
 }
 
@@ -231,11 +235,111 @@ Particle::Bank IndependentSource::sample(uint64_t* seed) const
   return site;
 }
 
+void IndependentSource::serialize(DataBuffer& buffer) const
+{
+  // Check for monoenergetic source above maximum particle energy
+  auto p = static_cast<int>(particle_);
+  auto energy_ptr = dynamic_cast<Discrete*>(energy_.get());
+  if (energy_ptr) {
+    for (double E : energy_ptr->x()) {
+      if (E > data::energy_max[p]) {
+        fatal_error("Source energy above range of energies of at least "
+                    "one cross section table");
+      } else if (E < data::energy_min[p]) {
+        fatal_error("Source energy below range of energies of at least "
+                    "one cross section table");
+      }
+    }
+  }
+
+  int offset_angle = 24 + buffer_nbytes(*space_);
+  int offset_energy = offset_angle + buffer_nbytes(*angle_);
+  buffer.add(static_cast<int>(particle_)); // 4
+  buffer.add(offset_angle);                // 4
+  buffer.add(strength_);                   // 8
+  buffer.add(offset_energy);               // 4
+  buffer.align(8);                         // 4
+  space_->serialize(buffer);
+  angle_->serialize(buffer);
+  energy_->serialize_tagged(buffer);
+}
+
+//==============================================================================
+// IndependentSourceFlat implementation
+//==============================================================================
+
+Particle::Bank IndependentSourceFlat::sample(Particle& p, uint64_t* seed) const
+{
+  auto offsets = reinterpret_cast<const int*>(data_);
+  SpatialDistributionFlat space(data_ + 24);
+  UnitSphereDistributionFlat angle(data_ + offsets[1]);
+  DistributionFlat energy(data_ + offsets[4]);
+
+  Particle::Bank site;
+
+  // Set weight to one by default
+  site.wgt = 1.0;
+  site.particle = static_cast<Particle::Type>(offsets[0]);
+
+  // Repeat sampling source location until a good site has been found. The
+  // particle's coordinates are used for the search and reset afterwards by
+  // Particle::from_source().
+  bool found = false;
+  int n_reject = 0;
+  while (!found) {
+    site.r = space.sample(seed);
+
+    p.clear();
+    p.r() = site.r;
+    p.u() = {0.0, 0.0, 1.0};
+    found = exhaustive_find_cell(p);
+
+    // Check if spatial site is in fissionable material
+    if (found && space.only_fissionable()) {
+      found = p.material_ != MATERIAL_VOID &&
+        model::materials[p.material_].fissionable();
+    }
+
+    // Give up on sites that cannot be placed rather than aborting on device
+    if (!found && ++n_reject >= EXTSRC_REJECT_THRESHOLD) {
+      site.wgt = 0.0;
+      break;
+    }
+  }
+
+  // Sample angle
+  site.u = angle.sample(seed);
+
+  int i = static_cast<int>(site.particle);
+  while (true) {
+    // Sample energy spectrum
+    site.E = energy.sample(seed);
+
+    // Resample if energy falls outside minimum or maximum particle energy
+    if (site.E < data::energy_max[i] && site.E > data::energy_min[i]) break;
+  }
+
+  // Set delayed group
+  site.delayed_group = 0;
+  // Set surface ID
+  site.surf_id = 0;
+  // Set emission time
+  site.time = 0.0;
+
+  return site;
+}
+
+double IndependentSourceFlat::strength() const
+{
+  return *reinterpret_cast<const double*>(data_ + 8);
+}
+
 //==============================================================================
 // FileSource implementation
 //==============================================================================
 
 FileSource::FileSource(std::string path)
+  : path_ {path}
 {
   // Check if source file exists
   if (!file_exists(path)) {
@@ -256,6 +360,20 @@ FileSource::FileSource(std::string path)
     fatal_error("Specified starting source file not a source file type.");
   }
 
+  // Files with more sites than may be held at once are read in blocks, one
+  // for each generation
+  n_file_sites_ = source_bank_size(file_id);
+  int64_t block_sites = settings::source_block_sites;
+  if (block_sites > 0 && block_sites < n_file_sites_) {
+    file_close(file_id);
+    n_blocks_ = (n_file_sites_ + block_sites - 1) / block_sites;
+    write_message(6, "Reading source file in {} blocks of {} sites", n_blocks_,
+      n_file_sites_ / n_blocks_);
+    read_block(block_index(0), sites_);
+    start_prefetch();
+    return;
+  }
+
   // Read in the source particles
   read_source_bank(file_id, sites_, false);
 
@@ -263,12 +381,75 @@ FileSource::FileSource(std::string path)
   file_close(file_id);
 }
 
+FileSource::~FileSource()
+{
+  if (prefetch_.joinable()) prefetch_.join();
+}
+
 Particle::Bank FileSource::sample(uint64_t* seed) const
 {
   size_t i_site = sites_.size()*prn(seed);
   return sites_[i_site];
 }
 
+void FileSource::prepare_generation()
+{
+  // The first generation is sampled from the block read on construction
+  if (n_blocks_ == 1 || first_generation_) {
+    first_generation_ = false;
+    return;
+  }
+
+  ++position_;
+  if (prefetch_.joinable()) {
+    prefetch_.join();
+    sites_.swap(next_sites_);
+  } else {
+    // The block is read here when HDF5 cannot be used from another thread
+    finish_statepoint_write();
+    read_block(block_index(position_), sites_);
+  }
+  start_prefetch();
+}
+
+int64_t FileSource::block_index(int64_t position) const
+{
+  // Processes take successive blocks of the sequence so that each block is
+  // used by one process on each pass
+  int64_t i = position*mpi::n_procs + mpi::rank;
+  int64_t pass = i / n_blocks_;
+
+  // Fisher-Yates shuffle of the blocks, seeded by the pass so that every
+  // process arrives at the same order
+  std::vector<int64_t> order(n_blocks_);
+  std::iota(order.begin(), order.end(), 0);
+  uint64_t seed = init_seed(pass + 1, STREAM_SOURCE);
+  for (int64_t j = n_blocks_ - 1; j > 0; --j) {
+    int64_t k = (j + 1)*prn(&seed);
+    std::swap(order[j], order[k]);
+  }
+  return order[i % n_blocks_];
+}
+
+void FileSource::read_block(int64_t block, BankVector& sites) const
+{
+  // Blocks differ in size by at most one site
+  int64_t start = block*n_file_sites_ / n_blocks_;
+  int64_t end = (block + 1)*n_file_sites_ / n_blocks_;
+
+  hid_t file_id = file_open(path_, 'r');
+  read_source_bank_range(file_id, sites, start, end - start);
+  file_close(file_id);
+}
+
+void FileSource::start_prefetch()
+{
+  if (!hdf5_thread_safe()) return;
+
+  int64_t block = block_index(position_ + 1);
+  prefetch_ = std::thread {[this, block] { read_block(block, next_sites_); }};
+}
+
 //==============================================================================
 // CustomSourceWrapper implementation
 //==============================================================================
@@ -333,6 +514,8 @@ void initialize_source()
 {
   write_message("Initializing source particles...", 5);
 
+  for (auto& s : model::external_sources) s->prepare_generation();
+
   // Generation source sites from specified distribution in user input
   #pragma omp parallel for
   for (int64_t i = 0; i < simulation::work_per_rank; ++i) {
@@ -357,6 +540,8 @@ void initialize_source()
 
 void initialize_fixed_source()
 {
+  for (auto& s : model::external_sources) s->prepare_generation();
+
   // Generation source sites from specified distribution in user input
   #pragma omp parallel for
   for (int64_t i = 0; i < simulation::work_per_rank; ++i) {
@@ -391,6 +576,9 @@ Particle::Bank sample_external_source(uint64_t* seed)
   // Sample source site from i-th source distribution
   Particle::Bank site {model::external_sources[i]->sample(seed)};
 
+  // Sources emit their particles at the start of the history
+  site.time = 0.0;
+
   // If running in MG, convert site.E to group
   if (!settings::run_CE) {
     site.E = lower_bound_index(data::mg.rev_energy_bins_.begin(),
@@ -401,6 +589,75 @@ Particle::Bank sample_external_source(uint64_t* seed)
   return site;
 }
 
+Particle::Bank sample_external_source_device(Particle& p, uint64_t* seed)
+{
+  const uint8_t* data = model::device_external_sources;
+  int n = *reinterpret_cast<const int*>(data);
+  double total_strength = *reinterpret_cast<const double*>(data + 8);
+  auto offsets = reinterpret_cast<const int*>(data + 16);
+
+  // Sample from among multiple source distributions
+  int i = 0;
+  if (n > 1) {
+    double xi = prn(seed)*total_strength;
+    double c = 0.0;
+    for (; i < n - 1; ++i) {
+      c += IndependentSourceFlat(data + offsets[i]).strength();
+      if (xi < c) break;
+    }
+  }
+
+  // Sample source site from i-th source distribution
+  return IndependentSourceFlat(data + offsets[i]).sample(p, seed);
+}
+
+bool can_sample_sources_on_device()
+{
+  if (!settings::run_CE) return false;
+  for (const auto& s : model::external_sources) {
+    auto source = dynamic_cast<IndependentSource*>(s.get());
+    if (!source || !source->space() || !source->angle() || !source->energy()) {
+      return false;
+    }
+  }
+  return !model::external_sources.empty();
+}
+
+void copy_external_sources_to_device()
+{
+  int n = model::external_sources.size();
+  std::vector<int> offsets;
+  size_t offset = aligned(16 + 4*n, 8);
+  double total_strength = 0.0;
+  for (const auto& s : model::external_sources) {
+    const auto& source = static_cast<const IndependentSource&>(*s);
+    offsets.push_back(offset);
+    offset += buffer_nbytes(source);
+    total_strength += source.strength();
+  }
+
+  auto& buffer {model::external_sources_flat};
+  buffer.reserve(offset, "External sources");
+  buffer.add(n);              // 4
+  buffer.align(8);            // 4
+  buffer.add(total_strength); // 8
+  buffer.add(offsets);        // 4*n
+  buffer.align(8);            // 0 or 4
+  for (const auto& s : model::external_sources) {
+    static_cast<const IndependentSource&>(*s).serialize(buffer);
+  }
+
+  model::device_external_sources = buffer.data_;
+  #pragma omp target enter data map(to: model::device_external_sources[:buffer.size()])
+}
+
+void release_external_sources_from_device()
+{
+  if (!model::device_external_sources) return;
+  #pragma omp target exit data map(release: model::device_external_sources[:model::external_sources_flat.size()])
+  model::device_external_sources = nullptr;
+}
+
 void free_memory_source()
 {
   model::external_sources.clear();
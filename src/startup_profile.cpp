@@ -0,0 +1,128 @@
+#include "openmc/startup_profile.h"
+
+#include <fstream>
+
+#include <unistd.h> // for sysconf
+
+#include <fmt/core.h>
+
+#include "openmc/device_alloc.h"
+#include "openmc/error.h"
+#include "openmc/message_passing.h"
+#include "openmc/settings.h"
+#include "openmc/string_utils.h"
+
+namespace openmc {
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace simulation {
+
+std::vector<StartupPhase> startup_phases;
+std::vector<StartupItem> startup_items;
+
+} // namespace simulation
+
+namespace {
+
+// Indices in simulation::startup_phases of the open phases, innermost last
+std::vector<int> open_phases;
+
+} // namespace
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+bool profiling_startup()
+{
+  return !settings::path_startup_profile.empty();
+}
+
+void begin_phase(const std::string& name)
+{
+  if (!profiling_startup()) return;
+
+  StartupPhase phase;
+  phase.name = name;
+  phase.depth = open_phases.size();
+  phase.host_start = host_resident_bytes();
+  phase.device_start = data::device_arena.total_bytes();
+  phase.timer.start();
+  open_phases.push_back(simulation::startup_phases.size());
+  simulation::startup_phases.push_back(phase);
+}
+
+void end_phase()
+{
+  if (open_phases.empty()) return;
+
+  auto& phase = simulation::startup_phases[open_phases.back()];
+  open_phases.pop_back();
+  phase.timer.stop();
+  phase.seconds = phase.timer.elapsed();
+  phase.host_bytes = host_resident_bytes() - phase.host_start;
+  phase.device_bytes = static_cast<int64_t>(data::device_arena.total_bytes()) -
+    phase.device_start;
+}
+
+void record_startup_item(const char* kind, const std::string& name,
+  double seconds)
+{
+  if (!profiling_startup()) return;
+
+  #pragma omp critical(startup_items)
+  simulation::startup_items.push_back({kind, name, seconds});
+}
+
+int64_t host_resident_bytes()
+{
+  // The second field of statm is the number of resident pages
+  std::ifstream statm {"/proc/self/statm"};
+  int64_t size, resident;
+  if (!(statm >> size >> resident)) return 0;
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+void write_startup_profile()
+{
+  if (!profiling_startup()) return;
+
+  // Phases left open by an error are closed where the report is written
+  while (!open_phases.empty()) end_phase();
+
+  if (mpi::master) {
+    std::ofstream out {settings::path_startup_profile};
+    if (!out) {
+      warning(fmt::format("Could not write startup profile {}.",
+        settings::path_startup_profile));
+    } else {
+      out << "{\n  \"phases\": [";
+      const auto& phases {simulation::startup_phases};
+      for (int i = 0; i < phases.size(); ++i) {
+        const auto& p {phases[i]};
+        out << (i == 0 ? "\n" : ",\n") << fmt::format("    {{\"name\": {}, "
+          "\"depth\": {}, \"seconds\": {:.6e}, \"host_bytes\": {}, "
+          "\"device_bytes\": {}}}", json_string(p.name), p.depth, p.seconds,
+          p.host_bytes, p.device_bytes);
+      }
+      out << "\n  ],\n  \"items\": [";
+      const auto& items {simulation::startup_items};
+      for (int i = 0; i < items.size(); ++i) {
+        const auto& item {items[i]};
+        out << (i == 0 ? "\n" : ",\n") << fmt::format("    {{\"kind\": {}, "
+          "\"name\": {}, \"seconds\": {:.6e}}}", json_string(item.kind),
+          json_string(item.name), item.seconds);
+      }
+      out << "\n  ]\n}\n";
+      write_message(5, "Wrote startup profile {}", settings::path_startup_profile);
+    }
+  }
+
+  simulation::startup_phases.clear();
+  simulation::startup_items.clear();
+}
+
+} // namespace openmc
@@ -1,8 +1,13 @@
 #include "openmc/state_point.h"
 
 #include <algorithm>
+#include <array>
 #include <cstdint> // for int64_t
+#include <cstdio>  // for rename, remove
+#include <cstring> // for memcpy
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <fmt/core.h>
@@ -13,28 +18,370 @@
 #include "openmc/bank.h"
 #include "openmc/capi.h"
 #include "openmc/constants.h"
+#include "openmc/domain_decomposition.h"
 #include "openmc/eigenvalue.h"
 #include "openmc/error.h"
+#include "openmc/file_utils.h"
 #include "openmc/hdf5_interface.h"
+#include "openmc/kernel_profile.h"
 #include "openmc/mesh.h"
 #include "openmc/message_passing.h"
 #include "openmc/mgxs_interface.h"
 #include "openmc/nuclide.h"
 #include "openmc/output.h"
+#include "openmc/profile_range.h"
 #include "openmc/settings.h"
 #include "openmc/simulation.h"
+#include "openmc/string_utils.h"
 #include "openmc/tallies/derivative.h"
 #include "openmc/tallies/filter.h"
 #include "openmc/tallies/tally.h"
 #include "openmc/timer.h"
+#include "openmc/weight_windows.h"
 
 namespace openmc {
 
+hid_t h5banktype();
+
+namespace {
+
+//! Copy of the results of a tally taken for a statepoint
+struct TallySnapshot {
+  std::string name; //!< Name of the tally's group
+  std::array<size_t, 3> shape;
+  std::vector<double> results;
+};
+
+//! Tally results of a statepoint being written by a background thread while
+//! the next batch is transported. They are copied when the statepoint is
+//! started, into buffers that are kept from one statepoint to the next.
+struct StatepointWriter {
+  std::thread thread;
+  std::mutex mutex; //!< Held while joining the thread
+  std::string filename;
+  xt::xtensor_fixed<double, xt::xshape<N_GLOBAL_TALLIES, 3>> global_tallies;
+  std::vector<TallySnapshot> tallies;
+};
+
+StatepointWriter writer;
+
+//! Copy the global tallies and the results of each writable tally
+void snapshot_tally_results()
+{
+  writer.global_tallies = simulation::global_tallies;
+  int n = 0;
+  for (int i = 0; i < model::tallies_size; ++i) {
+    const auto& tally = model::tallies[i];
+    if (!tally.writable_) continue;
+    if (writer.tallies.size() <= n) writer.tallies.emplace_back();
+    auto& snap = writer.tallies[n++];
+    snap.name = "tally " + std::to_string(tally.id_);
+    snap.shape = tally.results_shape();
+    snap.results.assign(tally.results_, tally.results_ + tally.results_size_);
+  }
+  writer.tallies.resize(n);
+}
+
+//! Write the copied results to the statepoint, on the background thread
+void write_tally_snapshot()
+{
+  hid_t file_id = file_open(writer.filename, 'a');
+  write_dataset(file_id, "global_tallies", writer.global_tallies);
+  hid_t tallies_group = open_group(file_id, "tallies");
+  for (const auto& snap : writer.tallies) {
+    hid_t tally_group = open_group(tallies_group, snap.name);
+    write_tally_results(tally_group, snap.shape[0], snap.shape[1],
+      snap.results.data());
+    close_group(tally_group);
+  }
+  close_group(tallies_group);
+  file_close(file_id);
+}
+
+#ifdef PHDF5
+//! Write the results of each tally not reduced during the run. Rather than
+//! reducing every tally onto the master, each process receives the sum over
+//! all processes of a contiguous range of filter bins and writes that range
+//! collectively.
+void write_tally_results_parallel(hid_t file_id)
+{
+  bool last = simulation::current_batch == settings::n_max_batches ||
+    simulation::satisfy_triggers;
+
+  hid_t tallies_group = open_group(file_id, "tallies");
+  for (int i = 0; i < model::tallies_size; ++i) {
+    const auto& t = &model::tallies[i];
+    if (!t->active_ || !t->writable_) continue;
+
+    // Make copy of sum and sum_sq of each bin in contiguous array
+    auto adapted_array = xt::adapt(t->results_, t->results_size_,
+      xt::no_ownership(), t->results_shape());
+    auto values_view = xt::view(adapted_array, xt::all(), xt::all(),
+      xt::range(static_cast<int>(TallyResult::SUM), static_cast<int>(TallyResult::SUM_SQ) + 1));
+    xt::xtensor<double, 3> values = values_view;
+
+    // Divide the filter bins as evenly as possible among the processes
+    int n_filter = values.shape()[0];
+    int n_score = values.shape()[1];
+    int row_size = n_score * 2;
+    std::vector<int> counts(mpi::n_procs);
+    std::vector<int> displs(mpi::n_procs);
+    for (int r = 0; r < mpi::n_procs; ++r) {
+      int n_rows = n_filter / mpi::n_procs + (r < n_filter % mpi::n_procs);
+      counts[r] = n_rows * row_size;
+      displs[r] = (r == 0) ? 0 : displs[r - 1] + counts[r - 1];
+    }
+
+    // Sum each range onto the process that writes it
+    std::vector<double> slab(counts[mpi::rank]);
+    MPI_Reduce_scatter(values.data(), slab.data(), counts.data(), MPI_DOUBLE,
+      MPI_SUM, mpi::intracomm);
+
+    std::string groupname {"tally " + std::to_string(t->id_)};
+    hid_t tally_group = open_group(tallies_group, groupname.c_str());
+    write_tally_results_slab(tally_group, n_filter, n_score,
+      displs[mpi::rank] / row_size, counts[mpi::rank] / row_size, slab.data());
+    close_group(tally_group);
+
+    // At the end of the simulation, store the results back in the regular
+    // TallyResults array on the master
+    if (last) {
+      MPI_Gatherv(slab.data(), counts[mpi::rank], MPI_DOUBLE, values.data(),
+        counts.data(), displs.data(), MPI_DOUBLE, 0, mpi::intracomm);
+      if (mpi::master) values_view = values;
+    }
+  }
+  close_group(tallies_group);
+}
+#endif
+
+//! State of the incremental checkpoint: the batch of its base statepoint, a
+//! hash of each block of filter bins of each tally as written there, and the
+//! file and batch of the state of the last batch written or restarted from
+struct Checkpoint {
+  int base_batch {-1};
+  std::vector<std::vector<uint64_t>> block_hashes;
+  std::string last_file;
+  int last_batch {-1};
+};
+
+Checkpoint checkpoint;
+
+//! State of a process part way through a batch, after its first n_sources
+//! source sites have been transported and the particle buffer has drained
+struct BatchCheckpoint {
+  std::string filename;
+  int batch {-1};
+  int64_t n_work;    //!< Source sites of the process in the batch
+  int64_t n_sources; //!< Source sites transported
+  double total_weight;
+  std::array<double, 4> keff_tallies; //!< Absorption, collision, tracklength, leakage
+  int n_lost_particles;
+  int64_t n_split_daughters {0};
+  std::vector<Particle::Bank> sites; //!< Fission sites banked, with those spilled
+  int64_t sites_dropped {0};
+  std::vector<int64_t> progeny;      //!< Progeny of each source site transported
+  std::vector<std::string> tally_names;
+  std::vector<std::vector<double>> tally_values; //!< Scores of each tally so far
+};
+
+//! Copy being written in the background, and the state read on restart
+BatchCheckpoint batch_snapshot;
+BatchCheckpoint batch_resume;
+
+std::string batch_checkpoint_filename(const std::string& base)
+{
+  return fmt::format("{}.batch.{}", base, mpi::rank);
+}
+
+//! Bank datatype with the fields kept only in memory, for sites that are read
+//! back into the fission bank before it is sorted
+hid_t h5fullbanktype()
+{
+  hid_t banktype = h5banktype();
+  H5Tinsert(banktype, "parent_id", HOFFSET(Particle::Bank, parent_id), H5T_NATIVE_INT64);
+  H5Tinsert(banktype, "progeny_id", HOFFSET(Particle::Bank, progeny_id), H5T_NATIVE_INT64);
+  H5Tinsert(banktype, "time", HOFFSET(Particle::Bank, time), H5T_NATIVE_DOUBLE);
+  return banktype;
+}
+
+//! Write the copied state of the batch in progress, on the background thread.
+//! The file is written under a temporary name and renamed, so that a write cut
+//! short leaves the previous one whole.
+void write_batch_snapshot()
+{
+  const auto& s = batch_snapshot;
+  std::string temp = s.filename + ".tmp";
+  hid_t file_id = file_open(temp, 'w');
+  write_attribute(file_id, "filetype", "checkpoint batch");
+  write_attribute(file_id, "version", VERSION_STATEPOINT);
+  write_dataset(file_id, "current_batch", s.batch);
+  write_dataset(file_id, "n_work", s.n_work);
+  write_dataset(file_id, "n_sources", s.n_sources);
+  write_dataset(file_id, "total_weight", s.total_weight);
+  write_dataset(file_id, "keff_tallies", s.keff_tallies);
+  write_dataset(file_id, "n_lost_particles", s.n_lost_particles);
+  write_dataset(file_id, "n_split_daughters", s.n_split_daughters);
+
+  if (settings::run_mode == RunMode::EIGENVALUE) {
+    hid_t banktype = h5fullbanktype();
+    hsize_t dims[] {s.sites.size()};
+    write_dataset_lowlevel(file_id, 1, dims, "fission_sites", banktype,
+      H5S_ALL, false, s.sites.data());
+    H5Tclose(banktype);
+    write_dataset(file_id, "sites_dropped", s.sites_dropped);
+    write_dataset(file_id, "progeny", s.progeny);
+  }
+
+  hid_t tallies_group = create_group(file_id, "tallies");
+  for (int i = 0; i < s.tally_values.size(); ++i) {
+    write_dataset(tallies_group, s.tally_names[i].c_str(), s.tally_values[i]);
+  }
+  close_group(tallies_group);
+  file_close(file_id);
+
+  std::rename(temp.c_str(), s.filename.c_str());
+}
+
+//! Read the state of the batch in progress on this process written next to
+//! the statepoint restarted from, if it was taken in the batch that follows
+void read_batch_checkpoint()
+{
+  std::string filename = batch_checkpoint_filename(settings::path_statepoint);
+  if (!file_exists(filename)) return;
+  hid_t file_id = file_open(filename, 'r');
+
+  auto& s = batch_resume;
+  read_dataset(file_id, "current_batch", s.batch);
+  read_dataset(file_id, "n_work", s.n_work);
+  if (s.batch != simulation::restart_batch + 1 ||
+      s.n_work != simulation::work_per_rank) {
+    s.batch = -1;
+    file_close(file_id);
+    return;
+  }
+  if (!batch_checkpoint_supported()) {
+    warning("The batch in progress in " + filename + " cannot be resumed "
+      "with these settings; the batch is started over.");
+    s.batch = -1;
+    file_close(file_id);
+    return;
+  }
+
+  write_message("Loading batch checkpoint " + filename + "...", 5);
+  read_dataset(file_id, "n_sources", s.n_sources);
+  read_dataset(file_id, "total_weight", s.total_weight);
+  read_dataset(file_id, "keff_tallies", s.keff_tallies);
+  read_dataset(file_id, "n_lost_particles", s.n_lost_particles);
+  read_dataset(file_id, "n_split_daughters", s.n_split_daughters);
+
+  if (settings::run_mode == RunMode::EIGENVALUE) {
+    hid_t banktype = h5fullbanktype();
+    hid_t dset = H5Dopen(file_id, "fission_sites", H5P_DEFAULT);
+    hid_t dspace = H5Dget_space(dset);
+    s.sites.resize(H5Sget_simple_extent_npoints(dspace));
+    H5Dread(dset, banktype, H5S_ALL, H5S_ALL, H5P_DEFAULT, s.sites.data());
+    H5Sclose(dspace);
+    H5Dclose(dset);
+    H5Tclose(banktype);
+    read_dataset(file_id, "sites_dropped", s.sites_dropped);
+    read_dataset(file_id, "progeny", s.progeny);
+  }
+
+  hid_t tallies_group = open_group(file_id, "tallies");
+  s.tally_values.assign(model::tallies_size, {});
+  for (int i = 0; i < model::tallies_size; ++i) {
+    const auto& t = model::tallies[i];
+    std::string name = "tally " + std::to_string(t.id_);
+    if (!object_exists(tallies_group, name.c_str())) continue;
+    auto& values = s.tally_values[i];
+    read_dataset(tallies_group, name.c_str(), values);
+    if (values.size() != t.results_shape()[0] * t.results_shape()[1]) {
+      fatal_error("The scores of tally " + std::to_string(t.id_) + " in " +
+        filename + " do not match its filters and scores.");
+    }
+  }
+  close_group(tallies_group);
+  file_close(file_id);
+}
+
+//! Number of filter bins in each block of a tally compared between checkpoints
+int checkpoint_block_rows(const Tally& t)
+{
+  int row_bytes = t.results_shape()[1] * 2 * sizeof(double);
+  return std::max<int>(1, CHECKPOINT_BLOCK_BYTES / row_bytes);
+}
+
+//! 64-bit FNV-1a hash of the sum and sum_sq of filter bins [begin, end) of a
+//! tally, taken a value at a time
+uint64_t hash_tally_rows(const Tally& t, int begin, int end)
+{
+  int n_score = t.results_shape()[1];
+  uint64_t h = 14695981039346656037ull;
+  for (int i = begin * n_score; i < end * n_score; ++i) {
+    for (auto r : {TallyResult::SUM, TallyResult::SUM_SQ}) {
+      uint64_t bits;
+      std::memcpy(&bits, &t.results_[3*i + static_cast<int>(r)], sizeof(bits));
+      h ^= bits;
+      h *= 1099511628211ull;
+    }
+  }
+  return h;
+}
+
+//! Hash of each block of each writable tally, empty for the others
+std::vector<std::vector<uint64_t>> hash_tally_blocks()
+{
+  std::vector<std::vector<uint64_t>> hashes(model::tallies_size);
+  for (int i = 0; i < model::tallies_size; ++i) {
+    const auto& t = model::tallies[i];
+    if (!t.writable_) continue;
+    int n_filter = t.results_shape()[0];
+    int rows = checkpoint_block_rows(t);
+    for (int b = 0; b < n_filter; b += rows) {
+      hashes[i].push_back(hash_tally_rows(t, b, std::min(b + rows, n_filter)));
+    }
+  }
+  return hashes;
+}
+
+//! Record the file holding the state at the end of the current batch, and
+//! remove the checkpoints of the batch in progress taken next to the last one
+void set_last_checkpoint(const std::string& filename)
+{
+  if (!checkpoint.last_file.empty()) {
+    finish_statepoint_write();
+    std::remove(batch_checkpoint_filename(checkpoint.last_file).c_str());
+  }
+  checkpoint.last_file = filename;
+  checkpoint.last_batch = simulation::current_batch;
+}
+
+} // namespace
+
+void finish_statepoint_write()
+{
+  std::lock_guard<std::mutex> lock(writer.mutex);
+  if (writer.thread.joinable()) writer.thread.join();
+}
+
 extern "C" int
 openmc_statepoint_write(const char* filename, bool* write_source)
 {
+  ProfileRange range {"statepoint_write"};
   simulation::time_statepoint.start();
 
+  // The HDF5 library is only used by one thread at a time
+  finish_statepoint_write();
+
+  // Tally results are written in the background when they are reduced, in
+  // which case only the master process writes them
+  bool async = settings::async_statepoint && settings::reduce_tallies;
+
+  // Bring results accumulated on device up to date
+  sync_tally_results_to_host();
+  sync_tally_stats_to_host();
+
   // Set the filename
   std::string filename_;
   if (filename) {
@@ -235,12 +582,32 @@ openmc_statepoint_write(const char* filename, bool* write_source)
         write_dataset(tally_group, "n_score_bins", scores.size());
         write_dataset(tally_group, "score_bins", scores);
 
+        // Write the scoring cost counters, if kept
+        if (tally->stats_) {
+          const auto& stats = *tally->stats_;
+          hid_t stats_group = create_group(tally_group, "stats");
+          write_dataset(stats_group, "events", stats.events);
+          write_dataset(stats_group, "combinations", stats.combinations);
+          write_dataset(stats_group, "results", stats.results);
+          write_dataset(stats_group, "sampled events", stats.sampled_events);
+          write_dataset(stats_group, "sampled time", stats.sampled_time);
+          write_dataset(stats_group, "estimated time", stats.estimated_time());
+          close_group(stats_group);
+        }
+
         close_group(tally_group);
       }
 
     }
 
-    if (settings::reduce_tallies) {
+    if (async) {
+      // Copy the results, to be written once the rest of the file is
+      write_attribute(file_id, "tallies_present",
+        model::active_tallies.size() > 0 ? 1 : 0);
+      snapshot_tally_results();
+      if (model::active_tallies.empty()) writer.tallies.clear();
+
+    } else if (settings::reduce_tallies) {
       // Write global tallies
       write_dataset(file_id, "global_tallies", simulation::global_tallies);
 
@@ -286,7 +653,12 @@ openmc_statepoint_write(const char* filename, bool* write_source)
     using namespace simulation;
     hid_t runtime_group = create_group(file_id, "runtime");
     write_dataset(runtime_group, "total initialization",  time_initialize.elapsed());
+    write_dataset(runtime_group, "reading materials", time_read_materials.elapsed());
+    write_dataset(runtime_group, "reading geometry", time_read_geometry.elapsed());
+    write_dataset(runtime_group, "finalizing geometry", time_finalize_geometry.elapsed());
     write_dataset(runtime_group, "reading cross sections", time_read_xs.elapsed());
+    write_dataset(runtime_group, "reading tallies", time_read_tallies.elapsed());
+    write_dataset(runtime_group, "preparing distribcells", time_distribcell.elapsed());
     write_dataset(runtime_group, "simulation", time_inactive.elapsed()
       + time_active.elapsed());
     write_dataset(runtime_group, "transport", time_transport.elapsed());
@@ -296,12 +668,17 @@ openmc_statepoint_write(const char* filename, bool* write_source)
     write_dataset(runtime_group, "active batches", time_active.elapsed());
     if (settings::run_mode == RunMode::EIGENVALUE) {
       write_dataset(runtime_group, "synchronizing fission bank", time_bank.elapsed());
+      write_dataset(runtime_group, "sorting fission sites", time_bank_sort.elapsed());
       write_dataset(runtime_group, "sampling source sites", time_bank_sample.elapsed());
       write_dataset(runtime_group, "SEND-RECV source sites", time_bank_sendrecv.elapsed());
     }
     write_dataset(runtime_group, "accumulating tallies", time_accumulate_tallies.elapsed());
     write_dataset(runtime_group, "total", time_total.elapsed());
     write_dataset(runtime_group, "writing statepoints", time_statepoint.elapsed());
+    if (settings::event_based && settings::kernel_profile) {
+      flush_kernel_profile();
+      write_kernel_profile(runtime_group);
+    }
     close_group(runtime_group);
 
     file_close(file_id);
@@ -309,6 +686,13 @@ openmc_statepoint_write(const char* filename, bool* write_source)
 
 #ifdef PHDF5
   bool parallel = true;
+
+  // Write the results of tallies that were not reduced from every process
+  if (!settings::reduce_tallies) {
+    file_id = file_open(filename_, 'a', true);
+    write_tally_results_parallel(file_id);
+    file_close(file_id);
+  }
 #else
   bool parallel = false;
 #endif
@@ -320,11 +704,255 @@ openmc_statepoint_write(const char* filename, bool* write_source)
     if (mpi::master || parallel) file_close(file_id);
   }
 
+  // Write the tally results while transport continues
+  if (async && mpi::master) {
+    writer.filename = filename_;
+    writer.thread = std::thread(write_tally_snapshot);
+  }
+
   simulation::time_statepoint.stop();
 
   return 0;
 }
 
+void write_checkpoint()
+{
+  std::string filename = settings::path_output + "checkpoint.h5";
+  std::string delta_filename = filename + ".delta";
+  bool write_source = (settings::run_mode == RunMode::EIGENVALUE);
+
+  // Find the blocks of filter bins that changed since the base was written.
+  // Tallies that are not reduced each batch are only whole in a statepoint.
+  std::vector<std::vector<int>> changed(model::tallies_size);
+  bool full = checkpoint.base_batch < 0 || !settings::reduce_tallies;
+  if (!full) sync_tally_results_to_host();
+  if (!full && mpi::master) {
+    auto hashes = hash_tally_blocks();
+    size_t n_blocks = 0;
+    size_t n_changed = 0;
+    for (int i = 0; i < model::tallies_size; ++i) {
+      for (int b = 0; b < hashes[i].size(); ++b) {
+        ++n_blocks;
+        if (hashes[i][b] != checkpoint.block_hashes[i][b]) {
+          changed[i].push_back(b);
+          ++n_changed;
+        }
+      }
+    }
+
+    // Once most blocks have changed, a new base costs little more
+    full = 2 * n_changed > n_blocks;
+  }
+#ifdef OPENMC_MPI
+  MPI_Bcast(&full, 1, MPI_C_BOOL, 0, mpi::intracomm);
+#endif
+
+  // Each file is written under a temporary name and renamed, so that an
+  // interrupted checkpoint leaves the previous one whole
+  if (full) {
+    std::string temp = filename + ".tmp";
+    openmc_statepoint_write(temp.c_str(), &write_source);
+    finish_statepoint_write();
+    if (mpi::master) {
+      if (std::rename(temp.c_str(), filename.c_str()) != 0) {
+        warning(fmt::format("Could not write checkpoint {}.", filename));
+      }
+      std::remove(delta_filename.c_str());
+      if (settings::reduce_tallies) checkpoint.block_hashes = hash_tally_blocks();
+    }
+    checkpoint.base_batch = simulation::current_batch;
+    set_last_checkpoint(filename);
+    return;
+  }
+
+  simulation::time_statepoint.start();
+  finish_statepoint_write();
+  write_message("Updating checkpoint " + filename + "...", 5);
+
+  std::string temp = delta_filename + ".tmp";
+  hid_t file_id;
+  if (mpi::master) {
+    file_id = file_open(temp, 'w');
+    write_attribute(file_id, "filetype", "checkpoint delta");
+    write_attribute(file_id, "version", VERSION_STATEPOINT);
+    write_attribute(file_id, "base_batch", checkpoint.base_batch);
+    write_attribute(file_id, "source_present", write_source);
+    write_dataset(file_id, "current_batch", simulation::current_batch);
+    write_dataset(file_id, "n_realizations", simulation::n_realizations);
+    if (settings::run_mode == RunMode::EIGENVALUE)
+      write_eigenvalue_hdf5(file_id);
+    write_dataset(file_id, "global_tallies", simulation::global_tallies);
+
+    // Write the sum and sum_sq of the filter bins of the changed blocks
+    hid_t tallies_group = create_group(file_id, "tallies");
+    for (int i = 0; i < model::tallies_size; ++i) {
+      const auto& t = model::tallies[i];
+      if (!t.writable_) continue;
+      hid_t tally_group = create_group(tallies_group,
+        "tally " + std::to_string(t.id_));
+      write_dataset(tally_group, "n_realizations", t.n_realizations_);
+
+      int rows = checkpoint_block_rows(t);
+      int n_filter = t.results_shape()[0];
+      int n_score = t.results_shape()[1];
+      std::vector<double> values;
+      for (int b : changed[i]) {
+        int end = std::min((b + 1) * rows, n_filter) * n_score;
+        for (int j = b * rows * n_score; j < end; ++j) {
+          values.push_back(t.results_[3*j + static_cast<int>(TallyResult::SUM)]);
+          values.push_back(t.results_[3*j + static_cast<int>(TallyResult::SUM_SQ)]);
+        }
+      }
+      write_dataset(tally_group, "block_rows", rows);
+      write_dataset(tally_group, "blocks", changed[i]);
+      write_dataset(tally_group, "results", values);
+      close_group(tally_group);
+    }
+    close_group(tallies_group);
+    file_close(file_id);
+  }
+
+#ifdef PHDF5
+  bool parallel = true;
+#else
+  bool parallel = false;
+#endif
+
+  if (write_source) {
+    if (mpi::master || parallel) file_id = file_open(temp, 'a', true);
+    write_source_bank(file_id, false);
+    if (mpi::master || parallel) file_close(file_id);
+  }
+
+  if (mpi::master && std::rename(temp.c_str(), delta_filename.c_str()) != 0) {
+    warning(fmt::format("Could not write checkpoint {}.", delta_filename));
+  }
+  set_last_checkpoint(filename);
+
+  simulation::time_statepoint.stop();
+}
+
+bool batch_checkpoint_supported()
+{
+  return settings::event_based && settings::gen_per_batch == 1 &&
+    !settings::hybrid_transport && !settings::async_bank_exchange &&
+    !domain_decomposed() && !settings::surf_source_write &&
+    !settings::cmfd_run;
+}
+
+bool write_batch_checkpoint(int64_t n_sources)
+{
+  // A batch can only be resumed from the state of the batch before it
+  if (checkpoint.last_batch != simulation::current_batch - 1) return false;
+
+  simulation::time_statepoint.start();
+
+  // The HDF5 library is only used by one thread at a time, and the copy of the
+  // last batch checkpoint is reused
+  finish_statepoint_write();
+
+  auto& s = batch_snapshot;
+  s.filename = batch_checkpoint_filename(checkpoint.last_file);
+  s.batch = simulation::current_batch;
+  s.n_work = simulation::work_per_rank;
+  s.n_sources = n_sources;
+  s.total_weight = simulation::total_weight;
+  s.keff_tallies = {global_tally_absorption, global_tally_collision,
+    global_tally_tracklength, global_tally_leakage};
+  s.n_lost_particles = simulation::n_lost_particles;
+  if (settings::weight_windows_on) {
+    #pragma omp target update from(variance_reduction::n_split_daughters)
+    s.n_split_daughters = variance_reduction::n_split_daughters;
+  }
+
+  // Fission sites banked so far, which are sorted with the rest at the end of
+  // the batch by the progeny counts of their parents
+  if (settings::run_mode == RunMode::EIGENVALUE) {
+    simulation::fission_bank.copy_device_to_host();
+    copy_fission_spill_to_host();
+    auto& bank = simulation::fission_bank;
+    auto& spill = simulation::fission_spill;
+    s.sites.assign(bank.data(), bank.data() + bank.size());
+    s.sites.insert(s.sites.end(), spill.data(), spill.data() + spill.size());
+    s.sites_dropped = simulation::fission_sites_dropped;
+    #pragma omp target update from(simulation::device_progeny_per_particle[:n_sources])
+    s.progeny.assign(simulation::progeny_per_particle.begin(),
+      simulation::progeny_per_particle.begin() + n_sources);
+  }
+
+  // Scores so far. The copies on host are replaced by those on device again at
+  // the end of the batch.
+  s.tally_names.clear();
+  s.tally_values.clear();
+  if (!model::active_tallies.empty()) {
+    reduce_tally_scores();
+    for (int i = 0; i < model::tallies_size; ++i) {
+      auto& t = model::tallies[i];
+      t.update_device_to_host();
+      if (t.accumulate_on_device_) {
+        double* results = t.results_;
+        #pragma omp target update from(results[:t.results_size_])
+      }
+      size_t n_bins = t.results_shape()[0] * t.results_shape()[1];
+      std::vector<double> values(n_bins);
+      for (size_t j = 0; j < n_bins; ++j) {
+        values[j] = t.results_[3*j + static_cast<int>(TallyResult::VALUE)];
+      }
+      s.tally_names.push_back("tally " + std::to_string(t.id_));
+      s.tally_values.push_back(std::move(values));
+    }
+  }
+
+  writer.thread = std::thread(write_batch_snapshot);
+  simulation::time_statepoint.stop();
+  return true;
+}
+
+int64_t resume_batch_checkpoint()
+{
+  auto& s = batch_resume;
+  if (s.batch != simulation::current_batch) return 0;
+  s.batch = -1;
+
+  simulation::total_weight += s.total_weight;
+  global_tally_absorption += s.keff_tallies[0];
+  global_tally_collision += s.keff_tallies[1];
+  global_tally_tracklength += s.keff_tallies[2];
+  global_tally_leakage += s.keff_tallies[3];
+  simulation::n_lost_particles = s.n_lost_particles;
+  if (settings::weight_windows_on) {
+    variance_reduction::n_split_daughters = s.n_split_daughters;
+    #pragma omp target update to(variance_reduction::n_split_daughters)
+  }
+
+  if (settings::run_mode == RunMode::EIGENVALUE) {
+    append_fission_sites(s.sites.data(), s.sites.size());
+    simulation::fission_bank.copy_host_to_device();
+    simulation::fission_sites_dropped = s.sites_dropped;
+    #pragma omp target update to(simulation::fission_sites_dropped)
+    std::copy(s.progeny.begin(), s.progeny.end(),
+      simulation::progeny_per_particle.begin());
+    #pragma omp target update to(simulation::device_progeny_per_particle[:s.n_sources])
+  }
+
+  // Scores accumulated on device are sent there now, and the others when the
+  // tallies are sent for transport
+  for (int i = 0; i < s.tally_values.size(); ++i) {
+    auto& t = model::tallies[i];
+    const auto& values = s.tally_values[i];
+    if (values.empty()) continue;
+    for (size_t j = 0; j < values.size(); ++j) {
+      t.results_[3*j + static_cast<int>(TallyResult::VALUE)] += values[j];
+    }
+    if (t.accumulate_on_device_) t.sync_results_to_device();
+  }
+
+  s.sites.clear();
+  s.progeny.clear();
+  s.tally_values.clear();
+  return s.n_sources;
+}
+
 void restart_set_keff()
 {
   if (simulation::restart_batch > settings::n_inactive) {
@@ -423,6 +1051,31 @@ void load_state_point()
   // Read number of realizations for global tallies
   read_dataset(file_id, "n_realizations", simulation::n_realizations);
 
+  // A checkpoint delta written after this file holds the later batch state
+  hid_t delta_id = -1;
+  bool delta_source = false;
+  std::string delta_filename = settings::path_statepoint + ".delta";
+  if (file_exists(delta_filename)) {
+    delta_id = file_open(delta_filename, 'r', true);
+    int base_batch;
+    read_attribute(delta_id, "base_batch", base_batch);
+    if (base_batch == simulation::restart_batch) {
+      write_message("Loading checkpoint delta " + delta_filename + "...", 5);
+      read_dataset(delta_id, "current_batch", simulation::restart_batch);
+      if (simulation::restart_batch > settings::n_batches) {
+        fatal_error("The number batches specified in settings.xml is fewer "
+          " than the number of batches in the given checkpoint.");
+      }
+      if (settings::run_mode == RunMode::EIGENVALUE)
+        read_eigenvalue_hdf5(delta_id);
+      read_dataset(delta_id, "n_realizations", simulation::n_realizations);
+      read_attribute(delta_id, "source_present", delta_source);
+    } else {
+      file_close(delta_id);
+      delta_id = -1;
+    }
+  }
+
   // Set k_sum, keff, and current_batch based on whether restart file is part
   // of active cycle or inactive cycle
   if (settings::run_mode == RunMode::EIGENVALUE) {
@@ -467,6 +1120,7 @@ void load_state_point()
 
           read_tally_results(tally_group, tally.results_shape()[0],
             tally.results_shape()[1], tally.results_);
+          if (tally.accumulate_on_device_) tally.sync_results_to_device();
           read_dataset(tally_group, "n_realizations", tally.n_realizations_);
           close_group(tally_group);
         }
@@ -474,10 +1128,50 @@ void load_state_point()
 
       close_group(tallies_group);
     }
+
+    // Replace the blocks of filter bins that changed since the base
+    if (delta_id >= 0) {
+      read_dataset_lowlevel(delta_id, "global_tallies", H5T_NATIVE_DOUBLE,
+        H5S_ALL, false, simulation::global_tallies.data());
+
+      hid_t tallies_group = open_group(delta_id, "tallies");
+      for (int i = 0; i < model::tallies_size; ++i) {
+        auto& tally = model::tallies[i];
+        std::string name = "tally " + std::to_string(tally.id_);
+        if (!tally.writable_ || !object_exists(tallies_group, name.c_str())) {
+          continue;
+        }
+        hid_t tally_group = open_group(tallies_group, name.c_str());
+        read_dataset(tally_group, "n_realizations", tally.n_realizations_);
+        int rows;
+        std::vector<int> blocks;
+        std::vector<double> values;
+        read_dataset(tally_group, "block_rows", rows);
+        read_dataset(tally_group, "blocks", blocks);
+        read_dataset(tally_group, "results", values);
+        close_group(tally_group);
+
+        int n_filter = tally.results_shape()[0];
+        int n_score = tally.results_shape()[1];
+        int k = 0;
+        for (int b : blocks) {
+          int end = std::min((b + 1) * rows, n_filter) * n_score;
+          for (int j = b * rows * n_score; j < end; ++j) {
+            tally.results_[3*j + static_cast<int>(TallyResult::SUM)] = values[k++];
+            tally.results_[3*j + static_cast<int>(TallyResult::SUM_SQ)] = values[k++];
+          }
+        }
+        if (tally.accumulate_on_device_) tally.sync_results_to_device();
+      }
+      close_group(tallies_group);
+    }
   }
 
   // Read source if in eigenvalue mode
-  if (settings::run_mode == RunMode::EIGENVALUE) {
+  if (delta_id >= 0 && delta_source) {
+    read_source_bank(delta_id, simulation::source_bank, true);
+
+  } else if (settings::run_mode == RunMode::EIGENVALUE) {
 
     // Check if source was written out separately
     if (!source_present) {
@@ -499,7 +1193,13 @@ void load_state_point()
   }
 
   // Close file
+  if (delta_id >= 0) file_close(delta_id);
   file_close(file_id);
+
+  // The batch that follows may have been checkpointed part way through
+  checkpoint.last_file = settings::path_statepoint;
+  checkpoint.last_batch = simulation::restart_batch;
+  read_batch_checkpoint();
 }
 
 
@@ -530,6 +1230,43 @@ hid_t h5banktype() {
   return banktype;
 }
 
+hid_t h5packed_banktype() {
+  // Same fields as h5banktype(), but with the direction and weight in single
+  // precision and the delayed group and particle type as 8-bit integers. Sites
+  // are converted to and from this layout by HDF5 as they are written and read.
+  hid_t postype = H5Tcreate(H5T_COMPOUND, 3*sizeof(double));
+  H5Tinsert(postype, "x", 0, H5T_NATIVE_DOUBLE);
+  H5Tinsert(postype, "y", sizeof(double), H5T_NATIVE_DOUBLE);
+  H5Tinsert(postype, "z", 2*sizeof(double), H5T_NATIVE_DOUBLE);
+
+  hid_t dirtype = H5Tcreate(H5T_COMPOUND, 3*sizeof(float));
+  H5Tinsert(dirtype, "x", 0, H5T_NATIVE_FLOAT);
+  H5Tinsert(dirtype, "y", sizeof(float), H5T_NATIVE_FLOAT);
+  H5Tinsert(dirtype, "z", 2*sizeof(float), H5T_NATIVE_FLOAT);
+
+  size_t size = 3*sizeof(double) + 3*sizeof(float) + sizeof(double) +
+    sizeof(float) + 2*sizeof(int8_t) + sizeof(int32_t);
+  hid_t banktype = H5Tcreate(H5T_COMPOUND, size);
+  size_t offset = 0;
+  H5Tinsert(banktype, "r", offset, postype);
+  offset += 3*sizeof(double);
+  H5Tinsert(banktype, "u", offset, dirtype);
+  offset += 3*sizeof(float);
+  H5Tinsert(banktype, "E", offset, H5T_NATIVE_DOUBLE);
+  offset += sizeof(double);
+  H5Tinsert(banktype, "wgt", offset, H5T_NATIVE_FLOAT);
+  offset += sizeof(float);
+  H5Tinsert(banktype, "delayed_group", offset, H5T_NATIVE_INT8);
+  offset += sizeof(int8_t);
+  H5Tinsert(banktype, "surf_id", offset, H5T_NATIVE_INT32);
+  offset += sizeof(int32_t);
+  H5Tinsert(banktype, "particle", offset, H5T_NATIVE_INT8);
+
+  H5Tclose(postype);
+  H5Tclose(dirtype);
+  return banktype;
+}
+
 std::vector<int64_t> calculate_surf_source_size()
 {
   std::vector<int64_t> surf_source_index;
@@ -566,6 +1303,9 @@ write_source_point(const char* filename, bool surf_source_bank)
   bool parallel = false;
 #endif
 
+  // The HDF5 library is only used by one thread at a time
+  finish_statepoint_write();
+
   std::string filename_;
   if (filename) {
     filename_ = filename;
@@ -577,6 +1317,13 @@ write_source_point(const char* filename, bool surf_source_bank)
       settings::path_output, simulation::current_batch, w);
   }
 
+  // Each process writes its own surface source sites without waiting on the
+  // others
+  if (surf_source_bank && settings::surf_source_per_rank) {
+    write_surf_source_per_rank(filename_);
+    return;
+  }
+
   hid_t file_id;
   if (mpi::master || parallel) {
     file_id = file_open(filename_, 'w', true);
@@ -589,20 +1336,83 @@ write_source_point(const char* filename, bool surf_source_bank)
   if (mpi::master || parallel) file_close(file_id);
 }
 
+void
+write_surf_source_per_rank(const std::string& filename)
+{
+  hid_t banktype = h5banktype();
+  hid_t filetype = settings::packed_bank ? h5packed_banktype() : banktype;
+  auto bank_index = calculate_surf_source_size();
+
+  // Files of each process are named after the joined file
+  std::string stem = filename;
+  if (ends_with(stem, ".h5")) stem.erase(stem.size() - 3);
+  auto rank_filename = [&stem](int rank) {
+    return fmt::format("{}.{}.h5", stem, rank);
+  };
+
+  // Write the sites of this process
+  hid_t file_id = file_open(rank_filename(mpi::rank), 'w');
+  write_attribute(file_id, "filetype", "source");
+  hsize_t count[] {static_cast<hsize_t>(simulation::surf_source_bank.size())};
+  hid_t dspace = H5Screate_simple(1, count, nullptr);
+  hid_t dcpl = dataset_create_plist(file_id, filetype, 1, count, false);
+  hid_t dset = H5Dcreate(file_id, "source_bank", filetype, dspace,
+                         H5P_DEFAULT, dcpl, H5P_DEFAULT);
+  if (dcpl != H5P_DEFAULT) H5Pclose(dcpl);
+  if (count[0] > 0) {
+    H5Dwrite(dset, banktype, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+      simulation::surf_source_bank.data());
+  }
+  H5Dclose(dset);
+  H5Sclose(dspace);
+  file_close(file_id);
+
+  if (mpi::master) {
+    // Map each range of the joined dataset onto the file of its process
+    hsize_t dims[] {static_cast<hsize_t>(bank_index[mpi::n_procs])};
+    hid_t vspace = H5Screate_simple(1, dims, nullptr);
+    dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    for (int i = 0; i < mpi::n_procs; ++i) {
+      hsize_t start[] {static_cast<hsize_t>(bank_index[i])};
+      hsize_t n[] {static_cast<hsize_t>(bank_index[i+1] - bank_index[i])};
+      if (n[0] == 0) continue;
+      H5Sselect_hyperslab(vspace, H5S_SELECT_SET, start, nullptr, n, nullptr);
+      hid_t srcspace = H5Screate_simple(1, n, nullptr);
+      H5Pset_virtual(dcpl, vspace, rank_filename(i).c_str(), "source_bank",
+        srcspace);
+      H5Sclose(srcspace);
+    }
+
+    file_id = file_open(filename, 'w');
+    write_attribute(file_id, "filetype", "source");
+    dset = H5Dcreate(file_id, "source_bank", filetype, vspace, H5P_DEFAULT,
+      dcpl, H5P_DEFAULT);
+    H5Dclose(dset);
+    file_close(file_id);
+    H5Pclose(dcpl);
+    H5Sclose(vspace);
+  }
+
+  if (filetype != banktype) H5Tclose(filetype);
+  H5Tclose(banktype);
+}
+
 void
 write_source_bank(hid_t group_id, bool surf_source_bank)
 {
   hid_t banktype = h5banktype();
+  hid_t filetype = settings::packed_bank ? h5packed_banktype() : banktype;
 
   // Set total and individual process dataspace sizes for source bank
   int64_t dims_size = settings::n_particles;
   int64_t count_size = simulation::work_per_rank;
 
   // Set vectors for source bank and starting bank index of each process
+  update_source_bank_host();
   std::vector<int64_t>* bank_index = &simulation::work_index;
-  std::vector<Particle::Bank>* source_bank = &simulation::source_bank;
+  BankVector* source_bank = &simulation::source_bank;
   std::vector<int64_t> surf_source_index_vector;
-  std::vector<Particle::Bank> surf_source_bank_vector;
+  BankVector surf_source_bank_vector;
 
   // Reset dataspace sizes and vectors for surface source bank
   if (surf_source_bank) {
@@ -623,8 +1433,10 @@ write_source_bank(hid_t group_id, bool surf_source_bank)
   // Set size of total dataspace for all procs and rank
   hsize_t dims[] {static_cast<hsize_t>(dims_size)};
   hid_t dspace = H5Screate_simple(1, dims, nullptr);
-  hid_t dset = H5Dcreate(group_id, "source_bank", banktype, dspace,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t dcpl = dataset_create_plist(group_id, filetype, 1, dims, false);
+  hid_t dset = H5Dcreate(group_id, "source_bank", filetype, dspace,
+                         H5P_DEFAULT, dcpl, H5P_DEFAULT);
+  if (dcpl != H5P_DEFAULT) H5Pclose(dcpl);
 
   // Create another data space but for each proc individually
   hsize_t count[] {static_cast<hsize_t>(count_size)};
@@ -653,8 +1465,10 @@ write_source_bank(hid_t group_id, bool surf_source_bank)
     // Create dataset big enough to hold all source sites
     hsize_t dims[] {static_cast<hsize_t>(dims_size)};
     hid_t dspace = H5Screate_simple(1, dims, nullptr);
-    hid_t dset = H5Dcreate(group_id, "source_bank", banktype, dspace,
-                           H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t dcpl = dataset_create_plist(group_id, filetype, 1, dims, false);
+    hid_t dset = H5Dcreate(group_id, "source_bank", filetype, dspace,
+                           H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    if (dcpl != H5P_DEFAULT) H5Pclose(dcpl);
 
     // Save source bank sites since the array is overwritten below
 #ifdef OPENMC_MPI
@@ -700,6 +1514,7 @@ write_source_bank(hid_t group_id, bool surf_source_bank)
   }
 #endif
 
+  if (filetype != banktype) H5Tclose(filetype);
   H5Tclose(banktype);
 }
 
@@ -717,10 +1532,10 @@ std::string dtype_member_names(hid_t dtype_id)
   return names;
 }
 
-void read_source_bank(hid_t group_id, std::vector<Particle::Bank>& sites, bool distribute)
+//! Open the source_bank dataset of a group, checking that its sites have the
+//! members of banktype
+hid_t open_source_bank(hid_t group_id, hid_t banktype)
 {
-  hid_t banktype = h5banktype();
-
   // Open the dataset
   hid_t dset = H5Dopen(group_id, "source_bank", H5P_DEFAULT);
 
@@ -728,11 +1543,19 @@ void read_source_bank(hid_t group_id, std::vector<Particle::Bank>& sites, bool d
   hid_t dtype = H5Dget_type(dset);
   auto file_member_names = dtype_member_names(dtype);
   auto bank_member_names = dtype_member_names(banktype);
+  H5Tclose(dtype);
   if (file_member_names != bank_member_names) {
     fatal_error(fmt::format("Source site attributes in file do not match what is "
       "expected for this version of OpenMC. File attributes = ({}). Expected "
       "attributes = ({})", file_member_names, bank_member_names));
   }
+  return dset;
+}
+
+void read_source_bank(hid_t group_id, BankVector& sites, bool distribute)
+{
+  hid_t banktype = h5banktype();
+  hid_t dset = open_source_bank(group_id, banktype);
 
   hid_t dspace = H5Dget_space(dset);
   hsize_t n_sites;
@@ -770,6 +1593,10 @@ void read_source_bank(hid_t group_id, std::vector<Particle::Bank>& sites, bool d
   H5Dread(dset, banktype, memspace, dspace, H5P_DEFAULT, sites.data());
 #endif
 
+  // Source files do not store emission times, so every site starts its
+  // history at time zero
+  for (auto& site : sites) site.time = 0.0;
+
   // Close all ids
   H5Sclose(dspace);
   if (distribute) H5Sclose(memspace);
@@ -777,6 +1604,40 @@ void read_source_bank(hid_t group_id, std::vector<Particle::Bank>& sites, bool d
   H5Tclose(banktype);
 }
 
+int64_t source_bank_size(hid_t group_id)
+{
+  hid_t dset = H5Dopen(group_id, "source_bank", H5P_DEFAULT);
+  hid_t dspace = H5Dget_space(dset);
+  hsize_t n_sites;
+  H5Sget_simple_extent_dims(dspace, &n_sites, nullptr);
+  H5Sclose(dspace);
+  H5Dclose(dset);
+  return n_sites;
+}
+
+void read_source_bank_range(hid_t group_id, BankVector& sites, int64_t offset,
+  int64_t n)
+{
+  hid_t banktype = h5banktype();
+  hid_t dset = open_source_bank(group_id, banktype);
+  sites.resize(n);
+
+  // Select the range in the file
+  hid_t dspace = H5Dget_space(dset);
+  hsize_t start = offset;
+  hsize_t count = n;
+  H5Sselect_hyperslab(dspace, H5S_SELECT_SET, &start, nullptr, &count, nullptr);
+  hid_t memspace = H5Screate_simple(1, &count, nullptr);
+
+  H5Dread(dset, banktype, memspace, dspace, H5P_DEFAULT, sites.data());
+  for (auto& site : sites) site.time = 0.0;
+
+  H5Sclose(memspace);
+  H5Sclose(dspace);
+  H5Dclose(dset);
+  H5Tclose(banktype);
+}
+
 #ifdef DAGMC
 void write_unstructured_mesh_results() {
   /*
@@ -906,6 +1767,11 @@ void write_tally_results_nr(hid_t file_id)
       write_attribute(file_id, "tallies_present", 1);
     }
 
+#ifdef PHDF5
+    // Results are written by all processes in write_tally_results_parallel()
+    continue;
+#endif
+
     // Get view of accumulated tally values
     auto adapted_array = xt::adapt(t->results_, t->results_size_,
       xt::no_ownership(), t->results_shape());
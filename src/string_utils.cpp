@@ -81,4 +81,14 @@ bool starts_with(const std::string& value, const std::string& beginning)
   return std::equal(beginning.begin(), beginning.end(), value.begin());
 }
 
+std::string json_string(const std::string& s)
+{
+  std::string out {"\""};
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out + '"';
+}
+
 } // namespace openmc
@@ -1,5 +1,11 @@
 #include "openmc/summary.h"
 
+#include <cstdint>
+#include <fstream>
+#include <iterator> // for istreambuf_iterator
+#include <string>
+#include <vector>
+
 #include <fmt/core.h>
 
 #include "openmc/capi.h"
@@ -14,9 +20,46 @@
 #include "openmc/output.h"
 #include "openmc/surface.h"
 #include "openmc/settings.h"
+#include "openmc/thermal.h"
 
 namespace openmc {
 
+namespace {
+
+// Model input files embedded by the hash summary format, where present
+const char* MODEL_INPUT_FILES[] {"settings.xml", "geometry.xml",
+  "materials.xml", "tallies.xml", "plots.xml", "geometry.h5", "materials.h5"};
+
+//! 64-bit FNV-1a hash, continuing from a previous hash
+uint64_t fnv1a(const std::string& s, uint64_t h = 14695981039346656037ull)
+{
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+//! Write rows of varying length as the values of all rows and, in a dataset
+//! with an "_offsets" suffix, the offset of each row followed by the total,
+//! as in the HDF5 model input
+template<typename T>
+void write_ragged(hid_t group, const std::string& name,
+  const std::vector<std::vector<T>>& rows)
+{
+  std::vector<int64_t> offsets(rows.size() + 1, 0);
+  for (int64_t i = 0; i < rows.size(); ++i) {
+    offsets[i + 1] = offsets[i] + rows[i].size();
+  }
+  std::vector<T> values;
+  values.reserve(offsets.back());
+  for (const auto& row : rows) values.insert(values.end(), row.begin(), row.end());
+  write_dataset(group, name.c_str(), values);
+  write_dataset(group, (name + "_offsets").c_str(), offsets);
+}
+
+} // namespace
+
 void write_summary()
 {
   // Display output message
@@ -27,8 +70,19 @@ void write_summary()
 
   write_header(file);
   write_nuclides(file);
-  write_geometry(file);
-  write_materials(file);
+  switch (settings::summary_format) {
+  case SummaryFormat::full:
+    write_geometry(file);
+    write_materials(file);
+    break;
+  case SummaryFormat::compact:
+    write_geometry_compact(file);
+    write_materials_compact(file);
+    break;
+  case SummaryFormat::hash:
+    write_model_input(file);
+    break;
+  }
 
   // Terminate access to the file.
   file_close(file);
@@ -39,6 +93,9 @@ void write_header(hid_t file)
   // Write filetype and version info
   write_attribute(file, "filetype", "summary");
   write_attribute(file, "version", VERSION_SUMMARY);
+  const char* formats[] {"full", "compact", "hash"};
+  write_attribute(file, "format",
+    formats[static_cast<int>(settings::summary_format)]);
   write_attribute(file, "openmc_version", VERSION);
 #ifdef GIT_SHA1
   write_attribute(file, "git_sha1", GIT_SHA1);
@@ -139,6 +196,191 @@ void write_materials(hid_t file)
   close_group(materials_group);
 }
 
+void write_geometry_compact(hid_t file)
+{
+  auto geom_group = create_group(file, "geometry");
+
+#ifdef DAGMC
+  if (settings::dagmc) {
+    write_attribute(geom_group, "dagmc", 1);
+    close_group(geom_group);
+    return;
+  }
+#endif
+
+  write_attribute(geom_group, "n_cells", model::cells.size());
+  write_attribute(geom_group, "n_surfaces", model::surfaces.size());
+  write_attribute(geom_group, "n_universes", model::universes.size());
+  write_attribute(geom_group, "n_lattices", model::lattices.size());
+
+  // Surfaces and lattices are written as in the full format; there are few of
+  // them next to the cells and materials of large models
+  auto surfaces_group = create_group(geom_group, "surfaces");
+  for (const auto& surf : model::surfaces) surf.to_hdf5(surfaces_group);
+  close_group(surfaces_group);
+
+  auto lattices_group = create_group(geom_group, "lattices");
+  for (const auto& lat : model::lattices) lat.to_hdf5(lattices_group);
+  close_group(lattices_group);
+
+  // The rows of each cell are built in parallel and written one dataset each
+  int64_t n = model::cells.size();
+  std::vector<int> id(n), universe(n), fill(n);
+  std::vector<std::string> name(n), fill_type(n);
+  std::vector<std::vector<char>> region(n);
+  std::vector<std::vector<int>> material(n);
+  std::vector<std::vector<double>> temperature(n), translation(n), rotation(n);
+
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (int64_t i = 0; i < n; ++i) {
+    const auto& c = model::cells[i];
+    id[i] = c.id_;
+    name[i] = c.name_;
+    universe[i] = model::universes[c.universe_].id_;
+    std::string spec = c.region_spec();
+    region[i].assign(spec.begin(), spec.end());
+    fill[i] = -1;
+    if (c.type_ == Fill::MATERIAL) {
+      fill_type[i] = "material";
+      for (auto i_mat : c.material_) {
+        material[i].push_back(i_mat == MATERIAL_VOID ? MATERIAL_VOID :
+          model::materials[i_mat].id_);
+      }
+      for (auto sqrtkT : c.sqrtkT_) {
+        temperature[i].push_back(sqrtkT * sqrtkT / K_BOLTZMANN);
+      }
+    } else if (c.type_ == Fill::UNIVERSE) {
+      fill_type[i] = "universe";
+      fill[i] = model::universes[c.fill_].id_;
+      if (c.translation_ != Position(0, 0, 0)) {
+        translation[i] = {c.translation_.x, c.translation_.y, c.translation_.z};
+      }
+      if (c.rotation_length_ == 12) {
+        rotation[i].assign(c.rotation_ + 9, c.rotation_ + 12);
+      } else {
+        rotation[i].assign(c.rotation_, c.rotation_ + c.rotation_length_);
+      }
+    } else {
+      fill_type[i] = "lattice";
+      fill[i] = model::lattices[c.fill_].id_;
+    }
+  }
+
+  auto cells_group = create_group(geom_group, "cells");
+  write_dataset(cells_group, "id", id);
+  write_dataset(cells_group, "name", name);
+  write_dataset(cells_group, "universe", universe);
+  write_dataset(cells_group, "fill_type", fill_type);
+  write_dataset(cells_group, "fill", fill);
+  write_ragged(cells_group, "region", region);
+  write_ragged(cells_group, "material", material);
+  write_ragged(cells_group, "temperature", temperature);
+  write_ragged(cells_group, "translation", translation);
+  write_ragged(cells_group, "rotation", rotation);
+  close_group(cells_group);
+
+  std::vector<int> universe_id;
+  std::vector<std::vector<int>> universe_cells;
+  for (const auto& u : model::universes) {
+    universe_id.push_back(u.id_);
+    universe_cells.emplace_back();
+    for (auto i_cell : u.cells_) {
+      universe_cells.back().push_back(model::cells[i_cell].id_);
+    }
+  }
+  auto universes_group = create_group(geom_group, "universes");
+  write_dataset(universes_group, "id", universe_id);
+  write_ragged(universes_group, "cells", universe_cells);
+  close_group(universes_group);
+
+  close_group(geom_group);
+}
+
+void write_materials_compact(hid_t file)
+{
+  write_dataset(file, "n_materials", model::materials_size);
+
+  // Materials refer to nuclides and thermal scattering tables by index
+  std::vector<std::string> nuclide_names, sab_names;
+  for (int i = 0; i < data::nuclides_size; ++i) {
+    nuclide_names.push_back(settings::run_CE ? data::nuclides[i].name_ :
+      data::mg.nuclides_[i].name);
+  }
+  for (const auto& table : data::thermal_scatt) {
+    sab_names.push_back(table.name_);
+  }
+
+  int64_t n = model::materials_size;
+  std::vector<int> id(n), depletable(n);
+  std::vector<std::string> name(n);
+  std::vector<double> volume(n), temperature(n), density(n);
+  std::vector<std::vector<int>> nuclide(n), sab(n);
+  std::vector<std::vector<double>> nuclide_density(n);
+
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (int64_t i = 0; i < n; ++i) {
+    const auto& mat = model::materials[i];
+    id[i] = mat.id_;
+    name[i] = mat.name_;
+    depletable[i] = mat.depletable_;
+    volume[i] = mat.volume_ > 0.0 ? mat.volume_ : -1.0;
+    temperature[i] = mat.temperature_ > 0.0 ? mat.temperature_ : -1.0;
+    density[i] = mat.density_;
+    for (int j = 0; j < mat.nuclide_.size(); ++j) {
+      nuclide[i].push_back(mat.nuclide_[j]);
+      nuclide_density[i].push_back(mat.atom_density_(j));
+    }
+    for (const auto& table : mat.thermal_tables_) {
+      sab[i].push_back(table.index_table);
+    }
+  }
+
+  hid_t materials_group = create_group(file, "materials");
+  if (!nuclide_names.empty()) {
+    write_dataset(materials_group, "nuclide_names", nuclide_names);
+  }
+  if (!sab_names.empty()) {
+    write_dataset(materials_group, "sab_names", sab_names);
+  }
+  write_dataset(materials_group, "id", id);
+  write_dataset(materials_group, "name", name);
+  write_dataset(materials_group, "depletable", depletable);
+  write_dataset(materials_group, "volume", volume);
+  write_dataset(materials_group, "temperature", temperature);
+  write_dataset(materials_group, "atom_density", density);
+  write_ragged(materials_group, "nuclide", nuclide);
+  write_ragged(materials_group, "nuclide_density", nuclide_density);
+  write_ragged(materials_group, "sab", sab);
+  close_group(materials_group);
+}
+
+void write_model_input(hid_t file)
+{
+  // The model can be rebuilt from its input files, which are identified by a
+  // hash of their names and contents
+  hid_t model_group = create_group(file, "model");
+  uint64_t hash = fnv1a("");
+  for (const char* filename : MODEL_INPUT_FILES) {
+    std::ifstream in {settings::path_input + filename, std::ios::binary};
+    if (!in) continue;
+    std::string contents {std::istreambuf_iterator<char>(in),
+      std::istreambuf_iterator<char>()};
+    hash = fnv1a(contents, fnv1a(filename, hash));
+    std::vector<char> bytes(contents.begin(), contents.end());
+    write_dataset(model_group, filename, bytes);
+  }
+  write_attribute(file, "model_hash", fmt::format("{:016x}", hash));
+  close_group(model_group);
+
+  auto geom_group = create_group(file, "geometry");
+  write_attribute(geom_group, "n_cells", model::cells.size());
+  write_attribute(geom_group, "n_surfaces", model::surfaces.size());
+  write_attribute(geom_group, "n_universes", model::universes.size());
+  write_attribute(geom_group, "n_lattices", model::lattices.size());
+  close_group(geom_group);
+  write_dataset(file, "n_materials", model::materials_size);
+}
+
 //==============================================================================
 // C API
 //==============================================================================
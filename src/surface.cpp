@@ -4,6 +4,8 @@
 #include <cmath>
 #include <utility>
 #include <set>
+#include <string>
+#include <vector>
 
 #include <fmt/core.h>
 #include <gsl/gsl>
@@ -130,23 +132,7 @@ Surface::Surface(pugi::xml_node surf_node, Surface::SurfaceType type) : type_(ty
   }
 
   if (check_for_node(surf_node, "boundary")) {
-    std::string surf_bc = get_node_value(surf_node, "boundary", true, true);
-
-    if (surf_bc == "transmission" || surf_bc == "transmit" ||surf_bc.empty()) {
-      // Leave the bc_ a nullptr
-    } else if (surf_bc == "vacuum") {
-      bc_ = BoundaryCondition(BoundaryCondition::BCType::Vacuum);
-    } else if (surf_bc == "reflective" || surf_bc == "reflect"
-               || surf_bc == "reflecting") {
-      bc_ = BoundaryCondition(BoundaryCondition::BCType::Reflective);
-    } else if (surf_bc == "white") {
-      bc_ = BoundaryCondition(BoundaryCondition::BCType::White);
-    } else if (surf_bc == "periodic") {
-      // periodic BC's are handled separately
-    } else {
-      fatal_error(fmt::format("Unknown boundary condition \"{}\" specified "
-        "on surface {}", surf_bc, id_));
-    }
+    set_boundary(get_node_value(surf_node, "boundary", true, true));
   }
   if (check_for_node(surf_node, "periodic_surface_id")) {
     i_periodic_ = std::stoi(get_node_value(surf_node, "periodic_surface_id"));
@@ -169,6 +155,56 @@ Surface::Surface(pugi::xml_node surf_node, Surface::SurfaceType type) : type_(ty
   }
 }
 
+Surface::Surface(int id, SurfaceType type, const std::string& name,
+  const std::string& boundary, const double* coeffs, int n_coeffs)
+  : id_(id), type_(type), name_(name)
+{
+  surf_source_ = contains(settings::source_write_surf_id, id_);
+  set_boundary(boundary);
+
+  // Type specific initializations, in the order of read_coeffs() above
+  std::vector<double*> c;
+  switch(type_){
+    case SurfaceType::SurfaceXPlane:    c = {&x0_}; break;
+    case SurfaceType::SurfaceYPlane:    c = {&y0_}; break;
+    case SurfaceType::SurfaceZPlane:    c = {&z0_}; break;
+    case SurfaceType::SurfacePlane:     c = {&A_, &B_, &C_, &D_}; break;
+    case SurfaceType::SurfaceXCylinder: c = {&y0_, &z0_, &radius_}; break;
+    case SurfaceType::SurfaceYCylinder: c = {&x0_, &z0_, &radius_}; break;
+    case SurfaceType::SurfaceZCylinder: c = {&x0_, &y0_, &radius_}; break;
+    case SurfaceType::SurfaceSphere:    c = {&x0_, &y0_, &z0_, &radius_}; break;
+    case SurfaceType::SurfaceXCone:     c = {&x0_, &y0_, &z0_, &radius_sq_}; break;
+    case SurfaceType::SurfaceYCone:     c = {&x0_, &y0_, &z0_, &radius_sq_}; break;
+    case SurfaceType::SurfaceZCone:     c = {&x0_, &y0_, &z0_, &radius_sq_}; break;
+    case SurfaceType::SurfaceQuadric:
+      c = {&A_, &B_, &C_, &D_, &E_, &F_, &G_, &H_, &J_, &K_}; break;
+  }
+  if (n_coeffs != static_cast<int>(c.size())) {
+    fatal_error(fmt::format("Surface {} expects {} coeffs but was given {}",
+      id_, c.size(), n_coeffs));
+  }
+  for (int i = 0; i < n_coeffs; ++i) *c[i] = coeffs[i];
+}
+
+void Surface::set_boundary(const std::string& surf_bc)
+{
+  if (surf_bc == "transmission" || surf_bc == "transmit" ||surf_bc.empty()) {
+    // Leave the bc_ a nullptr
+  } else if (surf_bc == "vacuum") {
+    bc_ = BoundaryCondition(BoundaryCondition::BCType::Vacuum);
+  } else if (surf_bc == "reflective" || surf_bc == "reflect"
+             || surf_bc == "reflecting") {
+    bc_ = BoundaryCondition(BoundaryCondition::BCType::Reflective);
+  } else if (surf_bc == "white") {
+    bc_ = BoundaryCondition(BoundaryCondition::BCType::White);
+  } else if (surf_bc == "periodic") {
+    // periodic BC's are handled separately
+  } else {
+    fatal_error(fmt::format("Unknown boundary condition \"{}\" specified "
+      "on surface {}", surf_bc, id_));
+  }
+}
+
 bool
 Surface::sense(Position r, Direction u) const
 {
@@ -284,15 +320,16 @@ Direction DAGSurface::normal(Position r) const
 Direction DAGSurface::reflect(Position r, Direction u, Particle* p) const
 {
   Expects(p);
-  p->history_.reset_to_last_intersection();
+  auto& cold = p->cold();
+  cold.history.reset_to_last_intersection();
   moab::ErrorCode rval;
   moab::EntityHandle surf = dagmc_ptr_->entity_by_index(2, dag_index_);
   double pnt[3] = {r.x, r.y, r.z};
   double dir[3];
-  rval = dagmc_ptr_->get_angle(surf, pnt, dir, &p->history_);
+  rval = dagmc_ptr_->get_angle(surf, pnt, dir, &cold.history);
   MB_CHK_ERR_CONT(rval);
-  p->last_dir_ = u.reflect(dir);
-  return p->last_dir_;
+  cold.last_dir = u.reflect(dir);
+  return cold.last_dir;
 }
 
 void DAGSurface::to_hdf5(hid_t group_id) const {}
@@ -732,13 +769,15 @@ double Surface::SurfaceSphere_evaluate(Position r) const
   return x*x + y*y + z*z - radius_*radius_;
 }
 
-double Surface::SurfaceSphere_distance(Position r, Direction u, bool coincident) const
+#pragma omp declare target
+double sphere_distance(Position r, Direction u, bool coincident, double x0,
+  double y0, double z0, double radius)
 {
-  const double x = r.x - x0_;
-  const double y = r.y - y0_;
-  const double z = r.z - z0_;
+  const double x = r.x - x0;
+  const double y = r.y - y0;
+  const double z = r.z - z0;
   const double k = x*u.x + y*u.y + z*u.z;
-  const double c = x*x + y*y + z*z - radius_*radius_;
+  const double c = x*x + y*y + z*z - radius*radius;
   const double quad = k*k - c;
 
   if (quad < 0.0) {
@@ -769,6 +808,12 @@ double Surface::SurfaceSphere_distance(Position r, Direction u, bool coincident)
     return d;
   }
 }
+#pragma omp end declare target
+
+double Surface::SurfaceSphere_distance(Position r, Direction u, bool coincident) const
+{
+  return sphere_distance(r, u, coincident, x0_, y0_, z0_, radius_);
+}
 
 Direction Surface::SurfaceSphere_normal(Position r) const
 {
@@ -1155,87 +1200,257 @@ bool Surface::periodic_translate(const Surface* other, Position& r,
   }
 }
 
+//==============================================================================
+// Surface batches
 //==============================================================================
 
-void read_surfaces(pugi::xml_node node)
+void pack_coefficients(const Surface& surf, vector<double>& coeffs)
 {
-  // Count the number of surfaces
-  int n_surfaces = 0;
-  for (pugi::xml_node surf_node : node.children("surface")) {n_surfaces++;}
-  if (n_surfaces == 0) {
-    fatal_error("No surfaces found in geometry.xml!");
+  switch(surf.type_){
+    case Surface::SurfaceType::SurfaceXPlane:
+      coeffs.push_back(surf.x0_);
+      break;
+    case Surface::SurfaceType::SurfaceYPlane:
+      coeffs.push_back(surf.y0_);
+      break;
+    case Surface::SurfaceType::SurfaceZPlane:
+      coeffs.push_back(surf.z0_);
+      break;
+    case Surface::SurfaceType::SurfaceXCylinder:
+      coeffs.push_back(surf.y0_);
+      coeffs.push_back(surf.z0_);
+      coeffs.push_back(surf.radius_);
+      break;
+    case Surface::SurfaceType::SurfaceYCylinder:
+      coeffs.push_back(surf.x0_);
+      coeffs.push_back(surf.z0_);
+      coeffs.push_back(surf.radius_);
+      break;
+    case Surface::SurfaceType::SurfaceZCylinder:
+      coeffs.push_back(surf.x0_);
+      coeffs.push_back(surf.y0_);
+      coeffs.push_back(surf.radius_);
+      break;
+    case Surface::SurfaceType::SurfacePlane:
+      coeffs.push_back(surf.A_);
+      coeffs.push_back(surf.B_);
+      coeffs.push_back(surf.C_);
+      coeffs.push_back(surf.D_);
+      break;
+    case Surface::SurfaceType::SurfaceSphere:
+      coeffs.push_back(surf.x0_);
+      coeffs.push_back(surf.y0_);
+      coeffs.push_back(surf.z0_);
+      coeffs.push_back(surf.radius_);
+      break;
+    default:
+      break;
   }
+}
 
-  // Loop over XML surface elements and populate the array.  Keep track of
-  // periodic surfaces.
-  model::surfaces.reserve(n_surfaces);
-  std::set<std::pair<int, int>> periodic_pairs;
-  {
-    pugi::xml_node surf_node;
-    int i_surf;
-    for (surf_node = node.child("surface"), i_surf = 0; surf_node;
-         surf_node = surf_node.next_sibling("surface"), i_surf++) {
-      std::string surf_type = get_node_value(surf_node, "type", true, true);
-
-
-      if (surf_type == "x-plane") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfaceXPlane);
-
-      } else if (surf_type == "y-plane") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfaceYPlane);
-
-      } else if (surf_type == "z-plane") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfaceZPlane);
-
-      } else if (surf_type == "plane") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfacePlane);
-
-      } else if (surf_type == "x-cylinder") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfaceXCylinder);
-
-      } else if (surf_type == "y-cylinder") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfaceYCylinder);
-
-      } else if (surf_type == "z-cylinder") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfaceZCylinder);
-
-      } else if (surf_type == "sphere") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfaceSphere);
+#pragma omp declare target
+// Keep the distance if it is nearer than the nearest one so far by more than
+// the floating point precision, so that the first of tied surfaces is kept.
+inline void update_nearest(double d, int32_t token, double& min_dist,
+  int32_t& i_surf)
+{
+  if (d < min_dist && min_dist - d >= FP_PRECISION*min_dist) {
+    min_dist = d;
+    i_surf = -token;
+  }
+}
 
-      } else if (surf_type == "x-cone") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfaceXCone);
+// The template parameter indicates the axis normal to the planes, which are
+// sorted by position. Only the first plane ahead of the particle, that it isn't
+// on, can be the nearest, and it is found by bisection.
+template<int i> void
+plane_batch_distance(int n, const int32_t* tokens, const double* coeffs,
+  Position r, Direction u, int32_t on_surface, double& min_dist,
+  int32_t& i_surf)
+{
+  if (u[i] == 0.0) return;
+
+  // First plane at least FP_COINCIDENT beyond the particle, going forward
+  // along the axis, or last one before it going backward
+  bool forward = u[i] > 0.0;
+  int lo = 0;
+  int hi = n;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (forward ? coeffs[mid] - r[i] < FP_COINCIDENT :
+        r[i] - coeffs[mid] >= FP_COINCIDENT) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  int step = forward ? 1 : -1;
+  for (int k = forward ? lo : lo - 1; k >= 0 && k < n; k += step) {
+    if (std::abs(tokens[k]) == std::abs(on_surface)) continue;
+    // Of planes at the same position, the first one is kept like for other
+    // batches
+    int first = k;
+    while (first > 0 && coeffs[first - 1] == coeffs[k]) --first;
+    for (k = first; std::abs(tokens[k]) == std::abs(on_surface); ++k) {}
+    double d = axis_aligned_plane_distance<i>(r, u, false, coeffs[k]);
+    update_nearest(d, tokens[k], min_dist, i_surf);
+    return;
+  }
+}
 
-      } else if (surf_type == "y-cone") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfaceYCone);
+// Same as Surface::SurfacePlane_distance, with the evaluations of the planes
+// taken from the cache when it has them
+void general_plane_batch_distance(int n, const int32_t* tokens,
+  const double* coeffs, Position r, Direction u, int32_t on_surface,
+  double& min_dist, int32_t& i_surf, PlaneEvalCache* planes)
+{
+  bool cached = planes && planes->n_ == n;
+  bool store = planes && !cached && n <= PlaneEvalCache::SIZE;
+  for (int k = 0; k < n; ++k) {
+    const double* c = coeffs + 4*k;
+    const double f = cached ? planes->f_[k] :
+      c[0]*r.x + c[1]*r.y + c[2]*r.z - c[3];
+    const double projection = c[0]*u.x + c[1]*u.y + c[2]*u.z;
+    if (store) planes->f_[k] = f;
+    if (cached || store) planes->projection_[k] = projection;
+
+    bool coincident = std::abs(tokens[k]) == std::abs(on_surface);
+    double d = INFTY;
+    if (!coincident && std::abs(f) >= FP_COINCIDENT && projection != 0.0) {
+      d = -f / projection;
+      if (d < 0.0) d = INFTY;
+    }
+    update_nearest(d, tokens[k], min_dist, i_surf);
+  }
+  if (cached || store) {
+    planes->n_ = n;
+    planes->u_ = u;
+  }
+}
 
-      } else if (surf_type == "z-cone") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfaceZCone);
+// The template parameters are the same as for axis_aligned_cylinder_distance.
+template<int i1, int i2, int i3> void
+cylinder_batch_distance(int n, const int32_t* tokens, const double* coeffs,
+  Position r, Direction u, int32_t on_surface, double& min_dist,
+  int32_t& i_surf)
+{
+  for (int k = 0; k < n; ++k) {
+    bool coincident = std::abs(tokens[k]) == std::abs(on_surface);
+    const double* c = coeffs + 3*k;
+    double d = axis_aligned_cylinder_distance<i1, i2, i3>(r, u, coincident,
+      c[0], c[1], c[2]);
+    update_nearest(d, tokens[k], min_dist, i_surf);
+  }
+}
 
-      } else if (surf_type == "quadric") {
-        model::surfaces.emplace_back(surf_node, Surface::SurfaceType::SurfaceQuadric);
+void sphere_batch_distance(int n, const int32_t* tokens, const double* coeffs,
+  Position r, Direction u, int32_t on_surface, double& min_dist,
+  int32_t& i_surf)
+{
+  for (int k = 0; k < n; ++k) {
+    bool coincident = std::abs(tokens[k]) == std::abs(on_surface);
+    const double* c = coeffs + 4*k;
+    double d = sphere_distance(r, u, coincident, c[0], c[1], c[2], c[3]);
+    update_nearest(d, tokens[k], min_dist, i_surf);
+  }
+}
 
-      } else {
-        fatal_error(fmt::format("Invalid surface type, \"{}\"", surf_type));
+void batch_distance(const SurfaceBatch& batch, const int32_t* tokens,
+  const double* coeffs, Position r, Direction u, int32_t on_surface,
+  double& min_dist, int32_t& i_surf, PlaneEvalCache* planes)
+{
+  int n = batch.n;
+  tokens += batch.token;
+  coeffs += batch.coeff;
+  switch(batch.type){
+    case Surface::SurfaceType::SurfaceXPlane:
+      plane_batch_distance<0>(n, tokens, coeffs, r, u, on_surface, min_dist,
+        i_surf);
+      break;
+    case Surface::SurfaceType::SurfaceYPlane:
+      plane_batch_distance<1>(n, tokens, coeffs, r, u, on_surface, min_dist,
+        i_surf);
+      break;
+    case Surface::SurfaceType::SurfaceZPlane:
+      plane_batch_distance<2>(n, tokens, coeffs, r, u, on_surface, min_dist,
+        i_surf);
+      break;
+    case Surface::SurfaceType::SurfacePlane:
+      general_plane_batch_distance(n, tokens, coeffs, r, u, on_surface,
+        min_dist, i_surf, planes);
+      break;
+    case Surface::SurfaceType::SurfaceXCylinder:
+      cylinder_batch_distance<0, 1, 2>(n, tokens, coeffs, r, u, on_surface,
+        min_dist, i_surf);
+      break;
+    case Surface::SurfaceType::SurfaceYCylinder:
+      cylinder_batch_distance<1, 0, 2>(n, tokens, coeffs, r, u, on_surface,
+        min_dist, i_surf);
+      break;
+    case Surface::SurfaceType::SurfaceZCylinder:
+      cylinder_batch_distance<2, 0, 1>(n, tokens, coeffs, r, u, on_surface,
+        min_dist, i_surf);
+      break;
+    case Surface::SurfaceType::SurfaceSphere:
+      sphere_batch_distance(n, tokens, coeffs, r, u, on_surface, min_dist,
+        i_surf);
+      break;
+    default:
+      // Other types are rarer and have more coefficients, so they are not
+      // packed
+      for (int k = 0; k < n; ++k) {
+        bool coincident = std::abs(tokens[k]) == std::abs(on_surface);
+        // Note the off-by-one indexing
+        double d = model::device_surfaces[std::abs(tokens[k]) - 1].distance(
+          r, u, coincident);
+        update_nearest(d, tokens[k], min_dist, i_surf);
       }
+  }
+}
+#pragma omp end declare target
 
-      // Check for a periodic surface
-      if (check_for_node(surf_node, "boundary")) {
-        std::string surf_bc = get_node_value(surf_node, "boundary", true, true);
-        if (surf_bc == "periodic") {
-          if (check_for_node(surf_node, "periodic_surface_id")) {
-            int i_periodic = std::stoi(get_node_value(surf_node,
-                                                      "periodic_surface_id"));
-            int lo_id = std::min(model::surfaces.back().id_, i_periodic);
-            int hi_id = std::max(model::surfaces.back().id_, i_periodic);
-            periodic_pairs.insert({lo_id, hi_id});
-          } else {
-            periodic_pairs.insert({model::surfaces.back().id_, -1});
-          }
-        }
-      }
-    }
+//==============================================================================
+
+namespace {
+
+//! Type of a surface from the type attribute of its XML element
+Surface::SurfaceType surface_type(const std::string& surf_type)
+{
+  if (surf_type == "x-plane") {
+    return Surface::SurfaceType::SurfaceXPlane;
+  } else if (surf_type == "y-plane") {
+    return Surface::SurfaceType::SurfaceYPlane;
+  } else if (surf_type == "z-plane") {
+    return Surface::SurfaceType::SurfaceZPlane;
+  } else if (surf_type == "plane") {
+    return Surface::SurfaceType::SurfacePlane;
+  } else if (surf_type == "x-cylinder") {
+    return Surface::SurfaceType::SurfaceXCylinder;
+  } else if (surf_type == "y-cylinder") {
+    return Surface::SurfaceType::SurfaceYCylinder;
+  } else if (surf_type == "z-cylinder") {
+    return Surface::SurfaceType::SurfaceZCylinder;
+  } else if (surf_type == "sphere") {
+    return Surface::SurfaceType::SurfaceSphere;
+  } else if (surf_type == "x-cone") {
+    return Surface::SurfaceType::SurfaceXCone;
+  } else if (surf_type == "y-cone") {
+    return Surface::SurfaceType::SurfaceYCone;
+  } else if (surf_type == "z-cone") {
+    return Surface::SurfaceType::SurfaceZCone;
+  } else if (surf_type == "quadric") {
+    return Surface::SurfaceType::SurfaceQuadric;
   }
+  fatal_error(fmt::format("Invalid surface type, \"{}\"", surf_type));
+}
 
+//! Map the IDs of the surfaces, pair their periodic boundary conditions and
+//! check that there is a boundary. Shared by the XML and HDF5 readers.
+//
+//! \param periodic_pairs IDs of the periodic surfaces and of their partners,
+//!   lower ID first, or -1 for partners left unspecified
+void finish_surfaces(std::set<std::pair<int, int>>& periodic_pairs)
+{
   // Fill the surface map
   for (int i_surf = 0; i_surf < model::surfaces.size(); i_surf++) {
     int id = model::surfaces[i_surf].id_;
@@ -1321,6 +1536,104 @@ void read_surfaces(pugi::xml_node node)
   }
 }
 
+} // namespace
+
+void read_surfaces(pugi::xml_node node)
+{
+  // Collect the surface elements so that they can be read in parallel
+  std::vector<pugi::xml_node> surf_nodes;
+  for (pugi::xml_node surf_node : node.children("surface")) {
+    surf_nodes.push_back(surf_node);
+  }
+  int n_surfaces = surf_nodes.size();
+  if (n_surfaces == 0) {
+    fatal_error("No surfaces found in geometry.xml!");
+  }
+
+  // Construct the surfaces from their XML elements
+  model::surfaces.resize(n_surfaces);
+  #pragma omp parallel for schedule(static)
+  for (int i_surf = 0; i_surf < n_surfaces; ++i_surf) {
+    pugi::xml_node surf_node = surf_nodes[i_surf];
+    std::string surf_type = get_node_value(surf_node, "type", true, true);
+    model::surfaces[i_surf] = Surface(surf_node, surface_type(surf_type));
+  }
+
+  // Keep track of periodic surfaces
+  std::set<std::pair<int, int>> periodic_pairs;
+  for (int i_surf = 0; i_surf < n_surfaces; ++i_surf) {
+    pugi::xml_node surf_node = surf_nodes[i_surf];
+    if (check_for_node(surf_node, "boundary")) {
+      std::string surf_bc = get_node_value(surf_node, "boundary", true, true);
+      if (surf_bc == "periodic") {
+        if (check_for_node(surf_node, "periodic_surface_id")) {
+          int i_periodic = std::stoi(get_node_value(surf_node,
+                                                    "periodic_surface_id"));
+          int lo_id = std::min(model::surfaces[i_surf].id_, i_periodic);
+          int hi_id = std::max(model::surfaces[i_surf].id_, i_periodic);
+          periodic_pairs.insert({lo_id, hi_id});
+        } else {
+          periodic_pairs.insert({model::surfaces[i_surf].id_, -1});
+        }
+      }
+    }
+  }
+
+  finish_surfaces(periodic_pairs);
+}
+
+void read_surfaces_hdf5(hid_t file_id)
+{
+  hid_t group = open_group(file_id, "surfaces");
+  std::vector<int> ids;
+  std::vector<std::string> types;
+  std::vector<std::string> names;
+  std::vector<std::string> boundaries;
+  std::vector<int> periodic_ids;
+  read_dataset(group, "id", ids);
+  read_dataset(group, "type", types);
+  read_dataset(group, "name", names);
+  read_dataset(group, "boundary", boundaries);
+  read_dataset(group, "periodic_surface_id", periodic_ids);
+  RaggedDataset<double> coeffs {group, "coeffs"};
+  close_group(group);
+
+  int n_surfaces = ids.size();
+  if (n_surfaces == 0) {
+    fatal_error("No surfaces found in geometry.h5!");
+  }
+  if (types.size() != n_surfaces || names.size() != n_surfaces ||
+      boundaries.size() != n_surfaces || periodic_ids.size() != n_surfaces ||
+      coeffs.size() != n_surfaces) {
+    fatal_error("The surface datasets of geometry.h5 differ in length.");
+  }
+
+  // Construct the surfaces from their rows
+  model::surfaces.resize(n_surfaces);
+  #pragma omp parallel for schedule(static)
+  for (int i_surf = 0; i_surf < n_surfaces; ++i_surf) {
+    auto c = coeffs.row(i_surf);
+    model::surfaces[i_surf] = Surface(ids[i_surf], surface_type(types[i_surf]),
+      names[i_surf], boundaries[i_surf], c.data(), c.size());
+  }
+
+  // Keep track of periodic surfaces
+  std::set<std::pair<int, int>> periodic_pairs;
+  for (int i_surf = 0; i_surf < n_surfaces; ++i_surf) {
+    int id = ids[i_surf];
+    int i_periodic = periodic_ids[i_surf];
+    if (i_periodic != C_NONE) model::surfaces[i_surf].i_periodic_ = i_periodic;
+    if (boundaries[i_surf] != "periodic") continue;
+    if (i_periodic != C_NONE) {
+      periodic_pairs.insert({std::min(id, i_periodic), std::max(id, i_periodic)});
+    } else {
+      periodic_pairs.insert({id, -1});
+    }
+  }
+
+  finish_surfaces(periodic_pairs);
+}
+
 void free_memory_surfaces()
 {
   model::surfaces.clear();
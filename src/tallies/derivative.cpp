@@ -20,6 +20,8 @@ namespace openmc {
 namespace model {
   std::unordered_map<int, int> tally_deriv_map;
   std::vector<TallyDerivative> tally_derivs;
+  TallyDerivative* device_tally_derivs {nullptr};
+  int n_tally_derivs {0};
 }
 
 //==============================================================================
@@ -95,6 +97,8 @@ read_tally_derivatives(pugi::xml_node node)
     fatal_error("Differential tallies not supported in multi-group mode");
 }
 
+#pragma omp declare target
+
 void
 apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
   double atom_density, int score_bin, double& score)
@@ -108,7 +112,7 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
   // where (1/f * d_f/d_p) is the (logarithmic) flux derivative and p is the
   // perturbated variable.
 
-  const auto& deriv {model::tally_derivs[tally.deriv_]};
+  const auto& deriv {model::device_tally_derivs[tally.deriv_]};
   const auto flux_deriv = p.flux_derivs_[tally.deriv_];
 
   // Handle special cases where we know that d_c/d_p must be zero.
@@ -151,14 +155,15 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
         break;
 
       default:
-        fatal_error("Tally derivative not defined for a score on tally "
-          + std::to_string(tally.id_));
+        // Rejected when the tally is read
+        break;
       }
       break;
 
     default:
-      fatal_error("Differential tallies are only implemented for analog and "
-        "collision estimators.");
+      // Differential tallies are only read with analog or collision
+      // estimators
+      break;
     }
     break;
 
@@ -195,14 +200,14 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
           // Find the index of the perturbed nuclide.
           int i;
           for (i = 0; i < material.nuclide_.size(); ++i)
-            if (material.nuclide_[i] == deriv.diff_nuclide) break;
-          score *= flux_deriv + 1. / material.atom_density_(i);
+            if (material.nuclide(i) == deriv.diff_nuclide) break;
+          score *= flux_deriv + 1. / material.atom_density(i);
         }
         break;
 
       default:
-        fatal_error("Tally derivative not defined for a score on tally "
-          + std::to_string(tally.id_));
+        // Rejected when the tally is read
+        break;
       }
       break;
 
@@ -277,14 +282,15 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
         break;
 
       default:
-        fatal_error("Tally derivative not defined for a score on tally "
-          + std::to_string(tally.id_));
+        // Rejected when the tally is read
+        break;
       }
       break;
 
     default:
-      fatal_error("Differential tallies are only implemented for analog and "
-        "collision estimators.");
+      // Differential tallies are only read with analog or collision
+      // estimators
+      break;
     }
     break;
 
@@ -309,7 +315,7 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
         // Find the index of the event nuclide.
         int i;
         for (i = 0; i < material.nuclide_.size(); ++i)
-          if (material.nuclide_[i] == p.event_nuclide_) break;
+          if (material.nuclide(i) == p.event_nuclide_) break;
 
         const auto& nuc {data::nuclides[p.event_nuclide_]};
         if (!multipole_in_range(nuc, p.E_last_)) {
@@ -323,8 +329,8 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
           if (p.neutron_xs_[p.event_nuclide_].total) {
             double dsig_s, dsig_a, dsig_f;
             std::tie(dsig_s, dsig_a, dsig_f)
-              = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
-            score *= flux_deriv + (dsig_s + dsig_a) * material.atom_density_(i)
+              = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
+            score *= flux_deriv + (dsig_s + dsig_a) * material.atom_density(i)
               / p.macro_xs_.total;
           } else {
             score *= flux_deriv;
@@ -336,8 +342,8 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
               - p.neutron_xs_[p.event_nuclide_].absorption) {
             double dsig_s, dsig_a, dsig_f;
             std::tie(dsig_s, dsig_a, dsig_f)
-              = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
-            score *= flux_deriv + dsig_s * material.atom_density_(i)
+              = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
+            score *= flux_deriv + dsig_s * material.atom_density(i)
               / (p.macro_xs_.total - p.macro_xs_.absorption);
           } else {
             score *= flux_deriv;
@@ -348,8 +354,8 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
           if (p.neutron_xs_[p.event_nuclide_].absorption) {
             double dsig_s, dsig_a, dsig_f;
             std::tie(dsig_s, dsig_a, dsig_f)
-              = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
-            score *= flux_deriv + dsig_a * material.atom_density_(i)
+              = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
+            score *= flux_deriv + dsig_a * material.atom_density(i)
               / p.macro_xs_.absorption;
           } else {
             score *= flux_deriv;
@@ -360,8 +366,8 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
           if (p.neutron_xs_[p.event_nuclide_].fission) {
             double dsig_s, dsig_a, dsig_f;
             std::tie(dsig_s, dsig_a, dsig_f)
-              = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
-            score *= flux_deriv + dsig_f * material.atom_density_(i)
+              = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
+            score *= flux_deriv + dsig_f * material.atom_density(i)
               / p.macro_xs_.fission;
           } else {
             score *= flux_deriv;
@@ -374,8 +380,8 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
               / p.neutron_xs_[p.event_nuclide_].fission;
             double dsig_s, dsig_a, dsig_f;
             std::tie(dsig_s, dsig_a, dsig_f)
-              = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
-            score *= flux_deriv + nu * dsig_f * material.atom_density_(i)
+              = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
+            score *= flux_deriv + nu * dsig_f * material.atom_density(i)
               / p.macro_xs_.nu_fission;
           } else {
             score *= flux_deriv;
@@ -383,8 +389,8 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
           break;
 
         default:
-          fatal_error("Tally derivative not defined for a score on tally "
-            + std::to_string(tally.id_));
+          // Rejected when the tally is read
+          break;
         }
       }
       break;
@@ -404,14 +410,14 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
         if (i_nuclide == -1 && p.macro_xs_.total > 0.0) {
           double cum_dsig = 0;
           for (auto i = 0; i < material.nuclide_.size(); ++i) {
-            auto i_nuc = material.nuclide_[i];
+            auto i_nuc = material.nuclide(i);
             const auto& nuc {data::nuclides[i_nuc]};
             if (multipole_in_range(nuc, p.E_last_)
                 && p.neutron_xs_[i_nuc].total) {
               double dsig_s, dsig_a, dsig_f;
               std::tie(dsig_s, dsig_a, dsig_f)
-                = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
-              cum_dsig += (dsig_s + dsig_a) * material.atom_density_(i);
+                = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
+              cum_dsig += (dsig_s + dsig_a) * material.atom_density(i);
             }
           }
           score *= flux_deriv + cum_dsig / p.macro_xs_.total;
@@ -419,7 +425,7 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
           const auto& nuc {data::nuclides[i_nuclide]};
           double dsig_s, dsig_a, dsig_f;
           std::tie(dsig_s, dsig_a, dsig_f)
-            = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
+            = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
           score *= flux_deriv
             + (dsig_s + dsig_a) / p.neutron_xs_[i_nuclide].total;
         } else {
@@ -432,15 +438,15 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
             - p.macro_xs_.absorption)) {
           double cum_dsig = 0;
           for (auto i = 0; i < material.nuclide_.size(); ++i) {
-            auto i_nuc = material.nuclide_[i];
+            auto i_nuc = material.nuclide(i);
             const auto& nuc {data::nuclides[i_nuc]};
             if (multipole_in_range(nuc, p.E_last_)
                 && (p.neutron_xs_[i_nuc].total
                 - p.neutron_xs_[i_nuc].absorption)) {
               double dsig_s, dsig_a, dsig_f;
               std::tie(dsig_s, dsig_a, dsig_f)
-                = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
-              cum_dsig += dsig_s * material.atom_density_(i);
+                = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
+              cum_dsig += dsig_s * material.atom_density(i);
             }
           }
           score *= flux_deriv + cum_dsig / (p.macro_xs_.total
@@ -450,7 +456,7 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
           const auto& nuc {data::nuclides[i_nuclide]};
           double dsig_s, dsig_a, dsig_f;
           std::tie(dsig_s, dsig_a, dsig_f)
-            = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
+            = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
           score *= flux_deriv + dsig_s / (p.neutron_xs_[i_nuclide].total
             - p.neutron_xs_[i_nuclide].absorption);
         } else {
@@ -462,14 +468,14 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
         if (i_nuclide == -1 && p.macro_xs_.absorption > 0.0) {
           double cum_dsig = 0;
           for (auto i = 0; i < material.nuclide_.size(); ++i) {
-            auto i_nuc = material.nuclide_[i];
+            auto i_nuc = material.nuclide(i);
             const auto& nuc {data::nuclides[i_nuc]};
             if (multipole_in_range(nuc, p.E_last_)
                 && p.neutron_xs_[i_nuc].absorption) {
               double dsig_s, dsig_a, dsig_f;
               std::tie(dsig_s, dsig_a, dsig_f)
-                = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
-              cum_dsig += dsig_a * material.atom_density_(i);
+                = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
+              cum_dsig += dsig_a * material.atom_density(i);
             }
           }
           score *= flux_deriv + cum_dsig / p.macro_xs_.absorption;
@@ -477,7 +483,7 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
           const auto& nuc {data::nuclides[i_nuclide]};
           double dsig_s, dsig_a, dsig_f;
           std::tie(dsig_s, dsig_a, dsig_f)
-            = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
+            = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
           score *= flux_deriv
             + dsig_a / p.neutron_xs_[i_nuclide].absorption;
         } else {
@@ -489,14 +495,14 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
         if (i_nuclide == -1 && p.macro_xs_.fission > 0.0) {
           double cum_dsig = 0;
           for (auto i = 0; i < material.nuclide_.size(); ++i) {
-            auto i_nuc = material.nuclide_[i];
+            auto i_nuc = material.nuclide(i);
             const auto& nuc {data::nuclides[i_nuc]};
             if (multipole_in_range(nuc, p.E_last_)
                 && p.neutron_xs_[i_nuc].fission) {
               double dsig_s, dsig_a, dsig_f;
               std::tie(dsig_s, dsig_a, dsig_f)
-                = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
-              cum_dsig += dsig_f * material.atom_density_(i);
+                = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
+              cum_dsig += dsig_f * material.atom_density(i);
             }
           }
           score *= flux_deriv + cum_dsig / p.macro_xs_.fission;
@@ -504,7 +510,7 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
           const auto& nuc {data::nuclides[i_nuclide]};
           double dsig_s, dsig_a, dsig_f;
           std::tie(dsig_s, dsig_a, dsig_f)
-            = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
+            = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
           score *= flux_deriv
             + dsig_f / p.neutron_xs_[i_nuclide].fission;
         } else {
@@ -516,7 +522,7 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
         if (i_nuclide == -1 && p.macro_xs_.nu_fission > 0.0) {
           double cum_dsig = 0;
           for (auto i = 0; i < material.nuclide_.size(); ++i) {
-            auto i_nuc = material.nuclide_[i];
+            auto i_nuc = material.nuclide(i);
             const auto& nuc {data::nuclides[i_nuc]};
             if (multipole_in_range(nuc, p.E_last_)
                 && p.neutron_xs_[i_nuc].fission) {
@@ -524,8 +530,8 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
                 / p.neutron_xs_[i_nuc].fission;
               double dsig_s, dsig_a, dsig_f;
               std::tie(dsig_s, dsig_a, dsig_f)
-                = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
-              cum_dsig += nu * dsig_f * material.atom_density_(i);
+                = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
+              cum_dsig += nu * dsig_f * material.atom_density(i);
             }
           }
           score *= flux_deriv + cum_dsig / p.macro_xs_.nu_fission;
@@ -533,7 +539,7 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
           const auto& nuc {data::nuclides[i_nuclide]};
           double dsig_s, dsig_a, dsig_f;
           std::tie(dsig_s, dsig_a, dsig_f)
-            = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
+            = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
           score *= flux_deriv
             + dsig_f / p.neutron_xs_[i_nuclide].fission;
         } else {
@@ -547,8 +553,9 @@ apply_derivative_to_score(const Particle& p, int i_tally, int i_nuclide,
       break;
 
     default:
-      fatal_error("Differential tallies are only implemented for analog and "
-        "collision estimators.");
+      // Differential tallies are only read with analog or collision
+      // estimators
+      break;
     }
     break;
   }
@@ -562,8 +569,8 @@ score_track_derivative(Particle& p, double distance)
 
   const Material& material {model::materials[p.material_]};
 
-  for (auto idx = 0; idx < model::tally_derivs.size(); idx++) {
-    const auto& deriv = model::tally_derivs[idx];
+  for (auto idx = 0; idx < model::n_tally_derivs; idx++) {
+    const auto& deriv = model::device_tally_derivs[idx];
     auto& flux_deriv = p.flux_derivs_[idx];
     if (deriv.diff_material != material.id_) continue;
 
@@ -587,16 +594,16 @@ score_track_derivative(Particle& p, double distance)
 
     case DerivativeVariable::TEMPERATURE:
       for (auto i = 0; i < material.nuclide_.size(); ++i) {
-        const auto& nuc {data::nuclides[material.nuclide_[i]]};
+        const auto& nuc {data::nuclides[material.nuclide(i)]};
         if (multipole_in_range(nuc, p.E_last_)) {
           // phi is proportional to e^(-Sigma_tot * dist)
           // (1 / phi) * (d_phi / d_T) = - (d_Sigma_tot / d_T) * dist
           // (1 / phi) * (d_phi / d_T) = - N (d_sigma_tot / d_T) * dist
           double dsig_s, dsig_a, dsig_f;
           std::tie(dsig_s, dsig_a, dsig_f)
-            = nuc.multipole_->evaluate_deriv(p.E_, p.sqrtkT_);
+            = nuc.multipole()->evaluate_deriv(p.E_, p.sqrtkT_);
           flux_deriv -= distance * (dsig_s + dsig_a)
-            * material.atom_density_(i);
+            * material.atom_density(i);
         }
       }
       break;
@@ -611,8 +618,8 @@ void score_collision_derivative(Particle& p)
 
   const Material& material {model::materials[p.material_]};
 
-  for (auto idx = 0; idx < model::tally_derivs.size(); idx++) {
-    const auto& deriv = model::tally_derivs[idx];
+  for (auto idx = 0; idx < model::n_tally_derivs; idx++) {
+    const auto& deriv = model::device_tally_derivs[idx];
     auto& flux_deriv = p.flux_derivs_[idx];
 
     if (deriv.diff_material != material.id_) continue;
@@ -631,23 +638,20 @@ void score_collision_derivative(Particle& p)
       // Find the index in this material for the diff_nuclide.
       int i;
       for (i = 0; i < material.nuclide_.size(); ++i)
-        if (material.nuclide_[i] == deriv.diff_nuclide) break;
-      // Make sure we found the nuclide.
-      if (material.nuclide_[i] != deriv.diff_nuclide) {
-        fatal_error(fmt::format(
-          "Could not find nuclide {} in material {} for tally derivative {}",
-          data::nuclides[deriv.diff_nuclide].name_, material.id_, deriv.id));
-      }
+        if (material.nuclide(i) == deriv.diff_nuclide) break;
+      // The event nuclide is always found in the material it collided in.
+      if (i == material.nuclide_.size()) continue;
       // phi is proportional to Sigma_s
       // (1 / phi) * (d_phi / d_N) = (d_Sigma_s / d_N) / Sigma_s
       // (1 / phi) * (d_phi / d_N) = sigma_s / Sigma_s
       // (1 / phi) * (d_phi / d_N) = 1 / N
-      flux_deriv += 1. / material.atom_density_(i);
+      flux_deriv += 1. / material.atom_density(i);
       break;
 
     case DerivativeVariable::TEMPERATURE:
       // Loop over the material's nuclides until we find the event nuclide.
-      for (auto i_nuc : material.nuclide_) {
+      for (auto i = 0; i < material.nuclide_.size(); ++i) {
+        auto i_nuc = material.nuclide(i);
         const auto& nuc {data::nuclides[i_nuc]};
         if (i_nuc == p.event_nuclide_ && multipole_in_range(nuc, p.E_last_)) {
           // phi is proportional to Sigma_s
@@ -656,7 +660,7 @@ void score_collision_derivative(Particle& p)
           const auto& micro_xs {p.neutron_xs_[i_nuc]};
           double dsig_s, dsig_a, dsig_f;
           std::tie(dsig_s, dsig_a, dsig_f)
-            = nuc.multipole_->evaluate_deriv(p.E_last_, p.sqrtkT_);
+            = nuc.multipole()->evaluate_deriv(p.E_last_, p.sqrtkT_);
           flux_deriv += dsig_s / (micro_xs.total - micro_xs.absorption);
           // Note that this is an approximation!  The real scattering cross
           // section is
@@ -672,4 +676,6 @@ void score_collision_derivative(Particle& p)
   }
 }
 
+#pragma omp end declare target
+
 }// namespace openmc
@@ -45,6 +45,7 @@ void Filter::copy_to_device()
   map_.copy_to_device();
   imap_.copy_to_device();
   bins_.copy_to_device();
+  energy_index_.copy_to_device();
   cells_.copy_to_device();
   cell_instances_.copy_to_device();
   groups_.copy_to_device();
@@ -94,6 +95,8 @@ Filter::FilterType Filter::get_filter_type(const std::string& type)
     return FilterType::PolarFilter;
   } else if (type == "surface") {
     return FilterType::SurfaceFilter;
+  } else if (type == "time") {
+    return FilterType::TimeFilter;
   } else if (type == "spatiallegendre") {
     return FilterType::SpatialLegendreFilter;
   } else if (type == "sphericalharmonics") {
@@ -153,6 +156,7 @@ void Filter::from_xml(pugi::xml_node node)
     case FilterType::SphericalHarmonicsFilter : SphericalHarmonicsFilter_from_xml(node); break;
     case FilterType::SpatialLegendreFilter    : SpatialLegendreFilter_from_xml(node); break;
     case FilterType::SurfaceFilter            : SurfaceFilter_from_xml(node); break;
+    case FilterType::TimeFilter               : TimeFilter_from_xml(node); break;
     case FilterType::UniverseFilter           : UniverseFilter_from_xml(node); break;
     case FilterType::ZernikeFilter            : ZernikeFilter_from_xml(node); break;
     case FilterType::ZernikeRadialFilter      : ZernikeFilter_from_xml(node); break; // Note -- type uses parent
@@ -217,6 +221,7 @@ std::string Filter::type() const
     case FilterType::SphericalHarmonicsFilter : return "sphericalharmonics";
     case FilterType::SpatialLegendreFilter    : return "spatiallegendre";
     case FilterType::SurfaceFilter            : return "surface";
+    case FilterType::TimeFilter               : return "time";
     case FilterType::UniverseFilter           : return "universe";
     case FilterType::ZernikeFilter            : return "zernike";
     case FilterType::ZernikeRadialFilter      : return "zernikeradial";
@@ -247,6 +252,7 @@ std::string Filter::text_label(int bin) const
     case FilterType::SphericalHarmonicsFilter : return SphericalHarmonicsFilter_text_label(bin); break;
     case FilterType::SpatialLegendreFilter    : return SpatialLegendreFilter_text_label(bin); break;
     case FilterType::SurfaceFilter            : return SurfaceFilter_text_label(bin); break;
+    case FilterType::TimeFilter               : return TimeFilter_text_label(bin); break;
     case FilterType::UniverseFilter           : return UniverseFilter_text_label(bin); break;
     case FilterType::ZernikeFilter            : return ZernikeFilter_text_label(bin); break;
     case FilterType::ZernikeRadialFilter      : return ZernikeRadialFilter_text_label(bin); break;
@@ -279,6 +285,7 @@ void Filter::to_statepoint(hid_t filter_group) const
     case FilterType::SphericalHarmonicsFilter : SphericalHarmonicsFilter_to_statepoint(filter_group); break;
     case FilterType::SpatialLegendreFilter    : SpatialLegendreFilter_to_statepoint(filter_group); break;
     case FilterType::SurfaceFilter            : SurfaceFilter_to_statepoint(filter_group); break;
+    case FilterType::TimeFilter               : TimeFilter_to_statepoint(filter_group); break;
     case FilterType::UniverseFilter           : UniverseFilter_to_statepoint(filter_group); break;
     case FilterType::ZernikeFilter            : ZernikeFilter_to_statepoint(filter_group); break;
     case FilterType::ZernikeRadialFilter      : ZernikeFilter_to_statepoint(filter_group); break; // Note - uses parent type
@@ -308,9 +315,9 @@ void Filter::get_all_bins(const Particle& p, TallyEstimator estimator, FilterMat
     case FilterType::SphericalHarmonicsFilter : SphericalHarmonicsFilter_get_all_bins(p, estimator, match); break;
     case FilterType::SpatialLegendreFilter    : SpatialLegendreFilter_get_all_bins(p, estimator, match); break;
     case FilterType::SurfaceFilter            : SurfaceFilter_get_all_bins(p, estimator, match); break;
+    case FilterType::TimeFilter               : TimeFilter_get_all_bins(p, estimator, match); break;
     case FilterType::UniverseFilter           : UniverseFilter_get_all_bins(p, estimator, match); break;
-    // TODO: ZernikeFilter relies on calc_zn, which uses a std::vector
-    //case FilterType::ZernikeFilter            : ZernikeFilter_get_all_bins(p, estimator, match); break;
+    case FilterType::ZernikeFilter            : ZernikeFilter_get_all_bins(p, estimator, match); break;
     case FilterType::ZernikeRadialFilter      : ZernikeRadialFilter_get_all_bins(p, estimator, match); break;
   }
 }
@@ -334,6 +341,7 @@ void Filter::set_bins(gsl::span<const double> bins)
     case FilterType::EnergyoutFilter          :   EnergyFilter_set_bins(bins); break; // Note we map derived type to parent type
     case FilterType::MuFilter                 :   MuFilter_set_bins(bins); break;
     case FilterType::PolarFilter              :   PolarFilter_set_bins(bins); break;
+    case FilterType::TimeFilter               :   TimeFilter_set_bins(bins); break;
   }
 }
 
@@ -41,6 +41,14 @@ void
 Filter::DistribcellFilter_get_all_bins(const Particle& p, TallyEstimator estimator,
                                 FilterMatch& match) const
 {
+  // When the filter's cell is the material cell the particle is in, its
+  // instance was already resolved by find_cell(), which walks the same
+  // offsets with the same distribcell index
+  if (cell_ == p.coord_[p.n_coord_ - 1].cell) {
+    match.push_back(p.cell_instance_, 1.0);
+    return;
+  }
+
   int offset = 0;
   auto distribcell_index = model::device_cells[cell_].distribcell_index_;
   for (int i = 0; i < p.n_coord_; i++) {
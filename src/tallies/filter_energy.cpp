@@ -1,5 +1,7 @@
 #include "openmc/tallies/filter.h"
 
+#include <cmath>
+
 #include <fmt/core.h>
 
 #include "openmc/capi.h"
@@ -15,6 +17,12 @@ namespace openmc {
 // EnergyFilter implementation
 //==============================================================================
 
+// Filters with fewer bins than this are searched directly
+constexpr int ENERGY_INDEX_MIN_BINS {32};
+
+// Number of log-spaced hash cells per bin in a filter's energy index
+constexpr int ENERGY_INDEX_CELLS_PER_BIN {4};
+
 void
 Filter::EnergyFilter_from_xml(pugi::xml_node node)
 {
@@ -39,6 +47,42 @@ Filter::EnergyFilter_set_bins(gsl::span<const double> bins)
 
   n_bins_ = bins_.size() - 1;
 
+  // Index the bins for O(1) lookups. The first edge may be zero, in which case
+  // the index starts at the second.
+  energy_index_.clear();
+  equal_lethargy_ = false;
+  energy_first_ = bins_.front() > 0.0 ? 0 : 1;
+  if (n_bins_ >= ENERGY_INDEX_MIN_BINS && energy_first_ < n_bins_ &&
+      bins_[energy_first_] > 0.0) {
+    energy_log_min_ = std::log(bins_[energy_first_]);
+    double u_range = std::log(bins_.back()) - energy_log_min_;
+
+    // Structures of equal lethargy bins need no index at all
+    int n_log = n_bins_ - energy_first_;
+    double du = u_range / n_log;
+    equal_lethargy_ = true;
+    for (int i = energy_first_; i < n_bins_; ++i) {
+      double w = std::log(bins_[i + 1] / bins_[i]);
+      if (std::abs(w - du) > 1.0e-6 * du) {
+        equal_lethargy_ = false;
+        break;
+      }
+    }
+
+    if (equal_lethargy_) {
+      energy_inv_du_ = 1.0 / du;
+    } else {
+      int n_cells = ENERGY_INDEX_CELLS_PER_BIN * n_bins_;
+      energy_inv_du_ = n_cells / u_range;
+      energy_index_.resize(n_cells + 1);
+      for (int k = 0; k <= n_cells; ++k) {
+        double E = std::exp(energy_log_min_ + k / energy_inv_du_);
+        int j = upper_bound_index(bins_.begin(), bins_.end(), E);
+        energy_index_[k] = std::max(energy_first_, std::min(j, n_bins_ - 1));
+      }
+    }
+  }
+
   // In MG mode, check if the filter bins match the transport bins.
   // We can save tallying time if we know that the tally bins match the energy
   // group structure.  In that case, the matching bin index is simply the group
@@ -57,6 +101,38 @@ Filter::EnergyFilter_set_bins(gsl::span<const double> bins)
   }
 }
 
+int
+Filter::energy_bin(double E) const
+{
+  if (!equal_lethargy_ && energy_index_.empty()) {
+    return lower_bound_index(bins_.begin(), bins_.end(), E);
+  }
+
+  // Everything up to the first indexed edge falls in the first bin
+  if (E <= bins_[energy_first_]) return 0;
+
+  // Find a candidate from the lethargy of E. Bins hold energies in
+  // (bins_[i], bins_[i + 1]], so an E on an edge belongs to the bin below it.
+  double u = (std::log(E) - energy_log_min_) * energy_inv_du_;
+  int i;
+  if (equal_lethargy_) {
+    i = energy_first_ + static_cast<int>(u);
+  } else {
+    int k = std::max(0, std::min(static_cast<int>(u),
+      static_cast<int>(energy_index_.size()) - 2));
+    int lo = energy_index_[k];
+    int hi = energy_index_[k + 1];
+    i = std::lower_bound(bins_.begin() + lo + 1, bins_.begin() + hi + 1, E) -
+      bins_.begin() - 1;
+  }
+
+  // Correct for rounding in the lethargy
+  i = std::max(energy_first_, std::min(i, n_bins_ - 1));
+  while (i > energy_first_ && bins_[i] >= E) --i;
+  while (i < n_bins_ - 1 && bins_[i + 1] < E) ++i;
+  return i;
+}
+
 void
 Filter::EnergyFilter_get_all_bins(const Particle& p, TallyEstimator estimator, FilterMatch& match)
 const
@@ -78,7 +154,7 @@ const
 
     // Bin the energy.
     if (E >= bins_.front() && E <= bins_.back()) {
-      auto bin = lower_bound_index(bins_.begin(), bins_.end(), E);
+      auto bin = energy_bin(E);
       //match.bins_.push_back(bin);
       //match.weights_.push_back(1.0);
       match.push_back(bin, 1.0);
@@ -115,7 +191,7 @@ Filter::EnergyoutFilter_get_all_bins(const Particle& p, TallyEstimator estimator
 
   // } else {
     if (p.E_ >= bins_.front() && p.E_ <= bins_.back()) {
-      auto bin = lower_bound_index(bins_.begin(), bins_.end(), p.E_);
+      auto bin = energy_bin(p.E_);
       //match.bins_.push_back(bin);
       //match.weights_.push_back(1.0);
       match.push_back(bin, 1.0);
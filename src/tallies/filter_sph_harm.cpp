@@ -27,6 +27,10 @@ Filter::SphericalHarmonicsFilter_set_order(int order)
   if (order < 0) {
     throw std::invalid_argument{"Spherical harmonics order must be non-negative."};
   }
+  if (order > RN_MAX_ORDER) {
+    throw std::invalid_argument{fmt::format(
+      "Spherical harmonics order must be at most {}.", RN_MAX_ORDER)};
+  }
   order_ = order;
   n_bins_ = (order_ + 1) * (order_ + 1);
 }
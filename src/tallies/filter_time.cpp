@@ -0,0 +1,82 @@
+#include "openmc/tallies/filter.h"
+
+#include <algorithm> // for max, min
+
+#include <fmt/core.h>
+
+#include "openmc/error.h"
+#include "openmc/search.h"
+#include "openmc/xml_interface.h"
+
+namespace openmc {
+
+void
+Filter::TimeFilter_from_xml(pugi::xml_node node)
+{
+  auto bins = get_node_array<double>(node, "bins");
+  this->set_bins(bins);
+}
+
+void
+Filter::TimeFilter_set_bins(gsl::span<const double> bins)
+{
+  // Clear existing bins
+  bins_.clear();
+  bins_.reserve(bins.size());
+
+  // Copy bins, ensuring they are valid
+  for (gsl::index i = 0; i < bins.size(); ++i) {
+    if (bins[i] < 0.0) {
+      throw std::runtime_error{"Time bins must not be negative."};
+    }
+    if (i > 0 && bins[i] <= bins[i-1]) {
+      throw std::runtime_error{"Time bins must be monotonically increasing."};
+    }
+    bins_.push_back(bins[i]);
+  }
+
+  n_bins_ = bins_.size() - 1;
+}
+
+void
+Filter::TimeFilter_get_all_bins(const Particle& p, TallyEstimator estimator, FilterMatch& match)
+const
+{
+  double t_end = p.time_;
+  double t_start = p.time_last_;
+
+  if (estimator != TallyEstimator::TRACKLENGTH || t_end <= t_start) {
+    // Events happen at the time of the particle
+    if (t_end >= bins_.front() && t_end <= bins_.back()) {
+      auto bin = lower_bound_index(bins_.begin(), bins_.end(), t_end);
+      match.push_back(bin, 1.0);
+    }
+    return;
+  }
+
+  // A track is divided among the bins it spans, in proportion to the time it
+  // spends in each of them
+  if (t_end <= bins_.front() || t_start >= bins_.back()) return;
+  double dt = t_end - t_start;
+  int bin = t_start <= bins_.front() ? 0 :
+    lower_bound_index(bins_.begin(), bins_.end(), t_start);
+  for (; bin < n_bins_ && bins_[bin] < t_end; ++bin) {
+    double overlap = std::min(bins_[bin+1], t_end) -
+      std::max(bins_[bin], t_start);
+    if (overlap > 0.0) match.push_back(bin, overlap / dt);
+  }
+}
+
+void
+Filter::TimeFilter_to_statepoint(hid_t filter_group) const
+{
+  write_dataset(filter_group, "bins", bins_);
+}
+
+std::string
+Filter::TimeFilter_text_label(int bin) const
+{
+  return fmt::format("Time [{}, {})", bins_[bin], bins_[bin+1]);
+}
+
+} // namespace openmc
@@ -21,7 +21,6 @@ namespace openmc {
 void
 Filter::ZernikeFilter_from_xml(pugi::xml_node node)
 {
-  fatal_error("Zernike filters not yet supported on device (due to calc_zn() dynamic memory allocation).");
   set_order(std::stoi(get_node_value(node, "order")));
   x_ = std::stod(get_node_value(node, "x"));
   yy_ = std::stod(get_node_value(node, "y"));
@@ -80,6 +79,10 @@ Filter::ZernikeFilter_set_order(int order)
   if (order < 0) {
     throw std::invalid_argument{"Zernike order must be non-negative."};
   }
+  if (get_type() == FilterType::ZernikeFilter && order > ZN_MAX_ORDER) {
+    throw std::invalid_argument{fmt::format(
+      "Zernike order must be at most {}.", ZN_MAX_ORDER)};
+  }
   order_ = order;
   n_bins_ = ((order+1) * (order+2)) / 2;
 }
@@ -2,13 +2,17 @@
 
 #include "openmc/capi.h"
 #include "openmc/constants.h"
+#include "openmc/device_sort.h"
 #include "openmc/error.h"
 #include "openmc/file_utils.h"
+#include "openmc/material.h"
+#include "openmc/memory_registry.h"
 #include "openmc/message_passing.h"
 #include "openmc/mesh.h"
 #include "openmc/mgxs_interface.h"
 #include "openmc/nuclide.h"
 #include "openmc/particle.h"
+#include "openmc/profile_range.h"
 #include "openmc/reaction.h"
 #include "openmc/reaction_product.h"
 #include "openmc/settings.h"
@@ -23,9 +27,11 @@
 #include "xtensor/xbuilder.hpp" // for empty_like
 #include "xtensor/xview.hpp"
 
-#include <algorithm> // for max
+#include <algorithm> // for max, sort, unique
 #include <array>
+#include <cmath> // for ceil
 #include <cstddef> // for size_t
+#include <limits> // for numeric_limits
 #include <string>
 
 namespace openmc {
@@ -46,15 +52,28 @@ namespace model {
   std::vector<int> active_surface_tallies;
   int* device_active_tallies {nullptr};
   size_t active_tallies_size;
+  int* device_active_analog_tallies {nullptr};
+  size_t active_analog_tallies_size;
   int* device_active_collision_tallies {nullptr};
   size_t active_collision_tallies_size;
   int* device_active_tracklength_tallies {nullptr};
   size_t active_tracklength_tallies_size;
+  int* device_active_meshsurf_tallies {nullptr};
+  size_t active_meshsurf_tallies_size;
+  int* device_active_surface_tallies {nullptr};
+  size_t active_surface_tallies_size;
 }
 
 namespace simulation {
   xt::xtensor_fixed<double, xt::xshape<N_GLOBAL_TALLIES, 3>> global_tallies;
   int32_t n_realizations {0};
+  SharedArray<TallyScore> tally_score_queue;
+}
+
+namespace {
+  // Sort keys and permutation of the deferred tally scores
+  uint64_t* tally_score_keys {nullptr};
+  uint32_t* tally_score_perm {nullptr};
 }
 
 double global_tally_absorption;
@@ -233,6 +252,26 @@ Tally::Tally(pugi::xml_node node)
         }
       }
     }
+
+    // Derivatives are applied to scores on device, where errors cannot be
+    // raised, so scores without a defined derivative are rejected here.
+    // Temperature derivatives leave other collision estimator scores as is.
+    for (int score : scores_) {
+      switch (score) {
+      case SCORE_FLUX:
+      case SCORE_TOTAL:
+      case SCORE_SCATTER:
+      case SCORE_ABSORPTION:
+      case SCORE_FISSION:
+      case SCORE_NU_FISSION:
+        break;
+      default:
+        if (deriv.variable == DerivativeVariable::TEMPERATURE
+            && estimator_ == TallyEstimator::COLLISION) break;
+        fatal_error(fmt::format(
+          "Tally derivative not defined for a score on tally {}", id_));
+      }
+    }
   }
 
   // If settings.xml trigger is turned on, create tally triggers
@@ -276,11 +315,56 @@ Tally::Tally(pugi::xml_node node)
         "Invalid estimator '{}' on tally {}", est, id_)};
     }
   }
+
+  // Delta-tracked flights are not followed through the cells they cross, so
+  // only collision estimators are available with delta tracking. Multigroup
+  // runs have no majorant and track every flight as usual.
+  if (settings::delta_tracking && settings::run_CE &&
+      estimator_ == TallyEstimator::TRACKLENGTH) {
+    warning(fmt::format("Tally {} uses a collision estimator, as delta "
+      "tracking leaves no track-length one.", id_));
+    estimator_ = TallyEstimator::COLLISION;
+  }
+
+  // Target motion sampling broadens the XS of a collision only, at the
+  // relative energy it samples, so the XS of the material at the particle's
+  // energy hold neither for reaction rates other than analog ones nor for
+  // flux estimators other than track-length ones
+  if (settings::temperature_tms && settings::run_CE &&
+      type_ == TallyType::VOLUME) {
+    bool flux = false;
+    bool reaction = false;
+    for (int score : scores_) {
+      if (score == SCORE_FLUX) {
+        flux = true;
+      } else if (score != SCORE_CURRENT && score != SCORE_EVENTS) {
+        reaction = true;
+      }
+    }
+    if (flux && reaction) {
+      fatal_error(fmt::format("Cannot tally flux and reaction rates in the "
+        "same tally with target motion sampling on tally {}", id_));
+    }
+    if (flux && estimator_ != TallyEstimator::TRACKLENGTH) {
+      fatal_error(fmt::format("Only the track-length estimator of the flux is "
+        "available with target motion sampling on tally {}", id_));
+    }
+    if (reaction && estimator_ != TallyEstimator::ANALOG) {
+      if (check_for_node(node, "estimator")) {
+        fatal_error(fmt::format("Only analog estimators of reaction rates "
+          "are available with target motion sampling on tally {}", id_));
+      }
+      warning(fmt::format("Tally {} uses an analog estimator, as target "
+        "motion sampling leaves no other for reaction rates.", id_));
+      estimator_ = TallyEstimator::ANALOG;
+    }
+  }
 }
 
 Tally::~Tally()
 {
   model::tally_map.erase(id_);
+  free(stats_);
 }
 
 Tally*
@@ -491,13 +575,8 @@ Tally::set_scores(const std::vector<std::string>& scores)
 
   // Check if there are any depletion-related scores
   for (auto sc : scores_) {
-    if ( sc == N_2N ||
-         sc == N_3N ||
-         sc == N_4N ||
-         sc == N_GAMMA ||
-         sc == N_P ||
-         sc == N_A )
-    {
+    if (std::find(DEPLETION_REACTIONS.begin(), DEPLETION_REACTIONS.end(), sc)
+        != DEPLETION_REACTIONS.end()) {
       simulation::depletion_scores_present = true;
     }
   }
@@ -608,44 +687,133 @@ void Tally::init_results()
   n_scores_ = scores_.size() * nuclides_.size();
   results_size_ = n_filter_bins_ * n_scores_ * 3;
   results_ = static_cast<double*>(malloc(results_size_ * sizeof(double)));
+  record_memory("Tally results", MemorySpace::host,
+    results_size_ * sizeof(double));
 }
 
 void Tally::reset()
 {
+#ifdef OPENMC_MPI
+  if (reduction_pending_) complete_tally_reductions(false);
+#endif
   n_realizations_ = 0;
+  gather_pending_ = false;
   std::memset(results_, 0, results_size_ * sizeof(double));
+  if (accumulate_on_device_) sync_results_to_device();
 }
 
+namespace {
+
+//! Factor that the results of a batch are multiplied by when accumulated
+double batch_normalization()
+{
+  // Calculate total source strength for normalization
+  double total_source = 0.0;
+  if (settings::run_mode == RunMode::FIXED_SOURCE) {
+    for (const auto& s : model::external_sources) {
+      total_source += s->strength();
+    }
+  } else {
+    total_source = 1.0;
+  }
+
+  // Account for number of source particles in normalization
+  return total_source / (settings::n_particles * settings::gen_per_batch);
+}
+
+//! First of the n_bins bins of a distributed tally owned by a rank; the bins
+//! of the last rank end at distributed_bin(n_bins, n_procs)
+size_t distributed_bin(size_t n_bins, int rank)
+{
+  return n_bins / mpi::n_procs * rank +
+    std::min<size_t>(rank, n_bins % mpi::n_procs);
+}
+
+} // namespace
+
 void Tally::accumulate()
 {
   // Increment number of realizations
   n_realizations_ += settings::reduce_tallies ? 1 : mpi::n_procs;
 
   if (mpi::master || !settings::reduce_tallies) {
-    // Calculate total source strength for normalization
-    double total_source = 0.0;
-    if (settings::run_mode == RunMode::FIXED_SOURCE) {
-      for (const auto& s : model::external_sources) {
-        total_source += s->strength();
+    double norm = batch_normalization();
+
+    if (accumulate_on_device_) {
+      // The batch's scores never left device, so accumulate them there
+      double* res = results_;
+      size_t n_bins = results_size_ / 3;
+      #pragma omp target teams distribute parallel for
+      for (size_t bin = 0; bin < n_bins; ++bin) {
+        double* result = res + bin * 3;
+        double val = result[static_cast<int>(TallyResult::VALUE)] * norm;
+        result[static_cast<int>(TallyResult::VALUE)] = 0.0;
+        result[static_cast<int>(TallyResult::SUM)] += val;
+        result[static_cast<int>(TallyResult::SUM_SQ)] += val*val;
+      }
+      host_results_stale_ = true;
+
+    // For sparse tallies, only the blocks gathered from device can hold
+    // non-zero values, unless results from other ranks were reduced in
+    } else if (n_sparse_blocks_ > 0 && !(settings::reduce_tallies && mpi::n_procs > 1)) {
+      // A block is gathered once per generation, so it is listed as many
+      // times with several generations per batch
+      std::sort(sparse_touched_.begin(), sparse_touched_.end());
+      sparse_touched_.erase(std::unique(sparse_touched_.begin(),
+        sparse_touched_.end()), sparse_touched_.end());
+
+      size_t n_bins = static_cast<size_t>(n_filter_bins_) * n_scores_;
+      #pragma omp parallel for
+      for (int b = 0; b < sparse_touched_.size(); ++b) {
+        size_t first = static_cast<size_t>(sparse_touched_[b]) * SPARSE_TALLY_BLOCK;
+        size_t last = std::min(first + SPARSE_TALLY_BLOCK, n_bins);
+        for (size_t bin = first; bin < last; ++bin) {
+          double* result = results_ + bin * 3;
+          double val = result[static_cast<int>(TallyResult::VALUE)] * norm;
+          result[static_cast<int>(TallyResult::VALUE)] = 0.0;
+          result[static_cast<int>(TallyResult::SUM)] += val;
+          result[static_cast<int>(TallyResult::SUM_SQ)] += val*val;
+        }
       }
     } else {
-      total_source = 1.0;
+      // Accumulate each result
+      #pragma omp parallel for
+      for (int i = 0; i < results_shape()[0]; ++i) {
+        for (int j = 0; j < results_shape()[1]; ++j) {
+          double val = *results(i, j, TallyResult::VALUE) * norm;
+          *results(i, j, TallyResult::VALUE) = 0.0;
+          *results(i, j, TallyResult::SUM) += val;
+          *results(i, j, TallyResult::SUM_SQ) += val*val;
+        }
+      }
     }
+  }
+  sparse_touched_.clear();
+}
 
-    // Account for number of source particles in normalization
-    double norm = total_source / (settings::n_particles * settings::gen_per_batch);
-
-    // Accumulate each result
+void Tally::accumulate_reduced(const double* values)
+{
+  n_realizations_ += 1;
+
+  // The values of a distributed tally are those of the bins this rank owns
+  if (mpi::master || distributed_) {
+    double norm = batch_normalization();
+    size_t first = 0;
+    size_t n_bins = results_size_ / 3;
+    if (distributed_) {
+      first = distributed_bin(n_bins, mpi::rank);
+      n_bins = distributed_bin(n_bins, mpi::rank + 1) - first;
+      gather_pending_ = true;
+    }
     #pragma omp parallel for
-    for (int i = 0; i < results_shape()[0]; ++i) {
-      for (int j = 0; j < results_shape()[1]; ++j) {
-        double val = *results(i, j, TallyResult::VALUE) * norm;
-        *results(i, j, TallyResult::VALUE) = 0.0;
-        *results(i, j, TallyResult::SUM) += val;
-        *results(i, j, TallyResult::SUM_SQ) += val*val;
-      }
+    for (size_t bin = 0; bin < n_bins; ++bin) {
+      double* result = results_ + (first + bin) * 3;
+      double val = values[bin] * norm;
+      result[static_cast<int>(TallyResult::SUM)] += val;
+      result[static_cast<int>(TallyResult::SUM_SQ)] += val*val;
     }
   }
+  sparse_touched_.clear();
 }
 
 std::string
@@ -662,17 +830,317 @@ void Tally::copy_to_device()
   nuclides_.copy_to_device();
   filters_.copy_to_device();
   strides_.copy_to_device();
-  #pragma omp target enter data map(to: results_[:results_size_])
+  shared_slots_.copy_to_device();
+  collapse_bins_.copy_to_device();
+  if (n_sparse_blocks_ > 0) {
+    size_t n_pool = (sparse_capacity_ + 1) * static_cast<size_t>(SPARSE_TALLY_BLOCK);
+    #pragma omp target enter data map(to: sparse_slots_[:n_sparse_blocks_])
+    #pragma omp target enter data map(to: sparse_owners_[:sparse_capacity_])
+    #pragma omp target enter data map(to: sparse_used_[:1])
+    #pragma omp target enter data map(to: sparse_pool_[:n_pool])
+  } else {
+    #pragma omp target enter data map(to: results_[:results_size_])
+  }
+  if (n_replicas_ > 0) {
+    size_t n = n_replicas_ * static_cast<size_t>(n_filter_bins_) * n_scores_;
+    #pragma omp target enter data map(to: replicas_[:n])
+  }
+  #pragma omp target enter data map(to: material_nuclide_offsets_[:n_material_nuclide_offsets_])
+  #pragma omp target enter data map(to: material_nuclides_[:n_material_nuclides_])
+  if (stats_) {
+    #pragma omp target enter data map(to: stats_[:1])
+  }
+}
+
+void Tally::init_device_scoring()
+{
+  int64_t n_bins = static_cast<int64_t>(n_filter_bins_) * n_scores_;
+
+  // Store large tallies in blocks that are only given device memory once
+  // scored. Their scores are added as they are made, so they are neither
+  // deferred nor replicated.
+  if (settings::event_based && settings::sparse_tally_fraction > 0.0 &&
+      n_bins >= settings::min_sparse_tally_bins) {
+    n_sparse_blocks_ = (n_bins + SPARSE_TALLY_BLOCK - 1) / SPARSE_TALLY_BLOCK;
+    sparse_capacity_ = std::max(1,
+      static_cast<int>(std::ceil(settings::sparse_tally_fraction * n_sparse_blocks_)));
+    sparse_slots_ = static_cast<int*>(malloc(n_sparse_blocks_ * sizeof(int)));
+    sparse_owners_ = static_cast<int*>(malloc(sparse_capacity_ * sizeof(int)));
+    sparse_used_ = static_cast<int*>(calloc(1, sizeof(int)));
+    sparse_pool_ = static_cast<double*>(calloc(
+      (sparse_capacity_ + 1) * static_cast<size_t>(SPARSE_TALLY_BLOCK), sizeof(double)));
+    std::fill(sparse_slots_, sparse_slots_ + n_sparse_blocks_, -1);
+    std::fill(sparse_owners_, sparse_owners_ + sparse_capacity_, -1);
+  }
+
+  // Bins are queued as 32-bit indices
+  defer_scores_ = settings::event_based && settings::deferred_tally_scores > 0 &&
+    n_bins <= std::numeric_limits<int32_t>::max() && n_sparse_blocks_ == 0;
+
+  // Replicate the results of small tallies that are scored on device. Large
+  // tallies see little contention per bin and would take too much memory.
+  if (settings::event_based && settings::tally_replicas > 0 &&
+      n_bins <= settings::max_replicated_tally_bins && n_sparse_blocks_ == 0) {
+    n_replicas_ = settings::tally_replicas;
+    replicas_ = static_cast<double*>(calloc(n_replicas_ * n_bins, sizeof(double)));
+  }
+
+  // Particles transported on host by hybrid transport score into a buffer of
+  // their own
+  free(host_scores_);
+  host_scores_ = nullptr;
+  if (settings::hybrid_transport) {
+    host_scores_ = static_cast<double*>(calloc(n_bins, sizeof(double)));
+  }
+
+  // Keep dense results on device across batches. Results reduced over MPI
+  // ranks or read by CMFD every batch have to be on host anyway.
+  accumulate_on_device_ = settings::event_based &&
+    settings::device_tally_accumulate && n_sparse_blocks_ == 0 &&
+    !(settings::reduce_tallies && mpi::n_procs > 1) && !settings::cmfd_run;
+
+  // Spread the accumulation of large reduced tallies over the ranks. CMFD
+  // reads the accumulated results on master every batch.
+  distributed_ = settings::reduce_tallies && mpi::n_procs > 1 &&
+    settings::min_distributed_tally_bins > 0 &&
+    n_bins >= settings::min_distributed_tally_bins &&
+    n_bins <= std::numeric_limits<int>::max() && !settings::cmfd_run;
+
+  // Counters start from zero for each simulation. They are kept on host
+  // after the tally is released from device, for the end of run report.
+  free(stats_);
+  stats_ = nullptr;
+  if (settings::tally_stats) {
+    stats_ = static_cast<TallyStats*>(calloc(1, sizeof(TallyStats)));
+  }
+
+  init_filter_pipeline();
+  init_material_nuclides();
+}
+
+void Tally::init_filter_pipeline()
+{
+  pipeline_ = FilterPipeline::generic;
+
+  // Find the position of a filter of the given type
+  auto position = [this](Filter::FilterType type) {
+    for (int i = 0; i < n_filters(); ++i) {
+      if (model::tally_filters[filters(i)].get_type() == type) return i;
+    }
+    return -1;
+  };
+
+  int mesh = position(Filter::FilterType::MeshFilter);
+  int energy = position(Filter::FilterType::EnergyFilter);
+  int cell = position(Filter::FilterType::CellFilter);
+  int material = position(Filter::FilterType::MaterialFilter);
+
+  if (n_filters() == 1 && mesh >= 0) {
+    pipeline_ = FilterPipeline::mesh;
+    pipeline_filters_[0] = mesh;
+  } else if (n_filters() == 2 && energy >= 0) {
+    if (mesh >= 0) {
+      pipeline_ = FilterPipeline::energy_mesh;
+      pipeline_filters_[0] = energy;
+      pipeline_filters_[1] = mesh;
+    } else if (cell >= 0) {
+      pipeline_ = FilterPipeline::cell_energy;
+      pipeline_filters_[0] = cell;
+      pipeline_filters_[1] = energy;
+    } else if (material >= 0) {
+      pipeline_ = FilterPipeline::material_energy;
+      pipeline_filters_[0] = material;
+      pipeline_filters_[1] = energy;
+    }
+  }
+}
+
+void Tally::init_material_nuclides()
+{
+  std::vector<int> offsets {0};
+  std::vector<TallyNuclide> bins;
+
+  // Void material: every bin is scored with zero density
+  for (int i = 0; i < nuclides_.size(); ++i) {
+    bins.push_back({i, nuclides_[i], 0.0});
+  }
+  offsets.push_back(bins.size());
+
+  // Index of each nuclide in the material being mapped, reset after it
+  int n_nuclides = settings::run_CE ?
+    data::nuclides_size : data::mg.nuclides_.size();
+  std::vector<int> index(n_nuclides, C_NONE);
+  for (int m = 0; m < model::materials_size; ++m) {
+    const auto& mat = model::materials[m];
+    for (int j = 0; j < mat.nuclide_.size(); ++j) index[mat.nuclide_[j]] = j;
+    for (int i = 0; i < nuclides_.size(); ++i) {
+      int i_nuclide = nuclides_[i];
+      if (i_nuclide < 0) {
+        bins.push_back({i, i_nuclide, 0.0});
+      } else {
+        int j = index[i_nuclide];
+        if (j != C_NONE) bins.push_back({i, i_nuclide, mat.atom_density_(j)});
+      }
+    }
+    for (int i_nuclide : mat.nuclide_) index[i_nuclide] = C_NONE;
+    offsets.push_back(bins.size());
+  }
+
+  n_material_nuclide_offsets_ = offsets.size();
+  n_material_nuclides_ = bins.size();
+  material_nuclide_offsets_ = static_cast<int*>(malloc(offsets.size() * sizeof(int)));
+  material_nuclides_ = static_cast<TallyNuclide*>(malloc(bins.size() * sizeof(TallyNuclide)));
+  std::copy(offsets.begin(), offsets.end(), material_nuclide_offsets_);
+  std::copy(bins.begin(), bins.end(), material_nuclides_);
+}
+
+void Tally::update_material_nuclides(int i_material)
+{
+  const auto& mat = model::materials[i_material];
+  int n;
+  auto bins = const_cast<TallyNuclide*>(material_nuclides(i_material, n));
+  for (int k = 0; k < n; ++k) {
+    if (bins[k].nuclide < 0) continue;
+    int j = mat.mat_nuclide_index(bins[k].nuclide);
+    bins[k].atom_density = mat.atom_density_(j);
+  }
+  if (n > 0) {
+    #pragma omp target update to(bins[:n])
+  }
 }
 
 void Tally::update_host_to_device()
 {
+  // The sparse store is emptied when gathered, so there is nothing to send,
+  // and results accumulated on device are already there
+  if (n_sparse_blocks_ > 0 || accumulate_on_device_) return;
   #pragma omp target update to(results_[:results_size_])
 }
 
 void Tally::update_device_to_host()
 {
+  if (n_sparse_blocks_ > 0) {
+    gather_sparse_results();
+    return;
+  }
+  reduce_replicas();
+  if (accumulate_on_device_) return;
+  #pragma omp target update from(results_[:results_size_])
+}
+
+void Tally::sync_results_to_host()
+{
+  if (!host_results_stale_) return;
   #pragma omp target update from(results_[:results_size_])
+  host_results_stale_ = false;
+}
+
+void Tally::sync_stats_to_host()
+{
+  if (!stats_) return;
+  #pragma omp target update from(stats_[:1])
+}
+
+void Tally::sync_results_to_device()
+{
+  // Does nothing if the results haven't been mapped yet
+  #pragma omp target update to(results_[:results_size_])
+  host_results_stale_ = false;
+}
+
+void Tally::gather_sparse_results()
+{
+  #pragma omp target update from(sparse_used_[:1])
+  if (*sparse_used_ > sparse_capacity_) {
+    fatal_error(fmt::format("Tally {} scored more blocks than its sparse "
+      "storage holds ({}). Increase the fraction given to --sparse-tallies.",
+      id_, sparse_capacity_));
+  }
+  int n_used = *sparse_used_;
+  if (n_used == 0) return;
+
+  // Only the claimed slots are transferred
+  #pragma omp target update from(sparse_owners_[:n_used])
+  #pragma omp target update from(sparse_pool_[:n_used * SPARSE_TALLY_BLOCK])
+
+  size_t n_bins = static_cast<size_t>(n_filter_bins_) * n_scores_;
+  for (int slot = 0; slot < n_used; ++slot) {
+    int block = sparse_owners_[slot];
+    if (block < 0) continue;
+    sparse_touched_.push_back(block);
+    const double* values = sparse_pool_ + slot * SPARSE_TALLY_BLOCK;
+    size_t first = static_cast<size_t>(block) * SPARSE_TALLY_BLOCK;
+    size_t last = std::min(first + SPARSE_TALLY_BLOCK, n_bins);
+    for (size_t bin = first; bin < last; ++bin) {
+      results_[bin * 3 + static_cast<int>(TallyResult::VALUE)] +=
+        values[bin - first];
+    }
+  }
+
+  // Empty the device store for the next batch
+  int* slots = sparse_slots_;
+  int* owners = sparse_owners_;
+  double* pool = sparse_pool_;
+  #pragma omp target teams distribute parallel for
+  for (int slot = 0; slot < n_used; ++slot) {
+    int block = owners[slot];
+    if (block >= 0) slots[block] = -1;
+    owners[slot] = -1;
+    for (int k = 0; k < SPARSE_TALLY_BLOCK; ++k) {
+      pool[slot * SPARSE_TALLY_BLOCK + k] = 0.0;
+    }
+  }
+  *sparse_used_ = 0;
+  #pragma omp target update to(sparse_used_[:1])
+}
+
+size_t Tally::device_results_bytes() const
+{
+  if (n_sparse_blocks_ > 0) {
+    return (sparse_capacity_ + 1) * static_cast<size_t>(SPARSE_TALLY_BLOCK) *
+      sizeof(double) + (n_sparse_blocks_ + sparse_capacity_ + 1) * sizeof(int);
+  }
+  return (results_size_ + static_cast<size_t>(n_replicas_) * n_filter_bins_ *
+    n_scores_) * sizeof(double);
+}
+
+void Tally::reduce_replicas()
+{
+  if (n_replicas_ == 0) return;
+
+  size_t n_bins = static_cast<size_t>(n_filter_bins_) * n_scores_;
+  int n_replicas = n_replicas_;
+  double* replicas = replicas_;
+  double* results = results_;
+  #pragma omp target teams distribute parallel for
+  for (size_t i = 0; i < n_bins; ++i) {
+    double sum = 0.0;
+    for (int r = 0; r < n_replicas; ++r) {
+      sum += replicas[r * n_bins + i];
+      replicas[r * n_bins + i] = 0.0;
+    }
+    results[i * 3 + static_cast<int>(TallyResult::VALUE)] += sum;
+  }
+}
+
+void Tally::add_host_scores()
+{
+  if (!host_scores_) return;
+
+  int64_t n_bins = static_cast<int64_t>(n_filter_bins_) * n_scores_;
+  double* scores = host_scores_;
+  double* results = results_;
+  if (accumulate_on_device_) {
+    #pragma omp target teams distribute parallel for map(to: scores[:n_bins])
+    for (int64_t i = 0; i < n_bins; ++i) {
+      results[i * 3 + static_cast<int>(TallyResult::VALUE)] += scores[i];
+    }
+  } else {
+    for (int64_t i = 0; i < n_bins; ++i) {
+      results[i * 3 + static_cast<int>(TallyResult::VALUE)] += scores[i];
+    }
+  }
+  std::fill(scores, scores + n_bins, 0.0);
 }
 
 void Tally::release_from_device()
@@ -681,7 +1149,48 @@ void Tally::release_from_device()
   nuclides_.release_device();
   filters_.release_device();
   strides_.release_device();
-  #pragma omp target exit data map(release: results_[:results_size_])
+  shared_slots_.release_device();
+  collapse_bins_.release_device();
+  if (n_sparse_blocks_ > 0) {
+    size_t n_pool = (sparse_capacity_ + 1) * static_cast<size_t>(SPARSE_TALLY_BLOCK);
+    #pragma omp target exit data map(release: sparse_slots_[:n_sparse_blocks_])
+    #pragma omp target exit data map(release: sparse_owners_[:sparse_capacity_])
+    #pragma omp target exit data map(release: sparse_used_[:1])
+    #pragma omp target exit data map(release: sparse_pool_[:n_pool])
+    free(sparse_slots_);
+    free(sparse_owners_);
+    free(sparse_used_);
+    free(sparse_pool_);
+    sparse_slots_ = nullptr;
+    sparse_owners_ = nullptr;
+    sparse_used_ = nullptr;
+    sparse_pool_ = nullptr;
+    n_sparse_blocks_ = 0;
+    sparse_capacity_ = 0;
+    sparse_touched_.clear();
+  } else {
+    #pragma omp target exit data map(release: results_[:results_size_])
+  }
+  if (n_replicas_ > 0) {
+    size_t n = n_replicas_ * static_cast<size_t>(n_filter_bins_) * n_scores_;
+    #pragma omp target exit data map(release: replicas_[:n])
+    free(replicas_);
+    replicas_ = nullptr;
+    n_replicas_ = 0;
+  }
+  free(host_scores_);
+  host_scores_ = nullptr;
+  if (stats_) {
+    #pragma omp target exit data map(from: stats_[:1])
+  }
+  #pragma omp target exit data map(release: material_nuclide_offsets_[:n_material_nuclide_offsets_])
+  #pragma omp target exit data map(release: material_nuclides_[:n_material_nuclides_])
+  free(material_nuclide_offsets_);
+  free(material_nuclides_);
+  material_nuclide_offsets_ = nullptr;
+  material_nuclides_ = nullptr;
+  n_material_nuclide_offsets_ = 0;
+  n_material_nuclides_ = 0;
 }
 
 const double* Tally::results(gsl::index i, gsl::index j, TallyResult k) const
@@ -703,6 +1212,69 @@ std::array<size_t, 3> Tally::results_shape() const
 // Non-member functions
 //==============================================================================
 
+void init_tally_score_queue(int capacity)
+{
+  simulation::tally_score_queue.reserve(capacity);
+  simulation::tally_score_queue.allocate_on_device();
+  tally_score_keys = new uint64_t[capacity];
+  tally_score_perm = new uint32_t[capacity];
+  #pragma omp target enter data map(alloc: tally_score_keys[:capacity], \
+    tally_score_perm[:capacity])
+}
+
+void free_tally_score_queue()
+{
+  int capacity = simulation::tally_score_queue.capacity();
+  if (capacity == 0) return;
+  #pragma omp target exit data map(delete: tally_score_keys[:capacity], \
+    tally_score_perm[:capacity])
+  delete[] tally_score_keys;
+  delete[] tally_score_perm;
+  tally_score_keys = nullptr;
+  tally_score_perm = nullptr;
+  simulation::tally_score_queue.clear();
+}
+
+void reduce_tally_scores()
+{
+  auto& queue = simulation::tally_score_queue;
+  if (queue.capacity() == 0) return;
+  queue.sync_size_device_to_host();
+  int n = queue.size();
+  if (n == 0) return;
+
+  // Local copies of the (host) pointers, which are translated to their
+  // corresponding device addresses when referenced in target regions
+  const TallyScore* scores = queue.data();
+  uint64_t* keys = tally_score_keys;
+  uint32_t* perm = tally_score_perm;
+
+  // Sort the scores by tally, then bin
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n; ++i) {
+    keys[i] = (static_cast<uint64_t>(scores[i].tally) << 32) |
+      static_cast<uint32_t>(scores[i].bin);
+  }
+  device_sort_keys(keys, perm, n);
+
+  // The first score of each run of equal keys sums the run. Since every bin
+  // is then updated by one thread only, no atomics are needed.
+  #pragma omp target teams distribute parallel for
+  for (int i = 0; i < n; ++i) {
+    if (i > 0 && keys[i] == keys[i - 1]) continue;
+    double sum = 0.0;
+    for (int j = i; j < n && keys[j] == keys[i]; ++j) {
+      sum += scores[perm[j]].value;
+    }
+    const TallyScore& first = scores[perm[i]];
+    Tally& tally = model::tallies[first.tally];
+    *tally.results(first.bin / tally.n_scores_, first.bin % tally.n_scores_,
+      TallyResult::VALUE) += sum;
+  }
+
+  queue.resize(0);
+}
+
 void read_tallies_xml()
 {
   // Check if tallies.xml exists. If not, just return since it is optional
@@ -776,13 +1348,150 @@ void read_tallies_xml()
 }
 
 #ifdef OPENMC_MPI
+namespace {
+
+//! Reduction of the batch values of one tally that may still be in flight
+struct TallyReduction {
+  int i_tally;
+  std::vector<double> send; //!< Values scored on this rank
+  std::vector<double> recv; //!< Values reduced onto this rank, on aggregators
+  std::vector<MPI_Request> requests; //!< One per chunk
+};
+
+std::vector<TallyReduction> pending_reductions;
+
+//! Ranks whose tallies are reduced onto the same aggregator, and the
+//! aggregators themselves with master as rank 0. Both are MPI_COMM_NULL when
+//! every rank reduces straight onto master.
+MPI_Comm group_comm {MPI_COMM_NULL};
+MPI_Comm aggregator_comm {MPI_COMM_NULL};
+bool reduction_comms_ready {false};
+
+void init_reduction_comms()
+{
+  if (reduction_comms_ready) return;
+  reduction_comms_ready = true;
+  if (settings::tally_reduce_group <= 1) return;
+
+  MPI_Comm_split(mpi::intracomm, mpi::rank / settings::tally_reduce_group,
+    mpi::rank, &group_comm);
+  int group_rank;
+  MPI_Comm_rank(group_comm, &group_rank);
+  MPI_Comm_split(mpi::intracomm, group_rank == 0 ? 0 : MPI_UNDEFINED,
+    mpi::rank, &aggregator_comm);
+}
+
+//! Copy the batch values of a tally out and reset them for the next batch
+void take_batch_values(Tally& tally, std::vector<double>& values)
+{
+  size_t n_values = tally.results_size_ / 3;
+  values.resize(n_values);
+  for (size_t i = 0; i < n_values; ++i) {
+    double* value = tally.results_ + i * 3 + static_cast<int>(TallyResult::VALUE);
+    values[i] = *value;
+    *value = 0.0;
+  }
+}
+
+//! Gather the slices of distributed tallies accumulated since they were last
+//! gathered onto master
+void gather_distributed_results()
+{
+  // Bins are sent whole, so that counts and displacements fit in an int
+  MPI_Datatype bin_type;
+  MPI_Type_contiguous(3, MPI_DOUBLE, &bin_type);
+  MPI_Type_commit(&bin_type);
+
+  std::vector<int> counts(mpi::n_procs);
+  std::vector<int> displs(mpi::n_procs);
+  for (int i = 0; i < model::tallies_size; ++i) {
+    auto& tally = model::tallies[i];
+    if (!tally.gather_pending_) continue;
+
+    size_t n_bins = tally.results_size_ / 3;
+    for (int p = 0; p < mpi::n_procs; ++p) {
+      displs[p] = distributed_bin(n_bins, p);
+      counts[p] = distributed_bin(n_bins, p + 1) - displs[p];
+    }
+    const void* send = mpi::master ? MPI_IN_PLACE :
+      tally.results_ + 3 * static_cast<size_t>(displs[mpi::rank]);
+    MPI_Gatherv(send, counts[mpi::rank], bin_type, tally.results_,
+      counts.data(), displs.data(), bin_type, 0, mpi::intracomm);
+    tally.gather_pending_ = false;
+  }
+  MPI_Type_free(&bin_type);
+}
+
+//! Start reducing n values onto rank 0 of comm, one chunk at a time
+void post_reduction(const void* send, double* recv, size_t n, MPI_Comm comm,
+  std::vector<MPI_Request>& requests)
+{
+  size_t chunk = settings::tally_reduce_chunk;
+  for (size_t first = 0; first < n; first += chunk) {
+    int count = std::min(chunk, n - first);
+    const void* s = send == MPI_IN_PLACE ? MPI_IN_PLACE :
+      static_cast<const double*>(send) + first;
+    requests.emplace_back();
+    MPI_Ireduce(s, recv + first, count, MPI_DOUBLE, MPI_SUM, 0, comm,
+      &requests.back());
+  }
+}
+
+} // namespace
+
+void complete_tally_reductions(bool gather)
+{
+  for (auto& r : pending_reductions) {
+    MPI_Waitall(r.requests.size(), r.requests.data(), MPI_STATUSES_IGNORE);
+    auto& tally = model::tallies[r.i_tally];
+
+    // Aggregators then reduce their group's values onto master
+    if (aggregator_comm != MPI_COMM_NULL && !tally.distributed_) {
+      r.requests.clear();
+      post_reduction(mpi::master ? MPI_IN_PLACE : r.recv.data(), r.recv.data(),
+        r.recv.size(), aggregator_comm, r.requests);
+      MPI_Waitall(r.requests.size(), r.requests.data(), MPI_STATUSES_IGNORE);
+    }
+
+    tally.accumulate_reduced(r.recv.data());
+    tally.reduction_pending_ = false;
+  }
+  pending_reductions.clear();
+
+  if (gather) gather_distributed_results();
+}
+
 void reduce_tally_results()
 {
-  // Don't reduce tally is no_reduce option is on
-  if (settings::reduce_tallies) {
+  // Reduce in chunks that are accumulated once they arrive, either right away
+  // or, when they are overlapped with the next batch, as soon as anything
+  // needs the accumulated results
+  if (settings::reduce_tallies && (settings::async_tally_reduction ||
+      settings::tally_reduce_group > 1)) {
+    complete_tally_reductions(false);
+    init_reduction_comms();
+    MPI_Comm comm = group_comm != MPI_COMM_NULL ? group_comm : mpi::intracomm;
+    int comm_rank;
+    MPI_Comm_rank(comm, &comm_rank);
+
+    for (int i_tally : model::active_tallies) {
+      Tally& tally = model::tallies[i_tally];
+      if (tally.distributed_) continue;
+      size_t n_values = tally.results_size_ / 3;
+
+      pending_reductions.push_back({i_tally});
+      auto& r = pending_reductions.back();
+      take_batch_values(tally, r.send);
+      r.recv.resize(comm_rank == 0 ? n_values : 0);
+
+      post_reduction(r.send.data(), r.recv.data(), n_values, comm, r.requests);
+      tally.reduction_pending_ = true;
+    }
+  } else if (settings::reduce_tallies) {
     for (int i_tally : model::active_tallies) {
       // Skip any tallies that are not active
       Tally* tally = &model::tallies[i_tally];
+      if (tally->distributed_) continue;
 
       auto shape = tally->results_shape();
       size_t n_values = shape[0] * shape[1];
@@ -811,6 +1520,27 @@ void reduce_tally_results()
     }
   }
 
+  // Distributed tallies are reduced straight onto the owners of their bins,
+  // without going through master
+  std::vector<int> counts(mpi::n_procs);
+  for (int i_tally : model::active_tallies) {
+    Tally& tally = model::tallies[i_tally];
+    if (!tally.distributed_) continue;
+    size_t n_values = tally.results_size_ / 3;
+    for (int p = 0; p < mpi::n_procs; ++p) {
+      counts[p] = distributed_bin(n_values, p + 1) - distributed_bin(n_values, p);
+    }
+
+    pending_reductions.push_back({i_tally});
+    auto& r = pending_reductions.back();
+    take_batch_values(tally, r.send);
+    r.recv.resize(counts[mpi::rank]);
+    r.requests.emplace_back();
+    MPI_Ireduce_scatter(r.send.data(), r.recv.data(), counts.data(),
+      MPI_DOUBLE, MPI_SUM, mpi::intracomm, &r.requests.back());
+    tally.reduction_pending_ = true;
+  }
+
   // Note that global tallies are *always* reduced even when no_reduce option is
   // on.
 
@@ -845,6 +1575,14 @@ void reduce_tally_results()
 void
 accumulate_tallies()
 {
+  ProfileRange range {"accumulate_tallies"};
+  // Sum the values of collapsed tallies from their parents first, so that
+  // they are reduced and accumulated like any other
+  for (int i_tally : model::active_tallies) {
+    auto& tally {model::tallies[i_tally]};
+    if (tally.collapsed_) tally.collapse_from_parent();
+  }
+
 #ifdef OPENMC_MPI
   // Combine tally results onto master process
   if (mpi::n_procs > 1) reduce_tally_results();
@@ -878,13 +1616,250 @@ accumulate_tallies()
     }
   }
 
-  // Accumulate results for each tally
+  // Accumulate results for each tally. Tallies whose reduction has been
+  // started are accumulated as it completes.
   for (int i_tally : model::active_tallies) {
     auto& tally {model::tallies[i_tally]};
-    tally.accumulate();
+    if (!tally.reduction_pending_) tally.accumulate();
+  }
+
+#ifdef OPENMC_MPI
+  if (!settings::async_tally_reduction) complete_tally_reductions(false);
+#endif
+}
+
+void sync_tally_results_to_host()
+{
+#ifdef OPENMC_MPI
+  complete_tally_reductions();
+#endif
+  for (int i = 0; i < model::tallies_size; ++i) {
+    model::tallies[i].sync_results_to_host();
   }
 }
 
+void sync_tally_stats_to_host()
+{
+  for (int i = 0; i < model::tallies_size; ++i) {
+    model::tallies[i].sync_stats_to_host();
+  }
+}
+
+void init_shared_filters()
+{
+  // Only filters matching at most one bin, with unit weight, independently of
+  // the estimator can have their bin shared
+  auto shareable = [](const Filter& f) {
+    return f.get_type() == Filter::FilterType::EnergyFilter ||
+      f.get_type() == Filter::FilterType::MaterialFilter;
+  };
+
+  // Filters of the same type with the same bins are evaluated as one
+  std::vector<int> canonical(model::n_tally_filters);
+  for (int i = 0; i < model::n_tally_filters; ++i) {
+    const auto& f = model::tally_filters[i];
+    canonical[i] = i;
+    if (!shareable(f)) continue;
+    for (int j = 0; j < i; ++j) {
+      const auto& g = model::tally_filters[j];
+      if (g.get_type() != f.get_type()) continue;
+      if (f.get_type() == Filter::FilterType::EnergyFilter ?
+          std::equal(f.bins().begin(), f.bins().end(),
+            g.bins().begin(), g.bins().end()) :
+          std::equal(f.materials().begin(), f.materials().end(),
+            g.materials().begin(), g.materials().end())) {
+        canonical[i] = canonical[j];
+        break;
+      }
+    }
+  }
+
+  // Count the tallies using each filter
+  std::vector<int> n_tallies(model::n_tally_filters, 0);
+  for (int i = 0; i < model::tallies_size; ++i) {
+    if (model::tallies[i].collapse_parent_ != C_NONE) continue;
+    for (auto i_filt : model::tallies[i].filters()) {
+      ++n_tallies[canonical[i_filt]];
+    }
+  }
+
+  // Give the filters used by several tallies a slot, as long as there is room
+  std::vector<int> slots(model::n_tally_filters, C_NONE);
+  int n_slots = 0;
+  for (int i = 0; i < model::n_tally_filters; ++i) {
+    if (canonical[i] != i || n_tallies[i] < 2) continue;
+    if (!shareable(model::tally_filters[i])) continue;
+    if (n_slots == MAX_SHARED_FILTERS) break;
+    slots[i] = n_slots++;
+  }
+
+  for (int i = 0; i < model::tallies_size; ++i) {
+    auto& tally = model::tallies[i];
+    tally.shared_slots_.resize(tally.n_filters());
+    for (int j = 0; j < tally.n_filters(); ++j) {
+      tally.shared_slots_[j] = slots[canonical[tally.filters(j)]];
+    }
+  }
+}
+
+namespace {
+
+//! Position of the EnergyFilter of a tally, or C_NONE
+int energy_filter_position(const Tally& t)
+{
+  for (int i = 0; i < t.n_filters(); ++i) {
+    if (model::tally_filters[t.filters(i)].get_type() ==
+        Filter::FilterType::EnergyFilter) return i;
+  }
+  return C_NONE;
+}
+
+//! Whether the results of a tally can be collapsed from those of another,
+//! which they are if both are identical but for the EnergyFilter at the same
+//! position, and the edges of the coarse one are a subset of those of the fine
+//! one starting from the same lowest edge. Both need their values on the same
+//! side, with dense storage.
+bool can_collapse(const Tally& coarse, const Tally& fine, int pos)
+{
+  if (fine.type_ != TallyType::VOLUME || fine.estimator_ != coarse.estimator_ ||
+      fine.deriv_ != coarse.deriv_ || fine.n_filters() != coarse.n_filters() ||
+      energy_filter_position(fine) != pos) return false;
+  if (!std::equal(coarse.scores_.begin(), coarse.scores_.end(),
+        fine.scores_.begin(), fine.scores_.end()) ||
+      !std::equal(coarse.nuclides_.begin(), coarse.nuclides_.end(),
+        fine.nuclides_.begin(), fine.nuclides_.end())) return false;
+  for (int i = 0; i < coarse.n_filters(); ++i) {
+    if (i != pos && coarse.filters(i) != fine.filters(i)) return false;
+  }
+  if (fine.n_sparse_blocks_ > 0 || coarse.n_sparse_blocks_ > 0 ||
+      fine.accumulate_on_device_ != coarse.accumulate_on_device_) return false;
+
+  const auto& c = model::tally_filters[coarse.filters(pos)].bins();
+  const auto& f = model::tally_filters[fine.filters(pos)].bins();
+  if (f.size() <= c.size() || c.front() != f.front()) return false;
+  return std::includes(f.begin(), f.end(), c.begin(), c.end());
+}
+
+} // namespace
+
+void init_collapsed_tallies()
+{
+  for (int i = 0; i < model::tallies_size; ++i) {
+    auto& tally = model::tallies[i];
+    tally.collapse_parent_ = C_NONE;
+    tally.collapse_bins_.clear();
+    tally.collapsed_ = false;
+  }
+  if (!settings::collapse_tallies) return;
+
+  for (int i = 0; i < model::tallies_size; ++i) {
+    auto& tally = model::tallies[i];
+    if (tally.type_ != TallyType::VOLUME) continue;
+    int pos = energy_filter_position(tally);
+    if (pos == C_NONE) continue;
+
+    // Collapse from the finest candidate, which can't itself be collapsed
+    // from another tally, as that would be finer still
+    int parent = C_NONE;
+    for (int j = 0; j < model::tallies_size; ++j) {
+      if (j == i || !can_collapse(tally, model::tallies[j], pos)) continue;
+      if (parent == C_NONE || model::tallies[j].n_filter_bins() >
+          model::tallies[parent].n_filter_bins()) parent = j;
+    }
+    if (parent == C_NONE) continue;
+    const auto& fine = model::tallies[parent];
+
+    // Coarse bin of each fine energy bin, or C_NONE above the coarse range
+    const auto& c = model::tally_filters[tally.filters(pos)].bins();
+    const auto& f = model::tally_filters[fine.filters(pos)].bins();
+    std::vector<int> energy_bins(f.size() - 1, C_NONE);
+    int k = 0;
+    for (int b = 0; b < energy_bins.size() && f[b + 1] <= c.back(); ++b) {
+      if (f[b] >= c[k + 1]) ++k;
+      energy_bins[b] = k;
+    }
+
+    // Map each fine filter combination through its bin of each filter
+    tally.collapse_bins_.resize(fine.n_filter_bins());
+    for (int fb = 0; fb < fine.n_filter_bins(); ++fb) {
+      int cb = 0;
+      for (int m = 0; m < fine.n_filters() && cb != C_NONE; ++m) {
+        int n_bins = model::tally_filters[fine.filters(m)].n_bins();
+        int bin = (fb / fine.strides(m)) % n_bins;
+        if (m == pos) bin = energy_bins[bin];
+        cb = bin == C_NONE ? C_NONE : cb + bin * tally.strides(m);
+      }
+      tally.collapse_bins_[fb] = cb;
+    }
+    tally.collapse_parent_ = parent;
+
+    if (mpi::master) {
+      write_message(fmt::format("Tally {} will be collapsed from tally {}",
+        tally.id_, fine.id_), 6);
+    }
+  }
+}
+
+void Tally::collapse_from_parent()
+{
+  const auto& parent = model::tallies[collapse_parent_];
+  int n_scores = n_scores_;
+  int n_parent_bins = parent.n_filter_bins_;
+  size_t n_values = results_size_ / 3;
+  double* res = results_;
+  const double* parent_res = parent.results_;
+  const int32_t* bins = collapse_bins_.data();
+  constexpr int value = static_cast<int>(TallyResult::VALUE);
+
+  if (accumulate_on_device_) {
+    // Both tallies' values are on device
+    #pragma omp target teams distribute parallel for
+    for (size_t i = 0; i < n_values; ++i) res[i * 3 + value] = 0.0;
+    #pragma omp target teams distribute parallel for collapse(2)
+    for (int fb = 0; fb < n_parent_bins; ++fb) {
+      for (int j = 0; j < n_scores; ++j) {
+        int cb = bins[fb];
+        if (cb == C_NONE) continue;
+        #pragma omp atomic
+        res[(cb * n_scores + j) * 3 + value] +=
+          parent_res[(fb * n_scores + j) * 3 + value];
+      }
+    }
+  } else {
+    for (size_t i = 0; i < n_values; ++i) res[i * 3 + value] = 0.0;
+    for (int fb = 0; fb < n_parent_bins; ++fb) {
+      int cb = bins[fb];
+      if (cb == C_NONE) continue;
+      for (int j = 0; j < n_scores; ++j) {
+        res[(cb * n_scores + j) * 3 + value] +=
+          parent_res[(fb * n_scores + j) * 3 + value];
+      }
+    }
+  }
+}
+
+void init_depletion_rx()
+{
+  simulation::n_depletion_rx = 0;
+  for (int mt : DEPLETION_REACTIONS) {
+    bool scored = false;
+    for (int i = 0; i < model::tallies_size; ++i) {
+      const auto& scores {model::tallies[i].scores_};
+      if (std::find(scores.begin(), scores.end(), mt) != scores.end()) {
+        scored = true;
+      }
+    }
+    if (!scored) continue;
+    if (simulation::n_depletion_rx == MAX_DEPLETION_RX) {
+      fatal_error(fmt::format("Tallies score more than {} depletion reactions.",
+        MAX_DEPLETION_RX));
+    }
+    simulation::depletion_rx[simulation::n_depletion_rx++] = mt;
+  }
+  #pragma omp target update to(simulation::depletion_rx)
+  #pragma omp target update to(simulation::n_depletion_rx)
+}
+
 void
 setup_active_tallies()
 {
@@ -895,22 +1870,31 @@ setup_active_tallies()
   model::active_meshsurf_tallies.clear();
   model::active_surface_tallies.clear();
   model::active_tallies_size = 0;
+  model::active_analog_tallies_size = 0;
   model::active_collision_tallies_size = 0;
   model::active_tracklength_tallies_size = 0;
-
+  model::active_meshsurf_tallies_size = 0;
+  model::active_surface_tallies_size = 0;
 
   for (auto i = 0; i < model::tallies_size; ++i) {
-    const auto& tally {model::tallies[i]};
+    auto& tally {model::tallies[i]};
 
     if (tally.active_) {
       model::active_tallies.push_back(i);
       model::active_tallies_size++;
+
+      // Tallies collapsed from an active tally aren't scored
+      tally.collapsed_ = tally.collapse_parent_ != C_NONE &&
+        model::tallies[tally.collapse_parent_].active_;
+      if (tally.collapsed_) continue;
+
       switch (tally.type_) {
 
       case TallyType::VOLUME:
         switch (tally.estimator_) {
           case TallyEstimator::ANALOG:
             model::active_analog_tallies.push_back(i);
+            model::active_analog_tallies_size++;
             break;
           case TallyEstimator::TRACKLENGTH:
             model::active_tracklength_tallies.push_back(i);
@@ -924,29 +1908,43 @@ setup_active_tallies()
 
       case TallyType::MESH_SURFACE:
         model::active_meshsurf_tallies.push_back(i);
+        model::active_meshsurf_tallies_size++;
         break;
 
       case TallyType::SURFACE:
         model::active_surface_tallies.push_back(i);
+        model::active_surface_tallies_size++;
       }
     }
   }
   
   model::device_active_tallies = model::active_tallies.data();
+  model::device_active_analog_tallies = model::active_analog_tallies.data();
   model::device_active_collision_tallies = model::active_collision_tallies.data();
   model::device_active_tracklength_tallies = model::active_tracklength_tallies.data();
+  model::device_active_meshsurf_tallies = model::active_meshsurf_tallies.data();
+  model::device_active_surface_tallies = model::active_surface_tallies.data();
   #pragma omp target enter data map(to: model::device_active_tallies[:model::active_tallies.size()])
+  #pragma omp target enter data map(to: model::device_active_analog_tallies[:model::active_analog_tallies.size()])
   #pragma omp target enter data map(to: model::device_active_collision_tallies[:model::active_collision_tallies.size()])
   #pragma omp target enter data map(to: model::device_active_tracklength_tallies[:model::active_tracklength_tallies.size()])
+  #pragma omp target enter data map(to: model::device_active_meshsurf_tallies[:model::active_meshsurf_tallies.size()])
+  #pragma omp target enter data map(to: model::device_active_surface_tallies[:model::active_surface_tallies.size()])
   
   model::active_tallies_size = model::active_tallies.size();
+  model::active_analog_tallies_size = model::active_analog_tallies.size();
   model::active_collision_tallies_size = model::active_collision_tallies.size();
   model::active_tracklength_tallies_size = model::active_tracklength_tallies.size();
+  model::active_meshsurf_tallies_size = model::active_meshsurf_tallies.size();
+  model::active_surface_tallies_size = model::active_surface_tallies.size();
 
   // Update active tally vectors on device
   #pragma omp target update to(model::active_tallies_size)
+  #pragma omp target update to(model::active_analog_tallies_size)
   #pragma omp target update to(model::active_collision_tallies_size)
   #pragma omp target update to(model::active_tracklength_tallies_size)
+  #pragma omp target update to(model::active_meshsurf_tallies_size)
+  #pragma omp target update to(model::active_surface_tallies_size)
 }
 
 void
@@ -969,9 +1967,19 @@ free_memory_tally()
   free(model::tallies);
   model::tallies_size = 0;
 
+#ifdef OPENMC_MPI
+  pending_reductions.clear();
+  if (group_comm != MPI_COMM_NULL) MPI_Comm_free(&group_comm);
+  if (aggregator_comm != MPI_COMM_NULL) MPI_Comm_free(&aggregator_comm);
+  reduction_comms_ready = false;
+#endif
+
   #pragma omp target exit data map(release: model::device_active_tallies[:model::active_tallies.size()])
+  #pragma omp target exit data map(release: model::device_active_analog_tallies[:model::active_analog_tallies.size()])
   #pragma omp target exit data map(release: model::device_active_collision_tallies[:model::active_collision_tallies.size()])
   #pragma omp target exit data map(release: model::device_active_tracklength_tallies[:model::active_tracklength_tallies.size()])
+  #pragma omp target exit data map(release: model::device_active_meshsurf_tallies[:model::active_meshsurf_tallies.size()])
+  #pragma omp target exit data map(release: model::device_active_surface_tallies[:model::active_surface_tallies.size()])
 
   model::active_tallies.clear();
   model::active_analog_tallies.clear();
@@ -1316,11 +2324,13 @@ openmc_tally_results(int32_t index, double** results, size_t* shape)
     return OPENMC_E_OUT_OF_BOUNDS;
   }
 
-  const auto& t {model::tallies[index]};
+  auto& t {model::tallies[index]};
   if (t.results_size_ == 0) {
     set_errmsg("Tally results have not been allocated yet.");
     return OPENMC_E_ALLOCATE;
   }
+  int err = openmc_tally_sync_results(index);
+  if (err) return err;
 
   // Set pointer to results and copy shape
   *results = t.results_;
@@ -1331,6 +2341,161 @@ openmc_tally_results(int32_t index, double** results, size_t* shape)
   return 0;
 }
 
+//! \brief Brings the host results of one tally up to date. Only results
+//! accumulated on device since they were last read are copied.
+extern "C" int
+openmc_tally_sync_results(int32_t index)
+{
+  // Make sure the index fits in the array bounds.
+  if (index < 0 || index >= model::tallies_size) {
+    set_errmsg("Index in tallies array is out of bounds.");
+    return OPENMC_E_OUT_OF_BOUNDS;
+  }
+
+#ifdef OPENMC_MPI
+  complete_tally_reductions();
+#endif
+  model::tallies[index].sync_results_to_host();
+  return 0;
+}
+
+//! \brief Returns the device address of the results of a tally accumulated on
+//! device, along with their shape, without copying them to host. The address
+//! is valid until the simulation is finalized, and the results are complete
+//! between batches.
+extern "C" int
+openmc_tally_device_results(int32_t index, double** results, size_t* shape)
+{
+  // Make sure the index fits in the array bounds.
+  if (index < 0 || index >= model::tallies_size) {
+    set_errmsg("Index in tallies array is out of bounds.");
+    return OPENMC_E_OUT_OF_BOUNDS;
+  }
+
+  auto& t {model::tallies[index]};
+  if (!simulation::initialized || !t.accumulate_on_device_) {
+    set_errmsg(fmt::format("Results of tally {} are not accumulated on "
+      "device.", t.id_));
+    return OPENMC_E_INVALID_TYPE;
+  }
+
+  double* ptr = t.results_;
+  #pragma omp target data use_device_ptr(ptr)
+  {
+    *results = ptr;
+  }
+  auto s = t.results_shape();
+  shape[0] = s[0];
+  shape[1] = s[1];
+  shape[2] = s[2];
+  return 0;
+}
+
+//! \brief Collapses the group flux of a tally with pointwise cross sections.
+//!
+//! The tally must score the total flux with a material filter followed by an
+//! energy filter. Reaction rates are written to rates[m][n][r] for material m
+//! of the filter, nuclide n and reaction r, and are the mean flux of material
+//! m collapsed with the reaction cross section of the nuclide at the material
+//! temperature, times the atom density of the nuclide in the material, or
+//! zero if the material does not contain it.
+extern "C" int
+openmc_tally_collapse_rates(int32_t index, int n_nuclides, const int* nuclides,
+  int n_reactions, const int* MTs, double* rates)
+{
+  // Make sure the index fits in the array bounds.
+  if (index < 0 || index >= model::tallies_size) {
+    set_errmsg("Index in tallies array is out of bounds.");
+    return OPENMC_E_OUT_OF_BOUNDS;
+  }
+
+  const auto& t {model::tallies[index]};
+  if (t.results_size_ == 0) {
+    set_errmsg("Tally results have not been allocated yet.");
+    return OPENMC_E_ALLOCATE;
+  }
+  if (t.n_filters() != 2 ||
+      model::tally_filters[t.filters(0)].get_type() !=
+        Filter::FilterType::MaterialFilter ||
+      model::tally_filters[t.filters(1)].get_type() !=
+        Filter::FilterType::EnergyFilter ||
+      t.scores_.size() != 1 || t.scores_[0] != SCORE_FLUX ||
+      t.nuclides_.size() != 1 || t.nuclides_[0] != -1) {
+    set_errmsg(fmt::format("Tally {} does not score the total flux with a "
+      "material filter followed by an energy filter.", t.id_));
+    return OPENMC_E_INVALID_TYPE;
+  }
+  for (int i = 0; i < n_nuclides; ++i) {
+    if (nuclides[i] < 0 || nuclides[i] >= data::nuclides_size) {
+      set_errmsg("Index in nuclides vector is out of bounds.");
+      return OPENMC_E_OUT_OF_BOUNDS;
+    }
+  }
+  for (int r = 0; r < n_reactions; ++r) {
+    if (MTs[r] <= 0) {
+      set_errmsg(fmt::format("Invalid reaction MT {}.", MTs[r]));
+      return OPENMC_E_INVALID_ARGUMENT;
+    }
+  }
+  sync_tally_results_to_host();
+
+  const auto& materials {model::tally_filters[t.filters(0)].materials()};
+  const auto& energy {model::tally_filters[t.filters(1)].bins()};
+  int n_materials = materials.size();
+  int n_groups = energy.size() - 1;
+  double norm = t.n_realizations_ > 0 ? 1.0 / t.n_realizations_ : 1.0;
+
+  // Mean flux of each material in each group
+  vector<double> flux(n_materials * n_groups);
+  for (int m = 0; m < n_materials; ++m) {
+    for (int g = 0; g < n_groups; ++g) {
+      int i_filter = m * t.strides(0) + g * t.strides(1);
+      flux[m * n_groups + g] = *t.results(i_filter, 0, TallyResult::SUM) * norm;
+    }
+  }
+
+  // Each pair of material and nuclide collapses every reaction independently;
+  // errors cannot leave the parallel region, so only the first is kept
+  int err = 0;
+  std::string msg;
+  #pragma omp parallel for collapse(2) schedule(dynamic)
+  for (int m = 0; m < n_materials; ++m) {
+    for (int n = 0; n < n_nuclides; ++n) {
+      const auto& mat = model::materials[materials[m]];
+      double* rate = rates + (static_cast<int64_t>(m) * n_nuclides + n) *
+        n_reactions;
+      std::fill(rate, rate + n_reactions, 0.0);
+
+      auto mat_nuclides = mat.nuclides();
+      auto it = std::find(mat_nuclides.begin(), mat_nuclides.end(),
+        nuclides[n]);
+      if (it == mat_nuclides.end()) continue;
+      double density = mat.densities()[it - mat_nuclides.begin()];
+
+      const auto& nuc = data::nuclides[nuclides[n]];
+      gsl::span<const double> phi {flux.data() + m * n_groups,
+        static_cast<size_t>(n_groups)};
+      try {
+        for (int r = 0; r < n_reactions; ++r) {
+          rate[r] = density * nuc.collapse_rate(MTs[r], mat.temperature(),
+            energy, phi);
+        }
+      } catch (const std::out_of_range& e) {
+        #pragma omp critical(collapse_rates)
+        if (err == 0) {
+          err = OPENMC_E_OUT_OF_BOUNDS;
+          msg = e.what();
+        }
+      }
+    }
+  }
+  if (err != 0) {
+    set_errmsg(msg);
+    return err;
+  }
+  return 0;
+}
+
 extern "C" int
 openmc_global_tallies(double** ptr)
 {
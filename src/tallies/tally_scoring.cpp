@@ -5,6 +5,7 @@
 #include "openmc/constants.h"
 #include "openmc/error.h"
 #include "openmc/material.h"
+#include "openmc/mesh.h"
 #include "openmc/mgxs_interface.h"
 #include "openmc/nuclide.h"
 #include "openmc/photon.h"
@@ -16,6 +17,7 @@
 #include "openmc/tallies/derivative.h"
 #include "openmc/tallies/filter.h"
 
+#include <algorithm> // for min
 #include <string>
 
 namespace openmc {
@@ -261,8 +263,7 @@ score_fission_delayed_dg(int i_tally, int d_bin, double score, int score_index,
   }
 
   // Update the tally result
-  #pragma omp atomic
-  *tally.results(filter_index, score_index, TallyResult::VALUE) += score*filter_weight;
+  tally.add_result(filter_index, score_index, score*filter_weight);
 
   // Reset the original delayed group bin
   dg_match.bins_[i_bin] = original_bin;
@@ -433,7 +434,8 @@ score_fission_eout(Particle& p, int i_tally, int i_score, int score_bin)
   // rate. Otherwise, the sum of all nu-fission rates would be ~1.0.
 
   // loop over number of particles banked
-  for (auto i = 0; i < p.n_bank_; ++i) {
+  int n_bank = std::min(p.n_bank_, simulation::nu_bank_slot_size);
+  for (auto i = 0; i < n_bank; ++i) {
     const auto& bank = p.nu_bank_[i];
 
     // get the delayed group
@@ -466,15 +468,14 @@ score_fission_eout(Particle& p, int i_tally, int i_score, int score_bin)
       if (settings::run_CE) {
         E_out = bank.E;
       } else {
-        E_out = data::mg.energy_bin_avg_[static_cast<int>(bank.E)];
+        E_out = data::mg_tables.energy_bin_avg(static_cast<int>(bank.E));
       }
 
       // Set EnergyoutFilter bin index
       if (E_out < eo_filt.bins().front() || E_out > eo_filt.bins().back()) {
         continue;
       } else {
-        auto i_match = lower_bound_index(eo_filt.bins().begin(),
-          eo_filt.bins().end(), E_out);
+        auto i_match = eo_filt.energy_bin(E_out);
         match.bins_[i_bin] = i_match;
       }
 
@@ -495,8 +496,7 @@ score_fission_eout(Particle& p, int i_tally, int i_score, int score_bin)
       }
 
       // Update tally results
-      #pragma omp atomic
-      *tally.results(filter_index, i_score, TallyResult::VALUE) += score*filter_weight;
+      tally.add_result(filter_index, i_score, score*filter_weight);
 
     } else if (score_bin == SCORE_DELAYED_NU_FISSION && g != 0) {
 
@@ -539,8 +539,7 @@ score_fission_eout(Particle& p, int i_tally, int i_score, int score_bin)
         }
 
         // Update tally results
-        #pragma omp atomic
-        *tally.results(filter_index, i_score, TallyResult::VALUE) += score*filter_weight;
+        tally.add_result(filter_index, i_score, score*filter_weight);
       }
     }
   }
@@ -608,7 +607,8 @@ void not_supported()
 
 void
 score_general_ce_nonanalog(Particle& p, int i_tally, int start_index, int filter_index,
-  double filter_weight, int i_nuclide, double atom_density, double flux, NuclideMicroXS& micro)
+  double filter_weight, int i_nuclide, double atom_density, double flux, NuclideMicroXS& micro,
+  const double* micro_rx)
 {
   Tally& tally {model::tallies[i_tally]};
 
@@ -622,7 +622,18 @@ score_general_ce_nonanalog(Particle& p, int i_tally, int start_index, int filter
     auto score_index = start_index + i;
     double score = 0.0;
 
-    switch (score_bin) {
+    // The XS of reactions of simulation::depletion_rx were looked up along
+    // with the macroscopic XS
+    int i_rx = depletion_rx_index(score_bin);
+    if (i_rx >= 0) {
+      if (p.type_ != Type::neutron) continue;
+      score = 0.;
+      if (i_nuclide >= 0) {
+        if (micro_rx) score = micro_rx[i_rx] * atom_density * flux;
+      } else if (p.material_ != MATERIAL_VOID) {
+        score = p.macro_rx()[i_rx] * flux;
+      }
+    } else switch (score_bin) {
     case SCORE_FLUX:
       score = flux;
       break;
@@ -940,8 +951,7 @@ score_general_ce_nonanalog(Particle& p, int i_tally, int start_index, int filter
 
     case SCORE_EVENTS:
       // Simply count the number of scoring events
-      #pragma omp atomic
-      *tally.results(filter_index, score_index, TallyResult::VALUE) += 1.0;
+      tally.add_result(filter_index, score_index, 1.0);
       continue;
 
     case ELASTIC:
@@ -977,53 +987,6 @@ score_general_ce_nonanalog(Particle& p, int i_tally, int start_index, int filter
       score = score_fission_q(p, score_bin, tally, flux, i_nuclide, atom_density);
       break;
 
-    case N_2N:
-    case N_3N:
-    case N_4N:
-    case N_GAMMA:
-    case N_P:
-    case N_A:
-      // This case block only works if cross sections for these reactions have
-      // been precalculated. When they are not, we revert to the default case,
-      // which looks up cross sections
-
-
-      // Note: the below problem no longer applies. We now check if any
-      // of these scores are present at tally initialization and do the lookups
-      // when tallies are active
-      //if (!simulation::need_depletion_rx) goto default_case;
-
-      if (p.type_ != Type::neutron) continue;
-
-      int m;
-      switch (score_bin) {
-      case N_GAMMA: m = 0; break;
-      case N_P: m = 1; break;
-      case N_A: m = 2; break;
-      case N_2N: m = 3; break;
-      case N_3N: m = 4; break;
-      case N_4N: m = 5; break;
-      }
-      if (i_nuclide >= 0) {
-        score = micro.reaction[m] * atom_density
-          * flux;
-      } else {
-        score = 0.;
-        if (p.material_ != MATERIAL_VOID) {
-          score += p.macro_xs_.reaction[m] * flux;
-          /*
-          const Material& material {model::materials[p.material_]};
-          for (auto i = 0; i < material.nuclide_.size(); ++i) {
-            auto j_nuclide = material.nuclide_[i];
-            auto atom_density = material.atom_density_(i);
-            score += p.neutron_xs_[j_nuclide].reaction[m]
-              * atom_density * flux;
-          }
-          */
-        }
-      }
-      break;
-
     case COHERENT:
     case INCOHERENT:
     case PHOTOELECTRIC:
@@ -1066,7 +1029,7 @@ score_general_ce_nonanalog(Particle& p, int i_tally, int start_index, int filter
         //for (auto it = bank.end() - p->n_bank_second_; it < bank.end(); ++it) {
         for (auto it = p.secondary_bank_length_ - p.n_bank_second_; it < p.secondary_bank_length_; it++) {
           //score -= it->E;
-          score -= p.secondary_bank_[it].E;
+          score -= p.secondary(it).E;
         }
 
         score *= p.wgt_last_;
@@ -1074,7 +1037,6 @@ score_general_ce_nonanalog(Particle& p, int i_tally, int start_index, int filter
       break;
 
     default:
-    default_case:
 
       // The default block is really only meant for redundant neutron reactions
       // (e.g. 444, 901)
@@ -1098,14 +1060,13 @@ score_general_ce_nonanalog(Particle& p, int i_tally, int start_index, int filter
       }
     }
 
-    // // Add derivative information on score for differential tallies.
-    // if (tally.deriv_ != C_NONE)
-    //   apply_derivative_to_score(p, i_tally, i_nuclide, atom_density, score_bin,
-    //     score);
+    // Add derivative information on score for differential tallies.
+    if (tally.deriv_ != C_NONE)
+      apply_derivative_to_score(p, i_tally, i_nuclide, atom_density, score_bin,
+        score);
 
     // Update tally results
-    #pragma omp atomic
-    *tally.results(filter_index, score_index, TallyResult::VALUE) += score*filter_weight;
+    tally.add_result(filter_index, score_index, score*filter_weight);
   }
 }
 
@@ -1444,7 +1405,8 @@ score_general_ce_analog(Particle& p, int i_tally, int start_index, int filter_in
         // ones are delayed. If a delayed neutron is encountered, add its
         // contribution to the fission bank to the score.
         score = 0.;
-        for (auto i = 0; i < p.n_bank_; ++i) {
+        int n_bank = std::min(p.n_bank_, simulation::nu_bank_slot_size);
+        for (auto i = 0; i < n_bank; ++i) {
           const auto& bank = p.nu_bank_[i];
           auto g = bank.delayed_group;
           if (g != 0) {
@@ -1504,8 +1466,7 @@ score_general_ce_analog(Particle& p, int i_tally, int start_index, int filter_in
 
     case SCORE_EVENTS:
       // Simply count the number of scoring events
-      #pragma omp atomic
-      *tally.results(filter_index, score_index, TallyResult::VALUE) += 1.0;
+      tally.add_result(filter_index, score_index, 1.0);
       continue;
 
 
@@ -1524,51 +1485,6 @@ score_general_ce_analog(Particle& p, int i_tally, int start_index, int filter_in
       break;
 
 
-    case N_2N:
-    case N_3N:
-    case N_4N:
-    case N_GAMMA:
-    case N_P:
-    case N_A:
-      // This case block only works if cross sections for these reactions have
-      // been precalculated. When they are not, we revert to the default case,
-      // which looks up cross sections
-      if (!simulation::need_depletion_rx) goto default_case;
-
-      if (p.type_ != Type::neutron) continue;
-
-      if (tally.estimator_ == TallyEstimator::ANALOG) {
-        // Check if the event MT matches
-        if (p.event_mt_ != score_bin) continue;
-        score = (p.wgt_last_ - wgt_absorb) * flux;
-      } else {
-        int m;
-        switch (score_bin) {
-        case N_GAMMA: m = 0; break;
-        case N_P: m = 1; break;
-        case N_A: m = 2; break;
-        case N_2N: m = 3; break;
-        case N_3N: m = 4; break;
-        case N_4N: m = 5; break;
-        }
-        if (i_nuclide >= 0) {
-          score = p.neutron_xs_[i_nuclide].reaction[m] * atom_density
-            * flux;
-        } else {
-          score = 0.;
-          if (p.material_ != MATERIAL_VOID) {
-            const Material& material {model::materials[p.material_]};
-            for (auto i = 0; i < material.nuclide_.size(); ++i) {
-              auto j_nuclide = material.nuclide_[i];
-              auto atom_density = material.atom_density_(i);
-              score += p.neutron_xs_[j_nuclide].reaction[m]
-                * atom_density * flux;
-            }
-          }
-        }
-      }
-      break;
-
     case COHERENT:
     case INCOHERENT:
     case PHOTOELECTRIC:
@@ -1602,7 +1518,7 @@ score_general_ce_analog(Particle& p, int i_tally, int start_index, int filter_in
         //for (auto it = bank.end() - p->n_bank_second_; it < bank.end(); ++it) {
         for (auto it = p.secondary_bank_length_ - p.n_bank_second_; it < p.secondary_bank_length_; it++) {
           //score -= it->E;
-          score -= p.secondary_bank_[it].E;
+          score -= p.secondary(it).E;
         }
 
         score *= p.wgt_last_;
@@ -1610,7 +1526,6 @@ score_general_ce_analog(Particle& p, int i_tally, int start_index, int filter_in
       break;
 
     default:
-    default_case:
 
       // The default block is really only meant for redundant neutron reactions
       // (e.g. 444, 901)
@@ -1628,8 +1543,7 @@ score_general_ce_analog(Particle& p, int i_tally, int start_index, int filter_in
         score);
 
     // Update tally results
-    #pragma omp atomic
-    *tally.results(filter_index, score_index, TallyResult::VALUE) += score*filter_weight;
+    tally.add_result(filter_index, score_index, score*filter_weight);
   }
 }
 
@@ -1653,8 +1567,7 @@ score_general_mg(Particle& p, int i_tally, int start_index, int filter_index,
 
     if (settings::survival_biasing) {
       // Determine weight that was absorbed
-      wgt_absorb = p.wgt_last_ * p.neutron_xs_[p.event_nuclide_].absorption /
-                   p.neutron_xs_[p.event_nuclide_].total;
+      wgt_absorb = p.wgt_last_ * p.macro_xs_.absorption / p.macro_xs_.total;
 
       // Then we either are alive and had a scatter (and so g changed),
       // or are dead and g did not change
@@ -1684,15 +1597,14 @@ score_general_mg(Particle& p, int i_tally, int start_index, int filter_index,
     p_g = p.g_;
   }
 
-  // For shorthand, assign pointers to the material and nuclide xs set
-  auto& nuc_xs = (i_nuclide >= 0) ? data::mg.nuclides_[i_nuclide] : data::mg.macro_xs_[p.material_];
-  auto& macro_xs = data::mg.macro_xs_[p.material_];
-
-  // Find the temperature and angle indices of interest
-  macro_xs.set_angle_index(p_u);
+  // For shorthand, find the material and nuclide xs sets at the temperature
+  // and angle of interest
+  const auto& tables {data::mg_tables};
+  MgxsTableSet macro_xs {&tables, tables.set_index(p.material_, p.sqrtkT_, p_u)};
+  MgxsTableSet nuc_xs {macro_xs};
   if (i_nuclide >= 0) {
-    nuc_xs.set_temperature_index(p.sqrtkT_);
-    nuc_xs.set_angle_index(p_u);
+    nuc_xs.set = tables.set_index(tables.nuclide_handle(i_nuclide), p.sqrtkT_,
+      p_u);
   }
 
   for (auto i = 0; i < tally.scores_.size(); ++i) {
@@ -2120,7 +2032,7 @@ score_general_mg(Particle& p, int i_tally, int start_index, int filter_index,
               // delayed-nu-fission xs to the absorption xs for all delayed
               // groups
               score = 0.;
-              for (auto d = 0; d < data::mg.num_delayed_groups_; ++d) {
+              for (auto d = 0; d < tables.num_delayed_groups(); ++d) {
                 if (i_nuclide >= 0) {
                   score += wgt_absorb * flux
                     * nuc_xs.get_xs(MgxsType::DECAY_RATE, p_g, nullptr,
@@ -2148,7 +2060,8 @@ score_general_mg(Particle& p, int i_tally, int start_index, int filter_index,
           // ones are delayed. If a delayed neutron is encountered, add its
           // contribution to the fission bank to the score.
           score = 0.;
-          for (auto i = 0; i < p.n_bank_; ++i) {
+          int n_bank = std::min(p.n_bank_, simulation::nu_bank_slot_size);
+          for (auto i = 0; i < n_bank; ++i) {
             const auto& bank = p.nu_bank_[i];
             auto d = bank.delayed_group - 1;
             if (d != -1) {
@@ -2202,7 +2115,7 @@ score_general_mg(Particle& p, int i_tally, int start_index, int filter_index,
           continue;
         } else {
           score = 0.;
-          for (auto d = 0; d < data::mg.num_delayed_groups_; ++d) {
+          for (auto d = 0; d < tables.num_delayed_groups(); ++d) {
             if (i_nuclide >= 0) {
               score += atom_density * flux
                 * nuc_xs.get_xs(MgxsType::DECAY_RATE, p_g, nullptr, nullptr, &d)
@@ -2253,8 +2166,7 @@ score_general_mg(Particle& p, int i_tally, int start_index, int filter_index,
 
     case SCORE_EVENTS:
       // Simply count the number of scoring events
-      #pragma omp atomic
-      *tally.results(filter_index, score_index, TallyResult::VALUE) += 1.0;
+      tally.add_result(filter_index, score_index, 1.0);
       continue;
 
 
@@ -2263,8 +2175,7 @@ score_general_mg(Particle& p, int i_tally, int start_index, int filter_index,
     }
 
     // Update tally results
-    #pragma omp atomic
-    *tally.results(filter_index, score_index, TallyResult::VALUE) += score*filter_weight;
+    tally.add_result(filter_index, score_index, score*filter_weight);
   }
 }
 
@@ -2277,26 +2188,19 @@ void score_analog_tally_ce(Particle& p)
     (p.type_ == Particle::Type::neutron || p.type_ == Particle::Type::photon) ?
     1.0 : 0.0;
 
-  for (auto i_tally : model::active_analog_tallies) {
+  // Bins of filters shared between tallies, evaluated once for this event
+  SharedFilterBins shared;
+
+  for (int j = 0; j < model::active_analog_tallies_size; ++j) {
+    int i_tally = model::device_active_analog_tallies[j];
     const Tally& tally {model::tallies[i_tally]};
-    
-    // Allocate particle FilterMatch array on the stack
-    FilterMatch filter_matches[FILTER_MATCHES_SIZE];
-    p.filter_matches_ = filter_matches;
+    TallyStatsProbe probe {tally, p.id_};
 
-    // Initialize an iterator over valid filter bin combinations.  If there are
-    // no valid combinations, use a continue statement to ensure we skip the
+    // Loop over valid filter bin combinations. If there are none, skip the
     // assume_separate break below.
-    auto filter_iter = FilterBinIter(tally, p);
-    //auto end = FilterBinIter(tally, true, &p->filter_matches_);
-    auto end = FilterBinIter(tally, true, p.filter_matches_);
-    if (filter_iter == end) continue;
-
-    // Loop over filter bins.
-    for (; filter_iter != end; ++filter_iter) {
-      auto filter_index = filter_iter.index_;
-      auto filter_weight = filter_iter.weight_;
-
+    bool scored = false;
+    for_each_filter_bin(tally, p, shared, [&](int filter_index, double filter_weight) {
+      probe.visit();
       // Loop over nuclide bins.
       for (auto i = 0; i < tally.nuclides_.size(); ++i) {
         auto i_nuclide = tally.nuclides_[i];
@@ -2308,7 +2212,9 @@ void score_analog_tally_ce(Particle& p)
           score_general_ce_analog(p, i_tally, i*tally.scores_.size(), filter_index,
             filter_weight, i_nuclide, -1.0, flux);
       }
-    }
+      scored = true;
+    });
+    if (!scored) continue;
 
     // If the user has specified that we can assume all tallies are spatially
     // separate, this implies that once a tally has been scored to, we needn't
@@ -2320,41 +2226,33 @@ void score_analog_tally_ce(Particle& p)
 
 void score_analog_tally_mg(Particle& p)
 {
-  for (auto i_tally : model::active_analog_tallies) {
+  // Bins of filters shared between tallies, evaluated once for this event
+  SharedFilterBins shared;
+
+  for (int j = 0; j < model::active_analog_tallies_size; ++j) {
+    int i_tally = model::device_active_analog_tallies[j];
     const Tally& tally {model::tallies[i_tally]};
-    
-    // Allocate particle FilterMatch array on the stack
-    FilterMatch filter_matches[FILTER_MATCHES_SIZE];
-    p.filter_matches_ = filter_matches;
+    TallyStatsProbe probe {tally, p.id_};
 
-    // Initialize an iterator over valid filter bin combinations.  If there are
-    // no valid combinations, use a continue statement to ensure we skip the
-    // assume_separate break below.
-    auto filter_iter = FilterBinIter(tally, p);
-    //auto end = FilterBinIter(tally, true, &p->filter_matches_);
-    auto end = FilterBinIter(tally, true, p.filter_matches_);
-    if (filter_iter == end) continue;
-
-    // Loop over filter bins.
-    for (; filter_iter != end; ++filter_iter) {
-      auto filter_index = filter_iter.index_;
-      auto filter_weight = filter_iter.weight_;
+    // Only the nuclide bins present in the material are visited
+    int n_nuclide_bins;
+    const TallyNuclide* nuclide_bins =
+      tally.material_nuclides(p.material_, n_nuclide_bins);
 
+    // Loop over valid filter bin combinations. If there are none, skip the
+    // assume_separate break below.
+    bool scored = false;
+    for_each_filter_bin(tally, p, shared, [&](int filter_index, double filter_weight) {
+      probe.visit();
       // Loop over nuclide bins.
-      for (auto i = 0; i < tally.nuclides_.size(); ++i) {
-        auto i_nuclide = tally.nuclides_[i];
-
-        double atom_density = 0.;
-        if (i_nuclide >= 0) {
-          auto j = model::materials[p.material_].mat_nuclide_index_[i_nuclide];
-          if (j == C_NONE) continue;
-          atom_density = model::materials[p.material_].atom_density_(j);
-        }
-
-        score_general_mg(p, i_tally, i*tally.scores_.size(), filter_index,
-          filter_weight, i_nuclide, atom_density, 1.0);
+      for (int k = 0; k < n_nuclide_bins; ++k) {
+        score_general_mg(p, i_tally, nuclide_bins[k].bin*tally.scores_.size(),
+          filter_index, filter_weight, nuclide_bins[k].nuclide,
+          nuclide_bins[k].atom_density, 1.0);
       }
-    }
+      scored = true;
+    });
+    if (!scored) continue;
 
     // If the user has specified that we can assume all tallies are spatially
     // separate, this implies that once a tally has been scored to, we needn't
@@ -2364,72 +2262,83 @@ void score_analog_tally_mg(Particle& p)
   }
 }
 
+//! Score the nuclide bins of a tracklength tally present in the particle's
+//! material to one combination of filter bins
+
+void
+score_tracklength_bin(Particle& p, int i_tally, int filter_index,
+  double filter_weight, const TallyNuclide* nuclide_bins, int n_nuclide_bins,
+  double flux, bool need_depletion_rx)
+{
+  const Tally& tally {model::tallies[i_tally]};
+
+  #ifdef NO_MICRO_XS_CACHE
+  // Find energy index on energy grid
+  int i_grid = energy_grid_search_index(p.E_);
+  #endif
+
+  // Loop over nuclide bins.
+  for (int k = 0; k < n_nuclide_bins; ++k) {
+    int i = nuclide_bins[k].bin;
+    int i_nuclide = nuclide_bins[k].nuclide;
+    double atom_density = nuclide_bins[k].atom_density;
+
+    NuclideMicroXS micro;
+    double* micro_rx = nullptr;
+    #ifdef NO_MICRO_XS_CACHE
+    double micro_rx_local[MAX_DEPLETION_RX];
+    #endif
+    if (i_nuclide >= 0 && p.material_ != MATERIAL_VOID) {
+      #ifndef NO_MICRO_XS_CACHE
+      micro = p.neutron_xs_[i_nuclide];
+      if (need_depletion_rx) micro_rx = p.micro_rx(i_nuclide);
+      #else
+      if (need_depletion_rx) micro_rx = micro_rx_local;
+      micro = data::nuclides[i_nuclide].calculate_xs<NuclideMicroXS>(i_grid, p, micro_rx, p.E_, p.sqrtkT_);
+      #endif
+    }
+
+    //TODO: consider replacing this "if" with pointers or templates
+    if (settings::run_CE) {
+      score_general_ce_nonanalog(p, i_tally, i*tally.scores_.size(), filter_index,
+        filter_weight, i_nuclide, atom_density, flux, micro, micro_rx);
+    } else {
+      score_general_mg(p, i_tally, i*tally.scores_.size(), filter_index,
+        filter_weight, i_nuclide, atom_density, flux);
+    }
+  }
+}
+
 void
 score_tracklength_tally(Particle& p, double distance, bool need_depletion_rx)
 {
   // Determine the tracklength estimate of the flux
   double flux = p.wgt_ * distance;
-  
-  double E = p.E_;
-  double sqrtkT = p.sqrtkT_;
+
+  // Bins of filters shared between tallies, evaluated once for this event
+  SharedFilterBins shared;
 
   for (int i = 0; i < model::active_tracklength_tallies_size; ++i) {
     int i_tally = model::device_active_tracklength_tallies[i];
     const Tally& tally {model::tallies[i_tally]};
-    
-    // Allocate particle FilterMatch array on the stack
-    FilterMatch filter_matches[FILTER_MATCHES_SIZE];
-    p.filter_matches_ = filter_matches;
-
-    // Initialize an iterator over valid filter bin combinations.  If there are
-    // no valid combinations, use a continue statement to ensure we skip the
-    // assume_separate break below.
-    auto filter_iter = FilterBinIter(tally, p);
-    //auto end = FilterBinIter(tally, true, &p->filter_matches_);
-    auto end = FilterBinIter(tally, true, p.filter_matches_);
-    if (filter_iter == end) continue;
-
-    // Loop over filter bins.
-    for (; filter_iter != end; ++filter_iter) {
-      auto filter_index = filter_iter.index_;
-      auto filter_weight = filter_iter.weight_;
-
-      #ifdef NO_MICRO_XS_CACHE
-      // Find energy index on energy grid
-      int neutron = static_cast<int>(Particle::Type::neutron);
-      int i_grid = std::log(E/data::energy_min[neutron])/simulation::log_spacing;
-      #endif
-
-      // Loop over nuclide bins.
-      for (auto i = 0; i < tally.nuclides_.size(); ++i) {
-        auto i_nuclide = tally.nuclides_[i];
-
-        double atom_density = 0.;
-        NuclideMicroXS micro;
-        if (i_nuclide >= 0) {
-          if (p.material_ != MATERIAL_VOID) {
-            auto j = model::materials[p.material_].mat_nuclide_index(i_nuclide);
-            if (j == C_NONE) continue;
-            atom_density = model::materials[p.material_].atom_density(j);
-            #ifndef NO_MICRO_XS_CACHE
-            micro = p.neutron_xs_[i_nuclide];
-            #else
-            micro = data::nuclides[i_nuclide].calculate_xs<NuclideMicroXS>(i_grid, p, need_depletion_rx, E, sqrtkT);
-            #endif
-          }
-        }
-
-        //TODO: consider replacing this "if" with pointers or templates
-        if (settings::run_CE) {
-          score_general_ce_nonanalog(p, i_tally, i*tally.scores_.size(), filter_index,
-            filter_weight, i_nuclide, atom_density, flux, micro);
-        } else {
-          not_supported();
-          //score_general_mg(p, i_tally, i*tally.scores_.size(), filter_index,
-          //  filter_weight, i_nuclide, atom_density, flux);
-        }
-      }
-    }
+    TallyStatsProbe probe {tally, p.id_};
+
+    // Only the nuclide bins present in the material are visited
+    int n_nuclide_bins;
+    const TallyNuclide* nuclide_bins =
+      tally.material_nuclides(p.material_, n_nuclide_bins);
+
+    // Loop over valid filter bin combinations. Tallies with a mesh filter
+    // are scored as the track is marched through the mesh. If there are no
+    // combinations, skip the assume_separate break below.
+    bool scored = false;
+    for_each_filter_bin(tally, p, shared, [&](int filter_index, double filter_weight) {
+      probe.visit();
+      score_tracklength_bin(p, i_tally, filter_index, filter_weight,
+        nuclide_bins, n_nuclide_bins, flux, need_depletion_rx);
+      scored = true;
+    });
+    if (!scored) continue;
 
     // If the user has specified that we can assume all tallies are spatially
     // separate, this implies that once a tally has been scored to, we needn't
@@ -2447,50 +2356,66 @@ void score_collision_tally(Particle& p)
     flux = p.wgt_last_ / p.macro_xs_.total;
   }
 
-  for (auto i_tally : model::active_collision_tallies) {
-    const Tally& tally {model::tallies[i_tally]};
-    
-    // Allocate particle FilterMatch array on the stack
-    FilterMatch filter_matches[FILTER_MATCHES_SIZE];
-    p.filter_matches_ = filter_matches;
+  #ifdef NO_MICRO_XS_CACHE
+  // Find the pre-collision energy index on the energy grid
+  int i_grid = energy_grid_search_index(p.E_last_);
+  #endif
 
-    // Initialize an iterator over valid filter bin combinations.  If there are
-    // no valid combinations, use a continue statement to ensure we skip the
-    // assume_separate break below.
-    auto filter_iter = FilterBinIter(tally, p);
-    //auto end = FilterBinIter(tally, true, &p->filter_matches_);
-    auto end = FilterBinIter(tally, true, p.filter_matches_);
-    if (filter_iter == end) continue;
+  // Bins of filters shared between tallies, evaluated once for this event
+  SharedFilterBins shared;
 
-    // Loop over filter bins.
-    for (; filter_iter != end; ++filter_iter) {
-      auto filter_index = filter_iter.index_;
-      auto filter_weight = filter_iter.weight_;
+  for (int j = 0; j < model::active_collision_tallies_size; ++j) {
+    int i_tally = model::device_active_collision_tallies[j];
+    const Tally& tally {model::tallies[i_tally]};
+    TallyStatsProbe probe {tally, p.id_};
 
-      // Loop over nuclide bins.
-      for (auto i = 0; i < tally.nuclides_.size(); ++i) {
-        auto i_nuclide = tally.nuclides_[i];
+    // Only the nuclide bins present in the material are visited
+    int n_nuclide_bins;
+    const TallyNuclide* nuclide_bins =
+      tally.material_nuclides(p.material_, n_nuclide_bins);
 
-        double atom_density = 0.;
+    // Loop over valid filter bin combinations. If there are none, skip the
+    // assume_separate break below.
+    bool scored = false;
+    for_each_filter_bin(tally, p, shared, [&](int filter_index, double filter_weight) {
+      probe.visit();
+      // Loop over nuclide bins.
+      for (int k = 0; k < n_nuclide_bins; ++k) {
+        int i = nuclide_bins[k].bin;
+        int i_nuclide = nuclide_bins[k].nuclide;
+        double atom_density = nuclide_bins[k].atom_density;
+
+        // Microscopic cross sections are those at the pre-collision energy.
+        // They are still cached, as the collision only marks them stale; when
+        // not cached, they are recomputed including depletion reactions.
+        NuclideMicroXS micro;
+        double* micro_rx = nullptr;
+        #ifdef NO_MICRO_XS_CACHE
+        double micro_rx_local[MAX_DEPLETION_RX];
+        #endif
         if (i_nuclide >= 0) {
-          auto j = model::materials[p.material_].mat_nuclide_index_[i_nuclide];
-          if (j == C_NONE) continue;
-          atom_density = model::materials[p.material_].atom_density_(j);
+          #ifndef NO_MICRO_XS_CACHE
+          micro = p.neutron_xs_[i_nuclide];
+          if (p.depletion_rx_) micro_rx = p.micro_rx(i_nuclide);
+          #else
+          if (simulation::n_depletion_rx > 0) micro_rx = micro_rx_local;
+          micro = data::nuclides[i_nuclide].calculate_xs<NuclideMicroXS>(i_grid,
+            p, micro_rx, p.E_last_, p.sqrtkT_);
+          #endif
         }
 
-        // TODO:
-        NuclideMicroXS micro;
-
         //TODO: consider replacing this "if" with pointers or templates
         if (settings::run_CE) {
           score_general_ce_nonanalog(p, i_tally, i*tally.scores_.size(), filter_index,
-            filter_weight, i_nuclide, atom_density, flux, micro);
+            filter_weight, i_nuclide, atom_density, flux, micro, micro_rx);
         } else {
           score_general_mg(p, i_tally, i*tally.scores_.size(), filter_index,
             filter_weight, i_nuclide, atom_density, flux);
         }
       }
-    }
+      scored = true;
+    });
+    if (!scored) continue;
 
     // If the user has specified that we can assume all tallies are spatially
     // separate, this implies that once a tally has been scored to, we needn't
@@ -2501,13 +2426,14 @@ void score_collision_tally(Particle& p)
 }
 
 void
-score_surface_tally(Particle& p, const std::vector<int>& tallies)
+score_surface_tally(Particle& p, const int* tallies, int n_tallies)
 {
   // No collision, so no weight change when survival biasing
   double current = p.wgt_last_;
 
-  for (auto i_tally : tallies) {
-    auto& tally {model::tallies[i_tally]};
+  for (int i = 0; i < n_tallies; ++i) {
+    auto& tally {model::tallies[tallies[i]]};
+    TallyStatsProbe probe {tally, p.id_};
     
     // Allocate particle FilterMatch array on the stack
     FilterMatch filter_matches[FILTER_MATCHES_SIZE];
@@ -2525,6 +2451,7 @@ score_surface_tally(Particle& p, const std::vector<int>& tallies)
     for (; filter_iter != end; ++filter_iter) {
       auto filter_index = filter_iter.index_;
       auto filter_weight = filter_iter.weight_;
+      probe.visit();
 
       // Loop over scores.
       // There is only one score type for current tallies so there is no need
@@ -2532,8 +2459,7 @@ score_surface_tally(Particle& p, const std::vector<int>& tallies)
       double score = current * filter_weight;
       for (auto score_index = 0; score_index < tally.scores_.size();
            ++score_index) {
-        #pragma omp atomic
-        *tally.results(filter_index, score_index, TallyResult::VALUE) += score;
+        tally.add_result(filter_index, score_index, score);
       }
     }
 
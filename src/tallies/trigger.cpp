@@ -1,7 +1,8 @@
 #include "openmc/tallies/trigger.h"
 
+#include <algorithm> // for max
 #include <cmath>
-#include <utility> // for std::pair
+#include <cstdint>
 
 #include <fmt/core.h>
 
@@ -23,24 +24,72 @@ namespace settings {
   KTrigger keff_trigger;
 }
 
+namespace simulation {
+  double trigger_ratio {0.0};
+}
+
 //==============================================================================
 // Non-member functions
 //==============================================================================
 
-std::pair<double, double>
-get_tally_uncertainty(int i_tally, int score_index, int filter_index)
+#pragma omp declare target
+//! Compute the uncertainty/threshold ratio of a trigger for one tally bin.
+//
+//! \param sum Sum of the bin's batch results
+//! \param sum_sq Sum of the squares of the bin's batch results
+//! \param n Number of realizations
+//! \param trigger The trigger applied to the bin
+
+double
+trigger_bin_ratio(double sum, double sum_sq, int n, const Trigger& trigger)
 {
-  const auto& tally {&model::tallies[i_tally]};
+  double mean = sum / n;
+  double std_dev = std::sqrt((sum_sq/n - mean*mean) / (n-1));
 
-  auto sum = *tally->results(filter_index, score_index, TallyResult::SUM);
-  auto sum_sq = *tally->results(filter_index, score_index, TallyResult::SUM_SQ);
+  // Pick out the relevant uncertainty metric for this trigger.
+  switch (trigger.metric) {
+  case TriggerMetric::variance:
+    return std::sqrt(std_dev * std_dev / trigger.threshold);
+  case TriggerMetric::standard_deviation:
+    return std_dev / trigger.threshold;
+  case TriggerMetric::relative_error:
+    return ((mean != 0.) ? std_dev / std::abs(mean) : 0.) / trigger.threshold;
+  default:
+    return 0.;
+  }
+}
+#pragma omp end declare target
 
-  int n = tally->n_realizations_;
-  auto mean = sum / n;
-  double std_dev = std::sqrt((sum_sq/n - mean*mean) / (n-1));
-  double rel_err = (mean != 0.) ? std_dev / std::abs(mean) : 0.;
+//! Find the largest uncertainty/threshold ratio of a trigger over the bins of
+//! its score. For a tally accumulated on device, the ratio is reduced there
+//! so that only it, rather than the tally results, is copied back to host.
 
-  return {std_dev, rel_err};
+double
+tally_trigger_ratio(const Tally& t, const Trigger& trigger)
+{
+  int n = t.n_realizations_;
+  int64_t n_filter_bins = t.n_filter_bins();
+  int64_t n_scores = t.n_scores_;
+  int j = trigger.score_index;
+  double ratio = 0.;
+
+  if (t.accumulate_on_device_ && t.host_results_stale_) {
+    const double* res = t.results_;
+    #pragma omp target teams distribute parallel for reduction(max:ratio) map(tofrom: ratio)
+    for (int64_t i = 0; i < n_filter_bins; ++i) {
+      const double* result = res + (i * n_scores + j) * 3;
+      ratio = std::max(ratio, trigger_bin_ratio(
+        result[static_cast<int>(TallyResult::SUM)],
+        result[static_cast<int>(TallyResult::SUM_SQ)], n, trigger));
+    }
+  } else {
+    for (int64_t i = 0; i < n_filter_bins; ++i) {
+      ratio = std::max(ratio, trigger_bin_ratio(
+        *t.results(i, j, TallyResult::SUM),
+        *t.results(i, j, TallyResult::SUM_SQ), n, trigger));
+    }
+  }
+  return ratio;
 }
 
 //! Find the limiting limiting tally trigger.
@@ -54,6 +103,9 @@ void
 check_tally_triggers(double& ratio, int& tally_id, int& score)
 {
   ratio = 0.;
+#ifdef OPENMC_MPI
+  complete_tally_reductions();
+#endif
   for (auto i_tally = 0; i_tally < model::tallies_size; ++i_tally) {
     const Tally& t {model::tallies[i_tally]};
 
@@ -64,45 +116,12 @@ check_tally_triggers(double& ratio, int& tally_id, int& score)
       // Skip trigger if it is not active
       if (trigger.metric == TriggerMetric::not_active) continue;
 
-      for (auto filter_index = 0; filter_index < t.results_shape()[0];
-           ++filter_index) {
-        for (auto score_index = 0; score_index < t.results_shape()[1];
-             ++score_index) {
-          // Compute the tally uncertainty metrics.
-          auto uncert_pair = get_tally_uncertainty(i_tally, score_index,
-            filter_index);
-          double std_dev = uncert_pair.first;
-          double rel_err = uncert_pair.second;
-
-          // Pick out the relevant uncertainty metric for this trigger.
-          double uncertainty;
-          switch (trigger.metric) {
-            case TriggerMetric::variance:
-              uncertainty = std_dev * std_dev;
-              break;
-            case TriggerMetric::standard_deviation:
-              uncertainty = std_dev;
-              break;
-            case TriggerMetric::relative_error:
-              uncertainty = rel_err;
-              break;
-            case TriggerMetric::not_active:
-              UNREACHABLE();
-          }
-
-          // Compute the uncertainty / threshold ratio.
-          double this_ratio = uncertainty / trigger.threshold;
-          if (trigger.metric == TriggerMetric::variance) {
-            this_ratio = std::sqrt(ratio);
-          }
-
-          // If this is the most uncertain value, set the output variables.
-          if (this_ratio > ratio) {
-            ratio = this_ratio;
-            score = t.scores_[trigger.score_index];
-            tally_id = t.id_;
-          }
-        }
+      // If this is the most uncertain value, set the output variables.
+      double this_ratio = tally_trigger_ratio(t, trigger);
+      if (this_ratio > ratio) {
+        ratio = this_ratio;
+        score = t.scores_[trigger.score_index];
+        tally_id = t.id_;
       }
     }
   }
@@ -161,6 +180,7 @@ check_triggers()
   double tally_ratio;
   int tally_id, score;
   check_tally_triggers(tally_ratio, tally_id, score);
+  simulation::trigger_ratio = std::max(keff_ratio, tally_ratio);
 
   // If all the triggers are satisfied, alert the user and return.
   if (std::max(keff_ratio, tally_ratio) <= 1.) {
@@ -227,6 +227,64 @@ void ThermalScattering::release_from_device()
   kTs_.release_device();
 }
 
+//==============================================================================
+// Specialized S(a,b) kernels
+//==============================================================================
+
+#pragma omp declare target
+template<ThermalElastic M>
+double elastic_xs(const uint8_t* xs, double E)
+{
+  if constexpr (M == ThermalElastic::coherent) {
+    return CoherentElasticXSFlat(xs)(E);
+  } else if constexpr (M == ThermalElastic::incoherent) {
+    return IncoherentElasticXSFlat(xs)(E);
+  } else if constexpr (M == ThermalElastic::incoherent_discrete) {
+    return Tabulated1DFlat(xs)(E);
+  } else {
+    return Function1DFlat(xs)(E);
+  }
+}
+
+template<ThermalInelastic M>
+double inelastic_xs(const uint8_t* xs, double E)
+{
+  if constexpr (M == ThermalInelastic::generic) {
+    return Function1DFlat(xs)(E);
+  } else {
+    return Tabulated1DFlat(xs)(E);
+  }
+}
+
+template<ThermalElastic M>
+void sample_elastic(const uint8_t* dist, double E_in, double& E_out,
+  double& mu, uint64_t* seed)
+{
+  if constexpr (M == ThermalElastic::coherent) {
+    CoherentElasticAEFlat(dist).sample(E_in, E_out, mu, seed);
+  } else if constexpr (M == ThermalElastic::incoherent) {
+    IncoherentElasticAEFlat(dist).sample(E_in, E_out, mu, seed);
+  } else if constexpr (M == ThermalElastic::incoherent_discrete) {
+    IncoherentElasticAEDiscreteFlat(dist).sample(E_in, E_out, mu, seed);
+  } else {
+    AngleEnergyFlat(dist).sample(E_in, E_out, mu, seed);
+  }
+}
+
+template<ThermalInelastic M>
+void sample_inelastic(const uint8_t* dist, double E_in, double& E_out,
+  double& mu, uint64_t* seed)
+{
+  if constexpr (M == ThermalInelastic::continuous) {
+    IncoherentInelasticAEFlat(dist).sample(E_in, E_out, mu, seed);
+  } else if constexpr (M == ThermalInelastic::discrete) {
+    IncoherentInelasticAEDiscreteFlat(dist).sample(E_in, E_out, mu, seed);
+  } else {
+    AngleEnergyFlat(dist).sample(E_in, E_out, mu, seed);
+  }
+}
+#pragma omp end declare target
+
 //==============================================================================
 // ThermalData implementation
 //==============================================================================
@@ -288,20 +346,66 @@ ThermalData::ThermalData(hid_t group)
 
     close_group(inelastic_group);
   }
+
+  // Resolve the kernels matching the types of data read
+  if (elastic_.xs && elastic_.distribution) {
+    auto xs_type = elastic_.xs->type();
+    auto dist_type = elastic_.distribution->type();
+    if (xs_type == FunctionType::COHERENT_ELASTIC &&
+        dist_type == AngleEnergyType::COHERENT_ELASTIC) {
+      elastic_mode_ = ThermalElastic::coherent;
+    } else if (xs_type == FunctionType::INCOHERENT_ELASTIC &&
+        dist_type == AngleEnergyType::INCOHERENT_ELASTIC) {
+      elastic_mode_ = ThermalElastic::incoherent;
+    } else if (xs_type == FunctionType::TABULATED &&
+        dist_type == AngleEnergyType::INCOHERENT_ELASTIC_DISCRETE) {
+      elastic_mode_ = ThermalElastic::incoherent_discrete;
+    } else {
+      elastic_mode_ = ThermalElastic::generic;
+    }
+  } else if (elastic_.xs) {
+    elastic_mode_ = ThermalElastic::generic;
+  }
+
+  if (inelastic_.xs && inelastic_.distribution &&
+      inelastic_.xs->type() == FunctionType::TABULATED) {
+    auto dist_type = inelastic_.distribution->type();
+    if (dist_type == AngleEnergyType::INCOHERENT_INELASTIC) {
+      inelastic_mode_ = ThermalInelastic::continuous;
+    } else if (dist_type == AngleEnergyType::INCOHERENT_INELASTIC_DISCRETE) {
+      inelastic_mode_ = ThermalInelastic::discrete;
+    }
+  }
 }
 
 void
 ThermalData::calculate_xs(double E, double* elastic, double* inelastic) const
 {
   // Calculate thermal elastic scattering cross section
-  if (elastic_.device_xs) {
-    *elastic = (*elastic_.device_xs)(E);
-  } else {
+  switch (elastic_mode_) {
+  case ThermalElastic::none:
     *elastic = 0.0;
+    break;
+  case ThermalElastic::coherent:
+    *elastic = elastic_xs<ThermalElastic::coherent>(elastic_.device_xs->data(), E);
+    break;
+  case ThermalElastic::incoherent:
+    *elastic = elastic_xs<ThermalElastic::incoherent>(elastic_.device_xs->data(), E);
+    break;
+  case ThermalElastic::incoherent_discrete:
+    *elastic = elastic_xs<ThermalElastic::incoherent_discrete>(elastic_.device_xs->data(), E);
+    break;
+  case ThermalElastic::generic:
+    *elastic = elastic_xs<ThermalElastic::generic>(elastic_.device_xs->data(), E);
+    break;
   }
 
   // Calculate thermal inelastic scattering cross section
-  *inelastic = (*inelastic_.device_xs)(E);
+  if (inelastic_mode_ == ThermalInelastic::generic) {
+    *inelastic = inelastic_xs<ThermalInelastic::generic>(inelastic_.device_xs->data(), E);
+  } else {
+    *inelastic = inelastic_xs<ThermalInelastic::continuous>(inelastic_.device_xs->data(), E);
+  }
 }
 
 void
@@ -310,9 +414,33 @@ ThermalData::sample(const NuclideMicroXS& micro_xs, double E,
 {
   // Determine whether inelastic or elastic scattering will occur
   if (prn(seed) < micro_xs.thermal_elastic / micro_xs.thermal) {
-    elastic_.device_distribution->sample(E, *E_out, *mu, seed);
+    const uint8_t* dist = elastic_.device_distribution->data();
+    switch (elastic_mode_) {
+    case ThermalElastic::coherent:
+      sample_elastic<ThermalElastic::coherent>(dist, E, *E_out, *mu, seed);
+      break;
+    case ThermalElastic::incoherent:
+      sample_elastic<ThermalElastic::incoherent>(dist, E, *E_out, *mu, seed);
+      break;
+    case ThermalElastic::incoherent_discrete:
+      sample_elastic<ThermalElastic::incoherent_discrete>(dist, E, *E_out, *mu, seed);
+      break;
+    default:
+      sample_elastic<ThermalElastic::generic>(dist, E, *E_out, *mu, seed);
+    }
   } else {
-    inelastic_.device_distribution->sample(E, *E_out, *mu, seed);
+    const uint8_t* dist = inelastic_.device_distribution->data();
+    switch (inelastic_mode_) {
+    case ThermalInelastic::continuous:
+      sample_inelastic<ThermalInelastic::continuous>(dist, E, *E_out, *mu, seed);
+      break;
+    case ThermalInelastic::discrete:
+      sample_inelastic<ThermalInelastic::discrete>(dist, E, *E_out, *mu, seed);
+      break;
+    case ThermalInelastic::generic:
+      sample_inelastic<ThermalInelastic::generic>(dist, E, *E_out, *mu, seed);
+      break;
+    }
   }
 
   // Because of floating-point roundoff, it may be possible for mu to be
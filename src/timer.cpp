@@ -1,5 +1,7 @@
 #include "openmc/timer.h"
 
+#include "openmc/kernel_profile.h"
+
 namespace openmc {
 
 //==============================================================================
@@ -11,15 +13,22 @@ namespace simulation {
 Timer time_active;
 Timer time_bank;
 Timer time_bank_sample;
+Timer time_bank_sort;
 Timer time_bank_sendrecv;
 Timer time_finalize;
 Timer time_inactive;
 Timer time_initialize;
 Timer time_read_xs;
+Timer time_read_materials;
+Timer time_read_geometry;
+Timer time_finalize_geometry;
+Timer time_read_tallies;
+Timer time_distribcell;
 Timer time_statepoint;
 Timer time_accumulate_tallies;
 Timer time_total;
 Timer time_transport;
+Timer time_transport_local;
 Timer time_event_init;
 Timer time_event_calculate_xs;
 Timer time_event_calculate_xs_fuel;
@@ -31,6 +40,8 @@ Timer time_event_collision;
 Timer time_event_death;
 Timer time_event_revival;
 Timer time_event_sort;
+Timer time_event_tail;
+Timer time_event_compact;
 
 } // namespace simulation
 
@@ -75,15 +86,22 @@ void reset_timers()
   simulation::time_active.reset();
   simulation::time_bank.reset();
   simulation::time_bank_sample.reset();
+  simulation::time_bank_sort.reset();
   simulation::time_bank_sendrecv.reset();
   simulation::time_finalize.reset();
   simulation::time_inactive.reset();
   simulation::time_initialize.reset();
   simulation::time_read_xs.reset();
+  simulation::time_read_materials.reset();
+  simulation::time_read_geometry.reset();
+  simulation::time_finalize_geometry.reset();
+  simulation::time_read_tallies.reset();
+  simulation::time_distribcell.reset();
   simulation::time_statepoint.reset();
   simulation::time_accumulate_tallies.reset();
   simulation::time_total.reset();
   simulation::time_transport.reset();
+  simulation::time_transport_local.reset();
   simulation::time_event_init.reset();
   simulation::time_event_calculate_xs.reset();
   simulation::time_event_calculate_xs_fuel.reset();
@@ -94,6 +112,9 @@ void reset_timers()
   simulation::time_event_death.reset();
   simulation::time_event_revival.reset();
   simulation::time_event_sort.reset();
+  simulation::time_event_tail.reset();
+  simulation::time_event_compact.reset();
+  reset_kernel_profiles();
 }
 
 } // namespace openmc
@@ -1,16 +1,19 @@
 #include "openmc/track_output.h"
 
 #include "openmc/constants.h"
+#include "openmc/error.h"
 #include "openmc/hdf5_interface.h"
-#include "openmc/position.h"
+#include "openmc/message_passing.h"
 #include "openmc/settings.h"
 #include "openmc/simulation.h"
+#include "openmc/state_point.h"
 
 #include <fmt/core.h>
-#include "xtensor/xtensor.hpp"
+#include "hdf5.h"
 
-#include <cstddef> // for size_t
+#include <algorithm> // for copy, min, sort
 #include <string>
+#include <tuple>     // for tie
 #include <vector>
 
 namespace openmc {
@@ -19,56 +22,202 @@ namespace openmc {
 // Global variables
 //==============================================================================
 
+namespace simulation {
+
+// Points are appended by every thread on host, or every particle in flight on
+// device, and written by the master process at the end of each generation
+SharedArray<TrackPoint> track_points;
+int* device_track_identifiers {nullptr};
+int n_track_identifiers {0};
+
+} // namespace simulation
+
+namespace {
+
+hid_t track_file {-1};             // Track file, open on the master process
+hsize_t n_points_written {0};      // Rows written to the coordinates dataset
+std::vector<int> track_identifiers; // settings::track_identifiers, flattened
+#ifdef OPENMC_MPI
+MPI_Datatype mpi_track_point;
+#endif
+
+} // namespace
+
 //==============================================================================
 // Non-member functions
 //==============================================================================
 
+bool track_particle(int64_t id)
+{
+  if (settings::write_all_tracks) return true;
+  for (int i = 0; i < simulation::n_track_identifiers; ++i) {
+    const int* t = simulation::device_track_identifiers + 3*i;
+    if (simulation::current_batch == t[0] && simulation::current_gen == t[1] &&
+        id == t[2]) return true;
+  }
+  return false;
+}
+
 void add_particle_track(Particle& p)
 {
-  p.tracks_.emplace_back();
+  ++p.n_tracks_;
+  p.n_track_points_ = 0;
 }
 
 void write_particle_track(Particle& p)
 {
-  p.tracks_.back().push_back(p.r());
+  simulation::track_points.thread_safe_append(
+    {p.r(), p.id_, p.n_tracks_ - 1, p.n_track_points_++});
 }
 
-void finalize_particle_track(Particle& p)
+void init_track_output()
 {
-  std::string filename = fmt::format("{}track_{}_{}_{}.h5",
-    settings::path_output, simulation::current_batch, simulation::current_gen,
-    p.id_);
-
-  // Determine number of coordinates for each particle
-  std::vector<int> n_coords;
-  for (auto& coords : p.tracks_) {
-    n_coords.push_back(coords.size());
+  if (!settings::write_all_tracks && settings::track_identifiers.empty()) {
+    return;
   }
 
-  #pragma omp critical (FinalizeParticleTrack)
-  {
-    hid_t file_id = file_open(filename, 'w');
-    write_attribute(file_id, "filetype", "track");
-    write_attribute(file_id, "version", VERSION_TRACK);
-    write_attribute(file_id, "n_particles", p.tracks_.size());
-    write_attribute(file_id, "n_coords", n_coords);
-    for (auto i = 1; i <= p.tracks_.size(); ++i) {
-      const auto& t {p.tracks_[i-1]};
-      size_t n = t.size();
-      xt::xtensor<double, 2> data({n,3});
-      for (int j = 0; j < n; ++j) {
-        data(j, 0) = t[j].x;
-        data(j, 1) = t[j].y;
-        data(j, 2) = t[j].z;
-      }
-      std::string name = fmt::format("coordinates_{}", i);
-      write_dataset(file_id, name.c_str(), data);
+  // Particles are selected where they are initialized, which may be on device
+  track_identifiers.clear();
+  for (const auto& t : settings::track_identifiers) {
+    track_identifiers.insert(track_identifiers.end(), t.begin(), t.end());
+  }
+  simulation::n_track_identifiers = settings::track_identifiers.size();
+  #pragma omp target update to(simulation::n_track_identifiers)
+  if (!track_identifiers.empty()) {
+    simulation::device_track_identifiers = track_identifiers.data();
+    #pragma omp target enter data map(to: simulation::device_track_identifiers[:track_identifiers.size()])
+  }
+
+  simulation::track_points.reserve(settings::track_buffer_size, "Track output");
+  simulation::track_points.allocate_on_device();
+
+  #ifdef OPENMC_MPI
+  MPI_Type_contiguous(sizeof(TrackPoint), MPI_BYTE, &mpi_track_point);
+  MPI_Type_commit(&mpi_track_point);
+  #endif
+
+  n_points_written = 0;
+  if (mpi::master) {
+    finish_statepoint_write();
+    track_file = file_open(settings::path_output + "tracks.h5", 'w');
+    write_attribute(track_file, "filetype", "track");
+    write_attribute(track_file, "version", VERSION_TRACK);
+    create_extendable_dataset(track_file, "coordinates", H5T_NATIVE_DOUBLE, 3);
+    create_extendable_dataset(track_file, "tracks", H5T_NATIVE_INT64, 6);
+  }
+}
+
+void flush_track_output()
+{
+  auto& points = simulation::track_points;
+  if (points.capacity() == 0) return;
+
+  // Points are appended on device by event-based and device history-based
+  // transport, and on host by host history-based transport and the host share
+  // of hybrid transport. Those appended on host are set aside while the ones
+  // appended on device are copied over them, and joined after.
+  bool on_device = settings::event_based;
+  #ifdef DEVICE_HISTORY
+  on_device = true;
+  #endif
+  if (on_device) {
+    std::vector<TrackPoint> host_points(points.data(),
+      points.data() + points.size());
+    points.copy_device_to_host();
+    int n_host = std::min(static_cast<int>(host_points.size()),
+      points.capacity() - points.size());
+    std::copy(host_points.begin(), host_points.begin() + n_host,
+      points.data() + points.size());
+    points.set_host_size(points.size() + n_host);
+  }
+
+  // The size is clamped to the capacity once the buffer is full
+  int n = points.size();
+  bool full = n == points.capacity();
+
+  // Gather the points of every process onto the master
+  #ifdef OPENMC_MPI
+  std::vector<int> counts(mpi::n_procs);
+  std::vector<int> displs(mpi::n_procs);
+  MPI_Gather(&n, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, mpi::intracomm);
+  int64_t n_total = 0;
+  if (mpi::master) {
+    for (int i = 0; i < mpi::n_procs; ++i) {
+      displs[i] = n_total;
+      n_total += counts[i];
+      if (counts[i] == points.capacity()) full = true;
+    }
+  }
+  std::vector<TrackPoint> all(n_total);
+  MPI_Gatherv(points.data(), n, mpi_track_point, all.data(), counts.data(),
+    displs.data(), mpi_track_point, 0, mpi::intracomm);
+  #else
+  std::vector<TrackPoint> all(points.data(), points.data() + n);
+  #endif
+  points.resize(0);
+
+  if (!mpi::master) return;
+  if (full) {
+    warning(fmt::format("The track buffer of {} points filled during batch {} "
+      "generation {}; later points were not written. Increase it with "
+      "--track-buffer.", settings::track_buffer_size,
+      simulation::current_batch, simulation::current_gen));
+  }
+  if (all.empty()) return;
+
+  std::sort(all.begin(), all.end(),
+    [](const TrackPoint& a, const TrackPoint& b) {
+      return std::tie(a.particle, a.track, a.point) <
+        std::tie(b.particle, b.track, b.point);
+    });
+
+  // One row of coordinates per point and, per track, a row of the index:
+  // batch, generation, particle, track, first row and number of rows
+  std::vector<double> coords;
+  coords.reserve(3 * all.size());
+  std::vector<int64_t> index;
+  for (int64_t i = 0; i < all.size(); ++i) {
+    const auto& t = all[i];
+    coords.insert(coords.end(), {t.r.x, t.r.y, t.r.z});
+    if (i == 0 || t.particle != all[i-1].particle ||
+        t.track != all[i-1].track) {
+      index.insert(index.end(), {simulation::current_batch,
+        simulation::current_gen, t.particle, t.track,
+        static_cast<int64_t>(n_points_written + i), 0});
     }
-    file_close(file_id);
+    ++index.back();
+  }
+
+  finish_statepoint_write();
+  append_dataset_rows(track_file, "coordinates", H5T_NATIVE_DOUBLE,
+    all.size(), coords.data());
+  append_dataset_rows(track_file, "tracks", H5T_NATIVE_INT64, index.size() / 6,
+    index.data());
+  n_points_written += all.size();
+}
+
+void finalize_track_output()
+{
+  auto& points = simulation::track_points;
+  if (points.capacity() == 0) return;
+
+  if (mpi::master) {
+    finish_statepoint_write();
+    file_close(track_file);
+    track_file = -1;
+  }
+
+  #pragma omp target exit data map(release: points.data_[:points.capacity()])
+  points.clear();
+  if (!track_identifiers.empty()) {
+    #pragma omp target exit data map(release: simulation::device_track_identifiers[:track_identifiers.size()])
   }
+  simulation::device_track_identifiers = nullptr;
+  track_identifiers.clear();
 
-  // Clear particle tracks
-  p.tracks_.clear();
+  #ifdef OPENMC_MPI
+  MPI_Type_free(&mpi_track_point);
+  #endif
 }
 
 } // namespace openmc
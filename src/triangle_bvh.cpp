@@ -0,0 +1,334 @@
+#include "openmc/triangle_bvh.h"
+
+#include <algorithm> // for max, min, partition, nth_element
+#include <cmath>     // for abs, fmax, fmin
+
+namespace openmc {
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace model {
+
+std::vector<TriangleBVH> cell_bvhs;
+TriangleBVH* device_cell_bvhs {nullptr};
+
+} // namespace model
+
+//==============================================================================
+// Hierarchy construction
+//==============================================================================
+
+namespace {
+
+struct Box {
+  Position lower {INFTY, INFTY, INFTY};
+  Position upper {-INFTY, -INFTY, -INFTY};
+
+  void grow(Position r)
+  {
+    lower = {std::min(lower.x, r.x), std::min(lower.y, r.y),
+      std::min(lower.z, r.z)};
+    upper = {std::max(upper.x, r.x), std::max(upper.y, r.y),
+      std::max(upper.z, r.z)};
+  }
+
+  void grow(const Box& other)
+  {
+    lower = {std::min(lower.x, other.lower.x), std::min(lower.y, other.lower.y),
+      std::min(lower.z, other.lower.z)};
+    upper = {std::max(upper.x, other.upper.x), std::max(upper.y, other.upper.y),
+      std::max(upper.z, other.upper.z)};
+  }
+
+  double area() const
+  {
+    Position d = upper - lower;
+    if (d.x < 0.0) return 0.0;
+    return 2.0 * (d.x*d.y + d.y*d.z + d.z*d.x);
+  }
+};
+
+struct BuildItem {
+  Box box;           //!< Bounding box of the triangle
+  Position centroid; //!< Center of the bounding box
+  int32_t triangle;  //!< Index of the triangle in the input
+};
+
+//! Build the subtree over items[begin, end) and return the index of its root
+int32_t build_node(std::vector<BuildItem>& items, int begin, int end,
+  int depth, std::vector<BVHNode>& nodes, std::vector<int32_t>& order)
+{
+  Box box, centroids;
+  for (int i = begin; i < end; ++i) {
+    box.grow(items[i].box);
+    centroids.grow(items[i].centroid);
+  }
+
+  int32_t i_node = nodes.size();
+  nodes.emplace_back();
+  for (int k = 0; k < 3; ++k) {
+    nodes[i_node].lower[k] = box.lower[k];
+    nodes[i_node].upper[k] = box.upper[k];
+  }
+
+  auto make_leaf = [&]() {
+    nodes[i_node].offset = order.size();
+    nodes[i_node].count = end - begin;
+    for (int i = begin; i < end; ++i) order.push_back(items[i].triangle);
+    return i_node;
+  };
+
+  int n = end - begin;
+  if (n <= BVH_LEAF_TRIANGLES || depth >= BVH_MAX_DEPTH - 1) {
+    return make_leaf();
+  }
+
+  // Find the cheapest split between bins of triangle centroids
+  double best_cost = INFTY;
+  int best_axis = -1;
+  int best_bin = 0;
+  for (int axis = 0; axis < 3; ++axis) {
+    double lower = centroids.lower[axis];
+    double extent = centroids.upper[axis] - lower;
+    if (extent <= 0.0) continue;
+
+    int counts[BVH_SAH_BINS] {};
+    Box boxes[BVH_SAH_BINS];
+    for (int i = begin; i < end; ++i) {
+      int b = std::min(BVH_SAH_BINS - 1, static_cast<int>(
+        BVH_SAH_BINS * (items[i].centroid[axis] - lower) / extent));
+      ++counts[b];
+      boxes[b].grow(items[i].box);
+    }
+
+    // Area and count of everything right of each split
+    double right_area[BVH_SAH_BINS];
+    int right_count[BVH_SAH_BINS];
+    Box right;
+    int n_right = 0;
+    for (int b = BVH_SAH_BINS - 1; b > 0; --b) {
+      right.grow(boxes[b]);
+      n_right += counts[b];
+      right_area[b] = right.area();
+      right_count[b] = n_right;
+    }
+
+    Box left;
+    int n_left = 0;
+    for (int b = 0; b < BVH_SAH_BINS - 1; ++b) {
+      left.grow(boxes[b]);
+      n_left += counts[b];
+      if (n_left == 0 || right_count[b + 1] == 0) continue;
+      double cost = n_left * left.area() + right_count[b + 1] * right_area[b + 1];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = b;
+      }
+    }
+  }
+
+  // All centroids coincide, or no split is cheaper than testing every
+  // triangle of a small leaf
+  if (best_axis < 0) return make_leaf();
+  if (best_cost >= n * box.area() && n <= 4 * BVH_LEAF_TRIANGLES) {
+    return make_leaf();
+  }
+
+  double lower = centroids.lower[best_axis];
+  double extent = centroids.upper[best_axis] - lower;
+  auto mid_it = std::partition(items.begin() + begin, items.begin() + end,
+    [&](const BuildItem& item) {
+      int b = std::min(BVH_SAH_BINS - 1, static_cast<int>(
+        BVH_SAH_BINS * (item.centroid[best_axis] - lower) / extent));
+      return b <= best_bin;
+    });
+  int mid = mid_it - items.begin();
+  if (mid == begin || mid == end) {
+    mid = begin + n / 2;
+    std::nth_element(items.begin() + begin, items.begin() + mid,
+      items.begin() + end, [&](const BuildItem& a, const BuildItem& b) {
+        return a.centroid[best_axis] < b.centroid[best_axis];
+      });
+  }
+
+  build_node(items, begin, mid, depth + 1, nodes, order);
+  int32_t right_child = build_node(items, mid, end, depth + 1, nodes, order);
+  nodes[i_node].offset = right_child;
+  nodes[i_node].count = 0;
+  return i_node;
+}
+
+} // namespace
+
+//==============================================================================
+// TriangleBVH implementation
+//==============================================================================
+
+void TriangleBVH::build(std::vector<BVHTriangle> triangles)
+{
+  nodes_.clear();
+  triangles_.clear();
+  if (triangles.empty()) return;
+
+  std::vector<BuildItem> items(triangles.size());
+  for (int32_t i = 0; i < triangles.size(); ++i) {
+    auto& item {items[i]};
+    item.box.grow(triangles[i].v0);
+    item.box.grow(triangles[i].v1);
+    item.box.grow(triangles[i].v2);
+    item.centroid = 0.5 * (item.box.lower + item.box.upper);
+    item.triangle = i;
+  }
+
+  std::vector<BVHNode> nodes;
+  std::vector<int32_t> order;
+  nodes.reserve(2 * triangles.size() / BVH_LEAF_TRIANGLES + 1);
+  order.reserve(triangles.size());
+  build_node(items, 0, items.size(), 0, nodes, order);
+
+  nodes_.assign(nodes.begin(), nodes.end());
+  triangles_.reserve(order.size());
+  for (int32_t i : order) triangles_.push_back(triangles[i]);
+}
+
+BVHHit TriangleBVH::nearest_hit(Position r, Direction u, bool exiting_only) const
+{
+  BVHHit hit;
+  if (nodes_.size() == 0) return hit;
+
+  double inv[3] {1.0 / u.x, 1.0 / u.y, 1.0 / u.z};
+  double origin[3] {r.x, r.y, r.z};
+
+  int32_t stack[BVH_MAX_DEPTH];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    int32_t i_node = stack[--top];
+    const auto& node {nodes_[i_node]};
+
+    // Skip nodes whose box the ray misses or reaches beyond the nearest hit
+    double t_enter = 0.0;
+    double t_exit = hit.distance;
+    bool missed = false;
+    for (int k = 0; k < 3; ++k) {
+      // Rays parallel to a slab hit it only if they start within it. The
+      // slab distances would be NaN for rays starting on one of its planes.
+      if (u[k] == 0.0) {
+        if (origin[k] < node.lower[k] || origin[k] > node.upper[k]) {
+          missed = true;
+        }
+        continue;
+      }
+      double t1 = (node.lower[k] - origin[k]) * inv[k];
+      double t2 = (node.upper[k] - origin[k]) * inv[k];
+      t_enter = std::fmax(t_enter, std::fmin(t1, t2));
+      t_exit = std::fmin(t_exit, std::fmax(t1, t2));
+    }
+    if (missed || t_enter > t_exit) continue;
+
+    if (node.count > 0) {
+      for (int32_t i = node.offset; i < node.offset + node.count; ++i) {
+        const auto& tri {triangles_[i]};
+        double t = intersect_triangle(r, u, tri, hit.distance);
+        if (t == INFTY) continue;
+        Position e1 = tri.v1 - tri.v0;
+        Position e2 = tri.v2 - tri.v0;
+        Direction n {e1.y*e2.z - e1.z*e2.y, e1.z*e2.x - e1.x*e2.z,
+          e1.x*e2.y - e1.y*e2.x};
+        bool exiting = n.dot(u) > 0.0;
+        if (exiting_only && !exiting) continue;
+        hit = {t, tri.surface, i, exiting};
+      }
+    } else {
+      stack[top++] = node.offset;
+      stack[top++] = i_node + 1;
+    }
+  }
+  return hit;
+}
+
+BVHHit TriangleBVH::ray_fire(Position r, Direction u) const
+{
+  return nearest_hit(r, u, true);
+}
+
+bool TriangleBVH::contains(Position r, Direction u) const
+{
+  BVHHit hit = nearest_hit(r, u, false);
+  return hit.triangle != C_NONE && hit.exiting;
+}
+
+BoundingBox TriangleBVH::bounding_box() const
+{
+  if (nodes_.size() == 0) return {};
+  const auto& root {nodes_[0]};
+  return {root.lower[0], root.upper[0], root.lower[1], root.upper[1],
+    root.lower[2], root.upper[2]};
+}
+
+void TriangleBVH::copy_to_device()
+{
+  nodes_.copy_to_device();
+  triangles_.copy_to_device();
+}
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+double intersect_triangle(Position r, Direction u, const BVHTriangle& tri,
+  double t_max)
+{
+  // Permute the axes so that the direction is largest along z, swapping x
+  // and y when it points to -z to keep the winding of the triangle
+  int kz = 0;
+  if (std::abs(u.y) > std::abs(u[kz])) kz = 1;
+  if (std::abs(u.z) > std::abs(u[kz])) kz = 2;
+  int kx = (kz + 1) % 3;
+  int ky = (kx + 1) % 3;
+  if (u[kz] < 0.0) {
+    int k = kx;
+    kx = ky;
+    ky = k;
+  }
+
+  // Shear the vertices, relative to the ray origin, so that the ray points
+  // along +z
+  double sx = u[kx] / u[kz];
+  double sy = u[ky] / u[kz];
+  double sz = 1.0 / u[kz];
+  Position a = tri.v0 - r;
+  Position b = tri.v1 - r;
+  Position c = tri.v2 - r;
+  double ax = a[kx] - sx * a[kz];
+  double ay = a[ky] - sy * a[kz];
+  double bx = b[kx] - sx * b[kz];
+  double by = b[ky] - sy * b[kz];
+  double cx = c[kx] - sx * c[kz];
+  double cy = c[ky] - sy * c[kz];
+
+  // Scaled barycentric coordinates. Points on an edge give a zero that is
+  // exact, so that the ray hits one of the two triangles sharing it.
+  double e0 = cx * by - cy * bx;
+  double e1 = ax * cy - ay * cx;
+  double e2 = bx * ay - by * ax;
+  if ((e0 < 0.0 || e1 < 0.0 || e2 < 0.0) &&
+      (e0 > 0.0 || e1 > 0.0 || e2 > 0.0)) {
+    return INFTY;
+  }
+  double det = e0 + e1 + e2;
+  if (det == 0.0) return INFTY;
+
+  // Scaled distance, compared against the range before dividing
+  double t = sz * (e0 * a[kz] + e1 * b[kz] + e2 * c[kz]);
+  if (det > 0.0 ? (t < 0.0 || t >= t_max * det) :
+      (t > 0.0 || t <= t_max * det)) {
+    return INFTY;
+  }
+  return t / det;
+}
+
+} // namespace openmc
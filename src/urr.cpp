@@ -1,7 +1,17 @@
 #include "openmc/urr.h"
 
+#include <algorithm> // for copy
+#include <array>
+#include <cmath>
 #include <iostream>
 
+#include "xtensor/xadapt.hpp"
+
+#include "openmc/device_alloc.h"
+#include "openmc/search.h"
+#include "openmc/settings.h"
+#include "openmc/xs_cache.h"
+
 namespace openmc {
 
 UrrData::UrrData(hid_t group_id)
@@ -28,12 +38,94 @@ UrrData::UrrData(hid_t group_id)
   read_dataset(group_id, "table", prob_);
 }
 
+UrrData::UrrData(XsCacheReader& cache)
+{
+  interp_ = cache.read<Interpolation>();
+  inelastic_flag_ = cache.read<int>();
+  absorption_flag_ = cache.read<int>();
+  multiply_smooth_ = cache.read<bool>();
+  n_energy_ = cache.read<int>();
+
+  size_t n;
+  const double* energy = cache.read_array<double>(n);
+  energy_ = xt::adapt(energy, n, xt::no_ownership(),
+    std::array<size_t, 1> {n});
+
+  std::array<size_t, 3> shape;
+  for (auto& s : shape) s = cache.read<uint64_t>();
+  const double* prob = cache.read_array<double>(n);
+  prob_ = xt::adapt(prob, n, xt::no_ownership(), shape);
+}
+
+void UrrData::write_cache(XsCacheWriter& cache) const
+{
+  cache.write(interp_);
+  cache.write(inelastic_flag_);
+  cache.write(absorption_flag_);
+  cache.write(multiply_smooth_);
+  cache.write(n_energy_);
+  cache.write_array(energy_.data(), energy_.size());
+  for (auto s : prob_.shape()) cache.write<uint64_t>(s);
+  cache.write_array(prob_.data(), prob_.size());
+}
+
 void UrrData::flatten_urr_data()
 {
   device_energy_ = energy_.data();
   device_prob_ = prob_.data();
   n_bands_ = prob_.shape(2);
   n_total_prob_ = n_energy_ * 6 * n_bands_;
+
+  if (settings::urr_fast_sampling) {
+    precompute_bands();
+  }
+
+  // Pack the tables used on device into the arena
+  if (settings::device_arena) {
+    auto pack = [](const double* x, size_t n) {
+      double* y = data::device_arena.allocate<double>(n, "Nuclide URR tables");
+      std::copy(x, x + n, y);
+      return y;
+    };
+    device_energy_ = pack(device_energy_, n_energy_);
+    if (n_total_bands_ > 0) {
+      device_bands_ = pack(device_bands_, n_total_bands_ * URR_BAND_FIELDS);
+      device_inv_spacing_ = pack(device_inv_spacing_, n_energy_ - 1);
+    } else {
+      device_prob_ = pack(device_prob_, n_total_prob_);
+    }
+  }
+}
+
+void UrrData::precompute_bands()
+{
+  const URRTableParam params[] {URRTableParam::CUM_PROB,
+    URRTableParam::ELASTIC, URRTableParam::FISSION, URRTableParam::N_GAMMA};
+  bool log_log = (interp_ == Interpolation::log_log);
+
+  n_total_bands_ = n_energy_ * n_bands_;
+  bands_.resize(n_total_bands_ * URR_BAND_FIELDS);
+  for (int i = 0; i < n_energy_; ++i) {
+    for (int b = 0; b < n_bands_; ++b) {
+      double* record = &bands_[(i * n_bands_ + b) * URR_BAND_FIELDS];
+      for (int k = 0; k < URR_BAND_FIELDS; ++k) {
+        double value = prob_(i, static_cast<int>(params[k]), b);
+        if (log_log && k > 0) {
+          value = (value > 0.) ? std::log(value) : URR_LOG_ZERO;
+        }
+        record[k] = value;
+      }
+    }
+  }
+
+  inv_spacing_.resize(n_energy_ - 1);
+  for (int i = 0; i < n_energy_ - 1; ++i) {
+    inv_spacing_[i] = log_log ? 1. / std::log(energy_(i + 1) / energy_(i)) :
+      1. / (energy_(i + 1) - energy_(i));
+  }
+
+  device_bands_ = bands_.data();
+  device_inv_spacing_ = inv_spacing_.data();
 }
 
 double UrrData::prob(int i_energy, URRTableParam i_tableparam, int band) const
@@ -41,4 +133,38 @@ double UrrData::prob(int i_energy, URRTableParam i_tableparam, int band) const
   return device_prob_[i_energy * 6 * n_bands_ + static_cast<int>(i_tableparam) * n_bands_ + band];
 }
 
+void UrrData::sample_bands(double E, double r, double& p_elastic,
+  double& p_fission, double& p_capture) const
+{
+  // Determine the energy table
+  int i_energy = upper_bound_index(device_energy_, device_energy_ + n_energy_, E);
+
+  // Sample the band at both bounding energies. The cumulative probabilities
+  // of the last band are unity, so the searches always terminate.
+  const double* low = &device_bands_[i_energy * n_bands_ * URR_BAND_FIELDS];
+  const double* up = low + n_bands_ * URR_BAND_FIELDS;
+  while (low[0] <= r) low += URR_BAND_FIELDS;
+  while (up[0] <= r) up += URR_BAND_FIELDS;
+
+  if (interp_ == Interpolation::lin_lin) {
+    double f = (E - device_energy_[i_energy]) * device_inv_spacing_[i_energy];
+    p_elastic = (1. - f) * low[1] + f * up[1];
+    p_fission = (1. - f) * low[2] + f * up[2];
+    p_capture = (1. - f) * low[3] + f * up[3];
+  } else if (interp_ == Interpolation::log_log) {
+    double f = std::log(E / device_energy_[i_energy]) *
+      device_inv_spacing_[i_energy];
+    p_elastic = (low[1] > URR_LOG_ZERO && up[1] > URR_LOG_ZERO) ?
+      std::exp((1. - f) * low[1] + f * up[1]) : 0.;
+    p_fission = (low[2] > URR_LOG_ZERO && up[2] > URR_LOG_ZERO) ?
+      std::exp((1. - f) * low[2] + f * up[2]) : 0.;
+    p_capture = (low[3] > URR_LOG_ZERO && up[3] > URR_LOG_ZERO) ?
+      std::exp((1. - f) * low[3] + f * up[3]) : 0.;
+  } else {
+    p_elastic = 0.;
+    p_fission = 0.;
+    p_capture = 0.;
+  }
+}
+
 }
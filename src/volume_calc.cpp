@@ -3,6 +3,7 @@
 #include "openmc/capi.h"
 #include "openmc/cell.h"
 #include "openmc/constants.h"
+#include "openmc/device_alloc.h"
 #include "openmc/error.h"
 #include "openmc/geometry.h"
 #include "openmc/hdf5_interface.h"
@@ -12,6 +13,7 @@
 #include "openmc/output.h"
 #include "openmc/random_lcg.h"
 #include "openmc/settings.h"
+#include "openmc/surface.h"
 #include "openmc/timer.h"
 #include "openmc/xml_interface.h"
 
@@ -22,7 +24,7 @@
 #include "xtensor/xadapt.hpp"
 #include "xtensor/xview.hpp"
 
-#include <algorithm> // for copy
+#include <algorithm> // for copy, find
 #include <cmath> // for pow, sqrt
 #include <unordered_set>
 
@@ -61,6 +63,18 @@ VolumeCalculation::VolumeCalculation(pugi::xml_node node)
   upper_right_ = get_node_array<double>(node, "upper_right");
   n_samples_ = std::stoull(get_node_value(node, "samples"));
 
+  if (check_for_node(node, "estimator")) {
+    std::string estimator = get_node_value(node, "estimator", true, true);
+    if (estimator == "point") {
+      estimator_ = Estimator::POINT;
+    } else if (estimator == "ray") {
+      estimator_ = Estimator::RAY;
+    } else {
+      fatal_error("Unrecognized estimator for stochastic volume calculation: "
+        + estimator);
+    }
+  }
+
   if (check_for_node(node, "threshold")) {
     pugi::xml_node threshold_node = node.child("threshold");
 
@@ -99,9 +113,18 @@ std::vector<VolumeCalculation::Result> VolumeCalculation::execute() const
   // Shared data that is collected from all threads
   int n = domain_ids_.size();
   std::vector<std::vector<int>> master_indices(n); // List of material indices for each domain
-  std::vector<std::vector<int>> master_hits(n); // Number of hits for each material in each domain
+  std::vector<std::vector<int64_t>> master_hits(n); // Number of hits for each material in each domain
   int iterations = 0;
 
+  // Sums of chord length fractions collected by the ray estimator
+  int n_slots = model::materials.size() + 1;
+  std::vector<double> master_sums, master_sums_sq, master_domain_sums_sq;
+  if (estimator_ == Estimator::RAY) {
+    master_sums.assign(n * n_slots, 0.0);
+    master_sums_sq.assign(n * n_slots, 0.0);
+    master_domain_sums_sq.assign(n, 0.0);
+  }
+
   // Divide work over MPI processes
   size_t min_samples = n_samples_ / mpi::n_procs;
   size_t remainder = n_samples_ % mpi::n_procs;
@@ -116,92 +139,121 @@ std::vector<VolumeCalculation::Result> VolumeCalculation::execute() const
 
   while (true) {
 
-    #pragma omp parallel
-    {
-      // Variables that are private to each thread
-      std::vector<std::vector<int>> indices(n);
-      std::vector<std::vector<int>> hits(n);
-      Particle p;
-
-      // Sample locations and count hits
-      #pragma omp for
-      for (size_t i = i_start; i < i_end; i++) {
-        int64_t id = iterations * n_samples_ + i;
-        uint64_t seed = init_seed(id, STREAM_VOLUME);
-
-        p.n_coord_ = 1;
-        Position xi {prn(&seed), prn(&seed), prn(&seed)};
-        p.r() = lower_left_ + xi*(upper_right_ - lower_left_);
-        p.u() = {0.5, 0.5, 0.5};
-
-        // If this location is not in the geometry at all, move on to next block
-        if (!exhaustive_find_cell(p))
-          continue;
-
-        if (domain_type_ == TallyDomain::MATERIAL) {
-          if (p.material_ != MATERIAL_VOID) {
-            for (int i_domain = 0; i_domain < n; i_domain++) {
-              if (model::materials[p.material_].id_ == domain_ids_[i_domain]) {
-                this->check_hit(p.material_, indices[i_domain], hits[i_domain]);
-                break;
+    if (estimator_ == Estimator::RAY) {
+      // Reduce this iteration's sums onto the master process
+      std::vector<double> sums(n * n_slots, 0.0);
+      std::vector<double> sums_sq(n * n_slots, 0.0);
+      std::vector<double> domain_sums_sq(n, 0.0);
+      sample_rays(iterations, i_start, i_end, sums, sums_sq, domain_sums_sq);
+#ifdef OPENMC_MPI
+      void* send = mpi::master ? MPI_IN_PLACE : sums.data();
+      MPI_Reduce(send, sums.data(), sums.size(), MPI_DOUBLE, MPI_SUM, 0,
+        mpi::intracomm);
+      send = mpi::master ? MPI_IN_PLACE : sums_sq.data();
+      MPI_Reduce(send, sums_sq.data(), sums_sq.size(), MPI_DOUBLE, MPI_SUM, 0,
+        mpi::intracomm);
+      send = mpi::master ? MPI_IN_PLACE : domain_sums_sq.data();
+      MPI_Reduce(send, domain_sums_sq.data(), domain_sums_sq.size(),
+        MPI_DOUBLE, MPI_SUM, 0, mpi::intracomm);
+#endif
+      for (int i = 0; i < sums.size(); ++i) {
+        master_sums[i] += sums[i];
+        master_sums_sq[i] += sums_sq[i];
+      }
+      for (int i = 0; i < n; ++i) {
+        master_domain_sums_sq[i] += domain_sums_sq[i];
+      }
+    } else if (settings::device_volume_calc) {
+      sample_on_device(iterations, i_start, i_end, master_indices,
+        master_hits);
+    } else {
+      #pragma omp parallel
+      {
+        // Variables that are private to each thread
+        std::vector<std::vector<int>> indices(n);
+        std::vector<std::vector<int64_t>> hits(n);
+        Particle p;
+
+        // Sample locations and count hits
+        #pragma omp for
+        for (size_t i = i_start; i < i_end; i++) {
+          int64_t id = iterations * n_samples_ + i;
+          uint64_t seed = init_seed(id, STREAM_VOLUME);
+
+          p.n_coord_ = 1;
+          Position xi {prn(&seed), prn(&seed), prn(&seed)};
+          p.r() = lower_left_ + xi*(upper_right_ - lower_left_);
+          p.u() = {0.5, 0.5, 0.5};
+
+          // If this location is not in the geometry at all, move on to next block
+          if (!exhaustive_find_cell(p))
+            continue;
+
+          if (domain_type_ == TallyDomain::MATERIAL) {
+            if (p.material_ != MATERIAL_VOID) {
+              for (int i_domain = 0; i_domain < n; i_domain++) {
+                if (model::materials[p.material_].id_ == domain_ids_[i_domain]) {
+                  this->check_hit(p.material_, indices[i_domain], hits[i_domain]);
+                  break;
+                }
               }
             }
-          }
-        } else if (domain_type_ == TallyDomain::CELL) {
-          for (int level = 0; level < p.n_coord_; ++level) {
-            for (int i_domain=0; i_domain < n; i_domain++) {
-              if (model::cells[p.coord_[level].cell].id_ == domain_ids_[i_domain]) {
-                this->check_hit(p.material_, indices[i_domain], hits[i_domain]);
-                break;
+          } else if (domain_type_ == TallyDomain::CELL) {
+            for (int level = 0; level < p.n_coord_; ++level) {
+              for (int i_domain=0; i_domain < n; i_domain++) {
+                if (model::cells[p.coord_[level].cell].id_ == domain_ids_[i_domain]) {
+                  this->check_hit(p.material_, indices[i_domain], hits[i_domain]);
+                  break;
+                }
               }
             }
-          }
-        } else if (domain_type_ == TallyDomain::UNIVERSE) {
-          for (int level = 0; level < p.n_coord_; ++level) {
-            for (int i_domain = 0; i_domain < n; ++i_domain) {
-              if (model::universes[p.coord_[level].universe].id_ == domain_ids_[i_domain]) {
-                check_hit(p.material_, indices[i_domain], hits[i_domain]);
-                break;
+          } else if (domain_type_ == TallyDomain::UNIVERSE) {
+            for (int level = 0; level < p.n_coord_; ++level) {
+              for (int i_domain = 0; i_domain < n; ++i_domain) {
+                if (model::universes[p.coord_[level].universe].id_ == domain_ids_[i_domain]) {
+                  check_hit(p.material_, indices[i_domain], hits[i_domain]);
+                  break;
+                }
               }
             }
           }
         }
-      }
 
-      // At this point, each thread has its own pair of index/hits lists and we now
-      // need to reduce them. OpenMP is not nearly smart enough to do this on its own,
-      // so we have to manually reduce them
+        // At this point, each thread has its own pair of index/hits lists and we now
+        // need to reduce them. OpenMP is not nearly smart enough to do this on its own,
+        // so we have to manually reduce them
 
   #ifdef _OPENMP
-      int n_threads = omp_get_num_threads();
+        int n_threads = omp_get_num_threads();
   #else
-      int n_threads = 1;
+        int n_threads = 1;
   #endif
 
-      #pragma omp for ordered schedule(static)
-      for (int i = 0; i < n_threads; ++i) {
-        #pragma omp ordered
-        for (int i_domain = 0; i_domain < n; ++i_domain) {
-          for (int j = 0; j < indices[i_domain].size(); ++j) {
-            // Check if this material has been added to the master list and if so,
-            // accumulate the number of hits
-            bool already_added = false;
-            for (int k = 0; k < master_indices[i_domain].size(); k++) {
-              if (indices[i_domain][j] == master_indices[i_domain][k]) {
-                master_hits[i_domain][k] += hits[i_domain][j];
-                already_added = true;
+        #pragma omp for ordered schedule(static)
+        for (int i = 0; i < n_threads; ++i) {
+          #pragma omp ordered
+          for (int i_domain = 0; i_domain < n; ++i_domain) {
+            for (int j = 0; j < indices[i_domain].size(); ++j) {
+              // Check if this material has been added to the master list and if so,
+              // accumulate the number of hits
+              bool already_added = false;
+              for (int k = 0; k < master_indices[i_domain].size(); k++) {
+                if (indices[i_domain][j] == master_indices[i_domain][k]) {
+                  master_hits[i_domain][k] += hits[i_domain][j];
+                  already_added = true;
+                }
+              }
+              if (!already_added) {
+                // If we made it here, the material hasn't yet been added to the master
+                // list, so add entries to the master indices and master hits lists
+                master_indices[i_domain].push_back(indices[i_domain][j]);
+                master_hits[i_domain].push_back(hits[i_domain][j]);
               }
-            }
-            if (!already_added) {
-              // If we made it here, the material hasn't yet been added to the master
-              // list, so add entries to the master indices and master hits lists
-              master_indices[i_domain].push_back(indices[i_domain][j]);
-              master_hits[i_domain].push_back(hits[i_domain][j]);
             }
           }
         }
-      }
-    } // omp parallel
+      } // omp parallel
+    }
 
     // Reduce hits onto master process
 
@@ -234,8 +286,8 @@ std::vector<VolumeCalculation::Result> VolumeCalculation::execute() const
         for (int j = 1; j < mpi::n_procs; j++) {
           int q;
           MPI_Recv(&q, 1, MPI_INTEGER, j, 0, mpi::intracomm, MPI_STATUS_IGNORE);
-          int buffer[2*q];
-          MPI_Recv(&buffer[0], 2*q, MPI_INTEGER, j, 1, mpi::intracomm, MPI_STATUS_IGNORE);
+          std::vector<int64_t> buffer(2*q);
+          MPI_Recv(buffer.data(), 2*q, MPI_INT64_T, j, 1, mpi::intracomm, MPI_STATUS_IGNORE);
           for (int k = 0; k < q; ++k) {
             for (int m = 0; m < master_indices[i_domain].size(); ++m) {
               if (buffer[2*k] == master_indices[i_domain][m]) {
@@ -247,40 +299,69 @@ std::vector<VolumeCalculation::Result> VolumeCalculation::execute() const
         }
       } else {
         int q = master_indices[i_domain].size();
-        int buffer[2*q];
+        std::vector<int64_t> buffer(2*q);
         for (int k = 0; k < q; ++k) {
           buffer[2*k] = master_indices[i_domain][k];
           buffer[2*k + 1] = master_hits[i_domain][k];
         }
 
         MPI_Send(&q, 1, MPI_INTEGER, 0, 0, mpi::intracomm);
-        MPI_Send(&buffer[0], 2*q, MPI_INTEGER, 0, 1, mpi::intracomm);
+        MPI_Send(buffer.data(), 2*q, MPI_INT64_T, 0, 1, mpi::intracomm);
       }
 #endif
 
       if (mpi::master) {
-        int total_hits = 0;
-        for (int j = 0; j < master_indices[i_domain].size(); ++j) {
-          total_hits += master_hits[i_domain][j];
-          double f = static_cast<double>(master_hits[i_domain][j]) / total_samples;
-          double var_f = f*(1.0 - f) / total_samples;
-
-          int i_material = master_indices[i_domain][j];
-          if (i_material == MATERIAL_VOID) continue;
-
-          const auto& mat = model::materials[i_material];
-          for (int k = 0; k < mat.nuclide_.size(); ++k) {
-            // Accumulate nuclide density
-            int i_nuclide = mat.nuclide_[k];
-            atoms(i_nuclide, 0) += mat.atom_density_[k] * f;
-            atoms(i_nuclide, 1) += std::pow(mat.atom_density_[k], 2) * var_f;
+        if (estimator_ == Estimator::RAY) {
+          double f_domain = 0.0;
+          for (int slot = 0; slot < n_slots; ++slot) {
+            int bin = i_domain * n_slots + slot;
+            if (master_sums[bin] == 0.0) continue;
+            double f = master_sums[bin] / total_samples;
+            double var_f = std::max(0.0,
+              master_sums_sq[bin] / total_samples - f*f) / total_samples;
+            f_domain += f;
+
+            int i_material = slot - 1;
+            if (i_material == MATERIAL_VOID) continue;
+
+            const auto& mat = model::materials[i_material];
+            for (int k = 0; k < mat.nuclide_.size(); ++k) {
+              // Accumulate nuclide density
+              int i_nuclide = mat.nuclide_[k];
+              atoms(i_nuclide, 0) += mat.atom_density_[k] * f;
+              atoms(i_nuclide, 1) += std::pow(mat.atom_density_[k], 2) * var_f;
+            }
           }
-        }
 
-        // Determine volume
-        result.volume[0] = static_cast<double>(total_hits) / total_samples * volume_sample;
-        result.volume[1] = std::sqrt(result.volume[0]
-          * (volume_sample - result.volume[0]) / total_samples);
+          // Determine volume
+          double var_domain = std::max(0.0, master_domain_sums_sq[i_domain]
+            / total_samples - f_domain*f_domain) / total_samples;
+          result.volume[0] = f_domain * volume_sample;
+          result.volume[1] = std::sqrt(var_domain) * volume_sample;
+        } else {
+          int64_t total_hits = 0;
+          for (int j = 0; j < master_indices[i_domain].size(); ++j) {
+            total_hits += master_hits[i_domain][j];
+            double f = static_cast<double>(master_hits[i_domain][j]) / total_samples;
+            double var_f = f*(1.0 - f) / total_samples;
+
+            int i_material = master_indices[i_domain][j];
+            if (i_material == MATERIAL_VOID) continue;
+
+            const auto& mat = model::materials[i_material];
+            for (int k = 0; k < mat.nuclide_.size(); ++k) {
+              // Accumulate nuclide density
+              int i_nuclide = mat.nuclide_[k];
+              atoms(i_nuclide, 0) += mat.atom_density_[k] * f;
+              atoms(i_nuclide, 1) += std::pow(mat.atom_density_[k], 2) * var_f;
+            }
+          }
+
+          // Determine volume
+          result.volume[0] = static_cast<double>(total_hits) / total_samples * volume_sample;
+          result.volume[1] = std::sqrt(result.volume[0]
+            * (volume_sample - result.volume[0]) / total_samples);
+        }
         result.iterations = iterations;
 
         // update threshold value if needed
@@ -341,6 +422,292 @@ std::vector<VolumeCalculation::Result> VolumeCalculation::execute() const
   } // end while
 }
 
+void VolumeCalculation::sample_on_device(int iterations, size_t i_start,
+  size_t i_end, std::vector<std::vector<int>>& master_indices,
+  std::vector<std::vector<int64_t>>& master_hits) const
+{
+  int n = domain_ids_.size();
+  std::vector<int> domain_of = domain_indices();
+
+  // Histogram of hits by domain and material. Void is counted in the first
+  // material slot of each domain.
+  int n_slots = model::materials.size() + 1;
+  std::vector<int64_t> hits(n * n_slots, 0);
+
+  int* device_domain_of = domain_of.data();
+  int64_t* device_hits = hits.data();
+  size_t n_domain_of = domain_of.size();
+  size_t n_hits = hits.size();
+  bool by_material = domain_type_ == TallyDomain::MATERIAL;
+  bool by_cell = domain_type_ == TallyDomain::CELL;
+  int64_t n_samples = n_samples_;
+  Position lower_left = lower_left_;
+  Position width = upper_right_ - lower_left_;
+
+  #pragma omp target teams distribute parallel for \
+    map(to: device_domain_of[:n_domain_of]) map(tofrom: device_hits[:n_hits])
+  for (size_t i = i_start; i < i_end; i++) {
+    int64_t id = iterations * n_samples + i;
+    uint64_t seed = init_seed(id, STREAM_VOLUME);
+
+    Particle p;
+    p.n_coord_ = 1;
+    Position xi {prn(&seed), prn(&seed), prn(&seed)};
+    p.r() = lower_left + xi*width;
+    p.u() = {0.5, 0.5, 0.5};
+
+    // If this location is not in the geometry at all, move on to next sample
+    if (!exhaustive_find_cell(p)) continue;
+
+    int slot = p.material_ + 1;
+    if (by_material) {
+      if (p.material_ != MATERIAL_VOID) {
+        int i_domain = device_domain_of[p.material_];
+        if (i_domain != C_NONE) {
+          #pragma omp atomic
+          device_hits[i_domain * n_slots + slot] += 1;
+        }
+      }
+    } else {
+      for (int level = 0; level < p.n_coord_; ++level) {
+        int index = by_cell ? p.coord_[level].cell : p.coord_[level].universe;
+        int i_domain = device_domain_of[index];
+        if (i_domain != C_NONE) {
+          #pragma omp atomic
+          device_hits[i_domain * n_slots + slot] += 1;
+        }
+      }
+    }
+  }
+
+  // Add the histogram to the master lists
+  for (int i_domain = 0; i_domain < n; ++i_domain) {
+    for (int slot = 0; slot < n_slots; ++slot) {
+      int64_t count = hits[i_domain * n_slots + slot];
+      if (count == 0) continue;
+      int i_material = slot - 1;
+      auto& indices = master_indices[i_domain];
+      auto it = std::find(indices.begin(), indices.end(), i_material);
+      if (it != indices.end()) {
+        master_hits[i_domain][it - indices.begin()] += count;
+      } else {
+        indices.push_back(i_material);
+        master_hits[i_domain].push_back(count);
+      }
+    }
+  }
+}
+
+namespace {
+
+//! Distance from a point inside a box to the box's surface along a direction
+double distance_to_box(Position r, Direction u, Position lower_left,
+  Position upper_right)
+{
+  double d = INFTY;
+  for (int i = 0; i < 3; ++i) {
+    if (u[i] > 0.0) {
+      d = std::min(d, (upper_right[i] - r[i]) / u[i]);
+    } else if (u[i] < 0.0) {
+      d = std::min(d, (lower_left[i] - r[i]) / u[i]);
+    }
+  }
+  return std::max(d, 0.0);
+}
+
+//! Follow a ray from r along u for a distance t_max, calling
+//! score(p, length) for every segment of it within the geometry
+//
+//! Where the ray is outside of the geometry it skips to the next crossing of
+//! one of the surfaces bounding the cells of the root universe, and looks for
+//! a cell again just past it.
+template<class F>
+void trace_chord(Particle& p, Position r, Direction u, double t_max,
+  const std::vector<int32_t>& outer_surfaces, F&& score)
+{
+  p.r() = r;
+  p.u() = u;
+  p.n_coord_ = 1;
+  p.surface_ = 0;
+  bool found = exhaustive_find_cell(p);
+  double s = 0.0;
+  while (s < t_max) {
+    if (!found) {
+      double d = INFTY;
+      for (int32_t i_surf : outer_surfaces) {
+        d = std::min(d, model::surfaces[i_surf].distance(p.r(), u, false));
+      }
+      if (d >= t_max - s) return;
+      s += d + TINY_BIT;
+      p.r() = r + s*u;
+      p.n_coord_ = 1;
+      p.surface_ = 0;
+      found = exhaustive_find_cell(p);
+      continue;
+    }
+
+    BoundaryInfo boundary = distance_to_boundary(p);
+    double d = std::min(boundary.distance, t_max - s);
+    score(p, d);
+    s += d;
+    if (s >= t_max) return;
+
+    // Move to the boundary and find the cell on the other side of it
+    for (int j = 0; j < p.n_coord_; ++j) {
+      p.coord_[j].r += d * p.coord_[j].u;
+    }
+    p.surface_ = boundary.surface_index;
+    p.n_coord_ = boundary.coord_level;
+    if (boundary.lattice_translation[0] != 0 ||
+        boundary.lattice_translation[1] != 0 ||
+        boundary.lattice_translation[2] != 0) {
+      cross_lattice(p, boundary);
+      int32_t i_cell = p.coord_[p.n_coord_ - 1].cell;
+      found = i_cell != C_NONE && model::cells[i_cell].type_ == Fill::MATERIAL;
+    } else {
+      found = neighbor_list_find_cell(p);
+      if (!found) {
+        p.surface_ = 0;
+        p.n_coord_ = 1;
+        found = exhaustive_find_cell(p);
+      }
+    }
+  }
+}
+
+} // namespace
+
+std::vector<int> VolumeCalculation::domain_indices() const
+{
+  std::vector<int> domain_of;
+  if (domain_type_ == TallyDomain::MATERIAL) {
+    domain_of.assign(model::materials.size(), C_NONE);
+  } else if (domain_type_ == TallyDomain::CELL) {
+    domain_of.assign(model::cells.size(), C_NONE);
+  } else {
+    domain_of.assign(model::universes.size(), C_NONE);
+  }
+
+  const auto& map = domain_type_ == TallyDomain::MATERIAL ?
+    model::material_map : domain_type_ == TallyDomain::CELL ?
+    model::cell_map : model::universe_map;
+  for (int i_domain = 0; i_domain < domain_ids_.size(); ++i_domain) {
+    auto search = map.find(domain_ids_[i_domain]);
+    if (search != map.end()) domain_of[search->second] = i_domain;
+  }
+  return domain_of;
+}
+
+void VolumeCalculation::sample_rays(int iterations, size_t i_start,
+  size_t i_end, std::vector<double>& sums, std::vector<double>& sums_sq,
+  std::vector<double>& domain_sums_sq) const
+{
+  int n = domain_ids_.size();
+  int n_slots = model::materials.size() + 1;
+  std::vector<int> domain_of = domain_indices();
+
+  // Surfaces bounding the region covered by the geometry
+  std::unordered_set<int32_t> outer;
+  for (int32_t i_cell : model::universes[model::root_universe].cells_) {
+    for (int32_t token : model::cells[i_cell].region_) {
+      if (token < OP_UNION) outer.insert(std::abs(token) - 1);
+    }
+  }
+  std::vector<int32_t> outer_surfaces(outer.begin(), outer.end());
+
+  #pragma omp parallel
+  {
+    // Variables that are private to each thread
+    std::vector<double> t_sums(n * n_slots, 0.0);
+    std::vector<double> t_sums_sq(n * n_slots, 0.0);
+    std::vector<double> t_domain_sums_sq(n, 0.0);
+    std::vector<double> ray(n * n_slots, 0.0); // Length in each bin
+    std::vector<double> ray_domain(n, 0.0);    // Fraction in each domain
+    std::vector<int> touched;                  // Bins with a length
+    Particle p;
+
+    auto score = [&](const Particle& p, double length) {
+      if (length <= 0.0) return;
+      int slot = p.material_ + 1;
+      auto add = [&](int i_domain) {
+        int bin = i_domain * n_slots + slot;
+        if (ray[bin] == 0.0) touched.push_back(bin);
+        ray[bin] += length;
+      };
+      if (domain_type_ == TallyDomain::MATERIAL) {
+        if (p.material_ != MATERIAL_VOID &&
+            domain_of[p.material_] != C_NONE) {
+          add(domain_of[p.material_]);
+        }
+      } else {
+        for (int level = 0; level < p.n_coord_; ++level) {
+          int index = domain_type_ == TallyDomain::CELL ?
+            p.coord_[level].cell : p.coord_[level].universe;
+          if (domain_of[index] != C_NONE) add(domain_of[index]);
+        }
+      }
+    };
+
+    // Trace chords and sum the fraction of their lengths in each bin
+    #pragma omp for
+    for (size_t i = i_start; i < i_end; i++) {
+      int64_t id = iterations * n_samples_ + i;
+      uint64_t seed = init_seed(id, STREAM_VOLUME);
+
+      Position xi {prn(&seed), prn(&seed), prn(&seed)};
+      Position r = lower_left_ + xi*(upper_right_ - lower_left_);
+      double mu = 2.0*prn(&seed) - 1.0;
+      double phi = 2.0*PI*prn(&seed);
+      double sin_theta = std::sqrt(1.0 - mu*mu);
+      Direction u {mu, sin_theta*std::cos(phi), sin_theta*std::sin(phi)};
+
+      double t_forward = distance_to_box(r, u, lower_left_, upper_right_);
+      double t_backward = distance_to_box(r, -u, lower_left_, upper_right_);
+      double chord = t_forward + t_backward;
+      if (chord <= 0.0) continue;
+
+      trace_chord(p, r, u, t_forward, outer_surfaces, score);
+      trace_chord(p, r, -u, t_backward, outer_surfaces, score);
+
+      for (int bin : touched) {
+        double x = ray[bin] / chord;
+        t_sums[bin] += x;
+        t_sums_sq[bin] += x*x;
+        ray_domain[bin / n_slots] += x;
+        ray[bin] = 0.0;
+      }
+      for (int bin : touched) {
+        double& x = ray_domain[bin / n_slots];
+        t_domain_sums_sq[bin / n_slots] += x*x;
+        x = 0.0;
+      }
+      touched.clear();
+    }
+
+    // Reduce the sums of each thread in order so that results are
+    // reproducible
+#ifdef _OPENMP
+    int n_threads = omp_get_num_threads();
+#else
+    int n_threads = 1;
+#endif
+
+    #pragma omp for ordered schedule(static)
+    for (int i = 0; i < n_threads; ++i) {
+      #pragma omp ordered
+      {
+        for (int bin = 0; bin < n * n_slots; ++bin) {
+          sums[bin] += t_sums[bin];
+          sums_sq[bin] += t_sums_sq[bin];
+        }
+        for (int i_domain = 0; i_domain < n; ++i_domain) {
+          domain_sums_sq[i_domain] += t_domain_sums_sq[i_domain];
+        }
+      }
+    }
+  } // omp parallel
+}
+
 void VolumeCalculation::to_hdf5(const std::string& filename,
   const std::vector<Result>& results) const
 {
@@ -362,6 +729,8 @@ void VolumeCalculation::to_hdf5(const std::string& filename,
   write_attribute(file_id, "samples", n_samples_);
   write_attribute(file_id, "lower_left", lower_left_);
   write_attribute(file_id, "upper_right", upper_right_);
+  write_attribute(file_id, "estimator",
+    estimator_ == Estimator::RAY ? "ray" : "point");
   // Write trigger info
   if (trigger_type_ != TriggerMetric::not_active) {
     write_attribute(file_id, "iterations", results[0].iterations);
@@ -427,7 +796,7 @@ void VolumeCalculation::to_hdf5(const std::string& filename,
 }
 
 void VolumeCalculation::check_hit(int i_material, std::vector<int>& indices,
-  std::vector<int>& hits) const
+  std::vector<int64_t>& hits) const
 {
 
   // Check if this material was previously hit and if so, increment count
@@ -468,6 +837,13 @@ int openmc_calculate_volumes() {
   Timer time_volume;
   time_volume.start();
 
+  // Cells are located through the device geometry pointers, which are only
+  // set once the geometry has been moved
+  if (!model::device_cells) {
+    move_settings_to_device();
+    move_geometry_to_device();
+  }
+
   for (int i = 0; i < model::volume_calcs.size(); ++i) {
     write_message(4, "Running volume calculation {}", i+1);
 
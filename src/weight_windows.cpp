@@ -0,0 +1,411 @@
+#include "openmc/weight_windows.h"
+
+#include <algorithm> // for min
+#include <cmath>     // for ceil, sqrt
+
+#include <fmt/core.h>
+
+#include "openmc/error.h"
+#include "openmc/mesh.h"
+#include "openmc/message_passing.h"
+#include "openmc/physics_common.h"
+#include "openmc/search.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+#include "openmc/tallies/filter.h"
+#include "openmc/tallies/tally.h"
+#include "openmc/xml_interface.h"
+
+namespace openmc {
+
+//==============================================================================
+// Global variables
+//==============================================================================
+
+namespace variance_reduction {
+
+std::vector<WeightWindows> weight_windows;
+std::unordered_map<int32_t, int32_t> ww_map;
+std::vector<WeightWindowsGenerator> ww_generators;
+
+WeightWindows* device_weight_windows {nullptr};
+int32_t particle_weight_windows[N_WW_PARTICLE_TYPES] {C_NONE, C_NONE,
+  C_NONE, C_NONE};
+int64_t n_split_daughters {0};
+int64_t split_budget {0};
+
+} // namespace variance_reduction
+
+//==============================================================================
+// WeightWindows implementation
+//==============================================================================
+
+WeightWindows::WeightWindows(pugi::xml_node node)
+{
+  id_ = std::stoi(get_node_value(node, "id"));
+  if (check_for_node(node, "particle")) {
+    particle_ = str_to_particle_type(get_node_value(node, "particle"));
+  }
+  if (!check_for_node(node, "mesh")) {
+    fatal_error(fmt::format("No mesh was given for weight windows {}.", id_));
+  }
+  mesh_id_ = std::stoi(get_node_value(node, "mesh"));
+
+  if (check_for_node(node, "energy_bounds")) {
+    energy_bounds_ = get_node_array_ov<double>(node, "energy_bounds");
+    if (energy_bounds_.size() < 2 ||
+        !std::is_sorted(energy_bounds_.begin(), energy_bounds_.end())) {
+      fatal_error(fmt::format("The energy bounds of weight windows {} must be "
+        "at least two increasing energies.", id_));
+    }
+    n_energy_ = energy_bounds_.size() - 1;
+  }
+
+  // The bounds may be left out when a generator sets them
+  if (check_for_node(node, "lower_ww_bounds")) {
+    lower_ww_ = get_node_array_ov<double>(node, "lower_ww_bounds");
+    if (check_for_node(node, "upper_ww_bounds")) {
+      upper_ww_ = get_node_array_ov<double>(node, "upper_ww_bounds");
+    } else {
+      double ratio = check_for_node(node, "upper_bound_ratio") ?
+        std::stod(get_node_value(node, "upper_bound_ratio")) : 5.0;
+      for (double lower : lower_ww_) upper_ww_.push_back(ratio * lower);
+    }
+    if (upper_ww_.size() != lower_ww_.size()) {
+      fatal_error(fmt::format("Weight windows {} have {} lower and {} upper "
+        "bounds.", id_, lower_ww_.size(), upper_ww_.size()));
+    }
+  }
+
+  if (check_for_node(node, "survival_ratio")) {
+    survival_ratio_ = std::stod(get_node_value(node, "survival_ratio"));
+  }
+  if (check_for_node(node, "max_split")) {
+    max_split_ = std::stoi(get_node_value(node, "max_split"));
+  }
+  if (check_for_node(node, "weight_cutoff")) {
+    weight_cutoff_ = std::stod(get_node_value(node, "weight_cutoff"));
+  }
+  if (survival_ratio_ < 1.0 || max_split_ < 1) {
+    fatal_error(fmt::format("Weight windows {} need a survival ratio of at "
+      "least 1 and a maximum split of at least 1.", id_));
+  }
+}
+
+void WeightWindows::init()
+{
+  auto it = model::mesh_map.find(mesh_id_);
+  if (it == model::mesh_map.end()) {
+    fatal_error(fmt::format("Mesh {} of weight windows {} does not exist.",
+      mesh_id_, id_));
+  }
+  mesh_ = it->second;
+  n_mesh_bins_ = model::meshes[mesh_].n_bins();
+
+  size_t n = static_cast<size_t>(n_mesh_bins_) * n_energy_;
+  if (lower_ww_.empty()) {
+    lower_ww_.resize(n, -1.0);
+    upper_ww_.resize(n, -1.0);
+  } else if (lower_ww_.size() != n) {
+    fatal_error(fmt::format("Weight windows {} have {} bounds, but their mesh "
+      "and energy groups have {} bins.", id_, lower_ww_.size(), n));
+  }
+}
+
+int WeightWindows::bin(const Particle& p) const
+{
+  int mesh_bin = model::meshes[mesh_].get_bin(p.r());
+  if (mesh_bin < 0) return C_NONE;
+
+  int e_bin = 0;
+  if (n_energy_ > 1) {
+    if (p.E_ < energy_bounds_[0] || p.E_ > energy_bounds_[n_energy_]) {
+      return C_NONE;
+    }
+    e_bin = std::min(lower_bound_index(energy_bounds_.begin(),
+      energy_bounds_.end(), p.E_), n_energy_ - 1);
+  }
+  return e_bin * n_mesh_bins_ + mesh_bin;
+}
+
+bool WeightWindows::matches(const Tally& tally) const
+{
+  bool has_mesh = false;
+  bool has_energy = false;
+  for (int i = 0; i < tally.n_filters(); ++i) {
+    const auto& filt {model::tally_filters[tally.filters(i)]};
+    if (filt.get_type() == Filter::FilterType::MeshFilter &&
+        filt.mesh() == mesh_) {
+      has_mesh = true;
+    } else if (filt.get_type() == Filter::FilterType::EnergyFilter &&
+        n_energy_ > 1 && filt.bins().size() == energy_bounds_.size() &&
+        std::equal(filt.bins().begin(), filt.bins().end(),
+          energy_bounds_.begin())) {
+      has_energy = true;
+    } else {
+      return false;
+    }
+  }
+  if (!has_mesh || has_energy != (n_energy_ > 1)) return false;
+  return std::find(tally.scores_.begin(), tally.scores_.end(), SCORE_FLUX) !=
+    tally.scores_.end();
+}
+
+void WeightWindows::update_magic(const Tally& tally, double threshold,
+  double ratio)
+{
+  int n = tally.n_realizations_;
+  if (n == 0) return;
+
+  int stride_mesh = 0;
+  int stride_energy = 0;
+  for (int i = 0; i < tally.n_filters(); ++i) {
+    const auto& filt {model::tally_filters[tally.filters(i)]};
+    if (filt.get_type() == Filter::FilterType::MeshFilter) {
+      stride_mesh = tally.strides(i);
+    } else {
+      stride_energy = tally.strides(i);
+    }
+  }
+  int score = std::find(tally.scores_.begin(), tally.scores_.end(),
+    SCORE_FLUX) - tally.scores_.begin();
+
+  for (int e = 0; e < n_energy_; ++e) {
+    double max_flux = 0.0;
+    for (int m = 0; m < n_mesh_bins_; ++m) {
+      int i_filter = m * stride_mesh + e * stride_energy;
+      max_flux = std::max(max_flux,
+        *tally.results(i_filter, score, TallyResult::SUM) / n);
+    }
+
+    for (int m = 0; m < n_mesh_bins_; ++m) {
+      int i_filter = m * stride_mesh + e * stride_energy;
+      double mean = *tally.results(i_filter, score, TallyResult::SUM) / n;
+      double mean_sq = *tally.results(i_filter, score, TallyResult::SUM_SQ) / n;
+
+      // Bins whose flux is unknown or too uncertain get no window
+      double rel_err = INFTY;
+      if (n > 1 && mean > 0.0) {
+        rel_err = std::sqrt(std::max(0.0, mean_sq - mean*mean) / (n - 1)) /
+          mean;
+      }
+      int i = e * n_mesh_bins_ + m;
+      if (rel_err > threshold) {
+        lower_ww_[i] = -1.0;
+        upper_ww_[i] = -1.0;
+      } else {
+        lower_ww_[i] = 0.5 * mean / max_flux;
+        upper_ww_[i] = ratio * lower_ww_[i];
+      }
+    }
+  }
+}
+
+void WeightWindows::copy_to_device()
+{
+  energy_bounds_.copy_to_device();
+  lower_ww_.copy_to_device();
+  upper_ww_.copy_to_device();
+}
+
+void WeightWindows::release_device()
+{
+  energy_bounds_.release_device();
+  lower_ww_.release_device();
+  upper_ww_.release_device();
+}
+
+void WeightWindows::update_bounds_to_device()
+{
+  lower_ww_.update_to_device();
+  upper_ww_.update_to_device();
+}
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+void read_weight_windows(pugi::xml_node root)
+{
+  using namespace variance_reduction;
+
+  for (auto node : root.children("weight_windows")) {
+    weight_windows.emplace_back(node);
+    int32_t id = weight_windows.back().id_;
+    if (ww_map.find(id) != ww_map.end()) {
+      fatal_error(fmt::format("Two or more weight windows use the same unique "
+        "ID: {}", id));
+    }
+    ww_map[id] = weight_windows.size() - 1;
+  }
+
+  for (auto node : root.children("weight_window_generator")) {
+    WeightWindowsGenerator gen;
+    int32_t id = std::stoi(get_node_value(node, "weight_windows"));
+    auto it = ww_map.find(id);
+    if (it == ww_map.end()) {
+      fatal_error(fmt::format("Weight windows {} of a weight window generator "
+        "do not exist.", id));
+    }
+    gen.weight_windows_ = it->second;
+    gen.tally_id_ = std::stoi(get_node_value(node, "tally"));
+    if (check_for_node(node, "threshold")) {
+      gen.threshold_ = std::stod(get_node_value(node, "threshold"));
+    }
+    if (check_for_node(node, "ratio")) {
+      gen.ratio_ = std::stod(get_node_value(node, "ratio"));
+    }
+    if (check_for_node(node, "interval")) {
+      gen.interval_ = std::stoi(get_node_value(node, "interval"));
+    }
+    if (gen.ratio_ <= 1.0 || gen.interval_ < 1) {
+      fatal_error(fmt::format("The generator of weight windows {} needs a "
+        "ratio above 1 and an interval of at least 1 batch.", id));
+    }
+    ww_generators.push_back(gen);
+  }
+
+  settings::weight_windows_on = !weight_windows.empty();
+}
+
+void init_weight_windows()
+{
+  using namespace variance_reduction;
+
+  for (int i = 0; i < N_WW_PARTICLE_TYPES; ++i) {
+    particle_weight_windows[i] = C_NONE;
+  }
+  for (int i = 0; i < weight_windows.size(); ++i) {
+    auto& ww {weight_windows[i]};
+    ww.init();
+    int type = static_cast<int>(ww.particle_);
+    if (particle_weight_windows[type] != C_NONE) {
+      fatal_error(fmt::format("More than one set of weight windows is given "
+        "for {}s.", particle_type_to_str(ww.particle_)));
+    }
+    particle_weight_windows[type] = i;
+  }
+
+  for (auto& gen : ww_generators) {
+    const auto& ww {weight_windows[gen.weight_windows_]};
+    auto it = model::tally_map.find(gen.tally_id_);
+    if (it == model::tally_map.end()) {
+      fatal_error(fmt::format("Tally {} of the generator of weight windows {} "
+        "does not exist.", gen.tally_id_, ww.id_));
+    }
+    gen.tally_ = it->second;
+    if (!ww.matches(model::tallies[gen.tally_])) {
+      fatal_error(fmt::format("Tally {} cannot generate weight windows {}: it "
+        "must score flux with only a mesh filter on mesh {} and, if the "
+        "windows have energy groups, an energy filter with the same bounds.",
+        gen.tally_id_, ww.id_, ww.mesh_id_));
+    }
+  }
+}
+
+void apply_weight_windows(Particle& p)
+{
+  int32_t i_ww =
+    variance_reduction::particle_weight_windows[static_cast<int>(p.type_)];
+  if (i_ww == C_NONE) return;
+  const auto& ww {variance_reduction::device_weight_windows[i_ww]};
+
+  int i = ww.bin(p);
+  if (i == C_NONE) return;
+  double lower = ww.lower_ww_[i];
+  if (lower < 0.0) return;
+
+  if (p.wgt_ < ww.weight_cutoff_) {
+    p.wgt_ = 0.0;
+    return;
+  }
+
+  double upper = ww.upper_ww_[i];
+  if (p.wgt_ > upper) {
+    // Split into particles of equal weight, banking all but this one
+    int n_split = std::min(static_cast<int>(std::ceil(p.wgt_ / upper)),
+      ww.max_split_);
+
+    // Take the daughters from what is left of this generation's budget.
+    // Daughters reserved past the end of the budget are not returned to it.
+    int64_t n_used;
+    #pragma omp atomic capture
+    {
+      n_used = variance_reduction::n_split_daughters;
+      variance_reduction::n_split_daughters += n_split - 1;
+    }
+    int64_t n_left = variance_reduction::split_budget - n_used;
+    if (n_left <= 0) return;
+    if (n_left < n_split - 1) n_split = n_left + 1;
+
+    Particle::Bank site;
+    site.particle = p.type_;
+    site.wgt = p.wgt_ / n_split;
+    site.r = p.r();
+    site.u = p.u();
+    site.E = settings::run_CE ? p.E_ : p.g_;
+    site.time = p.time_;
+    site.parent_id = p.id_;
+    site.progeny_id = p.n_progeny_;
+    // A daughter the full secondary pool can't take stays with this particle
+    int n_banked = 0;
+    while (n_banked < n_split - 1 && p.push_secondary(site)) ++n_banked;
+    p.wgt_ -= n_banked * site.wgt;
+  } else if (p.wgt_ < lower) {
+    // Roulette to the survival weight, or to no more than max_split_ times
+    // the current weight so that a survivor is not split back right away
+    russian_roulette(p, std::min(p.wgt_ * ww.max_split_,
+      lower * ww.survival_ratio_));
+  }
+}
+
+void update_weight_windows()
+{
+  using namespace variance_reduction;
+
+  if (ww_generators.empty()) return;
+  if (simulation::current_batch <= settings::n_inactive) return;
+  int n_active = simulation::current_batch - settings::n_inactive;
+
+#ifdef OPENMC_MPI
+  // The flux tallies must be fully reduced onto master
+  complete_tally_reductions();
+#endif
+
+  for (const auto& gen : ww_generators) {
+    if (n_active % gen.interval_ != 0) continue;
+    auto& ww {weight_windows[gen.weight_windows_]};
+    if (mpi::master) {
+      auto& tally {model::tallies[gen.tally_]};
+      tally.sync_results_to_host();
+      ww.update_magic(tally, gen.threshold_, gen.ratio_);
+    }
+#ifdef OPENMC_MPI
+    MPI_Bcast(ww.lower_ww_.data(), ww.lower_ww_.size(), MPI_DOUBLE, 0,
+      mpi::intracomm);
+    MPI_Bcast(ww.upper_ww_.data(), ww.upper_ww_.size(), MPI_DOUBLE, 0,
+      mpi::intracomm);
+#endif
+    ww.update_bounds_to_device();
+  }
+}
+
+void reset_split_budget()
+{
+  variance_reduction::n_split_daughters = 0;
+  variance_reduction::split_budget = static_cast<int64_t>(
+    settings::max_split_growth * simulation::work_per_rank);
+  #pragma omp target update to(variance_reduction::n_split_daughters)
+  #pragma omp target update to(variance_reduction::split_budget)
+}
+
+void free_memory_weight_windows()
+{
+  variance_reduction::weight_windows.clear();
+  variance_reduction::ww_map.clear();
+  variance_reduction::ww_generators.clear();
+  variance_reduction::device_weight_windows = nullptr;
+  settings::weight_windows_on = false;
+}
+
+} // namespace openmc
@@ -5,6 +5,7 @@
 #include "openmc/hdf5_interface.h"
 #include "openmc/math_functions.h"
 #include "openmc/nuclide.h"
+#include "openmc/settings.h"
 #include "openmc/error.h"  // for writing messages
 
 #include <fmt/core.h>
@@ -14,6 +15,20 @@
 
 namespace openmc {
 
+//========================================================================
+// Global variables
+//========================================================================
+
+namespace data {
+
+vector<int> wmp_nuclides;
+vector<int> wmp_slot;
+int* device_wmp_nuclides {nullptr};
+int* device_wmp_slot {nullptr};
+int n_wmp_nuclides {0};
+
+} // namespace data
+
 const int WindowedMultipole::MAX_POLY_COEFFICIENTS = 11;
 
 //========================================================================
@@ -147,13 +162,39 @@ WindowedMultipole::evaluate(double E, double sqrtkT) const
   } else {
     // At temperature, use Faddeeva function-based form.
     double dopp = sqrt_awr_ / sqrtkT;
-    for (int i_pole = window.index_start; i_pole <= window.index_end; ++i_pole) {
-      std::complex<double> z = (sqrtE - data(i_pole, MP_EA)) * dopp;
-      std::complex<double> w_val = faddeeva(z) * dopp * invE * SQRT_PI;
-      sig_s += (data(i_pole, MP_RS) * w_val).real();
-      sig_a += (data(i_pole, MP_RA) * w_val).real();
-      if (fissionable_) {
-        sig_f += (data(i_pole, MP_RF) * w_val).real();
+    if (settings::faddeeva_method == FaddeevaMethod::scalar) {
+      for (int i_pole = window.index_start; i_pole <= window.index_end; ++i_pole) {
+        std::complex<double> z = (sqrtE - data(i_pole, MP_EA)) * dopp;
+        std::complex<double> w_val = faddeeva(z) * dopp * invE * SQRT_PI;
+        sig_s += (data(i_pole, MP_RS) * w_val).real();
+        sig_a += (data(i_pole, MP_RA) * w_val).real();
+        if (fissionable_) {
+          sig_f += (data(i_pole, MP_RF) * w_val).real();
+        }
+      }
+    } else {
+      // Evaluate the Faddeeva function for a chunk of poles at a time so that
+      // the evaluations vectorize
+      double z_re[WMP_POLE_CHUNK], z_im[WMP_POLE_CHUNK];
+      double w_re[WMP_POLE_CHUNK], w_im[WMP_POLE_CHUNK];
+      for (int start = window.index_start; start <= window.index_end;
+           start += WMP_POLE_CHUNK) {
+        int n = std::min(WMP_POLE_CHUNK, window.index_end - start + 1);
+        for (int j = 0; j < n; ++j) {
+          std::complex<double> z = (sqrtE - data(start + j, MP_EA)) * dopp;
+          z_re[j] = z.real();
+          z_im[j] = z.imag();
+        }
+        faddeeva_batch(n, z_re, z_im, w_re, w_im, settings::faddeeva_method);
+        for (int j = 0; j < n; ++j) {
+          std::complex<double> w_val = std::complex<double>(w_re[j], w_im[j]) *
+            dopp * invE * SQRT_PI;
+          sig_s += (data(start + j, MP_RS) * w_val).real();
+          sig_a += (data(start + j, MP_RA) * w_val).real();
+          if (fissionable_) {
+            sig_f += (data(start + j, MP_RF) * w_val).real();
+          }
+        }
       }
     }
   }
@@ -172,13 +213,14 @@ WindowedMultipole::evaluate_deriv(double E, double sqrtkT) const
   double invE = 1.0 / E;
   double T = sqrtkT*sqrtkT / K_BOLTZMANN;
 
-  if (sqrtkT == 0.0) {
-    fatal_error("Windowed multipole temperature derivatives are not implemented"
-      " for 0 Kelvin cross sections.");
-  }
+  // Windowed multipole temperature derivatives are not implemented for 0
+  // Kelvin cross sections, which are rejected before transport (see
+  // enforce_assumptions())
+  if (sqrtkT == 0.0) return std::make_tuple(0.0, 0.0, 0.0);
 
   // Locate us
-  int i_window = (sqrtE - std::sqrt(E_min_)) * inv_spacing_;
+  int i_window = std::min(window_info_.size() - 1,
+    static_cast<size_t>((sqrtE - std::sqrt(E_min_)) * inv_spacing_));
   const auto& window {window_info_[i_window]};
 
   // Initialize the ouptut cross sections.
@@ -196,7 +238,7 @@ WindowedMultipole::evaluate_deriv(double E, double sqrtkT) const
 
   double dopp = sqrt_awr_ / sqrtkT;
   for (int i_pole = window.index_start; i_pole <= window.index_end; ++i_pole) {
-    std::complex<double> z = (sqrtE - data_(i_pole, MP_EA)) * dopp;
+    std::complex<double> z = (sqrtE - data(i_pole, MP_EA)) * dopp;
     std::complex<double> w_val = -invE * SQRT_PI * 0.5 * w_derivative(z, 2);
     sig_s += (data(i_pole, MP_RS) * w_val).real();
     sig_a += (data(i_pole, MP_RA) * w_val).real();
@@ -299,6 +341,36 @@ void read_multipole_data(int i_nuclide)
   file_close(file);
 }
 
+void init_wmp_slots()
+{
+  data::wmp_nuclides.clear();
+  data::wmp_slot.resize(data::nuclides_size);
+  for (int i = 0; i < data::nuclides_size; ++i) {
+    if (data::nuclides[i].multipole_) {
+      data::wmp_slot[i] = data::wmp_nuclides.size();
+      data::wmp_nuclides.push_back(i);
+    } else {
+      data::wmp_slot[i] = C_NONE;
+    }
+  }
+  data::n_wmp_nuclides = data::wmp_nuclides.size();
+
+  data::device_wmp_nuclides = data::wmp_nuclides.data();
+  data::device_wmp_slot = data::wmp_slot.data();
+  #pragma omp target update to(data::n_wmp_nuclides)
+  #pragma omp target enter data map(to: data::device_wmp_nuclides[:data::n_wmp_nuclides])
+  #pragma omp target enter data map(to: data::device_wmp_slot[:data::nuclides_size])
+}
+
+void free_wmp_slots()
+{
+  #pragma omp target exit data map(delete: data::device_wmp_nuclides[:data::n_wmp_nuclides])
+  #pragma omp target exit data map(delete: data::device_wmp_slot[:data::nuclides_size])
+  data::wmp_nuclides.clear();
+  data::wmp_slot.clear();
+  data::n_wmp_nuclides = 0;
+}
+
 void broaden_wmp_polynomials(double E, double dopp, int n, double factors[])
 {
   // Broadening of polynomials follows procedure outlined in C. Josey, P. Ducru,
@@ -0,0 +1,211 @@
+//! \file xs_benchmark.cpp
+//! \brief Macroscopic cross section lookups alone, at random materials and
+//! energies, with the lookup kernels and options of a real run
+
+#include <algorithm> // for min, max
+#include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <fmt/core.h>
+
+#include "openmc/capi.h"
+#include "openmc/constants.h"
+#include "openmc/error.h"
+#include "openmc/event.h"
+#include "openmc/material.h"
+#include "openmc/message_passing.h"
+#include "openmc/microbenchmark.h"
+#include "openmc/nuclide.h"
+#include "openmc/output.h"
+#include "openmc/particle.h"
+#include "openmc/random_lcg.h"
+#include "openmc/settings.h"
+#include "openmc/simulation.h"
+#include "openmc/timer.h"
+
+namespace openmc {
+
+namespace {
+
+#pragma omp declare target
+//! Put a neutron at a random site and at an energy drawn log-uniformly
+//! between the limits of the neutron data
+void sample_lookup(Particle& p, int64_t id, const int* material,
+  const int* cell, const double* sqrtkT, int n_sites, double log_E_min,
+  double log_E_max)
+{
+  sample_benchmark_site(p, id, material, cell, sqrtkT, n_sites);
+  p.E_ = std::exp(log_E_min + prn(p.current_seed()) * (log_E_max - log_E_min));
+  p.stream_ = STREAM_TRACKING;
+}
+#pragma omp end declare target
+
+//! Make n_lookups lookups through the XS lookup queues of event-based
+//! transport, one particle buffer at a time
+//
+//! \return Time taken by the lookup events, including queue ordering, in [s]
+double event_lookups(int64_t n_lookups, const BenchmarkSites& sites,
+  double log_E_min, double log_E_max)
+{
+  const int* material = sites.material.data();
+  const int* cell = sites.cell.data();
+  const double* sqrtkT = sites.sqrtkT.data();
+  int n_sites = sites.size();
+  int64_t n_buffer = simulation::particles.size();
+  bool aggregate = settings::aggregate_queue_appends;
+  int64_t offset = static_cast<int64_t>(mpi::rank) * n_lookups;
+
+  Timer timer;
+  for (int64_t first = 0; first < n_lookups; first += n_buffer) {
+    int n = std::min(n_buffer, n_lookups - first);
+    #pragma omp target teams distribute parallel for \
+      map(to: material[:n_sites], cell[:n_sites], sqrtkT[:n_sites])
+    for (int i = 0; i < n; ++i) {
+      Particle& p = simulation::device_particles[i];
+      sample_lookup(p, offset + first + i + 1, material, cell, sqrtkT,
+        n_sites, log_E_min, log_E_max);
+      EventType type = model::materials[p.material_].fissionable_ ?
+        EventType::calculate_xs_fuel : EventType::calculate_xs_nonfuel;
+      dispatch_particle(i, i, static_cast<int>(type), aggregate);
+    }
+    if (aggregate) enqueue_aggregated(n);
+    sync_queue_sizes();
+
+    timer.start();
+    if (settings::async_event_kernels) {
+      process_calculate_xs_events_concurrent();
+    } else {
+      process_calculate_xs_events_fuel();
+      process_calculate_xs_events_nonfuel();
+    }
+    timer.stop();
+
+    // The lookups move every particle to the advance queue, which is emptied
+    EventType advance = EventType::advance;
+    sync_queue_sizes(&advance);
+  }
+  return timer.elapsed();
+}
+
+//! Make n_lookups lookups on host threads, each with its own particle
+//
+//! \return Time taken in [s]
+double host_lookups(int64_t n_lookups, const BenchmarkSites& sites,
+  double log_E_min, double log_E_max)
+{
+  const int* material = sites.material.data();
+  const int* cell = sites.cell.data();
+  const double* sqrtkT = sites.sqrtkT.data();
+  int n_sites = sites.size();
+  bool need_depletion_rx = depletion_rx_check();
+  int64_t offset = static_cast<int64_t>(mpi::rank) * n_lookups;
+
+  Timer timer;
+  timer.start();
+  #pragma omp parallel
+  {
+    Particle p;
+    p.neutron_xs_.assign(omp_get_thread_num());
+    p.assign_flux_derivs(omp_get_thread_num());
+    p.assign_nuclide_cdf(omp_get_thread_num());
+    p.assign_depletion_rx(omp_get_thread_num());
+    p.assign_photon_xs(omp_get_thread_num());
+    p.assign_nu_bank(omp_get_thread_num());
+    #pragma omp for schedule(static)
+    for (int64_t i = 0; i < n_lookups; ++i) {
+      sample_lookup(p, offset + i + 1, material, cell, sqrtkT, n_sites,
+        log_E_min, log_E_max);
+      p.event_calculate_xs_execute(need_depletion_rx);
+    }
+  }
+  timer.stop();
+  return timer.elapsed();
+}
+
+} // namespace
+
+} // namespace openmc
+
+//==============================================================================
+// C API
+//==============================================================================
+
+int openmc_xs_benchmark()
+{
+  using namespace openmc;
+
+  if (!settings::run_CE) {
+    set_errmsg("The XS lookup benchmark requires continuous-energy data.");
+    return OPENMC_E_INVALID_ARGUMENT;
+  }
+
+  int err = openmc_simulation_init();
+  if (err) return err;
+
+  BenchmarkSites sites = find_benchmark_sites();
+  if (sites.size() == 0) {
+    set_errmsg("The model has no material cells to look up XS in.");
+    return OPENMC_E_GEOMETRY;
+  }
+
+  int neutron = static_cast<int>(Particle::Type::neutron);
+  double log_E_min = std::log(data::energy_min[neutron]);
+  double log_E_max = std::log(data::energy_max[neutron]);
+  int64_t n_lookups = settings::xs_benchmark_lookups;
+
+  double sort_start = simulation::time_event_sort.elapsed();
+  double seconds = settings::event_based ?
+    event_lookups(n_lookups, sites, log_E_min, log_E_max) :
+    host_lookups(n_lookups, sites, log_E_min, log_E_max);
+  double sort_seconds = simulation::time_event_sort.elapsed() - sort_start;
+
+  // Every process makes the same number of lookups, so the rate of the run is
+  // set by the slowest
+#ifdef OPENMC_MPI
+  MPI_Allreduce(MPI_IN_PLACE, &seconds, 1, MPI_DOUBLE, MPI_MAX,
+    mpi::intracomm);
+  MPI_Allreduce(MPI_IN_PLACE, &sort_seconds, 1, MPI_DOUBLE, MPI_MAX,
+    mpi::intracomm);
+#endif
+  int64_t n_total = n_lookups * mpi::n_procs;
+
+  if (mpi::master) {
+    header("XS LOOKUP BENCHMARK", 1);
+    const char* where = settings::event_based ?
+      (was_device_used() ? "event-based on device" : "event-based on host") :
+      "history-based on host";
+    fmt::print(" Lookups                           = {}\n", n_total);
+    fmt::print(" Material and temperature sites    = {}\n", sites.size());
+    fmt::print(" Nuclides per lookup (mean)        = {:.1f}\n",
+      sites.mean_nuclides);
+    fmt::print(" Lookup kernels                    = {}\n", where);
+    if (settings::event_based) {
+      fmt::print(" Queue ordering                    = {}\n",
+        settings::bucket_xs_queues ? "buckets" :
+        settings::sort_fissionable_xs_lookups ||
+        settings::sort_non_fissionable_xs_lookups ? "sorted" : "none");
+    }
+    #ifdef NO_MICRO_XS_CACHE
+    fmt::print(" Micro XS cache                    = off\n");
+    #else
+    fmt::print(" Micro XS cache                    = on\n");
+    #endif
+    #ifdef SINGLE_PRECISION_XS
+    fmt::print(" XS precision                      = single\n");
+    #else
+    fmt::print(" XS precision                      = double\n");
+    #endif
+    show_time("Lookup time", seconds);
+    if (settings::event_based) show_time("Queue ordering", sort_seconds, 1);
+    double rate = seconds > 0.0 ? n_total / seconds : 0.0;
+    fmt::print(" Lookup rate                       = {:.6} lookups/second\n",
+      rate);
+    fmt::print(" Nuclide lookup rate               = {:.6} lookups/second\n",
+      rate * sites.mean_nuclides);
+  }
+
+  return openmc_simulation_finalize();
+}
@@ -0,0 +1,210 @@
+#include "openmc/xs_cache.h"
+
+#include <cstdio> // for rename, remove
+#include <new>    // for placement new
+
+#include <fcntl.h>    // for open
+#include <sys/mman.h> // for mmap, munmap, madvise
+#include <sys/stat.h> // for stat, fstat
+#include <unistd.h>   // for close
+
+#include <fmt/core.h>
+
+#include "openmc/constants.h"
+#include "openmc/cross_sections.h"
+#include "openmc/distribution_energy.h"
+#include "openmc/error.h"
+#include "openmc/message_passing.h"
+#include "openmc/nuclide.h"
+#include "openmc/secondary_tables.h"
+#include "openmc/settings.h"
+
+namespace openmc {
+
+//==============================================================================
+// XsCacheWriter implementation
+//==============================================================================
+
+XsCacheWriter::XsCacheWriter(const std::string& filename)
+  : filename_ {filename},
+    temp_ {fmt::format("{}.{}.tmp", filename, mpi::rank)},
+    stream_ {temp_, std::ios::binary | std::ios::trunc}
+{ }
+
+void XsCacheWriter::write_bytes(const void* data, size_t n)
+{
+  stream_.write(static_cast<const char*>(data), n);
+}
+
+bool XsCacheWriter::close()
+{
+  stream_.close();
+  if (stream_.fail() || std::rename(temp_.c_str(), filename_.c_str()) != 0) {
+    std::remove(temp_.c_str());
+    return false;
+  }
+  return true;
+}
+
+//==============================================================================
+// XsCacheReader implementation
+//==============================================================================
+
+bool XsCacheReader::open(const std::string& filename)
+{
+  filename_ = filename;
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  size_ = info.st_size;
+
+  // A shared mapping lets every process on a node read the same pages
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) return false;
+  madvise(data, size_, MADV_SEQUENTIAL);
+  data_ = static_cast<const char*>(data);
+  return true;
+}
+
+XsCacheReader::~XsCacheReader()
+{
+  if (data_) munmap(const_cast<char*>(data_), size_);
+}
+
+const char* XsCacheReader::take(size_t n)
+{
+  if (n > size_ - offset_) {
+    fatal_error(fmt::format("Cross section cache {} is truncated.", filename_));
+  }
+  const char* p = data_ + offset_;
+  offset_ += n;
+  return p;
+}
+
+//==============================================================================
+// Non-member functions
+//==============================================================================
+
+namespace {
+
+// Identifies cache files
+constexpr char XS_CACHE_MAGIC[] {"OPENMCXS"};
+
+//! 64-bit FNV-1a hash
+uint64_t fnv1a(const std::string& s)
+{
+  uint64_t h = 14695981039346656037ull;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+} // namespace
+
+std::string xs_cache_filename(const std::vector<int>& nuclides,
+  const std::vector<std::string>& names,
+  const std::vector<std::vector<double>>& temps, std::string& key)
+{
+  // Settings that change what is read from the libraries. Those that only
+  // change quantities the nuclides derive from it, which are derived again
+  // after reading a cache, are left out.
+  key = fmt::format("version {} method {} tolerance {} range {} {} "
+    "pretabulate {} tms {} decoded {}\n", XS_CACHE_VERSION,
+    static_cast<int>(settings::temperature_method),
+    settings::temperature_tolerance, settings::temperature_range[0],
+    settings::temperature_range[1], settings::pretabulate_temperatures,
+    settings::temperature_tms, settings::decoded_distributions);
+  if (settings::prune_nuclear_data) {
+    key += fmt::format("prune photon {} res_scat {}", settings::photon_transport,
+      settings::res_scat_on);
+    for (const auto& name : settings::res_scat_nuclides) key += " " + name;
+    key += '\n';
+  }
+
+  for (int i_nuc : nuclides) {
+    const auto& name = names[i_nuc];
+    LibraryKey lib_key {Library::Type::neutron, name};
+    auto it = data::library_map.find(lib_key);
+    if (it == data::library_map.end()) return {};
+    const auto& path = data::libraries[it->second].path_;
+
+    // A library that was modified or replaced changes the key
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return {};
+    key += fmt::format("{} {} {} {}", name, path,
+      static_cast<int64_t>(info.st_size), static_cast<int64_t>(info.st_mtime));
+    for (double T : temps[i_nuc]) key += fmt::format(" {}", T);
+    key += '\n';
+  }
+
+  std::string dir = settings::path_xs_cache;
+  if (!dir.empty() && dir.back() != '/') dir += '/';
+  return fmt::format("{}xs_{:016x}.bin", dir, fnv1a(key));
+}
+
+bool read_xs_cache(const std::string& filename, const std::string& key,
+  int n_nuclides)
+{
+  XsCacheReader cache;
+  if (!cache.open(filename)) return false;
+
+  // Ignore files of another layout or, however unlikely, another key with the
+  // same hash
+  std::string magic = cache.read_string();
+  if (magic != XS_CACHE_MAGIC || cache.read<int>() != XS_CACHE_VERSION) {
+    return false;
+  }
+  if (cache.read_string() != key) return false;
+  if (cache.read<int>() != n_nuclides) return false;
+
+  write_message(5, "Reading cross sections from {}", filename);
+
+  // Global state the nuclides leave behind when read from HDF5
+  data::temperature_min = cache.read<double>();
+  data::temperature_max = cache.read<double>();
+  settings::temperature_method =
+    static_cast<TemperatureMethod>(cache.read<int>());
+  data::ct_tables.read_cache(cache);
+  data::ae_tables.read_cache(cache);
+
+  for (int i = 0; i < n_nuclides; ++i) {
+    new(data::nuclides + i) Nuclide(cache, i);
+  }
+  data::nuclides_size = n_nuclides;
+  return true;
+}
+
+void write_xs_cache(const std::string& filename, const std::string& key)
+{
+  XsCacheWriter cache {filename};
+  cache.write(std::string {XS_CACHE_MAGIC});
+  cache.write<int>(XS_CACHE_VERSION);
+  cache.write(key);
+  cache.write<int>(data::nuclides_size);
+
+  cache.write<double>(data::temperature_min);
+  cache.write<double>(data::temperature_max);
+  cache.write<int>(static_cast<int>(settings::temperature_method));
+  data::ct_tables.write_cache(cache);
+  data::ae_tables.write_cache(cache);
+
+  for (int i = 0; i < data::nuclides_size; ++i) {
+    data::nuclides[i].write_cache(cache);
+  }
+
+  if (cache.close()) {
+    write_message(5, "Wrote cross section cache {}", filename);
+  } else {
+    warning(fmt::format("Could not write cross section cache {}.", filename));
+  }
+}
+
+} // namespace openmc
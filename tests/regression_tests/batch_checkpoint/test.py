@@ -0,0 +1,95 @@
+import os
+import subprocess
+
+import numpy as np
+import openmc
+
+from tests.regression_tests import config
+
+
+def create_library():
+    groups = openmc.mgxs.EnergyGroups(group_edges=[0.0, 0.625, 20.0e6])
+    library = openmc.MGXSLibrary(groups)
+    fuel = openmc.XSdata('fuel', groups)
+    fuel.order = 0
+    fuel.set_nu_fission(np.multiply([2.5, 2.5], [0.002817, 0.097]))
+    fuel.set_absorption([0.011525, 0.12218])
+    fuel.set_scatter_matrix(np.array(
+        [[[0.31980], [0.004555]], [[0.00000], [0.424100]]]))
+    fuel.set_total([0.33588, 0.54628])
+    fuel.set_chi([1., 0.])
+    library.add_xsdata(fuel)
+    library.export_to_hdf5('2g.h5')
+
+
+def make_model():
+    model = openmc.model.Model()
+
+    fuel = openmc.Material(material_id=1)
+    fuel.set_density('macro', 1.0)
+    fuel.add_macroscopic('fuel')
+    model.materials.append(fuel)
+    model.materials.cross_sections = os.path.abspath('2g.h5')
+
+    cube = openmc.model.rectangular_prism(20.0, 20.0, boundary_type='vacuum')
+    z0 = openmc.ZPlane(z0=-10.0, boundary_type='vacuum')
+    z1 = openmc.ZPlane(z0=10.0, boundary_type='vacuum')
+    model.geometry = openmc.Geometry(
+        [openmc.Cell(fill=fuel, region=cube & +z0 & -z1)])
+
+    model.settings.energy_mode = 'multi-group'
+    model.settings.event_based = True
+    model.settings.batches = 4
+    model.settings.inactive = 1
+    model.settings.particles = 1000
+    model.settings.source = openmc.Source(space=openmc.stats.Box(
+        [-10., -10., -10.], [10., 10., 10.]))
+
+    mesh = openmc.RegularMesh(mesh_id=1)
+    mesh.lower_left = (-10., -10., -10.)
+    mesh.upper_right = (10., 10., 10.)
+    mesh.dimension = (4, 4, 1)
+    tally = openmc.Tally(tally_id=1)
+    tally.filters = [openmc.MeshFilter(mesh)]
+    tally.scores = ['flux', 'fission']
+    model.tallies.append(tally)
+    return model
+
+
+def run(subdir, *args, check=True):
+    cmd = [config['exe'], '--checkpoint-particles', '300', *args]
+    if config['mpi']:
+        cmd = [config['mpiexec'], '-n', config['mpi_np']] + cmd
+    p = subprocess.run(cmd, cwd=subdir, stdout=subprocess.PIPE,
+                       stderr=subprocess.STDOUT, universal_newlines=True)
+    if check and p.returncode != 0:
+        raise RuntimeError(p.stdout)
+    return p.returncode
+
+
+def results(subdir):
+    with openmc.StatePoint(os.path.join(subdir, 'statepoint.4.h5')) as sp:
+        return sp.k_generation, sp.get_tally(id=1).mean.ravel()
+
+
+def test_batch_checkpoint(run_in_tmpdir):
+    create_library()
+    model = make_model()
+    for subdir in ('uninterrupted', 'restarted'):
+        os.makedirs(subdir)
+        model.export_to_xml(subdir)
+    run('uninterrupted')
+
+    # Stop in the middle of the second batch, after 600 of its particles, and
+    # resume it from the checkpoint of the batch in progress
+    assert run('restarted', '--checkpoint-stop', '2', check=False) != 0
+    assert os.path.exists(os.path.join('restarted', 'checkpoint.h5.batch.0'))
+    assert not os.path.exists(os.path.join('restarted', 'statepoint.4.h5'))
+    run('restarted', '-r', 'checkpoint.h5')
+
+    # Each history has its own random number seed, so the resumed batch ends
+    # as the uninterrupted one does, up to the order of the tally sums
+    k_ref, mean_ref = results('uninterrupted')
+    k, mean = results('restarted')
+    assert np.allclose(k, k_ref, rtol=1.e-10, atol=0.0)
+    assert np.allclose(mean, mean_ref, rtol=1.e-10, atol=0.0)
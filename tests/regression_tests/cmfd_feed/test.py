@@ -1,6 +1,8 @@
 from tests.testing_harness import CMFDTestHarness
+import openmc
 from openmc import cmfd
 import numpy as np
+import pytest
 import scipy.sparse
 
 
@@ -189,3 +191,44 @@ def test_cmfd_multithread():
     # Initialize and run CMFD test harness
     harness = CMFDTestHarness('statepoint.20.h5', cmfd_run)
     harness.main()
+
+
+def run_cmfd_feed(**kwargs):
+    """Run the 1 group CMFD feedback problem with the given CMFDRun
+    attributes, returning the CMFD eigenvalues and the combined k"""
+    cmfd_mesh = cmfd.CMFDMesh()
+    cmfd_mesh.lower_left = (-10.0, -1.0, -1.0)
+    cmfd_mesh.upper_right = (10.0, 1.0, 1.0)
+    cmfd_mesh.dimension = (10, 1, 1)
+    cmfd_mesh.albedo = (0.0, 0.0, 1.0, 1.0, 1.0, 1.0)
+
+    cmfd_run = cmfd.CMFDRun()
+    cmfd_run.mesh = cmfd_mesh
+    cmfd_run.tally_begin = 5
+    cmfd_run.solver_begin = 5
+    cmfd_run.feedback = True
+    cmfd_run.gauss_seidel_tolerance = [1.e-15, 1.e-20]
+    for key, value in kwargs.items():
+        setattr(cmfd_run, key, value)
+    cmfd_run.run()
+
+    with openmc.StatePoint('statepoint.20.h5') as sp:
+        k = sp.k_combined
+    return np.array(cmfd_run.k_cmfd), cmfd_run._phi, k
+
+
+@pytest.mark.parametrize('on_device', [False, True])
+def test_cmfd_feed_bicgstab(on_device):
+    """Test the BiCGSTAB linear solver against Gauss-Seidel, on host and on
+    device. Each CMFD solve starts from the flux of the last one, which from
+    the second batch on nearly solves the system already."""
+    k_gs, phi_gs, keff_gs = run_cmfd_feed()
+    # The relative residual of BiCGSTAB cannot reach the inner tolerance of
+    # Gauss-Seidel, which bounds the change of the flux instead
+    k_bi, phi_bi, keff_bi = run_cmfd_feed(
+        linear_solver='bicgstab', linear_solver_on_device=on_device,
+        gauss_seidel_tolerance=[1.e-15, 1.e-12])
+
+    assert np.allclose(k_bi, k_gs, rtol=1.e-8)
+    assert np.allclose(phi_bi, phi_gs, rtol=1.e-6)
+    assert keff_bi.n == pytest.approx(keff_gs.n, rel=1.e-8)
@@ -0,0 +1,98 @@
+import os
+
+import numpy as np
+import openmc
+import pytest
+
+from tests.regression_tests import config
+
+
+pytestmark = pytest.mark.skipif(
+    not config['mpi'], reason='Domain decomposition needs MPI')
+
+
+def create_library():
+    groups = openmc.mgxs.EnergyGroups(group_edges=[0.0, 20.0e6])
+    library = openmc.MGXSLibrary(groups)
+    slab = openmc.XSdata('slab', groups)
+    slab.order = 0
+    slab.set_total([1.0])
+    slab.set_absorption([0.2])
+    slab.set_scatter_matrix(np.array([[[0.8]]]))
+    library.add_xsdata(slab)
+    library.export_to_hdf5('1g.h5')
+
+
+def make_model(decomposed):
+    model = openmc.model.Model()
+
+    slab = openmc.Material(material_id=1)
+    slab.set_density('macro', 1.0)
+    slab.add_macroscopic('slab')
+    model.materials.append(slab)
+    model.materials.cross_sections = os.path.abspath('1g.h5')
+
+    # Two halves of a slab, so that particles cross between the domains
+    x0 = openmc.XPlane(x0=-10.0, boundary_type='vacuum')
+    x1 = openmc.XPlane(x0=0.0)
+    x2 = openmc.XPlane(x0=10.0, boundary_type='vacuum')
+    y0 = openmc.YPlane(y0=-1.0, boundary_type='reflective')
+    y1 = openmc.YPlane(y0=1.0, boundary_type='reflective')
+    z0 = openmc.ZPlane(z0=-1.0, boundary_type='reflective')
+    z1 = openmc.ZPlane(z0=1.0, boundary_type='reflective')
+    box = +y0 & -y1 & +z0 & -z1
+    model.geometry = openmc.Geometry([
+        openmc.Cell(cell_id=1, fill=slab, region=+x0 & -x1 & box),
+        openmc.Cell(cell_id=2, fill=slab, region=+x1 & -x2 & box)
+    ])
+
+    model.settings.energy_mode = 'multi-group'
+    model.settings.run_mode = 'fixed source'
+    model.settings.event_based = True
+    model.settings.batches = 5
+    model.settings.particles = 2000
+    model.settings.source = openmc.Source(space=openmc.stats.Box(
+        [-10., -1., -1.], [-5., 1., 1.]), energy=openmc.stats.Discrete(
+        [1.0e6], [1.0]))
+
+    mesh = openmc.RegularMesh(mesh_id=1)
+    mesh.lower_left = (-10.0, -1.0, -1.0)
+    mesh.upper_right = (10.0, 1.0, 1.0)
+    mesh.dimension = (2, 1, 1)
+    if decomposed:
+        model.settings.domain_mesh = mesh
+
+    flux_mesh = openmc.RegularMesh(mesh_id=2)
+    flux_mesh.lower_left = (-10.0, -1.0, -1.0)
+    flux_mesh.upper_right = (10.0, 1.0, 1.0)
+    flux_mesh.dimension = (20, 1, 1)
+    tally = openmc.Tally(tally_id=1)
+    tally.filters = [openmc.MeshFilter(flux_mesh)]
+    tally.scores = ['flux', 'absorption']
+    model.tallies.append(tally)
+    tally = openmc.Tally(tally_id=2)
+    tally.filters = [openmc.CellFilter([1, 2])]
+    tally.scores = ['total']
+    tally.estimator = 'collision'
+    model.tallies.append(tally)
+    return model
+
+
+def run(model, subdir):
+    os.makedirs(subdir, exist_ok=True)
+    model.export_to_xml(subdir)
+    openmc.run(openmc_exec=config['exe'], cwd=subdir,
+               mpi_args=[config['mpiexec'], '-n', '2'])
+    with openmc.StatePoint(os.path.join(subdir, 'statepoint.5.h5')) as sp:
+        return [sp.get_tally(id=i).mean.ravel() for i in (1, 2)]
+
+
+def test_domain_decomposition(run_in_tmpdir):
+    create_library()
+    reference = run(make_model(False), 'undecomposed')
+    results = run(make_model(True), 'decomposed')
+
+    # A particle handed over to another domain continues its history with its
+    # own random number seeds, so only the order of the sums differs
+    for mean, mean_ref in zip(results, reference):
+        assert np.allclose(mean, mean_ref, rtol=1.e-10, atol=0.0)
@@ -0,0 +1,62 @@
+import os
+import subprocess
+
+import h5py
+import numpy as np
+import openmc
+from openmc.examples import pwr_pin_cell
+
+from tests.regression_tests import config
+
+
+def run(subdir, *args):
+    os.makedirs(subdir)
+    model = pwr_pin_cell()
+    model.settings.batches = 3
+    model.settings.inactive = 1
+    model.settings.particles = 1000
+    # Fewer particles in flight than per batch, so that revivals are traced
+    model.settings.max_particles_in_flight = 400
+    model.export_to_xml(subdir)
+    cmd = [config['exe'], '-e', *args]
+    if config['mpi']:
+        cmd = [config['mpiexec'], '-n', config['mpi_np']] + cmd
+    subprocess.run(cmd, cwd=subdir, check=True)
+    with openmc.StatePoint(os.path.join(subdir, 'statepoint.3.h5')) as sp:
+        return sp.k_generation
+
+
+def read_trace(subdir):
+    name = 'event_trace_0.h5' if config['mpi'] else 'event_trace.h5'
+    with h5py.File(os.path.join(subdir, name), 'r') as f:
+        assert f.attrs['filetype'].decode() == 'event trace'
+        return f.attrs['stride'], f['launches'][()], f['events'][()]
+
+
+def test_event_trace(run_in_tmpdir):
+    k_ref = run('untraced')
+    k_all = run('all', '--event-trace', '1')
+    k_some = run('sampled', '--event-trace', '7')
+
+    # Tracing does not change the histories, though the launches it times may
+    # be scheduled in another order
+    assert np.allclose(k_all, k_ref, rtol=1.e-10, atol=0.0)
+    assert np.allclose(k_some, k_ref, rtol=1.e-10, atol=0.0)
+
+    # With every particle sampled, each launch records one event per item of
+    # the queue it processes, so no record is dropped
+    stride, launches, events = read_trace('all')
+    assert stride == 1
+    queue_lengths = launches[np.arange(len(launches)), 3 + launches[:, 2]]
+    counts = np.bincount(events[:, 0], minlength=len(launches))
+    assert np.array_equal(counts, queue_lengths)
+    assert np.array_equal(events[:, 2], launches[events[:, 0], 2])
+
+    # Otherwise only the particles whose ID is a multiple of the stride are
+    stride, launches, events = read_trace('sampled')
+    assert stride == 7
+    assert len(events) > 0
+    assert np.all(events[:, 1] % 7 == 0)
+    counts = np.bincount(events[:, 0], minlength=len(launches))
+    queue_lengths = launches[np.arange(len(launches)), 3 + launches[:, 2]]
+    assert np.all(counts <= queue_lengths)
@@ -0,0 +1,54 @@
+import os
+
+import numpy as np
+import openmc
+from openmc.examples import pwr_assembly
+
+from tests.regression_tests import config
+
+
+def make_model():
+    model = pwr_assembly()
+    model.settings.batches = 5
+    model.settings.inactive = 2
+    model.settings.particles = 1000
+
+    fuel = next(c for c in model.geometry.get_all_cells().values()
+                if c.name == 'fuel')
+    tally = openmc.Tally(tally_id=1)
+    tally.filters = [openmc.DistribcellFilter(fuel)]
+    tally.scores = ['flux', 'fission']
+    model.tallies.append(tally)
+    tally = openmc.Tally(tally_id=2)
+    tally.filters = [openmc.MaterialFilter(model.materials)]
+    tally.scores = ['absorption']
+    tally.nuclides = ['U235', 'total']
+    model.tallies.append(tally)
+    return model
+
+
+def run(model, subdir, binary):
+    model.export_to_xml(subdir, binary=binary)
+    kwargs = {'openmc_exec': config['exe'], 'cwd': subdir,
+              'event_based': config['event']}
+    if config['mpi']:
+        kwargs['mpi_args'] = [config['mpiexec'], '-n', config['mpi_np']]
+    openmc.run(**kwargs)
+    with openmc.StatePoint(os.path.join(subdir, 'statepoint.5.h5')) as sp:
+        return (sp.k_generation, sp.get_tally(id=1).mean.ravel(),
+                sp.get_tally(id=2).mean.ravel())
+
+
+def test_model_binary(run_in_tmpdir):
+    model = make_model()
+    reference = run(model, 'xml', False)
+    results = run(model, 'binary', True)
+
+    assert not os.path.exists(os.path.join('binary', 'materials.xml'))
+    assert not os.path.exists(os.path.join('binary', 'geometry.xml'))
+    assert os.path.exists(os.path.join('binary', 'materials.h5'))
+    assert os.path.exists(os.path.join('binary', 'geometry.h5'))
+
+    # The same model read from either input transports the same histories
+    for value, value_ref in zip(results, reference):
+        assert np.allclose(value, value_ref, rtol=1.e-12, atol=0.0)
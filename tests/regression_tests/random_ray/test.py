@@ -0,0 +1,113 @@
+import os
+
+import h5py
+import numpy as np
+import openmc
+import pytest
+
+from tests.regression_tests import config
+
+
+def create_library():
+    groups = openmc.mgxs.EnergyGroups(group_edges=[0.0, 0.625, 20.0e6])
+    library = openmc.MGXSLibrary(groups)
+
+    # Isotropic data, since the random ray solver only treats isotropic
+    # scattering
+    fuel = openmc.XSdata('fuel', groups)
+    fuel.order = 0
+    nu = [2.50, 2.50]
+    fiss = np.array([0.002817, 0.097])
+    capture = [0.008708, 0.02518]
+    fuel.set_nu_fission(np.multiply(nu, fiss))
+    fuel.set_absorption(np.add(capture, fiss))
+    fuel.set_scatter_matrix(np.array(
+        [[[0.31980], [0.004555]], [[0.00000], [0.424100]]]))
+    fuel.set_total([0.33588, 0.54628])
+    fuel.set_chi([1., 0.])
+    library.add_xsdata(fuel)
+
+    water = openmc.XSdata('water', groups)
+    water.order = 0
+    water.set_absorption([0.0005, 0.0200])
+    water.set_scatter_matrix(np.array(
+        [[[0.5900], [0.0500]], [[0.0000], [1.3000]]]))
+    water.set_total([0.6405, 1.3200])
+    library.add_xsdata(water)
+
+    library.export_to_hdf5('2g.h5')
+
+
+def make_model():
+    model = openmc.model.Model()
+
+    fuel = openmc.Material(material_id=1)
+    fuel.set_density('macro', 1.0)
+    fuel.add_macroscopic('fuel')
+    water = openmc.Material(material_id=2)
+    water.set_density('macro', 1.0)
+    water.add_macroscopic('water')
+    model.materials += [fuel, water]
+    model.materials.cross_sections = os.path.abspath('2g.h5')
+
+    # Pincell in a reflective box, with the fuel and the water split into rings
+    # so that the flat sources resolve the flux
+    radii = [0.2, 0.3, 0.4, 0.5, 0.6]
+    cylinders = [openmc.ZCylinder(r=r) for r in radii]
+    box = openmc.model.rectangular_prism(1.26, 1.26, boundary_type='reflective')
+    cells = [openmc.Cell(fill=fuel, region=-cylinders[0])]
+    for inner, outer in zip(cylinders[:2], cylinders[1:3]):
+        cells.append(openmc.Cell(fill=fuel, region=+inner & -outer))
+    for inner, outer in zip(cylinders[2:4], cylinders[3:]):
+        cells.append(openmc.Cell(fill=water, region=+inner & -outer))
+    cells.append(openmc.Cell(fill=water, region=+cylinders[-1] & box))
+    model.geometry = openmc.Geometry(cells)
+
+    model.settings.energy_mode = 'multi-group'
+    model.settings.batches = 60
+    model.settings.inactive = 20
+    model.settings.particles = 2000
+    model.settings.source = openmc.Source(space=openmc.stats.Box(
+        [-0.63, -0.63, -1.], [0.63, 0.63, 1.]))
+    return model
+
+
+def run(model, subdir, filename):
+    os.makedirs(subdir, exist_ok=True)
+    model.export_to_xml(subdir)
+    kwargs = {'openmc_exec': config['exe'], 'cwd': subdir,
+              'event_based': config['event']}
+    if config['mpi']:
+        kwargs['mpi_args'] = [config['mpiexec'], '-n', config['mpi_np']]
+    openmc.run(**kwargs)
+    return os.path.join(subdir, filename)
+
+
+def test_random_ray(run_in_tmpdir):
+    create_library()
+
+    # Reference eigenvalue from multigroup Monte Carlo
+    model = make_model()
+    path = run(model, 'monte_carlo', 'statepoint.60.h5')
+    with openmc.StatePoint(path) as sp:
+        k_mc = sp.k_combined
+
+    model.settings.random_ray = {'distance_active': 100.0,
+                                 'distance_inactive': 20.0}
+    path = run(model, 'random_ray', 'random_ray.h5')
+    with h5py.File(path, 'r') as f:
+        k_rr, std_rr = f['k_combined'][()]
+        volumes = f['volumes'][()]
+        flux = f['flux'][()]
+
+    # The flat source approximation on these rings is good to well within a
+    # percent of the eigenvalue
+    assert abs(k_rr - k_mc.n) < 0.01*k_mc.n + 4*np.hypot(std_rr, k_mc.s)
+    assert volumes.sum() == pytest.approx(1.0)
+    assert np.all(flux > 0.0)
+
+    # Flat source regions are numbered by the material cell offsets, which the
+    # solver cannot do without
+    model.settings.material_cell_offsets = False
+    with pytest.raises(RuntimeError):
+        run(model, 'no_offsets', 'random_ray.h5')
@@ -0,0 +1,86 @@
+import os
+import subprocess
+
+import numpy as np
+import openmc
+from openmc.examples import pwr_assembly
+import pytest
+
+from tests.regression_tests import config
+
+
+def run(fmt):
+    os.makedirs(fmt)
+    model = pwr_assembly()
+    model.settings.batches = 1
+    model.settings.inactive = 0
+    model.settings.particles = 100
+    model.export_to_xml(fmt)
+    cmd = [config['exe'], '--summary-format', fmt]
+    if config['mpi']:
+        cmd = [config['mpiexec'], '-n', config['mpi_np']] + cmd
+    subprocess.run(cmd, cwd=fmt, check=True)
+    return openmc.Summary(os.path.join(fmt, 'summary.h5'))
+
+
+def fill_id(cell):
+    return None if cell.fill is None else cell.fill.id
+
+
+def describe_geometry(summary):
+    """Cells, universes and lattices of a summary, by ID"""
+    geometry = summary.geometry
+    cells = {
+        cell.id: (cell.name, cell.fill_type, fill_id(cell), str(cell.region))
+        for cell in geometry.get_all_cells().values()
+    }
+    universes = {
+        u.id: sorted(u.cells) for u in geometry.get_all_universes().values()
+    }
+    lattices = {
+        lat.id: (tuple(lat.pitch), tuple(lat.lower_left),
+                 [[u.id for u in row] for row in lat.universes])
+        for lat in geometry.get_all_lattices().values()
+    }
+    return cells, universes, lattices
+
+
+def describe_materials(summary):
+    """Nuclides, atom densities, S(a,b) tables and temperatures of the
+    materials of a summary, by ID"""
+    return {
+        mat.id: (mat.name, mat.get_nuclide_atom_densities(),
+                 sorted(name for name, _ in mat._sab), mat.temperature)
+        for mat in summary.materials
+    }
+
+
+def test_summary_format(run_in_tmpdir):
+    full = run('full')
+    compact = run('compact')
+    hashed = run('hash')
+
+    assert full.format == 'full'
+    assert compact.format == 'compact'
+    assert hashed.format == 'hash'
+    assert hashed.model_hash
+
+    # The compact layout holds all that the full layout does
+    assert describe_geometry(compact) == describe_geometry(full)
+    materials_full = describe_materials(full)
+    materials_compact = describe_materials(compact)
+    assert materials_compact.keys() == materials_full.keys()
+    for uid, (name, densities, sab, temperature) in materials_full.items():
+        name_c, densities_c, sab_c, temperature_c = materials_compact[uid]
+        assert (name_c, sab_c, temperature_c) == (name, sab, temperature)
+        assert densities_c.keys() == densities.keys()
+        for nuc, (_, density) in densities.items():
+            assert densities_c[nuc][1] == pytest.approx(density, rel=1e-12)
+
+    # The hash layout rebuilds the model from its input files, which give the
+    # same geometry and the same nuclides in each material
+    assert describe_geometry(hashed) == describe_geometry(full)
+    materials_hash = {m.id: (m.name, sorted(m.get_nuclides()))
+                      for m in hashed.materials}
+    assert materials_hash == {m.id: (m.name, sorted(m.get_nuclides()))
+                              for m in full.materials}
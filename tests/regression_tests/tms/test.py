@@ -0,0 +1,95 @@
+import os
+
+import h5py
+import numpy as np
+import openmc
+import pytest
+
+from tests.regression_tests import config
+
+
+def library_temperatures(nuclide):
+    """Temperatures in K the cross section library has data for"""
+    lib = openmc.data.DataLibrary.from_xml()
+    path = lib.get_by_material(nuclide)['path']
+    with h5py.File(path, 'r') as f:
+        return {int(name.rstrip('K')) for name in f[nuclide]['kTs']}
+
+
+def make_model(tms):
+    model = openmc.model.Model()
+
+    # The same fuel is seen cold and hot, so that target motion sampling
+    # broadens the 294 K data of U238 to 900 K in the hot pin
+    cold = openmc.Material(material_id=1, temperature=294)
+    hot = openmc.Material(material_id=2, temperature=900)
+    for fuel in (cold, hot):
+        fuel.set_density('g/cc', 10.0)
+        fuel.add_nuclide('U235', 0.04)
+        fuel.add_nuclide('U238', 0.96)
+        fuel.add_nuclide('O16', 2.0)
+    water = openmc.Material(material_id=3, temperature=294)
+    water.set_density('g/cc', 1.0)
+    water.add_nuclide('H1', 2.0)
+    water.add_nuclide('O16', 1.0)
+    model.materials += [cold, hot, water]
+
+    x0 = openmc.XPlane(x0=-1.26, boundary_type='reflective')
+    x1 = openmc.XPlane(x0=0.0)
+    x2 = openmc.XPlane(x0=1.26, boundary_type='reflective')
+    y0 = openmc.YPlane(y0=-0.63, boundary_type='reflective')
+    y1 = openmc.YPlane(y0=0.63, boundary_type='reflective')
+    r_cold = openmc.ZCylinder(x0=-0.63, r=0.4)
+    r_hot = openmc.ZCylinder(x0=0.63, r=0.4)
+    box = +y0 & -y1
+    cells = [
+        openmc.Cell(fill=cold, region=-r_cold),
+        openmc.Cell(fill=hot, region=-r_hot),
+        openmc.Cell(fill=water, region=+x0 & -x1 & box & +r_cold),
+        openmc.Cell(fill=water, region=+x1 & -x2 & box & +r_hot)
+    ]
+    model.geometry = openmc.Geometry(cells)
+
+    model.settings.batches = 20
+    model.settings.inactive = 5
+    model.settings.particles = 5000
+    model.settings.source = openmc.Source(space=openmc.stats.Box(
+        [-1., -0.5, -1.], [1., 0.5, 1.]))
+    model.settings.temperature = {'method': 'nearest', 'tms': tms}
+
+    # Absorption in the 6.67 eV resonance of U238 in the hot pin
+    tally = openmc.Tally(tally_id=1)
+    tally.filters = [openmc.MaterialFilter([hot]),
+                     openmc.EnergyFilter([6.0, 7.5])]
+    tally.nuclides = ['U238']
+    tally.scores = ['absorption']
+    tally.estimator = 'analog'
+    model.tallies.append(tally)
+    return model
+
+
+def run(model, subdir):
+    os.makedirs(subdir, exist_ok=True)
+    model.export_to_xml(subdir)
+    kwargs = {'openmc_exec': config['exe'], 'cwd': subdir,
+              'event_based': config['event']}
+    if config['mpi']:
+        kwargs['mpi_args'] = [config['mpiexec'], '-n', config['mpi_np']]
+    openmc.run(**kwargs)
+    path = os.path.join(subdir, 'statepoint.20.h5')
+    with openmc.StatePoint(path) as sp:
+        t = sp.get_tally(id=1)
+        return sp.k_combined, t.mean.flat[0], t.std_dev.flat[0]
+
+
+def test_tms(run_in_tmpdir):
+    if not {294, 900} <= library_temperatures('U238'):
+        pytest.skip('Cross sections of U238 at 294 K and 900 K are needed')
+
+    # Reference run with the library data at 900 K
+    k_ref, rate_ref, std_ref = run(make_model(False), 'reference')
+    k_tms, rate_tms, std_tms = run(make_model(True), 'tms')
+
+    # The broadened resonance absorbs as the data at 900 K do
+    assert abs(rate_tms - rate_ref) < 4*np.hypot(std_tms, std_ref)
+    assert abs(k_tms.n - k_ref.n) < 4*np.hypot(k_tms.s, k_ref.s)
@@ -1,8 +1,8 @@
 import glob
 import os
 from subprocess import call
-import shutil
 
+import h5py
 import pytest
 
 from tests.testing_harness import TestHarness
@@ -10,23 +10,37 @@ from tests.testing_harness import TestHarness
 
 class TrackTestHarness(TestHarness):
     def _test_output_created(self):
-        """Make sure statepoint.* and track* have been created."""
+        """Make sure statepoint.* and tracks.h5 have been created."""
         TestHarness._test_output_created(self)
-
-        outputs = glob.glob('track_1_1_*.h5')
-        assert len(outputs) == 2, 'Expected two track files.'
+        assert os.path.isfile('tracks.h5'), 'tracks.h5 file not found.'
 
     def _get_results(self):
-        """Digest info in the statepoint and return as a string."""
+        """Digest info in the track file and return as a string."""
+        # Tracks of all particles are written to one file, with a row of the
+        # index per track pointing at its rows of coordinates
+        with h5py.File('tracks.h5', 'r') as f:
+            filetype = f.attrs['filetype'].decode()
+            version = '.'.join(str(v) for v in f.attrs['version'])
+            coords = f['coordinates'][()]
+            index = f['tracks'][()]
+        outstr = 'filetype: {}\nversion: {}\n'.format(filetype, version)
+        n_rows = 0
+        for batch, gen, particle, track, offset, n_coords in index:
+            assert offset == n_rows, 'Track rows are not contiguous.'
+            assert n_coords >= 2, 'Track has fewer than two points.'
+            n_rows += n_coords
+            outstr += '{} {} {} {}\n'.format(batch, gen, particle, track)
+        assert n_rows == len(coords), 'Track index does not cover coordinates.'
+
         # Run the track-to-vtk conversion script.
-        call(['../../../scripts/openmc-track-to-vtk', '-o', 'poly'] +
-             glob.glob('track_1_1_*.h5'))
+        call(['../../../scripts/openmc-track-to-vtk', '-o', 'poly',
+              'tracks.h5'])
 
         # Make sure the vtk file was created then return it's contents.
         assert os.path.isfile('poly.pvtp'), 'poly.pvtp file not found.'
 
         with open('poly.pvtp', 'r') as fin:
-            outstr = fin.read()
+            outstr += fin.read()
 
         return outstr
 
@@ -0,0 +1,120 @@
+//! Checks ray queries of a TriangleBVH over the surface of the unit cube
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "openmc/constants.h"
+#include "openmc/position.h"
+#include "openmc/triangle_bvh.h"
+
+using namespace openmc;
+
+namespace {
+
+int n_failed {0};
+
+void check(bool passed, const char* what)
+{
+  if (!passed) {
+    std::printf("FAILED: %s\n", what);
+    ++n_failed;
+  }
+}
+
+bool close(double a, double b) { return std::abs(a - b) < 1e-12; }
+
+//! Triangles of the unit cube, two per face wound counterclockwise seen from
+//! outside, with the index of the face as their surface
+std::vector<BVHTriangle> unit_cube()
+{
+  const Position faces[6][4] {
+    {{0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0}}, // x = 0
+    {{1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1}}, // x = 1
+    {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}}, // y = 0
+    {{0, 1, 0}, {0, 1, 1}, {1, 1, 1}, {1, 1, 0}}, // y = 1
+    {{0, 0, 0}, {0, 1, 0}, {1, 1, 0}, {1, 0, 0}}, // z = 0
+    {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}}  // z = 1
+  };
+  std::vector<BVHTriangle> triangles;
+  for (int i = 0; i < 6; ++i) {
+    const auto& f = faces[i];
+    triangles.push_back({f[0], f[1], f[2], i});
+    triangles.push_back({f[0], f[2], f[3], i});
+  }
+  return triangles;
+}
+
+} // namespace
+
+int main()
+{
+  // A single triangle in the z = 0 plane
+  BVHTriangle tri {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, 0};
+  Direction down {0, 0, -1};
+  check(close(intersect_triangle({0.2, 0.2, 1}, down, tri, INFTY), 1.0),
+    "ray hits the triangle");
+  check(intersect_triangle({0.2, 0.2, 1}, down, tri, 0.5) == INFTY,
+    "hit beyond t_max is ignored");
+  check(intersect_triangle({2, 2, 1}, down, tri, INFTY) == INFTY,
+    "ray misses the triangle");
+  check(intersect_triangle({0.2, 0.2, -1}, down, tri, INFTY) == INFTY,
+    "triangle behind the ray is not hit");
+  check(close(intersect_triangle({0.5, 0.5, 1}, down, tri, INFTY), 1.0),
+    "ray through an edge hits");
+
+  TriangleBVH bvh;
+  bvh.build(unit_cube());
+  check(!bvh.empty(), "hierarchy is built");
+
+  auto box = bvh.bounding_box();
+  check(box.xmin == 0 && box.ymin == 0 && box.zmin == 0 && box.xmax == 1 &&
+    box.ymax == 1 && box.zmax == 1, "bounding box is the cube");
+
+  // Ray to the middle of a face
+  Position center {0.5, 0.5, 0.5};
+  BVHHit hit = bvh.ray_fire(center, {1, 0, 0});
+  check(close(hit.distance, 0.5) && hit.surface == 1 && hit.exiting,
+    "ray leaves through the face at x = 1");
+
+  // Ray through the diagonal shared by the two triangles of a face
+  hit = bvh.ray_fire(center, {0, 0, 1});
+  check(close(hit.distance, 0.5) && hit.surface == 5,
+    "ray through a shared edge hits the face");
+
+  // Ray through a corner
+  Direction corner {1, 1, 1};
+  corner /= corner.norm();
+  hit = bvh.ray_fire(center, corner);
+  check(close(hit.distance, 0.5 * std::sqrt(3.0)), "ray through a corner hits");
+
+  // Rays in every direction of a grid leave the cube, none through a gap
+  int n_missed = 0;
+  for (int i = -4; i <= 4; ++i) {
+    for (int j = -4; j <= 4; ++j) {
+      for (int k = -4; k <= 4; ++k) {
+        if (i == 0 && j == 0 && k == 0) continue;
+        Direction u {i * 0.25, j * 0.25, k * 0.25};
+        u /= u.norm();
+        hit = bvh.ray_fire({0.25, 0.5, 0.75}, u);
+        Position r = Position {0.25, 0.5, 0.75} + hit.distance * u;
+        bool on_surface = std::abs(r.x) < 1e-9 || std::abs(r.x - 1) < 1e-9 ||
+          std::abs(r.y) < 1e-9 || std::abs(r.y - 1) < 1e-9 ||
+          std::abs(r.z) < 1e-9 || std::abs(r.z - 1) < 1e-9;
+        if (hit.triangle == C_NONE || !on_surface) ++n_missed;
+      }
+    }
+  }
+  check(n_missed == 0, "rays in every direction leave the cube");
+
+  // A ray starting on the face it entered through doesn't hit it again
+  hit = bvh.ray_fire({0.5, 0.5, 0}, {0, 0, 1});
+  check(close(hit.distance, 1.0) && hit.surface == 5,
+    "ray entering through a face crosses the cube");
+
+  check(bvh.contains(center, {0, 1, 0}), "center is inside");
+  check(!bvh.contains({1.5, 0.5, 0.5}, {-1, 0, 0}), "point is outside");
+
+  if (n_failed == 0) std::printf("All checks passed\n");
+  return n_failed == 0 ? 0 : 1;
+}
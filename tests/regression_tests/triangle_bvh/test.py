@@ -0,0 +1,49 @@
+from pathlib import Path
+import os
+import shutil
+import subprocess
+import textwrap
+
+import pytest
+
+
+@pytest.fixture
+def bvh_driver(request):
+    """Compile the checks of the triangle hierarchy against libopenmc"""
+
+    # Get build directory and write CMakeLists.txt file
+    openmc_dir = Path(str(request.config.rootdir)) / 'build'
+    with open('CMakeLists.txt', 'w') as f:
+        f.write(textwrap.dedent("""
+            cmake_minimum_required(VERSION 3.3 FATAL_ERROR)
+            project(openmc_triangle_bvh CXX)
+            add_executable(triangle_bvh driver.cpp)
+            find_package(OpenMC REQUIRED HINTS {})
+            target_link_libraries(triangle_bvh OpenMC::libopenmc)
+            set_target_properties(triangle_bvh PROPERTIES CXX_STANDARD 17)
+            """.format(openmc_dir)))
+
+    # Create temporary build directory and change to there
+    local_builddir = Path('build')
+    local_builddir.mkdir(exist_ok=True)
+    os.chdir(str(local_builddir))
+
+    try:
+        print("Building driver")
+        subprocess.run(['cmake', os.path.pardir], check=True)
+        subprocess.run(['make'], check=True)
+        os.chdir(os.path.pardir)
+
+        yield "./build/triangle_bvh"
+
+    finally:
+        # Remove local build directory when test is complete
+        shutil.rmtree('build')
+        os.remove('CMakeLists.txt')
+
+
+def test_triangle_bvh(bvh_driver):
+    result = subprocess.run([bvh_driver], stdout=subprocess.PIPE,
+                            universal_newlines=True)
+    print(result.stdout)
+    assert result.returncode == 0
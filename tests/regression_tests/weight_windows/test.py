@@ -0,0 +1,102 @@
+import os
+
+import numpy as np
+import openmc
+import pytest
+
+from tests.regression_tests import config
+
+
+def create_library():
+    groups = openmc.mgxs.EnergyGroups(group_edges=[0.0, 20.0e6])
+    library = openmc.MGXSLibrary(groups)
+    shield = openmc.XSdata('shield', groups)
+    shield.order = 0
+    shield.set_total([1.0])
+    shield.set_absorption([0.3])
+    shield.set_scatter_matrix(np.array([[[0.7]]]))
+    library.add_xsdata(shield)
+    library.export_to_hdf5('1g.h5')
+
+
+def make_model(weight_windows=None, generator=False):
+    model = openmc.model.Model()
+
+    shield = openmc.Material(material_id=1)
+    shield.set_density('macro', 1.0)
+    shield.add_macroscopic('shield')
+    model.materials.append(shield)
+    model.materials.cross_sections = os.path.abspath('1g.h5')
+
+    # Slab shield, with particles entering through its face at x = 0
+    x0 = openmc.XPlane(x0=0.0, boundary_type='vacuum')
+    x1 = openmc.XPlane(x0=10.0, boundary_type='vacuum')
+    y0 = openmc.YPlane(y0=-1.0, boundary_type='reflective')
+    y1 = openmc.YPlane(y0=1.0, boundary_type='reflective')
+    z0 = openmc.ZPlane(z0=-1.0, boundary_type='reflective')
+    z1 = openmc.ZPlane(z0=1.0, boundary_type='reflective')
+    cell = openmc.Cell(fill=shield, region=+x0 & -x1 & +y0 & -y1 & +z0 & -z1)
+    model.geometry = openmc.Geometry([cell])
+
+    model.settings.energy_mode = 'multi-group'
+    model.settings.run_mode = 'fixed source'
+    model.settings.batches = 10
+    model.settings.particles = 2000
+    model.settings.source = openmc.Source(
+        space=openmc.stats.Point((1.0e-6, 0.0, 0.0)),
+        angle=openmc.stats.Monodirectional((1.0, 0.0, 0.0)),
+        energy=openmc.stats.Discrete([1.0e6], [1.0]))
+
+    mesh = openmc.RegularMesh(mesh_id=1)
+    mesh.lower_left = (0.0, -1.0, -1.0)
+    mesh.upper_right = (10.0, 1.0, 1.0)
+    mesh.dimension = (10, 1, 1)
+    tally = openmc.Tally(tally_id=1)
+    tally.filters = [openmc.MeshFilter(mesh)]
+    tally.scores = ['flux']
+    model.tallies.append(tally)
+
+    if weight_windows is not None:
+        ww = openmc.WeightWindows(mesh, lower_ww_bounds=weight_windows,
+                                  upper_bound_ratio=5.0, id=1)
+        model.settings.weight_windows = ww
+        if generator:
+            model.settings.weight_window_generators = \
+                openmc.WeightWindowGenerator(ww, tally, threshold=0.5)
+    return model
+
+
+def run(model, subdir):
+    os.makedirs(subdir, exist_ok=True)
+    model.export_to_xml(subdir)
+    kwargs = {'openmc_exec': config['exe'], 'cwd': subdir,
+              'event_based': config['event']}
+    if config['mpi']:
+        kwargs['mpi_args'] = [config['mpiexec'], '-n', config['mpi_np']]
+    openmc.run(**kwargs)
+    path = os.path.join(subdir, 'statepoint.10.h5')
+    with openmc.StatePoint(path) as sp:
+        t = sp.get_tally(id=1)
+        return t.mean.ravel(), t.std_dev.ravel()
+
+
+def test_weight_windows(run_in_tmpdir):
+    create_library()
+
+    mean_ref, std_ref = run(make_model(), 'analog')
+
+    # Windows following the attenuation of the flux in the shield: particles
+    # are split on their way in, so that the far side is sampled more often
+    x = np.arange(10) + 0.5
+    bounds = 0.5 * np.exp(-0.84 * x)
+    mean_ww, std_ww = run(make_model(bounds), 'fixed')
+
+    # Windows generated from the flux as it is tallied
+    mean_gen, std_gen = run(make_model(bounds, generator=True), 'generated')
+
+    # Splitting and roulette keep the flux unbiased
+    for mean, std in ((mean_ww, std_ww), (mean_gen, std_gen)):
+        assert np.all(np.abs(mean - mean_ref) < 4*np.hypot(std, std_ref))
+
+    # and sample the far side of the shield better than analog transport
+    assert std_ww[-1] / mean_ww[-1] < std_ref[-1] / mean_ref[-1]
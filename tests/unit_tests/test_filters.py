@@ -142,6 +142,27 @@ def test_zernike_radial():
     assert elem.find('order').text == str(n)
 
 
+def test_time():
+    f = openmc.TimeFilter([0., 1e-6, 1e-3, 1.])
+    assert f.num_bins == 3
+    assert f.units == 's'
+
+    # Make sure __repr__ works
+    repr(f)
+
+    # to_xml_element()
+    elem = f.to_xml_element()
+    assert elem.tag == 'filter'
+    assert elem.attrib['type'] == 'time'
+    bins = [float(x) for x in elem.find('bins').text.split()]
+    assert bins == [0., 1e-6, 1e-3, 1.]
+
+    # get_pandas_dataframe()
+    df = f.get_pandas_dataframe(f.num_bins, 1)
+    assert df['time low [s]'].tolist() == [0., 1e-6, 1e-3]
+    assert df['time high [s]'].tolist() == [1e-6, 1e-3, 1.]
+
+
 def test_first_moment(run_in_tmpdir, box_model):
     plain_tally = openmc.Tally()
     plain_tally.scores = ['flux', 'scatter']
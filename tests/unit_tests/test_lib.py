@@ -126,6 +126,15 @@ def test_cell_temperature(lib_init):
     assert cell.get_temperature() == 200.0
 
 
+def test_set_cell_temperatures(lib_init):
+    cells = [openmc.lib.cells[1], openmc.lib.cells[2]]
+    openmc.lib.set_cell_temperatures(cells, [300.0, 400.0])
+    assert cells[0].get_temperature() == pytest.approx(300.0)
+    assert cells[1].get_temperature() == pytest.approx(400.0)
+    openmc.lib.set_cell_temperatures(cells[:1], [200.0], [0])
+    assert cells[0].get_temperature(0) == pytest.approx(200.0)
+
+
 def test_properties_temperature(lib_init):
     # Cell temperature should be 200 from above test
     cell = openmc.lib.cells[1]
@@ -192,6 +201,19 @@ def test_material(lib_init):
     assert m.name == "Not hot borated water"
 
 
+def test_set_material_densities(lib_init):
+    m1 = openmc.lib.materials[1]
+    m3 = openmc.lib.materials[3]
+    old = [m1.densities, m3.densities]
+    new = [[2.0 * d for d in old[0]], [0.5 * d for d in old[1]]]
+    openmc.lib.set_material_densities([m1, m3], new)
+    assert m1.densities == pytest.approx(new[0])
+    assert m3.get_density() == pytest.approx(sum(new[1]))
+    with pytest.raises(ValueError):
+        openmc.lib.set_material_densities([m1], [new[0][:-1]])
+    openmc.lib.set_material_densities([m1, m3], old)
+
+
 def test_properties_density(lib_init):
     m = openmc.lib.materials[1]
     orig_density = m.get_density('atom/b-cm')
@@ -485,6 +507,15 @@ def test_find_cell(lib_init):
         openmc.lib.find_cell((100., 100., 100.))
 
 
+def test_find_cells(lib_init):
+    xyz = np.array([[0., 0., 0.], [0.4, 0., 0.], [100., 100., 100.]])
+    index, instance = openmc.lib.find_cells(xyz)
+    assert openmc.lib.Cell(index=index[0]) is openmc.lib.cells[1]
+    assert openmc.lib.Cell(index=index[1]) is openmc.lib.cells[2]
+    assert index[2] == -1
+    assert instance[2] == -1
+
+
 def test_find_material(lib_init):
     mat = openmc.lib.find_material((0., 0., 0.))
     assert mat is openmc.lib.materials[1]
@@ -1,5 +1,6 @@
 from collections import defaultdict
 
+import h5py
 import pytest
 
 import openmc
@@ -311,6 +312,45 @@ def test_materials(run_in_tmpdir):
     mats.export_to_xml()
 
 
+def test_export_to_hdf5(run_in_tmpdir):
+    m1 = openmc.Material(1, 'fuel')
+    m1.add_nuclide('U235', 1.0, 'wo')
+    m1.add_nuclide('O16', 2.0, 'wo')
+    m1.set_density('g/cm3', 10.0)
+    m1.depletable = True
+    m1.temperature = 900.0
+
+    m2 = openmc.Material(2)
+    m2.add_nuclide('H1', 2.0)
+    m2.add_nuclide('O16', 1.0)
+    m2.add_s_alpha_beta('c_H_in_H2O', 0.5)
+    m2.isotropic = ['H1']
+    m2.set_density('sum')
+
+    mats = openmc.Materials([m2, m1])
+    mats.cross_sections = 'fake_path.xml'
+    mats.export_to_hdf5()
+
+    with h5py.File('materials.h5', 'r') as f:
+        assert f.attrs['filetype'] == b'materials'
+        assert f.attrs['cross_sections'] == b'fake_path.xml'
+        assert list(f['id']) == [1, 2]
+        assert list(f['name']) == [b'fuel', b'']
+        assert list(f['depletable']) == [1, 0]
+        assert list(f['density_units']) == [b'g/cm3', b'sum']
+        assert list(f['temperature']) == [900.0, -1.0]
+        nuclides = list(f['nuclides'])
+        assert [nuclides[i] for i in f['nuclide']] == \
+            [b'U235', b'O16', b'H1', b'O16']
+        assert list(f['nuclide_offsets']) == [0, 2, 4]
+        assert list(f['nuclide_fraction']) == [-1.0, -2.0, 2.0, 1.0]
+        assert [nuclides[i] for i in f['isotropic']] == [b'H1']
+        assert list(f['isotropic_offsets']) == [0, 0, 1]
+        assert list(f['sab_names']) == [b'c_H_in_H2O']
+        assert list(f['sab_offsets']) == [0, 0, 1]
+        assert list(f['sab_fraction']) == [0.5]
+
+
 def test_borated_water():
     # Test against reference values from the BEAVRS benchmark.
     m = openmc.model.borated_water(975, 566.5, 15.51, material_id=50)
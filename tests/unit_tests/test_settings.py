@@ -28,25 +28,28 @@ def test_export_to_xml(run_in_tmpdir):
     s.survival_biasing = True
     s.cutoff = {'weight': 0.25, 'weight_avg': 0.5, 'energy_neutron': 1.0e-5,
                 'energy_photon': 1000.0, 'energy_electron': 1.0e-5,
-                'energy_positron': 1.0e-5}
+                'energy_positron': 1.0e-5, 'time_neutron': 1.0e-3}
     mesh = openmc.RegularMesh()
     mesh.lower_left = (-10., -10., -10.)
     mesh.upper_right = (10., 10., 10.)
     mesh.dimension = (5, 5, 5)
     s.entropy_mesh = mesh
+    s.domain_mesh = mesh
     s.trigger_active = True
     s.trigger_max_batches = 10000
     s.trigger_batch_interval = 50
     s.no_reduce = False
     s.tabular_legendre = {'enable': True, 'num_points': 50}
     s.temperature = {'default': 293.6, 'method': 'interpolation',
-                     'multipole': True, 'range': (200., 1000.)}
+                     'multipole': True, 'range': (200., 1000.),
+                     'tms': False}
     s.trace = (10, 1, 20)
     s.track = [1, 1, 1, 2, 1, 1]
     s.ufs_mesh = mesh
     s.resonance_scattering = {'enable': True, 'method': 'rvs',
                               'energy_min': 1.0, 'energy_max': 1000.0,
                               'nuclides': ['U235', 'U238', 'Pu239']}
+    s.random_ray = {'distance_active': 400.0, 'distance_inactive': 40.0}
     s.volume_calculations = openmc.VolumeCalculation(
         domains=[openmc.Cell()], samples=1000, lower_left=(-10., -10., -10.),
         upper_right = (10., 10., 10.))
@@ -55,6 +58,13 @@ def test_export_to_xml(run_in_tmpdir):
     s.photon_transport = False
     s.electron_treatment = 'led'
     s.dagmc = False
+    ww = openmc.WeightWindows(
+        mesh, lower_ww_bounds=[0.5]*250, upper_bound_ratio=4.0,
+        energy_bounds=[0.0, 1.0, 20.0e6], survival_ratio=2.0, max_split=5,
+        weight_cutoff=1.0e-30)
+    s.weight_windows = ww
+    s.weight_window_generators = openmc.WeightWindowGenerator(
+        ww, 3, threshold=0.5, ratio=6.0, interval=2)
 
     # Make sure exporting XML works
     s.export_to_xml()
@@ -86,7 +96,8 @@ def test_export_to_xml(run_in_tmpdir):
     assert s.survival_biasing
     assert s.cutoff == {'weight': 0.25, 'weight_avg': 0.5,
                         'energy_neutron': 1.0e-5, 'energy_photon': 1000.0,
-                        'energy_electron': 1.0e-5, 'energy_positron': 1.0e-5}
+                        'energy_electron': 1.0e-5, 'energy_positron': 1.0e-5,
+                        'time_neutron': 1.0e-3}
     assert isinstance(s.entropy_mesh, openmc.RegularMesh)
     assert s.entropy_mesh.lower_left == [-10., -10., -10.]
     assert s.entropy_mesh.upper_right == [10., 10., 10.]
@@ -97,18 +108,39 @@ def test_export_to_xml(run_in_tmpdir):
     assert not s.no_reduce
     assert s.tabular_legendre == {'enable': True, 'num_points': 50}
     assert s.temperature == {'default': 293.6, 'method': 'interpolation',
-                             'multipole': True, 'range': [200., 1000.]}
+                             'multipole': True, 'range': [200., 1000.],
+                             'tms': False}
     assert s.trace == [10, 1, 20]
     assert s.track == [1, 1, 1, 2, 1, 1]
     assert isinstance(s.ufs_mesh, openmc.RegularMesh)
     assert s.ufs_mesh.lower_left == [-10., -10., -10.]
     assert s.ufs_mesh.upper_right == [10., 10., 10.]
     assert s.ufs_mesh.dimension == [5, 5, 5]
+    assert isinstance(s.domain_mesh, openmc.RegularMesh)
+    assert s.domain_mesh.dimension == [5, 5, 5]
     assert s.resonance_scattering == {'enable': True, 'method': 'rvs',
                                       'energy_min': 1.0, 'energy_max': 1000.0,
                                       'nuclides': ['U235', 'U238', 'Pu239']}
+    assert s.random_ray == {'distance_active': 400.0,
+                            'distance_inactive': 40.0}
     assert s.create_fission_neutrons
     assert s.log_grid_bins == 2000
     assert not s.photon_transport
     assert s.electron_treatment == 'led'
     assert not s.dagmc
+    ww = s.weight_windows[0]
+    assert ww.mesh.dimension == [5, 5, 5]
+    assert ww.particle_type == 'neutron'
+    assert list(ww.lower_ww_bounds) == [0.5]*250
+    assert ww.upper_ww_bounds is None
+    assert ww.upper_bound_ratio == 4.0
+    assert list(ww.energy_bounds) == [0.0, 1.0, 20.0e6]
+    assert ww.survival_ratio == 2.0
+    assert ww.max_split == 5
+    assert ww.weight_cutoff == 1.0e-30
+    gen = s.weight_window_generators[0]
+    assert gen.weight_windows is ww
+    assert gen.tally_id == 3
+    assert gen.threshold == 0.5
+    assert gen.ratio == 6.0
+    assert gen.interval == 2
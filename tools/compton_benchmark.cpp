@@ -0,0 +1,165 @@
+//! \file compton_benchmark.cpp
+//! \brief Throughput and fidelity of tabulated Klein-Nishina sampling
+//! (ComptonTable) against the rejection sampler klein_nishina()
+//!
+//! Usage: compton_benchmark [n_samples] [n_quantiles ...]
+//!
+//! Tables are built for scattering off free electrons between 1 keV and
+//! 100 MeV, with each number of quantiles given (32, 128 and 512 by default).
+//! Fidelity is the largest Kolmogorov-Smirnov distance, over a set of photon
+//! energies, between n_samples scattering cosines drawn from the table and as
+//! many drawn by klein_nishina(). It is printed next to the 95% critical
+//! distance of two independent sets of that size. Throughput is measured on
+//! host and device with energies drawn log-uniformly over the whole range, so
+//! that neighbouring samples take different paths through klein_nishina().
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "openmc/constants.h"
+#include "openmc/photon.h"
+#include "openmc/random_lcg.h"
+
+using namespace openmc;
+
+namespace {
+
+constexpr double E_MIN {1.0e3};
+constexpr double E_MAX {1.0e8};
+
+//! Two-sample Kolmogorov-Smirnov distance
+double ks_distance(std::vector<double>& a, std::vector<double>& b)
+{
+  std::sort(a.begin(), a.end());
+  std::sort(b.begin(), b.end());
+  double d = 0.0;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < a.size() && j < b.size()) {
+    double x = std::min(a[i], b[j]);
+    while (i < a.size() && a[i] <= x) ++i;
+    while (j < b.size() && b[j] <= x) ++j;
+    d = std::max(d, std::abs(static_cast<double>(i) / a.size() -
+      static_cast<double>(j) / b.size()));
+  }
+  return d;
+}
+
+#pragma omp declare target
+//! Photon energy over electron rest mass, log-uniform between E_MIN and E_MAX
+double sample_alpha(uint64_t* seed)
+{
+  return std::exp(std::log(E_MIN) + prn(seed) * std::log(E_MAX / E_MIN)) /
+    MASS_ELECTRON_EV;
+}
+#pragma omp end declare target
+
+//! Draw n_samples cosines on host or device, from the table or, when table
+//! is nullptr, from klein_nishina()
+//
+//! \return Elapsed time in [s]
+double run_pass(int64_t n_samples, const ComptonTable* table, bool device,
+  double& sum_mu)
+{
+  double sum = 0.0;
+  auto start = std::chrono::steady_clock::now();
+  if (device) {
+    #pragma omp target teams distribute parallel for reduction(+:sum)
+    for (int64_t i = 0; i < n_samples; ++i) {
+      uint64_t seed = init_seed(i, STREAM_PHOTON);
+      double alpha = sample_alpha(&seed);
+      double alpha_out, mu;
+      if (table) {
+        table->sample(alpha, &alpha_out, &mu, &seed);
+      } else {
+        mu = klein_nishina(alpha, &seed).second;
+      }
+      sum += mu;
+    }
+  } else {
+    #pragma omp parallel for schedule(static) reduction(+:sum)
+    for (int64_t i = 0; i < n_samples; ++i) {
+      uint64_t seed = init_seed(i, STREAM_PHOTON);
+      double alpha = sample_alpha(&seed);
+      double alpha_out, mu;
+      if (table) {
+        table->sample(alpha, &alpha_out, &mu, &seed);
+      } else {
+        mu = klein_nishina(alpha, &seed).second;
+      }
+      sum += mu;
+    }
+  }
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+
+  sum_mu = sum;
+  return elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  int64_t n_samples = argc > 1 ? std::atoll(argv[1]) : 1000000;
+  std::vector<int> levels;
+  for (int i = 2; i < argc; ++i) levels.push_back(std::atoi(argv[i]));
+  if (levels.empty()) levels = {32, 128, 512};
+
+  // Energies the distributions are compared at, in [eV]
+  const double energies[] {2.0e3, 2.0e4, 2.0e5, 1.0e6, 1.0e7, 9.0e7};
+  int64_t n_fidelity = std::min<int64_t>(n_samples, 200000);
+  double critical = 1.358 * std::sqrt(2.0 / n_fidelity);
+
+  std::printf("%lld samples for throughput, %lld per energy for fidelity "
+    "(95%% critical KS distance %.5f)\n\n", static_cast<long long>(n_samples),
+    static_cast<long long>(n_fidelity), critical);
+  std::printf("%-10s %10s %12s %14s %14s\n", "Sampler", "Size [kB]",
+    "Max. KS", "Host Ms/s", "Device Ms/s");
+
+  double sum_mu;
+  double t_host = run_pass(n_samples, nullptr, false, sum_mu);
+  double t_device = run_pass(n_samples, nullptr, true, sum_mu);
+  std::printf("%-10s %10s %12s %14.2f %14.2f\n", "rejection", "-", "-",
+    n_samples / t_host / 1.0e6, n_samples / t_device / 1.0e6);
+
+  for (int n_quantiles : levels) {
+    if (n_quantiles < 2) continue;
+    ComptonTable table;
+    table.init(E_MIN / MASS_ELECTRON_EV, E_MAX / MASS_ELECTRON_EV,
+      n_quantiles, nullptr);
+
+    double max_ks = 0.0;
+    for (double E : energies) {
+      double alpha = E / MASS_ELECTRON_EV;
+      std::vector<double> mu_table(n_fidelity);
+      std::vector<double> mu_exact(n_fidelity);
+      uint64_t seed = init_seed(0, STREAM_PHOTON);
+      for (int64_t i = 0; i < n_fidelity; ++i) {
+        double alpha_out;
+        table.sample(alpha, &alpha_out, &mu_table[i], &seed);
+        mu_exact[i] = klein_nishina(alpha, &seed).second;
+      }
+      max_ks = std::max(max_ks, ks_distance(mu_table, mu_exact));
+    }
+
+    t_host = run_pass(n_samples, &table, false, sum_mu);
+    #pragma omp target enter data map(to: table)
+    table.copy_to_device();
+    t_device = run_pass(n_samples, &table, true, sum_mu);
+    table.release_device();
+    #pragma omp target exit data map(release: table)
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "table %d", n_quantiles);
+    std::printf("%-10s %10.1f %12.5f %14.2f %14.2f%s\n", name,
+      table.nbytes() / 1.0e3, max_ks, n_samples / t_host / 1.0e6,
+      n_samples / t_device / 1.0e6, max_ks > critical ? "  (differs)" : "");
+  }
+
+  return 0;
+}
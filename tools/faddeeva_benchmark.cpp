@@ -0,0 +1,93 @@
+//! \file faddeeva_benchmark.cpp
+//! \brief Accuracy and throughput comparison of the Faddeeva implementations
+//! available to windowed multipole lookups (see FaddeevaMethod)
+//!
+//! Usage: faddeeva_benchmark [n_args] [n_repeats]
+//!
+//! Arguments are drawn like those seen by WindowedMultipole::evaluate(): real
+//! parts spanning many decades of (sqrt(E) - pole) * dopp and small imaginary
+//! parts of either sign. Errors are relative to the MIT Faddeeva package when
+//! it is built in (new_w off), and to the 32 term Weideman approximation
+//! otherwise.
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "openmc/math_functions.h"
+
+using namespace openmc;
+
+struct Variant {
+  const char* name;
+  FaddeevaMethod method;
+};
+
+int main(int argc, char* argv[])
+{
+  int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  int n_repeats = argc > 2 ? std::atoi(argv[2]) : 10;
+
+  // Sample arguments
+  std::mt19937_64 rng(1);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  std::vector<double> z_re(n), z_im(n);
+  for (int i = 0; i < n; ++i) {
+    z_re[i] = std::pow(10.0, 3.0*uniform(rng)) * uniform(rng);
+    z_im[i] = std::pow(10.0, 2.0*uniform(rng) - 1.0) *
+      (uniform(rng) > -0.8 ? 1.0 : -1.0);
+  }
+
+  // Reference values
+  std::vector<double> ref_re(n), ref_im(n);
+#ifdef NEW_FADDEEVA
+  const char* ref_name = "weideman32";
+  faddeeva_batch(n, z_re.data(), z_im.data(), ref_re.data(), ref_im.data(),
+    FaddeevaMethod::weideman32);
+#else
+  const char* ref_name = "MIT";
+  faddeeva_batch(n, z_re.data(), z_im.data(), ref_re.data(), ref_im.data(),
+    FaddeevaMethod::scalar);
+#endif
+
+  const Variant variants[] {
+    {"scalar", FaddeevaMethod::scalar},
+    {"humlicek8", FaddeevaMethod::humlicek8},
+    {"weideman16", FaddeevaMethod::weideman16},
+    {"weideman32", FaddeevaMethod::weideman32}
+  };
+
+  std::printf("%d arguments, %d repeats, errors relative to %s\n\n", n,
+    n_repeats, ref_name);
+  std::printf("%-12s %14s %14s %14s\n", "Method", "Max Rel. Err.",
+    "Mean Rel. Err.", "Mevals/s");
+
+  std::vector<double> w_re(n), w_im(n);
+  for (const auto& v : variants) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < n_repeats; ++r) {
+      faddeeva_batch(n, z_re.data(), z_im.data(), w_re.data(), w_im.data(),
+        v.method);
+    }
+    std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+    double max_err = 0.0;
+    double sum_err = 0.0;
+    for (int i = 0; i < n; ++i) {
+      double err = std::hypot(w_re[i] - ref_re[i], w_im[i] - ref_im[i]) /
+        std::hypot(ref_re[i], ref_im[i]);
+      max_err = std::max(max_err, err);
+      sum_err += err;
+    }
+    double rate = static_cast<double>(n) * n_repeats / elapsed.count() / 1.0e6;
+    std::printf("%-12s %14.3e %14.3e %14.1f\n", v.name, max_err, sum_err / n,
+      rate);
+  }
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""Measure how the fission bank sort scales with the number of OpenMP threads.
+
+The same eigenvalue model is run once per thread count and the time spent
+sorting fission sites and synchronizing the fission bank (as recorded in the
+statepoint runtime metrics) is reported, along with the speedup relative to
+the first thread count.
+
+Usage:
+    fission_bank_sort_scaling.py --exe build/bin/openmc \\
+        [--threads 1 2 4 8 16 32 64] [--model DIR] [--particles N]
+
+If no model directory is given, the PWR pin cell example is generated with a
+large number of particles per batch so that the sort is a measurable part of
+each generation.
+"""
+
+import argparse
+import glob
+import os
+import shutil
+import tempfile
+
+import openmc
+from openmc.examples import pwr_pin_cell
+
+
+def build_default_model(directory, particles):
+    model = pwr_pin_cell()
+    model.settings.particles = particles
+    model.settings.batches = 10
+    model.settings.inactive = 5
+    model.export_to_xml(directory)
+
+
+def run(exe, model_dir, threads, event_based):
+    """Run a copy of the model with the given number of threads and return its
+    runtime metrics."""
+    run_dir = tempfile.mkdtemp(prefix='bank_sort_')
+    for f in glob.glob(os.path.join(model_dir, '*.xml')):
+        shutil.copy(f, run_dir)
+    openmc.run(openmc_exec=exe, cwd=run_dir, threads=threads,
+               event_based=event_based, output=False)
+    statepoints = glob.glob(os.path.join(run_dir, 'statepoint.*.h5'))
+    with openmc.StatePoint(max(statepoints, key=os.path.getmtime)) as sp:
+        runtime = sp.runtime
+    shutil.rmtree(run_dir)
+    return runtime
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--exe', default='openmc', help='OpenMC executable')
+    parser.add_argument('--threads', type=int, nargs='+',
+                        default=[1, 2, 4, 8, 16, 32, 64],
+                        help='Thread counts to run with')
+    parser.add_argument('--model', help='Directory containing model XML files')
+    parser.add_argument('--particles', type=int, default=1000000,
+                        help='Particles per batch for the default model')
+    parser.add_argument('--event', action='store_true',
+                        help='Run in event-based mode')
+    args = parser.parse_args()
+
+    model_dir = args.model
+    if model_dir is None:
+        model_dir = tempfile.mkdtemp(prefix='bank_sort_model_')
+        build_default_model(model_dir, args.particles)
+
+    print(f'{"Threads":>8s} {"Sort [s]":>12s} {"Sync [s]":>12s} '
+          f'{"Sort speedup":>14s}')
+    base = None
+    for threads in args.threads:
+        runtime = run(args.exe, model_dir, threads, args.event)
+        t_sort = runtime['sorting fission sites']
+        t_sync = runtime['synchronizing fission bank']
+        if base is None:
+            base = t_sort
+        speedup = base / t_sort if t_sort > 0.0 else float('inf')
+        print(f'{threads:8d} {t_sort:12.4e} {t_sync:12.4e} {speedup:14.2f}')
+
+
+if __name__ == '__main__':
+    main()
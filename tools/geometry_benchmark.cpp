@@ -0,0 +1,227 @@
+//! \file geometry_benchmark.cpp
+//! \brief Throughput of the geometry kernels alone, on host and device, with
+//! no physics
+//!
+//! Usage: geometry_benchmark model_dir [n_rays] [max_segments]
+//!          [xmin ymin zmin xmax ymax zmax]
+//!
+//! Rays start at points drawn uniformly in the bounding box of the root
+//! universe (or in the box given) with isotropic directions. Each one is
+//! followed from boundary to boundary, through distance_to_boundary(),
+//! cross_lattice() and the neighbor list and exhaustive cell searches used by
+//! surface crossings, until it reaches a surface with a boundary condition or
+//! has crossed max_segments boundaries. Three passes separate the kernels:
+//! locating the starting points only, locating them and finding one distance
+//! to boundary, and following whole rays.
+//!
+//! Only the cross_sections.xml index is read (to resolve the nuclides of
+//! materials.xml). No nuclear data is loaded.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "openmc/cell.h"
+#include "openmc/constants.h"
+#include "openmc/cross_sections.h"
+#include "openmc/device_alloc.h"
+#include "openmc/geometry.h"
+#include "openmc/geometry_aux.h"
+#include "openmc/material.h"
+#include "openmc/particle.h"
+#include "openmc/random_lcg.h"
+#include "openmc/settings.h"
+#include "openmc/surface.h"
+
+using namespace openmc;
+
+namespace {
+
+enum class Pass {
+  find_cell, //!< Locate the starting point
+  distance,  //!< Locate the starting point and find one distance to boundary
+  trace      //!< Follow the whole ray
+};
+
+struct RayCounts {
+  int64_t missed {0};     //!< Rays starting outside the geometry
+  int64_t lost {0};       //!< Rays whose next cell could not be found
+  int64_t surfaces {0};   //!< Surface crossings
+  int64_t lattices {0};   //!< Lattice tile crossings
+};
+
+#pragma omp declare target
+//! Follow one ray through the geometry
+//
+//! \return 0 if the ray was followed to its end, 1 if its starting point is
+//!   outside the geometry and 2 if it got lost
+int trace_ray(int64_t i, BoundingBox box, int max_segments, Pass pass,
+  int64_t& n_surfaces, int64_t& n_lattices)
+{
+  Particle p;
+  init_particle_seeds(i + 1, p.seeds_);
+  uint64_t* seed = &p.seeds_[STREAM_SOURCE];
+
+  p.r() = {box.xmin + prn(seed) * (box.xmax - box.xmin),
+    box.ymin + prn(seed) * (box.ymax - box.ymin),
+    box.zmin + prn(seed) * (box.zmax - box.zmin)};
+  double mu = 2.0 * prn(seed) - 1.0;
+  double phi = 2.0 * PI * prn(seed);
+  double s = std::sqrt(1.0 - mu * mu);
+  p.u() = {mu, s * std::cos(phi), s * std::sin(phi)};
+
+  if (!exhaustive_find_cell(p)) return 1;
+  if (pass == Pass::find_cell) return 0;
+
+  for (int n = 0; n < max_segments; ++n) {
+    BoundaryInfo boundary = distance_to_boundary(p);
+    if (pass == Pass::distance || boundary.distance == INFINITY) return 0;
+
+    for (int j = 0; j < p.n_coord_; ++j) {
+      p.coord_[j].r += boundary.distance * p.coord_[j].u;
+    }
+    p.surface_ = boundary.surface_index;
+    p.n_coord_ = boundary.coord_level;
+
+    if (boundary.lattice_translation[0] != 0 ||
+        boundary.lattice_translation[1] != 0 ||
+        boundary.lattice_translation[2] != 0) {
+      cross_lattice(p, boundary);
+      ++n_lattices;
+
+      // A successful search always ends in a material cell
+      int32_t i_cell = p.coord_[p.n_coord_ - 1].cell;
+      if (i_cell == C_NONE ||
+          model::device_cells[i_cell].type_ != Fill::MATERIAL) return 2;
+      continue;
+    }
+
+    // Rays end at the first boundary condition rather than being reflected
+    ++n_surfaces;
+    const auto& surf {model::device_surfaces[std::abs(p.surface_) - 1]};
+    if (surf.bc_.type_ != BoundaryCondition::BCType::Transmission) return 0;
+
+    // Same searches as Particle::cross_surface()
+    if (!neighbor_list_find_cell(p)) {
+      p.surface_ = 0;
+      p.n_coord_ = 1;
+      if (!exhaustive_find_cell(p)) return 2;
+    }
+  }
+  return 0;
+}
+#pragma omp end declare target
+
+//! Run one pass over n_rays rays on host or device
+//
+//! \return Elapsed time in [s]
+double run_pass(int64_t n_rays, BoundingBox box, int max_segments, Pass pass,
+  bool device, RayCounts& counts)
+{
+  int64_t missed = 0;
+  int64_t lost = 0;
+  int64_t surfaces = 0;
+  int64_t lattices = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  if (device) {
+    #pragma omp target teams distribute parallel for \
+      reduction(+:missed, lost, surfaces, lattices)
+    for (int64_t i = 0; i < n_rays; ++i) {
+      int status = trace_ray(i, box, max_segments, pass, surfaces, lattices);
+      if (status == 1) ++missed;
+      if (status == 2) ++lost;
+    }
+  } else {
+    #pragma omp parallel for schedule(dynamic, 64) \
+      reduction(+:missed, lost, surfaces, lattices)
+    for (int64_t i = 0; i < n_rays; ++i) {
+      int status = trace_ray(i, box, max_segments, pass, surfaces, lattices);
+      if (status == 1) ++missed;
+      if (status == 2) ++lost;
+    }
+  }
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+
+  counts = {missed, lost, surfaces, lattices};
+  return elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    std::printf("Usage: %s model_dir [n_rays] [max_segments] "
+      "[xmin ymin zmin xmax ymax zmax]\n", argv[0]);
+    return 1;
+  }
+  int64_t n_rays = argc > 2 ? std::atoll(argv[2]) : 1000000;
+  int max_segments = argc > 3 ? std::atoi(argv[3]) : 10000;
+
+  // Read the geometry only. In plotting mode no nuclear data is loaded.
+  settings::path_input = std::string(argv[1]) + "/";
+  settings::run_mode = RunMode::PLOTTING;
+  read_settings_xml();
+  read_cross_sections_xml();
+  read_materials_xml();
+  read_geometry_xml();
+  finalize_geometry();
+
+  BoundingBox box = model::universes[model::root_universe].bounding_box();
+  if (argc > 9) {
+    box = {std::atof(argv[4]), std::atof(argv[7]), std::atof(argv[5]),
+      std::atof(argv[8]), std::atof(argv[6]), std::atof(argv[9])};
+  }
+  if (!std::isfinite(box.xmin) || !std::isfinite(box.xmax) ||
+      !std::isfinite(box.ymin) || !std::isfinite(box.ymax) ||
+      !std::isfinite(box.zmin) || !std::isfinite(box.zmax)) {
+    std::printf("The root universe is unbounded; give a box to start rays "
+      "in.\n");
+    return 1;
+  }
+
+  move_settings_to_device();
+  move_geometry_to_device();
+
+  std::printf("\n%lld rays, at most %d segments each, %zu cells, %zu "
+    "surfaces, %zu lattices\n\n", static_cast<long long>(n_rays),
+    max_segments, model::cells.size(), model::surfaces.size(),
+    model::lattices.size());
+  std::printf("%-8s %12s %12s %12s %12s %12s %10s\n", "Target", "Find [ns]",
+    "Dist. [ns]", "Mrays/s", "Segs/ray", "Mseg/s", "Lattice %");
+
+  for (bool device : {false, true}) {
+    RayCounts find, dist, trace;
+    double t_find = run_pass(n_rays, box, max_segments, Pass::find_cell,
+      device, find);
+    double t_dist = run_pass(n_rays, box, max_segments, Pass::distance,
+      device, dist);
+    double t_trace = run_pass(n_rays, box, max_segments, Pass::trace, device,
+      trace);
+
+    // The distance pass repeats the find_cell pass, so the difference is the
+    // time of one distance_to_boundary() per ray
+    double n_found = static_cast<double>(n_rays - find.missed);
+    double ns_find = 1.0e9 * t_find / n_rays;
+    double ns_dist = n_found > 0.0 ? 1.0e9 * (t_dist - t_find) / n_found : 0.0;
+    double n_segments = trace.surfaces + trace.lattices;
+    double segs_per_ray = n_found > 0.0 ? n_segments / n_found : 0.0;
+    double lattice_pct = n_segments > 0.0 ?
+      100.0 * trace.lattices / n_segments : 0.0;
+    std::printf("%-8s %12.1f %12.1f %12.3f %12.2f %12.2f %10.1f\n",
+      device ? "device" : "host", ns_find, ns_dist,
+      n_rays / t_trace / 1.0e6, segs_per_ray, n_segments / t_trace / 1.0e6,
+      lattice_pct);
+    if (trace.missed > 0 || trace.lost > 0) {
+      std::printf("         %lld rays started outside the geometry, %lld were "
+        "lost\n", static_cast<long long>(trace.missed),
+        static_cast<long long>(trace.lost));
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,141 @@
+//! \file hex_lattice_benchmark.cpp
+//! \brief Agreement and throughput comparison of the hexagonal lattice index
+//! and distance kernels with the original implementations they replaced
+//!
+//! Usage: hex_lattice_benchmark [n_points] [n_repeats]
+//!
+//! Points are drawn uniformly over a 20 ring lattice of each orientation, plus
+//! points exactly on the sides of tiles, where the direction decides which tile
+//! the point is in. Distances are compared in the tile found by the fast
+//! indexing.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pugixml.hpp>
+
+#include "openmc/constants.h"
+#include "openmc/lattice.h"
+#include "openmc/position.h"
+
+using namespace openmc;
+
+namespace {
+
+constexpr int N_RINGS {20};
+constexpr double PITCH {1.26};
+
+Lattice make_lattice(const char* orientation)
+{
+  int n_univ = 3*N_RINGS*N_RINGS - 3*N_RINGS + 1;
+  std::ostringstream xml;
+  xml << "<hex_lattice id=\"1\" n_rings=\"" << N_RINGS << "\" orientation=\""
+      << orientation << "\"><center>0.0 0.0</center><pitch>" << PITCH
+      << "</pitch><universes>";
+  for (int i = 0; i < n_univ; ++i) xml << "1 ";
+  xml << "</universes></hex_lattice>";
+
+  pugi::xml_document doc;
+  doc.load_string(xml.str().c_str());
+  return Lattice(doc.child("hex_lattice"), LatticeType::hex);
+}
+
+template<class F>
+double time_it(int n_repeats, F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < n_repeats; ++r) f();
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  int n_repeats = argc > 2 ? std::atoi(argv[2]) : 10;
+
+  std::printf("%d points, %d repeats\n\n", n, n_repeats);
+  std::printf("%-12s %-10s %12s %14s %14s %10s\n", "Orientation", "Kernel",
+    "Mismatches", "Original [M/s]", "Fast [M/s]", "Speedup");
+
+  for (const char* orientation : {"y", "x"}) {
+    Lattice lat = make_lattice(orientation);
+    double extent = (N_RINGS - 1) * PITCH;
+
+    // Sample points over the lattice and on the sides of tiles
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    std::vector<Position> r(n);
+    std::vector<Direction> u(n);
+    for (int i = 0; i < n; ++i) {
+      double phi = PI * uniform(rng);
+      u[i] = {std::cos(phi), std::sin(phi), 0.0};
+      r[i] = {extent * uniform(rng), extent * uniform(rng), 0.0};
+      if (i % 4 == 0) {
+        // Move the point onto its tile's side facing a random direction
+        auto i_xyz = lat.HexLattice_get_indices(r[i], u[i]);
+        Position local = lat.get_local_position(r[i], i_xyz);
+        Position center {r[i].x - local.x, r[i].y - local.y, 0.0};
+        double angle = (orientation[0] == 'y' ? PI / 6.0 : 0.0) +
+          (rng() % 6) * PI / 3.0;
+        double along = 0.25 * PITCH * uniform(rng);
+        r[i] = {center.x + 0.5*PITCH*std::cos(angle) - along*std::sin(angle),
+                center.y + 0.5*PITCH*std::sin(angle) + along*std::cos(angle),
+                0.0};
+      }
+    }
+
+    // Indices
+    std::vector<std::array<int, 3>> idx_fast(n), idx_orig(n);
+    double t_orig = time_it(n_repeats, [&]() {
+      for (int i = 0; i < n; ++i)
+        idx_orig[i] = lat.HexLattice_get_indices_candidates(r[i], u[i]);
+    });
+    double t_fast = time_it(n_repeats, [&]() {
+      for (int i = 0; i < n; ++i)
+        idx_fast[i] = lat.HexLattice_get_indices(r[i], u[i]);
+    });
+    int n_diff = 0;
+    for (int i = 0; i < n; ++i) n_diff += (idx_fast[i] != idx_orig[i]);
+    double rate = static_cast<double>(n) * n_repeats / 1.0e6;
+    std::printf("%-12s %-10s %12d %14.1f %14.1f %10.2f\n", orientation,
+      "indices", n_diff, rate / t_orig, rate / t_fast, t_orig / t_fast);
+
+    // Distances, from the tile each point was found in
+    std::vector<std::pair<double, std::array<int, 3>>> d_fast(n), d_orig(n);
+    t_orig = time_it(n_repeats, [&]() {
+      for (int i = 0; i < n; ++i)
+        d_orig[i] = lat.HexLattice_distance_neighbors(r[i], u[i], idx_fast[i]);
+    });
+    t_fast = time_it(n_repeats, [&]() {
+      for (int i = 0; i < n; ++i)
+        d_fast[i] = lat.HexLattice_distance(r[i], u[i], idx_fast[i]);
+    });
+    n_diff = 0;
+    double max_err = 0.0;
+    for (int i = 0; i < n; ++i) {
+      // Crossings through a vertex may go to either tile
+      double err = std::abs(d_fast[i].first - d_orig[i].first) /
+        std::max(d_orig[i].first, 1.0);
+      max_err = std::max(max_err, err);
+      n_diff += (d_fast[i].second != d_orig[i].second && err > FP_PRECISION);
+    }
+    std::printf("%-12s %-10s %12d %14.1f %14.1f %10.2f\n", orientation,
+      "distance", n_diff, rate / t_orig, rate / t_fast, t_orig / t_fast);
+    std::printf("%-12s %-10s max. rel. distance difference %.3e\n", "", "",
+      max_err);
+  }
+
+  return 0;
+}
@@ -0,0 +1,573 @@
+#!/usr/bin/env python3
+"""Run the standard performance problems and record how fast OpenMC runs them.
+
+Each problem is built with the Python API, run once per transport mode and
+summarized by the particle rates of the inactive and active batches, the
+startup time, the peak resident memory of the run and, for event-based modes,
+the time, launches and items of each event kernel. The results are printed as
+a table and can be written as JSON so that runs on different machines,
+compilers and forks can be compared.
+
+Problems:
+    smr-fresh     37-assembly small modular reactor core, fresh UO2 fuel
+    smr-depleted  the same core with 296 nuclides in the fuel
+    hm-small      Hoogenboom-Martin full-core PWR, 34 nuclides in the fuel
+    hm-large      Hoogenboom-Martin full-core PWR, 300 nuclides in the fuel
+    triso         reflected cube of TRISO particles in graphite
+    fusion        fixed-source fusion blanket and shield with photon transport
+    mg            7-group (C5G7) PWR assembly in multigroup mode
+
+Modes:
+    history       history-based transport
+    event         event-based transport on host (OMP_TARGET_OFFLOAD=DISABLED)
+    device        event-based transport on device (OMP_TARGET_OFFLOAD=MANDATORY)
+
+Usage:
+    openmc_bench.py --exe build/bin/openmc [--problems smr-fresh hm-small]
+        [--modes history event device] [--threads N] [--output bench.json]
+
+Depleted fuel is represented by padding fresh fuel with trace amounts of
+fission products and actinides from the cross section library given by
+OPENMC_CROSS_SECTIONS, which is what determines the cost of cross section
+lookups.
+"""
+
+import argparse
+import datetime
+import glob
+import json
+import os
+import platform
+import shutil
+import subprocess
+import tempfile
+
+import numpy as np
+import openmc
+import openmc.data
+import openmc.mgxs
+import openmc.model
+from openmc.examples import pwr_core
+
+
+MODES = {
+    'history': ([], {}),
+    'event': (['-e', '--kernel-profile'], {'OMP_TARGET_OFFLOAD': 'DISABLED'}),
+    'device': (['-e', '--kernel-profile'], {'OMP_TARGET_OFFLOAD': 'MANDATORY'}),
+}
+
+# Particles, batches and inactive batches of each problem
+RUN_SIZES = {
+    'smr-fresh': (100000, 20, 10),
+    'smr-depleted': (100000, 20, 10),
+    'hm-small': (100000, 20, 10),
+    'hm-large': (100000, 20, 10),
+    'triso': (100000, 20, 10),
+    'fusion': (100000, 10, 0),
+    'mg': (1000000, 20, 10),
+}
+
+
+# ==============================================================================
+# Problems
+
+def add_trace_nuclides(material, n_nuclides, fraction=1.0e-8):
+    """Add trace amounts of nuclides from the cross section library to a
+    material until it holds n_nuclides, taking fission products and actinides
+    first."""
+    present = {n.name for n in material.nuclides}
+    total = sum(n.percent for n in material.nuclides)
+    library = openmc.data.DataLibrary.from_xml()
+    candidates = []
+    for lib in library.libraries:
+        if lib['type'] != 'neutron':
+            continue
+        for name in lib['materials']:
+            if name in present:
+                continue
+            try:
+                Z, A, m = openmc.data.zam(name)
+            except ValueError:
+                continue
+            fission_product = 30 <= Z <= 66 or Z >= 90
+            candidates.append((not fission_product, Z, A, m, name))
+    candidates.sort()
+
+    needed = n_nuclides - len(present)
+    if len(candidates) < needed:
+        raise RuntimeError(f'The cross section library has only '
+                           f'{len(present) + len(candidates)} nuclides for a '
+                           f'material of {n_nuclides}.')
+    for *_, name in candidates[:needed]:
+        material.add_nuclide(name, fraction * total)
+
+
+def pin_universes(fuel, clad, water, fuel_r=0.4096, clad_r=0.4750):
+    """Return fuel pin and guide tube universes."""
+    fuel_or = openmc.ZCylinder(r=fuel_r)
+    clad_or = openmc.ZCylinder(r=clad_r)
+    fuel_pin = openmc.Universe(name='fuel pin', cells=[
+        openmc.Cell(fill=fuel, region=-fuel_or),
+        openmc.Cell(fill=clad, region=+fuel_or & -clad_or),
+        openmc.Cell(fill=water, region=+clad_or)])
+    guide_tube = openmc.Universe(name='guide tube', cells=[
+        openmc.Cell(fill=water, region=-fuel_or),
+        openmc.Cell(fill=clad, region=+fuel_or & -clad_or),
+        openmc.Cell(fill=water, region=+clad_or)])
+    return fuel_pin, guide_tube
+
+
+def assembly_lattice(fuel_pin, guide_tube, pitch):
+    """Return a 17x17 assembly lattice centered on the origin."""
+    lattice = openmc.RectLattice(name='assembly')
+    lattice.pitch = (pitch/17, pitch/17)
+    lattice.lower_left = (-pitch/2, -pitch/2)
+    template_x = np.array([5, 8, 11, 3, 13, 2, 5, 8, 11, 14, 2, 5, 8,
+                           11, 14, 2, 5, 8, 11, 14, 3, 13, 5, 8, 11])
+    template_y = np.array([2, 2, 2, 3, 3, 5, 5, 5, 5, 5, 8, 8, 8, 8,
+                           8, 11, 11, 11, 11, 11, 13, 13, 14, 14, 14])
+    lattice.universes = np.tile(fuel_pin, (17, 17))
+    lattice.universes[template_x, template_y] = guide_tube
+    return lattice
+
+
+def smr_core(depleted):
+    """Return a 37-assembly small modular reactor core."""
+    fuel = openmc.Material(name='UO2 fuel')
+    fuel.set_density('g/cm3', 10.4)
+    fuel.add_element('U', 1.0, enrichment=4.5)
+    fuel.add_element('O', 2.0)
+    if depleted:
+        add_trace_nuclides(fuel, 296)
+
+    clad = openmc.Material(name='Zircaloy')
+    clad.set_density('g/cm3', 6.55)
+    clad.add_element('Zr', 1.0)
+
+    water = openmc.Material(name='Borated water')
+    water.set_density('g/cm3', 0.74)
+    water.add_element('H', 2.0)
+    water.add_element('O', 1.0)
+    water.add_element('B', 5.0e-4)
+    water.add_s_alpha_beta('c_H_in_H2O')
+
+    steel = openmc.Material(name='Stainless steel')
+    steel.set_density('g/cm3', 8.0)
+    steel.add_element('Fe', 0.70, 'wo')
+    steel.add_element('Cr', 0.19, 'wo')
+    steel.add_element('Ni', 0.11, 'wo')
+
+    # Fuel assemblies in a 7x7 lattice without the three positions at each
+    # corner
+    pitch = 21.50
+    fuel_pin, guide_tube = pin_universes(fuel, clad, water)
+    assembly = openmc.Universe(name='fuel assembly', cells=[
+        openmc.Cell(fill=assembly_lattice(fuel_pin, guide_tube, pitch))])
+    reflector = openmc.Universe(name='water', cells=[openmc.Cell(fill=water)])
+    rows = [3, 5, 7, 7, 7, 5, 3]
+    core = openmc.RectLattice(name='core')
+    core.pitch = (pitch, pitch)
+    core.lower_left = (-3.5*pitch, -3.5*pitch)
+    core.outer = reflector
+    universes = []
+    for n in rows:
+        pad = (7 - n) // 2
+        universes.append([reflector]*pad + [assembly]*n + [reflector]*pad)
+    core.universes = universes
+
+    height = 200.0
+    barrel_ir = openmc.ZCylinder(r=95.0)
+    barrel_or = openmc.ZCylinder(r=100.0)
+    vessel = openmc.ZCylinder(r=115.0, boundary_type='vacuum')
+    z_fuel_bot = openmc.ZPlane(z0=-height/2)
+    z_fuel_top = openmc.ZPlane(z0=height/2)
+    z_bot = openmc.ZPlane(z0=-height/2 - 20.0, boundary_type='vacuum')
+    z_top = openmc.ZPlane(z0=height/2 + 20.0, boundary_type='vacuum')
+    root = openmc.Universe(cells=[
+        openmc.Cell(fill=core, region=-barrel_ir & +z_fuel_bot & -z_fuel_top),
+        openmc.Cell(fill=water, region=-barrel_ir & +z_bot & -z_fuel_bot),
+        openmc.Cell(fill=water, region=-barrel_ir & +z_fuel_top & -z_top),
+        openmc.Cell(fill=steel, region=+barrel_ir & -barrel_or & +z_bot & -z_top),
+        openmc.Cell(fill=water, region=+barrel_or & -vessel & +z_bot & -z_top)])
+
+    model = openmc.model.Model()
+    model.materials = openmc.Materials([fuel, clad, water, steel])
+    model.geometry = openmc.Geometry(root)
+    model.settings.source = openmc.Source(space=openmc.stats.Box(
+        [-75.0, -75.0, -height/2], [75.0, 75.0, height/2],
+        only_fissionable=True))
+    return model
+
+
+def hm_core(n_nuclides):
+    """Return the Hoogenboom-Martin core with n_nuclides in the fuel."""
+    model = pwr_core()
+    fuel = next(m for m in model.materials if m.name == 'UOX fuel')
+    add_trace_nuclides(fuel, n_nuclides)
+    return model
+
+
+def triso_cube():
+    """Return a reflected 1 cm cube of TRISO particles in graphite."""
+    fuel = openmc.Material(name='UCO kernel')
+    fuel.set_density('g/cm3', 10.5)
+    fuel.add_nuclide('U235', 0.14154)
+    fuel.add_nuclide('U238', 0.85846)
+    fuel.add_nuclide('C0', 0.5)
+    fuel.add_nuclide('O16', 1.5)
+
+    def carbon(name, density):
+        mat = openmc.Material(name=name)
+        mat.set_density('g/cm3', density)
+        mat.add_nuclide('C0', 1.0)
+        mat.add_s_alpha_beta('c_Graphite')
+        return mat
+
+    buffer = carbon('buffer', 1.0)
+    ipyc = carbon('IPyC', 1.90)
+    opyc = carbon('OPyC', 1.87)
+    graphite = carbon('matrix', 1.1995)
+    sic = openmc.Material(name='SiC')
+    sic.set_density('g/cm3', 3.20)
+    sic.add_nuclide('C0', 1.0)
+    sic.add_element('Si', 1.0)
+
+    spheres = [openmc.Sphere(r=r*1e-4) for r in [212.5, 312.5, 347.5, 382.5]]
+    particle = openmc.Universe(cells=[
+        openmc.Cell(fill=fuel, region=-spheres[0]),
+        openmc.Cell(fill=buffer, region=+spheres[0] & -spheres[1]),
+        openmc.Cell(fill=ipyc, region=+spheres[1] & -spheres[2]),
+        openmc.Cell(fill=sic, region=+spheres[2] & -spheres[3]),
+        openmc.Cell(fill=opyc, region=+spheres[3])])
+
+    box = openmc.rectangular_prism(1.0, 1.0, boundary_type='reflective')
+    z_min = openmc.ZPlane(z0=-0.5, boundary_type='reflective')
+    z_max = openmc.ZPlane(z0=0.5, boundary_type='reflective')
+    region = box & +z_min & -z_max
+    outer_radius = 422.5e-4
+    centers = openmc.model.pack_spheres(radius=outer_radius, region=region,
+                                        pf=0.3, seed=1)
+    trisos = [openmc.model.TRISO(outer_radius, particle, c) for c in centers]
+    shape = (5, 5, 5)
+    lower_left = np.array([-0.5, -0.5, -0.5])
+    lattice = openmc.model.create_triso_lattice(
+        trisos, lower_left, np.ones(3) / shape, shape, graphite)
+
+    model = openmc.model.Model()
+    model.materials = openmc.Materials(
+        [fuel, buffer, ipyc, sic, opyc, graphite])
+    model.geometry = openmc.Geometry([openmc.Cell(fill=lattice, region=region)])
+    model.settings.source = openmc.Source(space=openmc.stats.Box(
+        [-0.5, -0.5, -0.5], [0.5, 0.5, 0.5]))
+    return model
+
+
+def fusion_shield():
+    """Return spherical first wall, blanket and shield layers around a 14.1
+    MeV point source."""
+    tungsten = openmc.Material(name='tungsten')
+    tungsten.set_density('g/cm3', 19.3)
+    tungsten.add_element('W', 1.0)
+
+    steel = openmc.Material(name='Eurofer')
+    steel.set_density('g/cm3', 7.8)
+    steel.add_element('Fe', 0.89, 'wo')
+    steel.add_element('Cr', 0.09, 'wo')
+    steel.add_element('W', 0.011, 'wo')
+    steel.add_element('Mn', 0.004, 'wo')
+    steel.add_element('V', 0.002, 'wo')
+    steel.add_element('C', 0.001, 'wo')
+
+    blanket = openmc.Material(name='Li4SiO4 and Be pebbles')
+    blanket.set_density('g/cm3', 1.9)
+    blanket.add_element('Li', 4.0, enrichment=60.0, enrichment_target='Li6',
+                        enrichment_type='ao')
+    blanket.add_element('Si', 1.0)
+    blanket.add_element('O', 4.0)
+    blanket.add_element('Be', 10.0)
+
+    shield = openmc.Material(name='steel and water shield')
+    shield.set_density('g/cm3', 6.4)
+    shield.add_element('Fe', 0.60, 'wo')
+    shield.add_element('Cr', 0.15, 'wo')
+    shield.add_element('Ni', 0.10, 'wo')
+    shield.add_element('H', 0.017, 'wo')
+    shield.add_element('O', 0.133, 'wo')
+
+    radii = [200.0, 202.0, 210.0, 260.0, 320.0]
+    spheres = [openmc.Sphere(r=r) for r in radii]
+    spheres[-1].boundary_type = 'vacuum'
+    fills = [None, tungsten, steel, blanket, shield]
+    cells = [openmc.Cell(fill=fills[0], region=-spheres[0])]
+    for i in range(1, len(radii)):
+        cells.append(openmc.Cell(fill=fills[i],
+                                 region=+spheres[i-1] & -spheres[i]))
+
+    flux = openmc.Tally(name='layer flux')
+    flux.filters = [openmc.CellFilter(cells[1:]), openmc.ParticleFilter(
+        ['neutron', 'photon'])]
+    flux.scores = ['flux', 'heating']
+    tbr = openmc.Tally(name='tritium breeding')
+    tbr.filters = [openmc.CellFilter([cells[3]])]
+    tbr.scores = ['(n,Xt)']
+
+    model = openmc.model.Model()
+    model.materials = openmc.Materials([tungsten, steel, blanket, shield])
+    model.geometry = openmc.Geometry(cells)
+    model.tallies = openmc.Tallies([flux, tbr])
+    model.settings.run_mode = 'fixed source'
+    model.settings.photon_transport = True
+    model.settings.source = openmc.Source(
+        space=openmc.stats.Point(), angle=openmc.stats.Isotropic(),
+        energy=openmc.stats.Discrete([14.1e6], [1.0]))
+    return model
+
+
+def c5g7_library():
+    """Return the UO2 and water data of the C5G7 benchmark."""
+    groups = openmc.mgxs.EnergyGroups(group_edges=[
+        1e-5, 0.0635, 10.0, 1.0e2, 1.0e3, 0.5e6, 1.0e6, 20.0e6])
+
+    uo2 = openmc.XSdata('UO2', groups)
+    uo2.order = 0
+    uo2.set_total([0.1779492, 0.3298048, 0.4803882, 0.5543674, 0.3118013,
+                   0.3951678, 0.5644058])
+    uo2.set_absorption([8.0248E-03, 3.7174E-03, 2.6769E-02, 9.6236E-02,
+                        3.0020E-02, 1.1126E-01, 2.8278E-01])
+    scatter = np.array(
+        [[[0.1275370, 0.0423780, 0.0000094, 0.0000000, 0.0000000, 0.0000000, 0.0000000],
+          [0.0000000, 0.3244560, 0.0016314, 0.0000000, 0.0000000, 0.0000000, 0.0000000],
+          [0.0000000, 0.0000000, 0.4509400, 0.0026792, 0.0000000, 0.0000000, 0.0000000],
+          [0.0000000, 0.0000000, 0.0000000, 0.4525650, 0.0055664, 0.0000000, 0.0000000],
+          [0.0000000, 0.0000000, 0.0000000, 0.0001253, 0.2714010, 0.0102550, 0.0000000],
+          [0.0000000, 0.0000000, 0.0000000, 0.0000000, 0.0012968, 0.2658020, 0.0168090],
+          [0.0000000, 0.0000000, 0.0000000, 0.0000000, 0.0000000, 0.0085458, 0.2730800]]])
+    uo2.set_scatter_matrix(np.rollaxis(scatter, 0, 3))
+    uo2.set_fission([7.21206E-03, 8.19301E-04, 6.45320E-03, 1.85648E-02,
+                     1.78084E-02, 8.30348E-02, 2.16004E-01])
+    uo2.set_nu_fission([2.005998E-02, 2.027303E-03, 1.570599E-02,
+                        4.518301E-02, 4.334208E-02, 2.020901E-01,
+                        5.257105E-01])
+    uo2.set_chi([5.8791E-01, 4.1176E-01, 3.3906E-04, 1.1761E-07, 0.0000E+00,
+                 0.0000E+00, 0.0000E+00])
+
+    h2o = openmc.XSdata('LWTR', groups)
+    h2o.order = 0
+    h2o.set_total([0.15920605, 0.412969593, 0.59030986, 0.58435, 0.718,
+                   1.2544497, 2.650379])
+    h2o.set_absorption([6.0105E-04, 1.5793E-05, 3.3716E-04, 1.9406E-03,
+                        5.7416E-03, 1.5001E-02, 3.7239E-02])
+    scatter = np.array(
+        [[[0.0444777, 0.1134000, 0.0007235, 0.0000037, 0.0000001, 0.0000000, 0.0000000],
+          [0.0000000, 0.2823340, 0.1299400, 0.0006234, 0.0000480, 0.0000074, 0.0000010],
+          [0.0000000, 0.0000000, 0.3452560, 0.2245700, 0.0169990, 0.0026443, 0.0005034],
+          [0.0000000, 0.0000000, 0.0000000, 0.0910284, 0.4155100, 0.0637320, 0.0121390],
+          [0.0000000, 0.0000000, 0.0000000, 0.0000714, 0.1391380, 0.5118200, 0.0612290],
+          [0.0000000, 0.0000000, 0.0000000, 0.0000000, 0.0022157, 0.6999130, 0.5373200],
+          [0.0000000, 0.0000000, 0.0000000, 0.0000000, 0.0000000, 0.1324400, 2.4807000]]])
+    h2o.set_scatter_matrix(np.rollaxis(scatter, 0, 3))
+
+    library = openmc.MGXSLibrary(groups)
+    library.add_xsdatas([uo2, h2o])
+    return library
+
+
+def mg_assembly():
+    """Return a reflected 17x17 assembly with C5G7 multigroup data."""
+    uo2 = openmc.Material(name='UO2 fuel')
+    uo2.set_density('macro', 1.0)
+    uo2.add_macroscopic('UO2')
+    water = openmc.Material(name='water')
+    water.set_density('macro', 1.0)
+    water.add_macroscopic('LWTR')
+
+    pitch = 21.42
+    fuel_or = openmc.ZCylinder(r=0.54)
+    fuel_pin = openmc.Universe(cells=[
+        openmc.Cell(fill=uo2, region=-fuel_or),
+        openmc.Cell(fill=water, region=+fuel_or)])
+    guide_tube = openmc.Universe(cells=[openmc.Cell(fill=water)])
+    box = openmc.rectangular_prism(pitch, pitch, boundary_type='reflective')
+
+    model = openmc.model.Model()
+    model.materials = openmc.Materials([uo2, water])
+    model.materials.cross_sections = 'mgxs.h5'
+    model.geometry = openmc.Geometry([openmc.Cell(
+        fill=assembly_lattice(fuel_pin, guide_tube, pitch), region=box)])
+    model.settings.energy_mode = 'multi-group'
+    model.settings.source = openmc.Source(space=openmc.stats.Box(
+        [-pitch/2, -pitch/2, -1], [pitch/2, pitch/2, 1],
+        only_fissionable=True))
+    return model
+
+
+PROBLEMS = {
+    'smr-fresh': lambda: smr_core(depleted=False),
+    'smr-depleted': lambda: smr_core(depleted=True),
+    'hm-small': lambda: hm_core(34),
+    'hm-large': lambda: hm_core(300),
+    'triso': triso_cube,
+    'fusion': fusion_shield,
+    'mg': mg_assembly,
+}
+
+
+def build(name, directory, particles, batches, inactive=None):
+    """Write the inputs of a problem to a directory."""
+    model = PROBLEMS[name]()
+    n, n_batches, n_inactive = RUN_SIZES[name]
+    model.settings.particles = particles or n
+    model.settings.batches = batches or n_batches
+    if model.settings.run_mode != 'fixed source':
+        if inactive is not None:
+            n_inactive = inactive
+        model.settings.inactive = min(n_inactive, model.settings.batches - 1)
+    model.settings.output = {'summary': False}
+    model.export_to_xml(directory)
+    if name == 'mg':
+        c5g7_library().export_to_hdf5(os.path.join(directory, 'mgxs.h5'))
+
+
+# ==============================================================================
+# Runner
+
+def run(exe, model_dir, mode, threads, mpi_args):
+    """Run a copy of a problem in a mode and return its measurements."""
+    flags, env = MODES[mode]
+    run_dir = tempfile.mkdtemp(prefix='bench_')
+    for f in glob.glob(os.path.join(model_dir, '*')):
+        shutil.copy(f, run_dir)
+
+    args = [exe] + flags + ['--startup-profile', 'startup.json']
+    if threads is not None:
+        args += ['-s', str(threads)]
+    if mpi_args:
+        args = mpi_args + args
+    environment = os.environ.copy()
+    environment.update(env)
+
+    # The process is waited on directly to get its peak resident memory. With
+    # MPI, this is the largest of the processes the launcher waits on.
+    log_path = os.path.join(run_dir, 'output.log')
+    with open(log_path, 'w') as log:
+        p = subprocess.Popen(args, cwd=run_dir, stdout=log,
+                             stderr=subprocess.STDOUT, env=environment)
+        _, status, usage = os.wait4(p.pid, 0)
+        p.returncode = os.waitstatus_to_exitcode(status)
+    with open(log_path) as log:
+        output = log.read()
+
+    result = {'mode': mode, 'threads': threads}
+    if p.returncode != 0:
+        _, _, error = output.partition('ERROR: ')
+        result['error'] = ' '.join(error.split()) or 'OpenMC aborted.'
+        shutil.rmtree(run_dir)
+        return result
+
+    result['peak_memory_mb'] = usage.ru_maxrss / 1024
+    result['location'] = 'device' if 'GPU Device' in output else 'host'
+
+    statepoints = glob.glob(os.path.join(run_dir, 'statepoint.*.h5'))
+    with openmc.StatePoint(max(statepoints, key=os.path.getmtime),
+                           autolink=False) as sp:
+        runtime = sp.runtime
+        n = sp.n_particles * sp.generations_per_batch
+        n_inactive = sp.n_inactive or 0
+        n_active = sp.current_batch - n_inactive
+        result['version'] = '.'.join(str(v) for v in sp.version)
+        result['particles'] = int(sp.n_particles)
+        result['batches'] = int(sp.current_batch)
+        result['rate_active'] = n * n_active / runtime['active batches']
+        if n_inactive > 0:
+            result['rate_inactive'] = n * n_inactive / runtime['inactive batches']
+        result['startup_seconds'] = float(runtime['total initialization'])
+        result['transport_seconds'] = float(runtime['transport'])
+        profile = sp.kernel_profile
+        if profile is not None:
+            result['kernels'] = {region: {k: v.item() for k, v in p.items()}
+                                 for region, p in profile.items()
+                                 if p['launches'] > 0 or p['kernels'] > 0}
+
+    startup = os.path.join(run_dir, 'startup.json')
+    if os.path.exists(startup):
+        with open(startup) as f:
+            phases = json.load(f)['phases']
+        result['startup_phases'] = {p['name']: p['seconds'] for p in phases
+                                    if p['depth'] == 0}
+
+    shutil.rmtree(run_dir)
+    return result
+
+
+def print_results(results):
+    print(f'{"Problem":<14s} {"Mode":<8s} {"Where":<7s} {"Active [n/s]":>13s} '
+          f'{"Inactive [n/s]":>15s} {"Startup [s]":>12s} {"Memory [MB]":>12s}')
+    for r in results:
+        if 'error' in r:
+            print(f'{r["problem"]:<14s} {r["mode"]:<8s} failed: {r["error"]}')
+            continue
+        inactive = r.get('rate_inactive')
+        inactive = f'{inactive:15.4e}' if inactive is not None else f'{"-":>15s}'
+        print(f'{r["problem"]:<14s} {r["mode"]:<8s} {r["location"]:<7s} '
+              f'{r["rate_active"]:13.4e} {inactive} '
+              f'{r["startup_seconds"]:12.3f} {r["peak_memory_mb"]:12.1f}')
+
+    for r in results:
+        if 'kernels' not in r:
+            continue
+        print(f'\n{r["problem"]} ({r["mode"]}) event kernels')
+        print(f'  {"Region":<22s} {"Launches":>10s} {"Items":>14s} '
+              f'{"Device [s]":>12s} {"Items/s":>12s}')
+        for region, k in r['kernels'].items():
+            seconds = k['device_seconds']
+            rate = k['items'] / seconds if seconds > 0.0 else 0.0
+            print(f'  {region:<22s} {k["launches"]:10d} {k["items"]:14d} '
+                  f'{seconds:12.4e} {rate:12.4e}')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--exe', default='openmc', help='OpenMC executable')
+    parser.add_argument('--problems', nargs='+', choices=list(PROBLEMS),
+                        default=list(PROBLEMS), help='Problems to run')
+    parser.add_argument('--modes', nargs='+', choices=list(MODES),
+                        default=['history', 'event'],
+                        help='Transport modes to run each problem in')
+    parser.add_argument('--threads', type=int, help='OpenMP threads')
+    parser.add_argument('--particles', type=int,
+                        help='Particles per batch, overriding each problem')
+    parser.add_argument('--batches', type=int,
+                        help='Batches, overriding each problem')
+    parser.add_argument('--mpi-args', default='',
+                        help='MPI launcher and its arguments, e.g. "mpiexec -n 4"')
+    parser.add_argument('--output', help='JSON file to write the results to')
+    args = parser.parse_args()
+
+    results = []
+    for name in args.problems:
+        model_dir = tempfile.mkdtemp(prefix=f'bench_{name}_')
+        build(name, model_dir, args.particles, args.batches)
+        for mode in args.modes:
+            result = run(args.exe, model_dir, mode, args.threads,
+                         args.mpi_args.split())
+            result['problem'] = name
+            results.append(result)
+        shutil.rmtree(model_dir)
+
+    print_results(results)
+
+    if args.output:
+        report = {
+            'date': datetime.datetime.now().isoformat(timespec='seconds'),
+            'host': platform.node(),
+            'executable': os.path.abspath(shutil.which(args.exe) or args.exe),
+            'mpi_args': args.mpi_args,
+            'results': results,
+        }
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+"""Check short runs of the standard performance problems against baselines.
+
+Each problem of openmc_bench.py is run in a shortened form a few times per
+transport mode, and the median of each metric is compared with the baseline
+stored for the machine class the check runs on:
+
+    rate_active, rate_inactive   particles per second of the batches
+    kernel:<region>              items per second of an event kernel
+
+A metric has regressed when its median falls below the baseline median by
+more than the tolerance. Timings are noisy, so the tolerance of each metric is
+widened to cover the spread seen when the baseline was recorded and in the
+current runs, measured as the median absolute deviation relative to the
+median and scaled by --noise-factor. The check exits with status 1 if any
+metric regressed, or if a baseline is missing and --require-baseline is given.
+
+Baselines are JSON files named <machine>.json in the baseline directory, one
+per machine class, e.g. "a100-nvhpc" or "epyc-gcc". The machine class is given
+by --machine or the OPENMC_PERF_MACHINE environment variable. A baseline is
+recorded, or a measured entry of it replaced, with --update.
+
+Usage:
+    openmc_perf_check.py --exe build/bin/openmc --machine a100-nvhpc
+        [--problems hm-small] [--modes event device] [--repeats 3]
+        [--tolerance 0.05] [--update]
+"""
+
+import argparse
+import datetime
+import json
+import os
+import shutil
+import statistics
+import sys
+import tempfile
+
+import openmc_bench
+
+
+# Particles, batches and inactive batches of the short version of each problem
+SHORT_RUN_SIZES = {
+    'smr-fresh': (20000, 8, 3),
+    'smr-depleted': (20000, 8, 3),
+    'hm-small': (20000, 8, 3),
+    'hm-large': (20000, 8, 3),
+    'triso': (20000, 8, 3),
+    'fusion': (20000, 4, 0),
+    'mg': (200000, 8, 3),
+}
+
+# Kernels with fewer items than this in a run are too short to time reliably
+MIN_KERNEL_ITEMS = 100000
+
+BASELINE_VERSION = 1
+
+
+# ==============================================================================
+# Measurements
+
+def metrics(result):
+    """Return the compared metrics of one run, all of which are rates."""
+    values = {'rate_active': result['rate_active']}
+    if 'rate_inactive' in result:
+        values['rate_inactive'] = result['rate_inactive']
+    for region, k in result.get('kernels', {}).items():
+        if k['items'] >= MIN_KERNEL_ITEMS and k['device_seconds'] > 0.0:
+            values[f'kernel:{region}'] = k['items'] / k['device_seconds']
+    return values
+
+
+def summarize(samples):
+    """Return the median and relative median absolute deviation of samples."""
+    median = statistics.median(samples)
+    deviation = statistics.median(abs(x - median) for x in samples)
+    return {'median': median,
+            'spread': deviation / median if median > 0.0 else 0.0,
+            'samples': samples}
+
+
+def measure(exe, name, mode, repeats, threads, mpi_args):
+    """Run the short version of a problem and summarize each metric.
+
+    Returns the summaries, or the error message of a failed run.
+    """
+    particles, batches, inactive = SHORT_RUN_SIZES[name]
+    model_dir = tempfile.mkdtemp(prefix=f'perf_{name}_')
+    try:
+        openmc_bench.build(name, model_dir, particles, batches, inactive)
+        samples = {}
+        for _ in range(repeats):
+            result = openmc_bench.run(exe, model_dir, mode, threads, mpi_args)
+            if 'error' in result:
+                return result['error']
+            for metric, value in metrics(result).items():
+                samples.setdefault(metric, []).append(value)
+    finally:
+        shutil.rmtree(model_dir)
+
+    # A metric missing from some runs, e.g. a kernel that was only sometimes
+    # long enough, is not compared
+    return {metric: summarize(values) for metric, values in samples.items()
+            if len(values) == repeats}
+
+
+# ==============================================================================
+# Comparison
+
+def compare(current, baseline, tolerance, noise_factor):
+    """Compare the metrics of one problem and mode with their baseline.
+
+    Returns rows of metric, baseline median, current median, relative change,
+    allowed decrease and whether the metric regressed.
+    """
+    rows = []
+    for metric, base in sorted(baseline.items()):
+        if metric not in current:
+            continue
+        now = current[metric]
+        change = now['median'] / base['median'] - 1.0
+        noise = noise_factor * max(base['spread'], now['spread'])
+        allowed = max(tolerance, noise)
+        rows.append((metric, base['median'], now['median'], change, allowed,
+                     change < -allowed))
+    return rows
+
+
+def print_comparison(key, rows):
+    print(f'\n{key}')
+    print(f'  {"Metric":<32s} {"Baseline":>12s} {"Current":>12s} '
+          f'{"Change":>8s} {"Allowed":>8s}')
+    for metric, base, now, change, allowed, regressed in rows:
+        status = '  REGRESSED' if regressed else ''
+        print(f'  {metric:<32s} {base:12.4e} {now:12.4e} {change:+8.1%} '
+              f'{-allowed:+8.1%}{status}')
+
+
+# ==============================================================================
+# Baselines
+
+def baseline_path(directory, machine):
+    return os.path.join(directory, f'{machine}.json')
+
+
+def load_baseline(path):
+    if not os.path.exists(path):
+        return {'version': BASELINE_VERSION, 'entries': {}}
+    with open(path) as f:
+        baseline = json.load(f)
+    if baseline.get('version') != BASELINE_VERSION:
+        sys.exit(f'{path} has baseline version {baseline.get("version")}, '
+                 f'expected {BASELINE_VERSION}.')
+    return baseline
+
+
+def save_baseline(path, baseline, exe):
+    baseline['executable'] = os.path.abspath(shutil.which(exe) or exe)
+    baseline['date'] = datetime.datetime.now().isoformat(timespec='seconds')
+    os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+    with open(path, 'w') as f:
+        json.dump(baseline, f, indent=2, sort_keys=True)
+        f.write('\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--exe', default='openmc', help='OpenMC executable')
+    parser.add_argument('--problems', nargs='+', choices=list(SHORT_RUN_SIZES),
+                        default=['hm-small', 'mg'], help='Problems to run')
+    parser.add_argument('--modes', nargs='+', choices=list(openmc_bench.MODES),
+                        default=['history', 'event'],
+                        help='Transport modes to run each problem in')
+    parser.add_argument('--machine', default=os.environ.get('OPENMC_PERF_MACHINE'),
+                        help='Machine class whose baseline is compared against')
+    parser.add_argument('--baseline-dir', default=os.path.join(
+                        os.path.dirname(os.path.abspath(__file__)), 'perf_baselines'),
+                        help='Directory of the baseline of each machine class')
+    parser.add_argument('--repeats', type=int, default=3,
+                        help='Runs of each problem and mode')
+    parser.add_argument('--tolerance', type=float, default=0.05,
+                        help='Relative decrease of a metric that is a regression')
+    parser.add_argument('--noise-factor', type=float, default=3.0,
+                        help='Multiple of the relative spread of a metric that '
+                        'widens its tolerance')
+    parser.add_argument('--threads', type=int, help='OpenMP threads')
+    parser.add_argument('--mpi-args', default='',
+                        help='MPI launcher and its arguments, e.g. "mpiexec -n 4"')
+    parser.add_argument('--update', action='store_true',
+                        help='Record the measurements as the baseline')
+    parser.add_argument('--require-baseline', action='store_true',
+                        help='Fail if a problem and mode have no baseline')
+    args = parser.parse_args()
+
+    if not args.machine:
+        parser.error('a machine class is needed: give --machine or set '
+                     'OPENMC_PERF_MACHINE')
+    if args.repeats < 1:
+        parser.error('--repeats must be at least 1')
+
+    path = baseline_path(args.baseline_dir, args.machine)
+    baseline = load_baseline(path)
+    failed = False
+    for name in args.problems:
+        for mode in args.modes:
+            key = f'{name}/{mode}'
+            current = measure(args.exe, name, mode, args.repeats, args.threads,
+                              args.mpi_args.split())
+            if isinstance(current, str):
+                print(f'\n{key} failed: {current}')
+                failed = True
+                continue
+
+            if args.update:
+                baseline['entries'][key] = current
+                print(f'\n{key}: recorded {len(current)} metrics')
+            elif key not in baseline['entries']:
+                print(f'\n{key}: no baseline for machine class {args.machine}')
+                failed |= args.require_baseline
+            else:
+                rows = compare(current, baseline['entries'][key],
+                               args.tolerance, args.noise_factor)
+                print_comparison(key, rows)
+                failed |= any(r[-1] for r in rows)
+
+    if args.update:
+        save_baseline(path, baseline, args.exe)
+        print(f'\nWrote baseline {path}')
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Compare keff and tally results between two OpenMC executables.
+
+This is intended to validate a build configured with -Dsingle_precision_xs=on
+against a reference double precision build. The same model is run with both
+executables (with identical seeds) and every result is required to agree
+within a given number of combined standard deviations.
+
+Usage:
+    validate_xs_precision.py --reference build-double/bin/openmc \\
+        --candidate build-single/bin/openmc [--model DIR] [--event]
+
+If no model directory is given, the PWR pin cell example (with a flux and
+reaction rate tally) is generated and used.
+"""
+
+import argparse
+import glob
+import os
+import shutil
+import sys
+import tempfile
+
+import numpy as np
+import openmc
+from openmc.examples import pwr_pin_cell
+
+
+def build_default_model(directory, particles):
+    model = pwr_pin_cell()
+    model.settings.particles = particles
+    tally = openmc.Tally(name='reaction rates')
+    tally.filters = [openmc.EnergyFilter([0.0, 0.625, 2.0e7])]
+    tally.scores = ['flux', 'total', 'absorption', 'fission', 'nu-fission']
+    model.tallies = openmc.Tallies([tally])
+    model.export_to_xml(directory)
+
+
+def run(exe, model_dir, event_based):
+    """Run a copy of the model with the given executable and return the path
+    of its final statepoint."""
+    run_dir = tempfile.mkdtemp(prefix='xs_precision_')
+    for f in glob.glob(os.path.join(model_dir, '*.xml')):
+        shutil.copy(f, run_dir)
+    openmc.run(openmc_exec=exe, cwd=run_dir, event_based=event_based)
+    statepoints = glob.glob(os.path.join(run_dir, 'statepoint.*.h5'))
+    return max(statepoints, key=os.path.getmtime)
+
+
+def compare(name, ref_mean, ref_std, cand_mean, cand_std, n_sigma):
+    """Return the number of results that disagree by more than n_sigma."""
+    sigma = np.sqrt(ref_std**2 + cand_std**2)
+    diff = np.abs(ref_mean - cand_mean)
+    bad = diff > n_sigma * np.where(sigma > 0.0, sigma, np.inf)
+    # Results without any uncertainty (e.g., zero scores) must match closely
+    exact = (sigma == 0.0) & ~np.isclose(ref_mean, cand_mean, rtol=1e-5)
+    n_bad = int(np.count_nonzero(bad | exact))
+    with np.errstate(divide='ignore', invalid='ignore'):
+        max_rel = np.nanmax(np.where(ref_mean != 0.0, diff / np.abs(ref_mean), 0.0))
+    print(f'  {name:30s} {ref_mean.size:8d} values, max rel. diff '
+          f'{max_rel:.3e}, {n_bad} outside {n_sigma} sigma')
+    return n_bad
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--reference', required=True,
+                        help='Reference (double precision) OpenMC executable')
+    parser.add_argument('--candidate', required=True,
+                        help='Candidate (e.g., single precision) OpenMC executable')
+    parser.add_argument('--model', help='Directory containing model XML files')
+    parser.add_argument('--particles', type=int, default=10000,
+                        help='Particles per batch for the default model')
+    parser.add_argument('--sigma', type=float, default=3.0,
+                        help='Allowed difference in combined standard deviations')
+    parser.add_argument('--event', action='store_true',
+                        help='Run in event-based mode')
+    args = parser.parse_args()
+
+    model_dir = args.model
+    if model_dir is None:
+        model_dir = tempfile.mkdtemp(prefix='xs_precision_model_')
+        build_default_model(model_dir, args.particles)
+
+    ref_sp = run(args.reference, model_dir, args.event)
+    cand_sp = run(args.candidate, model_dir, args.event)
+
+    n_bad = 0
+    with openmc.StatePoint(ref_sp) as ref, openmc.StatePoint(cand_sp) as cand:
+        print('Comparing results:')
+        k_ref, k_cand = ref.k_combined, cand.k_combined
+        n_bad += compare('keff', np.array([k_ref.n]), np.array([k_ref.s]),
+                         np.array([k_cand.n]), np.array([k_cand.s]), args.sigma)
+        for tally_id, tally in ref.tallies.items():
+            other = cand.tallies[tally_id]
+            n_bad += compare(f'tally {tally_id} ({tally.name})', tally.mean,
+                             tally.std_dev, other.mean, other.std_dev,
+                             args.sigma)
+
+    if n_bad > 0:
+        print(f'FAILED: {n_bad} results differ by more than {args.sigma} sigma')
+        sys.exit(1)
+    print('PASSED')
+
+
+if __name__ == '__main__':
+    main()